@@ -39,6 +39,7 @@
 #include <pdal/StageFactory.hpp>
 #include <pdal/pdal_config.hpp>
 #include <pdal/util/Backtrace.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 #include <iomanip>
 #include <iostream>
@@ -88,6 +89,7 @@ private:
     bool m_showJSON;
     std::string m_log;
     bool m_logtiming;
+    int m_maxThreads;
 };
 
 
@@ -282,6 +284,9 @@ void App::addArgs(ProgramArgs& args)
     args.add("log", "Log filename (accepts stderr, stdout, stdlog, devnull"
         " as special cases)", m_log, "stderr");
     args.add("logtiming", "Turn on timing for log messages", m_logtiming);
+    args.add("max-threads", "Maximum number of threads that the command's "
+        "parallel work uses at once, across all stages (0 for one per core)",
+        m_maxThreads, 0);
     Arg& json = args.add("showjson", "List options or drivers as JSON output",
         m_showJSON);
     json.setHidden();
@@ -324,6 +329,12 @@ int App::execute(StringList& cmdArgs, LogPtr& log)
     else if (m_debug)
         log->setLevel(LogLevel::Debug);
     log->get(LogLevel::Debug) << "Debugging..." << std::endl;
+    if (m_maxThreads < 0)
+    {
+        Utils::printError("Option 'max-threads' can't be negative.");
+        return -1;
+    }
+    setParallelThreads((size_t)m_maxThreads);
     PluginManager<Stage>::setLog(log);
     PluginManager<Kernel>::setLog(log);
 #ifndef _WIN32
@@ -0,0 +1,14 @@
+#
+# Apache Arrow and Parquet support
+#
+find_package(Arrow 15 QUIET REQUIRED)
+set_package_properties(Arrow PROPERTIES
+        TYPE OPTIONAL
+        URL "https://arrow.apache.org"
+        PURPOSE "Apache Arrow support")
+
+find_package(Parquet QUIET REQUIRED)
+set_package_properties(Parquet PROPERTIES
+        TYPE OPTIONAL
+        URL "https://parquet.apache.org"
+        PURPOSE "Apache Parquet support")
@@ -204,6 +204,7 @@ macro(PDAL_ADD_TEST _name)
             gtest
             ${PDAL_ADD_TEST_LINK_WITH}
             ${WINSOCK_LIBRARY}
+            ${RT_LIBRARY}
     )
     add_test(NAME ${_name}
         COMMAND
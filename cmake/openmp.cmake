@@ -0,0 +1,22 @@
+#
+# OpenMP support (optional).  Only used to run the vendored Poisson
+# reconstruction code in parallel.
+#
+option(WITH_OPENMP
+    "Build filters.poisson with OpenMP for multi-threaded reconstruction."
+    TRUE)
+if (WITH_OPENMP)
+    find_package(OpenMP QUIET)
+    set_package_properties(OpenMP PROPERTIES TYPE OPTIONAL
+        PURPOSE "Multi-threaded Poisson surface reconstruction")
+    if (OPENMP_FOUND)
+        set(PDAL_HAVE_OPENMP 1)
+        # OpenMP_CXX_LIBRARIES is only set by CMake 3.9 and later.  Older
+        # versions rely on the compiler flag at link time.
+        if (OpenMP_CXX_LIBRARIES)
+            set(PDAL_OPENMP_LIBRARIES ${OpenMP_CXX_LIBRARIES})
+        else()
+            set(PDAL_OPENMP_LIBRARIES ${OpenMP_CXX_FLAGS})
+        endif()
+    endif()
+endif(WITH_OPENMP)
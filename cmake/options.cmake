@@ -103,6 +103,11 @@ option(BUILD_PLUGIN_TILEDB
 add_feature_info("TileDB plugin" BUILD_PLUGIN_TILEDB
     "read/write data from TileDB")
 
+option(BUILD_PLUGIN_ARROW
+    "Choose if Apache Arrow and Parquet support should be built" FALSE)
+add_feature_info("Arrow plugin" BUILD_PLUGIN_ARROW
+    "read/write data from Arrow IPC and Parquet files")
+
 option(BUILD_TOOLS_NITFWRAP "Choose if nitfwrap tool should be built" FALSE)
 
 option(WITH_TESTS
@@ -135,6 +140,9 @@ cmake_dependent_option(BUILD_RIVLIB_TESTS
 cmake_dependent_option(BUILD_RDBLIB_TESTS
     "Choose if rdblib tests should be built"
     ON "BUILD_PLUGIN_RDBLIB; WITH_TESTS" OFF)
+cmake_dependent_option(BUILD_BENCHMARKS
+    "Choose if the pdal_bench benchmark program should be built"
+    OFF "WITH_TESTS" OFF)
 cmake_dependent_option(BUILD_PIPELINE_TESTS
     "Choose if pipeline tests should be built"
     OFF "WITH_TESTS" OFF)
@@ -42,3 +42,8 @@ function(pdal_target_compile_settings target)
         -Wno-deprecated-declarations
     )
 endfunction()
+
+# shm_open() is in librt with glibc before 2.34.
+if (CMAKE_SYSTEM_NAME STREQUAL "Linux")
+    set(RT_LIBRARY rt)
+endif()
@@ -86,14 +86,10 @@ void ApproximateCoplanarFilter::filter(PointView& view)
         // find the k-nearest neighbors
         auto ids = kdi.neighbors(i, m_knn);
 
-        // compute covariance of the neighborhood
-        auto B = eigen::computeCovariance(view, ids);
-
-        // perform the eigen decomposition
-        SelfAdjointEigenSolver<Matrix3f> solver(B);
-        if (solver.info() != Success)
+        // perform the eigen decomposition of the neighborhood covariance
+        Vector3f ev;
+        if (!eigen::computeCovarianceEigen(view, ids, ev))
             throwError("Cannot perform eigen decomposition.");
-        auto ev = solver.eigenvalues();
 
         // test eigenvalues to label points that are approximately coplanar
         if ((ev[1] > m_thresh1 * ev[0]) && (m_thresh2 * ev[1] > ev[2]))
@@ -164,13 +164,96 @@ bool AssignFilter::processOne(PointRef& point)
 }
 
 
+// Assign values to a block of points.  getValues(id, values) fetches the
+// values of a dimension for the block and setValues(id, first, count,
+// values) writes back the values of a run of points of the block.
+// Points that aren't active are left alone.
+template<typename GetValues, typename SetValues>
+void AssignFilter::assign(GetValues getValues, SetValues setValues,
+    point_count_t count, std::vector<char>& active)
+{
+    std::vector<double> values(count);
+    std::vector<char> changed(count);
+
+    if (m_args->m_condition.m_id != Dimension::Id::Unknown)
+    {
+        getValues(m_args->m_condition.m_id, values.data());
+        m_args->m_condition.valuesPass(values.data(), count, changed.data());
+        for (point_count_t i = 0; i < count; ++i)
+            active[i] &= changed[i];
+    }
+
+    for (AssignRange& r : m_args->m_assignments)
+    {
+        getValues(r.m_id, values.data());
+        r.valuesPass(values.data(), count, changed.data());
+        for (point_count_t i = 0; i < count; ++i)
+        {
+            changed[i] &= active[i];
+            if (changed[i])
+                values[i] = r.m_value;
+        }
+
+        // Only write back runs of changed values so that the values of
+        // other points don't go through a conversion to double and back.
+        point_count_t i = 0;
+        while (i < count)
+        {
+            if (!changed[i])
+            {
+                i++;
+                continue;
+            }
+            point_count_t first = i;
+            while (i < count && changed[i])
+                i++;
+            setValues(r.m_id, first, i - first, values.data() + first);
+        }
+    }
+}
+
+
+void AssignFilter::processBatch(StreamPointTable& table, PointId begin,
+    PointId end, std::vector<bool>& keep)
+{
+    const point_count_t count = end - begin;
+    std::vector<char> active(count);
+
+    for (point_count_t i = 0; i < count; ++i)
+        active[i] = keep[i];
+    assign([&](Dimension::Id id, double *v)
+        { table.getFieldArray(id, begin, count, v); },
+        [&](Dimension::Id id, PointId first, point_count_t n, const double *v)
+        { table.setFieldArray(id, begin + first, n, v); },
+        count, active);
+}
+
+
 void AssignFilter::filter(PointView& view)
 {
+    // Assign a block of points at a time rather than point by point.
+    // Values are set through a PointRef, which leaves values that can't
+    // be converted unchanged, as in stream mode.
+    const point_count_t blockSize = 4096;
+    std::vector<char> active(blockSize);
     PointRef point(view, 0);
-    for (PointId id = 0; id < view.size(); ++id)
+
+    for (PointId idx = 0; idx < view.size(); idx += blockSize)
     {
-        point.setPointId(id);
-        processOne(point);
+        point_count_t count = (std::min)(blockSize, view.size() - idx);
+        active.assign(count, 1);
+        assign([&](Dimension::Id id, double *v)
+            { view.getFieldArray(id, idx, count, v); },
+            [&](Dimension::Id id, PointId first, point_count_t n,
+                const double *v)
+            {
+                for (point_count_t i = 0; i < n; ++i)
+                {
+                    point.setPointId(idx + first + i);
+                    point.setField(id, v[i]);
+                }
+            },
+            count, active);
     }
 }
 
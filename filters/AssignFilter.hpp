@@ -53,8 +53,15 @@ public:
 private:
     virtual void addArgs(ProgramArgs& args);
     virtual void prepared(PointTableRef table);
+    virtual bool threadSafe() const
+        { return true; }
     virtual bool processOne(PointRef& point);
+    virtual void processBatch(StreamPointTable& table, PointId begin,
+        PointId end, std::vector<bool>& keep);
     virtual void filter(PointView& view);
+    template<typename GetValues, typename SetValues>
+    void assign(GetValues getValues, SetValues setValues, point_count_t count,
+        std::vector<char>& active);
 
     AssignFilter& operator=(const AssignFilter&) = delete;
     AssignFilter(const AssignFilter&) = delete;
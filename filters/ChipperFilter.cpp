@@ -33,8 +33,11 @@
 
 #include "ChipperFilter.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <limits>
+#include <map>
 
 /**
 The objective is to split the region into non-overlapping blocks, each
@@ -60,6 +63,14 @@ This procedure is then recursively applied to the created blocks until
 they contains only one or two partitions.  In the case of one or two
 partitions we are done, and we simply store away the contents of the
 blocks.
+
+The sorted arrays take several times the memory of the point indices
+themselves.  With the histogram option, the points are instead counted in a
+coarse grid of cells over their bounds.  Rectangles of cells are split the
+same way, at the cell boundary that best divides the points, until each
+holds no more than the capacity.  A second pass appends each point directly
+to the chip of its cell.  Cells that alone hold too many points are chipped
+by sorting, as above, but only those points are sorted.
 **/
 
 #include <pdal/util/ProgramArgs.hpp>
@@ -82,6 +93,8 @@ void ChipperFilter::addArgs(ProgramArgs& args)
 {
     args.add("capacity", "Maximum number of points per cell", m_threshold,
         (PointId) 5000u);
+    args.add("histogram", "Partition points with a coarse histogram rather "
+        "than by sorting them, to use less memory", m_histogram);
 }
 
 
@@ -90,11 +103,201 @@ PointViewSet ChipperFilter::run(PointViewPtr view)
     if (view->size() == 0)
         return m_outViews;
 
+    if (m_threshold == 0)
+        throwError("Option 'capacity' must be greater than 0.");
+    if (m_histogram)
+        chipHistogram(view);
+    else
+        chipSorted(view);
+    return m_outViews;
+}
+
+
+void ChipperFilter::chipSorted(PointViewPtr view)
+{
     m_inView = view;
     load(*view.get(), m_xvec, m_yvec, m_spare);
     partition(m_xvec.size());
     decideSplit(m_xvec, m_yvec, m_spare, 0, m_partitions.size() - 1);
-    return m_outViews;
+
+    m_partitions.clear();
+    m_xvec = ChipRefList();
+    m_yvec = ChipRefList();
+    m_spare = ChipRefList();
+}
+
+
+namespace
+{
+
+// Point counts in a grid of cells over the bounds of some points, along
+// with the chip assigned to each cell.
+struct ChipGrid
+{
+    static const size_t Empty;
+    static const size_t Dense;
+
+    ChipGrid(const BOX2D& bounds, size_t cells) : m_minx(bounds.minx),
+        m_miny(bounds.miny), m_cellWidth(1), m_cellHeight(1), m_cols(1),
+        m_rows(1)
+    {
+        double width = bounds.maxx - bounds.minx;
+        double height = bounds.maxy - bounds.miny;
+
+        // Make the cells about square.
+        if (width > 0 && height > 0)
+        {
+            double cols = std::round(std::sqrt(cells * width / height));
+            m_cols = (size_t)(std::min)((std::max)(cols, 1.0), (double)cells);
+            m_rows = (std::max)(cells / m_cols, (size_t)1);
+        }
+        else if (width > 0)
+            m_cols = cells;
+        else if (height > 0)
+            m_rows = cells;
+        if (width > 0)
+            m_cellWidth = width / m_cols;
+        if (height > 0)
+            m_cellHeight = height / m_rows;
+        m_counts.resize(m_cols * m_rows);
+        m_chips.resize(m_cols * m_rows, Empty);
+    }
+
+    size_t cell(double x, double y) const
+    {
+        size_t col = (std::min)((size_t)((x - m_minx) / m_cellWidth),
+            m_cols - 1);
+        size_t row = (std::min)((size_t)((y - m_miny) / m_cellHeight),
+            m_rows - 1);
+        return row * m_cols + col;
+    }
+
+    // Assign chips to the cells of the rectangle [c0, c1) x [r0, r1),
+    // splitting it until no chip holds more than 'capacity' points.
+    void assign(point_count_t capacity, size_t c0, size_t c1, size_t r0,
+        size_t r1, size_t& numChips)
+    {
+        // Split across the wider side, if it has more than one cell.
+        const bool byCol = (c1 - c0 > 1) && (r1 - r0 == 1 ||
+            (c1 - c0) * m_cellWidth >= (r1 - r0) * m_cellHeight);
+        const size_t begin = byCol ? c0 : r0;
+        const size_t end = byCol ? c1 : r1;
+
+        std::vector<point_count_t> counts(end - begin);
+        point_count_t total = 0;
+        for (size_t r = r0; r < r1; ++r)
+            for (size_t c = c0; c < c1; ++c)
+            {
+                point_count_t n = m_counts[r * m_cols + c];
+                counts[(byCol ? c : r) - begin] += n;
+                total += n;
+            }
+
+        if (total == 0)
+            return;
+        if (total <= capacity || end - begin == 1)
+        {
+            size_t chip = (total <= capacity) ? numChips++ : Dense;
+            for (size_t r = r0; r < r1; ++r)
+                for (size_t c = c0; c < c1; ++c)
+                    m_chips[r * m_cols + c] = chip;
+            return;
+        }
+
+        // Split where the points are divided in about the same proportion
+        // as the number of chips they need.
+        point_count_t parts = (total + capacity - 1) / capacity;
+        double target = (double)total * (parts / 2) / parts;
+        size_t split = begin + 1;
+        double bestDiff = (std::numeric_limits<double>::max)();
+        point_count_t sum = 0;
+        for (size_t i = begin + 1; i < end; ++i)
+        {
+            sum += counts[i - 1 - begin];
+            double diff = std::fabs(sum - target);
+            if (diff < bestDiff)
+            {
+                bestDiff = diff;
+                split = i;
+            }
+        }
+
+        if (byCol)
+        {
+            assign(capacity, c0, split, r0, r1, numChips);
+            assign(capacity, split, c1, r0, r1, numChips);
+        }
+        else
+        {
+            assign(capacity, c0, c1, r0, split, numChips);
+            assign(capacity, c0, c1, split, r1, numChips);
+        }
+    }
+
+    double m_minx;
+    double m_miny;
+    double m_cellWidth;
+    double m_cellHeight;
+    size_t m_cols;
+    size_t m_rows;
+    std::vector<point_count_t> m_counts;
+    std::vector<size_t> m_chips;
+};
+
+const size_t ChipGrid::Empty = (std::numeric_limits<size_t>::max)();
+const size_t ChipGrid::Dense = (std::numeric_limits<size_t>::max)() - 1;
+
+} // unnamed namespace
+
+
+void ChipperFilter::chipHistogram(PointViewPtr view)
+{
+    using namespace Dimension;
+
+    // Aim for cells that hold a sixteenth of a chip on average.
+    const size_t MaxCells = 1 << 22;
+    size_t cells = (size_t)(std::min)(view->size() * 16 / m_threshold,
+        (point_count_t)MaxCells);
+
+    BOX2D bounds;
+    view->calculateBounds(bounds);
+    ChipGrid grid(bounds, (std::max)(cells, (size_t)1));
+
+    for (PointId i = 0; i < view->size(); ++i)
+        grid.m_counts[grid.cell(view->getFieldAs<double>(Id::X, i),
+            view->getFieldAs<double>(Id::Y, i))]++;
+
+    size_t numChips = 0;
+    grid.assign(m_threshold, 0, grid.m_cols, 0, grid.m_rows, numChips);
+
+    std::vector<PointViewPtr> chips;
+    for (size_t i = 0; i < numChips; ++i)
+        chips.push_back(view->makeNew());
+    std::map<size_t, PointViewPtr> dense;
+
+    for (PointId i = 0; i < view->size(); ++i)
+    {
+        size_t cell = grid.cell(view->getFieldAs<double>(Id::X, i),
+            view->getFieldAs<double>(Id::Y, i));
+        size_t chip = grid.m_chips[cell];
+        if (chip == ChipGrid::Dense)
+        {
+            PointViewPtr& d = dense[cell];
+            if (!d)
+                d = view->makeNew();
+            d->appendPoint(*view, i);
+        }
+        else
+            chips[chip]->appendPoint(*view, i);
+    }
+    // Free the grid before sorting the points of dense cells.
+    std::vector<point_count_t>().swap(grid.m_counts);
+    std::vector<size_t>().swap(grid.m_chips);
+
+    for (PointViewPtr& v : chips)
+        m_outViews.insert(v);
+    for (auto& d : dense)
+        chipSorted(d.second);
 }
 
 
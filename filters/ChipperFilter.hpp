@@ -119,6 +119,8 @@ private:
     virtual void addArgs(ProgramArgs& args);
     virtual PointViewSet run(PointViewPtr view);
 
+    void chipSorted(PointViewPtr view);
+    void chipHistogram(PointViewPtr view);
     void load(PointView& view, ChipRefList& xvec,
         ChipRefList& yvec, ChipRefList& spare);
     void partition(point_count_t size);
@@ -129,6 +131,7 @@ private:
     void emit(ChipRefList& wide, PointId widemin, PointId widemax);
 
     PointId m_threshold;
+    bool m_histogram;
     PointViewPtr m_inView;
     PointViewSet m_outViews;
     std::vector<PointId> m_partitions;
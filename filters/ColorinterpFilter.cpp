@@ -36,6 +36,7 @@
 
 #include <pdal/PointView.hpp>
 #include <pdal/GDALUtils.hpp>
+#include <pdal/Reader.hpp>
 #include <pdal/util/ProgramArgs.hpp>
 
 #include <gdal.h>
@@ -124,6 +125,8 @@ void ColorinterpFilter::addArgs(ProgramArgs& args)
         m_madMultiplier, 1.4862);
     args.add("k", "Number of deviations to compute minimum/maximum ",
         m_stdDevThreshold, 0.0);
+    args.add("header_range", "Take a missing minimum/maximum of X, Y or Z "
+        "from the header of the input reader", m_headerRange, false);
 }
 
 void ColorinterpFilter::addDimensions(PointLayoutPtr layout)
@@ -142,6 +145,43 @@ void ColorinterpFilter::prepared(PointTableRef table)
     if (!std::isnan(m_min) && !std::isnan(m_max) && m_max <= m_min)
         throwError("Specified 'minimum' value must be less than "
             "'maximum' value.");
+    if (m_headerRange && m_stdDevThreshold == 0.0 &&
+            (std::isnan(m_min) || std::isnan(m_max)))
+        headerRange();
+}
+
+
+// Take a missing minimum or maximum of X, Y or Z from the metadata of the
+// reader feeding the filter, which holds the bounds from its header.
+void ColorinterpFilter::headerRange()
+{
+    Stage *s = this;
+    while (s->getInputs().size() == 1 && !dynamic_cast<Reader *>(s))
+        s = s->getInputs().front();
+
+    std::string dim = Utils::tolower(Dimension::name(m_interpDim));
+    MetadataNode minNode = s->getMetadata().findChild("min" + dim);
+    MetadataNode maxNode = s->getMetadata().findChild("max" + dim);
+    if (!dynamic_cast<Reader *>(s) || !minNode.valid() || !maxNode.valid())
+    {
+        log()->get(LogLevel::Warning) << getName() << ": No header range "
+            "available for dimension '" << m_interpDimString << "'.  "
+            "Computing it from the points." << std::endl;
+        return;
+    }
+    if (std::isnan(m_min))
+        m_min = minNode.value<double>();
+    if (std::isnan(m_max))
+        m_max = maxNode.value<double>();
+    log()->get(LogLevel::Debug) << getName() << " header minimum " <<
+        m_min << ", maximum " << m_max << std::endl;
+}
+
+
+// Compute the scale from values to ramp positions once the range is known.
+void ColorinterpFilter::setRange()
+{
+    m_scale = m_max > m_min ? m_redBand.size() / (m_max - m_min) : 0.0;
 }
 
 
@@ -165,6 +205,15 @@ void ColorinterpFilter::ready(PointTableRef table)
     m_raster->readBand(m_redBand, 1);
     m_raster->readBand(m_greenBand, 2);
     m_raster->readBand(m_blueBand, 3);
+
+    // Reverse the ramp here rather than for each point.
+    if (m_invertRamp)
+    {
+        std::reverse(m_redBand.begin(), m_redBand.end());
+        std::reverse(m_greenBand.begin(), m_greenBand.end());
+        std::reverse(m_blueBand.begin(), m_blueBand.end());
+    }
+    setRange();
 }
 
 
@@ -238,34 +287,62 @@ void ColorinterpFilter::filter(PointView& view)
     // compute them.
     else if (std::isnan(m_min) || std::isnan(m_max))
     {
-        stats::Summary summary(Dimension::name(m_interpDim),
-            stats::Summary::NoEnum, false);
-        for (PointId idx = 0; idx < view.size(); ++idx)
+        double lo = (std::numeric_limits<double>::max)();
+        double hi = std::numeric_limits<double>::lowest();
+        std::vector<double> values(view.size());
+        view.getFieldArray(m_interpDim, 0, view.size(), values.data());
+        for (double v : values)
         {
-            double v = view.getFieldAs<double>(m_interpDim, idx);
-            summary.insert(v);
+            lo = (std::min)(lo, v);
+            hi = (std::max)(hi, v);
         }
 
         if (std::isnan(m_min))
-            m_min = summary.minimum();
+            m_min = lo;
         if (std::isnan(m_max))
-            m_max = summary.maximum();
+            m_max = hi;
     }
-
-    PointRef point(view, 0);
-    for (PointId idx = 0; idx < view.size(); ++idx)
+    setRange();
+
+    // Color the points a block at a time.  The colors of points outside
+    // of the range are read and written back unchanged.
+    const point_count_t BlockSize = 4096;
+    std::vector<double> values(BlockSize);
+    std::vector<uint16_t> red(BlockSize);
+    std::vector<uint16_t> green(BlockSize);
+    std::vector<uint16_t> blue(BlockSize);
+    const size_t last = m_redBand.size() - 1;
+    for (PointId begin = 0; begin < view.size(); begin += BlockSize)
     {
-        point.setPointId(idx);
-        processOne(point);
+        point_count_t count = (std::min)(BlockSize, view.size() - begin);
+        view.getFieldArray(m_interpDim, begin, count, values.data());
+        view.getFieldArray(Dimension::Id::Red, begin, count, red.data());
+        view.getFieldArray(Dimension::Id::Green, begin, count, green.data());
+        view.getFieldArray(Dimension::Id::Blue, begin, count, blue.data());
+        for (point_count_t i = 0; i < count; ++i)
+        {
+            double v = values[i];
+            if (!(v >= m_min && v < m_max))
+                continue;
+            size_t position =
+                (std::min)((size_t)((v - m_min) * m_scale), last);
+            red[i] = m_redBand[position];
+            green[i] = m_greenBand[position];
+            blue[i] = m_blueBand[position];
+        }
+        view.setFieldArray(Dimension::Id::Red, begin, count, red.data());
+        view.setFieldArray(Dimension::Id::Green, begin, count, green.data());
+        view.setFieldArray(Dimension::Id::Blue, begin, count, blue.data());
     }
 }
 
 
-bool ColorinterpFilter::pipelineStreamable() const
+// Points can only be colored one at a time once the range is known.
+// Otherwise the filter runs on buffered points.
+bool ColorinterpFilter::canStream() const
 {
-    if (std::isnan(m_min) || std::isnan(m_max))
-        return false;
-    return Streamable::pipelineStreamable();
+    return !std::isnan(m_min) && !std::isnan(m_max) &&
+        m_stdDevThreshold == 0.0;
 }
 
 
@@ -274,16 +351,11 @@ bool ColorinterpFilter::processOne(PointRef& point)
     double v = point.getFieldAs<double>(m_interpDim);
 
     // Don't color points that aren't in the min/max range.
-    if (v < m_min || v >= m_max)
+    if (!(v >= m_min && v < m_max))
         return true;
 
-    double factor = (v - m_min) / (m_max - m_min);
-    size_t img_width = m_redBand.size();
-    size_t position = size_t(std::floor(factor * img_width));
-
-    if (m_invertRamp)
-        position = (img_width - 1) - position;
-
+    size_t position = (std::min)((size_t)((v - m_min) * m_scale),
+        m_redBand.size() - 1);
     point.setField(Dimension::Id::Red, m_redBand[position]);
     point.setField(Dimension::Id::Blue, m_blueBand[position]);
     point.setField(Dimension::Id::Green, m_greenBand[position]);
@@ -65,19 +65,23 @@ public:
         , m_stdDevThreshold(0.0)
         , m_useMAD(false)
         , m_madMultiplier(1.4862)
+        , m_headerRange(false)
+        , m_scale(0.0)
     {}
     ColorinterpFilter& operator=(const ColorinterpFilter&) = delete;
     ColorinterpFilter(const ColorinterpFilter&) = delete;
     std::string getName() const;
 
-    virtual bool pipelineStreamable() const;
 private:
     virtual void addArgs(ProgramArgs& args);
     virtual void filter(PointView& view);
     virtual void prepared(PointTableRef table);
     virtual void ready(PointTableRef table);
     virtual void addDimensions(PointLayoutPtr layout);
+    virtual bool canStream() const;
     virtual bool processOne(PointRef& point);
+    void headerRange();
+    void setRange();
 
     Dimension::Id m_interpDim;
     std::string m_interpDimString;
@@ -93,6 +97,9 @@ private:
     double m_stdDevThreshold;
     bool m_useMAD;
     double m_madMultiplier;
+    bool m_headerRange;
+    // Ramp positions per unit of the interpolated dimension.
+    double m_scale;
 };
 
 } // namespace pdal
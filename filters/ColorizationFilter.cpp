@@ -200,6 +200,10 @@ void ColorizationFilter::ready(PointTableRef table)
             throwError(m_raster->errorMsg());
         }
     }
+    for (auto& b : m_bands)
+        if (b.m_band < 1 || (int)b.m_band > m_raster->bandCount())
+            throwError("Band " + std::to_string(b.m_band) + " is not in "
+                "raster '" + m_rasterFilename + "'.");
 }
 
 
@@ -212,12 +216,10 @@ bool ColorizationFilter::processOne(PointRef& point)
 
     if (m_raster->read(x, y, data) == gdal::GDALError::None)
     {
-        int i(0);
         for (auto bi = m_bands.begin(); bi != m_bands.end(); ++bi)
         {
             BandInfo& b = *bi;
-            point.setField(b.m_dim, data[i] * b.m_scale);
-            ++i;
+            point.setField(b.m_dim, data[b.m_band - 1] * b.m_scale);
         }
         return true;
     }
@@ -225,13 +227,78 @@ bool ColorizationFilter::processOne(PointRef& point)
 }
 
 
+// Read the bands at the positions of a batch of points.  The raster
+// reads the positions block by block, so points in any order only read
+// each block once.
+void ColorizationFilter::readBands(const std::vector<double>& x,
+    const std::vector<double>& y, std::vector<bool>& found)
+{
+    found.assign(x.size(), true);
+    m_values.resize(m_bands.size());
+    for (size_t i = 0; i < m_bands.size(); ++i)
+        if (m_raster->read(x, y, m_bands[i].m_band, m_values[i], found) !=
+            gdal::GDALError::None)
+            throwError(m_raster->errorMsg());
+}
+
+
+void ColorizationFilter::processBatch(StreamPointTable& table,
+    PointId begin, PointId end, std::vector<bool>& keep)
+{
+    const point_count_t count = end - begin;
+    std::vector<double> x(count);
+    std::vector<double> y(count);
+    std::vector<bool> found;
+
+    table.getFieldArray(Dimension::Id::X, begin, count, x.data());
+    table.getFieldArray(Dimension::Id::Y, begin, count, y.data());
+    readBands(x, y, found);
+
+    PointRef point(table, begin);
+    for (point_count_t i = 0; i < count; ++i)
+    {
+        if (!keep[i])
+            continue;
+        if (!found[i])
+        {
+            keep[i] = false;
+            continue;
+        }
+        point.setPointId(begin + i);
+        for (size_t b = 0; b < m_bands.size(); ++b)
+            point.setField(m_bands[b].m_dim,
+                m_values[b][i] * m_bands[b].m_scale);
+    }
+}
+
+
 void ColorizationFilter::filter(PointView& view)
 {
-    PointRef point = view.point(0);
-    for (PointId idx = 0; idx < view.size(); ++idx)
+    // Points are colorized in large batches to limit the memory used for
+    // their positions and values.
+    const point_count_t BatchSize = 1 << 20;
+
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<bool> found;
+    for (PointId begin = 0; begin < view.size(); begin += BatchSize)
     {
-        point.setPointId(idx);
-        processOne(point);
+        const point_count_t count = (std::min)(BatchSize,
+            view.size() - begin);
+        x.resize(count);
+        y.resize(count);
+        view.getFieldArray(Dimension::Id::X, begin, count, x.data());
+        view.getFieldArray(Dimension::Id::Y, begin, count, y.data());
+        readBands(x, y, found);
+
+        for (point_count_t i = 0; i < count; ++i)
+        {
+            if (!found[i])
+                continue;
+            for (size_t b = 0; b < m_bands.size(); ++b)
+                view.setField(m_bands[b].m_dim, begin + i,
+                    m_values[b][i] * m_bands[b].m_scale);
+        }
     }
 }
 
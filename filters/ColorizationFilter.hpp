@@ -83,11 +83,16 @@ private:
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void ready(PointTableRef table);
     virtual bool processOne(PointRef& point);
+    virtual void processBatch(StreamPointTable& table, PointId begin,
+        PointId end, std::vector<bool>& keep);
     virtual void filter(PointView& view);
+    void readBands(const std::vector<double>& x, const std::vector<double>& y,
+        std::vector<bool>& found);
 
     StringList m_dimSpec;
     std::string m_rasterFilename;
     std::vector<BandInfo> m_bands;
+    std::vector<std::vector<double>> m_values;
 
     std::unique_ptr<gdal::Raster> m_raster;
 };
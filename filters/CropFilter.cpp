@@ -41,10 +41,13 @@
 #include <pdal/util/ProgramArgs.hpp>
 
 #include "private/Point.hpp"
-#include "private/pnp/GridPnp.hpp"
+#include "private/RTree.hpp"
 
-#include <sstream>
+#include <algorithm>
+#include <cmath>
 #include <cstdarg>
+#include <limits>
+#include <sstream>
 
 namespace pdal
 {
@@ -68,13 +71,6 @@ struct CropArgs
     std::vector<Polygon> m_polys;
 };
 
-CropFilter::ViewGeom::ViewGeom(const Polygon& poly) : m_poly(poly)
-{}
-
-CropFilter::ViewGeom::ViewGeom(ViewGeom&& vg) :
-    m_poly(std::move(vg.m_poly)), m_gridPnps(std::move(vg.m_gridPnps))
-{}
-
 std::string CropFilter::getName() const { return s_info.name; }
 
 CropFilter::CropFilter() : m_args(new CropArgs)
@@ -114,7 +110,7 @@ void CropFilter::initialize()
         {
             // Throws if invalid.
             poly.valid();
-            m_geoms.emplace_back(poly);
+            m_geoms.push_back(poly);
         }
     }
 
@@ -138,25 +134,61 @@ void CropFilter::ready(PointTableRef table)
                 "option.\n";
     }
     for (auto& geom : m_geoms)
-        geom.m_poly.setSpatialReference(m_args->m_assignedSrs);
+        geom.setSpatialReference(m_args->m_assignedSrs);
+    buildIndex();
+}
+
+
+bool CropFilter::pushdownBounds(BOX3D& bounds) const
+{
+    // If we keep points outside of the region, or the region may need to
+    // be reprojected to the coordinate system of the points, any point
+    // might be kept.
+    if (m_args->m_cropOutside || !m_args->m_assignedSrs.empty())
+        return true;
+
+    BOX2D region;
+    for (const Polygon& g : m_geoms)
+        region.grow(g.bounds().to2d());
+    for (const BOX2D& box : m_boxes)
+        region.grow(box);
+    const double d = m_args->m_distance;
+    for (const filter::Point& center : m_args->m_centers)
+        region.grow(BOX2D(center.x() - d, center.y() - d,
+            center.x() + d, center.y() + d));
+    if (region.empty())
+        return true;
+
+    // Cropping is done in two dimensions except for spherical regions,
+    // so Z isn't limited.
+    bounds.clip(BOX3D(region.minx, region.miny,
+        (std::numeric_limits<double>::lowest)(),
+        region.maxx, region.maxy, (std::numeric_limits<double>::max)()));
+    return true;
 }
 
 
 bool CropFilter::processOne(PointRef& point)
 {
-    for (auto& g : m_geoms)
-        for (auto& gridPnp : g.m_gridPnps)
-            if (crop(point, *gridPnp))
-                return true;
+    double x = point.getFieldAs<double>(Dimension::Id::X);
+    double y = point.getFieldAs<double>(Dimension::Id::Y);
 
-    for (auto& box : m_boxes)
-        if (crop(point, box))
-            return true;
+    // Only the regions whose bounds contain the point can cover it.
+    m_index->find(x, y, m_candidates);
+    if (!m_args->m_cropOutside)
+    {
+        for (size_t r : m_candidates)
+            if (covers(r, point))
+                return true;
+        return false;
+    }
 
-    for (auto& center: m_args->m_centers)
-        if (crop(point, center))
+    // A point outside of any region is kept.
+    if (m_candidates.size() < numRegions())
+        return true;
+    for (size_t r : m_candidates)
+        if (!covers(r, point))
             return true;
-
     return false;
 }
 
@@ -164,6 +196,7 @@ bool CropFilter::processOne(PointRef& point)
 void CropFilter::spatialReferenceChanged(const SpatialReference& srs)
 {
     transform(srs);
+    buildIndex();
 }
 
 
@@ -173,20 +206,12 @@ void CropFilter::transform(const SpatialReference& srs)
     {
         try
         {
-            geom.m_poly.transform(srs);
+            geom.transform(srs);
         }
         catch (pdal_error& err)
         {
             throwError(err.what());
         }
-        geom.m_gridPnps.clear();
-        std::vector<Polygon> polys = geom.m_poly.polygons();
-        for (auto& p : polys)
-        {
-            std::unique_ptr<GridPnp> gridPnp(new GridPnp(
-                p.exteriorRing(), p.interiorRings()));
-            geom.m_gridPnps.push_back(std::move(gridPnp));
-        }
     }
 
     // If we don't have any SRS, do nothing.
@@ -215,80 +240,94 @@ void CropFilter::transform(const SpatialReference& srs)
 
 PointViewSet CropFilter::run(PointViewPtr view)
 {
-    PointViewSet viewSet;
-
     transform(view->spatialReference());
-    for (auto& geom : m_geoms)
-    {
-        PointViewPtr outView = view->makeNew();
-        crop(geom, *view, *outView);
-        viewSet.insert(outView);
-    }
+    buildIndex();
 
-    for (auto& box : m_boxes)
-    {
-        PointViewPtr outView = view->makeNew();
-        crop(box, *view, *outView);
-        viewSet.insert(outView);
-    }
-
-    for (auto& point: m_args->m_centers)
-    {
-        PointViewPtr outView = view->makeNew();
-        crop(point, *view, *outView);
-        viewSet.insert(outView);
-    }
-
-    return viewSet;
+    std::vector<PointViewPtr> outViews;
+    for (size_t r = 0; r < numRegions(); ++r)
+        outViews.push_back(view->makeNew());
+    crop(*view, outViews);
+    return PointViewSet(outViews.begin(), outViews.end());
 }
 
 
-bool CropFilter::crop(const PointRef& point, const BOX2D& box)
+// Regions are numbered polygons first, then boxes, then circles/spheres,
+// which is the order of the output views.
+size_t CropFilter::numRegions() const
 {
-    double x = point.getFieldAs<double>(Dimension::Id::X);
-    double y = point.getFieldAs<double>(Dimension::Id::Y);
-
-    // Return true if we're keeping a point.
-    return (m_args->m_cropOutside != box.contains(x, y));
+    return m_geoms.size() + m_boxes.size() + m_args->m_centers.size();
 }
 
 
-void CropFilter::crop(const BOX2D& box, PointView& input, PointView& output)
+// Index the bounds of the regions so that a point is only tested against
+// the regions whose bounds contain it.
+void CropFilter::buildIndex()
 {
-    PointRef point = input.point(0);
-    for (PointId idx = 0; idx < input.size(); ++idx)
+    std::vector<BOX2D> bounds;
+    bounds.reserve(numRegions());
+    for (const Polygon& g : m_geoms)
+        bounds.push_back(g.bounds().to2d());
+    for (const BOX2D& box : m_boxes)
+        bounds.push_back(box);
+    for (const filter::Point& center : m_args->m_centers)
     {
-        point.setPointId(idx);
-        if (crop(point, box))
-            output.appendPoint(input, idx);
+        // Pad the box so that rounding can't leave out a point that the
+        // distance test would keep.
+        double d = m_args->m_distance + 1e-9 * (m_args->m_distance +
+            std::abs(center.x()) + std::abs(center.y()));
+        bounds.push_back(BOX2D(center.x() - d, center.y() - d,
+            center.x() + d, center.y() + d));
     }
+    m_index.reset(new RTree(bounds));
 }
 
 
-bool CropFilter::crop(const PointRef& point, GridPnp& g)
+// Determine if a region covers a point whose position is in the region's
+// bounds.
+bool CropFilter::covers(size_t region, const PointRef& point) const
 {
-    double x = point.getFieldAs<double>(Dimension::Id::X);
-    double y = point.getFieldAs<double>(Dimension::Id::Y);
-    return (m_args->m_cropOutside != g.inside(x, y));
+    if (region < m_geoms.size())
+        return m_geoms[region].covers(point);
+    region -= m_geoms.size();
+    // The bounds of a box are the box itself.
+    if (region < m_boxes.size())
+        return true;
+    region -= m_boxes.size();
+    return covers(point, m_args->m_centers[region]);
 }
 
 
-void CropFilter::crop(const ViewGeom& g, PointView& input, PointView& output)
+// Determine which of a set of points whose positions are in a region's
+// bounds the region covers.
+void CropFilter::covers(size_t region, PointView& view,
+    const std::vector<PointId>& ids, std::vector<bool>& in) const
 {
-    PointRef point = input.point(0);
-    for (auto& gridPnp : g.m_gridPnps)
+    if (region < m_geoms.size())
     {
-        for (PointId idx = 0; idx < input.size(); ++idx)
+        // Use the polygon's batched point-in-polygon test.
+        std::vector<double> x(ids.size());
+        std::vector<double> y(ids.size());
+        for (size_t i = 0; i < ids.size(); ++i)
         {
-            point.setPointId(idx);
-            if (crop(point, const_cast<GridPnp&>(*gridPnp)))
-                output.appendPoint(input, idx);
+            x[i] = view.getFieldAs<double>(Dimension::Id::X, ids[i]);
+            y[i] = view.getFieldAs<double>(Dimension::Id::Y, ids[i]);
         }
+        m_geoms[region].covers(x.data(), y.data(), ids.size(), in);
+        return;
+    }
+
+    in.resize(ids.size());
+    PointRef point(view, 0);
+    for (size_t i = 0; i < ids.size(); ++i)
+    {
+        point.setPointId(ids[i]);
+        in[i] = covers(region, point);
     }
 }
 
 
-bool CropFilter::crop(const PointRef& point, const filter::Point& center)
+bool CropFilter::covers(const PointRef& point,
+    const filter::Point& center) const
 {
     double x = point.getFieldAs<double>(Dimension::Id::X);
     double y = point.getFieldAs<double>(Dimension::Id::Y);
@@ -296,32 +335,80 @@ bool CropFilter::crop(const PointRef& point, const filter::Point& center)
     x = std::abs(x - center.x());
     y = std::abs(y - center.y());
     if (x > m_args->m_distance || y > m_args->m_distance)
-        return (m_args->m_cropOutside);
+        return false;
 
-    bool inside;
     if (center.is3d())
     {
         double z = point.getFieldAs<double>(Dimension::Id::Z);
         z = std::abs(z - center.z());
         if (z > m_args->m_distance)
-            return (m_args->m_cropOutside);
-        inside = (x * x + y * y + z * z < m_distance2);
+            return false;
+        return (x * x + y * y + z * z < m_distance2);
     }
-    else
-        inside = (x * x + y * y < m_distance2);
-    return (m_args->m_cropOutside != inside);
+    return (x * x + y * y < m_distance2);
 }
 
 
-void CropFilter::crop(const filter::Point& center, PointView& input,
-    PointView& output)
+// Crop the points of a view to all the regions in a single pass.  Each
+// point is tested only against the regions whose bounds contain it and is
+// appended to the output view of each region that keeps it.
+void CropFilter::crop(PointView& input, std::vector<PointViewPtr>& outputs)
 {
-    PointRef point = input.point(0);
-    for (PointId idx = 0; idx < input.size(); ++idx)
+    // The candidate points of each region are gathered a block at a time
+    // so that polygons can be tested with the batched test.
+    const point_count_t blockSize = 65536;
+
+    std::vector<std::vector<PointId>> candidates(outputs.size());
+    std::vector<size_t> touched;
+    std::vector<bool> in;
+    for (PointId start = 0; start < input.size(); start += blockSize)
     {
-        point.setPointId(idx);
-        if (crop(point, center))
-            output.appendPoint(input, idx);
+        PointId end = (std::min)(start + blockSize, input.size());
+        for (PointId idx = start; idx < end; ++idx)
+        {
+            double x = input.getFieldAs<double>(Dimension::Id::X, idx);
+            double y = input.getFieldAs<double>(Dimension::Id::Y, idx);
+            m_index->find(x, y, m_candidates);
+            for (size_t r : m_candidates)
+            {
+                if (candidates[r].empty())
+                    touched.push_back(r);
+                candidates[r].push_back(idx);
+            }
+        }
+
+        if (!m_args->m_cropOutside)
+        {
+            for (size_t r : touched)
+            {
+                const std::vector<PointId>& ids = candidates[r];
+                covers(r, input, ids, in);
+                for (size_t i = 0; i < ids.size(); ++i)
+                    if (in[i])
+                        outputs[r]->appendPoint(input, ids[i]);
+            }
+        }
+        else
+        {
+            // Every point goes to the view of each region that doesn't
+            // cover it.
+            for (size_t r = 0; r < outputs.size(); ++r)
+            {
+                const std::vector<PointId>& ids = candidates[r];
+                covers(r, input, ids, in);
+                size_t i = 0;
+                for (PointId idx = start; idx < end; ++idx)
+                {
+                    if (i < ids.size() && ids[i] == idx && in[i++])
+                        continue;
+                    outputs[r]->appendPoint(input, idx);
+                }
+            }
+        }
+
+        for (size_t r : touched)
+            candidates[r].clear();
+        touched.clear();
     }
 }
 
@@ -45,7 +45,7 @@ namespace pdal
 {
 
 class ProgramArgs;
-class GridPnp;
+class RTree;
 struct CropArgs;
 namespace filter
 {
@@ -63,35 +63,35 @@ public:
     std::string getName() const;
 
 private:
-    // This is just a way to marry a (multi)polygon with a list of its
-    // GridPnp's that do the actual point-in-polygon operation.
-    struct ViewGeom
-    {
-        ViewGeom(const Polygon& poly);
-        ViewGeom(ViewGeom&& vg);
-
-        Polygon m_poly;
-        std::vector<std::unique_ptr<GridPnp>> m_gridPnps;
-    };
     std::unique_ptr<CropArgs> m_args;
     double m_distance2;
-    std::vector<ViewGeom> m_geoms;
+    std::vector<Polygon> m_geoms;
     std::vector<BOX2D> m_boxes;
+    std::unique_ptr<RTree> m_index;
+    std::vector<size_t> m_candidates;
 
     void addArgs(ProgramArgs& args);
     virtual void initialize();
 
     virtual void ready(PointTableRef table);
+    virtual bool dimensionsUsed(PointLayoutPtr,
+        Dimension::IdList& dims) const
+    {
+        dims.insert(dims.end(),
+            { Dimension::Id::X, Dimension::Id::Y, Dimension::Id::Z });
+        return true;
+    }
+    virtual bool pushdownBounds(BOX3D& bounds) const;
     virtual void spatialReferenceChanged(const SpatialReference& srs);
     virtual bool processOne(PointRef& point);
     virtual PointViewSet run(PointViewPtr view);
-    bool crop(const PointRef& point, const BOX2D& box);
-    void crop(const BOX2D& box, PointView& input, PointView& output);
-    bool crop(const PointRef& point, GridPnp& g);
-    void crop(const ViewGeom& g, PointView& input, PointView& output);
-    bool crop(const PointRef& point, const filter::Point& center);
-    void crop(const filter::Point& center, PointView& input,
-        PointView& output);
+    size_t numRegions() const;
+    void buildIndex();
+    bool covers(size_t region, const PointRef& point) const;
+    void covers(size_t region, PointView& view,
+        const std::vector<PointId>& ids, std::vector<bool>& in) const;
+    bool covers(const PointRef& point, const filter::Point& center) const;
+    void crop(PointView& input, std::vector<PointViewPtr>& outputs);
     void transform(const SpatialReference& srs);
 
     CropFilter& operator=(const CropFilter&); // not implemented
@@ -136,11 +136,36 @@ PointViewSet DEMFilter::run(PointViewPtr inView)
 
     PointViewPtr outView = inView->makeNew();
 
-    for (PointId i = 0; i < inView->size(); ++i)
+    // Read the raster for large batches of points at once, so that each
+    // block of the raster is read once per batch.
+    const point_count_t BatchSize = 1 << 20;
+
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> values;
+    std::vector<bool> found;
+    for (PointId begin = 0; begin < inView->size(); begin += BatchSize)
     {
-        PointRef point = inView->point(i);
-        if (processOne(point))
-            outView->appendPoint(*inView, i);
+        const point_count_t count = (std::min)(BatchSize,
+            inView->size() - begin);
+        x.resize(count);
+        y.resize(count);
+        inView->getFieldArray(Dimension::Id::X, begin, count, x.data());
+        inView->getFieldArray(Dimension::Id::Y, begin, count, y.data());
+        if (m_raster->read(x, y, m_args->m_band, values, found) !=
+            gdal::GDALError::None)
+            throwError(m_raster->errorMsg());
+
+        for (point_count_t i = 0; i < count; ++i)
+        {
+            if (!found[i])
+                continue;
+            double z = inView->getFieldAs<double>(m_args->m_dim, begin + i);
+            double lb = values[i] - m_args->m_range.m_lower_bound;
+            double ub = values[i] + m_args->m_range.m_upper_bound;
+            if (z >= lb && z <= ub)
+                outView->appendPoint(*inView, begin + i);
+        }
     }
 
     viewSet.insert(outView);
@@ -60,9 +60,26 @@ void DecimationFilter::addArgs(ProgramArgs& args)
         m_limit, (std::numeric_limits<point_count_t>::max)());
 }
 
+// Keeping points by position alone lets readers skip the points between
+// those kept rather than reading them.
+bool DecimationFilter::pushdownSelection(PointSelection& selection) const
+{
+    if (m_step == 0)
+        return false;
+    selection.select(m_offset, m_step, m_limit);
+    return true;
+}
+
+
 PointViewSet DecimationFilter::run(PointViewPtr inView)
 {
     PointViewSet viewSet;
+    // The reader has already dropped the points that aren't kept.
+    if (m_pushed)
+    {
+        viewSet.insert(inView);
+        return viewSet;
+    }
     PointViewPtr outView = inView->makeNew();
     decimate(*inView.get(), *outView.get());
     viewSet.insert(outView);
@@ -72,6 +89,9 @@ PointViewSet DecimationFilter::run(PointViewPtr inView)
 
 bool DecimationFilter::processOne(PointRef& point)
 {
+    if (m_pushed)
+        return true;
+
     bool keep = true;
     if (m_index < m_offset || m_index >= m_limit)
         keep = false;
@@ -85,6 +105,8 @@ bool DecimationFilter::processOne(PointRef& point)
 void DecimationFilter::decimate(PointView& input, PointView& output)
 {
     PointId last_idx = (std::min)(m_limit, input.size());
+    if (last_idx > m_offset)
+        output.reserve((last_idx - m_offset - 1) / m_step + 1);
     for (PointId idx = m_offset; idx < last_idx; idx += m_step)
         output.appendPoint(input, idx);
 }
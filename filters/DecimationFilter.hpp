@@ -44,7 +44,7 @@ namespace pdal
 class PDAL_DLL DecimationFilter : public Filter, public Streamable
 {
 public:
-    DecimationFilter()
+    DecimationFilter() : m_pushed(false)
         {}
 
     std::string getName() const;
@@ -54,8 +54,14 @@ private:
     uint32_t m_offset;
     point_count_t m_limit;
     PointId m_index;
+    bool m_pushed;
 
     virtual void addArgs(ProgramArgs& args);
+    virtual bool dimensionsUsed(PointLayoutPtr, Dimension::IdList&) const
+        { return true; }
+    virtual bool pushdownSelection(PointSelection& selection) const;
+    virtual void selectionPushedDown()
+        { m_pushed = true; }
     void ready(PointTableRef table)
         { m_index = 0; }
     bool processOne(PointRef& point);
@@ -33,9 +33,18 @@
 ****************************************************************************/
 
 #include <cstddef> // NULL
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+
 #include "DelaunayFilter.hpp"
 #include "private/delaunator.hpp"
 
+#include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
 namespace pdal
 {
 
@@ -53,39 +62,443 @@ std::string DelaunayFilter::getName() const
     return s_info.name;
 }
 
+namespace
+{
+
+const point_count_t BlockSize = 4096;
+
+// Find the circumcircle of a triangle.  Returns false if the points are
+// collinear.
+bool circumcircle(const double *a, const double *b, const double *c,
+    double& cx, double& cy, double& r)
+{
+    const double bx = b[0] - a[0];
+    const double by = b[1] - a[1];
+    const double qx = c[0] - a[0];
+    const double qy = c[1] - a[1];
+    const double d = 2 * (bx * qy - by * qx);
+    if (d == 0)
+        return false;
+
+    const double bl = bx * bx + by * by;
+    const double ql = qx * qx + qy * qy;
+    const double x = (qy * bl - by * ql) / d;
+    const double y = (bx * ql - qx * bl) / d;
+    cx = a[0] + x;
+    cy = a[1] + y;
+    r = std::sqrt(x * x + y * y);
+    return std::isfinite(r);
+}
+
+inline std::size_t nextHalfedge(std::size_t e)
+{
+    return (e % 3 == 2) ? e - 2 : e + 1;
+}
+
+// Points sorted by tile, with their positions stored as floats relative to
+// the corner of their tile.
+struct TiledPoints
+{
+    double m_minx;
+    double m_miny;
+    double m_tileSize;
+    std::size_t m_cols;
+    std::size_t m_rows;
+    // Position of the first point of each tile, and one past the last.
+    std::vector<std::size_t> m_offsets;
+    std::vector<PointId> m_ids;
+    std::vector<float> m_x;
+    std::vector<float> m_y;
+
+    // Position of a point relative to the minimum of the bounds.  The same
+    // point always has exactly the same position.
+    void position(std::size_t tile, std::size_t pos, double *xy) const
+    {
+        xy[0] = (double)m_x[pos] + (tile % m_cols) * m_tileSize;
+        xy[1] = (double)m_y[pos] + (tile / m_cols) * m_tileSize;
+    }
+};
+
+// Results of triangulating a tile.  Vertices are positions in TiledPoints.
+struct TileMesh
+{
+    // Triangles that are part of the triangulation of all the points.
+    std::vector<std::size_t> m_final;
+    // Directed edges of final triangles whose neighbor across the edge isn't
+    // final.
+    std::vector<std::pair<std::size_t, std::size_t>> m_boundary;
+};
+
+} // unnamed namespace
+
+
+void DelaunayFilter::addArgs(ProgramArgs& args)
+{
+    args.add("tile_size", "Size of the square tiles that are triangulated "
+        "in parallel.  If 0, all the points are triangulated at once",
+        m_tileSize, 0.0);
+}
+
+
+void DelaunayFilter::initialize()
+{
+    if (m_tileSize < 0)
+        throwError("Option 'tile_size' must not be negative.");
+}
+
+
 PointViewSet DelaunayFilter::run(PointViewPtr pointView)
 {
     // Returns NULL if the mesh already exists
     TriangularMesh *mesh = pointView->createMesh("delaunay2d");
-    
+
     if (mesh != NULL)
     {
-        std::vector<double> delaunayPoints;
-        for (PointId i = 0; i < pointView->size(); i++)
+        if (m_tileSize == 0 || !triangulateTiles(*pointView, *mesh))
+            triangulate(*pointView, *mesh);
+    }
+
+    PointViewSet viewSet;
+    viewSet.insert(pointView);
+
+    return viewSet;
+}
+
+
+void DelaunayFilter::triangulate(PointView& view, TriangularMesh& mesh)
+{
+    const point_count_t count = view.size();
+    std::vector<double> delaunayPoints(count * 2);
+    std::vector<double> x(BlockSize);
+    std::vector<double> y(BlockSize);
+    for (PointId idx = 0; idx < count; idx += BlockSize)
+    {
+        const point_count_t n = (std::min)(BlockSize, count - idx);
+        view.getFieldArray(Dimension::Id::X, idx, n, x.data());
+        view.getFieldArray(Dimension::Id::Y, idx, n, y.data());
+        for (point_count_t i = 0; i < n; ++i)
         {
-            PointRef point(*pointView, i);
-            double x(point.getFieldAs<double>(Dimension::Id::X));
-            double y(point.getFieldAs<double>(Dimension::Id::Y));
-            
-            delaunayPoints.push_back(x);
-            delaunayPoints.push_back(y);
+            delaunayPoints[2 * (idx + i)] = x[i];
+            delaunayPoints[2 * (idx + i) + 1] = y[i];
         }
-        
-        // Actually perform the triangulation
-        delaunator::Delaunator triangulation(delaunayPoints);
-        
-        for (std::size_t i = 0; i < triangulation.triangles.size(); i += 3)
+    }
+
+    // Actually perform the triangulation
+    delaunator::Delaunator triangulation(delaunayPoints);
+    const std::vector<std::size_t>& tri = triangulation.triangles;
+    for (std::size_t i = 0; i < tri.size(); i += 3)
+        mesh.add(tri[i + 2], tri[i + 1], tri[i]);
+}
+
+
+// Triangulate the points of each tile in parallel.  A triangle of a tile
+// whose circumcircle lies inside the tile is part of the triangulation of
+// all the points, since the tile holds all the points that could be in
+// the circle.  The other triangles are replaced by triangulating the
+// vertices along the seams: the vertices of the other triangles and
+// those on the hull of each tile.  Seam triangles in the area already
+// covered by final triangles are discarded, found by filling outward from
+// the edges that bound the final triangles.  Returns false if the tiles
+// can't be stitched consistently, in which case the points should be
+// triangulated at once.
+bool DelaunayFilter::triangulateTiles(PointView& view, TriangularMesh& out)
+{
+    const point_count_t count = view.size();
+    if (count < 3)
+        return false;
+
+    std::vector<double> x(BlockSize);
+    std::vector<double> y(BlockSize);
+
+    TiledPoints pts;
+    pts.m_tileSize = m_tileSize;
+    pts.m_minx = (std::numeric_limits<double>::max)();
+    pts.m_miny = (std::numeric_limits<double>::max)();
+    double maxx = (std::numeric_limits<double>::lowest)();
+    double maxy = (std::numeric_limits<double>::lowest)();
+    for (PointId idx = 0; idx < count; idx += BlockSize)
+    {
+        const point_count_t n = (std::min)(BlockSize, count - idx);
+        view.getFieldArray(Dimension::Id::X, idx, n, x.data());
+        view.getFieldArray(Dimension::Id::Y, idx, n, y.data());
+        for (point_count_t i = 0; i < n; ++i)
         {
-            mesh->add(triangulation.triangles[i+2],
-                triangulation.triangles[i+1],
-                triangulation.triangles[i]);
+            pts.m_minx = (std::min)(pts.m_minx, x[i]);
+            pts.m_miny = (std::min)(pts.m_miny, y[i]);
+            maxx = (std::max)(maxx, x[i]);
+            maxy = (std::max)(maxy, y[i]);
         }
     }
-    
-    PointViewSet viewSet;
-    viewSet.insert(pointView);
-    
-    return viewSet;
+
+    const double cols = std::floor((maxx - pts.m_minx) / m_tileSize) + 1;
+    const double rows = std::floor((maxy - pts.m_miny) / m_tileSize) + 1;
+    if (!(cols * rows <= (double)count))
+    {
+        log()->get(LogLevel::Debug) << "Tile size too small for the extent "
+            "of the points.  Triangulating all points at once." << std::endl;
+        return false;
+    }
+    pts.m_cols = (std::size_t)cols;
+    pts.m_rows = (std::size_t)rows;
+    const std::size_t numTiles = pts.m_cols * pts.m_rows;
+
+    auto tileOf = [&pts](double px, double py)
+    {
+        std::size_t c = (std::size_t)((px - pts.m_minx) / pts.m_tileSize);
+        std::size_t r = (std::size_t)((py - pts.m_miny) / pts.m_tileSize);
+        c = (std::min)(c, pts.m_cols - 1);
+        r = (std::min)(r, pts.m_rows - 1);
+        return r * pts.m_cols + c;
+    };
+
+    // Sort the points by tile.
+    std::vector<uint32_t> tiles(count);
+    pts.m_offsets.assign(numTiles + 1, 0);
+    for (PointId idx = 0; idx < count; idx += BlockSize)
+    {
+        const point_count_t n = (std::min)(BlockSize, count - idx);
+        view.getFieldArray(Dimension::Id::X, idx, n, x.data());
+        view.getFieldArray(Dimension::Id::Y, idx, n, y.data());
+        for (point_count_t i = 0; i < n; ++i)
+        {
+            tiles[idx + i] = (uint32_t)tileOf(x[i], y[i]);
+            pts.m_offsets[tiles[idx + i] + 1]++;
+        }
+    }
+    for (std::size_t t = 0; t < numTiles; ++t)
+        pts.m_offsets[t + 1] += pts.m_offsets[t];
+
+    std::vector<std::size_t> next(pts.m_offsets.begin(),
+        pts.m_offsets.end() - 1);
+    pts.m_ids.resize(count);
+    pts.m_x.resize(count);
+    pts.m_y.resize(count);
+    for (PointId idx = 0; idx < count; idx += BlockSize)
+    {
+        const point_count_t n = (std::min)(BlockSize, count - idx);
+        view.getFieldArray(Dimension::Id::X, idx, n, x.data());
+        view.getFieldArray(Dimension::Id::Y, idx, n, y.data());
+        for (point_count_t i = 0; i < n; ++i)
+        {
+            const uint32_t t = tiles[idx + i];
+            const std::size_t pos = next[t]++;
+            pts.m_ids[pos] = idx + i;
+            pts.m_x[pos] = (float)(x[i] - pts.m_minx -
+                (t % pts.m_cols) * m_tileSize);
+            pts.m_y[pos] = (float)(y[i] - pts.m_miny -
+                (t / pts.m_cols) * m_tileSize);
+        }
+    }
+    std::vector<uint32_t>().swap(tiles);
+
+    // Triangulate each tile.  Each tile only sets the seam flags of its
+    // own points.
+    std::vector<char> seam(count, 0);
+    std::vector<TileMesh> meshes(numTiles);
+    parallelFor(numTiles, [&]()
+    {
+        return [&](std::size_t t)
+        {
+            const std::size_t begin = pts.m_offsets[t];
+            const std::size_t n = pts.m_offsets[t + 1] - begin;
+            if (n == 0)
+                return;
+
+            std::vector<double> coords(2 * n);
+            for (std::size_t i = 0; i < n; ++i)
+                pts.position(t, begin + i, coords.data() + 2 * i);
+
+            std::unique_ptr<delaunator::Delaunator> d;
+            if (n >= 3)
+            {
+                try
+                {
+                    d.reset(new delaunator::Delaunator(coords));
+                }
+                catch (const std::runtime_error&)
+                {}
+            }
+            if (!d)
+            {
+                std::fill(seam.begin() + begin, seam.begin() + begin + n, 1);
+                return;
+            }
+
+            const double x0 = (t % pts.m_cols) * m_tileSize;
+            const double y0 = (t / pts.m_cols) * m_tileSize;
+            const double x1 = x0 + m_tileSize;
+            const double y1 = y0 + m_tileSize;
+
+            const std::vector<std::size_t>& tri = d->triangles;
+            const std::size_t numTri = tri.size() / 3;
+            std::vector<char> isFinal(numTri);
+            for (std::size_t i = 0; i < numTri; ++i)
+            {
+                double cx, cy, r;
+                isFinal[i] = circumcircle(&coords[2 * tri[3 * i]],
+                    &coords[2 * tri[3 * i + 1]], &coords[2 * tri[3 * i + 2]],
+                    cx, cy, r) &&
+                    cx - r > x0 && cx + r < x1 && cy - r > y0 && cy + r < y1;
+            }
+
+            TileMesh& mesh = meshes[t];
+            for (std::size_t i = 0; i < numTri; ++i)
+            {
+                if (!isFinal[i])
+                {
+                    for (std::size_t k = 0; k < 3; ++k)
+                        seam[begin + tri[3 * i + k]] = 1;
+                    continue;
+                }
+                for (std::size_t k = 0; k < 3; ++k)
+                {
+                    const std::size_t e = 3 * i + k;
+                    mesh.m_final.push_back(begin + tri[e]);
+                    const std::size_t opp = d->halfedges[e];
+                    if (opp == delaunator::INVALID_INDEX || !isFinal[opp / 3])
+                        mesh.m_boundary.emplace_back(begin + tri[e],
+                            begin + tri[nextHalfedge(e)]);
+                }
+            }
+
+            // Vertices on the hull of the tile are on the seam.
+            for (std::size_t e = 0; e < tri.size(); ++e)
+                if (d->halfedges[e] == delaunator::INVALID_INDEX)
+                {
+                    seam[begin + tri[e]] = 1;
+                    seam[begin + tri[nextHalfedge(e)]] = 1;
+                }
+        };
+    }, 1);
+
+    // Triangulate the seam.
+    std::vector<std::size_t> seamPos;
+    for (std::size_t pos = 0; pos < count; ++pos)
+        if (seam[pos])
+            seamPos.push_back(pos);
+    std::vector<char>().swap(seam);
+
+    std::vector<std::size_t> seamTri;
+    bool haveFinal = false;
+    for (const TileMesh& mesh : meshes)
+        haveFinal |= !mesh.m_final.empty();
+
+    if (seamPos.size())
+    {
+        const std::size_t m = seamPos.size();
+        if (m < 3)
+            return false;
+
+        // Tile of each seam point, found from the sorted offsets.
+        std::vector<double> coords(2 * m);
+        std::size_t t = 0;
+        for (std::size_t i = 0; i < m; ++i)
+        {
+            while (pts.m_offsets[t + 1] <= seamPos[i])
+                t++;
+            pts.position(t, seamPos[i], coords.data() + 2 * i);
+        }
+
+        std::unique_ptr<delaunator::Delaunator> d;
+        try
+        {
+            d.reset(new delaunator::Delaunator(coords));
+        }
+        catch (const std::runtime_error&)
+        {
+            return false;
+        }
+        const std::vector<std::size_t>& tri = d->triangles;
+
+        auto local = [&seamPos](std::size_t pos, std::size_t& i)
+        {
+            auto it = std::lower_bound(seamPos.begin(), seamPos.end(), pos);
+            if (it == seamPos.end() || *it != pos)
+                return false;
+            i = it - seamPos.begin();
+            return true;
+        };
+
+        std::unordered_map<uint64_t, std::size_t> edges;
+        for (std::size_t e = 0; e < tri.size(); ++e)
+            edges[(uint64_t)tri[e] * m + tri[nextHalfedge(e)]] = e;
+
+        // Label the seam triangles on either side of the edges bounding
+        // the final triangles, and block filling across those edges.
+        enum : char { Unknown, Final, Seam };
+        std::vector<char> label(tri.size() / 3, Unknown);
+        std::vector<char> blocked(tri.size(), 0);
+        std::vector<std::size_t> stack;
+        auto setLabel = [&label, &stack](std::size_t i, char l)
+        {
+            if (label[i] == Unknown)
+            {
+                label[i] = l;
+                stack.push_back(i);
+            }
+            return label[i] == l;
+        };
+
+        for (const TileMesh& mesh : meshes)
+            for (const auto& edge : mesh.m_boundary)
+            {
+                std::size_t a, b;
+                if (!local(edge.first, a) || !local(edge.second, b))
+                    return false;
+                auto it = edges.find((uint64_t)a * m + b);
+                if (it == edges.end())
+                    return false;
+                const std::size_t e = it->second;
+                blocked[e] = 1;
+                if (!setLabel(e / 3, Final))
+                    return false;
+                const std::size_t opp = d->halfedges[e];
+                if (opp != delaunator::INVALID_INDEX)
+                {
+                    blocked[opp] = 1;
+                    if (!setLabel(opp / 3, Seam))
+                        return false;
+                }
+            }
+
+        while (stack.size())
+        {
+            const std::size_t i = stack.back();
+            stack.pop_back();
+            for (std::size_t e = 3 * i; e < 3 * i + 3; ++e)
+            {
+                const std::size_t opp = d->halfedges[e];
+                if (blocked[e] || opp == delaunator::INVALID_INDEX)
+                    continue;
+                if (!setLabel(opp / 3, label[i]))
+                    return false;
+            }
+        }
+
+        for (std::size_t i = 0; i < label.size(); ++i)
+        {
+            // Without final triangles, the seam is the whole triangulation.
+            // Otherwise every part of it borders a final triangle.
+            if (label[i] == Unknown && haveFinal)
+                return false;
+            if (label[i] != Final)
+                for (std::size_t k = 0; k < 3; ++k)
+                    seamTri.push_back(seamPos[tri[3 * i + k]]);
+        }
+    }
+
+    // Release the triangles of each tile once they're in the mesh.
+    auto addTriangles = [&pts, &out](std::vector<std::size_t>& tri)
+    {
+        for (std::size_t i = 0; i < tri.size(); i += 3)
+            out.add(pts.m_ids[tri[i + 2]], pts.m_ids[tri[i + 1]],
+                pts.m_ids[tri[i]]);
+        std::vector<std::size_t>().swap(tri);
+    };
+    for (TileMesh& mesh : meshes)
+        addTriangles(mesh.m_final);
+    addTriangles(seamTri);
+    return true;
 }
 
 } // namespace pdal
@@ -47,8 +47,17 @@ public:
     std::string getName() const;
 
 private:
+    virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
     virtual PointViewSet run(PointViewPtr view);
 
+    // Add the triangles to the mesh, reversing the order of the vertices
+    // produced by delaunator.
+    void triangulate(PointView& view, TriangularMesh& mesh);
+    bool triangulateTiles(PointView& view, TriangularMesh& mesh);
+
+    double m_tileSize;
+
     DelaunayFilter& operator=(const DelaunayFilter&); // not implemented
     DelaunayFilter(const DelaunayFilter&); // not implemented
 };
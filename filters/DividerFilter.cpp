@@ -87,6 +87,9 @@ void DividerFilter::addArgs(ProgramArgs& args)
     m_cntArg = &args.add("count", "Number of output views", m_size);
     m_capArg = &args.add("capacity", "Maximum number of points in each "
         "output view", m_size);
+    args.add("threads", "Number of threads on which the output views are "
+        "run through the filters that follow, up to filters.merge.  If 0, "
+        "each following filter runs the views in turn.", m_threads, 0);
 }
 
 
@@ -104,6 +107,8 @@ void DividerFilter::initialize()
     }
     if (m_capArg->set())
         m_sizeMode = SizeMode::Capacity;
+    if (m_threads < 0)
+        throwError("Option 'threads' must not be negative.");
 }
 
 
@@ -114,9 +119,13 @@ PointViewSet DividerFilter::run(PointViewPtr inView)
 
     PointViewSet result;
     std::vector<PointViewPtr> views;
+    // Each view gets at most this many points.
+    const point_count_t perView = inView->size() ?
+        ((inView->size() - 1) / m_size) + 1 : 0;
     for (point_count_t i = 0; i < m_size; ++i)
     {
         PointViewPtr v(inView->makeNew());
+        v->reserve(perView);
         views.push_back(v);
         result.insert(v);
     }
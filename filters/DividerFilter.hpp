@@ -44,7 +44,7 @@ class PDAL_DLL DividerFilter : public Filter
 public:
 
 public:
-    DividerFilter()
+    DividerFilter() : m_threads(0)
         {}
 
     std::string getName() const;
@@ -67,9 +67,12 @@ private:
     Mode m_mode;
     SizeMode m_sizeMode;
     point_count_t m_size;
+    int m_threads;
 
     virtual void addArgs(ProgramArgs& args);
     virtual void initialize();
+    virtual int branchThreads() const
+        { return m_threads; }
     virtual PointViewSet run(PointViewPtr view);
 
     DividerFilter& operator=(const DividerFilter&); // not implemented
@@ -39,7 +39,14 @@
 
 #include "ELMFilter.hpp"
 
-#include <map>
+#include <pdal/PointView.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+#include <pdal/private/RadixSort.hpp>
+
+#include <algorithm>
+#include <cmath>
 #include <string>
 
 namespace pdal
@@ -59,11 +66,20 @@ std::string ELMFilter::getName() const
     return s_info.name;
 }
 
+ELMFilter::ELMFilter() : Filter(), m_streaming(false), m_collecting(false)
+{}
+
+ELMFilter::~ELMFilter()
+{}
+
 void ELMFilter::addArgs(ProgramArgs& args)
 {
     args.add("cell", "Cell size", m_cell, 10.0);
     args.add("class", "Class to use for noise points", m_class, uint8_t(7));
     args.add("threshold", "Threshold value", m_threshold, 1.0);
+    args.add("stats", "File of cell statistics used to classify points in "
+        "stream mode.  If the file doesn't exist, it's written instead.",
+        m_statsFile);
 }
 
 void ELMFilter::addDimensions(PointLayoutPtr layout)
@@ -71,65 +87,267 @@ void ELMFilter::addDimensions(PointLayoutPtr layout)
     layout->registerDim(Dimension::Id::Classification);
 }
 
-void ELMFilter::filter(PointView& view)
+bool ELMFilter::Grid::key(double x, double y, uint64_t& key) const
+{
+    if (!(x >= m_minx && y >= m_miny))
+        return false;
+
+    size_t c = static_cast<size_t>(std::floor(x - m_minx) / m_cell);
+    size_t r = static_cast<size_t>(std::floor(y - m_miny) / m_cell);
+    if (c >= m_cols || r >= m_rows)
+        return false;
+    key = static_cast<uint64_t>(r) * m_cols + c;
+    return true;
+}
+
+ELMFilter::Grid ELMFilter::makeGrid(PointView& view) const
 {
     BOX2D bounds;
     view.calculateBounds(bounds);
 
-    size_t cols =
+    Grid grid;
+    grid.m_minx = bounds.minx;
+    grid.m_miny = bounds.miny;
+    grid.m_cell = m_cell;
+    grid.m_cols =
         static_cast<size_t>(((bounds.maxx - bounds.minx) / m_cell) + 1);
-    size_t rows =
+    grid.m_rows =
         static_cast<size_t>(((bounds.maxy - bounds.miny) / m_cell) + 1);
+    return grid;
+}
 
-    // Make an initial pass through the input PointView to index elevation
-    // values and PointIds by row and column.
-    std::map<uint32_t, std::multimap<double, PointId>> hash;
-    for (PointId id = 0; id < view.size(); ++id)
-    {
-        double x = view.getFieldAs<double>(Dimension::Id::X, id);
-        double y = view.getFieldAs<double>(Dimension::Id::Y, id);
-        double z = view.getFieldAs<double>(Dimension::Id::Z, id);
-
-        size_t c = static_cast<size_t>(std::floor(x - bounds.minx) / m_cell);
-        size_t r = static_cast<size_t>(std::floor(y - bounds.miny) / m_cell);
-
-        hash[c * rows + r].emplace(z, id);
-    }
+// Find the low outliers of each cell.  Points are sorted by cell and the
+// cells are split into bands of rows that are searched on as many threads
+// as there are cores.
+std::vector<ELMFilter::CellNoise> ELMFilter::findNoise(PointView& view,
+    const Grid& grid) const
+{
+    using namespace Dimension;
 
-    // Count the number of points we classify as noise.
-    point_count_t num(0);
+    std::vector<CellNoise> cells;
+    const point_count_t n = view.size();
+    if (n == 0)
+        return cells;
 
-    // Make a second pass through the now rasterized PointView to compute the
-    // extended local minimum.
-    for (size_t c = 0; c < cols; ++c)
+    std::vector<uint64_t> keys(n);
+    std::vector<PointId> ids(n);
+    parallelFor(n, [&]()
     {
-        for (size_t r = 0; r < rows; ++r)
+        return [&](PointId id)
         {
-            std::multimap<double, PointId> ids(hash[c * rows + r]);
+            grid.key(view.getFieldAs<double>(Id::X, id),
+                view.getFieldAs<double>(Id::Y, id), keys[id]);
+            ids[id] = id;
+        };
+    });
 
-            if (ids.size() <= 1)
-                continue;
+    // The sort is stable, so the points of a cell stay in order.
+    int bytes = 1;
+    for (uint64_t k = (grid.m_cols * grid.m_rows - 1) >> 8; k; k >>= 8)
+        bytes++;
+    radixSort(keys, ids, bytes);
 
-            for (auto it = ids.begin(); it != std::prev(ids.end()); ++it)
+    const size_t bandRows = (std::max)((size_t)1,
+        grid.m_rows / (parallelThreads() * 4));
+    const size_t bands = (grid.m_rows + bandRows - 1) / bandRows;
+    auto bandStart = [&](size_t band)
+    {
+        const uint64_t key = static_cast<uint64_t>(
+            (std::min)(band * bandRows, grid.m_rows)) * grid.m_cols;
+        return static_cast<size_t>(
+            std::lower_bound(keys.begin(), keys.end(), key) - keys.begin());
+    };
+
+    std::vector<std::vector<CellNoise>> found(bands);
+    parallelFor(bands, [&]()
+    {
+        std::vector<std::pair<double, PointId>> cell;
+        return [&, cell](size_t band) mutable
+        {
+            const size_t end = bandStart(band + 1);
+            for (size_t i = bandStart(band); i < end;)
             {
-                // Where the current value is sufficiently close to the next, we
-                // consider that this is not a low outlier and break the current
-                // loop.
-                if (std::fabs(it->first - std::next(it)->first) < m_threshold)
-                    break;
-
-                // Otherwise this point is classified as noise, and we proceed
-                // to the next lowest value.
-                view.setField(Dimension::Id::Classification, it->second,
-                              m_class);
-                ++num;
+                cell.clear();
+                size_t j = i;
+                for (; j < end && keys[j] == keys[i]; ++j)
+                    cell.emplace_back(
+                        view.getFieldAs<double>(Id::Z, ids[j]), ids[j]);
+                std::stable_sort(cell.begin(), cell.end(),
+                    [](const std::pair<double, PointId>& a,
+                        const std::pair<double, PointId>& b)
+                    { return a.first < b.first; });
+
+                // Where a value is sufficiently close to the next, it isn't
+                // a low outlier and neither are the values above it.
+                // Otherwise the point is classified as noise, and we
+                // proceed to the next lowest value.
+                size_t noise = 0;
+                while (noise + 1 < cell.size() &&
+                    !(std::fabs(cell[noise].first - cell[noise + 1].first) <
+                        m_threshold))
+                    noise++;
+                if (noise)
+                {
+                    CellNoise c;
+                    c.m_key = keys[i];
+                    c.m_cutoff = cell[noise].first;
+                    for (size_t k = 0; k < noise; ++k)
+                        c.m_ids.push_back(cell[k].second);
+                    found[band].push_back(std::move(c));
+                }
+                i = j;
             }
+        };
+    }, 1);
+
+    for (auto& band : found)
+        for (CellNoise& c : band)
+            cells.push_back(std::move(c));
+    return cells;
+}
+
+void ELMFilter::filter(PointView& view)
+{
+    std::vector<CellNoise> cells = findNoise(view, makeGrid(view));
+
+    // Count the number of points we classify as noise.
+    point_count_t num(0);
+    for (const CellNoise& cell : cells)
+        for (PointId id : cell.m_ids)
+        {
+            view.setField(Dimension::Id::Classification, id, m_class);
+            ++num;
         }
-    }
 
     log()->get(LogLevel::Info)
         << "Classified " << num
         << " points as noise by Extended Local Minimum (ELM).\n";
 }
 
+void ELMFilter::ready(PointTableRef)
+{
+    m_streaming = false;
+    m_collecting = false;
+    m_cutoffs.clear();
+    m_passView.reset();
+    m_passTable.reset();
+}
+
+// The statistics file is only looked at once points are streamed, so that
+// it has no effect in standard mode.
+void ELMFilter::startStream()
+{
+    m_streaming = true;
+    if (FileUtils::fileExists(m_statsFile))
+        readStats();
+    else
+    {
+        m_collecting = true;
+        m_passTable.reset(new PointTable);
+        PointLayoutPtr layout = m_passTable->layout();
+        layout->registerDim(Dimension::Id::X);
+        layout->registerDim(Dimension::Id::Y);
+        layout->registerDim(Dimension::Id::Z);
+        m_passTable->finalize();
+        m_passView.reset(new PointView(*m_passTable));
+    }
+}
+
+// Points pass through unchanged while statistics are collected.  Once they
+// have been, a point is noise if it's below the cutoff of its cell.
+bool ELMFilter::processOne(PointRef& point)
+{
+    using namespace Dimension;
+
+    if (!m_streaming)
+        startStream();
+
+    const double x = point.getFieldAs<double>(Id::X);
+    const double y = point.getFieldAs<double>(Id::Y);
+    const double z = point.getFieldAs<double>(Id::Z);
+    if (m_collecting)
+    {
+        const PointId id = m_passView->size();
+        m_passView->setField(Id::X, id, x);
+        m_passView->setField(Id::Y, id, y);
+        m_passView->setField(Id::Z, id, z);
+        return true;
+    }
+
+    uint64_t key;
+    if (m_grid.key(x, y, key))
+    {
+        auto it = m_cutoffs.find(key);
+        if (it != m_cutoffs.end() && z < it->second)
+            point.setField(Id::Classification, m_class);
+    }
+    return true;
+}
+
+void ELMFilter::done(PointTableRef)
+{
+    if (m_collecting && m_passView->size())
+    {
+        m_grid = makeGrid(*m_passView);
+        writeStats(findNoise(*m_passView, m_grid));
+    }
+    m_passView.reset();
+    m_passTable.reset();
+}
+
+// Statistics are text: the grid, then the key and cutoff of each cell
+// that holds noise.
+void ELMFilter::writeStats(const std::vector<CellNoise>& cells)
+{
+    std::ostream *out = FileUtils::createFile(m_statsFile, false);
+    if (!out)
+        throwError("Unable to create statistics file '" + m_statsFile + "'.");
+
+    out->precision(17);
+    *out << "elm 1 " << m_cell << " " << m_threshold << " " <<
+        m_grid.m_minx << " " << m_grid.m_miny << " " << m_grid.m_cols <<
+        " " << m_grid.m_rows << " " << cells.size() << "\n";
+    for (const CellNoise& cell : cells)
+        *out << cell.m_key << " " << cell.m_cutoff << "\n";
+    const bool ok = out->good();
+    FileUtils::closeFile(out);
+    if (!ok)
+        throwError("Unable to write statistics file '" + m_statsFile + "'.");
+
+    log()->get(LogLevel::Info) << "Wrote statistics of " << cells.size() <<
+        " cells with noise to '" << m_statsFile << "'.  Points are "
+        "classified when the pipeline is run again.\n";
+}
+
+void ELMFilter::readStats()
+{
+    std::istream *in = FileUtils::openFile(m_statsFile, false);
+    if (!in)
+        throwError("Unable to open statistics file '" + m_statsFile + "'.");
+
+    std::string magic;
+    int version(0);
+    double cell(0);
+    double threshold(0);
+    size_t count(0);
+    *in >> magic >> version >> cell >> threshold >> m_grid.m_minx >>
+        m_grid.m_miny >> m_grid.m_cols >> m_grid.m_rows >> count;
+    m_grid.m_cell = cell;
+    for (size_t i = 0; i < count && in->good(); ++i)
+    {
+        uint64_t key;
+        double cutoff;
+        *in >> key >> cutoff;
+        m_cutoffs[key] = cutoff;
+    }
+    const bool ok = !in->fail();
+    FileUtils::closeFile(in);
+
+    if (!ok || magic != "elm" || version != 1)
+        throwError("Invalid statistics file '" + m_statsFile + "'.");
+    if (cell != m_cell || threshold != m_threshold)
+        throwError("Statistics file '" + m_statsFile + "' was written "
+            "with a different 'cell' or 'threshold'.");
+}
+
 } // namespace pdal
@@ -35,33 +35,84 @@
 #pragma once
 
 #include <pdal/Filter.hpp>
+#include <pdal/Streamable.hpp>
 
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace pdal
 {
 
 class PointLayout;
+class PointTable;
 class PointView;
 
-class PDAL_DLL ELMFilter : public Filter
+class PDAL_DLL ELMFilter : public Filter, public Streamable
 {
 public:
-    ELMFilter() : Filter()
-    {
-    }
+    ELMFilter();
+    ~ELMFilter();
 
     std::string getName() const;
 
 private:
+    // Cells of the raster, numbered by row.
+    struct Grid
+    {
+        double m_minx;
+        double m_miny;
+        double m_cell;
+        size_t m_cols;
+        size_t m_rows;
+
+        // Whether a position is in a cell, and if so, which one.
+        bool key(double x, double y, uint64_t& key) const;
+    };
+
+    // The points of a cell marked as noise, which are those below the
+    // cutoff.
+    struct CellNoise
+    {
+        uint64_t m_key;
+        double m_cutoff;
+        std::vector<PointId> m_ids;
+    };
+
     double m_cell;
     double m_threshold;
     uint8_t m_class;
+    std::string m_statsFile;
+
+    // Stream mode.  The first run keeps the positions of the points to
+    // find the cutoff of each cell.  The second classifies points using
+    // the cutoffs.
+    bool m_streaming;
+    bool m_collecting;
+    std::unique_ptr<PointTable> m_passTable;
+    PointViewPtr m_passView;
+    Grid m_grid;
+    std::unordered_map<uint64_t, double> m_cutoffs;
 
     virtual void addArgs(ProgramArgs& args);
     virtual void addDimensions(PointLayoutPtr layout);
+    virtual bool viewsRunConcurrently() const
+        { return true; }
+    virtual bool canStream() const
+        { return !m_statsFile.empty(); }
+    virtual void ready(PointTableRef table);
     virtual void filter(PointView& view);
+    virtual bool processOne(PointRef& point);
+    virtual void done(PointTableRef table);
+
+    Grid makeGrid(PointView& view) const;
+    std::vector<CellNoise> findNoise(PointView& view,
+        const Grid& grid) const;
+    void startStream();
+    void readStats();
+    void writeStats(const std::vector<CellNoise>& cells);
 
     ELMFilter& operator=(const ELMFilter&); // not implemented
     ELMFilter(const ELMFilter&);            // not implemented
@@ -79,25 +79,22 @@ void EigenvaluesFilter::filter(PointView& view)
     using namespace Eigen;
 
     KD3Index& kdi = view.build3dIndex();
+    const double *coords = kdi.coords();
 
-    for (PointId i = 0; i < view.size(); ++i)
+    // find the k-nearest neighbors
+    kdi.knnSearchAll(m_knn, [this, &view, coords](PointId i,
+        const std::vector<PointId>& ids, const std::vector<double>&)
     {
-        // find the k-nearest neighbors
-        auto ids = kdi.neighbors(i, m_knn);
-
-        // compute covariance of the neighborhood
-        auto B = eigen::computeCovariance(view, ids);
-
-        // perform the eigen decomposition
-        SelfAdjointEigenSolver<Matrix3f> solver(B);
-        if (solver.info() != Success)
+        // perform the eigen decomposition of the neighborhood covariance,
+        // reading the neighbors' positions from the index
+        Vector3f ev;
+        if (!eigen::computeCovarianceEigen(coords, ids, ev))
             throwError("Cannot perform eigen decomposition.");
-        auto ev = solver.eigenvalues();
 
         view.setField(m_e0, i, ev[0]);
         view.setField(m_e1, i, ev[1]);
         view.setField(m_e2, i, ev[2]);
-    }
+    });
 }
 
 } // namespace pdal
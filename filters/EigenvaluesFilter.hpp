@@ -63,6 +63,8 @@ private:
 
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void addArgs(ProgramArgs& args);
+    virtual bool viewsRunConcurrently() const
+        { return true; }
     virtual void filter(PointView& view);
 };
 
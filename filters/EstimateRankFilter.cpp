@@ -75,13 +75,12 @@ void EstimateRankFilter::filter(PointView& view)
 {
     KD3Index& kdi = view.build3dIndex();
 
-    for (PointId i = 0; i < view.size(); ++i)
+    // find the k-nearest neighbors
+    kdi.knnSearchAll(m_knn, [this, &view](PointId i,
+        const std::vector<PointId>& ids, const std::vector<double>&)
     {
-        // find the k-nearest neighbors
-        auto ids = kdi.neighbors(i, m_knn);
-
         view.setField(m_rank, i, eigen::computeRank(view, ids, m_thresh));
-    }
+    });
 }
 
 } // namespace pdal
@@ -127,13 +127,40 @@ bool FerryFilter::processOne(PointRef& point)
 }
 
 
+// Points that have been filtered out are copied along with the rest.
+// Nothing looks at them again and it's cheaper than picking them out.
+void FerryFilter::processBatch(StreamPointTable& table, PointId begin,
+    PointId end, std::vector<bool>& /*keep*/)
+{
+    const point_count_t count = end - begin;
+    std::vector<double> buf(count);
+
+    for (const auto& info : m_dims)
+    {
+        if (info.m_fromId == Dimension::Id::Unknown)
+            continue;
+        table.getFieldArray(info.m_fromId, begin, count, buf.data());
+        table.setFieldArray(info.m_toId, begin, count, buf.data());
+    }
+}
+
+
 void FerryFilter::filter(PointView& view)
 {
-    PointRef point(view, 0);
-    for (PointId id = 0; id < view.size(); ++id)
+    // Copy a block of each dimension at a time rather than point by point.
+    const point_count_t blockSize = 4096;
+    std::vector<double> buf(blockSize);
+
+    for (const auto& info : m_dims)
     {
-        point.setPointId(id);
-        processOne(point);
+        if (info.m_fromId == Dimension::Id::Unknown)
+            continue;
+        for (PointId idx = 0; idx < view.size(); idx += blockSize)
+        {
+            point_count_t count = (std::min)(blockSize, view.size() - idx);
+            view.getFieldArray(info.m_fromId, idx, count, buf.data());
+            view.setFieldArray(info.m_toId, idx, count, buf.data());
+        }
     }
 }
 
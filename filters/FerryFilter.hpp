@@ -69,7 +69,11 @@ private:
     virtual void initialize();
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void prepared(PointTableRef table);
+    virtual bool threadSafe() const
+        { return true; }
     virtual bool processOne(PointRef& point);
+    virtual void processBatch(StreamPointTable& table, PointId begin,
+        PointId end, std::vector<bool>& keep);
     virtual void filter(PointView& view);
 
     FerryFilter& operator=(const FerryFilter&) = delete;
@@ -36,8 +36,11 @@
  */
 
 #include <cassert>
+#include <memory>
+#include <unordered_map>
 
 #include <pdal/KDIndex.hpp>
+#include <pdal/util/ThreadPool.hpp>
 #include <filters/NormalFilter.hpp>
 
 #include "GreedyProjection.hpp"
@@ -54,6 +57,29 @@ static StaticPluginInfo const s_info
 
 CREATE_STATIC_STAGE(GreedyProjection, s_info)
 
+namespace
+{
+
+const point_count_t BlockSize = 4096;
+
+// Triangles grown over the points of one tile, as point IDs of the
+// full view.
+struct TileMesh
+{
+    TileMesh() : m_parts(0), m_nnn4fn(0), m_nnn4s(0)
+    {}
+
+    // Triangles that don't share an edge with any other tile.
+    std::vector<PointId> m_interior;
+    // Triangles with an edge whose points are also in other tiles.
+    std::vector<PointId> m_seam;
+    int m_parts;
+    int m_nnn4fn;
+    int m_nnn4s;
+};
+
+} // unnamed namespace
+
 std::string GreedyProjection::getName() const
 {
     return s_info.name;
@@ -74,6 +100,9 @@ void GreedyProjection::addArgs(ProgramArgs& args)
         maximum_angle_, 2 * M_PI / 3);  // 120 degrees default
     args.add("eps_angle", "Max normal difference angle for triangulation "
         "consideration", eps_angle_, M_PI / 4);
+    args.add("tile_size", "Size of the square tiles whose meshes are grown "
+        "in parallel.  If 0, a single mesh is grown over all points",
+        tile_size_, 0.0);
 }
 
 
@@ -92,6 +121,8 @@ void GreedyProjection::initialize()
     if (mu_ <= 0)
         throwError("Invalid distance multiplier of '" +
             std::to_string(mu_) + "'.  Must be greater than 0.");
+    if (tile_size_ < 0)
+        throwError("Option 'tile_size' must not be negative.");
 }
 
 Eigen::Vector3d GreedyProjection::getCoord(PointId id)
@@ -124,14 +155,267 @@ void GreedyProjection::addTriangle(PointId a, PointId b, PointId c)
 }
 
 
+void GreedyProjection::findNeighbors(PointId id, std::vector<PointId>& nnIdx,
+    std::vector<double>& sqrDists)
+{
+    if (nn_ids_.empty())
+    {
+        tree_->knnSearch(id, nnn_, &nnIdx, &sqrDists);
+        return;
+    }
+
+    const size_t pos = id * nnn_;
+    std::copy(nn_ids_.begin() + pos, nn_ids_.begin() + pos + nnn_,
+        nnIdx.begin());
+    std::copy(nn_dists_.begin() + pos, nn_dists_.begin() + pos + nnn_,
+        sqrDists.begin());
+}
+
+
 void GreedyProjection::filter(PointView& view)
 {
     NormalFilter().doFilter(view);
 
-    KD3Index& tree = view.build3dIndex();
-
     view_ = &view;
     mesh_ = view_->createMesh(getName());
+    nr_parts_ = 0;
+    increase_nnn4fn_ = 0;
+    increase_nnn4s_ = 0;
+    increase_dist_ = 0;
+    if (tile_size_ > 0)
+        triangulateTiles(view);
+    else
+    {
+        tree_ = &view.build3dIndex();
+        triangulate();
+        tree_ = nullptr;
+    }
+
+    log()->get(LogLevel::Debug) << "Number of triangles: " <<
+        mesh_->size() << ".\n";
+    log()->get(LogLevel::Debug) << "Number of unconnected parts: " <<
+        nr_parts_ << ".\n";
+    if (increase_nnn4fn_ > 0)
+        log()->get(LogLevel::Warning) << "Number of neighborhood size "
+            "increase requests for fringe neighbors: " << increase_nnn4fn_ <<
+            ".\n";
+    if (increase_nnn4s_ > 0)
+        log()->get(LogLevel::Warning) << "Number of neighborhood size "
+            "increase requests for source: " << increase_nnn4s_ << ".\n";
+    if (increase_dist_ > 0)
+        log()->get(LogLevel::Warning) << "Number of automatic maximum "
+            "distance increases: " << increase_dist_ << ".\n";
+    view_ = nullptr;
+}
+
+
+// Grow a mesh over each tile in parallel.  Each tile also holds the points
+// within twice the search radius of it, so it holds every vertex of the
+// triangles whose centroid is in the tile.  Edges are limited to about the
+// search radius, though the limit isn't strict.  Each tile keeps only the
+// triangles whose centroid is in it.  Neighbors are found for all the
+// points of a tile before its mesh is grown.
+//
+// Triangles near the tile edges are grown independently by neighboring
+// tiles and may not agree.  They're merged in tile order, dropping any
+// triangle that would give an edge more than two triangles, so the result
+// doesn't depend on how the tiles were scheduled.
+void GreedyProjection::triangulateTiles(PointView& view)
+{
+    const point_count_t count = view.size();
+    if (count < 3)
+        return;
+
+    std::vector<double> x(count);
+    std::vector<double> y(count);
+    for (PointId idx = 0; idx < count; idx += BlockSize)
+    {
+        const point_count_t n = (std::min)(BlockSize, count - idx);
+        view.getFieldArray(Dimension::Id::X, idx, n, x.data() + idx);
+        view.getFieldArray(Dimension::Id::Y, idx, n, y.data() + idx);
+    }
+    const double minx = *std::min_element(x.begin(), x.end());
+    const double miny = *std::min_element(y.begin(), y.end());
+    const double maxx = *std::max_element(x.begin(), x.end());
+    const double maxy = *std::max_element(y.begin(), y.end());
+
+    const double dcols = std::floor((maxx - minx) / tile_size_) + 1;
+    const double drows = std::floor((maxy - miny) / tile_size_) + 1;
+    if (!(dcols * drows <= (double)count))
+    {
+        log()->get(LogLevel::Debug) << "Tile size too small for the extent "
+            "of the points.  Growing a single mesh." << std::endl;
+        tree_ = &view.build3dIndex();
+        triangulate();
+        tree_ = nullptr;
+        return;
+    }
+    const size_t cols = (size_t)dcols;
+    const size_t rows = (size_t)drows;
+    const size_t numTiles = cols * rows;
+
+    auto colOf = [&](double px)
+    {
+        double c = std::floor((px - minx) / tile_size_);
+        return (size_t)Utils::clamp(c, 0.0, (double)(cols - 1));
+    };
+    auto rowOf = [&](double py)
+    {
+        double r = std::floor((py - miny) / tile_size_);
+        return (size_t)Utils::clamp(r, 0.0, (double)(rows - 1));
+    };
+    auto tileOf = [&](double px, double py)
+        { return rowOf(py) * cols + colOf(px); };
+
+    // Find the points of each tile and those that are in more than one.
+    const double radius = 2 * search_radius_;
+    std::vector<std::vector<PointId>> tileIds(numTiles);
+    std::vector<char> shared(count, 0);
+    for (PointId idx = 0; idx < count; ++idx)
+    {
+        const size_t c0 = colOf(x[idx] - radius);
+        const size_t c1 = colOf(x[idx] + radius);
+        const size_t r0 = rowOf(y[idx] - radius);
+        const size_t r1 = rowOf(y[idx] + radius);
+        for (size_t r = r0; r <= r1; ++r)
+            for (size_t c = c0; c <= c1; ++c)
+                tileIds[r * cols + c].push_back(idx);
+        shared[idx] = (c0 != c1 || r0 != r1);
+    }
+
+    std::vector<TileMesh> meshes(numTiles);
+    parallelFor(numTiles, [&]()
+    {
+        std::shared_ptr<GreedyProjection> gp(new GreedyProjection);
+        LogPtr quiet(new Log(getName(), "devnull"));
+        gp->setLog(quiet);
+        gp->mu_ = mu_;
+        gp->search_radius_ = search_radius_;
+        gp->minimum_angle_ = minimum_angle_;
+        gp->maximum_angle_ = maximum_angle_;
+        gp->eps_angle_ = eps_angle_;
+        gp->consistent_ = consistent_;
+        gp->consistent_ordering_ = consistent_ordering_;
+
+        return [&, gp](size_t t)
+        {
+            const std::vector<PointId>& ids = tileIds[t];
+            if (ids.size() < 3)
+                return;
+
+            PointViewPtr sub = view.makeNew();
+            for (PointId id : ids)
+                sub->appendPoint(view, id);
+            KD3Index tree(*sub);
+            tree.build();
+
+            const int k = (int)(std::min)((point_count_t)nnn_, sub->size());
+            gp->nnn_ = k;
+            gp->nn_ids_.resize(ids.size() * k);
+            gp->nn_dists_.resize(ids.size() * k);
+            std::vector<PointId> nnIdx(k);
+            std::vector<double> sqrDists(k);
+            for (PointId i = 0; i < ids.size(); ++i)
+            {
+                tree.knnSearch(i, k, &nnIdx, &sqrDists);
+                std::copy(nnIdx.begin(), nnIdx.end(),
+                    gp->nn_ids_.begin() + i * k);
+                std::copy(sqrDists.begin(), sqrDists.end(),
+                    gp->nn_dists_.begin() + i * k);
+            }
+
+            TriangularMesh mesh;
+            gp->view_ = sub.get();
+            gp->mesh_ = &mesh;
+            gp->tree_ = &tree;
+            gp->nr_parts_ = 0;
+            gp->increase_nnn4fn_ = 0;
+            gp->increase_nnn4s_ = 0;
+            gp->triangulate();
+            gp->view_ = nullptr;
+            gp->mesh_ = nullptr;
+            gp->tree_ = nullptr;
+
+            TileMesh& out = meshes[t];
+            out.m_parts = gp->nr_parts_;
+            out.m_nnn4fn = gp->increase_nnn4fn_;
+            out.m_nnn4s = gp->increase_nnn4s_;
+            for (size_t i = 0; i < mesh.size(); ++i)
+            {
+                const Triangle& tri = mesh[i];
+                const PointId a = ids[tri.m_a];
+                const PointId b = ids[tri.m_b];
+                const PointId c = ids[tri.m_c];
+                if (tileOf((x[a] + x[b] + x[c]) / 3,
+                        (y[a] + y[b] + y[c]) / 3) != t)
+                    continue;
+                std::vector<PointId>& dst =
+                    ((shared[a] && shared[b]) || (shared[b] && shared[c]) ||
+                    (shared[c] && shared[a])) ? out.m_seam : out.m_interior;
+                dst.insert(dst.end(), { a, b, c });
+            }
+        };
+    }, 1);
+
+    // Edges between shared points are the only ones that more than one tile
+    // can make, so only they need to be counted.
+    std::unordered_map<uint64_t, int> edgeUses;
+    auto edgeKey = [count](PointId a, PointId b)
+    {
+        if (a > b)
+            std::swap(a, b);
+        return (uint64_t)a * count + b;
+    };
+    auto addSeam = [&](PointId a, PointId b, PointId c)
+    {
+        const PointId v[] = { a, b, c };
+        for (int i = 0; i < 3; ++i)
+        {
+            PointId p = v[i];
+            PointId q = v[(i + 1) % 3];
+            if (shared[p] && shared[q] && edgeUses[edgeKey(p, q)] >= 2)
+                return false;
+        }
+        for (int i = 0; i < 3; ++i)
+        {
+            PointId p = v[i];
+            PointId q = v[(i + 1) % 3];
+            if (shared[p] && shared[q])
+                edgeUses[edgeKey(p, q)]++;
+        }
+        return true;
+    };
+
+    point_count_t dropped = 0;
+    for (TileMesh& m : meshes)
+    {
+        for (size_t i = 0; i < m.m_interior.size(); i += 3)
+            addTriangle(m.m_interior[i], m.m_interior[i + 1],
+                m.m_interior[i + 2]);
+        for (size_t i = 0; i < m.m_seam.size(); i += 3)
+        {
+            if (addSeam(m.m_seam[i], m.m_seam[i + 1], m.m_seam[i + 2]))
+                addTriangle(m.m_seam[i], m.m_seam[i + 1], m.m_seam[i + 2]);
+            else
+                dropped++;
+        }
+        nr_parts_ += m.m_parts;
+        increase_nnn4fn_ += m.m_nnn4fn;
+        increase_nnn4s_ += m.m_nnn4s;
+        // Release the tile's triangles once they're in the mesh.
+        std::vector<PointId>().swap(m.m_interior);
+        std::vector<PointId>().swap(m.m_seam);
+    }
+    log()->get(LogLevel::Debug) << "Grew meshes over " << numTiles <<
+        " tiles.  Dropped " << dropped << " conflicting triangles along "
+        "tile edges." << std::endl;
+}
+
+
+// Grow the mesh over the points of view_ into mesh_.
+void GreedyProjection::triangulate()
+{
+    PointView& view = *view_;
     const double sqr_mu = mu_ * mu_;
     const double sqr_max_edge = search_radius_*search_radius_;
 
@@ -196,7 +480,9 @@ void GreedyProjection::filter(PointView& view)
   // Initializing
   PointId isFree = 0;
   bool done = false;
-  int nr_parts=0, increase_nnn4fn=0, increase_nnn4s=0, increase_dist=0, nr_touched = 0;
+  int &nr_parts = nr_parts_, &increase_nnn4fn = increase_nnn4fn_,
+      &increase_nnn4s = increase_nnn4s_;
+  int nr_touched = 0;
   bool is_fringe;
   angles_.resize(nnn_);
   std::vector<Eigen::Vector2d, Eigen::aligned_allocator<Eigen::Vector2d> > uvn_nn (nnn_);
@@ -213,7 +499,7 @@ void GreedyProjection::filter(PointView& view)
       part_[R_] = part_index++;
 
       // creating starting triangle
-      tree.knnSearch(R_, nnn_, &nnIdx, &sqrDists);
+      findNeighbors(R_, nnIdx, sqrDists);
 
       double sqr_dist_threshold =
           (std::min)(sqr_max_edge, sqr_mu * sqrDists[1]);
@@ -352,9 +638,11 @@ void GreedyProjection::filter(PointView& view)
       while (not_found);
     }
 
-    // Set the index of the first free point in isFree.
+    // Set the index of the first free point in isFree.  Points never
+    // become free again, so there are none before the last one found.
     done = true;
-    auto it = std::find(state_.begin(), state_.end(), GP3Type::FREE);
+    auto it = std::find(state_.begin() + isFree, state_.end(),
+        GP3Type::FREE);
     if (it == state_.end())
         done = true;
     else
@@ -387,7 +675,7 @@ void GreedyProjection::filter(PointView& view)
         state_[R_] = GP3Type::COMPLETED;
         continue;
       }
-      tree.knnSearch(R_, nnn_, &nnIdx, &sqrDists);
+      findNeighbors(R_, nnIdx, sqrDists);
 
 /**
       // Search tree returns indices into the original cloud, but we are working with indices TODO: make that optional!
@@ -1191,28 +1479,12 @@ void GreedyProjection::filter(PointView& view)
       }
     }
   }
-  log()->get(LogLevel::Debug) << "Number of triangles: " <<
-      mesh_->size() << ".\n";
-  log()->get(LogLevel::Debug) << "Number of unconnected parts: " << nr_parts <<
-      ".\n";
-  if (increase_nnn4fn > 0)
-      log()->get(LogLevel::Warning) << "Number of neighborhood size "
-          "increase requests for fringe neighbors: " << increase_nnn4fn <<
-          ".\n";
-  if (increase_nnn4s > 0)
-      log()->get(LogLevel::Warning) << "Number of neighborhood size "
-          "increase requests for source: " << increase_nnn4s << ".\n";
-  if (increase_dist > 0)
-      log()->get(LogLevel::Warning) << "Number of automatic maximum "
-          "distance increases: " << increase_dist << ".\n";
-
   // sorting and removing doubles from fringe queue
   std::sort (fringe_queue_.begin(), fringe_queue_.end ());
   fringe_queue_.erase (std::unique(fringe_queue_.begin(), fringe_queue_.end()),
       fringe_queue_.end ());
   log()->get(LogLevel::Debug) << "Number of processed points: " <<
       fringe_queue_.size() << " / " << view.size() << "!\n";
-  view_ = nullptr;
 }
 
 void GreedyProjection::closeTriangle ()
@@ -51,6 +51,7 @@
 
 namespace pdal
 {
+  class KD3Index;
   class TriangularMesh;
 
   /** \brief Returns if a point X is visible from point R (or the origin)
@@ -155,6 +156,7 @@ namespace pdal
         eps_angle_(M_PI/4), //45 degrees,
         consistent_(false),
         consistent_ordering_ (false),
+        tile_size_ (0),
         angles_ (),
         R_ (),
         state_ (),
@@ -182,7 +184,12 @@ namespace pdal
         uvn_next_sfn_ (),
         tmp_ (),
         view_(nullptr),
-        mesh_(nullptr)
+        mesh_(nullptr),
+        tree_(nullptr),
+        nr_parts_(0),
+        increase_nnn4fn_(0),
+        increase_nnn4s_(0),
+        increase_dist_(0)
       {};
 
       std::string getName() const;
@@ -261,6 +268,11 @@ namespace pdal
       */
       bool consistent_ordering_;
 
+      /** \brief Size of the square tiles whose meshes are grown
+          concurrently.  0 grows a single mesh over all the points.
+      */
+      double tile_size_;
+
      private:
       /** \brief Struct for storing the angles to nearest neighbors **/
       struct nnAngle
@@ -342,6 +354,20 @@ namespace pdal
       PointView *view_;
       /** \brief Pointer to the mesh we're creating. **/
       TriangularMesh *mesh_;
+      /** \brief Index used to find neighbors that weren't found in advance **/
+      KD3Index *tree_;
+      /** \brief Neighbors of each point found in advance, nnn_ per point **/
+      std::vector<PointId> nn_ids_;
+      /** \brief Squared distances to the neighbors in nn_ids_ **/
+      std::vector<double> nn_dists_;
+      /** \brief Number of unconnected parts in the mesh **/
+      int nr_parts_;
+      /** \brief Number of points with fringe neighbors out of range **/
+      int increase_nnn4fn_;
+      /** \brief Number of points with a source out of range **/
+      int increase_nnn4s_;
+      /** \brief Number of automatic maximum distance increases **/
+      int increase_dist_;
 
       /** \brief Forms a new triangle by connecting the current neighbor to the query point
         * and the previous neighbor
@@ -435,6 +461,10 @@ namespace pdal
       void addDimensions(PointLayoutPtr layout);
       void initialize();
       void filter(PointView& view);
+      void triangulate();
+      void triangulateTiles(PointView& view);
+      void findNeighbors(PointId id, std::vector<PointId>& nnIdx,
+          std::vector<double>& sqrDists);
       void addTriangle(PointId a, PointId b, PointId c);
       Eigen::Vector3d getCoord(PointId id);
       Eigen::Vector3d getNormalCoord(PointId id);
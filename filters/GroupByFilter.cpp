@@ -34,11 +34,46 @@
 
 #include "GroupByFilter.hpp"
 
+#include <pdal/StageFactory.hpp>
+#include <pdal/StageWrapper.hpp>
+#include <pdal/Writer.hpp>
 #include <pdal/util/ProgramArgs.hpp>
 
 namespace pdal
 {
 
+// Points of a group waiting to be written.
+class GroupBuffer : public StreamPointTable
+{
+public:
+    GroupBuffer(PointLayout& layout, point_count_t capacity) :
+        StreamPointTable(layout, capacity), m_count(0)
+    {
+        m_buf.resize(pointsToBytes(capacity + 1));
+    }
+
+    // Number of points in the buffer.
+    point_count_t m_count;
+
+protected:
+    virtual void reset()
+        { m_count = 0; }
+
+    virtual char *getPoint(PointId idx)
+        { return m_buf.data() + pointsToBytes(idx); }
+
+private:
+    std::vector<char> m_buf;
+};
+
+namespace
+{
+
+// A group's points are handed to its writer once this many are buffered.
+const point_count_t GroupCapacity = 4096;
+
+} // unnamed namespace
+
 static StaticPluginInfo const s_info
 {
     "filters.groupby",
@@ -47,7 +82,11 @@ static StaticPluginInfo const s_info
 };
 CREATE_STATIC_STAGE(GroupByFilter, s_info)
 
-GroupByFilter::GroupByFilter() : m_viewMap()
+GroupByFilter::GroupByFilter() : m_viewMap(), m_hashPos(std::string::npos),
+    m_maxWriters(100), m_table(nullptr)
+{}
+
+GroupByFilter::~GroupByFilter()
 {}
 
 std::string GroupByFilter::getName() const
@@ -58,6 +97,24 @@ std::string GroupByFilter::getName() const
 void GroupByFilter::addArgs(ProgramArgs& args)
 {
     args.add("dimension", "Dimension containing data to be grouped", m_dimName);
+    args.add("filename", "Output filename template.  If set, the points of "
+        "each group are written to a file named by replacing '#' with the "
+        "group's value", m_filename);
+    args.add("max_writers", "Maximum number of group files open at once",
+        m_maxWriters, (size_t)100);
+}
+
+void GroupByFilter::initialize()
+{
+    if (m_filename.size())
+    {
+        m_hashPos = Writer::handleFilenameTemplate(m_filename);
+        if (m_hashPos == std::string::npos)
+            throwError("Option 'filename' must contain a single '#' "
+                "template placeholder.");
+        if (m_maxWriters == 0)
+            throwError("Option 'max_writers' must be greater than 0.");
+    }
 }
 
 void GroupByFilter::prepared(PointTableRef table)
@@ -69,12 +126,159 @@ void GroupByFilter::prepared(PointTableRef table)
     // also need to check that we have a dimension with discrete values
 }
 
+void GroupByFilter::ready(PointTableRef table)
+{
+    m_table = &table;
+    m_parts.clear();
+    m_buffers.clear();
+    if (m_filename.size())
+        m_factory.reset(new StageFactory);
+}
+
+// Buffered points were read with the old spatial reference, so they're
+// written before the writers hear of the new one.
+void GroupByFilter::spatialReferenceChanged(const SpatialReference& srs)
+{
+    if (srs == m_srs)
+        return;
+    flushAll();
+    m_srs = srs;
+    for (auto& wp : m_writers)
+        StreamableWrapper::spatialReferenceChanged(*wp.second.m_writer, srs);
+}
+
+bool GroupByFilter::processOne(PointRef& point)
+{
+    uint64_t group = point.getFieldAs<uint64_t>(m_dimId);
+
+    PointLayoutPtr layout(m_table->layout());
+    std::unique_ptr<GroupBuffer>& buf = m_buffers[group];
+    if (!buf)
+        buf.reset(new GroupBuffer(*layout, GroupCapacity));
+
+    const DimTypeList& dimTypes = layout->dimTypes();
+    m_packed.resize(layout->pointSize());
+    point.getPackedData(dimTypes, m_packed.data());
+    PointRef dest(*buf, buf->m_count++);
+    dest.setPackedData(dimTypes, m_packed.data());
+
+    if (buf->m_count == GroupCapacity)
+        flush(group, *buf);
+    return true;
+}
+
+void GroupByFilter::flushAll()
+{
+    for (auto& bp : m_buffers)
+        flush(bp.first, *bp.second);
+}
+
+// Write a group's buffered points, keeping its writer at the front of the
+// LRU list.
+void GroupByFilter::flush(uint64_t group, GroupBuffer& buf)
+{
+    if (buf.m_count == 0)
+        return;
+
+    auto wi = m_writers.find(group);
+    if (wi == m_writers.end())
+    {
+        if (m_writers.size() == m_maxWriters)
+            closeWriter(m_writers.find(m_lru.back()));
+        wi = openWriter(group);
+    }
+    else
+        m_lru.splice(m_lru.begin(), m_lru, wi->second.m_lruPos);
+
+    Streamable& w = *wi->second.m_writer;
+    PointRef point(buf, 0);
+    for (PointId idx = 0; idx < buf.m_count; ++idx)
+    {
+        point.setPointId(idx);
+        StreamableWrapper::processOne(w, point);
+    }
+    buf.m_count = 0;
+}
+
+// A group whose writer was closed to make room for another gets a new file
+// with a part number should more of its points arrive.
+GroupByFilter::WriterMap::iterator GroupByFilter::openWriter(uint64_t group)
+{
+    int part = m_parts[group]++;
+    std::string name = std::to_string(group);
+    if (part)
+    {
+        name += "_" + std::to_string(part + 1);
+        log()->get(LogLevel::Debug) << getName() << ": Reopening group " <<
+            group << " as part " << (part + 1) << "." << std::endl;
+    }
+    std::string filename(m_filename);
+    filename.replace(m_hashPos, 1, name);
+
+    std::string driver = StageFactory::inferWriterDriver(filename);
+    if (driver.empty())
+        throwError("Can't infer a writer for output file '" + filename +
+            "'.");
+    Streamable *w = dynamic_cast<Streamable *>(m_factory->createStage(driver));
+    if (!w)
+        throwError("Writer '" + driver + "' for output file '" + filename +
+            "' can't be created or isn't streamable.");
+
+    Options opts;
+    opts.add("filename", filename);
+    w->setOptions(opts);
+    LogPtr l(log());
+    w->setLog(l);
+    w->prepare(*m_table);
+    StageWrapper::ready(*w, *m_table);
+    if (!m_srs.empty())
+        StreamableWrapper::spatialReferenceChanged(*w, m_srs);
+
+    m_lru.push_front(group);
+    return m_writers.insert(std::make_pair(group,
+        GroupWriter { w, m_lru.begin() })).first;
+}
+
+void GroupByFilter::closeWriter(WriterMap::iterator wi)
+{
+    Streamable *w = wi->second.m_writer;
+    StageWrapper::done(*w, *m_table);
+    m_factory->destroyStage(w);
+    m_lru.erase(wi->second.m_lruPos);
+    m_writers.erase(wi);
+}
+
+void GroupByFilter::done(PointTableRef table)
+{
+    if (m_table)
+        flushAll();
+    while (m_writers.size())
+        closeWriter(m_writers.begin());
+    m_buffers.clear();
+    m_factory.reset();
+    m_table = nullptr;
+}
+
 PointViewSet GroupByFilter::run(PointViewPtr inView)
 {
     PointViewSet viewSet;
     if (!inView->size())
         return viewSet;
 
+    // Write the groups and pass the points through.
+    if (m_filename.size())
+    {
+        spatialReferenceChanged(inView->spatialReference());
+        PointRef point(*inView, 0);
+        for (PointId idx = 0; idx < inView->size(); idx++)
+        {
+            point.setPointId(idx);
+            processOne(point);
+        }
+        viewSet.insert(inView);
+        return viewSet;
+    }
+
     for (PointId idx = 0; idx < inView->size(); idx++)
     {
         uint64_t val = inView->getFieldAs<uint64_t>(m_dimId, idx);
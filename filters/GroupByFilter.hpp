@@ -35,20 +35,34 @@
 #pragma once
 
 #include <pdal/Filter.hpp>
+#include <pdal/Streamable.hpp>
 
+#include <list>
 #include <map>
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace pdal
 {
 
+class GroupBuffer;
 class PointView;
 class ProgramArgs;
+class StageFactory;
 
-class PDAL_DLL GroupByFilter : public Filter
+class PDAL_DLL GroupByFilter : public Filter, public Streamable
 {
+    struct GroupWriter
+    {
+        Streamable *m_writer;
+        std::list<uint64_t>::iterator m_lruPos;
+    };
+    using WriterMap = std::map<uint64_t, GroupWriter>;
+
 public:
     GroupByFilter();
+    ~GroupByFilter();
 
     std::string getName() const;
 
@@ -57,9 +71,33 @@ private:
     std::string m_dimName;
     Dimension::Id m_dimId;
 
+    // Writing groups directly (stream mode).
+    std::string m_filename;
+    std::string::size_type m_hashPos;
+    size_t m_maxWriters;
+    std::unique_ptr<StageFactory> m_factory;
+    std::map<uint64_t, std::unique_ptr<GroupBuffer>> m_buffers;
+    std::vector<char> m_packed;
+    WriterMap m_writers;
+    std::list<uint64_t> m_lru;
+    std::map<uint64_t, int> m_parts;
+    BasePointTable *m_table;
+    SpatialReference m_srs;
+
     virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
     virtual void prepared(PointTableRef table);
+    virtual void ready(PointTableRef table);
+    virtual bool canStream() const
+        { return !m_filename.empty(); }
+    virtual bool processOne(PointRef& point);
+    virtual void spatialReferenceChanged(const SpatialReference& srs);
     virtual PointViewSet run(PointViewPtr view);
+    virtual void done(PointTableRef table);
+    void flush(uint64_t group, GroupBuffer& buf);
+    void flushAll();
+    WriterMap::iterator openWriter(uint64_t group);
+    void closeWriter(WriterMap::iterator wi);
 
     GroupByFilter& operator=(const GroupByFilter&); // not implemented
     GroupByFilter(const GroupByFilter&); // not implemented
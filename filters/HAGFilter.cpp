@@ -56,6 +56,15 @@ std::string HAGFilter::getName() const
     return s_info.name;
 }
 
+void HAGFilter::addArgs(ProgramArgs& args)
+{
+    args.add("raster", "GDAL-readable ground raster (DTM).  If set, heights "
+        "are computed from the raster instead of ground points",
+        m_rasterFilename);
+    args.add("band", "Raster band of ground elevations (count from 1)",
+        m_band, 1);
+}
+
 void HAGFilter::addDimensions(PointLayoutPtr layout)
 {
     layout->registerDim(Dimension::Id::HeightAboveGround);
@@ -63,13 +72,75 @@ void HAGFilter::addDimensions(PointLayoutPtr layout)
 
 void HAGFilter::prepared(PointTableRef table)
 {
+    if (m_rasterFilename.size())
+    {
+        if (m_band <= 0)
+            throwError("Option 'band' must be greater than 0.");
+        return;
+    }
+
     const PointLayoutPtr layout(table.layout());
     if (!layout->hasDim(Dimension::Id::Classification))
         throwError("Missing Classification dimension in input PointView.");
 }
 
+void HAGFilter::ready(PointTableRef table)
+{
+    m_missed = 0;
+    if (m_rasterFilename.empty())
+        return;
+
+    gdal::registerDrivers();
+    m_raster.reset(new gdal::Raster(m_rasterFilename));
+    if (m_raster->open() != gdal::GDALError::None)
+        throwError(m_raster->errorMsg());
+    if (m_band > m_raster->bandCount())
+        throwError("Raster '" + m_rasterFilename + "' has no band " +
+            std::to_string(m_band) + ".");
+}
+
+// Points outside of the raster or on a no-data cell are passed unchanged.
+bool HAGFilter::processOne(PointRef& point)
+{
+    if (!m_raster)
+        throwError("Stream mode requires the 'raster' option.");
+
+    double x = point.getFieldAs<double>(Dimension::Id::X);
+    double y = point.getFieldAs<double>(Dimension::Id::Y);
+    double ground;
+
+    if (m_raster->readValue(x, y, m_band, ground) == gdal::GDALError::None)
+    {
+        double z = point.getFieldAs<double>(Dimension::Id::Z);
+        point.setField(Dimension::Id::HeightAboveGround, z - ground);
+    }
+    else
+        m_missed++;
+    return true;
+}
+
+void HAGFilter::done(PointTableRef table)
+{
+    if (m_missed)
+        log()->get(LogLevel::Warning) << getName() << ": " << m_missed <<
+            " points were outside of the raster or on no-data cells.  "
+            "HeightAboveGround wasn't set." << std::endl;
+    m_raster.reset();
+}
+
 void HAGFilter::filter(PointView& view)
 {
+    if (m_raster)
+    {
+        PointRef point(view, 0);
+        for (PointId i = 0; i < view.size(); ++i)
+        {
+            point.setPointId(i);
+            processOne(point);
+        }
+        return;
+    }
+
     PointViewPtr gView = view.makeNew();
     PointViewPtr ngView = view.makeNew();
     std::vector<PointId> gIdx, ngIdx;
@@ -35,6 +35,8 @@
 #pragma once
 
 #include <pdal/Filter.hpp>
+#include <pdal/GDALUtils.hpp>
+#include <pdal/Streamable.hpp>
 
 #include <cstdint>
 #include <memory>
@@ -47,19 +49,29 @@ class Options;
 class PointLayout;
 class PointView;
 
-class PDAL_DLL HAGFilter : public Filter
+class PDAL_DLL HAGFilter : public Filter, public Streamable
 {
 public:
-    HAGFilter() : Filter()
+    HAGFilter() : Filter(), m_band(1), m_missed(0)
     {}
 
     std::string getName() const;
 
 private:
+    std::string m_rasterFilename;
+    int m_band;
+    std::unique_ptr<gdal::Raster> m_raster;
+    point_count_t m_missed;
 
+    virtual void addArgs(ProgramArgs& args);
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void prepared(PointTableRef table);
+    virtual void ready(PointTableRef table);
+    virtual bool canStream() const
+        { return !m_rasterFilename.empty(); }
+    virtual bool processOne(PointRef& point);
     virtual void filter(PointView& view);
+    virtual void done(PointTableRef table);
 
     HAGFilter& operator=(const HAGFilter&); // not implemented
     HAGFilter(const HAGFilter&); // not implemented
@@ -36,14 +36,15 @@
 
 #include <pdal/Filter.hpp>
 #include <pdal/PointViewIter.hpp>
+#include <pdal/Streamable.hpp>
 
 namespace pdal
 {
 
-class PDAL_DLL HeadFilter : public Filter
+class PDAL_DLL HeadFilter : public Filter, public Streamable
 {
 public:
-    HeadFilter()
+    HeadFilter() : m_index(0)
     {}
     HeadFilter& operator=(const HeadFilter&) = delete;
     HeadFilter(const HeadFilter&) = delete;
@@ -53,6 +54,10 @@ public:
 private:
     point_count_t m_count;
     bool m_invert;
+    point_count_t m_index;
+
+    virtual bool dimensionsUsed(PointLayoutPtr, Dimension::IdList&) const
+        { return true; }
 
     void addArgs(ProgramArgs& args)
     {
@@ -64,6 +69,36 @@ private:
     }
 
 
+    // Only the first 'count' points read are ever kept, so readers
+    // feeding us directly needn't read more than that.
+    virtual bool pushdownCount(point_count_t& count) const
+    {
+        if (m_invert)
+            return false;
+        count = (std::min)(count, m_count);
+        return true;
+    }
+
+    virtual bool pushdownSelection(PointSelection& selection) const
+    {
+        if (m_invert)
+            return false;
+        selection.select(0, 1, m_count);
+        return true;
+    }
+
+    virtual void ready(PointTableRef)
+        { m_index = 0; }
+
+    virtual bool processOne(PointRef&)
+    {
+        bool inHead = m_index++ < m_count;
+        return m_invert ? !inHead : inHead;
+    }
+
+    virtual bool satisfied() const
+        { return !m_invert && m_index >= m_count; }
+
     PointViewSet run(PointViewPtr view)
     {
         if (m_count > view->size())
@@ -37,6 +37,9 @@
 #include "private/hexer/HexGrid.hpp"
 #include "private/hexer/HexIter.hpp"
 #include <pdal/Polygon.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+#include <mutex>
 
 using namespace hexer;
 
@@ -50,6 +53,13 @@ static PluginInfo const s_info = PluginInfo(
 
 CREATE_STATIC_STAGE(HexBin, s_info)
 
+namespace
+{
+
+const point_count_t BlockSize = 65536;
+
+} // unnamed namespace
+
 HexBin::HexBin()
 {}
 
@@ -83,12 +93,18 @@ void HexBin::addArgs(ProgramArgs& args)
     m_cullArg = &args.add("hole_cull_area_tolerance", "Tolerance area to "
         "apply to holes before cull", m_cullArea);
     args.add("smooth", "Smooth boundary output", m_doSmooth, true);
+    args.add("exact_count", "Number of points binned before later points "
+        "are sampled.  0 bins every point", m_exactCount, point_count_t(0));
 }
 
 
 void HexBin::ready(PointTableRef table)
 {
     m_count = 0;
+    // The points used to compute the hexagon size are always binned.
+    m_exact = m_exactCount;
+    if (m_exact && m_edgeLength == 0.0)
+        m_exact = (std::max)(m_exact, (point_count_t)m_sampleSize);
     if (m_edgeLength == 0.0)  // 0 can always be represented exactly.
     {
         m_grid.reset(new HexGrid(m_density));
@@ -99,23 +115,90 @@ void HexBin::ready(PointTableRef table)
 }
 
 
+// Number of points that the point with the given index stands for, or 0 if
+// it isn't binned.  After the first m_exact points, points are taken in
+// runs of m_exact samples, each run with twice the stride of the one before.
+// Weighting each sample by its stride keeps the hexagon counts estimates
+// of the true density, while the number of points binned only grows with
+// the log of the total.
+int HexBin::sampleWeight(point_count_t idx) const
+{
+    if (m_exact == 0 || idx < m_exact)
+        return 1;
+
+    point_count_t start = m_exact;
+    point_count_t stride = 2;
+    while (idx - start >= m_exact * stride)
+    {
+        start += m_exact * stride;
+        stride *= 2;
+    }
+    return ((idx - start) % stride == 0) ? (int)stride : 0;
+}
+
+
+// Points are binned one at a time until the hexagon size and grid origin
+// are known.  The remaining points are counted in parallel, each thread into
+// a grid of its own, and the grids are merged.
 void HexBin::filter(PointView& view)
 {
+    const point_count_t count = view.size();
+    PointId idx = 0;
     PointRef p(view, 0);
-    for (PointId idx = 0; idx < view.size(); ++idx)
+    for (; idx < count && !(m_grid->width() > 0 && m_grid->hasOrigin());
+            ++idx)
     {
         p.setPointId(idx);
         processOne(p);
     }
+    if (idx == count)
+        return;
+
+    const PointId start = idx;
+    const point_count_t first = m_count;
+    std::mutex mutex;
+    std::vector<std::unique_ptr<HexGrid>> grids;
+    parallelFor((count - start + BlockSize - 1) / BlockSize, [&]()
+    {
+        HexGrid *grid = new HexGrid(m_grid->height(), m_grid->denseLimit(),
+            m_grid->origin());
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            grids.emplace_back(grid);
+        }
+
+        std::vector<double> x(BlockSize);
+        std::vector<double> y(BlockSize);
+        return [&, grid, x, y](std::size_t block) mutable
+        {
+            const PointId begin = start + block * BlockSize;
+            const point_count_t n = (std::min)(BlockSize, count - begin);
+            view.getFieldArray(Dimension::Id::X, begin, n, x.data());
+            view.getFieldArray(Dimension::Id::Y, begin, n, y.data());
+            for (point_count_t i = 0; i < n; ++i)
+            {
+                int weight = sampleWeight(first + begin - start + i);
+                if (weight)
+                    grid->countPoint(x[i], y[i], weight);
+            }
+        };
+    }, 1);
+
+    for (auto& grid : grids)
+        m_grid->merge(*grid);
+    m_count += count - start;
 }
 
 
 bool HexBin::processOne(PointRef& point)
 {
-    double x = point.getFieldAs<double>(Dimension::Id::X);
-    double y = point.getFieldAs<double>(Dimension::Id::Y);
-    m_grid->addPoint(x, y);
-    m_count++;
+    int weight = sampleWeight(m_count++);
+    if (weight)
+    {
+        double x = point.getFieldAs<double>(Dimension::Id::X);
+        double y = point.getFieldAs<double>(Dimension::Id::Y);
+        m_grid->addPoint(x, y, weight);
+    }
     return true;
 }
 
@@ -70,6 +70,8 @@ private:
     double m_edgeLength;
     bool m_outputTesselation;
     bool m_doSmooth;
+    point_count_t m_exactCount;
+    point_count_t m_exact;
     point_count_t m_count;
 
     virtual void addArgs(ProgramArgs& args);
@@ -77,6 +79,8 @@ private:
     virtual void filter(PointView& view);
     virtual bool processOne(PointRef& point);
     virtual void done(PointTableRef table);
+
+    int sampleWeight(point_count_t idx) const;
 };
 
 } // namespace pdal
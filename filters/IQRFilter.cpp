@@ -34,12 +34,22 @@
 
 #include "IQRFilter.hpp"
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
+#include "private/RankSelect.hpp"
+
 namespace pdal
 {
 
+namespace
+{
+
+const point_count_t BlockSize = 4096;
+
+} // unnamed namespace
+
 static StaticPluginInfo const s_info
 {
     "filters.iqr",
@@ -75,23 +85,20 @@ PointViewSet IQRFilter::run(PointViewPtr view)
 
     PointViewPtr output = view->makeNew();
 
-    auto quartile = [](std::vector<double> vals, double percent)
+    const point_count_t n = view->size();
+    if (n == 0)
     {
-        std::nth_element(vals.begin(),
-            vals.begin() + int(vals.size() * percent), vals.end());
-
-        return *(vals.begin() + int(vals.size() * percent));
-    };
-
-    std::vector<double> z(view->size());
-    for (PointId j = 0; j < view->size(); ++j)
-        z[j] = view->getFieldAs<double>(m_dimId, j);
+        PointViewSet viewSet;
+        viewSet.insert(output);
+        return viewSet;
+    }
 
+    RankSelect select(*view, m_dimId);
 
-    double pc25 = quartile(z, 0.25);
+    double pc25 = select.value(point_count_t(n * 0.25));
     log()->get(LogLevel::Debug) << "25th percentile: " << pc25 << std::endl;
 
-    double pc75 = quartile(z, 0.75);
+    double pc75 = select.value(point_count_t(n * 0.75));
     log()->get(LogLevel::Debug) << "75th percentile: " << pc75 << std::endl;
 
     double iqr = pc75-pc25;
@@ -100,11 +107,14 @@ PointViewSet IQRFilter::run(PointViewPtr view)
     double low_fence = pc25 - m_multiplier * iqr;
     double hi_fence = pc75 + m_multiplier * iqr;
 
-    for (PointId j = 0; j < view->size(); ++j)
+    std::vector<double> vals(BlockSize);
+    for (PointId begin = 0; begin < n; begin += BlockSize)
     {
-        double val = view->getFieldAs<double>(m_dimId, j);
-        if (val > low_fence && val < hi_fence)
-            output->appendPoint(*view, j);
+        point_count_t len = (std::min)(BlockSize, n - begin);
+        view->getFieldArray(m_dimId, begin, len, vals.data());
+        for (point_count_t i = 0; i < len; ++i)
+            if (vals[i] > low_fence && vals[i] < hi_fence)
+                output->appendPoint(*view, begin + i);
     }
     log()->get(LogLevel::Debug) << "Cropping " << m_dimName
                                 << " in the range (" << low_fence
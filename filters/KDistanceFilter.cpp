@@ -80,13 +80,11 @@ void KDistanceFilter::filter(PointView& view)
     // Compute the k-distance for each point. The k-distance is the Euclidean
     // distance to k-th nearest neighbor.
     log()->get(LogLevel::Debug) << "Computing k-distances...\n";
-    for (PointId i = 0; i < view.size(); ++i)
+    index.knnSearchAll(m_k, [this, &view](PointId i,
+        const std::vector<PointId>&, const std::vector<double>& sqr_dists)
     {
-        std::vector<PointId> indices(m_k);
-        std::vector<double> sqr_dists(m_k);
-        index.knnSearch(i, m_k, &indices, &sqr_dists);
-        view.setField(m_kdist, i, std::sqrt(sqr_dists[m_k-1]));
-    }
+        view.setField(m_kdist, i, std::sqrt(sqr_dists.back()));
+    });
 }
 
 } // namespace pdal
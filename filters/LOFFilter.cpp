@@ -35,7 +35,10 @@
 #include "LOFFilter.hpp"
 
 #include <pdal/KDIndex.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
+#include <functional>
+#include <numeric>
 #include <string>
 #include <vector>
 
@@ -59,6 +62,9 @@ std::string LOFFilter::getName() const
 void LOFFilter::addArgs(ProgramArgs& args)
 {
     args.add("minpts", "Minimum number of points", m_minpts, 10);
+    args.add("chunk_size", "Maximum number of points whose neighbors are "
+        "kept in memory at once.  If 0, the neighbors of all points are kept",
+        m_chunkSize, point_count_t(0));
 }
 
 void LOFFilter::addDimensions(PointLayoutPtr layout)
@@ -71,24 +77,83 @@ void LOFFilter::addDimensions(PointLayoutPtr layout)
 
 void LOFFilter::filter(PointView& view)
 {
-    using namespace Dimension;
+    const point_count_t n = view.size();
+    if (n == 0)
+        return;
 
     KD3Index& index = view.build3dIndex();
 
-    // Increment the minimum number of points, as knnSearch will be returning
-    // the neighbors along with the query point.
-    m_minpts++;
+    // Ask for one more than the minimum number of points, as knnSearch will
+    // be returning the neighbors along with the query point.
+    const point_count_t k = (std::min)((point_count_t)m_minpts + 1, n);
+
+    // The neighbors of a chunk of points are kept in a flat buffer, k per
+    // point.  When a single chunk holds every point, the neighbors are
+    // found once and reused by all three passes.  Otherwise each pass
+    // finds them again, one chunk at a time, to bound memory use.
+    const point_count_t chunk =
+        m_chunkSize ? (std::min)(m_chunkSize, n) : n;
+    std::vector<PointId> nbrIds(chunk * k);
+    std::vector<double> nbrDists(chunk * k);
+    bool cached = false;
+
+    auto findNeighbors = [&](PointId begin, point_count_t count)
+    {
+        auto store = [&](PointId idx, const std::vector<PointId>& ids,
+            const std::vector<double>& sqrDists)
+        {
+            size_t pos = (idx - begin) * k;
+            for (size_t j = 0; j < k; ++j)
+            {
+                nbrIds[pos + j] = ids[j];
+                nbrDists[pos + j] = std::sqrt(sqrDists[j]);
+            }
+        };
+
+        if (count == n)
+            index.knnSearchAll(k, store);
+        else
+        {
+            std::vector<PointId> queries(count);
+            std::iota(queries.begin(), queries.end(), begin);
+            index.knnSearchAll(view, queries, k, store);
+        }
+    };
+
+    // Call 'f' with the neighbors and neighbor distances of every point.
+    // Points are processed on as many threads as there are cores.
+    using PassFunc =
+        std::function<void(PointId, const PointId *, const double *)>;
+    auto pass = [&](const PassFunc& f)
+    {
+        for (PointId begin = 0; begin < n; begin += chunk)
+        {
+            const point_count_t count = (std::min)(chunk, n - begin);
+            if (!cached)
+                findNeighbors(begin, count);
+            cached = (count == n);
+            parallelFor(count, [&]()
+            {
+                return [&](PointId i)
+                {
+                    f(begin + i, nbrIds.data() + i * k,
+                        nbrDists.data() + i * k);
+                };
+            });
+        }
+    };
+
+    std::vector<double> kdist(n);
+    std::vector<double> lrd(n);
+    std::vector<double> lof(n);
 
     // First pass: Compute the k-distance for each point.
     // The k-distance is the Euclidean distance to k-th nearest neighbor.
     log()->get(LogLevel::Debug) << "Computing k-distances...\n";
-    for (PointId i = 0; i < view.size(); ++i)
+    pass([&kdist, k](PointId i, const PointId *, const double *dists)
     {
-        std::vector<PointId> indices(m_minpts);
-        std::vector<double> sqr_dists(m_minpts);
-        index.knnSearch(i, m_minpts, &indices, &sqr_dists);
-        view.setField(m_kdist, i, std::sqrt(sqr_dists[m_minpts-1]));
-    }
+        kdist[i] = dists[k - 1];
+    });
 
     // Second pass: Compute the local reachability distance for each point.
     // For each neighbor point, the reachability distance is the maximum value
@@ -96,39 +161,34 @@ void LOFFilter::filter(PointView& view)
     // the current point. The lrd is the inverse of the mean of the reachability
     // distances.
     log()->get(LogLevel::Debug) << "Computing lrd...\n";
-    for (PointId i = 0; i < view.size(); ++i)
+    pass([&kdist, &lrd, k](PointId i, const PointId *ids, const double *dists)
     {
-        std::vector<PointId> indices(m_minpts);
-        std::vector<double> sqr_dists(m_minpts);
-        index.knnSearch(i, m_minpts, &indices, &sqr_dists);
         double M1 = 0.0;
         point_count_t n = 0;
-        for (PointId j = 0; j < indices.size(); ++j)
+        for (PointId j = 0; j < k; ++j)
         {
-            double k = view.getFieldAs<double>(m_kdist, indices[j]);
-            double reachdist = (std::max)(k, std::sqrt(sqr_dists[j]));
+            double reachdist = (std::max)(kdist[ids[j]], dists[j]);
             M1 += (reachdist - M1) / ++n;
         }
-        view.setField(m_lrd, i, 1.0 / M1);
-    }
+        lrd[i] = 1.0 / M1;
+    });
 
     // Third pass: Compute the local outlier factor for each point.
     // The LOF is the average of the lrd's for a neighborhood of points.
     log()->get(LogLevel::Debug) << "Computing LOF...\n";
-    for (PointId i = 0; i < view.size(); ++i)
+    pass([&lrd, &lof, k](PointId i, const PointId *ids, const double *)
     {
-        double lrdp = view.getFieldAs<double>(m_lrd, i);
-        std::vector<PointId> indices(m_minpts);
-        std::vector<double> sqr_dists(m_minpts);
-        index.knnSearch(i, m_minpts, &indices, &sqr_dists);
+        double lrdp = lrd[i];
         double M1 = 0.0;
         point_count_t n = 0;
-        for (auto const& j : indices)
-        {
-            M1 += (view.getFieldAs<double>(m_lrd, j) / lrdp - M1) / ++n;
-        }
-        view.setField(m_lof, i, M1);
-    }
+        for (PointId j = 0; j < k; ++j)
+            M1 += (lrd[ids[j]] / lrdp - M1) / ++n;
+        lof[i] = M1;
+    });
+
+    view.setFieldArray(m_kdist, 0, n, kdist.data());
+    view.setFieldArray(m_lrd, 0, n, lrd.data());
+    view.setFieldArray(m_lof, 0, n, lof.data());
 }
 
 } // namespace pdal
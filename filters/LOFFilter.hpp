@@ -56,6 +56,7 @@ public:
 private:
     Dimension::Id m_kdist, m_lrd, m_lof;
     int m_minpts;
+    point_count_t m_chunkSize;
 
     virtual void addArgs(ProgramArgs& args);
     virtual void addDimensions(PointLayoutPtr layout);
@@ -34,12 +34,23 @@
 
 #include "MADFilter.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <string>
 #include <vector>
 
+#include "private/RankSelect.hpp"
+
 namespace pdal
 {
 
+namespace
+{
+
+const point_count_t BlockSize = 4096;
+
+} // unnamed namespace
+
 static StaticPluginInfo const s_info
 {
     "filters.mad",
@@ -76,29 +87,31 @@ PointViewSet MADFilter::run(PointViewPtr view)
 
     PointViewPtr output = view->makeNew();
 
-    auto estimate_median = [](std::vector<double> vals)
+    const point_count_t n = view->size();
+    if (n == 0)
     {
-        std::nth_element(vals.begin(), vals.begin()+vals.size()/2, vals.end());
-        return *(vals.begin()+vals.size()/2);
-    };
+        PointViewSet viewSet;
+        viewSet.insert(output);
+        return viewSet;
+    }
 
-    std::vector<double> z(view->size());
-    for (PointId j = 0; j < view->size(); ++j)
-        z[j] = view->getFieldAs<double>(m_dimId, j);
+    RankSelect select(*view, m_dimId);
 
-    double median = estimate_median(z);
+    double median = select.value(n / 2);
     log()->get(LogLevel::Debug) << getName() <<
         " estimated median value: " << median << std::endl;
 
-    std::transform(z.begin(), z.end(), z.begin(),
-       [median](double v) { return std::fabs(v - median); });
-    double mad = estimate_median(z)*m_madMultiplier;
+    double mad = select.deviation(median, n / 2) * m_madMultiplier;
     log()->get(LogLevel::Debug) << getName() << " mad " << mad << std::endl;
 
-    for (PointId j = 0; j < view->size(); ++j)
+    std::vector<double> vals(BlockSize);
+    for (PointId begin = 0; begin < n; begin += BlockSize)
     {
-        if (z[j]/mad < m_multiplier)
-            output->appendPoint(*view, j);
+        point_count_t len = (std::min)(BlockSize, n - begin);
+        view->getFieldArray(m_dimId, begin, len, vals.data());
+        for (point_count_t i = 0; i < len; ++i)
+            if (std::fabs(vals[i] - median) / mad < m_multiplier)
+                output->appendPoint(*view, begin + i);
     }
 
     double low_fence = median - m_multiplier * mad;
@@ -50,11 +50,10 @@ std::string MergeFilter::getName() const { return s_info.name; }
 
 void MergeFilter::ready(PointTableRef table)
 {
-    SpatialReference srs = getSpatialReference();
-
-    if (srs.empty())
-        srs = table.anySpatialReference();
-    m_view.reset(new PointView(table, srs));
+    m_srs = getSpatialReference();
+    if (m_srs.empty())
+        m_srs = table.anySpatialReference();
+    m_view.reset();
 }
 
 
@@ -64,11 +63,23 @@ PointViewSet MergeFilter::run(PointViewPtr in)
 
     // If the SRS of all the point views aren't the same, print a warning
     // unless we're explicitly overriding the SRS.
-    if (getSpatialReference().empty() &&
-      (in->spatialReference() != m_view->spatialReference()))
+    if (getSpatialReference().empty() && (in->spatialReference() != m_srs))
         log()->get(LogLevel::Warning) << getName() << ": merging points "
             "with inconsistent spatial references." << std::endl;
-    m_view->append(*in.get());
+
+    // The first view becomes the merged view and the point references of
+    // the others are appended to it.  No stage looks at the input views
+    // once we have them, so nothing needs to be copied.
+    if (!m_view)
+    {
+        m_view = in;
+        m_view->setSpatialReference(m_srs);
+    }
+    else
+    {
+        m_view->append(*in.get());
+        m_view->invalidateProducts();
+    }
     viewSet.insert(m_view);
     return viewSet;
 }
@@ -50,8 +50,15 @@ public:
 
 private:
     PointViewPtr m_view;
+    SpatialReference m_srs;
 
     virtual void ready(PointTableRef table);
+    virtual bool dimensionsUsed(PointLayoutPtr, Dimension::IdList&) const
+        { return true; }
+    virtual bool pushdownBounds(BOX3D&) const
+        { return true; }
+    virtual bool joinsBranches() const
+        { return true; }
     virtual bool processOne(PointRef& point)
         { return true; }
     virtual PointViewSet run(PointViewPtr in);
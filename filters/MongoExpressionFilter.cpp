@@ -73,6 +73,9 @@ void MongoExpressionFilter::prepared(PointTableRef table)
 
     log()->get(LogLevel::Debug) << "Built expression: " << *m_expression <<
         std::endl;
+
+    m_program = makeUnique<Program>();
+    m_expression->compile(*m_program);
 }
 
 PointViewSet MongoExpressionFilter::run(PointViewPtr inView)
@@ -80,13 +83,21 @@ PointViewSet MongoExpressionFilter::run(PointViewPtr inView)
     PointViewSet views;
     PointViewPtr view(inView->makeNew());
 
-    for (PointId i(0); i < inView->size(); ++i)
+    // Test a block of points at a time rather than point by point.
+    const point_count_t blockSize = 4096;
+    std::vector<char> passes(blockSize);
+
+    for (PointId idx = 0; idx < inView->size(); idx += blockSize)
     {
-        PointRef pr(inView->point(i));
-        if (processOne(pr))
-        {
-            view->appendPoint(*inView, i);
-        }
+        point_count_t count = (std::min)(blockSize, inView->size() - idx);
+        std::fill(passes.begin(), passes.begin() + count, 1);
+        m_program->test([&](Dimension::Id id, double *v)
+            { inView->getFieldArray(id, idx, count, v); },
+            count, passes.data());
+
+        for (point_count_t i = 0; i < count; ++i)
+            if (passes[i])
+                view->appendPoint(*inView, idx + i);
     }
 
     views.insert(view);
@@ -98,5 +109,20 @@ bool MongoExpressionFilter::processOne(PointRef& pr)
     return m_expression->check(pr);
 }
 
+void MongoExpressionFilter::processBatch(StreamPointTable& table,
+    PointId begin, PointId end, std::vector<bool>& keep)
+{
+    const point_count_t count = end - begin;
+    std::vector<char> passes(count);
+
+    for (point_count_t i = 0; i < count; ++i)
+        passes[i] = keep[i];
+    m_program->test([&](Dimension::Id id, double *v)
+        { table.getFieldArray(id, begin, count, v); },
+        count, passes.data());
+    for (point_count_t i = 0; i < count; ++i)
+        keep[i] = passes[i];
+}
+
 } // namespace pdal
 
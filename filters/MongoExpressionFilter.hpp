@@ -43,6 +43,7 @@ namespace pdal
 {
 
 class Expression;
+class Program;
 
 class PDAL_DLL MongoExpressionFilter : public Filter, public Streamable
 {
@@ -52,6 +53,8 @@ public:
 
     std::string getName() const override;
     virtual bool processOne(PointRef& point) override;
+    virtual void processBatch(StreamPointTable& table, PointId begin,
+        PointId end, std::vector<bool>& keep) override;
 
 private:
     virtual void addArgs(ProgramArgs& args) override;
@@ -60,6 +63,7 @@ private:
 
     Json::Value m_json;
     std::unique_ptr<Expression> m_expression;
+    std::unique_ptr<Program> m_program;
 };
 
 } // namespace pdal
@@ -38,6 +38,7 @@
 #include <pdal/PipelineManager.hpp>
 #include <pdal/SpatialReference.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
 #include <pdal/util/Utils.hpp>
 #include <io/BufferReader.hpp>
 
@@ -147,24 +148,55 @@ std::vector<PointId> MongusFilter::processGround(PointViewPtr view)
     MatrixXd cz(m_numRows, m_numCols);
     cz.setConstant((std::numeric_limits<double>::max)());
 
-    // find initial set of Z minimums at native resolution
-    for (point_count_t i = 0; i < np; ++i)
+    // find initial set of Z minimums at native resolution.  Points are
+    // sorted by row so that bands of rows are searched on separate
+    // threads.  The points of a row stay in order, so ties go to the first
+    // point.
+    std::vector<int> pointRow(np);
+    std::vector<int> pointCol(np);
+    parallelFor(np, [&]()
     {
-        using namespace Dimension;
-        double x = view->getFieldAs<double>(Id::X, i);
-        double y = view->getFieldAs<double>(Id::Y, i);
-        double z = view->getFieldAs<double>(Id::Z, i);
+        return [&](PointId i)
+        {
+            using namespace Dimension;
+            double x = view->getFieldAs<double>(Id::X, i);
+            double y = view->getFieldAs<double>(Id::Y, i);
+            pointCol[i] =
+                Utils::clamp(getColIndex(x, m_cellSize), 0, m_numCols-1);
+            pointRow[i] =
+                Utils::clamp(getRowIndex(y, m_cellSize), 0, m_numRows-1);
+        };
+    });
 
-        int c = Utils::clamp(getColIndex(x, m_cellSize), 0, m_numCols-1);
-        int r = Utils::clamp(getRowIndex(y, m_cellSize), 0, m_numRows-1);
+    std::vector<point_count_t> rowStart(m_numRows + 1);
+    for (point_count_t i = 0; i < np; ++i)
+        rowStart[pointRow[i] + 1]++;
+    for (int r = 0; r < m_numRows; ++r)
+        rowStart[r + 1] += rowStart[r];
+    std::vector<PointId> byRow(np);
+    std::vector<point_count_t> next(rowStart.begin(), rowStart.end() - 1);
+    for (point_count_t i = 0; i < np; ++i)
+        byRow[next[pointRow[i]]++] = i;
 
-        if (z < cz(r, c))
+    parallelFor(m_numRows, [&]()
+    {
+        return [&](size_t r)
         {
-            cx(r, c) = x;
-            cy(r, c) = y;
-            cz(r, c) = z;
-        }
-    }
+            using namespace Dimension;
+            for (point_count_t k = rowStart[r]; k < rowStart[r + 1]; ++k)
+            {
+                PointId i = byRow[k];
+                double z = view->getFieldAs<double>(Id::Z, i);
+                int c = pointCol[i];
+                if (z < cz(r, c))
+                {
+                    cx(r, c) = view->getFieldAs<double>(Id::X, i);
+                    cy(r, c) = view->getFieldAs<double>(Id::Y, i);
+                    cz(r, c) = z;
+                }
+            }
+        };
+    }, 16);
 
     writeControl(cx, cy, cz, "grid_mins.laz");
 
@@ -443,21 +475,29 @@ std::vector<PointId> MongusFilter::processGround(PointViewPtr view)
     // apply final filtering (top hat) using raw points against TPS
 
     // ...the LiDAR points are filtered only at the bottom level.
-    for (point_count_t i = 0; i < np; ++i)
+    std::vector<char> ground(np);
+    parallelFor(np, [&]()
     {
-        using namespace Dimension;
+        return [&](PointId i)
+        {
+            using namespace Dimension;
 
-        double x = view->getFieldAs<double>(Id::X, i);
-        double y = view->getFieldAs<double>(Id::Y, i);
-        double z = view->getFieldAs<double>(Id::Z, i);
+            double x = view->getFieldAs<double>(Id::X, i);
+            double y = view->getFieldAs<double>(Id::Y, i);
+            double z = view->getFieldAs<double>(Id::Z, i);
 
-        int c = Utils::clamp(getColIndex(x, cur_cell_size), 0, m_numCols-1);
-        int r = Utils::clamp(getRowIndex(y, cur_cell_size), 0, m_numRows-1);
+            int c = Utils::clamp(getColIndex(x, cur_cell_size), 0,
+                m_numCols-1);
+            int r = Utils::clamp(getRowIndex(y, cur_cell_size), 0,
+                m_numRows-1);
 
-        double res = z - surface(r, c);
-        if (res < 1.0)
+            double res = z - surface(r, c);
+            ground[i] = (res < 1.0);
+        };
+    });
+    for (point_count_t i = 0; i < np; ++i)
+        if (ground[i])
             groundIdx.push_back(i);
-    }
 
     return groundIdx;
 }
@@ -481,24 +521,42 @@ void MongusFilter::downsampleMin(Eigen::MatrixXd *cx, Eigen::MatrixXd *cy,
     dcz->resize(nr, nc);
     dcz->setConstant((std::numeric_limits<double>::max)());
 
-    for (auto c = 0; c < cz->cols(); ++c)
+    // Rows map to downsampled rows in order, so each downsampled row is
+    // found from its own range of rows on a separate thread.  Columns are
+    // still visited first, so ties go to the same cell.
+    std::vector<int> first(nr, 0);
+    std::vector<int> last(nr, 0);
+    for (auto r = 0; r < cz->rows(); ++r)
     {
-        for (auto r = 0; r < cz->rows(); ++r)
-        {
-            if ((*cz)(r, c) == (std::numeric_limits<double>::max)())
-                continue;
-
-            int rr = static_cast<int>(std::floor(r / cell_size));
-            int cc = static_cast<int>(std::floor(c / cell_size));
+        int rr = static_cast<int>(std::floor(r / cell_size));
+        if (first[rr] == last[rr])
+            first[rr] = r;
+        last[rr] = r + 1;
+    }
 
-            if ((*cz)(r, c) < (*dcz)(rr, cc))
+    parallelFor(nr, [&]()
+    {
+        return [&](size_t rr)
+        {
+            for (auto c = 0; c < cz->cols(); ++c)
             {
-                (*dcx)(rr, cc) = (*cx)(r, c);
-                (*dcy)(rr, cc) = (*cy)(r, c);
-                (*dcz)(rr, cc) = (*cz)(r, c);
+                for (auto r = first[rr]; r < last[rr]; ++r)
+                {
+                    if ((*cz)(r, c) == (std::numeric_limits<double>::max)())
+                        continue;
+
+                    int cc = static_cast<int>(std::floor(c / cell_size));
+
+                    if ((*cz)(r, c) < (*dcz)(rr, cc))
+                    {
+                        (*dcx)(rr, cc) = (*cx)(r, c);
+                        (*dcy)(rr, cc) = (*cy)(r, c);
+                        (*dcz)(rr, cc) = (*cz)(r, c);
+                    }
+                }
             }
-        }
-    }
+        };
+    }, 1);
 }
 
 PointViewSet MongusFilter::run(PointViewPtr view)
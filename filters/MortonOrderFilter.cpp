@@ -35,9 +35,14 @@
 #include "MortonOrderFilter.hpp"
 
 #include <climits>
-#include <iostream>
+#include <cmath>
 #include <limits>
-#include <map>
+#include <numeric>
+
+#include <pdal/util/Utils.hpp>
+
+#include <pdal/private/Morton.hpp>
+#include <pdal/private/RadixSort.hpp>
 
 namespace pdal
 {
@@ -57,48 +62,34 @@ std::string MortonOrderFilter::getName() const { return s_info.name; }
 void MortonOrderFilter::addArgs(ProgramArgs& args)
 {
     args.add("reverse", "Reverse Morton", m_reverse, false);
+    args.add("curve", "Space-filling curve to order by ('morton' or "
+        "'hilbert')", m_curve, "morton");
+    args.add("reorder_only", "Reorder the points of the input view in "
+        "place rather than copying them to a new view", m_reorderOnly, false);
 }
 
-//This used to be a lambda, but the VS compiler exploded, I guess.
-typedef std::pair<double, double> Coord;
-namespace
-{
-bool less_msb(const int& x, const int& y)
+void MortonOrderFilter::initialize()
 {
-    return x < y && x < (x ^ y);
+    m_curve = Utils::tolower(m_curve);
+    if (m_curve != "morton" && m_curve != "hilbert")
+        throwError("Invalid 'curve' option '" + m_curve + "'.  Valid "
+            "options are 'morton' and 'hilbert'.");
+    if (m_reverse && m_curve != "morton")
+        throwError("Option 'reverse' can only be used with the "
+            "'morton' curve.");
 }
 
-class CmpZOrder
+namespace
 {
-public:
-    bool operator()(const Coord& c1, const Coord& c2) const
-    {
-        int a[2] = {(int)(c1.first * INT_MAX), (int)(c1.second * INT_MAX)};
-        int b[2] = {(int)(c2.first * INT_MAX), (int)(c2.second * INT_MAX)};
-
-        int j = 0;
-        int x = 0;
-
-        for (int k = 0; k < 2; k++)
-        {
-            int y = a[k] ^ b[k];
-            if (less_msb(x, y))
-            {
-                j = k;
-                x = y;
-            }
-        }
-        return (a[j] - b[j]) < 0;
-    };
-};
-}
 
 class ReverseZOrder
 {
 public:
+    // Only the low 16 bits of each coordinate are used.
     static uint32_t encode_morton(uint32_t x, uint32_t y)
     {
-        return (part1_by1(y) << 1) + part1_by1(x);
+        return (uint32_t)((part1_by1(y & 0xffff) << 1) +
+            part1_by1(x & 0xffff));
     }
 
     static uint32_t reverse_morton(uint32_t index)
@@ -110,121 +101,159 @@ public:
         index = ((index >> 16) & 0xffffu) | ((index & 0xffffu) << 16);
         return index;
     }
+};
 
-private:
-    static uint32_t part1_by1(uint32_t x)
+// Distance of the cell (x, y) along a Hilbert curve that fills a
+// 2^32 x 2^32 grid.
+uint64_t hilbertCode(uint32_t x, uint32_t y)
+{
+    uint64_t d = 0;
+    for (uint32_t s = 1u << 31; s > 0; s >>= 1)
     {
-        x &= 0x0000ffff;
-        x = (x ^ (x <<  8)) & 0x00ff00ff;
-        x = (x ^ (x <<  4)) & 0x0f0f0f0f;
-        x = (x ^ (x <<  2)) & 0x33333333;
-        x = (x ^ (x <<  1)) & 0x55555555;
-        return x;
+        const uint32_t rx = (x & s) ? 1 : 0;
+        const uint32_t ry = (y & s) ? 1 : 0;
+        d += (uint64_t)s * s * ((3 * rx) ^ ry);
+
+        // Rotate the quadrant.  Flipping all the bits is the same as
+        // flipping the low ones since the high bits aren't looked at again.
+        if (ry == 0)
+        {
+            if (rx == 1)
+            {
+                x = ~x;
+                y = ~y;
+            }
+            std::swap(x, y);
+        }
     }
+    return d;
+}
 
-    static uint32_t part1_by2(uint32_t x)
+// Position of each point in [0, 1] along X and Y relative to the bounds
+// of the view.
+void normalize(const PointView& view, std::vector<double>& xs,
+    std::vector<double>& ys)
+{
+    const point_count_t n = view.size();
+    xs.resize(n);
+    ys.resize(n);
+    view.getFieldArray(Dimension::Id::X, 0, n, xs.data());
+    view.getFieldArray(Dimension::Id::Y, 0, n, ys.data());
+
+    BOX2D bounds;
+    view.calculateBounds(bounds);
+    const double xrange = bounds.maxx - bounds.minx;
+    const double yrange = bounds.maxy - bounds.miny;
+    for (PointId i = 0; i < n; ++i)
     {
-        x &= 0x000003ff;
-        x = (x ^ (x << 16)) & 0xff0000ff;
-        x = (x ^ (x <<  8)) & 0x0300f00f;
-        x = (x ^ (x <<  4)) & 0x030c30c3;
-        x = (x ^ (x <<  2)) & 0x09249249;
-        return x;
+        xs[i] = xrange ? (xs[i] - bounds.minx) / xrange : 0;
+        ys[i] = yrange ? (ys[i] - bounds.miny) / yrange : 0;
     }
-};
+}
 
-PointViewSet MortonOrderFilter::reverseMorton(PointViewPtr inView)
+// Point IDs in order of their codes.
+std::vector<PointId> sortByCode(std::vector<uint64_t>& codes)
 {
-    const int32_t cell = static_cast<int32_t>(sqrt(inView->size()));
+    std::vector<PointId> order(codes.size());
+    std::iota(order.begin(), order.end(), 0);
+    radixSort(codes, order);
+    return order;
+}
+
+} // unnamed namespace
+
+std::vector<PointId> MortonOrderFilter::reverseMorton(const PointView& view)
+{
+    const int32_t cell = static_cast<int32_t>(sqrt(view.size()));
 
     // compute range
     BOX2D buffer_bounds;
-    inView->calculateBounds(buffer_bounds);
+    view.calculateBounds(buffer_bounds);
     const double xrange = buffer_bounds.maxx - buffer_bounds.minx;
     const double yrange = buffer_bounds.maxy - buffer_bounds.miny;
 
-    const double cell_width = xrange / cell;
-    const double cell_height = yrange / cell;
+    const double cell_width = xrange ? xrange / cell : 1;
+    const double cell_height = yrange ? yrange / cell : 1;
 
     // compute reverse morton code for each point
-    std::multimap<uint32_t, PointId> codes;
-    for (PointId idx = 0; idx < inView->size(); idx++)
+    std::vector<uint64_t> codes(view.size());
+    for (PointId idx = 0; idx < view.size(); idx++)
     {
-        const double x = inView->getFieldAs<double>(Dimension::Id::X, idx);
+        const double x = view.getFieldAs<double>(Dimension::Id::X, idx);
         const int32_t xpos =
             static_cast<int32_t>(std::floor((x - buffer_bounds.minx) /
                 cell_width));
 
-        const double y = inView->getFieldAs<double>(Dimension::Id::Y, idx);
+        const double y = view.getFieldAs<double>(Dimension::Id::Y, idx);
         const int32_t ypos =
             static_cast<int32_t>(std::floor((y - buffer_bounds.miny) /
                 cell_height));
 
         const uint32_t code = ReverseZOrder::encode_morton(xpos, ypos);
-        const uint32_t reverse = ReverseZOrder::reverse_morton( code );
-
-        codes.insert( std::pair<uint32_t, PointId>(reverse, idx) );
+        codes[idx] = ReverseZOrder::reverse_morton(code);
     }
-
-    // a map is yet order by key so its naturally ordered by lod
-    std::multimap<uint32_t, PointId>::iterator it;
-    PointViewPtr outView = inView->makeNew();
-    for (it = codes.begin(); it != codes.end(); ++it)
-    {
-        outView->appendPoint(*inView, it->second);
-    }
-
-    // build output view
-    PointViewSet viewSet;
-    viewSet.insert(outView);
-
-    return viewSet;
+    return sortByCode(codes);
 }
 
-PointViewSet MortonOrderFilter::morton(PointViewPtr inView)
+// Interleave 31 bits of each coordinate, X above Y.
+std::vector<PointId> MortonOrderFilter::morton(const PointView& view)
 {
-    PointViewSet viewSet;
-    if (!inView->size())
-        return viewSet;
-    CmpZOrder compare;
-    std::multimap<Coord, PointId, CmpZOrder> sorted(compare);
-
-    BOX2D buffer_bounds;
-    inView->calculateBounds(buffer_bounds);
-    double xrange = buffer_bounds.maxx - buffer_bounds.minx;
-    double yrange = buffer_bounds.maxy - buffer_bounds.miny;
+    std::vector<double> xs;
+    std::vector<double> ys;
+    normalize(view, xs, ys);
 
-    for (PointId idx = 0; idx < inView->size(); idx++)
+    std::vector<uint64_t> codes(view.size());
+    for (PointId idx = 0; idx < view.size(); idx++)
     {
-        double xpos = (inView->getFieldAs<double>(Dimension::Id::X, idx) -
-            buffer_bounds.minx) / xrange;
-        double ypos = (inView->getFieldAs<double>(Dimension::Id::Y, idx) -
-            buffer_bounds.miny) / yrange;
-        Coord loc(xpos, ypos);
-        sorted.insert(std::make_pair(loc, idx));
+        const uint64_t x = (uint64_t)(xs[idx] * INT_MAX);
+        const uint64_t y = (uint64_t)(ys[idx] * INT_MAX);
+        codes[idx] = (part1_by1(x) << 1) | part1_by1(y);
     }
+    return sortByCode(codes);
+}
+
+std::vector<PointId> MortonOrderFilter::hilbert(const PointView& view)
+{
+    std::vector<double> xs;
+    std::vector<double> ys;
+    normalize(view, xs, ys);
 
-    PointViewPtr outView = inView->makeNew();
-    std::multimap<Coord, PointId, CmpZOrder>::iterator pos;
-    for (pos = sorted.begin(); pos != sorted.end(); ++pos)
+    const double scale = (std::numeric_limits<uint32_t>::max)();
+    std::vector<uint64_t> codes(view.size());
+    for (PointId idx = 0; idx < view.size(); idx++)
     {
-        outView->appendPoint(*inView, pos->second);
+        const uint32_t x = (uint32_t)(xs[idx] * scale);
+        const uint32_t y = (uint32_t)(ys[idx] * scale);
+        codes[idx] = hilbertCode(x, y);
     }
-    viewSet.insert(outView);
-
-    return viewSet;
+    return sortByCode(codes);
 }
 
 PointViewSet MortonOrderFilter::run(PointViewPtr inView)
 {
-    if ( m_reverse )
+    std::vector<PointId> order;
+    if (m_reverse)
+        order = reverseMorton(*inView);
+    else if (m_curve == "hilbert")
+        order = hilbert(*inView);
+    else
+        order = morton(*inView);
+
+    PointViewSet viewSet;
+    if (m_reorderOnly)
     {
-        return reverseMorton( inView );
+        inView->reorder(order);
+        viewSet.insert(inView);
     }
     else
     {
-        return morton( inView );
+        PointViewPtr outView = inView->makeNew();
+        outView->reserve(order.size());
+        for (PointId idx : order)
+            outView->appendPoint(*inView, idx);
+        viewSet.insert(outView);
     }
+    return viewSet;
 }
 
 } // pdal
@@ -36,6 +36,9 @@
 
 #include <pdal/Filter.hpp>
 
+#include <string>
+#include <vector>
+
 namespace pdal
 {
 
@@ -51,12 +54,16 @@ public:
 
 private:
     virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
     virtual PointViewSet run(PointViewPtr view);
 
-    PointViewSet reverseMorton(PointViewPtr view);
-    PointViewSet morton(PointViewPtr view);
+    std::vector<PointId> reverseMorton(const PointView& view);
+    std::vector<PointId> morton(const PointView& view);
+    std::vector<PointId> hilbert(const PointView& view);
 
     bool m_reverse = false;
+    std::string m_curve;
+    bool m_reorderOnly = false;
 };
 
 } // namespace pdal
@@ -37,10 +37,15 @@
 #include <pdal/PipelineManager.hpp>
 #include <pdal/StageFactory.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
+#include <pdal/private/Morton.hpp>
+#include <pdal/private/RadixSort.hpp>
 #include "private/DimRange.hpp"
 
 #include <iostream>
+#include <limits>
+#include <numeric>
 #include <utility>
 namespace pdal
 {
@@ -53,7 +58,7 @@ static PluginInfo const s_info = PluginInfo(
 CREATE_STATIC_STAGE(NeighborClassifierFilter, s_info)
 
 NeighborClassifierFilter::NeighborClassifierFilter() :
-    m_dim(Dimension::Id::Classification)
+    m_dim(Dimension::Id::Classification), m_morton(false)
 {}
 
 
@@ -68,6 +73,8 @@ void NeighborClassifierFilter::addArgs(ProgramArgs& args)
     args.add("k", "Number of nearest neighbors to consult",
         m_k).setPositional();
     args.add("candidate", "candidate file name", m_candidateFile);
+    args.add("morton", "Query the points in Morton order, which keeps "
+        "nearby points together in memory", m_morton, false);
 }
 
 void NeighborClassifierFilter::initialize()
@@ -105,52 +112,134 @@ void NeighborClassifierFilter::prepared(PointTableRef table)
     std::sort(m_domain.begin(), m_domain.end());
 }
 
-void NeighborClassifierFilter::doOneNoDomain(PointRef &point, PointRef &temp,
-    KD3Index &kdi)
+// The candidate file is read and indexed once, no matter how many views
+// are passed to the filter.
+void NeighborClassifierFilter::ready(PointTableRef)
+{
+    if (m_candidateFile.size())
+    {
+        m_candTable.reset(new PointTable);
+        m_candView = loadSet(m_candidateFile, *m_candTable);
+        m_candView->build3dIndex();
+    }
+}
+
+
+void NeighborClassifierFilter::done(PointTableRef)
+{
+    m_candView.reset();
+    m_candTable.reset();
+}
+
+// Returns true, with the winning class, if the neighbors vote to change
+// the class of a point to another one.  'nn' is the view holding the
+// neighbors.
+bool NeighborClassifierFilter::vote(const PointView& nn,
+    const std::vector<PointId>& iSrc, double oldclass, int& newclass) const
 {
-    std::vector<PointId> iSrc = kdi.neighbors(point, m_k);
     double thresh = iSrc.size()/2.0;
 
     // vote NNs
     using CountMap = std::map<int, unsigned int>;
     CountMap counts;
-    //std::map<int, unsigned int> counts;
     for (PointId id : iSrc)
-    {
-        temp.setPointId(id);
-        counts[temp.getFieldAs<int>(m_dim)]++;
-    }
+        counts[nn.getFieldAs<int>(m_dim, id)]++;
 
     // pick winner of the vote
     auto pr = *std::max_element(counts.begin(), counts.end(),
         [](CountMap::const_reference p1, CountMap::const_reference p2)
         { return p1.second < p2.second; });
 
-    // update point
-    auto oldclass = point.getFieldAs<double>(m_dim);
-    auto newclass = pr.first;
-    if (pr.second > thresh && oldclass != newclass)
-    {
-        point.setField(m_dim, newclass);
-    }
+    newclass = pr.first;
+    return (pr.second > thresh && oldclass != newclass);
 }
 
-// update point.  kdi and temp both reference the NN point cloud
-bool NeighborClassifierFilter::doOne(PointRef& point, PointRef &temp,
-    KD3Index &kdi)
+// Returns true if the point is subject to reclassification.
+bool NeighborClassifierFilter::inDomain(PointRef& point) const
 {
     if (m_domain.empty())  // No domain, process all points
-        doOneNoDomain(point, temp, kdi);
+        return true;
 
-    for (DimRange& r : m_domain)
+    for (const DimRange& r : m_domain)
     {   // process only points that satisfy a domain condition
         if (r.valuePasses(point.getFieldAs<double>(r.m_id)))
+            return true;
+    }
+    return false;
+}
+
+
+// IDs of the points subject to reclassification, in order.  The points
+// are tested in blocks on several threads.
+std::vector<PointId> NeighborClassifierFilter::domainPoints(
+    const PointView& view) const
+{
+    std::vector<PointId> ids;
+    if (m_domain.empty())
+    {
+        ids.resize(view.size());
+        std::iota(ids.begin(), ids.end(), 0);
+        return ids;
+    }
+
+    const size_t BlockSize = 65536;
+    size_t blocks = (view.size() + BlockSize - 1) / BlockSize;
+    std::vector<std::vector<PointId>> blockIds(blocks);
+    PointView& v = const_cast<PointView&>(view);
+    parallelFor(blocks, [&]()
+    {
+        return [&](size_t b)
         {
-            doOneNoDomain(point, temp, kdi);
-            break;
-        }
+            PointRef point(v, 0);
+            PointId end = (std::min)((b + 1) * BlockSize, (size_t)v.size());
+            for (PointId id = b * BlockSize; id < end; ++id)
+            {
+                point.setPointId(id);
+                if (inDomain(point))
+                    blockIds[b].push_back(id);
+            }
+        };
+    }, 1);
+
+    for (auto& b : blockIds)
+        ids.insert(ids.end(), b.begin(), b.end());
+    return ids;
+}
+
+
+// Sort point IDs by the Morton code of their X/Y position so that
+// neighboring queries touch the same parts of the index.  Each point is
+// voted on using the classes the points had on entry, so the order
+// doesn't change the result.
+void NeighborClassifierFilter::mortonOrder(const PointView& view,
+    std::vector<PointId>& ids) const
+{
+    if (ids.empty())
+        return;
+
+    std::vector<double> xs(ids.size());
+    std::vector<double> ys(ids.size());
+    BOX2D bounds;
+    for (size_t i = 0; i < ids.size(); ++i)
+    {
+        xs[i] = view.getFieldAs<double>(Dimension::Id::X, ids[i]);
+        ys[i] = view.getFieldAs<double>(Dimension::Id::Y, ids[i]);
+        bounds.grow(xs[i], ys[i]);
     }
-    return true;
+
+    const double maxCell = (std::numeric_limits<uint32_t>::max)();
+    const double xscale = bounds.maxx > bounds.minx ?
+        maxCell / (bounds.maxx - bounds.minx) : 0;
+    const double yscale = bounds.maxy > bounds.miny ?
+        maxCell / (bounds.maxy - bounds.miny) : 0;
+    std::vector<uint64_t> codes(ids.size());
+    for (size_t i = 0; i < ids.size(); ++i)
+    {
+        uint64_t x = (uint64_t)((xs[i] - bounds.minx) * xscale);
+        uint64_t y = (uint64_t)((ys[i] - bounds.miny) * yscale);
+        codes[i] = part1_by1(x) | (part1_by1(y) << 1);
+    }
+    radixSort(codes, ids);
 }
 
 
@@ -168,29 +257,38 @@ PointViewPtr NeighborClassifierFilter::loadSet(const std::string& filename,
 
 void NeighborClassifierFilter::filter(PointView& view)
 {
-    PointRef point_src(view, 0);
+    std::vector<PointId> ids = domainPoints(view);
+    if (m_morton)
+        mortonOrder(view, ids);
+
+    // The votes are counted concurrently and all use the classes the
+    // points had on entry, so the new classes are set once voting is done.
+    std::vector<int> newClasses(view.size());
+    std::vector<char> changed(view.size());
+    auto doVote = [this, &view, &newClasses, &changed](const PointView *nn)
+    {
+        return [this, &view, nn, &newClasses, &changed](PointId id,
+            const std::vector<PointId>& iSrc, const std::vector<double>&)
+        {
+            changed[id] = vote(*nn, iSrc, view.getFieldAs<double>(m_dim, id),
+                newClasses[id]);
+        };
+    };
+
     if (m_candidateFile.empty())
     {   // No candidate file so NN comes from src file
         KD3Index& kdiSrc = view.build3dIndex();
-        PointRef point_nn(view, 0);
-        for (PointId id = 0; id < view.size(); ++id)
-        {
-            point_src.setPointId(id);
-            doOne(point_src, point_nn, kdiSrc);
-        }
+        kdiSrc.knnSearchAll(view, ids, m_k, doVote(&view));
     }
     else
     {   // NN comes from candidate file
-        PointTable candTable;
-        PointViewPtr candView = loadSet(m_candidateFile, candTable);
-        KD3Index& kdiCand = candView->build3dIndex();
-        PointRef point_nn(*candView, 0);
-        for (PointId id = 0; id < view.size(); ++id)
-        {
-            point_src.setPointId(id);
-            doOne(point_src, point_nn, kdiCand);
-        }
+        KD3Index& kdiCand = m_candView->build3dIndex();
+        kdiCand.knnSearchAll(view, ids, m_k, doVote(m_candView.get()));
     }
+
+    for (PointId id : ids)
+        if (changed[id])
+            view.setField(m_dim, id, newClasses[id]);
 }
 
 } // namespace pdal
@@ -58,10 +58,15 @@ public:
 private:
     virtual void addArgs(ProgramArgs& args);
     virtual void prepared(PointTableRef table);
-    bool doOne(PointRef& point, PointRef& temp, KD3Index &kdi);
+    virtual void ready(PointTableRef table);
+    virtual void done(PointTableRef table);
+    bool inDomain(PointRef& point) const;
+    std::vector<PointId> domainPoints(const PointView& view) const;
+    void mortonOrder(const PointView& view, std::vector<PointId>& ids) const;
+    bool vote(const PointView& nn, const std::vector<PointId>& iSrc,
+        double oldclass, int& newclass) const;
     virtual void filter(PointView& view);
     virtual void initialize();
-    void doOneNoDomain(PointRef &point, PointRef& temp, KD3Index &kdi);
     PointViewPtr loadSet(const std::string &candFileName, PointTable &table);
     NeighborClassifierFilter& operator=(const NeighborClassifierFilter&) = delete;
     NeighborClassifierFilter(const NeighborClassifierFilter&) = delete;
@@ -71,6 +76,10 @@ private:
     Dimension::Id m_dim;
     std::string m_dimName;
     std::string m_candidateFile;
+    bool m_morton;
+    // The candidate points and their index are kept for all views.
+    std::unique_ptr<PointTable> m_candTable;
+    PointViewPtr m_candView;
 };
 
 } // namespace pdal
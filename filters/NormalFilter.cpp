@@ -61,6 +61,7 @@ struct NormalArgs
     int m_knn;
     filter::Point m_viewpoint;
     bool m_up;
+    bool m_float;
 };
 
 NormalFilter::NormalFilter() : m_args(new NormalArgs)
@@ -83,14 +84,17 @@ void NormalFilter::addArgs(ProgramArgs& args)
         "Viewpoint as WKT or GeoJSON", m_args->m_viewpoint);
     args.add("always_up", "Normals always oriented with positive Z?",
         m_args->m_up, true);
+    args.add("float_normals", "Store normals and curvature as 32-bit "
+        "floats rather than doubles?", m_args->m_float);
 }
 
 void NormalFilter::addDimensions(PointLayoutPtr layout)
 {
     using namespace Dimension;
 
-    layout->registerDims(
-        {Id::NormalX, Id::NormalY, Id::NormalZ, Id::Curvature});
+    Type type = m_args->m_float ? Type::Float : Type::Double;
+    for (Id id : {Id::NormalX, Id::NormalY, Id::NormalZ, Id::Curvature})
+        layout->registerDim(id, type);
 }
 
 // public method to access filter, used by GreedyProjection and Poisson filters
@@ -117,31 +121,31 @@ void NormalFilter::prepared(PointTableRef table)
 void NormalFilter::filter(PointView& view)
 {
     KD3Index& kdi = view.build3dIndex();
-
-    for (PointId i = 0; i < view.size(); ++i)
+    const double *coords = kdi.coords();
+    const bool useViewpoint = m_viewpointArg->set();
+
+    // Find the k-nearest neighbors and compute and orient each normal on
+    // as many threads as there are cores.  Each point only depends on its
+    // own neighbors and only its own fields are written, so the result is
+    // the same whatever the number of threads.
+    kdi.knnSearchAll(m_args->m_knn, [this, &view, coords, useViewpoint](
+        PointId i, const std::vector<PointId>& ids, const std::vector<double>&)
     {
-        // find the k-nearest neighbors
-        auto ids = kdi.neighbors(i, m_args->m_knn);
-
-        // compute covariance of the neighborhood
-        auto B = eigen::computeCovariance(view, ids);
-
-        // perform the eigen decomposition
-        Eigen::SelfAdjointEigenSolver<Eigen::Matrix3f> solver(B);
-        if (solver.info() != Eigen::Success)
+        // perform the eigen decomposition of the neighborhood covariance,
+        // reading the neighbors' positions from the index
+        Eigen::Vector3f eval;
+        Eigen::Matrix3f evec;
+        if (!eigen::computeCovarianceEigen(coords, ids, eval, &evec))
             throwError("Cannot perform eigen decomposition.");
-        auto eval = solver.eigenvalues();
-        Eigen::Vector3f normal = solver.eigenvectors().col(0);
+        Eigen::Vector3f normal = evec.col(0);
 
-        if (m_viewpointArg->set())
+        if (useViewpoint)
         {
-            using namespace Dimension;
-
-            PointRef p = view.point(i);
+            const double *p = coords + i * 3;
             Eigen::Vector3f vp(
-                (float)(m_args->m_viewpoint.x() - p.getFieldAs<double>(Id::X)),
-                (float)(m_args->m_viewpoint.y() - p.getFieldAs<double>(Id::Y)),
-                (float)(m_args->m_viewpoint.z() - p.getFieldAs<double>(Id::Z)));
+                (float)(m_args->m_viewpoint.x() - p[0]),
+                (float)(m_args->m_viewpoint.y() - p[1]),
+                (float)(m_args->m_viewpoint.z() - p[2]));
             if (vp.dot(normal) < 0)
                 normal *= -1.0;
         }
@@ -158,7 +162,7 @@ void NormalFilter::filter(PointView& view)
         double sum = eval[0] + eval[1] + eval[2];
         view.setField(Dimension::Id::Curvature, i,
                       sum ? std::fabs(eval[0] / sum) : 0);
-    }
+    });
 }
 
 } // namespace pdal
@@ -35,6 +35,7 @@
 #include "OutlierFilter.hpp"
 
 #include <pdal/KDIndex.hpp>
+#include <pdal/VoxelGridIndex.hpp>
 #include <pdal/util/ProgramArgs.hpp>
 #include <pdal/util/Utils.hpp>
 
@@ -67,6 +68,15 @@ void OutlierFilter::addArgs(ProgramArgs& args)
     args.add("mean_k", "Mean number of neighbors", m_meanK, 8);
     args.add("multiplier", "Standard deviation threshold", m_multiplier, 2.0);
     args.add("class", "Class to use for noise points", m_class, uint8_t(7));
+    args.add("index", "Index for radius searches [kdtree, voxel]", m_index,
+        "kdtree");
+}
+
+void OutlierFilter::initialize()
+{
+    if (!Utils::iequals(m_index, "kdtree") && !Utils::iequals(m_index, "voxel"))
+        throwError("Invalid 'index' option '" + m_index + "'.  Must be "
+            "'kdtree' or 'voxel'.");
 }
 
 void OutlierFilter::addDimensions(PointLayoutPtr layout)
@@ -76,17 +86,30 @@ void OutlierFilter::addDimensions(PointLayoutPtr layout)
 
 Indices OutlierFilter::processRadius(PointViewPtr inView)
 {
-    KD3Index index(*inView);
-    index.build();
-
     point_count_t np = inView->size();
 
     std::vector<PointId> inliers, outliers;
 
+    // The searches run concurrently, so note which points are inliers and
+    // sort them out afterward.
+    std::vector<char> isInlier(np);
+    auto cb = [this, &isInlier](PointId i,
+        const std::vector<PointId>& ids, const std::vector<double>&)
+    {
+        isInlier[i] = (ids.size() > size_t(m_minK));
+    };
+    if (Utils::iequals(m_index, "voxel"))
+    {
+        VoxelGridIndex index(*inView, m_radius);
+        index.build();
+        index.radiusAll(m_radius, cb);
+    }
+    else
+        inView->build3dIndex().radiusAll(m_radius, cb);
+
     for (PointId i = 0; i < np; ++i)
     {
-        auto ids = index.radius(i, m_radius);
-        if (ids.size() > size_t(m_minK))
+        if (isInlier[i])
             inliers.push_back(i);
         else
             outliers.push_back(i);
@@ -97,8 +120,7 @@ Indices OutlierFilter::processRadius(PointViewPtr inView)
 
 Indices OutlierFilter::processStatistical(PointViewPtr inView)
 {
-    KD3Index index(*inView);
-    index.build();
+    KD3Index& index = inView->build3dIndex();
 
     point_count_t np = inView->size();
 
@@ -109,21 +131,15 @@ Indices OutlierFilter::processStatistical(PointViewPtr inView)
     // we increase the count by one because the query point itself will
     // be included with a distance of 0
     point_count_t count = m_meanK + 1;
-    std::vector<PointId> indices(count);
-    std::vector<double> sqr_dists(count);
-    for (PointId i = 0; i < np; ++i)
+    index.knnSearchAll(count, [&distances](PointId i,
+        const std::vector<PointId>&, const std::vector<double>& sqr_dists)
     {
-
-        index.knnSearch(i, count, &indices, &sqr_dists);
-
-        for (size_t j = 1; j < count; ++j)
+        for (size_t j = 1; j < sqr_dists.size(); ++j)
         {
             double delta = std::sqrt(sqr_dists[j]) - distances[i];
             distances[i] += (delta / j);
         }
-        indices.clear(); indices.resize(count);
-        sqr_dists.clear(); sqr_dists.resize(count);
-    }
+    });
 
     size_t n(0);
     double M1(0.0);
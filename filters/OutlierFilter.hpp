@@ -67,11 +67,15 @@ private:
     int m_meanK;
     double m_multiplier;
     uint8_t m_class;
+    std::string m_index;
 
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
     Indices processRadius(PointViewPtr inView);
     Indices processStatistical(PointViewPtr inView);
+    virtual bool viewsRunConcurrently() const
+        { return true; }
     virtual PointViewSet run(PointViewPtr view);
 
     OutlierFilter& operator=(const OutlierFilter&); // not implemented
@@ -39,6 +39,9 @@
 #include <pdal/GDALUtils.hpp>
 #include <pdal/QuadIndex.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+#include "private/RTree.hpp"
 
 namespace pdal
 {
@@ -74,6 +77,14 @@ struct OGRFeatureDeleter
 };
 
 
+OverlayFilter::OverlayFilter() : m_ds(0), m_lyr(0)
+{}
+
+
+OverlayFilter::~OverlayFilter()
+{}
+
+
 void OverlayFilter::addArgs(ProgramArgs& args)
 {
     args.add("dimension", "Dimension on which to filter", m_dimName).
@@ -152,6 +163,19 @@ void OverlayFilter::ready(PointTableRef table)
             OGRFeatureDeleter());
     }
     while (feature);
+    buildIndex();
+}
+
+
+// Index the bounds of the polygons so that a point is only tested against
+// the polygons whose bounds contain it.
+void OverlayFilter::buildIndex()
+{
+    std::vector<BOX2D> bounds;
+    bounds.reserve(m_polygons.size());
+    for (const auto& poly : m_polygons)
+        bounds.push_back(poly.geom.bounds().to2d());
+    m_index.reset(new RTree(bounds));
 }
 
 
@@ -170,14 +194,27 @@ void OverlayFilter::spatialReferenceChanged(const SpatialReference& srs)
             throwError(err.what());
         }
     }
+    buildIndex();
 }
 
 
 bool OverlayFilter::processOne(PointRef& point)
 {
-    for (const auto& poly : m_polygons)
+    double x = point.getFieldAs<double>(Dimension::Id::X);
+    double y = point.getFieldAs<double>(Dimension::Id::Y);
+
+    // Later polygons take precedence, so test the candidates from the last
+    // and stop at the first one that covers the point.
+    m_index->find(x, y, m_candidates);
+    for (auto it = m_candidates.rbegin(); it != m_candidates.rend(); ++it)
+    {
+        const PolyVal& poly = m_polygons[*it];
         if (poly.geom.covers(point))
+        {
             point.setField(m_dim, poly.val);
+            break;
+        }
+    }
     return true;
 }
 
@@ -186,18 +223,45 @@ void OverlayFilter::filter(PointView& view)
 {
     QuadIndex idx(view);
 
-    for (const auto& poly : m_polygons)
+    // Find the candidate points of all the polygons at once, then the
+    // points each polygon covers, on several threads.
+    std::vector<BOX2D> boxes;
+    for (const PolyVal& poly : m_polygons)
     {
-        std::vector<PointId> ids = idx.getPoints(poly.geom.bounds());
-
-        PointRef point(view, 0);
-        for (PointId id : ids)
-        {
-            point.setPointId(id);
-            if (poly.geom.covers(point))
-                point.setField(m_dim, poly.val);
-        }
+        BOX3D b(poly.geom.bounds());
+        boxes.push_back(BOX2D(b.minx, b.miny, b.maxx, b.maxy));
     }
+    std::vector<std::vector<PointId>> covered = idx.getPoints(boxes);
+    parallelFor(m_polygons.size(), [&]()
+    {
+        return [&](size_t p)
+        {
+            const PolyVal& poly = m_polygons[p];
+            std::vector<PointId> ids;
+            ids.swap(covered[p]);
+
+            std::vector<double> x(ids.size());
+            std::vector<double> y(ids.size());
+            for (size_t i = 0; i < ids.size(); ++i)
+            {
+                x[i] = view.getFieldAs<double>(Dimension::Id::X, ids[i]);
+                y[i] = view.getFieldAs<double>(Dimension::Id::Y, ids[i]);
+            }
+
+            std::vector<bool> in;
+            poly.geom.covers(x.data(), y.data(), ids.size(), in);
+            std::vector<PointId>& out = covered[p];
+            for (size_t i = 0; i < ids.size(); ++i)
+                if (in[i])
+                    out.push_back(ids[i]);
+        };
+    }, 1);
+
+    // Set the values in polygon order, so later polygons take precedence
+    // as they do in stream mode.
+    for (size_t p = 0; p < m_polygons.size(); ++p)
+        for (PointId id : covered[p])
+            view.setField(m_dim, id, m_polygons[p].val);
 }
 
 } // namespace pdal
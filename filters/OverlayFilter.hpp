@@ -57,6 +57,7 @@ typedef std::shared_ptr<void> OGRFeaturePtr;
 typedef std::shared_ptr<void> OGRGeometryPtr;
 
 class Arg;
+class RTree;
 
 class PDAL_DLL OverlayFilter : public Filter, public Streamable
 {
@@ -67,8 +68,8 @@ class PDAL_DLL OverlayFilter : public Filter, public Streamable
     };
 
 public:
-    OverlayFilter() : m_ds(0), m_lyr(0)
-    {}
+    OverlayFilter();
+    ~OverlayFilter();
 
     std::string getName() const { return "filters.overlay"; }
 
@@ -80,6 +81,7 @@ private:
     virtual void prepared(PointTableRef table);
     virtual void ready(PointTableRef table);
     virtual void filter(PointView& view);
+    void buildIndex();
 
     OverlayFilter& operator=(const OverlayFilter&) = delete;
     OverlayFilter(const OverlayFilter&) = delete;
@@ -95,6 +97,8 @@ private:
     std::string m_layer;
     Dimension::Id m_dim;
     std::vector<PolyVal> m_polygons;
+    std::unique_ptr<RTree> m_index;
+    std::vector<size_t> m_candidates;
 };
 
 } // namespace pdal
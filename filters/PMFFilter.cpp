@@ -42,6 +42,7 @@
 #include <pdal/EigenUtils.hpp>
 #include <pdal/KDIndex.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 #include "private/Segmentation.hpp"
 #include "private/DimRange.hpp"
@@ -66,6 +67,8 @@ struct PMFArgs
     double m_maxDistance;
     double m_maxWindowSize;
     double m_slope;
+    double m_tile;
+    double m_buffer;
 };
 
 CREATE_STATIC_STAGE(PMFFilter, s_info)
@@ -95,6 +98,9 @@ void PMFFilter::addArgs(ProgramArgs& args)
     args.add("max_window_size", "Maximum window size", m_args->m_maxWindowSize,
              33.0);
     args.add("slope", "Slope", m_args->m_slope, 1.0);
+    args.add("tile", "Tile size for concurrent classification",
+             m_args->m_tile, 0.0);
+    args.add("buffer", "Buffer around each tile", m_args->m_buffer, 0.0);
 }
 
 void PMFFilter::addDimensions(PointLayoutPtr layout)
@@ -136,6 +142,16 @@ void PMFFilter::prepared(PointTableRef table)
             m_args->m_returns.clear();
         }
     }
+
+    if (m_args->m_tile < 0.0)
+        throwError("Option 'tile' must not be negative.");
+    if (m_args->m_buffer < 0.0)
+        throwError("Option 'buffer' must not be negative.");
+
+    // Each opening sees cells as far away as its window, and the openings
+    // are applied one after the other.
+    if (m_args->m_tile > 0.0 && m_args->m_buffer == 0.0)
+        m_args->m_buffer = 2 * m_args->m_maxWindowSize;
 }
 
 PointViewSet PMFFilter::run(PointViewPtr input)
@@ -178,8 +194,28 @@ PointViewSet PMFFilter::run(PointViewPtr input)
         throwError("No returns to process.");
     }
 
-    // Run the actual PMF algorithm.
-    processGround(firstView);
+    // Run the actual PMF algorithm.  Points in the buffer of a tile shape
+    // its surface, but only the tile's own points are classified.
+    BOX2D extent;
+    firstView->calculateBounds(extent);
+    if (m_args->m_tile > 0.0)
+    {
+        std::vector<Segmentation::Tile> tiles = Segmentation::tileView(
+            firstView, m_args->m_tile, m_args->m_buffer);
+        log()->get(LogLevel::Debug) << "Classifying " << tiles.size() <<
+            " tiles.\n";
+        parallelFor(tiles.size(), [&]()
+        {
+            return [&](size_t i)
+            {
+                processGround(tiles[i].m_view, tiles[i].m_coreCount,
+                    extent);
+                tiles[i].m_view.reset();
+            };
+        }, 1);
+    }
+    else
+        processGround(firstView, firstView->size(), extent);
 
     // Prepare the output PointView.
     PointViewPtr outView = input->makeNew();
@@ -191,11 +227,20 @@ PointViewSet PMFFilter::run(PointViewPtr input)
     return viewSet;
 }
 
-void PMFFilter::processGround(PointViewPtr view)
+void PMFFilter::processGround(PointViewPtr view, point_count_t count,
+    const BOX2D& extent)
 {
-    // initialize bounds, rows, columns, and surface
+    // initialize bounds, rows, columns, and surface.  The cells line up with
+    // those of a grid over the extent of all the points, and are found from
+    // that extent so that every tile puts a point in the same cell.
     BOX2D bounds;
     view->calculateBounds(bounds);
+    int col0 = static_cast<int>(
+        floor(bounds.minx - extent.minx) / m_args->m_cellSize);
+    int row0 = static_cast<int>(
+        floor(bounds.miny - extent.miny) / m_args->m_cellSize);
+    bounds.minx = extent.minx + col0 * m_args->m_cellSize;
+    bounds.miny = extent.miny + row0 * m_args->m_cellSize;
     size_t cols =
         static_cast<size_t>(((bounds.maxx - bounds.minx) /
             m_args->m_cellSize) + 1);
@@ -203,6 +248,12 @@ void PMFFilter::processGround(PointViewPtr view)
         static_cast<size_t>(((bounds.maxy - bounds.miny) /
             m_args->m_cellSize) + 1);
 
+    // Rounding can put the last points of a tile just past the grid.
+    cols = (std::max)(cols, static_cast<size_t>(floor((bounds.maxx -
+        extent.minx) / m_args->m_cellSize) - col0 + 1));
+    rows = (std::max)(rows, static_cast<size_t>(floor((bounds.maxy -
+        extent.miny) / m_args->m_cellSize) - row0 + 1));
+
     // initialize surface to NaN
     std::vector<double> ZImin(rows * cols,
         std::numeric_limits<double>::quiet_NaN());
@@ -214,15 +265,22 @@ void PMFFilter::processGround(PointViewPtr view)
         double x = view->getFieldAs<double>(Dimension::Id::X, i);
         double y = view->getFieldAs<double>(Dimension::Id::Y, i);
         double z = view->getFieldAs<double>(Dimension::Id::Z, i);
-        int c = static_cast<int>(floor(x - bounds.minx) / m_args->m_cellSize);
-        int r = static_cast<int>(floor(y - bounds.miny) / m_args->m_cellSize);
+        int c = static_cast<int>(floor(x - extent.minx) /
+            m_args->m_cellSize) - col0;
+        int r = static_cast<int>(floor(y - extent.miny) /
+            m_args->m_cellSize) - row0;
         size_t idx = c * rows + r;
         if (z < ZImin[idx] || std::isnan(ZImin[idx]))
             ZImin[idx] = z;
     }
 
-    // convert vector to PointView for indexing
-    PointViewPtr temp = view->makeNew();
+    // convert vector to PointView for indexing, in a table of its own so that
+    // tiles don't add points to the same one
+    PointTable table;
+    table.layout()->registerDims(
+        {Dimension::Id::X, Dimension::Id::Y, Dimension::Id::Z});
+    table.finalize();
+    PointViewPtr temp(new PointView(table));
     PointId i(0);
     for (size_t c = 0; c < cols; ++c)
     {
@@ -267,7 +325,7 @@ void PMFFilter::processGround(PointViewPtr view)
 
     // initialize ground indices
     std::vector<PointId> groundIdx;
-    for (PointId i = 0; i < view->size(); ++i)
+    for (PointId i = 0; i < count; ++i)
         groundIdx.push_back(i);
 
     // Compute the series of window sizes and height thresholds
@@ -306,9 +364,12 @@ void PMFFilter::processGround(PointViewPtr view)
     // Progressively filter ground returns using morphological open
     for (size_t j = 0; j < wsvec.size(); ++j)
     {
-        log()->get(LogLevel::Debug)
-            << "Iteration " << j << " (height threshold = " << htvec[j]
-            << ", window size = " << wsvec[j] << ")...\n";
+        {
+            std::lock_guard<std::mutex> lock(m_logMutex);
+            log()->get(LogLevel::Debug)
+                << "Iteration " << j << " (height threshold = " << htvec[j]
+                << ", window size = " << wsvec[j] << ")...\n";
+        }
 
         int iters = static_cast<int>(0.5 * (wsvec[j] - 1));
         using namespace eigen;
@@ -322,10 +383,10 @@ void PMFFilter::processGround(PointViewPtr view)
             double y = view->getFieldAs<double>(Dimension::Id::Y, p_idx);
             double z = view->getFieldAs<double>(Dimension::Id::Z, p_idx);
 
-            int c =
-                static_cast<int>(floor((x - bounds.minx) / m_args->m_cellSize));
-            int r =
-                static_cast<int>(floor((y - bounds.miny) / m_args->m_cellSize));
+            int c = static_cast<int>(
+                floor((x - extent.minx) / m_args->m_cellSize)) - col0;
+            int r = static_cast<int>(
+                floor((y - extent.miny) / m_args->m_cellSize)) - row0;
 
             if ((z - mo[c * rows + r]) < htvec[j])
                 groundNewIdx.push_back(p_idx);
@@ -334,12 +395,16 @@ void PMFFilter::processGround(PointViewPtr view)
         ZImin.swap(mo);
         groundIdx.swap(groundNewIdx);
 
+        std::lock_guard<std::mutex> lock(m_logMutex);
         log()->get(LogLevel::Debug)
             << "Ground now has " << groundIdx.size() << " points.\n";
     }
 
-    log()->get(LogLevel::Debug2)
-        << "Labeled " << groundIdx.size() << " ground returns!\n";
+    {
+        std::lock_guard<std::mutex> lock(m_logMutex);
+        log()->get(LogLevel::Debug2)
+            << "Labeled " << groundIdx.size() << " ground returns!\n";
+    }
 
     // set the classification label of ground returns as 2
     // (corresponding to ASPRS LAS specification)
@@ -37,6 +37,7 @@
 #include <pdal/Filter.hpp>
 
 #include <memory>
+#include <mutex>
 
 namespace pdal
 {
@@ -53,13 +54,15 @@ public:
 
 private:
     std::unique_ptr<PMFArgs> m_args;
+    std::mutex m_logMutex;
 
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void addArgs(ProgramArgs& args);
     virtual void prepared(PointTableRef table);
     virtual PointViewSet run(PointViewPtr view);
 
-    void processGround(PointViewPtr view);
+    void processGround(PointViewPtr view, point_count_t count,
+                       const BOX2D& extent);
 
     PMFFilter& operator=(const PMFFilter&); // not implemented
     PMFFilter(const PMFFilter&);            // not implemented
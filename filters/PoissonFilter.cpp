@@ -35,12 +35,39 @@
 #include "PoissonFilter.hpp"
 #include "NormalFilter.hpp"
 
+#include <thread>
+
 #include <kazhdan/PoissonRecon.h>
 #include <kazhdan/point_source/PointSource.h>
 
 namespace pdal
 {
 
+namespace
+{
+
+// Rough number of bytes held per octree node while solving: the node itself,
+// its FEM coefficients and constraints and its row of the system matrix
+// (125 neighbor entries at degree 2).  Only used to cap the depth.
+const double BytesPerNode = 2048;
+
+// Estimate the number of octree nodes built for a given depth.  The upper
+// levels of the tree are full.  Below that each sample can refine at most
+// one node per level, and each refinement adds a brood of eight children.
+double estimateNodes(point_count_t count, int depth)
+{
+    double nodes = 0;
+    double full = 1;
+    for (int d = 0; d <= depth; ++d)
+    {
+        nodes += (std::min)(full, 8.0 * count);
+        full *= 8;
+    }
+    return nodes;
+}
+
+} // unnamed namespace
+
 class PointViewSource : public PointSource
 {
 public:
@@ -255,6 +282,53 @@ void PoissonFilter::addArgs(ProgramArgs& args)
     args.add("density", "Output density estimates", m_density);
     args.add("depth", "Maximum depth of the octree used for reconstruction",
         m_depth, 8);
+    args.add("threads", "Number of threads used for reconstruction. "
+        "0 uses all available cores.", m_threads, 1);
+    args.add("max_memory", "Approximate memory budget for the octree, in "
+        "megabytes. The depth is reduced to stay within the budget. 0 means "
+        "no limit.", m_maxMemory, 0.0);
+}
+
+
+void PoissonFilter::initialize()
+{
+    if (m_threads < 0)
+        throwError("Option 'threads' must not be negative.");
+    if (m_maxMemory < 0)
+        throwError("Option 'max_memory' must not be negative.");
+    if (m_threads == 0)
+        m_threads = (std::max)((int)std::thread::hardware_concurrency(), 1);
+#ifndef _OPENMP
+    if (m_threads > 1)
+    {
+        log()->get(LogLevel::Warning) << getName() << ": PDAL was built "
+            "without OpenMP support. Reconstruction will run on a single "
+            "thread." << std::endl;
+        m_threads = 1;
+    }
+#endif
+}
+
+
+// Find the deepest tree, no deeper than the 'depth' option, whose estimated
+// size fits in the memory budget.
+int PoissonFilter::budgetDepth(point_count_t count) const
+{
+    if (m_maxMemory == 0)
+        return m_depth;
+
+    const double budget = m_maxMemory * 1024 * 1024;
+    int depth = m_depth;
+    while (depth > 2 && estimateNodes(count, depth) * BytesPerNode > budget)
+        depth--;
+    if (estimateNodes(count, depth) * BytesPerNode > budget)
+        log()->get(LogLevel::Warning) << getName() << ": Estimated memory "
+            "use at the minimum depth of " << depth << " exceeds "
+            "'max_memory'." << std::endl;
+    else if (depth < m_depth)
+        log()->get(LogLevel::Debug) << getName() << ": Reduced depth from " <<
+            m_depth << " to " << depth << " to fit 'max_memory'." << std::endl;
+    return depth;
 }
 
 
@@ -271,10 +345,12 @@ PointViewSet PoissonFilter::run(PointViewPtr view)
 
     PoissonOpts<double> opts;
 
-    opts.m_depth = m_depth;
+    const int depth = budgetDepth(view->size());
+    opts.m_depth = depth;
     opts.m_density = m_density;
-    opts.m_solveDepth = m_depth;
-    opts.m_kernelDepth = m_depth - 2;
+    opts.m_solveDepth = depth;
+    opts.m_kernelDepth = depth - 2;
+    opts.m_threads = m_threads;
     if (m_doColor)
     {
         opts.m_color = 16;
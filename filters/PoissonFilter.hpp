@@ -52,12 +52,17 @@ public:
 private:
     bool m_density;
     int m_depth;
+    int m_threads;
+    double m_maxMemory;
     bool m_normalsProvided;
     bool m_doColor;
 
     virtual void addDimensions(PointLayoutPtr layout);
     virtual PointViewSet run(PointViewPtr view);
     virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
+
+    int budgetDepth(point_count_t count) const;
 };
 
 } // namespace pdal
@@ -35,6 +35,8 @@
 #include "RadialDensityFilter.hpp"
 
 #include <pdal/KDIndex.hpp>
+#include <pdal/VoxelGridIndex.hpp>
+#include <pdal/util/Utils.hpp>
 
 #include <string>
 #include <vector>
@@ -59,6 +61,15 @@ std::string RadialDensityFilter::getName() const
 void RadialDensityFilter::addArgs(ProgramArgs& args)
 {
     args.add("radius", "Radius", m_rad, 1.0);
+    args.add("index", "Index for radius searches [kdtree, voxel]", m_index,
+        "kdtree");
+}
+
+void RadialDensityFilter::initialize()
+{
+    if (!Utils::iequals(m_index, "kdtree") && !Utils::iequals(m_index, "voxel"))
+        throwError("Invalid 'index' option '" + m_index + "'.  Must be "
+            "'kdtree' or 'voxel'.");
 }
 
 void RadialDensityFilter::addDimensions(PointLayoutPtr layout)
@@ -71,19 +82,24 @@ void RadialDensityFilter::filter(PointView& view)
 {
     using namespace Dimension;
 
-    // Build the 3D KD-tree.
-    KD3Index& index = view.build3dIndex();
-
     // Search for neighboring points within the specified radius. The number of
     // neighbors (which includes the query point) is normalized by the volume
     // of the search sphere and recorded as the density.
     log()->get(LogLevel::Debug) << "Computing densities...\n";
     double factor = 1.0 / ((4.0 / 3.0) * 3.14159 * (m_rad * m_rad * m_rad));
-    for (PointId i = 0; i < view.size(); ++i)
+    auto cb = [this, &view, factor](PointId i,
+        const std::vector<PointId>& pts, const std::vector<double>&)
     {
-        std::vector<PointId> pts = index.radius(i, m_rad);
         view.setField(m_rdens, i, pts.size() * factor);
+    };
+    if (Utils::iequals(m_index, "voxel"))
+    {
+        VoxelGridIndex index(view, m_rad);
+        index.build();
+        index.radiusAll(m_rad, cb);
     }
+    else
+        view.build3dIndex().radiusAll(m_rad, cb);
 }
 
 } // namespace pdal
@@ -37,6 +37,7 @@
 #include <pdal/Filter.hpp>
 
 #include <memory>
+#include <string>
 
 namespace pdal
 {
@@ -56,9 +57,13 @@ public:
 private:
     Dimension::Id m_rdens;
     double m_rad;
+    std::string m_index;
 
     virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
     virtual void addDimensions(PointLayoutPtr layout);
+    virtual bool viewsRunConcurrently() const
+        { return true; }
     virtual void filter(PointView& view);
 
     RadialDensityFilter& operator=(const RadialDensityFilter&); // not implemented
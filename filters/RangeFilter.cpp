@@ -89,6 +89,52 @@ void RangeFilter::prepared(PointTableRef table)
                 r.m_name + "'.");
     }
     std::sort(m_ranges.begin(), m_ranges.end());
+    m_rangeList.reset(new DimRangeList(m_ranges));
+}
+
+
+bool RangeFilter::dimensionsUsed(PointLayoutPtr,
+    Dimension::IdList& dims) const
+{
+    for (const DimRange& r : m_ranges)
+        dims.push_back(r.m_id);
+    return true;
+}
+
+
+// Ranges on X, Y and Z limit the bounds.  A point only passes if one of
+// the ranges for each dimension passes, so the limit for a dimension is
+// the span of its ranges.  Negated ranges pass points anywhere.
+bool RangeFilter::pushdownBounds(BOX3D& bounds) const
+{
+    using namespace Dimension;
+
+    auto limit = [this](Id id, double& lower, double& upper)
+    {
+        bool found = false;
+        double lo = (std::numeric_limits<double>::max)();
+        double hi = (std::numeric_limits<double>::lowest)();
+        for (const DimRange& r : m_ranges)
+        {
+            if (r.m_id != id)
+                continue;
+            if (r.m_negate)
+                return;
+            found = true;
+            lo = (std::min)(lo, r.m_lower_bound);
+            hi = (std::max)(hi, r.m_upper_bound);
+        }
+        if (found)
+        {
+            lower = (std::max)(lower, lo);
+            upper = (std::min)(upper, hi);
+        }
+    };
+
+    limit(Id::X, bounds.minx, bounds.maxx);
+    limit(Id::Y, bounds.miny, bounds.maxy);
+    limit(Id::Z, bounds.minz, bounds.maxz);
+    return true;
 }
 
 
@@ -102,6 +148,22 @@ bool RangeFilter::processOne(PointRef& point)
 }
 
 
+void RangeFilter::processBatch(StreamPointTable& table, PointId begin,
+    PointId end, std::vector<bool>& keep)
+{
+    const point_count_t count = end - begin;
+    std::vector<char> passes(count);
+
+    for (point_count_t i = 0; i < count; ++i)
+        passes[i] = keep[i];
+    m_rangeList->test([&](Dimension::Id id, double *v)
+        { table.getFieldArray(id, begin, count, v); },
+        count, passes.data());
+    for (point_count_t i = 0; i < count; ++i)
+        keep[i] = passes[i];
+}
+
+
 PointViewSet RangeFilter::run(PointViewPtr inView)
 {
     PointViewSet viewSet;
@@ -110,11 +172,21 @@ PointViewSet RangeFilter::run(PointViewPtr inView)
 
     PointViewPtr outView = inView->makeNew();
 
-    for (PointId i = 0; i < inView->size(); ++i)
+    // Test a block of points at a time rather than point by point.
+    const point_count_t blockSize = 4096;
+    std::vector<char> passes(blockSize);
+
+    for (PointId idx = 0; idx < inView->size(); idx += blockSize)
     {
-        PointRef point = inView->point(i);
-        if (processOne(point))
-            outView->appendPoint(*inView, i);
+        point_count_t count = (std::min)(blockSize, inView->size() - idx);
+        std::fill(passes.begin(), passes.begin() + count, 1);
+        m_rangeList->test([&](Dimension::Id id, double *v)
+            { inView->getFieldArray(id, idx, count, v); },
+            count, passes.data());
+
+        for (point_count_t i = 0; i < count; ++i)
+            if (passes[i])
+                outView->appendPoint(*inView, idx + i);
     }
 
     viewSet.insert(outView);
@@ -45,6 +45,7 @@ namespace pdal
 {
 
 struct DimRange;
+class DimRangeList;
 
 class PDAL_DLL RangeFilter : public Filter,  public Streamable
 {
@@ -56,10 +57,18 @@ public:
 
 private:
     std::vector<DimRange> m_ranges;
+    std::unique_ptr<DimRangeList> m_rangeList;
 
     virtual void addArgs(ProgramArgs& args);
     virtual void prepared(PointTableRef table);
+    virtual bool dimensionsUsed(PointLayoutPtr layout,
+        Dimension::IdList& dims) const;
+    virtual bool pushdownBounds(BOX3D& bounds) const;
+    virtual bool threadSafe() const
+        { return true; }
     virtual bool processOne(PointRef& point);
+    virtual void processBatch(StreamPointTable& table, PointId begin,
+        PointId end, std::vector<bool>& keep);
     virtual PointViewSet run(PointViewPtr view);
 
     RangeFilter& operator=(const RangeFilter&) = delete;
@@ -37,15 +37,30 @@
 #include <pdal/PointView.hpp>
 #include <pdal/GDALUtils.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 #include <gdal.h>
 #include <ogr_spatialref.h>
 
+#include <algorithm>
 #include <memory>
+#include <vector>
 
 namespace pdal
 {
 
+namespace
+{
+
+// Number of points passed to OGR at once by each thread.
+const point_count_t BlockSize = 4096;
+
+// Number of points of a view that are transformed before the results are
+// written back to the view.
+const point_count_t RoundSize = 1 << 20;
+
+} // unnamed namespace
+
 static StaticPluginInfo const s_info
 {
     "filters.reprojection",
@@ -59,21 +74,11 @@ std::string ReprojectionFilter::getName() const { return s_info.name; }
 
 ReprojectionFilter::ReprojectionFilter()
     : m_inferInputSRS(true)
-    , m_in_ref_ptr(NULL)
-    , m_out_ref_ptr(NULL)
-    , m_transform_ptr(NULL)
 {}
 
 
 ReprojectionFilter::~ReprojectionFilter()
-{
-    if (m_transform_ptr)
-        OCTDestroyCoordinateTransformation(m_transform_ptr);
-    if (m_in_ref_ptr)
-        OSRDestroySpatialReference(m_in_ref_ptr);
-    if (m_out_ref_ptr)
-        OSRDestroySpatialReference(m_out_ref_ptr);
-}
+{}
 
 
 void ReprojectionFilter::addArgs(ProgramArgs& args)
@@ -87,8 +92,11 @@ void ReprojectionFilter::initialize()
 {
     m_inferInputSRS = m_inSRS.empty();
 
-    m_out_ref_ptr = OSRNewSpatialReference(m_outSRS.getWKT().c_str());
-    if (!m_out_ref_ptr)
+    OGRSpatialReferenceH ref =
+        OSRNewSpatialReference(m_outSRS.getWKT().c_str());
+    if (ref)
+        OSRDestroySpatialReference(ref);
+    else
         throwError("Invalid output spatial reference '" + m_outSRS.getWKT() +
             "'.  This is usually caused by a bad value for the 'out_srs' "
             "option.");
@@ -112,20 +120,56 @@ void ReprojectionFilter::createTransform(const SpatialReference& srsSRS)
                 "none is specified with the 'in_srs' option.");
     }
 
-    if (m_in_ref_ptr)
-        OSRDestroySpatialReference(m_in_ref_ptr);
-    m_in_ref_ptr = OSRNewSpatialReference(m_inSRS.getWKT().c_str());
-    if (!m_in_ref_ptr)
+    // Views with the same spatial reference get the transformation that
+    // was released by the previous one.
+    m_transform.reset();
+    m_transform = acquireTransform();
+}
+
+
+ReprojectionFilter::TransformPtr ReprojectionFilter::acquireTransform()
+{
+    TransformPtr t = gdal::cachedTransform(m_inSRS.getWKT(),
+        m_outSRS.getWKT());
+    if (t)
+        return t;
+
+    OGRSpatialReferenceH ref =
+        OSRNewSpatialReference(m_inSRS.getWKT().c_str());
+    if (!ref)
         throwError("Invalid input spatial reference '" + m_inSRS.getWKT() +
             "'.  This is usually caused by a bad value for the 'in_srs' "
             "option or an invalid spatial reference in the source file.");
-    if (m_transform_ptr)
-        OCTDestroyCoordinateTransformation(m_transform_ptr);
-    m_transform_ptr = OCTNewCoordinateTransformation(m_in_ref_ptr,
-        m_out_ref_ptr);
-    if (!m_transform_ptr)
-        throwError("Could not construct coordinate transformation object "
-            "in createTransform");
+    OSRDestroySpatialReference(ref);
+    throwError("Could not construct coordinate transformation object "
+        "in createTransform");
+    return t;
+}
+
+
+// Transform points in blocks, using as many threads as there are blocks
+// (up to the number of cores).
+void ReprojectionFilter::transform(double *x, double *y, double *z,
+    int *success, point_count_t count)
+{
+    const size_t numBlocks = (size_t)((count + BlockSize - 1) / BlockSize);
+    if (numBlocks <= 1)
+    {
+        OCTTransformEx(m_transform.get(), (int)count, x, y, z, success);
+        return;
+    }
+
+    parallelFor(numBlocks, [this, x, y, z, success, count]()
+    {
+        TransformPtr t = acquireTransform();
+        return [t, x, y, z, success, count](size_t block)
+        {
+            point_count_t begin = block * BlockSize;
+            int n = (int)(std::min)(BlockSize, count - begin);
+            OCTTransformEx(t.get(), n, x + begin, y + begin, z + begin,
+                success + begin);
+        };
+    }, 1);
 }
 
 
@@ -136,12 +180,30 @@ PointViewSet ReprojectionFilter::run(PointViewPtr view)
 
     createTransform(view->spatialReference());
 
-    PointRef point(*view, 0);
-    for (PointId id = 0; id < view->size(); ++id)
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> z;
+    std::vector<int> success;
+    for (PointId begin = 0; begin < view->size(); begin += RoundSize)
     {
-        point.setPointId(id);
-        if (processOne(point))
-            outView->appendPoint(*view, id);
+        const point_count_t count =
+            (std::min)(RoundSize, view->size() - begin);
+        x.resize(count);
+        y.resize(count);
+        z.resize(count);
+        success.resize(count);
+
+        view->getFieldArray(Dimension::Id::X, begin, count, x.data());
+        view->getFieldArray(Dimension::Id::Y, begin, count, y.data());
+        view->getFieldArray(Dimension::Id::Z, begin, count, z.data());
+        transform(x.data(), y.data(), z.data(), success.data(), count);
+        view->setFieldArray(Dimension::Id::X, begin, count, x.data());
+        view->setFieldArray(Dimension::Id::Y, begin, count, y.data());
+        view->setFieldArray(Dimension::Id::Z, begin, count, z.data());
+
+        for (point_count_t i = 0; i < count; ++i)
+            if (success[i])
+                outView->appendPoint(*view, begin + i);
     }
 
     viewSet.insert(outView);
@@ -155,7 +217,7 @@ bool ReprojectionFilter::processOne(PointRef& point)
     double y(point.getFieldAs<double>(Dimension::Id::Y));
     double z(point.getFieldAs<double>(Dimension::Id::Z));
 
-    if (OCTTransform(m_transform_ptr, 1, &x, &y, &z))
+    if (OCTTransform(m_transform.get(), 1, &x, &y, &z))
     {
         point.setField(Dimension::Id::X, x);
         point.setField(Dimension::Id::Y, y);
@@ -169,4 +231,28 @@ bool ReprojectionFilter::processOne(PointRef& point)
     }
 }
 
+
+// Transform all the points of the batch at once.  Points that have been
+// filtered out go along since it's cheaper than picking them out.
+void ReprojectionFilter::processBatch(StreamPointTable& table,
+    PointId begin, PointId end, std::vector<bool>& keep)
+{
+    const point_count_t count = end - begin;
+    std::vector<double> x(count);
+    std::vector<double> y(count);
+    std::vector<double> z(count);
+    std::vector<int> success(count);
+
+    table.getFieldArray(Dimension::Id::X, begin, count, x.data());
+    table.getFieldArray(Dimension::Id::Y, begin, count, y.data());
+    table.getFieldArray(Dimension::Id::Z, begin, count, z.data());
+    transform(x.data(), y.data(), z.data(), success.data(), count);
+    for (point_count_t i = 0; i < count; ++i)
+        if (!success[i])
+            keep[i] = false;
+    table.setFieldArray(Dimension::Id::X, begin, count, x.data());
+    table.setFieldArray(Dimension::Id::Y, begin, count, y.data());
+    table.setFieldArray(Dimension::Id::Z, begin, count, z.data());
+}
+
 } // namespace pdal
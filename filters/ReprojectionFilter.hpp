@@ -38,6 +38,7 @@
 #include <pdal/Streamable.hpp>
 
 #include <memory>
+#include <vector>
 
 namespace pdal
 {
@@ -53,22 +54,35 @@ public:
 private:
     virtual void addArgs(ProgramArgs& args);
     virtual void initialize();
+    virtual bool dimensionsUsed(PointLayoutPtr,
+        Dimension::IdList& dims) const
+    {
+        dims.insert(dims.end(),
+            { Dimension::Id::X, Dimension::Id::Y, Dimension::Id::Z });
+        return true;
+    }
     virtual PointViewSet run(PointViewPtr view);
     virtual bool processOne(PointRef& point);
+    virtual void processBatch(StreamPointTable& table, PointId begin,
+        PointId end, std::vector<bool>& keep);
     virtual void spatialReferenceChanged(const SpatialReference& srs);
 
     void updateBounds();
     void createTransform(const SpatialReference& srs);
+    void transform(double *x, double *y, double *z, int *success,
+        point_count_t count);
 
     SpatialReference m_inSRS;
     SpatialReference m_outSRS;
     bool m_inferInputSRS;
 
-    typedef void* ReferencePtr;
-    typedef void* TransformPtr;
-    ReferencePtr m_in_ref_ptr;
-    ReferencePtr m_out_ref_ptr;
-    TransformPtr m_transform_ptr;
+    // OGR transformations can't be shared between threads, so each
+    // thread that transforms points borrows its own from the process-wide
+    // cache in GDALUtils.
+    typedef std::shared_ptr<void> TransformPtr;
+    TransformPtr acquireTransform();
+
+    TransformPtr m_transform;
 
     ReprojectionFilter& operator=(const ReprojectionFilter&); // not implemented
     ReprojectionFilter(const ReprojectionFilter&); // not implemented
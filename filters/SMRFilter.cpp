@@ -43,6 +43,7 @@
 #include <pdal/KDIndex.hpp>
 #include <pdal/util/FileUtils.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 #include "private/DimRange.hpp"
 #include "private/Segmentation.hpp"
@@ -96,6 +97,35 @@ struct SMRArgs
     std::string m_dir;
     std::vector<DimRange> m_ignored;
     StringList m_returns;
+    double m_tile;
+    double m_buffer;
+};
+
+// Raster covering the points that are classified together.  Its cells line
+// up with those of a raster over the extent of all the points, and it starts
+// at (m_col, m_row) of that raster.
+struct SMRGrid
+{
+    int m_rows;
+    int m_cols;
+    int m_row;
+    int m_col;
+    double m_cell;
+    BOX2D m_bounds;
+    BOX2D m_extent;
+
+    // Cells are found from the extent so that every grid holding a point
+    // puts it in the same cell.
+    int col(double x) const
+    {
+        return static_cast<int>(std::floor(x - m_extent.minx) / m_cell) -
+            m_col;
+    }
+    int row(double y) const
+    {
+        return static_cast<int>(std::floor(y - m_extent.miny) / m_cell) -
+            m_row;
+    }
 };
 
 SMRFilter::SMRFilter() : m_args(new SMRArgs)
@@ -121,6 +151,9 @@ void SMRFilter::addArgs(ProgramArgs& args)
     args.add("ignore", "Ignore values", m_args->m_ignored);
     args.add("returns", "Include last returns?", m_args->m_returns,
              {"last", "only"});
+    args.add("tile", "Tile size for concurrent classification",
+             m_args->m_tile, 0.0);
+    args.add("buffer", "Buffer around each tile", m_args->m_buffer, 0.0);
 }
 
 void SMRFilter::addDimensions(PointLayoutPtr layout)
@@ -161,6 +194,24 @@ void SMRFilter::prepared(PointTableRef table)
             m_args->m_returns.clear();
         }
     }
+
+    if (m_args->m_tile < 0.0)
+        throwError("Option 'tile' must not be negative.");
+    if (m_args->m_buffer < 0.0)
+        throwError("Option 'buffer' must not be negative.");
+    if (m_args->m_tile > 0.0)
+    {
+        // The morphological operations see cells as far away as the
+        // progressive opening and the net cut's opening reach.
+        if (m_args->m_buffer == 0.0)
+            m_args->m_buffer = 2 * m_args->m_window + 4 * m_args->m_cut;
+        if (!m_args->m_dir.empty())
+        {
+            log()->get(LogLevel::Warning) << "Debugging rasters aren't "
+                "written when 'tile' is set.\n";
+            m_args->m_dir.clear();
+        }
+    }
 }
 
 void SMRFilter::ready(PointTableRef table)
@@ -211,49 +262,89 @@ PointViewSet SMRFilter::run(PointViewPtr view)
 
     m_srs = firstView->spatialReference();
 
-    firstView->calculateBounds(m_bounds);
-    m_cols = static_cast<int>(((m_bounds.maxx - m_bounds.minx) /
-            m_args->m_cell) + 1);
-    m_rows = static_cast<int>(((m_bounds.maxy - m_bounds.miny) /
-        m_args->m_cell) + 1);
+    BOX2D extent;
+    firstView->calculateBounds(extent);
+    if (m_args->m_tile > 0.0)
+    {
+        // Points in the buffer of a tile shape its rasters, but only the
+        // tile's own points are classified.
+        std::vector<Segmentation::Tile> tiles = Segmentation::tileView(
+            firstView, m_args->m_tile, m_args->m_buffer);
+        log()->get(LogLevel::Debug) << "Classifying " << tiles.size() <<
+            " tiles.\n";
+        parallelFor(tiles.size(), [&]()
+        {
+            return [&](size_t i)
+            {
+                classify(tiles[i].m_view, tiles[i].m_coreCount, extent);
+                tiles[i].m_view.reset();
+            };
+        }, 1);
+    }
+    else
+        classify(firstView, firstView->size(), extent);
+
+    PointViewPtr outView = view->makeNew();
+    outView->append(*ignoredView);
+    outView->append(*secondView);
+    outView->append(*firstView);
+    viewSet.insert(outView);
+
+    return viewSet;
+}
+
+void SMRFilter::classify(PointViewPtr view, point_count_t count,
+    const BOX2D& extent)
+{
+    SMRGrid grid;
+    grid.m_row = 0;
+    grid.m_col = 0;
+    grid.m_cell = m_args->m_cell;
+    grid.m_extent = extent;
+    view->calculateBounds(grid.m_bounds);
+    grid.m_col = grid.col(grid.m_bounds.minx);
+    grid.m_row = grid.row(grid.m_bounds.miny);
+    grid.m_bounds.minx = extent.minx + grid.m_col * m_args->m_cell;
+    grid.m_bounds.miny = extent.miny + grid.m_row * m_args->m_cell;
+    grid.m_cols = static_cast<int>(((grid.m_bounds.maxx -
+        grid.m_bounds.minx) / m_args->m_cell) + 1);
+    grid.m_rows = static_cast<int>(((grid.m_bounds.maxy -
+        grid.m_bounds.miny) / m_args->m_cell) + 1);
+
+    // Rounding can put the last points of a tile just past the grid.
+    grid.m_cols = (std::max)(grid.m_cols, grid.col(grid.m_bounds.maxx) + 1);
+    grid.m_rows = (std::max)(grid.m_rows, grid.row(grid.m_bounds.maxy) + 1);
 
     // Create raster of minimum Z values per element.
-    std::vector<double> ZImin = createZImin(firstView);
+    std::vector<double> ZImin = createZImin(grid, view);
 
     // Create raster mask of pixels containing low outlier points.
-    std::vector<int> Low = createLowMask(ZImin);
+    std::vector<int> Low = createLowMask(grid, ZImin);
 
     // Create raster mask of net cuts. Net cutting is used to when a scene
     // contains large buildings in highly differentiated terrain.
-    std::vector<int> isNetCell = createNetMask();
+    std::vector<int> isNetCell = createNetMask(grid);
 
     // Apply net cutting to minimum Z raster.
-    std::vector<double> ZInet = createZInet(ZImin, isNetCell);
+    std::vector<double> ZInet = createZInet(grid, ZImin, isNetCell);
 
     // Create raster mask of pixels containing object points. Note that we use
     // ZInet, the result of net cutting, to identify object pixels.
-    std::vector<int> Obj = createObjMask(ZInet);
+    std::vector<int> Obj = createObjMask(grid, ZInet);
 
     // Create raster representing the provisional DEM. Note that we use the
     // original ZImin (not ZInet), however the net cut mask will still force
     // interpolation at these pixels.
     std::vector<double> ZIpro =
-        createZIpro(firstView, ZImin, Low, isNetCell, Obj);
+        createZIpro(grid, ZImin, Low, isNetCell, Obj);
 
     // Classify ground returns by comparing elevation values to the provisional
     // DEM.
-    classifyGround(firstView, ZIpro);
-
-    PointViewPtr outView = view->makeNew();
-    outView->append(*ignoredView);
-    outView->append(*secondView);
-    outView->append(*firstView);
-    viewSet.insert(outView);
-
-    return viewSet;
+    classifyGround(grid, view, count, ZIpro);
 }
 
-void SMRFilter::classifyGround(PointViewPtr view, std::vector<double>& ZIpro)
+void SMRFilter::classifyGround(const SMRGrid& grid, PointViewPtr view,
+    point_count_t count, std::vector<double>& ZIpro)
 {
     // "While many authors use a single value for the elevation threshold, we
     // suggest that a second parameter be used to increase the threshold on
@@ -264,10 +355,10 @@ void SMRFilter::classifyGround(PointViewPtr view, std::vector<double>& ZIpro)
     // vertical displacements yield larger errors on steep slopes, and as a
     // result the BE/OBJ threshold distance should be more permissive at these
     // points."
-    MatrixXd gsurfs(m_rows, m_cols);
-    MatrixXd thresh(m_rows, m_cols);
+    MatrixXd gsurfs(grid.m_rows, grid.m_cols);
+    MatrixXd thresh(grid.m_rows, grid.m_cols);
     {
-        MatrixXd ZIproM = Map<MatrixXd>(ZIpro.data(), m_rows, m_cols);
+        MatrixXd ZIproM = Map<MatrixXd>(ZIpro.data(), grid.m_rows, grid.m_cols);
         MatrixXd scaled = ZIproM / m_args->m_cell;
 
         MatrixXd gx = gradX(scaled);
@@ -275,8 +366,8 @@ void SMRFilter::classifyGround(PointViewPtr view, std::vector<double>& ZIpro)
         gsurfs = (gx.cwiseProduct(gx) + gy.cwiseProduct(gy)).cwiseSqrt();
         std::vector<double> gsurfsV(gsurfs.data(),
                                     gsurfs.data() + gsurfs.size());
-        std::vector<double> gsurfs_fillV = knnfill(view, gsurfsV);
-        gsurfs = Map<MatrixXd>(gsurfs_fillV.data(), m_rows, m_cols);
+        std::vector<double> gsurfs_fillV = knnfill(grid, gsurfsV);
+        gsurfs = Map<MatrixXd>(gsurfs_fillV.data(), grid.m_rows, grid.m_cols);
         thresh =
             (m_args->m_threshold + m_args->m_scalar * gsurfs.array()).matrix();
 
@@ -284,37 +375,37 @@ void SMRFilter::classifyGround(PointViewPtr view, std::vector<double>& ZIpro)
         {
             std::string fname =
                 FileUtils::toAbsolutePath("gx.tif", m_args->m_dir);
-            writeMatrix(gx, fname, "GTiff", m_args->m_cell, m_bounds, m_srs);
+            writeMatrix(gx, fname, "GTiff", m_args->m_cell, grid.m_bounds,
+                        m_srs);
 
             fname = FileUtils::toAbsolutePath("gy.tif", m_args->m_dir);
-            writeMatrix(gy, fname, "GTiff", m_args->m_cell, m_bounds, m_srs);
+            writeMatrix(gy, fname, "GTiff", m_args->m_cell, grid.m_bounds,
+                        m_srs);
 
             fname = FileUtils::toAbsolutePath("gsurfs.tif", m_args->m_dir);
-            writeMatrix(gsurfs, fname, "GTiff", m_args->m_cell, m_bounds,
+            writeMatrix(gsurfs, fname, "GTiff", m_args->m_cell, grid.m_bounds,
                         m_srs);
 
             fname = FileUtils::toAbsolutePath("gsurfs_fill.tif", m_args->m_dir);
             MatrixXd gsurfs_fill =
-                Map<MatrixXd>(gsurfs_fillV.data(), m_rows, m_cols);
-            writeMatrix(gsurfs_fill, fname, "GTiff", m_args->m_cell, m_bounds,
-                        m_srs);
+                Map<MatrixXd>(gsurfs_fillV.data(), grid.m_rows, grid.m_cols);
+            writeMatrix(gsurfs_fill, fname, "GTiff", m_args->m_cell,
+                        grid.m_bounds, m_srs);
 
             fname = FileUtils::toAbsolutePath("thresh.tif", m_args->m_dir);
-            writeMatrix(thresh, fname, "GTiff", m_args->m_cell, m_bounds,
+            writeMatrix(thresh, fname, "GTiff", m_args->m_cell, grid.m_bounds,
                         m_srs);
         }
     }
 
-    for (PointId i = 0; i < view->size(); ++i)
+    for (PointId i = 0; i < count; ++i)
     {
         double x = view->getFieldAs<double>(Id::X, i);
         double y = view->getFieldAs<double>(Id::Y, i);
         double z = view->getFieldAs<double>(Id::Z, i);
 
-        size_t c =
-            static_cast<size_t>(std::floor(x - m_bounds.minx) / m_args->m_cell);
-        size_t r =
-            static_cast<size_t>(std::floor(y - m_bounds.miny) / m_args->m_cell);
+        size_t c = static_cast<size_t>(grid.col(x));
+        size_t r = static_cast<size_t>(grid.row(y));
 
         // TODO(chambbj): We don't quite do this by the book and yet it seems to
         // work reasonably well:
@@ -325,7 +416,7 @@ void SMRFilter::classifyGround(PointViewPtr view, std::vector<double>& ZIpro)
         // DEM nearly corresponds to the resolution of the LIDAR data. Based on
         // these results, we find that a splined cubic interpolation provides
         // the best results."
-        if (std::isnan(ZIpro[c * m_rows + r]))
+        if (std::isnan(ZIpro[c * grid.m_rows + r]))
             continue;
 
         if (std::isnan(gsurfs(r, c)))
@@ -335,14 +426,15 @@ void SMRFilter::classifyGround(PointViewPtr view, std::vector<double>& ZIpro)
         // ground/object LIDAR points. This is accomplished by measuring the
         // vertical distance between each LIDAR point and the provisional
         // DEM, and applying a threshold calculation."
-        if (std::fabs(ZIpro[c * m_rows + r] - z) > thresh(r, c))
+        if (std::fabs(ZIpro[c * grid.m_rows + r] - z) > thresh(r, c))
             view->setField(Id::Classification, i, 1);
         else
             view->setField(Id::Classification, i, 2);
     }
 }
 
-std::vector<int> SMRFilter::createLowMask(std::vector<double> const& ZImin)
+std::vector<int> SMRFilter::createLowMask(const SMRGrid& grid,
+                                          std::vector<double> const& ZImin)
 {
     // "[The] minimum surface is checked for low outliers by inverting the point
     // cloud in the z-axis and applying the filter with parameters (slope =
@@ -353,21 +445,21 @@ std::vector<int> SMRFilter::createLowMask(std::vector<double> const& ZImin)
     std::vector<double> negZImin;
     std::transform(ZImin.begin(), ZImin.end(), std::back_inserter(negZImin),
                    [](double v) { return -v; });
-    std::vector<int> LowV = progressiveFilter(negZImin, 5.0, 1.0);
+    std::vector<int> LowV = progressiveFilter(grid, negZImin, 5.0, 1.0);
 
     if (!m_args->m_dir.empty())
     {
         std::string fname =
             FileUtils::toAbsolutePath("zilow.tif", m_args->m_dir);
-        MatrixXi Low = Map<MatrixXi>(LowV.data(), m_rows, m_cols);
+        MatrixXi Low = Map<MatrixXi>(LowV.data(), grid.m_rows, grid.m_cols);
         writeMatrix(Low.cast<double>(), fname, "GTiff", m_args->m_cell,
-                    m_bounds, m_srs);
+                    grid.m_bounds, m_srs);
     }
 
     return LowV;
 }
 
-std::vector<int> SMRFilter::createNetMask()
+std::vector<int> SMRFilter::createNetMask(const SMRGrid& grid)
 {
     // "To accommodate the removal of [very large buildings on highly
     // differentiated terrain], we implemented a feature in the published SMRF
@@ -376,23 +468,27 @@ std::vector<int> SMRFilter::createNetMask()
     // at a spacing equal to the maximum window diameter, where these minimum
     // values are found by applying a morphological open operation with a disk
     // shaped structuring element of radius (2*wkmax)."
-    std::vector<int> isNetCell(m_rows * m_cols, 0);
+    std::vector<int> isNetCell(grid.m_rows * grid.m_cols, 0);
     if (m_args->m_cut > 0.0)
     {
         int v = ceil<int>(m_args->m_cut / m_args->m_cell);
 
-        for (auto c = 0; c < m_cols; c += v)
+        // The net is laid out over all the points, whatever part of them
+        // the grid covers.
+        int firstCol = (v - grid.m_col % v) % v;
+        int firstRow = (v - grid.m_row % v) % v;
+        for (auto c = firstCol; c < grid.m_cols; c += v)
         {
-            for (auto r = 0; r < m_rows; ++r)
+            for (auto r = 0; r < grid.m_rows; ++r)
             {
-                isNetCell[c * m_rows + r] = 1;
+                isNetCell[c * grid.m_rows + r] = 1;
             }
         }
-        for (auto c = 0; c < m_cols; ++c)
+        for (auto c = 0; c < grid.m_cols; ++c)
         {
-            for (auto r = 0; r < m_rows; r += v)
+            for (auto r = firstRow; r < grid.m_rows; r += v)
             {
-                isNetCell[c * m_rows + r] = 1;
+                isNetCell[c * grid.m_rows + r] = 1;
             }
         }
     }
@@ -400,34 +496,36 @@ std::vector<int> SMRFilter::createNetMask()
     return isNetCell;
 }
 
-std::vector<int> SMRFilter::createObjMask(std::vector<double> const& ZImin)
+std::vector<int> SMRFilter::createObjMask(const SMRGrid& grid,
+                                          std::vector<double> const& ZImin)
 {
     // "The second stage of the ground identification algorithm involves the
     // application of a progressive morphological filter to the minimum surface
     // grid (ZImin)."
     std::vector<int> ObjV =
-        progressiveFilter(ZImin, m_args->m_slope, m_args->m_window);
+        progressiveFilter(grid, ZImin, m_args->m_slope, m_args->m_window);
 
     if (!m_args->m_dir.empty())
     {
         std::string fname =
             FileUtils::toAbsolutePath("ziobj.tif", m_args->m_dir);
-        MatrixXi Obj = Map<MatrixXi>(ObjV.data(), m_rows, m_cols);
+        MatrixXi Obj = Map<MatrixXi>(ObjV.data(), grid.m_rows, grid.m_cols);
         writeMatrix(Obj.cast<double>(), fname, "GTiff", m_args->m_cell,
-                    m_bounds, m_srs);
+                    grid.m_bounds, m_srs);
     }
 
     return ObjV;
 }
 
-std::vector<double> SMRFilter::createZImin(PointViewPtr view)
+std::vector<double> SMRFilter::createZImin(const SMRGrid& grid,
+                                           PointViewPtr view)
 {
     using namespace Dimension;
 
     // "As with many other ground filtering algorithms, the first step is
     // generation of ZImin from the cell size parameter and the extent of the
     // data."
-    std::vector<double> ZIminV(m_rows * m_cols,
+    std::vector<double> ZIminV(grid.m_rows * grid.m_cols,
                                std::numeric_limits<double>::quiet_NaN());
 
     for (PointId i = 0; i < view->size(); ++i)
@@ -436,36 +534,40 @@ std::vector<double> SMRFilter::createZImin(PointViewPtr view)
         double y = view->getFieldAs<double>(Id::Y, i);
         double z = view->getFieldAs<double>(Id::Z, i);
 
-        int c = static_cast<int>(floor(x - m_bounds.minx) / m_args->m_cell);
-        int r = static_cast<int>(floor(y - m_bounds.miny) / m_args->m_cell);
+        int c = grid.col(x);
+        int r = grid.row(y);
 
-        if (z < ZIminV[c * m_rows + r] || std::isnan(ZIminV[c * m_rows + r]))
-            ZIminV[c * m_rows + r] = z;
+        double& zmin = ZIminV[c * grid.m_rows + r];
+        if (z < zmin || std::isnan(zmin))
+            zmin = z;
     }
 
     // "...some grid points of ZImin will go unfilled. To fill these values, we
     // rely on computationally inexpensive image inpainting techniques. Image
     // inpainting involves the replacement of the empty cells in an image (or
     // matrix) with values calculated from other nearby values."
-    std::vector<double> ZImin_fillV = knnfill(view, ZIminV);
+    std::vector<double> ZImin_fillV = knnfill(grid, ZIminV);
 
     if (!m_args->m_dir.empty())
     {
         std::string fname =
             FileUtils::toAbsolutePath("zimin.tif", m_args->m_dir);
-        MatrixXd ZImin = Map<MatrixXd>(ZIminV.data(), m_rows, m_cols);
-        writeMatrix(ZImin, fname, "GTiff", m_args->m_cell, m_bounds, m_srs);
+        MatrixXd ZImin = Map<MatrixXd>(ZIminV.data(), grid.m_rows, grid.m_cols);
+        writeMatrix(ZImin, fname, "GTiff", m_args->m_cell, grid.m_bounds,
+                    m_srs);
 
         fname = FileUtils::toAbsolutePath("zimin_fill.tif", m_args->m_dir);
-        MatrixXd ZImin_fill = Map<MatrixXd>(ZImin_fillV.data(), m_rows, m_cols);
-        writeMatrix(ZImin_fill, fname, "GTiff", m_args->m_cell, m_bounds,
+        MatrixXd ZImin_fill =
+            Map<MatrixXd>(ZImin_fillV.data(), grid.m_rows, grid.m_cols);
+        writeMatrix(ZImin_fill, fname, "GTiff", m_args->m_cell, grid.m_bounds,
                     m_srs);
     }
 
     return ZImin_fillV;
 }
 
-std::vector<double> SMRFilter::createZInet(std::vector<double> const& ZImin,
+std::vector<double> SMRFilter::createZInet(const SMRGrid& grid,
+                                           std::vector<double> const& ZImin,
                                            std::vector<int> const& isNetCell)
 {
     // "To accommodate the removal of [very large buildings on highly
@@ -480,16 +582,16 @@ std::vector<double> SMRFilter::createZInet(std::vector<double> const& ZImin,
     {
         int v = ceil<int>(m_args->m_cut / m_args->m_cell);
         std::vector<double> bigErode =
-            erodeDiamond(ZImin, m_rows, m_cols, 2 * v);
+            erodeDiamond(ZImin, grid.m_rows, grid.m_cols, 2 * v);
         std::vector<double> bigOpen =
-            dilateDiamond(bigErode, m_rows, m_cols, 2 * v);
-        for (auto c = 0; c < m_cols; ++c)
+            dilateDiamond(bigErode, grid.m_rows, grid.m_cols, 2 * v);
+        for (auto c = 0; c < grid.m_cols; ++c)
         {
-            for (auto r = 0; r < m_rows; ++r)
+            for (auto r = 0; r < grid.m_rows; ++r)
             {
-                if (isNetCell[c * m_rows + r] == 1)
+                if (isNetCell[c * grid.m_rows + r] == 1)
                 {
-                    ZInetV[c * m_rows + r] = bigOpen[c * m_rows + r];
+                    ZInetV[c * grid.m_rows + r] = bigOpen[c * grid.m_rows + r];
                 }
             }
         }
@@ -499,14 +601,15 @@ std::vector<double> SMRFilter::createZInet(std::vector<double> const& ZImin,
     {
         std::string fname =
             FileUtils::toAbsolutePath("zinet.tif", m_args->m_dir);
-        MatrixXd ZInet = Map<MatrixXd>(ZInetV.data(), m_rows, m_cols);
-        writeMatrix(ZInet, fname, "GTiff", m_args->m_cell, m_bounds, m_srs);
+        MatrixXd ZInet = Map<MatrixXd>(ZInetV.data(), grid.m_rows, grid.m_cols);
+        writeMatrix(ZInet, fname, "GTiff", m_args->m_cell, grid.m_bounds,
+                    m_srs);
     }
 
     return ZInetV;
 }
 
-std::vector<double> SMRFilter::createZIpro(PointViewPtr view,
+std::vector<double> SMRFilter::createZIpro(const SMRGrid& grid,
                                            std::vector<double> const& ZImin,
                                            std::vector<int> const& Low,
                                            std::vector<int> const& isNetCell,
@@ -525,18 +628,20 @@ std::vector<double> SMRFilter::createZIpro(PointViewPtr view,
 
     // "These cells are then inpainted according to the same process described
     // previously, producing a provisional DEM (ZIpro)."
-    std::vector<double> ZIpro_fillV = knnfill(view, ZIproV);
+    std::vector<double> ZIpro_fillV = knnfill(grid, ZIproV);
 
     if (!m_args->m_dir.empty())
     {
         std::string fname =
             FileUtils::toAbsolutePath("zipro.tif", m_args->m_dir);
-        MatrixXd ZIpro = Map<MatrixXd>(ZIproV.data(), m_rows, m_cols);
-        writeMatrix(ZIpro, fname, "GTiff", m_args->m_cell, m_bounds, m_srs);
+        MatrixXd ZIpro = Map<MatrixXd>(ZIproV.data(), grid.m_rows, grid.m_cols);
+        writeMatrix(ZIpro, fname, "GTiff", m_args->m_cell, grid.m_bounds,
+                    m_srs);
 
         fname = FileUtils::toAbsolutePath("zipro_fill.tif", m_args->m_dir);
-        MatrixXd ZIpro_fill = Map<MatrixXd>(ZIpro_fillV.data(), m_rows, m_cols);
-        writeMatrix(ZIpro_fill, fname, "GTiff", m_args->m_cell, m_bounds,
+        MatrixXd ZIpro_fill =
+            Map<MatrixXd>(ZIpro_fillV.data(), grid.m_rows, grid.m_cols);
+        writeMatrix(ZIpro_fill, fname, "GTiff", m_args->m_cell, grid.m_bounds,
                     m_srs);
     }
 
@@ -544,25 +649,29 @@ std::vector<double> SMRFilter::createZIpro(PointViewPtr view,
 }
 
 // Fill voids with the average of eight nearest neighbors.
-std::vector<double> SMRFilter::knnfill(PointViewPtr view,
+std::vector<double> SMRFilter::knnfill(const SMRGrid& grid,
                                        std::vector<double> const& cz)
 {
     // Create a temporary PointView that encodes our raster values so that we
-    // can construct a 2D KDIndex and perform nearest neighbor searches.
-    PointViewPtr temp = view->makeNew();
+    // can construct a 2D KDIndex and perform nearest neighbor searches.  It
+    // has its own table so that tiles don't add points to the same one.
+    PointTable table;
+    table.layout()->registerDims({Id::X, Id::Y, Id::Z});
+    table.finalize();
+    PointViewPtr temp(new PointView(table));
     PointId i(0);
-    for (int c = 0; c < m_cols; ++c)
+    for (int c = 0; c < grid.m_cols; ++c)
     {
-        for (int r = 0; r < m_rows; ++r)
+        for (int r = 0; r < grid.m_rows; ++r)
         {
-            if (std::isnan(cz[c * m_rows + r]))
+            if (std::isnan(cz[c * grid.m_rows + r]))
                 continue;
 
             temp->setField(Id::X, i,
-                           m_bounds.minx + (c + 0.5) * m_args->m_cell);
+                           grid.m_bounds.minx + (c + 0.5) * m_args->m_cell);
             temp->setField(Id::Y, i,
-                           m_bounds.miny + (r + 0.5) * m_args->m_cell);
-            temp->setField(Id::Z, i, cz[c * m_rows + r]);
+                           grid.m_bounds.miny + (r + 0.5) * m_args->m_cell);
+            temp->setField(Id::Z, i, cz[c * grid.m_rows + r]);
             i++;
         }
     }
@@ -573,15 +682,15 @@ std::vector<double> SMRFilter::knnfill(PointViewPtr view,
     // nearest neighbors, and fill the void with the average value of the
     // neighbors.
     std::vector<double> out = cz;
-    for (int c = 0; c < m_cols; ++c)
+    for (int c = 0; c < grid.m_cols; ++c)
     {
-        for (int r = 0; r < m_rows; ++r)
+        for (int r = 0; r < grid.m_rows; ++r)
         {
-            if (!std::isnan(out[c * m_rows + r]))
+            if (!std::isnan(out[c * grid.m_rows + r]))
                 continue;
 
-            double x = m_bounds.minx + (c + 0.5) * m_args->m_cell;
-            double y = m_bounds.miny + (r + 0.5) * m_args->m_cell;
+            double x = grid.m_bounds.minx + (c + 0.5) * m_args->m_cell;
+            double y = grid.m_bounds.miny + (r + 0.5) * m_args->m_cell;
             int k = 8;
             std::vector<PointId> neighbors(k);
             std::vector<double> sqr_dists(k);
@@ -596,7 +705,7 @@ std::vector<double> SMRFilter::knnfill(PointViewPtr view,
                 M1 += (delta / j);
             }
 
-            out[c * m_rows + r] = M1;
+            out[c * grid.m_rows + r] = M1;
         }
     }
 
@@ -606,7 +715,8 @@ std::vector<double> SMRFilter::knnfill(PointViewPtr view,
 // Iteratively open the estimated surface. progressiveFilter can be used to
 // identify both low points and object (i.e., non-ground) points, depending on
 // the inputs.
-std::vector<int> SMRFilter::progressiveFilter(std::vector<double> const& ZImin,
+std::vector<int> SMRFilter::progressiveFilter(const SMRGrid& grid,
+                                              std::vector<double> const& ZImin,
                                               double slope, double max_window)
 {
     // "The maximum window radius is supplied as a distance metric (e.g., 21 m),
@@ -620,15 +730,15 @@ std::vector<int> SMRFilter::progressiveFilter(std::vector<double> const& ZImin,
     // "...the radius of the element at each step [is] increased by one pixel
     // from a starting value of one pixel to the pixel equivalent of the maximum
     // value."
-    std::vector<int> Obj(m_rows * m_cols, 0);
+    std::vector<int> Obj(grid.m_rows * grid.m_cols, 0);
     for (int radius = 1; radius <= max_radius; ++radius)
     {
         // "On the first iteration, the minimum surface (ZImin) is opened using
         // a disk-shaped structuring element with a radius of one pixel."
         std::vector<double> curErosion =
-            erodeDiamond(prevErosion, m_rows, m_cols, 1);
+            erodeDiamond(prevErosion, grid.m_rows, grid.m_cols, 1);
         std::vector<double> curOpening =
-            dilateDiamond(curErosion, m_rows, m_cols, radius);
+            dilateDiamond(curErosion, grid.m_rows, grid.m_cols, radius);
         prevErosion = curErosion;
 
         // "An elevation threshold is then calculated, where the value is equal
@@ -664,6 +774,7 @@ std::vector<int> SMRFilter::progressiveFilter(std::vector<double> const& ZImin,
         size_t ng = std::count(Obj.begin(), Obj.end(), 1);
         size_t g(Obj.size() - ng);
         double p(100.0 * double(ng) / double(Obj.size()));
+        std::lock_guard<std::mutex> lock(m_logMutex);
         log()->floatPrecision(2);
         log()->get(LogLevel::Debug) << "progressiveFilter: radius = " << radius
                                     << "\t" << g << " ground"
@@ -37,12 +37,14 @@
 #include <pdal/Filter.hpp>
 
 #include <memory>
+#include <mutex>
 #include <string>
 
 namespace pdal
 {
 
 struct SMRArgs;
+struct SMRGrid;
 
 class PDAL_DLL SMRFilter : public Filter
 {
@@ -53,11 +55,9 @@ public:
     std::string getName() const;
 
 private:
-    int m_rows;
-    int m_cols;
-    BOX2D m_bounds;
     SpatialReference m_srs;
     std::unique_ptr<SMRArgs> m_args;
+    std::mutex m_logMutex;
 
     virtual void addArgs(ProgramArgs& args);
     virtual void addDimensions(PointLayoutPtr layout);
@@ -65,19 +65,23 @@ private:
     virtual void ready(PointTableRef table);
     virtual PointViewSet run(PointViewPtr view);
 
-    void classifyGround(PointViewPtr, std::vector<double>&);
-    std::vector<int> createLowMask(std::vector<double> const&);
-    std::vector<int> createNetMask();
-    std::vector<int> createObjMask(std::vector<double> const&);
-    std::vector<double> createZImin(PointViewPtr view);
-    std::vector<double> createZInet(std::vector<double> const&,
+    void classify(PointViewPtr view, point_count_t count,
+                  const BOX2D& extent);
+    void classifyGround(const SMRGrid&, PointViewPtr, point_count_t,
+                        std::vector<double>&);
+    std::vector<int> createLowMask(const SMRGrid&, std::vector<double> const&);
+    std::vector<int> createNetMask(const SMRGrid&);
+    std::vector<int> createObjMask(const SMRGrid&, std::vector<double> const&);
+    std::vector<double> createZImin(const SMRGrid&, PointViewPtr view);
+    std::vector<double> createZInet(const SMRGrid&, std::vector<double> const&,
                                     std::vector<int> const&);
-    std::vector<double> createZIpro(PointViewPtr, std::vector<double> const&,
+    std::vector<double> createZIpro(const SMRGrid&, std::vector<double> const&,
                                     std::vector<int> const&,
                                     std::vector<int> const&,
                                     std::vector<int> const&);
-    std::vector<double> knnfill(PointViewPtr, std::vector<double> const&);
-    std::vector<int> progressiveFilter(std::vector<double> const&, double,
+    std::vector<double> knnfill(const SMRGrid&, std::vector<double> const&);
+    std::vector<int> progressiveFilter(const SMRGrid&,
+                                       std::vector<double> const&, double,
                                        double);
 
     SMRFilter& operator=(const SMRFilter&); // not implemented
@@ -34,10 +34,16 @@
 
 #include "SampleFilter.hpp"
 
-#include <pdal/KDIndex.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
 #include <pdal/util/Utils.hpp>
 
+#include <pdal/private/RadixSort.hpp>
+#include "private/VoxelMap.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <string>
 #include <vector>
 
@@ -53,6 +59,74 @@ static StaticPluginInfo const s_info
 
 CREATE_STATIC_STAGE(SampleFilter, s_info)
 
+namespace
+{
+
+typedef std::array<double, 3> Position;
+
+double distance2(const Position& p1, const Position& p2)
+{
+    double dx = p1[0] - p2[0];
+    double dy = p1[1] - p2[1];
+    double dz = p1[2] - p2[2];
+    return dx * dx + dy * dy + dz * dz;
+}
+
+} // unnamed namespace
+
+// Positions of the points kept in stream mode, bucketed in cubes with
+// edges of the radius.  The bounds of the points aren't known in stream
+// mode, so cube indices wrap around in 21 bits.  Cubes that wrap onto
+// the same key only cost extra distance checks.
+class SampleGrid
+{
+public:
+    SampleGrid(double radius) : m_radius(radius)
+    {}
+
+    // Keep a point if no kept point is within the radius.
+    bool add(const Position& p)
+    {
+        int64_t col = (int64_t)std::floor(p[0] / m_radius);
+        int64_t row = (int64_t)std::floor(p[1] / m_radius);
+        int64_t depth = (int64_t)std::floor(p[2] / m_radius);
+        const double r2 = m_radius * m_radius;
+        for (int64_t c = col - 1; c <= col + 1; ++c)
+            for (int64_t r = row - 1; r <= row + 1; ++r)
+                for (int64_t d = depth - 1; d <= depth + 1; ++d)
+                {
+                    const std::vector<Position> *kept =
+                        m_cubes.find(key(c, r, d));
+                    if (kept)
+                        for (const Position& q : *kept)
+                            if (distance2(p, q) < r2)
+                                return false;
+                }
+        m_cubes[key(col, row, depth)].push_back(p);
+        return true;
+    }
+
+private:
+    double m_radius;
+    VoxelMap<std::vector<Position>> m_cubes;
+
+    static uint64_t key(int64_t col, int64_t row, int64_t depth)
+    {
+        const uint64_t mask = (1 << 21) - 1;
+        return (((uint64_t)row & mask) << 42) |
+            (((uint64_t)col & mask) << 21) | ((uint64_t)depth & mask);
+    }
+};
+
+
+SampleFilter::SampleFilter()
+{}
+
+
+SampleFilter::~SampleFilter()
+{}
+
+
 std::string SampleFilter::getName() const
 {
     return s_info.name;
@@ -71,6 +145,34 @@ void SampleFilter::addDimensions(PointLayoutPtr layout)
 }
 
 
+void SampleFilter::initialize()
+{
+    if (m_radius <= 0)
+        throwError("Option 'radius' must be positive.");
+}
+
+
+void SampleFilter::ready(PointTableRef)
+{
+    m_grid.reset(new SampleGrid(m_radius));
+}
+
+
+bool SampleFilter::processOne(PointRef& point)
+{
+    Position p { point.getFieldAs<double>(Dimension::Id::X),
+        point.getFieldAs<double>(Dimension::Id::Y),
+        point.getFieldAs<double>(Dimension::Id::Z) };
+    return m_grid->add(p);
+}
+
+
+void SampleFilter::done(PointTableRef)
+{
+    m_grid.reset();
+}
+
+
 PointViewSet SampleFilter::run(PointViewPtr inView)
 {
     point_count_t np = inView->size();
@@ -82,29 +184,130 @@ PointViewSet SampleFilter::run(PointViewPtr inView)
         return viewSet;
     PointViewPtr outView = inView->makeNew();
 
-    // Build the 3D KD-tree.
-    KD3Index& index = inView->build3dIndex();
-
-    // All points are marked as kept (1) by default. As they are masked by
-    // neighbors within the user-specified radius, their value is changed to 0.
-    std::vector<int> keep(np, 1);
+    BOX3D bounds;
+    inView->calculateBounds(bounds);
+    const VoxelKey voxel(bounds, m_radius);
+    if (!voxel.fits())
+        throwError("Radius is too small for the extent of the points.");
 
-    // We are able to subsample in a single pass over the shuffled indices.
+    // Bucket the points in cubes with edges of the radius, so that all the
+    // neighbors of a point within the radius are in the 27 cubes around
+    // it.  The sort is stable, so the points of a cube stay in order.
+    std::vector<Position> pos(np);
+    std::vector<uint64_t> keys(np);
+    std::vector<PointId> ids(np);
     for (PointId i = 0; i < np; ++i)
     {
-        // If a point is masked, it is forever masked, and cannot be part of the
-        // sampled cloud. Otherwise, the current index is appended to the output
-        // PointView.
-        if (keep[i] == 0)
-            continue;
-        outView->appendPoint(*inView, i);
-
-        // We now proceed to mask all neighbors within m_radius of the kept
-        // point.
-        auto ids = index.radius(i, m_radius);
-        for (auto const& id : ids)
-            keep[id] = 0;
+        Position& p = pos[i];
+        p[0] = inView->getFieldAs<double>(Dimension::Id::X, i);
+        p[1] = inView->getFieldAs<double>(Dimension::Id::Y, i);
+        p[2] = inView->getFieldAs<double>(Dimension::Id::Z, i);
+        keys[i] = voxel.key(voxel.col(p[0]), voxel.row(p[1]),
+            voxel.depth(p[2]));
+        ids[i] = i;
     }
+    radixSort(keys, ids);
+
+    struct Cube
+    {
+        size_t m_begin;
+        size_t m_end;
+        size_t m_col;
+        size_t m_row;
+        size_t m_depth;
+        std::vector<PointId> m_kept;
+    };
+
+    // Cubes are split into 27 phases by their indices modulo three.  The
+    // neighbors of two cubes in the same phase don't overlap, so the cubes
+    // of a phase can be sampled at once.
+    std::vector<Cube> cubes;
+    VoxelMap<size_t> cubeIndex;
+    std::vector<size_t> phases[27];
+    for (size_t begin = 0; begin < np;)
+    {
+        size_t end = begin + 1;
+        while (end < np && keys[end] == keys[begin])
+            end++;
+
+        const Position& p = pos[ids[begin]];
+        Cube cube;
+        cube.m_begin = begin;
+        cube.m_end = end;
+        cube.m_col = voxel.col(p[0]);
+        cube.m_row = voxel.row(p[1]);
+        cube.m_depth = voxel.depth(p[2]);
+        cubeIndex[keys[begin]] = cubes.size();
+        phases[(cube.m_col % 3) * 9 + (cube.m_row % 3) * 3 +
+            cube.m_depth % 3].push_back(cubes.size());
+        cubes.push_back(std::move(cube));
+        begin = end;
+    }
+    std::vector<uint64_t>().swap(keys);
+
+    const size_t maxCol = voxel.col(bounds.maxx);
+    const size_t maxRow = voxel.row(bounds.maxy);
+    const size_t maxDepth = voxel.depth(bounds.maxz);
+    const double r2 = m_radius * m_radius;
+
+    // Keep a point of a cube if no point kept so far in it or its
+    // neighbors is within the radius.
+    auto sample = [&](Cube& cube)
+    {
+        const size_t c0 = cube.m_col ? cube.m_col - 1 : 0;
+        const size_t r0 = cube.m_row ? cube.m_row - 1 : 0;
+        const size_t d0 = cube.m_depth ? cube.m_depth - 1 : 0;
+        const size_t c1 = (std::min)(cube.m_col + 1, maxCol);
+        const size_t r1 = (std::min)(cube.m_row + 1, maxRow);
+        const size_t d1 = (std::min)(cube.m_depth + 1, maxDepth);
+
+        std::vector<const Cube *> neighbors;
+        for (size_t c = c0; c <= c1; ++c)
+            for (size_t r = r0; r <= r1; ++r)
+                for (size_t d = d0; d <= d1; ++d)
+                {
+                    const size_t *idx = cubeIndex.find(voxel.key(c, r, d));
+                    if (idx && &cubes[*idx] != &cube)
+                        neighbors.push_back(&cubes[*idx]);
+                }
+        neighbors.push_back(&cube);
+
+        for (size_t i = cube.m_begin; i < cube.m_end; ++i)
+        {
+            const Position& p = pos[ids[i]];
+            bool keep = true;
+            for (const Cube *n : neighbors)
+            {
+                for (PointId id : n->m_kept)
+                    if (distance2(p, pos[id]) < r2)
+                    {
+                        keep = false;
+                        break;
+                    }
+                if (!keep)
+                    break;
+            }
+            if (keep)
+                cube.m_kept.push_back(ids[i]);
+        }
+    };
+
+    for (const std::vector<size_t>& phase : phases)
+        parallelFor(phase.size(), [&]()
+        {
+            return [&](size_t i)
+            {
+                sample(cubes[phase[i]]);
+            };
+        }, 64);
+
+    // Append the kept points in their original order.
+    std::vector<PointId> kept;
+    for (const Cube& cube : cubes)
+        kept.insert(kept.end(), cube.m_kept.begin(), cube.m_kept.end());
+    std::sort(kept.begin(), kept.end());
+    for (PointId id : kept)
+        outView->appendPoint(*inView, id);
 
     // Simply calculate the percentage of retained points.
     double frac = (double)outView->size() / (double)inView->size();
@@ -35,19 +35,22 @@
 #pragma once
 
 #include <pdal/Filter.hpp>
+#include <pdal/Streamable.hpp>
 
+#include <memory>
 #include <string>
 
 namespace pdal
 {
 
 class Options;
+class SampleGrid;
 
-class PDAL_DLL SampleFilter : public pdal::Filter
+class PDAL_DLL SampleFilter : public pdal::Filter, public pdal::Streamable
 {
 public:
-    SampleFilter() : Filter()
-    {}
+    SampleFilter();
+    ~SampleFilter();
     SampleFilter& operator=(const SampleFilter&) = delete;
     SampleFilter(const SampleFilter&) = delete;
 
@@ -55,9 +58,14 @@ public:
 
 private:
     double m_radius;
+    std::unique_ptr<SampleGrid> m_grid;
 
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
+    virtual void ready(PointTableRef table);
+    virtual bool processOne(PointRef& point);
+    virtual void done(PointTableRef table);
     virtual PointViewSet run(PointViewPtr view);
 };
 
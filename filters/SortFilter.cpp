@@ -34,13 +34,19 @@
 
 #include "SortFilter.hpp"
 
+#include <numeric>
+
+#include <pdal/util/ThreadPool.hpp>
+
+#include <pdal/private/RadixSort.hpp>
+
 namespace pdal
 {
 
 static StaticPluginInfo const s_info
 {
     "filters.sort",
-    "Sort data based on a given dimension.",
+    "Sort data based on the values of one or more dimensions.",
     "http://pdal.io/stages/filters.sort.html"
 };
 
@@ -50,27 +56,59 @@ std::string SortFilter::getName() const { return s_info.name; }
 
 void SortFilter::addArgs(ProgramArgs& args)
 {
-    args.add("dimension", "Dimension on which to sort", m_dimName).
+    args.add("dimension", "Dimension on which to sort.  Separate several "
+        "dimensions with commas to sort by each in turn", m_dimName).
         setPositional();
     args.add("order", "Sort order ASC(ending) or DESC(ending)", m_order, SortOrder::ASC);
 }
 
 void SortFilter::prepared(PointTableRef table)
 {
-    m_dim = table.layout()->findDim(m_dimName);
-    if (m_dim == Dimension::Id::Unknown)
-        throwError("Dimension '" + m_dimName + "' not found.");
+    m_dims.clear();
+    for (std::string name : Utils::split2(m_dimName, ','))
+    {
+        Utils::trim(name);
+        Dimension::Id dim = table.layout()->findDim(name);
+        if (dim == Dimension::Id::Unknown)
+            throwError("Dimension '" + name + "' not found.");
+        m_dims.push_back(dim);
+    }
+    if (m_dims.empty())
+        throwError("No dimension on which to sort.");
+}
+
+
+bool SortFilter::dimensionsUsed(PointLayoutPtr,
+    Dimension::IdList& dims) const
+{
+    dims.insert(dims.end(), m_dims.begin(), m_dims.end());
+    return true;
 }
 
+// Sort by the least significant dimension first.  The radix sort is
+// stable, so each later sort keeps the order of points with equal
+// values.  The points of the view are reordered once at the end.
 void SortFilter::filter(PointView& view)
 {
-    auto cmp = [this](const PointIdxRef& p1, const PointIdxRef& p2)
-    {
-        bool result = p1.compare(m_dim, p2);
-        return (m_order == SortOrder::ASC) ? result : !result;
-    };
+    std::vector<PointId> order(view.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::vector<uint64_t> keys(view.size());
 
-    std::stable_sort(view.begin(), view.end(), cmp);
+    for (auto di = m_dims.rbegin(); di != m_dims.rend(); ++di)
+    {
+        SortKey makeKey(*di, view.layout()->dimType(*di),
+            m_order == SortOrder::DESC);
+        parallelFor(order.size(), [&]()
+        {
+            return [&](std::size_t i)
+            {
+                PointRef point(view, order[i]);
+                keys[i] = makeKey(point);
+            };
+        }, 1 << 16);
+        radixSort(keys, order, makeKey.bytes());
+    }
+    view.reorder(order);
 }
 
 std::istream& operator >> (std::istream& in, SortOrder& order)
@@ -94,8 +132,10 @@ std::ostream& operator<<(std::ostream& out, const SortOrder& order)
     {
     case SortOrder::ASC:
         out << "ASC";
+        break;
     case SortOrder::DESC:
         out << "DESC";
+        break;
     }
     return out;
 }
@@ -60,9 +60,9 @@ public:
     std::string getName() const;
 
 private:
-    // Dimension on which to sort.
-    Dimension::Id m_dim;
-    // Dimension name.
+    // Dimensions on which to sort, most significant first.
+    Dimension::IdList m_dims;
+    // Comma-separated dimension names.
     std::string m_dimName;
 
     // Sort order.
@@ -70,6 +70,10 @@ private:
 
     virtual void addArgs(ProgramArgs& args);
     virtual void prepared(PointTableRef table);
+    virtual bool dimensionsUsed(PointLayoutPtr layout,
+        Dimension::IdList& dims) const;
+    virtual bool pushdownBounds(BOX3D&) const
+        { return true; }
     virtual void filter(PointView& view);
 
     SortFilter& operator=(const SortFilter&) = delete;
@@ -38,6 +38,9 @@
 #include <iostream>
 #include <limits>
 
+#include <pdal/StageFactory.hpp>
+#include <pdal/StageWrapper.hpp>
+#include <pdal/Writer.hpp>
 #include <pdal/util/ProgramArgs.hpp>
 
 namespace pdal
@@ -52,9 +55,18 @@ static StaticPluginInfo const s_info
 
 CREATE_STATIC_STAGE(SplitterFilter, s_info)
 
-SplitterFilter::SplitterFilter() : m_viewMap(CoordCompare())
+SplitterFilter::SplitterFilter() : m_viewMap(CoordCompare()),
+    m_hashPos(std::string::npos), m_maxWriters(100), m_table(nullptr)
+{
+    m_writeAdder = [this](PointRef& point, int xpos, int ypos)
+        { writePoint(point, xpos, ypos); };
+}
+
+
+SplitterFilter::~SplitterFilter()
 {}
 
+
 std::string SplitterFilter::getName() const { return s_info.name; }
 
 void SplitterFilter::addArgs(ProgramArgs& args)
@@ -66,6 +78,11 @@ void SplitterFilter::addArgs(ProgramArgs& args)
         std::numeric_limits<double>::quiet_NaN());
     args.add("buffer", "Size of buffer (overlap) to include around each tile.",
         m_buffer, 0.0);
+    args.add("filename", "Output filename template.  If set, the points of "
+        "each tile are written to a file named by replacing '#' with the "
+        "tile's position", m_filename);
+    args.add("max_writers", "Maximum number of tile files open at once",
+        m_maxWriters, (size_t)100);
 }
 
 
@@ -78,6 +95,124 @@ void SplitterFilter::initialize()
             ") must be less than half of length (" << m_length << ")";
         throwError(oss.str());
     }
+    if (m_filename.size())
+    {
+        m_hashPos = Writer::handleFilenameTemplate(m_filename);
+        if (m_hashPos == std::string::npos)
+            throwError("Option 'filename' must contain a single '#' "
+                "template placeholder.");
+        if (m_maxWriters == 0)
+            throwError("Option 'max_writers' must be greater than 0.");
+    }
+}
+
+
+void SplitterFilter::ready(PointTableRef table)
+{
+    m_table = &table;
+    m_parts.clear();
+    if (m_filename.size())
+        m_factory.reset(new StageFactory);
+}
+
+
+void SplitterFilter::spatialReferenceChanged(const SpatialReference& srs)
+{
+    m_srs = srs;
+    for (auto& wp : m_writers)
+        StreamableWrapper::spatialReferenceChanged(*wp.second.m_writer, srs);
+}
+
+
+bool SplitterFilter::processOne(PointRef& point)
+{
+    // Use the location of the first point as the origin, unless specified.
+    if (std::isnan(m_xOrigin))
+        m_xOrigin = point.getFieldAs<double>(Dimension::Id::X);
+    if (std::isnan(m_yOrigin))
+        m_yOrigin = point.getFieldAs<double>(Dimension::Id::Y);
+    processPoint(point, m_writeAdder);
+    return true;
+}
+
+
+void SplitterFilter::writePoint(PointRef& point, int xpos, int ypos)
+{
+    Coord loc(xpos, ypos);
+
+    // Keep the most recently used writer at the front of the LRU list.
+    auto wi = m_writers.find(loc);
+    if (wi == m_writers.end())
+    {
+        if (m_writers.size() == m_maxWriters)
+            closeWriter(m_writers.find(m_lru.back()));
+        wi = openWriter(loc);
+    }
+    else
+        m_lru.splice(m_lru.begin(), m_lru, wi->second.m_lruPos);
+    StreamableWrapper::processOne(*wi->second.m_writer, point);
+}
+
+
+// A tile whose writer was closed to make room for another gets a new file
+// with a part number should more of its points arrive.
+SplitterFilter::WriterMap::iterator
+SplitterFilter::openWriter(const Coord& loc)
+{
+    int part = m_parts[loc]++;
+    std::string name = std::to_string(loc.first) + "_" +
+        std::to_string(loc.second);
+    if (part)
+    {
+        name += "_" + std::to_string(part + 1);
+        log()->get(LogLevel::Debug) << getName() << ": Reopening tile " <<
+            loc.first << "_" << loc.second << " as part " << (part + 1) <<
+            "." << std::endl;
+    }
+    std::string filename(m_filename);
+    filename.replace(m_hashPos, 1, name);
+
+    std::string driver = StageFactory::inferWriterDriver(filename);
+    if (driver.empty())
+        throwError("Can't infer a writer for output file '" + filename +
+            "'.");
+    Streamable *w = dynamic_cast<Streamable *>(m_factory->createStage(driver));
+    if (!w)
+        throwError("Writer '" + driver + "' for output file '" + filename +
+            "' can't be created or isn't streamable.");
+
+    Options opts;
+    opts.add("filename", filename);
+    w->setOptions(opts);
+    LogPtr l(log());
+    w->setLog(l);
+    w->prepare(*m_table);
+    StageWrapper::ready(*w, *m_table);
+    if (!m_srs.empty())
+        StreamableWrapper::spatialReferenceChanged(*w, m_srs);
+
+    m_lru.push_front(loc);
+    return m_writers.insert(std::make_pair(loc,
+        TileWriter { w, m_lru.begin() })).first;
+}
+
+
+void SplitterFilter::closeWriter(WriterMap::iterator wi)
+{
+    Streamable *w = wi->second.m_writer;
+    StageWrapper::done(*w, *m_table);
+    m_factory->destroyStage(w);
+    m_lru.erase(wi->second.m_lruPos);
+    m_writers.erase(wi);
+}
+
+
+void SplitterFilter::done(PointTableRef table)
+{
+    while (m_writers.size())
+        closeWriter(m_writers.begin());
+    m_factory.reset();
+    m_table = nullptr;
 }
 
 
@@ -94,6 +229,20 @@ PointViewSet SplitterFilter::run(PointViewPtr inView)
     if (!inView->size())
         return viewSet;
 
+    // Write the tiles and pass the points through.
+    if (m_filename.size())
+    {
+        spatialReferenceChanged(inView->spatialReference());
+        PointRef point(*inView, 0);
+        for (PointId idx = 0; idx < inView->size(); idx++)
+        {
+            point.setPointId(idx);
+            processOne(point);
+        }
+        viewSet.insert(inView);
+        return viewSet;
+    }
+
     auto addPoint = [this, &inView](PointRef& point, int xpos, int ypos) {
         Coord loc(xpos, ypos);
         PointViewPtr& outView = m_viewMap[loc];
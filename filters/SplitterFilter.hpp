@@ -35,11 +35,17 @@
 #pragma once
 
 #include <pdal/Filter.hpp>
+#include <pdal/Streamable.hpp>
+
+#include <list>
+#include <memory>
 
 namespace pdal
 {
 
-class PDAL_DLL SplitterFilter : public pdal::Filter
+class StageFactory;
+
+class PDAL_DLL SplitterFilter : public pdal::Filter, public pdal::Streamable
 {
 private:
     //This used to be a lambda, but the VS compiler exploded, I guess.
@@ -56,8 +62,16 @@ private:
         };
     };
 
+    struct TileWriter
+    {
+        Streamable *m_writer;
+        std::list<Coord>::iterator m_lruPos;
+    };
+    using WriterMap = std::map<Coord, TileWriter, CoordCompare>;
+
 public:
     SplitterFilter();
+    ~SplitterFilter();
     using PointAdder = std::function<void(PointRef&, int, int)>;
 
     std::string getName() const;
@@ -71,10 +85,31 @@ private:
     double m_buffer;
     std::map<Coord, PointViewPtr, CoordCompare> m_viewMap;
 
+    // Writing tiles directly (stream mode).
+    std::string m_filename;
+    std::string::size_type m_hashPos;
+    size_t m_maxWriters;
+    std::unique_ptr<StageFactory> m_factory;
+    WriterMap m_writers;
+    std::list<Coord> m_lru;
+    std::map<Coord, int, CoordCompare> m_parts;
+    BasePointTable *m_table;
+    SpatialReference m_srs;
+    PointAdder m_writeAdder;
+
     virtual void addArgs(ProgramArgs& args);
     virtual void initialize();
+    virtual void ready(PointTableRef table);
+    virtual bool canStream() const
+        { return !m_filename.empty(); }
+    virtual bool processOne(PointRef& point);
+    virtual void spatialReferenceChanged(const SpatialReference& srs);
     virtual PointViewSet run(PointViewPtr view);
+    virtual void done(PointTableRef table);
     bool squareContains(int xpos, int ypos, double x, double y) const;
+    void writePoint(PointRef& point, int xpos, int ypos);
+    WriterMap::iterator openWriter(const Coord& loc);
+    void closeWriter(WriterMap::iterator wi);
 
     SplitterFilter& operator=(const SplitterFilter&); // not implemented
     SplitterFilter(const SplitterFilter&); // not implemented
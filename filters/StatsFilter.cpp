@@ -34,13 +34,16 @@
 
 #include "StatsFilter.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <unordered_map>
+#include <vector>
 
 #include <pdal/Options.hpp>
 #include <pdal/Polygon.hpp>
 #include <pdal/PDALUtils.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 #include <json/json.h>
 
@@ -61,8 +64,134 @@ std::string StatsFilter::getName() const { return s_info.name; }
 namespace stats
 {
 
+void TDigest::merge(const TDigest& other)
+{
+    m_buffer.insert(m_buffer.end(), other.m_centroids.begin(),
+        other.m_centroids.end());
+    m_buffer.insert(m_buffer.end(), other.m_buffer.begin(),
+        other.m_buffer.end());
+    m_count += other.m_count;
+    m_min = (std::min)(m_min, other.m_min);
+    m_max = (std::max)(m_max, other.m_max);
+    compress();
+}
+
+
+// Merge the buffered values into the centroids.  Neighboring centroids
+// are combined as long as the combination spans no more than one unit of
+// the scale function k(q) = c / (2 * pi) * asin(2q - 1), which limits the
+// number of centroids to about the compression (c), and keeps those near
+// q = 0 and q = 1 small.
+void TDigest::compress()
+{
+    if (m_buffer.empty())
+        return;
+
+    m_buffer.insert(m_buffer.end(), m_centroids.begin(), m_centroids.end());
+    std::sort(m_buffer.begin(), m_buffer.end(),
+        [](const Centroid& a, const Centroid& b)
+        { return a.m_mean < b.m_mean; });
+
+    double total = 0;
+    for (const Centroid& c : m_buffer)
+        total += c.m_weight;
+
+    const double pi = 3.14159265358979323846;
+    auto k = [this, pi](double q)
+        { return m_compression / (2 * pi) * std::asin(2 * q - 1); };
+    auto kInverse = [this, pi](double k)
+        { return (std::sin(k * 2 * pi / m_compression) + 1) / 2; };
+
+    m_centroids.clear();
+    Centroid cur = m_buffer.front();
+    double soFar = 0;
+    double limit = total * kInverse(k(0) + 1);
+    for (auto it = m_buffer.begin() + 1; it != m_buffer.end(); ++it)
+    {
+        if (soFar + cur.m_weight + it->m_weight <= limit)
+        {
+            cur.m_weight += it->m_weight;
+            cur.m_mean += (it->m_mean - cur.m_mean) * it->m_weight /
+                cur.m_weight;
+        }
+        else
+        {
+            soFar += cur.m_weight;
+            m_centroids.push_back(cur);
+            limit = total * kInverse(k(soFar / total) + 1);
+            cur = *it;
+        }
+    }
+    m_centroids.push_back(cur);
+    m_buffer.clear();
+}
+
 
-void Summary::extractMetadata(MetadataNode &m)
+// Interpolate between the means of the centroids on either side of the
+// position of the quantile, or the minimum or maximum at the ends.
+double TDigest::quantile(double q)
+{
+    compress();
+    if (m_centroids.empty())
+        return 0;
+
+    const double target = (std::max)(0.0, (std::min)(1.0, q)) * m_count;
+    double prevPos = 0;
+    double prevMean = m_min;
+    double pos = 0;
+    for (const Centroid& c : m_centroids)
+    {
+        double center = pos + c.m_weight / 2;
+        if (target < center)
+        {
+            if (center == prevPos)
+                return c.m_mean;
+            return prevMean + (c.m_mean - prevMean) *
+                (target - prevPos) / (center - prevPos);
+        }
+        prevPos = center;
+        prevMean = c.m_mean;
+        pos += c.m_weight;
+    }
+    if (target >= m_count || pos == prevPos)
+        return m_max;
+    return prevMean + (m_max - prevMean) * (target - prevPos) /
+        (pos - prevPos);
+}
+
+
+// The inverse of quantile().
+double TDigest::cdf(double x)
+{
+    compress();
+    if (m_centroids.empty() || x <= m_min)
+        return 0;
+    if (x >= m_max)
+        return 1;
+
+    double prevPos = 0;
+    double prevMean = m_min;
+    double pos = 0;
+    for (const Centroid& c : m_centroids)
+    {
+        double center = pos + c.m_weight / 2;
+        if (x < c.m_mean)
+        {
+            if (c.m_mean == prevMean)
+                return prevPos / m_count;
+            return (prevPos + (center - prevPos) * (x - prevMean) /
+                (c.m_mean - prevMean)) / m_count;
+        }
+        prevPos = center;
+        prevMean = c.m_mean;
+        pos += c.m_weight;
+    }
+    return (prevPos + (pos - prevPos) * (x - prevMean) /
+        (m_max - prevMean)) / m_count;
+}
+
+
+void Summary::extractMetadata(MetadataNode &m, bool full)
 {
     uint32_t cnt = static_cast<uint32_t>(count());
     m.add("count", cnt, "count");
@@ -90,9 +219,12 @@ void Summary::extractMetadata(MetadataNode &m)
             m.add("skewness", skewness(), "skewness");
     }
 
+    if (!full)
+        return;
+
     if (m_enumerate == Enumerate)
     {
-        for (auto& v : m_values)
+        for (auto& v : values())
             m.addList("values", v.first);
     }
     else if (m_enumerate == Global)
@@ -103,7 +235,7 @@ void Summary::extractMetadata(MetadataNode &m)
     }
     else if (m_enumerate == Count)
     {
-        for (auto& v : m_values)
+        for (auto& v : values())
         {
             std::string val =
                 std::to_string(v.first) + "/" + std::to_string(v.second);
@@ -112,6 +244,19 @@ void Summary::extractMetadata(MetadataNode &m)
     }
 }
 
+const Summary::EnumMap& Summary::values() const
+{
+    m_values.clear();
+    for (size_t i = 0; i < m_dense.size(); ++i)
+        if (m_dense[i])
+            m_values.emplace_hint(m_values.end(),
+                (double)i - (double)m_denseOffset, m_dense[i]);
+    for (auto& v : m_sparse)
+        m_values[v.first] += v.second;
+    return m_values;
+}
+
+
 void Summary::computeGlobalStats()
 {
     auto compute_median = [](std::vector<double> vals)
@@ -121,6 +266,29 @@ void Summary::computeGlobalStats()
         return *(vals.begin()+vals.size()/2);
     };
 
+    if (m_approximate)
+    {
+        if (!m_digest.count())
+            return;
+
+        // The MAD is the distance from the median within which half the
+        // values lie, found by bisection on the distribution.
+        m_median = m_digest.quantile(.5);
+        double lo = 0;
+        double hi = (std::max)(m_median - m_min, m_max - m_median);
+        for (int i = 0; i < 64 && lo < hi; ++i)
+        {
+            double mid = (lo + hi) / 2;
+            if (m_digest.cdf(m_median + mid) -
+                    m_digest.cdf(m_median - mid) < .5)
+                lo = mid;
+            else
+                hi = mid;
+        }
+        m_mad = (lo + hi) / 2;
+        return;
+    }
+
     // TODO add quantiles
     m_median = compute_median(m_data);
     std::transform(m_data.begin(), m_data.end(), m_data.begin(),
@@ -131,6 +299,49 @@ void Summary::computeGlobalStats()
 }
 
 
+// Moments are combined with the pairwise formulas of Pebay, "Formulas
+// for Robust, One-Pass Parallel Computation of Covariances and
+// Arbitrary-Order Statistical Moments" (2008).
+void Summary::merge(const Summary& other)
+{
+    if (!other.m_cnt)
+        return;
+
+    const double na = (double)m_cnt;
+    const double nb = (double)other.m_cnt;
+    const double n = na + nb;
+    const double delta = other.M1 - M1;
+    const double delta2 = delta * delta;
+
+    if (m_advanced)
+    {
+        M4 += other.M4 + delta2 * delta2 * na * nb *
+                (na * na - na * nb + nb * nb) / (n * n * n) +
+            6 * delta2 * (na * na * other.M2 + nb * nb * M2) / (n * n) +
+            4 * delta * (na * other.M3 - nb * M3) / n;
+        M3 += other.M3 + delta2 * delta * na * nb * (na - nb) / (n * n) +
+            3 * delta * (na * other.M2 - nb * M2) / n;
+    }
+    M2 += other.M2 + delta2 * na * nb / n;
+    M1 += delta * nb / n;
+
+    m_cnt += other.m_cnt;
+    m_min = (std::min)(m_min, other.m_min);
+    m_max = (std::max)(m_max, other.m_max);
+    if (other.m_dense.size())
+    {
+        if (m_dense.empty())
+            m_dense.resize(m_denseSize);
+        for (size_t i = 0; i < m_dense.size(); ++i)
+            m_dense[i] += other.m_dense[i];
+    }
+    for (auto& v : other.m_sparse)
+        m_sparse[v.first] += v.second;
+    m_data.insert(m_data.end(), other.m_data.begin(), other.m_data.end());
+    m_digest.merge(other.m_digest);
+}
+
+
 } // namespace stats
 
 using namespace stats;
@@ -147,14 +358,84 @@ bool StatsFilter::processOne(PointRef& point)
 }
 
 
+void StatsFilter::processBatch(StreamPointTable& table, PointId begin,
+    PointId end, std::vector<bool>& keep)
+{
+    const point_count_t count = end - begin;
+    std::vector<double> values(count);
+
+    for (auto p = m_stats.begin(); p != m_stats.end(); ++p)
+    {
+        Dimension::Id d = p->first;
+        Summary& c = p->second;
+        table.getFieldArray(d, begin, count, values.data());
+        for (point_count_t i = 0; i < count; ++i)
+            if (keep[i])
+                c.insert(values[i]);
+    }
+}
+
+
+namespace
+{
+
+// Add the values of the points in [begin, end) to the summaries.
+void summarize(const PointView& view, PointId begin, PointId end,
+    std::map<Dimension::Id, Summary>& stats)
+{
+    // Fetch values a block at a time rather than point by point.
+    const point_count_t blockSize = 4096;
+    std::vector<double> values(blockSize);
+
+    for (auto p = stats.begin(); p != stats.end(); ++p)
+    {
+        Dimension::Id d = p->first;
+        Summary& c = p->second;
+        for (PointId idx = begin; idx < end; idx += blockSize)
+        {
+            point_count_t count = (std::min)(blockSize, end - idx);
+            view.getFieldArray(d, idx, count, values.data());
+            for (point_count_t i = 0; i < count; ++i)
+                c.insert(values[i]);
+        }
+    }
+}
+
+} // unnamed namespace
+
+
+// Large views are split into parts of a fixed size, which are summarized
+// on separate threads and then merged in order.  The size doesn't depend
+// on the number of threads, so the results are the same on any machine.
 void StatsFilter::filter(PointView& view)
 {
-    PointRef point(view, 0);
-    for (PointId idx = 0; idx < view.size(); ++idx)
+    const point_count_t partSize = 1 << 20;
+    const std::size_t numParts = (view.size() + partSize - 1) / partSize;
+
+    if (numParts <= 1)
     {
-        point.setPointId(idx);
-        processOne(point);
+        summarize(view, 0, view.size(), m_stats);
+        return;
     }
+
+    std::map<Dimension::Id, Summary> empty;
+    for (auto& p : m_stats)
+        empty.insert(std::make_pair(p.first, p.second.emptyCopy()));
+    std::vector<std::map<Dimension::Id, Summary>> parts(numParts, empty);
+
+    parallelFor(numParts, [&]()
+    {
+        return [&](std::size_t part)
+        {
+            PointId begin = part * partSize;
+            PointId end = (std::min)(begin + partSize, view.size());
+            summarize(view, begin, end, parts[part]);
+        };
+    }, 1);
+
+    for (auto& part : parts)
+        for (auto& p : part)
+            m_stats.at(p.first).merge(p.second);
 }
 
 
@@ -174,11 +455,19 @@ void StatsFilter::addArgs(ProgramArgs& args)
         m_global);
     args.add("count", "Dimensions whose values should be counted", m_counts);
     args.add("advanced", "Calculate skewness and kurtosis", m_advanced);
+    args.add("approximate", "Approximate global stats in constant memory "
+        "rather than storing all values", m_approximate);
+    args.add("compression", "Accuracy of approximate global stats.  "
+        "Larger values are more accurate but use more memory",
+        m_compression, 100.0);
 }
 
 
 void StatsFilter::prepared(PointTableRef table)
 {
+    if (m_compression < 1)
+        throwError("Option 'compression' must be at least 1.");
+
     PointLayoutPtr layout(table.layout());
     std::unordered_map<std::string, Summary::EnumType> dims;
 
@@ -237,7 +526,8 @@ void StatsFilter::prepared(PointTableRef table)
     // Create the summary objects.
     for (auto& dv : dims)
         m_stats.insert(std::make_pair(layout->findDim(dv.first),
-            Summary(dv.first, dv.second, m_advanced)));
+            Summary(dv.first, dv.second, m_advanced, m_approximate,
+                m_compression, layout->dimType(layout->findDim(dv.first)))));
 }
 
 
@@ -254,7 +544,7 @@ void StatsFilter::extractMetadata(PointTableRef table)
 
         MetadataNode t = m_metadata.addList("statistic");
         t.add("position", position++);
-        s.extractMetadata(t);
+        s.extractMetadata(t, metadataPolicy() == MetadataPolicy::Full);
     }
 
     // If we have X, Y, & Z dims, output bboxes
@@ -264,7 +554,7 @@ void StatsFilter::extractMetadata(PointTableRef table)
     if (xs != m_stats.end() &&
         ys != m_stats.end() &&
         zs != m_stats.end() &&
-        bNoPoints)
+        bNoPoints && metadataPolicy() == MetadataPolicy::Full)
     {
         BOX3D box(xs->second.minimum(), ys->second.minimum(),
             zs->second.minimum(), xs->second.maximum(), ys->second.maximum(),
@@ -306,6 +596,124 @@ void StatsFilter::extractMetadata(PointTableRef table)
 }
 
 
+namespace
+{
+
+// Combine two 'statistic' nodes.  Only the moments that can be combined
+// exactly are kept.
+MetadataNode mergeStatistic(const MetadataNode& a, const MetadataNode& b)
+{
+    const double na = a.findChild("count").value<double>();
+    const double nb = b.findChild("count").value<double>();
+    if (nb == 0)
+        return a;
+    if (na == 0)
+        return b;
+
+    const double ma = a.findChild("average").value<double>();
+    const double mb = b.findChild("average").value<double>();
+    const double va = na > 1 ? a.findChild("variance").value<double>() : 0;
+    const double vb = nb > 1 ? b.findChild("variance").value<double>() : 0;
+    const double n = na + nb;
+    const double delta = mb - ma;
+    const double m2 = va * (na - 1) + vb * (nb - 1) +
+        delta * delta * na * nb / n;
+
+    MetadataNode m("statistic");
+    m.add("position", a.findChild("position").value<uint32_t>(), "position");
+    m.add("count", (uint32_t)n, "count");
+    m.add("minimum", (std::min)(a.findChild("minimum").value<double>(),
+        b.findChild("minimum").value<double>()), "minimum");
+    m.add("maximum", (std::max)(a.findChild("maximum").value<double>(),
+        b.findChild("maximum").value<double>()), "maximum");
+    m.add("average", ma + delta * nb / n, "average");
+    m.add("stddev", std::sqrt(m2 / (n - 1)), "standard deviation");
+    m.add("variance", m2 / (n - 1), "variance");
+    m.add("name", a.findChild("name").value(), "name");
+    return m;
+}
+
+
+BOX3D metadataBox(const MetadataNode& m)
+{
+    return BOX3D(m.findChild("minx").value<double>(),
+        m.findChild("miny").value<double>(),
+        m.findChild("minz").value<double>(),
+        m.findChild("maxx").value<double>(),
+        m.findChild("maxy").value<double>(),
+        m.findChild("maxz").value<double>());
+}
+
+
+// Add a box and its boundary that covers the boxes of two bbox nodes.
+void mergeBox(MetadataNode& out, const std::string& name,
+    const MetadataNode& a, const MetadataNode& b)
+{
+    // Names like "EPSG:4326" can't be looked up with findChild().
+    auto findBox = [&name](const MetadataNode& m)
+    {
+        MetadataNodeList nodes = m.children(name);
+        return nodes.empty() ? MetadataNode() :
+            nodes.front().findChild("bbox");
+    };
+
+    MetadataNode ba = findBox(a);
+    MetadataNode bb = findBox(b);
+    if (!ba.valid() || !bb.valid())
+        return;
+
+    BOX3D box(metadataBox(ba));
+    box.grow(metadataBox(bb));
+    MetadataNode m = out.add(name);
+    m.add(Utils::toMetadata(box));
+
+    Json::Reader jsonReader;
+    Json::Value json;
+    jsonReader.parse(pdal::Polygon(box).json(), json);
+    m.addWithType("boundary", json.toStyledString(), "json",
+        "GeoJSON boundary");
+}
+
+} // unnamed namespace
+
+
+// Statistics of the same dimension are combined.  Global statistics,
+// enumerations and higher moments can't be combined from their values,
+// so they're dropped.
+MetadataNode StatsFilter::mergeMetadata(const MetadataNode& merged,
+    const MetadataNode& part) const
+{
+    MetadataNode out(merged.name());
+
+    std::vector<std::string> names;
+    for (const MetadataNode& a : merged.children("statistic"))
+    {
+        const std::string name = a.findChild("name").value();
+        names.push_back(name);
+        MetadataNode b = part.find([&name](const MetadataNode& n)
+            { return n.name() == "statistic" &&
+                n.findChild("name").value() == name; });
+        out.addList(b.valid() ? mergeStatistic(a, b) : a);
+    }
+    for (const MetadataNode& b : part.children("statistic"))
+        if (std::find(names.begin(), names.end(),
+                b.findChild("name").value()) == names.end())
+            out.addList(b);
+
+    MetadataNode ba = merged.findChild("bbox");
+    MetadataNode bb = part.findChild("bbox");
+    if (ba.valid() && bb.valid())
+    {
+        MetadataNode box = out.add("bbox");
+        mergeBox(box, "native", ba, bb);
+        mergeBox(box, "EPSG:4326", ba, bb);
+    }
+    else if (ba.valid() || bb.valid())
+        out.add(ba.valid() ? ba : bb);
+    return out;
+}
+
+
 const Summary& StatsFilter::getStats(Dimension::Id dim) const
 {
     for (auto di = m_stats.begin(); di != m_stats.end(); ++di)
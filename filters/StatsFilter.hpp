@@ -37,11 +37,79 @@
 #include <pdal/Filter.hpp>
 #include <pdal/Streamable.hpp>
 
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
 namespace pdal
 {
 namespace stats
 {
 
+/**
+  Approximate quantiles of a stream of values in bounded memory (Dunning's
+  merging t-digest).  Values are summarized by weighted centroids that
+  are small near the extremes and larger near the median.  The number of
+  centroids, and so the memory used, is about the compression.  Digests
+  can be merged, so parts of a stream can be summarized separately.
+*/
+class PDAL_DLL TDigest
+{
+public:
+    TDigest(double compression = 100) : m_compression(compression),
+        m_count(0),
+        m_min((std::numeric_limits<double>::max)()),
+        m_max((std::numeric_limits<double>::lowest)())
+    {}
+
+    void insert(double value)
+    {
+        m_buffer.push_back({value, 1});
+        m_count++;
+        m_min = (std::min)(m_min, value);
+        m_max = (std::max)(m_max, value);
+        if (m_buffer.size() >= bufferSize())
+            compress();
+    }
+
+    void merge(const TDigest& other);
+
+    /**
+      Approximate value below which a fraction of the values fall.
+
+      \param q  Fraction of the values, in [0, 1].
+    */
+    double quantile(double q);
+
+    /**
+      Approximate fraction of the values that are less than a value.
+    */
+    double cdf(double x);
+
+    point_count_t count() const
+        { return m_count; }
+    double compression() const
+        { return m_compression; }
+
+private:
+    struct Centroid
+    {
+        double m_mean;
+        double m_weight;
+    };
+
+    double m_compression;
+    point_count_t m_count;
+    double m_min;
+    double m_max;
+    std::vector<Centroid> m_centroids;
+    std::vector<Centroid> m_buffer;
+
+    std::size_t bufferSize() const
+        { return (std::size_t)(5 * m_compression) + 10; }
+    void compress();
+};
+
 class PDAL_DLL Summary
 {
 public:
@@ -57,9 +125,50 @@ typedef std::map<double, point_count_t> EnumMap;
 typedef std::vector<double> DataVector;
 
 public:
-    Summary(std::string name, EnumType enumerate, bool advanced = true) :
-        m_name(name), m_enumerate(enumerate), m_advanced(advanced)
-    { reset(); }
+    /**
+      \param name  Name of the dimension.
+      \param enumerate  Values to keep beyond the basic statistics.
+      \param advanced  Whether to compute skewness and kurtosis.
+      \param approximate  Whether global statistics (median and MAD) are
+        approximated with a t-digest rather than computed from all the
+        values.
+      \param compression  Size of the t-digest.  Larger is more accurate.
+      \param type  Type of the dimension.  Values of 8- and 16-bit integer
+        dimensions are counted in an array rather than a map.
+    */
+    Summary(std::string name, EnumType enumerate, bool advanced = true,
+            bool approximate = false, double compression = 100,
+            Dimension::Type type = Dimension::Type::None) :
+        m_name(name), m_enumerate(enumerate), m_advanced(advanced),
+        m_approximate(approximate), m_type(type), m_denseOffset(0),
+        m_denseSize(0), m_digest(compression)
+    {
+        switch (type)
+        {
+        case Dimension::Type::Signed8:
+            m_denseOffset = 128;
+            // fall through
+        case Dimension::Type::Unsigned8:
+            m_denseSize = 256;
+            break;
+        case Dimension::Type::Signed16:
+            m_denseOffset = 32768;
+            // fall through
+        case Dimension::Type::Unsigned16:
+            m_denseSize = 65536;
+            break;
+        default:
+            break;
+        }
+        reset();
+    }
+
+    /// Summary with the same settings as this one, but no values.
+    Summary emptyCopy() const
+    {
+        return Summary(m_name, m_enumerate, m_advanced, m_approximate,
+            m_digest.compression(), m_type);
+    }
 
     double minimum() const
         { return m_min; }
@@ -85,12 +194,21 @@ public:
         { return m_cnt; }
     std::string name() const
         { return m_name; }
-    const EnumMap& values() const
-        { return m_values; }
+    /// Count of each value inserted, in order of value.  Only kept when
+    /// values are enumerated.
+    const EnumMap& values() const;
 
-    void extractMetadata(MetadataNode &m);
+    // Unless full is set, enumerations and global stats are skipped.
+    void extractMetadata(MetadataNode &m, bool full = true);
     void computeGlobalStats();
 
+    /**
+      Add the values of another summary of the same dimension, as if they
+      had been inserted into this one.  The result matches inserting the
+      values directly, except for floating-point rounding.
+    */
+    void merge(const Summary& other);
+
     void reset()
     {
         m_max = (std::numeric_limits<double>::lowest)();
@@ -108,52 +226,80 @@ public:
         m_max = (std::max)(m_max, value);
 
         if (m_enumerate != NoEnum)
-            m_values[value]++;
+            count(value);
         if (m_enumerate == Global)
         {
-            if (m_data.capacity() - m_data.size() < 10000)
-                m_data.reserve(m_data.capacity() + m_cnt);
-            m_data.push_back(value);
+            if (m_approximate)
+                m_digest.insert(value);
+            else
+            {
+                if (m_data.capacity() - m_data.size() < 10000)
+                    m_data.reserve(m_data.capacity() + m_cnt);
+                m_data.push_back(value);
+            }
         }
 
         // stolen from http://www.johndcook.com/blog/skewness_kurtosis/
 
-        point_count_t n(m_cnt);
+        double n(static_cast<double>(m_cnt));
 
         // Difference from the mean
         double delta = value - M1;
         // Portion that this point's difference from the mean that it
         // contributes to the mean.
         double delta_n = delta / n;
+        // Contribution of this point to the sum of squared differences.
+        double term1 = delta * delta_n * (n - 1);
 
         // First moment - average.
         M1 += delta_n;
 
-        double delta_2 = pow(delta, 2.0);
-
         if (m_advanced)
         {
-            double delta_n2 = pow(delta_n, 2.0);
+            double delta_n2 = delta_n * delta_n;
             // Fourth moment - kurtosis (sum part)
-            M4 += delta_2 * delta_n2 * (n*n - 3*n + 3) +
+            M4 += term1 * delta_n2 * (n*n - 3*n + 3) +
                 (6 * delta_n2 * M2) - (4 * delta_n * M3);
             // Third moment - skewness (sum part)
-            M3 += delta_2 * delta_n * (n - 2) - 3 * delta_n * M2;
+            M3 += term1 * delta_n * (n - 2) - 3 * delta_n * M2;
         }
         // Second moment - variance (sum part)
-        M2 += delta_2;
+        M2 += term1;
     }
 
 private:
+    // Values of small integer dimensions are counted in a dense array
+    // indexed by the value plus an offset.  Others are counted in a hash
+    // map.  Both are only ordered when values() is called.
+    void count(double value)
+    {
+        const double idx = value + m_denseOffset;
+        if (idx >= 0 && idx < m_denseSize && idx == (double)(size_t)idx)
+        {
+            if (m_dense.empty())
+                m_dense.resize(m_denseSize);
+            m_dense[(size_t)idx]++;
+        }
+        else
+            m_sparse[value]++;
+    }
+
     std::string m_name;
     EnumType m_enumerate;
     bool m_advanced;
+    bool m_approximate;
+    Dimension::Type m_type;
     double m_max;
     double m_min;
     double m_mad;
     double m_median;
-    EnumMap m_values;
+    size_t m_denseOffset;
+    size_t m_denseSize;
+    std::vector<point_count_t> m_dense;
+    std::unordered_map<double, point_count_t> m_sparse;
+    mutable EnumMap m_values;
     DataVector m_data;
+    TDigest m_digest;
     point_count_t m_cnt;
     double M1, M2, M3, M4;
 };
@@ -172,12 +318,16 @@ public:
 
     const stats::Summary& getStats(Dimension::Id d) const;
     void reset();
+    virtual MetadataNode mergeMetadata(const MetadataNode& merged,
+        const MetadataNode& part) const;
 
 private:
     StatsFilter& operator=(const StatsFilter&); // not implemented
     StatsFilter(const StatsFilter&); // not implemented
     virtual void addArgs(ProgramArgs& args);
     virtual bool processOne(PointRef& point);
+    virtual void processBatch(StreamPointTable& table, PointId begin,
+        PointId end, std::vector<bool>& keep);
     virtual void prepared(PointTableRef table);
     virtual void done(PointTableRef table);
     virtual void filter(PointView& view);
@@ -188,6 +338,8 @@ private:
     StringList m_counts;
     StringList m_global;
     bool m_advanced;
+    bool m_approximate;
+    double m_compression;
     std::map<Dimension::Id, stats::Summary> m_stats;
 };
 
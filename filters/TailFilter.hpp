@@ -54,6 +54,9 @@ private:
     point_count_t m_count;
     bool m_invert;
 
+    virtual bool dimensionsUsed(PointLayoutPtr, Dimension::IdList&) const
+        { return true; }
+
     void addArgs(ProgramArgs& args)
     {
         args.add("count", "Number of points to return from end. "
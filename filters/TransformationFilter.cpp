@@ -35,10 +35,65 @@
 #include "TransformationFilter.hpp"
 
 #include <sstream>
+#include <vector>
+
+#if defined(__AVX512F__) || defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
 
 namespace pdal
 {
 
+namespace
+{
+
+// Packed double operations for the widest instruction set the compiler
+// was told it may use.  The lane order of the arithmetic matches the
+// scalar code so that results don't depend on which path runs.
+#if defined(__AVX512F__)
+#define PDAL_TRANSFORM_PACKED
+typedef __m512d Packed;
+const point_count_t PackedSize = 8;
+inline Packed splat(double d) { return _mm512_set1_pd(d); }
+inline Packed load(const double *p) { return _mm512_loadu_pd(p); }
+inline void store(double *p, Packed v) { _mm512_storeu_pd(p, v); }
+inline Packed add(Packed a, Packed b) { return _mm512_add_pd(a, b); }
+inline Packed mul(Packed a, Packed b) { return _mm512_mul_pd(a, b); }
+#elif defined(__AVX__)
+#define PDAL_TRANSFORM_PACKED
+typedef __m256d Packed;
+const point_count_t PackedSize = 4;
+inline Packed splat(double d) { return _mm256_set1_pd(d); }
+inline Packed load(const double *p) { return _mm256_loadu_pd(p); }
+inline void store(double *p, Packed v) { _mm256_storeu_pd(p, v); }
+inline Packed add(Packed a, Packed b) { return _mm256_add_pd(a, b); }
+inline Packed mul(Packed a, Packed b) { return _mm256_mul_pd(a, b); }
+#elif defined(__SSE2__)
+#define PDAL_TRANSFORM_PACKED
+typedef __m128d Packed;
+const point_count_t PackedSize = 2;
+inline Packed splat(double d) { return _mm_set1_pd(d); }
+inline Packed load(const double *p) { return _mm_loadu_pd(p); }
+inline void store(double *p, Packed v) { _mm_storeu_pd(p, v); }
+inline Packed add(Packed a, Packed b) { return _mm_add_pd(a, b); }
+inline Packed mul(Packed a, Packed b) { return _mm_mul_pd(a, b); }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define PDAL_TRANSFORM_PACKED
+typedef float64x2_t Packed;
+const point_count_t PackedSize = 2;
+inline Packed splat(double d) { return vdupq_n_f64(d); }
+inline Packed load(const double *p) { return vld1q_f64(p); }
+inline void store(double *p, Packed v) { vst1q_f64(p, v); }
+inline Packed add(Packed a, Packed b) { return vaddq_f64(a, b); }
+inline Packed mul(Packed a, Packed b) { return vmulq_f64(a, b); }
+#endif
+
+} // unnamed namespace
+
 static StaticPluginInfo const s_info
 {
     "filters.transformation",
@@ -114,13 +169,87 @@ bool TransformationFilter::processOne(PointRef& point)
 }
 
 
+// Points that have been filtered out are transformed along with the rest.
+// Nothing looks at them again and it's cheaper than picking them out.
+void TransformationFilter::processBatch(StreamPointTable& table,
+    PointId begin, PointId end, std::vector<bool>& /*keep*/)
+{
+    const point_count_t count = end - begin;
+    std::vector<double> x(count);
+    std::vector<double> y(count);
+    std::vector<double> z(count);
+
+    table.getFieldArray(Dimension::Id::X, begin, count, x.data());
+    table.getFieldArray(Dimension::Id::Y, begin, count, y.data());
+    table.getFieldArray(Dimension::Id::Z, begin, count, z.data());
+    transform(x.data(), y.data(), z.data(), count);
+    table.setFieldArray(Dimension::Id::X, begin, count, x.data());
+    table.setFieldArray(Dimension::Id::Y, begin, count, y.data());
+    table.setFieldArray(Dimension::Id::Z, begin, count, z.data());
+}
+
+
+void TransformationFilter::transform(double *x, double *y, double *z,
+    point_count_t count) const
+{
+    point_count_t i = 0;
+
+#ifdef PDAL_TRANSFORM_PACKED
+    Packed m[12];
+    for (size_t j = 0; j < 12; ++j)
+        m[j] = splat(m_matrix[j]);
+
+    for (; i + PackedSize <= count; i += PackedSize)
+    {
+        Packed xi = load(x + i);
+        Packed yi = load(y + i);
+        Packed zi = load(z + i);
+
+        store(x + i, add(add(add(mul(xi, m[0]), mul(yi, m[1])),
+            mul(zi, m[2])), m[3]));
+        store(y + i, add(add(add(mul(xi, m[4]), mul(yi, m[5])),
+            mul(zi, m[6])), m[7]));
+        store(z + i, add(add(add(mul(xi, m[8]), mul(yi, m[9])),
+            mul(zi, m[10])), m[11]));
+    }
+#endif
+
+    // Whatever is left over after the packed loop, or everything when
+    // there's no packed support.
+    for (; i < count; ++i)
+    {
+        double xi = x[i];
+        double yi = y[i];
+        double zi = z[i];
+
+        x[i] = xi * m_matrix[0] + yi * m_matrix[1] + zi * m_matrix[2] +
+            m_matrix[3];
+        y[i] = xi * m_matrix[4] + yi * m_matrix[5] + zi * m_matrix[6] +
+            m_matrix[7];
+        z[i] = xi * m_matrix[8] + yi * m_matrix[9] + zi * m_matrix[10] +
+            m_matrix[11];
+    }
+}
+
+
 void TransformationFilter::filter(PointView& view)
 {
-    PointRef point(view, 0);
-    for (PointId idx = 0; idx < view.size(); ++idx)
+    // Transform a block of points at a time rather than point by point.
+    const point_count_t blockSize = 4096;
+    std::vector<double> x(blockSize);
+    std::vector<double> y(blockSize);
+    std::vector<double> z(blockSize);
+
+    for (PointId idx = 0; idx < view.size(); idx += blockSize)
     {
-        point.setPointId(idx);
-        processOne(point);
+        point_count_t count = (std::min)(blockSize, view.size() - idx);
+        view.getFieldArray(Dimension::Id::X, idx, count, x.data());
+        view.getFieldArray(Dimension::Id::Y, idx, count, y.data());
+        view.getFieldArray(Dimension::Id::Z, idx, count, z.data());
+        transform(x.data(), y.data(), z.data(), count);
+        view.setFieldArray(Dimension::Id::X, idx, count, x.data());
+        view.setFieldArray(Dimension::Id::Y, idx, count, y.data());
+        view.setFieldArray(Dimension::Id::Z, idx, count, z.data());
     }
     view.invalidateProducts();
 }
@@ -66,8 +66,14 @@ private:
 
     virtual void addArgs(ProgramArgs& args);
     virtual void initialize();
+    virtual bool threadSafe() const
+        { return true; }
     virtual bool processOne(PointRef& point);
+    virtual void processBatch(StreamPointTable& table, PointId begin,
+        PointId end, std::vector<bool>& keep);
     virtual void filter(PointView& view);
+    void transform(double *x, double *y, double *z,
+        point_count_t count) const;
 
     std::string m_matrixSpec;
     TransformationMatrix m_matrix;
@@ -34,11 +34,12 @@
 
 #include "VoxelCenterNearestNeighborFilter.hpp"
 
-#include <pdal/KDIndex.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
-#include <set>
+#include "private/VoxelMap.hpp"
+
+#include <limits>
 #include <string>
-#include <tuple>
 #include <vector>
 
 namespace pdal
@@ -53,6 +54,13 @@ static StaticPluginInfo const s_info
 
 CREATE_STATIC_STAGE(VoxelCenterNearestNeighborFilter, s_info)
 
+namespace
+{
+
+const point_count_t BlockSize = 1 << 16;
+
+} // unnamed namespace
+
 std::string VoxelCenterNearestNeighborFilter::getName() const
 {
     return s_info.name;
@@ -63,51 +71,89 @@ void VoxelCenterNearestNeighborFilter::addArgs(ProgramArgs& args)
     args.add("cell", "Cell size", m_cell, 1.0);
 }
 
+void VoxelCenterNearestNeighborFilter::initialize()
+{
+    if (m_cell <= 0)
+        throwError("Option 'cell' must be positive.");
+}
+
 PointViewSet VoxelCenterNearestNeighborFilter::run(PointViewPtr view)
 {
     BOX3D bounds;
     view->calculateBounds(bounds);
 
-    // Find distance from voxel center to point.  If the distance is less
-    // than previous (or is the first one for the voxel), store the
-    // point ID and distance.
-    std::map<std::tuple<size_t, size_t, size_t>,
-        std::tuple<PointId, double>> populated_voxels;
-    for (PointId id = 0; id < view->size(); ++id)
+    const VoxelKey voxel(bounds, m_cell);
+    if (!voxel.fits())
+        throwError("Cell size is too small for the extent of the points.");
+
+    // Nearest point to the center of a voxel.
+    struct Nearest
     {
-        double x = view->getFieldAs<double>(Dimension::Id::X, id);
-        double y = view->getFieldAs<double>(Dimension::Id::Y, id);
-        double z = view->getFieldAs<double>(Dimension::Id::Z, id);
-        size_t c = static_cast<size_t>((x - bounds.minx) / m_cell);
-        size_t r = static_cast<size_t>((y - bounds.miny) / m_cell);
-        size_t d = static_cast<size_t>((z - bounds.minz) / m_cell);
-        double xv = bounds.minx + (c + 0.5) * m_cell;
-        double yv = bounds.miny + (r + 0.5) * m_cell;
-        double zv = bounds.minz + (d + 0.5) * m_cell;
-        double dist = pow(xv - x, 2) + pow(yv - y, 2) + pow(zv - z, 2);
-
-        auto t = std::make_tuple(r, c, d);
-        auto pi = populated_voxels.find(t);
-        if (pi == populated_voxels.end())
-            populated_voxels.insert(
-                std::make_pair(t, std::make_tuple(id, dist)));
-        else
+        Nearest() : m_id(0), m_dist((std::numeric_limits<double>::max)())
+        {}
+
+        PointId m_id;
+        double m_dist;
+    };
+
+    // Find the point nearest each voxel center separately for each block
+    // of points, on as many threads as there are blocks.
+    const point_count_t count = view->size();
+    const size_t numBlocks = (size_t)((count + BlockSize - 1) / BlockSize);
+    std::vector<VoxelMap<Nearest>> blocks(numBlocks);
+    parallelFor(numBlocks, [&]()
+    {
+        return [&](size_t block)
         {
-            auto& t2 = pi->second;  // Get point/distance tuple.
-            double curDist = std::get<1>(t2);
-            if (dist < curDist)
-                t2 = std::make_tuple(id, dist);
-        }
-    }
+            VoxelMap<Nearest>& voxels = blocks[block];
+            const PointId begin = block * BlockSize;
+            const PointId end = (std::min)(begin + BlockSize, count);
+            for (PointId id = begin; id < end; ++id)
+            {
+                double x = view->getFieldAs<double>(Dimension::Id::X, id);
+                double y = view->getFieldAs<double>(Dimension::Id::Y, id);
+                double z = view->getFieldAs<double>(Dimension::Id::Z, id);
+                size_t c = voxel.col(x);
+                size_t r = voxel.row(y);
+                size_t d = voxel.depth(z);
+                double xv = bounds.minx + (c + 0.5) * m_cell;
+                double yv = bounds.miny + (r + 0.5) * m_cell;
+                double zv = bounds.minz + (d + 0.5) * m_cell;
+                double dist = (xv - x) * (xv - x) + (yv - y) * (yv - y) +
+                    (zv - z) * (zv - z);
 
-    // Append the ID of the point nearest the voxel center to the output view.
-    PointViewPtr output = view->makeNew();
-    for (auto const& t : populated_voxels)
+                Nearest& n = voxels[voxel.key(c, r, d)];
+                if (dist < n.m_dist)
+                {
+                    n.m_id = id;
+                    n.m_dist = dist;
+                }
+            }
+        };
+    }, 1);
+
+    // Merge the blocks in order, keeping the earlier point of those at
+    // the same distance, as a single pass through the points would.
+    VoxelMap<Nearest> voxels;
+    if (numBlocks)
+        std::swap(voxels, blocks[0]);
+    for (size_t block = 1; block < numBlocks; ++block)
     {
-        auto& t2 = t.second; // Get point/distance tuple.
-        output->appendPoint(*view, std::get<0>(t2));
+        blocks[block].forEach([&voxels](uint64_t key, const Nearest& b)
+        {
+            Nearest& n = voxels[key];
+            if (b.m_dist < n.m_dist)
+                n = b;
+        });
+        blocks[block] = VoxelMap<Nearest>();
     }
 
+    // Append the ID of the point nearest each voxel center to the output
+    // view, ordered by row, column and depth.
+    PointViewPtr output = view->makeNew();
+    for (auto const& e : voxels.sorted())
+        output->appendPoint(*view, e.second.m_id);
+
     PointViewSet viewSet;
     viewSet.insert(output);
     return viewSet;
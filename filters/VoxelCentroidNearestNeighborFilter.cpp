@@ -34,16 +34,14 @@
 
 #include "VoxelCentroidNearestNeighborFilter.hpp"
 
-#include <pdal/EigenUtils.hpp>
 #include <pdal/KDIndex.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+#include "private/VoxelMap.hpp"
 
-#include <map>
 #include <string>
-#include <tuple>
 #include <vector>
 
-#include <Eigen/Dense>
-
 namespace pdal
 {
 
@@ -56,6 +54,13 @@ static StaticPluginInfo const s_info
 
 CREATE_STATIC_STAGE(VoxelCentroidNearestNeighborFilter, s_info)
 
+namespace
+{
+
+const point_count_t BlockSize = 1 << 16;
+
+} // unnamed namespace
+
 std::string VoxelCentroidNearestNeighborFilter::getName() const
 {
     return s_info.name;
@@ -66,39 +71,100 @@ void VoxelCentroidNearestNeighborFilter::addArgs(ProgramArgs& args)
     args.add("cell", "Cell size", m_cell, 1.0);
 }
 
+void VoxelCentroidNearestNeighborFilter::initialize()
+{
+    if (m_cell <= 0)
+        throwError("Option 'cell' must be positive.");
+}
+
 PointViewSet VoxelCentroidNearestNeighborFilter::run(PointViewPtr view)
 {
     BOX3D bounds;
     view->calculateBounds(bounds);
 
-    KD3Index& kdi = view->build3dIndex();
+    const VoxelKey voxel(bounds, m_cell);
+    if (!voxel.fits())
+        throwError("Cell size is too small for the extent of the points.");
 
-    // Make an initial pass through the input PointView to index PointIds by
-    // row, column, and depth.
-    std::map<std::tuple<size_t, size_t, size_t>, std::vector<PointId>>
-        populated_voxel_ids;
-    for (PointId id = 0; id < view->size(); ++id)
+    // Sum of the positions of the points in a voxel, relative to the
+    // minimum of the bounds to keep precision.
+    struct Sum
     {
-        double y = view->getFieldAs<double>(Dimension::Id::Y, id);
-        double x = view->getFieldAs<double>(Dimension::Id::X, id);
-        double z = view->getFieldAs<double>(Dimension::Id::Z, id);
-        size_t r = static_cast<size_t>((y - bounds.miny) / m_cell);
-        size_t c = static_cast<size_t>((x - bounds.minx) / m_cell);
-        size_t d = static_cast<size_t>((z - bounds.minz) / m_cell);
-        populated_voxel_ids[std::make_tuple(r, c, d)].push_back(id);
-    }
+        Sum() : m_x(0), m_y(0), m_z(0), m_count(0)
+        {}
 
-    // Make a second pass through the populated voxels to compute the voxel
-    // centroid and to find its nearest neighbor.
-    PointViewPtr output = view->makeNew();
-    for (auto const& t : populated_voxel_ids)
+        double m_x;
+        double m_y;
+        double m_z;
+        point_count_t m_count;
+    };
+
+    // Sum the points of each voxel separately for each block of points,
+    // on as many threads as there are blocks.
+    const point_count_t count = view->size();
+    const size_t numBlocks = (size_t)((count + BlockSize - 1) / BlockSize);
+    std::vector<VoxelMap<Sum>> blocks(numBlocks);
+    parallelFor(numBlocks, [&]()
+    {
+        return [&](size_t block)
+        {
+            VoxelMap<Sum>& voxels = blocks[block];
+            const PointId begin = block * BlockSize;
+            const PointId end = (std::min)(begin + BlockSize, count);
+            for (PointId id = begin; id < end; ++id)
+            {
+                double x = view->getFieldAs<double>(Dimension::Id::X, id);
+                double y = view->getFieldAs<double>(Dimension::Id::Y, id);
+                double z = view->getFieldAs<double>(Dimension::Id::Z, id);
+                Sum& sum = voxels[voxel.key(voxel.col(x), voxel.row(y),
+                    voxel.depth(z))];
+                sum.m_x += x - bounds.minx;
+                sum.m_y += y - bounds.miny;
+                sum.m_z += z - bounds.minz;
+                sum.m_count++;
+            }
+        };
+    }, 1);
+
+    // Merge the blocks in order so that the sums don't depend on the
+    // number of threads.
+    VoxelMap<Sum> voxels;
+    if (numBlocks)
+        std::swap(voxels, blocks[0]);
+    for (size_t block = 1; block < numBlocks; ++block)
     {
-        Eigen::Vector3d centroid = eigen::computeCentroid(*view, t.second);
-        std::vector<PointId> neighbors =
-            kdi.neighbors(centroid[0], centroid[1], centroid[2], 1);
-        output->appendPoint(*view, neighbors[0]);
+        blocks[block].forEach([&voxels](uint64_t key, const Sum& b)
+        {
+            Sum& sum = voxels[key];
+            sum.m_x += b.m_x;
+            sum.m_y += b.m_y;
+            sum.m_z += b.m_z;
+            sum.m_count += b.m_count;
+        });
+        blocks[block] = VoxelMap<Sum>();
     }
 
+    // Find the point nearest the centroid of each voxel, ordered by row,
+    // column and depth.
+    const std::vector<VoxelMap<Sum>::Entry> sums = voxels.sorted();
+    voxels = VoxelMap<Sum>();
+    std::vector<PointId> nearest(sums.size());
+    KD3Index& kdi = view->build3dIndex();
+    parallelFor(sums.size(), [&]()
+    {
+        return [&](size_t i)
+        {
+            const Sum& sum = sums[i].second;
+            const double n = (double)sum.m_count;
+            nearest[i] = kdi.neighbor(bounds.minx + sum.m_x / n,
+                bounds.miny + sum.m_y / n, bounds.minz + sum.m_z / n);
+        };
+    });
+
+    PointViewPtr output = view->makeNew();
+    for (PointId id : nearest)
+        output->appendPoint(*view, id);
+
     PointViewSet viewSet;
     viewSet.insert(output);
     return viewSet;
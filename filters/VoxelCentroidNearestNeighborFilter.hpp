@@ -58,6 +58,7 @@ private:
     double m_cell;
 
     virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
     virtual PointViewSet run(PointViewPtr view);
 
     VoxelCentroidNearestNeighborFilter&
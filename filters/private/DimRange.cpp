@@ -36,6 +36,9 @@
 
 #include <pdal/util/Utils.hpp>
 
+#include <cmath>
+#include <limits>
+
 namespace pdal
 {
 
@@ -126,6 +129,13 @@ bool DimRange::valuePasses(double v) const
     return !fail;
 }
 
+void DimRange::valuesPass(const double *values, point_count_t count,
+    char *passes) const
+{
+    std::fill(passes, passes + count, 0);
+    DimRangeList::Bounds(*this).orPasses(values, count, passes);
+}
+
 // Important - range list must be sorted.
 // This applies OR logic when there are multiple ranges for the same
 // dimension and AND logic for different dimensions.  It depends on
@@ -154,6 +164,51 @@ bool DimRange::pointPasses(const std::vector<DimRange>& ranges, PointRef& point)
     return passes;
 }
 
+DimRangeList::DimRangeList(const std::vector<DimRange>& ranges)
+{
+    for (const DimRange& r : ranges)
+    {
+        if (m_groups.empty() || m_groups.back().m_id != r.m_id)
+            m_groups.push_back({ r.m_id, m_bounds.size(), m_bounds.size() });
+        m_bounds.emplace_back(r);
+        m_groups.back().m_end = m_bounds.size();
+    }
+}
+
+
+// Comparisons with NaN are false, so a NaN bound in a range means no
+// limit (as in DimRange::valuePasses()) and a NaN bound here means that
+// no value passes.
+DimRangeList::Bounds::Bounds(const DimRange& r) :
+    m_lower(r.m_lower_bound), m_upper(r.m_upper_bound), m_negate(r.m_negate)
+{
+    const double inf = std::numeric_limits<double>::infinity();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+
+    if (std::isnan(m_lower))
+        m_lower = -inf;
+    else if (!r.m_inclusive_lower_bound)
+        m_lower = (m_lower == inf) ? nan : std::nextafter(m_lower, inf);
+
+    if (std::isnan(m_upper))
+        m_upper = inf;
+    else if (!r.m_inclusive_upper_bound)
+        m_upper = (m_upper == -inf) ? nan : std::nextafter(m_upper, -inf);
+}
+
+
+void DimRangeList::Bounds::orPasses(const double *values, point_count_t count,
+    char *passes) const
+{
+    const double lower = m_lower;
+    const double upper = m_upper;
+    const char negate = m_negate;
+    for (point_count_t i = 0; i < count; ++i)
+        passes[i] |= (char)(((values[i] >= lower) & (values[i] <= upper)) ^
+            negate);
+}
+
+
 void DimRange::parse(const std::string& r)
 {
     std::string::size_type pos = subParse(r);
@@ -34,7 +34,9 @@
 
 #pragma once
 
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include <pdal/Dimension.hpp>
 #include <pdal/PointRef.hpp>
@@ -71,6 +73,16 @@ struct DimRange
 
     void parse(const std::string& s);
     bool valuePasses(double d) const;
+    /**
+      Test a block of values against the range, as \ref valuePasses()
+      does for each one.
+
+      \param values  Values to test.
+      \param count  Number of values.
+      \param[out] passes  Set to 1 for values that pass, 0 for the others.
+    */
+    void valuesPass(const double *values, point_count_t count,
+        char *passes) const;
     static bool pointPasses(const std::vector<DimRange>& ranges,
         PointRef& point);
 
@@ -86,6 +98,80 @@ protected:
     std::string::size_type subParse(const std::string& r);
 };
 
+/**
+  A list of ranges compiled for testing blocks of points.  The logic is
+  that of \ref DimRange::pointPasses(): ranges of the same dimension are
+  ORed and dimensions are ANDed, so ranges of a dimension must be
+  contiguous.  Bounds are made inclusive when the list is compiled, so
+  that testing a value is two compares and no branches, which the
+  compiler can vectorize.
+*/
+class PDAL_DLL DimRangeList
+{
+public:
+    DimRangeList()
+    {}
+
+    /**
+      \param ranges  Ranges to compile.  Their dimension IDs must be set.
+    */
+    DimRangeList(const std::vector<DimRange>& ranges);
+
+    /**
+      Test a block of points.
+
+      \param getValues  Called as getValues(id, values) to fetch the values
+        of dimension \c id for the points of the block into \c values.
+      \param count  Number of points in the block.
+      \param[in,out] passes  Set to 0 for points that fail.  Points that are
+        0 stay 0.
+    */
+    template<typename GetValues>
+    void test(GetValues getValues, point_count_t count, char *passes) const
+    {
+        std::vector<double> values(count);
+        std::vector<char> dimPasses(count);
+        for (const Group& g : m_groups)
+        {
+            getValues(g.m_id, values.data());
+            std::fill(dimPasses.begin(), dimPasses.end(), 0);
+            for (size_t r = g.m_begin; r < g.m_end; ++r)
+                m_bounds[r].orPasses(values.data(), count, dimPasses.data());
+            for (point_count_t i = 0; i < count; ++i)
+                passes[i] &= dimPasses[i];
+        }
+    }
+
+private:
+    // A range with inclusive bounds.  Values pass if they're within the
+    // bounds, unless the range is negated.
+    struct Bounds
+    {
+        Bounds(const DimRange& r);
+
+        // OR whether each value passes into passes.
+        void orPasses(const double *values, point_count_t count,
+            char *passes) const;
+
+        double m_lower;
+        double m_upper;
+        char m_negate;
+    };
+
+    // Contiguous ranges of the same dimension.
+    struct Group
+    {
+        Dimension::Id m_id;
+        size_t m_begin;
+        size_t m_end;
+    };
+
+    std::vector<Bounds> m_bounds;
+    std::vector<Group> m_groups;
+
+    friend struct DimRange;
+};
+
 bool operator < (const DimRange& r1, const DimRange& r2);
 std::istream& operator>>(std::istream& in, DimRange& r);
 std::ostream& operator<<(std::ostream& out, const DimRange& r);
@@ -0,0 +1,143 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "RTree.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace pdal
+{
+
+RTree::RTree(const std::vector<BOX2D>& boxes, size_t nodeSize) :
+    m_nodeSize((std::max)(nodeSize, (size_t)2))
+{
+    // Entries of the leaves are the boxes themselves.
+    std::vector<Node> entries;
+    for (size_t i = 0; i < boxes.size(); ++i)
+        if (!boxes[i].empty())
+            entries.push_back({ boxes[i], (uint32_t)i, (uint32_t)i + 1 });
+    if (entries.empty())
+        return;
+
+    std::vector<Node> nodes = pack(entries);
+    m_boxes.reserve(entries.size());
+    m_ids.reserve(entries.size());
+    for (const Node& e : entries)
+    {
+        m_boxes.push_back(e.m_box);
+        m_ids.push_back(e.m_begin);
+    }
+    m_levels.push_back(std::move(nodes));
+
+    while (m_levels.back().size() > 1)
+    {
+        std::vector<Node> children = m_levels.back();
+        nodes = pack(children);
+        m_levels.back() = std::move(children);
+        m_levels.push_back(std::move(nodes));
+    }
+}
+
+
+// Sort entries into tiles and make a node for each run of m_nodeSize of
+// them.  The entries are reordered so that each node's children are
+// contiguous.
+std::vector<RTree::Node> RTree::pack(std::vector<Node>& entries) const
+{
+    auto cx = [](const Node& n) { return n.m_box.minx + n.m_box.maxx; };
+    auto cy = [](const Node& n) { return n.m_box.miny + n.m_box.maxy; };
+
+    const size_t count = entries.size();
+    const size_t numNodes = (count + m_nodeSize - 1) / m_nodeSize;
+    const size_t numSlices = (size_t)std::ceil(std::sqrt((double)numNodes));
+    const size_t sliceSize = numSlices * m_nodeSize;
+
+    std::sort(entries.begin(), entries.end(),
+        [&cx](const Node& n1, const Node& n2) { return cx(n1) < cx(n2); });
+    for (size_t begin = 0; begin < count; begin += sliceSize)
+    {
+        auto end = entries.begin() + (std::min)(begin + sliceSize, count);
+        std::sort(entries.begin() + begin, end,
+            [&cy](const Node& n1, const Node& n2) { return cy(n1) < cy(n2); });
+    }
+
+    std::vector<Node> nodes;
+    nodes.reserve(numNodes);
+    for (size_t begin = 0; begin < count; begin += m_nodeSize)
+    {
+        size_t end = (std::min)(begin + m_nodeSize, count);
+        Node n { BOX2D(), (uint32_t)begin, (uint32_t)end };
+        for (size_t i = begin; i < end; ++i)
+            n.m_box.grow(entries[i].m_box);
+        nodes.push_back(n);
+    }
+    return nodes;
+}
+
+
+void RTree::find(double x, double y, std::vector<size_t>& ids) const
+{
+    ids.clear();
+    if (m_levels.empty())
+        return;
+
+    // Nodes still to visit, as (level, index) pairs.
+    std::vector<std::pair<size_t, uint32_t>> stack;
+    const size_t top = m_levels.size() - 1;
+    for (uint32_t i = 0; i < m_levels[top].size(); ++i)
+        stack.emplace_back(top, i);
+    while (stack.size())
+    {
+        size_t level = stack.back().first;
+        const Node& n = m_levels[level][stack.back().second];
+        stack.pop_back();
+        if (!n.m_box.contains(x, y))
+            continue;
+        if (level)
+        {
+            for (uint32_t i = n.m_begin; i < n.m_end; ++i)
+                stack.emplace_back(level - 1, i);
+        }
+        else
+        {
+            for (uint32_t i = n.m_begin; i < n.m_end; ++i)
+                if (m_boxes[i].contains(x, y))
+                    ids.push_back(m_ids[i]);
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+}
+
+} // namespace pdal
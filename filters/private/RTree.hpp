@@ -0,0 +1,89 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <pdal/pdal_types.hpp>
+#include <pdal/util/Bounds.hpp>
+
+namespace pdal
+{
+
+/**
+  Static R-tree of 2D boxes, bulk-loaded with sort-tile-recursive packing.
+  Queries are read-only and can run on several threads at once.
+*/
+class PDAL_DLL RTree
+{
+public:
+    /**
+      \param boxes  Boxes to index.  The ID of a box is its position in
+        the vector.  Empty boxes are never found.
+      \param nodeSize  Maximum number of children of a node.
+    */
+    RTree(const std::vector<BOX2D>& boxes, size_t nodeSize = 16);
+
+    /**
+      Find the boxes that contain a point.
+
+      \param x  X position of the point.
+      \param y  Y position of the point.
+      \param[out] ids  IDs of the boxes containing the point, in increasing
+        order.
+    */
+    void find(double x, double y, std::vector<size_t>& ids) const;
+
+private:
+    struct Node
+    {
+        BOX2D m_box;
+        // Range of children in the level below, or of entries of m_ids
+        // for leaves.
+        uint32_t m_begin;
+        uint32_t m_end;
+    };
+
+    size_t m_nodeSize;
+    std::vector<BOX2D> m_boxes;
+    std::vector<size_t> m_ids;
+    // Levels of the tree, leaves first.  The last level is the root.
+    std::vector<std::vector<Node>> m_levels;
+
+    std::vector<Node> pack(std::vector<Node>& entries) const;
+};
+
+} // namespace pdal
@@ -0,0 +1,188 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include "RankSelect.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <mutex>
+
+#include <pdal/util/ThreadPool.hpp>
+
+namespace pdal
+{
+
+namespace
+{
+
+const point_count_t BlockSize = 1 << 16;
+const point_count_t CandidateLimit = 1 << 20;
+const int RadixBits = 16;
+const std::size_t NumBuckets = std::size_t(1) << RadixBits;
+
+// Unsigned key with the same order as the double, so counting by the
+// high bits of keys splits the values into ordered buckets.
+uint64_t toKey(double d)
+{
+    uint64_t u;
+    std::memcpy(&u, &d, sizeof(u));
+    return (u >> 63) ? ~u : (u | (uint64_t(1) << 63));
+}
+
+double fromKey(uint64_t k)
+{
+    uint64_t u = (k >> 63) ? (k & ~(uint64_t(1) << 63)) : ~k;
+    double d;
+    std::memcpy(&d, &u, sizeof(d));
+    return d;
+}
+
+// Calls visit(state, value, key) for the transformed value of every point,
+// on one thread per core.  Each thread gets its own state from init(),
+// and the states are returned when all the points have been seen.
+template<typename State, typename Transform, typename Init, typename Visit>
+std::deque<State> scan(const PointView& view, Dimension::Id dim,
+    Transform xform, Init init, Visit visit)
+{
+    const point_count_t n = view.size();
+    const std::size_t numBlocks = (n + BlockSize - 1) / BlockSize;
+    std::deque<State> states;
+    std::mutex mutex;
+
+    parallelFor(numBlocks, [&]()
+    {
+        State *state;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            states.push_back(init());
+            state = &states.back();
+        }
+        std::vector<double> buf(BlockSize);
+        return [&, state, buf](std::size_t b) mutable
+        {
+            PointId begin = b * BlockSize;
+            point_count_t len = (std::min)(BlockSize, n - begin);
+            view.getFieldArray(dim, begin, len, buf.data());
+            for (point_count_t i = 0; i < len; ++i)
+            {
+                double v = xform(buf[i]);
+                visit(*state, v, toKey(v));
+            }
+        };
+    }, 1);
+    return states;
+}
+
+} // unnamed namespace
+
+template<typename Transform>
+double RankSelect::select(point_count_t rank, Transform xform) const
+{
+    const point_count_t n = m_view.size();
+    if (rank >= n)
+        throw pdal_error("Rank " + std::to_string(rank) +
+            " is beyond the " + std::to_string(n) + " points of the view.");
+
+    uint64_t prefix = 0;
+    int prefixBits = 0;
+    point_count_t count = n;
+
+    // Whether a key starts with the bits found so far.
+    auto matches = [&prefix, &prefixBits](uint64_t key)
+    {
+        return prefixBits == 0 || (key >> (64 - prefixBits)) == prefix;
+    };
+
+    // Narrow the keys a radix digit at a time until few enough values
+    // are left to gather.
+    while (count > CandidateLimit)
+    {
+        // Every key left is the same, so it's the answer.
+        if (prefixBits == 64)
+            return fromKey(prefix);
+
+        const int shift = 64 - prefixBits - RadixBits;
+        auto hists = scan<std::vector<point_count_t>>(m_view, m_dim, xform,
+            [](){ return std::vector<point_count_t>(NumBuckets); },
+            [&](std::vector<point_count_t>& h, double, uint64_t key)
+            {
+                if (matches(key))
+                    h[(key >> shift) & (NumBuckets - 1)]++;
+            });
+
+        std::vector<point_count_t> total(NumBuckets);
+        for (auto& h : hists)
+            for (std::size_t i = 0; i < NumBuckets; ++i)
+                total[i] += h[i];
+
+        std::size_t bucket = 0;
+        while (rank >= total[bucket])
+            rank -= total[bucket++];
+        count = total[bucket];
+        prefix = (prefix << RadixBits) | bucket;
+        prefixBits += RadixBits;
+    }
+
+    auto lists = scan<std::vector<double>>(m_view, m_dim, xform,
+        [](){ return std::vector<double>(); },
+        [&](std::vector<double>& l, double v, uint64_t key)
+        {
+            if (matches(key))
+                l.push_back(v);
+        });
+
+    std::vector<double> vals;
+    vals.reserve(count);
+    for (auto& l : lists)
+        vals.insert(vals.end(), l.begin(), l.end());
+    std::nth_element(vals.begin(), vals.begin() + rank, vals.end());
+    return vals[rank];
+}
+
+
+double RankSelect::value(point_count_t rank) const
+{
+    return select(rank, [](double v){ return v; });
+}
+
+
+double RankSelect::deviation(double center, point_count_t rank) const
+{
+    return select(rank, [center](double v){ return std::fabs(v - center); });
+}
+
+} // namespace pdal
@@ -0,0 +1,89 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <pdal/PointView.hpp>
+
+namespace pdal
+{
+
+/**
+  Finds exact order statistics of the values of a dimension without
+  copying and sorting all of them.  Each pass over the points counts
+  them by the next 16 bits of a key with the same order as the values,
+  which narrows the search to the one bucket that holds the wanted rank.
+  Blocks of points are counted on several threads and their counts
+  merged.  Once few enough values are left they are gathered and the
+  rank is chosen with std::nth_element().
+*/
+class PDAL_DLL RankSelect
+{
+public:
+    /**
+      \param view  Points holding the values.
+      \param dim  Dimension of the values.
+    */
+    RankSelect(const PointView& view, Dimension::Id dim) :
+        m_view(view), m_dim(dim)
+    {}
+
+    /**
+      Value that would be at a position if the values were sorted.
+
+      \param rank  Zero-based position in sorted order.
+      \return  Value at the position.
+    */
+    double value(point_count_t rank) const;
+
+    /**
+      Distance from a center that would be at a position if the distances
+      of all the values from the center were sorted.
+
+      \param center  Value from which distances are measured.
+      \param rank  Zero-based position in sorted order.
+      \return  Distance at the position.
+    */
+    double deviation(double center, point_count_t rank) const;
+
+private:
+    const PointView& m_view;
+    Dimension::Id m_dim;
+
+    template<typename Transform>
+    double select(point_count_t rank, Transform xform) const;
+};
+
+} // namespace pdal
@@ -41,6 +41,10 @@
 #include "DimRange.hpp"
 #include "Segmentation.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
 #include <vector>
 
 namespace pdal
@@ -49,81 +53,122 @@ namespace pdal
 namespace Segmentation
 {
 
+namespace
+{
+
+// Find the root of a point's set, halving the path on the way.  A failed
+// exchange just means another thread has already shortened the path.
+PointId findRoot(std::vector<std::atomic<PointId>>& parents, PointId i)
+{
+    while (true)
+    {
+        PointId p = parents[i].load();
+        if (p == i)
+            return i;
+        PointId gp = parents[p].load();
+        if (p != gp)
+            parents[i].compare_exchange_weak(p, gp);
+        i = gp;
+    }
+}
+
+// Join the sets of two points.  The larger root is always linked below the
+// smaller, so the root of a set is its lowest PointId.
+void unite(std::vector<std::atomic<PointId>>& parents, PointId a, PointId b)
+{
+    while (true)
+    {
+        a = findRoot(parents, a);
+        b = findRoot(parents, b);
+        if (a == b)
+            return;
+        if (a < b)
+            std::swap(a, b);
+        PointId expected = a;
+        if (parents[a].compare_exchange_strong(expected, b))
+            return;
+    }
+}
+
+} // unnamed namespace
+
 std::vector<std::vector<PointId>> extractClusters(PointView& view,
                                                   uint64_t min_points,
                                                   uint64_t max_points,
                                                   double tolerance)
 {
     // Index the incoming PointView for subsequent radius searches.
-    KD3Index kdi(view);
-    kdi.build();
-
-    // Create variables to track PointIds that have already been added to
-    // clusters and to build the list of cluster indices.
-    std::vector<PointId> processed(view.size(), 0);
-    std::vector<std::vector<PointId>> clusters;
+    KD3Index& kdi = view.build3dIndex();
 
+    // Start with each point in a set of its own and join the sets of every
+    // pair of neighbors.  Distances are symmetric, so each pair only needs
+    // to be joined from one side.
+    std::vector<std::atomic<PointId>> parents(view.size());
     for (PointId i = 0; i < view.size(); ++i)
+        parents[i].store(i);
+    kdi.radiusAll(tolerance, [&parents](PointId i,
+        const std::vector<PointId>& ids, const std::vector<double>&)
     {
-        // Points can only belong to a single cluster.
-        if (processed[i])
-            continue;
+        for (PointId j : ids)
+            if (j > i)
+                unite(parents, i, j);
+    });
 
-        // Initialize list of indices belonging to current cluster, marking the
-        // seed point as processed.
-        std::vector<PointId> seed_queue;
-        size_t sq_idx = 0;
-        seed_queue.push_back(i);
-        processed[i] = 1;
-
-        // Check each point in the cluster for additional neighbors within the
-        // given tolerance, remembering that the list can grow if we add points
-        // to the cluster.
-        while (sq_idx < seed_queue.size())
+    // The root of a set is its lowest point, so visiting points in order
+    // numbers the clusters by their lowest point.
+    const size_t none = (std::numeric_limits<size_t>::max)();
+    std::vector<size_t> clusterIdx(view.size(), none);
+    std::vector<std::vector<PointId>> all;
+    for (PointId i = 0; i < view.size(); ++i)
+    {
+        PointId root = findRoot(parents, i);
+        if (root == i)
         {
-            // Find neighbors of the next cluster point.
-            PointId j = seed_queue[sq_idx];
-            std::vector<PointId> ids = kdi.radius(j, tolerance);
-
-            // The case where the only neighbor is the query point.
-            if (ids.size() == 1)
-            {
-                sq_idx++;
-                continue;
-            }
-
-            // Skip neighbors that already belong to a cluster and add the rest
-            // to this cluster.
-            for (auto const& k : ids)
-            {
-                if (processed[k])
-                    continue;
-                seed_queue.push_back(k);
-                processed[k] = 1;
-            }
-
-            sq_idx++;
+            clusterIdx[i] = all.size();
+            all.emplace_back();
         }
-
-        // Keep clusters that are within the min/max number of points.
-        if (seed_queue.size() >= min_points && seed_queue.size() <= max_points)
-            clusters.push_back(seed_queue);
+        all[clusterIdx[root]].push_back(i);
     }
 
+    // Keep clusters that are within the min/max number of points.
+    std::vector<std::vector<PointId>> clusters;
+    for (auto& c : all)
+        if (c.size() >= min_points && c.size() <= max_points)
+            clusters.push_back(std::move(c));
+
     return clusters;
 }
 
+// Points are tested in blocks so that ranges see arrays of values.
+namespace
+{
+
+const point_count_t IgnoreBlockSize = 4096;
+
+void splitIgnored(PointViewPtr input, PointViewPtr keep, PointViewPtr ignore,
+    PointId idx, point_count_t count, const std::vector<char>& passes)
+{
+    for (point_count_t i = 0; i < count; ++i)
+        if (passes[i])
+            ignore->appendPoint(*input, idx + i);
+        else
+            keep->appendPoint(*input, idx + i);
+}
+
+} // unnamed namespace
+
 void ignoreDimRange(DimRange dr, PointViewPtr input, PointViewPtr keep,
                     PointViewPtr ignore)
 {
-    PointRef point(*input, 0);
-    for (PointId i = 0; i < input->size(); ++i)
+    std::vector<double> values(IgnoreBlockSize);
+    std::vector<char> passes(IgnoreBlockSize);
+    for (PointId idx = 0; idx < input->size(); idx += IgnoreBlockSize)
     {
-        point.setPointId(i);
-        if (dr.valuePasses(point.getFieldAs<double>(dr.m_id)))
-            ignore->appendPoint(*input, i);
-        else
-            keep->appendPoint(*input, i);
+        point_count_t count =
+            (std::min)(IgnoreBlockSize, input->size() - idx);
+        input->getFieldArray(dr.m_id, idx, count, values.data());
+        dr.valuesPass(values.data(), count, passes.data());
+        splitIgnored(input, keep, ignore, idx, count, passes);
     }
 }
 
@@ -131,14 +176,17 @@ void ignoreDimRanges(std::vector<DimRange>& ranges, PointViewPtr input,
     PointViewPtr keep, PointViewPtr ignore)
 {
     std::sort(ranges.begin(), ranges.end());
-    PointRef point(*input, 0);
-    for (PointId i = 0; i < input->size(); ++i)
+    DimRangeList list(ranges);
+    std::vector<char> passes(IgnoreBlockSize);
+    for (PointId idx = 0; idx < input->size(); idx += IgnoreBlockSize)
     {
-        point.setPointId(i);
-        if (DimRange::pointPasses(ranges, point))
-            ignore->appendPoint(*input, i);
-        else
-            keep->appendPoint(*input, i);
+        point_count_t count =
+            (std::min)(IgnoreBlockSize, input->size() - idx);
+        std::fill(passes.begin(), passes.begin() + count, 1);
+        list.test([&](Dimension::Id id, double *v)
+            { input->getFieldArray(id, idx, count, v); },
+            count, passes.data());
+        splitIgnored(input, keep, ignore, idx, count, passes);
     }
 }
 
@@ -200,5 +248,67 @@ void segmentReturns(PointViewPtr input, PointViewPtr first,
     }
 }
 
+std::vector<Tile> tileView(PointViewPtr input, double size, double buffer)
+{
+    using namespace Dimension;
+
+    BOX2D bounds;
+    input->calculateBounds(bounds);
+    size_t cols = static_cast<size_t>((bounds.maxx - bounds.minx) / size) + 1;
+    size_t rows = static_cast<size_t>((bounds.maxy - bounds.miny) / size) + 1;
+
+    // Index of the tile holding a position along one axis, clamped to the
+    // tiles that exist.
+    auto tileIndex = [size](double pos, double min, size_t count)
+    {
+        double d = std::floor((pos - min) / size);
+        if (d < 0)
+            return (size_t)0;
+        return (std::min)(static_cast<size_t>(d), count - 1);
+    };
+
+    std::vector<std::vector<PointId>> core(rows * cols);
+    std::vector<std::vector<PointId>> halo(rows * cols);
+    for (PointId i = 0; i < input->size(); ++i)
+    {
+        double x = input->getFieldAs<double>(Id::X, i);
+        double y = input->getFieldAs<double>(Id::Y, i);
+
+        size_t col = tileIndex(x, bounds.minx, cols);
+        size_t row = tileIndex(y, bounds.miny, rows);
+        size_t colEnd = tileIndex(x + buffer, bounds.minx, cols);
+        size_t rowEnd = tileIndex(y + buffer, bounds.miny, rows);
+        for (size_t c = tileIndex(x - buffer, bounds.minx, cols);
+                c <= colEnd; ++c)
+            for (size_t r = tileIndex(y - buffer, bounds.miny, rows);
+                    r <= rowEnd; ++r)
+                if (c == col && r == row)
+                    core[c * rows + r].push_back(i);
+                else
+                    halo[c * rows + r].push_back(i);
+    }
+
+    std::vector<Tile> tiles;
+    for (size_t t = 0; t < core.size(); ++t)
+    {
+        if (core[t].empty())
+            continue;
+
+        Tile tile;
+        tile.m_view = input->makeNew();
+        tile.m_coreCount = core[t].size();
+        for (PointId i : core[t])
+            tile.m_view->appendPoint(*input, i);
+        for (PointId i : halo[t])
+            tile.m_view->appendPoint(*input, i);
+        tiles.push_back(tile);
+
+        // Release each tile's IDs once its view holds them.
+        std::vector<PointId>().swap(core[t]);
+        std::vector<PointId>().swap(halo[t]);
+    }
+    return tiles;
+}
+
 } // namespace Segmentation
 } // namespace pdal
@@ -52,10 +52,12 @@ namespace Segmentation
 /**
   Extract clusters of points from input PointView.
 
-  For each point, find neighbors within a given tolerance (Euclidean distance).
-  If a neighbor already belongs to another cluster, skip it. Otherwise, add it
-  to the current cluster. Recursively visit newly added cluster points, looking
-  for neighbors to add to the cluster.
+  Two points belong to the same cluster if they're within a given tolerance
+  (Euclidean distance) of each other or are linked by a chain of such points.
+  Neighbors are found and joined into clusters on as many threads as there
+  are cores.  The result doesn't depend on the number of threads: clusters
+  are ordered by their lowest PointId and the points of each cluster are in
+  increasing order.
 
   \param[in] view the input PointView.
   \param[in] min_points the minimum number of points in a cluster.
@@ -79,5 +81,30 @@ PDAL_DLL void segmentLastReturns(PointViewPtr input, PointViewPtr last,
 PDAL_DLL void segmentReturns(PointViewPtr input, PointViewPtr first,
                              PointViewPtr second, StringList returns);
 
+/**
+  A square tile of points along with the points in a buffer around it.
+*/
+struct Tile
+{
+    /// Points of the tile followed by the points of its buffer.
+    PointViewPtr m_view;
+    /// Number of points of the tile itself, at the start of the view.
+    point_count_t m_coreCount;
+};
+
+/**
+  Split the points of a view into square tiles aligned with the minimum X
+  and Y of the points.  Each point belongs to exactly one tile, and also
+  appears in the buffer of every other tile that is within 'buffer' of it.
+  Tiles without points of their own are skipped.
+
+  \param[in] input the input PointView.
+  \param[in] size the length of the sides of the tiles.
+  \param[in] buffer the width of the buffer around each tile.
+  \returns the tiles.
+*/
+PDAL_DLL std::vector<Tile> tileView(PointViewPtr input, double size,
+                                    double buffer);
+
 } // namespace Segmentation
 } // namespace pdal
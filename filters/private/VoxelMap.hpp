@@ -0,0 +1,230 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <pdal/util/Bounds.hpp>
+
+namespace pdal
+{
+
+/**
+  Packs the row, column and depth of a voxel into a 64-bit key.  The
+  row is in the high bits and the depth in the low bits, so keys sort
+  by row, then column, then depth.
+*/
+class VoxelKey
+{
+public:
+    /**
+      \param bounds  Bounds of the points.
+      \param cell  Edge length of a voxel.
+    */
+    VoxelKey(const BOX3D& bounds, double cell) : m_minx(bounds.minx),
+        m_miny(bounds.miny), m_minz(bounds.minz), m_cell(cell)
+    {
+        int colBits = bits(index(bounds.maxx, m_minx));
+        int rowBits = bits(index(bounds.maxy, m_miny));
+        int depthBits = bits(index(bounds.maxz, m_minz));
+        m_fits = (colBits + rowBits + depthBits <= 63);
+        m_colShift = depthBits;
+        m_rowShift = depthBits + colBits;
+    }
+
+    /// Whether the indices of every voxel in the bounds fit in a key.
+    bool fits() const
+        { return m_fits; }
+
+    /// Column of a voxel containing an X value.
+    size_t col(double x) const
+        { return index(x, m_minx); }
+    /// Row of a voxel containing a Y value.
+    size_t row(double y) const
+        { return index(y, m_miny); }
+    /// Depth of a voxel containing a Z value.
+    size_t depth(double z) const
+        { return index(z, m_minz); }
+
+    /// Key of a voxel.
+    uint64_t key(size_t col, size_t row, size_t depth) const
+    {
+        return ((uint64_t)row << m_rowShift) |
+            ((uint64_t)col << m_colShift) | (uint64_t)depth;
+    }
+
+private:
+    double m_minx;
+    double m_miny;
+    double m_minz;
+    double m_cell;
+    int m_colShift;
+    int m_rowShift;
+    bool m_fits;
+
+    size_t index(double v, double min) const
+        { return static_cast<size_t>((v - min) / m_cell); }
+
+    static int bits(size_t maxIndex)
+    {
+        int b = 0;
+        while (b < 64 && ((uint64_t)1 << b) <= maxIndex)
+            b++;
+        return b;
+    }
+};
+
+/**
+  Hash map from voxel keys to values, using open addressing with linear
+  probing.  Keys must come from \ref VoxelKey, which never uses all 64
+  bits, so the all-ones key marks empty slots.
+*/
+template <typename T>
+class VoxelMap
+{
+public:
+    typedef std::pair<uint64_t, T> Entry;
+
+    VoxelMap() : m_size(0)
+        { reset(16); }
+
+    /// Number of voxels in the map.
+    size_t size() const
+        { return m_size; }
+
+    /// Value of a voxel, which is value-initialized if it isn't in the map.
+    T& operator[](uint64_t key)
+    {
+        size_t pos = slot(key);
+        if (m_keys[pos] != empty())
+            return m_values[pos];
+
+        // Keep the load factor at or below one half.
+        if ((m_size + 1) * 2 > m_keys.size())
+        {
+            grow();
+            pos = slot(key);
+        }
+        m_keys[pos] = key;
+        m_values[pos] = T();
+        m_size++;
+        return m_values[pos];
+    }
+
+    /// Value of a voxel, or null if the voxel isn't in the map.
+    const T *find(uint64_t key) const
+    {
+        size_t pos = slot(key);
+        return m_keys[pos] == empty() ? nullptr : &m_values[pos];
+    }
+
+    /**
+      Calls a function with the key and value of each voxel, in no
+      particular order.
+    */
+    template <typename F>
+    void forEach(F f)
+    {
+        for (size_t i = 0; i < m_keys.size(); ++i)
+            if (m_keys[i] != empty())
+                f(m_keys[i], m_values[i]);
+    }
+
+    /// Voxels of the map, ordered by key.
+    std::vector<Entry> sorted() const
+    {
+        std::vector<Entry> entries;
+        entries.reserve(m_size);
+        for (size_t i = 0; i < m_keys.size(); ++i)
+            if (m_keys[i] != empty())
+                entries.emplace_back(m_keys[i], m_values[i]);
+        std::sort(entries.begin(), entries.end(),
+            [](const Entry& e1, const Entry& e2)
+            { return e1.first < e2.first; });
+        return entries;
+    }
+
+private:
+    std::vector<uint64_t> m_keys;
+    std::vector<T> m_values;
+    size_t m_size;
+
+    static uint64_t empty()
+        { return ~(uint64_t)0; }
+
+    // Slot holding a key, or the empty slot where it would go.
+    size_t slot(uint64_t key) const
+    {
+        // Mix the bits (the splitmix64 finalizer), since neighboring
+        // voxels differ only in a few low bits of each field.
+        uint64_t h = key;
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+        h ^= h >> 31;
+
+        const size_t mask = m_keys.size() - 1;
+        size_t pos = (size_t)h & mask;
+        while (m_keys[pos] != empty() && m_keys[pos] != key)
+            pos = (pos + 1) & mask;
+        return pos;
+    }
+
+    void reset(size_t capacity)
+    {
+        m_keys.assign(capacity, empty());
+        m_values.assign(capacity, T());
+    }
+
+    void grow()
+    {
+        std::vector<uint64_t> keys;
+        std::vector<T> values;
+        keys.swap(m_keys);
+        values.swap(m_values);
+        reset(keys.size() * 2);
+        for (size_t i = 0; i < keys.size(); ++i)
+            if (keys[i] != empty())
+            {
+                size_t pos = slot(keys[i]);
+                m_keys[pos] = keys[i];
+                m_values[pos] = std::move(values[i]);
+            }
+    }
+};
+
+} // namespace pdal
@@ -48,7 +48,8 @@ namespace hexer
 {
 
 HexGrid::HexGrid(int dense_limit) : m_height(-1.0), m_width(-1.0),
-    m_pos_roots(HexCompare()), m_dense_limit(dense_limit), m_miny(1)
+    m_has_origin(false), m_pos_roots(HexCompare()),
+    m_dense_limit(dense_limit), m_miny(1)
 {}
 
 void HexGrid::initialize(double height)
@@ -71,7 +72,9 @@ bool HexGrid::dense(Hexagon *h)
     return h->count() >= m_dense_limit;
 }
 
-void HexGrid::addPoint(Point p)
+// The weight is the number of points that this point stands for.  Points
+// collected to compute the hexagon size are counted once.
+void HexGrid::addPoint(Point p, int weight)
 {
     if (m_width < 0)
     {
@@ -82,7 +85,12 @@ void HexGrid::addPoint(Point p)
     }
 
     Hexagon *h = findHexagon(p);
-    h->increment();
+    h->increment(weight);
+    updateDense(h);
+}
+
+void HexGrid::updateDense(Hexagon *h)
+{
     if (!h->dense())
     {
         if (dense(h))
@@ -96,6 +104,21 @@ void HexGrid::addPoint(Point p)
     }
 }
 
+// Whether a hexagon is dense only depends on its final count, so grids
+// can be merged in any order.
+void HexGrid::merge(const HexGrid& grid)
+{
+    for (auto it = grid.m_hexes.begin(); it != grid.m_hexes.end(); ++it)
+    {
+        const Hexagon& src = it->second;
+        if (src.count() == 0)
+            continue;
+        Hexagon *h = getHexagon(src.x(), src.y());
+        h->increment(src.count());
+        updateDense(h);
+    }
+}
+
 void HexGrid::processSample()
 {
     if (m_width > 0 || m_sample.empty())
@@ -182,9 +205,10 @@ Hexagon *HexGrid::findHexagon(Point p)
 {
     int x, y;
 
-    if (m_hexes.empty())
+    if (!m_has_origin)
     {
         m_origin = p;
+        m_has_origin = true;
         // Make a hex at the origin and insert it.  Return a pointer
         // to the hexagon in the map.
         HexMap::value_type hexpair(Hexagon::key(0, 0), Hexagon(0, 0));
@@ -296,11 +320,22 @@ void HexGrid::findShapes()
 
 void HexGrid::findParentPaths()
 {
+    // Index the horizontal path segments by column, from the top down, so
+    // that finding a parent doesn't look up every hexagon below a path.
+    std::unordered_map<int, ColumnPaths> columns;
+    for (auto it = m_hex_paths.begin(); it != m_hex_paths.end(); ++it)
+        columns[it->first->x()].emplace_back(it->first->y(), it->second);
+    for (auto it = columns.begin(); it != columns.end(); ++it)
+        std::sort(it->second.begin(), it->second.end(),
+            [](const ColumnPaths::value_type& a,
+                const ColumnPaths::value_type& b)
+            { return a.first > b.first; });
+
     std::vector<Path *> roots;
     for (size_t i = 0; i < m_paths.size(); ++i)
     {
         Path *p = m_paths[i];
-        findParentPath(p);
+        findParentPath(p, columns[p->rootSegment().hex()->x()]);
         // Either add the path to the root list or the parent's list of
         // children.
         !p->parent() ?  roots.push_back(p) : p->parent()->addChild(p);
@@ -313,27 +348,26 @@ void HexGrid::findParentPaths()
     m_paths = roots;
 }
 
-void HexGrid::findParentPath(Path *p)
+// Walk down the column from the root segment of a path.  Each path
+// crossed toggles whether it contains the path.
+void HexGrid::findParentPath(Path *p, const ColumnPaths& column)
 {
-    Segment s = p->rootSegment();
-    Hexagon *h = s.hex();
-    int y = h->y();
-    while (y >= m_miny)
+    const int y = p->rootSegment().hex()->y();
+    for (auto it = column.begin(); it != column.end(); ++it)
     {
-        HexPathMap::iterator it = m_hex_paths.find(h);
-        if (it != m_hex_paths.end())
+        if (it->first > y)
+            continue;
+        if (it->first < m_miny)
+            break;
+        Path *parentPath = it->second;
+        if (parentPath == p->parent())
         {
-            Path *parentPath = it->second;
-            if (parentPath == p->parent())
-            {
-               p->setParent(NULL);
-            }
-            else if (!p->parent() && parentPath != p)
-            {
-               p->setParent(parentPath);
-            }
+           p->setParent(NULL);
+        }
+        else if (!p->parent() && parentPath != p)
+        {
+           p->setParent(parentPath);
         }
-        h = getHexagon(h->x(), --y);
     }
 }
 
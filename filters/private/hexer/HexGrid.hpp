@@ -55,7 +55,14 @@ class HexGrid
     friend class HexIter;
 public:
     HexGrid(int dense_limit);
-    HexGrid(double height, int dense_limit) : m_dense_limit(dense_limit)
+    HexGrid(double height, int dense_limit) : m_has_origin(false),
+            m_dense_limit(dense_limit)
+        { initialize(height); }
+    /// Make a grid whose hexagons line up with those of a grid with the
+    /// given origin, so that the two can be merged.
+    HexGrid(double height, int dense_limit, const Point& origin) :
+            m_origin(origin), m_has_origin(true),
+            m_dense_limit(dense_limit)
         { initialize(height); }
 
     ~HexGrid()
@@ -65,9 +72,16 @@ public:
     }
 
     bool dense(Hexagon *h);
-    void addPoint(double x, double y)
-        { addPoint(Point(x, y)); }
-    void addPoint(Point p);
+    void addPoint(double x, double y, int weight = 1)
+        { addPoint(Point(x, y), weight); }
+    void addPoint(Point p, int weight = 1);
+    /// Count a point in its hexagon without tracking dense hexagons.  Use
+    /// on grids that will be merged into another.
+    void countPoint(double x, double y, int weight = 1)
+        { findHexagon(Point(x, y))->increment(weight); }
+    /// Add the hexagon counts of a grid made with the same height and
+    /// origin.
+    void merge(const HexGrid& grid);
     void processSample();
     void findShapes();
     void findParentPaths();
@@ -90,6 +104,8 @@ public:
         { return (m_offsets[idx] - m_center_offset); }
     Point const& origin() const
         { return m_origin; }
+    bool hasOrigin() const
+        { return m_has_origin; }
     int denseLimit() const
         { return m_dense_limit; }
     std::vector<Path *> const& rootPaths() const
@@ -102,10 +118,14 @@ public:
 private:
     void initialize(double height);
     Hexagon *findHexagon(Point p);
+    void updateDense(Hexagon *h);
     void findShape(Hexagon *hex);
     void findHole(Hexagon *hex);
     void cleanPossibleRoot(Segment s, Path *p);
-    void findParentPath(Path *p);
+    /// Root paths by the Y position of their horizontal segments in a
+    /// column.
+    typedef std::vector<std::pair<int, Path *>> ColumnPaths;
+    void findParentPath(Path *p, const ColumnPaths& column);
     void markNeighborBelow(Hexagon *hex);
 
     /// Height of the hexagons in the grid (2x apothem)
@@ -114,6 +134,8 @@ private:
     double m_width;
     /// Origin of the hex grid in point coordinates.
     Point m_origin;
+    /// Whether the origin has been set.
+    bool m_has_origin;
     /// Offsets of vertices of hexagon, going anti-clockwise from upper-left
     Point m_offsets[6];
     /// Offset of the center of the hexagons.
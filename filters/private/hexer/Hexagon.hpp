@@ -55,6 +55,9 @@ public:
     void increment()
        { m_count++; }
 
+    void increment(int count)
+       { m_count += count; }
+
     static uint64_t key(int32_t x, int32_t y)
     {
         uint32_t ux = (uint32_t)x;
@@ -33,6 +33,7 @@
  ****************************************************************************/
 
 #include "Comparison.hpp"
+#include "Program.hpp"
 
 namespace pdal
 {
@@ -109,5 +110,26 @@ std::unique_ptr<Comparison> Comparison::create(const PointLayout& layout,
     }
 }
 
+std::size_t ComparisonSingle::compile(Program& program) const
+{
+    return program.compare(type(), m_dimId, m_operand);
+}
+
+std::size_t ComparisonAny::compile(Program& program) const
+{
+    std::vector<std::size_t> children;
+    for (const Operand& op : m_operands)
+        children.push_back(program.compare(ComparisonType::eq, m_dimId, op));
+    return program.gate(LogicalOperator::lOr, children);
+}
+
+std::size_t ComparisonNone::compile(Program& program) const
+{
+    std::vector<std::size_t> children;
+    for (const Operand& op : m_operands)
+        children.push_back(program.compare(ComparisonType::eq, m_dimId, op));
+    return program.gate(LogicalOperator::lNor, children);
+}
+
 } // namespace pdal
 
@@ -140,6 +140,13 @@ public:
             return Dimension::name(m_id);
     }
 
+    bool isDimension() const
+        { return m_id != Dimension::Id::Unknown; }
+    Dimension::Id id() const
+        { return m_id; }
+    double value() const
+        { return m_value; }
+
 private:
     double m_value = 0;
     Dimension::Id m_id = Dimension::Id::Unknown;
@@ -174,6 +181,8 @@ public:
         return compare(pr.getFieldAs<double>(m_dimId), m_operand.get(pr));
     }
 
+    virtual std::size_t compile(Program& program) const override;
+
     virtual std::string toString(std::string pre) const override
     {
         std::ostringstream ss;
@@ -302,6 +311,8 @@ protected:
                 m_operands.end(),
                 [&pr, val](const Operand& op) { return val == op.get(pr); });
     }
+
+    virtual std::size_t compile(Program& program) const override;
 };
 
 class ComparisonNone : public ComparisonMulti
@@ -322,6 +333,8 @@ protected:
                 m_operands.end(),
                 [&pr, val](const Operand& op) { return val == op.get(pr); });
     }
+
+    virtual std::size_t compile(Program& program) const override;
 };
 
 } // namespace pdal
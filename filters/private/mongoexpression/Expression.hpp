@@ -36,6 +36,7 @@
 
 #include "Comparison.hpp"
 #include "LogicGate.hpp"
+#include "Program.hpp"
 
 namespace pdal
 {
@@ -59,6 +60,11 @@ public:
         return m_root.toString("");
     }
 
+    void compile(Program& program) const
+    {
+        program.setRoot(m_root.compile(program));
+    }
+
 private:
     void build(LogicGate& gate, const Json::Value& json);
 
@@ -33,6 +33,7 @@
  ****************************************************************************/
 
 #include "LogicGate.hpp"
+#include "Program.hpp"
 
 namespace pdal
 {
@@ -46,5 +47,13 @@ std::unique_ptr<LogicGate> LogicGate::create(const LogicalOperator type)
     throw pdal_error("Invalid logic gate type");
 }
 
+std::size_t LogicGate::compile(Program& program) const
+{
+    std::vector<std::size_t> children;
+    for (const auto& f : m_filters)
+        children.push_back(f->compile(program));
+    return program.gate(type(), children);
+}
+
 } // namespace pdal
 
@@ -100,6 +100,8 @@ public:
 
     virtual LogicalOperator type() const = 0;
 
+    virtual std::size_t compile(Program& program) const override;
+
 protected:
     std::vector<std::unique_ptr<Filterable>> m_filters;
 };
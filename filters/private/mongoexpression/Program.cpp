@@ -0,0 +1,344 @@
+/******************************************************************************
+ * Copyright (c) 2018, Connor Manning (connor@hobu.co)
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following
+ * conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+ *       names of its contributors may be used to endorse or promote
+ *       products derived from this software without specific prior
+ *       written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ ****************************************************************************/
+
+
+#include "Program.hpp"
+
+#include <algorithm>
+
+namespace pdal
+{
+
+namespace
+{
+
+template<typename Op>
+void compareValues(const double *a, const double *b, double c,
+    point_count_t count, char *out, Op op)
+{
+    if (b)
+        for (point_count_t i = 0; i < count; ++i)
+            out[i] = op(a[i], b[i]);
+    else
+        for (point_count_t i = 0; i < count; ++i)
+            out[i] = op(a[i], c);
+}
+
+bool none(const char *mask, point_count_t count)
+{
+    return std::find(mask, mask + count, 1) == mask + count;
+}
+
+bool all(const char *mask, point_count_t count)
+{
+    return std::find(mask, mask + count, 0) == mask + count;
+}
+
+} // unnamed namespace
+
+std::size_t Program::push(Node node)
+{
+    m_nodes.push_back(std::move(node));
+    return m_nodes.size() - 1;
+}
+
+
+std::size_t Program::constant(bool value)
+{
+    return push(Node(value ? Opcode::True : Opcode::False));
+}
+
+
+std::size_t Program::compare(ComparisonType type, Dimension::Id id,
+    const Operand& op)
+{
+    if (!isSingle(type))
+        throw pdal_error("Can't compile multi-valued comparison " +
+            typeToString(type));
+
+    Node node(Opcode::Compare);
+    node.m_type = type;
+    node.m_lhs = reg(id);
+    node.m_rhsConstant = !op.isDimension();
+    if (node.m_rhsConstant)
+        node.m_value = op.value();
+    else
+        node.m_rhs = reg(op.id());
+    return push(node);
+}
+
+
+std::size_t Program::gate(LogicalOperator type,
+    const std::vector<std::size_t>& children)
+{
+    if (type == LogicalOperator::lNot)
+    {
+        if (children.size() != 1)
+            throw pdal_error("Logical NOT requires a single expression");
+        return negate(children[0]);
+    }
+    if (type == LogicalOperator::lNor)
+        return negate(gate(LogicalOperator::lOr, children));
+
+    const Opcode op =
+        (type == LogicalOperator::lAnd) ? Opcode::And : Opcode::Or;
+    // A child with the identity value doesn't change the result.  One with
+    // the absorbing value determines it.
+    const Opcode identity = (op == Opcode::And) ? Opcode::True : Opcode::False;
+    const Opcode absorbing = (op == Opcode::And) ? Opcode::False : Opcode::True;
+
+    Node node(op);
+    for (std::size_t c : children)
+    {
+        const Node& child = m_nodes[c];
+        if (child.m_op == identity)
+            continue;
+        if (child.m_op == absorbing)
+            return constant(op == Opcode::Or);
+        // Flatten nested gates of the same kind.
+        if (child.m_op == op)
+            node.m_children.insert(node.m_children.end(),
+                child.m_children.begin(), child.m_children.end());
+        else
+            node.m_children.push_back(c);
+    }
+    if (node.m_children.empty())
+        return constant(op == Opcode::And);
+    if (node.m_children.size() == 1)
+        return node.m_children[0];
+    return push(node);
+}
+
+
+std::size_t Program::negate(std::size_t n)
+{
+    const Node& node = m_nodes[n];
+    if (node.m_op == Opcode::True)
+        return constant(false);
+    if (node.m_op == Opcode::False)
+        return constant(true);
+    if (node.m_op == Opcode::Not)
+        return node.m_children[0];
+    // Only equality can be inverted in place.  The negation of an ordering
+    // comparison is true for NaN values.
+    if (node.m_op == Opcode::Compare && (node.m_type == ComparisonType::eq ||
+        node.m_type == ComparisonType::ne))
+    {
+        Node inverse(node);
+        inverse.m_type = (node.m_type == ComparisonType::eq) ?
+            ComparisonType::ne : ComparisonType::eq;
+        return push(inverse);
+    }
+
+    Node inverse(Opcode::Not);
+    inverse.m_children.push_back(n);
+    return push(inverse);
+}
+
+
+std::size_t Program::reg(Dimension::Id id)
+{
+    auto it = std::find(m_regIds.begin(), m_regIds.end(), id);
+    if (it != m_regIds.end())
+        return it - m_regIds.begin();
+    m_regIds.push_back(id);
+    m_regs.emplace_back();
+    m_loaded.push_back(0);
+    return m_regIds.size() - 1;
+}
+
+
+const double *Program::values(std::size_t r)
+{
+    std::vector<double>& v = m_regs[r];
+    if (!m_loaded[r])
+    {
+        if (v.size() < m_count)
+            v.resize(m_count);
+        (*m_getValues)(m_regIds[r], v.data());
+        m_loaded[r] = 1;
+    }
+    return v.data();
+}
+
+
+char *Program::scratch(std::size_t depth)
+{
+    if (m_scratch.size() <= depth)
+        m_scratch.resize(depth + 1);
+    std::vector<char>& s = m_scratch[depth];
+    if (s.size() < m_count)
+        s.resize(m_count);
+    return s.data();
+}
+
+
+void Program::test(const GetValues& getValues, point_count_t count,
+    char *passes)
+{
+    if (!count || m_nodes.empty())
+        return;
+
+    m_getValues = &getValues;
+    m_count = count;
+    std::fill(m_loaded.begin(), m_loaded.end(), 0);
+    if (m_result.size() < count)
+        m_result.resize(count);
+
+    eval(m_root, 0, m_result.data());
+    for (point_count_t i = 0; i < count; ++i)
+        passes[i] &= m_result[i];
+    m_getValues = nullptr;
+}
+
+
+void Program::eval(std::size_t n, std::size_t depth, char *out)
+{
+    Node& node = m_nodes[n];
+    switch (node.m_op)
+    {
+    case Opcode::True:
+        std::fill(out, out + m_count, 1);
+        break;
+    case Opcode::False:
+        std::fill(out, out + m_count, 0);
+        break;
+    case Opcode::Compare:
+        evalCompare(node, out);
+        break;
+    case Opcode::Not:
+        eval(node.m_children[0], depth + 1, out);
+        for (point_count_t i = 0; i < m_count; ++i)
+            out[i] = !out[i];
+        break;
+    case Opcode::And:
+    case Opcode::Or:
+        evalGate(node, depth, out);
+        break;
+    }
+}
+
+
+void Program::evalCompare(const Node& node, char *out)
+{
+    const double *a = values(node.m_lhs);
+    const double *b = node.m_rhsConstant ? nullptr : values(node.m_rhs);
+    const double c = node.m_value;
+
+    switch (node.m_type)
+    {
+    case ComparisonType::eq:
+        compareValues(a, b, c, m_count, out, std::equal_to<double>());
+        break;
+    case ComparisonType::ne:
+        compareValues(a, b, c, m_count, out, std::not_equal_to<double>());
+        break;
+    case ComparisonType::gt:
+        compareValues(a, b, c, m_count, out, std::greater<double>());
+        break;
+    case ComparisonType::gte:
+        compareValues(a, b, c, m_count, out, std::greater_equal<double>());
+        break;
+    case ComparisonType::lt:
+        compareValues(a, b, c, m_count, out, std::less<double>());
+        break;
+    case ComparisonType::lte:
+        compareValues(a, b, c, m_count, out, std::less_equal<double>());
+        break;
+    default:
+        throw pdal_error("Invalid compiled comparison");
+    }
+}
+
+
+void Program::evalGate(Node& node, std::size_t depth, char *out)
+{
+    const bool isAnd = (node.m_op == Opcode::And);
+    char *tmp = scratch(depth);
+
+    eval(node.m_children[0], depth + 1, out);
+    record(node.m_children[0], out);
+    for (std::size_t c = 1; c < node.m_children.size(); ++c)
+    {
+        // Skip the remaining children once the result is decided for
+        // every point of the block.
+        if (isAnd ? none(out, m_count) : all(out, m_count))
+            break;
+
+        const std::size_t child = node.m_children[c];
+        eval(child, depth + 1, tmp);
+        record(child, tmp);
+        if (isAnd)
+            for (point_count_t i = 0; i < m_count; ++i)
+                out[i] &= tmp[i];
+        else
+            for (point_count_t i = 0; i < m_count; ++i)
+                out[i] |= tmp[i];
+    }
+    reorder(node);
+}
+
+
+void Program::record(std::size_t n, const char *out)
+{
+    Node& node = m_nodes[n];
+    node.m_tested += m_count;
+    node.m_passed += std::count(out, out + m_count, 1);
+}
+
+
+void Program::reorder(Node& node)
+{
+    // The estimated fraction of points that pass each child.  Children that
+    // haven't been evaluated are assumed to pass half.
+    auto rate = [this](std::size_t n)
+    {
+        const Node& c = m_nodes[n];
+        return (c.m_passed + 1.0) / (c.m_tested + 2.0);
+    };
+
+    // AND is decided by its first failing child, OR by its first passing
+    // one.
+    if (node.m_op == Opcode::And)
+        std::stable_sort(node.m_children.begin(), node.m_children.end(),
+            [&rate](std::size_t a, std::size_t b)
+                { return rate(a) < rate(b); });
+    else
+        std::stable_sort(node.m_children.begin(), node.m_children.end(),
+            [&rate](std::size_t a, std::size_t b)
+                { return rate(a) > rate(b); });
+}
+
+} // namespace pdal
+
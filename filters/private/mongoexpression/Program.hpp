@@ -0,0 +1,133 @@
+/******************************************************************************
+ * Copyright (c) 2018, Connor Manning (connor@hobu.co)
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following
+ * conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+ *       names of its contributors may be used to endorse or promote
+ *       products derived from this software without specific prior
+ *       written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ ****************************************************************************/
+
+
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "Comparison.hpp"
+#include "LogicGate.hpp"
+
+namespace pdal
+{
+
+// An expression compiled for evaluation a block of points at a time.  The
+// nodes of the expression tree are stored in a flat list and operate on
+// registers holding the values of each dimension referenced, which are
+// loaded from the points at most once per block.  Constant subexpressions
+// are folded as the program is built.  The children of AND and OR nodes
+// are reordered after each block so that those most likely to decide the
+// result, judging by the points seen so far, are evaluated first.
+class Program
+{
+public:
+    using GetValues = std::function<void(Dimension::Id, double *)>;
+
+    Program()
+    {}
+
+    // Building.  Each function returns the index of the node it creates,
+    // which may be an existing node if the result was folded.
+    std::size_t constant(bool value);
+    std::size_t compare(ComparisonType type, Dimension::Id id,
+        const Operand& op);
+    std::size_t gate(LogicalOperator type,
+        const std::vector<std::size_t>& children);
+    void setRoot(std::size_t node)
+        { m_root = node; }
+
+    // Test a block of points.  getValues is called as getValues(id, values)
+    // to fetch the values of dimension id for the points of the block.
+    // Points that fail are set to 0 in passes.  Points that are 0 stay 0.
+    void test(const GetValues& getValues, point_count_t count, char *passes);
+
+private:
+    enum class Opcode
+    {
+        True,
+        False,
+        Compare,
+        Not,
+        And,
+        Or
+    };
+
+    struct Node
+    {
+        Node(Opcode op) : m_op(op)
+        {}
+
+        Opcode m_op;
+        // Comparison nodes.
+        ComparisonType m_type = ComparisonType::eq;
+        std::size_t m_lhs = 0;
+        std::size_t m_rhs = 0;
+        bool m_rhsConstant = true;
+        double m_value = 0;
+        // Gates.
+        std::vector<std::size_t> m_children;
+        // Number of points for which the node was evaluated and passed.
+        uint64_t m_tested = 0;
+        uint64_t m_passed = 0;
+    };
+
+    std::size_t push(Node node);
+    std::size_t negate(std::size_t node);
+    std::size_t reg(Dimension::Id id);
+    const double *values(std::size_t reg);
+    char *scratch(std::size_t depth);
+    void eval(std::size_t node, std::size_t depth, char *out);
+    void evalCompare(const Node& node, char *out);
+    void evalGate(Node& node, std::size_t depth, char *out);
+    void record(std::size_t node, const char *out);
+    void reorder(Node& node);
+
+    std::vector<Node> m_nodes;
+    std::size_t m_root = 0;
+
+    std::vector<Dimension::Id> m_regIds;
+    std::vector<std::vector<double>> m_regs;
+    std::vector<char> m_loaded;
+    std::vector<std::vector<char>> m_scratch;
+    std::vector<char> m_result;
+
+    // State of the block being tested.
+    const GetValues *m_getValues = nullptr;
+    point_count_t m_count = 0;
+};
+
+} // namespace pdal
+
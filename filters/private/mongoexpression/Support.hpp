@@ -44,6 +44,8 @@
 namespace pdal
 {
 
+class Program;
+
 class Loggable
 {
 public:
@@ -56,6 +58,9 @@ class Filterable : public Loggable
 {
 public:
     virtual bool operator()(const PointRef& pr) const = 0;
+
+    // Add the node to a compiled program, returning its index.
+    virtual std::size_t compile(Program& program) const = 0;
 };
 
 class Comparable : public Loggable
@@ -34,110 +34,50 @@
 
 #include "BpfCompressor.hpp"
 
+#ifdef PDAL_HAVE_ZLIB
+#include <zlib.h>
+#endif // PDAL_HAVE_ZLIB
+
 namespace pdal
 {
 
 #ifdef PDAL_HAVE_ZLIB
-void BpfCompressor::startBlock()
+void BpfCompressor::compress(const char *buf, size_t size,
+    std::vector<char>& out)
 {
-    // Initialize the stream.
-    m_strm.zalloc = Z_NULL;
-    m_strm.zfree = Z_NULL;
-    m_strm.opaque = Z_NULL;
-    if (deflateInit(&m_strm, Z_DEFAULT_COMPRESSION) != Z_OK)
-        throw error("Could not initialize BPF compressor.");
-
-    m_rawSize = 0;
-    m_compressedSize = 0;
-    uint32_t rawSize = 0;
-    uint32_t compressedSize = 0;
-
-    // Initiailize the streambuf with the backing buffer.
-    m_charbuf.initialize(m_inbuf.data(), m_inbuf.size());
-
-    // Note our position so that we can rewind here.
-    m_blockStart.mark();
-    m_out << rawSize << compressedSize;
-
-    // Make a new stream from our charbuf and push it so that future writes
-    // to our stream go to the backing vector.
-    m_out.pushStream(new std::ostream(&m_charbuf));
+    uLongf outSize = compressBound((uLong)size);
+    out.resize(outSize);
+    if (compress2((Bytef *)out.data(), &outSize, (const Bytef *)buf,
+            (uLong)size, Z_DEFAULT_COMPRESSION) != Z_OK)
+        throw error("Couldn't compress BPF data block.");
+    out.resize(outSize);
 }
 
 
-void BpfCompressor::compress()
+void BpfCompressor::decompress(const char *buf, size_t insize, char *out,
+    size_t outsize)
 {
-    // Note our position so that we know how much we've written.
-    uint32_t rawWritten = (uint32_t)m_out.position();
-
-    // Pop our temp stream so that we can write the real output file.
-    m_out.popStream();
-
-    m_rawSize += rawWritten;
-
-    // Deflate the data in the buffer and write it to the output stream.
-    m_strm.avail_in = rawWritten;
-    m_strm.next_in = (unsigned char *)m_inbuf.data();
-    m_strm.avail_out = CHUNKSIZE;
-    m_strm.next_out = m_tmpbuf;
-    while (m_strm.avail_in)
-    {
-        int ret = ::deflate(&m_strm, Z_NO_FLUSH);
-        size_t written = CHUNKSIZE - m_strm.avail_out;
-        m_compressedSize += written;
-        m_out.put(m_tmpbuf, written);
-        m_strm.avail_out = CHUNKSIZE;
-        m_strm.next_out = m_tmpbuf;
-    }
-
-    // All data has been written.  Reinitialize input buffer's streambuf and
-    // push it.
-    m_charbuf.initialize(m_inbuf.data(), m_inbuf.size());
-    m_out.pushStream(new std::ostream(&m_charbuf));
+    uLongf size = (uLongf)outsize;
+    if (uncompress((Bytef *)out, &size, (const Bytef *)buf,
+            (uLong)insize) != Z_OK || size != outsize)
+        throw error("Couldn't decompress BPF data block.");
 }
 
+#else
 
-void BpfCompressor::finish()
+void BpfCompressor::compress(const char *, size_t, std::vector<char>&)
 {
-    // Pop our special stream so that we can write the the file.
-    m_out.popStream();
-
-    // Deflate and write the result to the output file.
-    int ret = Z_OK;
-    while (ret == Z_OK)
-    {
-        ret = ::deflate(&m_strm, Z_FINISH);
-        size_t written = CHUNKSIZE - m_strm.avail_out;
-        m_compressedSize += written;
-        m_out.put(m_tmpbuf, written);
-        m_strm.avail_out = CHUNKSIZE;
-        m_strm.next_out = m_tmpbuf;
-    }
-    if (ret != Z_STREAM_END)
-        throw error("Couldn't close BPF compression stream.");
-    deflateEnd(&m_strm);
-
-    // Mark our position so that we can get back here.
-    OStreamMarker blockEnd(m_out);
-
-    // Rewind to the start of the block and write the size bytes.
-    m_blockStart.rewind();
-    m_out << (uint32_t)m_rawSize << (uint32_t)m_compressedSize;
-
-    // Set the position back to the end of the block.
-    blockEnd.rewind();
+    throw error("Can't compress BPF data. PDAL wasn't built with "
+        "Zlib support.");
 }
 
-#else
 
-void BpfCompressor::startBlock()
-{}
-void BpfCompressor::compress()
-{}
-void BpfCompressor::finish()
-{}
+void BpfCompressor::decompress(const char *, size_t, char *, size_t)
+{
+    throw error("Can't decompress BPF data. PDAL wasn't built with "
+        "Zlib support.");
+}
 
 #endif // PDAL_HAVE_ZLIB
 
 } // namespace pdal
-
@@ -35,19 +35,17 @@
 #pragma once
 
 #include <stdexcept>
-#include <ostream>
+#include <string>
+#include <vector>
 
 #include <pdal/pdal_features.hpp>
-#include <pdal/util/Charbuf.hpp>
-#include <pdal/util/OStream.hpp>
-
-#ifdef PDAL_HAVE_ZLIB
-#include <zlib.h>
-#endif // PDAL_HAVE_ZLIB
 
 namespace pdal
 {
 
+// Zlib codec for the blocks of compressed BPF point data.  Each block is a
+// complete zlib stream, so blocks can be compressed and decompressed
+// independently of one another.
 class BpfCompressor
 {
 public:
@@ -57,34 +55,13 @@ public:
         {}
     };
 
-#ifdef PDAL_HAVE_ZLIB
-    BpfCompressor(OLeStream& out, size_t maxSize) :
-        m_out(out), m_inbuf(maxSize), m_blockStart(out), m_rawSize(0),
-        m_compressedSize(0)
-    {}
-#else
-    BpfCompressor(OLeStream&, size_t)
-    {}
-#endif // PDAL_HAVE_ZLIB
-
-    void startBlock();
-    void finish();
-    void compress();
+    // Compress 'size' bytes of 'buf', replacing the contents of 'out'.
+    static void compress(const char *buf, size_t size, std::vector<char>& out);
 
-private:
-    static const int CHUNKSIZE = 1000000;
-
-#ifdef PDAL_HAVE_ZLIB
-    OLeStream& m_out;
-    Charbuf m_charbuf;
-    std::vector<char> m_inbuf;
-    z_stream m_strm;
-    unsigned char m_tmpbuf[CHUNKSIZE];
-    OStreamMarker m_blockStart;
-    size_t m_rawSize;
-    size_t m_compressedSize;
-#endif // PDAL_HAVE_ZLIB
+    // Decompress 'insize' bytes of 'buf' into exactly 'outsize' bytes
+    // at 'out'.
+    static void decompress(const char *buf, size_t insize, char *out,
+        size_t outsize);
 };
 
 } // namespace pdal
-
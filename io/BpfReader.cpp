@@ -35,13 +35,14 @@
 #include "BpfReader.hpp"
 
 #include <climits>
+#include <thread>
 
 #include <pdal/Options.hpp>
 #include <pdal/pdal_features.hpp>
+#include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
-#ifdef PDAL_HAVE_ZLIB
-#include <zlib.h>
-#endif
+#include "BpfCompressor.hpp"
 
 namespace pdal
 {
@@ -92,6 +93,15 @@ QuickInfo BpfReader::inspect()
 }
 
 
+void BpfReader::addArgs(ProgramArgs& args)
+{
+    args.add("threads", "Number of threads used to decompress point data.  "
+        "The default is the number of cores.", m_threads);
+    args.add("read_ahead", "Size in MiB of the windows of the file read "
+        "ahead on a background thread.  0 reads as needed", m_readAhead);
+}
+
+
 // When the stage is intialized, the schema needs to be populated with the
 // dimensions in order to allow subsequent stages to be aware of or append to
 // the dimensions in the PointView.
@@ -271,26 +281,18 @@ bool BpfReader::readPolarData()
 
 void BpfReader::ready(PointTableRef)
 {
-    m_istreamPtr = Utils::openFile(m_filename);
+    m_istreamPtr = Utils::openFile(m_filename, true,
+        m_readAhead * 1024 * 1024);
     m_stream = ILeStream(m_istreamPtr);
     m_stream.seek(m_header.m_len);
     m_index = 0;
     m_start = m_stream.position();
-#ifdef PDAL_HAVE_ZLIB
     if (m_header.m_compression)
     {
-        m_deflateBuf.resize(numPoints() * m_dims.size() * sizeof(float));
-        size_t index = 0;
-        size_t bytesRead = 0;
-        do
-        {
-            bytesRead = readBlock(m_deflateBuf, index);
-            index += bytesRead;
-        } while (bytesRead > 0 && index < m_deflateBuf.size());
+        readCompressed();
         m_charbuf.initialize(m_deflateBuf.data(), m_deflateBuf.size(), m_start);
         m_stream.pushStream(new std::istream(&m_charbuf));
     }
-#endif // PDAL_HAVE_ZLIB
 }
 
 
@@ -303,11 +305,31 @@ void BpfReader::done(PointTableRef)
 }
 
 
+// Points are found by position in every layout, so any of them can be read
+// without reading those before it.  The count then limits the positions
+// read rather than the points returned.
+bool BpfReader::restrictSelection(const PointSelection& selection)
+{
+    m_selection = selection;
+    m_selection.m_limit = (std::min)(m_selection.m_limit, m_count);
+    m_count = (std::numeric_limits<point_count_t>::max)();
+    return true;
+}
+
+
 bool BpfReader::processOne(PointRef& point)
 {
-    if (eof() || m_index >= m_count)
+    m_index = m_selection.next(m_index);
+    if (eof() || m_index >= m_count || m_index >= m_selection.m_limit)
         return false;
 
+    readPoint(point);
+    return true;
+}
+
+
+void BpfReader::readPoint(PointRef& point)
+{
     switch (m_header.m_pointFormat)
     {
     case BpfFormat::PointMajor:
@@ -320,12 +342,14 @@ bool BpfReader::processOne(PointRef& point)
         readByteMajor(point);
         break;
     }
-    return true;
 }
 
 
 point_count_t BpfReader::read(PointViewPtr data, point_count_t count)
 {
+    if (!m_selection.all())
+        return readSelected(data, count);
+
     switch (m_header.m_pointFormat)
     {
     case BpfFormat::PointMajor:
@@ -339,6 +363,27 @@ point_count_t BpfReader::read(PointViewPtr data, point_count_t count)
 }
 
 
+// Read the points of a selection one at a time, seeking past the rest.
+point_count_t BpfReader::readSelected(PointViewPtr data, point_count_t count)
+{
+    point_count_t last = (std::min)(numPoints(), m_selection.m_limit);
+    if (m_index < last && count < last - m_index)
+        last = m_index + count;
+
+    point_count_t numRead = 0;
+    while ((m_index = m_selection.next(m_index)) < last)
+    {
+        const PointId idx = data->size();
+        PointRef point(data->point(idx));
+        readPoint(point);
+        if (m_cb)
+            m_cb(*data, idx);
+        numRead++;
+    }
+    return numRead;
+}
+
+
 bool BpfReader::eof()
 {
     return m_index >= numPoints();
@@ -379,16 +424,14 @@ point_count_t BpfReader::readPointMajor(PointViewPtr view, point_count_t count)
     PointId nextId = view->size();
     PointId idx = m_index;
     point_count_t numRead = 0;
+    std::vector<float> vals(m_dims.size());
     seekPointMajor(idx);
     while (numRead < count && idx < numPoints())
     {
+        m_stream.read(vals.data(), vals.size());
         for (size_t d = 0; d < m_dims.size(); ++d)
-        {
-            float f;
-
-            m_stream >> f;
-            view->setField(m_dims[d].m_id, nextId, f + m_dims[d].m_offset);
-        }
+            view->setField(m_dims[d].m_id, nextId,
+                vals[d] + m_dims[d].m_offset);
 
         // Transformation only applies to X, Y and Z
         double x = view->getFieldAs<double>(Dimension::Id::X, nextId);
@@ -421,7 +464,6 @@ void BpfReader::readDimMajor(PointRef& point)
             m_streams.emplace_back(new ILeStream());
             m_streams.back()->open(m_filename);
 
-#ifdef PDAL_HAVE_ZLIB
             if (m_header.m_compression)
             {
                 m_charbufs.emplace_back(new Charbuf());
@@ -431,11 +473,15 @@ void BpfReader::readDimMajor(PointRef& point)
                 m_streams.back()->pushStream(
                         new std::istream(m_charbufs.back().get()));
             }
-#endif // PDAL_HAVE_ZLIB
 
             m_streams.back()->seek(m_start + offset);
         }
     }
+    // Selected points don't follow one another.
+    if (!m_selection.all())
+        for (size_t dim = 0; dim < m_dims.size(); ++dim)
+            m_streams[dim]->seek(m_start + (std::streamoff)(sizeof(float) *
+                (dim * numPoints() + m_index)));
 
     double x(0), y(0), z(0);
     float f(0);
@@ -469,19 +515,19 @@ point_count_t BpfReader::readDimMajor(PointViewPtr data, point_count_t count)
     PointId idx(0);
     PointId startId = data->size();
     point_count_t numRead = 0;
+    // Values of a dimension follow one another, so they're read at once.
+    const point_count_t avail =
+        m_index < numPoints() ? numPoints() - m_index : 0;
+    std::vector<float> vals((std::min)(count, avail));
     for (size_t d = 0; d < m_dims.size(); ++d)
     {
         idx = m_index;
         PointId nextId = startId;
-        numRead = 0;
         seekDimMajor(d, idx);
-        for (; numRead < count && idx < numPoints(); idx++, numRead++, nextId++)
-        {
-            float f;
-
-            m_stream >> f;
-            data->setField(m_dims[d].m_id, nextId, f + m_dims[d].m_offset);
-        }
+        m_stream.read(vals.data(), vals.size());
+        for (numRead = 0; numRead < vals.size(); idx++, numRead++, nextId++)
+            data->setField(m_dims[d].m_id, nextId,
+                vals[numRead] + m_dims[d].m_offset);
     }
     m_index = idx;
 
@@ -632,52 +678,74 @@ void BpfReader::seekByteMajor(size_t dimIdx, size_t byteIdx, PointId ptIdx)
 }
 
 
-#ifdef PDAL_HAVE_ZLIB
-size_t BpfReader::readBlock(std::vector<char>& outBuf, size_t index)
+// Compressed point data is a sequence of blocks, each a separate zlib
+// stream preceded by its decompressed and compressed sizes.  The writer
+// emits a block per dimension for dimension- and byte-major data, so the
+// blocks are read serially and decompressed in parallel into their
+// places in the buffer.
+void BpfReader::readCompressed()
 {
-    uint32_t finalBytes;
-    uint32_t compressBytes;
+    struct Block
+    {
+        std::vector<char> m_data;
+        size_t m_pos;
+        size_t m_size;
+    };
 
-    m_stream >> finalBytes;
-    m_stream >> compressBytes;
+    m_deflateBuf.resize(numPoints() * m_dims.size() * sizeof(float));
 
-    std::vector<char> in(compressBytes);
+    std::vector<Block> blocks;
+    size_t pos = 0;
+    while (pos < m_deflateBuf.size())
+    {
+        uint32_t finalBytes;
+        uint32_t compressBytes;
 
-    // Fill the input bytes from the stream.
-    m_stream.get(in);
-    int ret = inflate(in.data(), compressBytes,
-        outBuf.data() + index, finalBytes);
-    return (ret ? 0 : finalBytes);
-}
+        m_stream >> finalBytes >> compressBytes;
+        if (!m_stream || finalBytes == 0 ||
+                finalBytes > m_deflateBuf.size() - pos)
+            throwError("Invalid compressed block in BPF file.");
 
+        Block block;
+        block.m_data.resize(compressBytes);
+        m_stream.get(block.m_data);
+        if (!m_stream)
+            throwError("Unexpected end of file reading compressed BPF data.");
+        block.m_pos = pos;
+        block.m_size = finalBytes;
+        blocks.push_back(std::move(block));
+        pos += finalBytes;
+    }
 
-int BpfReader::inflate(char *buf, uint32_t insize,
-    char *outbuf, uint32_t outsize)
-{
-   if (insize == 0)
-        return 0;
-
-    int ret;
-    z_stream strm;
-
-    /* allocate inflate state */
-    strm.zalloc = Z_NULL;
-    strm.zfree = Z_NULL;
-    strm.opaque = Z_NULL;
-    strm.avail_in = 0;
-    strm.next_in = Z_NULL;
-    if (inflateInit(&strm) != Z_OK)
-        return -2;
-
-    strm.avail_in = insize;
-    strm.next_in = (unsigned char *)buf;
-    strm.avail_out = outsize;
-    strm.next_out = (unsigned char *)outbuf;
-
-    ret = ::inflate(&strm, Z_NO_FLUSH);
-    (void)inflateEnd(&strm);
-    return ret == Z_STREAM_END ? 0 : -1;
+    const size_t threads = (std::min)(blocks.size(), m_threads ? m_threads :
+        (size_t)(std::max)(std::thread::hardware_concurrency(), 1U));
+    try
+    {
+        if (threads <= 1)
+        {
+            for (Block& b : blocks)
+                BpfCompressor::decompress(b.m_data.data(), b.m_data.size(),
+                    m_deflateBuf.data() + b.m_pos, b.m_size);
+        }
+        else
+        {
+            ThreadPool pool(threads, blocks.size(), false);
+            for (Block& b : blocks)
+                pool.add([this, &b]()
+                {
+                    BpfCompressor::decompress(b.m_data.data(),
+                        b.m_data.size(), m_deflateBuf.data() + b.m_pos,
+                        b.m_size);
+                });
+            pool.join();
+            if (pool.errors().size())
+                throw BpfCompressor::error(pool.errors().front());
+        }
+    }
+    catch (const BpfCompressor::error& err)
+    {
+        throwError(err.what());
+    }
 }
-#endif // PDAL_HAVE_ZLIB
 
 } //namespace pdal
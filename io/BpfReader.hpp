@@ -77,15 +77,25 @@ private:
     std::vector<char> m_deflateBuf;
     /// Streambuf for deflated data.
     Charbuf m_charbuf;
+    /// Number of threads used to decompress data.
+    size_t m_threads;
+    /// Size in MiB of the windows of the file read ahead.
+    size_t m_readAhead;
+    /// Positions of the points to read.
+    PointSelection m_selection;
 
     // For dimension-major point-at-a-time usage.
     std::vector<std::unique_ptr<ILeStream>> m_streams;
     std::vector<std::unique_ptr<Charbuf>> m_charbufs;
 
     virtual QuickInfo inspect();
+    virtual void addArgs(ProgramArgs& args);
     virtual void initialize();
     virtual void addDimensions(PointLayoutPtr Layout);
+    virtual bool dimensionsUsed(PointLayoutPtr, Dimension::IdList&) const
+        { return true; }
     virtual void ready(PointTableRef table);
+    virtual bool restrictSelection(const PointSelection& selection);
     virtual bool processOne(PointRef& point);
     virtual point_count_t read(PointViewPtr data, point_count_t num);
     virtual void done(PointTableRef table);
@@ -94,15 +104,16 @@ private:
     bool readUlemFiles();
     bool readHeaderExtraData();
     bool readPolarData();
+    void readPoint(PointRef& point);
+    point_count_t readSelected(PointViewPtr data, point_count_t count);
     void readPointMajor(PointRef& point);
     point_count_t readPointMajor(PointViewPtr data, point_count_t count);
     void readDimMajor(PointRef& point);
     point_count_t readDimMajor(PointViewPtr data, point_count_t count);
     void readByteMajor(PointRef& point);
     point_count_t readByteMajor(PointViewPtr data, point_count_t count);
-    size_t readBlock(std::vector<char>& outBuf, size_t index);
+    void readCompressed();
     bool eof();
-    int inflate(char *inbuf, uint32_t insize, char *outbuf, uint32_t outsize);
 
     void seekPointMajor(PointId ptIdx);
     void seekDimMajor(size_t dimIdx, PointId ptIdx);
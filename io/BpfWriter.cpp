@@ -35,10 +35,15 @@
 #include "BpfWriter.hpp"
 
 #include <climits>
+#include <cstring>
+#include <functional>
+#include <thread>
 
 #include <pdal/Options.hpp>
 #include <pdal/util/FileUtils.hpp>
+#include <pdal/util/Inserter.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 #include "BpfCompressor.hpp"
 #include <pdal/util/Utils.hpp>
@@ -92,6 +97,8 @@ void BpfWriter::addArgs(ProgramArgs& args)
     args.add("bundledfile", "List of files to bundle in output",
         m_bundledFilesSpec);
     args.add("output_dims", "Output dimensions", m_outputDims);
+    args.add("threads", "Number of threads used to compress point data.  "
+        "The default is the number of cores.", m_threads);
     m_scaling.addArgs(args);
 }
 
@@ -150,7 +157,7 @@ void BpfWriter::readyFile(const std::string& filename,
     const SpatialReference& srs)
 {
     m_curFilename = filename;
-    m_stream.open(filename);
+    m_stream.open(filename, true);
     m_header.m_version = 3;
     m_header.m_numDim = m_dims.size();
     m_header.m_numPts = 0;
@@ -243,7 +250,9 @@ void BpfWriter::writeView(const PointViewPtr dataShared)
 
     try
     {
-        switch (m_header.m_pointFormat)
+        if (m_header.m_compression)
+            writeCompressed(data);
+        else switch (m_header.m_pointFormat)
         {
             case BpfFormat::PointMajor:
                 writePointMajor(data);
@@ -270,58 +279,23 @@ void BpfWriter::writeView(const PointViewPtr dataShared)
 
 void BpfWriter::writePointMajor(const PointView* data)
 {
-    // Blocks of 10,000 points will ensure that we're under 16MB, even
-    // for 255 dimensions.
-    size_t blockpoints = std::min<point_count_t>(10000UL, data->size());
-
-    // For compression we're going to write to a buffer so that it can be
-    // compressed before it's written to the file stream.
-    BpfCompressor compressor(m_stream,
-        blockpoints * sizeof(float) * m_dims.size());
-    PointId idx = 0;
-    while (idx < data->size())
-    {
-        if (m_header.m_compression)
-            compressor.startBlock();
-        size_t blockId;
-        for (blockId = 0; idx < data->size() && blockId < blockpoints;
-            ++idx, ++blockId)
-        {
-            for (auto & bpfDim : m_dims)
-            {
-                double d = getAdjustedValue(data, bpfDim, idx);
-                m_stream << (float)d;
-            }
-        }
-        if (m_header.m_compression)
+    for (PointId idx = 0; idx < data->size(); ++idx)
+        for (auto & bpfDim : m_dims)
         {
-            compressor.compress();
-            compressor.finish();
+            double d = getAdjustedValue(data, bpfDim, idx);
+            m_stream << (float)d;
         }
-    }
 }
 
 
 void BpfWriter::writeDimMajor(const PointView* data)
 {
-    // We're going to pretend for now that we only ever have one point buffer.
-    BpfCompressor compressor(m_stream, data->size() * sizeof(float));
-
     for (auto & bpfDim : m_dims)
-    {
-        if (m_header.m_compression)
-            compressor.startBlock();
         for (PointId idx = 0; idx < data->size(); ++idx)
         {
             double d = getAdjustedValue(data, bpfDim, idx);
             m_stream << (float)d;
         }
-        if (m_header.m_compression)
-        {
-            compressor.compress();
-            compressor.finish();
-        }
-    }
 }
 
 
@@ -333,12 +307,6 @@ void BpfWriter::writeByteMajor(const PointView* data)
         uint32_t u32;
     } uu;
 
-    // We're going to pretend for now that we only ever have one point buffer.
-    BpfCompressor compressor(m_stream,
-        data->size() * sizeof(float) * m_dims.size());
-
-    if (m_header.m_compression)
-        compressor.startBlock();
     for (auto & bpfDim : m_dims)
     {
         for (size_t b = 0; b < sizeof(float); b++)
@@ -351,10 +319,112 @@ void BpfWriter::writeByteMajor(const PointView* data)
             }
         }
     }
-    if (m_header.m_compression)
+}
+
+
+// Compressed point data is written as a sequence of blocks, each a separate
+// zlib stream preceded by its raw and compressed sizes.  Dimension- and
+// byte-major data get a block per dimension and point-major data a block
+// per 10,000 points.  Blocks are filled and compressed in parallel and
+// written in order.
+void BpfWriter::writeCompressed(const PointView* data)
+{
+    struct Block
+    {
+        std::vector<char> m_raw;
+        std::vector<char> m_compressed;
+        uint32_t m_rawSize;
+    };
+
+    const size_t numDims = m_dims.size();
+    std::vector<Block> blocks;
+    std::function<void(size_t)> fill;
+
+    switch (m_header.m_pointFormat)
+    {
+    case BpfFormat::PointMajor:
+    {
+        // Each point touches every dimension's bounds, so point-major
+        // blocks are filled up front and only compressed in parallel.
+        const point_count_t blockpoints = 10000;
+        blocks.resize((data->size() + blockpoints - 1) / blockpoints);
+        PointId idx = 0;
+        for (Block& block : blocks)
+        {
+            point_count_t count =
+                (std::min)(blockpoints, data->size() - idx);
+            block.m_raw.resize(count * numDims * sizeof(float));
+            LeInserter out(block.m_raw.data(), block.m_raw.size());
+            for (PointId end = idx + count; idx < end; ++idx)
+                for (auto & bpfDim : m_dims)
+                    out << (float)getAdjustedValue(data, bpfDim, idx);
+        }
+        fill = [](size_t){};
+        break;
+    }
+    case BpfFormat::DimMajor:
+        blocks.resize(numDims);
+        fill = [this, data, &blocks](size_t d)
+        {
+            std::vector<char>& raw = blocks[d].m_raw;
+            raw.resize(data->size() * sizeof(float));
+            LeInserter out(raw.data(), raw.size());
+            for (PointId idx = 0; idx < data->size(); ++idx)
+                out << (float)getAdjustedValue(data, m_dims[d], idx);
+        };
+        break;
+    case BpfFormat::ByteMajor:
+        blocks.resize(numDims);
+        fill = [this, data, &blocks](size_t d)
+        {
+            const point_count_t count = data->size();
+            std::vector<char>& raw = blocks[d].m_raw;
+            raw.resize(count * sizeof(float));
+            for (PointId idx = 0; idx < count; ++idx)
+            {
+                float f = (float)getAdjustedValue(data, m_dims[d], idx);
+                uint32_t u32;
+                std::memcpy(&u32, &f, sizeof(u32));
+                for (size_t b = 0; b < sizeof(float); ++b)
+                    raw[b * count + idx] =
+                        (char)(uint8_t)(u32 >> (b * CHAR_BIT));
+            }
+        };
+        break;
+    }
+
+    // Each task only touches the bounds of its own dimension.
+    auto process = [&blocks, &fill](size_t i)
+    {
+        Block& block = blocks[i];
+        fill(i);
+        block.m_rawSize = (uint32_t)block.m_raw.size();
+        BpfCompressor::compress(block.m_raw.data(), block.m_raw.size(),
+            block.m_compressed);
+        std::vector<char>().swap(block.m_raw);
+    };
+
+    const size_t threads = (std::min)(blocks.size(), m_threads ? m_threads :
+        (size_t)(std::max)(std::thread::hardware_concurrency(), 1U));
+    if (threads <= 1)
+    {
+        for (size_t i = 0; i < blocks.size(); ++i)
+            process(i);
+    }
+    else
+    {
+        ThreadPool pool(threads, blocks.size(), false);
+        for (size_t i = 0; i < blocks.size(); ++i)
+            pool.add([&process, i](){ process(i); });
+        pool.join();
+        if (pool.errors().size())
+            throw BpfCompressor::error(pool.errors().front());
+    }
+
+    for (const Block& block : blocks)
     {
-        compressor.compress();
-        compressor.finish();
+        m_stream << block.m_rawSize << (uint32_t)block.m_compressed.size();
+        m_stream.put(block.m_compressed.data(), block.m_compressed.size());
     }
 }
 
@@ -74,6 +74,7 @@ private:
     std::string m_extraDataSpec;
     StringList m_bundledFilesSpec;
     std::string m_curFilename;
+    size_t m_threads;
 
     virtual void addArgs(ProgramArgs& args);
     virtual void initialize();
@@ -90,7 +91,7 @@ private:
     void writePointMajor(const PointView* data);
     void writeDimMajor(const PointView* data);
     void writeByteMajor(const PointView* data);
-    void writeCompressedBlock(char *buf, size_t size);
+    void writeCompressed(const PointView* data);
 };
 
 } // namespace pdal
@@ -0,0 +1,416 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "CopcReader.hpp"
+
+#include <algorithm>
+#include <array>
+#include <tuple>
+
+#include <arbiter/arbiter.hpp>
+
+#include <pdal/compression/LazPerfVlrCompression.hpp>
+#include <pdal/util/Algorithm.hpp>
+#include <pdal/util/Extractor.hpp>
+
+namespace pdal
+{
+
+static StaticPluginInfo const s_info
+{
+    "readers.copc",
+    "COPC (cloud-optimized point cloud) reader.  Reads the parts of \n" \
+        "an octree-organized LAZ file that overlap a query.",
+    "http://pdal.io/stages/readers.copc.html"
+};
+
+CREATE_STATIC_STAGE(CopcReader, s_info)
+
+std::string CopcReader::getName() const { return s_info.name; }
+
+namespace
+{
+
+// Reads a remote file with HTTP range requests.  Data is fetched a block
+// at a time, except that large reads are fetched whole.
+class RangeStreambuf : public std::streambuf
+{
+public:
+    RangeStreambuf(const std::string& path) : m_path(path), m_pos(0)
+    {
+        m_size = (std::streamoff)m_arbiter.getSize(m_path);
+        setg(m_buf.data(), m_buf.data(), m_buf.data());
+    }
+
+protected:
+    virtual int_type underflow()
+    {
+        std::streamoff pos = tell();
+        if (pos >= m_size)
+            return traits_type::eof();
+
+        const std::streamoff len =
+            (std::min)((std::streamoff)BlockSize, m_size - pos);
+        fetch(pos, len, m_buf.data());
+        m_pos = pos;
+        setg(m_buf.data(), m_buf.data(), m_buf.data() + len);
+        return traits_type::to_int_type(*gptr());
+    }
+
+    virtual std::streamsize xsgetn(char *s, std::streamsize count)
+    {
+        std::streamsize avail = egptr() - gptr();
+        std::streamsize n = (std::min)(avail, count);
+        std::copy(gptr(), gptr() + n, s);
+        gbump((int)n);
+        if (n == count || count - n <= BlockSize)
+            return n + std::streambuf::xsgetn(s + n, count - n);
+
+        std::streamoff pos = tell();
+        std::streamsize len = (std::min)(count - n, m_size - pos);
+        if (len <= 0)
+            return n;
+        fetch(pos, len, s + n);
+        m_pos = pos + len;
+        setg(m_buf.data(), m_buf.data(), m_buf.data());
+        return n + len;
+    }
+
+    virtual pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+        std::ios_base::openmode which)
+    {
+        if (dir == std::ios_base::cur)
+            off += tell();
+        else if (dir == std::ios_base::end)
+            off += m_size;
+        return seekpos(off, which);
+    }
+
+    virtual pos_type seekpos(pos_type pos, std::ios_base::openmode)
+    {
+        std::streamoff off(pos);
+        if (off < 0 || off > m_size)
+            return pos_type(off_type(-1));
+
+        // Stay in the current block if the position is in it.
+        if (off >= m_pos && off < m_pos + (egptr() - eback()))
+            setg(eback(), eback() + (off - m_pos), egptr());
+        else
+        {
+            m_pos = off;
+            setg(m_buf.data(), m_buf.data(), m_buf.data());
+        }
+        return pos;
+    }
+
+private:
+    static const std::streamsize BlockSize = 256 * 1024;
+
+    std::streamoff tell() const
+        { return m_pos + (gptr() - eback()); }
+
+    void fetch(std::streamoff pos, std::streamsize len, char *dst)
+    {
+        arbiter::http::Headers headers;
+        headers["Range"] = "bytes=" + std::to_string(pos) + "-" +
+            std::to_string(pos + len - 1);
+        std::vector<char> data = m_arbiter.getBinary(m_path, headers);
+        if (data.size() != (size_t)len)
+            throw pdal_error("readers.copc: Unexpected response size "
+                "reading '" + m_path + "'.");
+        std::copy(data.begin(), data.end(), dst);
+    }
+
+    arbiter::Arbiter m_arbiter;
+    std::string m_path;
+    std::streamoff m_size;
+    std::streamoff m_pos;   // File position of the start of m_buf.
+    std::array<char, BlockSize> m_buf;
+};
+
+} // unnamed namespace
+
+class CopcReader::RangeStreamIf : public LasStreamIf
+{
+public:
+    RangeStreamIf(const std::string& filename) : m_buf(filename),
+        m_stream(&m_buf)
+    {
+        m_istream = &m_stream;
+    }
+
+    ~RangeStreamIf()
+    {
+        m_istream = nullptr;
+    }
+
+private:
+    RangeStreambuf m_buf;
+    std::istream m_stream;
+};
+
+
+// Octree node, as in an EPT key.
+struct CopcReader::Key
+{
+    int32_t d;
+    int32_t x;
+    int32_t y;
+    int32_t z;
+
+    Key child(int dir) const
+    {
+        return Key { d + 1, 2 * x + (dir & 1), 2 * y + ((dir >> 1) & 1),
+            2 * z + ((dir >> 2) & 1) };
+    }
+
+    bool operator<(const Key& other) const
+    {
+        return std::tie(d, x, y, z) <
+            std::tie(other.d, other.x, other.y, other.z);
+    }
+};
+
+
+// Hierarchy entry.  A point count of -1 locates a child hierarchy page
+// rather than points.
+struct CopcReader::Entry
+{
+    Key m_key;
+    uint64_t m_offset;
+    int32_t m_byteSize;
+    int32_t m_pointCount;
+};
+
+
+CopcReader::CopcReader() : m_resolution(0), m_depthEnd(0)
+{}
+
+
+void CopcReader::addArgs(ProgramArgs& args)
+{
+    LasReader::addArgs(args);
+    args.add("resolution", "Resolution limit", m_resolution);
+}
+
+
+void CopcReader::createStream()
+{
+    if (m_streamIf)
+        std::cerr << "Attempt to create stream twice!\n";
+
+    // Remote files that can be read in parts aren't downloaded.
+    arbiter::Arbiter a;
+    if (a.hasDriver(m_filename) && a.isHttpDerived(m_filename))
+    {
+        try
+        {
+            m_streamIf.reset(new RangeStreamIf(m_filename));
+        }
+        catch (arbiter::ArbiterError& err)
+        {
+            throwError("Unable to open '" + m_filename + "': " + err.what());
+        }
+    }
+    else
+        LasReader::createStream();
+}
+
+
+void CopcReader::initialize(PointTableRef table)
+{
+    // Hierarchy pages are read as they're needed rather than with the
+    // header.
+    if (!Utils::contains(m_ignoreVLROption, "copc/1000"))
+        m_ignoreVLROption.push_back("copc/1000");
+    initializeLocal(table, m_metadata);
+
+    const LasVLR *vlr = m_header.findVlr("copc", 1);
+    if (!vlr || vlr->dataLen() < 160)
+        throwError("'" + m_filename + "' isn't a COPC file.  It has no "
+            "COPC info VLR.");
+    if (!m_header.compressed())
+        throwError("'" + m_filename + "' isn't a COPC file.  It isn't "
+            "compressed.");
+
+    LeExtractor in(vlr->data(), vlr->dataLen());
+    in >> m_center[0] >> m_center[1] >> m_center[2] >> m_halfsize >>
+        m_spacing >> m_rootHierOffset >> m_rootHierSize;
+
+    auto& debug(log()->get(LogLevel::Debug));
+    m_depthEnd = 0;
+    if (m_resolution > 0)
+    {
+        // The root spacing is the resolution of the root node.  To select
+        // the resolution level, the depth end is one beyond it.
+        double currentResolution = m_spacing;
+        debug << "Root resolution: " << currentResolution << std::endl;
+
+        ++m_depthEnd;
+        while (currentResolution > m_resolution)
+        {
+            currentResolution /= 2;
+            ++m_depthEnd;
+        }
+
+        debug << "Query resolution:  " << m_resolution << "\n";
+        debug << "Actual resolution: " << currentResolution << "\n";
+        debug << "Depth end: " << m_depthEnd << std::endl;
+    }
+}
+
+
+BOX3D CopcReader::keyBounds(const Key& key) const
+{
+    const double side = 2 * m_halfsize / (double)(1 << key.d);
+    const double minx = m_center[0] - m_halfsize + key.x * side;
+    const double miny = m_center[1] - m_halfsize + key.y * side;
+    const double minz = m_center[2] - m_halfsize + key.z * side;
+    return BOX3D(minx, miny, minz, minx + side, miny + side, minz + side);
+}
+
+
+void CopcReader::readPage(std::istream& in, uint64_t offset, uint64_t size,
+    std::map<Key, Entry>& page) const
+{
+    std::vector<char> buf(size);
+    in.seekg(offset);
+    in.read(buf.data(), buf.size());
+    if (in.gcount() != (std::streamsize)buf.size())
+        throwError("Unexpected end of file reading the hierarchy of '" +
+            m_filename + "'.");
+
+    LeExtractor extractor(buf.data(), buf.size());
+    for (size_t i = 0; i < size / 32; ++i)
+    {
+        Entry e;
+        extractor >> e.m_key.d >> e.m_key.x >> e.m_key.y >> e.m_key.z >>
+            e.m_offset >> e.m_byteSize >> e.m_pointCount;
+        page[e.m_key] = e;
+    }
+}
+
+
+// Collect the nodes with points under 'key' that overlap the query,
+// reading the child hierarchy pages that do.
+void CopcReader::overlaps(std::istream& in, const std::map<Key, Entry>& page,
+    const Key& key, const BOX3D& bounds, std::vector<Entry>& nodes) const
+{
+    auto it = page.find(key);
+    if (it == page.end())
+        return;
+    if (bounds.valid() && !keyBounds(key).overlaps(bounds))
+        return;
+    if (m_depthEnd && key.d >= m_depthEnd)
+        return;
+
+    const Entry& entry = it->second;
+    if (entry.m_pointCount == -1)
+    {
+        std::map<Key, Entry> subPage;
+        readPage(in, entry.m_offset, (uint64_t)entry.m_byteSize, subPage);
+        overlaps(in, subPage, key, bounds, nodes);
+        return;
+    }
+
+    if (entry.m_pointCount > 0)
+        nodes.push_back(entry);
+    for (int dir = 0; dir < 8; ++dir)
+        overlaps(in, page, key.child(dir), bounds, nodes);
+}
+
+
+// Find the points of the nodes that overlap the query from the hierarchy.
+// Each node's points are a chunk, so the chunk table gives the index of the
+// first point of each node.
+bool CopcReader::selectPoints(const BOX3D& bounds, IntervalList& intervals)
+{
+    if (!bounds.valid() && !m_depthEnd)
+        return false;
+
+#ifdef PDAL_HAVE_LAZPERF
+    std::istream& in = *m_streamIf->m_istream;
+
+    std::map<Key, Entry> root;
+    readPage(in, m_rootHierOffset, m_rootHierSize, root);
+    std::vector<Entry> nodes;
+    overlaps(in, root, Key { 0, 0, 0, 0 }, bounds, nodes);
+
+    std::vector<uint32_t> counts;
+    std::vector<uint32_t> sizes = LazPerfVlrChunkDecompressor::readChunkTable(
+        in, m_header.pointOffset(), &counts);
+    in.clear();
+    if (sizes.empty())
+        throwError("Unable to read the chunk table of '" + m_filename + "'.");
+
+    std::map<uint64_t, point_count_t> firstPoints;
+    uint64_t offset = m_header.pointOffset() + sizeof(int64_t);
+    point_count_t first = 0;
+    for (size_t i = 0; i < sizes.size(); ++i)
+    {
+        firstPoints[offset] = first;
+        offset += sizes[i];
+        first += counts[i];
+    }
+
+    for (const Entry& node : nodes)
+    {
+        auto it = firstPoints.find(node.m_offset);
+        if (it == firstPoints.end())
+            throwError("Hierarchy of '" + m_filename + "' locates points "
+                "that don't start a chunk.");
+        intervals.emplace_back(it->second, it->second + node.m_pointCount);
+    }
+
+    // Merge the ranges of nodes whose chunks are adjacent.
+    std::sort(intervals.begin(), intervals.end());
+    IntervalList merged;
+    for (auto& i : intervals)
+        if (merged.size() && merged.back().second == i.first)
+            merged.back().second = i.second;
+        else
+            merged.push_back(i);
+    intervals.swap(merged);
+
+    log()->get(LogLevel::Debug) << "Overlap nodes: " << nodes.size() <<
+        std::endl;
+    return true;
+#else
+    throwError("Can't select the points of '" + m_filename + "' to read.  "
+        "PDAL not built with LAZperf.");
+    return false;
+#endif
+}
+
+} // namespace pdal
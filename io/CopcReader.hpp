@@ -0,0 +1,85 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "LasReader.hpp"
+
+namespace pdal
+{
+
+// Reads LAZ files in the cloud-optimized point cloud (COPC) layout.  The
+// points are LAZ chunks, one for each node of an octree.  Only the
+// hierarchy pages and chunks of the nodes that overlap the query bounds
+// and resolution are read.  Remote files are read with HTTP range
+// requests.
+class PDAL_DLL CopcReader : public LasReader
+{
+    class RangeStreamIf;
+
+public:
+    CopcReader();
+
+    std::string getName() const;
+
+protected:
+    virtual void createStream();
+
+private:
+    struct Key;
+    struct Entry;
+
+    double m_resolution;
+    double m_center[3];
+    double m_halfsize;
+    double m_spacing;
+    uint64_t m_rootHierOffset;
+    uint64_t m_rootHierSize;
+    int32_t m_depthEnd; // Zero selects all depths.
+
+    virtual void addArgs(ProgramArgs& args);
+    virtual void initialize(PointTableRef table);
+    virtual bool selectPoints(const BOX3D& bounds, IntervalList& intervals);
+
+    BOX3D keyBounds(const Key& key) const;
+    void readPage(std::istream& in, uint64_t offset, uint64_t size,
+        std::map<Key, Entry>& page) const;
+    void overlaps(std::istream& in, const std::map<Key, Entry>& page,
+        const Key& key, const BOX3D& bounds, std::vector<Entry>& nodes) const;
+};
+
+} // namespace pdal
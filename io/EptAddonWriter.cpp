@@ -54,6 +54,9 @@ namespace
         "http://pdal.io/stages/writers.ept.html",
         { "ept_addon", "ept-addon" }
     };
+
+    // Number of points whose addon values are gathered at a time.
+    const point_count_t BlockSize(65536);
 }
 
 CREATE_STATIC_STAGE(EptAddonWriter, s_info)
@@ -92,7 +95,7 @@ void EptAddonWriter::prepared(PointTableRef table)
         log()->get(LogLevel::Warning) << "Using a large thread count: " <<
             threads << " threads" << std::endl;
     }
-    m_pool.reset(new Pool(threads));
+    m_pool.reset(new ThreadPool(threads));
 
     const PointLayout& layout(*table.layout());
     for (const std::string path : m_addonsArg->getMemberNames())
@@ -164,26 +167,49 @@ void EptAddonWriter::writeOne(const PointViewPtr view, const Addon& addon) const
         buffers.emplace_back(p.second * addon.size(), 0);
     }
 
-    // Fill in our buffers with the data from the view.
-    PointRef pr(*view);
-    uint64_t nodeId(0);
-    uint64_t pointId(0);
-    for (uint64_t i(0); i < view->size(); ++i)
+    // Fill in our buffers with the data from the view.  Each EPT point has
+    // its own place in its node's buffer, so blocks of points can be
+    // copied on separate threads.
+    const point_count_t count(view->size());
+    const std::size_t numBlocks((count + BlockSize - 1) / BlockSize);
+    auto makeWorker = [this, &view, &buffers, &addon, count]()
     {
-        pr.setPointId(i);
-        nodeId = pr.getFieldAs<uint64_t>(m_nodeIdDim);
-
-        // Node IDs are 1-based to distinguish points that do not come from the
-        // EPT reader.
-        if (!nodeId) continue;
-
-        nodeId -= 1;
-        pointId = pr.getFieldAs<uint64_t>(m_pointIdDim);
+        std::vector<double> nodeIds(BlockSize);
+        std::vector<double> pointIds(BlockSize);
+        return [this, &view, &buffers, &addon, count, nodeIds, pointIds]
+            (std::size_t block) mutable
+        {
+            const PointId begin(block * BlockSize);
+            const point_count_t n((std::min)(BlockSize, count - begin));
+            view->getFieldArray(m_nodeIdDim, begin, n, nodeIds.data());
+            view->getFieldArray(m_pointIdDim, begin, n, pointIds.data());
+
+            PointRef pr(*view);
+            for (point_count_t i(0); i < n; ++i)
+            {
+                // Node IDs are 1-based to distinguish points that do not
+                // come from the EPT reader.
+                const uint64_t nodeId((uint64_t)nodeIds[i]);
+                if (!nodeId) continue;
+
+                const uint64_t pointId((uint64_t)pointIds[i]);
+                auto& buffer(buffers.at(nodeId - 1));
+                assert(pointId * addon.size() + addon.size() <=
+                    buffer.size());
+                char* dst = buffer.data() + pointId * addon.size();
+                pr.setPointId(begin + i);
+                pr.getField(dst, addon.id(), addon.type());
+            }
+        };
+    };
 
-        auto& buffer(buffers.at(nodeId));
-        assert(pointId * addon.size() + addon.size() <= buffer.size());
-        char* dst = buffer.data() + pointId * addon.size();
-        pr.getField(dst, addon.id(), addon.type());
+    if (view->table().concurrentReads())
+        parallelFor(numBlocks, makeWorker, 1);
+    else
+    {
+        auto worker = makeWorker();
+        for (std::size_t block(0); block < numBlocks; ++block)
+            worker(block);
     }
 
     const arbiter::Endpoint& ep(addon.ep());
@@ -196,8 +222,10 @@ void EptAddonWriter::writeOne(const PointViewPtr view, const Addon& addon) const
         arbiter::fs::mkdirp(hierEp.root());
     }
 
-    // Write the binary dimension data for the addon.
-    nodeId = 0;
+    // Write the binary dimension data for the addon.  The hierarchy is
+    // written while the data is being uploaded, since neither depends on
+    // the other.
+    uint64_t nodeId(0);
     for (const auto& p : m_hierarchy)
     {
         const Key key(p.first);
@@ -210,8 +238,6 @@ void EptAddonWriter::writeOne(const PointViewPtr view, const Addon& addon) const
         ++nodeId;
     }
 
-    m_pool->await();
-
     // Write the addon hierarchy data.
     Json::Value h;
     Key key;
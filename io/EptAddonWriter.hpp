@@ -53,7 +53,7 @@ namespace arbiter
 class Addon;
 class EptInfo;
 class Key;
-class Pool;
+class ThreadPool;
 
 class PDAL_DLL EptAddonWriter : public Writer
 {
@@ -70,7 +70,7 @@ public:
 
 private:
     std::unique_ptr<arbiter::Arbiter> m_arbiter;
-    std::unique_ptr<Pool> m_pool;
+    std::unique_ptr<ThreadPool> m_pool;
 
     std::unique_ptr<Json::Value> m_addonsArg;
     std::vector<std::unique_ptr<Addon>> m_addons;
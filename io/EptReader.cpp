@@ -36,12 +36,19 @@
 
 #include <limits>
 
+#include "private/EptCache.hpp"
 #include "private/EptSupport.hpp"
 #include "LasReader.hpp"
 
 #include <arbiter/arbiter.hpp>
 
+#include <filters/StreamCallbackFilter.hpp>
 #include <pdal/util/Algorithm.hpp>
+#include <pdal/util/ReadAhead.hpp>
+#include <pdal/util/Trace.hpp>
+#ifdef PDAL_HAVE_ZSTD
+#include <pdal/compression/ZstdCompression.hpp>
+#endif
 
 namespace pdal
 {
@@ -79,6 +86,10 @@ void EptReader::addArgs(ProgramArgs& args)
     args.add("resolution", "Resolution limit", m_args.resolutionArg());
     args.add("addons", "Mapping of addon dimensions to their output directory",
             m_args.addonsArg());
+    args.add("cache", "Directory in which to cache fetched data",
+            m_args.cacheArg());
+    args.add("cache_size", "Maximum size of the cache in megabytes",
+            m_args.cacheSizeArg(), uint64_t(1024));
 }
 
 BOX3D EptReader::Args::bounds() const
@@ -131,9 +142,25 @@ void EptReader::initialize()
         log()->get(LogLevel::Warning) << "Using a large thread count: " <<
             threads << " threads" << std::endl;
     }
-    m_pool.reset(new Pool(threads));
+    m_pool.reset(new ThreadPool(threads));
 
     debug << "Endpoint: " << m_ep->prefixedRoot() << std::endl;
+
+    // Local data is read in place, so only remote data is cached.
+    m_cache.reset();
+    if (m_args.cache().size() && m_ep->isRemote())
+    {
+        try
+        {
+            m_cache.reset(new EptCache(m_args.cache(), m_ep->prefixedRoot(),
+                m_args.cacheSize() * 1024 * 1024));
+        }
+        catch (std::exception& e)
+        {
+            throwError(e.what());
+        }
+        debug << "Cache: " << m_args.cache() << std::endl;
+    }
     try
     {
         m_info.reset(new EptInfo(parse(m_ep->get("ept.json"))));
@@ -144,6 +171,11 @@ void EptReader::initialize()
     }
 
     debug << "Got EPT info" << std::endl;
+#ifndef PDAL_HAVE_ZSTD
+    if (m_info->dataType() == EptInfo::DataType::Zstandard)
+        throwError("Can't read EPT zstandard data.  PDAL not built "
+            "with Zstd.");
+#endif
     debug << "SRS: " << m_info->srs() << std::endl;
     setSpatialReference(m_info->srs());
 
@@ -387,6 +419,14 @@ void EptReader::ready(PointTableRef table)
     m_nodeIdDim = table.layout()->findDim("EptNodeId");
     m_pointIdDim = table.layout()->findDim("EptPointId");
 
+    m_layout = table.layout();
+    m_packedDims = m_layout->dimTypes();
+    m_packed.resize(m_layout->pointSize());
+    m_fetches.reset();
+    m_node = Node();
+    m_nodePoint = 0;
+    m_streamed = 0;
+
     m_overlaps.clear();
 
     // Determine all overlapping data files we'll need to fetch.
@@ -498,6 +538,19 @@ void EptReader::overlaps(const arbiter::Endpoint& ep,
 
 PointViewSet EptReader::run(PointViewPtr view)
 {
+    // Reserve the points of each node in the destination table so that the
+    // nodes can be decoded straight into it in parallel.
+    std::vector<PointViewPtr> nodeViews;
+    std::vector<std::vector<char>> keeps;
+    for (const auto& entry : m_overlaps)
+    {
+        PointViewPtr nodeView(view->makeNew());
+        for (PointId i(0); i < entry.second; ++i)
+            nodeView->getOrAddPoint(i);
+        nodeViews.push_back(nodeView);
+        keeps.emplace_back(entry.second, 0);
+    }
+
     // Start these at 1 to differentiate from points added by other stages,
     // which will be ignored by the EPT writer.
     uint64_t nodeId(1);
@@ -505,25 +558,18 @@ PointViewSet EptReader::run(PointViewPtr view)
     for (const auto& entry : m_overlaps)
     {
         const Key& key(entry.first);
+        PointView& nodeView(*nodeViews[nodeId - 1]);
+        std::vector<char>& keep(keeps[nodeId - 1]);
 
-        log()->get(LogLevel::Debug) << "Data " << nodeId << "/" <<
-            m_overlaps.size() << ": " << key.toString() << std::endl;
-
-        m_pool->add([this, &view, &key, nodeId]()
+        log()->get(LogLevel::Debug, [&](std::ostream& out)
         {
-            uint64_t startId(0);
-
-            if (m_info->dataType() == EptInfo::DataType::Laszip)
-                startId = readLaszip(*view, key, nodeId);
-            else
-                startId = readBinary(*view, key, nodeId);
+            out << "Data " << nodeId << "/" << m_overlaps.size() << ": " <<
+                key.toString() << std::endl;
+        });
 
-            // Read addon information after the native data, we'll possibly
-            // overwrite attributes.
-            for (const auto& addon : m_addons)
-            {
-                readAddon(*view, key, *addon, startId);
-            }
+        m_pool->add([this, &nodeView, &keep, &key, nodeId]()
+        {
+            readNode(nodeView, key, nodeId, keep);
         });
 
         ++nodeId;
@@ -531,6 +577,15 @@ PointViewSet EptReader::run(PointViewPtr view)
 
     m_pool->await();
 
+    // The points that are kept are added to the view in node order.  The
+    // point data isn't copied.
+    for (size_t i(0); i < nodeViews.size(); ++i)
+    {
+        for (PointId id(0); id < nodeViews[i]->size(); ++id)
+            if (keeps[i][id])
+                view->appendPoint(*nodeViews[i], id);
+    }
+
     log()->get(LogLevel::Debug) << "Done reading!" << std::endl;
 
     PointViewSet views;
@@ -538,71 +593,200 @@ PointViewSet EptReader::run(PointViewPtr view)
     return views;
 }
 
-uint64_t EptReader::readLaszip(PointView& dst, const Key& key,
-        const uint64_t nodeId) const
+// In stream mode, nodes are fetched and decoded on the pool, several at a
+// time, while the points of the nodes that have arrived are passed on in
+// node order.
+void EptReader::startFetches()
+{
+    m_fetches.reset(new ReadAhead<Node>(*m_pool, m_args.threads()));
+
+    uint64_t nodeId(1);
+    for (const auto& entry : m_overlaps)
+    {
+        const Key& key(entry.first);
+        const uint64_t np(entry.second);
+        m_fetches->add([this, &key, np, nodeId]()
+        {
+            Node node;
+            node.m_table.reset(new PointTable);
+            *node.m_table->layout() = *m_layout;
+            node.m_view.reset(new PointView(*node.m_table));
+            for (PointId i(0); i < np; ++i)
+                node.m_view->getOrAddPoint(i);
+            node.m_keep.resize(np);
+            readNode(*node.m_view, key, nodeId, node.m_keep);
+            return node;
+        });
+        ++nodeId;
+    }
+}
+
+bool EptReader::processOne(PointRef& point)
+{
+    if (!m_fetches)
+        startFetches();
+
+    while (m_streamed < m_count)
+    {
+        if (m_nodePoint < m_node.m_keep.size())
+        {
+            const PointId id(m_nodePoint++);
+            if (!m_node.m_keep[id])
+                continue;
+            m_node.m_view->getPackedPoint(m_packedDims, id, m_packed.data());
+            point.setPackedData(m_packedDims, m_packed.data());
+            ++m_streamed;
+            return true;
+        }
+        if (m_fetches->empty())
+            break;
+        m_node = Node();
+        try
+        {
+            m_node = m_fetches->next();
+        }
+        catch (std::exception& e)
+        {
+            throwError(e.what());
+        }
+        m_nodePoint = 0;
+    }
+    return false;
+}
+
+void EptReader::done(PointTableRef)
 {
+    m_fetches.reset();
+    m_node = Node();
+}
+
+void EptReader::readNode(PointView& view, const Key& key, uint64_t nodeId,
+        std::vector<char>& keep) const
+{
+    if (m_info->dataType() == EptInfo::DataType::Laszip)
+        readLaszip(view, key, nodeId, keep);
+    else
+        readBinary(view, key, nodeId, keep);
+
+    // Read addon information after the native data, we'll possibly
+    // overwrite attributes.
+    for (const auto& addon : m_addons)
+    {
+        readAddon(view, key, *addon);
+    }
+}
+
+void EptReader::readLaszip(PointView& dst, const Key& key,
+        const uint64_t nodeId, std::vector<char>& keep) const
+{
+    const std::string name("ept-data/" + key.toString() + ".laz");
+
     // If the file is remote (HTTP, S3, Dropbox, etc.), getLocalHandle will
     // download the file and `localPath` will return the location of the
     // downloaded file in a temporary directory.  Otherwise it's a no-op.
-    auto handle(m_ep->getLocalHandle("ept-data/" + key.toString() + ".laz"));
-
-    PointTable table;
+    // With a cache, the file is downloaded to the cache unless it's
+    // already there.
+    std::unique_ptr<arbiter::fs::LocalHandle> handle;
+    std::string filename;
+    {
+        Trace::Span span("io", "fetch " + key.toString());
+        if (m_cache)
+        {
+            filename = m_cache->find(name);
+            if (filename.empty())
+                filename = m_cache->insert(name, m_ep->getBinary(name));
+        }
+        else
+        {
+            handle = m_ep->getLocalHandle(name);
+            filename = handle->localPath();
+        }
+    }
 
     Options options;
-    options.add("filename", handle->localPath());
+    options.add("filename", filename);
     options.add("use_eb_vlr", true);
 
+    // Points are streamed from the reader a few at a time and stored in
+    // their reserved place in the destination.
     LasReader reader;
     reader.setOptions(options);
-
-    std::lock_guard<std::mutex> lock(m_mutex);
-    reader.prepare(table);
-
-    const uint64_t startId(dst.size());
+    reader.setMetadataPolicy(MetadataPolicy::Essential);
 
     uint64_t pointId(0);
-    for (auto& src : reader.execute(table))
+    StreamCallbackFilter f;
+    f.setInput(reader);
+    f.setCallback([this, &dst, &keep, &pointId, nodeId](PointRef& pr)
     {
-        PointRef pr(*src);
-        for (uint64_t i(0); i < src->size(); ++i)
-        {
-            pr.setPointId(i);
-            process(dst, pr, nodeId, pointId);
-            ++pointId;
-        }
-    }
+        if (pointId >= keep.size())
+            throwError("Invalid point count in node data");
+        keep[pointId] = process(dst, pr, nodeId, pointId);
+        ++pointId;
+        return true;
+    });
 
-    return startId;
+    FixedPointTable table(1000);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        f.prepare(table);
+    }
+    f.execute(table);
 }
 
-uint64_t EptReader::readBinary(PointView& dst, const Key& key,
-        const uint64_t nodeId) const
+void EptReader::readBinary(PointView& dst, const Key& key,
+        const uint64_t nodeId, std::vector<char>& keep) const
 {
-    auto data(m_ep->getBinary("ept-data/" + key.toString() + ".bin"));
+    std::vector<char> data;
+    if (m_info->dataType() == EptInfo::DataType::Zstandard)
+    {
+#ifdef PDAL_HAVE_ZSTD
+        const auto compressed(getBinary("ept-data/" + key.toString() +
+            ".zst"));
+        ZstdDecompressor decompressor([&data](char *buf, size_t size)
+            { data.insert(data.end(), buf, buf + size); });
+        decompressor.decompress(compressed.data(), compressed.size());
+        decompressor.done();
+#endif
+    }
+    else
+        data = getBinary("ept-data/" + key.toString() + ".bin");
+
     ShallowPointTable table(*m_remoteLayout, data.data(), data.size());
     PointRef pr(table);
 
-    std::lock_guard<std::mutex> lock(m_mutex);
-
-    const uint64_t startId(dst.size());
+    if (table.numPoints() != keep.size())
+        throwError("Invalid point count in node data");
 
-    uint64_t pointId(0);
     for (uint64_t pointId(0); pointId < table.numPoints(); ++pointId)
     {
         pr.setPointId(pointId);
-        process(dst, pr, nodeId, pointId);
+        keep[pointId] = process(dst, pr, nodeId, pointId);
+    }
+}
+
+std::vector<char> EptReader::getBinary(const std::string& name) const
+{
+    Trace::Span span("io", "fetch " + name);
+    if (!m_cache)
+        return m_ep->getBinary(name);
+
+    const std::string filename(m_cache->find(name));
+    if (filename.size())
+    {
+        const std::string data(FileUtils::readFileIntoString(filename));
+        return std::vector<char>(data.begin(), data.end());
     }
 
-    return startId;
+    std::vector<char> data(m_ep->getBinary(name));
+    m_cache->insert(name, data);
+    return data;
 }
 
-void EptReader::process(PointView& dst, PointRef& pr, const uint64_t nodeId,
+bool EptReader::process(PointView& dst, PointRef& pr, const uint64_t nodeId,
         const uint64_t pointId) const
 {
     using D = Dimension::Id;
 
-    const point_count_t dstId(dst.size());
-
     const double x = pr.getFieldAs<double>(D::X) *
         m_xyzTransforms[0].m_scale.m_val + m_xyzTransforms[0].m_offset.m_val;
     const double y = pr.getFieldAs<double>(D::Y) *
@@ -613,30 +797,32 @@ void EptReader::process(PointView& dst, PointRef& pr, const uint64_t nodeId,
     const bool selected = m_queryOriginId == -1 ||
         pr.getFieldAs<int64_t>(D::OriginId) == m_queryOriginId;
 
-    if (selected && m_queryBounds.contains(x, y, z))
-    {
-        dst.setField(Dimension::Id::X, dstId, x);
-        dst.setField(Dimension::Id::Y, dstId, y);
-        dst.setField(Dimension::Id::Z, dstId, z);
+    if (!selected || !m_queryBounds.contains(x, y, z))
+        return false;
+
+    const PointId dstId(pointId);
+    dst.setField(Dimension::Id::X, dstId, x);
+    dst.setField(Dimension::Id::Y, dstId, y);
+    dst.setField(Dimension::Id::Z, dstId, z);
 
-        for (const DimType& dt : m_dimTypes)
+    for (const DimType& dt : m_dimTypes)
+    {
+        if (dt.m_id != D::X && dt.m_id != D::Y && dt.m_id != D::Z)
         {
-            if (dt.m_id != D::X && dt.m_id != D::Y && dt.m_id != D::Z)
-            {
-                const double d = pr.getFieldAs<double>(dt.m_id) *
-                    dt.m_xform.m_scale.m_val + dt.m_xform.m_offset.m_val;
+            const double d = pr.getFieldAs<double>(dt.m_id) *
+                dt.m_xform.m_scale.m_val + dt.m_xform.m_offset.m_val;
 
-                dst.setField(dt.m_id, dstId, d);
-            }
+            dst.setField(dt.m_id, dstId, d);
         }
-
-        dst.setField(m_nodeIdDim, dstId, nodeId);
-        dst.setField(m_pointIdDim, dstId, pointId);
     }
+
+    dst.setField(m_nodeIdDim, dstId, nodeId);
+    dst.setField(m_pointIdDim, dstId, pointId);
+    return true;
 }
 
-void EptReader::readAddon(PointView& dst, const Key& key, const Addon& addon,
-        const uint64_t pointId) const
+void EptReader::readAddon(PointView& dst, const Key& key,
+        const Addon& addon) const
 {
     const uint64_t np(addon.points(key));
     if (!np)
@@ -650,7 +836,7 @@ void EptReader::readAddon(PointView& dst, const Key& key, const Addon& addon,
         // for an EPT-read of the full dataset.  If the native EPT set already
         // contains Classification, then we should overwrite it with zeroes
         // where the addon leaves off.
-        for (uint64_t id(pointId); id < pointId + np; ++id)
+        for (PointId id(0); id < dst.size(); ++id)
         {
             dst.setField(addon.id(), id, 0);
         }
@@ -671,7 +857,7 @@ void EptReader::readAddon(PointView& dst, const Key& key, const Addon& addon,
     }
 
     const char* pos(data.data());
-    for (uint64_t id(pointId); id < pointId + np; ++id)
+    for (PointId id(0); id < np; ++id)
     {
         dst.setField(addon.id(), addon.type(), id, pos);
         pos += dimSize;
@@ -40,6 +40,7 @@
 #include <memory>
 #include <mutex>
 #include <set>
+#include <vector>
 
 #include <pdal/Reader.hpp>
 #include <pdal/Streamable.hpp>
@@ -60,12 +61,15 @@ namespace arbiter
 }
 
 class Addon;
+class EptCache;
 class EptInfo;
 class FixedPointLayout;
 class Key;
-class Pool;
+class PointTable;
+class ThreadPool;
+template<typename T> class ReadAhead;
 
-class PDAL_DLL EptReader : public Reader
+class PDAL_DLL EptReader : public Reader, public Streamable
 {
 public:
     EptReader();
@@ -76,10 +80,33 @@ public:
     virtual void initialize() override;
     virtual QuickInfo inspect() override;
     virtual void addDimensions(PointLayoutPtr layout) override;
+    virtual bool dimensionsUsed(PointLayoutPtr,
+        Dimension::IdList&) const override
+        { return true; }
+    virtual void restrictBounds(const BOX3D& bounds) override
+        { m_queryBounds.clip(bounds); }
     virtual void ready(PointTableRef table) override;
     virtual PointViewSet run(PointViewPtr view) override;
 
 private:
+    // A node read on its own for stream mode.  Its points are decoded into
+    // a table of their own, which is freed once they've been passed on.
+    struct Node
+    {
+        std::unique_ptr<PointTable> m_table;
+        PointViewPtr m_view;
+        std::vector<char> m_keep;
+    };
+
+    virtual bool processOne(PointRef& point) override;
+    virtual void done(PointTableRef table) override;
+
+    // Read the points of a node, including its addons.
+    void readNode(PointView& view, const Key& key, uint64_t nodeId,
+            std::vector<char>& keep) const;
+    // Start fetching the nodes that will be streamed.
+    void startFetches();
+
     // If argument "origin" is specified, this function will clip the query
     // bounds to the bounds of the specified origin and set m_queryOriginId to
     // the selected OriginId value.  If the selected origin is not found, throw.
@@ -93,19 +120,24 @@ private:
             const arbiter::Endpoint& ep, std::map<Key, uint64_t>& target,
             const Json::Value& current, const Key& key);
 
-    uint64_t readLaszip(PointView& view, const Key& key, uint64_t nodeId) const;
-    uint64_t readBinary(PointView& view, const Key& key, uint64_t nodeId) const;
-    void process(PointView& view, PointRef& pr, uint64_t nodeId,
+    // Each node is read into its own view, which has a point reserved for
+    // every point of the node.  Points that are kept are flagged in 'keep'.
+    void readLaszip(PointView& view, const Key& key, uint64_t nodeId,
+            std::vector<char>& keep) const;
+    void readBinary(PointView& view, const Key& key, uint64_t nodeId,
+            std::vector<char>& keep) const;
+    std::vector<char> getBinary(const std::string& name) const;
+    bool process(PointView& view, PointRef& pr, uint64_t nodeId,
             uint64_t pointId) const;
 
-    void readAddon(PointView& dst, const Key& key, const Addon& addon,
-            uint64_t startId) const;
+    void readAddon(PointView& dst, const Key& key, const Addon& addon) const;
 
     std::string m_root;
 
     std::unique_ptr<arbiter::Arbiter> m_arbiter;
     std::unique_ptr<arbiter::Endpoint> m_ep;
     std::unique_ptr<EptInfo> m_info;
+    std::unique_ptr<EptCache> m_cache;
 
     class Args
     {
@@ -117,6 +149,8 @@ private:
         std::size_t& threadsArg() { return m_threads; }
         double& resolutionArg() { return m_resolution; }
         Json::Value& addonsArg() { return *m_addons; }
+        std::string& cacheArg() { return m_cache; }
+        uint64_t& cacheSizeArg() { return m_cacheSize; }
 
         BOX3D bounds() const;
         std::string origin() const { return m_origin; }
@@ -126,6 +160,8 @@ private:
         }
         double resolution() const { return m_resolution; }
         const Json::Value& addons() const { return *m_addons; }
+        std::string cache() const { return m_cache; }
+        uint64_t cacheSize() const { return m_cacheSize; }
 
     private:
         Bounds m_bounds;
@@ -133,12 +169,14 @@ private:
         std::size_t m_threads = 0;
         double m_resolution = 0;
         std::unique_ptr<Json::Value> m_addons;
+        std::string m_cache;
+        uint64_t m_cacheSize = 0;
     };
 
     Args m_args;
     BOX3D m_queryBounds;
     int64_t m_queryOriginId = -1;
-    std::unique_ptr<Pool> m_pool;
+    std::unique_ptr<ThreadPool> m_pool;
     std::vector<std::unique_ptr<Addon>> m_addons;
 
     mutable std::mutex m_mutex;
@@ -153,6 +191,15 @@ private:
 
     Dimension::Id m_nodeIdDim = Dimension::Id::Unknown;
     Dimension::Id m_pointIdDim = Dimension::Id::Unknown;
+
+    // Stream mode state.
+    PointLayoutPtr m_layout = nullptr;
+    DimTypeList m_packedDims;
+    std::vector<char> m_packed;
+    std::unique_ptr<ReadAhead<Node>> m_fetches;
+    Node m_node;
+    PointId m_nodePoint = 0;
+    point_count_t m_streamed = 0;
 };
 
 } // namespace pdal
@@ -0,0 +1,443 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "EptWriter.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <unordered_map>
+
+#include <json/json.h>
+
+#include <arbiter/arbiter.hpp>
+
+#include "private/EptSupport.hpp"
+#ifdef PDAL_HAVE_ZSTD
+#include <pdal/compression/ZstdCompression.hpp>
+#endif
+
+namespace pdal
+{
+
+namespace
+{
+    const StaticPluginInfo s_info
+    {
+        "writers.ept",
+        "EPT Writer",
+        "http://pdal.io/stages/writers.ept.html",
+        {}
+    };
+
+    // Children of a node, indexed by the direction used in Key::bisect.
+    using Children = std::array<std::vector<PointId>, 8>;
+}
+
+CREATE_STATIC_STAGE(EptWriter, s_info)
+
+EptWriter::EptWriter()
+{ }
+
+EptWriter::~EptWriter()
+{ }
+
+std::string EptWriter::getName() const { return s_info.name; }
+
+void EptWriter::addArgs(ProgramArgs& args)
+{
+    args.add("filename", "Output directory", m_filename).setPositional();
+    args.add("span", "Number of voxels in each dimension of a node's grid",
+        m_span, (uint64_t)128);
+    args.add("data_type", "Point data format: 'binary' or 'zstandard'",
+        m_dataTypeArg, "binary");
+    args.add("max_depth", "Maximum depth of the octree", m_maxDepth,
+        (uint64_t)32);
+    args.add("threads", "Number of worker threads", m_numThreads);
+    args.add("zstd_level", "Zstandard compression level", m_zstdLevel, 15);
+    args.add("zstd_threads", "Number of zstd worker threads used to "
+        "compress each node", m_zstdThreads);
+    args.add("zstd_long", "Use zstd long distance matching", m_zstdLong);
+}
+
+void EptWriter::initialize()
+{
+    const std::string postfix("ept.json");
+    if (Utils::endsWith(m_filename, postfix))
+        m_filename = m_filename.substr(0, m_filename.size() - postfix.size());
+
+    if (m_filename.empty())
+        throwError("Missing output filename");
+
+    if (m_dataTypeArg != "binary" && m_dataTypeArg != "zstandard")
+        throwError("Invalid data_type '" + m_dataTypeArg + "'.  Must be "
+            "'binary' or 'zstandard'.");
+#ifndef PDAL_HAVE_ZSTD
+    if (m_dataTypeArg == "zstandard")
+        throwError("Can't write EPT zstandard data.  PDAL not built "
+            "with Zstd.");
+#endif
+
+    if (m_span < 2)
+        throwError("Option 'span' must be at least 2.");
+
+    // Node identifiers double at each level, so the depth is limited to
+    // keep them in range.
+    if (m_maxDepth > 63)
+        throwError("Option 'max_depth' can't be larger than 63.");
+
+    m_arbiter.reset(new arbiter::Arbiter());
+    m_ep.reset(new arbiter::Endpoint(
+        m_arbiter->getEndpoint(arbiter::fs::expandTilde(m_filename))));
+
+    const std::size_t threads(std::max<std::size_t>(m_numThreads, 4));
+    if (threads > 100)
+    {
+        log()->get(LogLevel::Warning) << "Using a large thread count: " <<
+            threads << " threads" << std::endl;
+    }
+
+    // Allow a few nodes per thread to be queued so that workers don't wait
+    // on each other between nodes.
+    m_pool.reset(new ThreadPool(threads, threads * 4));
+}
+
+void EptWriter::ready(PointTableRef table)
+{
+    m_view.reset(new PointView(table));
+    m_hierarchy.clear();
+    m_error.clear();
+
+    // Point IDs added by readers.ept refer to the source dataset, so they
+    // aren't carried to the new one.
+    m_dims.clear();
+    const PointLayoutPtr layout(table.layout());
+    for (const Dimension::Id id : layout->dims())
+    {
+        const std::string name(layout->dimName(id));
+        if (name != "EptNodeId" && name != "EptPointId")
+            m_dims.push_back(id);
+    }
+}
+
+void EptWriter::write(const PointViewPtr view)
+{
+    if (m_srs.empty())
+        m_srs = view->spatialReference();
+
+    // The points of all views are built into one dataset.  Appending
+    // doesn't copy the point data.
+    m_view->append(*view);
+}
+
+void EptWriter::done(PointTableRef table)
+{
+    if (m_view->empty())
+        throwError("Can't write an EPT dataset with no points.");
+
+    BOX3D conforming;
+    m_view->calculateBounds(conforming);
+
+    // The octree covers a cube around the data.
+    const double half(std::max(1.0, std::ceil(std::max({
+        conforming.maxx - conforming.minx,
+        conforming.maxy - conforming.miny,
+        conforming.maxz - conforming.minz }) / 2.0)));
+    const double midx(conforming.minx + (conforming.maxx - conforming.minx) / 2);
+    const double midy(conforming.miny + (conforming.maxy - conforming.miny) / 2);
+    const double midz(conforming.minz + (conforming.maxz - conforming.minz) / 2);
+
+    Key root;
+    root.b = BOX3D(midx - half, midy - half, midz - half,
+        midx + half, midy + half, midz + half);
+
+    if (m_ep->isLocal())
+    {
+        arbiter::fs::mkdirp(m_ep->getSubEndpoint("ept-data").root());
+        arbiter::fs::mkdirp(m_ep->getSubEndpoint("ept-hierarchy").root());
+    }
+
+    // The tree is built a level at a time.  The nodes of a level are
+    // independent of each other, so they're built and written in parallel.
+    // Only point IDs are held for the nodes of the current and next levels.
+    std::vector<std::pair<Key, std::vector<PointId>>> level(1);
+    level.front().first = root;
+    level.front().second.resize(m_view->size());
+    for (PointId id(0); id < m_view->size(); ++id)
+        level.front().second[id] = id;
+
+    while (level.size())
+    {
+        log()->get(LogLevel::Debug) << "Building " << level.size() <<
+            " nodes at depth " << level.front().first.d << std::endl;
+
+        std::vector<std::pair<Key, std::vector<PointId>>> next;
+        for (auto& node : level)
+        {
+            m_pool->add([this, &node, &next]()
+            {
+                try
+                {
+                    buildNode(node.first, node.second, next);
+                }
+                catch (std::exception& e)
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_error = e.what();
+                }
+            });
+        }
+        m_pool->await();
+
+        if (m_error.size())
+            throwError(m_error);
+        level = std::move(next);
+    }
+
+    // Write the hierarchy in a single file.
+    Json::Value hier;
+    for (const auto& p : m_hierarchy)
+        hier[p.first.toString()] = static_cast<Json::UInt64>(p.second);
+    m_ep->put("ept-hierarchy/" + root.toString() + ".json", stringify(hier));
+
+    const SpatialReference& srs(getSpatialReference().empty() ?
+        m_srs : getSpatialReference());
+
+    Json::Value info;
+    auto addBounds = [](Json::Value& json, const BOX3D& b)
+    {
+        json.append(b.minx);
+        json.append(b.miny);
+        json.append(b.minz);
+        json.append(b.maxx);
+        json.append(b.maxy);
+        json.append(b.maxz);
+    };
+    addBounds(info["bounds"], root.b);
+    addBounds(info["boundsConforming"], conforming);
+    info["dataType"] = m_dataTypeArg;
+    info["hierarchyType"] = "json";
+    info["points"] = static_cast<Json::UInt64>(m_view->size());
+    info["schema"] = schema();
+    info["span"] = static_cast<Json::UInt64>(m_span);
+    info["srs"] = Json::objectValue;
+    if (!srs.empty())
+        info["srs"]["wkt"] = srs.getWKT();
+    info["version"] = "1.0.0";
+
+    // The dataset is only valid once ept.json exists, so it's written last.
+    m_ep->put("ept.json", info.toStyledString());
+
+    m_view.reset();
+    m_hierarchy.clear();
+}
+
+void EptWriter::buildNode(const Key& key, std::vector<PointId>& ids,
+        std::vector<std::pair<Key, std::vector<PointId>>>& next)
+{
+    std::vector<PointId> kept;
+    Children children;
+
+    if (ids.size() <= m_span * m_span || key.d >= m_maxDepth)
+    {
+        // Few enough points to store them all in this node.
+        kept.swap(ids);
+    }
+    else
+    {
+        // Each cell of the node's grid keeps the point nearest its center.
+        // The rest of the points go to the child nodes.
+        const double size[] { (key.b.maxx - key.b.minx) / m_span,
+            (key.b.maxy - key.b.miny) / m_span,
+            (key.b.maxz - key.b.minz) / m_span };
+        const double min[] { key.b.minx, key.b.miny, key.b.minz };
+        const double mid[] { key.b.minx + (key.b.maxx - key.b.minx) / 2,
+            key.b.miny + (key.b.maxy - key.b.miny) / 2,
+            key.b.minz + (key.b.maxz - key.b.minz) / 2 };
+        const Dimension::Id dims[] { Dimension::Id::X, Dimension::Id::Y,
+            Dimension::Id::Z };
+
+        // Return the grid cell of a point and its squared distance from the
+        // cell's center.
+        auto locate = [&](PointId id, double& dist)
+        {
+            uint64_t cell(0);
+            dist = 0;
+            for (int i = 0; i < 3; ++i)
+            {
+                const double v(m_view->getFieldAs<double>(dims[i], id));
+                const double pos((v - min[i]) / size[i]);
+                const uint64_t c((uint64_t)Utils::clamp(pos, 0.0,
+                    (double)(m_span - 1)));
+                const double d(pos - c - 0.5);
+                cell = cell * m_span + c;
+                dist += d * d;
+            }
+            return cell;
+        };
+
+        auto direction = [&](PointId id)
+        {
+            uint64_t dir(0);
+            for (int i = 0; i < 3; ++i)
+                if (m_view->getFieldAs<double>(dims[i], id) >= mid[i])
+                    dir |= ((uint64_t)1 << i);
+            return dir;
+        };
+
+        std::unordered_map<uint64_t, std::pair<PointId, double>> cells;
+        for (PointId id : ids)
+        {
+            double dist;
+            const uint64_t cell(locate(id, dist));
+
+            auto it = cells.find(cell);
+            if (it == cells.end())
+                cells.insert({ cell, { id, dist } });
+            else
+            {
+                PointId overflow(id);
+                if (dist < it->second.second)
+                {
+                    overflow = it->second.first;
+                    it->second = { id, dist };
+                }
+                children[direction(overflow)].push_back(overflow);
+            }
+        }
+        std::vector<PointId>().swap(ids);
+
+        kept.reserve(cells.size());
+        for (const auto& p : cells)
+            kept.push_back(p.second.first);
+
+        // Keep the source order so that output doesn't depend on hashing.
+        std::sort(kept.begin(), kept.end());
+    }
+
+    writeNode(key, kept);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_hierarchy[key] = kept.size();
+    for (uint64_t dir(0); dir < children.size(); ++dir)
+        if (children[dir].size())
+            next.emplace_back(key.bisect(dir), std::move(children[dir]));
+}
+
+void EptWriter::writeNode(const Key& key,
+        const std::vector<PointId>& ids) const
+{
+    // The node data is packed in schema order.  XYZ are stored as doubles.
+    std::vector<Dimension::Type> types;
+    std::size_t pointSize(0);
+    for (const Dimension::Id id : m_dims)
+    {
+        const Dimension::Type t(id == Dimension::Id::X ||
+            id == Dimension::Id::Y || id == Dimension::Id::Z ?
+            Dimension::Type::Double : m_view->layout()->dimType(id));
+        types.push_back(t);
+        pointSize += Dimension::size(t);
+    }
+
+    std::vector<char> data(ids.size() * pointSize);
+    char *pos = data.data();
+    for (PointId id : ids)
+    {
+        for (std::size_t i(0); i < m_dims.size(); ++i)
+        {
+            m_view->getField(pos, m_dims[i], types[i], id);
+            pos += Dimension::size(types[i]);
+        }
+    }
+
+    const std::string name("ept-data/" + key.toString());
+    if (m_dataTypeArg == "zstandard")
+    {
+#ifdef PDAL_HAVE_ZSTD
+        CompressionOptions opts;
+        opts.level = m_zstdLevel;
+        opts.threads = m_zstdThreads;
+        opts.longDistance = m_zstdLong;
+
+        std::vector<char> compressed;
+        ZstdCompressor compressor([&compressed](char *buf, size_t size)
+            { compressed.insert(compressed.end(), buf, buf + size); }, opts);
+        compressor.compress(data.data(), data.size());
+        compressor.done();
+        m_ep->put(name + ".zst", compressed);
+#endif
+    }
+    else
+        m_ep->put(name + ".bin", data);
+}
+
+Json::Value EptWriter::schema() const
+{
+    Json::Value schema(Json::arrayValue);
+
+    const PointLayoutPtr layout(m_view->layout());
+    for (const Dimension::Id id : m_dims)
+    {
+        const Dimension::Type t(id == Dimension::Id::X ||
+            id == Dimension::Id::Y || id == Dimension::Id::Z ?
+            Dimension::Type::Double : layout->dimType(id));
+
+        Json::Value dim;
+        dim["name"] = layout->dimName(id);
+        dim["type"] = getTypeString(t);
+        dim["size"] = static_cast<Json::UInt64>(Dimension::size(t));
+        schema.append(dim);
+    }
+
+    return schema;
+}
+
+std::string EptWriter::getTypeString(Dimension::Type t) const
+{
+    std::string s;
+    const auto base(Dimension::base(t));
+
+    if (base == Dimension::BaseType::Signed)
+        s = "signed";
+    else if (base == Dimension::BaseType::Unsigned)
+        s = "unsigned";
+    else if (base == Dimension::BaseType::Floating)
+        s = "float";
+    else
+        throwError("Invalid dimension type");
+
+    return s;
+}
+
+} // namespace pdal
@@ -0,0 +1,101 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <pdal/Writer.hpp>
+
+namespace Json { class Value; }
+
+namespace pdal
+{
+
+namespace arbiter
+{
+    class Arbiter;
+    class Endpoint;
+}
+
+class Key;
+class ThreadPool;
+
+class PDAL_DLL EptWriter : public Writer
+{
+public:
+    EptWriter();
+    virtual ~EptWriter();
+
+    std::string getName() const override;
+
+private:
+    virtual void addArgs(ProgramArgs& args) override;
+    virtual void initialize() override;
+    virtual void ready(PointTableRef table) override;
+    virtual void write(const PointViewPtr view) override;
+    virtual void done(PointTableRef table) override;
+
+    void buildNode(const Key& key, std::vector<PointId>& ids,
+            std::vector<std::pair<Key, std::vector<PointId>>>& next);
+    void writeNode(const Key& key, const std::vector<PointId>& ids) const;
+    Json::Value schema() const;
+    std::string getTypeString(Dimension::Type t) const;
+
+    std::string m_filename;
+    std::string m_dataTypeArg;
+    uint64_t m_span;
+    uint64_t m_maxDepth;
+    std::size_t m_numThreads;
+    int m_zstdLevel;
+    int m_zstdThreads;
+    bool m_zstdLong;
+
+    std::unique_ptr<arbiter::Arbiter> m_arbiter;
+    std::unique_ptr<arbiter::Endpoint> m_ep;
+    std::unique_ptr<ThreadPool> m_pool;
+
+    PointViewPtr m_view;
+    SpatialReference m_srs;
+    Dimension::IdList m_dims;
+    std::map<Key, uint64_t> m_hierarchy;
+    std::string m_error;
+    std::mutex m_mutex;
+};
+
+} // namespace pdal
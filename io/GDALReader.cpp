@@ -35,9 +35,11 @@
 #include "GDALReader.hpp"
 
 #include <sstream>
+#include <thread>
 
 #include <pdal/GDALUtils.hpp>
 #include <pdal/PointView.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 namespace pdal
 {
@@ -61,7 +63,7 @@ std::string GDALReader::getName() const
 
 
 GDALReader::GDALReader()
-    : m_index(0)
+    : m_index(0), m_stripRow(0), m_stripHeight(0), m_stripRows(1)
 {}
 
 GDALReader::~GDALReader()
@@ -152,6 +154,9 @@ void GDALReader::addArgs(ProgramArgs& args)
         "raster bands to dimension id", m_header);
     args.add("memorycopy", "Load the given raster file "
         "entirely to memory", m_useMemoryCopy, false).setHidden();
+    args.add("threads", "Number of threads used to read the bands of "
+        "multi-band rasters.  The default is the number of cores.",
+        m_threads);
 }
 
 
@@ -171,9 +176,85 @@ void GDALReader::ready(PointTableRef table)
                 "copy.  Using standard interface.";
     }
 
+    // Bands are read in strips of whole rows of the natural blocks of
+    // the raster, limited to about 16M cells.
+    const size_t bands = (size_t)m_raster->bandCount();
+    int blockWidth(1), blockHeight(1);
+    if (bands)
+        m_raster->blockSize(1, blockWidth, blockHeight);
+    const int maxCells = 1 << 24;
+    m_stripRows = (std::max)(1,
+        (std::min)(blockHeight, maxCells / (std::max)(m_width, 1)));
+
+    // GDAL datasets can't be shared among threads, so each additional
+    // thread reads its bands through its own handle.  A memory copy
+    // can't be reopened.
+    size_t threads = m_threads ? m_threads :
+        std::thread::hardware_concurrency();
+    threads = (std::min)(threads, bands);
+    m_bandRasters.clear();
+    m_pool.reset();
+    if (threads > 1 && !m_useMemoryCopy)
+    {
+        for (size_t i = 1; i < threads; ++i)
+        {
+            std::unique_ptr<gdal::Raster> r(new gdal::Raster(m_filename));
+            if (r->open() != gdal::GDALError::None)
+                throwError("Couldn't open raster file '" + m_filename + "'.");
+            m_bandRasters.push_back(std::move(r));
+        }
+        m_pool.reset(new ThreadPool(threads - 1, threads - 1, false));
+    }
+    m_strip.resize(bands);
+
     m_index = 0;
     m_row = 0;
     m_col = 0;
+    m_stripRow = 0;
+    m_stripHeight = 0;
+}
+
+
+void GDALReader::done(PointTableRef table)
+{
+    m_pool.reset();
+    m_bandRasters.clear();
+    m_strip.clear();
+    m_raster->close();
+}
+
+
+// Read the values of all bands for the strip of rows that starts at the
+// current row.
+void GDALReader::readStrip()
+{
+    m_stripRow = m_row;
+    m_stripHeight = (std::min)(m_stripRows, m_height - m_row);
+
+    // Each handle reads every n'th band.
+    const size_t handles = m_bandRasters.size() + 1;
+    std::vector<std::string> errors(handles);
+    auto readBands = [this, handles, &errors](size_t h)
+    {
+        gdal::Raster& r = (h == 0) ? *m_raster : *m_bandRasters[h - 1];
+        for (size_t b = h; b < m_strip.size(); b += handles)
+            if (r.readWindow((int)b + 1, 0, m_stripRow, m_width,
+                m_stripHeight, m_strip[b]) != gdal::GDALError::None)
+            {
+                errors[h] = r.errorMsg();
+                return;
+            }
+    };
+
+    for (size_t h = 1; h < handles; ++h)
+        m_pool->add([&readBands, h](){ readBands(h); });
+    readBands(0);
+    if (m_pool)
+        m_pool->await();
+
+    for (const std::string& err : errors)
+        if (err.size())
+            throwError(err);
 }
 
 
@@ -200,22 +281,16 @@ bool GDALReader::processOne(PointRef& point)
     if (m_row == m_height)
         return false; // done
 
-    m_raster->pixelToCoord(m_col, m_row, coords);
-    double x = coords[0];
-    double y = coords[1];
-    point.setField(Dimension::Id::X, x);
-    point.setField(Dimension::Id::Y, y);
+    if (m_row >= m_stripRow + m_stripHeight)
+        readStrip();
 
-    std::vector<double> data;
-    if (m_raster->read(x, y, data) != gdal::GDALError::None)
-        return false;
+    m_raster->pixelToCoord(m_col, m_row, coords);
+    point.setField(Dimension::Id::X, coords[0]);
+    point.setField(Dimension::Id::Y, coords[1]);
 
-    for (int b = 0; b < m_raster->bandCount(); ++b)
-    {
-        Dimension::Id id = m_bandIds[b];
-        double v = data[b];
-        point.setField(id, v);
-    }
+    const size_t pos = (size_t)(m_row - m_stripRow) * m_width + m_col;
+    for (size_t b = 0; b < m_strip.size(); ++b)
+        point.setField(m_bandIds[b], m_strip[b][pos]);
     m_col++;
     if (m_col == m_width)
     {
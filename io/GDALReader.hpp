@@ -48,6 +48,8 @@ namespace pdal
 
 typedef std::map<std::string, Dimension::Id> DimensionMap;
 
+class ThreadPool;
+
 class PDAL_DLL GDALReader : public Reader , public Streamable
 {
 public:
@@ -61,11 +63,11 @@ private:
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void ready(PointTableRef table);
     virtual point_count_t read(PointViewPtr view, point_count_t num);
-    virtual void done(PointTableRef table)
-        { m_raster->close(); }
+    virtual void done(PointTableRef table);
     virtual bool processOne(PointRef& point);
     virtual QuickInfo inspect();
     virtual void addArgs(ProgramArgs& args);
+    void readStrip();
 
     std::unique_ptr<gdal::Raster> m_raster;
     std::vector<Dimension::Type> m_bandTypes;
@@ -77,6 +79,18 @@ private:
     point_count_t m_index;
     int m_row;
     int m_col;
+    size_t m_threads;
+
+    // Additional handles to the raster so that bands can be read in
+    // parallel.  A GDAL dataset can only be used by one thread at a time.
+    std::vector<std::unique_ptr<gdal::Raster>> m_bandRasters;
+    std::unique_ptr<ThreadPool> m_pool;
+
+    // Values of each band for rows [m_stripRow, m_stripRow + m_stripHeight).
+    std::vector<std::vector<double>> m_strip;
+    int m_stripRow;
+    int m_stripHeight;
+    int m_stripRows;
 
     BOX3D m_bounds;
     StringList m_dimNames;
@@ -34,11 +34,15 @@
 #include "GDALWriter.hpp"
 
 #include <sstream>
+#include <thread>
 
 #include <pdal/GDALUtils.hpp>
+#include <pdal/PDALUtils.hpp>
 #include <pdal/PointView.hpp>
+#include <pdal/util/FileUtils.hpp>
 
 #include "private/GDALGrid.hpp"
+#include "private/GDALTiledGrid.hpp"
 
 namespace pdal
 {
@@ -59,6 +63,14 @@ std::string GDALWriter::getName() const
 }
 
 
+GDALWriter::GDALWriter() : m_outputTypes(0), m_expandByPoint(true)
+{}
+
+
+GDALWriter::~GDALWriter()
+{}
+
+
 void GDALWriter::addArgs(ProgramArgs& args)
 {
     args.add("filename", "Output filename", m_filename).setPositional();
@@ -81,6 +93,15 @@ void GDALWriter::addArgs(ProgramArgs& args)
     args.add("dimension", "Dimension to use", m_interpDimString, "Z");
     args.add("bounds", "Bounds of data.  Required in streaming mode.",
         m_bounds);
+    args.add("tile_size", "Edge length of output tiles in cells.  When set, "
+        "the raster is built and written a tile at a time.", m_tileSize);
+    args.add("max_tiles", "Maximum number of tiles held in memory when "
+        "'tile_size' is set.  Other tiles are spilled to a temporary file.",
+        m_maxTiles, size_t(64));
+    args.add("sorted", "Points arrive in order of descending Y, so tiles are "
+        "written as soon as they're complete.", m_sorted);
+    args.add("threads", "Number of threads used to grid points and fill "
+        "empty cells.  The default is the number of cores.", m_threads);
 }
 
 
@@ -122,6 +143,10 @@ void GDALWriter::prepared(PointTableRef table)
             "' does not exist.");
     if (!m_radiusArg->set())
         m_radius = m_edgeLength * sqrt(2.0);
+    if (m_sorted && !m_tileSize)
+        throwError("Option 'sorted' requires option 'tile_size'.");
+    if (m_tileSize && m_windowSize > m_tileSize)
+        throwError("Option 'window_size' can't exceed 'tile_size'.");
     m_fixedGrid = m_bounds.to2d().valid();
     // If we've specified a grid, we don't expand by point.  We also
     // don't expand by point if we're running in standard mode.  That's
@@ -130,14 +155,54 @@ void GDALWriter::prepared(PointTableRef table)
 }
 
 
+bool GDALWriter::dimensionsUsed(PointLayoutPtr,
+    Dimension::IdList& dims) const
+{
+    dims.insert(dims.end(),
+        { Dimension::Id::X, Dimension::Id::Y, m_interpDim });
+    return true;
+}
+
+
 void GDALWriter::readyFile(const std::string& filename,
     const SpatialReference& srs)
 {
+    // GDAL can't write through a stream, so a remote raster is written to
+    // a local file that's uploaded once it's complete.
     m_outputFilename = filename;
+    m_remoteFilename.clear();
+    if (Utils::isRemote(filename))
+    {
+        m_remoteFilename = filename;
+        m_outputFilename = FileUtils::uniqueFilename("", "pdal_gdal") +
+            FileUtils::extension(filename);
+    }
     m_srs = srs;
     m_grid.reset();
+    m_tiledGrid.reset();
+    m_raster.reset();
     if (m_fixedGrid)
-        createGrid(m_bounds.to2d());
+    {
+        if (m_tileSize)
+            createTiledGrid(m_bounds.to2d());
+        else
+            createGrid(m_bounds.to2d());
+    }
+}
+
+
+void GDALWriter::prerunFile(const PointViewSet& pvSet)
+{
+    // A tiled raster can't grow, so its size is set from all the points
+    // before any are added.
+    if (!m_tileSize || m_fixedGrid)
+        return;
+
+    BOX2D bounds;
+    for (auto& view : pvSet)
+        view->calculateBounds(bounds);
+    if (bounds.valid())
+        createTiledGrid(bounds);
 }
 
 
@@ -171,6 +236,8 @@ void GDALWriter::createGrid(BOX2D bounds)
     {
         m_grid.reset(new GDALGrid(c.x + 1, c.y + 1, m_edgeLength,
             m_radius, m_outputTypes, m_windowSize));
+        m_grid->setThreads(m_threads ? m_threads :
+            std::thread::hardware_concurrency());
     }
     catch (GDALGrid::error& err)
     {
@@ -179,6 +246,79 @@ void GDALWriter::createGrid(BOX2D bounds)
 }
 
 
+void GDALWriter::createTiledGrid(BOX2D bounds)
+{
+    m_origin = { bounds.minx, bounds.miny };
+    Cell c = cell(bounds.maxx, bounds.maxy);
+    const size_t width = c.x + 1;
+    const size_t height = c.y + 1;
+
+    std::array<double, 6> pixelToPos;
+
+    pixelToPos[0] = m_origin.x;
+    pixelToPos[1] = m_edgeLength;
+    pixelToPos[2] = 0;
+    pixelToPos[3] = m_origin.y + (m_edgeLength * height);
+    pixelToPos[4] = 0;
+    pixelToPos[5] = -m_edgeLength;
+
+    try
+    {
+        m_tiledGrid.reset(new GDALTiledGrid(width, height, m_tileSize,
+            m_maxTiles, m_sorted, m_edgeLength, m_radius, m_outputTypes,
+            m_windowSize, [this](GDALGrid& tile, size_t col, size_t row)
+                { writeTile(tile, col, row); }));
+    }
+    catch (const GDALGrid::error& err)
+    {
+        throwError(err.what());
+    }
+
+    // Make GeoTIFF blocks match the tiles unless blocking was requested.
+    StringList options(m_options);
+    auto blocking = [](const std::string& opt)
+    {
+        return Utils::startsWith(Utils::toupper(opt), "TILED") ||
+            Utils::startsWith(Utils::toupper(opt), "BLOCKXSIZE") ||
+            Utils::startsWith(Utils::toupper(opt), "BLOCKYSIZE");
+    };
+    if (Utils::toupper(m_drivername) == "GTIFF" && m_tileSize % 16 == 0 &&
+        std::none_of(options.begin(), options.end(), blocking))
+    {
+        options.push_back("TILED=YES");
+        options.push_back("BLOCKXSIZE=" + std::to_string(m_tileSize));
+        options.push_back("BLOCKYSIZE=" + std::to_string(m_tileSize));
+    }
+
+    m_raster.reset(new gdal::Raster(m_outputFilename, m_drivername, m_srs,
+        pixelToPos));
+    gdal::GDALError err = m_raster->open((int)width, (int)height,
+        GDALGrid::numBands(m_outputTypes), m_dataType, m_noData, options);
+    if (err != gdal::GDALError::None)
+        throwError(m_raster->errorMsg());
+}
+
+
+void GDALWriter::writeTile(GDALGrid& tile, size_t col, size_t row)
+{
+    double srcNoData = std::numeric_limits<double>::quiet_NaN();
+    int bandNum = 1;
+
+    // Bands are in the same order as for an untiled raster.
+    for (const char *name : { "min", "max", "mean", "idw", "count", "stdev" })
+    {
+        double *src = tile.data(name);
+        if (!src)
+            continue;
+        gdal::GDALError err = m_raster->writeWindow(src, srcNoData,
+            bandNum++, (int)col, (int)row, (int)tile.width(),
+            (int)tile.height(), name);
+        if (err != gdal::GDALError::None)
+            throwError(m_raster->errorMsg());
+    }
+}
+
+
 void GDALWriter::expandGrid(BOX2D bounds)
 {
     Cell low = cell(bounds.minx, bounds.miny);
@@ -216,8 +356,8 @@ void GDALWriter::writeView(const PointViewPtr view)
 
     // When we're running in standard mode, it's better to get the bounds and
     // expand once, rather than have to do this for every point, since an
-    // expansion causes data to move.
-    if (!m_fixedGrid)
+    // expansion causes data to move.  A tiled grid is already sized.
+    if (!m_fixedGrid && !m_tileSize)
     {
         BOX2D bounds;
         view->calculateBounds(bounds);
@@ -227,12 +367,28 @@ void GDALWriter::writeView(const PointViewPtr view)
             expandGrid(bounds);
     }
 
-    PointRef point(*view, 0);
+    if (m_tileSize)
+    {
+        PointRef point(*view, 0);
+        for (PointId idx = 0; idx < view->size(); ++idx)
+        {
+            point.setPointId(idx);
+            processOne(point);
+        }
+        return;
+    }
+
+    // Gather the points so that the grid can add them in parallel.
+    std::vector<double> x(view->size());
+    std::vector<double> y(view->size());
+    std::vector<double> z(view->size());
     for (PointId idx = 0; idx < view->size(); ++idx)
     {
-        point.setPointId(idx);
-        processOne(point);
+        x[idx] = view->getFieldAs<double>(Dimension::Id::X, idx) - m_origin.x;
+        y[idx] = view->getFieldAs<double>(Dimension::Id::Y, idx) - m_origin.y;
+        z[idx] = view->getFieldAs<double>(m_interpDim, idx);
     }
+    m_grid->addPoints(x, y, z);
 }
 
 
@@ -242,6 +398,22 @@ bool GDALWriter::processOne(PointRef& point)
     double y = point.getFieldAs<double>(Dimension::Id::Y);
     double z = point.getFieldAs<double>(m_interpDim);
 
+    if (m_tileSize)
+    {
+        if (!m_tiledGrid)
+            throwError("Option 'bounds' is required for tiled output "
+                "when streaming.");
+        try
+        {
+            m_tiledGrid->addPoint(x - m_origin.x, y - m_origin.y, z);
+        }
+        catch (const GDALGrid::error& err)
+        {
+            throwError(err.what());
+        }
+        return true;
+    }
+
     if (m_expandByPoint)
     {
         Cell c = cell(x, y);
@@ -261,6 +433,27 @@ bool GDALWriter::processOne(PointRef& point)
 
 void GDALWriter::doneFile()
 {
+    if (m_tileSize)
+    {
+        if (!m_tiledGrid)
+            throw pdal_error("Unable to write GDAL data with no points "
+                "for output.");
+        try
+        {
+            m_tiledGrid->finish();
+        }
+        catch (const GDALGrid::error& err)
+        {
+            throwError(err.what());
+        }
+        m_tiledGrid.reset();
+        // Destroying the raster closes the dataset.
+        m_raster.reset();
+        uploadOutput();
+        getMetadata().addList("filename", m_filename);
+        return;
+    }
+
     if (!m_grid)
         throw pdal_error("Unable to write GDAL data with no points "
             "for output.");
@@ -307,8 +500,39 @@ void GDALWriter::doneFile()
         err = raster.writeBand(src, srcNoData, bandNum++, "stdev");
     if (err != gdal::GDALError::None)
         throwError(raster.errorMsg());
+    raster.close();
+    uploadOutput();
 
     getMetadata().addList("filename", m_filename);
 }
 
+
+// Copy a raster written locally to its remote destination.  The copy is
+// streamed, so it's uploaded in parts while the local file is read.
+void GDALWriter::uploadOutput()
+{
+    if (m_remoteFilename.empty())
+        return;
+
+    std::istream *in = FileUtils::openFile(m_outputFilename);
+    std::ostream *out = Utils::createFile(m_remoteFilename);
+    if (!in || !out)
+    {
+        FileUtils::closeFile(in);
+        FileUtils::deleteFile(m_outputFilename);
+        throwError("Unable to upload '" + m_remoteFilename + "'.");
+    }
+    *out << in->rdbuf();
+    FileUtils::closeFile(in);
+    FileUtils::deleteFile(m_outputFilename);
+    try
+    {
+        Utils::closeFile(out);
+    }
+    catch (const pdal_error& err)
+    {
+        throwError(err.what());
+    }
+}
+
 } // namespace pdal
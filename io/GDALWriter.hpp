@@ -43,6 +43,12 @@ namespace pdal
 {
 
 class GDALGrid;
+class GDALTiledGrid;
+
+namespace gdal
+{
+class Raster;
+}
 
 class PDAL_DLL GDALWriter : public FlexWriter, public Streamable
 {
@@ -60,25 +66,32 @@ class PDAL_DLL GDALWriter : public FlexWriter, public Streamable
 public:
     std::string getName() const;
 
-    GDALWriter() : m_outputTypes(0), m_expandByPoint(true)
-    {}
+    GDALWriter();
+    ~GDALWriter();
 
 private:
     virtual void addArgs(ProgramArgs& args);
     virtual void initialize();
     virtual void prepared(PointTableRef table);
+    virtual bool dimensionsUsed(PointLayoutPtr layout,
+        Dimension::IdList& dims) const;
     virtual void readyFile(const std::string& filename,
         const SpatialReference& srs);
+    virtual void prerunFile(const PointViewSet& pvSet);
     virtual void writeView(const PointViewPtr view);
     virtual bool processOne(PointRef& point);
     virtual void doneFile();
     void createGrid(BOX2D bounds);
+    void createTiledGrid(BOX2D bounds);
+    void writeTile(GDALGrid& tile, size_t col, size_t row);
     void expandGrid(BOX2D bounds);
     Cell cell(double x, double y);
     long width() const;
     long height() const;
+    void uploadOutput();
 
     std::string m_outputFilename;
+    std::string m_remoteFilename;
     std::string m_drivername;
     SpatialReference m_srs;
     Bounds m_bounds;
@@ -97,6 +110,12 @@ private:
     Dimension::Type m_dataType;
     bool m_expandByPoint;
     bool m_fixedGrid;
+    size_t m_tileSize;
+    size_t m_maxTiles;
+    bool m_sorted;
+    size_t m_threads;
+    std::unique_ptr<GDALTiledGrid> m_tiledGrid;
+    std::unique_ptr<gdal::Raster> m_raster;
 };
 
 }
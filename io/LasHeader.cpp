@@ -396,6 +396,27 @@ ILeStream& operator>>(ILeStream& in, LasHeader& h)
         in.seek(h.m_eVlrOffset);
         for (size_t i = 0; i < h.m_eVlrCount; ++i)
         {
+            const std::streampos pos = in.position();
+            uint16_t reserved;
+            std::string userId;
+            uint16_t recordId;
+            uint64_t dataLen;
+            in >> reserved;
+            in.get(userId, 16);
+            in >> recordId >> dataLen;
+            auto ignored = [&userId, recordId](const LasUtils::IgnoreVLR& v)
+            {
+                return v.m_userId == userId &&
+                    (v.m_recordId == 0 || v.m_recordId == recordId);
+            };
+            if (std::any_of(h.m_ignoredEVlrs.begin(), h.m_ignoredEVlrs.end(),
+                    ignored))
+            {
+                in.seek(in.position() + (std::streamoff)(32 + dataLen));
+                continue;
+            }
+            in.seek(pos);
+
             ExtLasVLR r;
             in >> r;
             h.m_vlrs.push_back(std::move(r));
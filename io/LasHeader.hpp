@@ -45,6 +45,7 @@
 #include <pdal/pdal_config.hpp>
 #include <pdal/gitsha.h>
 
+#include "LasUtils.hpp"
 #include "LasVLR.hpp"
 
 namespace pdal
@@ -249,7 +250,7 @@ public:
     /// Get the point count by return number.
     /// \param index - Return number.
     /// \return - Point count.
-    uint64_t pointCountByReturn(std::size_t index)
+    uint64_t pointCountByReturn(std::size_t index) const
         { return m_pointCountByReturn[index]; }
 
     size_t maxReturnCount() const
@@ -388,6 +389,10 @@ public:
         { m_log = log; }
     const VlrList& vlrs() const
         { return m_vlrs; }
+    // Extended VLRs that match are skipped without reading their data
+    // when the header is read.
+    void setIgnoredEVlrs(const std::vector<LasUtils::IgnoreVLR>& ignored)
+        { m_ignoredEVlrs = ignored; }
 
     PDAL_DLL friend ILeStream& operator>>(ILeStream&, LasHeader& h);
     friend OLeStream& operator<<(OLeStream&, const LasHeader& h);
@@ -421,6 +426,7 @@ private:
     SpatialReference m_srs;
     VlrList m_vlrs;
     VlrList m_eVlrs;
+    std::vector<LasUtils::IgnoreVLR> m_ignoredEVlrs;
 
     void setSrs();
     void setSrsFromWkt();
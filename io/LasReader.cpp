@@ -36,8 +36,12 @@
 
 #include "LasReader.hpp"
 
+#include <deque>
+#include <future>
+#include <limits>
 #include <sstream>
 #include <string.h>
+#include <thread>
 
 #include <pdal/pdal_features.hpp>
 #include <pdal/Metadata.hpp>
@@ -46,10 +50,14 @@
 #include <pdal/util/Extractor.hpp>
 #include <pdal/util/IStream.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 #include "GeotiffSupport.hpp"
 #include "LasHeader.hpp"
 #include "LasVLR.hpp"
+#include "private/LasColumns.hpp"
+#include "private/LasDims.hpp"
+#include "private/LaxIndex.hpp"
 
 namespace pdal
 {
@@ -65,7 +73,206 @@ struct invalid_stream : public std::runtime_error
 
 } // unnamed namespace
 
-LasReader::LasReader() : m_decompressor(nullptr), m_index(0)
+#ifdef PDAL_HAVE_LAZPERF
+// Decompresses LAZ chunks on a pool of threads ahead of the points being
+// loaded.  The compressed chunks are read from the stream, in order, on the
+// calling thread and decompressed points are handed back in file order.
+// Chunks without points in the intervals to be read are skipped.
+class LasReader::ChunkReader
+{
+public:
+    // Returns null if the points can't be read a chunk at a time.
+    static std::unique_ptr<ChunkReader> open(std::istream& stream,
+        const char *vlrData, std::streamoff pointOffset,
+        point_count_t numPoints, const IntervalList& intervals,
+        const PointSelection& selection, int threads);
+
+    // Return the next decompressed point or null if there are no more.
+    char *next();
+
+    // Move ahead so that the next point returned is the point at 'index'.
+    void seek(point_count_t index);
+
+private:
+    struct Pending
+    {
+        point_count_t m_first;
+        uint32_t m_count;
+        std::future<std::vector<char>> m_points;
+    };
+
+    ChunkReader(std::istream& stream, const char *vlrData,
+        std::vector<uint32_t>&& sizes, point_count_t numPoints,
+        const IntervalList& intervals, const PointSelection& selection,
+        int threads);
+
+    void queue();
+    void load();
+
+    std::istream& m_stream;
+    LazPerfVlrChunkDecompressor m_decompressor;
+    std::vector<uint32_t> m_sizes;
+    std::vector<bool> m_skip;
+    size_t m_chunk;
+    point_count_t m_next;
+    point_count_t m_remaining;
+    size_t m_ahead;
+    ThreadPool m_pool;
+    std::deque<Pending> m_pending;
+    std::vector<char> m_points;
+    point_count_t m_first;
+    size_t m_pos;
+};
+
+
+std::unique_ptr<LasReader::ChunkReader> LasReader::ChunkReader::open(
+    std::istream& stream, const char *vlrData, std::streamoff pointOffset,
+    point_count_t numPoints, const IntervalList& intervals,
+    const PointSelection& selection, int threads)
+{
+    std::unique_ptr<ChunkReader> reader;
+
+    LazPerfVlrChunkDecompressor decompressor(vlrData);
+    const uint32_t chunkSize = decompressor.chunkSize();
+    if (!chunkSize)
+        return reader;
+
+    std::vector<uint32_t> sizes =
+        LazPerfVlrChunkDecompressor::readChunkTable(stream, pointOffset);
+    if (sizes.size() != (numPoints + chunkSize - 1) / chunkSize)
+        return reader;
+
+    // The first chunk follows the chunk table position.
+    stream.seekg(pointOffset + sizeof(int64_t));
+    reader.reset(new ChunkReader(stream, vlrData, std::move(sizes),
+        numPoints, intervals, selection, threads));
+    return reader;
+}
+
+
+LasReader::ChunkReader::ChunkReader(std::istream& stream,
+        const char *vlrData, std::vector<uint32_t>&& sizes,
+        point_count_t numPoints, const IntervalList& intervals,
+        const PointSelection& selection, int threads) :
+    m_stream(stream), m_decompressor(vlrData), m_sizes(std::move(sizes)),
+    m_skip(m_sizes.size(), !intervals.empty()), m_chunk(0), m_next(0),
+    m_remaining(numPoints), m_ahead(2 * threads),
+    m_pool(threads, m_ahead, false), m_first(0), m_pos(0)
+{
+    // Mark the chunks that hold points in some interval.
+    const point_count_t chunkSize = m_decompressor.chunkSize();
+    for (auto& i : intervals)
+        for (point_count_t c = i.first / chunkSize;
+                c < m_skip.size() && c * chunkSize < i.second; ++c)
+            m_skip[c] = false;
+
+    // Chunks without a selected point are skipped too.
+    if (!selection.all())
+        for (size_t c = 0; c < m_skip.size(); ++c)
+            if (selection.next(c * chunkSize) >= (std::min)(
+                    (c + 1) * chunkSize, selection.m_limit))
+                m_skip[c] = true;
+}
+
+
+// Read compressed chunks and hand them to the pool until enough are
+// being worked on.
+void LasReader::ChunkReader::queue()
+{
+    while (m_pending.size() < m_ahead && m_remaining)
+    {
+        uint32_t count = (uint32_t)(std::min)(m_remaining,
+            (point_count_t)m_decompressor.chunkSize());
+        m_remaining -= count;
+        point_count_t first = m_next;
+        m_next += count;
+        if (m_skip[m_chunk])
+        {
+            m_stream.seekg(m_sizes[m_chunk++], std::ios::cur);
+            continue;
+        }
+
+        auto compressed =
+            std::make_shared<std::vector<char>>(m_sizes[m_chunk++]);
+        m_stream.read(compressed->data(), compressed->size());
+        if (m_stream.gcount() != (std::streamsize)compressed->size())
+            throw pdal_error("readers.las: Unexpected end of file reading "
+                "compressed points.");
+
+        const LazPerfVlrChunkDecompressor& decompressor(m_decompressor);
+        auto task = std::make_shared<std::packaged_task<std::vector<char>()>>(
+            [&decompressor, compressed, count]()
+            {
+                std::vector<char> points(count * decompressor.pointSize());
+                decompressor.decompress(*compressed, points.data(), count);
+                return points;
+            });
+        m_pending.push_back({ first, count, task->get_future() });
+        m_pool.add([task](){ (*task)(); });
+    }
+}
+
+
+// Make the oldest pending chunk the current one.
+void LasReader::ChunkReader::load()
+{
+    Pending& p = m_pending.front();
+    m_first = p.m_first;
+    m_points = p.m_points.get();
+    m_pending.pop_front();
+    m_pos = 0;
+    queue();
+}
+
+
+char *LasReader::ChunkReader::next()
+{
+    if (m_pos == m_points.size())
+    {
+        queue();
+        if (m_pending.empty())
+            return nullptr;
+        load();
+    }
+    char *p = m_points.data() + m_pos;
+    m_pos += m_decompressor.pointSize();
+    return p;
+}
+
+
+void LasReader::ChunkReader::seek(point_count_t index)
+{
+    const size_t pointSize = m_decompressor.pointSize();
+
+    // Drop chunks that end before the point.
+    if (index >= m_first + m_points.size() / pointSize)
+    {
+        m_points.clear();
+        m_pos = 0;
+        while (true)
+        {
+            queue();
+            if (m_pending.empty())
+                return;
+            const Pending& p = m_pending.front();
+            if (index < p.m_first + p.m_count)
+                break;
+            m_pending.pop_front();
+        }
+        load();
+    }
+    if (index > m_first)
+        m_pos = (index - m_first) * pointSize;
+}
+#else
+class LasReader::ChunkReader
+{};
+#endif // PDAL_HAVE_LAZPERF
+
+
+LasReader::LasReader() : m_decompressor(nullptr), m_index(0),
+    m_dims(new LasDims), m_columns(new LasColumns), m_rawXYZ(false),
+    m_interval(0), m_readPos(0), m_sample(0)
 {}
 
 
@@ -74,6 +281,7 @@ LasReader::~LasReader()
 #ifdef PDAL_HAVE_LAZPERF
     delete m_decompressor;
 #endif
+    FileUtils::unmapFile(m_map);
 }
 
 
@@ -85,6 +293,17 @@ void LasReader::addArgs(ProgramArgs& args)
     args.add("use_eb_vlr", "Use extra bytes VLR for 1.0 - 1.3 files",
         m_useEbVlr);
     args.add("ignore_vlr", "VLR userid/recordid to ignore", m_ignoreVLROption);
+    args.add("threads", "Number of threads used to decompress LAZ data. "
+        "0 uses all available cores.", m_threads, 1);
+    args.add("bounds", "Only read points inside this box", m_bounds);
+    args.add("polygon", "Only read points inside these polygons", m_polys).
+        setErrorText("Invalid polygon specification.  "
+            "Must be valid GeoJSON/WKT");
+    args.add("sample", "Read about this many points, in evenly spaced runs "
+        "through the file (0 reads every point)", m_sample);
+    args.add("read_ahead", "Size in MiB of the windows of the file read "
+        "ahead on a background thread, rather than mapping a local file.  "
+        "0 reads as needed", m_readAhead);
 }
 
 
@@ -129,8 +348,11 @@ void LasReader::handleCompressionOption()
 {
     std::string compression = Utils::toupper(m_compression);
 #if defined(PDAL_HAVE_LAZPERF) && defined(PDAL_HAVE_LASZIP)
+    // Only LAZperf can decompress chunks in parallel, but it can't
+    // decompress the point formats added in LAS 1.4.
     if (compression == "EITHER")
-        compression = "LASZIP";
+        compression = (m_threads == 1 || m_header.pointFormat() > 5) ?
+            "LASZIP" : "LAZPERF";
 #endif
 #if !defined(PDAL_HAVE_LAZPERF) && defined(PDAL_HAVE_LASZIP)
     if (compression == "EITHER")
@@ -179,6 +401,7 @@ void LasReader::initializeLocal(PointTableRef table, MetadataNode& m)
     }
 
     m_header.setLog(log());
+    m_header.setIgnoredEVlrs(m_ignoreVLRs);
 
     createStream();
     std::istream *stream(m_streamIf->m_istream);
@@ -217,7 +440,17 @@ void LasReader::initializeLocal(PointTableRef table, MetadataNode& m)
         readExtraBytesVlr();
     setSrs(m);
     MetadataNode forward = table.privateMetadata("lasforward");
-    extractHeaderMetadata(forward, m);
+    if (metadataPolicy() == MetadataPolicy::Full)
+    {
+        extractHeaderMetadata(forward, m);
+    }
+    else
+    {
+        // Forwarded values are still needed by writers.las.  The rest
+        // of the header goes to a node that's thrown away.
+        MetadataNode discard;
+        extractHeaderMetadata(forward, discard);
+    }
     extractVlrMetadata(forward, m);
 
     m_streamIf.reset();
@@ -239,10 +472,57 @@ void LasReader::handleLaszip(int result)
 
 void LasReader::ready(PointTableRef table)
 {
+    m_dims->resolve(*table.layout());
+    m_extraFields = LasUtils::extraFields(m_extraDims, *table.layout());
+    auto sameScaling = [&table](Dimension::Id dim, double scale,
+        double offset)
+    {
+        const Dimension::Detail *dd = table.layout()->dimDetail(dim);
+        return dd->scaled() && dd->xform().sameAs(XForm(scale, offset));
+    };
+    m_rawXYZ =
+        sameScaling(Dimension::Id::X, m_header.scaleX(), m_header.offsetX()) &&
+        sameScaling(Dimension::Id::Y, m_header.scaleY(), m_header.offsetY()) &&
+        sameScaling(Dimension::Id::Z, m_header.scaleZ(), m_header.offsetZ());
     createStream();
     std::istream *stream(m_streamIf->m_istream);
 
     m_index = 0;
+    m_readPos = 0;
+
+    // Points outside the bounds and polygon options are never kept.
+    // Bounds and polygons that are two-dimensional don't limit Z.
+    const double lo = (std::numeric_limits<double>::lowest)();
+    const double hi = (std::numeric_limits<double>::max)();
+    BOX3D region;
+    if (m_bounds.is3d())
+        region = m_bounds.to3d();
+    else if (m_bounds.to2d().valid())
+    {
+        BOX2D b = m_bounds.to2d();
+        region = BOX3D(b.minx, b.miny, lo, b.maxx, b.maxy, hi);
+    }
+    if (m_polys.size())
+    {
+        BOX2D b;
+        for (const Polygon& poly : m_polys)
+            b.grow(poly.bounds().to2d());
+        BOX3D polyRegion(b.minx, b.miny, lo, b.maxx, b.maxy, hi);
+        if (region.valid())
+            region.clip(polyRegion);
+        else
+            region = polyRegion;
+    }
+    if (region.valid())
+    {
+        if (m_queryBounds.valid())
+            m_queryBounds.clip(region);
+        else
+            m_queryBounds = region;
+    }
+    readIndex();
+    sampleIntervals();
+
     if (m_header.compressed())
     {
 #ifdef PDAL_HAVE_LASZIP
@@ -262,10 +542,33 @@ void LasReader::ready(PointTableRef table)
         {
             const LasVLR *vlr = m_header.findVlr(LASZIP_USER_ID,
                 LASZIP_RECORD_ID);
-            delete m_decompressor;
-            m_decompressor = new LazPerfVlrDecompressor(*stream,
-                vlr->data(), m_header.pointOffset());
-            m_decompressorBuf.resize(m_decompressor->pointSize());
+            int threads = m_threads ? m_threads :
+                (int)(std::max)(std::thread::hardware_concurrency(), 1u);
+            m_chunkReader.reset();
+
+            // Points that the spatial index or a selection skips are read
+            // a chunk at a time so that whole chunks can be skipped.
+            if (threads > 1 || m_intervals.size() || !m_selection.all())
+            {
+                m_chunkReader = ChunkReader::open(*stream, vlr->data(),
+                    m_header.pointOffset(),
+                    (std::min)(m_count, getNumPoints()), m_intervals,
+                    m_selection, threads);
+                if (!m_chunkReader)
+                    log()->get(LogLevel::Debug, [this](std::ostream& out)
+                    {
+                        out << "No usable chunk table in '" << m_filename <<
+                            "'.  Decompressing with a single thread." <<
+                            std::endl;
+                    });
+            }
+            if (!m_chunkReader)
+            {
+                delete m_decompressor;
+                m_decompressor = new LazPerfVlrDecompressor(*stream,
+                    vlr->data(), m_header.pointOffset());
+                m_decompressorBuf.resize(m_decompressor->pointSize());
+            }
         }
 #endif
 
@@ -276,6 +579,57 @@ void LasReader::ready(PointTableRef table)
     }
     else
         stream->seekg(m_header.pointOffset());
+
+    // If none of the points can be kept, don't read any.
+    if (m_queryBounds.valid() && !m_queryBounds.overlaps(m_header.getBounds()))
+    {
+        log()->get(LogLevel::Debug, [this](std::ostream& out)
+        {
+            out << "Skipping '" << m_filename <<
+                "': no points in query bounds." << std::endl;
+        });
+        m_index = getNumPoints();
+    }
+
+    // Uncompressed points in a local file are read from a mapping of the
+    // file rather than copied through the stream, unless the stream reads
+    // ahead.
+    const std::string& localFilename = m_streamIf->m_localFilename;
+    if (!m_header.compressed() && m_index < getNumPoints() &&
+        localFilename.size() && !m_readAhead)
+    {
+        m_map = FileUtils::mapFile(localFilename);
+        if (m_map.addr())
+            FileUtils::adviseSequential(m_map);
+        else
+            log()->get(LogLevel::Debug, [&](std::ostream& out)
+            {
+                out << "Can't map '" << localFilename << "': " <<
+                    m_map.what() << "  Reading through a stream." <<
+                    std::endl;
+            });
+    }
+}
+
+
+// Get the address of a point in the file mapping.
+const char *LasReader::mappedPoint(PointId idx) const
+{
+    return (const char *)m_map.addr() + m_streamIf->m_localOffset +
+        m_header.pointOffset() + idx * m_header.pointLen();
+}
+
+
+// Number of points that are actually in the file mapping.  Truncated files
+// may have fewer than the header says.
+point_count_t LasReader::mappedPointCount() const
+{
+    const uint64_t pointOffset =
+        m_streamIf->m_localOffset + m_header.pointOffset();
+    if (m_map.m_size < pointOffset)
+        return 0;
+    return (std::min)(getNumPoints(),
+        (point_count_t)((m_map.m_size - pointOffset) / m_header.pointLen()));
 }
 
 
@@ -420,6 +774,9 @@ void LasReader::extractHeaderMetadata(MetadataNode& forward, MetadataNode& m)
         m_header.pointCount(), "This field contains the total "
         "number of point records within the file.");
 
+    if (metadataPolicy() != MetadataPolicy::Full)
+        return;
+
     // PDAL metadata VLR
     const LasVLR *vlr = m_header.findVlr("PDAL", 12);
     if (vlr)
@@ -491,16 +848,32 @@ void LasReader::extractVlrMetadata(MetadataNode& forward, MetadataNode& m)
 {
     static const size_t DATA_LEN_MAX = 1000000;
 
+    const bool full = (metadataPolicy() == MetadataPolicy::Full);
     int i = 0;
-    for (auto vlr : m_header.vlrs())
+    for (const auto& vlr : m_header.vlrs())
     {
         if (vlr.dataLen() > DATA_LEN_MAX)
             continue;
 
         std::ostringstream name;
         name << "vlr_" << i++;
+
+        bool forwardable = true;
+        if (vlr.userId() == TRANSFORM_USER_ID||
+            vlr.userId() == LASZIP_USER_ID ||
+            vlr.userId() == LIBLAS_USER_ID)
+            forwardable = false;
+        if (vlr.userId() == SPEC_USER_ID &&
+            vlr.recordId() != 0 && vlr.recordId() != 3)
+            forwardable = false;
+
+        // Encoding VLR data is expensive.  Skip it when nobody will see it.
+        if (!full && !forwardable)
+            continue;
+
         MetadataNode vlrNode(name.str());
-        m.add(vlrNode);
+        if (full)
+            m.add(vlrNode);
 
         vlrNode.addEncoded("data",
             (const uint8_t *)vlr.data(), vlr.dataLen(), vlr.description());
@@ -511,14 +884,8 @@ void LasReader::extractVlrMetadata(MetadataNode& forward, MetadataNode& m)
             "Record ID specified by the user.");
         vlrNode.add("description", vlr.description());
 
-        if (vlr.userId() == TRANSFORM_USER_ID||
-            vlr.userId() == LASZIP_USER_ID ||
-            vlr.userId() == LIBLAS_USER_ID)
-            continue;
-        if (vlr.userId() == SPEC_USER_ID &&
-            vlr.recordId() != 0 && vlr.recordId() != 3)
-            continue;
-        forward.add(vlrNode);
+        if (forwardable)
+            forward.add(vlrNode);
     }
 }
 
@@ -527,6 +894,9 @@ void LasReader::addDimensions(PointLayoutPtr layout)
 {
     using namespace Dimension;
 
+    const LasHeader& h = m_header;
+    layout->proposeScaling(XForm(h.scaleX(), h.offsetX()),
+        XForm(h.scaleY(), h.offsetY()), XForm(h.scaleZ(), h.offsetZ()));
     layout->registerDim(Id::X, Type::Double);
     layout->registerDim(Id::Y, Type::Double);
     layout->registerDim(Id::Z, Type::Double);
@@ -570,10 +940,255 @@ void LasReader::addDimensions(PointLayoutPtr layout)
 
 bool LasReader::processOne(PointRef& point)
 {
-    if (m_index >= getNumPoints())
+    while (nextRun(getNumPoints()))
+        if (loadNext(point))
+            return true;
+    return false;
+}
+
+
+// Use a LAStools spatial index, if there is one, to find the points that
+// may be in the query bounds.  The index is read from an EVLR or a .lax
+// file next to the input.
+void LasReader::readIndex()
+{
+    m_intervals.clear();
+    m_interval = 0;
+    if (!selectPoints(m_queryBounds, m_intervals))
+        return;
+
+    const point_count_t numPoints = getNumPoints();
+    while (m_intervals.size() && m_intervals.back().first >= numPoints)
+        m_intervals.pop_back();
+    point_count_t count = 0;
+    for (auto& i : m_intervals)
+    {
+        i.second = (std::min)(i.second, numPoints);
+        count += i.second - i.first;
+    }
+    log()->get(LogLevel::Debug, [&](std::ostream& out)
+    {
+        out << "Spatial index selects " << count << " of " << numPoints <<
+            " points in '" << m_filename << "'." << std::endl;
+    });
+
+    // None of the points can be in the query bounds.
+    if (m_intervals.empty())
+        m_index = numPoints;
+}
+
+
+// Read only runs of points spread evenly through the file when a sample
+// is requested.  The runs of compressed points are whole chunks, so the
+// chunks in between are skipped without being decompressed.
+void LasReader::sampleIntervals()
+{
+    const point_count_t numPoints = getNumPoints();
+    if (m_sample == 0 || m_sample >= numPoints || m_index >= numPoints)
+        return;
+    if (m_intervals.size())
+    {
+        log()->get(LogLevel::Debug, [this](std::ostream& out)
+        {
+            out << "Ignoring 'sample' for '" << m_filename <<
+                "', which is read with a spatial index." << std::endl;
+        });
+        return;
+    }
+
+    point_count_t run = 1024;
+    if (m_header.compressed())
+    {
+        // The chunk size follows the compressor, coder, version and
+        // options in the LASzip VLR.  Files with variable-sized chunks
+        // have a chunk size of all ones.
+        run = 50000;
+        const LasVLR *vlr = m_header.findVlr(LASZIP_USER_ID,
+            LASZIP_RECORD_ID);
+        if (vlr && vlr->dataLen() >= 16)
+        {
+            LeExtractor in(vlr->data() + 12, sizeof(uint32_t));
+            uint32_t chunkSize;
+            in >> chunkSize;
+            if (chunkSize &&
+                    chunkSize != (std::numeric_limits<uint32_t>::max)())
+                run = chunkSize;
+        }
+    }
+    const bool aligned = m_header.compressed() && run <= m_sample;
+    run = (std::min)(run, m_sample);
+
+    const point_count_t runs = (m_sample + run - 1) / run;
+    const double spacing = (double)numPoints / runs;
+    for (point_count_t i = 0; i < runs; ++i)
+    {
+        point_count_t begin = (point_count_t)(i * spacing);
+        if (aligned)
+            begin -= begin % run;
+        if (m_intervals.size())
+            begin = (std::max)(begin, m_intervals.back().second);
+        point_count_t end = (std::min)(begin + run, numPoints);
+        if (begin < end)
+            m_intervals.push_back(std::make_pair(begin, end));
+    }
+
+    point_count_t count = 0;
+    for (auto& i : m_intervals)
+        count += i.second - i.first;
+    log()->get(LogLevel::Debug, [&](std::ostream& out)
+    {
+        out << "Sampling " << count << " of " << numPoints <<
+            " points in '" << m_filename << "'." << std::endl;
+    });
+}
+
+
+// Find the sorted ranges of points that may be inside 'bounds' from a
+// LAStools spatial index.  Returns false if all points must be read.
+bool LasReader::selectPoints(const BOX3D& bounds, IntervalList& intervals)
+{
+    if (!bounds.valid())
         return false;
 
+    std::unique_ptr<LaxIndex> index;
+    std::string laxFilename = m_filename.substr(0,
+        m_filename.size() - FileUtils::extension(m_filename).size()) + ".lax";
+    try
+    {
+        const LasVLR *vlr = m_header.findVlr("LAStools", 30);
+        if (vlr)
+        {
+            std::istringstream in(std::string(vlr->data(), vlr->dataLen()));
+            index.reset(new LaxIndex(in));
+        }
+        else if (Utils::fileExists(laxFilename))
+        {
+            std::istream *in = Utils::openFile(laxFilename);
+            if (in)
+            {
+                try
+                {
+                    index.reset(new LaxIndex(*in));
+                }
+                catch (...)
+                {
+                    Utils::closeFile(in);
+                    throw;
+                }
+                Utils::closeFile(in);
+            }
+        }
+    }
+    catch (const LaxIndex::error& err)
+    {
+        log()->get(LogLevel::Warning) << getName() << ": Ignoring spatial "
+            "index for '" << m_filename << "'.  " << err.what() << std::endl;
+    }
+    if (!index)
+        return false;
+
+    intervals = index->query(bounds.to2d());
+    return true;
+}
+
+
+// Points dropped by the reader would move the positions of the rest, so a
+// selection can't be taken along with bounds, polygons or a sample.  The
+// count then limits the positions read rather than the points returned.
+bool LasReader::restrictSelection(const PointSelection& selection)
+{
+    if (m_bounds.is3d() || m_bounds.to2d().valid() || m_polys.size() ||
+            m_sample || m_queryBounds.valid())
+        return false;
+
+    m_selection = selection;
+    m_selection.m_limit = (std::min)(m_selection.m_limit, m_count);
+    m_count = (std::numeric_limits<point_count_t>::max)();
+    return true;
+}
+
+
+// Move to the next point before 'end' that may be kept.  Returns the number
+// of points from there that can be read one after another.  Points of a
+// selection are read one at a time unless they follow one another.
+point_count_t LasReader::nextRun(point_count_t end)
+{
+    end = (std::min)(end, m_selection.m_limit);
+    while (point_count_t run = nextInterval(end))
+    {
+        const point_count_t pos = m_selection.next(m_index);
+        if (pos == m_index)
+            return m_selection.m_step == 1 ? run : 1;
+        m_index = (std::min)(pos, end);
+    }
+    return 0;
+}
+
+
+// Move to the next point before 'end' in the spatial index intervals.
+// Without a spatial index, all points to 'end' are read.
+point_count_t LasReader::nextInterval(point_count_t end)
+{
+    if (m_intervals.empty())
+        return (m_index < end) ? end - m_index : 0;
+
+    while (m_interval < m_intervals.size() &&
+            m_intervals[m_interval].second <= m_index)
+        m_interval++;
+    if (m_interval == m_intervals.size())
+    {
+        m_index = (std::max)(m_index, end);
+        return 0;
+    }
+
+    const point_count_t first =
+        (std::max)(m_index, m_intervals[m_interval].first);
+    if (first >= end)
+    {
+        m_index = (std::max)(m_index, end);
+        return 0;
+    }
+    m_index = first;
+    return (std::min)(m_intervals[m_interval].second, end) - m_index;
+}
+
+
+// Position the input at the current point after points have been skipped.
+void LasReader::seekPoint()
+{
+    if (m_readPos == m_index)
+        return;
+
+    if (m_header.compressed())
+    {
+#ifdef PDAL_HAVE_LASZIP
+        if (m_compression == "LASZIP")
+            handleLaszip(laszip_seek_point(m_laszip, m_index));
+#endif
+#ifdef PDAL_HAVE_LAZPERF
+        if (m_compression == "LAZPERF" && m_chunkReader)
+            m_chunkReader->seek(m_index);
+        // Without a chunk table, skipped points have to be decompressed.
+        else if (m_compression == "LAZPERF")
+            for (; m_readPos < m_index; ++m_readPos)
+                m_decompressor->decompress(m_decompressorBuf.data());
+#endif
+    }
+    else if (!m_map.addr())
+        m_streamIf->m_istream->seekg(m_header.pointOffset() +
+            m_index * m_header.pointLen());
+    m_readPos = m_index;
+}
+
+
+// Read the next point in the file.  The point is only loaded if it's in
+// the query bounds.
+bool LasReader::loadNext(PointRef& point)
+{
     size_t pointLen = m_header.pointLen();
+    bool keep = false;
+
+    seekPoint();
 
     if (m_header.compressed())
     {
@@ -581,15 +1196,29 @@ bool LasReader::processOne(PointRef& point)
         if (m_compression == "LASZIP")
         {
             handleLaszip(laszip_read_point(m_laszip));
-            loadPoint(point, *m_laszipPoint);
+            keep = inBounds(m_laszipPoint->X, m_laszipPoint->Y,
+                m_laszipPoint->Z);
+            if (keep)
+                loadPoint(point, *m_laszipPoint);
         }
 #endif
 
 #ifdef PDAL_HAVE_LAZPERF
-        if (m_compression == "LAZPERF")
+        if (m_compression == "LAZPERF" && m_chunkReader)
+        {
+            char *buf = m_chunkReader->next();
+            if (!buf)
+                throwError("Unexpected end of compressed points.");
+            keep = inBounds(buf);
+            if (keep)
+                loadPoint(point, buf, pointLen);
+        }
+        else if (m_compression == "LAZPERF")
         {
             m_decompressor->decompress(m_decompressorBuf.data());
-            loadPoint(point, m_decompressorBuf.data(), pointLen);
+            keep = inBounds(m_decompressorBuf.data());
+            if (keep)
+                loadPoint(point, m_decompressorBuf.data(), pointLen);
         }
 #endif
 #if !defined(PDAL_HAVE_LAZPERF) && !defined(PDAL_HAVE_LASZIP)
@@ -597,15 +1226,66 @@ bool LasReader::processOne(PointRef& point)
             "LAZperf decompression library.");
 #endif
     } // compression
+    else if (m_map.addr())
+    {
+        // Stop at the end of a truncated file.
+        if (m_index >= mappedPointCount())
+        {
+            m_index = getNumPoints();
+            return false;
+        }
+        const char *buf = mappedPoint(m_index);
+        keep = inBounds(buf);
+        if (keep)
+            loadPoint(point, buf, pointLen);
+    }
     else
     {
         std::vector<char> buf(m_header.pointLen());
 
         m_streamIf->m_istream->read(buf.data(), pointLen);
-        loadPoint(point, buf.data(), pointLen);
+        keep = inBounds(buf.data());
+        if (keep)
+            loadPoint(point, buf.data(), pointLen);
     }
-    m_index++;
-    return true;
+    m_readPos = ++m_index;
+    return keep;
+}
+
+
+bool LasReader::inBounds(int32_t xi, int32_t yi, int32_t zi) const
+{
+    if (!m_queryBounds.valid())
+        return true;
+
+    const LasHeader& h = m_header;
+    double x = xi * h.scaleX() + h.offsetX();
+    double y = yi * h.scaleY() + h.offsetY();
+    double z = zi * h.scaleZ() + h.offsetZ();
+    if (!m_queryBounds.contains(x, y, z))
+        return false;
+    if (m_polys.empty())
+        return true;
+
+    std::vector<bool> inside;
+    for (const Polygon& poly : m_polys)
+    {
+        poly.covers(&x, &y, 1, inside);
+        if (inside[0])
+            return true;
+    }
+    return false;
+}
+
+
+// Every point format starts with the scaled X, Y and Z values.
+bool LasReader::inBounds(const char *buf) const
+{
+    LeExtractor istream(buf, 3 * sizeof(int32_t));
+
+    int32_t xi, yi, zi;
+    istream >> xi >> yi >> zi;
+    return inBounds(xi, yi, zi);
 }
 
 
@@ -620,13 +1300,17 @@ point_count_t LasReader::read(PointViewPtr view, point_count_t count)
 #if defined(PDAL_HAVE_LAZPERF) || defined(PDAL_HAVE_LASZIP)
         if (m_compression == "LASZIP" || m_compression == "LAZPERF")
         {
-            for (i = 0; i < count; i++)
+            const point_count_t end = m_index + count;
+            while (nextRun(end))
             {
-                PointRef point = view->point(i);
                 PointId id = view->size();
-                processOne(point);
-                if (m_cb)
-                    m_cb(*view, id);
+                PointRef point = view->point(id);
+                if (loadNext(point))
+                {
+                    if (m_cb)
+                        m_cb(*view, id);
+                    i++;
+                }
             }
         }
 #else
@@ -634,42 +1318,200 @@ point_count_t LasReader::read(PointViewPtr view, point_count_t count)
             "LAZperf decompression library.");
 #endif
     }
+    else if (m_map.addr())
+    {
+        // Points past the end of a truncated file can't be read.
+        count = (std::min)(count, mappedPointCount() - m_index);
+
+        const point_count_t end = m_index + count;
+        while (point_count_t run = nextRun(end))
+        {
+            i += loadPoints(*view, mappedPoint(m_index), run);
+            m_index += run;
+        }
+    }
     else
     {
-        point_count_t remaining = count;
+        const point_count_t end = m_index + count;
 
         // Make a buffer at most a meg.
         size_t bufsize = (std::min)((point_count_t)1000000, count * pointLen);
         std::vector<char> buf(bufsize);
         try
         {
-            do
+            while (point_count_t remaining = nextRun(end))
             {
-                point_count_t blockPoints = readFileBlock(buf, remaining);
-                remaining -= blockPoints;
-                char *pos = buf.data();
-                while (blockPoints--)
+                seekPoint();
+                do
                 {
-                    PointId id = view->size();
-                    PointRef point = view->point(id);
-                    loadPoint(point, pos, pointLen);
-                    if (m_cb)
-                        m_cb(*view, id);
-                    pos += pointLen;
-                    i++;
-                }
-            } while (remaining);
+                    point_count_t blockPoints = readFileBlock(buf, remaining);
+                    remaining -= blockPoints;
+                    i += loadPoints(*view, buf.data(), blockPoints);
+                    m_index += blockPoints;
+                    m_readPos = m_index;
+                } while (remaining);
+            }
         }
         catch (std::out_of_range&)
         {}
         catch (invalid_stream&)
         {}
     }
-    m_index += i;
     return (point_count_t)i;
 }
 
 
+// Load point records that follow one another in memory into a view,
+// skipping those outside of the query bounds.  Returns the number of points
+// added to the view.
+point_count_t LasReader::loadPoints(PointView& view, const char *buf,
+    point_count_t count)
+{
+    const size_t pointLen = m_header.pointLen();
+    const point_count_t batchSize = 4096;
+    std::vector<char> kept;
+    point_count_t added = 0;
+
+    while (count)
+    {
+        point_count_t n = (std::min)(count, batchSize);
+        const char *batch = buf;
+        point_count_t batchCount = n;
+        buf += n * pointLen;
+        count -= n;
+
+        // Gather the points that are kept so they can be decoded together.
+        if (m_queryBounds.valid())
+        {
+            kept.resize(n * pointLen);
+            batchCount = 0;
+            for (const char *pos = batch; pos < buf; pos += pointLen)
+                if (inBounds(pos))
+                    std::copy(pos, pos + pointLen,
+                        kept.data() + pointLen * batchCount++);
+            batch = kept.data();
+        }
+        if (!batchCount)
+            continue;
+
+        const PointId begin = view.size();
+        for (PointId id = begin; id < begin + batchCount; ++id)
+            view.getOrAddPoint(id);
+
+        switch (m_header.pointFormat())
+        {
+        case 0:
+            loadColumns<0>(view, begin, batch, batchCount);
+            break;
+        case 1:
+            loadColumns<1>(view, begin, batch, batchCount);
+            break;
+        case 2:
+            loadColumns<2>(view, begin, batch, batchCount);
+            break;
+        case 3:
+            loadColumns<3>(view, begin, batch, batchCount);
+            break;
+        case 6:
+            loadColumns<6>(view, begin, batch, batchCount);
+            break;
+        case 7:
+            loadColumns<7>(view, begin, batch, batchCount);
+            break;
+        case 8:
+            loadColumns<8>(view, begin, batch, batchCount);
+            break;
+        default:
+            // Waveform formats aren't supported, so we shouldn't get here.
+            for (point_count_t j = 0; j < batchCount; ++j)
+            {
+                PointRef point(view, begin + j);
+                loadPoint(point, batch + j * pointLen, pointLen);
+            }
+            break;
+        }
+
+        if (m_extraFields.size())
+            LasUtils::loadExtraFields(m_extraFields,
+                batch + m_header.basePointLen(), pointLen, view, begin,
+                batchCount);
+
+        if (m_cb)
+            for (PointId id = begin; id < begin + batchCount; ++id)
+                m_cb(view, id);
+        added += batchCount;
+    }
+    return added;
+}
+
+
+// Decode a batch of point records into columns and copy them into the view.
+template<int FORMAT>
+void LasReader::loadColumns(PointView& view, PointId begin, const char *buf,
+    point_count_t count)
+{
+    using namespace Dimension;
+    typedef LasFormat<FORMAT> F;
+
+    const LasHeader& h = m_header;
+    const double scale[] { h.scaleX(), h.scaleY(), h.scaleZ() };
+    const double offset[] { h.offsetX(), h.offsetY(), h.offsetZ() };
+
+    LasColumns& c = *m_columns;
+    c.resize(count);
+    decodeLasPoints<FORMAT>(buf, h.pointLen(), count,
+        m_rawXYZ ? nullptr : scale, offset, c);
+
+    // When the table scales X, Y and Z as the file does, the stored
+    // integers are copied as they are.
+    if (m_rawXYZ)
+    {
+        view.setScaledArray(Id::X, begin, count, c.m_rawX.data());
+        view.setScaledArray(Id::Y, begin, count, c.m_rawY.data());
+        view.setScaledArray(Id::Z, begin, count, c.m_rawZ.data());
+    }
+    else
+    {
+        view.setFieldArray(Id::X, begin, count, c.m_x.data());
+        view.setFieldArray(Id::Y, begin, count, c.m_y.data());
+        view.setFieldArray(Id::Z, begin, count, c.m_z.data());
+    }
+    view.setFieldArray(Id::Intensity, begin, count, c.m_intensity.data());
+    view.setFieldArray(Id::ReturnNumber, begin, count,
+        c.m_returnNumber.data());
+    view.setFieldArray(Id::NumberOfReturns, begin, count,
+        c.m_numberOfReturns.data());
+    if (F::v14)
+    {
+        view.setFieldArray(Id::ClassFlags, begin, count,
+            c.m_classFlags.data());
+        view.setFieldArray(Id::ScanChannel, begin, count,
+            c.m_scanChannel.data());
+    }
+    view.setFieldArray(Id::ScanDirectionFlag, begin, count,
+        c.m_scanDirectionFlag.data());
+    view.setFieldArray(Id::EdgeOfFlightLine, begin, count,
+        c.m_edgeOfFlightLine.data());
+    view.setFieldArray(Id::Classification, begin, count,
+        c.m_classification.data());
+    view.setFieldArray(Id::ScanAngleRank, begin, count,
+        c.m_scanAngle.data());
+    view.setFieldArray(Id::UserData, begin, count, c.m_userData.data());
+    view.setFieldArray(Id::PointSourceId, begin, count,
+        c.m_pointSourceId.data());
+    if (F::time)
+        view.setFieldArray(Id::GpsTime, begin, count, c.m_gpsTime.data());
+    if (F::color)
+    {
+        view.setFieldArray(Id::Red, begin, count, c.m_red.data());
+        view.setFieldArray(Id::Green, begin, count, c.m_green.data());
+        view.setFieldArray(Id::Blue, begin, count, c.m_blue.data());
+    }
+    if (F::infrared)
+        view.setFieldArray(Id::Infrared, begin, count, c.m_infrared.data());
+}
+
+
 point_count_t LasReader::readFileBlock(std::vector<char>& buf,
     point_count_t maxpoints)
 {
@@ -705,7 +1547,8 @@ void LasReader::loadPoint(PointRef& point, laszip_point& p)
 #endif // PDAL_HAVE_LASZIP
 
 
-void LasReader::loadPoint(PointRef& point, char *buf, size_t bufsize)
+void LasReader::loadPoint(PointRef& point, const char *buf,
+    size_t bufsize)
 {
     if (m_header.has14Format())
         loadPointV14(point, buf, bufsize);
@@ -718,45 +1561,45 @@ void LasReader::loadPoint(PointRef& point, char *buf, size_t bufsize)
 void LasReader::loadPointV10(PointRef& point, laszip_point& p)
 {
     const LasHeader& h = m_header;
+    const LasDims& d = *m_dims;
 
     double x = p.X * h.scaleX() + h.offsetX();
     double y = p.Y * h.scaleY() + h.offsetY();
     double z = p.Z * h.scaleZ() + h.offsetZ();
 
-    point.setField(Dimension::Id::X, x);
-    point.setField(Dimension::Id::Y, y);
-    point.setField(Dimension::Id::Z, z);
-    point.setField(Dimension::Id::Intensity, p.intensity);
-    point.setField(Dimension::Id::ReturnNumber, p.return_number);
-    point.setField(Dimension::Id::NumberOfReturns, p.number_of_returns);
-    point.setField(Dimension::Id::ScanDirectionFlag, p.scan_direction_flag);
-    point.setField(Dimension::Id::EdgeOfFlightLine, p.edge_of_flight_line);
+    d.m_x.set(point, x);
+    d.m_y.set(point, y);
+    d.m_z.set(point, z);
+    d.m_intensity.set(point, p.intensity);
+    d.m_returnNumber.set(point, p.return_number);
+    d.m_numberOfReturns.set(point, p.number_of_returns);
+    d.m_scanDirectionFlag.set(point, p.scan_direction_flag);
+    d.m_edgeOfFlightLine.set(point, p.edge_of_flight_line);
     uint8_t classification = p.classification | (p.synthetic_flag << 5) |
         (p.keypoint_flag << 6) | (p.withheld_flag << 7);
-    point.setField(Dimension::Id::Classification, classification);
-    point.setField(Dimension::Id::ScanAngleRank, p.scan_angle_rank);
-    point.setField(Dimension::Id::UserData, p.user_data);
-    point.setField(Dimension::Id::PointSourceId, p.point_source_ID);
+    d.m_classification.set(point, classification);
+    d.m_scanAngle.set(point, p.scan_angle_rank);
+    d.m_userData.set(point, p.user_data);
+    d.m_pointSourceId.set(point, p.point_source_ID);
 
     if (h.hasTime())
-        point.setField(Dimension::Id::GpsTime, p.gps_time);
+        d.m_gpsTime.set(point, p.gps_time);
 
     if (h.hasColor())
     {
-        point.setField(Dimension::Id::Red, p.rgb[0]);
-        point.setField(Dimension::Id::Green, p.rgb[1]);
-        point.setField(Dimension::Id::Blue, p.rgb[2]);
+        d.m_red.set(point, p.rgb[0]);
+        d.m_green.set(point, p.rgb[1]);
+        d.m_blue.set(point, p.rgb[2]);
     }
 
-    if (m_extraDims.size())
-    {
-        LeExtractor extractor((const char *)p.extra_bytes, p.num_extra_bytes);
-        loadExtraDims(extractor, point);
-    }
+    if (m_extraFields.size())
+        LasUtils::loadExtraFields(m_extraFields,
+            (const char *)p.extra_bytes, point);
 }
 #endif // PDAL_HAVE_LASZIP
 
-void LasReader::loadPointV10(PointRef& point, char *buf, size_t bufsize)
+void LasReader::loadPointV10(PointRef& point, const char *buf,
+    size_t bufsize)
 {
     LeExtractor istream(buf, bufsize);
 
@@ -764,6 +1607,7 @@ void LasReader::loadPointV10(PointRef& point, char *buf, size_t bufsize)
     istream >> xi >> yi >> zi;
 
     const LasHeader& h = m_header;
+    const LasDims& d = *m_dims;
 
     double x = xi * h.scaleX() + h.offsetX();
     double y = yi * h.scaleY() + h.offsetY();
@@ -784,37 +1628,38 @@ void LasReader::loadPointV10(PointRef& point, char *buf, size_t bufsize)
     uint8_t scanDirFlag = (flags >> 6) & 0x01;
     uint8_t flight = (flags >> 7) & 0x01;
 
-    point.setField(Dimension::Id::X, x);
-    point.setField(Dimension::Id::Y, y);
-    point.setField(Dimension::Id::Z, z);
-    point.setField(Dimension::Id::Intensity, intensity);
-    point.setField(Dimension::Id::ReturnNumber, returnNum);
-    point.setField(Dimension::Id::NumberOfReturns, numReturns);
-    point.setField(Dimension::Id::ScanDirectionFlag, scanDirFlag);
-    point.setField(Dimension::Id::EdgeOfFlightLine, flight);
-    point.setField(Dimension::Id::Classification, classification);
-    point.setField(Dimension::Id::ScanAngleRank, scanAngleRank);
-    point.setField(Dimension::Id::UserData, user);
-    point.setField(Dimension::Id::PointSourceId, pointSourceId);
+    d.m_x.set(point, x);
+    d.m_y.set(point, y);
+    d.m_z.set(point, z);
+    d.m_intensity.set(point, intensity);
+    d.m_returnNumber.set(point, returnNum);
+    d.m_numberOfReturns.set(point, numReturns);
+    d.m_scanDirectionFlag.set(point, scanDirFlag);
+    d.m_edgeOfFlightLine.set(point, flight);
+    d.m_classification.set(point, classification);
+    d.m_scanAngle.set(point, scanAngleRank);
+    d.m_userData.set(point, user);
+    d.m_pointSourceId.set(point, pointSourceId);
 
     if (h.hasTime())
     {
         double time;
         istream >> time;
-        point.setField(Dimension::Id::GpsTime, time);
+        d.m_gpsTime.set(point, time);
     }
 
     if (h.hasColor())
     {
         uint16_t red, green, blue;
         istream >> red >> green >> blue;
-        point.setField(Dimension::Id::Red, red);
-        point.setField(Dimension::Id::Green, green);
-        point.setField(Dimension::Id::Blue, blue);
+        d.m_red.set(point, red);
+        d.m_green.set(point, green);
+        d.m_blue.set(point, blue);
     }
 
-    if (m_extraDims.size())
-        loadExtraDims(istream, point);
+    if (m_extraFields.size())
+        LasUtils::loadExtraFields(m_extraFields,
+            buf + m_header.basePointLen(), point);
 }
 
 
@@ -822,50 +1667,49 @@ void LasReader::loadPointV10(PointRef& point, char *buf, size_t bufsize)
 void LasReader::loadPointV14(PointRef& point, laszip_point& p)
 {
     const LasHeader& h = m_header;
+    const LasDims& d = *m_dims;
 
     double x = p.X * h.scaleX() + h.offsetX();
     double y = p.Y * h.scaleY() + h.offsetY();
     double z = p.Z * h.scaleZ() + h.offsetZ();
 
-    point.setField(Dimension::Id::X, x);
-    point.setField(Dimension::Id::Y, y);
-    point.setField(Dimension::Id::Z, z);
-    point.setField(Dimension::Id::Intensity, p.intensity);
-    point.setField(Dimension::Id::ReturnNumber, p.extended_return_number);
-    point.setField(Dimension::Id::NumberOfReturns,
-        p.extended_number_of_returns);
-    point.setField(Dimension::Id::ClassFlags, p.extended_classification_flags);
-    point.setField(Dimension::Id::ScanChannel, p.extended_scanner_channel);
-    point.setField(Dimension::Id::ScanDirectionFlag, p.scan_direction_flag);
-    point.setField(Dimension::Id::EdgeOfFlightLine, p.edge_of_flight_line);
-    point.setField(Dimension::Id::Classification, p.extended_classification);
-    point.setField(Dimension::Id::ScanAngleRank, p.extended_scan_angle * .006);
-    point.setField(Dimension::Id::UserData, p.user_data);
-    point.setField(Dimension::Id::PointSourceId, p.point_source_ID);
-    point.setField(Dimension::Id::GpsTime, p.gps_time);
+    d.m_x.set(point, x);
+    d.m_y.set(point, y);
+    d.m_z.set(point, z);
+    d.m_intensity.set(point, p.intensity);
+    d.m_returnNumber.set(point, p.extended_return_number);
+    d.m_numberOfReturns.set(point, p.extended_number_of_returns);
+    d.m_classFlags.set(point, p.extended_classification_flags);
+    d.m_scanChannel.set(point, p.extended_scanner_channel);
+    d.m_scanDirectionFlag.set(point, p.scan_direction_flag);
+    d.m_edgeOfFlightLine.set(point, p.edge_of_flight_line);
+    d.m_classification.set(point, p.extended_classification);
+    d.m_scanAngle.set(point, (float)(p.extended_scan_angle * .006));
+    d.m_userData.set(point, p.user_data);
+    d.m_pointSourceId.set(point, p.point_source_ID);
+    d.m_gpsTime.set(point, p.gps_time);
 
     if (h.hasColor())
     {
-        point.setField(Dimension::Id::Red, p.rgb[0]);
-        point.setField(Dimension::Id::Green, p.rgb[1]);
-        point.setField(Dimension::Id::Blue, p.rgb[2]);
+        d.m_red.set(point, p.rgb[0]);
+        d.m_green.set(point, p.rgb[1]);
+        d.m_blue.set(point, p.rgb[2]);
     }
 
     if (h.hasInfrared())
     {
-        point.setField(Dimension::Id::Infrared, p.rgb[3]);
+        d.m_infrared.set(point, p.rgb[3]);
     }
 
-    if (m_extraDims.size())
-    {
-        LeExtractor extractor((const char *)p.extra_bytes, p.num_extra_bytes);
-        loadExtraDims(extractor, point);
-    }
+    if (m_extraFields.size())
+        LasUtils::loadExtraFields(m_extraFields,
+            (const char *)p.extra_bytes, point);
 }
 #endif  // PDAL_HAVE_LASZIP
 
 
-void LasReader::loadPointV14(PointRef& point, char *buf, size_t bufsize)
+void LasReader::loadPointV14(PointRef& point, const char *buf,
+    size_t bufsize)
 {
     LeExtractor istream(buf, bufsize);
 
@@ -873,6 +1717,7 @@ void LasReader::loadPointV14(PointRef& point, char *buf, size_t bufsize)
     istream >> xi >> yi >> zi;
 
     const LasHeader& h = m_header;
+    const LasDims& d = *m_dims;
 
     double x = xi * h.scaleX() + h.offsetX();
     double y = yi * h.scaleY() + h.offsetY();
@@ -897,29 +1742,29 @@ void LasReader::loadPointV14(PointRef& point, char *buf, size_t bufsize)
     uint8_t scanDirFlag = (flags >> 6) & 0x01;
     uint8_t flight = (flags >> 7) & 0x01;
 
-    point.setField(Dimension::Id::X, x);
-    point.setField(Dimension::Id::Y, y);
-    point.setField(Dimension::Id::Z, z);
-    point.setField(Dimension::Id::Intensity, intensity);
-    point.setField(Dimension::Id::ReturnNumber, returnNum);
-    point.setField(Dimension::Id::NumberOfReturns, numReturns);
-    point.setField(Dimension::Id::ClassFlags, classFlags);
-    point.setField(Dimension::Id::ScanChannel, scanChannel);
-    point.setField(Dimension::Id::ScanDirectionFlag, scanDirFlag);
-    point.setField(Dimension::Id::EdgeOfFlightLine, flight);
-    point.setField(Dimension::Id::Classification, classification);
-    point.setField(Dimension::Id::ScanAngleRank, scanAngle * .006);
-    point.setField(Dimension::Id::UserData, user);
-    point.setField(Dimension::Id::PointSourceId, pointSourceId);
-    point.setField(Dimension::Id::GpsTime, gpsTime);
+    d.m_x.set(point, x);
+    d.m_y.set(point, y);
+    d.m_z.set(point, z);
+    d.m_intensity.set(point, intensity);
+    d.m_returnNumber.set(point, returnNum);
+    d.m_numberOfReturns.set(point, numReturns);
+    d.m_classFlags.set(point, classFlags);
+    d.m_scanChannel.set(point, scanChannel);
+    d.m_scanDirectionFlag.set(point, scanDirFlag);
+    d.m_edgeOfFlightLine.set(point, flight);
+    d.m_classification.set(point, classification);
+    d.m_scanAngle.set(point, (float)(scanAngle * .006));
+    d.m_userData.set(point, user);
+    d.m_pointSourceId.set(point, pointSourceId);
+    d.m_gpsTime.set(point, gpsTime);
 
     if (h.hasColor())
     {
         uint16_t red, green, blue;
         istream >> red >> green >> blue;
-        point.setField(Dimension::Id::Red, red);
-        point.setField(Dimension::Id::Green, green);
-        point.setField(Dimension::Id::Blue, blue);
+        d.m_red.set(point, red);
+        d.m_green.set(point, green);
+        d.m_blue.set(point, blue);
     }
 
     if (h.hasInfrared())
@@ -927,41 +1772,34 @@ void LasReader::loadPointV14(PointRef& point, char *buf, size_t bufsize)
         uint16_t nearInfraRed;
 
         istream >> nearInfraRed;
-        point.setField(Dimension::Id::Infrared, nearInfraRed);
+        d.m_infrared.set(point, nearInfraRed);
     }
 
-    if (m_extraDims.size())
-        loadExtraDims(istream, point);
+    if (m_extraFields.size())
+        LasUtils::loadExtraFields(m_extraFields,
+            buf + m_header.basePointLen(), point);
 }
 
 
-void LasReader::loadExtraDims(LeExtractor& istream, PointRef& point)
+void LasReader::done(PointTableRef)
 {
-    for (auto& dim : m_extraDims)
+    // Mapped points are read up to the current point.  Otherwise the
+    // stream position is the number of bytes read from the file.
+    if (m_map.addr())
     {
-        // Dimension type of None is undefined and unprocessed
-        if (dim.m_dimType.m_type == Dimension::Type::None)
-        {
-            istream.skip(dim.m_size);
-            continue;
-        }
-
-        Everything e = Utils::extractDim(istream, dim.m_dimType.m_type);
-        if (dim.m_dimType.m_xform.nonstandard())
-        {
-            double d = Utils::toDouble(e, dim.m_dimType.m_type);
-            d = d * dim.m_dimType.m_xform.m_scale.m_val +
-                dim.m_dimType.m_xform.m_offset.m_val;
-            point.setField(dim.m_dimType.m_id, d);
-        }
-        else
-            point.setField(dim.m_dimType.m_id, dim.m_dimType.m_type, &e);
+        countIoBytes(m_header.pointOffset() + (std::min)(m_index,
+            mappedPointCount()) * m_header.pointLen());
+        FileUtils::unmapFile(m_map);
+    }
+    else if (m_streamIf)
+    {
+        std::istream *stream(m_streamIf->m_istream);
+        stream->clear();
+        std::streamoff pos = stream->tellg();
+        if (pos > 0)
+            countIoBytes(pos);
     }
-}
-
 
-void LasReader::done(PointTableRef)
-{
 #ifdef PDAL_HAVE_LASZIP
     if (m_laszip)
     {
@@ -969,6 +1807,7 @@ void LasReader::done(PointTableRef)
         handleLaszip(laszip_destroy(m_laszip));
     }
 #endif
+    m_chunkReader.reset();
     m_streamIf.reset();
 }
 
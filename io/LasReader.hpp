@@ -37,8 +37,10 @@
 #include <pdal/pdal_export.hpp>
 #include <pdal/pdal_features.hpp>
 #include <pdal/PDALUtils.hpp>
+#include <pdal/Polygon.hpp>
 #include <pdal/Reader.hpp>
 #include <pdal/Streamable.hpp>
+#include <pdal/util/FileUtils.hpp>
 
 #ifdef PDAL_HAVE_LASZIP
 #include <laszip/laszip_api.h>
@@ -57,6 +59,8 @@ namespace pdal
 
 class NitfReader;
 class LasHeader;
+struct LasDims;
+struct LasColumns;
 class LeExtractor;
 class PointDimensions;
 class LazPerfVlrDecompressor;
@@ -67,12 +71,18 @@ protected:
     class LasStreamIf
     {
     protected:
-        LasStreamIf()
+        LasStreamIf() : m_localOffset(0)
         {}
 
     public:
-        LasStreamIf(const std::string& filename)
-            { m_istream = Utils::openFile(filename); }
+        LasStreamIf(const std::string& filename, size_t readAhead = 0) :
+            m_localOffset(0)
+        {
+            m_istream = Utils::openFile(filename, true, readAhead);
+            // Only local files can be mapped.
+            if (FileUtils::fileExists(filename))
+                m_localFilename = filename;
+        }
 
         ~LasStreamIf()
         {
@@ -81,9 +91,13 @@ protected:
         }
 
         std::istream *m_istream;
+        std::string m_localFilename;
+        // Position of the LAS data in the local file.
+        uint64_t m_localOffset;
     };
 
     friend class NitfReader;
+    friend class CopcReader;
 public:
     LasReader();
     ~LasReader();
@@ -94,13 +108,16 @@ public:
         { return m_header; }
     point_count_t getNumPoints() const
         { return m_header.pointCount(); }
+    virtual point_count_t numPoints() const
+        { return getNumPoints(); }
 
 protected:
     virtual void createStream()
     {
         if (m_streamIf)
             std::cerr << "Attempt to create stream twice!\n";
-        m_streamIf.reset(new LasStreamIf(m_filename));
+        m_streamIf.reset(new LasStreamIf(m_filename,
+            m_readAhead * 1024 * 1024));
         if (!m_streamIf->m_istream)
         {
             std::ostringstream oss;
@@ -113,7 +130,10 @@ protected:
     std::unique_ptr<LasStreamIf> m_streamIf;
 
 private:
+    class ChunkReader;
     typedef std::vector<LasUtils::IgnoreVLR> IgnoreVLRList;
+    // Ranges of point indices, [first, second).
+    typedef std::vector<std::pair<point_count_t, point_count_t>> IntervalList;
 
     LasHeader m_header;
     laszip_POINTER m_laszip;
@@ -121,19 +141,41 @@ private:
 
     LazPerfVlrDecompressor *m_decompressor;
     std::vector<char> m_decompressorBuf;
+    std::unique_ptr<ChunkReader> m_chunkReader;
+    FileUtils::MapContext m_map;
+    size_t m_readAhead;
+    int m_threads;
     point_count_t m_index;
     StringList m_extraDimSpec;
     std::vector<ExtraDim> m_extraDims;
+    LasUtils::ExtraFieldList m_extraFields;
     IgnoreVLRList m_ignoreVLRs;
     std::string m_compression;
     StringList m_ignoreVLROption;
     bool m_useEbVlr;
+    std::unique_ptr<LasDims> m_dims;
+    std::unique_ptr<LasColumns> m_columns;
+    // Whether the table stores X, Y and Z scaled as they are in the file.
+    bool m_rawXYZ;
+    BOX3D m_queryBounds;
+    Bounds m_bounds;
+    std::vector<Polygon> m_polys;
+    IntervalList m_intervals;
+    size_t m_interval;
+    point_count_t m_readPos;
+    point_count_t m_sample;
+    PointSelection m_selection;
 
     virtual void addArgs(ProgramArgs& args);
     virtual void initialize(PointTableRef table)
         { initializeLocal(table, m_metadata); }
     virtual void initializeLocal(PointTableRef table, MetadataNode& m);
     virtual void addDimensions(PointLayoutPtr layout);
+    virtual bool dimensionsUsed(PointLayoutPtr, Dimension::IdList&) const
+        { return true; }
+    virtual void restrictBounds(const BOX3D& bounds)
+        { m_queryBounds = bounds; }
+    virtual bool restrictSelection(const PointSelection& selection);
     virtual QuickInfo inspect();
     virtual void ready(PointTableRef table);
     virtual point_count_t read(PointViewPtr view, point_count_t count);
@@ -147,13 +189,28 @@ private:
     void readExtraBytesVlr();
     void extractHeaderMetadata(MetadataNode& forward, MetadataNode& m);
     void extractVlrMetadata(MetadataNode& forward, MetadataNode& m);
+    void readIndex();
+    void sampleIntervals();
+    virtual bool selectPoints(const BOX3D& bounds, IntervalList& intervals);
+    point_count_t nextInterval(point_count_t end);
+    point_count_t nextRun(point_count_t end);
+    void seekPoint();
+    bool loadNext(PointRef& point);
+    bool inBounds(int32_t xi, int32_t yi, int32_t zi) const;
+    bool inBounds(const char *buf) const;
     void loadPoint(PointRef& point, laszip_point& p);
     void loadPointV10(PointRef& point, laszip_point& p);
     void loadPointV14(PointRef& point, laszip_point& p);
-    void loadPoint(PointRef& point, char *buf, size_t bufsize);
-    void loadPointV10(PointRef& point, char *buf, size_t bufsize);
-    void loadPointV14(PointRef& point, char *buf, size_t bufsize);
-    void loadExtraDims(LeExtractor& istream, PointRef& data);
+    void loadPoint(PointRef& point, const char *buf, size_t bufsize);
+    void loadPointV10(PointRef& point, const char *buf, size_t bufsize);
+    void loadPointV14(PointRef& point, const char *buf, size_t bufsize);
+    point_count_t loadPoints(PointView& view, const char *buf,
+        point_count_t count);
+    template<int FORMAT>
+    void loadColumns(PointView& view, PointId begin, const char *buf,
+        point_count_t count);
+    const char *mappedPoint(PointId idx) const;
+    point_count_t mappedPointCount() const;
     point_count_t readFileBlock(std::vector<char>& buf,
         point_count_t maxPoints);
     void handleLaszip(int result);
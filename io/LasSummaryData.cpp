@@ -67,6 +67,23 @@ void LasSummaryData::addPoint(double x, double y, double z, int returnNumber)
 }
 
 
+void LasSummaryData::addHeader(const LasHeader& header)
+{
+    if (header.pointCount() == 0)
+        return;
+
+    m_totalNumPoints += header.pointCount();
+    m_minX = (std::min)(m_minX, header.minX());
+    m_minY = (std::min)(m_minY, header.minY());
+    m_minZ = (std::min)(m_minZ, header.minZ());
+    m_maxX = (std::max)(m_maxX, header.maxX());
+    m_maxY = (std::max)(m_maxY, header.maxY());
+    m_maxZ = (std::max)(m_maxZ, header.maxZ());
+    for (size_t i = 0; i < m_returnCounts.size(); ++i)
+        m_returnCounts[i] += header.pointCountByReturn(i);
+}
+
+
 BOX3D LasSummaryData::getBounds() const
 {
     BOX3D output(m_minX, m_minY, m_minZ, m_maxX, m_maxY, m_maxZ);
@@ -56,6 +56,9 @@ public:
     LasSummaryData();
 
     void addPoint(double x, double y, double z, int returnNumber);
+    // Add the points described by a header, so that the summary of points
+    // appended to a file covers all of the file's points.
+    void addHeader(const LasHeader& header);
     point_count_t getTotalNumPoints() const
         { return m_totalNumPoints; }
     BOX3D getBounds() const;
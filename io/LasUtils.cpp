@@ -34,6 +34,9 @@
 
 #include "LasUtils.hpp"
 
+#include <pdal/PDALUtils.hpp>
+#include <pdal/PointView.hpp>
+#include <pdal/util/ByteSwap.hpp>
 #include <pdal/util/Extractor.hpp>
 #include <pdal/util/Inserter.hpp>
 #include <pdal/util/Utils.hpp>
@@ -51,6 +54,46 @@ namespace
         DT::Unsigned32, DT::Signed32, DT::Unsigned64, DT::Signed64,
         DT::Float, DT::Double
     };
+
+    // Extra bytes are little-endian.
+    const bool swapExtraBytes = (le16toh(1) != 1);
+
+    // Gather a field of consecutive records into a column and set it in
+    // the view.  The view copies the column as a block when the field has
+    // the type of the dimension.
+    template<typename T>
+    void loadColumn(const LasUtils::ExtraField& f, const char *buf,
+        size_t stride, PointView& view, PointId begin, point_count_t count)
+    {
+        std::vector<T> col(count);
+        buf += f.m_pos;
+        for (point_count_t i = 0; i < count; ++i)
+            memcpy(&col[i], buf + i * stride, sizeof(T));
+        if (swapExtraBytes)
+            Utils::byteSwap(col.data(), col.data(), sizeof(T), count);
+        if (f.m_scaled)
+        {
+            std::vector<double> d(count);
+            for (point_count_t i = 0; i < count; ++i)
+                d[i] = col[i] * f.m_scale + f.m_offset;
+            view.setFieldArray(f.m_id, begin, count, d.data());
+        }
+        else
+            view.setFieldArray(f.m_id, begin, count, col.data());
+    }
+
+    template<typename T>
+    void fillColumn(const LasUtils::ExtraField& f, const PointView& view,
+        PointId begin, point_count_t count, char *buf, size_t stride)
+    {
+        std::vector<T> col(count);
+        view.getFieldArray(f.m_id, begin, count, col.data());
+        if (swapExtraBytes)
+            Utils::byteSwap(col.data(), col.data(), sizeof(T), count);
+        buf += f.m_pos;
+        for (point_count_t i = 0; i < count; ++i)
+            memcpy(buf + i * stride, &col[i], sizeof(T));
+    }
 }
 
 uint8_t ExtraBytesIf::lasType()
@@ -180,6 +223,146 @@ std::vector<ExtraDim> ExtraBytesIf::toExtraDims()
 namespace LasUtils
 {
 
+// Fields with no type, and those whose dimension isn't in the layout,
+// are skipped.
+ExtraFieldList extraFields(const std::vector<ExtraDim>& dims,
+    const PointLayout& layout)
+{
+    ExtraFieldList fields;
+    size_t pos = 0;
+    for (const ExtraDim& dim : dims)
+    {
+        const DimType& dt = dim.m_dimType;
+        if (dt.m_type == Dimension::Type::None)
+        {
+            pos += dim.m_size;
+            continue;
+        }
+        if (layout.hasDim(dt.m_id))
+        {
+            ExtraField f;
+            f.m_id = dt.m_id;
+            f.m_type = dt.m_type;
+            f.m_pos = pos;
+            f.m_scaled = dt.m_xform.nonstandard();
+            f.m_scale = dt.m_xform.m_scale.m_val;
+            f.m_offset = dt.m_xform.m_offset.m_val;
+            fields.push_back(f);
+        }
+        pos += Dimension::size(dt.m_type);
+    }
+    return fields;
+}
+
+
+void loadExtraFields(const ExtraFieldList& fields, const char *buf,
+    PointRef& point)
+{
+    for (const ExtraField& f : fields)
+    {
+        LeExtractor in(buf + f.m_pos, Dimension::size(f.m_type));
+        Everything e = Utils::extractDim(in, f.m_type);
+        if (f.m_scaled)
+            point.setField(f.m_id,
+                Utils::toDouble(e, f.m_type) * f.m_scale + f.m_offset);
+        else
+            point.setField(f.m_id, f.m_type, &e);
+    }
+}
+
+
+// Load the extra bytes of 'count' records, 'stride' bytes apart, a field
+// at a time.
+void loadExtraFields(const ExtraFieldList& fields, const char *buf,
+    size_t stride, PointView& view, PointId begin, point_count_t count)
+{
+    for (const ExtraField& f : fields)
+    {
+        switch (f.m_type)
+        {
+        case Dimension::Type::Unsigned8:
+            loadColumn<uint8_t>(f, buf, stride, view, begin, count);
+            break;
+        case Dimension::Type::Signed8:
+            loadColumn<int8_t>(f, buf, stride, view, begin, count);
+            break;
+        case Dimension::Type::Unsigned16:
+            loadColumn<uint16_t>(f, buf, stride, view, begin, count);
+            break;
+        case Dimension::Type::Signed16:
+            loadColumn<int16_t>(f, buf, stride, view, begin, count);
+            break;
+        case Dimension::Type::Unsigned32:
+            loadColumn<uint32_t>(f, buf, stride, view, begin, count);
+            break;
+        case Dimension::Type::Signed32:
+            loadColumn<int32_t>(f, buf, stride, view, begin, count);
+            break;
+        case Dimension::Type::Unsigned64:
+            loadColumn<uint64_t>(f, buf, stride, view, begin, count);
+            break;
+        case Dimension::Type::Signed64:
+            loadColumn<int64_t>(f, buf, stride, view, begin, count);
+            break;
+        case Dimension::Type::Float:
+            loadColumn<float>(f, buf, stride, view, begin, count);
+            break;
+        case Dimension::Type::Double:
+            loadColumn<double>(f, buf, stride, view, begin, count);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+
+// Write the extra bytes of 'count' records, 'stride' bytes apart, a field
+// at a time.
+void fillExtraFields(const ExtraFieldList& fields, const PointView& view,
+    PointId begin, point_count_t count, char *buf, size_t stride)
+{
+    for (const ExtraField& f : fields)
+    {
+        switch (f.m_type)
+        {
+        case Dimension::Type::Unsigned8:
+            fillColumn<uint8_t>(f, view, begin, count, buf, stride);
+            break;
+        case Dimension::Type::Signed8:
+            fillColumn<int8_t>(f, view, begin, count, buf, stride);
+            break;
+        case Dimension::Type::Unsigned16:
+            fillColumn<uint16_t>(f, view, begin, count, buf, stride);
+            break;
+        case Dimension::Type::Signed16:
+            fillColumn<int16_t>(f, view, begin, count, buf, stride);
+            break;
+        case Dimension::Type::Unsigned32:
+            fillColumn<uint32_t>(f, view, begin, count, buf, stride);
+            break;
+        case Dimension::Type::Signed32:
+            fillColumn<int32_t>(f, view, begin, count, buf, stride);
+            break;
+        case Dimension::Type::Unsigned64:
+            fillColumn<uint64_t>(f, view, begin, count, buf, stride);
+            break;
+        case Dimension::Type::Signed64:
+            fillColumn<int64_t>(f, view, begin, count, buf, stride);
+            break;
+        case Dimension::Type::Float:
+            fillColumn<float>(f, view, begin, count, buf, stride);
+            break;
+        case Dimension::Type::Double:
+            fillColumn<double>(f, view, begin, count, buf, stride);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+
 std::vector<IgnoreVLR> parseIgnoreVLRs(const StringList& ignored)
 {
     std::vector<IgnoreVLR> ignoredVLRs;
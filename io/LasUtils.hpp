@@ -41,6 +41,10 @@
 namespace pdal
 {
 
+class PointLayout;
+class PointRef;
+class PointView;
+
 enum class LasCompression
 {
     LasZip,
@@ -173,6 +177,29 @@ struct error : public std::runtime_error
 
 std::vector<ExtraDim> parse(const StringList& dimString, bool allOk);
 
+// An extra-bytes field of a point record, laid out once the dimensions of
+// the table are known so that fields are copied without looking up the
+// extra dimensions for each point.
+struct ExtraField
+{
+    Dimension::Id m_id;
+    Dimension::Type m_type;  // Type of the field in the record.
+    size_t m_pos;  // Position of the field in the extra bytes.
+    bool m_scaled;
+    double m_scale;
+    double m_offset;
+};
+typedef std::vector<ExtraField> ExtraFieldList;
+
+ExtraFieldList extraFields(const std::vector<ExtraDim>& dims,
+    const PointLayout& layout);
+void loadExtraFields(const ExtraFieldList& fields, const char *buf,
+    PointRef& point);
+void loadExtraFields(const ExtraFieldList& fields, const char *buf,
+    size_t stride, PointView& view, PointId begin, point_count_t count);
+void fillExtraFields(const ExtraFieldList& fields, const PointView& view,
+    PointId begin, point_count_t count, char *buf, size_t stride);
+
 
 struct IgnoreVLR
 {
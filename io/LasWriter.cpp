@@ -52,8 +52,11 @@
 
 #include "LasWriter.hpp"
 
+#include <algorithm>
 #include <climits>
 #include <iostream>
+#include <numeric>
+#include <thread>
 #include <vector>
 
 #include <json/json.h>
@@ -70,6 +73,8 @@
 #include <pdal/util/ProgramArgs.hpp>
 
 #include "GeotiffSupport.hpp"
+#include "private/LasDims.hpp"
+#include "private/LaxIndex.hpp"
 
 namespace pdal
 {
@@ -89,7 +94,9 @@ CREATE_STATIC_STAGE(LasWriter, s_info)
 std::string LasWriter::getName() const { return s_info.name; }
 
 LasWriter::LasWriter() : m_compressor(nullptr), m_ostream(NULL),
-    m_compression(LasCompression::None), m_srsCnt(0),
+    m_dims(new LasDims), m_layout(nullptr), m_rawXYZ(false),
+    m_compression(LasCompression::None), m_threads(1),
+    m_spatialIndex(false), m_append(false), m_indexCount(0), m_srsCnt(0),
     m_userVLRs(new Json::Value())
 {}
 
@@ -148,6 +155,12 @@ void LasWriter::addArgs(ProgramArgs& args)
     args.add("offset_y", "Y offset", m_offsetY);
     args.add("offset_z", "Z offset", m_offsetZ);
     args.add("vlrs", "List of VLRs to set", *m_userVLRs);
+    args.add("threads", "Number of threads used to compress LAZ data with "
+        "LAZperf. 0 uses all available cores.", m_threads, 1);
+    args.add("spatial_index", "Order points spatially and write a LAStools "
+        "spatial index (.lax) file", m_spatialIndex);
+    args.add("append", "Add the points to the end of an existing file "
+        "instead of replacing it", m_append);
 }
 
 void LasWriter::initialize()
@@ -155,7 +168,19 @@ void LasWriter::initialize()
     std::string ext = FileUtils::extension(m_filename);
     ext = Utils::tolower(ext);
     if ((ext == ".laz") && (m_compression == LasCompression::None))
+    {
+#ifdef PDAL_HAVE_LAZPERF
+        // Only LAZperf output can be compressed by multiple threads.
+        m_compression = (m_threads == 1) ?
+            LasCompression::LasZip : LasCompression::LazPerf;
+#else
         m_compression = LasCompression::LasZip;
+#endif
+    }
+    if (m_compression == LasCompression::LasZip && m_threads != 1)
+        log()->get(LogLevel::Warning) << getName() << ": LASzip compression "
+            "uses a single thread.  Set 'compression' to 'lazperf' to "
+            "compress with multiple threads." << std::endl;
 
     if (!m_aSrs.empty())
         setSpatialReference(m_aSrs);
@@ -175,6 +200,8 @@ void LasWriter::initialize()
         throwError(err.what());
     }
     fillForwardList();
+    if (m_append && m_spatialIndex)
+        throwError("Can't write a spatial index when appending to a file.");
 }
 
 
@@ -190,6 +217,9 @@ void LasWriter::spatialReferenceChanged(const SpatialReference&)
 void LasWriter::prepared(PointTableRef table)
 {
     FlexWriter::validateFilename(table);
+    if (m_spatialIndex && !table.supportsView())
+        throwError("Can't write a spatial index using streaming point "
+            "table.");
 
     PointLayoutPtr layout = table.layout();
 
@@ -225,6 +255,7 @@ void LasWriter::prepared(PointTableRef table)
             "(" << Dimension::interpretationName(dim.m_dimType.m_type) <<
             ") " << " to LAS extra bytes." << std::endl;
     }
+    m_extraFields = LasUtils::extraFields(m_extraDims, *table.layout());
 }
 
 
@@ -308,6 +339,8 @@ void LasWriter::fillForwardList()
 
 void LasWriter::readyTable(PointTableRef table)
 {
+    m_dims->resolve(*table.layout());
+    m_layout = table.layout();
     m_firstPoint = true;
     m_forwardMetadata = table.privateMetadata("lasforward");
     if(m_writePDALMetadata)
@@ -325,7 +358,19 @@ void LasWriter::readyTable(PointTableRef table)
 void LasWriter::readyFile(const std::string& filename,
     const SpatialReference& srs)
 {
-    std::ostream *out = Utils::createFile(filename, true);
+    if (m_append)
+    {
+        if (Utils::isRemote(filename) || Utils::toupper(filename) == "STDOUT")
+            throwError("Can't append to '" + filename + "'.  Only local "
+                "files can be appended to.");
+        if (FileUtils::fileExists(filename))
+        {
+            readyAppend(filename, srs);
+            return;
+        }
+    }
+
+    std::ostream *out = createFile(filename);
     if (!out)
         throwError("Couldn't open file '" + filename + "' for output.");
     m_curFilename = filename;
@@ -349,6 +394,8 @@ void LasWriter::prepOutput(std::ostream *outStream, const SpatialReference& srs)
     addSpatialRefVlrs();
 
     m_summaryData.reset(new LasSummaryData());
+    m_laxIndex.reset();
+    m_indexCount = 0;
     m_ostream = outStream;
     if (m_lasHeader.compressed())
         readyCompression();
@@ -382,6 +429,195 @@ void LasWriter::prepOutput(std::ostream *outStream, const SpatialReference& srs)
 }
 
 
+// The writer's settings that are replaced by those of a file that points
+// are appended to.  They're restored once the file is done.
+struct LasWriter::AppendState
+{
+    LasHeader m_header;
+    LasCompression m_compression;
+    Scaling m_scaling;
+    std::vector<ExtLasVLR> m_eVlrs;
+    std::streamoff m_start;
+};
+
+
+// Ready an existing file so that points are written after the ones it
+// holds.  The file keeps its header, VLRs, point format and scaling.
+// Whatever follows the points (extended VLRs and the chunk table of LAZ
+// data) is cut from the file and written again when the file is done, so
+// only the new points are written.  In LAZ data, a last chunk that isn't
+// full is compressed again along with the new points, so that all
+// chunks but the last still hold the same number of points.
+void LasWriter::readyAppend(const std::string& filename,
+    const SpatialReference& srs)
+{
+    std::istream *in = Utils::openFile(filename);
+    if (!in)
+        throwError("Couldn't open file '" + filename + "' to append to.");
+    auto fail = [this, &in, &filename](const std::string& err)
+    {
+        Utils::closeFile(in);
+        throwError("Can't append to '" + filename + "'.  " + err);
+    };
+
+    LasHeader header;
+    header.setLog(log());
+    try
+    {
+        ILeStream lin(in);
+        lin >> header;
+    }
+    catch (const LasHeader::error& err)
+    {
+        fail(err.what());
+    }
+    if (!header.pointFormatSupported())
+        fail("Unsupported point format " +
+            Utils::toString((int)header.pointFormat()) + ".");
+    if (header.pointLen() != header.basePointLen() + m_extraByteLen)
+        fail("Its points are " + Utils::toString(header.pointLen()) +
+            " bytes long but points with the extra dimensions being written "
+            "are " + Utils::toString(header.basePointLen() + m_extraByteLen) +
+            " bytes long.");
+
+    std::streamoff appendPos = header.pointOffset() +
+        (std::streamoff)(header.pointCount() * header.pointLen());
+    // Sizes of the LAZ chunks kept and the points of a partial last chunk.
+    std::vector<uint32_t> chunks;
+    std::vector<char> points;
+    if (header.compressed())
+    {
+#ifdef PDAL_HAVE_LAZPERF
+        if (header.versionAtLeast(1, 4))
+            fail("Can't write version 1.4 output with LAZperf.");
+        const LasVLR *vlr = header.findVlr(LASZIP_USER_ID, LASZIP_RECORD_ID);
+        if (!vlr)
+            fail("The file has no LASzip VLR.");
+        LazPerfVlrChunkDecompressor decompressor(vlr->data());
+        const uint32_t chunkSize = decompressor.chunkSize();
+        if (chunkSize == 0)
+            fail("Its compressed chunks vary in size.");
+        if (decompressor.pointSize() != header.pointLen())
+            fail("The point size of its compressed data doesn't match "
+                "its header.");
+
+        const point_count_t count = header.pointCount();
+        const size_t numChunks = (size_t)((count + chunkSize - 1) / chunkSize);
+        chunks = LazPerfVlrChunkDecompressor::readChunkTable(*in,
+            header.pointOffset());
+        if (chunks.size() < numChunks)
+            fail("Its chunk table is missing or incomplete.");
+        chunks.resize(numChunks);
+
+        appendPos = header.pointOffset() + sizeof(uint64_t);
+        for (uint32_t size : chunks)
+            appendPos += size;
+        const uint32_t last = (uint32_t)(count % chunkSize);
+        if (last)
+        {
+            std::vector<char> buf(chunks.back());
+            appendPos -= chunks.back();
+            chunks.pop_back();
+            in->clear();
+            in->seekg(appendPos);
+            in->read(buf.data(), buf.size());
+            if (!*in)
+                fail("Couldn't read its last compressed chunk.");
+            points.resize((size_t)last * header.pointLen());
+            decompressor.decompress(buf, points.data(), last);
+        }
+#else
+        fail("PDAL not built with LAZperf, which is needed to append to "
+            "LAZ files.");
+#endif
+    }
+    if (FileUtils::fileSize(filename) < (uintmax_t)appendPos)
+        fail("The file is shorter than its header says.");
+
+    std::vector<ExtLasVLR> eVlrs;
+    const VlrList& vlrs = header.vlrs();
+    for (size_t i = header.vlrCount(); i < vlrs.size(); ++i)
+    {
+        const LasVLR& v = vlrs[i];
+        std::vector<uint8_t> data(v.data(), v.data() + v.dataLen());
+        eVlrs.emplace_back(v.userId(), v.recordId(), v.description(), data);
+    }
+    Utils::closeFile(in);
+
+    const SpatialReference& outSrs = getSpatialReference().empty() ?
+        srs : getSpatialReference();
+    if (!outSrs.empty() && !header.srs().empty() && outSrs != header.srs())
+        log()->get(LogLevel::Warning) << getName() << ": The spatial "
+            "reference of the points appended to '" << filename << "' "
+            "differs from that of the file.  The file's is kept." <<
+            std::endl;
+
+    FileUtils::resizeFile(filename, appendPos);
+    std::ostream *out = FileUtils::openForUpdate(filename);
+    if (!out)
+        throwError("Couldn't open file '" + filename + "' to append to.");
+    out->seekp(appendPos);
+
+    m_appendState.reset(new AppendState { m_lasHeader, m_compression,
+        m_scaling, std::move(m_eVlrs), appendPos });
+    m_lasHeader = header;
+    m_eVlrs = std::move(eVlrs);
+    m_compression = header.compressed() ?
+        LasCompression::LazPerf : LasCompression::None;
+
+    auto fixXForm = [](XForm& xform, double scale, double offset)
+    {
+        xform.m_scale = XForm::XFormComponent(scale);
+        xform.m_offset = XForm::XFormComponent(offset);
+    };
+    fixXForm(m_scaling.m_xXform, header.scaleX(), header.offsetX());
+    fixXForm(m_scaling.m_yXform, header.scaleY(), header.offsetY());
+    fixXForm(m_scaling.m_zXform, header.scaleZ(), header.offsetZ());
+    setRawXYZ();
+
+    m_srs = header.srs();
+    m_summaryData.reset(new LasSummaryData());
+    m_summaryData->addHeader(header);
+    m_laxIndex.reset();
+    m_indexCount = 0;
+    m_ostream = out;
+    m_curFilename = filename;
+    Utils::writeProgress(m_progressFd, "READYFILE", filename);
+    m_pointBuf.resize(m_lasHeader.pointLen());
+
+#ifdef PDAL_HAVE_LAZPERF
+    if (m_compression == LasCompression::LazPerf)
+    {
+        const LasVLR *vlr =
+            m_lasHeader.findVlr(LASZIP_USER_ID, LASZIP_RECORD_ID);
+        laszip::io::laz_vlr zipvlr(vlr->data());
+
+        delete m_compressor;
+        int threads = m_threads ? m_threads :
+            (int)(std::max)(std::thread::hardware_concurrency(), 1u);
+        m_compressor = new LazPerfVlrCompressor(*m_ostream,
+            laszip::io::laz_vlr::to_schema(zipvlr), zipvlr.chunk_size,
+            threads);
+        m_compressor->resume(m_lasHeader.pointOffset(), chunks);
+        for (size_t pos = 0; pos < points.size();
+                pos += m_lasHeader.pointLen())
+            m_compressor->compress(points.data() + pos);
+    }
+#endif
+}
+
+
+// Put back the writer's settings once a file that was appended to is done.
+void LasWriter::finishAppend()
+{
+    m_lasHeader = m_appendState->m_header;
+    m_compression = m_appendState->m_compression;
+    m_scaling = m_appendState->m_scaling;
+    m_eVlrs = std::move(m_appendState->m_eVlrs);
+    m_appendState.reset();
+}
+
+
 /// Search for metadata associated with the provided recordId and userId.
 /// \param  node - Top-level node to use for metadata search.
 /// \param  recordId - Record ID to match.
@@ -655,6 +891,9 @@ void LasWriter::fillHeader()
     {
         throwError(err.what());
     }
+
+    setRawXYZ();
+
     m_lasHeader.setVlrCount(m_vlrs.size());
     m_lasHeader.setEVlrCount(m_eVlrs.size());
 
@@ -680,6 +919,22 @@ void LasWriter::fillHeader()
 }
 
 
+// When the table stores X, Y and Z scaled as they're written, the
+// stored integers are copied as they are.
+void LasWriter::setRawXYZ()
+{
+    auto sameScaling = [this](Dimension::Id dim, const XForm& xform)
+    {
+        const Dimension::Detail *dd = m_layout->dimDetail(dim);
+        return dd->scaled() && dd->xform().sameAs(xform);
+    };
+    m_rawXYZ = m_layout &&
+        sameScaling(Dimension::Id::X, m_scaling.m_xXform) &&
+        sameScaling(Dimension::Id::Y, m_scaling.m_yXform) &&
+        sameScaling(Dimension::Id::Z, m_scaling.m_zXform);
+}
+
+
 void LasWriter::readyCompression()
 {
     deleteVlr(LASZIP_USER_ID, LASZIP_RECORD_ID);
@@ -740,8 +995,10 @@ void LasWriter::readyLazPerfCompression()
     addVlr(LASZIP_USER_ID, LASZIP_RECORD_ID, "http://laszip.org", data);
 
     delete m_compressor;
+    int threads = m_threads ? m_threads :
+        (int)(std::max)(std::thread::hardware_concurrency(), 1u);
     m_compressor = new LazPerfVlrCompressor(*m_ostream, schema,
-        zipvlr.chunk_size);
+        zipvlr.chunk_size, threads);
 #endif
 }
 
@@ -838,26 +1095,34 @@ void LasWriter::writeView(const PointViewPtr view)
 
     point_count_t pointLen = m_lasHeader.pointLen();
 
+    std::vector<uint32_t> cells;
+    PointViewPtr v = m_spatialIndex ? spatialOrder(view, cells) : view;
+
     // Since we use the LASzip API, we can't benefit from building
     // a buffer of multiple points, so loop.
     if (m_compression == LasCompression::LasZip)
     {
-        PointRef point(*view, 0);
-        for (PointId idx = 0; idx < view->size(); ++idx)
+        PointRef point(*v, 0);
+        for (PointId idx = 0; idx < v->size(); ++idx)
         {
             point.setPointId(idx);
-            processPoint(point);
+            if (processPoint(point) && m_laxIndex)
+                m_laxIndex->add(cells[idx], m_indexCount++);
         }
     }
     else
     {
         // Make a buffer of at most a meg.
         m_pointBuf.resize((std::min)((point_count_t)1000000,
-                    pointLen * view->size()));
+                    pointLen * v->size()));
+
+        const PointView& viewRef(*v.get());
 
-        const PointView& viewRef(*view.get());
+        if (m_laxIndex)
+            for (uint32_t cell : cells)
+                m_laxIndex->add(cell, m_indexCount++);
 
-        point_count_t remaining = view->size();
+        point_count_t remaining = v->size();
         PointId idx = 0;
         while (remaining)
         {
@@ -876,6 +1141,80 @@ void LasWriter::writeView(const PointViewPtr view)
 }
 
 
+// Order the points of a view by the cell of the spatial index that holds
+// them, so that each cell's points are written together.  The index is
+// created with the bounds of the first view written to a file.  Points
+// outside of those bounds are put in the cells at the edges.
+PointViewPtr LasWriter::spatialOrder(const PointViewPtr view,
+    std::vector<uint32_t>& cells)
+{
+    if (view->empty())
+        return view;
+
+    if (!m_laxIndex)
+    {
+        BOX2D bounds;
+        view->calculateBounds(bounds);
+
+        // Use cells that hold a few thousand points on average.
+        uint32_t levels = 1;
+        while (levels < 10 && (point_count_t)5000 << (2 * levels) <
+                view->size())
+            levels++;
+        m_laxIndex.reset(new LaxIndex(bounds, levels));
+    }
+
+    const point_count_t n = view->size();
+    std::vector<double> xs(n);
+    std::vector<double> ys(n);
+    view->getFieldArray(Dimension::Id::X, 0, n, xs.data());
+    view->getFieldArray(Dimension::Id::Y, 0, n, ys.data());
+
+    std::vector<uint32_t> viewCells(n);
+    for (PointId i = 0; i < n; ++i)
+        viewCells[i] = m_laxIndex->cell(xs[i], ys[i]);
+
+    std::vector<PointId> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+        [&viewCells](PointId a, PointId b)
+        { return viewCells[a] < viewCells[b]; });
+
+    PointViewPtr sorted = view->makeNew();
+    cells.resize(n);
+    for (PointId i = 0; i < n; ++i)
+    {
+        sorted->appendPoint(*view, order[i]);
+        cells[i] = viewCells[order[i]];
+    }
+    return sorted;
+}
+
+
+// Write the spatial index next to the output file.
+void LasWriter::writeSpatialIndex()
+{
+    if (!m_laxIndex)
+        return;
+
+    if (Utils::toupper(m_curFilename) == "STDOUT")
+    {
+        log()->get(LogLevel::Warning) << getName() << ": Can't write a "
+            "spatial index for standard output." << std::endl;
+        return;
+    }
+
+    std::string laxFilename = m_curFilename.substr(0, m_curFilename.size() -
+        FileUtils::extension(m_curFilename).size()) + ".lax";
+    std::ostream *out = Utils::createFile(laxFilename, true);
+    if (!out)
+        throwError("Couldn't open file '" + laxFilename + "' for output.");
+    m_laxIndex->write(*out);
+    Utils::closeFile(out);
+    m_laxIndex.reset();
+}
+
+
 bool LasWriter::writeLasZipBuf(PointRef& point)
 {
 #ifdef PDAL_HAVE_LASZIP
@@ -1023,20 +1362,24 @@ void LasWriter::writeLazPerfBuf(char *pos, size_t pointLen,
 }
 
 
-bool LasWriter::fillPointBuf(PointRef& point, LeInserter& ostream)
+// The extra bytes are skipped rather than written if 'extraBytes' isn't
+// set.
+bool LasWriter::fillPointBuf(PointRef& point, LeInserter& ostream,
+    bool extraBytes)
 {
     bool has14Format = m_lasHeader.has14Format();
     static const size_t maxReturnCount = m_lasHeader.maxReturnCount();
 
     // we always write the base fields
     using namespace Dimension;
+    const LasDims& d = *m_dims;
 
     uint8_t returnNumber(1);
     uint8_t numberOfReturns(1);
     if (point.hasDim(Id::ReturnNumber))
-        returnNumber = point.getFieldAs<uint8_t>(Id::ReturnNumber);
+        returnNumber = d.m_returnNumber.get(point);
     if (point.hasDim(Id::NumberOfReturns))
-        numberOfReturns = point.getFieldAs<uint8_t>(Id::NumberOfReturns);
+        numberOfReturns = d.m_numberOfReturns.get(point);
     if (numberOfReturns > maxReturnCount)
     {
         if (m_discardHighReturnNumbers)
@@ -1060,31 +1403,41 @@ bool LasWriter::fillPointBuf(PointRef& point, LeInserter& ostream)
         return i;
     };
 
-    double xOrig = point.getFieldAs<double>(Id::X);
-    double yOrig = point.getFieldAs<double>(Id::Y);
-    double zOrig = point.getFieldAs<double>(Id::Z);
-    double x = m_scaling.m_xXform.toScaled(xOrig);
-    double y = m_scaling.m_yXform.toScaled(yOrig);
-    double z = m_scaling.m_zXform.toScaled(zOrig);
-
-    ostream << converter(x, Id::X);
-    ostream << converter(y, Id::Y);
-    ostream << converter(z, Id::Z);
+    double xOrig, yOrig, zOrig;
+    if (m_rawXYZ)
+    {
+        int32_t x = point.getScaledField(Id::X);
+        int32_t y = point.getScaledField(Id::Y);
+        int32_t z = point.getScaledField(Id::Z);
+        ostream << x << y << z;
+        xOrig = m_scaling.m_xXform.fromScaled(x);
+        yOrig = m_scaling.m_yXform.fromScaled(y);
+        zOrig = m_scaling.m_zXform.fromScaled(z);
+    }
+    else
+    {
+        xOrig = d.m_x.get(point);
+        yOrig = d.m_y.get(point);
+        zOrig = d.m_z.get(point);
+        ostream << converter(m_scaling.m_xXform.toScaled(xOrig), Id::X);
+        ostream << converter(m_scaling.m_yXform.toScaled(yOrig), Id::Y);
+        ostream << converter(m_scaling.m_zXform.toScaled(zOrig), Id::Z);
+    }
 
-    ostream << point.getFieldAs<uint16_t>(Id::Intensity);
+    ostream << d.m_intensity.get(point);
 
-    uint8_t scanChannel = point.getFieldAs<uint8_t>(Id::ScanChannel);
+    uint8_t scanChannel = d.m_scanChannel.get(point);
     uint8_t scanDirectionFlag =
-        point.getFieldAs<uint8_t>(Id::ScanDirectionFlag);
+        d.m_scanDirectionFlag.get(point);
     uint8_t edgeOfFlightLine =
-        point.getFieldAs<uint8_t>(Id::EdgeOfFlightLine);
+        d.m_edgeOfFlightLine.get(point);
 
     if (has14Format)
     {
         uint8_t bits = returnNumber | (numberOfReturns << 4);
         ostream << bits;
 
-        uint8_t classFlags = point.getFieldAs<uint8_t>(Id::ClassFlags);
+        uint8_t classFlags = d.m_classFlags.get(point);
         bits = (classFlags & 0x0F) |
             ((scanChannel & 0x03) << 4) |
             ((scanDirectionFlag & 0x01) << 6) |
@@ -1098,44 +1451,50 @@ bool LasWriter::fillPointBuf(PointRef& point, LeInserter& ostream)
         ostream << bits;
     }
 
-    ostream << point.getFieldAs<uint8_t>(Id::Classification);
+    ostream << d.m_classification.get(point);
 
-    uint8_t userData = point.getFieldAs<uint8_t>(Id::UserData);
+    uint8_t userData = d.m_userData.get(point);
     if (has14Format)
     {
          // Guaranteed to fit if scan angle rank isn't wonky.
         int16_t scanAngleRank =
             static_cast<int16_t>(std::round(
-                point.getFieldAs<float>(Id::ScanAngleRank) / .006f));
+                d.m_scanAngle.get(point) / .006f));
         ostream << userData << scanAngleRank;
     }
     else
     {
-        int8_t scanAngleRank = point.getFieldAs<int8_t>(Id::ScanAngleRank);
+        int8_t scanAngleRank = d.m_scanAngleRank.get(point);
         ostream << scanAngleRank << userData;
     }
 
-    ostream << point.getFieldAs<uint16_t>(Id::PointSourceId);
+    ostream << d.m_pointSourceId.get(point);
 
     if (m_lasHeader.hasTime())
-        ostream << point.getFieldAs<double>(Id::GpsTime);
+        ostream << d.m_gpsTime.get(point);
 
     if (m_lasHeader.hasColor())
     {
-        ostream << point.getFieldAs<uint16_t>(Id::Red);
-        ostream << point.getFieldAs<uint16_t>(Id::Green);
-        ostream << point.getFieldAs<uint16_t>(Id::Blue);
+        ostream << d.m_red.get(point);
+        ostream << d.m_green.get(point);
+        ostream << d.m_blue.get(point);
     }
 
     if (m_lasHeader.hasInfrared())
-        ostream << point.getFieldAs<uint16_t>(Id::Infrared);
+        ostream << d.m_infrared.get(point);
 
-    Everything e;
-    for (auto& dim : m_extraDims)
+    if (extraBytes)
     {
-        point.getField((char *)&e, dim.m_dimType.m_id, dim.m_dimType.m_type);
-        Utils::insertDim(ostream, dim.m_dimType.m_type, e);
+        Everything e;
+        for (auto& dim : m_extraDims)
+        {
+            point.getField((char *)&e, dim.m_dimType.m_id,
+                dim.m_dimType.m_type);
+            Utils::insertDim(ostream, dim.m_dimType.m_type, e);
+        }
     }
+    else
+        ostream.seek(ostream.position() + m_extraByteLen);
 
     m_summaryData->addPoint(xOrig, yOrig, zOrig, returnNumber);
     return true;
@@ -1149,13 +1508,17 @@ point_count_t LasWriter::fillWriteBuf(const PointView& view,
     blocksize = (std::min)(blocksize, view.size() - startId);
     PointId lastId = startId + blocksize;
 
+    // The extra bytes of the block are filled a field at a time.
     LeInserter ostream(buf.data(), buf.size());
     PointRef point = (const_cast<PointView&>(view)).point(0);
     for (PointId idx = startId; idx < lastId; idx++)
     {
         point.setPointId(idx);
-        fillPointBuf(point, ostream);
+        fillPointBuf(point, ostream, false);
     }
+    if (m_extraFields.size())
+        LasUtils::fillExtraFields(m_extraFields, view, startId, blocksize,
+            buf.data() + m_lasHeader.basePointLen(), m_lasHeader.pointLen());
     return blocksize;
 }
 
@@ -1163,10 +1526,27 @@ point_count_t LasWriter::fillWriteBuf(const PointView& view,
 void LasWriter::doneFile()
 {
     finishOutput();
+    writeSpatialIndex();
     Utils::writeProgress(m_progressFd, "DONEFILE", m_curFilename);
     getMetadata().addList("filename", m_curFilename);
-    delete m_ostream;
+    m_ostream->seekp(0, std::ios::end);
+    std::streamoff size = m_ostream->tellp();
+    if (m_appendState)
+        size -= m_appendState->m_start;
+    if (size > 0)
+        countIoBytes(size);
+    std::ostream *out = m_ostream;
     m_ostream = NULL;
+    try
+    {
+        Utils::closeFile(out);
+    }
+    catch (const pdal_error& err)
+    {
+        throwError(err.what());
+    }
+    if (m_appendState)
+        finishAppend();
 }
 
 
@@ -1184,6 +1564,8 @@ void LasWriter::finishOutput()
     OLeStream out(m_ostream);
 
     // addVlr prevents any eVlrs from being added before version 1.4.
+    if (m_eVlrs.size())
+        m_lasHeader.setEVlrOffset((uint64_t)m_ostream->tellp());
     for (auto vi = m_eVlrs.begin(); vi != m_eVlrs.end(); ++vi)
     {
         ExtLasVLR evlr = *vi;
@@ -60,6 +60,8 @@ class LasTester;
 class NitfWriter;
 class GeotiffSupport;
 class LazPerfVlrCompressor;
+class LaxIndex;
+struct LasDims;
 
 struct VlrOptionInfo
 {
@@ -97,6 +99,11 @@ private:
     std::vector<ExtLasVLR> m_eVlrs;
     StringList m_extraDimSpec;
     std::vector<ExtraDim> m_extraDims;
+    LasUtils::ExtraFieldList m_extraFields;
+    std::unique_ptr<LasDims> m_dims;
+    PointLayoutPtr m_layout;
+    // Whether the table stores X, Y and Z scaled as they're written.
+    bool m_rawXYZ;
     uint16_t m_extraByteLen;
     SpatialReference m_srs;
     std::string m_curFilename;
@@ -104,6 +111,13 @@ private:
     std::set<std::string> m_forwards;
     bool m_forwardVlrs = false;
     LasCompression m_compression;
+    int m_threads;
+    bool m_spatialIndex;
+    bool m_append;
+    struct AppendState;
+    std::unique_ptr<AppendState> m_appendState;
+    std::unique_ptr<LaxIndex> m_laxIndex;
+    point_count_t m_indexCount;
     std::vector<char> m_pointBuf;
     SpatialReference m_aSrs;
     int m_srsCnt;
@@ -155,7 +169,12 @@ private:
         const MetadataNode& base);
     void handleHeaderForwards(MetadataNode& forward);
     void fillHeader();
-    bool fillPointBuf(PointRef& point, LeInserter& ostream);
+    void setRawXYZ();
+    void readyAppend(const std::string& filename,
+        const SpatialReference& srs);
+    void finishAppend();
+    bool fillPointBuf(PointRef& point, LeInserter& ostream,
+        bool extraBytes = true);
     point_count_t fillWriteBuf(const PointView& view, PointId startId,
         std::vector<char>& buf);
     bool writeLasZipBuf(PointRef& point);
@@ -179,6 +198,9 @@ private:
     void finishLasZipOutput();
     void finishLazPerfOutput();
     bool processPoint(PointRef& point);
+    PointViewPtr spatialOrder(const PointViewPtr view,
+        std::vector<uint32_t>& cells);
+    void writeSpatialIndex();
 
     LasWriter& operator=(const LasWriter&); // not implemented
     LasWriter(const LasWriter&); // not implemented
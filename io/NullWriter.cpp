@@ -1,6 +1,10 @@
 
 #include "NullWriter.hpp"
 
+#include <algorithm>
+
+#include <pdal/PointView.hpp>
+
 namespace pdal
 {
 
@@ -16,4 +20,108 @@ CREATE_STATIC_STAGE(NullWriter, s_info)
 
 std::string NullWriter::getName() const { return s_info.name; }
 
+
+NullWriter::NullWriter() : m_readFields(false), m_count(0)
+{}
+
+
+void NullWriter::addArgs(ProgramArgs& args)
+{
+    args.add("read_fields", "Read the value of every dimension of every "
+        "point", m_readFields);
+}
+
+
+void NullWriter::ready(PointTableRef table)
+{
+    m_dims = table.layout()->dimTypes();
+    m_buf.resize(table.layout()->pointSize());
+    m_count = 0;
+    m_latencies.clear();
+    m_start = Clock::now();
+}
+
+
+void NullWriter::readFields(PointRef& point)
+{
+    point.getPackedData(m_dims, m_buf.data());
+}
+
+
+void NullWriter::write(const PointViewPtr view)
+{
+    Clock::time_point start = Clock::now();
+    if (m_readFields)
+    {
+        PointRef point(*view, 0);
+        for (PointId idx = 0; idx < view->size(); ++idx)
+        {
+            point.setPointId(idx);
+            readFields(point);
+        }
+    }
+    m_count += view->size();
+    m_latencies.push_back(
+        std::chrono::duration<double>(Clock::now() - start).count());
 }
+
+
+bool NullWriter::processOne(PointRef& point)
+{
+    if (m_readFields)
+        readFields(point);
+    m_count++;
+    return true;
+}
+
+
+void NullWriter::processBatch(StreamPointTable& table, PointId begin,
+    PointId end, std::vector<bool>& keep)
+{
+    Clock::time_point start = Clock::now();
+    Streamable::processBatch(table, begin, end, keep);
+    m_latencies.push_back(
+        std::chrono::duration<double>(Clock::now() - start).count());
+}
+
+
+void NullWriter::done(PointTableRef table)
+{
+    const double seconds =
+        std::chrono::duration<double>(Clock::now() - m_start).count();
+
+    m_metadata.add("count", m_count, "Number of points written");
+    m_metadata.add("seconds", seconds,
+        "Time from the start of writing until the last point was written");
+    m_metadata.add("points_per_second", seconds > 0 ? m_count / seconds : 0.0);
+    m_metadata.add("batches", m_latencies.size(),
+        "Number of point views or stream batches written");
+
+    if (m_latencies.size())
+    {
+        std::sort(m_latencies.begin(), m_latencies.end());
+        auto percentile = [this](double p)
+        {
+            size_t idx = (size_t)(p * (m_latencies.size() - 1) + .5);
+            return m_latencies[idx] * 1000;
+        };
+
+        MetadataNode latency = m_metadata.add("latency_ms");
+        latency.add("min", percentile(0));
+        latency.add("p50", percentile(.5));
+        latency.add("p90", percentile(.9));
+        latency.add("p99", percentile(.99));
+        latency.add("max", percentile(1));
+    }
+
+    if (m_readFields)
+    {
+        PointLayoutPtr layout = table.layout();
+        MetadataNode bytes = m_metadata.add("bytes_read");
+        for (const DimType& d : m_dims)
+            bytes.add(layout->dimName(d.m_id),
+                (uint64_t)(m_count * Dimension::size(d.m_type)));
+    }
+}
+
+} // namespace pdal
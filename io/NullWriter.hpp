@@ -34,18 +34,49 @@
 
 #pragma once
 
+#include <chrono>
+#include <vector>
+
+#include <pdal/Streamable.hpp>
 #include <pdal/Writer.hpp>
 
 namespace pdal
 {
 
-class PDAL_DLL NullWriter : public Writer
+/**
+  Sink that discards its points.  Throughput, the latency of each view or
+  stream batch and, optionally, the bytes read for each dimension are
+  recorded in the stage's metadata so that the writer can be used to
+  benchmark pipelines.
+*/
+class PDAL_DLL NullWriter : public Writer, public Streamable
 {
 public:
+    NullWriter();
+
     std::string getName() const;
+
 private:
-    virtual void write(const PointViewPtr /*view*/)
-        {}
+    typedef std::chrono::steady_clock Clock;
+
+    virtual void addArgs(ProgramArgs& args);
+    virtual void ready(PointTableRef table);
+    virtual void write(const PointViewPtr view);
+    virtual bool processOne(PointRef& point);
+    virtual void processBatch(StreamPointTable& table, PointId begin,
+        PointId end, std::vector<bool>& keep);
+    virtual void done(PointTableRef table);
+    virtual bool dimensionsUsed(PointLayoutPtr, Dimension::IdList&) const
+        { return true; }
+
+    void readFields(PointRef& point);
+
+    bool m_readFields;
+    DimTypeList m_dims;
+    std::vector<char> m_buf;
+    point_count_t m_count;
+    std::vector<double> m_latencies;
+    Clock::time_point m_start;
 };
 
 } // namespace pdal
@@ -62,7 +62,7 @@ static StaticPluginInfo const s_info
 CREATE_STATIC_STAGE(OGRWriter, s_info)
 
 OGRWriter::OGRWriter() : m_driver(nullptr), m_ds(nullptr), m_layer(nullptr),
-    m_feature(nullptr)
+    m_feature(nullptr), m_curCount(0), m_batchCount(0)
 {}
 
 
@@ -80,6 +80,8 @@ void OGRWriter::addArgs(ProgramArgs& args)
     args.add("measure_dim", "Use dimensions as a measure value",
         m_measureDimName);
     args.add("ogrdriver", "OGR writer driver name", m_driverName, m_driverName);
+    args.add("batch_size", "Number of features written in each transaction "
+        "(0 for a single transaction)", m_batchSize, point_count_t(10000));
 }
 
 
@@ -137,6 +139,35 @@ void OGRWriter::readyFile(const std::string& filename,
         m_ds->SetProjection(srs.getWKT().data());
     }
     m_feature = OGRFeature::CreateFeature(m_layer->GetLayerDefn());
+    m_batchCount = 0;
+    transact(&OGRLayer::StartTransaction, "start");
+}
+
+
+// Drivers without transactions, such as shapefiles, accept the calls and
+// write as they go.  Others, such as GeoPackage, would otherwise commit
+// every feature on its own.
+void OGRWriter::transact(OGRErr (OGRLayer::*op)(), const std::string& what)
+{
+    if ((m_layer->*op)() != OGRERR_NONE)
+        throwError("Unable to " + what + " transaction: " +
+            CPLGetLastErrorMsg());
+}
+
+
+// The same feature is written over and over, so its ID is cleared to
+// have the driver assign a new one each time.
+void OGRWriter::createFeature()
+{
+    m_feature->SetFID(OGRNullFID);
+    if (m_layer->CreateFeature(m_feature))
+        throwError("Couldn't create feature.");
+    if (m_batchSize && ++m_batchCount == m_batchSize)
+    {
+        transact(&OGRLayer::CommitTransaction, "commit");
+        transact(&OGRLayer::StartTransaction, "start");
+        m_batchCount = 0;
+    }
 }
 
 void OGRWriter::writeView(const PointViewPtr view)
@@ -174,8 +205,7 @@ bool OGRWriter::processOne(PointRef& point)
         }
         else
             m_feature->SetGeometry(&pt);
-        if (m_layer->CreateFeature(m_feature))
-            throwError("Couldn't create feature.");
+        createFeature();
         m_curCount = 0;
     }
     return true;
@@ -184,9 +214,15 @@ bool OGRWriter::processOne(PointRef& point)
 
 void OGRWriter::doneFile()
 {
+    // Write the points of a partly filled multipoint.
     if (m_curCount)
-        if (m_layer->CreateFeature(m_feature))
-            throwError("Couldn't create feature.");
+    {
+        m_feature->SetGeometry(&m_multiPoint);
+        m_multiPoint.empty();
+        createFeature();
+        m_curCount = 0;
+    }
+    transact(&OGRLayer::CommitTransaction, "commit");
     OGRFeature::DestroyFeature(m_feature);
     GDALClose(m_ds);
     m_layer = nullptr;
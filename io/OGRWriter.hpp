@@ -75,6 +75,9 @@ private:
     virtual bool processOne(PointRef& point);
     virtual void doneFile();
 
+    void createFeature();
+    void transact(OGRErr (OGRLayer::*op)(), const std::string& what);
+
     // I don't think this needs to be deleted.
 #ifdef PDAL_GDAL2_1
     GDALDriver *m_driver;
@@ -91,6 +94,8 @@ private:
     std::string m_driverName;
     size_t m_multiCount;
     size_t m_curCount;
+    point_count_t m_batchSize;
+    point_count_t m_batchCount;
     std::string m_measureDimName;
     Dimension::Id m_measureDim;
 };
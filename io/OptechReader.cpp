@@ -38,10 +38,12 @@
 #include <cmath>
 #include <cstring>
 #include <sstream>
+#include <thread>
 
 #include <pdal/PDALUtils.hpp>
 #include <pdal/SpatialReference.hpp>
 #include <pdal/StageFactory.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 namespace pdal
 {
@@ -73,16 +75,27 @@ OptechReader::OptechReader()
     , m_boresightMatrix(georeference::createIdentityMatrix())
     , m_istream()
     , m_buffer()
-    , m_extractor(m_buffer.data(), 0)
     , m_recordIndex(0)
+    , m_pulseIndex(0)
     , m_returnIndex(0)
-    , m_pulse()
+    , m_threads(0)
+{}
+
+
+OptechReader::~OptechReader()
 {}
 
 
 const CsdHeader& OptechReader::getHeader() const { return m_header; }
 
 
+void OptechReader::addArgs(ProgramArgs& args)
+{
+    args.add("threads", "Number of threads used to georeference pulses.  "
+        "The default is the number of cores.", m_threads);
+}
+
+
 void OptechReader::initialize()
 {
     ILeStream stream(Utils::openFile(m_filename));
@@ -138,8 +151,14 @@ void OptechReader::ready(PointTableRef)
 
     m_istream->seek(m_header.headerSize);
     m_recordIndex = 0;
+    m_pulses.clear();
+    m_pulseIndex = 0;
     m_returnIndex = 0;
-    m_pulse = CsdPulse();
+
+    const size_t threads = m_threads ? m_threads :
+        (std::max)(std::thread::hardware_concurrency(), 1U);
+    if (threads > 1)
+        m_pool.reset(new ThreadPool(threads, threads, false));
 }
 
 
@@ -147,96 +166,153 @@ point_count_t OptechReader::read(PointViewPtr data,
                                  point_count_t countRequested)
 {
     point_count_t numRead = 0;
-    point_count_t dataIndex = data->size();
 
     while (numRead < countRequested)
     {
-        if (m_returnIndex == 0)
+        if (m_pulseIndex >= m_pulses.size())
         {
-            if (!m_extractor.good())
-            {
-                if (m_recordIndex >= m_header.numRecords)
-                {
-                    break;
-                }
-                m_recordIndex += fillBuffer();
-            }
+            if (m_recordIndex >= m_header.numRecords)
+                break;
+            m_recordIndex += fillBuffer();
+            continue;
+        }
 
-            m_extractor >> m_pulse.gpsTime >> m_pulse.returnCount >>
-                m_pulse.range[0] >> m_pulse.range[1] >> m_pulse.range[2] >>
-                m_pulse.range[3] >> m_pulse.intensity[0] >>
-                m_pulse.intensity[1] >> m_pulse.intensity[2] >>
-                m_pulse.intensity[3] >> m_pulse.scanAngle >> m_pulse.roll >>
-                m_pulse.pitch >> m_pulse.heading >> m_pulse.latitude >>
-                m_pulse.longitude >> m_pulse.elevation;
+        const PointId begin = data->size();
+        const point_count_t n =
+            readPulses(*data, countRequested - numRead);
+        if (m_cb)
+            for (PointId idx = begin; idx < begin + n; ++idx)
+                m_cb(*data, idx);
+        numRead += n;
+    }
+    return numRead;
+}
 
-            if (m_pulse.returnCount == 0)
-            {
-                m_returnIndex = 0;
-                continue;
-            }
 
-            // In all the csd files that we've tested, the longitude
-            // values have been less than -2pi.
-            if (m_pulse.longitude < -M_PI * 2)
+// Write up to 'count' points from the buffered pulses to the view.
+// Ranges of pulses are georeferenced in parallel, each into its own view
+// whose points are then appended to the destination view.
+point_count_t OptechReader::readPulses(PointView& view, point_count_t count)
+{
+    std::vector<ReturnSpan> spans;
+    point_count_t total = 0;
+    while (m_pulseIndex < m_pulses.size() && total < count)
+    {
+        const CsdPulse& pulse = m_pulses[m_pulseIndex];
+        const size_t numReturns = (std::min)((size_t)pulse.returnCount,
+            MaximumNumberOfReturns);
+        const size_t n = (size_t)(std::min)(
+            (point_count_t)(numReturns - m_returnIndex), count - total);
+
+        spans.push_back({ m_pulseIndex, m_returnIndex, n });
+        total += n;
+        m_returnIndex += n;
+        if (m_returnIndex >= numReturns)
+        {
+            m_pulseIndex++;
+            m_returnIndex = 0;
+        }
+    }
+
+    if (!m_pool || spans.size() < 2)
+    {
+        const PointId begin = view.size();
+        for (PointId idx = begin; idx < begin + total; ++idx)
+            view.getOrAddPoint(idx);
+        georeferencePulses(spans.data(), spans.size(), view, begin);
+        return total;
+    }
+
+    const size_t pieces = (std::min)(m_pool->size(), spans.size());
+    std::vector<PointViewPtr> views;
+    std::vector<std::string> errors(pieces);
+    for (size_t p = 0; p < pieces; ++p)
+    {
+        const size_t first = spans.size() * p / pieces;
+        const size_t last = spans.size() * (p + 1) / pieces;
+
+        point_count_t numPoints = 0;
+        for (size_t i = first; i < last; ++i)
+            numPoints += spans[i].numReturns;
+        PointViewPtr v = view.makeNew();
+        for (PointId idx = 0; idx < numPoints; ++idx)
+            v->getOrAddPoint(idx);
+        views.push_back(v);
+
+        m_pool->add([this, first, last, &spans, &views, &errors, p]()
+        {
+            try
             {
-                m_pulse.longitude = m_pulse.longitude + M_PI * 2;
+                georeferencePulses(spans.data() + first, last - first,
+                    *views[p], 0);
             }
-            else if (m_pulse.longitude > M_PI * 2)
+            catch (const std::exception& err)
             {
-                m_pulse.longitude = m_pulse.longitude - M_PI * 2;
+                errors[p] = err.what();
             }
-        }
+        });
+    }
+    m_pool->await();
+
+    for (const std::string& err : errors)
+        if (err.size())
+            throwError(err);
+    for (PointViewPtr& v : views)
+        view.append(*v);
+    return total;
+}
 
-        georeference::Xyz gpsPoint = georeference::Xyz(
-            m_pulse.longitude, m_pulse.latitude, m_pulse.elevation);
-        georeference::RotationMatrix rotationMatrix =
-            createOptechRotationMatrix(m_pulse.roll, m_pulse.pitch,
-                                       m_pulse.heading);
-        georeference::Xyz point = pdal::georeference::georeferenceWgs84(
-            m_pulse.range[m_returnIndex], m_pulse.scanAngle,
-            m_boresightMatrix, rotationMatrix, gpsPoint);
-
-        data->setField(Dimension::Id::X, dataIndex, point.X * 180 / M_PI);
-        data->setField(Dimension::Id::Y, dataIndex, point.Y * 180 / M_PI);
-        data->setField(Dimension::Id::Z, dataIndex, point.Z);
-        data->setField(Dimension::Id::GpsTime, dataIndex, m_pulse.gpsTime);
-        if (m_returnIndex == MaximumNumberOfReturns - 1)
-        {
-            data->setField(Dimension::Id::ReturnNumber, dataIndex,
-                          m_pulse.returnCount);
-        }
-        else
-        {
-            data->setField(Dimension::Id::ReturnNumber, dataIndex,
-                          m_returnIndex + 1);
-        }
-        data->setField(Dimension::Id::NumberOfReturns, dataIndex,
-                      m_pulse.returnCount);
-        data->setField(Dimension::Id::EchoRange, dataIndex,
-                      m_pulse.range[m_returnIndex]);
-        data->setField(Dimension::Id::Intensity, dataIndex,
-                      m_pulse.intensity[m_returnIndex]);
-        data->setField(Dimension::Id::ScanAngleRank, dataIndex,
-                      m_pulse.scanAngle * 180 / M_PI);
 
-        if (m_cb)
-            m_cb(*data, dataIndex);
+// Georeference the returns of 'count' spans into consecutive points of
+// the view starting at 'idx'.  The attitude matrix and the scan angle
+// terms are computed once per pulse and shared by all of its returns.
+void OptechReader::georeferencePulses(const ReturnSpan *spans, size_t count,
+    PointView& view, PointId idx)
+{
+    using namespace Dimension;
 
-        ++dataIndex;
-        ++numRead;
-        ++m_returnIndex;
+    double ranges[MaximumNumberOfReturns];
+    std::vector<georeference::Xyz> points(MaximumNumberOfReturns,
+        georeference::Xyz(0, 0, 0));
 
-        if (m_returnIndex >= m_pulse.returnCount ||
-            m_returnIndex >= MaximumNumberOfReturns)
+    for (const ReturnSpan *span = spans; span < spans + count; ++span)
+    {
+        const CsdPulse& pulse = m_pulses[span->pulse];
+        for (size_t i = 0; i < span->numReturns; ++i)
+            ranges[i] = pulse.range[span->firstReturn + i];
+
+        georeference::georeferenceWgs84(ranges, span->numReturns,
+            pulse.scanAngle, m_boresightMatrix,
+            createOptechRotationMatrix(pulse.roll, pulse.pitch,
+                pulse.heading),
+            georeference::Xyz(pulse.longitude, pulse.latitude,
+                pulse.elevation),
+            points.data());
+
+        for (size_t i = 0; i < span->numReturns; ++i, ++idx)
         {
-            m_returnIndex = 0;
+            const size_t returnIndex = span->firstReturn + i;
+            const georeference::Xyz& point = points[i];
+
+            view.setField(Id::X, idx, point.X * 180 / M_PI);
+            view.setField(Id::Y, idx, point.Y * 180 / M_PI);
+            view.setField(Id::Z, idx, point.Z);
+            view.setField(Id::GpsTime, idx, pulse.gpsTime);
+            if (returnIndex == MaximumNumberOfReturns - 1)
+                view.setField(Id::ReturnNumber, idx, pulse.returnCount);
+            else
+                view.setField(Id::ReturnNumber, idx, returnIndex + 1);
+            view.setField(Id::NumberOfReturns, idx, pulse.returnCount);
+            view.setField(Id::EchoRange, idx, pulse.range[returnIndex]);
+            view.setField(Id::Intensity, idx, pulse.intensity[returnIndex]);
+            view.setField(Id::ScanAngleRank, idx,
+                pulse.scanAngle * 180 / M_PI);
         }
     }
-    return numRead;
 }
 
 
+// Read the next block of records and decode the pulses that have returns.
 size_t OptechReader::fillBuffer()
 {
     size_t numRecords = (std::min)(m_header.numRecords - m_recordIndex,
@@ -245,14 +321,46 @@ size_t OptechReader::fillBuffer()
     buffer_size_t bufferSize = NumBytesInRecord * numRecords;
     m_buffer.resize(bufferSize);
     m_istream->get(m_buffer);
-    m_extractor = LeExtractor(m_buffer.data(), m_buffer.size());
+    LeExtractor extractor(m_buffer.data(), m_buffer.size());
+
+    m_pulses.clear();
+    m_pulseIndex = 0;
+    m_returnIndex = 0;
+    for (size_t i = 0; i < numRecords; ++i)
+    {
+        CsdPulse pulse;
+        extractor >> pulse.gpsTime >> pulse.returnCount >>
+            pulse.range[0] >> pulse.range[1] >> pulse.range[2] >>
+            pulse.range[3] >> pulse.intensity[0] >>
+            pulse.intensity[1] >> pulse.intensity[2] >>
+            pulse.intensity[3] >> pulse.scanAngle >> pulse.roll >>
+            pulse.pitch >> pulse.heading >> pulse.latitude >>
+            pulse.longitude >> pulse.elevation;
+
+        if (pulse.returnCount == 0)
+            continue;
+
+        // In all the csd files that we've tested, the longitude
+        // values have been less than -2pi.
+        if (pulse.longitude < -M_PI * 2)
+        {
+            pulse.longitude = pulse.longitude + M_PI * 2;
+        }
+        else if (pulse.longitude > M_PI * 2)
+        {
+            pulse.longitude = pulse.longitude - M_PI * 2;
+        }
+        m_pulses.push_back(pulse);
+    }
     return numRecords;
 }
 
 
 void OptechReader::done(PointTableRef)
 {
+    m_pool.reset();
     m_istream.reset();
+    m_pulses.clear();
 }
 
 } // namespace pdal
@@ -47,6 +47,7 @@
 namespace pdal
 {
 
+class ThreadPool;
 
 class PDAL_DLL OptechReader : public Reader
 {
@@ -59,6 +60,7 @@ public:
     static const size_t MaxNumRecordsInBuffer = BufferSize / NumBytesInRecord;
 
     OptechReader();
+    ~OptechReader();
 
     const CsdHeader& getHeader() const;
 
@@ -66,20 +68,34 @@ private:
     typedef std::vector<char> buffer_t;
     typedef buffer_t::size_type buffer_size_t;
 
+    // A run of returns from one buffered pulse to be written as points.
+    struct ReturnSpan
+    {
+        size_t pulse;
+        size_t firstReturn;
+        size_t numReturns;
+    };
+
+    virtual void addArgs(ProgramArgs& args);
     virtual void initialize();
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void ready(PointTableRef table);
     virtual point_count_t read(PointViewPtr view, point_count_t num);
     size_t fillBuffer();
+    point_count_t readPulses(PointView& view, point_count_t count);
+    void georeferencePulses(const ReturnSpan *spans, size_t count,
+        PointView& view, PointId idx);
     virtual void done(PointTableRef table);
 
     CsdHeader m_header;
     georeference::RotationMatrix m_boresightMatrix;
     std::unique_ptr<IStream> m_istream;
     buffer_t m_buffer;
-    LeExtractor m_extractor;
     size_t m_recordIndex;
+    std::vector<CsdPulse> m_pulses;
+    size_t m_pulseIndex;
     size_t m_returnIndex;
-    CsdPulse m_pulse;
+    size_t m_threads;
+    std::unique_ptr<ThreadPool> m_pool;
 };
 }
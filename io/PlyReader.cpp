@@ -38,11 +38,21 @@
 
 #include <pdal/PDALUtils.hpp>
 #include <pdal/PointView.hpp>
+#include <pdal/util/Extractor.hpp>
 #include <pdal/util/IStream.hpp>
+#include <pdal/util/ProgramArgs.hpp>
 
 namespace pdal
 {
 
+namespace
+{
+
+// Binary data not read from a mapping is read in blocks of this size.
+const size_t BlockSize = 1 << 20;
+
+} // unnamed namespace
+
 static StaticPluginInfo const s_info
 {
         "readers.ply",
@@ -54,7 +64,8 @@ static StaticPluginInfo const s_info
 CREATE_STATIC_STAGE(PlyReader, s_info)
 
 
-PlyReader::PlyReader() : m_vertexElt(nullptr)
+PlyReader::PlyReader() : m_vertexElt(nullptr), m_pos(nullptr),
+    m_end(nullptr), m_bufPos(0)
 {}
 
 
@@ -277,8 +288,22 @@ void PlyReader::extractHeader()
     m_dataPos = m_stream->tellg();
 
     for (Element& elt : m_elements)
+    {
         if (elt.m_name == "vertex")
             m_vertexElt = &elt;
+
+        elt.m_recordSize = 0;
+        for (auto& prop : elt.m_properties)
+        {
+            auto sprop = dynamic_cast<SimpleProperty *>(prop.get());
+            if (!sprop)
+            {
+                elt.m_recordSize = 0;
+                break;
+            }
+            elt.m_recordSize += Dimension::size(sprop->m_type);
+        }
+    }
     if (!m_vertexElt)
         throwError("Can't read PLY file without a 'vertex' element.");
 }
@@ -290,6 +315,14 @@ std::string PlyReader::getName() const
 }
 
 
+void PlyReader::addArgs(ProgramArgs& args)
+{
+    args.add("read_ahead", "Size in MiB of the windows of the file read "
+        "ahead on a background thread, rather than mapping binary data.  "
+        "0 reads as needed", m_readAhead);
+}
+
+
 void PlyReader::initialize()
 {
     m_stream = Utils::openFile(m_filename, true);
@@ -359,6 +392,14 @@ void PlyReader::SimpleProperty::read(std::istream *stream,
 }
 
 
+void PlyReader::SimpleProperty::extract(SwitchableExtractor& in,
+    PointRef& point)
+{
+    Everything e = Utils::extractDim(in, m_type);
+    point.setField(m_dim, m_type, &e);
+}
+
+
 // Right now we don't support list properties for point data.  We just
 // read the data and throw it away.
 void PlyReader::ListProperty::read(std::istream *stream,
@@ -403,21 +444,40 @@ void PlyReader::readElement(Element& elt, PointRef& point)
 
 void PlyReader::ready(PointTableRef table)
 {
-    m_stream = Utils::openFile(m_filename, true);
+    m_stream = Utils::openFile(m_filename, true, m_readAhead * 1024 * 1024);
     if (m_stream)
         m_stream->seekg(m_dataPos);
+
+    m_buf.clear();
+    m_bufPos = 0;
+    m_pos = m_end = nullptr;
+    if (m_format != Format::Ascii && !m_readAhead)
+    {
+        m_map = FileUtils::mapFile(m_filename);
+        if (m_map.addr())
+        {
+            FileUtils::adviseSequential(m_map);
+            m_pos = (const char *)m_map.addr() + m_dataPos;
+            m_end = (const char *)m_map.addr() + m_map.m_size;
+        }
+    }
+
     for (Element& elt : m_elements)
     {
         if (&elt == m_vertexElt)
             break;
 
+        if (m_format != Format::Ascii)
+        {
+            skipElement(elt);
+            continue;
+        }
+
         // We read an element into point 0.  Since the element's properties
         // weren't registered as dimensions, we'll try to write the data
         // to a NULL dimension, which is a noop.
         // This essentially just gets us to the vertex element.
-        // In binary mode, this is all silliness, since we should be able
-        // to seek right where we want to go, but in text mode, you've got
-        // to go through the data.
+        // In text mode, you've got to go through the data.
         PointRef point(table, 0);
         for (PointId idx = 0; idx < elt.m_count; ++idx)
             readElement(elt, point);
@@ -426,37 +486,240 @@ void PlyReader::ready(PointTableRef table)
 }
 
 
-bool PlyReader::processOne(PointRef& point)
+// Get the address of the next 'size' bytes of binary data, or null if
+// the data ends first.  The address is valid until the next fetch.
+const char *PlyReader::fetch(size_t size)
 {
-    if (m_index < m_vertexElt->m_count)
+    if (m_map.addr())
     {
+        if ((size_t)(m_end - m_pos) < size)
+            return nullptr;
+        const char *pos = m_pos;
+        m_pos += size;
+        return pos;
+    }
+
+    size_t avail = m_buf.size() - m_bufPos;
+    if (avail < size)
+    {
+        if (!m_stream)
+            return nullptr;
+        m_buf.erase(m_buf.begin(), m_buf.begin() + m_bufPos);
+        m_bufPos = 0;
+        m_buf.resize((std::max)(size, BlockSize));
+        m_stream->read(m_buf.data() + avail, m_buf.size() - avail);
+        m_buf.resize(avail + (size_t)m_stream->gcount());
+        if (m_buf.size() < size)
+            return nullptr;
+    }
+    const char *pos = m_buf.data() + m_bufPos;
+    m_bufPos += size;
+    return pos;
+}
+
+
+double PlyReader::readValue(Dimension::Type type)
+{
+    double d;
+    if (m_format == Format::Ascii)
+    {
+        *m_stream >> d;
+        if (m_stream->fail())
+            throwError("Error reading PLY data.");
+        return d;
+    }
+
+    const size_t size = Dimension::size(type);
+    const char *pos = fetch(size);
+    if (!pos)
+        throwError("Unexpected end of PLY data.");
+    SwitchableExtractor in(pos, size, m_format == Format::BinaryLe);
+    Everything e = Utils::extractDim(in, type);
+    return Utils::toDouble(e, type);
+}
+
+
+void PlyReader::skipElement(Element& elt)
+{
+    if (elt.m_recordSize)
+    {
+        for (size_t i = 0; i < elt.m_count; ++i)
+            if (!fetch(elt.m_recordSize))
+                throwError("Unexpected end of PLY data in element '" +
+                    elt.m_name + "'.");
+        return;
+    }
+
+    for (size_t i = 0; i < elt.m_count; ++i)
+        for (auto& prop : elt.m_properties)
+        {
+            auto lprop = dynamic_cast<ListProperty *>(prop.get());
+            if (lprop)
+            {
+                size_t cnt = (size_t)readValue(lprop->m_countType);
+                while (cnt--)
+                    readValue(lprop->m_listType);
+            }
+            else
+                readValue(static_cast<SimpleProperty *>(prop.get())->m_type);
+        }
+}
+
+
+// Read the faces following the vertices into a mesh.  Faces with more than
+// three vertices are split into triangles that fan from the first vertex.
+void PlyReader::readFaces(PointView& view)
+{
+    auto it = m_elements.begin();
+    while (&*it != m_vertexElt)
+        ++it;
+
+    ListProperty *indices = nullptr;
+    auto faceIt = it;
+    while (!indices && ++faceIt != m_elements.end())
+        if (faceIt->m_name == "face")
+            for (auto& prop : faceIt->m_properties)
+                if (prop->m_name == "vertex_indices" ||
+                    prop->m_name == "vertex_index")
+                    indices = dynamic_cast<ListProperty *>(prop.get());
+    if (!indices)
+        return;
+
+    // Get past any elements between the vertices and faces.
+    while (++it != faceIt)
+    {
+        if (m_format == Format::Ascii)
+        {
+            PointRef point(view, 0);
+            for (PointId idx = 0; idx < it->m_count; ++idx)
+                readElement(*it, point);
+        }
+        else
+            skipElement(*it);
+    }
+
+    Element& elt = *faceIt;
+    TriangularMesh *mesh = view.createMesh(getName());
+    if (!mesh)
+        return;
+
+    std::vector<PointId> face;
+    for (size_t i = 0; i < elt.m_count; ++i)
+    {
+        for (auto& prop : elt.m_properties)
+        {
+            auto lprop = dynamic_cast<ListProperty *>(prop.get());
+            if (!lprop)
+            {
+                readValue(
+                    static_cast<SimpleProperty *>(prop.get())->m_type);
+                continue;
+            }
+
+            size_t cnt = (size_t)readValue(lprop->m_countType);
+            if (lprop != indices)
+            {
+                while (cnt--)
+                    readValue(lprop->m_listType);
+                continue;
+            }
+
+            face.clear();
+            while (cnt--)
+            {
+                double d = readValue(lprop->m_listType);
+                if (d < 0 || d >= m_vertexElt->m_count)
+                    throwError("Invalid vertex index " +
+                        Utils::toString(d) + " in face " +
+                        std::to_string(i) + ".");
+                face.push_back((PointId)d);
+            }
+            for (size_t j = 2; j < face.size(); ++j)
+                mesh->add(face[0], face[j - 1], face[j]);
+        }
+    }
+}
+
+
+bool PlyReader::processOne(PointRef& point)
+{
+    if (m_index >= m_vertexElt->m_count)
+        return false;
+
+    if (m_format == Format::Ascii)
         readElement(*m_vertexElt, point);
-        m_index++;
-        return true;
+    else
+    {
+        const size_t size = m_vertexElt->m_recordSize;
+        const char *pos = fetch(size);
+        if (!pos)
+            throwError("Error reading data for point/element " +
+                std::to_string(m_index) + ".");
+        SwitchableExtractor in(pos, size, m_format == Format::BinaryLe);
+        for (auto& prop : m_vertexElt->m_properties)
+            static_cast<SimpleProperty *>(prop.get())->extract(in, point);
     }
-    return false;
+    m_index++;
+    return true;
 }
 
 
-// We're just reading the vertex element here.
+// We're just reading the vertex element here, along with any faces.
 point_count_t PlyReader::read(PointViewPtr view, point_count_t num)
 {
     point_count_t cnt(0);
+    num = (std::min)(num, (point_count_t)m_vertexElt->m_count);
 
     PointRef point(view->point(0));
-    for (PointId idx = 0; idx < m_vertexElt->m_count && idx < num; ++idx)
+    if (m_format == Format::Ascii)
+    {
+        for (PointId idx = 0; idx < num; ++idx)
+        {
+            point.setPointId(idx);
+            processOne(point);
+            cnt++;
+        }
+    }
+    else
     {
-        point.setPointId(idx);
-        processOne(point);
-        cnt++;
+        // Binary vertices are decoded a block of records at a time.
+        const size_t size = m_vertexElt->m_recordSize;
+        const point_count_t blockCount =
+            (std::max)(BlockSize / size, (size_t)1);
+        while (cnt < num)
+        {
+            const point_count_t n = (std::min)(blockCount, num - cnt);
+            const char *pos = fetch(n * size);
+            if (!pos)
+                throwError("Error reading data for point/element " +
+                    std::to_string(cnt) + ".");
+            SwitchableExtractor in(pos, n * size,
+                m_format == Format::BinaryLe);
+            for (PointId idx = cnt; idx < cnt + n; ++idx)
+            {
+                point.setPointId(idx);
+                for (auto& prop : m_vertexElt->m_properties)
+                    static_cast<SimpleProperty *>(prop.get())->extract(in,
+                        point);
+            }
+            cnt += n;
+        }
+        m_index = cnt;
     }
+
+    if (cnt == m_vertexElt->m_count)
+        readFaces(*view);
     return cnt;
 }
 
 
 void PlyReader::done(PointTableRef table)
 {
+    if (m_map.addr())
+        FileUtils::unmapFile(m_map);
+    m_buf.clear();
     Utils::closeFile(m_stream);
+    m_stream = nullptr;
 }
 
 } // namespace pdal
@@ -41,10 +41,13 @@
 #include <pdal/Reader.hpp>
 #include <pdal/StageFactory.hpp>
 #include <pdal/Streamable.hpp>
+#include <pdal/util/FileUtils.hpp>
 
 namespace pdal
 {
 
+class SwitchableExtractor;
+
 class PDAL_DLL PlyReader : public Reader, public Streamable
 {
 public:
@@ -90,6 +93,7 @@ private:
             PointRef& point) override;
         virtual void setDim(Dimension::Id id) override
         { m_dim = id; }
+        void extract(SwitchableExtractor& in, PointRef& point);
     };
 
     struct ListProperty : public Property
@@ -109,12 +113,14 @@ private:
     struct Element
     {
         Element(const std::string name, size_t count) :
-            m_name(name), m_count(count)
+            m_name(name), m_count(count), m_recordSize(0)
         {}
 
         std::string m_name;
         size_t m_count;
         std::vector<std::unique_ptr<Property>> m_properties;
+        // Size of a binary record, or 0 if the element has a list property.
+        size_t m_recordSize;
     };
 
     Format m_format;
@@ -127,6 +133,16 @@ private:
     PointId m_index;
     Element *m_vertexElt;
 
+    // Binary data is read from a mapping of the file when possible and
+    // otherwise in blocks from the stream.
+    FileUtils::MapContext m_map;
+    const char *m_pos;
+    const char *m_end;
+    std::vector<char> m_buf;
+    size_t m_bufPos;
+    size_t m_readAhead;
+
+    virtual void addArgs(ProgramArgs& args);
     virtual void initialize();
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void ready(PointTableRef table);
@@ -147,6 +163,10 @@ private:
     void extractHeader();
     void readElement(Element& elt, PointRef& point);
     bool readProperty(Property *prop, PointRef& point);
+    const char *fetch(size_t size);
+    double readValue(Dimension::Type type);
+    void skipElement(Element& elt);
+    void readFaces(PointView& view);
 };
 
 } // namespace pdal
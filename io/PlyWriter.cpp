@@ -37,12 +37,75 @@
 #include <limits>
 #include <sstream>
 
-#include <pdal/util/OStream.hpp>
+#include <pdal/PDALUtils.hpp>
+#include <pdal/util/Inserter.hpp>
 #include <pdal/util/ProgramArgs.hpp>
 
 namespace pdal
 {
 
+namespace
+{
+
+// Binary data is formatted into blocks of about this size before writing.
+const size_t BlockSize = 1 << 20;
+
+template <typename INSERTER>
+void writeBinaryPoints(std::ostream& out, const PointView& view,
+    const Dimension::IdList& dims, PointLayoutPtr layout)
+{
+    std::vector<Dimension::Type> types;
+    size_t recordSize = 0;
+    for (auto dim : dims)
+    {
+        types.push_back(layout->dimType(dim));
+        recordSize += Dimension::size(types.back());
+    }
+    if (!recordSize)
+        return;
+
+    const PointId blockCount = (std::max)(BlockSize / recordSize, (size_t)1);
+    std::vector<char> buf(blockCount * recordSize);
+    for (PointId start = 0; start < view.size(); start += blockCount)
+    {
+        const PointId end = (std::min)(start + blockCount,
+            (PointId)view.size());
+        INSERTER ins(buf.data(), buf.size());
+        for (PointId idx = start; idx < end; ++idx)
+            for (size_t i = 0; i < dims.size(); ++i)
+            {
+                Everything e;
+                view.getField((char *)&e, dims[i], types[i], idx);
+                Utils::insertDim(ins, types[i], e);
+            }
+        out.write(buf.data(), (end - start) * recordSize);
+    }
+}
+
+
+// Faces are written as a one-byte count of 3 and three uint32 indices.
+template <typename INSERTER>
+void writeBinaryFaces(std::ostream& out, const TriangularMesh& mesh,
+    PointId offset)
+{
+    const size_t recordSize = 1 + 3 * sizeof(uint32_t);
+    const size_t blockCount = BlockSize / recordSize;
+    std::vector<char> buf(blockCount * recordSize);
+    for (size_t start = 0; start < mesh.size(); start += blockCount)
+    {
+        const size_t end = (std::min)(start + blockCount, mesh.size());
+        INSERTER ins(buf.data(), buf.size());
+        mesh.visit(start, end, [&ins, offset](PointId a, PointId b, PointId c)
+        {
+            ins << (uint8_t)3 << (uint32_t)(a + offset) <<
+                (uint32_t)(b + offset) << (uint32_t)(c + offset);
+        });
+        out.write(buf.data(), (end - start) * recordSize);
+    }
+}
+
+} // unnamed namespace
+
 static StaticPluginInfo const s_info
 {
         "writers.ply",
@@ -152,7 +215,7 @@ void PlyWriter::ready(PointTableRef table)
             std::to_string((std::numeric_limits<uint32_t>::max)()) +
             " points supported.");
 
-    m_stream = Utils::createFile(m_filename, true);
+    m_stream = Utils::createFile(m_filename, true, true);
     writeHeader(table.layout());
 }
 
@@ -166,33 +229,16 @@ void PlyWriter::write(const PointViewPtr data)
 void PlyWriter::writeValue(PointRef& point, Dimension::Id dim,
     Dimension::Type type)
 {
-    if (m_format == Format::Ascii)
-    {
-        double d = point.getFieldAs<double>(dim);
-        if (m_precisionArg->set() &&
-            Dimension::base(type) == Dimension::BaseType::Floating)
-        {
-            *m_stream << std::fixed;
-            m_stream->precision(m_precision);
-        }
-        else
-            m_stream->unsetf(std::ios_base::fixed);
-        *m_stream << d;
-    }
-    else if (m_format == Format::BinaryLe)
+    double d = point.getFieldAs<double>(dim);
+    if (m_precisionArg->set() &&
+        Dimension::base(type) == Dimension::BaseType::Floating)
     {
-        OLeStream out(m_stream);
-        Everything e;
-        point.getField((char *)&e, dim, type);
-        Utils::insertDim(out, type, e);
-    }
-    else if (m_format == Format::BinaryBe)
-    {
-        OBeStream out(m_stream);
-        Everything e;
-        point.getField((char *)&e, dim, type);
-        Utils::insertDim(out, type, e);
+        *m_stream << std::fixed;
+        m_stream->precision(m_precision);
     }
+    else
+        m_stream->unsetf(std::ios_base::fixed);
+    *m_stream << d;
 }
 
 
@@ -203,39 +249,17 @@ void PlyWriter::writePoint(PointRef& point, PointLayoutPtr layout)
         Dimension::Id dim = *it;
         writeValue(point, dim, layout->dimType(dim));
         ++it;
-        if (m_format == Format::Ascii && it != m_dims.end())
+        if (it != m_dims.end())
             *m_stream << " ";
     }
-    if (m_format == Format::Ascii)
-        *m_stream << std::endl;
+    *m_stream << std::endl;
 }
 
 
 void PlyWriter::writeTriangle(const Triangle& t, size_t offset)
 {
-    if (m_format == Format::Ascii)
-    {
-        *m_stream << "3 " << (t.m_a + offset) << " " <<
-            (t.m_b + offset) << " " << (t.m_c + offset) << std::endl;
-    }
-    else if (m_format == Format::BinaryLe)
-    {
-        OLeStream out(m_stream);
-        unsigned char count = 3;
-        uint32_t a = (uint32_t)(t.m_a + offset);
-        uint32_t b = (uint32_t)(t.m_b + offset);
-        uint32_t c = (uint32_t)(t.m_c + offset);
-        out << count << a << b << c;
-    }
-    else if (m_format == Format::BinaryBe)
-    {
-        OBeStream out(m_stream);
-        unsigned char count = 3;
-        uint32_t a = (uint32_t)(t.m_a + offset);
-        uint32_t b = (uint32_t)(t.m_b + offset);
-        uint32_t c = (uint32_t)(t.m_c + offset);
-        out << count << a << b << c;
-    }
+    *m_stream << "3 " << (t.m_a + offset) << " " <<
+        (t.m_b + offset) << " " << (t.m_c + offset) << std::endl;
 }
 
 
@@ -243,13 +267,24 @@ void PlyWriter::writeTriangle(const Triangle& t, size_t offset)
 // point views to be written.
 void PlyWriter::done(PointTableRef table)
 {
+    // Binary points and faces are written in blocks.  Text is written a
+    // value at a time.
     for (auto& v : m_views)
     {
-        PointRef point(*v, 0);
-        for (PointId idx = 0; idx < v->size(); ++idx)
+        if (m_format == Format::BinaryLe)
+            writeBinaryPoints<LeInserter>(*m_stream, *v, m_dims,
+                table.layout());
+        else if (m_format == Format::BinaryBe)
+            writeBinaryPoints<BeInserter>(*m_stream, *v, m_dims,
+                table.layout());
+        else
         {
-            point.setPointId(idx);
-            writePoint(point, table.layout());
+            PointRef point(*v, 0);
+            for (PointId idx = 0; idx < v->size(); ++idx)
+            {
+                point.setPointId(idx);
+                writePoint(point, table.layout());
+            }
         }
     }
     if (m_faces)
@@ -260,11 +295,14 @@ void PlyWriter::done(PointTableRef table)
             TriangularMesh *mesh = v->mesh();
             if (mesh)
             {
-                for (size_t id = 0; id < mesh->size(); ++id)
-                {
-                    const Triangle& t = (*mesh)[id];
-                    writeTriangle(t, offset);
-                }
+                if (m_format == Format::BinaryLe)
+                    writeBinaryFaces<LeInserter>(*m_stream, *mesh, offset);
+                else if (m_format == Format::BinaryBe)
+                    writeBinaryFaces<BeInserter>(*m_stream, *mesh, offset);
+                else
+                    mesh->visit(0, mesh->size(),
+                        [this, offset](PointId a, PointId b, PointId c)
+                        { writeTriangle(Triangle(a, b, c), offset); });
             }
             offset += v->size();
         }
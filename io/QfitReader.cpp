@@ -192,11 +192,9 @@ CREATE_STATIC_STAGE(QfitReader, s_info)
 std::string QfitReader::getName() const { return s_info.name; }
 
 QfitReader::QfitReader()
-    : pdal::Reader()
-    , m_format(QFIT_Format_Unknown)
+    : m_format(QFIT_Format_Unknown)
     , m_size(0)
     , m_littleEndian(false)
-    , m_istream()
 {}
 
 
@@ -267,6 +265,7 @@ void QfitReader::initialize()
 
 void QfitReader::addArgs(ProgramArgs& args)
 {
+    FixedRecordReader::addArgs(args);
     args.add("flip_coordinates", "Flip coordinates from 0-360 to -180-180",
         m_flip_x);
     args.add("scale_z", "Z scale. Use 0.001 to go from mm to m",
@@ -310,99 +309,102 @@ void QfitReader::addDimensions(PointLayoutPtr layout)
 
 void QfitReader::ready(PointTableRef)
 {
-    m_numPoints = m_point_bytes / m_size;
     if (m_point_bytes % m_size)
         throwError("Error calculating file point count.  File size is "
             "inconsistent with point size.");
-    m_index = 0;
-    m_istream.reset(new IStream(m_filename));
-    m_istream->seek(m_offset);
+    openRecords(m_offset, m_size, m_point_bytes / m_size);
 }
 
 
-point_count_t QfitReader::read(PointViewPtr data, point_count_t count)
+void QfitReader::decodeRecord(const char *rec, PointRef& point)
 {
-    if (!m_istream->good())
-        throwError("Corrupted file/file read error.");
-    if (m_istream->stream()->eof())
-        throwError("End of file detected.");
-
-    count = (std::min)(m_numPoints - m_index, count);
-    std::vector<char> buf(m_size);
-    PointId nextId = data->size();
-    point_count_t numRead = 0;
-    while (count--)
-    {
-        m_istream->get(buf);
-        SwitchableExtractor extractor(buf.data(), m_size, m_littleEndian);
+    int32_t words[MaxRecordWords];
+    SwitchableExtractor extractor(rec, m_size, m_littleEndian);
+    extractor.get(words, m_size / sizeof(int32_t));
+    decodeWords(words, point);
+}
 
-        // always read the base fields
-        {
-            int32_t time, y, xi, z, start_pulse, reflected_pulse, scan_angle,
-                pitch, roll;
-            extractor >> time >> y >> xi >> z >> start_pulse >>
-                reflected_pulse >> scan_angle >> pitch >> roll;
-            double x = xi / 1000000.0;
-            if (m_flip_x && x > 180)
-                x -= 360;
-
-            data->setField(Dimension::Id::OffsetTime, nextId, time);
-            data->setField(Dimension::Id::Y, nextId, y / 1000000.0);
-            data->setField(Dimension::Id::X, nextId, x);
-            data->setField(Dimension::Id::Z, nextId, z * m_scale_z);
-            data->setField(Dimension::Id::StartPulse, nextId, start_pulse);
-            data->setField(Dimension::Id::ReflectedPulse, nextId,
-                reflected_pulse);
-            data->setField(Dimension::Id::Azimuth, nextId,
-                scan_angle / 1000.0);
-            data->setField(Dimension::Id::Pitch, nextId, pitch / 1000.0);
-            data->setField(Dimension::Id::Roll, nextId, roll / 1000.0);
-        }
 
-        if (m_format == QFIT_Format_12)
-        {
-            int32_t pdop, pulse_width;
-            extractor >> pdop >> pulse_width;
-            data->setField(Dimension::Id::Pdop, nextId, pdop / 10.0);
-            data->setField(Dimension::Id::PulseWidth, nextId, pulse_width);
-        }
-        else if (m_format == QFIT_Format_14)
+// Records are made only of 32-bit words, so a batch of them is converted
+// to host order at once.
+void QfitReader::decodeRecords(const char *rec, point_count_t count,
+    PointView& view, PointId begin)
+{
+    const size_t BlockRecords = 4096;
+    const size_t recWords = m_size / sizeof(int32_t);
+    std::vector<int32_t> words(BlockRecords * recWords);
+    PointRef point(view, begin);
+    for (point_count_t done = 0; done < count;)
+    {
+        const size_t n = (size_t)(std::min)((point_count_t)BlockRecords,
+            count - done);
+        SwitchableExtractor extractor(rec, n * m_size, m_littleEndian);
+        extractor.get(words.data(), n * recWords);
+        for (size_t i = 0; i < n; ++i)
         {
-            int32_t passive_signal, passive_y, passive_x, passive_z;
-            extractor >> passive_signal >> passive_y >> passive_x >> passive_z;
-            double x = passive_x / 1000000.0;
-            if (m_flip_x && x > 180)
-                x -= 360;
-            data->setField(Dimension::Id::PassiveSignal, nextId, passive_signal);
-            data->setField(Dimension::Id::PassiveY, nextId,
-                passive_y / 1000000.0);
-            data->setField(Dimension::Id::PassiveX, nextId, x);
-            data->setField(Dimension::Id::PassiveZ, nextId,
-                passive_z * m_scale_z);
+            point.setPointId(begin + done + i);
+            decodeWords(words.data() + i * recWords, point);
         }
-        // GPS time is really a GPS offset from the start of the GPS day
-        // encoded in this odd way: 153320100 = 15 hours 33 minutes
-        // 20 seconds 100 milliseconds.
-        // Not sure why we have that AND the other offset time.  For now
-        // we'll just extract this time and drop it.
-        int32_t gpstime;
-        extractor >> gpstime;
-
-        if (m_cb)
-            m_cb(*data, nextId);
-
-        numRead++;
-        nextId++;
+        rec += n * m_size;
+        done += n;
     }
-    m_index += numRead;
-
-    return numRead;
 }
 
 
-void QfitReader::done(PointTableRef)
+void QfitReader::decodeWords(const int32_t *w, PointRef& point)
 {
-    m_istream.reset();
+    // always read the base fields
+    {
+        const int32_t time = w[0];
+        const int32_t y = w[1];
+        const int32_t xi = w[2];
+        const int32_t z = w[3];
+        const int32_t start_pulse = w[4];
+        const int32_t reflected_pulse = w[5];
+        const int32_t scan_angle = w[6];
+        const int32_t pitch = w[7];
+        const int32_t roll = w[8];
+        double x = xi / 1000000.0;
+        if (m_flip_x && x > 180)
+            x -= 360;
+
+        point.setField(Dimension::Id::OffsetTime, time);
+        point.setField(Dimension::Id::Y, y / 1000000.0);
+        point.setField(Dimension::Id::X, x);
+        point.setField(Dimension::Id::Z, z * m_scale_z);
+        point.setField(Dimension::Id::StartPulse, start_pulse);
+        point.setField(Dimension::Id::ReflectedPulse, reflected_pulse);
+        point.setField(Dimension::Id::Azimuth, scan_angle / 1000.0);
+        point.setField(Dimension::Id::Pitch, pitch / 1000.0);
+        point.setField(Dimension::Id::Roll, roll / 1000.0);
+    }
+
+    if (m_format == QFIT_Format_12)
+    {
+        const int32_t pdop = w[9];
+        const int32_t pulse_width = w[10];
+        point.setField(Dimension::Id::Pdop, pdop / 10.0);
+        point.setField(Dimension::Id::PulseWidth, pulse_width);
+    }
+    else if (m_format == QFIT_Format_14)
+    {
+        const int32_t passive_signal = w[9];
+        const int32_t passive_y = w[10];
+        const int32_t passive_x = w[11];
+        const int32_t passive_z = w[12];
+        double x = passive_x / 1000000.0;
+        if (m_flip_x && x > 180)
+            x -= 360;
+        point.setField(Dimension::Id::PassiveSignal, passive_signal);
+        point.setField(Dimension::Id::PassiveY, passive_y / 1000000.0);
+        point.setField(Dimension::Id::PassiveX, x);
+        point.setField(Dimension::Id::PassiveZ, passive_z * m_scale_z);
+    }
+    // GPS time is really a GPS offset from the start of the GPS day
+    // encoded in this odd way: 153320100 = 15 hours 33 minutes
+    // 20 seconds 100 milliseconds.
+    // Not sure why we have that AND the other offset time.  For now
+    // we'll just ignore it.
 }
 
 } // namespace pdal
@@ -37,7 +37,7 @@
 #include <memory>
 #include <vector>
 
-#include <pdal/Reader.hpp>
+#include <pdal/FixedRecordReader.hpp>
 #include <pdal/Options.hpp>
 #include <pdal/util/IStream.hpp>
 
@@ -52,8 +52,11 @@ enum QFIT_Format_Type
     QFIT_Format_Unknown = 128
 };
 
-class PDAL_DLL QfitReader : public pdal::Reader
+class PDAL_DLL QfitReader : public FixedRecordReader
 {
+    // The largest record, format 14, has 14 words.
+    static const size_t MaxRecordWords = 14;
+
 public:
     QfitReader();
 
@@ -67,16 +70,15 @@ private:
     bool m_flip_x;
     double m_scale_z;
     bool m_littleEndian;
-    point_count_t m_numPoints;
-    std::unique_ptr<IStream> m_istream;
-    point_count_t m_index;
 
     virtual void addArgs(ProgramArgs& args);
     virtual void initialize();
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void ready(PointTableRef table);
-    virtual point_count_t read(PointViewPtr buf, point_count_t count);
-    virtual void done(PointTableRef table);
+    virtual void decodeRecord(const char *rec, PointRef& point);
+    virtual void decodeRecords(const char *rec, point_count_t count,
+        PointView& view, PointId begin);
+    void decodeWords(const int32_t *words, PointRef& point);
 
     QfitReader& operator=(const QfitReader&) = delete;
     QfitReader(const QfitReader&) = delete;
@@ -36,6 +36,7 @@
 #include "SbetCommon.hpp"
 
 #include <pdal/PointRef.hpp>
+#include <pdal/util/Extractor.hpp>
 #include <pdal/util/FileUtils.hpp>
 
 #define _USE_MATH_DEFINES
@@ -58,6 +59,7 @@ std::string SbetReader::getName() const { return s_info.name; }
 
 void SbetReader::addArgs(ProgramArgs& args)
 {
+    FixedRecordReader::addArgs(args);
     args.add("angles_as_degrees", "Convert all angles to degrees", m_anglesAsDegrees, true);
 }
 
@@ -73,64 +75,27 @@ void SbetReader::ready(PointTableRef)
     size_t pointSize = sbet::fileDimensions().size() * sizeof(double);
     if (fileSize % pointSize != 0)
         throwError("Invalid file size.");
-    m_numPts = fileSize / pointSize;
-    m_index = 0;
-    m_stream.reset(new ILeStream(m_filename));
     m_dims = sbet::fileDimensions();
-    seek(m_index);
+    openRecords(0, pointSize, fileSize / pointSize);
 }
 
 
-bool SbetReader::processOne(PointRef& point)
+void SbetReader::decodeRecord(const char *rec, PointRef& point)
 {
     auto radiansToDegrees = [](double radians) {
         return radians * 180.0 / M_PI;
     };
+    LeExtractor extractor(rec, m_dims.size() * sizeof(double));
     for (auto di = m_dims.begin(); di != m_dims.end(); ++di)
     {
         double d;
-        *m_stream >> d;
+        extractor >> d;
         Dimension::Id dim = *di;
         if (m_anglesAsDegrees && sbet::isAngularDimension(dim)) {
             d = radiansToDegrees(d);
         }
         point.setField(dim, d);
     }
-    return (m_stream->good());
-}
-
-
-point_count_t SbetReader::read(PointViewPtr view, point_count_t count)
-{
-    PointId nextId = view->size();
-    PointId idx = m_index;
-    point_count_t numRead = 0;
-    seek(idx);
-    while (numRead < count && idx < m_numPts)
-    {
-        PointRef point = view->point(nextId);
-        processOne(point);
-        if (m_cb)
-            m_cb(*view, nextId);
-
-        idx++;
-        nextId++;
-        numRead++;
-    }
-    m_index = idx;
-    return numRead;
-}
-
-
-bool SbetReader::eof()
-{
-    return m_index >= m_numPts;
-}
-
-
-void SbetReader::seek(PointId idx)
-{
-    m_stream->seek(idx * sizeof(double) * sbet::fileDimensions().size());
 }
 
 } // namespace pdal
@@ -34,39 +34,29 @@
 
 #pragma once
 
+#include <pdal/FixedRecordReader.hpp>
 #include <pdal/PointView.hpp>
-#include <pdal/Reader.hpp>
-#include <pdal/Streamable.hpp>
-#include <pdal/util/IStream.hpp>
 #include <pdal/util/ProgramArgs.hpp>
 
 namespace pdal
 {
 
-class PDAL_DLL SbetReader : public Reader, public Streamable
+class PDAL_DLL SbetReader : public FixedRecordReader
 {
 public:
-    SbetReader() : Reader()
+    SbetReader()
         {}
 
     std::string getName() const;
 
 private:
-    std::unique_ptr<ILeStream> m_stream;
-    // Number of points in the file.
-    point_count_t m_numPts;
-    point_count_t m_index;
     Dimension::IdList m_dims;
     bool m_anglesAsDegrees;
 
-    virtual bool processOne(PointRef& point);
     virtual void addArgs(ProgramArgs& args);
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void ready(PointTableRef table);
-    virtual point_count_t read(PointViewPtr view, point_count_t count);
-    virtual bool eof();
-
-    void seek(PointId idx);
+    virtual void decodeRecord(const char *rec, PointRef& point);
 };
 
 } // namespace pdal
@@ -33,6 +33,9 @@
 ****************************************************************************/
 
 #include "TIndexReader.hpp"
+
+#include <thread>
+
 #include <pdal/GDALUtils.hpp>
 #include <pdal/util/ProgramArgs.hpp>
 
@@ -74,19 +77,35 @@ TIndexReader::FieldIndexes TIndexReader::getFields()
 }
 
 
-std::vector<TIndexReader::FileInfo> TIndexReader::getFiles()
+std::vector<TIndexReader::FileInfo> TIndexReader::getFiles(
+    OGRGeometryH filter)
 {
     std::vector<TIndexReader::FileInfo> output;
 
     OGR_L_ResetReading(m_layer);
     FieldIndexes indexes = getFields();
 
+    point_count_t skipped = 0;
     while (true)
     {
         OGRFeatureH feature = OGR_L_GetNextFeature(m_layer);
         if (!feature)
             break;
 
+        // Some OGR drivers only check the spatial filter against the
+        // envelope of a tile.  Skip tiles whose boundary doesn't actually
+        // intersect the filter so they're never opened.
+        if (filter)
+        {
+            OGRGeometryH tile = OGR_F_GetGeometryRef(feature);
+            if (tile && !OGR_G_Intersects(tile, filter))
+            {
+                skipped++;
+                OGR_F_Destroy(feature);
+                continue;
+            }
+        }
+
         FileInfo fileInfo;
         fileInfo.m_filename =
             OGR_F_GetFieldAsString(feature, indexes.m_filename);
@@ -96,6 +115,9 @@ std::vector<TIndexReader::FileInfo> TIndexReader::getFiles()
 
         OGR_F_Destroy(feature);
     }
+    if (skipped)
+        log()->get(LogLevel::Debug) << "Skipped " << skipped << " tiles "
+            "outside of the query geometry." << std::endl;
 
     return output;
 }
@@ -125,6 +147,8 @@ void TIndexReader::addArgs(ProgramArgs& args)
         "with lyr_name", m_attributeFilter);
     args.add("dialect", "OGR SQL dialect to use when querying tile "
         "index layer", m_dialect, "OGRSQL");
+    args.add("threads", "Number of files to read at the same time.  The "
+        "default is the number of cores.", m_threads);
 }
 
 
@@ -211,7 +235,10 @@ void TIndexReader::initialize()
     if (m_wkt.size())
         cropOptions.add("polygon", m_wkt);
 
-    for (auto f : getFiles())
+    m_readers.clear();
+    std::vector<FileInfo> files = getFiles(wkt_g ? wkt_g->get() : nullptr);
+    m_fileCount = files.size();
+    for (auto f : files)
     {
         log()->get(LogLevel::Debug) << "Adding file " << f.m_filename <<
             " to merge filter" << std::endl;
@@ -240,6 +267,8 @@ void TIndexReader::initialize()
             repro->setOptions(reproOptions);
             premerge = repro;
         }
+        else
+            m_readers.push_back(dynamic_cast<Reader *>(reader));
 
         // WKT is set even if we're using a bounding box for filtering, so
         // can be used as a test here.
@@ -270,6 +299,15 @@ void TIndexReader::initialize()
     m_dataset = 0;
 }
 
+// Bounds are in the output coordinate system, so they can only be passed
+// to readers whose points aren't reprojected.
+void TIndexReader::restrictBounds(const BOX3D& bounds)
+{
+    for (Reader *r : m_readers)
+        if (r)
+            r->restrictBounds(bounds);
+}
+
 void TIndexReader::prepared(PointTableRef table)
 {
     m_merge.prepare(table);
@@ -277,7 +315,12 @@ void TIndexReader::prepared(PointTableRef table)
 
 void TIndexReader::ready(PointTableRef table)
 {
-    m_pvSet = m_merge.execute(table);
+    // Each file is an independent branch of the merge, so the files
+    // can be read concurrently.
+    size_t threads = m_threads ? m_threads :
+        std::thread::hardware_concurrency();
+    threads = (std::min)(threads, m_fileCount);
+    m_pvSet = m_merge.execute(table, (int)(std::max)(threads, size_t(1)));
 }
 
 
@@ -62,7 +62,7 @@ class PDAL_DLL TIndexReader : public Reader
     };
 
 public:
-    TIndexReader() : m_dataset(NULL) , m_layer(NULL)
+    TIndexReader() : m_dataset(NULL) , m_layer(NULL), m_fileCount(0)
         {}
 
     std::string getName() const;
@@ -71,6 +71,7 @@ private:
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void addArgs(ProgramArgs& args);
     virtual void initialize();
+    virtual void restrictBounds(const BOX3D& bounds);
     virtual void prepared(PointTableRef table);
     virtual void ready(PointTableRef table);
     virtual PointViewSet run(PointViewPtr view);
@@ -86,6 +87,7 @@ private:
     std::string m_dialect;
     BOX2D m_bounds;
     std::string m_sql;
+    size_t m_threads;
 
     std::unique_ptr<gdal::SpatialRef> m_out_ref;
     void *m_dataset;
@@ -93,9 +95,11 @@ private:
 
     StageFactory m_factory;
     MergeFilter m_merge;
+    std::vector<Reader *> m_readers;
     PointViewSet m_pvSet;
+    size_t m_fileCount;
 
-    std::vector<FileInfo> getFiles();
+    std::vector<FileInfo> getFiles(OGRGeometryH filter);
     FieldIndexes getFields();
 };
 
@@ -133,20 +133,23 @@ void TerrasolidReader::addDimensions(PointLayoutPtr layout)
 
 void TerrasolidReader::ready(PointTableRef)
 {
-    m_istream.reset(new IStream(m_filename));
-    // Skip to the beginning of points.
-    m_istream->seek(56);
-    m_index = 0;
+    // Points start after the header.
+    openRecords(56, m_size, getNumPoints());
+
+    // Times are offsets from the time of the first point.
+    m_baseTime = 0;
+    if (m_haveTime && numRecords())
+    {
+        const size_t timeOffset = (m_format == TERRASOLID_Format_1) ? 16 : 20;
+        LeExtractor extractor(record(0) + timeOffset, sizeof(m_baseTime));
+        extractor >> m_baseTime;
+    }
 }
 
 
-point_count_t TerrasolidReader::read(PointViewPtr view, point_count_t count)
+void TerrasolidReader::decodeRecord(const char *rec, PointRef& point)
 {
-    count = (std::min)(count, getNumPoints() - m_index);
-
-    std::vector<char> buf(m_size * count);
-    m_istream->get(buf);
-    LeExtractor extractor(buf.data(), buf.size());
+    LeExtractor extractor(rec, m_size);
 
     // See https://www.terrasolid.com/download/tscan.pdf
     // This spec is awful, but it's something.
@@ -155,114 +158,92 @@ point_count_t TerrasolidReader::read(PointViewPtr view, point_count_t count)
     // says.
     // Also modified the fetch of time/color based on header flag (rather
     // than just not write the data into the buffer).
-    PointId nextId = view->size();
-    while (!eof())
+    if (m_format == TERRASOLID_Format_1)
     {
-        if (m_format == TERRASOLID_Format_1)
-        {
-            uint8_t classification, flight_line, echo_int, x, y, z;
-
-            extractor >> classification >> flight_line >> echo_int >> x >> y >>
-                z;
-
-            view->setField(Dimension::Id::Classification, nextId,
-                          classification);
-            view->setField(Dimension::Id::PointSourceId, nextId, flight_line);
-            switch (echo_int)
-            {
-            case 0: // only echo
-                view->setField(Dimension::Id::ReturnNumber, nextId, 1);
-                view->setField(Dimension::Id::NumberOfReturns, nextId, 1);
-                break;
-            case 1: // first of many echos
-                view->setField(Dimension::Id::ReturnNumber, nextId, 1);
-                break;
-            default: // intermediate echo or last of many echos
-                break;
-            }
-            view->setField(Dimension::Id::X, nextId,
-                          (x - m_header->OrgX) / m_header->Units);
-            view->setField(Dimension::Id::Y, nextId,
-                          (y - m_header->OrgY) / m_header->Units);
-            view->setField(Dimension::Id::Z, nextId,
-                          (z - m_header->OrgZ) / m_header->Units);
-        }
+        uint8_t classification, flight_line, echo_int, x, y, z;
 
-        if (m_format == TERRASOLID_Format_2)
-        {
-            int32_t x, y, z;
-            uint8_t classification, echo_int, flag, mark;
-            uint16_t flight_line, intensity;
-
-            extractor >> x >> y >> z >> classification >> echo_int >> flag >>
-                mark >> flight_line >> intensity;
-
-            view->setField(Dimension::Id::X, nextId,
-                          (x - m_header->OrgX) / m_header->Units);
-            view->setField(Dimension::Id::Y, nextId,
-                          (y - m_header->OrgY) / m_header->Units);
-            view->setField(Dimension::Id::Z, nextId,
-                          (z - m_header->OrgZ) / m_header->Units);
-            view->setField(Dimension::Id::Classification, nextId,
-                          classification);
-            switch (echo_int)
-            {
-            case 0: // only echo
-                view->setField(Dimension::Id::ReturnNumber, nextId, 1);
-                view->setField(Dimension::Id::NumberOfReturns, nextId, 1);
-                break;
-            case 1: // first of many echos
-                view->setField(Dimension::Id::ReturnNumber, nextId, 1);
-                break;
-            default: // intermediate echo or last of many echos
-                break;
-            }
-            view->setField(Dimension::Id::Flag, nextId, flag);
-            view->setField(Dimension::Id::Mark, nextId, mark);
-            view->setField(Dimension::Id::PointSourceId, nextId, flight_line);
-            view->setField(Dimension::Id::Intensity, nextId, intensity);
-        }
+        extractor >> classification >> flight_line >> echo_int >> x >> y >>
+            z;
 
-        if (m_haveTime)
+        point.setField(Dimension::Id::Classification, classification);
+        point.setField(Dimension::Id::PointSourceId, flight_line);
+        switch (echo_int)
         {
-            uint32_t t;
-
-            extractor >> t;
-
-            if (m_index == 0)
-                m_baseTime = t;
-            t -= m_baseTime; // Offset from the beginning of the read.
-            // instead of GPS week.
-            t /= 5; // 5000ths of a second to milliseconds
-            view->setField(Dimension::Id::OffsetTime, nextId, t);
+        case 0: // only echo
+            point.setField(Dimension::Id::ReturnNumber, 1);
+            point.setField(Dimension::Id::NumberOfReturns, 1);
+            break;
+        case 1: // first of many echos
+            point.setField(Dimension::Id::ReturnNumber, 1);
+            break;
+        default: // intermediate echo or last of many echos
+            break;
         }
+        point.setField(Dimension::Id::X,
+            (x - m_header->OrgX) / m_header->Units);
+        point.setField(Dimension::Id::Y,
+            (y - m_header->OrgY) / m_header->Units);
+        point.setField(Dimension::Id::Z,
+            (z - m_header->OrgZ) / m_header->Units);
+    }
 
-        if (m_haveColor)
+    if (m_format == TERRASOLID_Format_2)
+    {
+        int32_t x, y, z;
+        uint8_t classification, echo_int, flag, mark;
+        uint16_t flight_line, intensity;
+
+        extractor >> x >> y >> z >> classification >> echo_int >> flag >>
+            mark >> flight_line >> intensity;
+
+        point.setField(Dimension::Id::X,
+            (x - m_header->OrgX) / m_header->Units);
+        point.setField(Dimension::Id::Y,
+            (y - m_header->OrgY) / m_header->Units);
+        point.setField(Dimension::Id::Z,
+            (z - m_header->OrgZ) / m_header->Units);
+        point.setField(Dimension::Id::Classification, classification);
+        switch (echo_int)
         {
-            uint8_t red, green, blue, alpha;
-
-            extractor >> red >> green >> blue >> alpha;
-
-            view->setField(Dimension::Id::Red, nextId, red);
-            view->setField(Dimension::Id::Green, nextId, green);
-            view->setField(Dimension::Id::Blue, nextId, blue);
-            view->setField(Dimension::Id::Alpha, nextId, alpha);
+        case 0: // only echo
+            point.setField(Dimension::Id::ReturnNumber, 1);
+            point.setField(Dimension::Id::NumberOfReturns, 1);
+            break;
+        case 1: // first of many echos
+            point.setField(Dimension::Id::ReturnNumber, 1);
+            break;
+        default: // intermediate echo or last of many echos
+            break;
         }
+        point.setField(Dimension::Id::Flag, flag);
+        point.setField(Dimension::Id::Mark, mark);
+        point.setField(Dimension::Id::PointSourceId, flight_line);
+        point.setField(Dimension::Id::Intensity, intensity);
+    }
+
+    if (m_haveTime)
+    {
+        uint32_t t;
 
-        if (m_cb)
-            m_cb(*view, nextId);
+        extractor >> t;
 
-        nextId++;
-        m_index++;
+        t -= m_baseTime; // Offset from the beginning of the read.
+        // instead of GPS week.
+        t /= 5; // 5000ths of a second to milliseconds
+        point.setField(Dimension::Id::OffsetTime, t);
     }
 
-    return count;
-}
+    if (m_haveColor)
+    {
+        uint8_t red, green, blue, alpha;
 
+        extractor >> red >> green >> blue >> alpha;
 
-void TerrasolidReader::done(PointTableRef)
-{
-    m_istream.reset();
+        point.setField(Dimension::Id::Red, red);
+        point.setField(Dimension::Id::Green, green);
+        point.setField(Dimension::Id::Blue, blue);
+        point.setField(Dimension::Id::Alpha, alpha);
+    }
 }
 
 } // namespace pdal
@@ -35,7 +35,7 @@
 #pragma once
 
 #include <pdal/Options.hpp>
-#include <pdal/Reader.hpp>
+#include <pdal/FixedRecordReader.hpp>
 #include <pdal/util/IStream.hpp>
 
 #include <memory>
@@ -81,16 +81,17 @@ struct TerraSolidHeader
 
 typedef std::unique_ptr<TerraSolidHeader> TerraSolidHeaderPtr;
 
-class PDAL_DLL TerrasolidReader : public pdal::Reader
+class PDAL_DLL TerrasolidReader : public FixedRecordReader
 {
 public:
-    TerrasolidReader() : pdal::Reader(),
-        m_format(TERRASOLID_Format_Unknown)
+    TerrasolidReader() : m_format(TERRASOLID_Format_Unknown)
     {}
     std::string getName() const;
 
     point_count_t getNumPoints() const
         { return m_header->PntCnt; }
+    virtual point_count_t numPoints() const
+        { return m_header ? getNumPoints() : 0; }
 
     const TerraSolidHeader& getHeader() const { return *m_header; }
 
@@ -105,16 +106,11 @@ private:
     bool m_haveColor;
     bool m_haveTime;
     uint32_t m_baseTime;
-    std::unique_ptr<IStream> m_istream;
-    point_count_t m_index;
 
     virtual void initialize();
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void ready(PointTableRef table);
-    virtual point_count_t read(PointViewPtr view, point_count_t count);
-    virtual void done(PointTableRef table);
-    virtual bool eof()
-        { return m_index >= getNumPoints(); }
+    virtual void decodeRecord(const char *rec, PointRef& point);
 
     TerrasolidReader& operator=(const TerrasolidReader&); // not implemented
     TerrasolidReader(const TerrasolidReader&); // not implemented
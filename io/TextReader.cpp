@@ -32,8 +32,13 @@
 * OF SUCH DAMAGE.
 ****************************************************************************/
 
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
 #include <pdal/PDALUtils.hpp>
 #include <pdal/util/Algorithm.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 #include "TextReader.hpp"
 #include "../filters/StatsFilter.hpp"
@@ -53,6 +58,19 @@ CREATE_STATIC_STAGE(TextReader, s_info)
 
 std::string TextReader::getName() const { return s_info.name; }
 
+TextReader::TextReader() : m_istream(NULL), m_pos(nullptr), m_end(nullptr),
+    m_valuePos(0)
+{}
+
+
+TextReader::~TextReader()
+{
+    if (m_map.addr())
+        FileUtils::unmapFile(m_map);
+    Utils::closeFile(m_istream);
+}
+
+
 // NOTE: - Forces reading of the entire file.
 QuickInfo TextReader::inspect()
 {
@@ -161,6 +179,11 @@ void TextReader::addArgs(ProgramArgs& args)
     args.add("header", "Use this string as the header line.", m_header);
     args.add("skip", "Skip this number of lines before attempting to "
         "read the header.", m_skip);
+    args.add("threads", "Number of threads used to parse points.  The "
+        "default is the number of cores.", m_threads);
+    args.add("read_ahead", "Size in MiB of the windows of the file read "
+        "ahead on a background thread, rather than mapping the file.  0 "
+        "reads as needed", m_readAhead);
 }
 
 
@@ -182,13 +205,41 @@ void TextReader::addDimensions(PointLayoutPtr layout)
 
 void TextReader::ready(PointTableRef table)
 {
-    m_istream = Utils::openFile(m_filename, false);
+    m_istream = Utils::openFile(m_filename, false, m_readAhead * 1024 * 1024);
     if (!m_istream)
         throwError("Unable to open text file '" + m_filename + "'.");
 
     std::string dummy;
     for (size_t i = 0; i < m_line; ++i)
-	std::getline(*m_istream, dummy);
+        std::getline(*m_istream, dummy);
+
+    // Values of dimensions that aren't in the layout aren't converted.
+    m_convert.clear();
+    for (Dimension::Id id : m_dims)
+        m_convert.push_back(table.layout()->hasDim(id));
+
+    m_values.clear();
+    m_valuePos = 0;
+    m_buf.clear();
+    m_pos = m_end = nullptr;
+
+    // Read the points from a mapping of the file if we can.
+    const std::istream::pos_type offset = m_istream->tellg();
+    if (offset != std::istream::pos_type(-1) && !m_readAhead)
+        m_map = FileUtils::mapFile(m_filename);
+    if (m_map.addr())
+    {
+        FileUtils::adviseSequential(m_map);
+        m_pos = (const char *)m_map.addr() + offset;
+        m_end = (const char *)m_map.addr() + m_map.m_size;
+        Utils::closeFile(m_istream);
+        m_istream = nullptr;
+    }
+
+    const size_t threads = m_threads ? m_threads :
+        std::max(std::thread::hardware_concurrency(), 1U);
+    if (threads > 1)
+        m_pool.reset(new ThreadPool(threads, threads));
 }
 
 
@@ -211,62 +262,233 @@ point_count_t TextReader::read(PointViewPtr view, point_count_t numPts)
 
 bool TextReader::processOne(PointRef& point)
 {
-    if (!fillFields())
-        return false;
+    const size_t numDims = m_dims.size();
+    while (m_valuePos == m_values.size())
+        if (!nextBatch())
+            return false;
 
-    double d;
-    for (size_t i = 0; i < m_fields.size(); ++i)
-    {
-        if (!Utils::fromString(m_fields[i], d))
-        {
-            log()->get(LogLevel::Error) << "Can't convert "
-                "field '" << m_fields[i] << "' to numeric value on line " <<
-                m_line << " in '" << m_filename << "'.  Setting to 0." <<
-                std::endl;
-            d = 0;
-        }
-        point.setField(m_dims[i], d);
-    }
+    const double *values = m_values.data() + m_valuePos;
+    for (size_t i = 0; i < numDims; ++i)
+        if (m_convert[i])
+            point.setField(m_dims[i], values[i]);
+    m_valuePos += numDims;
     return true;
 }
 
 
-bool TextReader::fillFields()
+struct TextReader::Batch
+{
+    struct Error
+    {
+        size_t m_line;
+        bool m_badCount;
+        size_t m_numFields;
+        std::string m_field;
+    };
+
+    std::vector<double> m_values;
+    std::vector<Error> m_errors;
+    size_t m_lines = 0;
+};
+
+
+bool TextReader::nextBatch()
 {
-    while (true)
+    // Lines are parsed ahead in blocks of about this size per thread.
+    const size_t blockSize = (1 << 22) * (m_pool ? m_pool->size() : 1);
+
+    const char *begin;
+    const char *end;
+    if (m_map.addr())
     {
+        if (m_pos >= m_end)
+            return false;
+        begin = m_pos;
+        end = begin + (std::min)(blockSize, (size_t)(m_end - begin));
+        if (end != m_end)
+        {
+            const char *eol = (const char *)memchr(end, '\n', m_end - end);
+            end = eol ? eol + 1 : m_end;
+        }
+        m_pos = end;
+    }
+    else
+    {
+        // m_buf holds any partial line left from the previous block.  Read
+        // until it holds a whole line or the input ends.
+        size_t lineEnd = 0;
+        while (!lineEnd && m_istream->good())
+        {
+            const size_t size = m_buf.size();
+            m_buf.resize(size + blockSize);
+            m_istream->read(m_buf.data() + size, blockSize);
+            m_buf.resize(size + (size_t)m_istream->gcount());
+            for (size_t i = m_buf.size(); i > size; --i)
+                if (m_buf[i - 1] == '\n')
+                {
+                    lineEnd = i;
+                    break;
+                }
+        }
         if (!m_istream->good())
+            lineEnd = m_buf.size();
+        if (!lineEnd)
             return false;
 
-        std::string buf;
+        // Only the partial line at the end is copied back to m_buf.
+        m_block.swap(m_buf);
+        m_buf.assign(m_block.begin() + lineEnd, m_block.end());
+        m_block.resize(lineEnd);
+        begin = m_block.data();
+        end = begin + m_block.size();
+    }
 
-        std::getline(*m_istream, buf);
-        m_line++;
-        if (buf.empty())
+    // Split the block at line boundaries into a piece per thread.
+    const size_t threads = m_pool ? m_pool->size() : 1;
+    const size_t pieceSize = (end - begin) / threads + 1;
+    std::vector<const char *> bounds { begin };
+    while (bounds.back() < end)
+    {
+        const char *pos = bounds.back() +
+            (std::min)(pieceSize, (size_t)(end - bounds.back()));
+        if (pos < end)
+        {
+            const char *eol = (const char *)memchr(pos, '\n', end - pos);
+            pos = eol ? eol + 1 : end;
+        }
+        bounds.push_back(pos);
+    }
+
+    std::vector<Batch> batches(bounds.size() - 1);
+    if (batches.size() == 1)
+        parseLines(bounds[0], bounds[1], batches[0]);
+    else
+    {
+        for (size_t i = 0; i < batches.size(); ++i)
+            m_pool->add([this, &bounds, &batches, i]()
+                { parseLines(bounds[i], bounds[i + 1], batches[i]); });
+        m_pool->await();
+    }
+
+    m_values.clear();
+    m_valuePos = 0;
+    for (Batch& batch : batches)
+    {
+        for (const Batch::Error& err : batch.m_errors)
+        {
+            if (err.m_badCount)
+                log()->get(LogLevel::Error) << "Line " <<
+                    (m_line + err.m_line) << " in '" << m_filename <<
+                    "' contains " << err.m_numFields << " fields when " <<
+                    m_dims.size() << " were expected.  Ignoring." <<
+                    std::endl;
+            else
+                log()->get(LogLevel::Error) << "Can't convert "
+                    "field '" << err.m_field << "' to numeric value on "
+                    "line " << (m_line + err.m_line) << " in '" <<
+                    m_filename << "'.  Setting to 0." << std::endl;
+        }
+        m_values.insert(m_values.end(), batch.m_values.begin(),
+            batch.m_values.end());
+        m_line += batch.m_lines;
+    }
+    return true;
+}
+
+
+void TextReader::parseLines(const char *begin, const char *end,
+    Batch& batch) const
+{
+    const size_t numDims = m_dims.size();
+    std::vector<std::pair<const char *, const char *>> fields;
+    std::string field;
+
+    while (begin < end)
+    {
+        const char *pos = begin;
+        const char *eol = (const char *)memchr(begin, '\n', end - begin);
+        if (!eol)
+            eol = end;
+        begin = (eol < end) ? eol + 1 : end;
+        batch.m_lines++;
+
+        if (pos == eol)
             continue;
+
+        // Spaces are ignored when there's some other separator.  A line
+        // of nothing but spaces has no fields.
+        fields.clear();
         if (m_separator != ' ')
         {
-            Utils::remove(buf, ' ');
-            m_fields = Utils::split(buf, m_separator);
+            if (std::find_if(pos, eol, [](char c){ return c != ' '; }) != eol)
+                while (true)
+                {
+                    const char *sep = std::find(pos, eol, m_separator);
+                    fields.emplace_back(pos, sep);
+                    if (sep == eol)
+                        break;
+                    pos = sep + 1;
+                }
         }
         else
-            m_fields = Utils::split2(buf, m_separator);
-        if (m_fields.size() != m_dims.size())
         {
-            log()->get(LogLevel::Error) << "Line " << m_line <<
-                " in '" << m_filename << "' contains " << m_fields.size() <<
-                " fields when " << m_dims.size() << " were expected.  "
-                "Ignoring." << std::endl;
+            while (pos < eol)
+            {
+                if (*pos == ' ')
+                {
+                    pos++;
+                    continue;
+                }
+                const char *sep = std::find(pos, eol, ' ');
+                fields.emplace_back(pos, sep);
+                pos = sep;
+            }
+        }
+
+        if (fields.size() != numDims)
+        {
+            batch.m_errors.push_back(
+                { batch.m_lines, true, fields.size(), "" });
             continue;
         }
-        return true;
+
+        for (size_t i = 0; i < numDims; ++i)
+        {
+            double d = 0;
+            if (m_convert[i])
+            {
+                // Copy the field so that it's terminated for strtod().
+                field.clear();
+                for (const char *c = fields[i].first; c != fields[i].second;
+                        ++c)
+                    if (*c != ' ')
+                        field += *c;
+
+                char *numEnd;
+                d = std::strtod(field.c_str(), &numEnd);
+                if (numEnd == field.c_str())
+                {
+                    batch.m_errors.push_back(
+                        { batch.m_lines, false, 0, field });
+                    d = 0;
+                }
+            }
+            batch.m_values.push_back(d);
+        }
     }
 }
 
 
 void TextReader::done(PointTableRef table)
 {
+    if (m_map.addr())
+        FileUtils::unmapFile(m_map);
     Utils::closeFile(m_istream);
+    m_istream = nullptr;
+    m_pool.reset();
+    m_values.clear();
+    m_buf.clear();
+    m_block.clear();
 }
 
 
@@ -35,20 +35,24 @@
 #pragma once
 
 #include <istream>
+#include <memory>
 
 #include <pdal/Reader.hpp>
 #include <pdal/Streamable.hpp>
+#include <pdal/util/FileUtils.hpp>
 
 namespace pdal
 {
 
+class ThreadPool;
+
 class PDAL_DLL TextReader : public Reader, public Streamable
 {
 public:
     std::string getName() const;
 
-    TextReader() : m_istream(NULL)
-    {}
+    TextReader();
+    ~TextReader();
 
 private:
     /**
@@ -79,6 +83,8 @@ private:
       \param layout  Layout to which the dimenions are added.
     */
     virtual void addDimensions(PointLayoutPtr layout);
+    virtual bool dimensionsUsed(PointLayoutPtr, Dimension::IdList&) const
+        { return true; }
 
     /**
       Reopen the file in preparation for reading.
@@ -111,7 +117,23 @@ private:
     */
     virtual bool processOne(PointRef& point);
 
-    bool fillFields();
+    /**
+      Parse the next block of lines from the input into m_values.
+
+      \return  False if there's no more input.
+    */
+    bool nextBatch();
+
+    struct Batch;
+
+    /**
+      Parse lines of text into field values.
+
+      \param begin  Start of the text.
+      \param end  End of the text.
+      \param batch  Batch to which values and errors are added.
+    */
+    void parseLines(const char *begin, const char *end, Batch& batch) const;
 
     /**
       Parse a header line into a list of dimension names.
@@ -135,10 +157,25 @@ private:
     std::istream *m_istream;
     StringList m_dimNames;
     Dimension::IdList m_dims;
-    StringList m_fields;
+    std::vector<bool> m_convert;
     size_t m_line;
     std::string m_header;
     size_t m_skip;
+    size_t m_threads;
+    size_t m_readAhead;
+    std::unique_ptr<ThreadPool> m_pool;
+
+    // Input is read from a mapping of the file where possible and otherwise
+    // from the stream through m_buf.
+    FileUtils::MapContext m_map;
+    const char *m_pos;
+    const char *m_end;
+    std::vector<char> m_buf;
+    std::vector<char> m_block;
+
+    // Values of the lines parsed ahead, m_dims.size() per point.
+    std::vector<double> m_values;
+    size_t m_valuePos;
 };
 
 } // namespace pdal
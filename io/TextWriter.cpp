@@ -39,8 +39,12 @@
 #include <pdal/PointView.hpp>
 #include <pdal/util/Algorithm.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
+#include <cmath>
+#include <cstdio>
 #include <iostream>
+#include <thread>
 
 namespace pdal
 {
@@ -55,6 +59,81 @@ static StaticPluginInfo const s_info
 
 CREATE_STATIC_STAGE(TextWriter, s_info)
 
+namespace
+{
+
+// Formatted points are written to the file in blocks of about this size.
+const size_t BlockSize = 1 << 20;
+
+// Number of points formatted by one task when writing in parallel.
+const size_t PointsPerTask = 1 << 15;
+
+// Append a value formatted as an ostream set to std::fixed would format it,
+// which is the same as printf's "%.*f".
+void appendFixed(std::string& buf, double d, size_t precision)
+{
+    // The value scaled by 10^precision is rounded to an integer and
+    // printed directly when the rounding can't be in doubt: the scaled value
+    // is small enough to have plenty of fractional bits and isn't near a
+    // half.  Otherwise printf does the work.
+    static const double powers[] = { 1, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+        1e8, 1e9 };
+    if (precision < sizeof(powers) / sizeof(powers[0]) && std::isfinite(d))
+    {
+        const double scaled = std::fabs(d) * powers[precision];
+        if (scaled < (double)(1ULL << 40))
+        {
+            const double whole = std::floor(scaled);
+            const double frac = scaled - whole;
+            if (std::fabs(frac - .5) > 1.0 / (1 << 10))
+            {
+                uint64_t n = (uint64_t)whole + (frac > .5 ? 1 : 0);
+
+                char tmp[32];
+                char *end = tmp + sizeof(tmp);
+                char *pos = end;
+                for (size_t i = 0; i < precision; ++i)
+                {
+                    *--pos = '0' + n % 10;
+                    n /= 10;
+                }
+                if (precision)
+                    *--pos = '.';
+                do
+                {
+                    *--pos = '0' + n % 10;
+                    n /= 10;
+                } while (n);
+                if (std::signbit(d))
+                    *--pos = '-';
+                buf.append(pos, end);
+                return;
+            }
+        }
+    }
+
+    char tmp[128];
+    int len = snprintf(tmp, sizeof(tmp), "%.*f", (int)precision, d);
+    if (len < (int)sizeof(tmp))
+        buf.append(tmp, len);
+    else
+    {
+        std::vector<char> big(len + 1);
+        snprintf(big.data(), big.size(), "%.*f", (int)precision, d);
+        buf.append(big.data(), len);
+    }
+}
+
+} // unnamed namespace
+
+TextWriter::TextWriter()
+{}
+
+
+TextWriter::~TextWriter()
+{}
+
+
 std::string TextWriter::getName() const { return s_info.name; }
 
 std::istream& operator >> (std::istream& in, TextWriter::OutputType& type)
@@ -81,19 +160,16 @@ std::ostream& operator << (std::ostream& out,
     return out;
 }
 
-struct FileStreamDeleter
+void FileStreamDeleter::operator()(std::ostream *out) const
 {
-
-    template <typename T>
-    void operator()(T* ptr)
+    try
     {
-        if (ptr)
-        {
-            ptr->flush();
-            Utils::closeFile(ptr);
-        }
+        out->flush();
+        Utils::closeFile(out);
     }
-};
+    catch (...)
+    {}
+}
 
 
 void TextWriter::addArgs(ProgramArgs& args)
@@ -110,13 +186,14 @@ void TextWriter::addArgs(ProgramArgs& args)
     args.add("quote_header", "Whether a header should be quoted",
         m_quoteHeader, true);
     args.add("precision", "Output precision", m_precision, 3);
+    args.add("threads", "Number of threads used to format points.  The "
+        "default is the number of cores.", m_threads);
 }
 
 
 void TextWriter::initialize(PointTableRef table)
 {
-    m_stream = FileStreamPtr(Utils::createFile(m_filename, true),
-        FileStreamDeleter());
+    m_stream = FileStreamPtr(Utils::createFile(m_filename, true, true));
     if (!m_stream)
         throwError("Couldn't open '" + m_filename + "' for output.");
 }
@@ -155,6 +232,25 @@ TextWriter::DimSpec TextWriter::extractDim(std::string dim, PointTableRef table)
 }
 
 
+// Only the listed dimensions are used if we're not writing the rest.
+bool TextWriter::dimensionsUsed(PointLayoutPtr layout,
+    Dimension::IdList& dims) const
+{
+    if (m_dimOrder.empty() || m_writeAllDims)
+        return false;
+
+    StringList dimNames = Utils::split2(m_dimOrder, ',');
+    for (std::string dim : dimNames)
+    {
+        Utils::trim(dim);
+        StringList s = Utils::split(dim, ':');
+        if (s.size())
+            dims.push_back(layout->findDim(s[0]));
+    }
+    return true;
+}
+
+
 bool TextWriter::findDim(Dimension::Id id, DimSpec& ds)
 {
     auto it = std::find_if(m_dims.begin(), m_dims.end(),
@@ -170,6 +266,11 @@ void TextWriter::ready(PointTableRef table)
 {
     *m_stream << std::fixed;
 
+    const size_t threads = m_threads ? m_threads :
+        std::max(std::thread::hardware_concurrency(), 1U);
+    if (threads > 1)
+        m_pool.reset(new ThreadPool(threads, threads));
+
     m_xDim = { Dimension::Id::X, static_cast<size_t>(m_precision),
         table.layout()->dimName(Dimension::Id::X) };
     m_yDim = { Dimension::Id::Y, static_cast<size_t>(m_precision),
@@ -232,7 +333,18 @@ void TextWriter::writeFooter()
         if (m_callback.size())
             *m_stream  <<")";
     }
-    m_stream.reset();
+    // Close the file here rather than in the deleter so that a failure to
+    // finish it (an upload to remote storage, for instance) is reported.
+    m_stream->flush();
+    try
+    {
+        Utils::closeFile(m_stream.release());
+    }
+    catch (const pdal_error& err)
+    {
+        throwError(err.what());
+    }
+    m_pool.reset();
 }
 
 
@@ -262,56 +374,73 @@ void TextWriter::writeCSVHeader(PointTableRef table)
 }
 
 
-void TextWriter::processOneCSV(PointRef& point)
+void TextWriter::formatCSV(std::string& buf, PointRef& point) const
 {
     for (auto di = m_dims.begin(); di != m_dims.end(); ++di)
     {
         if (di != m_dims.begin())
-            *m_stream << m_delimiter;
-        m_stream->precision(di->precision);
-        *m_stream << point.getFieldAs<double>(di->id);
+            buf += m_delimiter;
+        appendFixed(buf, point.getFieldAs<double>(di->id), di->precision);
     }
-    *m_stream << m_newline;
+    buf += m_newline;
 }
 
-void TextWriter::processOneGeoJSON(PointRef& point)
+
+void TextWriter::formatGeoJSON(std::string& buf, PointRef& point) const
 {
     if (m_idx)
-        *m_stream << ",";
-    *m_stream << "{ \"type\":\"Feature\",\"geometry\": "
+        buf += ",";
+    buf += "{ \"type\":\"Feature\",\"geometry\": "
         "{ \"type\": \"Point\", \"coordinates\": [";
 
-    m_stream->precision(m_xDim.precision);
-    *m_stream << point.getFieldAs<double>(Dimension::Id::X) << ",";
-    m_stream->precision(m_yDim.precision);
-    *m_stream << point.getFieldAs<double>(Dimension::Id::Y) << ",";
-    m_stream->precision(m_zDim.precision);
-    *m_stream << point.getFieldAs<double>(Dimension::Id::Z) << "]},";
+    appendFixed(buf, point.getFieldAs<double>(Dimension::Id::X),
+        m_xDim.precision);
+    buf += ",";
+    appendFixed(buf, point.getFieldAs<double>(Dimension::Id::Y),
+        m_yDim.precision);
+    buf += ",";
+    appendFixed(buf, point.getFieldAs<double>(Dimension::Id::Z),
+        m_zDim.precision);
+    buf += "]},";
 
-    *m_stream << "\"properties\": {";
+    buf += "\"properties\": {";
 
     for (auto di = m_dims.begin(); di != m_dims.end(); ++di)
     {
         if (di != m_dims.begin())
-            *m_stream << ",";
+            buf += ",";
 
-        *m_stream << "\"" << di->name << "\":";
-        *m_stream << "\"";
-        m_stream->precision(di->precision);
-        *m_stream << point.getFieldAs<double>(di->id);
-        *m_stream <<"\"";
+        buf += "\"" + di->name + "\":";
+        buf += "\"";
+        appendFixed(buf, point.getFieldAs<double>(di->id), di->precision);
+        buf += "\"";
     }
-    *m_stream << "}"; // end properties
-    *m_stream << "}"; // end feature
+    buf += "}"; // end properties
+    buf += "}"; // end feature
 }
 
 
-bool TextWriter::processOne(PointRef& point)
+void TextWriter::format(std::string& buf, PointRef& point) const
 {
     if (m_outputType == OutputType::CSV)
-        processOneCSV(point);
-    else
-        processOneGeoJSON(point);
+        formatCSV(buf, point);
+    else if (m_outputType == OutputType::GEOJSON)
+        formatGeoJSON(buf, point);
+}
+
+
+void TextWriter::flush()
+{
+    m_stream->write(m_buf.data(), m_buf.size());
+    m_buf.clear();
+}
+
+
+bool TextWriter::processOne(PointRef& point)
+{
+    format(m_buf, point);
+    if (m_buf.size() >= BlockSize)
+        flush();
     m_idx++;
     return true;
 }
@@ -319,25 +448,56 @@ bool TextWriter::processOne(PointRef& point)
 
 void TextWriter::write(const PointViewPtr view)
 {
-    PointRef point(*view, 0);
-
-    if (m_outputType == OutputType::CSV)
+    if (!m_pool || view->size() <= PointsPerTask)
+    {
+        PointRef point(*view, 0);
         for (PointId idx = 0; idx < view->size(); ++idx)
         {
             point.setPointId(idx);
-            processOneCSV(point);
+            format(m_buf, point);
+            if (m_buf.size() >= BlockSize)
+                flush();
         }
-    else if (m_outputType == OutputType::GEOJSON)
-        for (PointId idx = 0; idx < view->size(); ++idx)
+        flush();
+        return;
+    }
+
+    // Ranges of points are formatted in parallel, a round of one range per
+    // thread at a time, and written in order.
+    const size_t threads = m_pool->size();
+    std::vector<std::string> bufs(threads);
+    for (PointId start = 0; start < view->size();
+        start += threads * PointsPerTask)
+    {
+        for (size_t i = 0; i < threads; ++i)
         {
-            point.setPointId(idx);
-            processOneGeoJSON(point);
+            const PointId begin = start + i * PointsPerTask;
+            const PointId end = (std::min)(begin + PointsPerTask,
+                (PointId)view->size());
+            bufs[i].clear();
+            if (begin >= end)
+                continue;
+            m_pool->add([this, &view, &bufs, i, begin, end]()
+            {
+                PointRef point(*view, begin);
+                for (PointId idx = begin; idx < end; ++idx)
+                {
+                    point.setPointId(idx);
+                    format(bufs[i], point);
+                }
+            });
         }
+        m_pool->await();
+
+        for (const std::string& buf : bufs)
+            m_stream->write(buf.data(), buf.size());
+    }
 }
 
 
 void TextWriter::done(PointTableRef /*table*/)
 {
+    flush();
     writeFooter();
     getMetadata().addList("filename", m_filename);
 }
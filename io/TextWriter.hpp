@@ -34,13 +34,23 @@
 
 #pragma once
 
+#include <memory>
+
 #include <pdal/Streamable.hpp>
 #include <pdal/Writer.hpp>
 
 namespace pdal
 {
 
-typedef std::shared_ptr<std::ostream> FileStreamPtr;
+class ThreadPool;
+
+// Closes a stream created by Utils::createFile().  Errors are ignored, so
+// a stream that's finished normally should be closed explicitly.
+struct FileStreamDeleter
+{
+    void operator()(std::ostream *out) const;
+};
+typedef std::unique_ptr<std::ostream, FileStreamDeleter> FileStreamPtr;
 
 class PDAL_DLL TextWriter : public Writer, public Streamable
 {
@@ -62,8 +72,8 @@ class PDAL_DLL TextWriter : public Writer, public Streamable
         const OutputType& type);
 
 public:
-    TextWriter()
-    {}
+    TextWriter();
+    ~TextWriter();
 
     std::string getName() const;
 
@@ -71,6 +81,8 @@ private:
     virtual void addArgs(ProgramArgs& args);
     virtual void initialize(PointTableRef table);
     virtual void ready(PointTableRef table);
+    virtual bool dimensionsUsed(PointLayoutPtr layout,
+        Dimension::IdList& dims) const;
     virtual void write(const PointViewPtr view);
     virtual void done(PointTableRef table);
     virtual bool processOne(PointRef& point);
@@ -79,8 +91,10 @@ private:
     void writeFooter();
     void writeGeoJSONHeader();
     void writeCSVHeader(PointTableRef table);
-    void processOneCSV(PointRef& point);
-    void processOneGeoJSON(PointRef& point);
+    void formatCSV(std::string& buf, PointRef& point) const;
+    void formatGeoJSON(std::string& buf, PointRef& point) const;
+    void format(std::string& buf, PointRef& point) const;
+    void flush();
 
     DimSpec extractDim(std::string dim, PointTableRef table);
     bool findDim(Dimension::Id id, DimSpec& ds);
@@ -96,9 +110,12 @@ private:
     bool m_quoteHeader;
     bool m_packRgb;
     int m_precision;
+    size_t m_threads;
     PointId m_idx;
 
     FileStreamPtr m_stream;
+    std::string m_buf;
+    std::unique_ptr<ThreadPool> m_pool;
     std::vector<DimSpec> m_dims;
     DimSpec m_xDim;
     DimSpec m_yDim;
@@ -0,0 +1,158 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "EptCache.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <sstream>
+
+#include <pdal/pdal_types.hpp>
+#include <pdal/util/FileUtils.hpp>
+
+namespace pdal
+{
+
+EptCache::EptCache(const std::string& dir, const std::string& root,
+        uint64_t maxSize) : m_maxSize(maxSize), m_size(0)
+{
+    std::ostringstream oss;
+    oss << std::hex << std::hash<std::string>()(root);
+    m_dir = dir + "/" + oss.str() + "/";
+    if (!FileUtils::createDirectories(m_dir) &&
+            !FileUtils::directoryExists(m_dir))
+        throw pdal_error("Unable to create cache directory '" + m_dir + "'.");
+
+    // Load the files of every dataset in the cache, oldest first.
+    std::vector<std::pair<int64_t, Entry>> files;
+    for (const std::string& sub : FileUtils::directoryList(dir))
+    {
+        if (!FileUtils::isDirectory(sub))
+            continue;
+        for (const std::string& file : FileUtils::directoryList(sub))
+        {
+            Entry e { file, FileUtils::fileSize(file) };
+            files.push_back(std::make_pair(FileUtils::lastWriteTime(file), e));
+        }
+    }
+    std::stable_sort(files.begin(), files.end(),
+        [](const std::pair<int64_t, Entry>& a,
+            const std::pair<int64_t, Entry>& b)
+        { return a.first < b.first; });
+
+    for (auto& f : files)
+    {
+        m_size += f.second.m_size;
+        m_entries.push_back(f.second);
+        m_index[f.second.m_path] = std::prev(m_entries.end());
+    }
+    evict();
+}
+
+
+std::string EptCache::path(const std::string& name) const
+{
+    std::string filename(name);
+    std::replace(filename.begin(), filename.end(), '/', '_');
+    return m_dir + filename;
+}
+
+
+std::string EptCache::find(const std::string& name)
+{
+    const std::string filename(path(name));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_index.find(filename);
+    if (it == m_index.end())
+        return std::string();
+
+    // Move to the most recently used end.
+    m_entries.splice(m_entries.end(), m_entries, it->second);
+    FileUtils::touchFile(filename);
+    return filename;
+}
+
+
+std::string EptCache::insert(const std::string& name,
+    const std::vector<char>& data)
+{
+    const std::string filename(path(name));
+
+    // Write to a temporary file and rename it so that readers in other
+    // processes never see part of a file.
+    const std::string temp(FileUtils::uniqueFilename(m_dir, "tmp-"));
+    std::ostream *out = FileUtils::createFile(temp);
+    if (!out)
+        throw pdal_error("Unable to create cache file '" + temp + "'.");
+    out->write(data.data(), data.size());
+    const bool ok = (bool)*out;
+    FileUtils::closeFile(out);
+    if (!ok)
+    {
+        FileUtils::deleteFile(temp);
+        throw pdal_error("Unable to write cache file '" + temp + "'.");
+    }
+    FileUtils::renameFile(filename, temp);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_index.find(filename);
+    if (it != m_index.end())
+    {
+        m_size -= it->second->m_size;
+        m_entries.erase(it->second);
+    }
+    m_entries.push_back(Entry { filename, data.size() });
+    m_index[filename] = std::prev(m_entries.end());
+    m_size += data.size();
+    evict();
+    return filename;
+}
+
+
+// Remove the least recently used files, except the most recent, until the
+// cache fits.
+void EptCache::evict()
+{
+    while (m_size > m_maxSize && m_entries.size() > 1)
+    {
+        const Entry& e = m_entries.front();
+        FileUtils::deleteFile(e.m_path);
+        m_size -= e.m_size;
+        m_index.erase(e.m_path);
+        m_entries.pop_front();
+    }
+}
+
+} // namespace pdal
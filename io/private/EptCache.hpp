@@ -0,0 +1,85 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <pdal/pdal_export.hpp>
+
+namespace pdal
+{
+
+// Copies of EPT data files on local disk.  Files are kept in a subdirectory
+// for each dataset.  When the files in the cache directory exceed the
+// maximum size, the least recently used are removed.  Use is tracked
+// with file modification times so that it persists between runs.
+class PDAL_DLL EptCache
+{
+public:
+    EptCache(const std::string& dir, const std::string& root,
+        uint64_t maxSize);
+
+    // Return the path of the cached copy of 'name', or an empty string if
+    // it isn't cached.
+    std::string find(const std::string& name);
+    // Cache 'data' as the content of 'name' and return the path of the
+    // cached copy.
+    std::string insert(const std::string& name, const std::vector<char>& data);
+
+private:
+    struct Entry
+    {
+        std::string m_path;
+        uint64_t m_size;
+    };
+    typedef std::list<Entry> EntryList;
+
+    std::string path(const std::string& name) const;
+    void evict();
+
+    std::mutex m_mutex;
+    std::string m_dir;
+    uint64_t m_maxSize;
+    uint64_t m_size;
+    EntryList m_entries;    // Least recently used first.
+    std::map<std::string, EntryList::iterator> m_index;
+};
+
+} // namespace pdal
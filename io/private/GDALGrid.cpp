@@ -39,6 +39,7 @@
 #include <limits>
 #include <iostream>
 #include <pdal/pdal_types.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 namespace pdal
 {
@@ -54,7 +55,8 @@ namespace pdal
 GDALGrid::GDALGrid(size_t width, size_t height, double edgeLength,
         double radius, int outputTypes, size_t windowSize) :
     m_width(width), m_height(height), m_windowSize(windowSize),
-    m_edgeLength(edgeLength), m_radius(radius), m_outputTypes(outputTypes)
+    m_edgeLength(edgeLength), m_radius(radius), m_outputTypes(outputTypes),
+    m_threads(1)
 {
     if (width > (std::numeric_limits<int>::max)() ||
         height > (std::numeric_limits<int>::max)())
@@ -144,21 +146,21 @@ void GDALGrid::expand(size_t width, size_t height, size_t xshift, size_t yshift)
 }
 
 
-int GDALGrid::numBands() const
+int GDALGrid::numBands(int outputTypes)
 {
     int num = 0;
 
-    if (m_outputTypes & statCount)
+    if (outputTypes & statCount)
         num++;
-    if (m_outputTypes & statMin)
+    if (outputTypes & statMin)
         num++;
-    if (m_outputTypes & statMax)
+    if (outputTypes & statMax)
         num++;
-    if (m_outputTypes & statMean)
+    if (outputTypes & statMean)
         num++;
-    if (m_outputTypes & statIdw)
+    if (outputTypes & statIdw)
         num++;
-    if (m_outputTypes & statStdDev)
+    if (outputTypes & statStdDev)
         num++;
     return num;
 }
@@ -183,6 +185,35 @@ double *GDALGrid::data(const std::string& name)
 
 
 void GDALGrid::addPoint(double x, double y, double z)
+{
+    addPoint(x, y, z, 0, (int)m_height);
+}
+
+
+void GDALGrid::addPoints(const std::vector<double>& x,
+    const std::vector<double>& y, const std::vector<double>& z)
+{
+    // Each task owns a band of rows and updates only cells in that band,
+    // so every cell sees its points in the same order as when they're
+    // added one at a time.
+    auto addBand = [this, &x, &y, &z](size_t jBegin, size_t jEnd)
+    {
+        for (size_t k = 0; k < x.size(); ++k)
+        {
+            // Rows within the radius of the point, padded by one to
+            // stay clear of rounding at cell edges.
+            int jLow = verticalIndex(y[k] + m_radius) - 1;
+            int jHigh = verticalIndex(y[k] - m_radius) + 1;
+            if (jHigh < (int)jBegin || jLow >= (int)jEnd)
+                continue;
+            addPoint(x[k], y[k], z[k], (int)jBegin, (int)jEnd);
+        }
+    };
+    runParallel(m_height, addBand);
+}
+
+
+void GDALGrid::addPoint(double x, double y, double z, int jMin, int jMax)
 {
     int iOrigin = horizontalIndex(x);
     int jOrigin = verticalIndex(y);
@@ -220,10 +251,11 @@ void GDALGrid::addPoint(double x, double y, double z)
     int iStart, jStart;
     // First quadrant;
     i = iStart = (std::max)(0, iOrigin + 1);
-    j = (std::min)(jOrigin, int(m_height - 1));
-    while (i < (int)m_width && j >= 0)
+    j = (std::min)(jOrigin, jMax - 1);
+    while (j >= jMin)
     {
-        double d = distance(i, j, x, y);
+        // Cells past the edge of the grid end the row or column.
+        double d = i < (int)m_width ? distance(i, j, x, y) : m_radius;
         if (d < m_radius)
         {
             update(i, j, z, d);
@@ -240,10 +272,10 @@ void GDALGrid::addPoint(double x, double y, double z)
 
     // Second quadrant;
     i = (std::min)(iOrigin, int(m_width - 1));
-    j = jStart = (std::min)(jOrigin - 1, int(m_height - 1));
-    while (i >= 0 && j >= 0)
+    j = jStart = (std::min)(jOrigin - 1, jMax - 1);
+    while (i >= 0)
     {
-        double d = distance(i, j, x, y);
+        double d = j >= jMin ? distance(i, j, x, y) : m_radius;
         if (d < m_radius)
         {
             update(i, j, z, d);
@@ -260,10 +292,10 @@ void GDALGrid::addPoint(double x, double y, double z)
 
     // Third quadrant;
     i = iStart = (std::min)(iOrigin - 1, int(m_width - 1));
-    j = (std::max)(jOrigin, 0);
-    while (i >= 0 && j < (int)m_height)
+    j = (std::max)(jOrigin, jMin);
+    while (j < jMax)
     {
-        double d = distance(i, j, x, y);
+        double d = i >= 0 ? distance(i, j, x, y) : m_radius;
         if (d < m_radius)
         {
             update(i, j, z, d);
@@ -279,10 +311,10 @@ void GDALGrid::addPoint(double x, double y, double z)
     }
     // Fourth quadrant;
     i = (std::max)(iOrigin, 0);
-    j = jStart = (std::max)(jOrigin + 1, 0);
-    while (i < (int)m_width && j < (int)m_height)
+    j = jStart = (std::max)(jOrigin + 1, jMin);
+    while (i < (int)m_width)
     {
-        double d = distance(i, j, x, y);
+        double d = j < jMax ? distance(i, j, x, y) : m_radius;
         if (d < m_radius)
         {
             update(i, j, z, d);
@@ -301,8 +333,8 @@ void GDALGrid::addPoint(double x, double y, double z)
     // it just be counted?
     double d = distance(iOrigin, jOrigin, x, y);
     if (d < m_radius &&
-        iOrigin >= 0 && jOrigin >= 0 &&
-        iOrigin < (int)m_width && jOrigin < (int)m_height)
+        iOrigin >= 0 && jOrigin >= jMin &&
+        iOrigin < (int)m_width && jOrigin < jMax)
         update(iOrigin, jOrigin, z, d);
 }
 
@@ -372,31 +404,128 @@ void GDALGrid::update(size_t i, size_t j, double val, double dist)
 }
 
 void GDALGrid::finalize()
+{
+    finalizeStats();
+    fillEmpty(0, 0, width(), height());
+}
+
+
+void GDALGrid::finalizeStats()
 {
     // See
     // https://en.wikipedia.org/wiki/Algorithms_for_calculating_variance
     // https://en.wikipedia.org/wiki/Inverse_distance_weighting
-    if (m_stdDev)
-        for (size_t i = 0; i < m_count->size(); ++i)
-            if (!empty(i))
-                (*m_stdDev)[i] = sqrt((*m_stdDev)[i] / (*m_count)[i]);
+    auto finalizeRange = [this](size_t begin, size_t end)
+    {
+        if (m_stdDev)
+            for (size_t i = begin; i < end; ++i)
+                if (!empty(i))
+                    (*m_stdDev)[i] = sqrt((*m_stdDev)[i] / (*m_count)[i]);
 
-    if (m_idw)
-        for (size_t i = 0; i < m_count->size(); ++i)
-            if (!empty(i))
-            {
-                double& distSum = (*m_idwDist)[i];
+        if (m_idw)
+            for (size_t i = begin; i < end; ++i)
+                if (!empty(i))
+                {
+                    double& distSum = (*m_idwDist)[i];
+
+                    if (!std::isnan(distSum))
+                        (*m_idw)[i] /= distSum;
+                }
+    };
+    runParallel(m_count->size(), finalizeRange);
+}
 
-                if (!std::isnan(distSum))
-                    (*m_idw)[i] /= distSum;
-            }
 
-    if (m_windowSize > 0)
-        windowFill();
-    else
-        for (size_t i = 0; i < m_count->size(); ++i)
-            if (empty(i))
-                fillNodata(i);
+void GDALGrid::fillEmpty(size_t i0, size_t j0, size_t i1, size_t j1)
+{
+    // Filled cells stay empty, so they're never used as window fill sources.
+    // That makes every cell independent and the columns can be split
+    // among threads.
+    auto fillColumns = [this, i0, j0, j1](size_t begin, size_t end)
+    {
+        for (size_t i = i0 + begin; i < i0 + end; ++i)
+            for (size_t j = j0; j < j1; ++j)
+                if (empty(i, j))
+                {
+                    if (m_windowSize > 0)
+                        windowFill(i, j);
+                    else
+                        fillNodata(index(i, j));
+                }
+    };
+    runParallel(i1 - i0, fillColumns);
+}
+
+
+void GDALGrid::runParallel(size_t count,
+    const std::function<void(size_t, size_t)>& func)
+{
+    size_t threads = (std::min)(m_threads, count);
+    if (threads <= 1)
+    {
+        func(0, count);
+        return;
+    }
+
+    ThreadPool pool(threads, threads, false);
+    for (size_t t = 0; t < threads; ++t)
+    {
+        size_t begin = count * t / threads;
+        size_t end = count * (t + 1) / threads;
+        pool.add([&func, begin, end]()
+        {
+            func(begin, end);
+        });
+    }
+    pool.join();
+}
+
+
+void GDALGrid::copyCells(const GDALGrid& src, size_t srcI, size_t srcJ,
+    size_t dstI, size_t dstJ, size_t width, size_t height)
+{
+    auto copy = [&](const DataPtr& from, DataPtr& to)
+    {
+        if (!from || !to)
+            return;
+        for (size_t j = 0; j < height; ++j)
+        {
+            auto si = from->begin() + src.index(srcI, srcJ + j);
+            std::copy(si, si + width, to->begin() + index(dstI, dstJ + j));
+        }
+    };
+
+    copy(src.m_count, m_count);
+    copy(src.m_min, m_min);
+    copy(src.m_max, m_max);
+    copy(src.m_mean, m_mean);
+    copy(src.m_stdDev, m_stdDev);
+    copy(src.m_idw, m_idw);
+    copy(src.m_idwDist, m_idwDist);
+}
+
+
+void GDALGrid::save(std::ostream& out) const
+{
+    for (const DataPtr *v : { &m_count, &m_min, &m_max, &m_mean, &m_stdDev,
+            &m_idw, &m_idwDist })
+        if (*v)
+            out.write(reinterpret_cast<const char *>((*v)->data()),
+                (*v)->size() * sizeof(double));
+    if (!out)
+        throw error("Unable to write grid data.");
+}
+
+
+void GDALGrid::load(std::istream& in)
+{
+    for (DataPtr *v : { &m_count, &m_min, &m_max, &m_mean, &m_stdDev,
+            &m_idw, &m_idwDist })
+        if (*v)
+            in.read(reinterpret_cast<char *>((*v)->data()),
+                (*v)->size() * sizeof(double));
+    if (!in)
+        throw error("Unable to read grid data.");
 }
 
 
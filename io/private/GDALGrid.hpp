@@ -32,8 +32,14 @@
 * OF SUCH DAMAGE.
 ****************************************************************************/
 
+#pragma once
+
 #include <math.h>
+#include <algorithm>
+#include <functional>
+#include <istream>
 #include <memory>
+#include <ostream>
 #include <string>
 #include <vector>
 #include <stdexcept>
@@ -67,16 +73,49 @@ public:
     void expand(size_t width, size_t height, size_t xshift, size_t yshift);
 
     // Get the number of bands represented by this grid.
-    int numBands() const;
+    int numBands() const
+        { return numBands(m_outputTypes); }
+
+    // Get the number of bands produced for a set of output types.
+    static int numBands(int outputTypes);
 
     // Return a pointer to the data in a raster band, row-major ordered.
-    double *data(const std::string& name);
+    PDAL_DLL double *data(const std::string& name);
+
+    // Set the number of threads used to add points, finalize and fill.
+    void setThreads(size_t threads)
+        { m_threads = (std::max)(threads, size_t(1)); }
 
     // Add a point to the raster grid.
-    void addPoint(double x, double y, double z);
+    PDAL_DLL void addPoint(double x, double y, double z);
+
+    // Add points to the raster grid.  The result is the same as adding
+    // the points in order with addPoint().
+    PDAL_DLL void addPoints(const std::vector<double>& x,
+        const std::vector<double>& y, const std::vector<double>& z);
 
     // Compute final values after all points have been added.
-    void finalize();
+    PDAL_DLL void finalize();
+
+    // Compute final statistics of cells with points.  Called once after
+    // all points have been added.
+    void finalizeStats();
+
+    // Fill the empty cells in the rectangle [i0, i1) x [j0, j1) by window
+    // fill or with no data.  Cells outside the rectangle are only read.
+    void fillEmpty(size_t i0, size_t j0, size_t i1, size_t j1);
+
+    // Copy all values of a width x height rectangle of cells from 'src'
+    // at srcI, srcJ to this grid at dstI, dstJ.
+    void copyCells(const GDALGrid& src, size_t srcI, size_t srcJ,
+        size_t dstI, size_t dstJ, size_t width, size_t height);
+
+    // Write the cell values to a stream.
+    void save(std::ostream& out) const;
+
+    // Read cell values written by save() for a grid of the same size and
+    // output types.
+    void load(std::istream& in);
 
     size_t width() const
         { return m_width; }
@@ -102,6 +141,7 @@ private:
     DataPtr m_idwDist;
 
     int m_outputTypes;
+    size_t m_threads;
 
     // Find an index into the actual storage given a grid coordinate.
     size_t index(size_t i, size_t j) const
@@ -142,22 +182,19 @@ private:
         return sqrt(pow(x1 - x, 2) + pow(y1 - y, 2));
     }
 
+    // Add a point, updating only cells in rows [jMin, jMax).
+    void addPoint(double x, double y, double z, int jMin, int jMax);
+
+    // Run func(begin, end) over [0, count) split into one range per thread.
+    void runParallel(size_t count,
+        const std::function<void(size_t, size_t)>& func);
+
     // Update cell at i, j with value at a distance.
     void update(size_t i, size_t j, double val, double dist);
 
     // Fill cell at index \c i with the nondata value.
     void fillNodata(size_t i);
 
-    // Fill an empty cell with a value inverse-distance averaged from
-    // surrounding cells.
-    void windowFill()
-    {
-        for (size_t i = 0; i < width(); ++i)
-            for (size_t j = 0; j < height(); ++j)
-                if (empty(i, j))
-                    windowFill(i, j);
-    }
-
     // Fill empty cell at dstI, dstJ with inverse-distance weighted values
     // from neighboring cells.
     void windowFill(size_t dstI, size_t dstJ);
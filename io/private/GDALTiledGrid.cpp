@@ -0,0 +1,326 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "GDALTiledGrid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <pdal/util/FileUtils.hpp>
+
+namespace pdal
+{
+
+GDALTiledGrid::GDALTiledGrid(size_t width, size_t height, size_t tileSize,
+        size_t maxTiles, bool sorted, double edgeLength, double radius,
+        int outputTypes, size_t windowSize, WriteFunc writeFunc) :
+    m_width(width), m_height(height), m_tileSize(tileSize),
+    m_maxTiles((std::max)(maxTiles, (size_t)1)), m_sorted(sorted),
+    m_edgeLength(edgeLength), m_radius(radius), m_outputTypes(outputTypes),
+    m_windowSize(windowSize), m_writeFunc(writeFunc), m_nextRow(0),
+    m_frontRow((std::numeric_limits<int64_t>::min)()), m_spillEnd(0)
+{
+    if (m_width > (size_t)(std::numeric_limits<int>::max)() ||
+        m_height > (size_t)(std::numeric_limits<int>::max)())
+        throw GDALGrid::error("Grid width or height is too large. Try "
+            "setting bounds or increasing resolution.");
+    if (m_tileSize == 0)
+        throw GDALGrid::error("Tile size must be greater than 0.");
+    if (m_windowSize > m_tileSize)
+        throw GDALGrid::error("Window size can't exceed the tile size.");
+    m_tilesX = (m_width + m_tileSize - 1) / m_tileSize;
+    m_tilesY = (m_height + m_tileSize - 1) / m_tileSize;
+    m_tiles.resize(m_tilesX * m_tilesY);
+}
+
+
+GDALTiledGrid::~GDALTiledGrid()
+{
+    if (m_spillFilename.size())
+    {
+        m_spill.close();
+        FileUtils::deleteFile(m_spillFilename);
+    }
+}
+
+
+size_t GDALTiledGrid::tileWidth(size_t tx) const
+{
+    return (std::min)(m_tileSize, m_width - tx * m_tileSize);
+}
+
+
+size_t GDALTiledGrid::tileHeight(size_t ty) const
+{
+    return (std::min)(m_tileSize, m_height - ty * m_tileSize);
+}
+
+
+void GDALTiledGrid::addPoint(double x, double y, double z)
+{
+    const double e = m_edgeLength;
+    const int64_t reach = (int64_t)std::ceil(m_radius / e) + 1;
+
+    if (m_sorted)
+    {
+        // Cell row of the point, counted from the top of the grid.  Rows
+        // of points far outside of the grid are clamped.
+        double r = (double)m_height - 1 - std::floor(y / e);
+        r = (std::max)(-1.0, (std::min)(r, (double)(m_height + reach)));
+        int64_t row = (int64_t)r;
+
+        if (row < m_frontRow)
+            throw GDALGrid::error("Points aren't ordered by descending Y "
+                "as required by option 'sorted'.");
+        if (row > m_frontRow)
+        {
+            m_frontRow = row;
+
+            // No later point reaches the rows of cells more than the
+            // radius above this one.  Window fill of a row of tiles also
+            // reads the row below it, which must be complete as well.
+            int64_t done = (std::max)(m_frontRow - reach, (int64_t)0);
+            size_t rows = (std::min)((size_t)done / m_tileSize, m_tilesY);
+            if (m_windowSize && rows < m_tilesY && rows > 0)
+                rows--;
+            writeRows(rows);
+        }
+    }
+
+    // Find the cells whose centers may be within the radius of the point.
+    double colMin = std::floor((x - m_radius) / e);
+    double colMax = std::floor((x + m_radius) / e);
+    double rowMin = (double)m_height - 1 - std::floor((y + m_radius) / e);
+    double rowMax = (double)m_height - 1 - std::floor((y - m_radius) / e);
+    if (colMax < 0 || rowMax < 0 || colMin >= (double)m_width ||
+            rowMin >= (double)m_height)
+        return;
+    size_t col0 = (size_t)(std::max)(colMin, 0.0);
+    size_t col1 = (size_t)(std::min)(colMax, (double)m_width - 1);
+    size_t row0 = (size_t)(std::max)(rowMin, 0.0);
+    size_t row1 = (size_t)(std::min)(rowMax, (double)m_height - 1);
+
+    for (size_t ty = row0 / m_tileSize; ty <= row1 / m_tileSize; ++ty)
+        for (size_t tx = col0 / m_tileSize; tx <= col1 / m_tileSize; ++tx)
+        {
+            // Positions in a tile are relative to its lower-left corner.
+            double x0 = tx * m_tileSize * e;
+            double y0 = (m_height - ty * m_tileSize - tileHeight(ty)) * e;
+
+            tile(tx, ty).addPoint(x - x0, y - y0, z);
+            m_tiles[ty * m_tilesX + tx].m_dirty = true;
+        }
+}
+
+
+void GDALTiledGrid::finish()
+{
+    writeRows(m_tilesY);
+    if (m_spillFilename.size())
+    {
+        m_spill.close();
+        FileUtils::deleteFile(m_spillFilename);
+        m_spillFilename.clear();
+    }
+}
+
+
+GDALGrid& GDALTiledGrid::tile(size_t tx, size_t ty)
+{
+    size_t idx = ty * m_tilesX + tx;
+    Tile& t = m_tiles[idx];
+
+    if (t.m_released)
+        throw GDALGrid::error("Raster tile used after it was written.");
+    if (t.m_grid)
+    {
+        m_lru.splice(m_lru.begin(), m_lru, t.m_lru);
+        return *t.m_grid;
+    }
+
+    t.m_grid.reset(new GDALGrid(tileWidth(tx), tileHeight(ty), m_edgeLength,
+        m_radius, m_outputTypes, m_windowSize));
+    if (t.m_spilled)
+    {
+        m_spill.seekg(t.m_spillPos);
+        t.m_grid->load(m_spill);
+    }
+    m_lru.push_front(idx);
+    t.m_lru = m_lru.begin();
+
+    while (m_lru.size() > m_maxTiles)
+        evict();
+    return *t.m_grid;
+}
+
+
+void GDALTiledGrid::evict()
+{
+    Tile& t = m_tiles[m_lru.back()];
+    m_lru.pop_back();
+
+    // A tile that never held data or that is unchanged since it was last
+    // spilled is just dropped.
+    if (t.m_dirty)
+    {
+        if (m_spillFilename.empty())
+        {
+            m_spillFilename = FileUtils::uniqueFilename("", "pdal_tiles_");
+            m_spill.open(m_spillFilename, std::ios::in | std::ios::out |
+                std::ios::binary | std::ios::trunc);
+            if (!m_spill)
+                throw GDALGrid::error("Unable to open temporary tile file '" +
+                    m_spillFilename + "'.");
+        }
+        if (!t.m_spilled)
+            t.m_spillPos = m_spillEnd;
+        m_spill.seekp(t.m_spillPos);
+        t.m_grid->save(m_spill);
+        if (!t.m_spilled)
+            m_spillEnd = m_spill.tellp();
+        t.m_spilled = true;
+        t.m_dirty = false;
+    }
+    t.m_grid.reset();
+}
+
+
+void GDALTiledGrid::finalizeTile(size_t tx, size_t ty)
+{
+    Tile& t = m_tiles[ty * m_tilesX + tx];
+
+    if (t.m_finalized)
+        return;
+    t.m_finalized = true;
+    // A tile without data has nothing to finalize.
+    if (t.m_dirty || t.m_spilled)
+    {
+        tile(tx, ty).finalizeStats();
+        t.m_dirty = true;
+    }
+}
+
+
+void GDALTiledGrid::writeRows(size_t rowLimit)
+{
+    for (; m_nextRow < rowLimit; ++m_nextRow)
+        for (size_t tx = 0; tx < m_tilesX; ++tx)
+            writeTile(tx, m_nextRow);
+}
+
+
+void GDALTiledGrid::writeTile(size_t tx, size_t ty)
+{
+    const size_t col = tx * m_tileSize;
+    const size_t row = ty * m_tileSize;
+    const size_t w = tileWidth(tx);
+    const size_t h = tileHeight(ty);
+
+    if (m_windowSize == 0)
+    {
+        finalizeTile(tx, ty);
+        GDALGrid& grid = tile(tx, ty);
+        grid.fillEmpty(0, 0, w, h);
+        m_writeFunc(grid, col, row);
+        release(tx, ty);
+        return;
+    }
+
+    // Window fill reads cells up to the window size away, which may be in
+    // neighboring tiles.  Fill a copy of the tile padded with the cells of
+    // its neighbors.
+    const size_t c0 = col - (std::min)(col, m_windowSize);
+    const size_t c1 = (std::min)(m_width, col + w + m_windowSize);
+    const size_t r0 = row - (std::min)(row, m_windowSize);
+    const size_t r1 = (std::min)(m_height, row + h + m_windowSize);
+    GDALGrid padded(c1 - c0, r1 - r0, m_edgeLength, m_radius, m_outputTypes,
+        m_windowSize);
+
+    for (size_t ny = (ty ? ty - 1 : 0); ny <= (std::min)(ty + 1, m_tilesY - 1);
+            ++ny)
+        for (size_t nx = (tx ? tx - 1 : 0);
+                nx <= (std::min)(tx + 1, m_tilesX - 1); ++nx)
+        {
+            const size_t tc = nx * m_tileSize;
+            const size_t tr = ny * m_tileSize;
+            const size_t ic0 = (std::max)(tc, c0);
+            const size_t ic1 = (std::min)(tc + tileWidth(nx), c1);
+            const size_t ir0 = (std::max)(tr, r0);
+            const size_t ir1 = (std::min)(tr + tileHeight(ny), r1);
+            if (ic0 >= ic1 || ir0 >= ir1)
+                continue;
+
+            finalizeTile(nx, ny);
+            padded.copyCells(tile(nx, ny), ic0 - tc, ir0 - tr,
+                ic0 - c0, ir0 - r0, ic1 - ic0, ir1 - ir0);
+        }
+    padded.fillEmpty(col - c0, row - r0, col - c0 + w, row - r0 + h);
+
+    // Filled cells stay empty, so copying them back doesn't change the
+    // window fill of neighboring tiles.
+    GDALGrid& grid = tile(tx, ty);
+    grid.copyCells(padded, col - c0, row - r0, 0, 0, w, h);
+    m_tiles[ty * m_tilesX + tx].m_dirty = true;
+    m_writeFunc(grid, col, row);
+
+    // Tiles are written in row-major order.  A tile is no longer needed
+    // once it and all of its neighbors have been written.
+    const size_t written = ty * m_tilesX + tx;
+    for (size_t ny = (ty ? ty - 1 : 0); ny <= ty; ++ny)
+        for (size_t nx = (tx ? tx - 1 : 0); nx <= tx; ++nx)
+        {
+            size_t last = (std::min)(ny + 1, m_tilesY - 1) * m_tilesX +
+                (std::min)(nx + 1, m_tilesX - 1);
+            if (last <= written)
+                release(nx, ny);
+        }
+}
+
+
+void GDALTiledGrid::release(size_t tx, size_t ty)
+{
+    Tile& t = m_tiles[ty * m_tilesX + tx];
+
+    if (t.m_released)
+        return;
+    if (t.m_grid)
+    {
+        m_lru.erase(t.m_lru);
+        t.m_grid.reset();
+    }
+    t.m_released = true;
+}
+
+} // namespace pdal
@@ -0,0 +1,130 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "GDALGrid.hpp"
+
+namespace pdal
+{
+
+// A raster grid held as square tiles of GDALGrid.  At most a fixed number
+// of tiles are kept in memory.  The least recently used tiles are spilled
+// to a temporary file and read back when they're needed again.  Finished
+// tiles are passed to a callback in row-major order.
+class GDALTiledGrid
+{
+public:
+    // Called with a finished tile and the column and row of its upper-left
+    // cell in the full grid.
+    typedef std::function<void(GDALGrid& tile, size_t col, size_t row)>
+        WriteFunc;
+
+    // When 'sorted' is set, points must be added in order of descending Y.
+    // Rows of tiles are then finished as soon as no later point can reach
+    // them.
+    GDALTiledGrid(size_t width, size_t height, size_t tileSize,
+        size_t maxTiles, bool sorted, double edgeLength, double radius,
+        int outputTypes, size_t windowSize, WriteFunc writeFunc);
+    ~GDALTiledGrid();
+
+    // Add a point to the grid.  Positions are relative to the lower-left
+    // corner of the grid.
+    void addPoint(double x, double y, double z);
+
+    // Finish and write all tiles that haven't been written.
+    void finish();
+
+    size_t width() const
+        { return m_width; }
+
+    size_t height() const
+        { return m_height; }
+
+private:
+    struct Tile
+    {
+        Tile() : m_spilled(false), m_dirty(false), m_finalized(false),
+            m_released(false)
+        {}
+
+        std::unique_ptr<GDALGrid> m_grid;
+        std::list<size_t>::iterator m_lru;
+        std::streamoff m_spillPos;
+        bool m_spilled;    // Tile data is in the spill file.
+        bool m_dirty;      // Tile data changed since it was last spilled.
+        bool m_finalized;  // Cell statistics have been finalized.
+        bool m_released;   // Tile was written and is no longer needed.
+    };
+
+    size_t m_width;
+    size_t m_height;
+    size_t m_tileSize;
+    size_t m_maxTiles;
+    bool m_sorted;
+    double m_edgeLength;
+    double m_radius;
+    int m_outputTypes;
+    size_t m_windowSize;
+    WriteFunc m_writeFunc;
+
+    size_t m_tilesX;
+    size_t m_tilesY;
+    std::vector<Tile> m_tiles;
+    std::list<size_t> m_lru;  // Resident tiles, most recently used first.
+    size_t m_nextRow;         // Next row of tiles to write.
+    int64_t m_frontRow;       // Highest cell row reached by sorted input.
+    std::string m_spillFilename;
+    std::fstream m_spill;
+    std::streamoff m_spillEnd;
+
+    size_t tileWidth(size_t tx) const;
+    size_t tileHeight(size_t ty) const;
+    GDALGrid& tile(size_t tx, size_t ty);
+    void evict();
+    void finalizeTile(size_t tx, size_t ty);
+    void writeRows(size_t rowLimit);
+    void writeTile(size_t tx, size_t ty);
+    void release(size_t tx, size_t ty);
+};
+
+} // namespace pdal
@@ -0,0 +1,310 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <cstring>
+#include <vector>
+
+#include <pdal/pdal_types.hpp>
+#include <pdal/util/portable_endian.hpp>
+
+namespace pdal
+{
+
+// Values of the standard LAS dimensions for a batch of points, with one
+// buffer for each dimension.
+struct LasColumns
+{
+    void resize(point_count_t count)
+    {
+        m_x.resize(count);
+        m_y.resize(count);
+        m_z.resize(count);
+        m_rawX.resize(count);
+        m_rawY.resize(count);
+        m_rawZ.resize(count);
+        m_intensity.resize(count);
+        m_returnNumber.resize(count);
+        m_numberOfReturns.resize(count);
+        m_classFlags.resize(count);
+        m_scanChannel.resize(count);
+        m_scanDirectionFlag.resize(count);
+        m_edgeOfFlightLine.resize(count);
+        m_classification.resize(count);
+        m_scanAngle.resize(count);
+        m_userData.resize(count);
+        m_pointSourceId.resize(count);
+        m_gpsTime.resize(count);
+        m_red.resize(count);
+        m_green.resize(count);
+        m_blue.resize(count);
+        m_infrared.resize(count);
+    }
+
+    std::vector<double> m_x;
+    std::vector<double> m_y;
+    std::vector<double> m_z;
+    // Stored X, Y and Z, when they're kept as scaled integers.
+    std::vector<int32_t> m_rawX;
+    std::vector<int32_t> m_rawY;
+    std::vector<int32_t> m_rawZ;
+    std::vector<uint16_t> m_intensity;
+    std::vector<uint8_t> m_returnNumber;
+    std::vector<uint8_t> m_numberOfReturns;
+    std::vector<uint8_t> m_classFlags;
+    std::vector<uint8_t> m_scanChannel;
+    std::vector<uint8_t> m_scanDirectionFlag;
+    std::vector<uint8_t> m_edgeOfFlightLine;
+    std::vector<uint8_t> m_classification;
+    std::vector<float> m_scanAngle;
+    std::vector<uint8_t> m_userData;
+    std::vector<uint16_t> m_pointSourceId;
+    std::vector<double> m_gpsTime;
+    std::vector<uint16_t> m_red;
+    std::vector<uint16_t> m_green;
+    std::vector<uint16_t> m_blue;
+    std::vector<uint16_t> m_infrared;
+};
+
+
+// Layout of the point record of a LAS point format.  Only formats without
+// waveform data are described.
+template<int FORMAT>
+struct LasFormat
+{
+    static const bool v14 = (FORMAT >= 6);
+    static const bool time = (FORMAT == 1 || FORMAT >= 3);
+    static const bool color = (FORMAT == 2 || FORMAT == 3 || FORMAT == 7 ||
+        FORMAT == 8);
+    static const bool infrared = (FORMAT == 8);
+
+    static const size_t timeOffset = v14 ? 22 : 20;
+    static const size_t colorOffset = v14 ? 30 : (time ? 28 : 20);
+    static const size_t infraredOffset = colorOffset + 6;
+};
+
+
+namespace lascolumns
+{
+
+template<typename T>
+inline T get(const char *p);
+
+template<>
+inline uint8_t get(const char *p)
+    { return (uint8_t)*p; }
+
+template<>
+inline int8_t get(const char *p)
+    { return (int8_t)*p; }
+
+template<>
+inline uint16_t get(const char *p)
+{
+    uint16_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return le16toh(v);
+}
+
+template<>
+inline int16_t get(const char *p)
+    { return (int16_t)get<uint16_t>(p); }
+
+template<>
+inline int32_t get(const char *p)
+{
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return (int32_t)le32toh(v);
+}
+
+template<>
+inline double get(const char *p)
+{
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    v = le64toh(v);
+    double d;
+    std::memcpy(&d, &v, sizeof(d));
+    return d;
+}
+
+// Fetch a field from each of a set of records into a column.
+template<typename T, typename Op>
+inline void column(const char *buf, size_t pointLen, size_t offset,
+    point_count_t count, Op op)
+{
+    buf += offset;
+    for (point_count_t i = 0; i < count; ++i, buf += pointLen)
+        op(i, get<T>(buf));
+}
+
+} // namespace lascolumns
+
+
+/**
+  Decode a batch of point records of a LAS point format into columns.
+  Each field is decoded for all the points before moving on to the next,
+  so the loops are short and simple enough for the compiler to vectorize.
+
+  \param buf  Point records, one after the other.
+  \param pointLen  Length of each record, including any extra bytes.
+  \param count  Number of records.
+  \param scale  Scale of X, Y and Z, or null to copy the stored integers
+    to the raw columns without scaling them.
+  \param offset  Offset of X, Y and Z.
+  \param c  Columns to fill.  They must hold at least \ref count values.
+*/
+template<int FORMAT>
+void decodeLasPoints(const char *buf, size_t pointLen, point_count_t count,
+    const double *scale, const double *offset, LasColumns& c)
+{
+    using namespace lascolumns;
+    typedef LasFormat<FORMAT> F;
+
+    if (scale)
+    {
+        double *x = c.m_x.data();
+        double *y = c.m_y.data();
+        double *z = c.m_z.data();
+        column<int32_t>(buf, pointLen, 0, count,
+            [=](point_count_t i, int32_t v){ x[i] = v * scale[0] + offset[0]; });
+        column<int32_t>(buf, pointLen, 4, count,
+            [=](point_count_t i, int32_t v){ y[i] = v * scale[1] + offset[1]; });
+        column<int32_t>(buf, pointLen, 8, count,
+            [=](point_count_t i, int32_t v){ z[i] = v * scale[2] + offset[2]; });
+    }
+    else
+    {
+        int32_t *x = c.m_rawX.data();
+        int32_t *y = c.m_rawY.data();
+        int32_t *z = c.m_rawZ.data();
+        column<int32_t>(buf, pointLen, 0, count,
+            [=](point_count_t i, int32_t v){ x[i] = v; });
+        column<int32_t>(buf, pointLen, 4, count,
+            [=](point_count_t i, int32_t v){ y[i] = v; });
+        column<int32_t>(buf, pointLen, 8, count,
+            [=](point_count_t i, int32_t v){ z[i] = v; });
+    }
+
+    uint16_t *intensity = c.m_intensity.data();
+    column<uint16_t>(buf, pointLen, 12, count,
+        [=](point_count_t i, uint16_t v){ intensity[i] = v; });
+
+    uint8_t *returnNum = c.m_returnNumber.data();
+    uint8_t *numReturns = c.m_numberOfReturns.data();
+    uint8_t *scanDir = c.m_scanDirectionFlag.data();
+    uint8_t *flight = c.m_edgeOfFlightLine.data();
+    uint8_t *classification = c.m_classification.data();
+    uint8_t *user = c.m_userData.data();
+    float *scanAngle = c.m_scanAngle.data();
+    uint16_t *pointSourceId = c.m_pointSourceId.data();
+    if (F::v14)
+    {
+        column<uint8_t>(buf, pointLen, 14, count,
+            [=](point_count_t i, uint8_t v)
+            {
+                returnNum[i] = v & 0x0F;
+                numReturns[i] = (v >> 4) & 0x0F;
+            });
+        uint8_t *classFlags = c.m_classFlags.data();
+        uint8_t *scanChannel = c.m_scanChannel.data();
+        column<uint8_t>(buf, pointLen, 15, count,
+            [=](point_count_t i, uint8_t v)
+            {
+                classFlags[i] = v & 0x0F;
+                scanChannel[i] = (v >> 4) & 0x03;
+                scanDir[i] = (v >> 6) & 0x01;
+                flight[i] = (v >> 7) & 0x01;
+            });
+        column<uint8_t>(buf, pointLen, 16, count,
+            [=](point_count_t i, uint8_t v){ classification[i] = v; });
+        column<uint8_t>(buf, pointLen, 17, count,
+            [=](point_count_t i, uint8_t v){ user[i] = v; });
+        column<int16_t>(buf, pointLen, 18, count,
+            [=](point_count_t i, int16_t v)
+            { scanAngle[i] = (float)(v * .006); });
+        column<uint16_t>(buf, pointLen, 20, count,
+            [=](point_count_t i, uint16_t v){ pointSourceId[i] = v; });
+    }
+    else
+    {
+        column<uint8_t>(buf, pointLen, 14, count,
+            [=](point_count_t i, uint8_t v)
+            {
+                returnNum[i] = v & 0x07;
+                numReturns[i] = (v >> 3) & 0x07;
+                scanDir[i] = (v >> 6) & 0x01;
+                flight[i] = (v >> 7) & 0x01;
+            });
+        column<uint8_t>(buf, pointLen, 15, count,
+            [=](point_count_t i, uint8_t v){ classification[i] = v; });
+        column<int8_t>(buf, pointLen, 16, count,
+            [=](point_count_t i, int8_t v){ scanAngle[i] = v; });
+        column<uint8_t>(buf, pointLen, 17, count,
+            [=](point_count_t i, uint8_t v){ user[i] = v; });
+        column<uint16_t>(buf, pointLen, 18, count,
+            [=](point_count_t i, uint16_t v){ pointSourceId[i] = v; });
+    }
+
+    if (F::time)
+    {
+        double *gpsTime = c.m_gpsTime.data();
+        column<double>(buf, pointLen, F::timeOffset, count,
+            [=](point_count_t i, double v){ gpsTime[i] = v; });
+    }
+
+    if (F::color)
+    {
+        uint16_t *red = c.m_red.data();
+        uint16_t *green = c.m_green.data();
+        uint16_t *blue = c.m_blue.data();
+        column<uint16_t>(buf, pointLen, F::colorOffset, count,
+            [=](point_count_t i, uint16_t v){ red[i] = v; });
+        column<uint16_t>(buf, pointLen, F::colorOffset + 2, count,
+            [=](point_count_t i, uint16_t v){ green[i] = v; });
+        column<uint16_t>(buf, pointLen, F::colorOffset + 4, count,
+            [=](point_count_t i, uint16_t v){ blue[i] = v; });
+    }
+
+    if (F::infrared)
+    {
+        uint16_t *infrared = c.m_infrared.data();
+        column<uint16_t>(buf, pointLen, F::infraredOffset, count,
+            [=](point_count_t i, uint16_t v){ infrared[i] = v; });
+    }
+}
+
+} // namespace pdal
@@ -0,0 +1,93 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <pdal/TypedDim.hpp>
+
+namespace pdal
+{
+
+// Accessors for the standard LAS dimensions, typed as they're stored in
+// a LAS point record.
+struct LasDims
+{
+    void resolve(const PointLayout& layout)
+    {
+        m_x.resolve(layout);
+        m_y.resolve(layout);
+        m_z.resolve(layout);
+        m_intensity.resolve(layout);
+        m_returnNumber.resolve(layout);
+        m_numberOfReturns.resolve(layout);
+        m_classFlags.resolve(layout);
+        m_scanChannel.resolve(layout);
+        m_scanDirectionFlag.resolve(layout);
+        m_edgeOfFlightLine.resolve(layout);
+        m_classification.resolve(layout);
+        m_scanAngle.resolve(layout);
+        m_scanAngleRank.resolve(layout);
+        m_userData.resolve(layout);
+        m_pointSourceId.resolve(layout);
+        m_gpsTime.resolve(layout);
+        m_red.resolve(layout);
+        m_green.resolve(layout);
+        m_blue.resolve(layout);
+        m_infrared.resolve(layout);
+    }
+
+    TypedDim<Dimension::Id::X, double> m_x;
+    TypedDim<Dimension::Id::Y, double> m_y;
+    TypedDim<Dimension::Id::Z, double> m_z;
+    TypedDim<Dimension::Id::Intensity, uint16_t> m_intensity;
+    TypedDim<Dimension::Id::ReturnNumber, uint8_t> m_returnNumber;
+    TypedDim<Dimension::Id::NumberOfReturns, uint8_t> m_numberOfReturns;
+    TypedDim<Dimension::Id::ClassFlags, uint8_t> m_classFlags;
+    TypedDim<Dimension::Id::ScanChannel, uint8_t> m_scanChannel;
+    TypedDim<Dimension::Id::ScanDirectionFlag, uint8_t> m_scanDirectionFlag;
+    TypedDim<Dimension::Id::EdgeOfFlightLine, uint8_t> m_edgeOfFlightLine;
+    TypedDim<Dimension::Id::Classification, uint8_t> m_classification;
+    // Scan angle in degrees (LAS 1.4) and as a signed byte (LAS 1.0 - 1.3).
+    TypedDim<Dimension::Id::ScanAngleRank, float> m_scanAngle;
+    TypedDim<Dimension::Id::ScanAngleRank, int8_t> m_scanAngleRank;
+    TypedDim<Dimension::Id::UserData, uint8_t> m_userData;
+    TypedDim<Dimension::Id::PointSourceId, uint16_t> m_pointSourceId;
+    TypedDim<Dimension::Id::GpsTime, double> m_gpsTime;
+    TypedDim<Dimension::Id::Red, uint16_t> m_red;
+    TypedDim<Dimension::Id::Green, uint16_t> m_green;
+    TypedDim<Dimension::Id::Blue, uint16_t> m_blue;
+    TypedDim<Dimension::Id::Infrared, uint16_t> m_infrared;
+};
+
+} // namespace pdal
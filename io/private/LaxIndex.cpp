@@ -0,0 +1,269 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include <pdal/util/IStream.hpp>
+#include <pdal/util/OStream.hpp>
+
+#include "LaxIndex.hpp"
+
+namespace pdal
+{
+
+namespace
+{
+
+void checkSignature(ILeStream& in, const char *sig)
+{
+    std::string s;
+    in.get(s, 4);
+    if (s != sig)
+        throw LaxIndex::error("Invalid spatial index.  Expected '" +
+            std::string(sig) + "' signature.");
+}
+
+} // unnamed namespace
+
+
+LaxIndex::LaxIndex(std::istream& stream)
+{
+    ILeStream in(&stream);
+
+    uint32_t version;
+    uint32_t type;
+    uint32_t levelIndex;
+    uint32_t implicitLevels;
+
+    checkSignature(in, "LASX");
+    in >> version;
+
+    // Quadtree.
+    checkSignature(in, "LASS");
+    in >> type;
+    if (type != 0)
+        throw error("Unsupported spatial index type.");
+    checkSignature(in, "LASQ");
+    in >> version >> m_levels >> levelIndex >> implicitLevels;
+    in >> m_minx >> m_maxx >> m_miny >> m_maxy;
+    if (m_levels > 15)
+        throw error("Invalid spatial index depth.");
+
+    // Point intervals for each cell.  Interval ends in the file are
+    // inclusive.
+    checkSignature(in, "LASV");
+    uint32_t numCells;
+    in >> version >> numCells;
+    for (uint32_t i = 0; i < numCells; ++i)
+    {
+        int32_t cellIndex;
+        uint32_t numIntervals;
+        uint32_t numPoints;
+        in >> cellIndex >> numIntervals >> numPoints;
+        if (cellIndex < 0)
+            throw error("Invalid spatial index cell.");
+
+        std::vector<Interval>& intervals = m_cells[(uint32_t)cellIndex];
+        for (uint32_t j = 0; j < numIntervals; ++j)
+        {
+            uint32_t start, end;
+            in >> start >> end;
+            if (!stream)
+                throw error("Unexpected end of spatial index.");
+            if (end < start)
+                throw error("Invalid spatial index interval.");
+            intervals.push_back({ start, (point_count_t)end + 1 });
+        }
+    }
+    if (!stream)
+        throw error("Unexpected end of spatial index.");
+}
+
+
+LaxIndex::LaxIndex(const BOX2D& bounds, uint32_t levels) : m_levels(levels)
+{
+    double size = (std::max)(bounds.maxx - bounds.minx,
+        bounds.maxy - bounds.miny);
+    m_minx = (float)bounds.minx;
+    m_miny = (float)bounds.miny;
+    m_maxx = (float)(bounds.minx + size);
+    m_maxy = (float)(bounds.miny + size);
+}
+
+
+// Follow the position down the tree the same way that cellBounds() does.
+uint32_t LaxIndex::cell(double x, double y) const
+{
+    double minx = m_minx;
+    double maxx = m_maxx;
+    double miny = m_miny;
+    double maxy = m_maxy;
+
+    uint32_t index = 0;
+    uint32_t levelStart = 0;
+    uint32_t levelSize = 1;
+    for (uint32_t level = 0; level < m_levels; ++level)
+    {
+        const double midx = (minx + maxx) / 2;
+        const double midy = (miny + maxy) / 2;
+        index <<= 2;
+        if (x < midx)
+            maxx = midx;
+        else
+        {
+            minx = midx;
+            index |= 1;
+        }
+        if (y < midy)
+            maxy = midy;
+        else
+        {
+            miny = midy;
+            index |= 2;
+        }
+        levelStart += levelSize;
+        levelSize *= 4;
+    }
+    return levelStart + index;
+}
+
+
+void LaxIndex::add(uint32_t cell, point_count_t index)
+{
+    std::vector<Interval>& intervals = m_cells[cell];
+    if (intervals.size() && intervals.back().second == index)
+        intervals.back().second++;
+    else
+        intervals.push_back({ index, index + 1 });
+}
+
+
+void LaxIndex::write(std::ostream& stream) const
+{
+    OLeStream out(&stream);
+
+    out.put("LASX", 4);
+    out << (uint32_t)0;
+
+    // Quadtree.  The level index and implicit levels are only used by
+    // LAStools when indexing parts of a file.
+    out.put("LASS", 4);
+    out << (uint32_t)0;
+    out.put("LASQ", 4);
+    out << (uint32_t)0 << m_levels << (uint32_t)0 << (uint32_t)0;
+    out << m_minx << m_maxx << m_miny << m_maxy;
+
+    // Cells.  The point count of a cell isn't used when reading.
+    out.put("LASV", 4);
+    out << (uint32_t)0 << (uint32_t)m_cells.size();
+    for (auto& c : m_cells)
+    {
+        point_count_t count = 0;
+        for (const Interval& i : c.second)
+            count += i.second - i.first;
+        out << (int32_t)c.first << (uint32_t)c.second.size() <<
+            (uint32_t)count;
+        for (const Interval& i : c.second)
+            out << (uint32_t)i.first << (uint32_t)(i.second - 1);
+    }
+}
+
+
+// Cells are numbered level by level.  The index of a cell within its level
+// has two bits for each level of the tree, starting at the root.  The low
+// bit picks the upper half in X and the high bit the upper half in Y.
+BOX2D LaxIndex::cellBounds(uint32_t index) const
+{
+    uint32_t level = 0;
+    uint32_t levelStart = 0;
+    uint32_t levelSize = 1;
+    while (index >= levelStart + levelSize)
+    {
+        levelStart += levelSize;
+        levelSize *= 4;
+        level++;
+    }
+    index -= levelStart;
+
+    // Points beyond the edges of the tree are put in the edge cells.
+    const double lo = (std::numeric_limits<double>::lowest)();
+    const double hi = (std::numeric_limits<double>::max)();
+    double minx = m_minx;
+    double maxx = m_maxx;
+    double miny = m_miny;
+    double maxy = m_maxy;
+    BOX2D box(lo, lo, hi, hi);
+    while (level)
+    {
+        level--;
+        const uint32_t quad = (index >> (2 * level)) & 3;
+        const double midx = (minx + maxx) / 2;
+        const double midy = (miny + maxy) / 2;
+        if (quad & 1)
+            box.minx = minx = midx;
+        else
+            box.maxx = maxx = midx;
+        if (quad & 2)
+            box.miny = miny = midy;
+        else
+            box.maxy = maxy = midy;
+    }
+    return box;
+}
+
+
+std::vector<LaxIndex::Interval> LaxIndex::query(const BOX2D& region) const
+{
+    std::vector<Interval> intervals;
+    for (auto& c : m_cells)
+        if (cellBounds(c.first).overlaps(region))
+            intervals.insert(intervals.end(), c.second.begin(),
+                c.second.end());
+    std::sort(intervals.begin(), intervals.end());
+
+    // Merge intervals that overlap or touch.
+    std::vector<Interval> merged;
+    for (const Interval& i : intervals)
+    {
+        if (merged.size() && i.first <= merged.back().second)
+            merged.back().second = (std::max)(merged.back().second, i.second);
+        else
+            merged.push_back(i);
+    }
+    return merged;
+}
+
+} // namespace pdal
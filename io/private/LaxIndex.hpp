@@ -0,0 +1,97 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <istream>
+#include <map>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <pdal/pdal_types.hpp>
+#include <pdal/util/Bounds.hpp>
+
+namespace pdal
+{
+
+// Spatial index of a LAS file, as written by LAStools' lasindex to a .lax
+// file or an EVLR.  The index is a quadtree.  Each cell of the tree lists
+// the intervals of point indices holding the points in the cell.
+class LaxIndex
+{
+public:
+    struct error : public std::runtime_error
+    {
+        error(const std::string& err) : std::runtime_error(err)
+        {}
+    };
+
+    // Range of point indices, [first, second).
+    typedef std::pair<point_count_t, point_count_t> Interval;
+
+    // Read an index.  Throws LaxIndex::error if the index is invalid.
+    LaxIndex(std::istream& in);
+
+    // Create an empty index with cells 'levels' deep in a square that
+    // covers 'bounds'.
+    LaxIndex(const BOX2D& bounds, uint32_t levels);
+
+    // Find the points that may be in a region.  The intervals are sorted
+    // and don't overlap.
+    std::vector<Interval> query(const BOX2D& region) const;
+
+    // Find the deepest cell holding a position.  Cells are numbered so
+    // that nearby cells have nearby numbers.
+    uint32_t cell(double x, double y) const;
+
+    // Add the point at 'index' to a cell.  Points should be added in order.
+    void add(uint32_t cell, point_count_t index);
+
+    // Write the index in the format read by the constructor.
+    void write(std::ostream& out) const;
+
+private:
+    BOX2D cellBounds(uint32_t index) const;
+
+    uint32_t m_levels;
+    float m_minx;
+    float m_maxx;
+    float m_miny;
+    float m_maxy;
+    std::map<uint32_t, std::vector<Interval>> m_cells;
+};
+
+} // namespace pdal
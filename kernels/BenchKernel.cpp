@@ -0,0 +1,503 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (hobu.inc@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "BenchKernel.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include <io/BufferReader.hpp>
+#include <pdal/KDIndex.hpp>
+#include <pdal/PointTable.hpp>
+#include <pdal/StageFactory.hpp>
+#include <pdal/pdal_config.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+namespace pdal
+{
+
+static StaticPluginInfo const s_info
+{
+    "kernels.bench",
+    "Bench Kernel",
+    "http://pdal.io/apps/bench.html"
+};
+
+CREATE_STATIC_KERNEL(BenchKernel, s_info)
+
+std::string BenchKernel::getName() const { return s_info.name; }
+
+namespace
+{
+
+class Timer
+{
+public:
+    Timer() : m_start(std::chrono::steady_clock::now())
+    {}
+
+    double seconds() const
+    {
+        std::chrono::duration<double> d =
+            std::chrono::steady_clock::now() - m_start;
+        return d.count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point m_start;
+};
+
+// Peak resident set size of the process so far, in megabytes.  Zero
+// where it isn't available.
+double peakRss()
+{
+#ifndef _WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+    {
+#ifdef __APPLE__
+        return usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+        return usage.ru_maxrss / 1024.0;
+#endif
+    }
+#endif
+    return 0;
+}
+
+Stage& createStage(StageFactory& factory, const std::string& type,
+    const Options& opts)
+{
+    Stage *stage = factory.createStage(type);
+    if (!stage)
+        throw pdal_error("Unable to create stage '" + type + "'.");
+    stage->setOptions(opts);
+    return *stage;
+}
+
+} // unnamed namespace
+
+
+BenchKernel::BenchKernel() : m_repeat(1)
+{}
+
+
+void BenchKernel::addSwitches(ProgramArgs& args)
+{
+    args.add("sizes", "Comma-separated list of point counts to run each "
+        "benchmark with", m_sizes, { "1000000" });
+    args.add("threads", "Comma-separated list of thread counts to run each "
+        "benchmark with.  Defaults to 1 and the number of cores", m_threads);
+    args.add("benchmarks", "Comma-separated list of benchmarks to run.  "
+        "Defaults to all", m_benchmarks);
+    args.add("tempdir", "Directory for files written by the benchmarks.  "
+        "Defaults to the system temporary directory", m_tempDir);
+    args.add("repeat", "Number of times to run each benchmark.  The "
+        "fastest run is reported", m_repeat, 1);
+}
+
+
+std::vector<BenchKernel::Benchmark> BenchKernel::benchmarks() const
+{
+    std::vector<Benchmark> all
+    {
+        { "faux", &BenchKernel::faux },
+        { "las_write", &BenchKernel::lasWrite },
+        { "laz_write", &BenchKernel::lazWrite },
+        { "las_read", &BenchKernel::lasRead },
+        { "laz_read", &BenchKernel::lazRead },
+        { "reprojection", &BenchKernel::reprojection },
+        { "kdtree", &BenchKernel::kdtree },
+        { "normal", &BenchKernel::normal },
+        { "smrf", &BenchKernel::smrf },
+        { "gdal", &BenchKernel::gdal }
+    };
+
+    if (m_benchmarks.empty())
+        return all;
+
+    std::vector<Benchmark> selected;
+    for (const std::string& name : m_benchmarks)
+    {
+        auto it = std::find_if(all.begin(), all.end(),
+            [&name](const Benchmark& b){ return b.name == name; });
+        if (it == all.end())
+            throw pdal_error("Unknown benchmark '" + name + "'.");
+        selected.push_back(*it);
+    }
+    return selected;
+}
+
+
+std::vector<point_count_t> BenchKernel::sizes() const
+{
+    std::vector<point_count_t> sizes;
+    for (const std::string& s : m_sizes)
+    {
+        point_count_t size;
+        if (!Utils::fromString(s, size) || size == 0)
+            throw pdal_error("Invalid benchmark size '" + s + "'.");
+        sizes.push_back(size);
+    }
+    return sizes;
+}
+
+
+std::vector<int> BenchKernel::threads() const
+{
+    std::vector<int> threads;
+    for (const std::string& s : m_threads)
+    {
+        int t;
+        if (!Utils::fromString(s, t) || t <= 0)
+            throw pdal_error("Invalid thread count '" + s + "'.");
+        threads.push_back(t);
+    }
+    if (threads.empty())
+    {
+        threads.push_back(1);
+        int cores = (int)std::thread::hardware_concurrency();
+        if (cores > 1)
+            threads.push_back(cores);
+    }
+    return threads;
+}
+
+
+// Generate the points that the benchmarks work on.  Uniform points are
+// the same on every run.
+PointViewPtr BenchKernel::generate(PointTable& table, point_count_t count)
+{
+    StageFactory factory;
+
+    Options opts;
+    opts.add("mode", "uniform");
+    opts.add("count", count);
+    opts.add("bounds", BOX3D(0, 0, 0, 1000, 1000, 100));
+    opts.add("number_of_returns", 1);
+    Stage& reader = createStage(factory, "readers.faux", opts);
+    reader.prepare(table);
+    PointViewSet viewSet = reader.execute(table);
+    return *viewSet.begin();
+}
+
+
+// Copy the points of a view to a view of a table that has already been
+// prepared with the dimensions of the source.
+PointViewPtr BenchKernel::copy(PointViewPtr src, PointTable& table)
+{
+    DimTypeList dims = src->dimTypes();
+    std::vector<char> buf(src->pointSize());
+
+    PointViewPtr view(new PointView(table));
+    for (PointId idx = 0; idx < src->size(); ++idx)
+    {
+        src->getPackedPoint(dims, idx, buf.data());
+        view->setPackedPoint(dims, idx, buf.data());
+    }
+    return view;
+}
+
+
+// Time a stage run on a copy of the points.  Copying isn't timed.
+BenchKernel::Run BenchKernel::filter(PointViewPtr src,
+    const std::string& type, const Options& opts)
+{
+    StageFactory factory;
+    PointTable table;
+    for (const DimType& d : src->dimTypes())
+        table.layout()->registerDim(d.m_id, d.m_type);
+
+    BufferReader reader;
+    Stage& stage = createStage(factory, type, opts);
+    stage.setInput(reader);
+    stage.prepare(table);
+    reader.addView(copy(src, table));
+
+    Run run;
+    Timer timer;
+    stage.execute(table);
+    run.seconds = timer.seconds();
+    return run;
+}
+
+
+BenchKernel::Run BenchKernel::write(PointViewPtr src,
+    const std::string& filename, const std::string& type,
+    const Options& opts)
+{
+    Options writerOpts(opts);
+    writerOpts.add("filename", filename);
+
+    Run run;
+    try
+    {
+        run = filter(src, type, writerOpts);
+    }
+    catch (...)
+    {
+        FileUtils::deleteFile(filename);
+        throw;
+    }
+    FileUtils::deleteFile(filename);
+    return run;
+}
+
+
+// Write the points with writers.las, which isn't timed, and time reading
+// them back.
+BenchKernel::Run BenchKernel::read(PointViewPtr src,
+    const std::string& filename, const Options& writerOpts,
+    const Options& readerOpts)
+{
+    Options wOpts(writerOpts);
+    wOpts.add("filename", filename);
+
+    Run run;
+    try
+    {
+        filter(src, "writers.las", wOpts);
+
+        StageFactory factory;
+        PointTable table;
+        Options rOpts(readerOpts);
+        rOpts.add("filename", filename);
+        Stage& reader = createStage(factory, "readers.las", rOpts);
+        reader.prepare(table);
+
+        Timer timer;
+        reader.execute(table);
+        run.seconds = timer.seconds();
+    }
+    catch (...)
+    {
+        FileUtils::deleteFile(filename);
+        throw;
+    }
+    FileUtils::deleteFile(filename);
+    return run;
+}
+
+
+BenchKernel::Run BenchKernel::faux(PointViewPtr src, int /*threads*/)
+{
+    StageFactory factory;
+    PointTable table;
+
+    Options opts;
+    opts.add("mode", "uniform");
+    opts.add("count", src->size());
+    opts.add("bounds", BOX3D(0, 0, 0, 1000, 1000, 100));
+    Stage& reader = createStage(factory, "readers.faux", opts);
+    reader.prepare(table);
+
+    Run run;
+    Timer timer;
+    reader.execute(table);
+    run.seconds = timer.seconds();
+    return run;
+}
+
+
+BenchKernel::Run BenchKernel::lasWrite(PointViewPtr src, int /*threads*/)
+{
+    return write(src, FileUtils::uniqueFilename(m_tempDir, "bench") +
+        ".las", "writers.las", Options());
+}
+
+
+BenchKernel::Run BenchKernel::lazWrite(PointViewPtr src, int threads)
+{
+    Options opts;
+    opts.add("compression", "lazperf");
+    opts.add("threads", threads);
+    return write(src, FileUtils::uniqueFilename(m_tempDir, "bench") +
+        ".laz", "writers.las", opts);
+}
+
+
+BenchKernel::Run BenchKernel::lasRead(PointViewPtr src, int threads)
+{
+    Options readerOpts;
+    readerOpts.add("threads", threads);
+    return read(src, FileUtils::uniqueFilename(m_tempDir, "bench") + ".las",
+        Options(), readerOpts);
+}
+
+
+BenchKernel::Run BenchKernel::lazRead(PointViewPtr src, int threads)
+{
+    Options writerOpts;
+    writerOpts.add("compression", "lazperf");
+    writerOpts.add("threads", threads);
+
+    Options readerOpts;
+    readerOpts.add("threads", threads);
+    return read(src, FileUtils::uniqueFilename(m_tempDir, "bench") + ".laz",
+        writerOpts, readerOpts);
+}
+
+
+BenchKernel::Run BenchKernel::reprojection(PointViewPtr src, int /*threads*/)
+{
+    Options opts;
+    opts.add("in_srs", "EPSG:32615");
+    opts.add("out_srs", "EPSG:4326");
+    return filter(src, "filters.reprojection", opts);
+}
+
+
+BenchKernel::Run BenchKernel::kdtree(PointViewPtr src, int /*threads*/)
+{
+    KD3Index index(*src);
+
+    Run run;
+    Timer timer;
+    index.build();
+    run.seconds = timer.seconds();
+    return run;
+}
+
+
+BenchKernel::Run BenchKernel::normal(PointViewPtr src, int /*threads*/)
+{
+    Options opts;
+    opts.add("knn", 8);
+    return filter(src, "filters.normal", opts);
+}
+
+
+BenchKernel::Run BenchKernel::smrf(PointViewPtr src, int /*threads*/)
+{
+    Options opts;
+    opts.add("tile", 250.0);
+    opts.add("buffer", 20.0);
+    return filter(src, "filters.smrf", opts);
+}
+
+
+BenchKernel::Run BenchKernel::gdal(PointViewPtr src, int threads)
+{
+    Options opts;
+    opts.add("resolution", 1.0);
+    opts.add("output_type", "mean");
+    opts.add("threads", threads);
+    return write(src, FileUtils::uniqueFilename(m_tempDir, "bench") +
+        ".tif", "writers.gdal", opts);
+}
+
+
+int BenchKernel::execute()
+{
+    std::vector<Benchmark> benches = benchmarks();
+    std::vector<point_count_t> counts = sizes();
+    std::vector<int> threadCounts = threads();
+    if (m_repeat < 1)
+        throw pdal_error("Option 'repeat' must be at least 1.");
+
+    MetadataNode root;
+    for (point_count_t count : counts)
+    {
+        PointTable srcTable;
+        PointViewPtr src = generate(srcTable, count);
+
+        const size_t threadLimit = parallelThreadLimit();
+        for (const Benchmark& bench : benches)
+        {
+            double basePps = 0;
+            int baseThreads = 0;
+            for (int threads : threadCounts)
+            {
+                // Stages without a 'threads' option use parallelFor(), so
+                // limit that as well.
+                setParallelThreads(threads);
+
+                Run best;
+                for (int i = 0; i < m_repeat && best.error.empty(); ++i)
+                {
+                    try
+                    {
+                        Run run = (this->*bench.func)(src, threads);
+                        if (i == 0 || run.seconds < best.seconds)
+                            best = run;
+                    }
+                    catch (const pdal_error& err)
+                    {
+                        best.error = err.what();
+                    }
+                }
+                setParallelThreads(threadLimit);
+
+                MetadataNode result = root.addList("results");
+                result.add("benchmark", bench.name);
+                result.add("points", count);
+                result.add("threads", threads);
+                if (!best.error.empty())
+                {
+                    result.add("error", best.error);
+                    continue;
+                }
+
+                double pps = best.seconds > 0 ? count / best.seconds : 0;
+                result.add("seconds", best.seconds);
+                result.add("points_per_second", pps);
+                result.add("peak_rss_mb", peakRss());
+
+                // Efficiency is the speedup over the first thread count
+                // divided by the increase in threads.
+                if (!baseThreads)
+                {
+                    basePps = pps;
+                    baseThreads = threads;
+                }
+                if (basePps > 0)
+                    result.add("efficiency", (pps / basePps) /
+                        ((double)threads / baseThreads));
+            }
+        }
+    }
+    root.add("hardware_threads", std::thread::hardware_concurrency());
+    root.add("pdal_version", Config::fullVersionString());
+    Utils::toJSON(root, std::cout);
+
+    return 0;
+}
+
+} // namespace pdal
@@ -0,0 +1,99 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (hobu.inc@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <pdal/Kernel.hpp>
+#include <pdal/PointView.hpp>
+
+namespace pdal
+{
+
+class PointTable;
+
+class PDAL_DLL BenchKernel : public Kernel
+{
+public:
+    BenchKernel();
+    std::string getName() const;
+    int execute();
+
+private:
+    struct Run
+    {
+        Run() : seconds(0)
+        {}
+
+        double seconds;
+        std::string error;
+    };
+
+    struct Benchmark
+    {
+        std::string name;
+        Run (BenchKernel::*func)(PointViewPtr, int);
+    };
+
+    void addSwitches(ProgramArgs& args);
+    std::vector<Benchmark> benchmarks() const;
+    std::vector<point_count_t> sizes() const;
+    std::vector<int> threads() const;
+    PointViewPtr generate(PointTable& table, point_count_t count);
+    PointViewPtr copy(PointViewPtr src, PointTable& table);
+    Run filter(PointViewPtr src, const std::string& type,
+        const Options& opts);
+    Run write(PointViewPtr src, const std::string& filename,
+        const std::string& type, const Options& opts);
+    Run read(PointViewPtr src, const std::string& filename,
+        const Options& writerOpts, const Options& readerOpts);
+
+    Run faux(PointViewPtr src, int threads);
+    Run lasWrite(PointViewPtr src, int threads);
+    Run lazWrite(PointViewPtr src, int threads);
+    Run lasRead(PointViewPtr src, int threads);
+    Run lazRead(PointViewPtr src, int threads);
+    Run reprojection(PointViewPtr src, int threads);
+    Run kdtree(PointViewPtr src, int threads);
+    Run normal(PointViewPtr src, int threads);
+    Run smrf(PointViewPtr src, int threads);
+    Run gdal(PointViewPtr src, int threads);
+
+    std::vector<std::string> m_sizes;
+    std::vector<std::string> m_threads;
+    std::vector<std::string> m_benchmarks;
+    std::string m_tempDir;
+    int m_repeat;
+};
+
+} // namespace pdal
@@ -34,6 +34,8 @@
 
 #include "DeltaKernel.hpp"
 
+#include <numeric>
+
 #include <pdal/Stage.hpp>
 #include <pdal/PDALUtils.hpp>
 
@@ -51,7 +53,8 @@ CREATE_STATIC_KERNEL(DeltaKernel, s_info)
 
 std::string DeltaKernel::getName() const { return s_info.name; }
 
-DeltaKernel::DeltaKernel() : m_detail(false), m_allDims(false)
+DeltaKernel::DeltaKernel() : m_detail(false), m_allDims(false),
+    m_indexCache(false)
 {}
 
 
@@ -65,6 +68,9 @@ void DeltaKernel::addSwitches(ProgramArgs& args)
     args.add("detail", "Output deltas per-point", m_detail);
     args.add("alldims", "Compute diffs for all dimensions (not just X,Y,Z)",
         m_allDims);
+    args.add("index-cache", "Keep the index of the candidate file in a "
+        "sidecar file (<filename>.kdi) and reuse it while the points are "
+        "unchanged", m_indexCache);
 }
 
 
@@ -125,8 +131,9 @@ int DeltaKernel::execute()
     }
 
     // Index the candidate data.
-    KD3Index index(*candView);
-    index.build();
+    KD3Index& index = m_indexCache ?
+        candView->build3dIndex(m_candidateFile + ".kdi") :
+        candView->build3dIndex();
 
     MetadataNode root;
 
@@ -140,15 +147,32 @@ int DeltaKernel::execute()
 }
 
 
+// Nearest candidate point to each source point.  The queries are spread
+// across threads.
+std::vector<PointId> DeltaKernel::neighbors(PointViewPtr& srcView,
+    KD3Index& index)
+{
+    std::vector<PointId> ids(srcView->size());
+    std::iota(ids.begin(), ids.end(), 0);
+    std::vector<PointId> neighbors(srcView->size());
+    index.knnSearchAll(*srcView, ids, 1, [&neighbors](PointId idx,
+        const std::vector<PointId>& ids, const std::vector<double>&)
+    {
+        neighbors[idx] = ids[0];
+    });
+    return neighbors;
+}
+
+
 MetadataNode DeltaKernel::dump(PointViewPtr& srcView, PointViewPtr& candView,
     KD3Index& index, DimIndexMap& dims)
 {
     MetadataNode root;
 
+    std::vector<PointId> candIds = neighbors(srcView, index);
     for (PointId id = 0; id < srcView->size(); ++id)
     {
-        PointRef point = srcView->point(id);
-        PointId candId = index.neighbor(point);
+        PointId candId = candIds[id];
 
         // It may be faster to put in a special case to avoid having to
         // fetch X, Y and Z, more than once but this is simpler and
@@ -191,10 +215,10 @@ MetadataNode DeltaKernel::dumpDetail(PointViewPtr& srcView,
 {
     MetadataNode root;
 
+    std::vector<PointId> candIds = neighbors(srcView, index);
     for (PointId id = 0; id < srcView->size(); ++id)
     {
-        PointRef point = srcView->point(id);
-        PointId candId = index.neighbor(point);
+        PointId candId = candIds[id];
 
         MetadataNode delta = root.add("delta");
         delta.add("i", id);
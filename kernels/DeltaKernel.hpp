@@ -72,6 +72,7 @@ public:
 private:
     void addSwitches(ProgramArgs& args);
     PointViewPtr loadSet(const std::string& filename, PointTable& table);
+    std::vector<PointId> neighbors(PointViewPtr& srcView, KD3Index& index);
     MetadataNode dump(PointViewPtr& srcView, PointViewPtr& candView,
         KD3Index& index, DimIndexMap& dims);
     MetadataNode dumpDetail(PointViewPtr& srcView, PointViewPtr& candView,
@@ -87,6 +88,7 @@ private:
 
     bool m_detail;
     bool m_allDims;
+    bool m_indexCache;
 };
 
 } // namespace pdal
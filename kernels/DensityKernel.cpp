@@ -34,10 +34,19 @@
 
 #include "DensityKernel.hpp"
 #include "../filters/HexBinFilter.hpp"
+#include "../filters/StreamCallbackFilter.hpp"
 #include "private/density/OGR.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <thread>
+
 #include <pdal/GDALUtils.hpp>
 #include <pdal/util/FileUtils.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+#include <filters/private/hexer/HexGrid.hpp>
 
 namespace pdal
 {
@@ -53,6 +62,14 @@ CREATE_STATIC_KERNEL(DensityKernel, s_info)
 
 std::string DensityKernel::getName() const { return s_info.name; }
 
+DensityKernel::DensityKernel() : m_threads(0), m_batchSize(10000)
+{}
+
+
+DensityKernel::~DensityKernel()
+{}
+
+
 void DensityKernel::addSwitches(ProgramArgs& args)
 {
     args.add("input,i", "input point cloud file name", m_inputFile).
@@ -69,26 +86,31 @@ void DensityKernel::addSwitches(ProgramArgs& args)
     args.add("hole_cull_area_tolerance", "Tolerance area to "
             "apply to holes before cull", m_cullArea);
     args.add("smooth", "Smooth boundary output", m_doSmooth, true);
+    args.add("threads", "Number of input files binned at once when the "
+        "input is a wildcard (0 for one per core)", m_threads, 0);
+    args.add("batch_size", "Number of hexagons written in each transaction "
+        "(0 for a single transaction)", m_batchSize, point_count_t(10000));
 }
 
 
-void DensityKernel::outputDensity(pdal::SpatialReference const& reference)
+void DensityKernel::validateSwitches(ProgramArgs& args)
 {
-    HexBin* hexbin = dynamic_cast<HexBin*>(m_hexbinStage);
-    if (!hexbin)
-        throw pdal::pdal_error("unable to fetch filters.hexbin stage!");
+    if (m_threads < 0)
+        throw pdal_error("Option 'threads' can't be negative.");
+}
 
-    hexer::HexGrid* grid = hexbin->grid();
 
+void DensityKernel::outputDensity(hexer::HexGrid *grid,
+    pdal::SpatialReference const& reference)
+{
     OGR writer(m_outputFile, reference.getWKT(), m_driverName, m_layerName);
-    writer.writeDensity(grid);
+    writer.writeDensity(grid, m_batchSize);
 }
 
 
-int DensityKernel::execute()
+// Bin the points of a single input or pipeline with filters.hexbin.
+hexer::HexGrid *DensityKernel::binPipeline(SpatialReference& srs)
 {
-    gdal::registerDrivers();
-
     if (m_inputFile == "STDIN" ||
         (FileUtils::extension(m_inputFile) == ".xml" ||
         FileUtils::extension(m_inputFile) == ".json"))
@@ -105,10 +127,121 @@ int DensityKernel::execute()
     options.add("edge_length", m_edgeLength);
     options.add("hole_cull_area_tolerance", m_cullArea);
     options.add("smooth", m_doSmooth);
-    m_hexbinStage = &(m_manager.makeFilter("filters.hexbin",
-        *m_manager.getStage(), options));
+    Stage& hexbinStage = m_manager.makeFilter("filters.hexbin",
+        *m_manager.getStage(), options);
     m_manager.execute();
-    outputDensity(m_manager.pointTable().anySpatialReference());
+    srs = m_manager.pointTable().anySpatialReference();
+
+    HexBin* hexbin = dynamic_cast<HexBin*>(&hexbinStage);
+    if (!hexbin)
+        throw pdal::pdal_error("unable to fetch filters.hexbin stage!");
+    return hexbin->grid();
+}
+
+
+// Pass the X and Y of each point in a file to 'bin'.  Files are streamed
+// when their reader allows it so that large tiles needn't fit in memory.
+SpatialReference DensityKernel::binFile(const std::string& filename,
+    std::function<void(double, double)> bin)
+{
+    PipelineManager manager;
+    manager.setLog(m_log);
+    manager.commonOptions() = m_manager.commonOptions();
+    manager.stageOptions() = m_manager.stageOptions();
+
+    Stage& reader = manager.makeReader(filename, "");
+    StreamCallbackFilter f;
+    f.setInput(reader);
+    f.setCallback([&bin](PointRef& point)
+    {
+        bin(point.getFieldAs<double>(Dimension::Id::X),
+            point.getFieldAs<double>(Dimension::Id::Y));
+        return true;
+    });
+
+    if (f.pipelineStreamable())
+    {
+        FixedPointTable table(10000);
+        f.prepare(table);
+        f.execute(table);
+        return table.anySpatialReference();
+    }
+    PointTable table;
+    f.prepare(table);
+    f.execute(table);
+    return table.anySpatialReference();
+}
+
+
+// Bin the points of many files, usually tiles of a larger dataset.  The
+// first file is binned on its own to fix the hexagon size and the origin
+// of the grid.  The others are binned in parallel, each into a grid that
+// lines up with the first, and their counts are merged.
+hexer::HexGrid *DensityKernel::binFiles(const StringList& files,
+    SpatialReference& srs)
+{
+    using namespace hexer;
+
+    if (m_edgeLength == 0.0)
+    {
+        m_grid.reset(new HexGrid(m_density));
+        m_grid->setSampleSize(m_sampleSize);
+    }
+    else
+        m_grid.reset(new HexGrid(m_edgeLength * std::sqrt(3), m_density));
+
+    HexGrid *grid = m_grid.get();
+    srs = binFile(files.front(), [grid](double x, double y)
+        { grid->addPoint(x, y); });
+    grid->processSample();
+    if (!(grid->width() > 0 && grid->hasOrigin()))
+        throw pdal_error("Unable to determine the hexagon size from '" +
+            files.front() + "'.");
+
+    size_t threads = m_threads ? (size_t)m_threads :
+        (size_t)(std::max)(std::thread::hardware_concurrency(), 1U);
+    std::mutex mutex;
+    ThreadPool pool(threads, threads, false);
+    for (auto fi = files.begin() + 1; fi != files.end(); ++fi)
+    {
+        const std::string& filename = *fi;
+        pool.add([this, grid, &mutex, &filename]()
+        {
+            HexGrid tile(grid->height(), grid->denseLimit(), grid->origin());
+            binFile(filename, [&tile](double x, double y)
+                { tile.countPoint(x, y); });
+
+            std::lock_guard<std::mutex> lock(mutex);
+            grid->merge(tile);
+        });
+    }
+    pool.await();
+    pool.join();
+    if (pool.errors().size())
+        throw pdal_error(pool.errors().front());
+    return grid;
+}
+
+
+int DensityKernel::execute()
+{
+    gdal::registerDrivers();
+
+    SpatialReference srs;
+    hexer::HexGrid *grid;
+    if (m_inputFile != "STDIN" &&
+        m_inputFile.find_first_of("*?[") != std::string::npos)
+    {
+        StringList files = FileUtils::glob(m_inputFile);
+        if (files.empty())
+            throw pdal_error("No input files found for path '" +
+                m_inputFile + "'.");
+        std::sort(files.begin(), files.end());
+        grid = binFiles(files, srs);
+    }
+    else
+        grid = binPipeline(srs);
+    outputDensity(grid, srs);
     return 0;
 }
 
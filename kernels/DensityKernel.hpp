@@ -35,9 +35,16 @@
 #pragma once
 
 
+#include <functional>
+#include <memory>
+
 #include <pdal/Kernel.hpp>
 #include <pdal/PipelineManager.hpp>
 
+namespace hexer
+{
+    class HexGrid;
+}
 
 namespace pdal
 {
@@ -45,11 +52,13 @@ namespace pdal
 class PDAL_DLL DensityKernel : public Kernel
 {
 public:
+    DensityKernel();
+    ~DensityKernel();
     std::string getName() const;
     int execute();
 
 private:
-    Stage *m_hexbinStage;
+    std::unique_ptr<hexer::HexGrid> m_grid;
     std::string m_inputFile;
     std::string m_outputFile;
     std::string m_driverName;
@@ -59,9 +68,17 @@ private:
     double m_edgeLength;
     double m_cullArea;
     bool m_doSmooth;
+    int m_threads;
+    point_count_t m_batchSize;
 
     virtual void addSwitches(ProgramArgs& args);
-    void outputDensity(pdal::SpatialReference const& ref);
+    virtual void validateSwitches(ProgramArgs& args);
+    hexer::HexGrid *binPipeline(SpatialReference& srs);
+    hexer::HexGrid *binFiles(const StringList& files, SpatialReference& srs);
+    SpatialReference binFile(const std::string& filename,
+        std::function<void(double, double)> bin);
+    void outputDensity(hexer::HexGrid *grid,
+        pdal::SpatialReference const& ref);
 };
 
 } // namespace pdal
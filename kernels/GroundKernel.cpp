@@ -65,7 +65,7 @@ std::string GroundKernel::getName() const
 GroundKernel::GroundKernel()
     : Kernel(), m_inputFile(""), m_outputFile(""), m_maxWindowSize(33),
       m_slope(1), m_maxDistance(2.5), m_initialDistance(0.15), m_cellSize(1),
-      m_extract(false), m_reset(false), m_denoise(false)
+      m_tile(0), m_buffer(0), m_extract(false), m_reset(false), m_denoise(false)
 {
 }
 
@@ -78,6 +78,8 @@ void GroundKernel::addSwitches(ProgramArgs& args)
     args.add("max_distance", "Max distance", m_maxDistance, 2.5);
     args.add("initial_distance", "Initial distance", m_initialDistance, .15);
     args.add("cell_size", "Cell size", m_cellSize, 1.0);
+    args.add("tile", "Tile size for concurrent classification", m_tile, 0.0);
+    args.add("buffer", "Buffer around each tile", m_buffer, 0.0);
     args.add("extract", "Extract ground returns?", m_extract);
     args.add("reset", "Reset classifications prior to segmenting?", m_reset);
     args.add("denoise", "Apply statistical outlier removal prior to segmenting?", m_denoise);
@@ -98,6 +100,8 @@ int GroundKernel::execute()
     groundOptions.add("max_distance", m_maxDistance);
     groundOptions.add("initial_distance", m_initialDistance);
     groundOptions.add("cell_size", m_cellSize);
+    groundOptions.add("tile", m_tile);
+    groundOptions.add("buffer", m_buffer);
     groundOptions.add("ignore", "Classification[7:7]");
 
     Options rangeOptions;
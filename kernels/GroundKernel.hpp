@@ -65,6 +65,8 @@ private:
     double m_maxDistance;
     double m_initialDistance;
     double m_cellSize;
+    double m_tile;
+    double m_buffer;
     bool m_extract;
     bool m_reset;
     bool m_denoise;
@@ -34,8 +34,10 @@
 
 #include "HausdorffKernel.hpp"
 
+#include <cmath>
 #include <memory>
 
+#include <filters/private/VoxelMap.hpp>
 #include <pdal/PDALUtils.hpp>
 #include <pdal/PointView.hpp>
 #include <pdal/pdal_config.hpp>
@@ -64,6 +66,12 @@ void HausdorffKernel::addSwitches(ProgramArgs& args)
     Arg& candidate = args.add("candidate", "Candidate filename",
                               m_candidateFile);
     candidate.setPositional();
+    args.add("index-cache", "Keep the index of each file in a sidecar "
+        "file (<filename>.kdi) and reuse it while the points are unchanged",
+        m_indexCache);
+    args.add("cell_size", "Compare one point from each cube of this size "
+        "rather than every point.  The result is within the reported "
+        "error bound of the exact distance", m_cellSize, 0.0);
 }
 
 
@@ -78,6 +86,36 @@ PointViewPtr HausdorffKernel::loadSet(const std::string& filename,
 }
 
 
+// Keep the first point in each cube of the grid, so that every point of
+// the view is within a cube's diagonal of a point that's kept.
+PointViewPtr HausdorffKernel::thin(PointViewPtr view) const
+{
+    BOX3D bounds;
+    view->calculateBounds(bounds);
+    VoxelKey voxels(bounds, m_cellSize);
+    if (!voxels.fits())
+        throw pdal_error("Option 'cell_size' is too small for the extent "
+            "of the points.");
+
+    PointViewPtr out = view->makeNew();
+    VoxelMap<char> seen;
+    for (PointId i = 0; i < view->size(); ++i)
+    {
+        double x = view->getFieldAs<double>(Dimension::Id::X, i);
+        double y = view->getFieldAs<double>(Dimension::Id::Y, i);
+        double z = view->getFieldAs<double>(Dimension::Id::Z, i);
+        char& s = seen[voxels.key(voxels.col(x), voxels.row(y),
+            voxels.depth(z))];
+        if (!s)
+        {
+            s = 1;
+            out->appendPoint(*view, i);
+        }
+    }
+    return out;
+}
+
+
 int HausdorffKernel::execute()
 {
     PointTable srcTable;
@@ -86,12 +124,34 @@ int HausdorffKernel::execute()
     PointTable candTable;
     PointViewPtr candView = loadSet(m_candidateFile, candTable);
 
+    // The distance between the thinned sets is within the distance from
+    // each set to its thinned points (a cube's diagonal) of the exact one.
+    double errorBound = 0;
+    if (m_cellSize > 0)
+    {
+        srcView = thin(srcView);
+        candView = thin(candView);
+        errorBound = 2 * m_cellSize * std::sqrt(3.0);
+    }
+    // The views keep their indexes, so computeHausdorff() uses these.
+    else if (m_indexCache)
+    {
+        srcView->build3dIndex(m_sourceFile + ".kdi");
+        candView->build3dIndex(m_candidateFile + ".kdi");
+    }
+
     double hausdorff = Utils::computeHausdorff(srcView, candView);
 
     MetadataNode root;
     root.add("filenames", m_sourceFile);
     root.add("filenames", m_candidateFile);
     root.add("hausdorff", hausdorff);
+    if (m_cellSize > 0)
+    {
+        root.add("error_bound", errorBound);
+        root.add("source_points", srcView->size());
+        root.add("candidate_points", candView->size());
+    }
     root.add("pdal_version", Config::fullVersionString());
     Utils::toJSON(root, std::cout);
 
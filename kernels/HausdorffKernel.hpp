@@ -52,9 +52,12 @@ public:
 private:
     virtual void addSwitches(ProgramArgs& args);
     PointViewPtr loadSet(const std::string& filename, PointTable& table);
+    PointViewPtr thin(PointViewPtr view) const;
 
     std::string m_sourceFile;
     std::string m_candidateFile;
+    bool m_indexCache;
+    double m_cellSize;
 };
 
 } // namespace pdal
@@ -35,15 +35,18 @@
 #include "InfoKernel.hpp"
 
 #include <algorithm>
+#include <cmath>
 
 #include <pdal/pdal_config.hpp>
 #include <pdal/pdal_features.hpp>
 
 #include <filters/InfoFilter.hpp>
+#include <io/LasReader.hpp>
 #include <pdal/KDIndex.hpp>
 #include <pdal/PipelineWriter.hpp>
 #include <pdal/PDALUtils.hpp>
 #include <pdal/StageFactory.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 namespace pdal
 {
@@ -61,8 +64,8 @@ std::string InfoKernel::getName() const { return s_info.name; }
 
 InfoKernel::InfoKernel() : m_showStats(false), m_showSchema(false),
     m_showAll(false), m_showMetadata(false), m_boundary(false),
-    m_showSummary(false), m_needPoints(false), m_statsStage(nullptr),
-    m_hexbinStage(nullptr), m_infoStage(nullptr), m_reader(nullptr)
+    m_showSummary(false), m_needPoints(false), m_sample(0), m_fraction(0),
+    m_jobs(1)
 {}
 
 
@@ -123,6 +126,18 @@ void InfoKernel::validateSwitches(ProgramArgs& args)
         throw pdal_error("'enumerate' option requires 'stats' option.");
     if (!m_showStats && m_dimensions.size())
         throw pdal_error("'dimensions' option requires 'stats' option.");
+
+    if (m_sample && m_fraction)
+        throw pdal_error("Can't specify both 'sample' and 'fraction' "
+            "options.");
+    if (m_fraction < 0 || m_fraction > 1)
+        throw pdal_error("'fraction' option must be between 0 and 1.");
+    if ((m_sample || m_fraction) && (m_pointIndexes.size() ||
+            m_queryPoint.size()))
+        throw pdal_error("'sample' and 'fraction' options are incompatible "
+            "with 'point' and 'query' options.");
+    if (m_jobs < 1)
+        throw pdal_error("'jobs' option must be positive.");
 }
 
 
@@ -151,6 +166,12 @@ void InfoKernel::addSwitches(ProgramArgs& args)
     args.add("summary", "Dump summary of the info", m_showSummary);
     args.add("metadata", "Dump file metadata info", m_showMetadata);
     args.add("stdin,s", "Read a pipeline file from standard input", m_usestdin);
+    args.add("sample", "Compute statistics and boundary from about this "
+        "many points, spread through the input", m_sample);
+    args.add("fraction", "Compute statistics and boundary from about this "
+        "fraction of the points, spread through the input", m_fraction);
+    args.add("jobs,j", "Number of files to process at once when the input "
+        "is a wildcard", m_jobs, 1);
 }
 
 
@@ -185,26 +206,62 @@ MetadataNode InfoKernel::dumpSummary(const QuickInfo& qi)
     return summary;
 }
 
-void InfoKernel::makeReader(const std::string& filename)
+void InfoKernel::makeReader(PipelineManager& manager,
+    const std::string& filename, Stages& stages)
 {
     Options rOps;
     if (!m_needPoints)
         rOps.add("count", 0);
-    m_reader = &(m_manager.makeReader(filename, m_driverOverride, rOps));
+    stages.m_reader = &(manager.makeReader(filename, m_driverOverride, rOps));
+    if (!m_needPoints || (!m_sample && !m_fraction))
+        return;
+
+    // Only read a sample of the points.  The LAS reader can skip the
+    // points between evenly spaced runs (whole chunks of compressed points)
+    // so those are never decoded.  Other readers read all the points and
+    // keep every Nth.
+    QuickInfo qi = stages.m_reader->preview();
+    if (!qi.valid() || qi.m_pointCount == 0)
+    {
+        m_log->get(LogLevel::Warning) << "Can't determine the number of "
+            "points in '" << filename << "'.  Reading all points." <<
+            std::endl;
+        return;
+    }
+    stages.m_totalPoints = qi.m_pointCount;
+    point_count_t sample = m_sample ? m_sample :
+        (point_count_t)std::ceil(m_fraction * qi.m_pointCount);
+    sample = (std::max)(sample, (point_count_t)1);
+    if (sample >= qi.m_pointCount)
+        return;
+
+    if (dynamic_cast<LasReader *>(stages.m_reader))
+    {
+        Options sOps;
+        sOps.add("sample", sample);
+        stages.m_reader->addOptions(sOps);
+    }
+    else
+    {
+        Options dOps;
+        dOps.add("step", qi.m_pointCount / sample);
+        stages.m_sampler = &(manager.makeFilter("filters.decimation",
+            *stages.m_reader, dOps));
+    }
 }
 
 
-void InfoKernel::makePipeline()
+void InfoKernel::makePipeline(PipelineManager& manager, Stages& stages)
 {
-    Stage *stage = m_reader;
+    Stage *stage = stages.m_sampler ? stages.m_sampler : stages.m_reader;
 
     Options iOps;
     if (m_queryPoint.size())
         iOps.add("query", m_queryPoint);
     if (m_pointIndexes.size())
         iOps.add("point", m_pointIndexes);
-    stage = m_infoStage =
-        &(m_manager.makeFilter("filters.info", *stage, iOps));
+    stage = stages.m_info =
+        &(manager.makeFilter("filters.info", *stage, iOps));
 
     if (m_showStats)
     {
@@ -213,22 +270,30 @@ void InfoKernel::makePipeline()
             filterOptions.add({"dimensions", m_dimensions});
         if (m_enumerate.size())
             filterOptions.add({"enumerate", m_enumerate});
-        stage = m_statsStage =
-            &m_manager.makeFilter("filters.stats", *stage, filterOptions);
+        stage = stages.m_stats =
+            &manager.makeFilter("filters.stats", *stage, filterOptions);
     }
     if (m_boundary)
-        m_hexbinStage = &m_manager.makeFilter("filters.hexbin", *stage);
+        stages.m_hexbin = &manager.makeFilter("filters.hexbin", *stage);
 }
 
 
 MetadataNode InfoKernel::run(const std::string& filename)
+{
+    return run(m_manager, filename);
+}
+
+
+MetadataNode InfoKernel::run(PipelineManager& manager,
+    const std::string& filename)
 {
     MetadataNode root;
+    Stages stages;
 
-    makeReader(filename);
+    makeReader(manager, filename, stages);
     if (m_showSummary)
     {
-        QuickInfo qi = m_manager.getStage()->preview();
+        QuickInfo qi = manager.getStage()->preview();
         if (!qi.valid())
             throw pdal_error("No summary data available for '" +
                 filename + "'.");
@@ -236,20 +301,20 @@ MetadataNode InfoKernel::run(const std::string& filename)
     }
     else
     {
-        makePipeline();
+        makePipeline(manager, stages);
         if (m_needPoints || m_showMetadata)
         {
-            if (m_manager.pipelineStreamable())
+            if (manager.pipelineStreamable())
             {
                 FixedPointTable fixedTable(10000);
-                m_manager.executeStream(fixedTable);
+                manager.executeStream(fixedTable);
             }
             else
-                m_manager.execute();
+                manager.execute();
         }
         else
-            m_manager.prepare();
-        dump(root);
+            manager.prepare();
+        dump(manager, stages, root);
     }
     root.add("filename", filename);
     root.add("pdal_version", Config::fullVersionString());
@@ -257,17 +322,18 @@ MetadataNode InfoKernel::run(const std::string& filename)
 }
 
 
-void InfoKernel::dump(MetadataNode& root)
+void InfoKernel::dump(PipelineManager& manager, const Stages& stages,
+    MetadataNode& root)
 {
     if (m_pipelineFile.size() > 0)
-        PipelineWriter::writePipeline(m_manager.getStage(), m_pipelineFile);
+        PipelineWriter::writePipeline(manager.getStage(), m_pipelineFile);
 
     // Reader stage.
     if (m_showMetadata)
-        root.add(m_reader->getMetadata().clone("metadata"));
+        root.add(stages.m_reader->getMetadata().clone("metadata"));
 
     // Info stage.
-    auto info = dynamic_cast<InfoFilter *>(m_infoStage);
+    auto info = dynamic_cast<InfoFilter *>(stages.m_info);
     MetadataNode node = info->getMetadata();
     MetadataNode points = node.findChild("points");
     if (points)
@@ -278,12 +344,12 @@ void InfoKernel::dump(MetadataNode& root)
 
     // Stats stage.
     if (m_showStats)
-        root.add(m_statsStage->getMetadata().clone("stats"));
+        root.add(stages.m_stats->getMetadata().clone("stats"));
 
     // Hexbin stage.
-    if (m_hexbinStage)
+    if (stages.m_hexbin)
     {
-        MetadataNode node = m_hexbinStage->getMetadata();
+        MetadataNode node = stages.m_hexbin->getMetadata();
         if (node.findChild("error"))
         {
             std::string poly = info->bounds().to2d().toWKT();
@@ -293,13 +359,106 @@ void InfoKernel::dump(MetadataNode& root)
             root.add(m);
         }
         else
-            root.add(m_hexbinStage->getMetadata().clone("boundary"));
+            root.add(stages.m_hexbin->getMetadata().clone("boundary"));
+    }
+
+    if (stages.m_totalPoints)
+        dumpSample(stages, root);
+}
+
+
+// Describe the sample that the statistics were computed from.  The
+// standard error of each average is its standard deviation over the square
+// root of the sample size, corrected for sampling without replacement.
+// Minimums and maximums of a sample only bound those of all the points.
+void InfoKernel::dumpSample(const Stages& stages, MetadataNode& root)
+{
+    const point_count_t total = stages.m_totalPoints;
+    point_count_t count = stages.m_info->getMetadata().
+        findChild("num_points").value<point_count_t>();
+
+    MetadataNode sample = root.add("sample");
+    sample.add("points", count, "Number of points read");
+    sample.add("total_points", total, "Number of points in the input");
+    sample.add("fraction", total ? (double)count / total : 1.0,
+        "Fraction of the points read");
+    sample.add("method", stages.m_sampler ? "decimation" : "runs",
+        "How the points read were chosen");
+    if (!stages.m_stats || count == 0)
+        return;
+
+    const double correction = std::sqrt((std::max)(0.0,
+        1.0 - (double)count / total));
+    MetadataNode stats = root.findChild("stats");
+    for (MetadataNode stat : stats.children("statistic"))
+    {
+        MetadataNode stddev = stat.findChild("stddev");
+        point_count_t n = stat.findChild("count").value<point_count_t>();
+        if (!stddev || n == 0)
+            continue;
+        double err = stddev.value<double>() / std::sqrt((double)n) *
+            correction;
+        stat.add("average_error", err,
+            "Standard error of the average from sampling");
     }
 }
 
 
+// Run info on each of several files, up to m_jobs at once, and output
+// the results as a list.
+int InfoKernel::executeMany(const StringList& files)
+{
+    if (m_pipelineFile.size())
+        throw pdal_error("'pipeline-serialization' option can't be used "
+            "with multiple input files.");
+
+    std::vector<MetadataNode> results(files.size());
+    ThreadPool pool((size_t)m_jobs, files.size(), false);
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        pool.add([this, i, &files, &results]()
+        {
+            PipelineManager manager;
+            manager.setLog(m_log);
+            manager.commonOptions() = m_manager.commonOptions();
+            manager.stageOptions() = m_manager.stageOptions();
+            try
+            {
+                results[i] = run(manager, files[i]);
+            }
+            catch (const std::exception& err)
+            {
+                MetadataNode node;
+                node.add("filename", files[i]);
+                node.add("error", err.what());
+                results[i] = node;
+            }
+        });
+    }
+    pool.await();
+    pool.join();
+
+    MetadataNode root;
+    for (MetadataNode& node : results)
+        root.addList(node.clone("files"));
+    Utils::toJSON(root, std::cout);
+    return 0;
+}
+
+
 int InfoKernel::execute()
 {
+    // A wildcard input is expanded to a list of files.
+    if (!m_usestdin && m_inputFile.find_first_of("*?[") != std::string::npos)
+    {
+        StringList files = FileUtils::glob(m_inputFile);
+        if (files.empty())
+            throw pdal_error("No input files found for path '" +
+                m_inputFile + "'.");
+        std::sort(files.begin(), files.end());
+        return executeMany(files);
+    }
+
     std::string filename = (m_usestdin ? std::string("STDIN") : m_inputFile);
     MetadataNode root = run(filename);
     Utils::toJSON(root, std::cout);
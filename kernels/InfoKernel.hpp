@@ -63,12 +63,32 @@ public:
     inline void doComputeBoundary(bool value) { m_boundary = value; }
 
 private:
+    // The stages of the pipeline run for one file.
+    struct Stages
+    {
+        Stages() : m_reader(nullptr), m_sampler(nullptr), m_info(nullptr),
+            m_stats(nullptr), m_hexbin(nullptr), m_totalPoints(0)
+        {}
+
+        Stage *m_reader;
+        Stage *m_sampler;
+        Stage *m_info;
+        Stage *m_stats;
+        Stage *m_hexbin;
+        point_count_t m_totalPoints;
+    };
+
     void addSwitches(ProgramArgs& args);
     void validateSwitches(ProgramArgs& args);
-    void makeReader(const std::string& filename);
-    void makePipeline();
-    void dump(MetadataNode& root);
+    MetadataNode run(PipelineManager& manager, const std::string& filename);
+    void makeReader(PipelineManager& manager, const std::string& filename,
+        Stages& stages);
+    void makePipeline(PipelineManager& manager, Stages& stages);
+    void dump(PipelineManager& manager, const Stages& stages,
+        MetadataNode& root);
+    void dumpSample(const Stages& stages, MetadataNode& root);
     MetadataNode dumpSummary(const QuickInfo& qi);
+    int executeMany(const StringList& files);
 
     std::string m_inputFile;
     bool m_showStats;
@@ -84,11 +104,9 @@ private:
     bool m_showSummary;
     bool m_needPoints;
     bool m_usestdin;
-
-    Stage *m_statsStage;
-    Stage *m_hexbinStage;
-    Stage *m_infoStage;
-    Stage *m_reader;
+    point_count_t m_sample;
+    double m_fraction;
+    int m_jobs;
 
     MetadataNode m_tree;
 };
@@ -34,12 +34,77 @@
 
 #include "MergeKernel.hpp"
 
+#include <deque>
+#include <limits>
+#include <queue>
+
 #include <filters/MergeFilter.hpp>
 #include <pdal/StageFactory.hpp>
+#include <pdal/StageWrapper.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 namespace pdal
 {
 
+// Points read from an input, waiting to be written.  Shares the layout of
+// the kernel's table.
+class MergeBuffer : public StreamPointTable
+{
+public:
+    MergeBuffer(PointLayout& layout, point_count_t capacity) :
+        StreamPointTable(layout, capacity), m_count(0)
+    {
+        m_buf.resize(pointsToBytes(capacity + 1));
+    }
+
+    // Number of points in the buffer.
+    point_count_t m_count;
+
+protected:
+    virtual void reset()
+        { m_count = 0; }
+
+    virtual char *getPoint(PointId idx)
+        { return m_buf.data() + pointsToBytes(idx); }
+
+private:
+    std::vector<char> m_buf;
+};
+
+// An input that is read a buffer at a time on the kernel's pool.  Readers
+// aren't thread-safe, so only one buffer of a source is filled at once.
+// The members other than the reader are guarded by the kernel's mutex.
+class MergeSource
+{
+public:
+    MergeSource(const std::string& filename, Streamable& reader) :
+        m_filename(filename), m_reader(reader), m_reading(false),
+        m_finished(false)
+    {}
+
+    std::string m_filename;
+    Streamable& m_reader;
+    std::vector<std::unique_ptr<MergeBuffer>> m_buffers;
+    std::deque<MergeBuffer *> m_free;
+    std::deque<MergeBuffer *> m_full;
+    bool m_reading;
+    bool m_finished;
+    std::string m_error;
+};
+
+namespace
+{
+
+// Number of points in the buffers of an input read on its own.
+const point_count_t BufferSize = 10000;
+// Number of points buffered for all the inputs of an ordered merge, which
+// must all be read at once.
+const point_count_t OrderedPoints = 1 << 17;
+// Smallest buffer of an input of an ordered merge.
+const point_count_t MinBufferSize = 256;
+
+} // unnamed namespace
+
 static StaticPluginInfo const s_info
 {
     "kernels.merge",
@@ -49,6 +114,14 @@ static StaticPluginInfo const s_info
 
 CREATE_STATIC_KERNEL(MergeKernel, s_info)
 
+MergeKernel::MergeKernel() : m_threads(1), m_table(BufferSize)
+{}
+
+
+MergeKernel::~MergeKernel()
+{}
+
+
 std::string MergeKernel::getName() const
 {
     return s_info.name;
@@ -58,6 +131,9 @@ std::string MergeKernel::getName() const
 void MergeKernel::addSwitches(ProgramArgs& args)
 {
     args.add("files,f", "input/output files", m_files).setPositional();
+    args.add("threads", "Number of inputs read at once", m_threads, 1);
+    args.add("order_by", "Dimension by which every input is sorted.  The "
+        "output is sorted by it too", m_orderBy);
 }
 
 
@@ -67,25 +143,339 @@ void MergeKernel::validateSwitches(ProgramArgs& args)
         throw pdal_error("Must specify an input and output file.");
     m_outputFile = m_files.back();
     m_files.resize(m_files.size() - 1);
+    if (m_threads < 1)
+        throw pdal_error("Option 'threads' must be positive.");
 }
 
 
 int MergeKernel::execute()
+{
+    std::vector<Stage *> readers;
+    bool streamable(true);
+    for (size_t i = 0; i < m_files.size(); ++i)
+    {
+        Stage& reader = makeReader(m_files[i], m_driverOverride);
+        streamable = streamable && reader.pipelineStreamable();
+        readers.push_back(&reader);
+    }
+
+    Stage& writer = m_manager.makeWriter(m_outputFile, "");
+    Streamable *sw = dynamic_cast<Streamable *>(&writer);
+    if (streamable && sw && sw->pipelineStreamable())
+        executeStream(readers, *sw);
+    else
+        executeStandard(readers, writer);
+    return 0;
+}
+
+
+// Merge the inputs in memory, for drivers that can't stream points.
+void MergeKernel::executeStandard(const std::vector<Stage *>& readers,
+    Stage& writer)
 {
     PointTable table;
 
     MergeFilter filter;
+    for (Stage *reader : readers)
+        filter.setInput(*reader);
 
-    for (size_t i = 0; i < m_files.size(); ++i)
+    Stage *last = &filter;
+    if (m_orderBy.size())
     {
-        Stage& reader = makeReader(m_files[i], m_driverOverride);
-        filter.setInput(reader);
+        Options opts;
+        opts.add("dimension", m_orderBy);
+        last = &m_manager.makeFilter("filters.sort", filter, opts);
     }
-
-    Stage& writer = makeWriter(m_outputFile, filter, "");
+    writer.setInput(*last);
     writer.prepare(table);
     writer.execute(table);
-    return 0;
+}
+
+
+// Stream the points of the inputs into the writer.  The inputs share the
+// layout of the kernel's table, which is made once before any are read.
+void MergeKernel::executeStream(const std::vector<Stage *>& readers,
+    Streamable& writer)
+{
+    SpatialReference srs;
+    for (size_t i = 0; i < readers.size(); ++i)
+    {
+        Streamable *r = dynamic_cast<Streamable *>(readers[i]);
+        r->prepare(m_table);
+        m_sources.emplace_back(new MergeSource(m_files[i], *r));
+
+        SpatialReference rSrs = r->getSpatialReference();
+        if (srs.empty())
+            srs = rSrs;
+        else if (!rSrs.empty() && rSrs != srs)
+            m_log->get(LogLevel::Warning) << "Merging points with "
+                "inconsistent spatial references." << std::endl;
+    }
+    writer.prepare(m_table);
+    m_table.finalize();
+
+    Dimension::Id dim(Dimension::Id::Unknown);
+    if (m_orderBy.size())
+    {
+        dim = m_table.layout()->findDim(m_orderBy);
+        if (dim == Dimension::Id::Unknown)
+            throw pdal_error("Dimension '" + m_orderBy + "' not found.");
+    }
+
+    if (!srs.empty())
+        m_table.setSpatialReference(srs);
+    StreamableWrapper::ready(writer, m_table);
+    StreamableWrapper::spatialReferenceChanged(writer, srs);
+
+    // A source never has more than one buffer waiting to be filled, so
+    // adding a task never waits for room in the queue.
+    m_pool.reset(new ThreadPool(m_threads, m_sources.size(), false));
+    if (dim == Dimension::Id::Unknown)
+        mergeUnordered(writer);
+    else
+        mergeOrdered(writer, dim);
+    m_pool->join();
+    m_pool.reset();
+    StreamableWrapper::done(writer, m_table);
+    m_sources.clear();
+}
+
+
+// Write the points of the inputs in the order that they're read.  Only
+// 'threads' inputs are open at once, so memory use doesn't depend on the
+// number of inputs.
+void MergeKernel::mergeUnordered(Streamable& writer)
+{
+    std::deque<MergeSource *> active;
+    size_t nextSource = 0;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (active.size() || nextSource < m_sources.size())
+    {
+        while (active.size() < (size_t)m_threads &&
+            nextSource < m_sources.size())
+        {
+            MergeSource& src = *m_sources[nextSource++];
+            lock.unlock();
+            open(src, BufferSize);
+            lock.lock();
+            read(src);
+            active.push_back(&src);
+        }
+
+        m_cv.wait(lock, [&active]()
+        {
+            for (MergeSource *src : active)
+                if (src->m_full.size() || !src->m_reading)
+                    return true;
+            return false;
+        });
+
+        for (auto si = active.begin(); si != active.end();)
+        {
+            MergeSource& src = **si;
+            if (src.m_error.size())
+                throw pdal_error("Unable to read '" + src.m_filename +
+                    "': " + src.m_error);
+            if (src.m_full.size())
+            {
+                MergeBuffer *buf = src.m_full.front();
+                src.m_full.pop_front();
+                lock.unlock();
+                write(writer, *buf);
+                lock.lock();
+                src.m_free.push_back(buf);
+                read(src);
+                ++si;
+            }
+            else if (src.m_finished && !src.m_reading)
+            {
+                lock.unlock();
+                close(src);
+                lock.lock();
+                si = active.erase(si);
+            }
+            else
+                ++si;
+        }
+    }
+}
+
+
+// Write the points of the inputs in the order of a dimension by which
+// each input is already sorted.  Every input is read at once, so the
+// buffers are made smaller as the number of inputs grows.  Points with
+// equal values are taken from the inputs in the order they were listed.
+void MergeKernel::mergeOrdered(Streamable& writer, Dimension::Id dim)
+{
+    struct Head
+    {
+        MergeBuffer *m_buf;
+        PointId m_pos;
+        double m_value;
+    };
+    typedef std::pair<double, size_t> Entry;
+    auto later = [](const Entry& a, const Entry& b)
+        { return a.first > b.first ||
+            (a.first == b.first && a.second > b.second); };
+    std::priority_queue<Entry, std::vector<Entry>, decltype(later)>
+        heap(later);
+
+    const point_count_t capacity = (std::max)(MinBufferSize,
+        OrderedPoints / (point_count_t)m_sources.size());
+    std::vector<Head> heads(m_sources.size());
+
+    // Queue the current point of an input, moving to its next buffer if
+    // need be.
+    std::unique_lock<std::mutex> lock(m_mutex, std::defer_lock);
+    auto advance = [&](size_t i)
+    {
+        Head& head = heads[i];
+        MergeSource& src = *m_sources[i];
+        while (!head.m_buf || head.m_pos >= head.m_buf->m_count)
+        {
+            lock.lock();
+            if (head.m_buf)
+                src.m_free.push_back(head.m_buf);
+            head.m_buf = next(src, lock);
+            lock.unlock();
+            head.m_pos = 0;
+            if (!head.m_buf)
+                return;
+        }
+        PointRef point(*head.m_buf, head.m_pos);
+        double value = point.getFieldAs<double>(dim);
+        if (value < head.m_value)
+            throw pdal_error("Input '" + src.m_filename + "' isn't sorted "
+                "by '" + m_orderBy + "'.");
+        head.m_value = value;
+        heap.push(Entry(value, i));
+    };
+
+    for (size_t i = 0; i < m_sources.size(); ++i)
+    {
+        open(*m_sources[i], capacity);
+        lock.lock();
+        read(*m_sources[i]);
+        lock.unlock();
+        heads[i] = Head { nullptr, 0, std::numeric_limits<double>::lowest() };
+    }
+    for (size_t i = 0; i < m_sources.size(); ++i)
+        advance(i);
+
+    while (heap.size())
+    {
+        size_t i = heap.top().second;
+        heap.pop();
+        PointRef point(*heads[i].m_buf, heads[i].m_pos);
+        StreamableWrapper::processOne(writer, point);
+        ++heads[i].m_pos;
+        advance(i);
+    }
+
+    for (auto& src : m_sources)
+        close(*src);
+}
+
+
+void MergeKernel::open(MergeSource& src, point_count_t capacity)
+{
+    StreamableWrapper::ready(src.m_reader, m_table);
+    for (int i = 0; i < 2; ++i)
+    {
+        src.m_buffers.emplace_back(
+            new MergeBuffer(*m_table.layout(), capacity));
+        src.m_free.push_back(src.m_buffers.back().get());
+    }
+}
+
+
+void MergeKernel::close(MergeSource& src)
+{
+    StreamableWrapper::done(src.m_reader, m_table);
+    src.m_free.clear();
+    src.m_full.clear();
+    src.m_buffers.clear();
+}
+
+
+// Start filling a free buffer of a source.  Must be called with the mutex
+// held.
+void MergeKernel::read(MergeSource& src)
+{
+    if (src.m_reading || src.m_finished || src.m_free.empty())
+        return;
+
+    MergeBuffer *buf = src.m_free.front();
+    src.m_free.pop_front();
+    src.m_reading = true;
+    m_pool->add([this, &src, buf]()
+    {
+        bool finished(false);
+        std::string error;
+        try
+        {
+            PointRef point(*buf, 0);
+            buf->m_count = 0;
+            while (buf->m_count < buf->capacity())
+            {
+                point.setPointId(buf->m_count);
+                if (!StreamableWrapper::processOne(src.m_reader, point))
+                {
+                    finished = true;
+                    break;
+                }
+                buf->m_count++;
+            }
+        }
+        catch (const std::exception& err)
+        {
+            error = err.what();
+            finished = true;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (buf->m_count)
+            src.m_full.push_back(buf);
+        else
+            src.m_free.push_back(buf);
+        src.m_reading = false;
+        src.m_finished = finished;
+        src.m_error = error;
+        m_cv.notify_all();
+    });
+}
+
+
+// Wait for the next full buffer of a source.  Returns nullptr once all of
+// its points have been taken.  Must be called with the mutex held.
+MergeBuffer *MergeKernel::next(MergeSource& src,
+    std::unique_lock<std::mutex>& lock)
+{
+    read(src);
+    m_cv.wait(lock, [&src]()
+        { return src.m_full.size() || (src.m_finished && !src.m_reading); });
+    if (src.m_error.size())
+        throw pdal_error("Unable to read '" + src.m_filename + "': " +
+            src.m_error);
+    if (src.m_full.empty())
+        return nullptr;
+
+    MergeBuffer *buf = src.m_full.front();
+    src.m_full.pop_front();
+    read(src);
+    return buf;
+}
+
+
+void MergeKernel::write(Streamable& writer, MergeBuffer& buf)
+{
+    PointRef point(buf, 0);
+    for (PointId idx = 0; idx < buf.m_count; ++idx)
+    {
+        point.setPointId(idx);
+        StreamableWrapper::processOne(writer, point);
+    }
 }
 
 } // namespace pdal
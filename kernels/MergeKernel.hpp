@@ -34,23 +34,54 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
 #include <pdal/Kernel.hpp>
+#include <pdal/PointTable.hpp>
+#include <pdal/Streamable.hpp>
 
 namespace pdal
 {
 
+class MergeBuffer;
+class MergeSource;
+class ThreadPool;
+
 class PDAL_DLL MergeKernel : public Kernel
 {
 public:
+    MergeKernel();
+    ~MergeKernel();
     std::string getName() const;
     int execute();
 
 private:
     void addSwitches(ProgramArgs& args);
     void validateSwitches(ProgramArgs& args);
+    void executeStandard(const std::vector<Stage *>& readers,
+        Stage& writer);
+    void executeStream(const std::vector<Stage *>& readers,
+        Streamable& writer);
+    void mergeUnordered(Streamable& writer);
+    void mergeOrdered(Streamable& writer, Dimension::Id dim);
+    void open(MergeSource& src, point_count_t capacity);
+    void close(MergeSource& src);
+    void read(MergeSource& src);
+    MergeBuffer *next(MergeSource& src, std::unique_lock<std::mutex>& lock);
+    void write(Streamable& writer, MergeBuffer& buf);
 
     StringList m_files;
     std::string m_outputFile;
+    std::string m_orderBy;
+    int m_threads;
+    FixedPointTable m_table;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::vector<std::unique_ptr<MergeSource>> m_sources;
+    std::unique_ptr<ThreadPool> m_pool;
 };
 
 } // namespace pdal
@@ -41,8 +41,18 @@
 #endif
 
 #include <pdal/PDALUtils.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/Streamable.hpp>
+#include <pdal/util/ThreadPool.hpp>
+#include <pdal/util/Trace.hpp>
 #include <json/json.h>
 
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <sstream>
+
 namespace pdal
 {
 
@@ -57,10 +67,41 @@ CREATE_STATIC_KERNEL(PipelineKernel, s_info)
 
 std::string PipelineKernel::getName() const { return s_info.name; }
 
-PipelineKernel::PipelineKernel() : m_validate(false), m_progressFd(-1)
+PipelineKernel::PipelineKernel() : m_streamMetadata(false),
+    m_validate(false), m_progressFd(-1),
+    m_threads(1), m_memoryBudget(1024), m_memoryLimit(0), m_hugePages(false),
+    m_alignedPoints(false),
+    m_hybrid(false), m_hybridChunk(0), m_streamUnordered(false),
+    m_profile(false), m_jobs(1), m_essentialMetadata(false),
+    m_traceEvents(0)
 {}
 
 
+namespace
+{
+
+// Parse 'auto', one value for X, Y and Z or three comma-separated values
+// into a component of each of three transforms.
+void parseXYZ(const std::string& s, const std::string& option,
+    std::vector<XForm>& xforms, XForm::XFormComponent XForm::*comp)
+{
+    StringList vals = Utils::split2(s, ',');
+    for (std::string& v : vals)
+        Utils::trim(v);
+    if (vals.size() == 1)
+        vals.resize(3, vals[0]);
+    if (vals.size() != 3)
+        throw pdal_error("Option '" + option + "' must be 'auto', a "
+            "single value or three comma-separated values.");
+    for (size_t i = 0; i < 3; ++i)
+        if (!(xforms[i].*comp).set(vals[i]))
+            throw pdal_error("Invalid value '" + vals[i] + "' for option '" +
+                option + "'.");
+}
+
+} // unnamed namespace
+
+
 void PipelineKernel::validateSwitches(ProgramArgs& args)
 {
     if (m_usestdin)
@@ -68,6 +109,102 @@ void PipelineKernel::validateSwitches(ProgramArgs& args)
 
     if (m_inputFile.empty())
         throw pdal_error("Input filename required.");
+    if (m_threads < 1)
+        throw pdal_error("Number of threads must be positive.");
+    m_tableType = Utils::tolower(m_tableType);
+    if (m_tableType != "row" && m_tableType != "column" &&
+            m_tableType != "mapped" && m_tableType != "compressed")
+        throw pdal_error("Invalid table type '" + m_tableType + "'.  "
+            "Must be 'row', 'column', 'mapped' or 'compressed'.");
+    if (m_memoryBudget == 0)
+        throw pdal_error("Memory budget must be positive.");
+    m_memoryPolicy = Utils::tolower(m_memoryPolicy);
+    if (m_memoryPolicy != "fail" && m_memoryPolicy != "spill")
+        throw pdal_error("Invalid memory policy '" + m_memoryPolicy + "'.  "
+            "Must be 'fail' or 'spill'.");
+    if (m_memoryLimit && m_memoryPolicy == "spill" && m_tableType == "column")
+        throw pdal_error("Memory policy 'spill' can't be used with a "
+            "'column' table.");
+    if (m_jobs < 1)
+        throw pdal_error("Number of jobs must be positive.");
+    if (m_traceEvents == 0)
+        throw pdal_error("Number of trace events must be positive.");
+    if (m_xyzScale.size())
+    {
+        m_xyzXForms.resize(3);
+        parseXYZ(m_xyzScale, "xyz-scale", m_xyzXForms, &XForm::m_scale);
+        parseXYZ(m_xyzOffset, "xyz-offset", m_xyzXForms, &XForm::m_offset);
+    }
+    else if (args.set("xyz-offset"))
+        throw pdal_error("Option 'xyz-offset' requires 'xyz-scale'.");
+    if (m_batchFile.size())
+    {
+        if (m_validate)
+            throw pdal_error("Option 'validate' can't be used with 'batch'.");
+        if (m_pipelineFile.size())
+            throw pdal_error("Option 'pipeline-serialization' can't be used "
+                "with 'batch'.");
+        if (m_profile)
+            throw pdal_error("Option 'profile' can't be used with 'batch'.");
+    }
+    else if (m_workersFile.size())
+        throw pdal_error("Option 'workers' requires 'batch'.");
+}
+
+
+// Run a pipeline that has been read, in stream mode if possible.  Returns
+// the number of points read.
+point_count_t PipelineKernel::runPipeline(PipelineManager& manager)
+{
+    // Spilling keeps points in a mapped table with the limit as its
+    // budget.  Otherwise the table fails when it grows past the limit.
+    bool spill = m_memoryLimit && m_memoryPolicy == "spill";
+    if (m_tableType == "column")
+        manager.setPointTable(
+            std::unique_ptr<BasePointTable>(new ColumnPointTable()));
+    else if (m_tableType == "mapped" || spill)
+        manager.setPointTable(std::unique_ptr<BasePointTable>(
+            new MappedPointTable(m_scratchDir,
+                (spill ? m_memoryLimit : m_memoryBudget) * 1024 * 1024)));
+    else if (m_tableType == "compressed")
+        manager.setPointTable(std::unique_ptr<BasePointTable>(
+            new CompressedPointTable(m_memoryBudget * 1024 * 1024)));
+    else if (m_blockPool)
+        manager.setPointTable(
+            std::unique_ptr<BasePointTable>(new PointTable(m_blockPool)));
+    if (!spill)
+        manager.pointTable().setMemoryLimit(m_memoryLimit * 1024 * 1024);
+    manager.pointTable().layout()->setAligned(m_alignedPoints);
+    if (m_xyzXForms.size())
+        manager.pointTable().layout()->setScaling(m_xyzXForms[0],
+            m_xyzXForms[1], m_xyzXForms[2]);
+    // Stage output is only cached in standard mode.
+    manager.setCacheDir(m_cacheDir);
+    Streamable *terminal = dynamic_cast<Streamable *>(manager.getStage());
+    bool stream = !m_noStream && m_cacheDir.empty() &&
+        (manager.pipelineStreamable() || (m_hybrid && terminal));
+    if (!stream)
+        manager.execute(m_threads);
+    else
+    {
+        if (terminal)
+        {
+            terminal->setHybridChunkSize(m_hybridChunk);
+            terminal->setStreamOrdered(!m_streamUnordered);
+        }
+        std::unique_ptr<StreamPointTable> table =
+            makeStreamTable(m_streamBatch);
+        table->layout()->setAligned(m_alignedPoints);
+        if (m_xyzXForms.size())
+            table->layout()->setScaling(m_xyzXForms[0], m_xyzXForms[1],
+                m_xyzXForms[2]);
+        manager.executeStream(*table, m_threads);
+    }
+
+    point_count_t count = 0;
+    for (Stage *s : manager.roots())
+        count += s->profile().pointsOut();
+    return count;
 }
 
 
@@ -96,7 +233,83 @@ void PipelineKernel::addSwitches(ProgramArgs& args)
     args.add("stream", "This option is obsolete.", m_stream);
     args.add("nostream", "Don't run in stream mode, even if technically "
         "possible.", m_noStream);
+    args.add("stream-batch", "Number of points in a batch in stream "
+        "mode, or 'auto' to tune it as the pipeline runs", m_streamBatch,
+        "10000");
+    args.add("hybrid", "Run in stream mode even if some stages don't "
+        "support streaming.  Points are buffered for those stages.",
+        m_hybrid);
+    args.add("hybrid-chunk", "Maximum number of points buffered at once "
+        "for a stage that doesn't support streaming in hybrid mode.  If 0, "
+        "all points are buffered", m_hybridChunk, (point_count_t)0);
+    args.add("stream-unordered", "When the readers of a stream mode "
+        "pipeline run at once, pass each batch of points to the stages "
+        "they share as soon as it's read rather than in reader order",
+        m_streamUnordered);
     args.add("metadata", "Metadata filename", m_metadataFile);
+    args.add("stream-metadata", "Write the metadata of each stage to the "
+        "metadata file as soon as the stage finishes", m_streamMetadata);
+    args.add("profile", "Write the time spent and points processed by each "
+        "stage to standard output", m_profile);
+    args.add("threads", "Maximum number of threads used to run the "
+        "pipeline", m_threads, 1);
+    args.add("table", "Point storage used in standard mode: 'row', "
+        "'column', 'mapped' or 'compressed'", m_tableType, "row");
+    args.add("scratch-dir", "Directory for the scratch file of a 'mapped' "
+        "table", m_scratchDir);
+    args.add("memory-budget", "Megabytes of point data a 'mapped' or "
+        "'compressed' table keeps uncompressed in memory", m_memoryBudget, (uint64_t)1024);
+    args.add("memory-limit", "Megabytes of point data the pipeline may "
+        "hold in standard mode.  0 means no limit", m_memoryLimit,
+        (uint64_t)0);
+    args.add("memory-policy", "What to do when 'memory-limit' is reached: "
+        "'fail' stops the pipeline, 'spill' keeps points in a 'mapped' "
+        "table with the limit as its budget", m_memoryPolicy, "fail");
+    args.add("huge-pages", "Back the blocks of a 'row' table with "
+        "transparent huge pages where supported", m_hugePages);
+    args.add("aligned-points", "Pad each point so that its fields are "
+        "aligned in memory", m_alignedPoints);
+    args.add("batch", "File listing the files to run the pipeline on, one "
+        "per line.  Each input filename may be followed by an output "
+        "filename", m_batchFile);
+    args.add("jobs", "Number of files processed at once with 'batch'",
+        m_jobs, 1);
+    args.add("workers", "File listing commands that run PDAL on worker "
+        "hosts, one per line.  Files of a 'batch' are sent to the workers "
+        "rather than processed in this process", m_workersFile);
+    args.add("essential-metadata", "Only build the metadata that stages "
+        "need, skipping descriptive metadata", m_essentialMetadata);
+    args.add("trace", "Write a timeline of the execution of stages, "
+        "stream batches, pool tasks and I/O to this file in Chrome trace "
+        "format", m_traceFile);
+    args.add("trace-events", "Number of events kept for 'trace'.  The "
+        "oldest are dropped once there are more", m_traceEvents,
+        (size_t)(1 << 20));
+    args.add("cache-dir", "Directory in which to save the output of "
+        "pipeline stages, so that later runs can start from it.  Implies "
+        "'nostream'", m_cacheDir);
+    args.add("xyz-scale", "Store X, Y and Z as integers scaled by this "
+        "value: 'auto' to use the scale of the input, one scale or three "
+        "comma-separated scales", m_xyzScale);
+    args.add("xyz-offset", "Offset of X, Y and Z when they're stored as "
+        "scaled integers: 'auto', one offset or three comma-separated "
+        "offsets", m_xyzOffset, "auto");
+}
+
+
+// Write the events recorded for 'trace' and stop recording.
+void PipelineKernel::writeTrace()
+{
+    if (m_traceFile.empty())
+        return;
+
+    std::ostream *out = Utils::createFile(m_traceFile, false);
+    if (!out)
+        throw pdal_error("Can't open file '" + m_traceFile +
+            "' for trace output.");
+    Trace::write(*out);
+    Utils::closeFile(out);
+    Trace::stop();
 }
 
 
@@ -109,6 +322,8 @@ int PipelineKernel::execute()
         m_progressFd = Utils::openProgress(m_progressFile);
         m_manager.setProgressFd(m_progressFd);
     }
+    if (m_essentialMetadata)
+        m_manager.setMetadataPolicy(MetadataPolicy::Essential);
 
     if (m_validate)
     {
@@ -135,16 +350,63 @@ int PipelineKernel::execute()
         return 0;
     }
 
+    // Tables of batch runs share a pool, so that blocks freed by one run
+    // are reused by the next.
+    if (m_tableType == "row" && (m_batchFile.size() || m_hugePages))
+        m_blockPool.reset(new BlockPool(1024 * 1024 * 1024, m_hugePages));
+
+    if (m_traceFile.size())
+        Trace::start(m_traceEvents);
+
+    if (m_batchFile.size())
+    {
+        int ret = executeBatch();
+        Utils::closeProgress(m_progressFd);
+        writeTrace();
+        return ret;
+    }
+
     m_manager.readPipeline(m_inputFile);
-    if (m_noStream || !m_manager.pipelineStreamable())
-        m_manager.execute();
-    else
+
+    // With --stream-metadata, each stage's metadata is written as the
+    // stage finishes, so it isn't all held until the pipeline is done.
+    std::ostream *metaOut = nullptr;
+    std::unique_ptr<Utils::MetadataJsonStream> metaStream;
+    if (m_metadataFile.size() && m_streamMetadata)
     {
-        FixedPointTable table(10000);
-        m_manager.executeStream(table);
+        metaOut = Utils::createFile(m_metadataFile, false);
+        if (!metaOut)
+            throw pdal_error("Can't open file '" + m_metadataFile +
+                "' for metadata output.");
+        metaStream.reset(new Utils::MetadataJsonStream(*metaOut, "stages"));
+        Utils::MetadataJsonStream *ms = metaStream.get();
+        for (Stage *s : m_manager.stages())
+            s->setDoneCallback([ms](Stage& stage)
+                { ms->add(PipelineManager::getMetadata(stage)); });
     }
+    auto closeMetadata = [this, &metaStream, &metaOut]()
+    {
+        if (!metaStream)
+            return;
+        for (Stage *s : m_manager.stages())
+            s->setDoneCallback(nullptr);
+        metaStream.reset();
+        Utils::closeFile(metaOut);
+    };
 
-    if (m_metadataFile.size())
+    try
+    {
+        runPipeline(m_manager);
+    }
+    catch (...)
+    {
+        closeMetadata();
+        throw;
+    }
+    closeMetadata();
+    writeTrace();
+
+    if (m_metadataFile.size() && !m_streamMetadata)
     {
         std::ostream *out = Utils::createFile(m_metadataFile, false);
         if (!out)
@@ -153,6 +415,8 @@ int PipelineKernel::execute()
         Utils::toJSON(m_manager.getMetadata(), *out);
         Utils::closeFile(out);
     }
+    if (m_profile)
+        Utils::toJSON(m_manager.getProfile(), std::cout);
     if (m_pipelineFile.size())
         PipelineWriter::writePipeline(m_manager.getStage(), m_pipelineFile);
 
@@ -175,4 +439,505 @@ int PipelineKernel::execute()
     return 0;
 }
 
+
+namespace
+{
+
+struct BatchFile
+{
+    std::string m_input;
+    std::string m_output;
+};
+
+std::vector<BatchFile> readBatchFile(const std::string& filename)
+{
+    std::istream *in = Utils::openFile(filename, false);
+    if (!in)
+        throw pdal_error("Can't open batch file '" + filename + "'.");
+
+    std::vector<BatchFile> files;
+    std::string line;
+    while (std::getline(*in, line))
+    {
+        Utils::trim(line);
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        BatchFile f;
+        std::istringstream iss(line);
+        iss >> f.m_input >> f.m_output;
+        files.push_back(f);
+    }
+    Utils::closeFile(in);
+    return files;
+}
+
+
+// Replace the filename of the first reader of a parsed pipeline with an
+// input file.  If an output file is given, it replaces the filename of the
+// last writer.  Otherwise '#' in writer filenames is replaced by the stem
+// of the input file.  Readers and writers are identified as they are by
+// PipelineReaderJSON.
+Json::Value batchPipeline(const Json::Value& root, const BatchFile& f)
+{
+    Json::Value tree(root);
+    Json::Value& stages = (tree.isObject() && tree.isMember("pipeline")) ?
+        tree["pipeline"] : tree;
+    if (!stages.isArray() || stages.empty())
+        throw pdal_error("JSON pipeline: Root element is not a Pipeline");
+
+    auto filename = [](Json::Value& node) -> Json::Value&
+    {
+        return node.isString() ? node : node["filename"];
+    };
+
+    bool haveReader = false;
+    std::vector<Json::Value *> writers;
+    Json::ArrayIndex last = stages.size() - 1;
+    for (Json::ArrayIndex i = 0; i < stages.size(); ++i)
+    {
+        Json::Value& node = stages[i];
+        std::string type;
+        if (node.isObject() && node["type"].isString())
+            type = node["type"].asString();
+
+        if ((type.empty() && (i == 0 || i != last)) ||
+            Utils::startsWith(type, "readers."))
+        {
+            if (!haveReader)
+                filename(node) = f.m_input;
+            haveReader = true;
+        }
+        else if (type.empty() || Utils::startsWith(type, "writers."))
+            writers.push_back(&node);
+    }
+    if (!haveReader)
+        throw pdal_error("Batch pipeline has no reader.");
+
+    if (f.m_output.size())
+    {
+        if (writers.empty())
+            throw pdal_error("Batch pipeline has no writer for output '" +
+                f.m_output + "'.");
+        filename(*writers.back()) = f.m_output;
+        return tree;
+    }
+
+    // Writers without a filename, such as writers.null, are left alone.
+    bool named = false;
+    bool replaced = false;
+    const std::string stem = FileUtils::stem(f.m_input);
+    for (Json::Value *w : writers)
+    {
+        if (w->isObject() && !w->isMember("filename"))
+            continue;
+        named = true;
+        Json::Value& val = filename(*w);
+        std::string name = val.asString();
+        std::string::size_type pos;
+        while ((pos = name.find('#')) != std::string::npos)
+        {
+            name.replace(pos, 1, stem);
+            replaced = true;
+        }
+        val = name;
+    }
+    if (named && !replaced)
+        throw pdal_error("No output filename for '" + f.m_input + "'.  "
+            "Writer filenames must contain '#' or an output filename must "
+            "follow each input file in the batch file.");
+    return tree;
+}
+
+
+std::vector<std::string> readWorkersFile(const std::string& filename)
+{
+    std::istream *in = Utils::openFile(filename, false);
+    if (!in)
+        throw pdal_error("Can't open workers file '" + filename + "'.");
+
+    std::vector<std::string> workers;
+    std::string line;
+    while (std::getline(*in, line))
+    {
+        Utils::trim(line);
+        if (line.size() && line[0] != '#')
+            workers.push_back(line);
+    }
+    Utils::closeFile(in);
+    if (workers.empty())
+        throw pdal_error("Workers file '" + filename + "' lists no workers.");
+    return workers;
+}
+
+
+// Add JSON written by Utils::toJSON() to metadata.  The types of values
+// aren't kept, but they read back as the same values.
+void addJSON(MetadataNode& parent, const std::string& name,
+    const Json::Value& v, bool list = false)
+{
+    if (v.isArray())
+    {
+        for (const Json::Value& elt : v)
+            addJSON(parent, name, elt, true);
+    }
+    else if (v.isObject())
+    {
+        MetadataNode n(name);
+        for (const std::string& key : v.getMemberNames())
+            addJSON(n, key, v[key]);
+        if (list)
+            parent.addList(n);
+        else
+            parent.add(n);
+    }
+    else if (v.isBool())
+        list ? parent.addList(name, v.asBool()) : parent.add(name, v.asBool());
+    else if (v.isUInt64())
+        list ? parent.addList(name, v.asUInt64()) :
+            parent.add(name, v.asUInt64());
+    else if (v.isInt64())
+        list ? parent.addList(name, v.asInt64()) :
+            parent.add(name, v.asInt64());
+    else if (v.isDouble())
+        list ? parent.addList(name, v.asDouble()) :
+            parent.add(name, v.asDouble());
+    else
+        list ? parent.addList(name, v.asString()) :
+            parent.add(name, v.asString());
+}
+
+
+// Run a batch pipeline with a worker command.  The worker is given the
+// pipeline on standard input and returns the metadata of the run on
+// standard output.
+MetadataNode runOnWorker(const std::string& worker,
+    const Json::Value& pipeline)
+{
+    const std::string filename =
+        FileUtils::uniqueFilename("", "pdal-worker-") + ".json";
+    std::ostream *out = Utils::createFile(filename, false);
+    if (!out)
+        throw pdal_error("Can't create file '" + filename + "'.");
+    Json::StyledWriter writer;
+    *out << writer.write(pipeline);
+    Utils::closeFile(out);
+
+    std::string output;
+    int status = Utils::run_shell_command(worker +
+        " pipeline --stdin --metadata STDOUT < \"" + filename + "\"", output);
+    FileUtils::deleteFile(filename);
+    if (status)
+        throw pdal_error("Worker '" + worker + "' failed with status " +
+            std::to_string(status) + ".");
+
+    Json::Value root;
+    Json::CharReaderBuilder builder;
+    std::string err;
+    std::istringstream iss(output);
+    if (!Json::parseFromStream(builder, iss, &root, &err) ||
+            !root.isObject() || !root["stages"].isObject())
+        throw pdal_error("Worker '" + worker + "' didn't return the "
+            "metadata of the pipeline.");
+
+    MetadataNode stages("stages");
+    for (const std::string& name : root["stages"].getMemberNames())
+        addJSON(stages, name, root["stages"][name]);
+    return stages;
+}
+
+
+// Count the points read by a pipeline run on a worker: the sum of the
+// points out of its root stages, as for a local run.  Stages are found in
+// the metadata by name.  Stages of the same type are in pipeline order.
+point_count_t workerPointsOut(const Json::Value& pipeline,
+    const MetadataNode& metadata)
+{
+    PipelineManager manager;
+    manager.readPipeline(pipeline);
+    const std::vector<Stage *> roots = manager.roots();
+
+    point_count_t count = 0;
+    std::map<std::string, size_t> seen;
+    for (Stage *s : manager.stages())
+    {
+        const size_t k = seen[s->getName()]++;
+        if (std::find(roots.begin(), roots.end(), s) == roots.end())
+            continue;
+        const MetadataNodeList nodes = metadata.children(s->getName());
+        if (k < nodes.size())
+            count += nodes[k].findChild("profile:points_out").
+                value<point_count_t>();
+    }
+    return count;
+}
+
+
+// Combine the profiles of two runs of a stage.  Storage sizes are peaks,
+// so the larger is kept.  Times, point counts and I/O add up.
+MetadataNode mergeProfile(const MetadataNode& a, const MetadataNode& b)
+{
+    MetadataNode m(a.name());
+    for (const MetadataNode& n : a.children())
+    {
+        const std::string name = n.name();
+        const MetadataNode other = b.findChild(name);
+        if (name == "allocated_bytes" || name == "table_bytes")
+            m.add(name, (std::max)(n.value<uint64_t>(),
+                other.value<uint64_t>()), n.description());
+        else if (n.type() == "double")
+            m.add(name, n.value<double>() + other.value<double>(),
+                n.description());
+        else
+            m.add(name, n.value<uint64_t>() + other.value<uint64_t>(),
+                n.description());
+    }
+    return m;
+}
+
+
+// Gathers the metadata of the runs of a batch.  The metadata of each stage
+// is combined with Stage::mergeMetadata().  If a stage can't combine its
+// metadata, the metadata of each run is kept as a list of parts.
+class MetadataGather
+{
+public:
+    MetadataGather(const std::vector<Stage *>& stages) : m_stages(stages),
+        m_merged(stages.size()), m_profiles(stages.size()),
+        m_parts(stages.size())
+    {}
+
+    // Add the metadata of a run, as returned by
+    // PipelineManager::getMetadata().
+    void add(const MetadataNode& root)
+    {
+        // Stages are found by name.  Stages of the same type are in
+        // pipeline order.
+        std::map<std::string, size_t> seen;
+        for (size_t i = 0; i < m_stages.size(); ++i)
+        {
+            const Stage& stage = *m_stages[i];
+            const MetadataNodeList nodes = root.children(stage.getName());
+            const size_t k = seen[stage.getName()]++;
+            if (k >= nodes.size())
+                continue;
+
+            MetadataNode own(nodes[k].name());
+            for (const MetadataNode& n : nodes[k].children())
+            {
+                if (n.name() == "profile")
+                    m_profiles[i] = m_profiles[i].valid() ?
+                        mergeProfile(m_profiles[i], n) : n;
+                else if (n.kind() == MetadataType::Array)
+                    own.addList(n);
+                else
+                    own.add(n);
+            }
+
+            MetadataNode& merged = m_merged[i];
+            if (m_parts[i].size())
+                m_parts[i].push_back(own);
+            else if (!merged.valid() || !own.hasChildren())
+                merged = merged.valid() ? merged : own;
+            else if (merged.hasChildren())
+            {
+                MetadataNode m = stage.mergeMetadata(merged, own);
+                if (m.valid())
+                    merged = m;
+                else
+                {
+                    m_parts[i].push_back(merged);
+                    m_parts[i].push_back(own);
+                }
+            }
+            else
+                merged = own;
+        }
+    }
+
+    MetadataNode result() const
+    {
+        MetadataNode output("stages");
+        for (size_t i = 0; i < m_stages.size(); ++i)
+        {
+            const std::string name = m_stages[i]->getName();
+            MetadataNode m(name);
+            if (m_parts[i].size())
+            {
+                for (const MetadataNode& part : m_parts[i])
+                    m.addList(part.clone("part"));
+            }
+            else if (m_merged[i].valid())
+                m = m_merged[i].clone(name);
+            else
+                continue;
+            if (m_profiles[i].valid())
+                m.add(m_profiles[i]);
+            output.add(m);
+        }
+        return output;
+    }
+
+private:
+    std::vector<Stage *> m_stages;
+    std::vector<MetadataNode> m_merged;
+    std::vector<MetadataNode> m_profiles;
+    std::vector<MetadataNodeList> m_parts;
+};
+
+} // unnamed namespace
+
+
+// Run the pipeline on each file in the batch file, several at a time.
+// The stages of each run are created from a copy of the parsed pipeline.
+int PipelineKernel::executeBatch()
+{
+    Json::Value root;
+    std::istream *in = Utils::openFile(m_inputFile, false);
+    if (!in)
+        throw pdal_error("Can't open file '" + m_inputFile + "' as pipeline "
+            "input.");
+    Json::CharReaderBuilder builder;
+    builder["rejectDupKeys"] = true;
+    std::string err;
+    bool ok = Json::parseFromStream(builder, *in, &root, &err);
+    Utils::closeFile(in);
+    if (!ok)
+        throw pdal_error("JSON pipeline: Unable to parse pipeline:\n" + err);
+
+    // Substitute all the filenames before running anything so that
+    // mistakes in the batch file are found right away.
+    std::vector<BatchFile> files = readBatchFile(m_batchFile);
+    std::vector<Json::Value> pipelines;
+    for (const BatchFile& f : files)
+        pipelines.push_back(batchPipeline(root, f));
+
+    // Each worker runs one file at a time.  Options given on the command
+    // line aren't part of the pipeline, so they can't be sent to workers.
+    std::vector<std::string> workers;
+    if (m_workersFile.size())
+    {
+        if (m_manager.commonOptions().getKeys().size() ||
+                !m_manager.stageOptions().empty())
+            throw pdal_error("Stage options can't be used with 'workers'. "
+                "Set them in the pipeline.");
+        workers = readWorkersFile(m_workersFile);
+    }
+    std::vector<std::string> idle(workers);
+    int jobs = workers.size() ? (int)workers.size() : m_jobs;
+
+    // The stages of the pipeline name the metadata gathered from the runs.
+    std::unique_ptr<MetadataGather> gather;
+    if (m_metadataFile.size())
+    {
+        m_manager.readPipeline(pipelines.front());
+        gather.reset(new MetadataGather(m_manager.stages()));
+    }
+
+    // Metadata of each file, gathered in file order once all have run.
+    std::vector<MetadataNode> results(files.size());
+    std::mutex mutex;
+    size_t done = 0;
+    size_t failed = 0;
+    point_count_t total = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    ThreadPool pool(jobs, jobs, false);
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        pool.add([&, i]()
+        {
+            auto fileStart = std::chrono::steady_clock::now();
+            std::string error;
+            point_count_t count = 0;
+            MetadataNode metadata;
+            if (workers.size())
+            {
+                std::string worker;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    worker = idle.back();
+                    idle.pop_back();
+                }
+                try
+                {
+                    metadata = runOnWorker(worker, pipelines[i]);
+                    count = workerPointsOut(pipelines[i], metadata);
+                }
+                catch (std::exception& e)
+                {
+                    error = e.what();
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                idle.push_back(worker);
+            }
+            else
+            {
+                try
+                {
+                    PipelineManager manager;
+                    manager.setLog(m_log);
+                    manager.setProgressFd(m_progressFd);
+                    if (m_essentialMetadata)
+                        manager.setMetadataPolicy(MetadataPolicy::Essential);
+                    manager.commonOptions() = m_manager.commonOptions();
+                    manager.stageOptions() = m_manager.stageOptions();
+                    manager.readPipeline(pipelines[i]);
+                    count = runPipeline(manager);
+                    if (gather)
+                        metadata = manager.getMetadata();
+                }
+                catch (std::exception& e)
+                {
+                    error = e.what();
+                }
+            }
+            std::chrono::duration<double> secs =
+                std::chrono::steady_clock::now() - fileStart;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            done++;
+            if (gather && error.empty())
+                results[i] = metadata;
+            std::cout << "[" << done << "/" << files.size() << "] " <<
+                files[i].m_input << ": ";
+            if (error.size())
+            {
+                failed++;
+                std::cout << "failed: " << error << std::endl;
+            }
+            else
+            {
+                total += count;
+                std::cout << count << " points in " << secs.count() <<
+                    " s" << std::endl;
+            }
+        });
+    }
+    pool.join();
+
+    if (gather)
+    {
+        for (const MetadataNode& metadata : results)
+            if (metadata.valid())
+                gather->add(metadata);
+        std::ostream *out = Utils::createFile(m_metadataFile, false);
+        if (!out)
+            throw pdal_error("Can't open file '" + m_metadataFile +
+                "' for metadata output.");
+        Utils::toJSON(gather->result(), *out);
+        Utils::closeFile(out);
+    }
+
+    std::chrono::duration<double> secs =
+        std::chrono::steady_clock::now() - start;
+    std::cout << "Processed " << files.size() << " files (" << failed <<
+        " failed): " << total << " points in " << secs.count() << " s";
+    if (secs.count() > 0)
+        std::cout << " (" << (point_count_t)(total / secs.count()) <<
+            " points/s)";
+    std::cout << std::endl;
+    return failed ? 1 : 0;
+}
+
 } // pdal
@@ -34,6 +34,7 @@
 
 #pragma once
 
+#include <pdal/BlockAllocator.hpp>
 #include <pdal/Kernel.hpp>
 #include <pdal/PipelineManager.hpp>
 #include <pdal/PipelineWriter.hpp>
@@ -53,10 +54,14 @@ private:
     void addSwitches(ProgramArgs& args);
     void validateSwitches(ProgramArgs& args);
     virtual bool isStagePrefix(const std::string& stage);
+    point_count_t runPipeline(PipelineManager& manager);
+    int executeBatch();
+    void writeTrace();
 
     std::string m_inputFile;
     std::string m_pipelineFile;
     std::string m_metadataFile;
+    bool m_streamMetadata;
     bool m_validate;
     std::string m_PointCloudSchemaOutput;
     std::string m_progressFile;
@@ -64,6 +69,30 @@ private:
     bool m_usestdin;
     bool m_stream;
     bool m_noStream;
+    std::string m_streamBatch;
+    int m_threads;
+    std::string m_tableType;
+    std::string m_scratchDir;
+    uint64_t m_memoryBudget;
+    uint64_t m_memoryLimit;
+    std::string m_memoryPolicy;
+    bool m_hugePages;
+    bool m_alignedPoints;
+    BlockAllocatorPtr m_blockPool;
+    bool m_hybrid;
+    point_count_t m_hybridChunk;
+    bool m_streamUnordered;
+    bool m_profile;
+    std::string m_batchFile;
+    int m_jobs;
+    std::string m_workersFile;
+    bool m_essentialMetadata;
+    std::string m_traceFile;
+    size_t m_traceEvents;
+    std::string m_cacheDir;
+    std::string m_xyzScale;
+    std::string m_xyzOffset;
+    std::vector<XForm> m_xyzXForms;
 };
 
 } // pdal
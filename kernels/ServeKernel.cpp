@@ -0,0 +1,273 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (hobu.inc@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "ServeKernel.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <sstream>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include <pdal/GDALUtils.hpp>
+#include <pdal/PipelineManager.hpp>
+#include <pdal/PluginManager.hpp>
+#include <pdal/Stage.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+namespace pdal
+{
+
+static StaticPluginInfo const s_info
+{
+    "kernels.serve",
+    "Serve Kernel",
+    "http://pdal.io/apps/serve.html"
+};
+
+CREATE_STATIC_KERNEL(ServeKernel, s_info)
+
+std::string ServeKernel::getName() const { return s_info.name; }
+
+ServeKernel::ServeKernel() : m_jobs(1), m_threads(1), m_maxRequests(0),
+    m_timeout(60), m_essentialMetadata(false)
+{}
+
+
+void ServeKernel::addSwitches(ProgramArgs& args)
+{
+    args.add("socket", "Filename of the local socket on which to accept "
+        "pipelines", m_socket).setPositional();
+    args.add("jobs", "Number of pipelines run at once.  0 uses all "
+        "available cores", m_jobs, 0);
+    args.add("threads", "Maximum number of threads used to run each "
+        "pipeline", m_threads, 1);
+    args.add("max-requests", "Exit after this many requests.  0 serves "
+        "until the process is stopped", m_maxRequests, (uint64_t)0);
+    args.add("timeout", "Seconds to wait for more of a pipeline from a "
+        "client before giving up on it.  0 waits forever", m_timeout, 60);
+    args.add("essential-metadata", "Only build the metadata that stages "
+        "need, skipping descriptive metadata", m_essentialMetadata);
+}
+
+
+void ServeKernel::validateSwitches(ProgramArgs& /*args*/)
+{
+    if (m_jobs < 0)
+        throw pdal_error("Number of jobs can't be negative.");
+    if (m_jobs == 0)
+        m_jobs = (std::max)((int)std::thread::hardware_concurrency(), 1);
+    if (m_threads < 1)
+        throw pdal_error("Number of threads must be positive.");
+    if (m_timeout < 0)
+        throw pdal_error("Timeout can't be negative.");
+}
+
+
+// Run one pipeline, in stream mode if possible, and return the JSON
+// response.
+std::string ServeKernel::run(const std::string& pipeline)
+{
+    MetadataNode root;
+    auto start = std::chrono::steady_clock::now();
+    try
+    {
+        PipelineManager manager;
+        manager.setLog(m_log);
+        if (m_essentialMetadata)
+            manager.setMetadataPolicy(MetadataPolicy::Essential);
+        std::istringstream in(pipeline);
+        manager.readPipeline(in);
+        if (manager.pipelineStreamable())
+        {
+            FixedPointTable table(10000);
+            manager.executeStream(table, m_threads);
+        }
+        else
+            manager.execute(m_threads);
+
+        point_count_t count = 0;
+        for (Stage *s : manager.roots())
+            count += s->profile().pointsOut();
+        std::chrono::duration<double> secs =
+            std::chrono::steady_clock::now() - start;
+
+        root.add("points", count);
+        root.add("seconds", secs.count());
+        root.add(manager.getMetadata().clone("metadata"));
+    }
+    catch (std::exception& e)
+    {
+        root = MetadataNode();
+        root.add("error", e.what());
+    }
+
+    std::ostringstream out;
+    Utils::toJSON(root, out);
+    return out.str();
+}
+
+
+#ifdef _WIN32
+
+int ServeKernel::listen()
+{
+    throw pdal_error("'pdal serve' isn't supported on Windows.");
+}
+
+
+void ServeKernel::handle(int)
+{}
+
+#else
+
+// Read a pipeline from a connection until the client shuts down its side,
+// run it and write the response.  A client that sends nothing for
+// 'timeout' seconds is answered with an error, so it can't hold a job
+// forever.
+void ServeKernel::handle(int fd)
+{
+    if (m_timeout)
+    {
+        timeval tv {};
+        tv.tv_sec = m_timeout;
+        ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    }
+
+    std::string pipeline;
+    char buf[4096];
+    ssize_t cnt;
+    while ((cnt = ::read(fd, buf, sizeof(buf))) > 0)
+        pipeline.append(buf, cnt);
+
+    std::string response;
+    if (cnt == 0)
+        response = run(pipeline);
+    else if (errno == EAGAIN || errno == EWOULDBLOCK)
+    {
+        MetadataNode root;
+        root.add("error", "Timed out reading pipeline.");
+        std::ostringstream out;
+        Utils::toJSON(root, out);
+        response = out.str();
+    }
+
+    int flags = 0;
+#ifdef MSG_NOSIGNAL
+    flags = MSG_NOSIGNAL;
+#endif
+    const char *pos = response.data();
+    size_t left = response.size();
+    while (left)
+    {
+        cnt = ::send(fd, pos, left, flags);
+        if (cnt <= 0)
+            break;
+        pos += cnt;
+        left -= cnt;
+    }
+    ::close(fd);
+}
+
+
+int ServeKernel::listen()
+{
+    sockaddr_un addr {};
+    if (m_socket.size() >= sizeof(addr.sun_path))
+        throw pdal_error("Socket filename '" + m_socket + "' is too long.");
+    addr.sun_family = AF_UNIX;
+    m_socket.copy(addr.sun_path, m_socket.size());
+
+    int sock = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock < 0)
+        throw pdal_error("Unable to create socket.");
+
+    // A socket file left by a previous server would make bind() fail.
+    // Other files are left alone and make bind() fail instead.
+    struct stat st;
+    if (::lstat(m_socket.c_str(), &st) == 0 && S_ISSOCK(st.st_mode))
+        FileUtils::deleteFile(m_socket);
+    if (::bind(sock, (sockaddr *)&addr, sizeof(addr)) != 0 ||
+        ::listen(sock, 128) != 0)
+    {
+        ::close(sock);
+        throw pdal_error("Unable to listen on socket '" + m_socket + "'.");
+    }
+
+    // Connections wait in the pool's queue while all jobs are busy, so a
+    // burst of requests doesn't start more pipelines than 'jobs'.
+    ThreadPool pool(m_jobs, m_jobs, false);
+    uint64_t requests = 0;
+    while (!m_maxRequests || requests < m_maxRequests)
+    {
+        int fd = ::accept(sock, nullptr, nullptr);
+        if (fd < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            break;
+        }
+        requests++;
+        pool.add([this, fd](){ handle(fd); });
+    }
+    pool.join();
+    ::close(sock);
+    FileUtils::deleteFile(m_socket);
+    return 0;
+}
+
+#endif
+
+
+int ServeKernel::execute()
+{
+    if (m_socket.empty())
+        throw pdal_error("Socket filename required.");
+
+    // Load everything that would otherwise be loaded by the first request
+    // that needs it.  It stays loaded for the life of the server.
+    PluginManager<Stage>::loadAll();
+    gdal::registerDrivers();
+
+    return listen();
+}
+
+} // namespace pdal
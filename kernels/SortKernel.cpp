@@ -34,7 +34,11 @@
 
 #include "SortKernel.hpp"
 
+#include <pdal/PointTable.hpp>
 #include <pdal/Stage.hpp>
+#include <pdal/util/Utils.hpp>
+
+#include "private/ExternalSort.hpp"
 
 namespace pdal
 {
@@ -54,7 +58,8 @@ std::string SortKernel::getName() const
 }
 
 
-SortKernel::SortKernel() : m_bCompress(false), m_bForwardMetadata(false)
+SortKernel::SortKernel() : m_bCompress(false), m_bForwardMetadata(false),
+    m_external(false), m_memoryBudget(1024)
 {}
 
 
@@ -67,20 +72,62 @@ void SortKernel::addSwitches(ProgramArgs& args)
     args.add("metadata,m",
         "Forward metadata (VLRs, header entries, etc) from previous stages",
         m_bForwardMetadata);
+    args.add("dimension,d", "Dimensions on which to sort, separated by "
+        "commas.  If not provided, points are sorted in Morton order",
+        m_dimension);
+    args.add("order", "Sort order ASC(ending) or DESC(ending)", m_order,
+        "ASC");
+    args.add("external", "Sort points that don't fit in memory by writing "
+        "sorted runs to temporary files and merging them", m_external);
+    args.add("memory-budget", "Megabytes of points to sort in memory at "
+        "once with 'external'", m_memoryBudget, (uint64_t)1024);
+    args.add("temp-dir", "Directory for the temporary files of 'external'",
+        m_tempDir);
+}
+
+
+void SortKernel::validateSwitches(ProgramArgs& args)
+{
+    m_order = Utils::toupper(m_order);
+    if (m_order != "ASC" && m_order != "DESC")
+        throw pdal_error("Invalid sort order '" + m_order + "'.  "
+            "Must be 'ASC' or 'DESC'.");
+    if (args.set("order") && m_dimension.empty())
+        throw pdal_error("'order' option requires 'dimension' option.");
+    if (m_external && m_dimension.empty())
+        throw pdal_error("'external' option requires 'dimension' option.");
+    if (m_memoryBudget == 0)
+        throw pdal_error("Memory budget must be positive.");
 }
 
 
 int SortKernel::execute()
 {
     Stage& readerStage = makeReader(m_inputFile, m_driverOverride);
-    Stage& sortStage = makeFilter("filters.mortonorder", readerStage);
 
     Options writerOptions;
     if (m_bCompress)
         writerOptions.add("compression", true);
     if (m_bForwardMetadata)
         writerOptions.add("forward_metadata", true);
-    Stage& writer = makeWriter(m_outputFile, sortStage, "", writerOptions);
+
+    if (m_external)
+    {
+        executeExternal(readerStage, writerOptions);
+        return 0;
+    }
+
+    Stage *sortStage;
+    if (m_dimension.empty())
+        sortStage = &makeFilter("filters.mortonorder", readerStage);
+    else
+    {
+        Options sortOptions;
+        sortOptions.add("dimension", m_dimension);
+        sortOptions.add("order", m_order);
+        sortStage = &makeFilter("filters.sort", readerStage, sortOptions);
+    }
+    Stage& writer = makeWriter(m_outputFile, *sortStage, "", writerOptions);
 
     PointTable table;
     writer.prepare(table);
@@ -89,4 +136,34 @@ int SortKernel::execute()
     return 0;
 }
 
+
+// Stream the input into sorted runs, then stream the merged runs to the
+// writer.  Only a run's worth of points is held in memory at once.
+void SortKernel::executeExternal(Stage& reader, const Options& writerOptions)
+{
+    sort::ExternalSort sorter(Utils::split2(m_dimension, ','),
+        m_order == "DESC", m_memoryBudget * 1024 * 1024, m_tempDir);
+
+    point_count_t count = sorter.makeRuns(reader);
+    m_log->get(LogLevel::Debug) << "Sorted " << count << " points into " <<
+        sorter.numRuns() << " runs." << std::endl;
+
+    Stage& writer = makeWriter(m_outputFile, sorter.merged(), "",
+        writerOptions);
+    if (writer.pipelineStreamable())
+    {
+        FixedPointTable table(10000);
+        writer.prepare(table);
+        writer.execute(table);
+    }
+    else
+    {
+        m_log->get(LogLevel::Warning) << "Writer can't stream.  All points "
+            "will be loaded into memory." << std::endl;
+        PointTable table;
+        writer.prepare(table);
+        writer.execute(table);
+    }
+}
+
 } // namespace pdal
@@ -48,11 +48,18 @@ public:
 
 private:
     void addSwitches(ProgramArgs& args);
+    void validateSwitches(ProgramArgs& args);
+    void executeExternal(Stage& reader, const Options& writerOptions);
 
     std::string m_inputFile;
     std::string m_outputFile;
     bool m_bCompress;
     bool m_bForwardMetadata;
+    std::string m_dimension;
+    std::string m_order;
+    bool m_external;
+    uint64_t m_memoryBudget;
+    std::string m_tempDir;
 };
 
 } // namespace pdal
@@ -34,8 +34,13 @@
 
 #include "SplitKernel.hpp"
 
+#include <algorithm>
+#include <vector>
+
 #include <io/BufferReader.hpp>
+#include <pdal/Reader.hpp>
 #include <pdal/StageFactory.hpp>
+#include <pdal/StageWrapper.hpp>
 #include <pdal/util/Utils.hpp>
 
 namespace pdal
@@ -66,6 +71,8 @@ void SplitKernel::addSwitches(ProgramArgs& args)
         std::numeric_limits<double>::quiet_NaN());
     args.add("origin_y", "Origin in Y axis for splitter cells", m_yOrigin,
         std::numeric_limits<double>::quiet_NaN());
+    args.add("stream", "Split the points as they're read rather than "
+        "reading them all first", m_stream);
 }
 
 
@@ -95,6 +102,18 @@ std::string makeFilename(const std::string& s, int i)
 
 
 int SplitKernel::execute()
+{
+    if (!m_stream)
+        executeStandard();
+    else if (m_length)
+        streamByLength();
+    else
+        streamByCapacity();
+    return 0;
+}
+
+
+void SplitKernel::executeStandard()
 {
     PointTable table;
 
@@ -128,7 +147,127 @@ int SplitKernel::execute()
         writer.prepare(table);
         writer.execute(table);
     }
-    return 0;
+}
+
+
+// Write the points to a new file every 'capacity' points, in the order
+// they're read.  Unlike filters.chipper, the points of a file needn't be
+// near one another.
+void SplitKernel::streamByCapacity()
+{
+    FixedPointTable table(10000);
+
+    Stage& r = makeReader(m_inputFile, m_driverOverride);
+    Streamable *reader = dynamic_cast<Streamable *>(&r);
+    if (!reader || !reader->pipelineStreamable())
+        throw pdal_error("Driver for input file '" + m_inputFile +
+            "' is not streamable.");
+
+    // The table's layout can't change once points have been read, so a
+    // writer is prepared for every output file first.  That takes the
+    // number of points.
+    QuickInfo qi = r.preview();
+    if (!qi.valid())
+        throw pdal_error("Can't split input file '" + m_inputFile +
+            "' by capacity as it's read: its number of points isn't known.");
+    point_count_t total = qi.m_pointCount;
+    if (Reader *rdr = dynamic_cast<Reader *>(&r))
+        total = (std::min)(total, rdr->count());
+    reader->prepare(table);
+
+    std::vector<Streamable *> writers;
+    do
+    {
+        std::string filename = makeFilename(m_outputFile,
+            (int)writers.size() + 1);
+        Streamable *writer =
+            dynamic_cast<Streamable *>(&m_manager.makeWriter(filename, ""));
+        if (!writer)
+            throw pdal_error("Driver for output file '" + filename +
+                "' is not streamable.");
+        writer->prepare(table);
+        writers.push_back(writer);
+    } while (writers.size() * m_capacity < total);
+    table.finalize();
+
+    StreamableWrapper::ready(*reader, table);
+    SpatialReference srs = reader->getSpatialReference();
+    if (!srs.empty())
+        table.setSpatialReference(srs);
+
+    size_t filenum = 0;
+    point_count_t written = 0;
+    bool open = false;
+    bool finished = false;
+    PointRef point(table, 0);
+    while (!finished)
+    {
+        PointId count = 0;
+        for (; count < table.capacity(); ++count)
+        {
+            point.setPointId(count);
+            if (!StreamableWrapper::processOne(*reader, point))
+            {
+                finished = true;
+                break;
+            }
+        }
+
+        for (PointId idx = 0; idx < count; ++idx)
+        {
+            if (!open)
+            {
+                if (filenum == writers.size())
+                    throw pdal_error("Input file '" + m_inputFile +
+                        "' has more points than its header reports.");
+                StreamableWrapper::ready(*writers[filenum], table);
+                StreamableWrapper::spatialReferenceChanged(*writers[filenum],
+                    srs);
+                open = true;
+            }
+            point.setPointId(idx);
+            StreamableWrapper::processOne(*writers[filenum], point);
+            if (++written == m_capacity)
+            {
+                StreamableWrapper::done(*writers[filenum], table);
+                open = false;
+                written = 0;
+                filenum++;
+            }
+        }
+        table.clear(count);
+    }
+    if (open)
+        StreamableWrapper::done(*writers[filenum], table);
+    StreamableWrapper::done(*reader, table);
+}
+
+
+// Let filters.splitter write the points of each cell to its own file as
+// they're read.  Files are named by the position of their cell.
+void SplitKernel::streamByLength()
+{
+    FixedPointTable table(10000);
+
+    Stage& reader = makeReader(m_inputFile, m_driverOverride);
+
+    std::string filename(m_outputFile);
+    auto pos = filename.find_last_of('.');
+    if (pos == filename.npos)
+        pos = filename.length();
+    filename.insert(pos, "_#");
+
+    Options filterOpts;
+    filterOpts.add("length", m_length);
+    filterOpts.add("origin_x", m_xOrigin);
+    filterOpts.add("origin_y", m_yOrigin);
+    filterOpts.add("filename", filename);
+    Stage& f = makeFilter("filters.splitter", reader, filterOpts);
+    if (!f.pipelineStreamable())
+        throw pdal_error("Driver for input file '" + m_inputFile +
+            "' is not streamable.");
+    f.prepare(table);
+    f.execute(table);
 }
 
 } // namespace pdal
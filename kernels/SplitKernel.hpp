@@ -48,6 +48,9 @@ public:
 private:
     void addSwitches(ProgramArgs& args);
     void validateSwitches(ProgramArgs& args);
+    void executeStandard();
+    void streamByCapacity();
+    void streamByLength();
 
     std::string m_inputFile;
     std::string m_outputFile;
@@ -55,6 +58,7 @@ private:
     double m_length;
     double m_xOrigin;
     double m_yOrigin;
+    bool m_stream;
 };
 
 } // namespace pdal
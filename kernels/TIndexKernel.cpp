@@ -34,12 +34,16 @@
 
 #include "TIndexKernel.hpp"
 
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #include <pdal/PDALUtils.hpp>
 #include <pdal/StageFactory.hpp>
 #include <pdal/util/FileUtils.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 #include "../io/LasWriter.hpp"
 
@@ -79,6 +83,8 @@ TIndexKernel::TIndexKernel() : SubcommandKernel()
     , m_dataset(NULL)
     , m_layer(NULL)
     , m_overrideASrs(false)
+    , m_threads(0)
+    , m_exactCount(0)
 {}
 
 
@@ -113,6 +119,12 @@ void TIndexKernel::addSubSwitches(ProgramArgs& args,
             "Write absolute rather than relative file paths", m_absPath);
         args.add("stdin,s", "Read filespec pattern from standard input",
             m_usestdin);
+        args.add("threads", "Number of files to process at once (0 for "
+            "one per core)", m_threads, 0);
+        args.add("exact_count", "Number of points of each file binned "
+            "exactly when computing its boundary before the rest are "
+            "sampled (0 bins every point)", m_exactCount,
+            point_count_t(1000000));
     }
     else if (subcommand == "merge")
     {
@@ -192,30 +204,55 @@ StringList readSTDIN()
 }
 
 
-bool TIndexKernel::isFileIndexed(const FieldIndexes& indexes,
-    const FileInfo& fileInfo)
+// Look up a file in the index.  Returns the ID of the file's feature, or
+// OGRNullFID if the file isn't indexed.  'current' is set if the
+// modification time in the index matches that of the file.
+long long TIndexKernel::findFile(const FieldIndexes& indexes,
+    const std::string& filename, bool& current)
 {
     std::ostringstream qstring;
 
     qstring << Utils::toupper(m_tileIndexColumnName) << "=" <<
-        "'" << fileInfo.m_filename << "'";
+        "'" << filename << "'";
     std::string query = qstring.str();
     OGRErr err = OGR_L_SetAttributeFilter(m_layer, query.c_str());
     if (err != OGRERR_NONE)
     {
         std::ostringstream oss;
         oss << "Unable to set attribute filter for file '" <<
-             fileInfo.m_filename << "'";
+             filename << "'";
         throw pdal_error(oss.str());
     }
 
-    bool output(false);
+    long long fid = OGRNullFID;
+    current = false;
     OGR_L_ResetReading(m_layer);
-    if (OGR_L_GetNextFeature(m_layer))
-        output = true;
+    OGRFeatureH feature = OGR_L_GetNextFeature(m_layer);
+    if (feature)
+    {
+        fid = OGR_F_GetFID(feature);
+
+        int year, month, day, hour, minute, second, tz;
+        if (OGR_F_GetFieldAsDateTime(feature, indexes.m_mtime, &year,
+                &month, &day, &hour, &minute, &second, &tz))
+        {
+            struct tm mtime;
+            FileUtils::fileTimes(filename, nullptr, &mtime);
+            current = (year == mtime.tm_year + 1900 &&
+                month == mtime.tm_mon + 1 && day == mtime.tm_mday);
+
+            // Some formats (notably shapefile) only store the date.
+            OGRFieldDefnH defn = OGR_FD_GetFieldDefn(
+                OGR_L_GetLayerDefn(m_layer), indexes.m_mtime);
+            if (OGR_Fld_GetType(defn) == OFTDateTime)
+                current = current && hour == mtime.tm_hour &&
+                    minute == mtime.tm_min && second == mtime.tm_sec;
+        }
+        OGR_F_Destroy(feature);
+    }
     OGR_L_ResetReading(m_layer);
     OGR_L_SetAttributeFilter(m_layer, NULL);
-    return output;
+    return fid;
 }
 
 
@@ -264,27 +301,88 @@ void TIndexKernel::createFile()
 
     FieldIndexes indexes = getFields();
 
+    // A file to be scanned and, once done, added to the index.
+    struct Job
+    {
+        std::string m_filename;
+        long long m_fid;
+        FileInfo m_info;
+        bool m_ok;
+        bool m_done;
+    };
+
+    // Files whose modification time matches that in the index aren't
+    // scanned again.  OGR isn't thread-safe, so all use of the index
+    // happens on this thread.
     size_t filecount(0);
-    StageFactory factory(false);
+    std::vector<Job> jobs;
     for (auto f : m_files)
     {
         //ABELL - Not sure why we need to get absolute path here.
         f = FileUtils::toAbsolutePath(f);
-        FileInfo info;
-        if (getFileInfo(factory, f, info))
+        bool current;
+        long long fid = findFile(indexes, f, current);
+        if (current)
         {
             filecount++;
-            if (!isFileIndexed(indexes, info))
+            continue;
+        }
+        jobs.push_back(Job { f, fid, FileInfo(), false, false });
+    }
+
+    // Compute the boundaries on a pool of threads.  Features are added
+    // here in file order as the boundaries become available.
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t threads = m_threads ? (size_t)m_threads :
+        (size_t)(std::max)(std::thread::hardware_concurrency(), 1U);
+    ThreadPool pool(threads, (std::max)(jobs.size(), (size_t)1), false);
+    for (Job& job : jobs)
+    {
+        pool.add([this, &job, &mutex, &cv]()
+        {
+            bool ok(false);
+            try
             {
-                if (createFeature(indexes, info))
-                    m_log->get(LogLevel::Info) << "Indexed file " << f <<
-                    std::endl;
-                else
-                    m_log->get(LogLevel::Error) << "Failed to create feature "
-                        "for file '" << f << "'" << std::endl;
+                ok = getFileInfo(job.m_filename, job.m_info);
             }
+            catch (const std::exception& err)
+            {
+                m_log->get(LogLevel::Error) << "Skipping file '" <<
+                    job.m_filename << "': " << err.what() << std::endl;
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            job.m_ok = ok;
+            job.m_done = true;
+            cv.notify_all();
+        });
+    }
+
+    for (Job& job : jobs)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&job](){ return job.m_done; });
         }
+        if (!job.m_ok)
+            continue;
+        filecount++;
+
+        // Replace the feature of a file that has changed.
+        if (job.m_fid != OGRNullFID &&
+                OGR_L_DeleteFeature(m_layer, job.m_fid) != OGRERR_NONE)
+            m_log->get(LogLevel::Warning) << "Unable to remove outdated "
+                "feature for file '" << job.m_filename << "'" << std::endl;
+
+        if (createFeature(indexes, job.m_info))
+            m_log->get(LogLevel::Info) << "Indexed file " <<
+                job.m_filename << std::endl;
+        else
+            m_log->get(LogLevel::Error) << "Failed to create feature "
+                "for file '" << job.m_filename << "'" << std::endl;
     }
+    pool.join();
+
     if (!filecount)
         throw pdal_error("Couldn't index any files.");
     OGR_DS_Destroy(m_dataset);
@@ -515,8 +613,8 @@ bool TIndexKernel::slowBoundary(Stage& hexer, FileInfo& fileInfo)
 }
 
 
-bool TIndexKernel::getFileInfo(StageFactory& factory,
-    const std::string& filename, FileInfo& fileInfo)
+bool TIndexKernel::getFileInfo(const std::string& filename,
+    FileInfo& fileInfo)
 {
     PipelineManager manager;
     manager.commonOptions() = m_manager.commonOptions();
@@ -532,7 +630,10 @@ bool TIndexKernel::getFileInfo(StageFactory& factory,
     {
         if (!fast)
         {
-            Stage& hexer = manager.makeFilter("filters.hexbin", reader);
+            Options hexOptions;
+            hexOptions.add("exact_count", m_exactCount);
+            Stage& hexer = manager.makeFilter("filters.hexbin", reader,
+                hexOptions);
             fast = !slowBoundary(hexer, fileInfo);
         }
     }
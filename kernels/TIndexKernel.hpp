@@ -81,8 +81,7 @@ private:
     bool openLayer(const std::string& layerName);
     bool createLayer(const std::string& layerName);
     FieldIndexes getFields();
-    bool getFileInfo(StageFactory& factory, const std::string& filename,
-        FileInfo& info);
+    bool getFileInfo(const std::string& filename, FileInfo& info);
     bool createFeature(const FieldIndexes& indexes, FileInfo& info);
     gdal::Geometry prepareGeometry(const FileInfo& fileInfo);
     gdal::Geometry prepareGeometry(const std::string& wkt,
@@ -91,7 +90,8 @@ private:
     bool fastBoundary(Stage& reader, FileInfo& fileInfo);
     bool slowBoundary(Stage& hexer, FileInfo& fileInfo);
 
-    bool isFileIndexed( const FieldIndexes& indexes, const FileInfo& fileInfo);
+    long long findFile(const FieldIndexes& indexes,
+        const std::string& filename, bool& current);
 
     std::string m_idxFilename;
     std::string m_filespec;
@@ -111,6 +111,8 @@ private:
     bool m_fastBoundary;
     bool m_usestdin;
     bool m_overrideASrs;
+    int m_threads;
+    point_count_t m_exactCount;
 };
 
 } // namespace pdal
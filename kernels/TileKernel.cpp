@@ -38,10 +38,47 @@
 #include <pdal/StageWrapper.hpp>
 #include <pdal/Writer.hpp>
 #include <pdal/util/FileUtils.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 namespace pdal
 {
 
+// Points of a tile waiting to be written.  Shares the layout of the
+// kernel's table.
+class TileBuffer : public StreamPointTable
+{
+public:
+    TileBuffer(PointLayout& layout, point_count_t capacity) :
+        StreamPointTable(layout, capacity), m_count(0)
+    {
+        m_buf.resize(pointsToBytes(capacity + 1));
+    }
+
+    // Number of points in the buffer.
+    point_count_t m_count;
+
+protected:
+    virtual void reset()
+        { m_count = 0; }
+
+    virtual char *getPoint(PointId idx)
+        { return m_buf.data() + pointsToBytes(idx); }
+
+private:
+    std::vector<char> m_buf;
+};
+
+namespace
+{
+
+// A tile's points are written once this many have been buffered, as long
+// as other tiles are ready to be written at the same time.
+const point_count_t FlushCount = 8192;
+// A tile's points are always written once this many have been buffered.
+const point_count_t TileCapacity = 4 * FlushCount;
+
+} // unnamed namespace
+
 static StaticPluginInfo const s_info
 {
     "kernels.tile",
@@ -51,7 +88,12 @@ static StaticPluginInfo const s_info
 
 CREATE_STATIC_KERNEL(TileKernel, s_info)
 
-TileKernel::TileKernel() : m_table(10000), m_repro(nullptr)
+TileKernel::TileKernel() : m_maxWriters(100), m_threads(1), m_table(10000),
+    m_repro(nullptr)
+{}
+
+
+TileKernel::~TileKernel()
 {}
 
 
@@ -73,6 +115,10 @@ void TileKernel::addSwitches(ProgramArgs& args)
         std::numeric_limits<double>::quiet_NaN());
     args.add("buffer", "Size of buffer (overlap) to include around each tile",
         m_buffer);
+    args.add("max_writers", "Maximum number of tile files open at once",
+        m_maxWriters, (size_t)100);
+    args.add("threads", "Number of threads used to write tiles",
+        m_threads, 1);
     args.add("out_srs", "Output SRS to which points will be reprojected",
         m_outSrs);
 }
@@ -84,6 +130,10 @@ void TileKernel::validateSwitches(ProgramArgs& args)
     if (m_hashPos == std::string::npos)
         throw pdal_error("Output filename must contain a single '#' "
             "template placeholder.");
+    if (m_maxWriters == 0)
+        throw pdal_error("Option 'max_writers' must be greater than 0.");
+    if (m_threads < 1)
+        throw pdal_error("Option 'threads' must be positive.");
 }
 
 
@@ -107,10 +157,21 @@ int TileKernel::execute()
     m_splitter.prepare(m_table);
 
     m_table.finalize();
+    if (m_threads > 1)
+        m_pool.reset(new ThreadPool(m_threads, m_threads, false));
     process(readers);
     StageWrapper::done(m_splitter, m_table);
-    for (auto&& wp : m_writers)
-        StageWrapper::done(*wp.second, m_table);
+
+    // Write what's left of every tile.
+    std::vector<Coord> tiles;
+    for (auto& bp : m_buffers)
+        if (bp.second->m_count)
+            tiles.push_back(bp.first);
+    flush(tiles);
+    m_buffers.clear();
+    while (m_writers.size())
+        closeWriter(m_writers.begin());
+    m_pool.reset();
     return 0;
 }
 
@@ -276,37 +337,127 @@ void TileKernel::process(const Readers& readers)
 }
 
 
+// Copy a point to the buffer of its tile.  Tiles are written once enough
+// of them are full to keep the writing threads busy.
 void TileKernel::adder(PointRef& point, int xpos, int ypos)
 {
     Coord loc(xpos, ypos);
 
-    Stage *w;
-    Streamable *sw;
+    std::unique_ptr<TileBuffer>& buf = m_buffers[loc];
+    if (!buf)
+        buf.reset(new TileBuffer(*m_table.layout(), TileCapacity));
+    else if (buf->m_count == TileCapacity)
+        flush(m_full);
+
+    const DimTypeList& dimTypes = m_table.layout()->dimTypes();
+    m_packed.resize(m_table.layout()->pointSize());
+    point.getPackedData(dimTypes, m_packed.data());
+    PointRef dest(*buf, buf->m_count++);
+    dest.setPackedData(dimTypes, m_packed.data());
+
+    if (buf->m_count == FlushCount)
+    {
+        m_full.push_back(loc);
+        if (m_full.size() >= (size_t)m_threads)
+            flush(m_full);
+    }
+}
 
+
+// Write the buffered points of some tiles, one tile per thread.  No more
+// than max_writers tiles are written at once so that their writers can all
+// be open.
+void TileKernel::flush(std::vector<Coord> tiles)
+{
+    m_full.clear();
+    for (size_t start = 0; start < tiles.size(); start += m_maxWriters)
+    {
+        size_t end = (std::min)(start + m_maxWriters, tiles.size());
+
+        // Open the writers here, since the pipeline manager isn't
+        // thread-safe.
+        std::vector<std::pair<Streamable *, TileBuffer *>> work;
+        for (size_t i = start; i < end; ++i)
+        {
+            TileBuffer *buf = m_buffers[tiles[i]].get();
+            if (buf->m_count)
+                work.push_back(std::make_pair(writer(tiles[i]), buf));
+        }
+
+        for (auto& w : work)
+        {
+            Streamable *sw = w.first;
+            TileBuffer *buf = w.second;
+            auto write = [sw, buf]()
+            {
+                PointRef point(*buf, 0);
+                for (PointId idx = 0; idx < buf->m_count; ++idx)
+                {
+                    point.setPointId(idx);
+                    StreamableWrapper::processOne(*sw, point);
+                }
+                buf->m_count = 0;
+            };
+            if (m_pool)
+                m_pool->add(write);
+            else
+                write();
+        }
+        if (m_pool)
+        {
+            m_pool->await();
+            const std::vector<std::string>& errors = m_pool->errors();
+            if (errors.size())
+                throw pdal_error(errors.front());
+        }
+    }
+}
+
+
+// Get the writer of a tile, opening it if necessary.  When max_writers are
+// already open the least recently used is closed, and a tile whose writer
+// was closed gets a new file with a part number.
+Streamable *TileKernel::writer(const Coord& loc)
+{
     auto wi = m_writers.find(loc);
-    if (wi == m_writers.end())
+    if (wi != m_writers.end())
     {
-        std::string filename(m_outputFile);
-        std::string xname(std::to_string(xpos));
-        std::string yname(std::to_string(ypos));
-        filename.replace(m_hashPos, 1, (xname + "_" + yname));
-
-        w = &m_manager.makeWriter(filename, "");
-        if (!w)
-            throw pdal_error("Couldn't create writer for output file '" +
-                m_outputFile + "'.");
-        sw = dynamic_cast<Streamable *>(w);
-        if (!sw)
-            throw pdal_error("Driver '" + w->getName() + "' for input file '" +
-                m_outputFile + "' is not streamable.");  
-        m_writers[loc] = sw;
-
-        sw->prepare(m_table);
-        StreamableWrapper::ready(*sw, m_table);
+        m_lru.splice(m_lru.begin(), m_lru, wi->second.m_lruPos);
+        return wi->second.m_writer;
     }
-    else
-        sw = wi->second;
-    StreamableWrapper::processOne(*sw, point);
+    if (m_writers.size() == m_maxWriters)
+        closeWriter(m_writers.find(m_lru.back()));
+
+    int part = m_parts[loc]++;
+    std::string name = std::to_string(loc.first) + "_" +
+        std::to_string(loc.second);
+    if (part)
+        name += "_" + std::to_string(part + 1);
+    std::string filename(m_outputFile);
+    filename.replace(m_hashPos, 1, name);
+
+    Stage *w = &m_manager.makeWriter(filename, "");
+    if (!w)
+        throw pdal_error("Couldn't create writer for output file '" +
+            filename + "'.");
+    Streamable *sw = dynamic_cast<Streamable *>(w);
+    if (!sw)
+        throw pdal_error("Driver '" + w->getName() + "' for output file '" +
+            filename + "' is not streamable.");
+
+    sw->prepare(m_table);
+    StreamableWrapper::ready(*sw, m_table);
+    m_lru.push_front(loc);
+    m_writers.insert(std::make_pair(loc, TileWriter { sw, m_lru.begin() }));
+    return sw;
+}
+
+
+void TileKernel::closeWriter(WriterMap::iterator wi)
+{
+    StageWrapper::done(*wi->second.m_writer, m_table);
+    m_lru.erase(wi->second.m_lruPos);
+    m_writers.erase(wi);
 }
 
 } // namespace pdal
@@ -34,7 +34,10 @@
 
 #pragma once
 
+#include <list>
 #include <map>
+#include <memory>
+#include <vector>
 
 #include <pdal/Kernel.hpp>
 #include <filters/SplitterFilter.hpp>
@@ -42,13 +45,24 @@
 namespace pdal
 {
 
+class ThreadPool;
+class TileBuffer;
+
 class PDAL_DLL TileKernel : public Kernel
 {
     using Coord = std::pair<int, int>;
     using Readers = std::map<std::string, Streamable *>;
 
+    struct TileWriter
+    {
+        Streamable *m_writer;
+        std::list<Coord>::iterator m_lruPos;
+    };
+    using WriterMap = std::map<Coord, TileWriter>;
+
 public:
     TileKernel();
+    ~TileKernel();
     std::string getName() const;
     int execute();
 
@@ -59,6 +73,9 @@ private:
     void process(const Readers& readers);
     void checkReaders(const Readers& readers);
     void adder(PointRef& point, int xpos, int ypos);
+    void flush(std::vector<Coord> tiles);
+    Streamable *writer(const Coord& loc);
+    void closeWriter(WriterMap::iterator wi);
 
     std::string m_inputFile;
     std::string m_outputFile;
@@ -66,7 +83,15 @@ private:
     double m_xOrigin;
     double m_yOrigin;
     double m_buffer;
-    std::map<Coord, Streamable *> m_writers;
+    size_t m_maxWriters;
+    int m_threads;
+    WriterMap m_writers;
+    std::list<Coord> m_lru;
+    std::map<Coord, int> m_parts;
+    std::map<Coord, std::unique_ptr<TileBuffer>> m_buffers;
+    std::vector<Coord> m_full;
+    std::vector<char> m_packed;
+    std::unique_ptr<ThreadPool> m_pool;
     FixedPointTable m_table;
     SplitterFilter m_splitter;
     Streamable *m_repro;
@@ -43,9 +43,12 @@
 #include <pdal/PipelineReaderJSON.hpp>
 #include <pdal/Writer.hpp>
 #include <pdal/util/FileUtils.hpp>
+#include <pdal/util/ThreadPool.hpp>
 #include <json/json.h>
 
+#include <algorithm>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -70,7 +73,7 @@ std::string TranslateKernel::getName() const
     return s_info.name;
 }
 
-TranslateKernel::TranslateKernel()
+TranslateKernel::TranslateKernel() : m_threads(1), m_jobs(1)
 {}
 
 void TranslateKernel::addSwitches(ProgramArgs& args)
@@ -90,13 +93,21 @@ void TranslateKernel::addSwitches(ProgramArgs& args)
     args.add("writer,w", "Writer type", m_writerType);
     args.add("nostream", "Don't run in stream mode, even if technically "
         "possible.", m_noStream);
+    args.add("stream-batch", "Number of points in a batch in stream "
+        "mode, or 'auto' to tune it as the pipeline runs", m_streamBatch,
+        "10000");
+    args.add("threads", "Maximum number of threads used to run the "
+        "pipeline", m_threads, 1);
+    args.add("jobs,j", "Number of input files to translate at once when "
+        "the input is a wildcard", m_jobs, 1);
 }
 
 
 /*
   Build a pipeline from a JSON filter specification.
 */
-void TranslateKernel::makeJSONPipeline()
+void TranslateKernel::makeJSONPipeline(PipelineManager& manager,
+    const std::string& inputFile, const std::string& outputFile)
 {
     std::string json;
 
@@ -106,9 +117,9 @@ void TranslateKernel::makeJSONPipeline()
     if (json.empty())
         json = m_filterJSON;
     std::stringstream in(json);
-    m_manager.readPipeline(in);
+    manager.readPipeline(in);
 
-    std::vector<Stage *> roots = m_manager.roots();
+    std::vector<Stage *> roots = manager.roots();
     if (roots.size() > 1)
         throw pdal_error("Can't process pipeline with more than one root.");
 
@@ -117,31 +128,31 @@ void TranslateKernel::makeJSONPipeline()
         r = dynamic_cast<Reader *>(roots[0]);
     if (r)
     {
-        StageCreationOptions ops { m_inputFile, m_readerType, nullptr,
+        StageCreationOptions ops { inputFile, m_readerType, nullptr,
             Options(), r->tag() };
-        m_manager.replace(r, &m_manager.makeReader(ops));
+        manager.replace(r, &manager.makeReader(ops));
     }
     else
     {
-        r = &m_manager.makeReader(m_inputFile, m_readerType);
+        r = &manager.makeReader(inputFile, m_readerType);
         if (roots.size())
             roots[0]->setInput(*r);
     }
 
-    std::vector<Stage *> leaves = m_manager.leaves();
+    std::vector<Stage *> leaves = manager.leaves();
     if (leaves.size() != 1)
         throw pdal_error("Can't process pipeline with more than one "
             "terminal stage.");
 
     Stage *w = dynamic_cast<Writer *>(leaves[0]);
     if (w)
-        m_manager.replace(w, &m_manager.makeWriter(m_outputFile, m_writerType));
+        manager.replace(w, &manager.makeWriter(outputFile, m_writerType));
     else
     {
         // We know we have a leaf because we added a reader.
-        StageCreationOptions ops { m_outputFile, m_writerType, leaves[0],
+        StageCreationOptions ops { outputFile, m_writerType, leaves[0],
             Options(), "" };  // These last two args just keep compiler quiet.
-        m_manager.makeWriter(ops);
+        manager.makeWriter(ops);
     }
 }
 
@@ -149,12 +160,13 @@ void TranslateKernel::makeJSONPipeline()
 /*
   Build a pipeline from filters specified as command-line arguments.
 */
-void TranslateKernel::makeArgPipeline()
+void TranslateKernel::makeArgPipeline(PipelineManager& manager,
+    const std::string& inputFile, const std::string& outputFile)
 {
     std::string readerType(m_readerType);
     if (!readerType.empty() && !Utils::startsWith(readerType, "readers."))
         readerType.insert(0, "readers.");
-    Stage& reader = m_manager.makeReader(m_inputFile, readerType);
+    Stage& reader = manager.makeReader(inputFile, readerType);
     Stage* stage = &reader;
 
     // add each filter provided on the command-line,
@@ -166,13 +178,118 @@ void TranslateKernel::makeArgPipeline()
         if (!Utils::startsWith(f, "filters."))
             filter_name.insert(0, "filters.");
 
-        Stage& filter = m_manager.makeFilter(filter_name, *stage);
+        Stage& filter = manager.makeFilter(filter_name, *stage);
         stage = &filter;
     }
     std::string writerType(m_writerType);
     if (!writerType.empty() && !Utils::startsWith(writerType, "writers."))
         writerType.insert(0, "writers.");
-    m_manager.makeWriter(m_outputFile, writerType, *stage);
+    manager.makeWriter(outputFile, writerType, *stage);
+}
+
+
+void TranslateKernel::run(PipelineManager& manager)
+{
+    if (m_noStream || !manager.pipelineStreamable())
+    {
+        manager.execute(m_threads);
+    }
+    else
+    {
+        std::unique_ptr<StreamPointTable> t = makeStreamTable(m_streamBatch);
+        manager.executeStream(*t, m_threads);
+    }
+}
+
+
+/*
+  Translate each of several input files with its own pipeline, running
+  up to m_jobs pipelines at once.  The '#' in the output filename is
+  replaced with the stem of each input filename.
+*/
+int TranslateKernel::executeMany(const StringList& inputs,
+    std::ostream *metaOut)
+{
+    std::string outputTemplate(m_outputFile);
+    std::string::size_type hashPos =
+        Writer::handleFilenameTemplate(outputTemplate);
+    if (hashPos == std::string::npos)
+        throw pdal_error("Output filename must contain a single '#' "
+            "template placeholder when translating multiple inputs.");
+    if (m_pipelineOutputFile.size())
+        throw pdal_error("Can't write a pipeline when translating multiple "
+            "inputs.");
+
+    const bool keepMetadata = (metaOut != nullptr);
+    std::vector<MetadataNode> metadata(inputs.size());
+    std::mutex mutex;
+    size_t done = 0;
+
+    ThreadPool pool((size_t)m_jobs, (size_t)m_jobs, false);
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        pool.add([this, i, &inputs, &outputTemplate, hashPos, keepMetadata,
+            &metadata, &mutex, &done]()
+        {
+            const std::string& input = inputs[i];
+            std::string output(outputTemplate);
+            output.replace(hashPos, 1, FileUtils::stem(input));
+
+            // Stage factories and plugins are shared by the process, so
+            // each pipeline only costs its own stages.
+            PipelineManager manager;
+            manager.setLog(m_log);
+            manager.commonOptions() = m_manager.commonOptions();
+            manager.stageOptions() = m_manager.stageOptions();
+            if (!m_filterJSON.empty())
+                makeJSONPipeline(manager, input, output);
+            else
+                makeArgPipeline(manager, input, output);
+            try
+            {
+                run(manager);
+            }
+            catch (const pdal_error& err)
+            {
+                throw pdal_error("Unable to translate '" + input + "': " +
+                    err.what());
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (keepMetadata)
+                metadata[i] = manager.getMetadata();
+            done++;
+            m_log->get(LogLevel::Info) << "Translated '" << input <<
+                "' to '" << output << "' (" << done << " of " <<
+                inputs.size() << ")." << std::endl;
+        });
+    }
+    pool.await();
+    pool.join();
+
+    const std::vector<std::string>& errors = pool.errors();
+    if (errors.size())
+    {
+        std::string msg;
+        for (const std::string& err : errors)
+            msg += err + "\n";
+        throw pdal_error(msg);
+    }
+
+    if (metaOut)
+    {
+        MetadataNode root;
+        for (size_t i = 0; i < inputs.size(); ++i)
+        {
+            MetadataNode m = root.addList("translations");
+            m.add("input", inputs[i]);
+            m.add(metadata[i].clone("metadata"));
+        }
+        Utils::toJSON(root, *metaOut);
+        FileUtils::closeFile(metaOut);
+    }
+
+    return 0;
 }
 
 
@@ -183,6 +300,23 @@ int TranslateKernel::execute()
     if (m_filterJSON.size() && m_filterType.size())
         throw pdal_error("Cannot set both --filter options and --json options");
 
+    if (m_threads < 1)
+        throw pdal_error("Number of threads must be positive.");
+    if (m_jobs < 1)
+        throw pdal_error("Number of jobs must be positive.");
+
+    // A wildcard input is expanded to a list of input files, each of
+    // which is translated separately.
+    StringList inputs;
+    if (m_inputFile.find_first_of("*?[") != std::string::npos)
+    {
+        inputs = FileUtils::glob(m_inputFile);
+        if (inputs.empty())
+            throw pdal_error("No input files found for path '" +
+                m_inputFile + "'.");
+        std::sort(inputs.begin(), inputs.end());
+    }
+
     if (m_metadataFile.size())
     {
         if (m_pipelineOutputFile.size())
@@ -197,10 +331,13 @@ int TranslateKernel::execute()
         }
     }
 
+    if (inputs.size())
+        return executeMany(inputs, metaOut);
+
     if (!m_filterJSON.empty())
-        makeJSONPipeline();
+        makeJSONPipeline(m_manager, m_inputFile, m_outputFile);
     else
-        makeArgPipeline();
+        makeArgPipeline(m_manager, m_inputFile, m_outputFile);
 
     // If we write pipeline output, we don't run, and therefore don't write
     if (m_pipelineOutputFile.size() > 0)
@@ -210,20 +347,12 @@ int TranslateKernel::execute()
         return 0;
     }
 
-    if (m_noStream || !m_manager.pipelineStreamable())
-    {
-        m_manager.execute();
-    }
-    else
-    {
-        FixedPointTable t(10000);
-        m_manager.executeStream(t);
-    }
+    run(m_manager);
 
     if (metaOut)
     {
         MetadataNode m = m_manager.getMetadata();
-        *metaOut << Utils::toJSON(m);
+        Utils::toJSON(m, *metaOut);
         FileUtils::closeFile(metaOut);
     }
 
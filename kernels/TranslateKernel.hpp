@@ -54,8 +54,12 @@ public:
 
 private:
     virtual void addSwitches(ProgramArgs& args);
-    void makeJSONPipeline();
-    void makeArgPipeline();
+    void makeJSONPipeline(PipelineManager& manager,
+        const std::string& inputFile, const std::string& outputFile);
+    void makeArgPipeline(PipelineManager& manager,
+        const std::string& inputFile, const std::string& outputFile);
+    void run(PipelineManager& manager);
+    int executeMany(const StringList& inputs, std::ostream *metaOut);
 
     std::string m_inputFile;
     std::string m_outputFile;
@@ -66,6 +70,9 @@ private:
     std::string m_filterJSON;
     std::string m_metadataFile;
     bool m_noStream;
+    std::string m_streamBatch;
+    int m_threads;
+    int m_jobs;
 };
 
 } // namespace pdal
@@ -0,0 +1,325 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "ExternalSort.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+#include <pdal/PointTable.hpp>
+#include <pdal/Reader.hpp>
+#include <pdal/Streamable.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/Utils.hpp>
+#include <filters/StreamCallbackFilter.hpp>
+
+namespace pdal
+{
+namespace sort
+{
+
+// Streams the points of the runs of an ExternalSort in sorted order by
+// repeatedly taking the smallest of the first unread point of each run.
+class RunReader : public Reader, public Streamable
+{
+public:
+    RunReader(const ExternalSort& sort) : m_sort(sort)
+    {}
+    ~RunReader()
+        { close(); }
+
+    std::string getName() const
+        { return "readers.sortruns"; }
+
+private:
+    const ExternalSort& m_sort;
+    DimTypeList m_dims;
+    std::vector<std::istream *> m_streams;
+    std::vector<char> m_records;
+    std::vector<std::size_t> m_heap;
+
+    virtual void addDimensions(PointLayoutPtr layout)
+    {
+        m_dims.clear();
+        for (std::size_t i = 0; i < m_sort.m_names.size(); ++i)
+        {
+            Dimension::Type type = m_sort.m_dimTypes[i].m_type;
+            Dimension::Id id =
+                layout->registerOrAssignDim(m_sort.m_names[i], type);
+            m_dims.push_back(DimType(id, type));
+        }
+    }
+
+    virtual void ready(PointTableRef)
+    {
+        setSpatialReference(m_sort.m_srs);
+
+        close();
+        const std::size_t numRuns = m_sort.m_runs.size();
+        m_records.resize(numRuns * m_sort.m_recordSize);
+        for (std::size_t run = 0; run < numRuns; ++run)
+        {
+            std::istream *in = FileUtils::openFile(m_sort.m_runs[run], true);
+            if (!in)
+                throwError("Unable to open sort run '" +
+                    m_sort.m_runs[run] + "'.");
+            m_streams.push_back(in);
+            if (readRecord(run))
+                m_heap.push_back(run);
+        }
+        std::make_heap(m_heap.begin(), m_heap.end(), greater(this));
+    }
+
+    virtual bool processOne(PointRef& point)
+    {
+        if (m_heap.empty())
+            return false;
+
+        std::pop_heap(m_heap.begin(), m_heap.end(), greater(this));
+        std::size_t run = m_heap.back();
+        point.setPackedData(m_dims, record(run) + keysSize());
+        if (readRecord(run))
+            std::push_heap(m_heap.begin(), m_heap.end(), greater(this));
+        else
+            m_heap.pop_back();
+        return true;
+    }
+
+    virtual point_count_t read(PointViewPtr view, point_count_t count)
+    {
+        PointId idx = view->size();
+        point_count_t numRead = 0;
+        PointRef point(*view, idx);
+        while (numRead < count)
+        {
+            point.setPointId(idx++);
+            if (!processOne(point))
+                break;
+            numRead++;
+        }
+        return numRead;
+    }
+
+    virtual void done(PointTableRef)
+        { close(); }
+
+    void close()
+    {
+        for (std::istream *in : m_streams)
+            FileUtils::closeFile(in);
+        m_streams.clear();
+        m_heap.clear();
+    }
+
+    std::size_t keysSize() const
+        { return m_sort.m_keys.size() * sizeof(uint64_t); }
+
+    char *record(std::size_t run)
+        { return m_records.data() + run * m_sort.m_recordSize; }
+
+    uint64_t key(std::size_t run, std::size_t k)
+    {
+        uint64_t val;
+        memcpy(&val, record(run) + k * sizeof(uint64_t), sizeof(val));
+        return val;
+    }
+
+    bool readRecord(std::size_t run)
+    {
+        std::istream& in = *m_streams[run];
+        in.read(record(run), m_sort.m_recordSize);
+        if (in.gcount() == 0 && in.eof())
+            return false;
+        if ((std::size_t)in.gcount() != m_sort.m_recordSize)
+            throwError("Error reading sort run '" + m_sort.m_runs[run] +
+                "'.");
+        return true;
+    }
+
+    // Heap ordering.  Ties go to the earlier run, which holds points
+    // that were read first, so the sort is stable.
+    struct greater
+    {
+        RunReader *m_reader;
+
+        greater(RunReader *reader) : m_reader(reader)
+        {}
+
+        bool operator()(std::size_t a, std::size_t b) const
+        {
+            for (std::size_t k = 0; k < m_reader->m_sort.m_keys.size(); ++k)
+            {
+                uint64_t ka = m_reader->key(a, k);
+                uint64_t kb = m_reader->key(b, k);
+                if (ka != kb)
+                    return ka > kb;
+            }
+            return a > b;
+        }
+    };
+};
+
+ExternalSort::ExternalSort(const StringList& dims, bool descending,
+        uint64_t memoryBudget, const std::string& tempDir) :
+    m_dimNames(dims), m_descending(descending),
+    m_memoryBudget(memoryBudget), m_tempDir(tempDir), m_recordSize(0),
+    m_maxPoints(0), m_count(0)
+{
+    for (std::string& name : m_dimNames)
+        Utils::trim(name);
+}
+
+
+ExternalSort::~ExternalSort()
+{
+    m_reader.reset();
+    for (const std::string& run : m_runs)
+        FileUtils::deleteFile(run);
+}
+
+
+point_count_t ExternalSort::makeRuns(Stage& input)
+{
+    StreamCallbackFilter f;
+    f.setInput(input);
+    f.setCallback([this](PointRef& point)
+    {
+        addPoint(point);
+        return true;
+    });
+
+    FixedPointTable table(10000);
+    f.prepare(table);
+
+    PointLayoutPtr layout = table.layout();
+    m_dimTypes = layout->dimTypes();
+    m_names.clear();
+    std::size_t pointSize = 0;
+    for (const DimType& dt : m_dimTypes)
+    {
+        m_names.push_back(layout->dimName(dt.m_id));
+        pointSize += Dimension::size(dt.m_type);
+    }
+
+    m_keys.clear();
+    for (const std::string& name : m_dimNames)
+    {
+        Dimension::Id id = layout->findDim(name);
+        if (id == Dimension::Id::Unknown)
+            throw pdal_error("Dimension '" + name + "' not found.");
+        m_keys.emplace_back(id, layout->dimType(id), m_descending);
+    }
+    if (m_keys.empty())
+        throw pdal_error("No dimension on which to sort.");
+
+    // Besides the records, sorting a run takes a key and a point ID per
+    // point, and the same again for the radix sort to scatter into.
+    m_recordSize = m_keys.size() * sizeof(uint64_t) + pointSize;
+    const std::size_t sortSize = 2 * (sizeof(uint64_t) + sizeof(PointId));
+    m_maxPoints = (std::max)((std::size_t)1,
+        (std::size_t)(m_memoryBudget / (m_recordSize + sortSize)));
+
+    f.execute(table);
+    if (m_buf.size())
+        writeRun();
+    std::vector<char>().swap(m_buf);
+    m_srs = table.anySpatialReference();
+    return m_count;
+}
+
+
+void ExternalSort::addPoint(PointRef& point)
+{
+    if (m_buf.empty())
+        m_buf.reserve(m_maxPoints * m_recordSize);
+
+    std::size_t pos = m_buf.size();
+    m_buf.resize(pos + m_recordSize);
+    char *rec = m_buf.data() + pos;
+    for (const SortKey& key : m_keys)
+    {
+        uint64_t val = key(point);
+        memcpy(rec, &val, sizeof(val));
+        rec += sizeof(val);
+    }
+    point.getPackedData(m_dimTypes, rec);
+    m_count++;
+
+    if (m_buf.size() / m_recordSize >= m_maxPoints)
+        writeRun();
+}
+
+
+// Sort by the least significant key first, as filters.sort does.
+void ExternalSort::writeRun()
+{
+    const std::size_t n = m_buf.size() / m_recordSize;
+    std::vector<PointId> ids(n);
+    std::iota(ids.begin(), ids.end(), 0);
+    std::vector<uint64_t> keys(n);
+    for (std::size_t k = m_keys.size(); k-- > 0;)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+            memcpy(&keys[i], m_buf.data() + ids[i] * m_recordSize +
+                k * sizeof(uint64_t), sizeof(uint64_t));
+        radixSort(keys, ids, m_keys[k].bytes());
+    }
+
+    std::string filename =
+        FileUtils::uniqueFilename(m_tempDir, "pdal_sort_run_");
+    std::ostream *out = FileUtils::createFile(filename, true);
+    if (!out)
+        throw pdal_error("Unable to create sort run '" + filename + "'.");
+    m_runs.push_back(filename);
+    for (PointId id : ids)
+        out->write(m_buf.data() + id * m_recordSize, m_recordSize);
+    out->flush();
+    bool ok = out->good();
+    FileUtils::closeFile(out);
+    if (!ok)
+        throw pdal_error("Error writing sort run '" + filename + "'.");
+    m_buf.clear();
+}
+
+
+Stage& ExternalSort::merged()
+{
+    if (!m_reader)
+        m_reader.reset(new RunReader(*this));
+    return *m_reader;
+}
+
+} // namespace sort
+} // namespace pdal
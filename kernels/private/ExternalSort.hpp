@@ -0,0 +1,120 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <pdal/DimType.hpp>
+#include <pdal/SpatialReference.hpp>
+#include <pdal/pdal_types.hpp>
+#include <pdal/private/RadixSort.hpp>
+
+namespace pdal
+{
+
+class Stage;
+
+namespace sort
+{
+
+class RunReader;
+
+/**
+  Sort points that don't fit in memory.  Points are streamed from a
+  stage into runs of sorted points in temporary files.  A reader stage
+  then merges the runs and streams the points in sorted order.
+
+  Each point of a run is stored as its sort keys followed by the values
+  of all its dimensions.
+*/
+class PDAL_DLL ExternalSort
+{
+    friend class RunReader;
+public:
+    /**
+      \param dims  Names of the dimensions on which to sort, most
+        significant first.
+      \param descending  Whether to sort from largest to smallest.
+      \param memoryBudget  Bytes of memory to use for sorting each run.
+      \param tempDir  Directory for the run files.  If empty, the system
+        temporary directory is used.
+    */
+    ExternalSort(const StringList& dims, bool descending,
+        uint64_t memoryBudget, const std::string& tempDir);
+    ~ExternalSort();
+
+    /**
+      Execute a stage in stream mode and write its points to sorted runs.
+
+      \param input  Last stage of the pipeline providing the points.
+      \return  Number of points read.
+    */
+    point_count_t makeRuns(Stage& input);
+
+    /// Number of runs written.
+    std::size_t numRuns() const
+        { return m_runs.size(); }
+
+    /**
+      Reader stage that returns the points of the runs in sorted order.
+      Only valid after \ref makeRuns() has been called.
+    */
+    Stage& merged();
+
+private:
+    StringList m_dimNames;
+    bool m_descending;
+    uint64_t m_memoryBudget;
+    std::string m_tempDir;
+
+    DimTypeList m_dimTypes;
+    StringList m_names;
+    std::vector<SortKey> m_keys;
+    std::size_t m_recordSize;
+    std::size_t m_maxPoints;
+    std::vector<char> m_buf;
+    point_count_t m_count;
+    std::vector<std::string> m_runs;
+    SpatialReference m_srs;
+    std::unique_ptr<RunReader> m_reader;
+
+    void addPoint(PointRef& point);
+    void writeRun();
+};
+
+} // namespace sort
+} // namespace pdal
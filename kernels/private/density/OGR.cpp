@@ -228,36 +228,59 @@ void OGR::writeBoundary(hexer::HexGrid *grid)
     }
 }
 
-void OGR::writeDensity(hexer::HexGrid *grid)
+// Features are written in transactions of 'batchSize' hexagons (all of them
+// if 0).  Drivers without transactions, such as shapefiles, accept the
+// calls and write as they go.
+void OGR::writeDensity(hexer::HexGrid *grid, size_t batchSize)
 {
+    OGRFeatureDefnH defn = OGR_L_GetLayerDefn(m_layer);
+    int idField = OGR_FD_GetFieldIndex(defn, "ID");
+    int countField = OGR_FD_GetFieldIndex(defn, "COUNT");
+
+    auto transact = [this](OGRErr (*op)(OGRLayerH), const char *what)
+    {
+        if (op(m_layer) != OGRERR_NONE)
+        {
+            std::ostringstream oss;
+            oss << "Unable to " << what << " transaction with error '" <<
+                CPLGetLastErrorMsg() << "'";
+            throw pdal::pdal_error(oss.str());
+        }
+    };
+
     int counter(0);
+    size_t batch(0);
+    transact(OGR_L_StartTransaction, "start");
+    OGRFeatureH hFeature = OGR_F_Create(defn);
     for (hexer::HexIter iter = grid->hexBegin(); iter != grid->hexEnd(); ++iter)
     {
-
         hexer::HexInfo hi = *iter;
         OGRGeometryH polygon = collectHexagon(hi, grid);
-        OGRFeatureH hFeature;
-
-        hFeature = OGR_F_Create(OGR_L_GetLayerDefn(m_layer));
-        OGR_F_SetFieldInteger( hFeature, OGR_F_GetFieldIndex(hFeature, "ID"),
-            counter);
-        OGR_F_SetFieldInteger( hFeature, OGR_F_GetFieldIndex(hFeature, "COUNT"),
-            hi.m_density);
 
-        OGR_F_SetGeometry(hFeature, polygon);
-        OGR_G_DestroyGeometry(polygon);
+        OGR_F_SetFID(hFeature, OGRNullFID);
+        OGR_F_SetFieldInteger(hFeature, idField, counter);
+        OGR_F_SetFieldInteger(hFeature, countField, hi.m_density);
+        OGR_F_SetGeometryDirectly(hFeature, polygon);
 
         if( OGR_L_CreateFeature( m_layer, hFeature ) != OGRERR_NONE )
         {
+            OGR_F_Destroy( hFeature );
+            OGR_L_RollbackTransaction(m_layer);
             std::ostringstream oss;
             oss << "Unable to create feature for multipolygon with error '"
                 << CPLGetLastErrorMsg() << "'";
             throw pdal::pdal_error(oss.str());
         }
-        OGR_F_Destroy( hFeature );
         counter++;
+        if (batchSize && ++batch == batchSize)
+        {
+            transact(OGR_L_CommitTransaction, "commit");
+            transact(OGR_L_StartTransaction, "start");
+            batch = 0;
+        }
     }
+    OGR_F_Destroy( hFeature );
+    transact(OGR_L_CommitTransaction, "commit");
 }
 
 } // namespace pdal
-
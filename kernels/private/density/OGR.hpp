@@ -55,7 +55,7 @@ public:
     ~OGR();
 
     void writeBoundary(hexer::HexGrid *grid);
-    void writeDensity(hexer::HexGrid *grid);
+    void writeDensity(hexer::HexGrid *grid, size_t batchSize = 0);
 
 private:
     std::string m_filename;
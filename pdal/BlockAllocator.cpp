@@ -0,0 +1,170 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (hobu.inc@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/BlockAllocator.hpp>
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace pdal
+{
+
+namespace
+{
+
+#ifdef __linux__
+// Transparent huge pages are 2MB on the platforms that have them.
+const std::size_t HugePageSize = 2 * 1024 * 1024;
+#endif
+
+} // unnamed namespace
+
+
+BlockPool::BlockPool(uint64_t maxIdleBytes, bool hugePages) :
+    m_idleBytes(0), m_maxIdleBytes(maxIdleBytes), m_hugePages(hugePages)
+{}
+
+
+BlockPool::~BlockPool()
+{
+    for (auto& idle : m_idle)
+        for (char *block : idle.second)
+            freeBlock(block);
+}
+
+
+int BlockPool::currentNode()
+{
+#if defined(__linux__) && defined(SYS_getcpu)
+    unsigned cpu;
+    unsigned node;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0)
+        return (int)node;
+#endif
+    return 0;
+}
+
+
+char *BlockPool::allocate(std::size_t size)
+{
+    int node = currentNode();
+    char *block = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_idle.find(std::make_pair(node, size));
+        if (it != m_idle.end() && it->second.size())
+        {
+            block = it->second.back();
+            it->second.pop_back();
+            m_idleBytes -= size;
+        }
+    }
+
+    // New blocks are zeroed outside the lock, on this thread, so that
+    // their pages are placed on this thread's node.
+    if (!block)
+        block = newBlock(size);
+    std::memset(block, 0, size);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_nodes[block] = node;
+    return block;
+}
+
+
+void BlockPool::release(char *block, std::size_t size)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_nodes.find(block);
+        int node = (it == m_nodes.end()) ? 0 : it->second;
+        if (it != m_nodes.end())
+            m_nodes.erase(it);
+        if (m_idleBytes + size <= m_maxIdleBytes)
+        {
+            m_idle[std::make_pair(node, size)].push_back(block);
+            m_idleBytes += size;
+            return;
+        }
+    }
+    freeBlock(block);
+}
+
+
+uint64_t BlockPool::idleBytes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_idleBytes;
+}
+
+
+char *BlockPool::newBlock(std::size_t size)
+{
+    void *block = nullptr;
+#ifdef __linux__
+    if (m_hugePages)
+    {
+        // Huge pages need aligned memory that spans whole huge pages.
+        std::size_t alloc = (size + HugePageSize - 1) / HugePageSize *
+            HugePageSize;
+        if (posix_memalign(&block, HugePageSize, alloc) == 0)
+        {
+#ifdef MADV_HUGEPAGE
+            madvise(block, alloc, MADV_HUGEPAGE);
+#endif
+            return static_cast<char *>(block);
+        }
+        block = nullptr;
+    }
+#endif
+    block = std::malloc(size);
+    if (!block)
+        throw std::bad_alloc();
+    return static_cast<char *>(block);
+}
+
+
+void BlockPool::freeBlock(char *block)
+{
+    std::free(block);
+}
+
+} // namespace pdal
@@ -0,0 +1,136 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (hobu.inc@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <pdal/pdal_internal.hpp>
+
+namespace pdal
+{
+
+/**
+  Source of the blocks of memory in which a PointTable stores points.
+*/
+class PDAL_DLL BlockAllocator
+{
+public:
+    virtual ~BlockAllocator()
+    {}
+
+    /**
+      Allocate a block.  The block is zeroed by the calling thread.
+
+      \param size  Size of the block in bytes.
+      \return  Pointer to the block.
+    */
+    virtual char *allocate(std::size_t size) = 0;
+
+    /**
+      Return a block obtained from allocate().
+
+      \param block  Pointer to the block.
+      \param size  Size of the block in bytes, as passed to allocate().
+    */
+    virtual void release(char *block, std::size_t size) = 0;
+};
+typedef std::shared_ptr<BlockAllocator> BlockAllocatorPtr;
+
+/**
+  A block allocator that keeps released blocks and hands them out again,
+  so that tables created and destroyed one after the other, like those of
+  a batch of pipelines, don't go back to the system allocator for each
+  block.  Blocks are kept separately for each NUMA node and are reused by
+  threads on the node where they were first allocated.  New blocks are
+  zeroed by the allocating thread, so the operating system places their
+  pages on that thread's node.  The pool can be shared by tables used on
+  different threads.
+*/
+class PDAL_DLL BlockPool : public BlockAllocator
+{
+public:
+    /**
+      Create a block pool.
+
+      \param maxIdleBytes  Maximum number of bytes of released blocks kept
+        for reuse.  Blocks released beyond this are freed.
+      \param hugePages  Whether to ask the operating system to back blocks
+        with transparent huge pages.  Ignored where it isn't supported.
+    */
+    BlockPool(uint64_t maxIdleBytes = 1024 * 1024 * 1024,
+        bool hugePages = false);
+    virtual ~BlockPool();
+
+    virtual char *allocate(std::size_t size);
+    virtual void release(char *block, std::size_t size);
+
+    /**
+      Get the number of bytes of released blocks held for reuse.
+
+      \return  Number of bytes.
+    */
+    uint64_t idleBytes() const;
+
+    /**
+      Get the NUMA node of the CPU running the calling thread.
+
+      \return  NUMA node, or 0 where it can't be determined.
+    */
+    static int currentNode();
+
+private:
+    char *newBlock(std::size_t size);
+    void freeBlock(char *block);
+
+    mutable std::mutex m_mutex;
+    // Released blocks, by NUMA node and size.
+    std::map<std::pair<int, std::size_t>, std::vector<char *>> m_idle;
+    // NUMA node on which each block handed out was allocated.
+    std::unordered_map<char *, int> m_nodes;
+    uint64_t m_idleBytes;
+    uint64_t m_maxIdleBytes;
+    bool m_hugePages;
+
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+};
+
+} // namespace pdal
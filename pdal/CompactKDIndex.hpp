@@ -0,0 +1,449 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (hobu.inc@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+
+#include <nanoflann/nanoflann.hpp>
+
+#include <pdal/PointView.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+namespace pdal
+{
+
+/**
+  A KD index that takes less memory than KDIndex and touches it in order.
+  When built, the coordinates are copied once, as floats relative to the
+  center of the points' bounds, and sorted into the order of the tree's
+  leaves.  The points of a leaf are then adjacent in memory, and indices
+  in the tree are 32 bits.  Distances are computed in single precision,
+  which resolves about a millimeter across ten kilometers.
+
+  Neighbors are returned as indices in the indexed view, as with KDIndex.
+*/
+template<int DIM>
+class PDAL_DLL CompactKDIndex
+{
+public:
+    /**
+      Function called with the neighbors of a query point, nearest first.
+
+      \param idx  Index of the query point.
+      \param ids  Indices of the neighbors in the indexed view.
+      \param sqrDists  Square distances from the query point to the
+        neighbors.
+    */
+    typedef std::function<void(PointId idx, const std::vector<PointId>& ids,
+        const std::vector<double>& sqrDists)> NeighborFunc;
+
+    CompactKDIndex(const PointView& buf) : m_buf(buf)
+    {
+        static const char *names[] = { "X", "Y", "Z" };
+
+        for (int d = 0; d < DIM; ++d)
+            if (!buf.hasDim(dim(d)))
+                throw pdal_error("CompactKDIndex: point view missing '" +
+                    std::string(names[d]) + "' dimension.");
+        if (buf.size() > (std::numeric_limits<uint32_t>::max)())
+            throw pdal_error("CompactKDIndex: point view has too many "
+                "points to index.");
+    }
+
+    // nanoflann dataset interface.
+    std::size_t kdtree_get_point_count() const
+        { return m_ids.size(); }
+    float kdtree_get_pt(const uint32_t idx, int d) const
+        { return m_coords[idx * DIM + d]; }
+    float kdtree_distance(const float *p1, const uint32_t idx,
+        size_t /*numDims*/) const
+    {
+        const float *p2 = &m_coords[idx * DIM];
+        float dist = 0;
+        for (int d = 0; d < DIM; ++d)
+        {
+            const float diff = p1[d] - p2[d];
+            dist += diff * diff;
+        }
+        return dist;
+    }
+    template <class BBOX> bool kdtree_get_bbox(BBOX& bb) const
+    {
+        for (int d = 0; d < DIM; ++d)
+        {
+            bb[d].low = m_low[d];
+            bb[d].high = m_high[d];
+        }
+        return true;
+    }
+
+    void build()
+    {
+        loadCoords();
+        m_index.reset(new Tree(*this));
+        if (m_ids.empty())
+            return;
+        m_index->buildIndex();
+
+        // Put the coordinates in tree order so that the leaf searches read
+        // them sequentially.  The tree then refers to points by position,
+        // which m_ids maps back to the view.
+        std::vector<uint32_t>& order = m_index->order();
+        std::vector<float> coords(m_coords.size());
+        for (size_t pos = 0; pos < order.size(); ++pos)
+        {
+            std::copy_n(&m_coords[order[pos] * DIM], DIM, &coords[pos * DIM]);
+            m_ids[pos] = order[pos];
+            order[pos] = (uint32_t)pos;
+        }
+        m_coords.swap(coords);
+    }
+
+    /**
+      Find the k nearest neighbors of a location.
+
+      \param pt  DIM coordinates of the location.
+      \param k  Number of neighbors to find.
+      \param ids  Indices of the neighbors in the indexed view.
+      \param sqrDists  Square distances to the neighbors.
+    */
+    void knnSearch(const double *pt, point_count_t k,
+        std::vector<PointId>& ids, std::vector<double>& sqrDists) const
+    {
+        float local[DIM];
+        toLocal(pt, local);
+        std::vector<uint32_t> positions;
+        std::vector<float> dists;
+        knn(local, k, positions, dists);
+        output(positions, dists, ids, sqrDists);
+    }
+
+    /**
+      Find the k nearest neighbors of a location.
+
+      \param pt  DIM coordinates of the location.
+      \param k  Number of neighbors to find.
+      \return  Indices of the neighbors in the indexed view, nearest first.
+    */
+    std::vector<PointId> neighbors(const double *pt, point_count_t k) const
+    {
+        std::vector<PointId> ids;
+        std::vector<double> sqrDists;
+        knnSearch(pt, k, ids, sqrDists);
+        return ids;
+    }
+
+    /**
+      Find the k nearest neighbors of a point of the indexed view,
+      including the point itself.
+
+      \param idx  Index of the point in the view.
+      \param k  Number of neighbors to find.
+      \return  Indices of the neighbors in the indexed view, nearest first.
+    */
+    std::vector<PointId> neighbors(PointId idx, point_count_t k) const
+    {
+        double pt[DIM];
+        viewPoint(idx, pt);
+        return neighbors(pt, k);
+    }
+
+    /**
+      Find the neighbors within a radius of a location.
+
+      \param pt  DIM coordinates of the location.
+      \param r  Search radius.
+      \param ids  Indices of the neighbors in the indexed view.
+      \param sqrDists  Square distances to the neighbors.
+    */
+    void radiusSearch(const double *pt, double r, std::vector<PointId>& ids,
+        std::vector<double>& sqrDists) const
+    {
+        float local[DIM];
+        toLocal(pt, local);
+        std::vector<std::pair<uint32_t, float>> matches;
+        radius(local, (float)(r * r), matches);
+        ids.resize(matches.size());
+        sqrDists.resize(matches.size());
+        for (size_t i = 0; i < matches.size(); ++i)
+        {
+            ids[i] = m_ids[matches[i].first];
+            sqrDists[i] = matches[i].second;
+        }
+    }
+
+    /**
+      Find the neighbors within a radius of a location.
+
+      \param pt  DIM coordinates of the location.
+      \param r  Search radius.
+      \return  Indices of the neighbors in the indexed view, nearest first.
+    */
+    std::vector<PointId> radius(const double *pt, double r) const
+    {
+        std::vector<PointId> ids;
+        std::vector<double> sqrDists;
+        radiusSearch(pt, r, ids, sqrDists);
+        return ids;
+    }
+
+    /**
+      Find the neighbors within a radius of a point of the indexed view,
+      including the point itself.
+
+      \param idx  Index of the point in the view.
+      \param r  Search radius.
+      \return  Indices of the neighbors in the indexed view, nearest first.
+    */
+    std::vector<PointId> radius(PointId idx, double r) const
+    {
+        double pt[DIM];
+        viewPoint(idx, pt);
+        return radius(pt, r);
+    }
+
+    /**
+      Find the k nearest neighbors of every point in the indexed view.
+      Points are queried in tree order, so neighboring queries visit
+      the same parts of the index.  \ref cb is called concurrently, though
+      never twice for the same point.  An exception thrown by \ref cb
+      stops the search and is rethrown.
+
+      \param k  Number of neighbors to find, including the point itself.
+      \param cb  Function called with the neighbors of each point.
+    */
+    void knnSearchAll(point_count_t k, const NeighborFunc& cb) const
+    {
+        auto query = [this, k](const float *pt, std::vector<uint32_t>& pos,
+            std::vector<float>& dists)
+        {
+            knn(pt, k, pos, dists);
+        };
+        queryAll(query, cb);
+    }
+
+    /**
+      Find the neighbors within a radius of every point in the indexed
+      view.  \ref cb is called as for knnSearchAll().
+
+      \param r  Search radius.
+      \param cb  Function called with the neighbors of each point.
+    */
+    void radiusAll(double r, const NeighborFunc& cb) const
+    {
+        const float r2 = (float)(r * r);
+        std::vector<std::pair<uint32_t, float>> matches;
+        auto query = [this, r2, matches](const float *pt,
+            std::vector<uint32_t>& pos, std::vector<float>& dists) mutable
+        {
+            radius(pt, r2, matches);
+            pos.resize(matches.size());
+            dists.resize(matches.size());
+            for (size_t i = 0; i < matches.size(); ++i)
+            {
+                pos[i] = matches[i].first;
+                dists[i] = matches[i].second;
+            }
+        };
+        queryAll(query, cb);
+    }
+
+    /**
+      Get the number of bytes held by the index.
+
+      \return  Size of the coordinates, point indices and tree.
+    */
+    size_t memoryUsed() const
+    {
+        return m_coords.capacity() * sizeof(float) +
+            m_ids.capacity() * sizeof(uint32_t) +
+            (m_index ? m_index->usedMemory() : 0);
+    }
+
+private:
+    typedef nanoflann::L2_Simple_Adaptor<float, CompactKDIndex, float> Metric;
+
+    // nanoflann's tree, with access to the order of its points.
+    class Tree : public nanoflann::KDTreeSingleIndexAdaptor<Metric,
+        CompactKDIndex, DIM, uint32_t>
+    {
+    public:
+        Tree(const CompactKDIndex& data) :
+            nanoflann::KDTreeSingleIndexAdaptor<Metric, CompactKDIndex, DIM,
+                uint32_t>(DIM, data, nanoflann::KDTreeSingleIndexAdaptorParams(
+                    100, (unsigned)parallelThreads()))
+        {}
+
+        std::vector<uint32_t>& order()
+            { return this->vind; }
+    };
+
+    const PointView& m_buf;
+    double m_origin[DIM];
+    float m_low[DIM];
+    float m_high[DIM];
+    // Coordinates relative to m_origin, DIM per point, in tree order once
+    // built.
+    std::vector<float> m_coords;
+    // Index in m_buf of the point at each position of m_coords.
+    std::vector<uint32_t> m_ids;
+    std::unique_ptr<Tree> m_index;
+
+    CompactKDIndex(const CompactKDIndex&);
+    CompactKDIndex& operator=(CompactKDIndex&);
+
+    static Dimension::Id dim(int d)
+    {
+        static const Dimension::Id dims[] =
+            { Dimension::Id::X, Dimension::Id::Y, Dimension::Id::Z };
+        return dims[d];
+    }
+
+    void viewPoint(PointId idx, double *pt) const
+    {
+        for (int d = 0; d < DIM; ++d)
+            pt[d] = m_buf.getFieldAs<double>(dim(d), idx);
+    }
+
+    void toLocal(const double *pt, float *local) const
+    {
+        for (int d = 0; d < DIM; ++d)
+            local[d] = (float)(pt[d] - m_origin[d]);
+    }
+
+    void loadCoords()
+    {
+        const point_count_t count = m_buf.size();
+        std::vector<double> values(count);
+
+        m_coords.resize(count * DIM);
+        m_ids.resize(count);
+        for (int d = 0; d < DIM; ++d)
+        {
+            if (count)
+                m_buf.getFieldArray(dim(d), 0, count, values.data());
+            double low = 0;
+            double high = 0;
+            for (PointId i = 0; i < count; ++i)
+            {
+                if (i == 0 || values[i] < low)
+                    low = values[i];
+                if (i == 0 || values[i] > high)
+                    high = values[i];
+            }
+            m_origin[d] = low + (high - low) / 2;
+            for (PointId i = 0; i < count; ++i)
+                m_coords[i * DIM + d] = (float)(values[i] - m_origin[d]);
+            m_low[d] = (float)(low - m_origin[d]);
+            m_high[d] = (float)(high - m_origin[d]);
+        }
+        for (PointId i = 0; i < count; ++i)
+            m_ids[i] = (uint32_t)i;
+    }
+
+    void knn(const float *pt, point_count_t k, std::vector<uint32_t>& pos,
+        std::vector<float>& dists) const
+    {
+        k = (std::min)((point_count_t)m_ids.size(), k);
+        pos.resize(k);
+        dists.resize(k);
+        if (k == 0)
+            return;
+        nanoflann::KNNResultSet<float, uint32_t, point_count_t> resultSet(k);
+        resultSet.init(pos.data(), dists.data());
+        m_index->findNeighbors(resultSet, pt, nanoflann::SearchParams(10));
+    }
+
+    void radius(const float *pt, float r2,
+        std::vector<std::pair<uint32_t, float>>& matches) const
+    {
+        matches.clear();
+        if (m_ids.empty())
+            return;
+        nanoflann::SearchParams params;
+        params.sorted = true;
+        m_index->radiusSearch(pt, r2, matches, params);
+    }
+
+    void output(const std::vector<uint32_t>& pos,
+        const std::vector<float>& dists, std::vector<PointId>& ids,
+        std::vector<double>& sqrDists) const
+    {
+        ids.resize(pos.size());
+        sqrDists.resize(pos.size());
+        for (size_t i = 0; i < pos.size(); ++i)
+        {
+            ids[i] = m_ids[pos[i]];
+            sqrDists[i] = dists[i];
+        }
+    }
+
+    // Run the query for each indexed point, in tree order, each thread
+    // with its own copy of the query and result buffers.
+    template<typename Query>
+    void queryAll(Query query, const NeighborFunc& cb) const
+    {
+        struct Worker
+        {
+            const CompactKDIndex& m_index;
+            Query m_query;
+            const NeighborFunc& m_cb;
+            std::vector<uint32_t> m_pos;
+            std::vector<float> m_dists;
+            std::vector<PointId> m_ids;
+            std::vector<double> m_sqrDists;
+
+            void operator()(size_t pos)
+            {
+                m_query(&m_index.m_coords[pos * DIM], m_pos, m_dists);
+                m_index.output(m_pos, m_dists, m_ids, m_sqrDists);
+                m_cb(m_index.m_ids[pos], m_ids, m_sqrDists);
+            }
+        };
+
+        parallelFor(m_ids.size(), [&]()
+            { return Worker { *this, query, cb, {}, {}, {}, {} }; });
+    }
+};
+
+typedef CompactKDIndex<2> CompactKD2Index;
+typedef CompactKDIndex<3> CompactKD3Index;
+
+} // namespace pdal
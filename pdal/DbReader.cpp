@@ -136,4 +136,36 @@ void DbReader::writePoint(PointView& view, PointId idx, const char *buf)
     }
 }
 
+
+void DbReader::writeField(PointRef& point, const char *pos,
+    const DimType& dim)
+{
+    using namespace Dimension;
+
+    if (dim.m_id == Id::X || dim.m_id == Id::Y || dim.m_id == Id::Z)
+    {
+        Everything e;
+
+        memcpy(&e, pos, Dimension::size(dim.m_type));
+        double d = Utils::toDouble(e, dim.m_type);
+        d = (d * dim.m_xform.m_scale.m_val) + dim.m_xform.m_offset.m_val;
+        point.setField(dim.m_id, d);
+    }
+    else
+        point.setField(dim.m_id, dim.m_type, pos);
+}
+
+
+/// Write a point's packed data into a point.
+/// \param[in] point  Point to write to.
+/// \param[in] buf  Pointer to packed DB point data.
+void DbReader::writePoint(PointRef& point, const char *buf)
+{
+    for (auto di = m_dims.begin(); di != m_dims.end(); ++di)
+    {
+        writeField(point, buf, di->m_dimType);
+        buf += Dimension::size(di->m_dimType.m_type);
+    }
+}
+
 } // namespace pdal
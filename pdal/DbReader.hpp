@@ -52,6 +52,8 @@ protected:
     void writeField(PointView& view, const char *pos, const DimType& dim,
         PointId idx);
     void writePoint(PointView& view, PointId idx, const char *buf);
+    void writeField(PointRef& point, const char *pos, const DimType& dim);
+    void writePoint(PointRef& point, const char *buf);
     size_t packedPointSize() const
         { return m_packedPointSize; }
     size_t dimOffset(Dimension::Id id) const;
@@ -44,7 +44,8 @@ namespace Dimension
 class Detail
 {
 public:
-    Detail() : m_id(Id::Unknown), m_offset(-1), m_type(Type::None)
+    Detail() : m_id(Id::Unknown), m_offset(-1), m_type(Type::None),
+        m_scaled(false)
     {}
     //NOTE - This is strange, but for some reason things run faster with
     // this NOOP virtual dtor.  Perhaps it has something to do with
@@ -67,14 +68,27 @@ public:
     Type type() const
         { return m_type; }
     size_t size() const
-        { return Dimension::size(m_type); }
+        { return m_scaled ? sizeof(int32_t) : Dimension::size(m_type); }
     BaseType base() const
         { return Dimension::base(m_type); }
 
+    // A scaled dimension has values of its type but is stored as 32-bit
+    // integers that are converted with a transform.
+    void setScaled(bool scaled)
+        { m_scaled = scaled; }
+    bool scaled() const
+        { return m_scaled; }
+    void setXForm(const XForm& xform)
+        { m_xform = xform; }
+    const XForm& xform() const
+        { return m_xform; }
+
 private:
     Id m_id;
     int m_offset;
     Type m_type;
+    bool m_scaled;
+    XForm m_xform;
 };
 typedef std::vector<Detail> DetailList;
 
@@ -103,6 +103,53 @@ inline BaseType base(Type t)
     return BaseType(Utils::toNative(t) & 0xFF00);
 }
 
+/// Get the dimension type that corresponds to a C++ type.
+/// \return  Dimension type of T, or Type::None if T doesn't correspond
+///   to a dimension type.
+template<typename T>
+inline Type getType()
+    { return Type::None; }
+
+template<>
+inline Type getType<float>()
+    { return Type::Float; }
+
+template<>
+inline Type getType<double>()
+    { return Type::Double; }
+
+template<>
+inline Type getType<int8_t>()
+    { return Type::Signed8; }
+
+template<>
+inline Type getType<int16_t>()
+    { return Type::Signed16; }
+
+template<>
+inline Type getType<int32_t>()
+    { return Type::Signed32; }
+
+template<>
+inline Type getType<int64_t>()
+    { return Type::Signed64; }
+
+template<>
+inline Type getType<uint8_t>()
+    { return Type::Unsigned8; }
+
+template<>
+inline Type getType<uint16_t>()
+    { return Type::Unsigned16; }
+
+template<>
+inline Type getType<uint32_t>()
+    { return Type::Unsigned32; }
+
+template<>
+inline Type getType<uint64_t>()
+    { return Type::Unsigned64; }
+
 static const int COUNT = (std::numeric_limits<uint16_t>::max)();
 static const int PROPRIETARY = 0xF000;
 
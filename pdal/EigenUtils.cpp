@@ -38,11 +38,14 @@
 #include <pdal/PointView.hpp>
 #include <pdal/SpatialReference.hpp>
 #include <pdal/util/Bounds.hpp>
+#include <pdal/util/ThreadPool.hpp>
 #include <pdal/util/Utils.hpp>
 
 #include <Eigen/Dense>
 
+#include <algorithm>
 #include <cfloat>
+#include <cmath>
 #include <numeric>
 #include <vector>
 
@@ -83,46 +86,130 @@ Eigen::Vector3d computeCentroid(PointView& view,
     return centroid;
 }
 
-Eigen::Matrix3f computeCovariance(PointView& view,
-    const std::vector<PointId>& ids)
+namespace
+{
+
+// Accumulate the covariance in a single pass.  Coordinates are taken
+// relative to the first point, which keeps the sums small for a compact
+// neighborhood so that the products don't lose precision.  'getPoint'
+// sets the coordinates of a point.
+template<typename GetPoint>
+Eigen::Matrix3d covariance(const std::vector<PointId>& ids,
+    GetPoint getPoint)
 {
     using namespace Eigen;
 
-    auto n = ids.size();
+    Matrix3d cov;
+    if (ids.empty())
+    {
+        cov.setConstant(std::numeric_limits<double>::quiet_NaN());
+        return cov;
+    }
 
-    Vector3d centroid = computeCentroid(view, ids);
+    double p0[3];
+    getPoint(ids.front(), p0);
 
-    // demean the neighborhood
-    MatrixXf A(3, n);
-    size_t k = 0;
+    double sx(0), sy(0), sz(0);
+    double sxx(0), sxy(0), sxz(0), syy(0), syz(0), szz(0);
     for (auto const& j : ids)
     {
-        A(0, k) =
-            static_cast<float>(view.getFieldAs<double>(Dimension::Id::X, j) -
-                centroid[0]);
-        A(1, k) =
-            static_cast<float>(view.getFieldAs<double>(Dimension::Id::Y, j) -
-                centroid[1]);
-        A(2, k) =
-            static_cast<float>(view.getFieldAs<double>(Dimension::Id::Z, j) -
-                centroid[2]);
-        k++;
+        double p[3];
+        getPoint(j, p);
+        double x = p[0] - p0[0];
+        double y = p[1] - p0[1];
+        double z = p[2] - p0[2];
+        sx += x;
+        sy += y;
+        sz += z;
+        sxx += x * x;
+        sxy += x * y;
+        sxz += x * z;
+        syy += y * y;
+        syz += y * z;
+        szz += z * z;
     }
 
-    return A * A.transpose() / (ids.size()-1);
+    const double n = (double)ids.size();
+    cov(0, 0) = sxx - sx * sx / n;
+    cov(0, 1) = cov(1, 0) = sxy - sx * sy / n;
+    cov(0, 2) = cov(2, 0) = sxz - sx * sz / n;
+    cov(1, 1) = syy - sy * sy / n;
+    cov(1, 2) = cov(2, 1) = syz - sy * sz / n;
+    cov(2, 2) = szz - sz * sz / n;
+    return cov / (n - 1);
 }
 
-uint8_t computeRank(PointView& view, const std::vector<PointId>& ids,
-    double threshold)
+
+Eigen::Matrix3d covariance(PointView& view, const std::vector<PointId>& ids)
+{
+    return covariance(ids, [&view](PointId id, double *p)
+    {
+        p[0] = view.getFieldAs<double>(Dimension::Id::X, id);
+        p[1] = view.getFieldAs<double>(Dimension::Id::Y, id);
+        p[2] = view.getFieldAs<double>(Dimension::Id::Z, id);
+    });
+}
+
+
+// Solve the eigenproblem of a covariance matrix in closed form.
+bool covarianceEigen(const Eigen::Matrix3d& cov,
+    Eigen::Vector3f& eigenvalues, Eigen::Matrix3f *eigenvectors)
 {
     using namespace Eigen;
 
-    Matrix3f B = computeCovariance(view, ids);
+    if (!cov.allFinite())
+        return false;
+
+    SelfAdjointEigenSolver<Matrix3d> solver;
+    solver.computeDirect(cov,
+        eigenvectors ? ComputeEigenvectors : EigenvaluesOnly);
+    eigenvalues = solver.eigenvalues().cast<float>();
+    if (eigenvectors)
+        *eigenvectors = solver.eigenvectors().cast<float>();
+    return eigenvalues.allFinite();
+}
 
-    JacobiSVD<Matrix3f> svd(B);
-    svd.setThreshold((float)threshold);
+} // unnamed namespace
 
-    return static_cast<uint8_t>(svd.rank());
+Eigen::Matrix3f computeCovariance(PointView& view,
+    const std::vector<PointId>& ids)
+{
+    return covariance(view, ids).cast<float>();
+}
+
+bool computeCovarianceEigen(PointView& view, const std::vector<PointId>& ids,
+    Eigen::Vector3f& eigenvalues, Eigen::Matrix3f *eigenvectors)
+{
+    return covarianceEigen(covariance(view, ids), eigenvalues, eigenvectors);
+}
+
+bool computeCovarianceEigen(const double *coords,
+    const std::vector<PointId>& ids, Eigen::Vector3f& eigenvalues,
+    Eigen::Matrix3f *eigenvectors)
+{
+    Eigen::Matrix3d cov = covariance(ids, [coords](PointId id, double *p)
+        { std::copy_n(coords + id * 3, 3, p); });
+    return covarianceEigen(cov, eigenvalues, eigenvectors);
+}
+
+uint8_t computeRank(PointView& view, const std::vector<PointId>& ids,
+    double threshold)
+{
+    // The singular values of a covariance matrix are its eigenvalues.  As
+    // with the SVD, a value counts toward the rank if it's larger than
+    // threshold times the largest value.
+    Eigen::Vector3f ev;
+    if (!computeCovarianceEigen(view, ids, ev))
+        return 0;
+    ev = ev.cwiseAbs();
+
+    float limit = (std::max)(ev.maxCoeff() * (float)threshold,
+        (std::numeric_limits<float>::min)());
+    uint8_t rank(0);
+    for (int i = 0; i < 3; ++i)
+        if (ev[i] > limit)
+            rank++;
+    return rank;
 }
 
 Eigen::MatrixXd computeSpline(Eigen::MatrixXd x, Eigen::MatrixXd y,
@@ -140,91 +227,104 @@ Eigen::MatrixXd computeSpline(Eigen::MatrixXd x, Eigen::MatrixXd y,
 
     MatrixXd S = MatrixXd::Zero(num_rows, num_cols);
 
-    for (auto col = 0; col < num_cols; ++col)
+    // Every cell is interpolated on its own, so bands of rows are
+    // interpolated on separate threads.
+    parallelFor(num_rows, [&]()
     {
-        for (auto row = 0; row < num_rows; ++row)
+        return [&](size_t i)
         {
-            // Further optimizations are achieved by estimating only the
-            // interpolated surface within a local neighbourhood (e.g. a 7 x 7
-            // neighbourhood is used in our case) of the cell being filtered.
-            int radius = 3;
-
-            int c = static_cast<int>(std::floor(col/2));
-            int r = static_cast<int>(std::floor(row/2));
-
-            int cs = Utils::clamp(c-radius, 0, static_cast<int>(z.cols()-1));
-            int ce = Utils::clamp(c+radius, 0, static_cast<int>(z.cols()-1));
-            int col_size = ce - cs + 1;
-            int rs = Utils::clamp(r-radius, 0, static_cast<int>(z.rows()-1));
-            int re = Utils::clamp(r+radius, 0, static_cast<int>(z.rows()-1));
-            int row_size = re - rs + 1;
-
-            MatrixXd Xn = x.block(rs, cs, row_size, col_size);
-            MatrixXd Yn = y.block(rs, cs, row_size, col_size);
-            MatrixXd Hn = z.block(rs, cs, row_size, col_size);
-
-            int nsize = row_size * col_size;
-            VectorXd T = VectorXd::Zero(nsize);
-            MatrixXd P = MatrixXd::Zero(nsize, 3);
-            MatrixXd K = MatrixXd::Zero(nsize, nsize);
-
-            for (auto id = 0; id < nsize; ++id)
+            const int row = static_cast<int>(i);
+            for (auto col = 0; col < num_cols; ++col)
             {
-                double xj = Xn(id);
-                double yj = Yn(id);
-                double zj = Hn(id);
-                if (std::isnan(xj) || std::isnan(yj) || std::isnan(zj))
-                    continue;
-                T(id) = zj;
-                P.row(id) << 1, xj, yj;
-                for (auto id2 = 0; id2 < nsize; ++id2)
+                // Further optimizations are achieved by estimating only
+                // the interpolated surface within a local neighbourhood
+                // (e.g. a 7 x 7 neighbourhood is used in our case) of the
+                // cell being filtered.
+                int radius = 3;
+
+                int c = static_cast<int>(std::floor(col/2));
+                int r = static_cast<int>(std::floor(row/2));
+
+                int cs = Utils::clamp(c-radius, 0,
+                    static_cast<int>(z.cols()-1));
+                int ce = Utils::clamp(c+radius, 0,
+                    static_cast<int>(z.cols()-1));
+                int col_size = ce - cs + 1;
+                int rs = Utils::clamp(r-radius, 0,
+                    static_cast<int>(z.rows()-1));
+                int re = Utils::clamp(r+radius, 0,
+                    static_cast<int>(z.rows()-1));
+                int row_size = re - rs + 1;
+
+                MatrixXd Xn = x.block(rs, cs, row_size, col_size);
+                MatrixXd Yn = y.block(rs, cs, row_size, col_size);
+                MatrixXd Hn = z.block(rs, cs, row_size, col_size);
+
+                int nsize = row_size * col_size;
+                VectorXd T = VectorXd::Zero(nsize);
+                MatrixXd P = MatrixXd::Zero(nsize, 3);
+                MatrixXd K = MatrixXd::Zero(nsize, nsize);
+
+                for (auto id = 0; id < nsize; ++id)
                 {
-                    if (id == id2)
-                        continue;
-                    double xk = Xn(id2);
-                    double yk = Yn(id2);
-                    double zk = Hn(id2);
-                    if (std::isnan(xk) || std::isnan(yk) || std::isnan(zk))
+                    double xj = Xn(id);
+                    double yj = Yn(id);
+                    double zj = Hn(id);
+                    if (std::isnan(xj) || std::isnan(yj) || std::isnan(zj))
                         continue;
-                    double rsqr = (xj - xk) * (xj - xk) + (yj - yk) * (yj - yk);
-                    if (rsqr == 0.0)
-                        continue;
-                    K(id, id2) = rsqr * std::log10(std::sqrt(rsqr));
+                    T(id) = zj;
+                    P.row(id) << 1, xj, yj;
+                    for (auto id2 = 0; id2 < nsize; ++id2)
+                    {
+                        if (id == id2)
+                            continue;
+                        double xk = Xn(id2);
+                        double yk = Yn(id2);
+                        double zk = Hn(id2);
+                        if (std::isnan(xk) || std::isnan(yk) || std::isnan(zk))
+                            continue;
+                        double rsqr = (xj - xk) * (xj - xk) +
+                            (yj - yk) * (yj - yk);
+                        if (rsqr == 0.0)
+                            continue;
+                        K(id, id2) = rsqr * std::log10(std::sqrt(rsqr));
+                    }
                 }
-            }
 
-            MatrixXd A = MatrixXd::Zero(nsize+3, nsize+3);
-            A.block(0,0,nsize,nsize) = K;
-            A.block(0,nsize,nsize,3) = P;
-            A.block(nsize,0,3,nsize) = P.transpose();
+                MatrixXd A = MatrixXd::Zero(nsize+3, nsize+3);
+                A.block(0,0,nsize,nsize) = K;
+                A.block(0,nsize,nsize,3) = P;
+                A.block(nsize,0,3,nsize) = P.transpose();
 
-            VectorXd b = VectorXd::Zero(nsize+3);
-            b.head(nsize) = T;
+                VectorXd b = VectorXd::Zero(nsize+3);
+                b.head(nsize) = T;
 
-            VectorXd x = A.fullPivHouseholderQr().solve(b);
+                VectorXd x = A.fullPivHouseholderQr().solve(b);
 
-            Vector3d a = x.tail(3);
-            VectorXd w = x.head(nsize);
+                Vector3d a = x.tail(3);
+                VectorXd w = x.head(nsize);
 
-            double sum = 0.0;
-            double xi2 = xx(row, col);
-            double yi2 = yy(row, col);
-            for (auto j = 0; j < nsize; ++j)
-            {
-                double xj = Xn(j);
-                double yj = Yn(j);
-                double zj = Hn(j);
-                if (std::isnan(xj) || std::isnan(yj) || std::isnan(zj))
-                    continue;
-                double rsqr = (xj - xi2) * (xj - xi2) + (yj - yi2) * (yj - yi2);
-                if (rsqr == 0.0)
-                    continue;
-                sum += w(j) * rsqr * std::log10(std::sqrt(rsqr));
-            }
+                double sum = 0.0;
+                double xi2 = xx(row, col);
+                double yi2 = yy(row, col);
+                for (auto j = 0; j < nsize; ++j)
+                {
+                    double xj = Xn(j);
+                    double yj = Yn(j);
+                    double zj = Hn(j);
+                    if (std::isnan(xj) || std::isnan(yj) || std::isnan(zj))
+                        continue;
+                    double rsqr = (xj - xi2) * (xj - xi2) +
+                        (yj - yi2) * (yj - yi2);
+                    if (rsqr == 0.0)
+                        continue;
+                    sum += w(j) * rsqr * std::log10(std::sqrt(rsqr));
+                }
 
-            S(row, col) = a(0) + a(1)*xi2 + a(2)*yi2 + sum;
-        }
-    }
+                S(row, col) = a(0) + a(1)*xi2 + a(2)*yi2 + sum;
+            }
+        };
+    }, 1);
 
     return S;
 }
@@ -285,8 +385,7 @@ Eigen::MatrixXd createMaxMatrix2(PointView& view, int rows, int cols,
     using namespace Dimension;
     using namespace Eigen;
 
-    KD2Index kdi(view);
-    kdi.build();
+    KD2Index& kdi = view.build2dIndex();
 
     MatrixXd ZImax(rows, cols);
     ZImax.setConstant(std::numeric_limits<double>::quiet_NaN());
@@ -369,161 +468,207 @@ Eigen::MatrixXd extendedLocalMinimum(PointView& view, int rows, int cols,
 }
 
 
-Eigen::MatrixXd matrixClose(Eigen::MatrixXd data, int radius)
+namespace
 {
-    using namespace Eigen;
 
-    MatrixXd data2 = padMatrix(data, radius);
+// Morphology with windows of any size at a cost per cell that doesn't
+// depend on the window size (van Herk/Gil-Werman).  Minimum and maximum
+// are exact, so the results are the same as those of a brute-force scan
+// of each window.  As with a scan that starts with the identity and
+// replaces the running value only with a strictly smaller (or larger)
+// one, NaN values are ignored.
 
-    int nrows = static_cast<int>(data2.rows());
-    int ncols = data2.cols();
+struct MinOp
+{
+    static double identity()
+        { return (std::numeric_limits<double>::max)(); }
+    double operator()(double a, double b) const
+        { return b < a ? b : a; }
+};
 
-    MatrixXd minZ(nrows, ncols);
-    minZ.setConstant((std::numeric_limits<double>::max)());
-    MatrixXd maxZ(nrows, ncols);
-    maxZ.setConstant(std::numeric_limits<double>::lowest());
-    for (auto c = 0; c < ncols; ++c)
+struct MaxOp
+{
+    static double identity()
+        { return std::numeric_limits<double>::lowest(); }
+    double operator()(double a, double b) const
+        { return b > a ? b : a; }
+};
+
+// Buffers for sliding a window along one line of values.
+struct LineBuffers
+{
+    std::vector<double> line;
+    std::vector<double> prefix;
+    std::vector<double> suffix;
+};
+
+// Apply 'op' over the window of 2 * radius + 1 values centered on each
+// of 'count' values spaced 'stride' apart.  Values off the ends of the
+// line are ignored.
+template<typename OP>
+void slideLine(const double *in, double *out, size_t count,
+    std::ptrdiff_t stride, size_t radius, OP op, LineBuffers& buf)
+{
+    // Padding the line with the identity keeps every window the full
+    // block size.
+    const size_t block = 2 * radius + 1;
+    const size_t n = count + 2 * radius;
+    buf.line.assign(n, OP::identity());
+    buf.prefix.resize(n);
+    buf.suffix.resize(n);
+    for (size_t i = 0; i < count; ++i)
+        buf.line[radius + i] = in[(std::ptrdiff_t)i * stride];
+
+    for (size_t start = 0; start < n; start += block)
     {
-        int cs = Utils::clamp(c-radius, 0, ncols-1);
-        int ce = Utils::clamp(c+radius, 0, ncols-1);
+        size_t end = (std::min)(start + block, n);
+        double v = OP::identity();
+        for (size_t i = start; i < end; ++i)
+            buf.prefix[i] = v = op(v, buf.line[i]);
+        v = OP::identity();
+        for (size_t i = end; i-- > start;)
+            buf.suffix[i] = v = op(v, buf.line[i]);
+    }
 
-        for (auto r = 0; r < nrows; ++r)
-        {
-            int rs = Utils::clamp(r-radius, 0, nrows-1);
-            int re = Utils::clamp(r+radius, 0, nrows-1);
+    // The window for value i is [i, i + 2 * radius] of the padded line.
+    for (size_t i = 0; i < count; ++i)
+        out[(std::ptrdiff_t)i * stride] =
+            op(buf.suffix[i], buf.prefix[i + 2 * radius]);
+}
 
-            for (auto col = cs; col <= ce; ++col)
-            {
-                for (auto row = rs; row <= re; ++row)
-                {
-                    if ((row-r)*(row-r)+(col-c)*(col-c) > radius*radius)
-                        continue;
-                    if (data2(row, col) > maxZ(r, c))
-                        maxZ(r, c) = data2(row, col);
-                }
-            }
-        }
-    }
-    for (auto c = 0; c < ncols; ++c)
-    {
-        int cs = Utils::clamp(c-radius, 0, ncols-1);
-        int ce = Utils::clamp(c+radius, 0, ncols-1);
 
-        for (auto r = 0; r < nrows; ++r)
+// Apply 'op' over the four neighbors and the cell itself for each cell
+// of a column-major raster.
+template<typename OP>
+void crossPass(const std::vector<double>& in, std::vector<double>& out,
+    size_t rows, size_t cols, OP op)
+{
+    parallelFor(cols, [&]()
+    {
+        return [&](size_t col)
         {
-            int rs = Utils::clamp(r-radius, 0, nrows-1);
-            int re = Utils::clamp(r+radius, 0, nrows-1);
-
-            for (auto col = cs; col <= ce; ++col)
+            size_t index = col * rows;
+            for (size_t row = 0; row < rows; ++row)
             {
-                for (auto row = rs; row <= re; ++row)
-                {
-                    if ((row-r)*(row-r)+(col-c)*(col-c) > radius*radius)
-                        continue;
-                    if (maxZ(row, col) < minZ(r, c))
-                        minZ(r, c) = maxZ(row, col);
-                }
+                size_t i = index + row;
+                double v = op(OP::identity(), in[i]);
+                if (row > 0)
+                    v = op(v, in[i - 1]);
+                if (row < rows - 1)
+                    v = op(v, in[i + 1]);
+                if (col > 0)
+                    v = op(v, in[i - rows]);
+                if (col < cols - 1)
+                    v = op(v, in[i + rows]);
+                out[i] = v;
             }
-        }
-    }
-
-    return minZ.block(radius, radius, data.rows(), data.cols());
+        };
+    }, 16);
 }
 
-Eigen::MatrixXd matrixOpen(Eigen::MatrixXd data, int radius)
-{
-    using namespace Eigen;
-
-    MatrixXd data2 = padMatrix(data, radius);
 
-    int nrows = data2.rows();
-    int ncols = data2.cols();
+// Apply 'op' along every diagonal line of a column-major raster running
+// in the direction (drow, 1) where drow is 1 or -1.
+template<typename OP>
+void diagonalPass(const std::vector<double>& in, std::vector<double>& out,
+    size_t rows, size_t cols, size_t radius, int drow, OP op)
+{
+    const std::ptrdiff_t stride = (std::ptrdiff_t)rows + drow;
 
-    MatrixXd minZ(nrows, ncols);
-    minZ.setConstant((std::numeric_limits<double>::max)());
-    MatrixXd maxZ(nrows, ncols);
-    maxZ.setConstant(std::numeric_limits<double>::lowest());
-    for (auto c = 0; c < ncols; ++c)
+    // Lines start in the first column or, for the rest, in the first
+    // (drow == 1) or last (drow == -1) row.
+    parallelFor(rows + cols - 1, [&]()
     {
-        int cs = Utils::clamp(c-radius, 0, ncols-1);
-        int ce = Utils::clamp(c+radius, 0, ncols-1);
-
-        for (auto r = 0; r < nrows; ++r)
+        LineBuffers buf;
+        return [&, buf](size_t line) mutable
         {
-            int rs = Utils::clamp(r-radius, 0, nrows-1);
-            int re = Utils::clamp(r+radius, 0, nrows-1);
-
-            for (auto col = cs; col <= ce; ++col)
+            size_t row = 0;
+            size_t col = 0;
+            if (line < rows)
+                row = line;
+            else
             {
-                for (auto row = rs; row <= re; ++row)
-                {
-                    if ((row-r)*(row-r)+(col-c)*(col-c) > radius*radius)
-                        continue;
-                    if (data2(row, col) < minZ(r, c))
-                        minZ(r, c) = data2(row, col);
-                }
+                row = (drow > 0) ? 0 : rows - 1;
+                col = line - rows + 1;
             }
-        }
-    }
-    for (auto c = 0; c < ncols; ++c)
-    {
-        int cs = Utils::clamp(c-radius, 0, ncols-1);
-        int ce = Utils::clamp(c+radius, 0, ncols-1);
+            size_t count = (drow > 0) ? rows - row : row + 1;
+            count = (std::min)(count, cols - col);
+            size_t start = col * rows + row;
+            slideLine(in.data() + start, out.data() + start, count, stride,
+                radius, op, buf);
+        };
+    }, 16);
+}
 
-        for (auto r = 0; r < nrows; ++r)
-        {
-            int rs = Utils::clamp(r-radius, 0, nrows-1);
-            int re = Utils::clamp(r+radius, 0, nrows-1);
 
-            for (auto col = cs; col <= ce; ++col)
-            {
-                for (auto row = rs; row <= re; ++row)
-                {
-                    if ((row-r)*(row-r)+(col-c)*(col-c) > radius*radius)
-                        continue;
-                    if (minZ(row, col) > maxZ(r, c))
-                        maxZ(r, c) = minZ(row, col);
-                }
-            }
-        }
+// Erosion or dilation by a diamond of 'radius' cells, which is what
+// 'radius' passes with the four-neighbor cross give.  A diamond of
+// radius 2m + 1 is a square of radius m turned 45 degrees (two diagonal
+// passes) followed by one cross pass.  A diamond of radius 2m + 2 takes
+// a second cross pass.  The raster is padded with the identity so that
+// no partial result is clipped at the edges.
+template<typename OP>
+std::vector<double> diamond(const std::vector<double>& data, size_t rows,
+    size_t cols, int radius, OP op)
+{
+    const size_t m = (radius - 1) / 2;
+    const int crosses = radius - 2 * (int)m;
+    const size_t pad = radius;
+    const size_t prows = rows + 2 * pad;
+    const size_t pcols = cols + 2 * pad;
+
+    std::vector<double> a(prows * pcols, OP::identity());
+    for (size_t col = 0; col < cols; ++col)
+        std::copy(data.begin() + col * rows, data.begin() + (col + 1) * rows,
+            a.begin() + (col + pad) * prows + pad);
+    std::vector<double> b(a.size());
+
+    if (m)
+    {
+        diagonalPass(a, b, prows, pcols, m, 1, op);
+        diagonalPass(b, a, prows, pcols, m, -1, op);
+    }
+    for (int i = 0; i < crosses; ++i)
+    {
+        crossPass(a, b, prows, pcols, op);
+        a.swap(b);
     }
 
-    return maxZ.block(radius, radius, data.rows(), data.cols());
+    std::vector<double> out(data.size());
+    for (size_t col = 0; col < cols; ++col)
+        std::copy(a.begin() + (col + pad) * prows + pad,
+            a.begin() + (col + pad) * prows + pad + rows,
+            out.begin() + col * rows);
+    return out;
 }
 
-std::vector<double> dilateDiamond(std::vector<double> data, size_t rows, size_t cols, int iterations)
-{
-    std::vector<double> out(data.size(), std::numeric_limits<double>::lowest());
-    std::vector<size_t> idx(5);
 
+// Repeated cross passes, as dilateDiamond()/erodeDiamond() have always
+// done.  Used when the data has NaN values, because those make the
+// result depend on the order of the passes.
+template<typename OP>
+std::vector<double> iterateCross(std::vector<double> data, size_t rows,
+    size_t cols, int iterations, OP op)
+{
+    std::vector<double> out(data.size(), OP::identity());
     for (int iter = 0; iter < iterations; ++iter)
     {
         for (size_t col = 0; col < cols; ++col)
         {
-            size_t index = col*rows;
+            size_t index = col * rows;
             for (size_t row = 0; row < rows; ++row)
             {
-                // Find the index into the vector of the current cell.  Then
-                // find the index of the cells to the right/left/above/below
-                // if they exist.
-                size_t j = 0;
-                idx[j++] = index+row;
+                size_t i = index + row;
+                double& v = out[i];
+                v = op(v, data[i]);
                 if (row > 0)
-                    idx[j++] = idx[0]-1;
-                if (row < rows-1)
-                    idx[j++] = idx[0]+1;
+                    v = op(v, data[i - 1]);
+                if (row < rows - 1)
+                    v = op(v, data[i + 1]);
                 if (col > 0)
-                    idx[j++] = idx[0]-rows;
-                if (col < cols-1)
-                    idx[j++] = idx[0]+rows;
-                // If the data at the test cell pos is greater than that
-                // from the last iteration, set the value to the maximum of
-                // the value of those cells.
-                for (size_t i = 0; i < j; ++i)
-                {
-                    if (data[idx[i]] > out[index+row])
-                        out[index+row] = data[idx[i]];
-                }
+                    v = op(v, data[i - rows]);
+                if (col < cols - 1)
+                    v = op(v, data[i + rows]);
             }
         }
         data.swap(out);
@@ -531,49 +676,163 @@ std::vector<double> dilateDiamond(std::vector<double> data, size_t rows, size_t
     return data;
 }
 
-std::vector<double> erodeDiamond(std::vector<double> data, size_t rows, size_t cols, int iterations)
+
+template<typename OP>
+std::vector<double> diamondFilter(std::vector<double> data, size_t rows,
+    size_t cols, int iterations, OP op)
 {
-    std::vector<double> out(data.size(), (std::numeric_limits<double>::max)());
-    std::vector<size_t> idx(5);
+    if (iterations <= 0 || data.empty())
+        return data;
+    for (double d : data)
+        if (std::isnan(d))
+            return iterateCross(std::move(data), rows, cols, iterations, op);
+    return diamond(data, rows, cols, iterations, op);
+}
 
-    for (int iter = 0; iter < iterations; ++iter)
+
+// Erosion or dilation by a square with sides of 2 * radius + 1 cells:
+// a pass along the columns and one along the rows.
+template<typename OP>
+std::vector<double> square(const std::vector<double>& data, size_t rows,
+    size_t cols, int radius, OP op)
+{
+    if (radius <= 0 || data.empty())
+        return data;
+
+    std::vector<double> tmp(data.size());
+    std::vector<double> out(data.size());
+    parallelFor(cols, [&]()
     {
-        for (size_t col = 0; col < cols; ++col)
+        LineBuffers buf;
+        return [&, buf](size_t col) mutable
         {
-            size_t index = col*rows;
-            for (size_t row = 0; row < rows; ++row)
+            slideLine(data.data() + col * rows, tmp.data() + col * rows,
+                rows, 1, radius, op, buf);
+        };
+    }, 16);
+    parallelFor(rows, [&]()
+    {
+        LineBuffers buf;
+        return [&, buf](size_t row) mutable
+        {
+            slideLine(tmp.data() + row, out.data() + row, cols, rows,
+                radius, op, buf);
+        };
+    }, 16);
+    return out;
+}
+
+
+// Erosion or dilation by a disk.  The disk is a stack of horizontal
+// chords, one for each row offset.  A sliding window along the rows is
+// computed once for each chord width and the chords are combined down
+// the columns, so the cost per cell is proportional to the radius rather
+// than to the area of the disk.  Cells outside the matrix are ignored.
+template<typename OP>
+Eigen::MatrixXd disk(const Eigen::MatrixXd& data, int radius, OP op)
+{
+    using namespace Eigen;
+
+    const size_t rows = data.rows();
+    const size_t cols = data.cols();
+
+    // Half width of the chord at each row offset.
+    std::vector<size_t> halfWidth(radius + 1);
+    for (int dr = 0; dr <= radius; ++dr)
+    {
+        int w = 0;
+        while ((w + 1) * (w + 1) + dr * dr <= radius * radius)
+            w++;
+        halfWidth[dr] = w;
+    }
+
+    MatrixXd out = MatrixXd::Constant(rows, cols, OP::identity());
+    MatrixXd chord(rows, cols);
+    const double *in = data.data();
+    double *dst = chord.data();
+    for (int dr = 0; dr <= radius; ++dr)
+    {
+        // Row offsets with the same width share a sliding window.
+        if (dr == 0 || halfWidth[dr] != halfWidth[dr - 1])
+            parallelFor(rows, [&]()
             {
-                size_t j = 0;
-                idx[j++] = index+row;
-                if (row > 0)
-                    idx[j++] = idx[0]-1;
-                if (row < rows-1)
-                    idx[j++] = idx[0]+1;
-                if (col > 0)
-                    idx[j++] = idx[0]-rows;
-                if (col < cols-1)
-                    idx[j++] = idx[0]+rows;
-                for (size_t i = 0; i < j; ++i)
+                LineBuffers buf;
+                return [&, buf](size_t row) mutable
+                {
+                    slideLine(in + row, dst + row, cols, rows, halfWidth[dr],
+                        op, buf);
+                };
+            }, 16);
+        parallelFor(cols, [&]()
+        {
+            return [&](size_t col)
+            {
+                for (size_t row = 0; row < rows; ++row)
                 {
-                    if (data[idx[i]] < out[index+row])
-                        out[index+row] = data[idx[i]];
+                    double& v = out(row, col);
+                    if (row >= (size_t)dr)
+                        v = op(v, chord(row - dr, col));
+                    if (dr && row + dr < rows)
+                        v = op(v, chord(row + dr, col));
                 }
-            }
-        }
-        data.swap(out);
+            };
+        }, 16);
     }
-    return data;
+    return out;
+}
+
+} // unnamed namespace
+
+Eigen::MatrixXd matrixClose(Eigen::MatrixXd data, int radius)
+{
+    using namespace Eigen;
+
+    MatrixXd data2 = padMatrix(data, radius);
+    MatrixXd maxZ = disk(data2, radius, MaxOp());
+    MatrixXd minZ = disk(maxZ, radius, MinOp());
+    return minZ.block(radius, radius, data.rows(), data.cols());
+}
+
+Eigen::MatrixXd matrixOpen(Eigen::MatrixXd data, int radius)
+{
+    using namespace Eigen;
+
+    MatrixXd data2 = padMatrix(data, radius);
+    MatrixXd minZ = disk(data2, radius, MinOp());
+    MatrixXd maxZ = disk(minZ, radius, MaxOp());
+    return maxZ.block(radius, radius, data.rows(), data.cols());
+}
+
+std::vector<double> dilateDiamond(std::vector<double> data, size_t rows, size_t cols, int iterations)
+{
+    return diamondFilter(std::move(data), rows, cols, iterations, MaxOp());
+}
+
+std::vector<double> erodeDiamond(std::vector<double> data, size_t rows, size_t cols, int iterations)
+{
+    return diamondFilter(std::move(data), rows, cols, iterations, MinOp());
+}
+
+std::vector<double> dilateSquare(const std::vector<double>& data, size_t rows,
+    size_t cols, int radius)
+{
+    return square(data, rows, cols, radius, MaxOp());
+}
+
+std::vector<double> erodeSquare(const std::vector<double>& data, size_t rows,
+    size_t cols, int radius)
+{
+    return square(data, rows, cols, radius, MinOp());
 }
 
 Eigen::MatrixXd pointViewToEigen(const PointView& view)
 {
     Eigen::MatrixXd matrix(view.size(), 3);
-    for (PointId i = 0; i < view.size(); ++i)
-    {
-        matrix(i, 0) = view.getFieldAs<double>(Dimension::Id::X, i);
-        matrix(i, 1) = view.getFieldAs<double>(Dimension::Id::Y, i);
-        matrix(i, 2) = view.getFieldAs<double>(Dimension::Id::Z, i);
-    }
+
+    // The matrix is column-major, so each column can be filled at once.
+    view.getFieldArray(Dimension::Id::X, 0, view.size(), matrix.col(0).data());
+    view.getFieldArray(Dimension::Id::Y, 0, view.size(), matrix.col(1).data());
+    view.getFieldArray(Dimension::Id::Z, 0, view.size(), matrix.col(2).data());
     return matrix;
 }
 
@@ -103,6 +103,53 @@ PDAL_DLL Eigen::Vector3d computeCentroid(PointView& view,
 PDAL_DLL Eigen::Matrix3f computeCovariance(PointView& view,
     const std::vector<PointId>& ids);
 
+/**
+  Compute the eigenvalues and, optionally, the eigenvectors of the
+  covariance matrix of a collection of points.
+
+  The covariance is accumulated in one pass over the points and the 3x3
+  eigenproblem is solved in closed form, which is much faster than
+  running Eigen::SelfAdjointEigenSolver::compute() on the result of
+  computeCovariance().
+
+  \code
+  Eigen::Vector3f eval;
+  Eigen::Matrix3f evec;
+  if (computeCovarianceEigen(view, ids, eval, &evec))
+      Eigen::Vector3f normal = evec.col(0);
+  \endcode
+
+  \param view the source PointView.
+  \param ids a vector of PointIds specifying a subset of points.
+  \param eigenvalues set to the eigenvalues in increasing order.
+  \param eigenvectors if not null, set to the normalized eigenvectors, one
+    per column in the order of the eigenvalues.
+  \return false if the decomposition couldn't be computed, as when there
+    are fewer than two points.
+*/
+PDAL_DLL bool computeCovarianceEigen(PointView& view,
+    const std::vector<PointId>& ids, Eigen::Vector3f& eigenvalues,
+    Eigen::Matrix3f *eigenvectors = nullptr);
+
+/**
+  Compute the eigenvalues and, optionally, the eigenvectors of the
+  covariance matrix of a collection of points whose coordinates are held
+  in an array, such as the one returned by KD3Index::coords().  This gives
+  the same result as the PointView version but avoids fetching each
+  coordinate from the view.
+
+  \param coords coordinates of the points, X, Y and Z of each in turn.
+  \param ids a vector of PointIds specifying a subset of points.
+  \param eigenvalues set to the eigenvalues in increasing order.
+  \param eigenvectors if not null, set to the normalized eigenvectors, one
+    per column in the order of the eigenvalues.
+  \return false if the decomposition couldn't be computed, as when there
+    are fewer than two points.
+*/
+PDAL_DLL bool computeCovarianceEigen(const double *coords,
+    const std::vector<PointId>& ids, Eigen::Vector3f& eigenvalues,
+    Eigen::Matrix3f *eigenvectors = nullptr);
+
 /**
   Compute second derivative in X direction using central difference method.
 
@@ -207,14 +254,12 @@ PDAL_DLL Eigen::MatrixXd cleanDSM(Eigen::MatrixXd data);
   Compute the rank of a collection of points.
 
   Computes the rank of a collection of points (specified by PointId) sampled
-  from the input PointView. This method uses Eigen's JacobiSVD class to solve
-  the singular value decomposition and to estimate the rank using the given
-  threshold. A singular value will be considered nonzero if its absolute value
-  is greater than the product of the user-supplied threshold and the absolute
-  value of the maximum singular value.
-
-  More on JacobiSVD can be found at
-  https://eigen.tuxfamily.org/dox/classEigen_1_1JacobiSVD.html.
+  from the input PointView. The singular values of the covariance matrix,
+  which are its eigenvalues, are found with computeCovarianceEigen() and the
+  rank is estimated using the given threshold. A singular value will be
+  considered nonzero if its absolute value is greater than the product of the
+  user-supplied threshold and the absolute value of the maximum singular
+  value, as with Eigen's JacobiSVD::rank().
 
   \code
   // build 3D kd-tree
@@ -323,7 +368,9 @@ PDAL_DLL Eigen::MatrixXd matrixOpen(Eigen::MatrixXd data, int radius);
   Performs a morphological dilation of the input raster using a diamond
   structuring element. Larger structuring elements are approximated by applying
   multiple iterations of the opening operation. The input and output rasters are
-  stored in column major order.
+  stored in column major order.  The result is computed directly for the
+  diamond given by all the iterations, so the cost doesn't depend on the
+  number of iterations.
 
   \param data the input raster.
   \param rows the number of rows.
@@ -342,7 +389,9 @@ PDAL_DLL std::vector<double> dilateDiamond(std::vector<double> data,
   Performs a morphological erosion of the input raster using a diamond
   structuring element. Larger structuring elements are approximated by applying
   multiple iterations of the opening operation. The input and output rasters are
-  stored in column major order.
+  stored in column major order.  The result is computed directly for the
+  diamond given by all the iterations, so the cost doesn't depend on the
+  number of iterations.
 
   \param data the input raster.
   \param rows the number of rows.
@@ -355,6 +404,42 @@ PDAL_DLL std::vector<double> erodeDiamond(std::vector<double> data,
                                           size_t rows, size_t cols,
                                           int iterations);
 
+/**
+  Perform a morphological dilation of the input raster.
+
+  Performs a morphological dilation of the input raster using a square
+  structuring element with sides of 2 * radius + 1 cells.  The cost doesn't
+  depend on the radius.  The input and output rasters are stored in column
+  major order.
+
+  \param data the input raster.
+  \param rows the number of rows.
+  \param cols the number of cols.
+  \param radius the radius of the square structuring element.
+  \return the morphological dilation of the input raster.
+*/
+PDAL_DLL std::vector<double> dilateSquare(const std::vector<double>& data,
+                                          size_t rows, size_t cols,
+                                          int radius);
+
+/**
+  Perform a morphological erosion of the input raster.
+
+  Performs a morphological erosion of the input raster using a square
+  structuring element with sides of 2 * radius + 1 cells.  The cost doesn't
+  depend on the radius.  The input and output rasters are stored in column
+  major order.
+
+  \param data the input raster.
+  \param rows the number of rows.
+  \param cols the number of cols.
+  \param radius the radius of the square structuring element.
+  \return the morphological erosion of the input raster.
+*/
+PDAL_DLL std::vector<double> erodeSquare(const std::vector<double>& data,
+                                         size_t rows, size_t cols,
+                                         int radius);
+
 /**
   Pad input matrix symmetrically.
 
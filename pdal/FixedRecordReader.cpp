@@ -0,0 +1,308 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/FixedRecordReader.hpp>
+
+#include <thread>
+
+#include <pdal/PointView.hpp>
+#include <pdal/util/IStream.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+namespace pdal
+{
+
+namespace
+{
+
+// Records are decoded in blocks of this many per thread.
+const point_count_t BlockRecords = 65536;
+
+} // unnamed namespace
+
+
+FixedRecordReader::FixedRecordReader() : m_threads(0), m_bufFirst(0),
+    m_bufCount(0), m_offset(0), m_recordSize(0), m_numRecords(0), m_index(0)
+{}
+
+
+FixedRecordReader::~FixedRecordReader()
+{
+    closeRecords();
+}
+
+
+void FixedRecordReader::addArgs(ProgramArgs& args)
+{
+    args.add("threads", "Number of threads used to decode records.  The "
+        "default is the number of cores.", m_threads);
+}
+
+
+// Records are found by position, so any of them can be read without
+// reading those before it.  The count then limits the positions read
+// rather than the points returned.
+bool FixedRecordReader::restrictSelection(const PointSelection& selection)
+{
+    m_selection = selection;
+    m_selection.m_limit = (std::min)(m_selection.m_limit, m_count);
+    m_count = (std::numeric_limits<point_count_t>::max)();
+    return true;
+}
+
+
+void FixedRecordReader::openRecords(uint64_t offset, size_t size,
+    point_count_t count)
+{
+    closeRecords();
+    if (size == 0)
+        throwError("Invalid record size of 0.");
+
+    m_offset = offset;
+    m_recordSize = size;
+    m_index = 0;
+
+    m_map = FileUtils::mapFile(m_filename);
+    uintmax_t fileSize;
+    if (m_map.addr())
+    {
+        FileUtils::adviseSequential(m_map);
+        fileSize = m_map.m_size;
+    }
+    else
+    {
+        log()->get(LogLevel::Debug) << "Couldn't map '" << m_filename <<
+            "': " << m_map.what() << "  Reading through a stream." <<
+            std::endl;
+        m_stream.reset(new IStream(m_filename));
+        if (!m_stream->good())
+            throwError("Unable to open file '" + m_filename + "'.");
+        fileSize = FileUtils::fileSize(m_filename);
+    }
+
+    const point_count_t available = fileSize > offset ?
+        (point_count_t)((fileSize - offset) / size) : 0;
+    if (count > available)
+    {
+        log()->get(LogLevel::Warning) << "File '" << m_filename <<
+            "' should hold " << count << " records but only holds " <<
+            available << "." << std::endl;
+        count = available;
+    }
+    m_numRecords = count;
+}
+
+
+void FixedRecordReader::closeRecords()
+{
+    if (m_map.addr())
+        FileUtils::unmapFile(m_map);
+    m_stream.reset();
+    m_buf.clear();
+    m_bufFirst = 0;
+    m_bufCount = 0;
+}
+
+
+const char *FixedRecordReader::record(point_count_t idx)
+{
+    return records(idx, 1);
+}
+
+
+// Get a pointer to 'count' consecutive records starting at 'first'.
+const char *FixedRecordReader::records(point_count_t first,
+    point_count_t count)
+{
+    if (m_map.addr())
+        return (const char *)m_map.addr() + m_offset + first * m_recordSize;
+
+    // Read ahead a block so that records read one at a time don't each
+    // go to the stream.
+    if (first < m_bufFirst || first + count > m_bufFirst + m_bufCount)
+    {
+        point_count_t n = (std::max)(count,
+            (std::min)(BlockRecords, m_numRecords - first));
+        m_buf.resize(n * m_recordSize);
+        m_stream->seek(m_offset + first * m_recordSize);
+        m_stream->get(m_buf);
+        if (!m_stream->good())
+            throwError("Unable to read records from '" + m_filename + "'.");
+        m_bufFirst = first;
+        m_bufCount = n;
+    }
+    return m_buf.data() + (first - m_bufFirst) * m_recordSize;
+}
+
+
+void FixedRecordReader::decodeRecords(const char *rec, point_count_t count,
+    PointView& view, PointId begin)
+{
+    PointRef point(view, begin);
+    for (PointId idx = begin; idx < begin + count; ++idx)
+    {
+        point.setPointId(idx);
+        decodeRecord(rec, point);
+        rec += m_recordSize;
+    }
+}
+
+
+point_count_t FixedRecordReader::read(PointViewPtr view, point_count_t count)
+{
+    const size_t threads = m_threads ? m_threads :
+        (std::max)(std::thread::hardware_concurrency(), 1U);
+    if (threads > 1 && !m_pool)
+        m_pool.reset(new ThreadPool(threads, threads, false));
+
+    if (m_selection.m_step > 1)
+        return readSelected(*view, count);
+
+    // A selection with a step of one is a range of records.
+    const point_count_t last = (std::min)(m_numRecords, m_selection.m_limit);
+    m_index = (std::max)(m_index, m_selection.m_offset);
+    if (m_index >= last)
+        return 0;
+    count = (std::min)(count, last - m_index);
+    const point_count_t blockRecords = BlockRecords * threads;
+    point_count_t numRead = 0;
+    while (numRead < count)
+    {
+        const point_count_t n = (std::min)(blockRecords, count - numRead);
+        const char *rec = records(m_index, n);
+        const PointId begin = view->size();
+        if (m_pool && n > 1)
+            decodeParallel(rec, n, *view);
+        else
+        {
+            for (PointId idx = begin; idx < begin + n; ++idx)
+                view->getOrAddPoint(idx);
+            decodeRecords(rec, n, *view, begin);
+        }
+
+        if (m_cb)
+            for (PointId idx = begin; idx < begin + n; ++idx)
+                m_cb(*view, idx);
+        m_index += n;
+        numRead += n;
+    }
+    return numRead;
+}
+
+
+// Decode the records of a selection one at a time.
+point_count_t FixedRecordReader::readSelected(PointView& view,
+    point_count_t count)
+{
+    point_count_t last = (std::min)(m_numRecords, m_selection.m_limit);
+    if (m_index < last && count < last - m_index)
+        last = m_index + count;
+
+    point_count_t numRead = 0;
+    while ((m_index = m_selection.next(m_index)) < last)
+    {
+        const PointId idx = view.size();
+        view.getOrAddPoint(idx);
+        PointRef point(view, idx);
+        decodeRecord(record(m_index), point);
+        if (m_cb)
+            m_cb(view, idx);
+        m_index++;
+        numRead++;
+    }
+    return numRead;
+}
+
+
+// Decode a block of records in a range per thread.  Each range is decoded
+// into its own view, whose points are then appended to the destination
+// view without being copied.
+void FixedRecordReader::decodeParallel(const char *rec, point_count_t count,
+    PointView& view)
+{
+    const size_t pieces = (size_t)(std::min)((point_count_t)m_pool->size(),
+        count);
+    std::vector<PointViewPtr> views;
+    std::vector<std::string> errors(pieces);
+    for (size_t p = 0; p < pieces; ++p)
+    {
+        const point_count_t first = count * p / pieces;
+        const point_count_t last = count * (p + 1) / pieces;
+
+        PointViewPtr v = view.makeNew();
+        for (PointId idx = 0; idx < last - first; ++idx)
+            v->getOrAddPoint(idx);
+        views.push_back(v);
+
+        m_pool->add([this, rec, first, &views, &errors, p]()
+        {
+            try
+            {
+                decodeRecords(rec + first * m_recordSize, views[p]->size(),
+                    *views[p], 0);
+            }
+            catch (const std::exception& err)
+            {
+                errors[p] = err.what();
+            }
+        });
+    }
+    m_pool->await();
+
+    for (const std::string& err : errors)
+        if (err.size())
+            throwError(err);
+    for (PointViewPtr& v : views)
+        view.append(*v);
+}
+
+
+bool FixedRecordReader::processOne(PointRef& point)
+{
+    m_index = m_selection.next(m_index);
+    if (m_index >= m_numRecords || m_index >= m_selection.m_limit)
+        return false;
+    decodeRecord(record(m_index), point);
+    m_index++;
+    return true;
+}
+
+
+void FixedRecordReader::done(PointTableRef)
+{
+    m_pool.reset();
+    closeRecords();
+}
+
+} // namespace pdal
@@ -0,0 +1,144 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <pdal/Reader.hpp>
+#include <pdal/Streamable.hpp>
+#include <pdal/util/FileUtils.hpp>
+
+namespace pdal
+{
+
+class IStream;
+class ThreadPool;
+
+/**
+  Base for readers of files made of fixed-size binary records, one record
+  per point.  The file is mapped into memory when possible and ranges of
+  records are decoded on several threads in standard mode.  Derived
+  readers open the records in ready() and decode them in decodeRecord()
+  or, when decoding a batch at once is cheaper, in decodeRecords().
+*/
+class PDAL_DLL FixedRecordReader : public Reader, public Streamable
+{
+protected:
+    FixedRecordReader();
+    ~FixedRecordReader();
+
+    virtual void addArgs(ProgramArgs& args);
+    virtual bool restrictSelection(const PointSelection& selection);
+    virtual void done(PointTableRef table);
+
+    /**
+      Open the records of the file for reading.
+
+      \param offset  Position of the first record in the file.
+      \param size  Size of a record in bytes.
+      \param count  Number of records.
+    */
+    void openRecords(uint64_t offset, size_t size, point_count_t count);
+
+    /**
+      Release the mapping or stream opened by openRecords().
+    */
+    void closeRecords();
+
+    /**
+      Get a pointer to record \ref idx.  The pointer is only valid until
+      another record is requested.
+    */
+    const char *record(point_count_t idx);
+
+    /**
+      Get the number of records opened by openRecords().
+    */
+    point_count_t numRecords() const
+        { return m_numRecords; }
+
+    /**
+      Get the index of the next record to be read.
+    */
+    point_count_t recordIndex() const
+        { return m_index; }
+
+    /**
+      Decode one record into a point.
+
+      \param rec  Start of the record.
+      \param point  Point to fill.
+    */
+    virtual void decodeRecord(const char *rec, PointRef& point) = 0;
+
+    /**
+      Decode consecutive records into consecutive points of a view.  Ranges
+      of records are decoded at the same time on several threads, each
+      into its own view, so this must only write to the points it's given.
+      The default decodes each record with decodeRecord().
+
+      \param rec  Start of the first record.
+      \param count  Number of records.
+      \param view  View to fill.  Its points already exist.
+      \param begin  Index of the point for the first record.
+    */
+    virtual void decodeRecords(const char *rec, point_count_t count,
+        PointView& view, PointId begin);
+
+private:
+    size_t m_threads;
+    std::unique_ptr<ThreadPool> m_pool;
+    FileUtils::MapContext m_map;
+    std::unique_ptr<IStream> m_stream;
+    std::vector<char> m_buf;
+    point_count_t m_bufFirst;
+    point_count_t m_bufCount;
+    uint64_t m_offset;
+    size_t m_recordSize;
+    point_count_t m_numRecords;
+    point_count_t m_index;
+    PointSelection m_selection;
+
+    virtual point_count_t read(PointViewPtr view, point_count_t count);
+    point_count_t readSelected(PointView& view, point_count_t count);
+    virtual bool processOne(PointRef& point);
+
+    const char *records(point_count_t first, point_count_t count);
+    void decodeParallel(const char *rec, point_count_t count,
+        PointView& view);
+};
+
+} // namespace pdal
@@ -33,8 +33,12 @@
 
 #pragma once
 
+#include <map>
+#include <memory>
+
 #include <pdal/PDALUtils.hpp>
 #include <pdal/Scaling.hpp>
+#include <pdal/StageFactory.hpp>
 #include <pdal/Writer.hpp>
 
 namespace pdal
@@ -43,7 +47,7 @@ namespace pdal
 class PDAL_DLL FlexWriter : public Writer
 {
 protected:
-    FlexWriter() : m_filenum(1)
+    FlexWriter() : m_filenum(1), m_table(nullptr), m_serialFiles(false)
     {}
 
     std::string m_filename;
@@ -61,7 +65,25 @@ protected:
         }
     }
 
+    // Create an output file.  Data for a local file is written on a
+    // background thread so that slow storage doesn't stall the writer.
+    std::ostream *createFile(const std::string& filename)
+    {
+        return Utils::createFile(filename, true, true);
+    }
+
 private:
+    // The file to which a view is written and, when files are written
+    // concurrently, the copy of this stage that writes it.
+    struct ViewFile
+    {
+        ViewFile() : m_writer(nullptr)
+        {}
+
+        std::string m_filename;
+        FlexWriter *m_writer;
+    };
+
     std::string::size_type m_hashPos;
 
     virtual void writerInitialize(PointTableRef table)
@@ -93,9 +115,73 @@ private:
     virtual bool srsOverridden() const
     { return false; }
 
+    // Separate output files are written concurrently by copies of this
+    // stage, so views can be run concurrently when the filename is a
+    // template.
+    virtual bool viewsRunConcurrently() const
+    { return m_hashPos != std::string::npos && !m_serialFiles; }
+
+    // Make a prepared and readied copy of this stage for each file that
+    // will be written.  If a copy can't be made, the files are written
+    // one at a time.
+    void makeCopies()
+    {
+        m_copyFactory.reset(new StageFactory);
+        try
+        {
+            for (auto& vf : m_viewFiles)
+            {
+                FlexWriter *w =
+                    dynamic_cast<FlexWriter *>(&clone(*m_copyFactory));
+                if (!w)
+                    throw pdal_error("Copy isn't a FlexWriter.");
+                // The inputs are only used to describe the pipeline.
+                for (Stage *in : getInputs())
+                    w->setInput(*in);
+                prepareCopy(*w, *m_table);
+                w->readyTable(*m_table);
+                vf.second.m_writer = w;
+            }
+        }
+        catch (const pdal_error& err)
+        {
+            log()->get(LogLevel::Debug) << getName() << ": Can't write "
+                "files concurrently: " << err.what() << std::endl;
+            for (auto& vf : m_viewFiles)
+                vf.second.m_writer = nullptr;
+            m_copyFactory.reset();
+            m_serialFiles = true;
+        }
+    }
+
+    // Finish the copies and merge their metadata into ours in the order
+    // the files would have been written by this stage.
+    void doneCopies(PointTableRef table)
+    {
+        for (auto& vf : m_viewFiles)
+        {
+            FlexWriter *w = vf.second.m_writer;
+            if (!w)
+                continue;
+            w->doneTable(table);
+            for (const MetadataNode& n : w->getMetadata().children())
+            {
+                if (n.kind() == MetadataType::Array)
+                    m_metadata.addList(n);
+                else
+                    m_metadata.add(n);
+            }
+            countIoBytes(w->profile().ioBytes());
+        }
+        m_viewFiles.clear();
+        m_copyFactory.reset();
+        m_serialFiles = false;
+    }
+
     virtual void ready(PointTableRef table) final
     {
         readyTable(table);
+        m_table = &table;
 
         // Ready the file if we're writing a single file.
         if (m_hashPos == std::string::npos)
@@ -113,33 +199,62 @@ private:
         // If the output is a consolidation of all views, call
         // prerun with all views.
         if (m_hashPos == std::string::npos)
+        {
             prerunFile(views);
+            return;
+        }
+
+        // Number the files in the order the views are passed so that the
+        // names don't depend on the order in which the files are written.
+        m_viewFiles.clear();
+        for (const PointViewPtr& v : views)
+            if (v->size())
+                m_viewFiles[v->id()].m_filename = generateFilename();
+        if (viewThreads() > 1)
+            makeCopies();
     }
 
     // This essentially moves ready() and done() into write(), which means
     // that they get executed once for each view.  The check for m_hashPos
     // is a test to see if the filename specification is a template.  If it's
     // not a template, ready() and done() are taken care of in the ready()
-    // and done() functions in this class.
+    // and done() functions in this class.  When views are run concurrently,
+    // each file is written by its own copy of the stage.
     virtual void write(const PointViewPtr view) final
     {
-        if (m_hashPos != std::string::npos)
+        if (m_hashPos == std::string::npos)
         {
-            if (view->size() == 0)
-                return;
-            // Ready the file - we're writing each view separately.
-            readyFile(generateFilename(), view->spatialReference());
-            prerunFile({view});
+            writeView(view);
+            return;
         }
-        writeView(view);
-        if (m_hashPos != std::string::npos)
-            doneFile();
+        if (view->size() == 0)
+            return;
+
+        FlexWriter *w = this;
+        std::string filename;
+        auto it = m_viewFiles.find(view->id());
+        if (it != m_viewFiles.end())
+        {
+            filename = it->second.m_filename;
+            if (it->second.m_writer)
+                w = it->second.m_writer;
+        }
+        else
+            filename = generateFilename();
+
+        // Ready the file - we're writing each view separately.
+        w->readyFile(filename, view->spatialReference());
+        w->prerunFile({view});
+        w->writeView(view);
+        w->doneFile();
     }
 
     virtual void done(PointTableRef table) final
     {
         if (m_hashPos == std::string::npos)
             doneFile();
+        else
+            doneCopies(table);
         doneTable(table);
     }
 
@@ -160,6 +275,10 @@ private:
     {}
 
     size_t m_filenum;
+    BasePointTable *m_table;
+    bool m_serialFiles;
+    std::map<int, ViewFile> m_viewFiles;
+    std::unique_ptr<StageFactory> m_copyFactory;
 
     FlexWriter& operator=(const FlexWriter&); // not implemented
     FlexWriter(const FlexWriter&); // not implemented
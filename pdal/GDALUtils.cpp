@@ -37,8 +37,12 @@
 #include <pdal/util/Algorithm.hpp>
 #include <pdal/util/Utils.hpp>
 
+#include <algorithm>
+#include <cmath>
 #include <functional>
+#include <list>
 #include <map>
+#include <unordered_map>
 
 #include <ogr_spatialref.h>
 #include <ogr_p.h>
@@ -195,6 +199,113 @@ std::string lastError()
 }
 
 
+namespace
+{
+
+// Coordinate transformations that aren't in use, by source and
+// destination WKT.
+class TransformCache
+{
+public:
+    OGRCoordinateTransformationH acquire(const std::string& src,
+        const std::string& dst)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_idle.find(Key(src, dst));
+            if (it != m_idle.end() && it->second.size())
+            {
+                OGRCoordinateTransformationH t = it->second.back();
+                it->second.pop_back();
+                return t;
+            }
+        }
+
+        // The transformation keeps its own copies of the references.
+        OGRSpatialReferenceH srcRef = OSRNewSpatialReference(src.c_str());
+        OGRSpatialReferenceH dstRef = OSRNewSpatialReference(dst.c_str());
+        OGRCoordinateTransformationH t = nullptr;
+        if (srcRef && dstRef)
+            t = OCTNewCoordinateTransformation(srcRef, dstRef);
+        if (srcRef)
+            OSRDestroySpatialReference(srcRef);
+        if (dstRef)
+            OSRDestroySpatialReference(dstRef);
+        return t;
+    }
+
+    void release(const std::string& src, const std::string& dst,
+        OGRCoordinateTransformationH t)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            Key key(src, dst);
+            // Forget everything rather than grow without bound when many
+            // different pairs of references are used.
+            if (m_idle.size() >= MaxPairs && !m_idle.count(key))
+                clear();
+            std::vector<OGRCoordinateTransformationH>& idle = m_idle[key];
+            if (idle.size() < MaxIdle)
+            {
+                idle.push_back(t);
+                return;
+            }
+        }
+        OCTDestroyCoordinateTransformation(t);
+    }
+
+private:
+    typedef std::pair<std::string, std::string> Key;
+
+    void clear()
+    {
+        for (auto& idle : m_idle)
+            for (OGRCoordinateTransformationH t : idle.second)
+                OCTDestroyCoordinateTransformation(t);
+        m_idle.clear();
+    }
+
+    static const size_t MaxPairs = 64;
+    static const size_t MaxIdle = 64;
+    std::mutex m_mutex;
+    std::map<Key, std::vector<OGRCoordinateTransformationH>> m_idle;
+};
+
+// Never destroyed, since transformations can be released while static
+// objects are destroyed at exit.
+TransformCache& transformCache()
+{
+    static TransformCache *cache = new TransformCache;
+    return *cache;
+}
+
+} // unnamed namespace
+
+
+/**
+  Get a coordinate transformation from a process-wide cache.  A
+  transformation can't be used by more than one thread at a time, so the
+  caller has it to itself until the returned pointer is released.  It then
+  goes back to the cache, so that creating another transformation between
+  the same references is nearly free.
+
+  \param srcWkt  WKT of the source spatial reference.
+  \param dstWkt  WKT of the destination spatial reference.
+  eturn  Pointer to an OGRCoordinateTransformationH, or a null pointer if
+    the transformation can't be created.
+*/
+std::shared_ptr<void> cachedTransform(const std::string& srcWkt,
+    const std::string& dstWkt)
+{
+    OGRCoordinateTransformationH t =
+        transformCache().acquire(srcWkt, dstWkt);
+    if (!t)
+        return std::shared_ptr<void>();
+    return std::shared_ptr<void>(t, [srcWkt, dstWkt](void *t)
+        { transformCache().release(srcWkt, dstWkt, t); });
+}
+
+
 static ErrorHandler* s_gdalErrorHandler= 0;
 
 void registerDrivers()
@@ -623,6 +734,99 @@ GDALError Raster::computePDALDimensionTypes()
 }
 
 
+// Blocks of bands read through the cache, the most recently used first.
+struct Raster::BlockCache
+{
+    struct Block
+    {
+        uint64_t m_key;
+        int m_width;
+        std::vector<double> m_values;
+    };
+    typedef std::list<Block> BlockList;
+
+    BlockList m_blocks;
+    std::unordered_map<uint64_t, BlockList::iterator> m_index;
+};
+
+
+GDALError Raster::checkBand(int band)
+{
+    if (!m_ds)
+    {
+        m_errorMsg = "Raster not open.";
+        return GDALError::NotOpen;
+    }
+    if (band < 1 || band > m_numBands)
+    {
+        m_errorMsg = "Band " + std::to_string(band) + " is not in raster '" +
+            m_filename + "'.";
+        return GDALError::InvalidBand;
+    }
+    return GDALError::None;
+}
+
+
+// Read the value of a band at a cell of the raster, reading the block
+// that holds it if it isn't cached.
+GDALError Raster::cachedValue(int band, int32_t pixel, int32_t line,
+    double& value)
+{
+    GDALRasterBandH b = GDALGetRasterBand(m_ds, band);
+    int blockWidth, blockHeight;
+    GDALGetBlockSize(b, &blockWidth, &blockHeight);
+    uint64_t blockCols = (m_width + blockWidth - 1) / blockWidth;
+    uint64_t blockRows = (m_height + blockHeight - 1) / blockHeight;
+    int col = pixel / blockWidth;
+    int row = line / blockHeight;
+    uint64_t key = ((band - 1) * blockRows + row) * blockCols + col;
+
+    if (!m_cache)
+        m_cache.reset(new BlockCache);
+    BlockCache::BlockList& blocks = m_cache->m_blocks;
+    if (blocks.empty() || blocks.front().m_key != key)
+    {
+        auto it = m_cache->m_index.find(key);
+        if (it != m_cache->m_index.end())
+            blocks.splice(blocks.begin(), blocks, it->second);
+        else
+        {
+            // Blocks at the right and bottom edges may be partial.
+            int xOff = col * blockWidth;
+            int yOff = row * blockHeight;
+            int width = (std::min)(blockWidth, m_width - xOff);
+            int height = (std::min)(blockHeight, m_height - yOff);
+
+            BlockCache::Block block;
+            block.m_key = key;
+            block.m_width = width;
+            block.m_values.resize((size_t)width * height);
+            if (GDALRasterIO(b, GF_Read, xOff, yOff, width, height,
+                block.m_values.data(), width, height, GDT_Float64, 0, 0) !=
+                CE_None)
+            {
+                m_errorMsg = "Unable to read block for raster '" +
+                    m_filename + "'.";
+                return GDALError::CantReadBlock;
+            }
+
+            blocks.push_front(std::move(block));
+            m_cache->m_index[key] = blocks.begin();
+            if (blocks.size() > m_cacheBlocks)
+            {
+                m_cache->m_index.erase(blocks.back().m_key);
+                blocks.pop_back();
+            }
+        }
+    }
+
+    const BlockCache::Block& block = blocks.front();
+    value = block.m_values[(size_t)(line - row * blockHeight) *
+        block.m_width + (pixel - col * blockWidth)];
+    return GDALError::None;
+}
+
+
 GDALError Raster::read(double x, double y, std::vector<double>& data)
 {
     if (!m_ds)
@@ -635,8 +839,6 @@ GDALError Raster::read(double x, double y, std::vector<double>& data)
     int32_t line(0);
     data.resize(m_numBands);
 
-    std::array<double, 2> pix = { {0.0, 0.0} };
-
     // No data at this x,y if we can't compute a pixel/line location
     // for it.
     if (!getPixelAndLinePosition(x, y, pixel, line))
@@ -645,17 +847,135 @@ GDALError Raster::read(double x, double y, std::vector<double>& data)
         return GDALError::NoData;
     }
 
-    for (int i=0; i < m_numBands; ++i)
+    for (int i = 0; i < m_numBands; ++i)
+    {
+        GDALError err = cachedValue(i + 1, pixel, line, data[i]);
+        if (err != GDALError::None)
+            return err;
+    }
+    return GDALError::None;
+}
+
+
+GDALError Raster::read(const std::vector<double>& x,
+    const std::vector<double>& y, int band, std::vector<double>& values,
+    std::vector<bool>& found)
+{
+    GDALError err = checkBand(band);
+    if (err != GDALError::None)
+        return err;
+
+    const size_t count = x.size();
+    values.resize(count);
+    found.assign(count, false);
+
+    // Order the positions in the raster by block, then by position, so
+    // each block is only needed once.
+    GDALRasterBandH b = GDALGetRasterBand(m_ds, band);
+    int blockWidth, blockHeight;
+    GDALGetBlockSize(b, &blockWidth, &blockHeight);
+    const uint64_t blockCols = (m_width + blockWidth - 1) / blockWidth;
+
+    struct Cell
     {
-        GDALRasterBandH b = GDALGetRasterBand(m_ds, i + 1);
-        if (GDALRasterIO(b, GF_Read, pixel, line, 1, 1,
-            &pix[0], 1, 1, GDT_Float64, 0, 0) == CE_None)
+        uint64_t m_block;
+        size_t m_pos;
+        int32_t m_pixel;
+        int32_t m_line;
+    };
+    std::vector<Cell> cells;
+    cells.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        Cell c;
+        if (getPixelAndLinePosition(x[i], y[i], c.m_pixel, c.m_line))
         {
-            // we read a pixel put its values in our vector
-            data[i] = pix[0];
+            c.m_block = (uint64_t)(c.m_line / blockHeight) * blockCols +
+                c.m_pixel / blockWidth;
+            c.m_pos = i;
+            cells.push_back(c);
         }
     }
+    std::sort(cells.begin(), cells.end(), [](const Cell& c1, const Cell& c2)
+        { return c1.m_block < c2.m_block ||
+            (c1.m_block == c2.m_block && c1.m_pos < c2.m_pos); });
+
+    for (const Cell& c : cells)
+    {
+        err = cachedValue(band, c.m_pixel, c.m_line, values[c.m_pos]);
+        if (err != GDALError::None)
+            return err;
+        found[c.m_pos] = true;
+    }
+    return GDALError::None;
+}
+
+
+GDALError Raster::readWindow(int band, int x, int y, int width, int height,
+    std::vector<double>& data)
+{
+    GDALError err = checkBand(band);
+    if (err != GDALError::None)
+        return err;
+
+    if (x < 0 || y < 0 || width < 0 || height < 0 ||
+        x + width > m_width || y + height > m_height)
+    {
+        m_errorMsg = "Requested window is not in the raster.";
+        return GDALError::NoData;
+    }
+
+    data.resize((size_t)width * height);
+    if (data.empty())
+        return GDALError::None;
+    if (GDALRasterIO(GDALGetRasterBand(m_ds, band), GF_Read, x, y,
+        width, height, data.data(), width, height, GDT_Float64, 0, 0) !=
+        CE_None)
+    {
+        m_errorMsg = "Unable to read window for raster '" + m_filename + "'.";
+        return GDALError::CantReadBlock;
+    }
+    return GDALError::None;
+}
+
 
+GDALError Raster::blockSize(int band, int& width, int& height)
+{
+    GDALError err = checkBand(band);
+    if (err != GDALError::None)
+        return err;
+
+    GDALGetBlockSize(GDALGetRasterBand(m_ds, band), &width, &height);
+    return GDALError::None;
+}
+
+
+GDALError Raster::readValue(double x, double y, int band, double& value)
+{
+    GDALError err = checkBand(band);
+    if (err != GDALError::None)
+        return err;
+
+    int32_t pixel(0);
+    int32_t line(0);
+    if (!getPixelAndLinePosition(x, y, pixel, line))
+    {
+        m_errorMsg = "Requested location is not in the raster.";
+        return GDALError::NoData;
+    }
+
+    err = cachedValue(band, pixel, line, value);
+    if (err != GDALError::None)
+        return err;
+
+    int hasNoData(0);
+    double noData =
+        GDALGetRasterNoDataValue(GDALGetRasterBand(m_ds, band), &hasNoData);
+    if ((hasNoData && value == noData) || std::isnan(value))
+    {
+        m_errorMsg = "Requested location holds no data.";
+        return GDALError::NoData;
+    }
     return GDALError::None;
 }
 
@@ -681,6 +1001,7 @@ void Raster::close()
     GDALClose(m_ds);
     m_ds = nullptr;
     m_types.clear();
+    m_cache.reset();
 }
 
 } // namespace gdal
@@ -41,8 +41,10 @@
 
 #include <pdal/Log.hpp>
 
+#include <algorithm>
 #include <array>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <sstream>
 #include <vector>
@@ -74,6 +76,8 @@ PDAL_DLL bool reprojectBounds(BOX3D& box, const std::string& srcSrs,
 PDAL_DLL bool reprojectBounds(BOX2D& box, const std::string& srcSrs,
     const std::string& dstSrs);
 PDAL_DLL std::string lastError();
+PDAL_DLL std::shared_ptr<void> cachedTransform(const std::string& srcWkt,
+    const std::string& dstWkt);
 
 typedef std::shared_ptr<void> RefPtr;
 
@@ -489,21 +493,7 @@ private:
             auto si = sourceBegin + (wholeRowElts + partialRowElts);
             std::transform(si, si + m_xBlockSize, di,
                 [srcNoData, dstNoData](ITER_VAL<SOURCE_ITER> s){
-                    T t;
-
-                    if (srcNoData == s ||
-                        (std::isnan(srcNoData) && std::isnan(s)))
-                        t = dstNoData;
-                    else
-                    {
-                        if (!Utils::numericCast(s, t))
-                        {
-                        throw CantWriteBlock("Unable to convert data for "
-                            "raster type as requested: " + Utils::toString(s) +
-                            " -> " + Utils::typeidName<T>());
-                        }
-                    }
-                    return t;
+                    return convert(s, srcNoData, dstNoData);
                 });
 
             // Blocks are always full-sized, even if only some of the data
@@ -514,6 +504,50 @@ private:
             throw CantWriteBlock();
     }
 
+    /*
+      Write a window of the band from linearized data covering just the
+      window.
+
+      \param x  Column of the upper-left cell of the window.
+      \param y  Row of the upper-left cell of the window.
+      \param width  Width of the window in cells.
+      \param height  Height of the window in cells.
+      \param si  Iterator to the window data, row-major ordered.
+      \param srcNoData  No-data value in the source data.
+    */
+    template <typename SOURCE_ITER>
+    void writeWindow(int x, int y, int width, int height, SOURCE_ITER si,
+        ITER_VAL<SOURCE_ITER> srcNoData)
+    {
+        T dstNoData = getNoData();
+        std::vector<T> buf(width * height);
+        std::transform(si, si + buf.size(), buf.begin(),
+            [srcNoData, dstNoData](ITER_VAL<SOURCE_ITER> s){
+                return convert(s, srcNoData, dstNoData);
+            });
+        if (m_band->RasterIO(GF_Write, x, y, width, height, buf.data(),
+                width, height, m_band->GetRasterDataType(), 0, 0) != CE_None)
+            throw CantWriteBlock();
+    }
+
+    // Convert a source value to the band type, mapping the source no-data
+    // value to the destination no-data value.
+    template <typename S>
+    static T convert(S s, S srcNoData, T dstNoData)
+    {
+        T t;
+
+        if (srcNoData == s || (std::isnan(srcNoData) && std::isnan(s)))
+            t = dstNoData;
+        else if (!Utils::numericCast(s, t))
+        {
+            throw CantWriteBlock("Unable to convert data for "
+                "raster type as requested: " + Utils::toString(s) +
+                " -> " + Utils::typeidName<T>());
+        }
+        return t;
+    }
+
     void statistics(double* minimum, double* maximum,
                     double* mean, double* stddev,
                     int bApprox, int bForce) const
@@ -620,7 +654,7 @@ public:
         catch (CantReadBlock)
         {
             std::ostringstream oss;
-            oss << "Unable to read block for for raster '" << m_filename <<
+            oss << "Unable to read block for raster '" << m_filename <<
                 "'.";
             m_errorMsg = oss.str();
             return GDALError::CantReadBlock;
@@ -691,7 +725,85 @@ public:
         catch (CantWriteBlock err)
         {
             std::ostringstream oss;
-            oss << "Unable to write block for for raster '" << m_filename <<
+            oss << "Unable to write block for raster '" << m_filename <<
+                "'.";
+            if (err.what.size())
+                oss << "\n" << err.what;
+            m_errorMsg = oss.str();
+            return GDALError::CantWriteBlock;
+        }
+        return GDALError::None;
+    }
+
+    /**
+      Write a window of a raster band.  The data covers just the window.
+
+      \param data  Linearized window data to be written, row-major ordered.
+      \param noData  No-data value in the source data.
+      \param nBand  Band number to write.
+      \param x  Column of the upper-left cell of the window.
+      \param y  Row of the upper-left cell of the window.
+      \param width  Width of the window in cells.
+      \param height  Height of the window in cells.
+      \param name  Name of the raster band.
+    */
+    template<typename SOURCE_ITER>
+    GDALError writeWindow(SOURCE_ITER si, ITER_VAL<SOURCE_ITER> srcNoData,
+        int nBand, int x, int y, int width, int height,
+        const std::string& name = "")
+    {
+        try
+        {
+            switch(m_bandType)
+            {
+                case Dimension::Type::Unsigned8:
+                    writeWindowAs<uint8_t>(si, srcNoData, nBand, x, y,
+                        width, height, name);
+                    break;
+                case Dimension::Type::Signed8:
+                    writeWindowAs<int8_t>(si, srcNoData, nBand, x, y,
+                        width, height, name);
+                    break;
+                case Dimension::Type::Unsigned16:
+                    writeWindowAs<uint16_t>(si, srcNoData, nBand, x, y,
+                        width, height, name);
+                    break;
+                case Dimension::Type::Signed16:
+                    writeWindowAs<int16_t>(si, srcNoData, nBand, x, y,
+                        width, height, name);
+                    break;
+                case Dimension::Type::Unsigned32:
+                    writeWindowAs<uint32_t>(si, srcNoData, nBand, x, y,
+                        width, height, name);
+                    break;
+                case Dimension::Type::Signed32:
+                    writeWindowAs<int32_t>(si, srcNoData, nBand, x, y,
+                        width, height, name);
+                    break;
+                case Dimension::Type::Unsigned64:
+                    writeWindowAs<uint64_t>(si, srcNoData, nBand, x, y,
+                        width, height, name);
+                    break;
+                case Dimension::Type::Signed64:
+                    writeWindowAs<int64_t>(si, srcNoData, nBand, x, y,
+                        width, height, name);
+                    break;
+                case Dimension::Type::Float:
+                    writeWindowAs<float>(si, srcNoData, nBand, x, y,
+                        width, height, name);
+                    break;
+                case Dimension::Type::Double:
+                    writeWindowAs<double>(si, srcNoData, nBand, x, y,
+                        width, height, name);
+                    break;
+                case Dimension::Type::None:
+                    throw CantWriteBlock();
+            }
+        }
+        catch (CantWriteBlock err)
+        {
+            std::ostringstream oss;
+            oss << "Unable to write window for raster '" << m_filename <<
                 "'.";
             if (err.what.size())
                 oss << "\n" << err.what;
@@ -704,6 +816,7 @@ public:
     /**
       Read the data for each band at x/y into a vector of doubles.  x and y
       are transformed to the basis of the raster before the data is fetched.
+      Blocks are cached as for \ref readValue().
 
       \param x  X position to read
       \param y  Y position to read
@@ -711,6 +824,76 @@ public:
     */
     GDALError read(double x, double y, std::vector<double>& data);
 
+    /**
+      Read the values of one band at many x/y positions.  The positions are
+      visited block by block, so each block of the band is read at most
+      once, however the positions are ordered.  As with
+      \ref read(double, double, std::vector<double>&), cells that hold the
+      no-data value are read like any others.
+
+      \param x  X positions to read
+      \param y  Y positions to read.  Must be the same size as \ref x.
+      \param band  Band to read (count from 1)
+      \param[out] values  Value of the band at each position.  Values of
+        positions that aren't in the raster are left unchanged.
+      \param[out] found  Whether each position is in the raster.
+      \return  Error code or GDALError::None.
+    */
+    GDALError read(const std::vector<double>& x, const std::vector<double>& y,
+        int band, std::vector<double>& values, std::vector<bool>& found);
+
+    /**
+      Read the value of one band at x/y.  x and y are transformed to the
+      basis of the raster before the data is fetched.  The blocks of the
+      band that were used most recently are kept in memory, so reading
+      nearby positions one after another doesn't go through GDAL for each
+      of them.
+
+      \param x  X position to read
+      \param y  Y position to read
+      \param band  Band to read (count from 1)
+      \param[out] value  Value of the band at x/y.
+      \return  GDALError::NoData if x/y isn't in the raster or the cell
+        holds the band's no-data value.
+    */
+    GDALError readValue(double x, double y, int band, double& value);
+
+    /**
+      Read a window of one band into a vector of doubles.  Reading whole
+      rows of the band's natural blocks (see \ref blockSize()) is cheapest.
+
+      \param band  Band to read (count from 1)
+      \param x  Column of the upper-left cell of the window.
+      \param y  Row of the upper-left cell of the window.
+      \param width  Width of the window in cells.
+      \param height  Height of the window in cells.
+      \param[out] data  Values of the window, row-major ordered.  The vector
+        is resized to hold them.
+      \return  Error code or GDALError::None.
+    */
+    GDALError readWindow(int band, int x, int y, int width, int height,
+        std::vector<double>& data);
+
+    /**
+      Get the size of the natural blocks of a band, the units in which GDAL
+      reads and caches the band's data.
+
+      \param band  Band (count from 1)
+      \param[out] width  Width of a block in cells.
+      \param[out] height  Height of a block in cells.
+      \return  Error code or GDALError::None.
+    */
+    GDALError blockSize(int band, int& width, int& height);
+
+    /**
+      Set the maximum number of blocks that the read functions keep in
+      memory.
+
+      \param count  Number of blocks.  At least one block is kept.
+    */
+    void setCacheBlocks(size_t count)
+        { m_cacheBlocks = (std::max)(count, (size_t)1); }
+
     /**
       Get a vector of dimensions that map to the bands of a raster.
     */
@@ -827,10 +1010,26 @@ private:
     mutable std::vector<pdal::Dimension::Type> m_types;
     std::vector<std::array<double, 2>> m_block_sizes;
 
+    struct BlockCache;
+    std::shared_ptr<BlockCache> m_cache;
+    size_t m_cacheBlocks = 64;
+
+    template<typename T, typename SOURCE_ITER>
+    void writeWindowAs(SOURCE_ITER si, ITER_VAL<SOURCE_ITER> srcNoData,
+        int nBand, int x, int y, int width, int height,
+        const std::string& name)
+    {
+        Band<T>(m_ds, nBand, m_dstNoData, name).
+            writeWindow(x, y, width, height, si, srcNoData);
+    }
+
     GDALError validateType(Dimension::Type& type, GDALDriver *driver);
     bool getPixelAndLinePosition(double x, double y,
         int32_t& pixel, int32_t& line);
     GDALError computePDALDimensionTypes();
+    GDALError checkBand(int band);
+    GDALError cachedValue(int band, int32_t pixel, int32_t line,
+        double& value);
 };
 
 
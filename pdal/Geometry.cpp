@@ -104,13 +104,17 @@ void Geometry::update(const std::string& wkt_or_json)
     if (m_geom)
         newGeom->assignSpatialReference(m_geom->getSpatialReference());
     m_geom.reset(newGeom);
+    modified();
 }
 
 
 Geometry& Geometry::operator=(const Geometry& input)
 {
     if (m_geom != input.m_geom)
+    {
         *m_geom = *input.m_geom;
+        modified();
+    }
     return *this;
 }
 
@@ -138,6 +142,7 @@ void Geometry::transform(const SpatialReference& ref) const
         input, &output);
     m_geom->transform(xform);
     delete xform;
+    modified();
 }
 
 
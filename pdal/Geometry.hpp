@@ -81,6 +81,11 @@ public:
 protected:
     std::unique_ptr<OGRGeometry> m_geom;
 
+    // Called when the geometry in m_geom has been changed so that derived
+    // classes can discard anything computed from it.
+    virtual void modified() const
+    {}
+
     friend PDAL_DLL std::ostream& operator<<(std::ostream& ostr,
         const Geometry& p);
     friend PDAL_DLL std::istream& operator>>(std::istream& istr,
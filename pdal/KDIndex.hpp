@@ -34,11 +34,17 @@
 
 #pragma once
 
+#include <cstdio>
+#include <cstring>
+#include <functional>
 #include <memory>
+#include <thread>
 
 #include <nanoflann/nanoflann.hpp>
 
 #include <pdal/PointView.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 namespace nanoflann
 {
@@ -72,13 +78,191 @@ public:
     template <class BBOX> bool kdtree_get_bbox(BBOX& bb) const;
     void build()
     {
+        loadCoords();
         m_index.reset(new my_kd_tree_t(DIM, *this,
-            nanoflann::KDTreeSingleIndexAdaptorParams(100)));
+            nanoflann::KDTreeSingleIndexAdaptorParams(100,
+                (unsigned)parallelThreads())));
         m_index->buildIndex();
     }
 
+    /**
+      Write the built index to a file so that load() can restore it
+      instead of building it again.  The file is replaced atomically, so
+      processes sharing it never see a partial index.
+
+      \param filename  Name of the file.
+      \return  Whether the file was written.
+    */
+    bool save(const std::string& filename) const
+    {
+        if (!m_index)
+            return false;
+
+        std::string tempFile;
+        try
+        {
+            tempFile = FileUtils::uniqueFilename(
+                FileUtils::getDirectory(filename), "kdindex");
+            FILE *fp = fopen(tempFile.c_str(), "wb");
+            if (!fp)
+                return false;
+
+            FileHeader header = fileHeader();
+            fwrite(&header, sizeof(header), 1, fp);
+            m_index->saveIndex(fp);
+            bool ok = !ferror(fp);
+            ok = (fclose(fp) == 0) && ok;
+            if (!ok)
+            {
+                FileUtils::deleteFile(tempFile);
+                return false;
+            }
+            FileUtils::renameFile(filename, tempFile);
+        }
+        catch (...)
+        {
+            if (tempFile.size() && FileUtils::fileExists(tempFile))
+                FileUtils::deleteFile(tempFile);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+      Load an index written by save() in place of calling build().  Nothing
+      is loaded unless the file holds an index of exactly the points of
+      the view, in which case build() must be called as usual.
+
+      \param filename  Name of the file.
+      \return  Whether the index was loaded.
+    */
+    bool load(const std::string& filename)
+    {
+        if (!FileUtils::fileExists(filename))
+            return false;
+        loadCoords();
+
+        FILE *fp = fopen(filename.c_str(), "rb");
+        if (!fp)
+            return false;
+
+        bool ok = false;
+        std::unique_ptr<my_kd_tree_t> index;
+        try
+        {
+            FileHeader expected = fileHeader();
+            FileHeader header;
+            if (fread(&header, sizeof(header), 1, fp) == 1 &&
+                memcmp(&header, &expected, sizeof(header)) == 0)
+            {
+                index.reset(new my_kd_tree_t(DIM, *this,
+                    nanoflann::KDTreeSingleIndexAdaptorParams(100)));
+                index->loadIndex(fp);
+                ok = (index->size() == m_buf.size());
+            }
+        }
+        catch (...)
+        {}
+        fclose(fp);
+
+        if (ok)
+            m_index = std::move(index);
+        return ok;
+    }
+
+    /**
+      Function called with the neighbors of a query point, nearest first.
+
+      \param idx  Index of the query point.
+      \param ids  Indices of the neighbors in the indexed view.
+      \param sqrDists  Square distances from the query point to the
+        neighbors.
+    */
+    typedef std::function<void(PointId idx, const std::vector<PointId>& ids,
+        const std::vector<double>& sqrDists)> NeighborFunc;
+
+    /**
+      Find the k nearest neighbors of every point in the indexed view.
+      The queries are spread across threads, so \ref cb is called
+      concurrently, though never twice for the same point.  An exception
+      thrown by \ref cb stops the search and is rethrown.
+
+      \param k  Number of neighbors to find, including the point itself.
+      \param cb  Function called with the neighbors of each point.
+    */
+    void knnSearchAll(point_count_t k, const NeighborFunc& cb) const
+    {
+        auto getPoint = [this](PointId i, double *pt)
+        {
+            std::copy_n(&m_coords[i * DIM], DIM, pt);
+            return i;
+        };
+        queryAll(m_buf.size(), getPoint, knnQuery(k), cb);
+    }
+
+    /**
+      Find the k nearest neighbors in the indexed view of points of
+      another view.  \ref cb is called as for knnSearchAll(k, cb).
+
+      \param queries  View holding the query points.
+      \param ids  Indices in \ref queries of the query points.
+      \param k  Number of neighbors to find.
+      \param cb  Function called with the index in \ref queries of each
+        query point and its neighbors.
+    */
+    void knnSearchAll(const PointView& queries,
+        const std::vector<PointId>& ids, point_count_t k,
+        const NeighborFunc& cb) const
+    {
+        static const Dimension::Id dims[] =
+            { Dimension::Id::X, Dimension::Id::Y, Dimension::Id::Z };
+
+        auto getPoint = [&queries, &ids](PointId i, double *pt)
+        {
+            for (int d = 0; d < DIM; ++d)
+                pt[d] = queries.getFieldAs<double>(dims[d], ids[i]);
+            return ids[i];
+        };
+        queryAll(ids.size(), getPoint, knnQuery(k), cb);
+    }
+
+    /**
+      Find the neighbors within a radius of every point in the indexed view.
+      \ref cb is called as for knnSearchAll().
+
+      \param r  Search radius.
+      \param cb  Function called with the neighbors of each point.
+    */
+    void radiusAll(double r, const NeighborFunc& cb) const
+    {
+        auto getPoint = [this](PointId i, double *pt)
+        {
+            std::copy_n(&m_coords[i * DIM], DIM, pt);
+            return i;
+        };
+
+        // Our distance metric is square distance, so we use the square of
+        // the radius.
+        RadiusQuery query(*m_index, r * r);
+        queryAll(m_buf.size(), getPoint, query, cb);
+    }
+
+    /**
+      Get the coordinates of the indexed points, DIM values per point in
+      the order of the points in the view.  Code that works on the
+      neighbors found by a search can read their positions from here
+      rather than from the view.
+
+      \return  Pointer to the coordinates of the first point.
+    */
+    const double *coords() const
+        { return m_coords.data(); }
+
 protected:
     const PointView& m_buf;
+    // Point coordinates, DIM per point, copied from m_buf by build() so
+    // that the tree doesn't go through getFieldAs() for every access.
+    std::vector<double> m_coords;
 
     typedef nanoflann::KDTreeSingleIndexAdaptor<nanoflann::L2_Simple_Adaptor<
         double, KDIndex, double>, KDIndex, -1, std::size_t> my_kd_tree_t;
@@ -88,6 +272,135 @@ protected:
 private:
     KDIndex(const KDIndex&);
     KDIndex& operator=(KDIndex&);
+
+    std::function<void(const double *, std::vector<PointId>&,
+        std::vector<double>&)> knnQuery(point_count_t k) const
+    {
+        k = (std::min)(m_buf.size(), k);
+        return [this, k](const double *pt, std::vector<PointId>& ids,
+            std::vector<double>& sqrDists)
+        {
+            ids.resize(k);
+            sqrDists.resize(k);
+            if (k == 0)
+                return;
+            nanoflann::KNNResultSet<double, PointId, point_count_t>
+                resultSet(k);
+            resultSet.init(ids.data(), sqrDists.data());
+            m_index->findNeighbors(resultSet, pt,
+                nanoflann::SearchParams(10));
+        };
+    }
+
+    // nanoflann's radius search wants a vector of pairs, so each copy of
+    // the query (one per thread) keeps its own.
+    struct RadiusQuery
+    {
+        RadiusQuery(const my_kd_tree_t& index, double r2) :
+            m_index(index), m_r2(r2)
+        {}
+
+        void operator()(const double *pt, std::vector<PointId>& ids,
+            std::vector<double>& sqrDists)
+        {
+            nanoflann::SearchParams params;
+            params.sorted = true;
+
+            const std::size_t count =
+                m_index.radiusSearch(pt, m_r2, m_matches, params);
+            ids.resize(count);
+            sqrDists.resize(count);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                ids[i] = m_matches[i].first;
+                sqrDists[i] = m_matches[i].second;
+            }
+        }
+
+        const my_kd_tree_t& m_index;
+        double m_r2;
+        std::vector<std::pair<std::size_t, double>> m_matches;
+    };
+
+    // Run the query for each of 'count' points, each thread with its own
+    // copy of the query and result buffers.
+    template<typename GetPoint, typename Query>
+    void queryAll(point_count_t count, GetPoint getPoint, Query query,
+        const NeighborFunc& cb) const
+    {
+        struct Worker
+        {
+            Query m_query;
+            GetPoint& m_getPoint;
+            const NeighborFunc& m_cb;
+            std::vector<PointId> m_ids;
+            std::vector<double> m_sqrDists;
+
+            void operator()(PointId i)
+            {
+                double pt[DIM];
+                PointId idx = m_getPoint(i, pt);
+                m_query(pt, m_ids, m_sqrDists);
+                m_cb(idx, m_ids, m_sqrDists);
+            }
+        };
+
+        parallelFor(count, [&]()
+            { return Worker { query, getPoint, cb, {}, {} }; });
+    }
+
+    // Start of an index file.  The points are identified by a hash of
+    // their coordinates, so an index is only loaded for the points it
+    // was built from, whatever file they came from.
+    struct FileHeader
+    {
+        char m_magic[8];
+        uint32_t m_version;
+        uint32_t m_sizeofSize;
+        uint64_t m_dims;
+        uint64_t m_count;
+        uint64_t m_hash;
+    };
+
+    FileHeader fileHeader() const
+    {
+        FileHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.m_magic, "PDALKDI", 8);
+        header.m_version = 1;
+        header.m_sizeofSize = sizeof(std::size_t);
+        header.m_dims = DIM;
+        header.m_count = m_buf.size();
+
+        // FNV-1a over the bits of the coordinates.
+        uint64_t hash = 14695981039346656037ULL;
+        for (double d : m_coords)
+        {
+            uint64_t bits;
+            memcpy(&bits, &d, sizeof(bits));
+            hash = (hash ^ bits) * 1099511628211ULL;
+        }
+        header.m_hash = hash;
+        return header;
+    }
+
+    void loadCoords()
+    {
+        static const Dimension::Id dims[] =
+            { Dimension::Id::X, Dimension::Id::Y, Dimension::Id::Z };
+
+        const point_count_t count = m_buf.size();
+        std::vector<double> values(count);
+
+        m_coords.resize(count * DIM);
+        for (int d = 0; d < DIM; ++d)
+        {
+            if (count)
+                m_buf.getFieldArray(dims[d], 0, count, values.data());
+            for (PointId i = 0; i < count; ++i)
+                m_coords[i * DIM + d] = values[i];
+        }
+    }
 };
 
 class PDAL_DLL KD2Index : public KDIndex<2>
@@ -364,20 +677,10 @@ double KDIndex<2>::kdtree_get_pt(const PointId idx, int dim) const
     if (idx >= m_buf.size())
         return 0.0;
 
-    Dimension::Id id = Dimension::Id::Unknown;
-    switch (dim)
-    {
-    case 0:
-        id = Dimension::Id::X;
-        break;
-    case 1:
-        id = Dimension::Id::Y;
-        break;
-    default:
+    if (dim < 0 || dim > 1)
         throw pdal_error("kdtree_get_pt: Request for invalid dimension "
             "from nanoflann");
-    }
-    return m_buf.getFieldAs<double>(id, idx);
+    return m_coords[idx * 2 + dim];
 }
 
 template<>
@@ -387,23 +690,10 @@ double KDIndex<3>::kdtree_get_pt(const PointId idx, int dim) const
     if (idx >= m_buf.size())
         return 0.0;
 
-    Dimension::Id id = Dimension::Id::Unknown;
-    switch (dim)
-    {
-    case 0:
-        id = Dimension::Id::X;
-        break;
-    case 1:
-        id = Dimension::Id::Y;
-        break;
-    case 2:
-        id = Dimension::Id::Z;
-        break;
-    default:
+    if (dim < 0 || dim > 2)
         throw pdal_error("kdtree_get_pt: Request for invalid dimension "
             "from nanoflann");
-    }
-    return m_buf.getFieldAs<double>(id, idx);
+    return m_coords[idx * 3 + dim];
 }
 
 // nanoflann hands us a vector that represents the position of p1.  We fetch
@@ -412,8 +702,9 @@ template<>
 inline double KDIndex<2>::kdtree_distance(const double *p1, const PointId idx,
     size_t /*numDims*/) const
 {
-    double d0 = p1[0] - m_buf.getFieldAs<double>(Dimension::Id::X, idx);
-    double d1 = p1[1] - m_buf.getFieldAs<double>(Dimension::Id::Y, idx);
+    const double *p2 = &m_coords[idx * 2];
+    double d0 = p1[0] - p2[0];
+    double d1 = p1[1] - p2[1];
 
     return (d0 * d0 + d1 * d1);
 }
@@ -422,63 +713,43 @@ template<>
 inline double KDIndex<3>::kdtree_distance(const double *p1, const PointId idx,
     size_t /*numDims*/) const
 {
-    double d0 = p1[0] - m_buf.getFieldAs<double>(Dimension::Id::X, idx);
-    double d1 = p1[1] - m_buf.getFieldAs<double>(Dimension::Id::Y, idx);
-    double d2 = p1[2] - m_buf.getFieldAs<double>(Dimension::Id::Z, idx);
+    const double *p2 = &m_coords[idx * 3];
+    double d0 = p1[0] - p2[0];
+    double d1 = p1[1] - p2[1];
+    double d2 = p1[2] - p2[2];
 
     return (d0 * d0 + d1 * d1 + d2 * d2);
 }
 
 
-template<>
+// The bounds are computed from the copied coordinates rather than with
+// PointView::calculateBounds(), which would read every point again.
+template<int DIM>
 template <class BBOX>
-bool KDIndex<2>::kdtree_get_bbox(BBOX& bb) const
+bool KDIndex<DIM>::kdtree_get_bbox(BBOX& bb) const
 {
-    if (m_buf.empty())
+    for (int d = 0; d < DIM; ++d)
     {
-        bb[0].low = 0.0;
-        bb[0].high = 0.0;
-        bb[1].low = 0.0;
-        bb[1].high = 0.0;
+        bb[d].low = 0.0;
+        bb[d].high = 0.0;
     }
-    else
-    {
-        BOX2D bounds;
-        m_buf.calculateBounds(bounds);
-
-        bb[0].low = bounds.minx;
-        bb[0].high = bounds.maxx;
-        bb[1].low = bounds.miny;
-        bb[1].high = bounds.maxy;
-    }
-    return true;
-}
+    if (m_coords.empty())
+        return true;
 
-template<>
-template <class BBOX>
-bool KDIndex<3>::kdtree_get_bbox(BBOX& bb) const
-{
-    if (m_buf.empty())
+    for (int d = 0; d < DIM; ++d)
     {
-        bb[0].low = 0.0;
-        bb[0].high = 0.0;
-        bb[1].low = 0.0;
-        bb[1].high = 0.0;
-        bb[2].low = 0.0;
-        bb[2].high = 0.0;
-    }
-    else
-    {
-        BOX3D bounds;
-        m_buf.calculateBounds(bounds);
-
-        bb[0].low = bounds.minx;
-        bb[0].high = bounds.maxx;
-        bb[1].low = bounds.miny;
-        bb[1].high = bounds.maxy;
-        bb[2].low = bounds.minz;
-        bb[2].high = bounds.maxz;
+        bb[d].low = m_coords[d];
+        bb[d].high = m_coords[d];
     }
+    for (size_t i = DIM; i < m_coords.size(); i += DIM)
+        for (int d = 0; d < DIM; ++d)
+        {
+            const double v = m_coords[i + d];
+            if (v < bb[d].low)
+                bb[d].low = v;
+            if (v > bb[d].high)
+                bb[d].high = v;
+        }
     return true;
 }
 
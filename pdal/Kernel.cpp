@@ -358,6 +358,24 @@ Stage& Kernel::makeWriter(const std::string& outputFile, Stage& parent,
 }
 
 
+std::unique_ptr<StreamPointTable> Kernel::makeStreamTable(
+    const std::string& batch)
+{
+    std::unique_ptr<StreamPointTable> table;
+    if (Utils::iequals(batch, "auto"))
+        table.reset(new AdaptivePointTable());
+    else
+    {
+        point_count_t capacity;
+        if (!Utils::fromString(batch, capacity) || capacity == 0)
+            throw pdal_error("Invalid stream batch size '" + batch + "'.  "
+                "Must be a positive number or 'auto'.");
+        table.reset(new FixedPointTable(capacity));
+    }
+    return table;
+}
+
+
 bool Kernel::test_parseStageOption(std::string o, std::string& stage,
     std::string& option, std::string& value)
 {
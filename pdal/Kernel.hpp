@@ -90,6 +90,11 @@ protected:
     Stage& makeWriter(const std::string& outputFile, Stage& parent,
         std::string driver, Options options);
     virtual bool isStagePrefix(const std::string& stageType);
+    // Make the table for running a pipeline in stream mode.  'batch' is
+    // the number of points in a batch, or "auto" to tune it as the
+    // pipeline runs.
+    std::unique_ptr<StreamPointTable> makeStreamTable(
+        const std::string& batch);
 
     LogPtr m_log;
     PipelineManager m_manager;
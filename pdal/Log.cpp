@@ -61,7 +61,7 @@ Log::Log(std::string const& leaderString, std::string const& outputName,
         m_log = Utils::createFile(outputName);
         m_deleteStreamOnCleanup = true;
     }
-    m_leaders.push(leaderString);
+    m_rootLeader = leaderString;
     if (m_timing)
         m_start = m_clock.now();
 }
@@ -73,7 +73,7 @@ Log::Log(std::string const& leaderString, std::ostream* v, bool timing)
     , m_timing(timing)
 {
     m_log = v;
-    m_leaders.push(leaderString);
+    m_rootLeader = leaderString;
     if (m_timing)
         m_start = m_clock.now();
 }
@@ -90,6 +90,35 @@ Log::~Log()
 }
 
 
+void Log::pushLeader(const std::string& leader)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_leaders[std::this_thread::get_id()].push(leader);
+}
+
+
+std::string Log::leader() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_leaders.find(std::this_thread::get_id());
+    if (it == m_leaders.end() || it->second.empty())
+        return m_rootLeader;
+    return it->second.top();
+}
+
+
+void Log::popLeader()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_leaders.find(std::this_thread::get_id());
+    if (it == m_leaders.end())
+        return;
+    it->second.pop();
+    if (it->second.empty())
+        m_leaders.erase(it);
+}
+
+
 void Log::floatPrecision(int level)
 {
     m_log->setf(std::ios_base::fixed, std::ios_base::floatfield);
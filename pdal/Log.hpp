@@ -35,9 +35,12 @@
 #pragma once
 
 #include <cassert>
+#include <map>
 #include <memory> // shared_ptr
+#include <mutex>
 #include <stack>
 #include <chrono>
+#include <thread>
 
 #include <pdal/pdal_internal.hpp>
 #include <pdal/util/NullOStream.hpp>
@@ -95,22 +98,18 @@ public:
     void setLeader(const std::string& leader)
         { pushLeader(leader); }
 
-    /// Push the leader string onto the stack.
+    /// Push the leader string onto the stack.  Each thread has its own
+    /// stack of leaders so that stages running concurrently don't stomp
+    /// on each other's leader.
     /// \param  leader  Leader string
-    void pushLeader(const std::string& leader)
-        { m_leaders.push(leader); }
+    void pushLeader(const std::string& leader);
 
     /// Get the leader string.
     /// \return  The current leader string.
-    std::string leader() const
-        { return m_leaders.empty() ? std::string() : m_leaders.top(); }
+    std::string leader() const;
 
     /// Pop the current leader string.
-    void popLeader()
-    {
-        if (!m_leaders.empty())
-            m_leaders.pop();
-    }
+    void popLeader();
 
     /// @return A string representing the LogLevel
     std::string getLevelString(LogLevel v) const;
@@ -130,6 +129,29 @@ public:
     /// pdal::Log::get is less than the logging level of the pdal::Log instance
     std::ostream& get(LogLevel level = LogLevel::Info);
 
+    /// Writes a message at the given level.  The function is called with
+    /// the log stream only if the level is enabled, so the arguments of
+    /// the message aren't evaluated otherwise.  Use this in loops.
+    /// \code
+    /// log->get(LogLevel::Debug, [&](std::ostream& out)
+    ///     { out << "Read " << key.toString() << std::endl; });
+    /// \endcode
+    /// @param level logging level of the message
+    /// @param f function that writes the message to the stream passed
+    template<typename F>
+    void get(LogLevel level, F&& f)
+    {
+        if (enabled(level))
+            f(get(level));
+    }
+
+    /// @return true if messages at the given level are written.
+    /// @param level logging level to test
+    bool enabled(LogLevel level) const
+    {
+        return level <= m_level;
+    }
+
     /// Sets the floating point precision
     void floatPrecision(int level);
 
@@ -146,7 +168,9 @@ private:
 
     LogLevel m_level;
     bool m_deleteStreamOnCleanup;
-    std::stack<std::string> m_leaders;
+    std::string m_rootLeader;
+    std::map<std::thread::id, std::stack<std::string>> m_leaders;
+    mutable std::mutex m_mutex;
     NullOStream m_nullStream;
     bool m_timing;
     std::chrono::steady_clock m_clock;
@@ -34,7 +34,10 @@
 
 #pragma once
 
-#include <deque>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
 
 namespace pdal
 {
@@ -62,22 +65,115 @@ class Mesh
 
 /**
   A mesh where the faces are triangles.
+
+  Vertex indices are kept in chunks of ChunkFaces faces, so a growing
+  mesh is never copied.  They're stored as 32-bit values until a face
+  refers to a point beyond the range of 32 bits, when the mesh switches
+  to full-width indices.
 */
 class TriangularMesh : public Mesh
 {
 public:
-    PDAL_DLL TriangularMesh()
+    static const size_t ChunkFaces = 1 << 16;
+
+    PDAL_DLL TriangularMesh() : m_size(0)
     {}
 
     size_t PDAL_DLL size() const
-        { return m_index.size(); }
+        { return m_size; }
     void PDAL_DLL add(PointId a, PointId b, PointId c)
-        { m_index.emplace_back(a, b, c); }
-    const PDAL_DLL Triangle& operator[](PointId id) const
-        { return m_index[id]; }
+    {
+        const PointId narrowMax = (std::numeric_limits<uint32_t>::max)();
+        if (m_wide.empty() && (a > narrowMax || b > narrowMax ||
+                c > narrowMax))
+            widen();
+        if (m_wide.empty())
+            append(m_narrow, (uint32_t)a, (uint32_t)b, (uint32_t)c);
+        else
+            append(m_wide, a, b, c);
+        m_size++;
+    }
+    PDAL_DLL Triangle operator[](PointId id) const
+    {
+        const size_t chunk = id / ChunkFaces;
+        const size_t pos = 3 * (id % ChunkFaces);
+        if (m_wide.size())
+        {
+            const std::vector<PointId>& c = m_wide[chunk];
+            return Triangle(c[pos], c[pos + 1], c[pos + 2]);
+        }
+        const std::vector<uint32_t>& c = m_narrow[chunk];
+        return Triangle(c[pos], c[pos + 1], c[pos + 2]);
+    }
+
+    /**
+      Call a function with the vertex indices of each face in a range,
+      in order.  This avoids locating the chunk of every face.
+
+      \param begin  Index of the first face.
+      \param end  Index past the last face.
+      \param f  Function called as f(a, b, c) for each face.
+    */
+    template<typename FUNC>
+    void visit(size_t begin, size_t end, FUNC f) const
+    {
+        if (m_wide.size())
+            visit(m_wide, begin, end, f);
+        else
+            visit(m_narrow, begin, end, f);
+    }
+
 protected:
-    std::deque<Triangle> m_index;
+    template<typename T>
+    static void append(std::vector<std::vector<T>>& chunks, T a, T b, T c)
+    {
+        if (chunks.empty() || chunks.back().size() == 3 * ChunkFaces)
+        {
+            // Small meshes grow their only chunk as needed.
+            chunks.emplace_back();
+            if (chunks.size() > 1)
+                chunks.back().reserve(3 * ChunkFaces);
+        }
+        std::vector<T>& chunk = chunks.back();
+        chunk.push_back(a);
+        chunk.push_back(b);
+        chunk.push_back(c);
+    }
+
+    template<typename T, typename FUNC>
+    static void visit(const std::vector<std::vector<T>>& chunks,
+        size_t begin, size_t end, FUNC& f)
+    {
+        while (begin < end)
+        {
+            const std::vector<T>& c = chunks[begin / ChunkFaces];
+            size_t pos = 3 * (begin % ChunkFaces);
+            const size_t last = (std::min)(c.size(),
+                pos + 3 * (end - begin));
+            for (; pos < last; pos += 3, ++begin)
+                f((PointId)c[pos], (PointId)c[pos + 1], (PointId)c[pos + 2]);
+        }
+    }
+
+    // Copy the indices stored so far to full-width chunks.
+    void widen()
+    {
+        for (std::vector<uint32_t>& c : m_narrow)
+        {
+            for (size_t pos = 0; pos < c.size(); pos += 3)
+                append(m_wide, (PointId)c[pos], (PointId)c[pos + 1],
+                    (PointId)c[pos + 2]);
+            std::vector<uint32_t>().swap(c);
+        }
+        m_narrow.clear();
+        // Make sure the mesh is marked wide even if it was empty.
+        if (m_wide.empty())
+            m_wide.emplace_back();
+    }
 
+    std::vector<std::vector<uint32_t>> m_narrow;
+    std::vector<std::vector<PointId>> m_wide;
+    size_t m_size;
 };
 
 } // namespace pdal
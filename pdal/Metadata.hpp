@@ -56,9 +56,22 @@ enum class MetadataType
     Array
 };
 
+/**
+  How much metadata stages should build.  With Essential, stages only
+  build metadata that other stages rely on (forwarded header values,
+  spatial references and such) and skip descriptive metadata that is
+  only useful when someone looks at it.
+*/
+enum class MetadataPolicy
+{
+    Full,
+    Essential
+};
+
 class Metadata;
 class MetadataNode;
 class MetadataNodeImpl;
+class MetadataJsonWriter;
 typedef std::shared_ptr<MetadataNodeImpl> MetadataNodeImplPtr;
 typedef std::vector<MetadataNodeImplPtr> MetadataImplList;
 typedef std::map<std::string, MetadataImplList> MetadataSubnodes;
@@ -67,6 +80,7 @@ typedef std::vector<MetadataNode> MetadataNodeList;
 class PDAL_DLL MetadataNodeImpl
 {
     friend class MetadataNode;
+    friend class MetadataJsonWriter;
 
 private:
     MetadataNodeImpl(const std::string& name) : m_kind(MetadataType::Instance)
@@ -393,6 +407,7 @@ inline std::string value(const std::string&, const std::string& value)
 class PDAL_DLL MetadataNode
 {
     friend class Metadata;
+    friend class MetadataJsonWriter;
     friend inline
         bool operator == (const MetadataNode& m1, const MetadataNode& m2);
     friend inline
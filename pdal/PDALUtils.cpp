@@ -44,109 +44,265 @@
 #include <pdal/PointView.hpp>
 #include <pdal/Options.hpp>
 #include <pdal/util/FileUtils.hpp>
+#include <pdal/private/MultipartOStream.hpp>
+
+#include <algorithm>
+#include <future>
+#include <mutex>
+#include <numeric>
+#include <pdal/private/RemoteCache.hpp>
 
 using namespace std;
 
 namespace pdal
 {
 
-namespace {
-
-void toJSON(const MetadataNode& m, std::ostream& o, int level);
-void arrayToJSON(const MetadataNodeList& children, std::ostream& o, int level);
-void arrayEltToJSON(const MetadataNode& m, std::ostream& o, int level);
-void subnodesToJSON(const MetadataNode& parent, std::ostream& o, int level)
+// Writes metadata as JSON directly from the nodes' own storage, without
+// building intermediate strings or node lists.  Output is collected in a
+// buffer that is written to the stream when full, rather than flushing
+// the stream at the end of every line.
+class MetadataJsonWriter
 {
-    const std::string indent(level * 2, ' ');
-
-    std::vector<std::string> names = parent.childNames();
+public:
+    MetadataJsonWriter(std::ostream& out) : m_out(out)
+        { m_buf.reserve(BufSize); }
+    ~MetadataJsonWriter()
+        { flush(); }
 
-    o << indent << "{" << endl;
-    for (auto ni = names.begin(); ni != names.end(); ++ni)
+    void write(const MetadataNode& m)
     {
-        MetadataNodeList children = parent.children(*ni);
+        const MetadataNodeImpl& impl = *m.m_impl;
 
-        MetadataNode& node = *children.begin();
-        if (node.kind() == MetadataType::Array)
+        if (impl.m_name.empty())
+            subnodes(impl, 0);
+        else if (impl.m_kind == MetadataType::Array)
         {
-            o << indent << "  \"" << node.name() << "\":" << std::endl;
-            arrayToJSON(children, o, level + 1);
+            // An array written at the top level contains all the node's
+            // children.
+            bool first = true;
+            beginArray(0);
+            for (auto& sub : impl.m_subnodes)
+                for (const MetadataNodeImplPtr& child : sub.second)
+                    arrayElement(*child, 1, first);
+            endArray(0, first);
         }
         else
-            toJSON(node, o, level + 1);
-        if (ni != names.rbegin().base() - 1)
-            o << ",";
-        o << std::endl;
+        {
+            put("{\n");
+            node(impl, 1);
+            put("\n}");
+        }
+        put('\n');
     }
-    o << indent << "}";
-}
 
-void arrayToJSON(const MetadataNodeList& children, std::ostream& o, int level)
-{
-    const std::string indent(level * 2, ' ');
+    void writeElement(const MetadataNode& m, int level)
+    {
+        indent(level);
+        put("{\n");
+        node(*m.m_impl, level + 1);
+        put('\n');
+        indent(level);
+        put('}');
+    }
 
-    o << indent << "[" << std::endl;
-    for (auto ci = children.begin(); ci != children.end(); ++ci)
+    void put(char c)
     {
-        const MetadataNode& m = *ci;
+        m_buf.push_back(c);
+        if (m_buf.size() >= BufSize)
+            flush();
+    }
 
-        arrayEltToJSON(m, o, level + 1);
-        if (ci != children.rbegin().base() - 1)
-            o << ",";
-        o << std::endl;
+    void put(const char *s)
+    {
+        while (*s)
+            put(*s++);
     }
-    o << indent << "]";
-}
 
-void arrayEltToJSON(const MetadataNode& m, std::ostream& o, int level)
-{
-    std::string indent(level * 2, ' ');
-    std::string value = m.jsonValue();
-    bool children = m.hasChildren();
+    void indent(int level)
+    {
+        for (int i = 0; i < level * 2; ++i)
+            put(' ');
+    }
 
-    // This is a case from XML.  In JSON, you can't have two values.
-    if (!value.empty() && children)
+    void flush()
     {
-        o << value << "," << std::endl;
-        subnodesToJSON(m, o, level);
+        if (m_buf.size())
+            m_out.write(m_buf.data(), m_buf.size());
+        m_buf.clear();
     }
-    else if (!value.empty())
-        o << indent << value;
-    else
-        subnodesToJSON(m, o, level);
-    // There is the case where we have a name and no value to handle.  What
-    // should be done?
-}
 
-void toJSON(const MetadataNode& m, std::ostream& o, int level)
-{
-    std::string indent(level * 2, ' ');
-    std::string name = m.name();
-    std::string value = m.jsonValue();
-    bool children = m.hasChildren();
+private:
+    static const size_t BufSize = 1 << 16;
 
-    if (name.empty())
-        name = "unnamed";
+    std::ostream& m_out;
+    std::string m_buf;
 
-    // This is a case from XML.  In JSON, you can't have two values.
-    if (!value.empty() && children)
+    void name(const std::string& s)
     {
-        o << indent << "\"" << name << "\": " << value << "," << std::endl;
-        o << indent << "\"" << name << "\": ";
-        subnodesToJSON(m, o, level);
+        put('"');
+        for (char c : s)
+            put(c);
+        put("\":");
     }
-    else if (!value.empty())
-        o << indent << "\"" << name << "\": " << value;
-    else
+
+    static bool quoted(const MetadataNodeImpl& m)
     {
-        o << indent << "\"" << name << "\":" << std::endl;
-        subnodesToJSON(m, o, level);
+        const std::string& t = m.m_type;
+
+        if (t == "string" || t == "base64Binary" || t == "uuid" ||
+            t == "matrix")
+            return true;
+        if (t == "double")
+        {
+            const std::string& v = m.m_value;
+            return v == "NaN" || v == "Infinity" || v == "-Infinity";
+        }
+        return false;
     }
-    // There is the case where we have a name and no value to handle.  What
-    // should be done?
-}
 
-} // unnamed namespace
+    // Whether the node's JSON value is non-empty.  Control characters
+    // are dropped from unquoted values, so a value containing only
+    // those is empty.
+    static bool hasValue(const MetadataNodeImpl& m)
+    {
+        if (m.m_type == "json")
+            return m.m_value.size();
+        if (quoted(m))
+            return true;
+        for (char c : m.m_value)
+            if (c > 31)
+                return true;
+        return false;
+    }
+
+    void value(const MetadataNodeImpl& m)
+    {
+        if (m.m_type == "json")
+        {
+            for (char c : m.m_value)
+                put(c);
+            return;
+        }
+
+        bool q = quoted(m);
+        if (q)
+            put('"');
+        for (char c : m.m_value)
+        {
+            if (c <= 31)
+                continue;
+            if (c == '"' || c == '\\')
+                put('\\');
+            put(c);
+        }
+        if (q)
+            put('"');
+    }
+
+    void subnodes(const MetadataNodeImpl& parent, int level)
+    {
+        indent(level);
+        put("{\n");
+        const MetadataSubnodes& nodes = parent.m_subnodes;
+        for (auto si = nodes.begin(); si != nodes.end(); ++si)
+        {
+            const MetadataImplList& children = si->second;
+            const MetadataNodeImpl& node = *children.front();
+
+            if (si != nodes.begin())
+                put(",\n");
+            if (node.m_kind == MetadataType::Array)
+            {
+                indent(level + 1);
+                name(node.m_name);
+                put('\n');
+
+                bool first = true;
+                beginArray(level + 1);
+                for (const MetadataNodeImplPtr& child : children)
+                    arrayElement(*child, level + 2, first);
+                endArray(level + 1, first);
+            }
+            else
+                this->node(node, level + 1);
+        }
+        if (nodes.size())
+            put('\n');
+        indent(level);
+        put('}');
+    }
+
+    void beginArray(int level)
+    {
+        indent(level);
+        put("[\n");
+    }
+
+    void endArray(int level, bool empty)
+    {
+        if (!empty)
+            put('\n');
+        indent(level);
+        put(']');
+    }
+
+    void arrayElement(const MetadataNodeImpl& m, int level, bool& first)
+    {
+        if (!first)
+            put(",\n");
+        first = false;
+
+        // This is a case from XML.  In JSON, you can't have two values.
+        if (hasValue(m))
+        {
+            if (m.m_subnodes.size())
+            {
+                value(m);
+                put(",\n");
+                subnodes(m, level);
+            }
+            else
+            {
+                indent(level);
+                value(m);
+            }
+        }
+        else
+            subnodes(m, level);
+        // There is the case where we have a name and no value to handle.
+        // What should be done?
+    }
+
+    void node(const MetadataNodeImpl& m, int level)
+    {
+        static const std::string unnamed("unnamed");
+        const std::string& n = m.m_name.empty() ? unnamed : m.m_name;
+
+        indent(level);
+        name(n);
+        // This is a case from XML.  In JSON, you can't have two values.
+        if (hasValue(m))
+        {
+            put(' ');
+            value(m);
+            if (m.m_subnodes.size())
+            {
+                put(",\n");
+                indent(level);
+                name(n);
+                put(' ');
+                subnodes(m, level);
+            }
+        }
+        else
+        {
+            put('\n');
+            subnodes(m, level);
+        }
+        // There is the case where we have a name and no value to handle.
+        // What should be done?
+    }
+};
 
 namespace Utils
 {
@@ -161,18 +317,53 @@ std::string toJSON(const MetadataNode& m)
 
 void toJSON(const MetadataNode& m, std::ostream& o)
 {
-    if (m.name().empty())
-        pdal::subnodesToJSON(m, o, 0);
-    else if (m.kind() == MetadataType::Array)
-        pdal::arrayToJSON(m.children(), o, 0);
-    else
     {
-        o << "{" << std::endl;
-        pdal::toJSON(m, o, 1);
-        o << std::endl;
-        o << "}";
+        MetadataJsonWriter writer(o);
+        writer.write(m);
     }
-    o << std::endl;
+    o.flush();
+}
+
+
+MetadataJsonStream::MetadataJsonStream(std::ostream& out,
+        const std::string& name) : m_out(out), m_count(0), m_closed(false)
+{
+    m_out << "{\n  \"" << name << "\":\n  [\n";
+    m_out.flush();
+}
+
+
+MetadataJsonStream::~MetadataJsonStream()
+{
+    close();
+}
+
+
+void MetadataJsonStream::add(const MetadataNode& m)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_closed)
+        return;
+    {
+        MetadataJsonWriter writer(m_out);
+        if (m_count++)
+            writer.put(",\n");
+        writer.writeElement(m, 2);
+    }
+    m_out.flush();
+}
+
+
+void MetadataJsonStream::close()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_closed)
+        return;
+    m_closed = true;
+    m_out << (m_count ? "\n" : "") << "  ]\n}\n";
+    m_out.flush();
 }
 
 namespace
@@ -205,28 +396,51 @@ private:
     std::string m_filename;
 };
 
-class ArbiterOutStream : public std::ofstream
+#ifdef PDAL_ARBITER_ENABLED
+// Uploads through arbiter.  S3 objects are sent as multipart uploads.
+// Other drivers get the whole file in one request.
+class ArbiterTarget : public MultipartTarget
 {
 public:
-    ArbiterOutStream(const std::string& localPath,
-            const std::string& remotePath, std::ios::openmode mode) :
-        std::ofstream(localPath, mode), m_remotePath(remotePath),
-        m_localFile(localPath)
+    ArbiterTarget(const std::string& path) : m_path(path),
+        m_rawPath(arbiter::Arbiter::stripType(path)),
+        m_s3(dynamic_cast<const arbiter::drivers::S3 *>(
+            &m_arbiter.getDriver(path)))
     {}
 
-    virtual ~ArbiterOutStream()
+    virtual bool multipart() const
+        { return m_s3; }
+    virtual void put(const std::vector<char>& data)
+        { m_arbiter.put(m_path, data); }
+    virtual void start()
+        { m_uploadId = m_s3->startMultipartUpload(m_rawPath); }
+
+    virtual void putPart(int partNum, const std::vector<char>& data)
     {
-#ifdef PDAL_ARBITER_ENABLED
-        close();
-        arbiter::Arbiter a;
-        a.put(m_remotePath, a.getBinary(m_localFile.filename()));
-#endif
+        std::string etag = m_s3->putPart(m_rawPath, m_uploadId, partNum, data);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_etags.size() < (size_t)partNum)
+            m_etags.resize(partNum);
+        m_etags[partNum - 1] = etag;
+    }
+
+    virtual void complete(int numParts)
+    {
+        m_etags.resize(numParts);
+        m_s3->completeMultipartUpload(m_rawPath, m_uploadId, m_etags);
     }
 
 private:
-    std::string m_remotePath;
-    TempFile m_localFile;
+    arbiter::Arbiter m_arbiter;
+    std::string m_path;
+    std::string m_rawPath;
+    const arbiter::drivers::S3 *m_s3;
+    std::string m_uploadId;
+    std::mutex m_mutex;
+    std::vector<std::string> m_etags;
 };
+#endif
 
 class ArbiterInStream : public std::ifstream
 {
@@ -251,13 +465,17 @@ private:
 }  // unnamed namespace
 
 /**
-  Create a file (may be on a supported remote filesystem).
+  Create a file (may be on a supported remote filesystem).  Data for a
+  remote file is uploaded in parts on background threads as it's written
+  and the upload is finished by closeFile().
 
   \param path  Path to file to create.
   \param asBinary  Whether the file should be written in binary mode.
+  \param async  Whether a local file should be written on a background
+    thread.
   \return  Pointer to the created stream, or NULL.
 */
-std::ostream *createFile(const std::string& path, bool asBinary)
+std::ostream *createFile(const std::string& path, bool asBinary, bool async)
 {
     ostream *ofs(nullptr);
 
@@ -269,32 +487,31 @@ std::ostream *createFile(const std::string& path, bool asBinary)
     {
         try
         {
-            ofs = new ArbiterOutStream(tempFilename(path), path,
-                asBinary ? ios::out | ios::binary : ios::out);
+            ofs = new MultipartOStream(std::unique_ptr<MultipartTarget>(
+                new ArbiterTarget(path)));
         }
         catch (arbiter::ArbiterError&)
         {}
-        if (ofs && !ofs->good())
-        {
-            delete ofs;
-            ofs = nullptr;
-        }
     }
     else
 #endif
-        ofs = FileUtils::createFile(path, asBinary);
+        ofs = FileUtils::createFile(path, asBinary, async);
     return ofs;
 }
 
 
 /**
-  Open a file (potentially on a remote filesystem).
+  Open a file (potentially on a remote filesystem).  Remote files are
+  read through the local cache when PDAL_REMOTE_CACHE is set.
 
   \param path  Path (potentially remote) of file to open.
   \param asBinary  Whether the file should be opened binary.
+  \param readAhead  Size of the windows of a local file read ahead on a
+    background thread, or 0 to read as requested.
   \return  Pointer to stream opened for input.
 */
-std::istream *openFile(const std::string& path, bool asBinary)
+std::istream *openFile(const std::string& path, bool asBinary,
+    size_t readAhead)
 {
 #ifdef PDAL_ARBITER_ENABLED
     arbiter::Arbiter a;
@@ -302,6 +519,10 @@ std::istream *openFile(const std::string& path, bool asBinary)
     {
         try
         {
+            RemoteCache *cache = RemoteCache::instance();
+            if (cache)
+                return FileUtils::openFile(cache->fetch(path), asBinary,
+                    readAhead);
             return new ArbiterInStream(tempFilename(path), path,
                 asBinary ? ios::in | ios::binary : ios::in);
         }
@@ -311,16 +532,25 @@ std::istream *openFile(const std::string& path, bool asBinary)
         }
     }
 #endif
-    return FileUtils::openFile(path, asBinary);
+    return FileUtils::openFile(path, asBinary, readAhead);
 }
 
 /**
-  Close an output stream.
+  Close an output stream.  Data for a remote file is uploaded before the
+  stream is closed.
 
   \param out  Stream to close.
+  \throws pdal_error  If the data for a remote file couldn't be uploaded.
 */
 void closeFile(std::ostream *out)
 {
+    MultipartOStream *mos = dynamic_cast<MultipartOStream *>(out);
+    if (mos)
+    {
+        std::unique_ptr<MultipartOStream> stream(mos);
+        stream->close();
+        return;
+    }
     FileUtils::closeFile(out);
 }
 
@@ -336,6 +566,23 @@ void closeFile(std::istream *in)
 }
 
 
+/**
+  Check whether a path refers to a file on a remote filesystem.
+
+  \param path  Path to check.
+  \return  Whether the path is remote.
+*/
+bool isRemote(const std::string& path)
+{
+#ifdef PDAL_ARBITER_ENABLED
+    arbiter::Arbiter a;
+    return a.hasDriver(path) && a.isRemote(path);
+#else
+    return false;
+#endif
+}
+
+
 /**
   Check to see if a file exists.
 
@@ -356,43 +603,45 @@ bool fileExists(const std::string& path)
     return FileUtils::fileExists(path);
 }
 
-double computeHausdorff(PointViewPtr srcView, PointViewPtr candView)
+namespace
 {
-    using namespace Dimension;
-
-    KD3Index srcIndex(*srcView);
-    srcIndex.build();
-
-    KD3Index candIndex(*candView);
-    candIndex.build();
-
-    double maxDistSrcToCand = std::numeric_limits<double>::lowest();
-    double maxDistCandToSrc = std::numeric_limits<double>::lowest();
 
-    for (PointId i = 0; i < srcView->size(); ++i)
+// Largest square distance from a point of a view to its nearest neighbor
+// in an index.  The queries are spread across threads.
+double maxSqrDist(const PointView& view, const KD3Index& index)
+{
+    std::vector<PointId> ids(view.size());
+    std::iota(ids.begin(), ids.end(), 0);
+    std::vector<double> sqrDists(view.size(),
+        std::numeric_limits<double>::lowest());
+    index.knnSearchAll(view, ids, 1, [&sqrDists](PointId idx,
+        const std::vector<PointId>&, const std::vector<double>& dists)
     {
-        std::vector<PointId> indices(1);
-        std::vector<double> sqr_dists(1);
-        PointRef srcPoint = srcView->point(i);
-        candIndex.knnSearch(srcPoint, 1, &indices, &sqr_dists);
+        if (dists.size())
+            sqrDists[idx] = dists[0];
+    });
+    return sqrDists.empty() ? std::numeric_limits<double>::lowest() :
+        *std::max_element(sqrDists.begin(), sqrDists.end());
+}
 
-        if (sqr_dists[0] > maxDistSrcToCand)
-            maxDistSrcToCand = sqr_dists[0];
-    }
+} // unnamed namespace
 
-    for (PointId i = 0; i < candView->size(); ++i)
+// Building an index doesn't use more than one thread, so the two indexes
+// are built at once.  The queries of each direction use every core.
+double computeHausdorff(PointViewPtr srcView, PointViewPtr candView)
+{
+    if (srcView != candView)
     {
-        std::vector<PointId> indices(1);
-        std::vector<double> sqr_dists(1);
-        PointRef candPoint = candView->point(i);
-        srcIndex.knnSearch(candPoint, 1, &indices, &sqr_dists);
-
-        if (sqr_dists[0] > maxDistCandToSrc)
-            maxDistCandToSrc = sqr_dists[0];
+        auto srcBuild = std::async(std::launch::async,
+            [&srcView]() { srcView->build3dIndex(); });
+        candView->build3dIndex();
+        srcBuild.get();
     }
+    KD3Index& candIndex = candView->build3dIndex();
+    KD3Index& srcIndex = srcView->build3dIndex();
 
-    maxDistSrcToCand = std::sqrt(maxDistSrcToCand);
-    maxDistCandToSrc = std::sqrt(maxDistCandToSrc);
+    double maxDistSrcToCand = std::sqrt(maxSqrDist(*srcView, candIndex));
+    double maxDistCandToSrc = std::sqrt(maxSqrDist(*candView, srcIndex));
 
     return (std::max)(maxDistSrcToCand, maxDistCandToSrc);
 }
@@ -40,6 +40,8 @@
 #include <pdal/util/Inserter.hpp>
 #include <pdal/util/Extractor.hpp>
 
+#include <mutex>
+
 #ifndef _WIN32
 #include <fcntl.h>
 #include <unistd.h>
@@ -262,12 +264,60 @@ inline void writeProgress(int fd, const std::string& type,
 
 std::string PDAL_DLL toJSON(const MetadataNode& m);
 void PDAL_DLL toJSON(const MetadataNode& m, std::ostream& o);
-std::istream PDAL_DLL *openFile(const std::string& path, bool asBinary = true);
+
+/**
+  Writes metadata nodes to a stream as elements of a JSON array as they're
+  added, so that metadata can be written while it's still being produced.
+  The stream is flushed after each node.  The output is an object with
+  a single member, the array:
+
+    { "name": [ { <node> }, { <node> } ] }
+
+  Nodes may be added from several threads.
+*/
+class PDAL_DLL MetadataJsonStream
+{
+public:
+    /**
+      Start the output.
+
+      \param out  Stream to write to.
+      \param name  Name of the array in the output.
+    */
+    MetadataJsonStream(std::ostream& out, const std::string& name);
+    ~MetadataJsonStream();
+
+    /**
+      Write a node as the next element of the array.  Nodes added after
+      the output is closed are ignored.
+
+      \param m  Node to write.
+    */
+    void add(const MetadataNode& m);
+
+    /**
+      Finish the output.  Called by the destructor if not called before.
+    */
+    void close();
+
+private:
+    std::ostream& m_out;
+    std::mutex m_mutex;
+    size_t m_count;
+    bool m_closed;
+
+    MetadataJsonStream(const MetadataJsonStream&) = delete;
+    MetadataJsonStream& operator=(const MetadataJsonStream&) = delete;
+};
+
+std::istream PDAL_DLL *openFile(const std::string& path, bool asBinary = true,
+    size_t readAhead = 0);
 std::ostream PDAL_DLL *createFile(const std::string& path,
-    bool asBinary = true);
+    bool asBinary = true, bool async = false);
 void PDAL_DLL closeFile(std::istream *in);
 void PDAL_DLL closeFile(std::ostream *out);
 bool PDAL_DLL fileExists(const std::string& path);
+bool PDAL_DLL isRemote(const std::string& path);
 std::vector<std::string> PDAL_DLL maybeGlob(const std::string& path);
 double PDAL_DLL computeHausdorff(PointViewPtr srcView, PointViewPtr candView);
 
@@ -36,17 +36,25 @@
 #include <pdal/StageFactory.hpp>
 #include <pdal/PipelineReaderJSON.hpp>
 #include <pdal/PDALUtils.hpp>
+#include <pdal/Reader.hpp>
+#include <pdal/Writer.hpp>
 #include <pdal/util/Algorithm.hpp>
 #include <pdal/util/FileUtils.hpp>
 
+#include "private/StageCache.hpp"
+
+#include <limits>
+#include <map>
+
 #pragma GCC diagnostic ignored "-Wmissing-field-initializers"
 
 namespace pdal
 {
 
 PipelineManager::PipelineManager() : m_factory(new StageFactory),
-    m_tablePtr(new PointTable()), m_table(*m_tablePtr),
-    m_progressFd(-1), m_input(nullptr)
+    m_tablePtr(new PointTable()),
+    m_progressFd(-1), m_metadataPolicy(MetadataPolicy::Full),
+    m_input(nullptr)
 {}
 
 
@@ -68,6 +76,14 @@ void PipelineManager::readPipeline(std::istream& input)
 }
 
 
+void PipelineManager::readPipeline(const Json::Value& root)
+{
+    // Parsing the pipeline modifies the tree, so work on a copy.
+    Json::Value tree(root);
+    PipelineReaderJSON(*this).readPipeline(tree);
+}
+
+
 void PipelineManager::readPipeline(const std::string& filename)
 {
     if (FileUtils::extension(filename) == ".json")
@@ -109,6 +125,14 @@ pdal_error stageError(const std::string& cls, const std::string& type)
 }
 
 
+void PipelineManager::setMetadataPolicy(MetadataPolicy policy)
+{
+    m_metadataPolicy = policy;
+    for (Stage *s : m_stages)
+        s->setMetadataPolicy(policy);
+}
+
+
 Stage& PipelineManager::addReader(const std::string& type)
 {
     Stage *reader = m_factory->createStage(type);
@@ -116,6 +140,7 @@ Stage& PipelineManager::addReader(const std::string& type)
         throw stageError("reader", type);
     reader->setLog(m_log);
     reader->setProgressFd(m_progressFd);
+    reader->setMetadataPolicy(m_metadataPolicy);
     m_stages.push_back(reader);
     return *reader;
 }
@@ -128,6 +153,7 @@ Stage& PipelineManager::addFilter(const std::string& type)
         throw stageError("filter", type);
     filter->setLog(m_log);
     filter->setProgressFd(m_progressFd);
+    filter->setMetadataPolicy(m_metadataPolicy);
     m_stages.push_back(filter);
     return *filter;
 }
@@ -140,6 +166,7 @@ Stage& PipelineManager::addWriter(const std::string& type)
         throw stageError("writer", type);
     writer->setLog(m_log);
     writer->setProgressFd(m_progressFd);
+    writer->setMetadataPolicy(m_metadataPolicy);
     m_stages.push_back(writer);
     return *writer;
 }
@@ -196,18 +223,164 @@ void PipelineManager::prepare() const
     validateStageOptions();
     Stage *s = getStage();
     if (s)
-       s->prepare(m_table);
+    {
+        s->prepare(*m_tablePtr);
+        pruneDimensions(*m_tablePtr);
+        pushdownBounds();
+        pushdownCount();
+        pushdownSelection();
+    }
 }
 
 
-point_count_t PipelineManager::execute()
+void PipelineManager::pruneDimensions(PointTableRef table) const
 {
-    prepare();
+    PointLayoutPtr layout = table.layout();
 
-    Stage *s = getStage();
-    if (!s)
-        return 0;
-    m_viewSet = s->execute(m_table);
+    // X, Y and Z are always kept.  Lots of code assumes they exist.
+    Dimension::IdList used { Dimension::Id::X, Dimension::Id::Y,
+        Dimension::Id::Z };
+    for (Stage *s : m_stages)
+        if (!s->dimensionsUsed(layout, used))
+            return;
+
+    Dimension::IdList dims = layout->dims();
+    for (Dimension::Id id : dims)
+        if (!Utils::contains(used, id))
+        {
+            if (m_log)
+                m_log->get(LogLevel::Debug) << "Removing unused dimension '" <<
+                    layout->dimName(id) << "'." << std::endl;
+            layout->removeDim(id);
+        }
+}
+
+
+void PipelineManager::pushdownBounds() const
+{
+    std::map<const Stage *, std::vector<Stage *>> consumers;
+    for (Stage *s : m_stages)
+        for (Stage *in : s->getInputs())
+            consumers[in].push_back(s);
+
+    const double lo = (std::numeric_limits<double>::lowest)();
+    const double hi = (std::numeric_limits<double>::max)();
+    const BOX3D everything(lo, lo, lo, hi, hi, hi);
+
+    for (Stage *s : m_stages)
+    {
+        Reader *r = dynamic_cast<Reader *>(s);
+        if (!r || s->getInputs().size())
+            continue;
+
+        // Follow the stages after the reader as long as each one only
+        // feeds a single stage.  If the output of a stage is used twice,
+        // points dropped on one branch may be needed by the other.
+        BOX3D bounds(everything);
+        const Stage *cur = s;
+        while (consumers[cur].size() == 1)
+        {
+            const Stage *next = consumers[cur].front();
+            if (!next->pushdownBounds(bounds))
+                break;
+            cur = next;
+        }
+        if (bounds == everything)
+            continue;
+
+        if (m_log)
+            m_log->get(LogLevel::Debug) << "Pushing bounds " << bounds <<
+                " to '" << s->getName() << "'." << std::endl;
+        r->restrictBounds(bounds);
+    }
+}
+
+
+void PipelineManager::pushdownCount() const
+{
+    std::map<const Stage *, std::vector<Stage *>> consumers;
+    for (Stage *s : m_stages)
+        for (Stage *in : s->getInputs())
+            consumers[in].push_back(s);
+
+    const point_count_t all = (std::numeric_limits<point_count_t>::max)();
+
+    for (Stage *s : m_stages)
+    {
+        Reader *r = dynamic_cast<Reader *>(s);
+        if (!r || s->getInputs().size())
+            continue;
+
+        // As with bounds, stop at a stage whose output is used twice.
+        point_count_t count(all);
+        const Stage *cur = s;
+        while (consumers[cur].size() == 1)
+        {
+            const Stage *next = consumers[cur].front();
+            if (!next->pushdownCount(count))
+                break;
+            cur = next;
+        }
+        if (count == all || count >= r->count())
+            continue;
+
+        if (m_log)
+            m_log->get(LogLevel::Debug) << "Pushing count " << count <<
+                " to '" << s->getName() << "'." << std::endl;
+        r->restrictCount(count);
+    }
+}
+
+
+void PipelineManager::pushdownSelection() const
+{
+    std::map<const Stage *, std::vector<Stage *>> consumers;
+    for (Stage *s : m_stages)
+        for (Stage *in : s->getInputs())
+            consumers[in].push_back(s);
+
+    for (Stage *s : m_stages)
+    {
+        Reader *r = dynamic_cast<Reader *>(s);
+        if (!r || s->getInputs().size())
+            continue;
+
+        // As with bounds, stop at a stage whose output is used twice.
+        PointSelection selection;
+        std::vector<Stage *> selecting;
+        const Stage *cur = s;
+        while (consumers[cur].size() == 1)
+        {
+            Stage *next = consumers[cur].front();
+            if (!next->pushdownSelection(selection))
+                break;
+            selecting.push_back(next);
+            cur = next;
+        }
+        if (selection.all() || !r->restrictSelection(selection))
+            continue;
+
+        if (m_log)
+            m_log->get(LogLevel::Debug) << "Pushing selection of every " <<
+                selection.m_step << " points from " << selection.m_offset <<
+                " to '" << s->getName() << "'." << std::endl;
+        for (Stage *stage : selecting)
+            stage->selectionPushedDown();
+    }
+}
+
+
+point_count_t PipelineManager::execute(int threads)
+{
+    if (m_cacheDir.empty() || !executeCached(threads))
+    {
+        prepare();
+
+        Stage *s = getStage();
+        if (!s)
+            return 0;
+        m_viewSet = s->execute(*m_tablePtr, threads);
+    }
     point_count_t cnt = 0;
     for (auto pi = m_viewSet.begin(); pi != m_viewSet.end(); ++pi)
     {
@@ -218,7 +391,121 @@ point_count_t PipelineManager::execute()
 }
 
 
-void PipelineManager::executeStream(StreamPointTable& table)
+// Run a pipeline that's a single chain of stages, starting from the
+// output of the deepest stage whose output is in the cache and saving the
+// output of the stage that feeds the last filter.  Pipelines are usually
+// rerun after changing the last filter, so that's the output most likely
+// to be reused.  Returns false if the pipeline can't use the cache.
+bool PipelineManager::executeCached(int threads)
+{
+    validateStageOptions();
+    Stage *leaf = getStage();
+    if (!leaf)
+        return false;
+
+    std::vector<Stage *> chain;
+    for (Stage *s = leaf; s;
+            s = s->getInputs().size() ? s->getInputs().front() : nullptr)
+    {
+        if (s->getInputs().size() > 1)
+            break;
+        chain.insert(chain.begin(), s);
+    }
+    if (chain.size() != m_stages.size())
+    {
+        if (m_log)
+            m_log->get(LogLevel::Debug) << "Not caching stage output: "
+                "pipeline isn't a single chain of stages." << std::endl;
+        return false;
+    }
+
+    // Writers have no output to save, so they're run every time.
+    int last = (int)chain.size() - 1;
+    while (last >= 0 && dynamic_cast<Writer *>(chain[last]))
+        last--;
+    if (last < 0)
+        return false;
+
+    std::vector<std::string> files;
+    std::string hash;
+    int resume = -1;
+    for (int i = 0; i <= last; ++i)
+    {
+        hash = chain[i]->contentHash(hash);
+        if (hash.empty())
+        {
+            if (m_log)
+                m_log->get(LogLevel::Debug) << "Not caching stage output: "
+                    "a file read by '" << chain[i]->getName() << "' was "
+                    "just modified." << std::endl;
+            return false;
+        }
+        files.push_back(StageCache::filename(m_cacheDir, hash));
+        if (StageCache::valid(files.back()))
+            resume = i;
+    }
+    int save = (std::max)(last - 1, 0);
+
+    // Point stages at the cache stages, remembering the inputs to restore.
+    std::vector<std::pair<Stage *, std::vector<Stage *>>> inputs;
+    auto rewire = [&inputs](Stage *s, Stage& input)
+    {
+        inputs.push_back(std::make_pair(s, s->getInputs()));
+        s->getInputs().assign(1, &input);
+    };
+
+    Stage *end = leaf;
+    std::unique_ptr<StageCacheReader> reader;
+    std::unique_ptr<StageCacheWriter> writer;
+    if (resume >= 0)
+    {
+        if (m_log)
+            m_log->get(LogLevel::Debug) << "Starting from cached output of '" <<
+                chain[resume]->getName() << "' in '" << files[resume] <<
+                "'." << std::endl;
+        reader.reset(new StageCacheReader(files[resume]));
+        reader->setLog(m_log);
+        if (resume == (int)chain.size() - 1)
+            end = reader.get();
+        else
+            rewire(chain[resume + 1], *reader);
+    }
+    if (save > resume)
+    {
+        FileUtils::createDirectories(m_cacheDir);
+        writer.reset(new StageCacheWriter(files[save]));
+        writer->setLog(m_log);
+        writer->setInput(*chain[save]);
+        if (save == (int)chain.size() - 1)
+            end = writer.get();
+        else
+            rewire(chain[save + 1], *writer);
+    }
+
+    auto restore = [&inputs]()
+    {
+        for (auto it = inputs.rbegin(); it != inputs.rend(); ++it)
+            it->first->getInputs() = it->second;
+    };
+
+    // Pruning and pushdowns would change the points that are saved, so
+    // they're skipped.
+    try
+    {
+        end->prepare(*m_tablePtr);
+        m_viewSet = end->execute(*m_tablePtr, threads);
+    }
+    catch (...)
+    {
+        restore();
+        throw;
+    }
+    restore();
+    return true;
+}
+
+
+void PipelineManager::executeStream(StreamPointTable& table, int threads)
 {
     validateStageOptions();
     Stage *s = getStage();
@@ -226,7 +513,11 @@ void PipelineManager::executeStream(StreamPointTable& table)
         return;
 
     s->prepare(table);
-    s->execute(table);
+    pruneDimensions(table);
+    pushdownBounds();
+    pushdownCount();
+    pushdownSelection();
+    s->execute(table, threads);
 }
 
 
@@ -234,9 +525,32 @@ MetadataNode PipelineManager::getMetadata() const
 {
     MetadataNode output("stages");
 
+    for (auto s : m_stages)
+        output.add(getMetadata(*s));
+    return output;
+}
+
+
+MetadataNode PipelineManager::getMetadata(const Stage& s)
+{
+    // Add the profile to a copy so that the stage's own metadata
+    // isn't changed.
+    MetadataNode m = s.getMetadata();
+    m = m.clone(m.name());
+    m.addOrUpdate(s.profile().toMetadata());
+    return m;
+}
+
+
+MetadataNode PipelineManager::getProfile() const
+{
+    MetadataNode output("profile");
+
     for (auto s : m_stages)
     {
-        output.add(s->getMetadata());
+        MetadataNode m = output.add(s->profile().toMetadata(s->getName()));
+        if (s->tag().size())
+            m.add("tag", s->tag());
     }
     return output;
 }
@@ -460,6 +774,37 @@ void PipelineManager::replace(Stage *sOld, Stage *sNew)
 }
 
 
+PipelineManagerPtr PipelineManager::clone() const
+{
+    PipelineManagerPtr mgr(new PipelineManager);
+
+    mgr->m_commonOptions = m_commonOptions;
+    mgr->m_stageOptions = m_stageOptions;
+    mgr->m_progressFd = m_progressFd;
+    mgr->m_metadataPolicy = m_metadataPolicy;
+    mgr->m_log = m_log;
+
+    std::map<Stage *, Stage *> copies;
+    for (Stage *s : m_stages)
+    {
+        Stage& copy = s->clone(*mgr->m_factory);
+        mgr->m_stages.push_back(&copy);
+        copies[s] = &copy;
+    }
+    for (Stage *s : m_stages)
+        for (Stage *in : s->getInputs())
+        {
+            auto it = copies.find(in);
+            if (it == copies.end())
+                throw pdal_error("Can't copy pipeline: stage '" +
+                    s->getName() + "' has an input that isn't part of "
+                    "the pipeline.");
+            copies[s]->setInput(*it->second);
+        }
+    return mgr;
+}
+
+
 void PipelineManager::destroyStage(Stage *s)
 {
     if (s)
@@ -42,6 +42,11 @@
 #include <vector>
 #include <string>
 
+namespace Json
+{
+    class Value;
+}
+
 namespace pdal
 {
 
@@ -67,9 +72,13 @@ public:
 
     void setProgressFd(int fd)
         { m_progressFd = fd; }
+    // Set the metadata policy of all current and future stages.
+    void setMetadataPolicy(MetadataPolicy policy);
 
     void readPipeline(std::istream& input);
     void readPipeline(const std::string& filename);
+    // Create the stages of an already parsed JSON pipeline.
+    void readPipeline(const Json::Value& root);
 
     // Use these to manually add stages into the pipeline manager.
     Stage& addReader(const std::string& type);
@@ -117,8 +126,16 @@ public:
 
     QuickInfo preview() const;
     void prepare() const;
-    point_count_t execute();
-    void executeStream(StreamPointTable& table);
+    // Remove dimensions that no stage uses from a prepared table's layout.
+    void pruneDimensions(PointTableRef table) const;
+    // Hand readers the bounds outside of which later stages drop points.
+    void pushdownBounds() const;
+    // Hand readers the number of points that later stages use.
+    void pushdownCount() const;
+    // Hand readers the positions of the points that later stages use.
+    void pushdownSelection() const;
+    point_count_t execute(int threads = 1);
+    void executeStream(StreamPointTable& table, int threads = 1);
     void validateStageOptions() const;
     bool pipelineStreamable() const;
 
@@ -128,9 +145,25 @@ public:
 
     // Get the point table data.
     PointTableRef pointTable() const
-        { return m_table; }
+        { return *m_tablePtr; }
+
+    // Save the output of pipeline stages to a cache directory and start
+    // later runs of the same stages from the saved points.  Only used for
+    // pipelines that are a single chain of stages.
+    void setCacheDir(const std::string& dir)
+        { m_cacheDir = dir; }
+
+    // Replace the point table used when running in standard mode.  Must
+    // be called before the pipeline is prepared or executed.
+    void setPointTable(std::unique_ptr<BasePointTable> table)
+        { m_tablePtr = std::move(table); }
 
     MetadataNode getMetadata() const;
+    // Get the metadata of a stage as it appears in getMetadata(), with
+    // the stage's profile added.
+    static MetadataNode getMetadata(const Stage& s);
+    // Get the execution statistics of each stage.
+    MetadataNode getProfile() const;
     Options& commonOptions()
         { return m_commonOptions; }
     OptionsMap& stageOptions()
@@ -141,22 +174,27 @@ public:
 
     const std::vector<Stage *> stages() const
         { return m_stages; }
+    // Create an unexecuted copy of the pipeline, with copies of its stages,
+    // that can be prepared and executed independently of this one.
+    std::unique_ptr<PipelineManager> clone() const;
     void destroyStage(Stage *s = nullptr);
 
 private:
     void setOptions(Stage& stage, const Options& addOps);
+    bool executeCached(int threads);
     Options stageOptions(Stage& stage);
 
     std::unique_ptr<StageFactory> m_factory;
-    std::unique_ptr<PointTable> m_tablePtr;
-    PointTableRef m_table;
+    std::unique_ptr<BasePointTable> m_tablePtr;
     Options m_commonOptions;
     OptionsMap m_stageOptions;
     PointViewSet m_viewSet;
     std::vector<Stage*> m_stages; // stage observer, never owner
     int m_progressFd;
+    MetadataPolicy m_metadataPolicy;
     std::istream *m_input;
     LogPtr m_log;
+    std::string m_cacheDir;
 
     PipelineManager& operator=(const PipelineManager&); // not implemented
     PipelineManager(const PipelineManager&); // not implemented
@@ -147,7 +147,12 @@ void PipelineReaderJSON::readPipeline(std::istream& input)
         err = "JSON pipeline: Unable to parse pipeline:\n" + err;
         throw pdal_error(err);
     }
+    readPipeline(root);
+}
+
 
+void PipelineReaderJSON::readPipeline(Json::Value& root)
+{
     if (root.isObject() && root.isMember("pipeline"))
     {
         parsePipeline(root["pipeline"]);
@@ -63,6 +63,7 @@ private:
     void parsePipeline(Json::Value&);
     void readPipeline(const std::string& filename);
     void readPipeline(std::istream& input);
+    void readPipeline(Json::Value& root);
     std::string extractType(Json::Value& node);
     std::string extractFilename(Json::Value& node);
     std::string extractTag(Json::Value& node, TagMap& tags);
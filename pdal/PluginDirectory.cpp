@@ -36,6 +36,10 @@
 #include <pdal/util/FileUtils.hpp>
 #include <pdal/pdal_config.hpp>
 
+#include <json/json.h>
+
+#include <ctime>
+
 namespace pdal
 {
 
@@ -111,30 +115,165 @@ std::string validPlugin(const std::string& path, const StringList& types)
     return type + "s." + file;
 }
 
+// The plugin cache is a JSON file that holds the plugins found in each
+// search directory along with the directory's modification time.  A
+// directory is only rescanned when its modification time changes.
+std::string pluginCacheFile()
+{
+    std::string filename;
+
+    // Setting PDAL_PLUGIN_CACHE to an empty value or "off" disables caching.
+    if (Utils::getenv("PDAL_PLUGIN_CACHE", filename) == 0)
+        return (filename == "off") ? std::string() : filename;
+
+    std::string dir;
+#ifdef _WIN32
+    Utils::getenv("LOCALAPPDATA", dir);
+#else
+    Utils::getenv("XDG_CACHE_HOME", dir);
+    if (dir.empty() && Utils::getenv("HOME", dir) == 0 && dir.size())
+        dir = FileUtils::toAbsolutePath(".cache", dir);
+#endif
+    if (dir.empty())
+        return std::string();
+    return FileUtils::toAbsolutePath("pdal/plugins.json", dir);
+}
+
+
+Json::Value readPluginCache(const std::string& filename)
+{
+    Json::Value cache;
+
+    if (filename.empty() || !FileUtils::fileExists(filename))
+        return cache;
+
+    Json::CharReaderBuilder builder;
+    std::string err;
+    std::istream *in = FileUtils::openFile(filename, false);
+    if (!in)
+        return cache;
+    try
+    {
+        if (!Json::parseFromStream(builder, *in, &cache, &err) ||
+            !cache.isObject() || !cache["pdal_version"].isString() ||
+            cache["pdal_version"].asString() != Config::fullVersionString())
+            cache = Json::Value();
+    }
+    catch (...)
+    {
+        cache = Json::Value();
+    }
+    FileUtils::closeFile(in);
+    return cache;
+}
+
+
+// Write to a temporary file and rename it into place so that concurrent
+// processes never see a partial cache.  Failure just means that the
+// next process rescans the plugin directories.
+void writePluginCache(const std::string& filename, const Json::Value& cache)
+{
+    std::string tempFile;
+    try
+    {
+        std::string dir = FileUtils::getDirectory(filename);
+        if (dir.size() && !FileUtils::directoryExists(dir))
+            FileUtils::createDirectories(dir);
+        tempFile = FileUtils::uniqueFilename(dir, "plugins");
+
+        std::ostream *out = FileUtils::createFile(tempFile, false);
+        if (!out)
+            return;
+        *out << cache;
+        bool ok = out->good();
+        FileUtils::closeFile(out);
+        if (ok)
+            FileUtils::renameFile(filename, tempFile);
+        else
+            FileUtils::deleteFile(tempFile);
+    }
+    catch (...)
+    {
+        if (tempFile.size() && FileUtils::fileExists(tempFile))
+            FileUtils::deleteFile(tempFile);
+    }
+}
+
+
+Json::Value scanPluginDirectory(const std::string& dir, int64_t mtime)
+{
+    Json::Value entry(Json::objectValue);
+    Json::Value& kernels = entry["kernels"] = Json::Value(Json::objectValue);
+    Json::Value& drivers = entry["drivers"] = Json::Value(Json::objectValue);
+
+    // A directory changed during the current second might change again
+    // without its time changing, so don't trust it on the next run.
+    if (mtime >= (int64_t)std::time(nullptr))
+        entry["mtime"] = (Json::Int64)-2;
+    else
+        entry["mtime"] = (Json::Int64)mtime;
+    if (mtime < 0)
+        return entry;
+
+    StringList files = FileUtils::directoryList(dir);
+    for (auto& file : files)
+    {
+        file = FileUtils::toAbsolutePath(file);
+
+        std::string plugin;
+        plugin = validPlugin(file, {"kernel"});
+        if (plugin.size())
+        {
+            if (!kernels.isMember(plugin))
+                kernels[plugin] = file;
+            continue;
+        }
+        plugin = validPlugin(file, {"reader", "writer", "filter"});
+        if (plugin.size() && !drivers.isMember(plugin))
+            drivers[plugin] = file;
+    }
+    return entry;
+}
+
 } // unnamed namespace;
 
 
 PluginDirectory::PluginDirectory()
 {
+    const std::string cacheFile = pluginCacheFile();
+    Json::Value cache = readPluginCache(cacheFile);
+    bool changed = !cache.isObject();
+
+    cache["pdal_version"] = Config::fullVersionString();
+    Json::Value& dirs = cache["directories"];
+    if (!dirs.isObject())
+        dirs = Json::Value(Json::objectValue);
     for (const auto& dir : pluginSearchPaths())
     {
-        StringList files = FileUtils::directoryList(dir);
-        for (auto& file : files)
+        const std::string absDir = FileUtils::toAbsolutePath(dir);
+        const int64_t mtime = FileUtils::lastWriteTime(absDir);
+
+        Json::Value& entry = dirs[absDir];
+        if (!entry.isObject() || !entry["mtime"].isInt64() ||
+            entry["mtime"].asInt64() != mtime ||
+            !entry["kernels"].isObject() || !entry["drivers"].isObject())
         {
-            file = FileUtils::toAbsolutePath(file);
-
-            std::string plugin;
-            plugin = validPlugin(file, {"kernel"});
-            if (plugin.size())
-            {
-                m_kernels.insert(std::make_pair(plugin, file));
-                continue;
-            }
-            plugin = validPlugin(file, {"reader", "writer", "filter"});
-            if (plugin.size())
-                m_drivers.insert(std::make_pair(plugin, file));
+            entry = scanPluginDirectory(dir, mtime);
+            changed = true;
         }
+
+        auto load = [](const Json::Value& plugins,
+            std::map<std::string, std::string>& m)
+        {
+            for (const std::string& name : plugins.getMemberNames())
+                if (plugins[name].isString())
+                    m.insert(std::make_pair(name, plugins[name].asString()));
+        };
+        load(entry["kernels"], m_kernels);
+        load(entry["drivers"], m_drivers);
     }
+    if (changed && cacheFile.size())
+        writePluginCache(cacheFile, cache);
 }
 
 StringList PluginDirectory::test_pluginSearchPaths()
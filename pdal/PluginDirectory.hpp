@@ -51,6 +51,7 @@ class PluginDirectory
 {
     FRIEND_TEST(PluginManagerTest, SearchPaths);
     FRIEND_TEST(PluginManagerTest, validnames);
+    FRIEND_TEST(PluginManagerTest, cache);
 
 private:
     PluginDirectory();
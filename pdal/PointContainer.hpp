@@ -46,11 +46,32 @@ class PDAL_DLL PointContainer
     friend class PointTable;
     friend class PointView;
     friend class PointRef;
+    friend class StreamPointTable;
 private:
     virtual void setFieldInternal(Dimension::Id dim, PointId idx,
         const void *val) = 0;
     virtual void getFieldInternal(Dimension::Id dim, PointId idx,
         void *val) const = 0;
+
+    // Set or get the values of a dimension for a list of points.  Values
+    // are packed in the buffer as the dimension's type.  Containers
+    // override these to avoid a virtual call for each value.
+    virtual void setFieldsInternal(Dimension::Id dim, const PointId *ids,
+        point_count_t count, const void *val)
+    {
+        const char *buf = (const char *)val;
+        const size_t size = layout()->dimSize(dim);
+        for (point_count_t i = 0; i < count; ++i, buf += size)
+            setFieldInternal(dim, ids[i], buf);
+    }
+    virtual void getFieldsInternal(Dimension::Id dim, const PointId *ids,
+        point_count_t count, void *val) const
+    {
+        char *buf = (char *)val;
+        const size_t size = layout()->dimSize(dim);
+        for (point_count_t i = 0; i < count; ++i, buf += size)
+            getFieldInternal(dim, ids[i], buf);
+    }
 public:
     virtual PointLayoutPtr layout() const = 0;
 };
@@ -0,0 +1,310 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (hobu.inc@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include <pdal/pdal_internal.hpp>
+
+namespace pdal
+{
+
+/**
+  The list of table point IDs that make up a PointView.  Views usually
+  refer to consecutive points of their table, as when points come straight
+  from a reader, so the list is stored in chunks that each hold either a
+  run of consecutive IDs or, once a chunk has been filtered or reordered,
+  the IDs themselves.  A run costs a few bytes no matter how many points
+  it covers.
+*/
+class PointIndex
+{
+public:
+    PointIndex() : m_size(0), m_reserved(0)
+    {}
+
+    std::size_t size() const
+        { return m_size; }
+    bool empty() const
+        { return m_size == 0; }
+
+    PointId operator[](std::size_t i) const
+    {
+        const Chunk& c = m_chunks[i >> ChunkBits];
+        const std::size_t off = i & ChunkMask;
+        return c.m_ids.empty() ? c.m_start + off : c.m_ids[off];
+    }
+
+    PointId at(std::size_t i) const
+    {
+        if (i >= m_size)
+            throw std::out_of_range("Point index out of range.");
+        return (*this)[i];
+    }
+
+    /**
+      Change the ID at a position in the list.
+
+      \param i  Position in the list.
+      \param id  New point ID.
+    */
+    void set(std::size_t i, PointId id)
+    {
+        Chunk& c = m_chunks[i >> ChunkBits];
+        const std::size_t off = i & ChunkMask;
+        if (c.m_ids.empty())
+        {
+            if (id == c.m_start + off)
+                return;
+            materialize(c, chunkEntries(i >> ChunkBits));
+        }
+        c.m_ids[off] = id;
+    }
+
+    void push_back(PointId id)
+    {
+        const std::size_t off = m_size & ChunkMask;
+        if (off == 0)
+            m_chunks.push_back(Chunk(id));
+        else
+        {
+            Chunk& c = m_chunks.back();
+            if (c.m_ids.empty())
+            {
+                if (id != c.m_start + off)
+                {
+                    materialize(c, off);
+                    c.m_ids.reserve(reservedEntries());
+                    c.m_ids.push_back(id);
+                }
+            }
+            else
+                c.m_ids.push_back(id);
+        }
+        m_size++;
+    }
+
+    /**
+      Append a run of consecutive point IDs.
+
+      \param start  First point ID.
+      \param count  Number of IDs.
+    */
+    void pushRun(PointId start, std::size_t count)
+    {
+        while (count)
+        {
+            const std::size_t off = m_size & ChunkMask;
+            const std::size_t n =
+                (std::min)(count, (std::size_t)ChunkSize - off);
+            if (off == 0)
+                m_chunks.push_back(Chunk(start));
+            else
+            {
+                Chunk& c = m_chunks.back();
+                if (c.m_ids.empty() && start != c.m_start + off)
+                {
+                    materialize(c, off);
+                    c.m_ids.reserve(reservedEntries());
+                }
+                for (std::size_t i = 0; !c.m_ids.empty() && i < n; ++i)
+                    c.m_ids.push_back(start + i);
+            }
+            m_size += n;
+            start += n;
+            count -= n;
+        }
+    }
+
+    /**
+      Append the first 'count' IDs of a list, which may be this one.
+
+      \param other  List whose IDs should be appended.
+      \param count  Number of IDs to append.
+    */
+    void append(const PointIndex& other, std::size_t count)
+    {
+        if (&other == this)
+        {
+            PointIndex copy(*this);
+            append(copy, count);
+            return;
+        }
+        reserve(m_size + count);
+        for (std::size_t k = 0; count; ++k)
+        {
+            const Chunk& c = other.m_chunks[k];
+            const std::size_t n = (std::min)(count, (std::size_t)ChunkSize);
+            if (c.m_ids.empty())
+                pushRun(c.m_start, n);
+            else
+                for (std::size_t i = 0; i < n; ++i)
+                    push_back(c.m_ids[i]);
+            count -= n;
+        }
+    }
+
+    /**
+      Copy a range of the list to an array.
+
+      \param begin  Position of the first ID to copy.
+      \param count  Number of IDs to copy.
+      \param out  Array to hold \ref count IDs.
+    */
+    void copy(std::size_t begin, std::size_t count, PointId *out) const
+    {
+        while (count)
+        {
+            const Chunk& c = m_chunks[begin >> ChunkBits];
+            const std::size_t off = begin & ChunkMask;
+            const std::size_t n =
+                (std::min)(count, (std::size_t)ChunkSize - off);
+            if (c.m_ids.empty())
+                for (std::size_t i = 0; i < n; ++i)
+                    *out++ = c.m_start + off + i;
+            else
+            {
+                std::copy(c.m_ids.begin() + off, c.m_ids.begin() + off + n,
+                    out);
+                out += n;
+            }
+            begin += n;
+            count -= n;
+        }
+    }
+
+    /**
+      Shorten or lengthen the list.  Entries added when the list is
+      lengthened are zero.
+
+      \param size  New size of the list.
+    */
+    void resize(std::size_t size)
+    {
+        if (size >= m_size)
+        {
+            while (m_size < size)
+                push_back(0);
+            return;
+        }
+        const std::size_t chunks = (size + ChunkSize - 1) >> ChunkBits;
+        m_chunks.erase(m_chunks.begin() + chunks, m_chunks.end());
+        if (m_chunks.size() && !m_chunks.back().m_ids.empty())
+            m_chunks.back().m_ids.resize(size - ((m_chunks.size() - 1) <<
+                ChunkBits));
+        m_size = size;
+    }
+
+    void clear()
+    {
+        m_chunks.clear();
+        m_size = 0;
+        m_reserved = 0;
+    }
+
+    /**
+      Make room for the list to grow to a size without reallocating.  A
+      run that has to be replaced by explicit IDs also gets room for the
+      positions up to this size.
+
+      \param size  Expected size of the list.
+    */
+    void reserve(std::size_t size)
+    {
+        m_chunks.reserve((size + ChunkSize - 1) >> ChunkBits);
+        m_reserved = (std::max)(m_reserved, size);
+    }
+
+    /**
+      Get the number of bytes used to hold the list.
+
+      \return  Bytes used to hold the list.
+    */
+    std::size_t memoryUsed() const
+    {
+        std::size_t bytes = m_chunks.capacity() * sizeof(Chunk);
+        for (const Chunk& c : m_chunks)
+            bytes += c.m_ids.capacity() * sizeof(PointId);
+        return bytes;
+    }
+
+private:
+    // Each chunk holds the IDs of up to 65536 positions in the list.  A
+    // chunk with no explicit IDs holds the run m_start, m_start + 1, ...
+    struct Chunk
+    {
+        Chunk(PointId start) : m_start(start)
+        {}
+
+        PointId m_start;
+        std::vector<PointId> m_ids;
+    };
+
+    enum { ChunkBits = 16, ChunkSize = 1 << ChunkBits,
+        ChunkMask = ChunkSize - 1 };
+
+    // Number of positions held by a chunk.
+    std::size_t chunkEntries(std::size_t k) const
+    {
+        return (k + 1 == m_chunks.size()) ?
+            m_size - (k << ChunkBits) : (std::size_t)ChunkSize;
+    }
+
+    // Number of positions of the last chunk covered by reserve().
+    std::size_t reservedEntries() const
+    {
+        const std::size_t start = (m_chunks.size() - 1) << ChunkBits;
+        return m_reserved > start ?
+            (std::min)(m_reserved - start, (std::size_t)ChunkSize) : 0;
+    }
+
+    // Replace a run with the explicit IDs of its first 'count' positions.
+    static void materialize(Chunk& c, std::size_t count)
+    {
+        c.m_ids.resize(count);
+        for (std::size_t i = 0; i < count; ++i)
+            c.m_ids[i] = c.m_start + i;
+    }
+
+    std::vector<Chunk> m_chunks;
+    std::size_t m_size;
+    // Size passed to reserve().
+    std::size_t m_reserved;
+};
+
+} // namespace pdal
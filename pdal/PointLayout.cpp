@@ -45,6 +45,8 @@ PointLayout::PointLayout()
     , m_nextFree(Dimension::PROPRIETARY)
     , m_pointSize(0)
     , m_finalized(false)
+    , m_aligned(false)
+    , m_scaled(false)
 {
     int id = 0;
     for (auto& d : m_detail)
@@ -57,10 +59,86 @@ PointLayout::PointLayout()
 
 void PointLayout::finalize()
 {
+    // Scaled dimensions get their transforms once all sources have had a
+    // chance to offer theirs.
+    if (m_scaled && !m_finalized)
+    {
+        const Dimension::Id xyz[] { Dimension::Id::X, Dimension::Id::Y,
+            Dimension::Id::Z };
+        for (int i = 0; i < 3; ++i)
+        {
+            XForm& xf = m_xforms[i];
+            if (xf.m_scale.m_auto)
+                throw pdal_error("Can't store " + Dimension::name(xyz[i]) +
+                    " as a scaled integer: scale is 'auto' and no source "
+                    "provided one.");
+            if (xf.m_offset.m_auto)
+                xf.m_offset = XForm::XFormComponent(0.0);
+            Dimension::Detail& dd = m_detail[Utils::toNative(xyz[i])];
+            if (dd.scaled())
+                dd.setXForm(xf);
+        }
+    }
+    if (m_aligned && !m_finalized)
+    {
+        size_t align = 1;
+        for (auto id : m_used)
+            align = (std::max)(align, dimSize(id));
+        m_pointSize = (m_pointSize + align - 1) / align * align;
+    }
     m_finalized = true;
 }
 
 
+void PointLayout::setAligned(bool aligned)
+{
+    if (m_finalized)
+        throw pdal_error("Can't update layout after points have been added.");
+    m_aligned = aligned;
+}
+
+
+void PointLayout::setScaling(const XForm& x, const XForm& y, const XForm& z)
+{
+    if (m_finalized)
+        throw pdal_error("Can't update layout after points have been added.");
+    for (const XForm *xf : { &x, &y, &z })
+        if (!xf->m_scale.m_auto && xf->m_scale.m_val == 0)
+            throw pdal_error("Scale of a scaled dimension can't be zero.");
+
+    m_scaled = true;
+    m_xforms[0] = x;
+    m_xforms[1] = y;
+    m_xforms[2] = z;
+
+    // Dimensions that are already registered are switched to scaled
+    // storage.
+    for (Dimension::Id id : { Dimension::Id::X, Dimension::Id::Y,
+            Dimension::Id::Z })
+        if (hasDim(id))
+            registerDim(id, Dimension::Type::Double);
+}
+
+
+void PointLayout::proposeScaling(const XForm& x, const XForm& y,
+    const XForm& z)
+{
+    if (!m_scaled || m_finalized)
+        return;
+
+    const XForm *proposed[] { &x, &y, &z };
+    for (int i = 0; i < 3; ++i)
+    {
+        XForm& xf = m_xforms[i];
+        if (xf.m_scale.m_auto && !proposed[i]->m_scale.m_auto &&
+                proposed[i]->m_scale.m_val != 0)
+            xf.m_scale = XForm::XFormComponent(proposed[i]->m_scale.m_val);
+        if (xf.m_offset.m_auto && !proposed[i]->m_offset.m_auto)
+            xf.m_offset = XForm::XFormComponent(proposed[i]->m_offset.m_val);
+    }
+}
+
+
 void PointLayout::registerDims(std::vector<Dimension::Id> ids)
 {
     for (auto ii = ids.begin(); ii != ids.end(); ++ii)
@@ -84,7 +162,14 @@ void PointLayout::registerDim(Dimension::Id id)
 void PointLayout::registerDim(Dimension::Id id, Dimension::Type type)
 {
     Dimension::Detail dd = m_detail[Utils::toNative(id)];
-    dd.setType(resolveType(type, dd.type()));
+    if (m_scaled && (id == Dimension::Id::X || id == Dimension::Id::Y ||
+            id == Dimension::Id::Z))
+    {
+        dd.setType(Dimension::Type::Double);
+        dd.setScaled(true);
+    }
+    else
+        dd.setType(resolveType(type, dd.type()));
     update(dd, Dimension::name(id));
 }
 
@@ -127,6 +212,34 @@ Dimension::Id PointLayout::registerOrAssignDim(const std::string name,
 }
 
 
+void PointLayout::removeDim(Dimension::Id id)
+{
+    if (m_finalized)
+        throw pdal_error("Can't update layout after points have been added.");
+
+    auto ui = std::find(m_used.begin(), m_used.end(), id);
+    if (ui == m_used.end())
+        return;
+    m_used.erase(ui);
+
+    // Dimensions are sorted, so moving the ones that followed the removed
+    // dimension down by its size keeps them sorted.
+    Dimension::Detail& dd = m_detail[Utils::toNative(id)];
+    int offset = dd.offset();
+    int size = (int)dd.size();
+    for (auto uid : m_used)
+    {
+        Dimension::Detail& d = m_detail[Utils::toNative(uid)];
+        if (d.offset() > offset)
+            d.setOffset(d.offset() - size);
+    }
+    m_pointSize -= size;
+
+    dd = Dimension::Detail();
+    dd.setId(id);
+}
+
+
 DimTypeList PointLayout::dimTypes() const
 {
     DimTypeList dimTypes;
@@ -262,6 +375,8 @@ bool PointLayout::update(Dimension::Detail dd, const std::string& name)
         //NOTE - I tried forcing all points to be aligned on 8-byte boundaries
         // in case this would matter to the optimized memcpy, but it made
         // no difference.  No sense wasting space for no difference.
+        // Padding is applied in finalize() when asked for with
+        // setAligned(), for code that reads fields with aligned loads.
         m_pointSize = (size_t)offset;
     }
 
@@ -326,6 +441,12 @@ MetadataNode PointLayout::toMetadata() const
         Dimension::Type t = dimType(id);
         dim.add("type", Dimension::toName(Dimension::base(t)));
         dim.add("size", dimSize(id));
+        const Dimension::Detail *dd = dimDetail(id);
+        if (dd->scaled())
+        {
+            dim.add("scale", dd->xform().m_scale.m_val);
+            dim.add("offset", dd->xform().m_offset.m_val);
+        }
         root.addList(dim);
     }
 
@@ -69,6 +69,61 @@ public:
     PDAL_DLL bool finalized() const
         { return m_finalized; }
 
+    /**
+      Pad points to a multiple of the size of their largest dimension
+      when the layout is finalized.  Dimensions are placed in order of
+      decreasing size, so each is aligned within a point.  Padding keeps
+      them aligned in every point of contiguous storage, at the cost of
+      up to seven bytes a point.
+
+      \param aligned  Whether points should be padded.
+    */
+    PDAL_DLL void setAligned(bool aligned);
+
+    /**
+      Determine if points are padded when the layout is finalized.
+
+      \return  Whether points are padded.
+    */
+    PDAL_DLL bool aligned() const
+        { return m_aligned; }
+
+    /**
+      Store X, Y and Z as 32-bit integers, like LAS does, rather than as
+      doubles.  Values are still read and written as doubles and are
+      converted with the transforms, so points take twelve fewer bytes at
+      the cost of rounding coordinates to the scale.  Scale or offset
+      components set to 'auto' are taken from the first data source that
+      offers its own (see \ref proposeScaling()).  An offset that no source
+      offers is zero.
+
+      \param x  Transform of X values.
+      \param y  Transform of Y values.
+      \param z  Transform of Z values.
+    */
+    PDAL_DLL void setScaling(const XForm& x, const XForm& y, const XForm& z);
+
+    /**
+      Offer the transforms with which a data source stores X, Y and Z.
+      They fill in the components of the transforms passed to
+      \ref setScaling() that are 'auto' and haven't been filled in by an
+      earlier source.  Does nothing if X, Y and Z aren't scaled.
+
+      \param x  Transform of X values.
+      \param y  Transform of Y values.
+      \param z  Transform of Z values.
+    */
+    PDAL_DLL void proposeScaling(const XForm& x, const XForm& y,
+        const XForm& z);
+
+    /**
+      Determine if X, Y and Z are stored as scaled integers.
+
+      \return  Whether X, Y and Z are scaled.
+    */
+    PDAL_DLL bool scaled() const
+        { return m_scaled; }
+
     /**
       Register a vector of dimensions.
 
@@ -130,6 +185,15 @@ public:
     PDAL_DLL Dimension::Id registerOrAssignDim(const std::string name,
         Dimension::Type type);
 
+    /**
+      Remove a dimension from the layout.  The dimensions that follow it in
+      a point are moved to close the gap.  This does nothing if the
+      dimension isn't part of the layout.
+
+      \param id  ID of the dimension to remove.
+    */
+    PDAL_DLL void removeDim(Dimension::Id id);
+
     /**
       Get a list of DimType objects that define the layout.
 
@@ -249,6 +313,9 @@ protected:
     int m_nextFree;
     std::size_t m_pointSize;
     bool m_finalized;
+    bool m_aligned;
+    bool m_scaled;
+    XForm m_xforms[3];
 };
 
 typedef PointLayout* PointLayoutPtr;
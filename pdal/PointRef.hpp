@@ -44,6 +44,7 @@ namespace pdal
 
 class PDAL_DLL PointRef
 {
+    template<Dimension::Id ID, typename T> friend class TypedDim;
 public:
     PointRef(PointContainer& container, PointId idx = 0) :
         m_container(container), m_layout(*container.layout()), m_idx(idx)
@@ -73,10 +74,16 @@ public:
         T val(0);
         bool success = true;
         Everything e;
-        Dimension::Type type = m_layout.dimDetail(dim)->type();
+        const Dimension::Detail *dd = m_layout.dimDetail(dim);
+        Dimension::Type type = dd->type();
 
         m_container.getFieldInternal(dim, m_idx, &e);
-        switch (type)
+        if (dd->scaled())
+        {
+            e.d = dd->xform().fromScaled(e.s32);
+            success = Utils::numericCast(e.d, val);
+        }
+        else switch (type)
         {
         case Dimension::Type::Unsigned8:
             success = Utils::numericCast(e.u8, val);
@@ -134,11 +141,18 @@ public:
     template<typename T>
     void setField(Dimension::Id dim, T val)
     {
-        Dimension::Type type = m_layout.dimDetail(dim)->type();
+        const Dimension::Detail *dd = m_layout.dimDetail(dim);
+        Dimension::Type type = dd->type();
         Everything e;
         bool success = false;
 
-        switch (type)
+        if (dd->scaled())
+        {
+            double d;
+            success = Utils::numericCast(val, d) &&
+                Utils::numericCast(dd->xform().toScaled(d), e.s32);
+        }
+        else switch (type)
         {
         case Dimension::Type::Unsigned8:
             success = Utils::numericCast(val, e.u8);
@@ -177,6 +191,34 @@ public:
             m_container.setFieldInternal(dim, m_idx, &e);
     }
 
+    /**
+      Get the stored integer of a dimension kept as a scaled integer
+      (see PointLayout::setScaling()), without converting it.
+
+      \param dim  Scaled dimension.
+      \return  Stored value.
+    */
+    int32_t getScaledField(Dimension::Id dim) const
+    {
+        assert(m_layout.dimDetail(dim)->scaled());
+        int32_t val;
+        m_container.getFieldInternal(dim, m_idx, &val);
+        return val;
+    }
+
+    /**
+      Set the stored integer of a dimension kept as a scaled integer,
+      without converting it.
+
+      \param dim  Scaled dimension.
+      \param val  Value to store.
+    */
+    void setScaledField(Dimension::Id dim, int32_t val)
+    {
+        assert(m_layout.dimDetail(dim)->scaled());
+        m_container.setFieldInternal(dim, m_idx, &val);
+    }
+
     /**
       Set the ID of a PointRef.
 
@@ -229,6 +271,13 @@ public:
 
 
 private:
+    // Access without conversion, for callers that have checked that the
+    // value is of the dimension's type.
+    void getFieldDirect(Dimension::Id dim, void *val) const
+        { m_container.getFieldInternal(dim, m_idx, val); }
+    void setFieldDirect(Dimension::Id dim, const void *val)
+        { m_container.setFieldInternal(dim, m_idx, val); }
+
     PointContainer& m_container;
     PointLayout& m_layout;
     PointId m_idx;
@@ -0,0 +1,125 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (hobu.inc@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <algorithm>
+#include <limits>
+
+#include <pdal/pdal_internal.hpp>
+
+namespace pdal
+{
+
+/**
+  Points picked by their position in the output of a reader: the points
+  at positions offset, offset + step, offset + 2 * step, ... that come
+  before the limit.  Stages that keep points by position, like
+  filters.decimation and filters.head, narrow a selection so that readers
+  able to skip records can read only the points that are kept.
+*/
+struct PointSelection
+{
+    PointSelection() : m_offset(0), m_step(1),
+        m_limit((std::numeric_limits<point_count_t>::max)())
+    {}
+
+    point_count_t m_offset;
+    point_count_t m_step;
+    point_count_t m_limit;
+
+    /**
+      Determine whether every point is selected.
+    */
+    bool all() const
+    {
+        return m_offset == 0 && m_step == 1 &&
+            m_limit == (std::numeric_limits<point_count_t>::max)();
+    }
+
+    /**
+      Get the number of selected points.
+    */
+    point_count_t size() const
+    {
+        return m_limit <= m_offset ? 0 : (m_limit - m_offset - 1) / m_step + 1;
+    }
+
+    /**
+      Get the position of the first selected point at or after a position.
+
+      \param pos  Position at which to start.
+      \return  Position of a selected point or, if there is none, a
+        position at or past the limit.
+    */
+    point_count_t next(point_count_t pos) const
+    {
+        if (pos >= m_limit)
+            return pos;
+        if (pos <= m_offset)
+            return m_offset;
+        const point_count_t past = (pos - m_offset) % m_step;
+        if (past == 0)
+            return pos;
+        if (m_limit - pos <= m_step - past)
+            return m_limit;
+        return pos + m_step - past;
+    }
+
+    /**
+      Narrow the selection to some of the points it already selects.  The
+      arguments refer to the selected points as if they had been numbered
+      from zero.
+
+      \param offset  Number of the first point to keep.
+      \param step  Distance between kept points.
+      \param limit  Number of the point at which to stop.
+    */
+    void select(point_count_t offset, point_count_t step,
+        point_count_t limit)
+    {
+        const point_count_t count = size();
+        auto position = [this, count](point_count_t n)
+            { return n < count ? m_offset + n * m_step : m_limit; };
+
+        const point_count_t first = position(offset);
+        m_limit = position(limit);
+        m_step = step < count ? m_step * step :
+            (std::numeric_limits<point_count_t>::max)();
+        m_offset = first;
+    }
+};
+
+} // namespace pdal
@@ -32,14 +32,26 @@
 * OF SUCH DAMAGE.
 ****************************************************************************/
 
+#include <cstring>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
 #include <pdal/ArtifactManager.hpp>
 #include <pdal/PointTable.hpp>
+#include <pdal/pdal_features.hpp>
+#ifdef PDAL_HAVE_ZSTD
+#include <pdal/compression/ZstdCompression.hpp>
+#elif defined(PDAL_HAVE_ZLIB)
+#include <pdal/compression/DeflateCompression.hpp>
+#endif
 
 namespace pdal
 {
 
 BasePointTable::BasePointTable(PointLayout& layout) :
-    m_metadata(new Metadata()), m_layoutRef(layout)
+    m_metadata(new Metadata()), m_layoutRef(layout), m_memoryLimit(0)
 {}
 
 
@@ -47,6 +59,18 @@ BasePointTable::~BasePointTable()
 {}
 
 
+void BasePointTable::checkMemoryLimit(uint64_t allocated,
+    uint64_t bytes) const
+{
+    if (!withinMemoryLimit(allocated, bytes))
+        throw pdal_error("Point storage exceeds the memory limit of " +
+            std::to_string(m_memoryLimit / (1024 * 1024)) + " MB after " +
+            std::to_string(allocated / (1024 * 1024)) + " MB.  Raise the "
+            "limit or store points in a 'mapped' table, which spills them "
+            "to disk.");
+}
+
+
 MetadataNode BasePointTable::privateMetadata(const std::string& name)
 {
     MetadataNode mp = m_metadata->m_private;
@@ -99,19 +123,276 @@ void SimplePointTable::getFieldInternal(Dimension::Id id, PointId idx,
 }
 
 
+void SimplePointTable::setFieldsInternal(Dimension::Id id,
+    const PointId *ids, point_count_t count, const void *value)
+{
+    const Dimension::Detail *d = m_layoutRef.dimDetail(id);
+    const size_t size = d->size();
+    const char *src = (const char *)value;
+
+    for (point_count_t i = 0; i < count; ++i, src += size)
+        std::memcpy(getDimension(d, ids[i]), src, size);
+}
+
+
+void SimplePointTable::getFieldsInternal(Dimension::Id id,
+    const PointId *ids, point_count_t count, void *value) const
+{
+    const Dimension::Detail *d = m_layoutRef.dimDetail(id);
+    const size_t size = d->size();
+    char *dst = (char *)value;
+
+    for (point_count_t i = 0; i < count; ++i, dst += size)
+        std::memcpy(dst, getDimension(d, ids[i]), size);
+}
+
+
+namespace
+{
+
+const point_count_t BulkCount = 1024;
+
+template<typename T>
+void toDouble(const void *raw, point_count_t count, double *out)
+{
+    const T *in = (const T *)raw;
+    for (point_count_t i = 0; i < count; ++i)
+        out[i] = (double)in[i];
+}
+
+// Convert values, dropping those that don't fit in T.  The IDs of the
+// points whose values were kept are stored in ids.
+template<typename T>
+point_count_t fromDouble(const double *in, PointId begin,
+    point_count_t count, PointId *ids, void *raw)
+{
+    T *out = (T *)raw;
+    point_count_t n = 0;
+    for (point_count_t i = 0; i < count; ++i)
+        if (Utils::numericCast(in[i], out[n]))
+            ids[n++] = begin + i;
+    return n;
+}
+
+} // unnamed namespace
+
+
+void StreamPointTable::getFieldArray(Dimension::Id dim, PointId begin,
+    point_count_t count, double *out) const
+{
+    // Call through the container so that the table's bulk accessors,
+    // which are private to SimplePointTable, are used.
+    const PointContainer& container = *this;
+    const Dimension::Detail *dd = layout()->dimDetail(dim);
+    const Dimension::Type type = dd->type();
+    PointId ids[BulkCount];
+    double raw[BulkCount];
+
+    while (count)
+    {
+        point_count_t n = (std::min)(count, BulkCount);
+        for (point_count_t i = 0; i < n; ++i)
+            ids[i] = begin + i;
+
+        // Scaled dimensions are stored as 32-bit integers and are always
+        // converted.
+        if (dd->scaled())
+        {
+            container.getFieldsInternal(dim, ids, n, raw);
+            const int32_t *scaled = (const int32_t *)raw;
+            for (point_count_t i = 0; i < n; ++i)
+                out[i] = dd->xform().fromScaled(scaled[i]);
+            begin += n;
+            out += n;
+            count -= n;
+            continue;
+        }
+
+        // When the dimension is a double the table fills the buffer
+        // directly.
+        if (type == Dimension::Type::Double)
+            container.getFieldsInternal(dim, ids, n, out);
+        else if (type != Dimension::Type::None)
+            container.getFieldsInternal(dim, ids, n, raw);
+
+        switch (type)
+        {
+        case Dimension::Type::Float:
+            toDouble<float>(raw, n, out);
+            break;
+        case Dimension::Type::Double:
+            break;
+        case Dimension::Type::Signed8:
+            toDouble<int8_t>(raw, n, out);
+            break;
+        case Dimension::Type::Signed16:
+            toDouble<int16_t>(raw, n, out);
+            break;
+        case Dimension::Type::Signed32:
+            toDouble<int32_t>(raw, n, out);
+            break;
+        case Dimension::Type::Signed64:
+            toDouble<int64_t>(raw, n, out);
+            break;
+        case Dimension::Type::Unsigned8:
+            toDouble<uint8_t>(raw, n, out);
+            break;
+        case Dimension::Type::Unsigned16:
+            toDouble<uint16_t>(raw, n, out);
+            break;
+        case Dimension::Type::Unsigned32:
+            toDouble<uint32_t>(raw, n, out);
+            break;
+        case Dimension::Type::Unsigned64:
+            toDouble<uint64_t>(raw, n, out);
+            break;
+        case Dimension::Type::None:
+        default:
+            std::fill(out, out + n, 0.0);
+            break;
+        }
+        begin += n;
+        out += n;
+        count -= n;
+    }
+}
+
+
+void StreamPointTable::setFieldArray(Dimension::Id dim, PointId begin,
+    point_count_t count, const double *in)
+{
+    PointContainer& container = *this;
+    const Dimension::Detail *dd = layout()->dimDetail(dim);
+    const Dimension::Type type = dd->scaled() ? Dimension::Type::None :
+        dd->type();
+    PointId ids[BulkCount];
+    double raw[BulkCount];
+
+    while (count)
+    {
+        point_count_t n = (std::min)(count, BulkCount);
+        point_count_t kept = 0;
+        if (dd->scaled())
+        {
+            // Values that don't fit in the scaled integers are dropped,
+            // as they are for other types.
+            int32_t *scaled = (int32_t *)raw;
+            for (point_count_t i = 0; i < n; ++i)
+                if (Utils::numericCast(dd->xform().toScaled(in[i]),
+                        scaled[kept]))
+                    ids[kept++] = begin + i;
+        }
+        switch (type)
+        {
+        case Dimension::Type::Float:
+            kept = fromDouble<float>(in, begin, n, ids, raw);
+            break;
+        case Dimension::Type::Double:
+            kept = fromDouble<double>(in, begin, n, ids, raw);
+            break;
+        case Dimension::Type::Signed8:
+            kept = fromDouble<int8_t>(in, begin, n, ids, raw);
+            break;
+        case Dimension::Type::Signed16:
+            kept = fromDouble<int16_t>(in, begin, n, ids, raw);
+            break;
+        case Dimension::Type::Signed32:
+            kept = fromDouble<int32_t>(in, begin, n, ids, raw);
+            break;
+        case Dimension::Type::Signed64:
+            kept = fromDouble<int64_t>(in, begin, n, ids, raw);
+            break;
+        case Dimension::Type::Unsigned8:
+            kept = fromDouble<uint8_t>(in, begin, n, ids, raw);
+            break;
+        case Dimension::Type::Unsigned16:
+            kept = fromDouble<uint16_t>(in, begin, n, ids, raw);
+            break;
+        case Dimension::Type::Unsigned32:
+            kept = fromDouble<uint32_t>(in, begin, n, ids, raw);
+            break;
+        case Dimension::Type::Unsigned64:
+            kept = fromDouble<uint64_t>(in, begin, n, ids, raw);
+            break;
+        case Dimension::Type::None:
+        default:
+            break;
+        }
+        if (kept)
+            container.setFieldsInternal(dim, ids, kept, raw);
+        begin += n;
+        in += n;
+        count -= n;
+    }
+}
+
+
 PointTable::~PointTable()
 {
+    size_t size = pointsToBytes(m_blockPtCnt);
     for (auto vi = m_blocks.begin(); vi != m_blocks.end(); ++vi)
-        delete [] *vi;
+    {
+        if (m_allocator)
+            m_allocator->release(*vi, size);
+        else
+            delete [] *vi;
+    }
 }
 
+bool PointTable::enableConcurrency()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_concurrent)
+    {
+        m_blocks.reserve(m_maxConcurrentBlocks);
+        m_concurrent = true;
+    }
+    return true;
+}
+
+
+uint64_t PointTable::allocatedBytes() const
+{
+    std::unique_lock<std::mutex> lock(m_mutex, std::defer_lock);
+    if (m_concurrent)
+        lock.lock();
+    return m_blocks.size() * pointsToBytes(m_blockPtCnt);
+}
+
+
+void PointTable::reserve(point_count_t count)
+{
+    // Blocks are still allocated as they're needed, since a reader may
+    // end up with fewer points than it expected.  A concurrent table has
+    // already reserved its list of blocks.
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_concurrent)
+        m_blocks.reserve((m_numPts + count + m_blockPtCnt - 1) /
+            m_blockPtCnt);
+}
+
+
 PointId PointTable::addPoint()
 {
+    std::unique_lock<std::mutex> lock(m_mutex, std::defer_lock);
+    if (m_concurrent)
+        lock.lock();
+
     if (m_numPts % m_blockPtCnt == 0)
     {
+        if (m_concurrent && m_blocks.size() == m_blocks.capacity())
+            throw pdal_error("Point table capacity exceeded during "
+                "concurrent execution.");
         size_t size = pointsToBytes(m_blockPtCnt);
-        char *buf = new char[size];
-        memset(buf, 0, size);
+        checkMemoryLimit(m_blocks.size() * size, size);
+        char *buf;
+        if (m_allocator)
+            buf = m_allocator->allocate(size);
+        else
+        {
+            buf = new char[size];
+            memset(buf, 0, size);
+        }
         m_blocks.push_back(buf);
     }
     return m_numPts++;
@@ -125,13 +406,67 @@ char *PointTable::getPoint(PointId idx)
 }
 
 
+void PointTable::setFieldsInternal(Dimension::Id id, const PointId *ids,
+    point_count_t count, const void *value)
+{
+    const Dimension::Detail *d = m_layoutRef.dimDetail(id);
+    const size_t size = d->size();
+    const size_t offset = d->offset();
+    const size_t pointSize = m_layoutRef.pointSize();
+    const char *src = (const char *)value;
+
+    for (point_count_t i = 0; i < count; ++i, src += size)
+    {
+        PointId idx = ids[i];
+        char *dst = m_blocks[idx / m_blockPtCnt] +
+            (idx % m_blockPtCnt) * pointSize + offset;
+        std::memcpy(dst, src, size);
+    }
+}
+
+
+void PointTable::getFieldsInternal(Dimension::Id id, const PointId *ids,
+    point_count_t count, void *value) const
+{
+    const Dimension::Detail *d = m_layoutRef.dimDetail(id);
+    const size_t size = d->size();
+    const size_t offset = d->offset();
+    const size_t pointSize = m_layoutRef.pointSize();
+    char *dst = (char *)value;
+
+    for (point_count_t i = 0; i < count; ++i, dst += size)
+    {
+        PointId idx = ids[i];
+        const char *src = m_blocks[idx / m_blockPtCnt] +
+            (idx % m_blockPtCnt) * pointSize + offset;
+        std::memcpy(dst, src, size);
+    }
+}
+
+
 ContiguousPointTable::~ContiguousPointTable()
 {}
 
 
+void ContiguousPointTable::reserve(point_count_t count)
+{
+    size_t size = pointsToBytes(m_numPts + count);
+    if (size > m_buf.capacity() &&
+            withinMemoryLimit(m_buf.capacity(), size - m_buf.capacity()))
+        m_buf.reserve(size);
+}
+
+
 PointId ContiguousPointTable::addPoint()
 {
-    m_buf.resize(pointsToBytes(m_numPts + 1));
+    size_t size = pointsToBytes(m_numPts + 1);
+    if (size > m_buf.capacity())
+    {
+        size_t capacity = (std::max)(size, m_buf.capacity() * 2);
+        checkMemoryLimit(m_buf.capacity(), capacity - m_buf.capacity());
+        m_buf.reserve(capacity);
+    }
+    m_buf.resize(size);
     return m_numPts++;
 }
 
@@ -142,10 +477,565 @@ char *ContiguousPointTable::getPoint(PointId idx)
 }
 
 
+MappedPointTable::~MappedPointTable()
+{
+    for (size_t i = 0; i < m_blocks.size(); ++i)
+        FileUtils::unmapFile(m_blocks[i].m_ctx);
+    if (m_filename.size())
+        FileUtils::deleteFile(m_filename);
+}
+
+
+PointId MappedPointTable::addPoint()
+{
+    if (m_numPts % m_blockPtCnt == 0)
+    {
+        if (m_filename.empty())
+        {
+            m_filename = FileUtils::uniqueFilename(m_scratchDir, "pdal-");
+            std::ostream *out = FileUtils::createFile(m_filename);
+            if (!out)
+                throw pdal_error("Can't create scratch file '" +
+                    m_filename + "'.");
+            FileUtils::closeFile(out);
+            m_maxMapped = (std::max)((uint64_t)2,
+                m_memoryBudget / blockBytes());
+        }
+        // Extending the file zero-fills the new block.
+        m_blocks.push_back(Block());
+        FileUtils::resizeFile(m_filename, m_blocks.size() * blockBytes());
+    }
+    return m_numPts++;
+}
+
+
+char *MappedPointTable::getPoint(PointId idx)
+{
+    size_t blockNum = idx / m_blockPtCnt;
+    if (blockNum != m_current)
+    {
+        m_currentAddr = mapBlock(blockNum);
+        m_current = blockNum;
+    }
+    return m_currentAddr + pointsToBytes(idx % m_blockPtCnt);
+}
+
+
+// Field access locks the table: mapping one block can unmap another that a
+// different thread is reading.
+void MappedPointTable::setFieldInternal(Dimension::Id id, PointId idx,
+    const void *value)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    SimplePointTable::setFieldInternal(id, idx, value);
+}
+
+
+void MappedPointTable::getFieldInternal(Dimension::Id id, PointId idx,
+    void *value) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    SimplePointTable::getFieldInternal(id, idx, value);
+}
+
+
+void MappedPointTable::setFieldsInternal(Dimension::Id id,
+    const PointId *ids, point_count_t count, const void *value)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    SimplePointTable::setFieldsInternal(id, ids, count, value);
+}
+
+
+void MappedPointTable::getFieldsInternal(Dimension::Id id,
+    const PointId *ids, point_count_t count, void *value) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    SimplePointTable::getFieldsInternal(id, ids, count, value);
+}
+
+
+char *MappedPointTable::mapBlock(size_t blockNum)
+{
+    Block& b = m_blocks[blockNum];
+    if (b.m_ctx.addr())
+    {
+        m_mapped.splice(m_mapped.begin(), m_mapped, b.m_pos);
+        return (char *)b.m_ctx.addr();
+    }
+
+    if (m_mapped.size() >= m_maxMapped)
+        unmapBlock(m_mapped.back());
+    b.m_ctx = FileUtils::mapFile(m_filename, false,
+        blockNum * blockBytes(), blockBytes());
+    if (!b.m_ctx.addr())
+        throw pdal_error("Can't map block of scratch file '" + m_filename +
+            "': " + b.m_ctx.what());
+    m_mapped.push_front(blockNum);
+    b.m_pos = m_mapped.begin();
+    return (char *)b.m_ctx.addr();
+}
+
+
+void MappedPointTable::unmapBlock(size_t blockNum)
+{
+    Block& b = m_blocks[blockNum];
+    FileUtils::unmapFile(b.m_ctx);
+    m_mapped.erase(b.m_pos);
+}
+
+
+namespace
+{
+
+// Compress a block of points a byte column at a time.
+void compressBlock(const std::vector<char>& points, size_t pointSize,
+    std::vector<char>& out)
+{
+    const size_t numPts = points.size() / pointSize;
+    std::vector<char> columns(points.size());
+    char *dst = columns.data();
+    for (size_t b = 0; b < pointSize; ++b)
+    {
+        const char *src = points.data() + b;
+        for (size_t i = 0; i < numPts; ++i, src += pointSize)
+            *dst++ = *src;
+    }
+
+    out.clear();
+    auto cb = [&out](char *buf, size_t size)
+        { out.insert(out.end(), buf, buf + size); };
+#ifdef PDAL_HAVE_ZSTD
+    // Speed matters more than size here.
+    ZstdCompressor compressor(cb, 1);
+    compressor.compress(columns.data(), columns.size());
+    compressor.done();
+#elif defined(PDAL_HAVE_ZLIB)
+    DeflateCompressor compressor(cb);
+    compressor.compress(columns.data(), columns.size());
+    compressor.done();
+#else
+    (void)cb;
+    out.swap(columns);
+#endif
+    out.shrink_to_fit();
+}
+
+
+// Restore a block of points compressed by compressBlock().  'points' must
+// already have the size of the block.
+void decompressBlock(const std::vector<char>& data, size_t pointSize,
+    std::vector<char>& points)
+{
+    std::vector<char> columns;
+    columns.reserve(points.size());
+    auto cb = [&columns](char *buf, size_t size)
+        { columns.insert(columns.end(), buf, buf + size); };
+#ifdef PDAL_HAVE_ZSTD
+    ZstdDecompressor decompressor(cb);
+    decompressor.decompress(data.data(), data.size());
+    decompressor.done();
+#elif defined(PDAL_HAVE_ZLIB)
+    DeflateDecompressor decompressor(cb);
+    decompressor.decompress(data.data(), data.size());
+    decompressor.done();
+#else
+    (void)cb;
+    columns = data;
+#endif
+    if (columns.size() != points.size())
+        throw pdal_error("Can't decompress block of compressed point table.");
+
+    const size_t numPts = points.size() / pointSize;
+    const char *src = columns.data();
+    for (size_t b = 0; b < pointSize; ++b)
+    {
+        char *dst = points.data() + b;
+        for (size_t i = 0; i < numPts; ++i, dst += pointSize)
+            *dst = *src++;
+    }
+}
+
+} // unnamed namespace
+
+CompressedPointTable::~CompressedPointTable()
+{}
+
+
+PointId CompressedPointTable::addPoint()
+{
+    if (m_numPts % m_blockPtCnt == 0)
+    {
+        if (m_blocks.empty())
+            m_maxHot = (size_t)(std::max)((uint64_t)2,
+                m_memoryBudget / blockBytes());
+        makeRoom();
+        checkMemoryLimit(allocatedBytes(), blockBytes());
+
+        // A new block is hot and has nothing compressed.
+        const size_t blockNum = m_blocks.size();
+        m_blocks.push_back(Block());
+        Block& b = m_blocks.back();
+        b.m_points.resize(blockBytes());
+        b.m_dirty = true;
+        m_hot.push_front(blockNum);
+        b.m_pos = m_hot.begin();
+        m_current = blockNum;
+        m_currentAddr = b.m_points.data();
+    }
+    return m_numPts++;
+}
+
+
+char *CompressedPointTable::getPoint(PointId idx)
+{
+    // The caller may write to the point, so the block must be compressed
+    // again when it's evicted.
+    return loadBlock(idx / m_blockPtCnt, true) +
+        pointsToBytes(idx % m_blockPtCnt);
+}
+
+
+// Field access locks the table: loading one block can evict another that a
+// different thread is reading.
+void CompressedPointTable::setFieldInternal(Dimension::Id id, PointId idx,
+    const void *value)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    SimplePointTable::setFieldInternal(id, idx, value);
+}
+
+
+void CompressedPointTable::getFieldInternal(Dimension::Id id, PointId idx,
+    void *value) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const Dimension::Detail *d = m_layoutRef.dimDetail(id);
+    CompressedPointTable *ncThis = const_cast<CompressedPointTable *>(this);
+    const char *src = ncThis->loadBlock(idx / m_blockPtCnt, false) +
+        pointsToBytes(idx % m_blockPtCnt) + d->offset();
+    std::copy(src, src + d->size(), (char *)value);
+}
+
+
+void CompressedPointTable::setFieldsInternal(Dimension::Id id,
+    const PointId *ids, point_count_t count, const void *value)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    SimplePointTable::setFieldsInternal(id, ids, count, value);
+}
+
+
+void CompressedPointTable::getFieldsInternal(Dimension::Id id,
+    const PointId *ids, point_count_t count, void *value) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const Dimension::Detail *d = m_layoutRef.dimDetail(id);
+    const size_t size = d->size();
+    const size_t offset = d->offset();
+    CompressedPointTable *ncThis = const_cast<CompressedPointTable *>(this);
+    char *dst = (char *)value;
+
+    for (point_count_t i = 0; i < count; ++i, dst += size)
+    {
+        PointId idx = ids[i];
+        const char *src = ncThis->loadBlock(idx / m_blockPtCnt, false) +
+            pointsToBytes(idx % m_blockPtCnt) + offset;
+        std::memcpy(dst, src, size);
+    }
+}
+
+
+// Get the uncompressed points of a block, decompressing it if necessary.
+// If 'write' is true, the compressed copy of the block is discarded.
+char *CompressedPointTable::loadBlock(size_t blockNum, bool write)
+{
+    Block& b = m_blocks[blockNum];
+    if (blockNum == m_current && (b.m_dirty || !write))
+        return m_currentAddr;
+
+    if (b.m_points.size())
+        m_hot.splice(m_hot.begin(), m_hot, b.m_pos);
+    else
+    {
+        makeRoom();
+        b.m_points.resize(blockBytes());
+        decompressBlock(b.m_data, m_layoutRef.pointSize(), b.m_points);
+        m_hot.push_front(blockNum);
+        b.m_pos = m_hot.begin();
+    }
+    if (write && !b.m_dirty)
+    {
+        b.m_dirty = true;
+        m_compressedBytes -= b.m_data.size();
+        std::vector<char>().swap(b.m_data);
+    }
+    m_current = blockNum;
+    m_currentAddr = b.m_points.data();
+    return m_currentAddr;
+}
+
+
+// Evict hot blocks until another block can be made hot.
+void CompressedPointTable::makeRoom()
+{
+    while (m_hot.size() && m_hot.size() >= m_maxHot)
+        evictBlock(m_hot.back());
+}
+
+
+void CompressedPointTable::evictBlock(size_t blockNum)
+{
+    Block& b = m_blocks[blockNum];
+    if (b.m_dirty)
+    {
+        compressBlock(b.m_points, m_layoutRef.pointSize(), b.m_data);
+        m_compressedBytes += b.m_data.size();
+        b.m_dirty = false;
+    }
+    std::vector<char>().swap(b.m_points);
+    m_hot.erase(b.m_pos);
+    if (blockNum == m_current)
+    {
+        m_current = (std::numeric_limits<size_t>::max)();
+        m_currentAddr = nullptr;
+    }
+}
+
+
+ColumnPointTable::~ColumnPointTable()
+{}
+
+
+char *ColumnPointTable::column(Dimension::Id id)
+{
+    std::vector<char>& col = m_columns[Utils::toNative(id)];
+    return col.empty() ? nullptr : col.data();
+}
+
+
+const char *ColumnPointTable::column(Dimension::Id id) const
+{
+    const std::vector<char>& col = m_columns[Utils::toNative(id)];
+    return col.empty() ? nullptr : col.data();
+}
+
+
+void ColumnPointTable::reserve(point_count_t count)
+{
+    point_count_t capacity = m_numPts + count;
+    if (capacity > m_capacity && withinMemoryLimit(allocatedBytes(),
+            (capacity - m_capacity) * m_layout.pointSize()))
+        grow(capacity);
+}
+
+
+PointId ColumnPointTable::addPoint()
+{
+    // Grow all the columns at once so that adding a point is normally
+    // just an increment.
+    if (m_numPts == m_capacity)
+    {
+        point_count_t capacity =
+            (std::max)((point_count_t)65536, m_capacity * 2);
+        checkMemoryLimit(allocatedBytes(),
+            (capacity - m_capacity) * m_layout.pointSize());
+        grow(capacity);
+    }
+    return m_numPts++;
+}
+
+
+void ColumnPointTable::grow(point_count_t capacity)
+{
+    m_capacity = capacity;
+    for (Dimension::Id id : m_layout.dims())
+        m_columns[Utils::toNative(id)].resize(
+            m_capacity * m_layout.dimSize(id));
+}
+
+
+char *ColumnPointTable::getPoint(PointId /*idx*/)
+{
+    throw pdal_error("Can't access raw point data in a column point table.");
+}
+
+
+void ColumnPointTable::setFieldInternal(Dimension::Id id, PointId idx,
+    const void *value)
+{
+    const Dimension::Detail *d = m_layoutRef.dimDetail(id);
+    const char *src = (const char *)value;
+    char *dst = m_columns[Utils::toNative(id)].data() + idx * d->size();
+    std::copy(src, src + d->size(), dst);
+}
+
+
+void ColumnPointTable::getFieldInternal(Dimension::Id id, PointId idx,
+    void *value) const
+{
+    const Dimension::Detail *d = m_layoutRef.dimDetail(id);
+    const char *src = m_columns[Utils::toNative(id)].data() + idx * d->size();
+    char *dst = (char *)value;
+    std::copy(src, src + d->size(), dst);
+}
+
+
+void ColumnPointTable::setFieldsInternal(Dimension::Id id,
+    const PointId *ids, point_count_t count, const void *value)
+{
+    const size_t size = m_layoutRef.dimSize(id);
+    const char *src = (const char *)value;
+    char *col = m_columns[Utils::toNative(id)].data();
+
+    for (point_count_t i = 0; i < count; ++i, src += size)
+        std::memcpy(col + ids[i] * size, src, size);
+}
+
+
+void ColumnPointTable::getFieldsInternal(Dimension::Id id,
+    const PointId *ids, point_count_t count, void *value) const
+{
+    const size_t size = m_layoutRef.dimSize(id);
+    char *dst = (char *)value;
+    const char *col = m_columns[Utils::toNative(id)].data();
+
+    for (point_count_t i = 0; i < count; ++i, dst += size)
+        std::memcpy(dst, col + ids[i] * size, size);
+}
+
+
 MetadataNode BasePointTable::toMetadata() const
 {
     return layout()->toMetadata();
 }
 
+
+namespace
+{
+
+// Size of the L2 cache of the processor, or a likely size if it can't be
+// determined.
+size_t l2CacheSize()
+{
+    long size = 0;
+#if defined(__linux__) && defined(_SC_LEVEL2_CACHE_SIZE)
+    size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+    return size > 0 ? (size_t)size : 1024 * 1024;
+}
+
+} // unnamed namespace
+
+AdaptivePointTable::AdaptivePointTable(point_count_t maxCapacity) :
+    StreamPointTable(m_layout, maxCapacity),
+    m_minCapacity((std::min)((point_count_t)1024, maxCapacity)),
+    m_maxCapacity(maxCapacity),
+    m_trialPoints(0), m_trialSeconds(0), m_trialBatches(-1),
+    m_bestCapacity(0), m_bestRate(0), m_growing(true), m_reversed(false),
+    m_settled(false)
+{}
+
+
+void AdaptivePointTable::finalize()
+{
+    if (m_layout.finalized())
+        return;
+    BasePointTable::finalize();
+    m_buf.resize(pointsToBytes(m_maxCapacity + 1));
+
+    // Start with a batch of points that fits in half the L2 cache, which
+    // leaves room for the data stages keep beside the points.
+    point_count_t capacity = (point_count_t)
+        (l2CacheSize() / 2 / (std::max)((size_t)1, m_layout.pointSize()));
+    capacity = Utils::clamp(capacity, m_minCapacity, m_maxCapacity);
+    setCapacity(capacity);
+    m_start = std::chrono::steady_clock::now();
+}
+
+
+// Called after each batch has been run through the pipeline.
+void AdaptivePointTable::reset()
+{
+    const point_count_t used = capacity();
+    if (!m_settled)
+    {
+        auto now = std::chrono::steady_clock::now();
+        std::chrono::duration<double> elapsed = now - m_start;
+        m_start = now;
+
+        // The first batch includes the start-up of the stages, so it
+        // isn't measured.
+        if (m_trialBatches >= 0)
+        {
+            m_trialPoints += numPoints();
+            m_trialSeconds += elapsed.count();
+        }
+        m_trialBatches++;
+
+        // Measure a few batches, and at least 10ms, at each capacity so
+        // that a single slow batch doesn't decide the result.
+        if (m_trialBatches >= 4 && m_trialSeconds >= .01)
+        {
+            double rate = m_trialPoints / m_trialSeconds;
+            m_trialPoints = 0;
+            m_trialSeconds = 0;
+            m_trialBatches = 0;
+
+            // Small differences are noise, so only take a capacity that
+            // is clearly better.
+            if (rate > m_bestRate * 1.05)
+            {
+                m_bestRate = rate;
+                m_bestCapacity = used;
+                step(used);
+            }
+            else if (!m_reversed)
+            {
+                m_reversed = true;
+                m_growing = !m_growing;
+                step(m_bestCapacity);
+            }
+            else
+            {
+                setCapacity(m_bestCapacity);
+                m_settled = true;
+            }
+        }
+    }
+    // Clear every point that was in use, including those beyond a
+    // smaller new capacity.
+    std::fill(m_buf.begin(),
+        m_buf.begin() + pointsToBytes((std::max)(used, capacity())), 0);
+}
+
+
+// Move to the next capacity in the direction being searched.  If the
+// capacity can't move, the search ends at the best capacity found.
+void AdaptivePointTable::step(point_count_t from)
+{
+    point_count_t next = m_growing ? from * 2 : from / 2;
+    next = Utils::clamp(next, m_minCapacity, m_maxCapacity);
+    if (next == from)
+    {
+        if (m_reversed)
+        {
+            setCapacity(m_bestCapacity);
+            m_settled = true;
+            return;
+        }
+        m_reversed = true;
+        m_growing = !m_growing;
+        next = Utils::clamp(m_growing ? from * 2 : from / 2,
+            m_minCapacity, m_maxCapacity);
+        if (next == from)
+        {
+            m_settled = true;
+            return;
+        }
+    }
+    setCapacity(next);
+}
+
 } // namespace pdal
 
@@ -35,14 +35,20 @@
 #pragma once
 
 #include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <limits>
 #include <list>
+#include <mutex>
 #include <vector>
 
+#include "pdal/BlockAllocator.hpp"
 #include "pdal/SpatialReference.hpp"
 #include "pdal/Dimension.hpp"
 #include "pdal/PointContainer.hpp"
 #include "pdal/PointLayout.hpp"
 #include "pdal/Metadata.hpp"
+#include "pdal/util/FileUtils.hpp"
 
 namespace pdal
 {
@@ -91,6 +97,29 @@ public:
     }
     virtual bool supportsView() const
         { return false; }
+    // Allow points to be added to the table from more than one thread
+    // at a time.  Returns false if the table doesn't support this.
+    virtual bool enableConcurrency()
+        { return false; }
+    // Whether points can be read from more than one thread at a time.
+    virtual bool concurrentReads() const
+        { return true; }
+    // Number of bytes of point storage the table has allocated.
+    virtual uint64_t allocatedBytes() const
+        { return 0; }
+    // Make adding points fail once the table's point storage would grow
+    // beyond this many bytes.  Zero, the default, means no limit.  Tables
+    // that keep points on disk ignore the limit.
+    void setMemoryLimit(uint64_t bytes)
+        { m_memoryLimit = bytes; }
+    uint64_t memoryLimit() const
+        { return m_memoryLimit; }
+    // Prepare for 'count' more points to be added, as when a reader knows
+    // how many points it will read, so that storage isn't grown a piece at
+    // a time.  This is only a hint: tables may ignore it, and storage that
+    // would exceed the memory limit isn't reserved.
+    virtual void reserve(point_count_t /*count*/)
+        {}
     MetadataNode privateMetadata(const std::string& name);
     MetadataNode toMetadata() const;
     ArtifactManager& artifactManager();
@@ -101,12 +130,20 @@ private:
 
 protected:
     virtual char *getPoint(PointId idx) = 0;
+    // Throw if growing point storage from 'allocated' bytes by 'bytes'
+    // would exceed the memory limit.
+    void checkMemoryLimit(uint64_t allocated, uint64_t bytes) const;
+    // Whether growing point storage from 'allocated' bytes by 'bytes'
+    // stays within the memory limit.
+    bool withinMemoryLimit(uint64_t allocated, uint64_t bytes) const
+        { return !m_memoryLimit || allocated + bytes <= m_memoryLimit; }
 
 protected:
     MetadataPtr m_metadata;
     std::list<SpatialReference> m_spatialRefs;
     PointLayout& m_layoutRef;
     std::unique_ptr<ArtifactManager> m_artifactManager;
+    uint64_t m_memoryLimit;
 };
 typedef BasePointTable& PointTableRef;
 typedef BasePointTable const & ConstPointTableRef;
@@ -122,12 +159,16 @@ protected:
     std::size_t pointsToBytes(point_count_t numPts) const
         { return m_layoutRef.pointSize() * numPts; }
 
-private:
     virtual void setFieldInternal(Dimension::Id id, PointId idx,
         const void *value);
     virtual void getFieldInternal(Dimension::Id id, PointId idx,
         void *value) const;
+    virtual void setFieldsInternal(Dimension::Id id, const PointId *ids,
+        point_count_t count, const void *value);
+    virtual void getFieldsInternal(Dimension::Id id, const PointId *ids,
+        point_count_t count, void *value) const;
 
+private:
     // The number of points in each memory block.
     char *getDimension(const Dimension::Detail *d, PointId idx)
         { return getPoint(idx) + d->offset(); }
@@ -148,13 +189,28 @@ private:
     std::vector<char *> m_blocks;
     point_count_t m_numPts;
     static const point_count_t m_blockPtCnt = 65536;
+    // Maximum number of blocks when points are added concurrently.  The
+    // block list can't be reallocated while other threads are reading it.
+    static const size_t m_maxConcurrentBlocks = 1 << 20;
+    bool m_concurrent;
+    mutable std::mutex m_mutex;
+    BlockAllocatorPtr m_allocator;
 
 public:
-    PointTable() : SimplePointTable(m_layout), m_numPts(0)
+    PointTable() : SimplePointTable(m_layout), m_numPts(0),
+        m_concurrent(false)
+        {}
+    // Create a table whose blocks of points come from an allocator, such
+    // as a BlockPool shared by many tables.
+    PointTable(BlockAllocatorPtr allocator) : SimplePointTable(m_layout),
+        m_numPts(0), m_concurrent(false), m_allocator(allocator)
         {}
     virtual ~PointTable();
     virtual bool supportsView() const
         { return true; }
+    virtual bool enableConcurrency();
+    virtual uint64_t allocatedBytes() const;
+    virtual void reserve(point_count_t count);
 
 protected:
     virtual char *getPoint(PointId idx);
@@ -162,6 +218,10 @@ protected:
 private:
     // Point data operations.
     virtual PointId addPoint();
+    virtual void setFieldsInternal(Dimension::Id id, const PointId *ids,
+        point_count_t count, const void *value);
+    virtual void getFieldsInternal(Dimension::Id id, const PointId *ids,
+        point_count_t count, void *value) const;
 
     PointLayout m_layout;
 };
@@ -178,16 +238,281 @@ public:
     virtual ~ContiguousPointTable();
     virtual bool supportsView() const
         { return true; }
+    virtual uint64_t allocatedBytes() const
+        { return m_buf.capacity(); }
+    virtual void reserve(point_count_t count);
+
+protected:
+    virtual char *getPoint(PointId idx);
+
+private:
+    virtual PointId addPoint();
+
+    PointLayout m_layout;
+};
+
+/// A point table whose points are stored in a scratch file rather than in
+/// memory.  Blocks of the file are mapped into memory as they're accessed
+/// and the least recently used blocks are unmapped to keep the mapped
+/// memory within a budget.  The scratch file is removed when the table is
+/// destroyed.
+class PDAL_DLL MappedPointTable : public SimplePointTable
+{
+public:
+    /**
+      Create a mapped point table.
+
+      \param scratchDir  Directory for the scratch file.  If empty, the
+        system temporary directory is used.
+      \param memoryBudget  Maximum number of bytes of point data mapped
+        into memory at once.  At least two blocks are always mapped.
+    */
+    MappedPointTable(const std::string& scratchDir = "",
+            uint64_t memoryBudget = 1024 * 1024 * 1024) :
+        SimplePointTable(m_layout), m_scratchDir(scratchDir),
+        m_memoryBudget(memoryBudget), m_numPts(0), m_maxMapped(0),
+        m_current((std::numeric_limits<size_t>::max)()),
+        m_currentAddr(nullptr)
+        {}
+    virtual ~MappedPointTable();
+    virtual bool supportsView() const
+        { return true; }
+    // Reading a point can map and unmap blocks, so field access is
+    // serialized.  Reads from several threads are safe but gain nothing.
+    virtual bool concurrentReads() const
+        { return false; }
+    virtual uint64_t allocatedBytes() const
+        { return m_blocks.size() * blockBytes(); }
+    virtual void reserve(point_count_t count)
+        { m_blocks.reserve((m_numPts + count + m_blockPtCnt - 1) /
+            m_blockPtCnt); }
+
+    /**
+      Get the name of the scratch file.  Empty until points are added.
+
+      \return  Name of the scratch file.
+    */
+    std::string filename() const
+        { return m_filename; }
+
+    /**
+      Get the number of blocks currently mapped into memory.
+
+      \return  Number of mapped blocks.
+    */
+    size_t mappedBlocks() const
+        { return m_mapped.size(); }
 
 protected:
+    // The returned address is only good until another point is accessed.
     virtual char *getPoint(PointId idx);
 
 private:
+    struct Block
+    {
+        FileUtils::MapContext m_ctx;
+        // Position in the list of mapped blocks.
+        std::list<size_t>::iterator m_pos;
+    };
+
     virtual PointId addPoint();
+    virtual void setFieldInternal(Dimension::Id id, PointId idx,
+        const void *value);
+    virtual void getFieldInternal(Dimension::Id id, PointId idx,
+        void *value) const;
+    virtual void setFieldsInternal(Dimension::Id id, const PointId *ids,
+        point_count_t count, const void *value);
+    virtual void getFieldsInternal(Dimension::Id id, const PointId *ids,
+        point_count_t count, void *value) const;
+    char *mapBlock(size_t blockNum);
+    void unmapBlock(size_t blockNum);
+    uint64_t blockBytes() const
+        { return pointsToBytes(m_blockPtCnt); }
+
+    static const point_count_t m_blockPtCnt = 65536;
+    std::string m_scratchDir;
+    std::string m_filename;
+    uint64_t m_memoryBudget;
+    point_count_t m_numPts;
+    size_t m_maxMapped;
+    std::vector<Block> m_blocks;
+    // Mapped blocks, most recently used first.
+    std::list<size_t> m_mapped;
+    // Most recently used block, which is checked before the list.
+    size_t m_current;
+    char *m_currentAddr;
+    // Guards the mapped blocks during field access.
+    mutable std::mutex m_mutex;
 
     PointLayout m_layout;
 };
 
+/// A point table that keeps blocks of points compressed in memory.  The
+/// most recently used blocks are kept uncompressed; a block is decompressed
+/// when one of its points is accessed and compressed again when it is
+/// pushed out by other blocks.  Each block is compressed a byte column at
+/// a time (the first byte of every point, then the second, and so on) so
+/// that the values of a dimension are compressed together.  Blocks are
+/// compressed with Zstd if PDAL was built with it, otherwise with Deflate,
+/// and are kept as they are if PDAL was built with neither.
+class PDAL_DLL CompressedPointTable : public SimplePointTable
+{
+public:
+    /**
+      Create a compressed point table.
+
+      \param memoryBudget  Maximum number of bytes of uncompressed point
+        data kept in memory at once.  At least two blocks are always kept.
+    */
+    CompressedPointTable(uint64_t memoryBudget = 1024 * 1024 * 1024) :
+        SimplePointTable(m_layout), m_memoryBudget(memoryBudget),
+        m_numPts(0), m_maxHot(0), m_compressedBytes(0),
+        m_current((std::numeric_limits<size_t>::max)()),
+        m_currentAddr(nullptr)
+        {}
+    virtual ~CompressedPointTable();
+    virtual bool supportsView() const
+        { return true; }
+    // Reading a point can decompress and compress blocks, so field access
+    // is serialized.  Reads from several threads are safe but gain nothing.
+    virtual bool concurrentReads() const
+        { return false; }
+    virtual uint64_t allocatedBytes() const
+        { return m_compressedBytes + m_hot.size() * blockBytes(); }
+    virtual void reserve(point_count_t count)
+        { m_blocks.reserve((m_numPts + count + m_blockPtCnt - 1) /
+            m_blockPtCnt); }
+
+    /**
+      Get the number of blocks currently held uncompressed.
+
+      \return  Number of uncompressed blocks.
+    */
+    size_t hotBlocks() const
+        { return m_hot.size(); }
+
+    /**
+      Get the number of bytes held by compressed blocks.
+
+      \return  Size of the compressed blocks.
+    */
+    uint64_t compressedBytes() const
+        { return m_compressedBytes; }
+
+protected:
+    // The returned address is only good until another point is accessed.
+    virtual char *getPoint(PointId idx);
+
+private:
+    struct Block
+    {
+        Block() : m_dirty(false)
+        {}
+
+        // Compressed points.  Empty while the block is hot and modified.
+        std::vector<char> m_data;
+        // Uncompressed points.  Empty unless the block is hot.
+        std::vector<char> m_points;
+        // Whether the uncompressed points may differ from m_data.
+        bool m_dirty;
+        // Position in the list of hot blocks.
+        std::list<size_t>::iterator m_pos;
+    };
+
+    virtual PointId addPoint();
+    virtual void setFieldInternal(Dimension::Id id, PointId idx,
+        const void *value);
+    virtual void getFieldInternal(Dimension::Id id, PointId idx,
+        void *value) const;
+    virtual void setFieldsInternal(Dimension::Id id, const PointId *ids,
+        point_count_t count, const void *value);
+    virtual void getFieldsInternal(Dimension::Id id, const PointId *ids,
+        point_count_t count, void *value) const;
+    char *loadBlock(size_t blockNum, bool write);
+    void evictBlock(size_t blockNum);
+    void makeRoom();
+    uint64_t blockBytes() const
+        { return pointsToBytes(m_blockPtCnt); }
+
+    static const point_count_t m_blockPtCnt = 65536;
+    uint64_t m_memoryBudget;
+    point_count_t m_numPts;
+    size_t m_maxHot;
+    uint64_t m_compressedBytes;
+    std::vector<Block> m_blocks;
+    // Hot blocks, most recently used first.
+    std::list<size_t> m_hot;
+    // Most recently used block, which is checked before the list.
+    size_t m_current;
+    char *m_currentAddr;
+    // Guards the hot blocks during field access.
+    mutable std::mutex m_mutex;
+
+    PointLayout m_layout;
+};
+
+/// A point table that stores the values of each dimension in its own
+/// contiguous array rather than storing points as interleaved records.
+/// Code that works on only a few dimensions touches only the memory for
+/// those dimensions, and the values of a dimension can be handed directly
+/// to code that operates on arrays.  Raw point records aren't available
+/// from this table, so PointView::getPoint() can't be used with it.
+class PDAL_DLL ColumnPointTable : public BasePointTable
+{
+public:
+    ColumnPointTable() : BasePointTable(m_layout),
+        m_columns(Dimension::COUNT), m_numPts(0), m_capacity(0)
+        {}
+    virtual ~ColumnPointTable();
+    virtual bool supportsView() const
+        { return true; }
+    virtual uint64_t allocatedBytes() const
+        { return m_capacity * m_layout.pointSize(); }
+    virtual void reserve(point_count_t count);
+
+    /**
+      Get the number of points in the table.
+
+      \return  Number of points.
+    */
+    point_count_t numPoints() const
+        { return m_numPts; }
+
+    /**
+      Get a pointer to the values of a dimension.  Values are stored as the
+      dimension's type (see PointLayout::dimType()) and are ordered by point
+      ID in the table, not by the order of points in any PointView.  The
+      pointer is invalidated when points are added to the table.
+
+      \param id  ID of the dimension.
+      \return  Pointer to the first of \ref numPoints() values, or nullptr
+        if the dimension isn't part of the layout.
+    */
+    char *column(Dimension::Id id);
+    const char *column(Dimension::Id id) const;
+
+protected:
+    virtual char *getPoint(PointId idx);
+
+private:
+    virtual PointId addPoint();
+    virtual void setFieldInternal(Dimension::Id id, PointId idx,
+        const void *value);
+    virtual void getFieldInternal(Dimension::Id id, PointId idx,
+        void *value) const;
+    virtual void setFieldsInternal(Dimension::Id id, const PointId *ids,
+        point_count_t count, const void *value);
+    virtual void getFieldsInternal(Dimension::Id id, const PointId *ids,
+        point_count_t count, void *value) const;
+    void grow(point_count_t capacity);
+
+    // Storage for each dimension, indexed by dimension ID.
+    std::vector<std::vector<char>> m_columns;
+    point_count_t m_numPts;
+    point_count_t m_capacity;
+    PointLayout m_layout;
+};
+
 /// A StreamPointTable must provide storage for point data up to its capacity.
 /// It must implement getPoint() which returns a pointer to a buffer of
 /// sufficient size to contain a point's data.  The minimum size required
@@ -233,6 +558,32 @@ public:
     point_count_t capacity() const
         { return m_capacity; }
 
+    /**
+      Get the values of a dimension for a range of points, converted to
+      double.  This is much faster than calling getFieldAs() on a PointRef
+      for each point.
+
+      \param dim  Dimension of the values.
+      \param begin  Index of the first point in the table.
+      \param count  Number of points.
+      \param out  Buffer to hold \ref count values.
+    */
+    void getFieldArray(Dimension::Id dim, PointId begin, point_count_t count,
+        double *out) const;
+
+    /**
+      Set the values of a dimension for a range of points, converting them
+      from double.  As with setField() on a PointRef, values that can't be
+      converted to the type of the dimension are left unchanged.
+
+      \param dim  Dimension of the values.
+      \param begin  Index of the first point in the table.
+      \param count  Number of points.
+      \param in  Buffer holding \ref count values.
+    */
+    void setFieldArray(Dimension::Id dim, PointId begin, point_count_t count,
+        const double *in);
+
     /// During a given call to reset(), this indicates the number of points
     /// populated in the table.  This value will always be less then or equal
     /// to capacity(), and also includes skipped points.
@@ -245,6 +596,15 @@ protected:
     virtual void reset()
     {}
 
+    /// Change the number of points in the following batches.  The new
+    /// capacity can't be larger than the capacity the table was
+    /// constructed with.
+    void setCapacity(point_count_t capacity)
+    {
+        assert(capacity <= m_skips.size());
+        m_capacity = capacity;
+    }
+
 private:
     point_count_t m_capacity;
     point_count_t m_numPoints;
@@ -279,5 +639,45 @@ private:
     PointLayout m_layout;
 };
 
+/// A stream table that tunes the number of points in a batch while the
+/// pipeline runs.  The first batches are sized to fit the L2 cache.  The
+/// capacity is then doubled or halved while the measured throughput
+/// improves, and left alone once it stops improving.
+class PDAL_DLL AdaptivePointTable : public StreamPointTable
+{
+public:
+    /// \param maxCapacity  The largest number of points in a batch.
+    AdaptivePointTable(point_count_t maxCapacity = 262144);
+
+    virtual void finalize();
+
+protected:
+    virtual void reset();
+
+    virtual char *getPoint(PointId idx)
+        { return m_buf.data() + pointsToBytes(idx); }
+
+private:
+    void step(point_count_t from);
+
+    std::vector<char> m_buf;
+    PointLayout m_layout;
+    point_count_t m_minCapacity;
+    point_count_t m_maxCapacity;
+
+    // Measurement of the current capacity.
+    std::chrono::steady_clock::time_point m_start;
+    point_count_t m_trialPoints;
+    double m_trialSeconds;
+    int m_trialBatches;
+
+    // The best capacity found so far and its throughput.
+    point_count_t m_bestCapacity;
+    double m_bestRate;
+    bool m_growing;
+    bool m_reversed;
+    bool m_settled;
+};
+
 } //namespace
 
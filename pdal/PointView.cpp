@@ -32,26 +32,30 @@
 * OF SUCH DAMAGE.
 ****************************************************************************/
 
+#include <array>
 #include <iomanip>
+#include <limits>
 
 #include <pdal/KDIndex.hpp>
 #include <pdal/PointView.hpp>
 #include <pdal/PointViewIter.hpp>
 #include <pdal/util/Algorithm.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 namespace pdal
 {
 
-int PointView::m_lastId = 0;
+std::atomic<int> PointView::m_lastId(0);
 
 PointView::PointView(PointTableRef pointTable) : m_pointTable(pointTable),
-m_size(0), m_id(0)
+m_size(0), m_id(0), m_modCount(0), m_index3ModCount(0), m_index2ModCount(0)
 {
 	m_id = ++m_lastId;
 }
 
 PointView::PointView(PointTableRef pointTable, const SpatialReference& srs) :
-	m_pointTable(pointTable), m_size(0), m_id(0), m_spatialReference(srs)
+	m_pointTable(pointTable), m_size(0), m_id(0), m_spatialReference(srs),
+	m_modCount(0), m_index3ModCount(0), m_index2ModCount(0)
 {
 	m_id = ++m_lastId;
 }
@@ -82,6 +86,7 @@ void PointView::setFieldInternal(Dimension::Id dim, PointId idx,
         rawId = m_pointTable.addPoint();
         m_index.push_back(rawId);
         m_size++;
+        m_modCount++;
         assert(m_temps.empty());
     }
     else if (idx > size())
@@ -94,34 +99,113 @@ void PointView::setFieldInternal(Dimension::Id dim, PointId idx,
     {
         rawId = m_index[idx];
     }
+    coordsChanged(dim);
     m_pointTable.setFieldInternal(dim, rawId, buf);
 }
 
 
-void PointView::calculateBounds(BOX2D& output) const
+namespace
 {
-    for (PointId idx = 0; idx < size(); idx++)
+
+// Number of points whose values are fetched into an array at once.
+const point_count_t BoundsBlockSize = 16384;
+
+// Find the minimum and maximum of X, Y and (when DIM is 3) Z.  Each block
+// of points is fetched into an array and reduced with simple loops that
+// the compiler can vectorize.  Blocks are spread across threads when the
+// table allows concurrent reads.  NaN values are ignored, so a dimension
+// with no other values is left with lo > hi.
+template<std::size_t DIM>
+void viewBounds(const PointView& view, bool concurrent, double *lo,
+    double *hi)
+{
+    static const Dimension::Id dims[] =
+        { Dimension::Id::X, Dimension::Id::Y, Dimension::Id::Z };
+
+    const point_count_t count = view.size();
+    const std::size_t numBlocks =
+        (count + BoundsBlockSize - 1) / BoundsBlockSize;
+    std::vector<std::array<double, 2 * DIM>> results(numBlocks);
+
+    auto makeWorker = [&]()
+    {
+        std::vector<double> buf(BoundsBlockSize);
+        return [&, buf](std::size_t block) mutable
+        {
+            PointId begin = block * BoundsBlockSize;
+            point_count_t n = (std::min)(BoundsBlockSize, count - begin);
+            for (std::size_t d = 0; d < DIM; ++d)
+            {
+                view.getFieldArray(dims[d], begin, n, buf.data());
+                double l = (std::numeric_limits<double>::max)();
+                double h = std::numeric_limits<double>::lowest();
+                for (point_count_t i = 0; i < n; ++i)
+                {
+                    double v = buf[i];
+                    l = v < l ? v : l;
+                    h = v > h ? v : h;
+                }
+                results[block][d] = l;
+                results[block][DIM + d] = h;
+            }
+        };
+    };
+
+    if (concurrent)
+        parallelFor(numBlocks, makeWorker, 1);
+    else
     {
-        double x = getFieldAs<double>(Dimension::Id::X, idx);
-        double y = getFieldAs<double>(Dimension::Id::Y, idx);
+        auto worker = makeWorker();
+        for (std::size_t block = 0; block < numBlocks; ++block)
+            worker(block);
+    }
 
-        output.grow(x, y);
+    for (std::size_t d = 0; d < DIM; ++d)
+    {
+        lo[d] = (std::numeric_limits<double>::max)();
+        hi[d] = std::numeric_limits<double>::lowest();
     }
+    for (const auto& r : results)
+        for (std::size_t d = 0; d < DIM; ++d)
+        {
+            lo[d] = (std::min)(lo[d], r[d]);
+            hi[d] = (std::max)(hi[d], r[DIM + d]);
+        }
 }
 
-
-void PointView::calculateBounds(BOX3D& output) const
+// Grow one dimension of a box by a range, unless the range is empty.
+void growRange(double& boxLo, double& boxHi, double lo, double hi)
 {
-    for (PointId idx = 0; idx < size(); idx++)
+    if (lo <= hi)
     {
-        double x = getFieldAs<double>(Dimension::Id::X, idx);
-        double y = getFieldAs<double>(Dimension::Id::Y, idx);
-        double z = getFieldAs<double>(Dimension::Id::Z, idx);
-
-        output.grow(x, y, z);
+        boxLo = (std::min)(boxLo, lo);
+        boxHi = (std::max)(boxHi, hi);
     }
 }
 
+} // unnamed namespace
+
+
+void PointView::calculateBounds(BOX2D& output) const
+{
+    double lo[2];
+    double hi[2];
+    viewBounds<2>(*this, m_pointTable.concurrentReads(), lo, hi);
+    growRange(output.minx, output.maxx, lo[0], hi[0]);
+    growRange(output.miny, output.maxy, lo[1], hi[1]);
+}
+
+
+void PointView::calculateBounds(BOX3D& output) const
+{
+    double lo[3];
+    double hi[3];
+    viewBounds<3>(*this, m_pointTable.concurrentReads(), lo, hi);
+    growRange(output.minx, output.maxx, lo[0], hi[0]);
+    growRange(output.miny, output.maxy, lo[1], hi[1]);
+    growRange(output.minz, output.maxz, lo[2], hi[2]);
+}
+
 
 MetadataNode PointView::toMetadata() const
 {
@@ -175,13 +259,28 @@ void PointView::invalidateProducts()
 
 KD3Index& PointView::build3dIndex()
 {
-    //ABELL
-    // Should we allow a force of point view build - perhaps the index has
-    // changed or the point values have changed.
-    if (!m_index3)
+    if (!m_index3 || m_index3ModCount != m_modCount)
     {
         m_index3.reset(new KD3Index(*this));
         m_index3->build();
+        m_index3ModCount = m_modCount;
+    }
+    return *m_index3.get();
+}
+
+
+KD3Index& PointView::build3dIndex(const std::string& cacheFile)
+{
+    if (!m_index3 || m_index3ModCount != m_modCount)
+    {
+        m_index3.reset(new KD3Index(*this));
+        if (!m_index3->load(cacheFile))
+        {
+            m_index3->build();
+            // Failing to write the file just means building it next time.
+            m_index3->save(cacheFile);
+        }
+        m_index3ModCount = m_modCount;
     }
     return *m_index3.get();
 }
@@ -189,13 +288,11 @@ KD3Index& PointView::build3dIndex()
 
 KD2Index& PointView::build2dIndex()
 {
-    //ABELL
-    // Should we allow a force of point view build - perhaps the index has
-    // changed or the point values have changed.
-    if (!m_index2)
+    if (!m_index2 || m_index2ModCount != m_modCount)
     {
         m_index2.reset(new KD2Index(*this));
         m_index2->build();
+        m_index2ModCount = m_modCount;
     }
     return *m_index2.get();
 }
@@ -220,7 +317,9 @@ void PointView::dump(std::ostream& ostr) const
             ostr << layout->dimName(d) << " (" <<
                 Dimension::interpretationName(dd->type()) << ") : ";
 
-            switch (dd->type())
+            if (dd->scaled())
+                ostr << getFieldAs<double>(d, idx);
+            else switch (dd->type())
             {
             case Dimension::Type::Signed8:
                 {
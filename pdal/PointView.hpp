@@ -38,11 +38,14 @@
 #include <pdal/DimType.hpp>
 #include <pdal/Mesh.hpp>
 #include <pdal/PointContainer.hpp>
+#include <pdal/PointIndex.hpp>
 #include <pdal/PointLayout.hpp>
 #include <pdal/PointRef.hpp>
 #include <pdal/PointTable.hpp>
 #include <pdal/util/Bounds.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <queue>
 #include <set>
@@ -70,6 +73,8 @@ class PDAL_DLL PointView : public PointContainer
 {
     FRIEND_TEST(VoxelTest, center);
     friend class Stage;
+    friend class MergeFilter;
+    friend class StageCacheReader;
     friend class plang::Invocation;
     friend class PointIdxRef;
     friend struct PointViewLess;
@@ -92,17 +97,74 @@ public:
     bool empty() const
         { return m_size == 0; }
 
+    /**
+      Get a count that changes whenever points join the view, are
+      reordered or have their X, Y or Z changed.  Data derived from the
+      positions of the points is current as long as the count is unchanged.
+
+      \return  The modification count.
+    */
+    uint64_t modCount() const
+        { return m_modCount; }
+
     inline void appendPoint(const PointView& buffer, PointId id);
+
+    /**
+      Make room for 'count' more points to join the view, so that its list
+      of point references isn't grown a piece at a time.  This only
+      reserves space in the view.  Use BasePointTable::reserve() when the
+      points will be new points of the table.
+
+      \param count  Number of points expected to join the view.
+    */
+    void reserve(point_count_t count)
+        { m_index.reserve(m_size + count); }
+
+    /**
+      Append the points of another view.  Only point references are
+      appended.  No point data is copied.
+
+      \param buf  View whose points should be appended.  It must be a view
+        of the same point table.
+    */
     void append(const PointView& buf)
     {
-        // We use size() instead of the index end because temp points
-        // might have been placed at the end of the buffer.
-        // We're essentially ditching temp points.
-        auto thisEnd = m_index.begin() + size();
-        auto bufEnd = buf.m_index.begin() + buf.size();
-        m_index.insert(thisEnd, buf.m_index.begin(), bufEnd);
-        m_size += buf.size();
+        if (&buf.m_pointTable != &m_pointTable)
+            throw pdal_error("Can't append a point view of a different "
+                "point table.");
+
+        // Temp points might have been placed at the end of the index.
+        // We're essentially ditching them.  Dropping them first means the
+        // new references go at the end rather than being inserted.
         clearTemps();
+        m_index.resize(m_size);
+        m_index.append(buf.m_index, buf.size());
+        m_size += buf.size();
+        m_modCount++;
+    }
+
+    /**
+      Reorder the points of the view in place.  Only point references are
+      moved.  No point data is copied.
+
+      \param order  Permutation of the point IDs of the view.  The point
+        at position 'i' after the reorder is the point that was at
+        position 'order[i]' before it.
+    */
+    void reorder(const std::vector<PointId>& order)
+    {
+        if (order.size() != size())
+            throw pdal_error("Can't reorder a point view with an ordering "
+                "of a different size.");
+
+        // Building a new index lets runs of consecutive points form again.
+        PointIndex index;
+        for (PointId i = 0; i < order.size(); ++i)
+            index.push_back(m_index[order[i]]);
+        for (PointId i = order.size(); i < m_index.size(); ++i)
+            index.push_back(m_index[i]);
+        m_index = std::move(index);
+        m_modCount++;
     }
 
     /// Return a new point view with the same point table as this
@@ -127,6 +189,60 @@ public:
     inline void setField(Dimension::Id dim, Dimension::Type type,
         PointId idx, const void *val);
 
+    /**
+      Get the values of a dimension for a range of points, converted to T.
+      This is much faster than calling getFieldAs() for each point,
+      particularly when T is the type of the dimension.
+
+      \param dim  Dimension of the values.
+      \param begin  Index of the first point in the view.
+      \param count  Number of points.
+      \param out  Buffer to hold \ref count values.
+    */
+    template<typename T>
+    void getFieldArray(Dimension::Id dim, PointId begin, point_count_t count,
+        T *out) const;
+
+    /**
+      Set the values of a dimension for a range of points, converting them
+      from T.  The points must already exist in the view.
+
+      \param dim  Dimension of the values.
+      \param begin  Index of the first point in the view.
+      \param count  Number of points.
+      \param in  Buffer holding \ref count values.
+    */
+    template<typename T>
+    void setFieldArray(Dimension::Id dim, PointId begin, point_count_t count,
+        const T *in);
+
+    /**
+      Get the stored integers of a dimension kept as scaled integers
+      (see PointLayout::setScaling()) for a range of points, without
+      converting them.  Writers of data scaled the same way can copy them
+      as they are.
+
+      \param dim  Scaled dimension.
+      \param begin  Index of the first point in the view.
+      \param count  Number of points.
+      \param out  Buffer to hold \ref count values.
+    */
+    void getScaledArray(Dimension::Id dim, PointId begin, point_count_t count,
+        int32_t *out) const;
+
+    /**
+      Set the stored integers of a dimension kept as scaled integers for a
+      range of points, without converting them.  The points must already
+      exist in the view.
+
+      \param dim  Scaled dimension.
+      \param begin  Index of the first point in the view.
+      \param count  Number of points.
+      \param in  Buffer holding \ref count values.
+    */
+    void setScaledArray(Dimension::Id dim, PointId begin, point_count_t count,
+        const int32_t *in);
+
     template <typename T>
     bool compare(Dimension::Id dim, PointId id1, PointId id2)
     {
@@ -137,6 +253,8 @@ public:
     {
         const Dimension::Detail *dd = layout()->dimDetail(dim);
 
+        if (dd->scaled())
+            return getFieldAs<double>(dim, id1) < getFieldAs<double>(dim, id2);
         switch (dd->type())
         {
             case Dimension::Type::Float:
@@ -182,6 +300,8 @@ public:
     }
 
     /*! @return a cumulated bounds of all points in the PointView.
+        Large views are reduced in blocks on several threads unless the
+        point table can't be read concurrently.  NaN values are ignored.
         \verbatim embed:rst
         .. note::
 
@@ -248,6 +368,12 @@ public:
     char *getPoint(PointId id)
         { return m_pointTable.getPoint(m_index[id]); }
 
+    /// Get the ID in the point table of a point of the view, such as to
+    /// find its values in the columns of a ColumnPointTable.
+    /// \param[in] id  Index of the point in the view.
+    PointId tableId(PointId id) const
+        { return m_index[id]; }
+
     /// Provides access to the memory storing the point data.  Though this
     /// function is public, other access methods are safer and preferred.
     char *getOrAddPoint(PointId id)
@@ -256,6 +382,7 @@ public:
         {
             m_index.push_back(m_pointTable.addPoint());
             ++m_size;
+            m_modCount++;
             assert(m_temps.empty());
         }
 
@@ -272,6 +399,10 @@ public:
     }
     MetadataNode toMetadata() const;
 
+    /**
+      Discard the spatial indexes and other products built from the
+      points of the view.
+    */
     void invalidateProducts();
 
     /**
@@ -291,12 +422,39 @@ public:
     */
     TriangularMesh *mesh(const std::string& name = "");
 
+    /**
+      Get a 3D index of the points of the view.  The index is built on the
+      first call and reused by later calls, so stages that follow one
+      another in a pipeline share it.  It's rebuilt if points were added
+      to the view, reordered or had their X, Y or Z values changed through
+      the view since it was built.
+
+      \return  Index of the points of the view.
+    */
     KD3Index& build3dIndex();
+
+    /**
+      Get a 3D index of the points of the view as build3dIndex() does, but
+      read it from a file written by an earlier call rather than building
+      it, if the file holds an index of the same points.  A newly built
+      index is written to the file for next time.
+
+      \param cacheFile  Name of the index file.
+      \return  Index of the points of the view.
+    */
+    KD3Index& build3dIndex(const std::string& cacheFile);
+
+    /**
+      Get a 2D index of the points of the view.  The index is reused as
+      for build3dIndex().
+
+      \return  Index of the points of the view.
+    */
     KD2Index& build2dIndex();
 
 protected:
     PointTableRef m_pointTable;
-    std::deque<PointId> m_index;
+    PointIndex m_index;
     // The index might be larger than the size to support temporary point
     // references.
     point_count_t m_size;
@@ -306,12 +464,32 @@ protected:
     std::map<std::string, std::unique_ptr<TriangularMesh>> m_meshes;
     std::unique_ptr<KD3Index> m_index3;
     std::unique_ptr<KD2Index> m_index2;
+    // Incremented when points join the view, are reordered or have their
+    // X, Y or Z changed.  The indexes are rebuilt when the count has
+    // changed since they were built.
+    uint64_t m_modCount;
+    uint64_t m_index3ModCount;
+    uint64_t m_index2ModCount;
 
 private:
-    static int m_lastId;
+    static std::atomic<int> m_lastId;
+    // Number of points handed to the table at once by the array accessors.
+    enum { BulkCount = 1024 };
 
     template<typename T_IN, typename T_OUT>
     bool convertAndSet(Dimension::Id dim, PointId idx, T_IN in);
+    template<typename T_IN, typename T_OUT>
+    void getConvertedArray(Dimension::Id dim, const PointId *ids,
+        point_count_t count, T_OUT *out) const;
+    template<typename T_IN, typename T_OUT>
+    void setConvertedArray(Dimension::Id dim, const PointId *ids,
+        point_count_t count, const T_IN *in);
+    template<typename T>
+    void getUnscaledArray(Dimension::Id dim, const PointId *ids,
+        point_count_t count, T *out) const;
+    template<typename T>
+    void setUnscaledArray(Dimension::Id dim, const PointId *ids,
+        point_count_t count, const T *in);
 
     virtual void setFieldInternal(Dimension::Id dim, PointId idx,
         const void *buf);
@@ -324,6 +502,12 @@ private:
     inline PointId getTemp(PointId id);
     void freeTemp(PointId id)
         { m_temps.push(id); }
+    void coordsChanged(Dimension::Id dim)
+    {
+        if (dim == Dimension::Id::X || dim == Dimension::Id::Y ||
+                dim == Dimension::Id::Z)
+            m_modCount++;
+    }
     void setSpatialReference(const SpatialReference& spatialRef)
         { m_spatialReference = spatialRef; }
 
@@ -443,7 +627,13 @@ inline T PointView::getFieldAs(Dimension::Id dim,
     const Dimension::Detail *dd = layout()->dimDetail(dim);
     Everything e;
 
-    switch (dd->type())
+    if (dd->scaled())
+    {
+        e.d = dd->xform().fromScaled(getFieldInternal<int32_t>(dim,
+            pointIndex));
+        ok = Utils::numericCast(e.d, retval);
+    }
+    else switch (dd->type())
     {
     case Dimension::Type::Float:
         e.f = getFieldInternal<float>(dim, pointIndex);
@@ -525,7 +715,11 @@ void PointView::setField(Dimension::Id dim, PointId idx, T val)
     const Dimension::Detail *dd = layout()->dimDetail(dim);
 
     bool ok = true;
-    switch (dd->type())
+    double d;
+    if (dd->scaled())
+        ok = Utils::numericCast(val, d) &&
+            convertAndSet<double, int32_t>(dim, idx, dd->xform().toScaled(d));
+    else switch (dd->type())
     {
     case Dimension::Type::Float:
         ok = convertAndSet<T, float>(dim, idx, val);
@@ -572,12 +766,266 @@ void PointView::setField(Dimension::Id dim, PointId idx, T val)
     }
 }
 
+template<typename T_IN, typename T_OUT>
+void PointView::getConvertedArray(Dimension::Id dim, const PointId *ids,
+    point_count_t count, T_OUT *out) const
+{
+    T_IN buf[BulkCount];
+
+    m_pointTable.getFieldsInternal(dim, ids, count, buf);
+    for (point_count_t i = 0; i < count; ++i)
+        if (!Utils::numericCast(buf[i], out[i]))
+        {
+            std::ostringstream oss;
+            oss << "Unable to fetch data and convert as requested: ";
+            oss << Dimension::name(dim) << ":" <<
+                Utils::typeidName<T_IN>() << "(" << (double)buf[i] <<
+                ") -> " << Utils::typeidName<T_OUT>();
+            throw pdal_error(oss.str());
+        }
+}
+
+
+template<typename T>
+void PointView::getFieldArray(Dimension::Id dim, PointId begin,
+    point_count_t count, T *out) const
+{
+    assert(begin + count <= m_size);
+    const Dimension::Detail *dd = layout()->dimDetail(dim);
+    const Dimension::Type type = dd->type();
+    PointId ids[BulkCount];
+
+    while (count)
+    {
+        point_count_t n = (std::min)(count, (point_count_t)BulkCount);
+        m_index.copy(begin, n, ids);
+
+        // When the types match the table fills the buffer directly.
+        // Scaled dimensions are always converted.
+        if (dd->scaled())
+            getUnscaledArray(dim, ids, n, out);
+        else if (type == Dimension::getType<T>())
+            m_pointTable.getFieldsInternal(dim, ids, n, out);
+        else switch (type)
+        {
+        case Dimension::Type::Float:
+            getConvertedArray<float>(dim, ids, n, out);
+            break;
+        case Dimension::Type::Double:
+            getConvertedArray<double>(dim, ids, n, out);
+            break;
+        case Dimension::Type::Signed8:
+            getConvertedArray<int8_t>(dim, ids, n, out);
+            break;
+        case Dimension::Type::Signed16:
+            getConvertedArray<int16_t>(dim, ids, n, out);
+            break;
+        case Dimension::Type::Signed32:
+            getConvertedArray<int32_t>(dim, ids, n, out);
+            break;
+        case Dimension::Type::Signed64:
+            getConvertedArray<int64_t>(dim, ids, n, out);
+            break;
+        case Dimension::Type::Unsigned8:
+            getConvertedArray<uint8_t>(dim, ids, n, out);
+            break;
+        case Dimension::Type::Unsigned16:
+            getConvertedArray<uint16_t>(dim, ids, n, out);
+            break;
+        case Dimension::Type::Unsigned32:
+            getConvertedArray<uint32_t>(dim, ids, n, out);
+            break;
+        case Dimension::Type::Unsigned64:
+            getConvertedArray<uint64_t>(dim, ids, n, out);
+            break;
+        case Dimension::Type::None:
+        default:
+            std::fill(out, out + n, T(0));
+            break;
+        }
+        begin += n;
+        out += n;
+        count -= n;
+    }
+}
+
+
+template<typename T_IN, typename T_OUT>
+void PointView::setConvertedArray(Dimension::Id dim, const PointId *ids,
+    point_count_t count, const T_IN *in)
+{
+    T_OUT buf[BulkCount];
+
+    for (point_count_t i = 0; i < count; ++i)
+        if (!Utils::numericCast(in[i], buf[i]))
+        {
+            std::ostringstream oss;
+            oss << "Unable to set data and convert as requested: ";
+            oss << Dimension::name(dim) << ":" <<
+                Utils::typeidName<T_IN>() << "(" << (double)in[i] <<
+                ") -> " << Utils::typeidName<T_OUT>();
+            throw pdal_error(oss.str());
+        }
+    m_pointTable.setFieldsInternal(dim, ids, count, buf);
+}
+
+
+template<typename T>
+void PointView::setFieldArray(Dimension::Id dim, PointId begin,
+    point_count_t count, const T *in)
+{
+    assert(begin + count <= m_size);
+    const Dimension::Detail *dd = layout()->dimDetail(dim);
+    const Dimension::Type type = dd->type();
+    PointId ids[BulkCount];
+
+    coordsChanged(dim);
+    while (count)
+    {
+        point_count_t n = (std::min)(count, (point_count_t)BulkCount);
+        m_index.copy(begin, n, ids);
+
+        if (dd->scaled())
+            setUnscaledArray(dim, ids, n, in);
+        else if (type == Dimension::getType<T>())
+            m_pointTable.setFieldsInternal(dim, ids, n, in);
+        else switch (type)
+        {
+        case Dimension::Type::Float:
+            setConvertedArray<T, float>(dim, ids, n, in);
+            break;
+        case Dimension::Type::Double:
+            setConvertedArray<T, double>(dim, ids, n, in);
+            break;
+        case Dimension::Type::Signed8:
+            setConvertedArray<T, int8_t>(dim, ids, n, in);
+            break;
+        case Dimension::Type::Signed16:
+            setConvertedArray<T, int16_t>(dim, ids, n, in);
+            break;
+        case Dimension::Type::Signed32:
+            setConvertedArray<T, int32_t>(dim, ids, n, in);
+            break;
+        case Dimension::Type::Signed64:
+            setConvertedArray<T, int64_t>(dim, ids, n, in);
+            break;
+        case Dimension::Type::Unsigned8:
+            setConvertedArray<T, uint8_t>(dim, ids, n, in);
+            break;
+        case Dimension::Type::Unsigned16:
+            setConvertedArray<T, uint16_t>(dim, ids, n, in);
+            break;
+        case Dimension::Type::Unsigned32:
+            setConvertedArray<T, uint32_t>(dim, ids, n, in);
+            break;
+        case Dimension::Type::Unsigned64:
+            setConvertedArray<T, uint64_t>(dim, ids, n, in);
+            break;
+        case Dimension::Type::None:
+        default:
+            break;
+        }
+        begin += n;
+        in += n;
+        count -= n;
+    }
+}
+
+
+template<typename T>
+void PointView::getUnscaledArray(Dimension::Id dim, const PointId *ids,
+    point_count_t count, T *out) const
+{
+    const XForm& xform = layout()->dimDetail(dim)->xform();
+    int32_t buf[BulkCount];
+
+    m_pointTable.getFieldsInternal(dim, ids, count, buf);
+    for (point_count_t i = 0; i < count; ++i)
+    {
+        double d = xform.fromScaled(buf[i]);
+        if (!Utils::numericCast(d, out[i]))
+        {
+            std::ostringstream oss;
+            oss << "Unable to fetch data and convert as requested: ";
+            oss << Dimension::name(dim) << ":double(" << d << ") -> " <<
+                Utils::typeidName<T>();
+            throw pdal_error(oss.str());
+        }
+    }
+}
+
+
+template<typename T>
+void PointView::setUnscaledArray(Dimension::Id dim, const PointId *ids,
+    point_count_t count, const T *in)
+{
+    const XForm& xform = layout()->dimDetail(dim)->xform();
+    int32_t buf[BulkCount];
+
+    for (point_count_t i = 0; i < count; ++i)
+    {
+        double d;
+        if (!Utils::numericCast(in[i], d) ||
+            !Utils::numericCast(xform.toScaled(d), buf[i]))
+        {
+            std::ostringstream oss;
+            oss << "Unable to set data and convert as requested: ";
+            oss << Dimension::name(dim) << ":" <<
+                Utils::typeidName<T>() << "(" << (double)in[i] <<
+                ") -> scaled int32";
+            throw pdal_error(oss.str());
+        }
+    }
+    m_pointTable.setFieldsInternal(dim, ids, count, buf);
+}
+
+
+inline void PointView::getScaledArray(Dimension::Id dim, PointId begin,
+    point_count_t count, int32_t *out) const
+{
+    assert(begin + count <= m_size);
+    assert(layout()->dimDetail(dim)->scaled());
+    PointId ids[BulkCount];
+
+    while (count)
+    {
+        point_count_t n = (std::min)(count, (point_count_t)BulkCount);
+        m_index.copy(begin, n, ids);
+        m_pointTable.getFieldsInternal(dim, ids, n, out);
+        begin += n;
+        out += n;
+        count -= n;
+    }
+}
+
+
+inline void PointView::setScaledArray(Dimension::Id dim, PointId begin,
+    point_count_t count, const int32_t *in)
+{
+    assert(begin + count <= m_size);
+    assert(layout()->dimDetail(dim)->scaled());
+    PointId ids[BulkCount];
+
+    coordsChanged(dim);
+    while (count)
+    {
+        point_count_t n = (std::min)(count, (point_count_t)BulkCount);
+        m_index.copy(begin, n, ids);
+        m_pointTable.setFieldsInternal(dim, ids, n, in);
+        begin += n;
+        in += n;
+        count -= n;
+    }
+}
+
+
 inline void PointView::appendPoint(const PointView& buffer, PointId id)
 {
     // Invalid 'id' is a programmer error.
     PointId rawId = buffer.m_index[id];
     m_index.push_back(rawId);
     m_size++;
+    m_modCount++;
     assert(m_temps.empty());
 }
 
@@ -590,7 +1038,7 @@ inline PointId PointView::getTemp(PointId id)
     {
         newid = m_temps.front();
         m_temps.pop();
-        m_index[newid] = m_index[id];
+        m_index.set(newid, m_index[id]);
     }
     else
     {
@@ -76,7 +76,10 @@ public:
             m_tmp = true;
         }
         else
-            m_buf->m_index[m_id] = r.m_buf->m_index[r.m_id];
+        {
+            m_buf->m_index.set(m_id, r.m_buf->m_index[r.m_id]);
+            m_buf->m_modCount++;
+        }
         return *this;
     }
 
@@ -86,8 +89,9 @@ public:
     void swap(PointIdxRef& p)
     {
         PointId id = m_buf->m_index[m_id];
-        m_buf->m_index[m_id] = p.m_buf->m_index[p.m_id];
-        p.m_buf->m_index[p.m_id] = id;
+        m_buf->m_index.set(m_id, p.m_buf->m_index[p.m_id]);
+        p.m_buf->m_index.set(p.m_id, id);
+        m_buf->m_modCount++;
     }
 };
 
@@ -37,9 +37,88 @@
 
 #include <ogr_geometry.h>
 
+#include <atomic>
+#include <mutex>
+
+#include "private/pnp/GridPnp.hpp"
+
 namespace pdal
 {
 
+// Holds the point-in-polygon engine and the bounds of a polygon.  Each is
+// built once, by whichever thread first needs it.
+class Polygon::PnpCache
+{
+public:
+    PnpCache() : m_built(false), m_envBuilt(false), m_hasEnv(false)
+    {}
+
+    const GridPnp *grid(const Polygon& poly);
+    const OGREnvelope *envelope(const Polygon& poly);
+
+private:
+    std::atomic<bool> m_built;
+    std::atomic<bool> m_envBuilt;
+    std::mutex m_mutex;
+    // Null if the polygon can't be handled by the grid (it's empty, for
+    // example), in which case points are tested with OGR.
+    std::unique_ptr<GridPnp> m_grid;
+    // False if the polygon is empty and so has no bounds.
+    bool m_hasEnv;
+    OGREnvelope m_env;
+};
+
+
+const GridPnp *Polygon::PnpCache::grid(const Polygon& poly)
+{
+    if (m_built.load(std::memory_order_acquire))
+        return m_grid.get();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_built.load(std::memory_order_relaxed))
+    {
+        if (poly.m_geom && !poly.m_geom->IsEmpty())
+        {
+            // The grid handles any number of rings, so the rings of all
+            // the polygons of a multipolygon go into a single engine.
+            std::vector<Ring> rings;
+            for (const Polygon& p : poly.polygons())
+            {
+                rings.push_back(p.exteriorRing());
+                for (const Ring& r : p.interiorRings())
+                    rings.push_back(r);
+            }
+            try
+            {
+                m_grid.reset(new GridPnp(rings));
+            }
+            catch (const grid_error&)
+            {}
+        }
+        m_built.store(true, std::memory_order_release);
+    }
+    return m_grid.get();
+}
+
+
+const OGREnvelope *Polygon::PnpCache::envelope(const Polygon& poly)
+{
+    if (!m_envBuilt.load(std::memory_order_acquire))
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_envBuilt.load(std::memory_order_relaxed))
+        {
+            if (poly.m_geom && !poly.m_geom->IsEmpty())
+            {
+                poly.m_geom->getEnvelope(&m_env);
+                m_hasEnv = true;
+            }
+            m_envBuilt.store(true, std::memory_order_release);
+        }
+    }
+    return m_hasEnv ? &m_env : nullptr;
+}
+
 Polygon::Polygon(OGRGeometryH g, const SpatialReference& srs) : Geometry(g, srs)
 {
     // If the handle was null, we need to create an empty polygon.
@@ -133,6 +212,7 @@ void Polygon::simplify(double distance_tolerance, double area_tolerance)
         for (int i = 0; i < mpoly->getNumGeometries(); ++i)
             deleteSmallRings(mpoly->getGeometryRef(i));
     }
+    modified();
 }
 
 
@@ -162,12 +242,55 @@ double Polygon::area() const
 }
 
 
-bool Polygon::covers(const PointRef& ref) const
+std::shared_ptr<Polygon::PnpCache> Polygon::newPnpCache()
 {
-    throwNoGeos();
+    return std::make_shared<PnpCache>();
+}
+
+
+const GridPnp *Polygon::gridPnp() const
+{
+    return m_pnp->grid(*this);
+}
+
+
+void Polygon::modified() const
+{
+    // Other copies of the polygon may be using the current cache.
+    m_pnp = newPnpCache();
+}
+
 
+// The predicates below are cheap to answer from the bounds of the two
+// polygons when the bounds don't meet, which is the common case when
+// comparing a query polygon against many tiles or features.
+bool Polygon::disjointBounds(const Polygon& p) const
+{
+    const OGREnvelope *e1 = m_pnp->envelope(*this);
+    const OGREnvelope *e2 = p.m_pnp->envelope(p);
+    return e1 && e2 && !e1->Intersects(*e2);
+}
+
+
+// Returns true if the bounds of 'p' are known not to lie within our bounds.
+bool Polygon::boundsExclude(const Polygon& p) const
+{
+    const OGREnvelope *e1 = m_pnp->envelope(*this);
+    const OGREnvelope *e2 = p.m_pnp->envelope(p);
+    return e1 && e2 && !e1->Contains(*e2);
+}
+
+
+bool Polygon::covers(const PointRef& ref) const
+{
     double x = ref.getFieldAs<double>(Dimension::Id::X);
     double y = ref.getFieldAs<double>(Dimension::Id::Y);
+
+    if (const GridPnp *grid = gridPnp())
+        return grid->inside(x, y);
+
+    throwNoGeos();
+
     double z = ref.getFieldAs<double>(Dimension::Id::Z);
 
     OGRPoint p(x, y, z);
@@ -175,10 +298,33 @@ bool Polygon::covers(const PointRef& ref) const
 }
 
 
+void Polygon::covers(const double *x, const double *y, point_count_t count,
+    std::vector<bool>& result) const
+{
+    if (const GridPnp *grid = gridPnp())
+    {
+        grid->inside(x, y, count, result);
+        return;
+    }
+
+    throwNoGeos();
+
+    result.resize(count);
+    for (point_count_t i = 0; i < count; ++i)
+    {
+        OGRPoint p(x[i], y[i]);
+        result[i] = m_geom->Contains(&p) || m_geom->Touches(&p);
+    }
+}
+
+
 bool Polygon::overlaps(const Polygon& p) const
 {
     throwNoGeos();
 
+    if (disjointBounds(p))
+        return false;
+
     return m_geom->Overlaps(p.m_geom.get());
 }
 
@@ -186,6 +332,9 @@ bool Polygon::contains(const Polygon& p) const
 {
     throwNoGeos();
 
+    if (boundsExclude(p))
+        return false;
+
     return m_geom->Contains(p.m_geom.get());
 }
 
@@ -193,6 +342,9 @@ bool Polygon::touches(const Polygon& p) const
 {
     throwNoGeos();
 
+    if (disjointBounds(p))
+        return false;
+
     return m_geom->Touches(p.m_geom.get());
 }
 
@@ -200,6 +352,9 @@ bool Polygon::within(const Polygon& p) const
 {
     throwNoGeos();
 
+    if (p.boundsExclude(*this))
+        return false;
+
     return m_geom->Within(p.m_geom.get());
 }
 
@@ -207,6 +362,9 @@ bool Polygon::crosses(const Polygon& p) const
 {
     throwNoGeos();
 
+    if (disjointBounds(p))
+        return false;
+
     return m_geom->Crosses(p.m_geom.get());
 }
 
@@ -42,6 +42,8 @@
 namespace pdal
 {
 
+class GridPnp;
+
 class PDAL_DLL Polygon : public Geometry
 {
     using Point = std::pair<double, double>;
@@ -66,6 +68,10 @@ public:
     std::vector<Polygon> polygons() const;
 
     bool covers(const PointRef& ref) const;
+    // Determine if each of 'count' points is covered by the polygon.
+    // Point i is at (x[i], y[i]) and its status is written to result[i].
+    void covers(const double *x, const double *y, point_count_t count,
+        std::vector<bool>& result) const;
     bool equal(const Polygon& p) const;
     bool overlaps(const Polygon& p) const;
     bool contains(const Polygon& p) const;
@@ -74,6 +80,19 @@ public:
     bool crosses(const Polygon& p) const;
     Ring exteriorRing() const;
     std::vector<Ring> interiorRings() const;
+
+private:
+    class PnpCache;
+
+    // Point-in-polygon engine and bounds built from the polygon the
+    // first time they're needed.  Copies share them until modified.
+    mutable std::shared_ptr<PnpCache> m_pnp { newPnpCache() };
+
+    static std::shared_ptr<PnpCache> newPnpCache();
+    const GridPnp *gridPnp() const;
+    bool disjointBounds(const Polygon& p) const;
+    bool boundsExclude(const Polygon& p) const;
+    virtual void modified() const;
 };
 
 } // namespace pdal
@@ -32,14 +32,21 @@
 * OF SUCH DAMAGE.
 ****************************************************************************/
 
+#include <algorithm>
 #include <limits>
 #include <cmath>
 #include <memory>
+#include <mutex>
+#include <numeric>
 
 #include <pdal/PointView.hpp>
 #include <pdal/QuadIndex.hpp>
+#include <pdal/util/ThreadPool.hpp>
 #include <pdal/util/Utils.hpp>
 
+#include <pdal/private/Morton.hpp>
+#include <pdal/private/RadixSort.hpp>
+
 namespace
 {
     using namespace pdal;
@@ -478,6 +485,30 @@ void Tree::getPoints(
     }
 }
 
+namespace
+{
+
+// Points in a leaf of the bulk-loaded tree.
+const std::size_t LeafSize = 64;
+
+} // anonymous namespace
+
+// Node of a quadtree stored in an array.  The points are sorted by Morton
+// code, so each node covers a run of them, and the children of a node are
+// stored next to each other.
+struct QuadNode
+{
+    std::size_t begin;       // First sorted point.
+    std::size_t end;         // One past the last sorted point.
+    std::size_t child;       // First child, or 0 for a leaf.
+    std::size_t childCount;
+    // Bounds of the node's points.
+    double xMin;
+    double yMin;
+    double xMax;
+    double yMax;
+};
+
 struct QuadIndex::QImpl
 {
     QImpl(const PointView& view, std::size_t topLevel);
@@ -504,7 +535,7 @@ struct QuadIndex::QImpl
 
     std::size_t getDepth() const;
 
-    std::vector<std::size_t> getFills();
+    std::vector<std::size_t> getFills() const;
 
     std::vector<PointId> getPoints(
             std::size_t depthBegin,
@@ -535,49 +566,65 @@ struct QuadIndex::QImpl
             std::size_t depthBegin,
             std::size_t depthEnd) const;
 
+    void getPoints(
+            double xMin,
+            double yMin,
+            double xMax,
+            double yMax,
+            std::vector<PointId>& results) const;
+
+    void load(std::vector<double>& x, std::vector<double>& y,
+            const std::vector<PointId>& ids);
+    void buildTree() const;
+
     std::size_t m_topLevel;
+    double m_xMin;
+    double m_yMin;
+    double m_xMax;
+    double m_yMax;
+
+    // Bulk-loaded tree, which answers queries for all the points in a box.
+    std::vector<PointId> m_ids;
+    std::vector<double> m_x;
+    std::vector<double> m_y;
+    std::vector<QuadNode> m_nodes;
+
+    // The tree of points by depth, built on first use, which answers the
+    // queries that depend on the depth of points.
+    const PointView *m_view;
     std::vector<std::shared_ptr<QuadPointRef> > m_pointRefVec;
-    std::unique_ptr<Tree> m_tree;
-    std::size_t m_depth;
-    std::vector<std::size_t> m_fills;
+    mutable std::once_flag m_treeFlag;
+    mutable std::unique_ptr<Tree> m_tree;
+    mutable std::size_t m_depth;
+    mutable std::vector<std::size_t> m_fills;
 };
 
 QuadIndex::QImpl::QImpl(const PointView& view, std::size_t topLevel)
     : m_topLevel(topLevel)
-    , m_pointRefVec()
-    , m_tree()
+    , m_view(&view)
     , m_depth(0)
-    , m_fills()
 {
-    m_pointRefVec.resize(view.size());
-
-    double xMin((std::numeric_limits<double>::max)());
-    double yMin((std::numeric_limits<double>::max)());
-    double xMax((std::numeric_limits<double>::min)());
-    double yMax((std::numeric_limits<double>::min)());
-
-    for (PointId i(0); i < view.size(); ++i)
+    const point_count_t n(view.size());
+    std::vector<double> x(n);
+    std::vector<double> y(n);
+    view.getFieldArray(Dimension::Id::X, 0, n, x.data());
+    view.getFieldArray(Dimension::Id::Y, 0, n, y.data());
+
+    m_xMin = (std::numeric_limits<double>::max)();
+    m_yMin = (std::numeric_limits<double>::max)();
+    m_xMax = (std::numeric_limits<double>::min)();
+    m_yMax = (std::numeric_limits<double>::min)();
+    for (PointId i(0); i < n; ++i)
     {
-        m_pointRefVec[i].reset(
-                new QuadPointRef(
-                    Point(
-                        view.getFieldAs<double>(Dimension::Id::X, i),
-                        view.getFieldAs<double>(Dimension::Id::Y, i)),
-                i));
-
-        const QuadPointRef* pointRef(m_pointRefVec[i].get());
-        if (pointRef->point.x < xMin) xMin = pointRef->point.x;
-        if (pointRef->point.x > xMax) xMax = pointRef->point.x;
-        if (pointRef->point.y < yMin) yMin = pointRef->point.y;
-        if (pointRef->point.y > yMax) yMax = pointRef->point.y;
+        if (x[i] < m_xMin) m_xMin = x[i];
+        if (x[i] > m_xMax) m_xMax = x[i];
+        if (y[i] < m_yMin) m_yMin = y[i];
+        if (y[i] > m_yMax) m_yMax = y[i];
     }
 
-    m_tree.reset(new Tree(BBox(Point(xMin, yMin), Point(xMax, yMax))));
-
-    for (std::size_t i = 0; i < m_pointRefVec.size(); ++i)
-    {
-        m_depth = (std::max)(m_tree->addPoint(m_pointRefVec[i].get()), m_depth);
-    }
+    std::vector<PointId> ids(n);
+    std::iota(ids.begin(), ids.end(), 0);
+    load(x, y, ids);
 }
 
 QuadIndex::QImpl::QImpl(
@@ -588,29 +635,22 @@ QuadIndex::QImpl::QImpl(
         double yMax,
         std::size_t topLevel)
     : m_topLevel(topLevel)
-    , m_pointRefVec()
-    , m_tree()
+    , m_xMin(xMin)
+    , m_yMin(yMin)
+    , m_xMax(xMax)
+    , m_yMax(yMax)
+    , m_view(&view)
     , m_depth(0)
-    , m_fills()
 {
-    m_pointRefVec.resize(view.size());
-
-    for (PointId i(0); i < view.size(); ++i)
-    {
-        m_pointRefVec[i].reset(
-                new QuadPointRef(
-                    Point(
-                        view.getFieldAs<double>(Dimension::Id::X, i),
-                        view.getFieldAs<double>(Dimension::Id::Y, i)),
-                i));
-    }
-
-    m_tree.reset(new Tree(BBox(Point(xMin, yMin), Point(xMax, yMax))));
-
-    for (std::size_t i = 0; i < m_pointRefVec.size(); ++i)
-    {
-        m_depth = (std::max)(m_tree->addPoint(m_pointRefVec[i].get()), m_depth);
-    }
+    const point_count_t n(view.size());
+    std::vector<double> x(n);
+    std::vector<double> y(n);
+    view.getFieldArray(Dimension::Id::X, 0, n, x.data());
+    view.getFieldArray(Dimension::Id::Y, 0, n, y.data());
+
+    std::vector<PointId> ids(n);
+    std::iota(ids.begin(), ids.end(), 0);
+    load(x, y, ids);
 }
 
 QuadIndex::QImpl::QImpl(
@@ -621,18 +661,187 @@ QuadIndex::QImpl::QImpl(
         double yMax,
         std::size_t topLevel)
     : m_topLevel(topLevel)
-    , m_pointRefVec(points.size())
-    , m_tree()
+    , m_xMin(xMin)
+    , m_yMin(yMin)
+    , m_xMax(xMax)
+    , m_yMax(yMax)
+    , m_view(nullptr)
+    , m_pointRefVec(points)
     , m_depth(0)
-    , m_fills()
 {
-    m_tree.reset(new Tree(BBox(Point(xMin, yMin), Point(xMax, yMax))));
-
+    std::vector<double> x(points.size());
+    std::vector<double> y(points.size());
+    std::vector<PointId> ids(points.size());
     for (std::size_t i = 0; i < points.size(); ++i)
     {
-        m_pointRefVec[i] = points[i];
-        m_depth = (std::max)(m_tree->addPoint(m_pointRefVec[i].get()), m_depth);
+        x[i] = points[i]->point.x;
+        y[i] = points[i]->point.y;
+        ids[i] = points[i]->pbIndex;
     }
+    load(x, y, ids);
+}
+
+// Sort the points by the Morton code of their position in the index bounds
+// and split the sorted points into nodes, each of which covers a quadrant
+// of its parent.  Points outside of the bounds are placed in the nearest
+// cell, which is fine since the nodes keep the bounds of their points.
+void QuadIndex::QImpl::load(std::vector<double>& x, std::vector<double>& y,
+        const std::vector<PointId>& ids)
+{
+    const std::size_t n(ids.size());
+    if (n == 0)
+        return;
+
+    const double maxCell((std::numeric_limits<uint32_t>::max)());
+    const double xScale(m_xMax > m_xMin ? maxCell / (m_xMax - m_xMin) : 0);
+    const double yScale(m_yMax > m_yMin ? maxCell / (m_yMax - m_yMin) : 0);
+    auto cell = [maxCell](double d)
+    {
+        return (uint64_t)(std::max)(0.0, (std::min)(d, maxCell));
+    };
+
+    std::vector<uint64_t> codes(n);
+    parallelFor(n, [&]()
+    {
+        return [&](std::size_t i)
+        {
+            codes[i] = part1_by1(cell((x[i] - m_xMin) * xScale)) |
+                (part1_by1(cell((y[i] - m_yMin) * yScale)) << 1);
+        };
+    }, 65536);
+
+    std::vector<PointId> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    radixSort(codes, order);
+
+    m_ids.resize(n);
+    m_x.resize(n);
+    m_y.resize(n);
+    parallelFor(n, [&]()
+    {
+        return [&](std::size_t i)
+        {
+            m_ids[i] = ids[order[i]];
+            m_x[i] = x[order[i]];
+            m_y[i] = y[order[i]];
+        };
+    }, 65536);
+    std::vector<double>().swap(x);
+    std::vector<double>().swap(y);
+
+    // Split the nodes breadth first, so the children of each node are
+    // added together.  A node's points share the top 2 * level bits of
+    // their codes.
+    std::vector<int> levels;
+    m_nodes.push_back(QuadNode { 0, n, 0, 0, 0, 0, 0, 0 });
+    levels.push_back(0);
+    std::vector<std::size_t> leaves;
+    for (std::size_t ni = 0; ni < m_nodes.size(); ++ni)
+    {
+        QuadNode node = m_nodes[ni];
+        int level = levels[ni];
+        if (node.end - node.begin <= LeafSize || level == 32 ||
+                codes[node.begin] == codes[node.end - 1])
+        {
+            leaves.push_back(ni);
+            continue;
+        }
+
+        const int shift = 64 - 2 * (level + 1);
+        const uint64_t prefix =
+            level ? codes[node.begin] >> (shift + 2) : 0;
+        std::size_t begin = node.begin;
+        std::size_t child = m_nodes.size();
+        for (uint64_t q = 0; q < 4 && begin < node.end; ++q)
+        {
+            std::size_t end = node.end;
+            if (q < 3)
+            {
+                uint64_t limit = ((prefix << 2) | (q + 1)) << shift;
+                end = std::lower_bound(codes.begin() + begin,
+                    codes.begin() + node.end, limit) - codes.begin();
+            }
+            if (end > begin)
+            {
+                m_nodes.push_back(QuadNode { begin, end, 0, 0, 0, 0, 0, 0 });
+                levels.push_back(level + 1);
+            }
+            begin = end;
+        }
+        m_nodes[ni].child = child;
+        m_nodes[ni].childCount = m_nodes.size() - child;
+    }
+
+    // Find the bounds of the leaves on several threads and those of the
+    // other nodes from their children.  Children always follow their
+    // parents.
+    parallelFor(leaves.size(), [&]()
+    {
+        return [&](std::size_t l)
+        {
+            QuadNode& node = m_nodes[leaves[l]];
+            node.xMin = node.xMax = m_x[node.begin];
+            node.yMin = node.yMax = m_y[node.begin];
+            for (std::size_t i = node.begin + 1; i < node.end; ++i)
+            {
+                node.xMin = (std::min)(node.xMin, m_x[i]);
+                node.xMax = (std::max)(node.xMax, m_x[i]);
+                node.yMin = (std::min)(node.yMin, m_y[i]);
+                node.yMax = (std::max)(node.yMax, m_y[i]);
+            }
+        };
+    }, 64);
+    for (std::size_t ni = m_nodes.size(); ni-- > 0;)
+    {
+        QuadNode& node = m_nodes[ni];
+        if (!node.childCount)
+            continue;
+        const QuadNode& first = m_nodes[node.child];
+        node.xMin = first.xMin;
+        node.yMin = first.yMin;
+        node.xMax = first.xMax;
+        node.yMax = first.yMax;
+        for (std::size_t c = 1; c < node.childCount; ++c)
+        {
+            const QuadNode& other = m_nodes[node.child + c];
+            node.xMin = (std::min)(node.xMin, other.xMin);
+            node.yMin = (std::min)(node.yMin, other.yMin);
+            node.xMax = (std::max)(node.xMax, other.xMax);
+            node.yMax = (std::max)(node.yMax, other.yMax);
+        }
+    }
+}
+
+// Build the tree of points by depth by inserting the points one at a time
+// in their original order.
+void QuadIndex::QImpl::buildTree() const
+{
+    std::call_once(m_treeFlag, [this]()
+    {
+        std::vector<std::shared_ptr<QuadPointRef> > refs(m_pointRefVec);
+        if (m_view)
+        {
+            refs.resize(m_view->size());
+            for (PointId i(0); i < m_view->size(); ++i)
+                refs[i].reset(
+                        new QuadPointRef(
+                            Point(
+                                m_view->getFieldAs<double>(
+                                    Dimension::Id::X, i),
+                                m_view->getFieldAs<double>(
+                                    Dimension::Id::Y, i)),
+                        i));
+        }
+
+        m_tree.reset(new Tree(BBox(Point(m_xMin, m_yMin),
+            Point(m_xMax, m_yMax))));
+        for (std::size_t i = 0; i < refs.size(); ++i)
+            m_depth = (std::max)(m_tree->addPoint(refs[i].get()), m_depth);
+        m_tree->getFills(m_fills);
+
+        // The tree refers to the points, so they're kept.
+        const_cast<QImpl *>(this)->m_pointRefVec.swap(refs);
+    });
 }
 
 void QuadIndex::QImpl::getBounds(
@@ -641,27 +850,21 @@ void QuadIndex::QImpl::getBounds(
         double& xMax,
         double& yMax) const
 {
-    if (m_tree)
-    {
-        xMin = m_tree->bbox.minimum.x;
-        yMin = m_tree->bbox.minimum.y;
-        xMax = m_tree->bbox.maximum.x;
-        yMax = m_tree->bbox.maximum.y;
-    }
+    xMin = m_xMin;
+    yMin = m_yMin;
+    xMax = m_xMax;
+    yMax = m_yMax;
 }
 
 std::size_t QuadIndex::QImpl::getDepth() const
 {
+    buildTree();
     return m_depth;
 }
 
-std::vector<std::size_t> QuadIndex::QImpl::getFills()
+std::vector<std::size_t> QuadIndex::QImpl::getFills() const
 {
-    if (m_tree && !m_fills.size())
-    {
-        m_tree->getFills(m_fills);
-    }
-
+    buildTree();
     return m_fills;
 }
 
@@ -671,11 +874,8 @@ std::vector<PointId> QuadIndex::QImpl::getPoints(
 {
     std::vector<PointId> results;
 
-    if (m_tree)
-    {
-        m_tree->getPoints(results, minDepth, maxDepth, m_topLevel);
-    }
-
+    buildTree();
+    m_tree->getPoints(results, minDepth, maxDepth, m_topLevel);
     return results;
 }
 
@@ -690,33 +890,31 @@ std::vector<PointId> QuadIndex::QImpl::getPoints(
 {
     std::vector<PointId> results;
 
-    if (m_tree)
-    {
-        const size_t exp(static_cast<size_t>(std::pow(2, rasterize)));
-        const double xWidth(m_tree->bbox.maximum.x - m_tree->bbox.minimum.x);
-        const double yWidth(m_tree->bbox.maximum.y - m_tree->bbox.minimum.y);
+    buildTree();
+    const size_t exp(static_cast<size_t>(std::pow(2, rasterize)));
+    const double xWidth(m_tree->bbox.maximum.x - m_tree->bbox.minimum.x);
+    const double yWidth(m_tree->bbox.maximum.y - m_tree->bbox.minimum.y);
 
-        xStep = xWidth / exp;
-        yStep = yWidth / exp;
-        xBegin =    m_tree->bbox.minimum.x + (xStep / 2);
-        yBegin =    m_tree->bbox.minimum.y + (yStep / 2);
-        // One tick past the end.
-        xEnd =      m_tree->bbox.maximum.x + (xStep / 2);
-        yEnd =      m_tree->bbox.maximum.y + (yStep / 2);
+    xStep = xWidth / exp;
+    yStep = yWidth / exp;
+    xBegin =    m_tree->bbox.minimum.x + (xStep / 2);
+    yBegin =    m_tree->bbox.minimum.y + (yStep / 2);
+    // One tick past the end.
+    xEnd =      m_tree->bbox.maximum.x + (xStep / 2);
+    yEnd =      m_tree->bbox.maximum.y + (yStep / 2);
 
-        results.resize(exp * exp, (std::numeric_limits<PointId>::max)());
+    results.resize(exp * exp, (std::numeric_limits<PointId>::max)());
 
-        m_tree->getPoints(
-                results,
-                rasterize,
-                xBegin,
-                xEnd,
-                xStep,
-                yBegin,
-                yEnd,
-                yStep,
-                m_topLevel);
-    }
+    m_tree->getPoints(
+            results,
+            rasterize,
+            xBegin,
+            xEnd,
+            xStep,
+            yBegin,
+            yEnd,
+            yStep,
+            m_topLevel);
 
     return results;
 }
@@ -731,23 +929,21 @@ std::vector<PointId> QuadIndex::QImpl::getPoints(
 {
     std::vector<PointId> results;
 
-    if (m_tree)
-    {
-        size_t width(
-            static_cast<size_t>(Utils::sround((xEnd - xBegin) / xStep)));
-        std::size_t height(
-            static_cast<size_t>(Utils::sround((yEnd - yBegin) / yStep)));
-        results.resize(width * height, (std::numeric_limits<PointId>::max)());
+    buildTree();
+    size_t width(
+        static_cast<size_t>(Utils::sround((xEnd - xBegin) / xStep)));
+    std::size_t height(
+        static_cast<size_t>(Utils::sround((yEnd - yBegin) / yStep)));
+    results.resize(width * height, (std::numeric_limits<PointId>::max)());
 
-        m_tree->getPoints(
-                results,
-                xBegin,
-                xEnd,
-                xStep,
-                yBegin,
-                yEnd,
-                yStep);
-    }
+    m_tree->getPoints(
+            results,
+            xBegin,
+            xEnd,
+            xStep,
+            yBegin,
+            yEnd,
+            yStep);
 
     return results;
 }
@@ -763,21 +959,71 @@ std::vector<PointId> QuadIndex::QImpl::getPoints(
     std::vector<PointId> results;
 
     // Making BBox from external parameters here, so do some light validation.
-    if (m_tree)
+    const double x0((std::min)(xMin, xMax));
+    const double y0((std::min)(yMin, yMax));
+    const double x1((std::max)(xMin, xMax));
+    const double y1((std::max)(yMin, yMax));
+
+    // Only the tree by depth knows the depth of points.
+    if (minDepth > m_topLevel || maxDepth != 0)
     {
+        buildTree();
         m_tree->getPoints(
                 results,
-                BBox(
-                    Point((std::min)(xMin, xMax), (std::min)(yMin, yMax)),
-                    Point((std::max)(xMin, xMax), (std::max)(yMin, yMax))),
+                BBox(Point(x0, y0), Point(x1, y1)),
                 minDepth,
                 maxDepth,
                 m_topLevel);
     }
+    else
+        getPoints(x0, y0, x1, y1, results);
 
     return results;
 }
 
+// Append the points in [xMin, xMax) x [yMin, yMax) from the bulk-loaded
+// tree.  Nodes that are entirely inside the box are added without looking
+// at their points.
+void QuadIndex::QImpl::getPoints(
+        double xMin,
+        double yMin,
+        double xMax,
+        double yMax,
+        std::vector<PointId>& results) const
+{
+    if (m_nodes.empty())
+        return;
+
+    std::vector<std::size_t> stack(1, 0);
+    while (stack.size())
+    {
+        const QuadNode& node = m_nodes[stack.back()];
+        stack.pop_back();
+
+        if (node.xMax < xMin || node.yMax < yMin ||
+                node.xMin >= xMax || node.yMin >= yMax)
+            continue;
+        if (node.xMin >= xMin && node.yMin >= yMin &&
+                node.xMax < xMax && node.yMax < yMax)
+        {
+            results.insert(results.end(), m_ids.begin() + node.begin,
+                m_ids.begin() + node.end);
+        }
+        else if (node.childCount)
+        {
+            for (std::size_t c = 0; c < node.childCount; ++c)
+                stack.push_back(node.child + c);
+        }
+        else
+        {
+            for (std::size_t i = node.begin; i < node.end; ++i)
+                if (m_x[i] >= xMin && m_y[i] >= yMin &&
+                        m_x[i] < xMax && m_y[i] < yMax)
+                    results.push_back(m_ids[i]);
+        }
+    }
+}
+
 QuadIndex::QuadIndex(const PointView& view, std::size_t topLevel)
     : m_qImpl(new QImpl(view, topLevel))
 { }
@@ -906,5 +1152,20 @@ std::vector<PointId> QuadIndex::getPoints(
             depthEnd);
 }
 
+std::vector<std::vector<PointId>> QuadIndex::getPoints(
+        const std::vector<BOX2D>& boxes) const
+{
+    std::vector<std::vector<PointId>> results(boxes.size());
+    parallelFor(boxes.size(), [&]()
+    {
+        return [&](std::size_t i)
+        {
+            const BOX2D& b(boxes[i]);
+            m_qImpl->getPoints(b.minx, b.miny, b.maxx, b.maxy, results[i]);
+        };
+    }, 1);
+    return results;
+}
+
 } // namespace pdal
 
@@ -77,6 +77,11 @@ struct QuadPointRef
     QuadPointRef(const QuadPointRef&); // not implemented
 };
 
+// A 2D index of the points of a view.  The index is bulk-loaded from the
+// points sorted by Morton code into an array of nodes, which answers
+// bounding box queries.  Queries that depend on the depth of points in the
+// tree (fills, rasters and depth ranges) use a tree of points by depth
+// that is built on first use.  The view must outlive the index.
 class PDAL_DLL QuadIndex
 {
 public:
@@ -157,6 +162,11 @@ public:
         return getPoints(box.minx, box.miny, box.maxx, box.maxy, depthEnd);
     }
 
+    // Return the points within each of several bounding boxes, found on
+    // several threads.  The points of each box are in no particular order.
+    std::vector<std::vector<PointId>> getPoints(
+            const std::vector<BOX2D>& boxes) const;
+
     // Return all points within the bounding box, searching at tree depth
     // levels from [depthBegin, depthEnd).
     // A depthEnd value of zero will return all points within the query range
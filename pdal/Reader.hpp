@@ -37,6 +37,7 @@
 #include <pdal/Stage.hpp>
 #include <pdal/Options.hpp>
 
+#include <algorithm>
 #include <functional>
 
 namespace pdal
@@ -57,6 +58,49 @@ public:
     point_count_t count() const
         { return m_count; }
 
+    /**
+      Get the number of points the reader expects to read, as found in the
+      header of a file.  Storage for this many points, or 'count' if it's
+      smaller, is reserved before the points are read.
+
+      \return  Expected number of points, or 0 if it isn't known.
+    */
+    virtual point_count_t numPoints() const
+        { return 0; }
+
+    /**
+      Tell the reader that points outside of a bounds box will be dropped
+      by the stages that follow it.  Readers that can find points by
+      location may use this to skip data.  Skipping isn't required since
+      later stages still drop the points.
+
+      \param bounds  Bounds outside of which points may be skipped.
+    */
+    virtual void restrictBounds(const BOX3D& /*bounds*/)
+        {}
+
+    /**
+      Tell the reader that only the first 'count' points will be used by
+      the stages that follow it.  The reader's own count is lowered if
+      it's larger.
+
+      \param count  Number of points needed.
+    */
+    virtual void restrictCount(point_count_t count)
+        { m_count = (std::min)(m_count, count); }
+
+    /**
+      Tell the reader that only the points at some positions will be used
+      by the stages that follow it.  Unlike bounds, a selection that's
+      taken must be honored, since later stages stop dropping points.
+      Readers that drop points themselves can't take a selection.
+
+      \param selection  Positions of the points needed.
+      \return  Whether the reader will read only the selected points.
+    */
+    virtual bool restrictSelection(const PointSelection& /*selection*/)
+        { return false; }
+
     using Stage::setSpatialReference;
 
 protected:
@@ -78,6 +122,12 @@ private:
         PointViewSet viewSet;
 
         view->clearTemps();
+        const point_count_t expected = (std::min)(numPoints(), m_count);
+        if (expected)
+        {
+            view->reserve(expected);
+            view->table().reserve(expected);
+        }
         read(view, m_count);
         viewSet.insert(view);
         return viewSet;
@@ -0,0 +1,94 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (hobu.inc@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+/*
+ * Layout of the POSIX shared-memory segment written by
+ * pdal::SharedMemoryPointTable.  This header is plain C so that programs
+ * in other languages can map a segment read-only and use the points
+ * without PDAL.
+ *
+ * The segment starts with a pdal_shm_header, followed by dim_count
+ * pdal_shm_dim records.  Points start data_offset bytes from the start of
+ * the segment and are point_size bytes apart.  The value of a dimension is
+ * at the dimension's offset in a point.  All values are in the byte order
+ * of the host.
+ *
+ * point_count is updated as points are added.  Wait for state to be
+ * PDAL_SHM_COMPLETE before using the points.
+ */
+
+#ifndef PDAL_SHARED_MEMORY_LAYOUT_H
+#define PDAL_SHARED_MEMORY_LAYOUT_H
+
+#include <stdint.h>
+
+#define PDAL_SHM_MAGIC 0x4d484450u
+#define PDAL_SHM_VERSION 1
+
+/* Values of pdal_shm_header.state. */
+#define PDAL_SHM_WRITING 0
+#define PDAL_SHM_COMPLETE 1
+
+/*
+ * Dimension types, as pdal::Dimension::Type.  The size of a value in bytes
+ * is in the low byte and its base type is one of these.
+ */
+#define PDAL_SHM_SIGNED 0x100
+#define PDAL_SHM_UNSIGNED 0x200
+#define PDAL_SHM_FLOATING 0x400
+#define PDAL_SHM_TYPE_SIZE(type) ((type) & 0xFF)
+
+#define PDAL_SHM_NAME_SIZE 64
+
+struct pdal_shm_dim
+{
+    char name[PDAL_SHM_NAME_SIZE];  /* Null-terminated dimension name. */
+    uint32_t type;
+    uint32_t offset;
+};
+
+struct pdal_shm_header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t state;
+    uint32_t dim_count;
+    uint64_t point_count;
+    uint64_t capacity;
+    uint64_t point_size;
+    uint64_t data_offset;
+};
+
+#endif /* PDAL_SHARED_MEMORY_LAYOUT_H */
@@ -0,0 +1,209 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (hobu.inc@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include <pdal/SharedMemoryPointTable.hpp>
+#include <pdal/SharedMemoryLayout.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace pdal
+{
+
+namespace
+{
+
+std::string segmentName(const std::string& name)
+{
+    if (name.empty())
+        throw pdal_error("Shared memory segment name can't be empty.");
+    return name[0] == '/' ? name : "/" + name;
+}
+
+} // unnamed namespace
+
+
+SharedMemoryPointTable::SharedMemoryPointTable(const std::string& name,
+        point_count_t capacity) :
+    SimplePointTable(m_layout), m_name(segmentName(name)),
+    m_capacity(capacity), m_numPts(0), m_addr(nullptr), m_size(0),
+    m_header(nullptr), m_data(nullptr)
+{
+#ifdef _WIN32
+    throw pdal_error("Shared memory point tables aren't supported on "
+        "Windows.");
+#endif
+}
+
+
+SharedMemoryPointTable::~SharedMemoryPointTable()
+{
+#ifndef _WIN32
+    if (m_addr)
+    {
+        complete();
+        ::munmap(m_addr, m_size);
+    }
+#endif
+}
+
+
+void SharedMemoryPointTable::finalize()
+{
+    BasePointTable::finalize();
+    if (!m_addr)
+        create();
+}
+
+
+// Create the segment and write the header and the layout.
+void SharedMemoryPointTable::create()
+{
+#ifndef _WIN32
+    const Dimension::IdList& dims = m_layout.dims();
+    // The segment's layout describes each value by its type, so values
+    // stored as scaled integers can't be described.
+    for (Dimension::Id id : dims)
+        if (m_layout.dimDetail(id)->scaled())
+            throw pdal_error("Shared memory point table '" + m_name +
+                "' can't store scaled dimension '" + m_layout.dimName(id) +
+                "'.");
+    size_t dimBytes = dims.size() * sizeof(pdal_shm_dim);
+    // Start the points on a cache line.
+    size_t dataOffset = (sizeof(pdal_shm_header) + dimBytes + 63) / 64 * 64;
+    m_size = dataOffset + pointsToBytes(m_capacity);
+
+    ::shm_unlink(m_name.c_str());
+    int fd = ::shm_open(m_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0)
+        throw pdal_error("Can't create shared memory segment '" + m_name +
+            "': " + std::strerror(errno) + ".");
+    // Extending the segment zero-fills it.
+    if (::ftruncate(fd, (off_t)m_size) != 0)
+    {
+        std::string err(std::strerror(errno));
+        ::close(fd);
+        ::shm_unlink(m_name.c_str());
+        throw pdal_error("Can't size shared memory segment '" + m_name +
+            "': " + err + ".");
+    }
+    void *addr = ::mmap(nullptr, m_size, PROT_READ | PROT_WRITE,
+        MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED)
+    {
+        ::shm_unlink(m_name.c_str());
+        throw pdal_error("Can't map shared memory segment '" + m_name +
+            "': " + std::strerror(errno) + ".");
+    }
+    m_addr = static_cast<char *>(addr);
+    m_header = reinterpret_cast<pdal_shm_header *>(m_addr);
+    m_data = m_addr + dataOffset;
+
+    pdal_shm_dim *dim =
+        reinterpret_cast<pdal_shm_dim *>(m_addr + sizeof(pdal_shm_header));
+    for (Dimension::Id id : dims)
+    {
+        std::string name = m_layout.dimName(id);
+        if (name.size() >= PDAL_SHM_NAME_SIZE)
+            throw pdal_error("Dimension name '" + name + "' is too long "
+                "for a shared memory point table.");
+        std::strncpy(dim->name, name.c_str(), PDAL_SHM_NAME_SIZE);
+        dim->type = (uint32_t)Utils::toNative(m_layout.dimType(id));
+        dim->offset = (uint32_t)m_layout.dimOffset(id);
+        dim++;
+    }
+
+    m_header->version = PDAL_SHM_VERSION;
+    m_header->state = PDAL_SHM_WRITING;
+    m_header->dim_count = (uint32_t)dims.size();
+    m_header->point_count = 0;
+    m_header->capacity = m_capacity;
+    m_header->point_size = m_layout.pointSize();
+    m_header->data_offset = dataOffset;
+    // The magic number is written last so that a reader that finds it
+    // sees a complete header.
+    std::atomic_thread_fence(std::memory_order_release);
+    m_header->magic = PDAL_SHM_MAGIC;
+#endif
+}
+
+
+void SharedMemoryPointTable::complete()
+{
+    if (!m_header)
+        return;
+    m_header->point_count = m_numPts;
+    std::atomic_thread_fence(std::memory_order_release);
+    m_header->state = PDAL_SHM_COMPLETE;
+}
+
+
+void SharedMemoryPointTable::remove(const std::string& name)
+{
+#ifndef _WIN32
+    ::shm_unlink(segmentName(name).c_str());
+#endif
+}
+
+
+PointId SharedMemoryPointTable::addPoint()
+{
+    // Points can be added to a table that a pipeline hasn't finalized.
+    if (!m_addr)
+        finalize();
+    if (m_numPts == m_capacity)
+        throw pdal_error("Shared memory point table '" + m_name +
+            "' is full.  It can hold " + std::to_string(m_capacity) +
+            " points.");
+    m_header->point_count = m_numPts + 1;
+    return m_numPts++;
+}
+
+
+char *SharedMemoryPointTable::getPoint(PointId idx)
+{
+    return m_data + pointsToBytes(idx);
+}
+
+} // namespace pdal
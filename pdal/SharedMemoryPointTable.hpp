@@ -0,0 +1,120 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (hobu.inc@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <string>
+
+#include <pdal/PointTable.hpp>
+
+struct pdal_shm_header;
+
+namespace pdal
+{
+
+/**
+  A point table whose points, layout and point count are kept in a POSIX
+  shared-memory segment, so that other processes on the host can map the
+  segment and read the points without them being serialized or copied.
+  The format of the segment is described by the C header
+  pdal/SharedMemoryLayout.h.
+
+  The segment is created when the table is finalized and can hold a fixed
+  number of points.  Memory is only committed as points are written, so
+  the capacity can be generous.  The segment isn't removed when the table
+  is destroyed; it is marked complete so that a reader can use it after
+  the pipeline ends.  Use remove() to delete it.  Not supported on
+  Windows.
+*/
+class PDAL_DLL SharedMemoryPointTable : public SimplePointTable
+{
+public:
+    /**
+      Create a shared-memory point table.
+
+      \param name  Name of the segment.  A leading slash is added if
+        missing.  An existing segment of the same name is replaced.
+      \param capacity  Maximum number of points the table can hold.
+    */
+    SharedMemoryPointTable(const std::string& name, point_count_t capacity);
+    virtual ~SharedMemoryPointTable();
+
+    virtual bool supportsView() const
+        { return true; }
+    virtual void finalize();
+    virtual uint64_t allocatedBytes() const
+        { return pointsToBytes(m_numPts); }
+
+    /**
+      Get the name of the segment, including the leading slash.
+
+      \return  Name of the segment.
+    */
+    std::string name() const
+        { return m_name; }
+
+    /**
+      Mark the points in the segment as complete.  Readers can use the
+      points once this has been done.  Called when the table is destroyed.
+    */
+    void complete();
+
+    /**
+      Remove a shared-memory segment.  Processes that have the segment
+      mapped can continue to use it.
+
+      \param name  Name of the segment.
+    */
+    static void remove(const std::string& name);
+
+protected:
+    virtual char *getPoint(PointId idx);
+
+private:
+    virtual PointId addPoint();
+    void create();
+
+    std::string m_name;
+    point_count_t m_capacity;
+    point_count_t m_numPts;
+    char *m_addr;
+    std::size_t m_size;
+    pdal_shm_header *m_header;
+    char *m_data;
+
+    PointLayout m_layout;
+};
+
+} // namespace pdal
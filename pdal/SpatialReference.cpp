@@ -33,6 +33,8 @@
  ****************************************************************************/
 
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 
 #include <pdal/SpatialReference.hpp>
 #include <pdal/PDALUtils.hpp>
@@ -70,6 +72,51 @@ OGRScopedSpatialReference ogrCreateSrs(std::string s = "")
                 OSRNewSpatialReference(s.c_str())));
 }
 
+// Results of OGR calls on spatial references, kept for the life of the
+// process.  Readers create the same references over and over, once for
+// each file or EPT node, and parsing WKT and searching the PROJ database
+// is slow.  Keys are WKT, which is the form a SpatialReference holds.
+template<typename T>
+class SrsCache
+{
+public:
+    template<typename F>
+    T get(const std::string& key, F compute)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_values.find(key);
+            if (it != m_values.end())
+                return it->second;
+        }
+
+        // Compute without the lock so that threads don't wait for each
+        // other's OGR calls.  Exceptions aren't cached.
+        T value = compute();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_values.size() >= MaxEntries)
+            m_values.clear();
+        m_values.emplace(key, value);
+        return value;
+    }
+
+private:
+    static const size_t MaxEntries = 4096;
+    std::mutex m_mutex;
+    std::unordered_map<std::string, T> m_values;
+};
+
+// Get the result of an OGR call from the cache for its type, computing it
+// if needed.  The name of the call is part of the key.
+template<typename F>
+auto cached(const char *what, const std::string& key, F compute) ->
+    decltype(compute())
+{
+    typedef decltype(compute()) T;
+    static SrsCache<T> cache;
+    return cache.get(what + std::string(1, '\0') + key, compute);
+}
+
 }
 
 namespace pdal
@@ -89,40 +136,49 @@ bool SpatialReference::empty() const
 
 bool SpatialReference::valid() const
 {
-    OGRScopedSpatialReference current(ogrCreateSrs(m_wkt));
-    if (!current)
-        return false;
+    return cached("valid", m_wkt, [this]() -> bool
+    {
+        OGRScopedSpatialReference current(ogrCreateSrs(m_wkt));
+        if (!current)
+            return false;
 
-    OGRErr err = OSRValidate(current.get());
-    return err == OGRERR_NONE;
+        OGRErr err = OSRValidate(current.get());
+        return err == OGRERR_NONE;
+    });
 }
 
 
 std::string SpatialReference::identifyHorizontalEPSG() const
 {
-    OGRScopedSpatialReference srs(ogrCreateSrs(getHorizontal()));
+    return cached("horizontal_epsg", m_wkt, [this]() -> std::string
+    {
+        OGRScopedSpatialReference srs(ogrCreateSrs(getHorizontal()));
 
-    if (!srs || srs->AutoIdentifyEPSG() != OGRERR_NONE)
-        return "";
+        if (!srs || srs->AutoIdentifyEPSG() != OGRERR_NONE)
+            return "";
 
-    if (const char* c = srs->GetAuthorityCode(nullptr))
-        return std::string(c);
+        if (const char* c = srs->GetAuthorityCode(nullptr))
+            return std::string(c);
 
-    return "";
+        return "";
+    });
 }
 
 
 std::string SpatialReference::identifyVerticalEPSG() const
 {
-    OGRScopedSpatialReference srs(ogrCreateSrs(getVertical()));
+    return cached("vertical_epsg", m_wkt, [this]() -> std::string
+    {
+        OGRScopedSpatialReference srs(ogrCreateSrs(getVertical()));
 
-    if (!srs || srs->AutoIdentifyEPSG() != OGRERR_NONE)
-        return "";
+        if (!srs || srs->AutoIdentifyEPSG() != OGRERR_NONE)
+            return "";
 
-    if (const char* c = srs->GetAuthorityCode(nullptr))
-        return std::string(c);
+        if (const char* c = srs->GetAuthorityCode(nullptr))
+            return std::string(c);
 
-    return "";
+        return "";
+    });
 }
 
 
@@ -141,6 +197,14 @@ void SpatialReference::set(std::string v)
         return;
     }
 
+    // WKT is by far the most common input, so don't look for a file
+    // named by it.
+    if (isWKT(v))
+    {
+        m_wkt = v;
+        return;
+    }
+
     std::string newV = FileUtils::readFileIntoString(v);
     if (newV.size())
         v = newV;
@@ -151,95 +215,108 @@ void SpatialReference::set(std::string v)
         return;
     }
 
-    OGRSpatialReference srs(NULL);
-
-    CPLErrorReset();
-    const char* input = v.c_str();
-    OGRErr err = srs.SetFromUserInput(const_cast<char *>(input));
-    if (err != OGRERR_NONE)
+    m_wkt = cached("input", v, [&v]() -> std::string
     {
-        std::ostringstream oss;
-        std::string msg = CPLGetLastErrorMsg();
-        if (msg.empty())
-            msg = "(unknown reason)";
-        oss << "Could not import coordinate system '" << input << "': " <<
-            msg << ".";
-        throw pdal_error(oss.str());
-    }
+        OGRSpatialReference srs(NULL);
 
-    char *poWKT = 0;
-    srs.exportToWkt(&poWKT);
-    m_wkt = poWKT;
-    CPLFree(poWKT);
+        CPLErrorReset();
+        const char* input = v.c_str();
+        OGRErr err = srs.SetFromUserInput(const_cast<char *>(input));
+        if (err != OGRERR_NONE)
+        {
+            std::ostringstream oss;
+            std::string msg = CPLGetLastErrorMsg();
+            if (msg.empty())
+                msg = "(unknown reason)";
+            oss << "Could not import coordinate system '" << input << "': " <<
+                msg << ".";
+            throw pdal_error(oss.str());
+        }
+
+        char *poWKT = 0;
+        srs.exportToWkt(&poWKT);
+        std::string wkt(poWKT);
+        CPLFree(poWKT);
+        return wkt;
+    });
 }
 
 
 std::string SpatialReference::getProj4() const
 {
-    std::string tmp;
+    return cached("proj4", m_wkt, [this]() -> std::string
+    {
+        std::string tmp;
 
-    const char* poWKT = m_wkt.c_str();
+        const char* poWKT = m_wkt.c_str();
 
-    OGRSpatialReference srs(NULL);
-    if (OGRERR_NONE == srs.importFromWkt(const_cast<char **>(&poWKT)))
-    {
-        char* proj4 = nullptr;
-        srs.exportToProj4(&proj4);
-        tmp = proj4;
-        CPLFree(proj4);
-        Utils::trim(tmp);
-    }
+        OGRSpatialReference srs(NULL);
+        if (OGRERR_NONE == srs.importFromWkt(const_cast<char **>(&poWKT)))
+        {
+            char* proj4 = nullptr;
+            srs.exportToProj4(&proj4);
+            tmp = proj4;
+            CPLFree(proj4);
+            Utils::trim(tmp);
+        }
 
-    return tmp;
+        return tmp;
+    });
 }
 
 
 std::string SpatialReference::getVertical() const
 {
-    std::string tmp;
+    return cached("vertical", m_wkt, [this]() -> std::string
+    {
+        std::string tmp;
 
-    OGRScopedSpatialReference poSRS = ogrCreateSrs(m_wkt);
+        OGRScopedSpatialReference poSRS = ogrCreateSrs(m_wkt);
 
-    // Above can fail if m_wkt is bad.
-    if (!poSRS)
-        return tmp;
+        // Above can fail if m_wkt is bad.
+        if (!poSRS)
+            return tmp;
 
-    char *pszWKT = NULL;
+        char *pszWKT = NULL;
 
-    OGR_SRSNode* node = poSRS->GetAttrNode("VERT_CS");
-    if (node && poSRS)
-    {
-        node->exportToWkt(&pszWKT);
-        tmp = pszWKT;
-        CPLFree(pszWKT);
-    }
+        OGR_SRSNode* node = poSRS->GetAttrNode("VERT_CS");
+        if (node && poSRS)
+        {
+            node->exportToWkt(&pszWKT);
+            tmp = pszWKT;
+            CPLFree(pszWKT);
+        }
 
-    return tmp;
+        return tmp;
+    });
 }
 
 
 std::string SpatialReference::getVerticalUnits() const
 {
-    std::string tmp;
-
-    OGRScopedSpatialReference poSRS = ogrCreateSrs(m_wkt);
-    if (poSRS)
+    return cached("vertical_units", m_wkt, [this]() -> std::string
     {
-        OGR_SRSNode* node = poSRS->GetAttrNode("VERT_CS");
-        if (node)
-        {
-            char* units(nullptr);
+        std::string tmp;
 
-            // 'units' remains internal to the OGRSpatialReference
-            // and should not be freed, or modified. It may be invalidated
-            // on the next OGRSpatialReference call.
-            (void)poSRS->GetLinearUnits(&units);
-            tmp = units;
-            Utils::trim(tmp);
+        OGRScopedSpatialReference poSRS = ogrCreateSrs(m_wkt);
+        if (poSRS)
+        {
+            OGR_SRSNode* node = poSRS->GetAttrNode("VERT_CS");
+            if (node)
+            {
+                char* units(nullptr);
+
+                // 'units' remains internal to the OGRSpatialReference
+                // and should not be freed, or modified. It may be invalidated
+                // on the next OGRSpatialReference call.
+                (void)poSRS->GetLinearUnits(&units);
+                tmp = units;
+                Utils::trim(tmp);
+            }
         }
-    }
 
-    return tmp;
+        return tmp;
+    });
 }
 
 
@@ -247,16 +324,21 @@ std::string SpatialReference::getHorizontal() const
 {
     if (m_horizontalWkt.empty())
     {
-        OGRScopedSpatialReference poSRS = ogrCreateSrs(m_wkt);
-
-        if (poSRS)
+        m_horizontalWkt = cached("horizontal", m_wkt, [this]() -> std::string
         {
-            char *pszWKT(nullptr);
-            poSRS->StripVertical();
-            poSRS->exportToWkt(&pszWKT);
-            m_horizontalWkt = pszWKT;
-            CPLFree(pszWKT);
-        }
+            std::string wkt;
+            OGRScopedSpatialReference poSRS = ogrCreateSrs(m_wkt);
+
+            if (poSRS)
+            {
+                char *pszWKT(nullptr);
+                poSRS->StripVertical();
+                poSRS->exportToWkt(&pszWKT);
+                wkt = pszWKT;
+                CPLFree(pszWKT);
+            }
+            return wkt;
+        });
     }
     return m_horizontalWkt;
 }
@@ -264,20 +346,23 @@ std::string SpatialReference::getHorizontal() const
 
 std::string SpatialReference::getHorizontalUnits() const
 {
-    OGRScopedSpatialReference poSRS = ogrCreateSrs(m_wkt);
+    return cached("horizontal_units", m_wkt, [this]() -> std::string
+    {
+        OGRScopedSpatialReference poSRS = ogrCreateSrs(m_wkt);
 
-    if (!poSRS)
-        return std::string();
+        if (!poSRS)
+            return std::string();
 
-    char* units(nullptr);
+        char* units(nullptr);
 
-    // The returned value remains internal to the OGRSpatialReference
-    // and should not be freed, or modified. It may be invalidated on
-    // the next OGRSpatialReference call.
-    double u = poSRS->GetLinearUnits(&units);
-    std::string tmp(units);
-    Utils::trim(tmp);
-    return tmp;
+        // The returned value remains internal to the OGRSpatialReference
+        // and should not be freed, or modified. It may be invalidated on
+        // the next OGRSpatialReference call.
+        double u = poSRS->GetLinearUnits(&units);
+        std::string tmp(units);
+        Utils::trim(tmp);
+        return tmp;
+    });
 }
 
 
@@ -286,15 +371,19 @@ bool SpatialReference::equals(const SpatialReference& input) const
     if (getWKT() == input.getWKT())
         return true;
 
-    OGRScopedSpatialReference current = ogrCreateSrs(getWKT());
-    OGRScopedSpatialReference other = ogrCreateSrs(input.getWKT());
+    std::string key = getWKT() + std::string(1, '\0') + input.getWKT();
+    return cached("equals", key, [this, &input]() -> bool
+    {
+        OGRScopedSpatialReference current = ogrCreateSrs(getWKT());
+        OGRScopedSpatialReference other = ogrCreateSrs(input.getWKT());
 
-    if (!current || !other)
-        return false;
+        if (!current || !other)
+            return false;
 
-    int output = OSRIsSame(current.get(), other.get());
+        int output = OSRIsSame(current.get(), other.get());
 
-    return (output == 1);
+        return (output == 1);
+    });
 }
 
 
@@ -319,34 +408,43 @@ const std::string& SpatialReference::getName() const
 
 bool SpatialReference::isGeographic() const
 {
-    OGRScopedSpatialReference current = ogrCreateSrs(m_wkt);
-    if (!current)
-        return false;
+    return cached("geographic", m_wkt, [this]() -> bool
+    {
+        OGRScopedSpatialReference current = ogrCreateSrs(m_wkt);
+        if (!current)
+            return false;
 
-    bool output = OSRIsGeographic(current.get());
-    return output;
+        bool output = OSRIsGeographic(current.get());
+        return output;
+    });
 }
 
 
 bool SpatialReference::isGeocentric() const
 {
-    OGRScopedSpatialReference current = ogrCreateSrs(m_wkt);
-    if (!current)
-        return false;
+    return cached("geocentric", m_wkt, [this]() -> bool
+    {
+        OGRScopedSpatialReference current = ogrCreateSrs(m_wkt);
+        if (!current)
+            return false;
 
-    bool output = OSRIsGeocentric(current.get());
-    return output;
+        bool output = OSRIsGeocentric(current.get());
+        return output;
+    });
 }
 
 
 bool SpatialReference::isProjected() const
 {
-    OGRScopedSpatialReference current = ogrCreateSrs(m_wkt);
-    if (!current)
-        return false;
+    return cached("projected", m_wkt, [this]() -> bool
+    {
+        OGRScopedSpatialReference current = ogrCreateSrs(m_wkt);
+        if (!current)
+            return false;
 
-    bool output = OSRIsProjected(current.get());
-    return output;
+        bool output = OSRIsProjected(current.get());
+        return output;
+    });
 }
 
 int SpatialReference::calculateZone(double lon, double lat)
@@ -407,30 +505,36 @@ bool SpatialReference::isWKT(const std::string& wkt)
 
 std::string SpatialReference::prettyWkt(const std::string& wkt)
 {
-    std::string outWkt;
+    return cached("pretty", wkt, [&wkt]() -> std::string
+    {
+        std::string outWkt;
 
-    OGRScopedSpatialReference srs = ogrCreateSrs(wkt);
-    if (!srs)
-        return outWkt;
+        OGRScopedSpatialReference srs = ogrCreateSrs(wkt);
+        if (!srs)
+            return outWkt;
 
-    char *buf = nullptr;
-    srs->exportToPrettyWkt(&buf, FALSE);
+        char *buf = nullptr;
+        srs->exportToPrettyWkt(&buf, FALSE);
 
-    outWkt = buf;
-    CPLFree(buf);
-    return outWkt;
+        outWkt = buf;
+        CPLFree(buf);
+        return outWkt;
+    });
 }
 
 
 int SpatialReference::getUTMZone() const
 {
-    OGRScopedSpatialReference current = ogrCreateSrs(m_wkt);
-    if (!current)
-        throw pdal_error("Could not fetch current SRS");
-
-    int north(0);
-    int zone = OSRGetUTMZone(current.get(), &north);
-    return (north ? 1 : -1) * zone;
+    return cached("utm_zone", m_wkt, [this]() -> int
+    {
+        OGRScopedSpatialReference current = ogrCreateSrs(m_wkt);
+        if (!current)
+            throw pdal_error("Could not fetch current SRS");
+
+        int north(0);
+        int zone = OSRGetUTMZone(current.get(), &north);
+        return (north ? 1 : -1) * zone;
+    });
 }
 
 
@@ -32,27 +32,94 @@
 * OF SUCH DAMAGE.
 ****************************************************************************/
 
+#include <pdal/Filter.hpp>
 #include <pdal/GDALUtils.hpp>
 #include <pdal/PipelineManager.hpp>
 #include <pdal/Stage.hpp>
+#include <pdal/StageFactory.hpp>
 #include <pdal/SpatialReference.hpp>
 #include <pdal/PDALUtils.hpp>
 #include <pdal/util/Algorithm.hpp>
+#include <pdal/util/FileUtils.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
+#include <pdal/util/Trace.hpp>
 
 #include "private/StageRunner.hpp"
 
+#include <algorithm>
+#include <condition_variable>
+#include <ctime>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iomanip>
 #include <iterator>
 #include <memory>
+#include <set>
+#include <sstream>
 
 namespace pdal
 {
 
-Stage::Stage() : m_progressFd(-1), m_verbose(0), m_pointCount(0),
-    m_faceCount(0)
+Stage::Stage() : m_progressFd(-1), m_metadataPolicy(MetadataPolicy::Full),
+    m_verbose(0), m_pointCount(0), m_faceCount(0), m_viewThreads(1)
 {}
 
 
+Stage& Stage::clone(StageFactory& factory) const
+{
+    Stage *s = factory.createStage(getName());
+    if (!s)
+        throw pdal_error(getName() + ": Couldn't create copy of stage.");
+    s->m_options = m_options;
+    s->m_tag = m_tag;
+    s->m_log = m_log;
+    s->m_progressFd = m_progressFd;
+    s->m_metadataPolicy = m_metadataPolicy;
+    return *s;
+}
+
+
+std::string Stage::contentHash(const std::string& inputHash) const
+{
+    // Modification times have a resolution of a second or two, so a file
+    // changed that recently could change again without its time changing.
+    const int64_t recent = (int64_t)std::time(nullptr) - 2;
+
+    std::ostringstream oss;
+    oss << getName() << '\n' << inputHash << '\n';
+    // Options are ordered by name, so equal option sets hash the same.
+    // Any option may name a file that's read, such as a raster or script.
+    for (const Option& o : m_options.getOptions())
+    {
+        const std::string& value = o.getValue();
+        oss << o.getName() << '=' << value << '\n';
+        if (value.empty() || !FileUtils::fileExists(value))
+            continue;
+        // Standard input has no modification time and can be different
+        // every time.
+        const int64_t mtime = FileUtils::lastWriteTime(value);
+        if (mtime < 0 || mtime >= recent)
+            return std::string();
+        oss << mtime;
+        if (!FileUtils::isDirectory(value))
+            oss << ':' << FileUtils::fileSize(value);
+        oss << '\n';
+    }
+
+    // FNV-1a
+    const std::string s(oss.str());
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : s)
+        hash = (hash ^ c) * 1099511628211ULL;
+
+    std::ostringstream out;
+    out << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return out.str();
+}
+
+
 void Stage::addConditionalOptions(const Options& opts)
 {
     for (const auto& o : opts.getOptions())
@@ -136,6 +203,7 @@ QuickInfo Stage::preview()
 
 void Stage::prepare(PointTableRef table)
 {
+    m_profile.reset();
     m_args.reset(new ProgramArgs);
     for (size_t i = 0; i < m_inputs.size(); ++i)
     {
@@ -152,80 +220,303 @@ void Stage::prepare(PointTableRef table)
 }
 
 
-PointViewSet Stage::execute(PointTableRef table)
+void Stage::prepareCopy(Stage& copy, PointTableRef table) const
 {
-    table.finalize();
-
-    // We store stage instances instead of stages because a stage may get
-    // executed more than once.  A stage instance is created for each
-    // execution of a stage in a pipeline.  This properly builds out
-    // diamond-shaped pipelines.
-    int stageInstanceId = 1;
-    struct StageInstance
-    {
-        Stage *m_stage;
-        int m_id;
+    copy.m_profile.reset();
+    copy.m_args.reset(new ProgramArgs);
+    copy.handleOptions();
+    copy.startLogging();
+    copy.m_metadata = MetadataNode(getName());
+    copy.readerInitialize(table);
+    copy.writerInitialize(table);
+    copy.initialize(table);
+    copy.addDimensions(table.layout());
+    copy.prepared(table);
+    copy.stopLogging();
+}
 
-        StageInstance(Stage *s, int id) : m_stage(s), m_id(id)
-        {}
-        StageInstance() : m_stage(nullptr), m_id(0)
-        {}
 
-        bool operator<(const StageInstance& other) const
-        { return m_id < other.m_id; }
-    };
+namespace
+{
 
-    std::stack<StageInstance> stages;
+// We store stage instances instead of stages because a stage may get
+// executed more than once.  A stage instance is created for each
+// execution of a stage in a pipeline.  This properly builds out
+// diamond-shaped pipelines.
+struct StageInstance
+{
+    StageInstance(Stage *s, int child) : m_stage(s), m_child(child),
+        m_numInputs(s->getInputs().size()), m_inBranch(false)
+    {}
+
+    Stage *m_stage;
+    int m_child;       // Index of the instance that consumes our output.
+    int m_numInputs;
+    bool m_inBranch;   // Run by the stage that fans out before it.
+};
+
+// Linearize stage execution.  The instances are returned in reverse
+// execution order, so the terminal stage is first.
+std::vector<StageInstance> linearize(Stage *terminal)
+{
+    std::vector<StageInstance> instances;
     std::stack<StageInstance> pending;
-    std::map<StageInstance, StageInstance> children;
-
-    m_log->get(LogLevel::Debug) << "Executing pipeline in standard mode." <<
-        std::endl;
-
-    pending.push(StageInstance(this, stageInstanceId++));
 
-    // Linearize stage execution.
+    pending.push(StageInstance(terminal, -1));
     while (pending.size())
     {
         StageInstance si = pending.top();
         pending.pop();
-        stages.push(si);
-        for (Stage *in : si.m_stage->m_inputs)
+        instances.push_back(si);
+        int child = (int)instances.size() - 1;
+        for (Stage *in : si.m_stage->getInputs())
+            pending.push(StageInstance(in, child));
+    }
+    return instances;
+}
+
+// Find the filters run on the parallel branches of the instances whose
+// stages fan out (see Stage::branchThreads()).  Each instance's chain is
+// in execution order.  The instances in a chain are marked, since they're
+// run by the instance that fans out.
+std::vector<std::vector<int>> findBranches(
+    std::vector<StageInstance>& instances)
+{
+    std::vector<std::vector<int>> branches(instances.size());
+    for (size_t i = 0; i < instances.size(); ++i)
+    {
+        if (instances[i].m_stage->branchThreads() <= 0)
+            continue;
+        for (int c = instances[i].m_child; c >= 0; c = instances[c].m_child)
         {
-            StageInstance parent(in, stageInstanceId++);
-            pending.push(parent);
-            children[parent] = si;
+            Stage *s = instances[c].m_stage;
+            if (s->getInputs().size() != 1 || s->joinsBranches() ||
+                    s->branchThreads() > 0 || !dynamic_cast<Filter *>(s))
+                break;
+            branches[i].push_back(c);
+            instances[c].m_inBranch = true;
         }
     }
+    return branches;
+}
+
+std::vector<Stage *> branchStages(const std::vector<StageInstance>& instances,
+    const std::vector<int>& branch)
+{
+    std::vector<Stage *> stages;
+    for (int i : branch)
+        stages.push_back(instances[i].m_stage);
+    return stages;
+}
+
+// Turn-taking for a stage that runs one view at a time on branch threads.
+struct BranchTurn
+{
+    BranchTurn() : m_next(0)
+    {}
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    size_t m_next;
+};
+
+} // unnamed namespace
+
+
+PointViewSet Stage::execute(PointTableRef table, int threads)
+{
+    table.finalize();
+
+    if (threads > 1)
+    {
+        if (table.enableConcurrency())
+            return executeConcurrent(table, threads);
+        m_log->get(LogLevel::Warning) << "Point table doesn't support "
+            "concurrent execution.  Running with a single thread." <<
+            std::endl;
+    }
+    return executeSerial(table);
+}
+
+
+PointViewSet Stage::executeSerial(PointTableRef table)
+{
+    m_log->get(LogLevel::Debug) << "Executing pipeline in standard mode." <<
+        std::endl;
+
+    std::vector<StageInstance> instances = linearize(this);
+    std::vector<std::vector<int>> branches = findBranches(instances);
 
     // Go through the stages in order, executing
     PointViewSet outViews;
-    std::map<StageInstance, PointViewSet> sets;
-    while (stages.size())
+    std::map<int, PointViewSet> sets;
+    for (int i = (int)instances.size() - 1; i >= 0; --i)
     {
-        StageInstance si = stages.top();
-        stages.pop();
-        PointViewSet& inViews = sets[si];
+        StageInstance& si = instances[i];
+        if (si.m_inBranch)
+            continue;
+        PointViewSet& inViews = sets[i];
         if (inViews.empty())
             inViews.insert(PointViewPtr(new PointView(table)));
         outViews = si.m_stage->execute(table, inViews);
 
-        StageInstance child = children[si];
+        // A stage that fans out runs its views through the following
+        // filters itself.  The last of them passes the views on.
+        int last = i;
+        if (branches[i].size())
+        {
+            outViews = si.m_stage->executeBranch(
+                branchStages(instances, branches[i]), table, outViews,
+                nullptr);
+            last = branches[i].back();
+        }
 
         // If a stage has no child it is the terminal stage.  We're done.
-        if (child.m_stage)
+        int child = instances[last].m_child;
+        if (child >= 0)
             sets[child].insert(outViews.begin(), outViews.end());
         // Allow previous point views to be freed.
-        sets.erase(si);
+        sets.erase(i);
     }
     return outViews;
 }
 
-PointViewSet Stage::execute(PointTableRef table, PointViewSet& views)
+
+PointViewSet Stage::executeConcurrent(PointTableRef table, int threads)
 {
+    m_log->get(LogLevel::Debug) << "Executing pipeline in standard mode "
+        "with " << threads << " threads." << std::endl;
+
+    std::vector<StageInstance> instances = linearize(this);
+    std::vector<std::vector<int>> branches = findBranches(instances);
+    std::vector<PointViewSet> sets(instances.size());
+
+    // Create the views for source stages up front and in serial execution
+    // order so that view IDs, and therefore view ordering at joins, match
+    // what we'd get running with a single thread.
+    for (int i = (int)instances.size() - 1; i >= 0; --i)
+        if (instances[i].m_numInputs == 0)
+            sets[i].insert(PointViewPtr(new PointView(table)));
+
+    std::mutex mutex;
+    std::mutex tableMutex;
+    std::condition_variable cv;
+    std::deque<int> finished;
+    std::exception_ptr error;
+
+    // Instances ready to run, kept in serial execution order.
+    std::set<int, std::greater<int>> ready;
+    std::set<Stage *> running;
+    for (int i = 0; i < (int)instances.size(); ++i)
+        if (instances[i].m_numInputs == 0)
+            ready.insert(i);
+
+    ThreadPool pool(threads, instances.size());
+    PointViewSet outViews;
+    size_t remaining = instances.size();
+    size_t active = 0;
+    while (remaining)
+    {
+        // Start everything that's ready, but never run the same stage
+        // twice at once.
+        if (!error)
+        {
+            for (auto ri = ready.begin(); ri != ready.end();)
+            {
+                int i = *ri;
+                Stage *stage = instances[i].m_stage;
+                std::vector<Stage *> stages(
+                    branchStages(instances, branches[i]));
+                stages.push_back(stage);
+                if (std::any_of(stages.begin(), stages.end(),
+                        [&running](Stage *s){ return running.count(s); }))
+                {
+                    ri++;
+                    continue;
+                }
+                running.insert(stages.begin(), stages.end());
+                stages.pop_back();
+                ri = ready.erase(ri);
+                active++;
+                pool.add([&, i, stage, stages]()
+                {
+                    try
+                    {
+                        PointViewSet out = stage->execute(table, sets[i],
+                            &tableMutex, threads);
+                        if (stages.size())
+                            out = stage->executeBranch(stages, table, out,
+                                &tableMutex);
+                        std::lock_guard<std::mutex> lock(mutex);
+                        sets[i].swap(out);
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        if (!error)
+                            error = std::current_exception();
+                    }
+                    std::lock_guard<std::mutex> lock(mutex);
+                    finished.push_back(i);
+                    cv.notify_one();
+                });
+            }
+        }
+        if (!active)
+            break;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&finished](){ return finished.size(); });
+        int i = finished.front();
+        finished.pop_front();
+        lock.unlock();
+
+        // A stage that fans out has also run the filters on its branches.
+        // The last of them passes the views on.
+        StageInstance& si = instances[i];
+        running.erase(si.m_stage);
+        for (int b : branches[i])
+            running.erase(instances[b].m_stage);
+        active--;
+        remaining -= 1 + branches[i].size();
+        int child = branches[i].size() ?
+            instances[branches[i].back()].m_child : si.m_child;
+
+        // The output views of a stage become input to its child.
+        // If a stage has no child it is the terminal stage.
+        if (child >= 0)
+        {
+            PointViewSet& childViews = sets[child];
+            childViews.insert(sets[i].begin(), sets[i].end());
+            if (--instances[child].m_numInputs == 0)
+                ready.insert(child);
+        }
+        else
+            outViews = sets[i];
+        // Allow previous point views to be freed.
+        sets[i].clear();
+    }
+    pool.join();
+    if (error)
+        std::rethrow_exception(error);
+    return outViews;
+}
+
 
+PointViewSet Stage::execute(PointTableRef table, PointViewSet& views,
+    std::mutex *tableMutex, int threads)
+{
     PointViewSet outViews;
     std::vector<StageRunnerPtr> runners;
+    StageProfile::Timer timer(m_profile);
+    Trace::Span span("stage", getName());
+    uint64_t allocated = table.allocatedBytes();
+
+    // When running concurrently, the table's spatial references and the
+    // ready()/done() calls are protected from other stages.
+    std::unique_lock<std::mutex> lock;
+    if (tableMutex)
+        lock = std::unique_lock<std::mutex>(*tableMutex);
 
     startLogging();
 
@@ -253,19 +544,47 @@ PointViewSet Stage::execute(PointTableRef table, PointViewSet& views)
         if (m)
             m_faceCount += m->size();
     }
+    // Run the views on a pool if there's more than one and the stage
+    // allows it.  The stage can ask how many threads will be used from
+    // ready() on.
+    m_viewThreads = 1;
+    if (threads > 1 && views.size() > 1 && viewsRunConcurrently() &&
+        table.enableConcurrency())
+        m_viewThreads = (int)(std::min)((size_t)threads, views.size());
+
     // Do the ready operation and then start running all the views
     // through the stage.
     ready(table);
     prerun(views);
+    if (lock)
+        lock.unlock();
+
+    // A stage may find in prerun() that it can't run the views
+    // concurrently after all.
+    std::unique_ptr<ThreadPool> pool;
+    if (m_viewThreads > 1 && viewsRunConcurrently())
+    {
+        pool.reset(new ThreadPool(m_viewThreads, views.size(), false));
+        log()->get(LogLevel::Debug) << "Running " << views.size() <<
+            " views with " << m_viewThreads << " threads." << std::endl;
+    }
     for (auto const& it : views)
     {
         StageRunnerPtr runner(new StageRunner(this, it));
         runners.push_back(runner);
-        runner->run();
+        if (pool)
+            runner->run(*pool);
+        else
+            runner->run();
     }
-
-    // As the stages complete (synchronously at this time), propagate the
-    // spatial reference and merge the output views.
+    // Make sure all the runs are finished before anything can throw.
+    if (pool)
+        pool->join();
+
+    // As the stages complete, propagate the spatial reference and merge
+    // the output views.
+    if (tableMutex)
+        lock.lock();
     srs = getSpatialReference();
     for (auto const& it : runners)
     {
@@ -281,8 +600,200 @@ PointViewSet Stage::execute(PointTableRef table, PointViewSet& views)
     }
     done(table);
     stopLogging();
+    m_viewThreads = 1;
+
+    point_count_t outCount = 0;
+    for (auto const& v : outViews)
+        outCount += v->size();
+    m_profile.addPoints(m_pointCount, outCount);
+    uint64_t nowAllocated = table.allocatedBytes();
+    if (nowAllocated > allocated)
+        m_profile.addAllocatedBytes(nowAllocated - allocated);
+    m_profile.setTableBytes(nowAllocated);
     m_pointCount = 0;
     m_faceCount = 0;
+    notifyDone();
+    return outViews;
+}
+
+
+// Run the views produced by this stage through a chain of filters, each
+// view on a thread of its own.  Filters that can't run views concurrently
+// are passed the views one at a time, in order, so the results match
+// running the chain on the views one after the other.
+PointViewSet Stage::executeBranch(const std::vector<Stage *>& stages,
+    PointTableRef table, const PointViewSet& views, std::mutex *tableMutex)
+{
+    std::vector<PointViewPtr> parts(views.begin(), views.end());
+    size_t threads = (std::min)((size_t)branchThreads(), parts.size());
+    if (threads > 1 && !table.enableConcurrency())
+    {
+        log()->get(LogLevel::Warning) << "Point table doesn't support "
+            "concurrent execution.  Running branches with a single "
+            "thread." << std::endl;
+        threads = 1;
+    }
+    log()->get(LogLevel::Debug) << "Running " << parts.size() <<
+        " views through " << stages.size() << " stages with " <<
+        threads << " threads." << std::endl;
+
+    // Get the stages ready as execute() does.  Each sees the spatial
+    // references of the views it will be passed.
+    std::unique_lock<std::mutex> lock;
+    if (tableMutex)
+        lock = std::unique_lock<std::mutex>(*tableMutex);
+    point_count_t count = 0;
+    std::vector<SpatialReference> srsList;
+    for (auto it = parts.rbegin(); it != parts.rend(); ++it)
+    {
+        count += (*it)->size();
+        srsList.push_back((*it)->spatialReference());
+    }
+    for (Stage *stage : stages)
+    {
+        table.clearSpatialReferences();
+        for (const SpatialReference& srs : srsList)
+            table.addSpatialReference(srs);
+        stage->m_pointCount = count;
+        stage->startLogging();
+        stage->ready(table);
+        stage->stopLogging();
+        SpatialReference srs = stage->getSpatialReference();
+        if (!srs.empty())
+            srsList.assign(1, srs);
+    }
+    if (lock)
+        lock.unlock();
+
+    std::vector<std::unique_ptr<BranchTurn>> turns(stages.size());
+    for (size_t s = 0; s < stages.size(); ++s)
+        if (!stages[s]->viewsRunConcurrently())
+            turns[s].reset(new BranchTurn);
+
+    std::vector<PointViewSet> results(parts.size());
+    std::mutex errorMutex;
+    std::exception_ptr error;
+    auto runPart = [&](size_t p)
+    {
+        PointViewSet in { parts[p] };
+        for (size_t s = 0; s < stages.size(); ++s)
+        {
+            Stage *stage = stages[s];
+            BranchTurn *turn = turns[s].get();
+            if (turn)
+            {
+                std::unique_lock<std::mutex> l(turn->m_mutex);
+                turn->m_cv.wait(l, [turn, p](){ return turn->m_next == p; });
+            }
+
+            // Once a run has failed, views only take their turns so that
+            // the other threads can finish.
+            bool failed;
+            {
+                std::lock_guard<std::mutex> l(errorMutex);
+                failed = (bool)error;
+            }
+            if (!failed)
+            {
+                PointViewSet out;
+                point_count_t inCount = 0;
+                point_count_t outCount = 0;
+                {
+                    StageProfile::Timer timer(stage->m_profile, false);
+                    Trace::Span span("stage", stage->getName());
+                    stage->startLogging();
+                    try
+                    {
+                        for (PointViewPtr v : in)
+                        {
+                            inCount += v->size();
+                            PointViewSet temp = stage->run(v);
+                            out.insert(temp.begin(), temp.end());
+                        }
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard<std::mutex> l(errorMutex);
+                        if (!error)
+                            error = std::current_exception();
+                    }
+                    stage->stopLogging();
+                }
+                SpatialReference srs = stage->getSpatialReference();
+                for (PointViewPtr v : out)
+                {
+                    if (!srs.empty())
+                        v->setSpatialReference(srs);
+                    outCount += v->size();
+                }
+                stage->m_profile.addPoints(inCount, outCount);
+                in.swap(out);
+            }
+
+            if (turn)
+            {
+                std::lock_guard<std::mutex> l(turn->m_mutex);
+                turn->m_next++;
+                turn->m_cv.notify_all();
+            }
+        }
+        results[p].swap(in);
+    };
+
+    // The pool runs tasks in the order they're added, so the view whose
+    // turn it is at any stage is always running.
+    if (threads > 1)
+    {
+        ThreadPool pool(threads, parts.size(), false);
+        for (size_t p = 0; p < parts.size(); ++p)
+            pool.add([&runPart, p](){ runPart(p); });
+        pool.join();
+    }
+    else
+        for (size_t p = 0; p < parts.size(); ++p)
+            runPart(p);
+    if (error)
+        std::rethrow_exception(error);
+
+    if (tableMutex)
+        lock.lock();
+    for (Stage *stage : stages)
+    {
+        stage->startLogging();
+        stage->done(table);
+        stage->stopLogging();
+        stage->m_pointCount = 0;
+        stage->notifyDone();
+    }
+    if (lock)
+        lock.unlock();
+
+    // Gather the views in the order of the views that started the
+    // branches.  Views made on the branch threads may have been numbered
+    // out of that order, in which case their points are moved to views
+    // made in order.
+    std::vector<PointViewPtr> ordered;
+    std::set<PointView *> seen;
+    for (PointViewSet& r : results)
+        for (PointViewPtr v : r)
+            if (seen.insert(v.get()).second)
+                ordered.push_back(v);
+    bool inOrder = true;
+    for (size_t i = 1; i < ordered.size(); ++i)
+        if (ordered[i]->id() < ordered[i - 1]->id())
+            inOrder = false;
+
+    PointViewSet outViews;
+    for (PointViewPtr v : ordered)
+    {
+        if (!inOrder)
+        {
+            PointViewPtr nv = v->makeNew();
+            nv->append(*v);
+            v = nv;
+        }
+        outViews.insert(v);
+    }
     return outViews;
 }
 
@@ -34,7 +34,9 @@
 
 #pragma once
 
+#include <functional>
 #include <list>
+#include <mutex>
 
 #include <pdal/pdal_internal.hpp>
 
@@ -47,9 +49,11 @@
 #include <pdal/PluginHelper.hpp>
 #include <pdal/PointTable.hpp>
 #include <pdal/PointRef.hpp>
+#include <pdal/PointSelection.hpp>
 #include <pdal/PointView.hpp>
 #include <pdal/QuickInfo.hpp>
 #include <pdal/SpatialReference.hpp>
+#include <pdal/StageProfile.hpp>
 #include <pdal/util/ProgramArgs.hpp>
 
 namespace pdal
@@ -57,6 +61,7 @@ namespace pdal
 
 class ProgramArgs;
 class StageRunner;
+class StageFactory;
 class StageWrapper;
 class Streamable;
 
@@ -88,6 +93,31 @@ public:
     void setInput(Stage& input)
         { m_inputs.push_back(&input); }
 
+    /**
+      Create an unprepared copy of this stage.  The copy is the same kind
+      of stage with the same options, tag, log, progress descriptor and
+      metadata policy, but it has no inputs and shares no state with this
+      stage, so the two can be prepared and executed on different threads.
+
+      \param factory  Factory that creates and owns the copy.
+      \return  The new stage.
+    */
+    Stage& clone(StageFactory& factory) const;
+
+    /**
+      Compute a hash that identifies the output of the stage.  The hash
+      covers the stage's type and options, the hash of its input and the
+      modification time and size of any local file named by an option
+      value, so it changes when anything that can change the output does.
+
+      \param inputHash  Hash of the stage's input, or empty for a reader.
+      \return  Hash as a string of hex digits, or an empty string if the
+        stage reads standard input or a file named by an option was
+        modified in the last two seconds, since it could be changed again
+        without its modification time changing.
+    */
+    std::string contentHash(const std::string& inputHash) const;
+
     /**
       Set a file descriptor to which progress information should be written.
 
@@ -96,6 +126,33 @@ public:
     void setProgressFd(int fd)
         { m_progressFd = fd; }
 
+    /**
+      Set how much metadata the stage should build.
+
+      \param policy  Metadata policy.
+    */
+    void setMetadataPolicy(MetadataPolicy policy)
+        { m_metadataPolicy = policy; }
+
+    /**
+      Get the metadata policy of the stage.
+
+      \return  The stage's metadata policy.
+    */
+    MetadataPolicy metadataPolicy() const
+        { return m_metadataPolicy; }
+
+    /**
+      Set a function to be called each time the stage finishes a run,
+      after done() is called and the stage's profile is updated.  The
+      function may be called from a thread other than the one that
+      started execution.
+
+      \param cb  Function to call with the finished stage.
+    */
+    void setDoneCallback(std::function<void(Stage&)> cb)
+        { m_doneCallback = cb; }
+
     /**
       Retrieve some basic point information without reading all data when
       possible.  Usually implemented only by Readers.
@@ -116,12 +173,25 @@ public:
 
       This performs the action associated with the stage by executing the
       \ref run function of each stage in depth first order.  Each stage is run
-      to completion (all points are processed) before the next stages is run.o
+      to completion (all points are processed) before the next stages is run.
+
+      When \ref threads is greater than one, stages whose inputs have all
+      completed are run concurrently on a pool of worker threads, so that
+      independent branches of a pipeline (several readers feeding a merge,
+      for instance) are executed at the same time.  A stage is never run
+      concurrently with itself.  The table's spatial references are set
+      for the \ref ready and \ref done calls of each stage the same way as
+      in serial execution, but stages that inspect the table's spatial
+      references while running points should be run with a single thread.
+      Stages that allow it also run the point views they're passed
+      concurrently (see \ref viewsRunConcurrently).  If the table doesn't
+      support concurrent access, the pipeline is run serially.
 
       \param table  Point table being used for stage pipeline.  This must be
         the same \ref table used in the \ref prepare function.
+      \param threads  Maximum number of stages to run at once.
     */
-    PointViewSet execute(PointTableRef table);
+    PointViewSet execute(PointTableRef table, int threads = 1);
 
     virtual void execute(StreamPointTable& table)
     {
@@ -129,6 +199,16 @@ public:
             "stage.");
     }
 
+    /**
+      Execute a prepared pipeline in stream mode using up to \ref threads
+      threads.  See Streamable::execute(StreamPointTable&, int).
+
+      \param table  Streaming point table used for stage pipeline.
+      \param threads  Maximum number of threads to use.
+    */
+    virtual void execute(StreamPointTable& table, int /*threads*/)
+        { execute(table); }
+
     /**
       Determine if a pipeline with this stage as a sink is streamable.
 
@@ -137,6 +217,18 @@ public:
     virtual bool pipelineStreamable() const
     { return false; }
 
+    /**
+      Determine whether one prepared instance of the stage may process
+      points on several threads at once, both in \ref run and in stream
+      mode.  Override to return true in stages that keep no state while
+      processing points.  Stages that do (readers' files, writers' output,
+      accumulated results) should be replicated with \ref clone instead.
+
+      \return  Whether the stage is thread-safe.
+    */
+    virtual bool threadSafe() const
+        { return false; }
+
     /**
       Return a pointer to a pipeline's first non-streamable stage,
       if one exists.
@@ -147,6 +239,101 @@ public:
     virtual const Stage *findNonstreamable() const
     { return this; }
 
+    /**
+      Get the number of threads on which the point views this stage
+      produces are run through the filters that follow it.  Each view is
+      passed through that chain of filters on its own thread, without
+      waiting for the other views, until a stage that joins the branches
+      (see \ref joinsBranches), a stage with several inputs or a stage that
+      isn't a filter is reached.  The views that come out of the branches
+      are ordered as if the chain had been run one view at a time.
+
+      \return  Number of branch threads, or 0 (the default) if the stage's
+        views are run by each following stage in turn.
+    */
+    virtual int branchThreads() const
+    { return 0; }
+
+    /**
+      Determine whether the stage gathers the views of the parallel branches
+      started by a stage before it (see \ref branchThreads).
+
+      \return  Whether the stage ends parallel branches.
+    */
+    virtual bool joinsBranches() const
+    { return false; }
+
+    /**
+      Get the dimensions whose values the stage reads or must keep.  When
+      every stage in a pipeline can tell which dimensions it uses, the
+      other dimensions are removed from the layout once the pipeline is
+      prepared, so they aren't stored or decoded.  Stages that support this
+      must handle dimensions that they registered being removed.
+
+      \param layout  Layout of the prepared pipeline.
+      \param[out] dims  Dimensions used by the stage are appended.
+      \return  Whether the stage can tell which dimensions it uses.  If
+        false (the default), the stage may use any dimension.
+    */
+    virtual bool dimensionsUsed(PointLayoutPtr /*layout*/,
+        Dimension::IdList& /*dims*/) const
+    { return false; }
+
+    /**
+      Limit a bounds box to the region outside of which the stage drops
+      every point.  Once the pipeline is prepared, the bounds of the stages
+      downstream of a reader are handed to the reader, which may skip
+      points outside of them rather than decoding them.  Stages that support
+      this must decide whether to keep a point by looking at that point
+      alone and must not change point positions.
+
+      \param[in,out] bounds  Bounds to limit.  Stages that keep points
+        anywhere leave the bounds unchanged.
+      \return  Whether bounds may be pushed through the stage to the
+        stages before it.  If false (the default), bounds from this stage
+        and the stages after it aren't passed upstream.
+    */
+    virtual bool pushdownBounds(BOX3D& /*bounds*/) const
+    { return false; }
+
+    /**
+      Limit the number of points a reader needs to provide.  Like bounds,
+      counts are handed from the stages downstream of a reader to the
+      reader once the pipeline is prepared.  Stages that support this must
+      keep only points from the start of their input, in order.
+
+      \param[in,out] count  Number of points to limit.  Stages that may
+        keep any point leave the count unchanged.
+      \return  Whether a count may be pushed through the stage to the
+        stages before it.  If false (the default), counts from this stage
+        and the stages after it aren't passed upstream.
+    */
+    virtual bool pushdownCount(point_count_t& /*count*/) const
+    { return false; }
+
+    /**
+      Narrow the selection of points that a reader needs to provide.
+      Selections are handed from the stages downstream of a reader to the
+      reader once the pipeline is prepared, after bounds and counts.
+      Stages that support this must keep points by their position in
+      their input alone.
+
+      \param[in,out] selection  Selection to narrow.
+      \return  Whether a selection may be pushed through the stage to the
+        stages before it.  If false (the default), selections from this
+        stage and the stages after it aren't passed upstream.
+    */
+    virtual bool pushdownSelection(PointSelection& /*selection*/) const
+    { return false; }
+
+    /**
+      Called when the reader before the stage has taken the selection made
+      by pushdownSelection().  The points the stage is then given are
+      exactly those it would have kept, in order.
+    */
+    virtual void selectionPushedDown()
+    {}
+
     /**
       Set the spatial reference of a stage.
 
@@ -256,6 +443,15 @@ public:
     bool isDebug() const
         { return m_log && m_log->getLevel() > LogLevel::Debug; }
 
+    /**
+      Return the execution statistics of the stage.  The statistics are
+      cleared when the stage is prepared.
+
+      \return  The stage's profile.
+    */
+    const StageProfile& profile() const
+        { return m_profile; }
+
     /**
       Return the name of a stage.
 
@@ -293,6 +489,23 @@ public:
     MetadataNode getMetadata() const
         { return m_metadata; }
 
+    /**
+      Combine the metadata of two runs of this stage on different parts of
+      the same data, as when 'pdal pipeline --batch' runs a pipeline on
+      each tile of a dataset.  Stages whose metadata summarizes their
+      points, such as statistics, override this so that the result
+      describes all the points.
+
+      \param merged  Metadata combined from the parts gathered so far.
+      \param part  Metadata of another part.
+      \return  Metadata describing both, or an empty node if the stage's
+        metadata can't be combined.  The metadata of each part is then
+        kept separately.
+    */
+    virtual MetadataNode mergeMetadata(const MetadataNode& /*merged*/,
+            const MetadataNode& /*part*/) const
+        { return MetadataNode(); }
+
     /**
       Serialize a stage by inserting apporpritate data into the provided
       MetadataNode.  Used to dump a pipeline specification in a portable
@@ -328,6 +541,7 @@ protected:
     Options m_options;          ///< Stage's options.
     MetadataNode m_metadata;    ///< Stage's metadata.
     int m_progressFd;           ///< Descriptor for progress info.
+    MetadataPolicy m_metadataPolicy; ///< How much metadata to build.
 
     virtual void setSpatialReference(MetadataNode& m, SpatialReference const&);
     void throwError(const std::string& s) const;
@@ -347,6 +561,32 @@ protected:
     */
     point_count_t faceCount() const
         { return m_faceCount; }
+    /**
+      Add to the number of bytes the stage has read or written, which
+      is reported in the stage's profile.
+
+      \param bytes  Number of bytes read or written.
+    */
+    void countIoBytes(uint64_t bytes)
+        { m_profile.addIoBytes(bytes); }
+    /**
+      Return the number of threads on which the point views passed to
+      \ref prerun will be run.  Only valid from \ref ready until \ref done.
+
+      \return  Number of threads, or 1 if the views are run one at a time.
+    */
+    int viewThreads() const
+        { return m_viewThreads; }
+    /**
+      Prepare a copy of this stage made with \ref clone to process points
+      in place of this stage, which must already be prepared.  The copy is
+      initialized with the table as this stage was, but its metadata is kept
+      out of the table's so that it can be merged into this stage's.
+
+      \param copy  Unprepared copy of this stage.
+      \param table  Table with which this stage was prepared.
+    */
+    void prepareCopy(Stage& copy, PointTableRef table) const;
 
 private:
     uint32_t m_verbose;
@@ -363,15 +603,23 @@ private:
     std::string m_userDataJSON;
     point_count_t m_pointCount;
     point_count_t m_faceCount;
+    int m_viewThreads;
+    StageProfile m_profile;
     // This is never used, but we want something to bind to the argument
     // we stick in ProgramArgs so that it shows up in help and an options list.
     std::string m_optionFile;
+    std::function<void(Stage&)> m_doneCallback;
 
     Stage& operator=(const Stage&); // not implemented
     Stage(const Stage&); // not implemented
 
     void setupLog();
     void handleOptions();
+    void notifyDone()
+    {
+        if (m_doneCallback)
+            m_doneCallback(*this);
+    }
 
     void l_addArgs(ProgramArgs& args);
     virtual void readerAddArgs(ProgramArgs& /*args*/)
@@ -438,9 +686,19 @@ private:
 
       \param table  PointTable
       \param pvSet  Input PointViewSet
+      \param tableMutex  If not null, held while the table's spatial
+        references are set and while \ref ready and \ref done are called.
+      \param threads  Maximum number of views to run at once if the stage
+        supports running views concurrently.
       \return  Output PointViewSet
     */
-    PointViewSet execute(PointTableRef table, PointViewSet& pvSet);
+    PointViewSet execute(PointTableRef table, PointViewSet& pvSet,
+        std::mutex *tableMutex = nullptr, int threads = 1);
+    PointViewSet executeSerial(PointTableRef table);
+    PointViewSet executeConcurrent(PointTableRef table, int threads);
+    PointViewSet executeBranch(const std::vector<Stage *>& stages,
+        PointTableRef table, const PointViewSet& views,
+        std::mutex *tableMutex);
 
     /**
       Functions called after dimensions have been added.  Implement in
@@ -469,6 +727,17 @@ private:
     virtual void prerun(const PointViewSet& /*pvSet*/)
         {}
 
+    /**
+      Determine whether \ref run may be called for several point views at
+      once from different threads.  Override to return true in stages whose
+      \ref run doesn't modify stage state and only modifies the points
+      in the view it's passed.  Thread-safe stages allow it by default.
+
+      \return  Whether views may be run concurrently.
+    */
+    virtual bool viewsRunConcurrently() const
+        { return threadSafe(); }
+
     /**
       Process all points in a view.  Implement in subclass.
 
@@ -66,6 +66,8 @@ const std::string extension_json (
 R"PDALEXTENSIONS(
 
 {
+    "readers.arrow" : "arrow, feather, parquet",
+    "writers.arrow" : "arrow, feather, parquet",
     "readers.greyhound" : "greyhound",
     "readers.icebridge" : "icebridge h5",
     "readers.matlab" : "mat",
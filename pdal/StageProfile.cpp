@@ -0,0 +1,99 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include <pdal/StageProfile.hpp>
+
+namespace pdal
+{
+
+void StageProfile::reset()
+{
+    m_wallNs = 0;
+    m_cpuNs = 0;
+    m_pointsIn = 0;
+    m_pointsOut = 0;
+    m_allocatedBytes = 0;
+    m_tableBytes = 0;
+    m_ioBytes = 0;
+}
+
+
+MetadataNode StageProfile::toMetadata(const std::string& name) const
+{
+    MetadataNode m(name);
+
+    m.add("wall_time", wallTime(), "Wall time running the stage (seconds)");
+    m.add("cpu_time", cpuTime(), "CPU time running the stage (seconds)");
+    m.add("points_in", pointsIn(), "Number of points passed to the stage");
+    m.add("points_out", pointsOut(), "Number of points passed on by the "
+        "stage");
+    m.add("allocated_bytes", allocatedBytes(), "Bytes of point storage "
+        "allocated while the stage ran");
+    m.add("table_bytes", tableBytes(), "Bytes of point storage held by the "
+        "point table when the stage finished");
+    m.add("io_bytes", ioBytes(), "Bytes read or written by the stage");
+    return m;
+}
+
+
+std::chrono::nanoseconds StageProfile::threadCpuTime()
+{
+#ifdef _WIN32
+    FILETIME create, exit, kernel, user;
+    if (GetThreadTimes(GetCurrentThread(), &create, &exit, &kernel, &user))
+    {
+        // FILETIME is in units of 100 nanoseconds.
+        ULARGE_INTEGER k, u;
+        k.LowPart = kernel.dwLowDateTime;
+        k.HighPart = kernel.dwHighDateTime;
+        u.LowPart = user.dwLowDateTime;
+        u.HighPart = user.dwHighDateTime;
+        return std::chrono::nanoseconds((k.QuadPart + u.QuadPart) * 100);
+    }
+#else
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0)
+        return std::chrono::seconds(ts.tv_sec) +
+            std::chrono::nanoseconds(ts.tv_nsec);
+#endif
+    return std::chrono::nanoseconds(0);
+}
+
+} // namespace pdal
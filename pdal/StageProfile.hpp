@@ -0,0 +1,243 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include <pdal/pdal_internal.hpp>
+#include <pdal/Metadata.hpp>
+
+namespace pdal
+{
+
+/**
+  Execution statistics of a stage.  Counters are updated once for each point
+  view or buffer of streamed points that a stage processes rather than for
+  each point, so collecting them is cheap enough to always be on.  Counters
+  may be updated from more than one thread at a time.
+*/
+class PDAL_DLL StageProfile
+{
+public:
+    StageProfile()
+        { reset(); }
+
+    /**
+      Measures the wall and CPU time spent in a scope and adds it to
+      a profile when the scope is left.
+    */
+    class Timer
+    {
+    public:
+        /**
+          Start timing.
+
+          \param profile  Profile to which the elapsed time is added.
+          \param wall  Whether to add the wall time.  Work done on pool
+            threads only adds its CPU time, since the wall time is
+            measured by the thread that waits for it.
+        */
+        Timer(StageProfile& profile, bool wall = true) :
+            m_profile(profile), m_wall(wall),
+            m_start(std::chrono::steady_clock::now()),
+            m_cpuStart(threadCpuTime())
+        {}
+
+        ~Timer()
+        {
+            std::chrono::nanoseconds cpu = threadCpuTime() - m_cpuStart;
+            std::chrono::nanoseconds wall(0);
+            if (m_wall)
+                wall = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - m_start);
+            m_profile.addTime(wall, cpu);
+        }
+
+    private:
+        StageProfile& m_profile;
+        bool m_wall;
+        std::chrono::steady_clock::time_point m_start;
+        std::chrono::nanoseconds m_cpuStart;
+    };
+
+    /**
+      Clear all counters.
+    */
+    void reset();
+
+    /**
+      Add to the elapsed wall and CPU time.
+
+      \param wall  Wall time to add.
+      \param cpu  CPU time to add.
+    */
+    void addTime(std::chrono::nanoseconds wall, std::chrono::nanoseconds cpu)
+    {
+        m_wallNs.fetch_add(wall.count(), std::memory_order_relaxed);
+        m_cpuNs.fetch_add(cpu.count(), std::memory_order_relaxed);
+    }
+
+    /**
+      Add to the number of points passed to and produced by the stage.
+
+      \param in  Number of points passed to the stage.
+      \param out  Number of points the stage passed on.
+    */
+    void addPoints(point_count_t in, point_count_t out)
+    {
+        m_pointsIn.fetch_add(in, std::memory_order_relaxed);
+        m_pointsOut.fetch_add(out, std::memory_order_relaxed);
+    }
+
+    /**
+      Add to the number of bytes of point storage allocated while the
+      stage ran.
+
+      \param bytes  Number of bytes allocated.
+    */
+    void addAllocatedBytes(uint64_t bytes)
+        { m_allocatedBytes.fetch_add(bytes, std::memory_order_relaxed); }
+
+    /**
+      Record the bytes of point storage held by the table when the stage
+      finished.  The largest value recorded is kept.
+
+      \param bytes  Number of bytes held by the table.
+    */
+    void setTableBytes(uint64_t bytes)
+    {
+        uint64_t cur = m_tableBytes.load(std::memory_order_relaxed);
+        while (bytes > cur && !m_tableBytes.compare_exchange_weak(cur, bytes,
+                std::memory_order_relaxed))
+            ;
+    }
+
+    /**
+      Add to the number of bytes read or written by the stage.
+
+      \param bytes  Number of bytes read or written.
+    */
+    void addIoBytes(uint64_t bytes)
+        { m_ioBytes.fetch_add(bytes, std::memory_order_relaxed); }
+
+    /**
+      Get the wall time spent running the stage.
+
+      \return  Wall time in seconds.
+    */
+    double wallTime() const
+        { return m_wallNs.load(std::memory_order_relaxed) / 1e9; }
+
+    /**
+      Get the CPU time used running the stage, summed over all threads.
+
+      \return  CPU time in seconds.
+    */
+    double cpuTime() const
+        { return m_cpuNs.load(std::memory_order_relaxed) / 1e9; }
+
+    /**
+      Get the number of points passed to the stage.  Zero for readers.
+
+      \return  Number of points.
+    */
+    point_count_t pointsIn() const
+        { return m_pointsIn.load(std::memory_order_relaxed); }
+
+    /**
+      Get the number of points the stage passed on.
+
+      \return  Number of points.
+    */
+    point_count_t pointsOut() const
+        { return m_pointsOut.load(std::memory_order_relaxed); }
+
+    /**
+      Get the number of bytes of point table storage allocated while the
+      stage ran in standard mode.  When stages run concurrently, storage
+      allocated by a stage running at the same time may be included.
+
+      \return  Number of bytes.
+    */
+    uint64_t allocatedBytes() const
+        { return m_allocatedBytes.load(std::memory_order_relaxed); }
+
+    /**
+      Get the largest number of bytes of point storage held by the table
+      when the stage finished running in standard mode.  This is the
+      memory the pipeline needed up to and including the stage.
+
+      \return  Number of bytes.
+    */
+    uint64_t tableBytes() const
+        { return m_tableBytes.load(std::memory_order_relaxed); }
+
+    /**
+      Get the number of bytes read or written by the stage.  Only counted
+      by stages that report it.
+
+      \return  Number of bytes.
+    */
+    uint64_t ioBytes() const
+        { return m_ioBytes.load(std::memory_order_relaxed); }
+
+    /**
+      Get the counters as a metadata node.
+
+      \param name  Name of the node.
+      \return  Metadata node.
+    */
+    MetadataNode toMetadata(const std::string& name = "profile") const;
+
+    /**
+      Get the CPU time used so far by the calling thread.
+
+      \return  CPU time, or zero if it isn't available on this platform.
+    */
+    static std::chrono::nanoseconds threadCpuTime();
+
+private:
+    std::atomic<uint64_t> m_wallNs;
+    std::atomic<uint64_t> m_cpuNs;
+    std::atomic<uint64_t> m_pointsIn;
+    std::atomic<uint64_t> m_pointsOut;
+    std::atomic<uint64_t> m_allocatedBytes;
+    std::atomic<uint64_t> m_tableBytes;
+    std::atomic<uint64_t> m_ioBytes;
+};
+
+} // namespace pdal
@@ -32,20 +32,433 @@
 * OF SUCH DAMAGE.
 ****************************************************************************/
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <iterator>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
 
 #include <pdal/Streamable.hpp>
 #include <pdal/Reader.hpp>
+#include <pdal/util/Trace.hpp>
 
 namespace pdal
 {
 
-Streamable::Streamable()
+namespace
+{
+
+// Buffer for a set of points passed between threads in pipelined stream
+// execution.  Shares the layout of the pipeline's table.
+class StreamBuffer : public StreamPointTable
+{
+public:
+    StreamBuffer(PointLayout& layout, point_count_t capacity) :
+        StreamPointTable(layout, capacity), m_count(0), m_last(false),
+        m_path(0)
+    {
+        m_buf.resize(pointsToBytes(capacity + 1));
+    }
+
+    // Number of points (including skipped points) in the buffer.
+    point_count_t m_count;
+    // Whether this is the last buffer that the reader will fill.
+    bool m_last;
+    // Index of the path whose reader filled the buffer.
+    size_t m_path;
+    // Spatial reference of the points in the buffer.
+    SpatialReference m_srs;
+
+protected:
+    virtual void reset()
+        { std::fill(m_buf.begin(), m_buf.end(), 0); }
+
+    virtual char *getPoint(PointId idx)
+        { return m_buf.data() + pointsToBytes(idx); }
+
+private:
+    std::vector<char> m_buf;
+};
+
+
+// Queue of buffers waiting to be processed by a group of stages.
+class BufferQueue
+{
+public:
+    BufferQueue() : m_stopped(false)
+    {}
+
+    void push(StreamBuffer *b)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_buffers.push_back(b);
+        m_cv.notify_one();
+    }
+
+    // Returns nullptr if the queue has been stopped.
+    StreamBuffer *pop()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this](){ return m_stopped || m_buffers.size(); });
+        if (m_stopped)
+            return nullptr;
+        StreamBuffer *b = m_buffers.front();
+        m_buffers.pop_front();
+        return b;
+    }
+
+    void stop()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopped = true;
+        m_cv.notify_all();
+    }
+
+private:
+    std::deque<StreamBuffer *> m_buffers;
+    bool m_stopped;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+};
+
+// Table for the points buffered for a stage that doesn't support streaming.
+// Shares the layout of the streaming table.
+class BufferTable : public SimplePointTable
+{
+public:
+    BufferTable(PointLayout& layout) : SimplePointTable(layout), m_numPts(0)
+    {}
+
+    virtual bool supportsView() const
+        { return true; }
+
+protected:
+    virtual char *getPoint(PointId idx)
+    {
+        return m_blocks[idx / BlockPtCnt].data() +
+            pointsToBytes(idx % BlockPtCnt);
+    }
+
+private:
+    virtual PointId addPoint()
+    {
+        if (m_numPts % BlockPtCnt == 0)
+            m_blocks.emplace_back(pointsToBytes(BlockPtCnt));
+        return m_numPts++;
+    }
+
+    static const point_count_t BlockPtCnt = 65536;
+
+    std::vector<std::vector<char>> m_blocks;
+    point_count_t m_numPts;
+};
+
+} // unnamed namespace
+
+
+// List of stages that make up a path from a source to the terminal stage.
+class Streamable::StageList : public std::list<Streamable *>
+{
+public:
+    StageList operator - (const StageList& other) const
+    {
+        StageList resultList;
+        auto ti = rbegin();
+        auto oi = other.rbegin();
+
+        while (oi != other.rend() && ti != rend() && *ti == *oi)
+        {
+            oi++;
+            ti++;
+        }
+        while (ti != rend())
+            resultList.push_front(*ti++);
+        return resultList;
+    };
+
+    void ready(PointTableRef& table)
+    {
+        for (auto s : *this)
+        {
+            StageProfile::Timer timer(s->m_profile);
+            s->startLogging();
+            s->ready(table);
+            s->stopLogging();
+            SpatialReference srs = s->getSpatialReference();
+            if (!srs.empty())
+                table.setSpatialReference(srs);
+        }
+    }
+
+    void done(PointTableRef& table)
+    {
+        for (auto s : *this)
+        {
+            StageProfile::Timer timer(s->m_profile);
+            s->startLogging();
+            s->done(table);
+            s->stopLogging();
+            s->notifyDone();
+        }
+    }
+};
+
+
+// Streams the points produced by the paths ending at a stage into point
+// views, a chunk at a time.
+class Streamable::StreamRunner
+{
+public:
+    StreamRunner(Stage *terminal, PointTableRef table,
+        point_count_t capacity, point_count_t chunkSize);
+
+    // Append as many as 'count' points to a new view.  The view has fewer
+    // than 'count' points only if the input is exhausted.
+    PointViewPtr append(BasePointTable& bufTable, point_count_t count);
+
+private:
+    bool step();
+
+    Streamable *m_terminal;
+    std::vector<std::unique_ptr<Streamable>> m_sources;
+    std::vector<StageList> m_paths;
+    size_t m_pathIdx;
+    StageList m_lastRun;
+    PointTableRef m_table;
+    StreamBuffer m_buf;
+    PointId m_bufPos;
+    point_count_t m_count;
+    bool m_finished;
+    SrsMap m_srsMap;
+    DimTypeList m_dims;
+    std::vector<char> m_data;
+};
+
+
+// Source stage that runs a stage that doesn't support streaming on the
+// points buffered from its inputs and streams the resulting points.
+class Streamable::HybridSource : public Streamable
+{
+public:
+    HybridSource(Stage *stage, point_count_t chunkSize);
+
+    std::string getName() const
+        { return m_stage->getName(); }
+
+private:
+    virtual void ready(PointTableRef table);
+    virtual bool processOne(PointRef& point);
+    virtual void done(PointTableRef table);
+
+    bool fill();
+
+    Stage *m_stage;
+    point_count_t m_chunkSize;
+    PointLayoutPtr m_layout;
+    DimTypeList m_dims;
+    std::vector<char> m_data;
+    std::vector<std::unique_ptr<StreamRunner>> m_runners;
+    size_t m_runnerIdx;
+    bool m_sourceRun;
+    std::unique_ptr<BufferTable> m_bufTable;
+    std::deque<PointViewPtr> m_views;
+    PointViewPtr m_view;
+    PointId m_viewPos;
+};
+
+
+Streamable::StreamRunner::StreamRunner(Stage *terminal, PointTableRef table,
+        point_count_t capacity, point_count_t chunkSize) :
+    m_terminal(dynamic_cast<Streamable *>(terminal)), m_pathIdx(0),
+    m_table(table), m_buf(*table.layout(), capacity), m_bufPos(0),
+    m_count(0), m_finished(true), m_dims(table.layout()->dimTypes())
+{
+    if (!m_terminal || !m_terminal->canStream())
+    {
+        m_sources.emplace_back(new HybridSource(terminal, chunkSize));
+        m_terminal = m_sources.back().get();
+    }
+    m_paths = m_terminal->paths(m_sources, chunkSize);
+    m_data.resize(table.layout()->pointSize());
+}
+
+
+// Fill the buffer with the next set of points.  Returns false when all the
+// paths have been run.
+bool Streamable::StreamRunner::step()
+{
+    if (m_finished)
+    {
+        if (m_pathIdx == m_paths.size())
+        {
+            if (m_lastRun.size())
+                m_lastRun.done(m_table);
+            m_lastRun.clear();
+            return false;
+        }
+        StageList& stages = m_paths[m_pathIdx++];
+        (m_lastRun - stages).done(m_table);
+        (stages - m_lastRun).ready(m_table);
+        m_lastRun = stages;
+
+        m_count = (std::numeric_limits<point_count_t>::max)();
+        if (Reader *r = dynamic_cast<Reader *>(stages.front()))
+            m_count = r->count();
+        m_finished = false;
+    }
+
+    std::list<Streamable *> filters(std::next(m_lastRun.begin()),
+        m_lastRun.end());
+    m_buf.clear(m_buf.m_count);
+    m_buf.m_count = m_terminal->executeChunk(m_buf, m_lastRun.front(),
+        filters, m_count, m_srsMap, m_finished);
+    m_bufPos = 0;
+    return true;
+}
+
+
+PointViewPtr Streamable::StreamRunner::append(BasePointTable& bufTable,
+    point_count_t count)
+{
+    PointViewPtr view;
+
+    while (!view || view->size() < count)
+    {
+        if (m_bufPos == m_buf.m_count && !step())
+            break;
+        if (!view)
+            view.reset(new PointView(bufTable, m_buf.anySpatialReference()));
+
+        PointRef point(m_buf, 0);
+        for (; m_bufPos < m_buf.m_count && view->size() < count; ++m_bufPos)
+        {
+            if (m_buf.skip(m_bufPos))
+                continue;
+            point.setPointId(m_bufPos);
+            point.getPackedData(m_dims, m_data.data());
+            view->setPackedPoint(m_dims, view->size(), m_data.data());
+        }
+    }
+    return view;
+}
+
+
+Streamable::HybridSource::HybridSource(Stage *stage,
+        point_count_t chunkSize) :
+    m_stage(stage), m_chunkSize(chunkSize), m_runnerIdx(0),
+    m_sourceRun(false), m_viewPos(0)
+{
+    m_log = stage->m_log;
+    m_logLeader = stage->m_logLeader;
+}
+
+
+void Streamable::HybridSource::ready(PointTableRef table)
+{
+    m_log->get(LogLevel::Debug) << "Buffering points for stage that doesn't "
+        "support streaming." << std::endl;
+
+    point_count_t capacity = 10000;
+    if (StreamPointTable *t = dynamic_cast<StreamPointTable *>(&table))
+        capacity = t->capacity();
+
+    m_layout = table.layout();
+    m_dims = m_layout->dimTypes();
+    m_data.resize(m_layout->pointSize());
+    m_runners.clear();
+    for (Stage *s : m_stage->m_inputs)
+        m_runners.emplace_back(new StreamRunner(s, table, capacity,
+            m_chunkSize));
+    m_runnerIdx = 0;
+    m_sourceRun = false;
+}
+
+
+// Buffer the next chunk of points from the inputs and run the stage on them.
+// Returns false when there are no more points.
+bool Streamable::HybridSource::fill()
+{
+    // Release the points of the last chunk before buffering more.
+    m_views.clear();
+    m_view.reset();
+    m_bufTable.reset(new BufferTable(*m_layout));
+
+    PointViewSet views;
+    if (m_stage->m_inputs.empty())
+    {
+        // A source stage is just run once, like in standard mode.
+        if (m_sourceRun)
+            return false;
+        views.insert(PointViewPtr(new PointView(*m_bufTable)));
+        m_sourceRun = true;
+    }
+    else
+    {
+        point_count_t remaining = m_chunkSize ? m_chunkSize :
+            (std::numeric_limits<point_count_t>::max)();
+        while (remaining && m_runnerIdx < m_runners.size())
+        {
+            PointViewPtr v =
+                m_runners[m_runnerIdx]->append(*m_bufTable, remaining);
+            point_count_t n = v ? v->size() : 0;
+            // Fewer points than requested means the input is exhausted.
+            if (n < remaining)
+                m_runnerIdx++;
+            if (n)
+                views.insert(v);
+            remaining -= n;
+        }
+        if (views.empty())
+            return false;
+    }
+
+    PointViewSet outViews = m_stage->execute(*m_bufTable, views);
+    m_views.assign(outViews.begin(), outViews.end());
+    return true;
+}
+
+
+bool Streamable::HybridSource::processOne(PointRef& point)
+{
+    while (!m_view || m_viewPos == m_view->size())
+    {
+        if (m_views.empty() && !fill())
+            return false;
+        if (m_views.empty())
+            continue;
+        m_view = m_views.front();
+        m_views.pop_front();
+        m_viewPos = 0;
+        if (m_view->spatialReference() != getSpatialReference())
+            setSpatialReference(m_view->spatialReference());
+    }
+    m_view->getPackedPoint(m_dims, m_viewPos++, m_data.data());
+    point.setPackedData(m_dims, m_data.data());
+    return true;
+}
+
+
+void Streamable::HybridSource::done(PointTableRef table)
+{
+    m_views.clear();
+    m_view.reset();
+    m_bufTable.reset();
+    m_runners.clear();
+}
+
+
+Streamable::Streamable() : m_hybridChunkSize(0), m_streamOrdered(true)
 {}
 
 
 bool Streamable::pipelineStreamable() const
 {
+    if (!canStream())
+        return false;
     for (const Stage *s : m_inputs)
         if (!s->pipelineStreamable())
             return false;
@@ -57,6 +470,8 @@ const Stage *Streamable::findNonstreamable() const
 {
     const Stage *nonstreamable;
 
+    if (!canStream())
+        return this;
     for (const Stage *s : m_inputs)
     {
         nonstreamable = s->findNonstreamable();
@@ -69,69 +484,63 @@ const Stage *Streamable::findNonstreamable() const
 
 // Streamed execution.
 void Streamable::execute(StreamPointTable& table)
+{
+    execute(table, 1);
+}
+
+
+void Streamable::execute(StreamPointTable& table, int threads)
 {
     m_log->get(LogLevel::Debug) << "Executing pipeline in stream mode." <<
         std::endl;
-    struct StreamableList : public std::list<Streamable *>
-    {
-        StreamableList operator - (const StreamableList& other) const
-        {
-            StreamableList resultList;
-            auto ti = rbegin();
-            auto oi = other.rbegin();
 
-            while (oi != other.rend() && ti != rend() && *ti == *oi)
-            {
-                oi++;
-                ti++;
-            }
-            while (ti != rend())
-                resultList.push_front(*ti++);
-            return resultList;
-        };
+    if (!canStream())
+        throwError("Attempting to use stream mode with options that "
+            "don't support streaming.");
+    table.finalize();
 
-        void ready(PointTableRef& table)
-        {
-            for (auto s : *this)
-            {
-                s->startLogging();
-                s->ready(table);
-                s->stopLogging();
-                SpatialReference srs = s->getSpatialReference();
-                if (!srs.empty())
-                    table.setSpatialReference(srs);
-            }
-        }
+    // Stages that don't support streaming are replaced by sources that
+    // run them on buffered points.
+    std::vector<std::unique_ptr<Streamable>> sources;
+    std::vector<StageList> pathList = paths(sources, m_hybridChunkSize);
 
-        void done(PointTableRef& table)
-        {
-            for (auto s : *this)
-            {
-                s->startLogging();
-                s->done(table);
-                s->stopLogging();
-            }
-        }
-    };
+    SrsMap srsMap;
+    if (threads > 1 && pathList.size() > 1 && sources.empty() &&
+            executeConcurrent(table, pathList, threads))
+        return;
 
-    const Stage *nonstreaming = findNonstreamable();
-    if (nonstreaming)
-        nonstreaming->throwError("Attempting to use stream mode with a "
-            "stage that doesn't support streaming.");
+    StageList lastRunStages;
+    for (StageList& stages : pathList)
+    {
+        // Call done on all the stages we ran last time and aren't
+        // using this time.
+        (lastRunStages - stages).done(table);
+        // Call ready on all the stages we didn't run last time.
+        (stages - lastRunStages).ready(table);
+        if (threads > 1 && stages.size() > 1)
+            executePipelined(table, stages, srsMap, threads);
+        else
+            execute(table, stages, srsMap);
+        lastRunStages = stages;
+    }
+    lastRunStages.done(table);
+}
 
-    SpatialReference srs;
-    std::list<StreamableList> lists;
-    StreamableList stages;
-    StreamableList lastRunStages;
 
-    table.finalize();
+std::vector<Streamable::StageList> Streamable::paths(
+    std::vector<std::unique_ptr<Streamable>>& sources,
+    point_count_t chunkSize)
+{
+    std::vector<StageList> pathList;
+    std::list<StageList> lists;
+    StageList stages;
 
     // Walk from the current stage backwards.  As we add each input, copy
     // the list of stages and push it on a list.  We then pull a list from the
     // back of list and keep going.  Pushing on the front and pulling from the
     // back insures that the stages will be executed in the order that they
-    // were added.  If we hit stage with no previous stages, we execute
-    // the stage list.
+    // were added.  If we hit stage with no previous stages, we've found
+    // a path to execute.
     // All this often amounts to a bunch of list copying for
     // no reason, but it's more simple than what we might otherwise do and
     // this should be a nit in the grand scheme of execution time.
@@ -139,39 +548,80 @@ void Streamable::execute(StreamPointTable& table)
     // As an example, if there are four paths from the end stage (writer) to
     // reader stages, there will be four stage lists and execute(table, stages)
     // will be called four times.
-    SrsMap srsMap;
+    //
+    // A stage that doesn't support streaming is replaced by a source stage
+    // that runs it (and its inputs) separately, so the walk stops there.
     Streamable *s = this;
     stages.push_front(s);
     while (true)
     {
         if (s->m_inputs.empty())
-        {
-            // Call done on all the stages we ran last time and aren't
-            // using this time.
-            (lastRunStages - stages).done(table);
-            // Call ready on all the stages we didn't run last time.
-            (stages - lastRunStages).ready(table);
-            execute(table, stages, srsMap);
-            lastRunStages = stages;
-        }
+            pathList.push_back(stages);
         else
         {
             for (auto bi = s->m_inputs.rbegin(); bi != s->m_inputs.rend(); bi++)
             {
-                StreamableList newStages(stages);
-                newStages.push_front(dynamic_cast<Streamable *>(*bi));
+                Streamable *in = dynamic_cast<Streamable *>(*bi);
+                if (!in || !in->canStream())
+                {
+                    sources.emplace_back(new HybridSource(*bi, chunkSize));
+                    in = sources.back().get();
+                }
+                StageList newStages(stages);
+                newStages.push_front(in);
                 lists.push_front(newStages);
             }
         }
         if (lists.empty())
-        {
-            lastRunStages.done(table);
             break;
-        }
         stages = lists.front();
         lists.pop_front();
         s = stages.front();
     }
+    return pathList;
+}
+
+
+void Streamable::processBatch(StreamPointTable& table, PointId begin,
+    PointId end, std::vector<bool>& keep)
+{
+    PointRef point(table, begin);
+    for (PointId idx = begin; idx < end; idx++)
+    {
+        if (!keep[idx - begin])
+            continue;
+        point.setPointId(idx);
+        if (!processOne(point))
+            keep[idx - begin] = false;
+    }
+}
+
+
+// Run a filter (or writer) on the points of a table that haven't been
+// skipped and skip the points that it filters out.
+void Streamable::filterTable(Streamable& s, StreamPointTable& table,
+    point_count_t count)
+{
+    std::vector<bool> keep(count);
+    point_count_t in = 0;
+    for (PointId idx = 0; idx < count; idx++)
+        if ((keep[idx] = !table.skip(idx)))
+            in++;
+
+    if (in)
+    {
+        StageProfile::Timer timer(s.m_profile);
+        Trace::Span span("stream", s.getName());
+        s.processBatch(table, 0, count, keep);
+    }
+
+    point_count_t out = 0;
+    for (PointId idx = 0; idx < count; idx++)
+        if (keep[idx])
+            out++;
+        else
+            table.setSkip(idx);
+    s.m_profile.addPoints(in, out);
 }
 
 
@@ -179,7 +629,6 @@ void Streamable::execute(StreamPointTable& table,
     std::list<Streamable *>& stages, SrsMap& srsMap)
 {
     std::list<Streamable *> filters;
-    SpatialReference srs;
 
     // Separate out the first stage.
     Streamable *reader = stages.front();
@@ -197,23 +646,58 @@ void Streamable::execute(StreamPointTable& table,
 
     // Loop until we're finished.  We handle the number of points up to
     // the capacity of the StreamPointTable that we've been provided.
-
     bool finished = false;
     while (!finished)
     {
-        // Clear the spatial reference when processing starts.
-        table.clearSpatialReferences();
-        PointId idx = 0;
-        PointRef point(table, idx);
-        point_count_t pointLimit = (std::min)(count, table.capacity());
+        point_count_t pointLimit =
+            executeChunk(table, reader, filters, count, srsMap, finished);
+        table.clear(pointLimit);
+    }
+}
 
-        reader->startLogging();
-        // When we get false back from a reader, we're done, so set
-        // the point limit to the number of points processed in this loop
-        // of the table.
-        if (!pointLimit)
-            finished = true;
 
+// Fill the table with points from the reader and run them through the
+// filters.  Returns the number of points in the table, including those
+// that have been skipped.
+point_count_t Streamable::executeChunk(StreamPointTable& table,
+    Streamable *reader, std::list<Streamable *>& filters,
+    point_count_t& count, SrsMap& srsMap, bool& finished)
+{
+    SpatialReference srs;
+
+    point_count_t pointLimit =
+        readChunk(table, reader, filters, count, srs, finished);
+    filterChunk(table, filters, pointLimit, srs, srsMap);
+    return pointLimit;
+}
+
+
+// Fill the table with points from the reader.  'srs' is set to the
+// reader's spatial reference.  Returns the number of points read.
+point_count_t Streamable::readChunk(StreamPointTable& table,
+    Streamable *reader, std::list<Streamable *>& filters,
+    point_count_t& count, SpatialReference& srs, bool& finished)
+{
+    // Clear the spatial reference when processing starts.
+    table.clearSpatialReferences();
+    PointRef point(table, 0);
+    point_count_t pointLimit = (std::min)(count, table.capacity());
+
+    // Once a stage wants no more points there's no reason to read them.
+    for (Streamable *s : filters)
+        if (s->satisfied())
+            pointLimit = 0;
+
+    reader->startLogging();
+    // When we get false back from a reader, we're done, so set
+    // the point limit to the number of points processed in this loop
+    // of the table.
+    if (!pointLimit)
+        finished = true;
+
+    {
+        StageProfile::Timer timer(reader->m_profile);
+        Trace::Span span("stream", reader->getName());
         for (PointId idx = 0; idx < pointLimit; idx++)
         {
             point.setPointId(idx);
@@ -221,45 +705,433 @@ void Streamable::execute(StreamPointTable& table,
             if (finished)
                 pointLimit = idx;
         }
-        count -= pointLimit;
+    }
+    count -= pointLimit;
+    reader->m_profile.addPoints(0, pointLimit);
 
-        reader->stopLogging();
-        srs = reader->getSpatialReference();
-        if (!srs.empty())
+    reader->stopLogging();
+    srs = reader->getSpatialReference();
+    if (!srs.empty())
+        table.setSpatialReference(srs);
+    return pointLimit;
+}
+
+
+// Run the filters on the first 'count' points of the table.  'srs' is
+// the spatial reference of the points and is updated by the filters that
+// change it.
+void Streamable::filterChunk(StreamPointTable& table,
+    std::list<Streamable *>& filters, point_count_t count,
+    SpatialReference& srs, SrsMap& srsMap)
+{
+    // When we get a false back from a filter, we're filtering out a
+    // point, so add it to the list of skips so that it doesn't get
+    // processed by subsequent filters.
+    for (Streamable *s : filters)
+    {
+        auto si = srsMap.find(s);
+        if (si == srsMap.end() || si->second != srs)
+        {
+            s->spatialReferenceChanged(srs);
+            srsMap[s] = srs;
+        }
+        s->startLogging();
+        filterTable(*s, table, count);
+        const SpatialReference& tempSrs = s->getSpatialReference();
+        if (!tempSrs.empty())
+        {
+            srs = tempSrs;
             table.setSpatialReference(srs);
+        }
+        s->stopLogging();
+    }
+}
+
+
+void Streamable::executePipelined(StreamPointTable& table,
+    std::list<Streamable *>& stages, SrsMap& srsMap, int threads)
+{
+    using StageGroup = std::vector<Streamable *>;
+
+    // Split the stages into groups that each run on their own thread.
+    // The reader always gets a thread of its own and, if there are enough
+    // threads, so does the last stage (usually a writer).  The remaining
+    // stages are split evenly among the threads that are left.
+    std::vector<Streamable *> all(stages.begin(), stages.end());
+    size_t numGroups = (std::min)((size_t)threads, all.size());
+    std::vector<StageGroup> groups(numGroups);
+    groups.front().push_back(all.front());
+    size_t middle = all.size() - 1;
+    size_t middleGroups = numGroups - 1;
+    if (numGroups > 2)
+    {
+        groups.back().push_back(all.back());
+        middle--;
+        middleGroups--;
+    }
+    for (size_t i = 0; i < middle; ++i)
+        groups[1 + (i * middleGroups) / middle].push_back(all[i + 1]);
+
+    // We may be limited in the number of points requested.
+    Streamable *reader = all.front();
+    point_count_t count = (std::numeric_limits<point_count_t>::max)();
+    if (Reader *r = dynamic_cast<Reader *>(reader))
+        count = r->count();
+
+    // There's one more buffer than there are groups so that the reader can
+    // start filling a buffer as soon as the last group takes one.
+    std::vector<std::unique_ptr<StreamBuffer>> buffers;
+    for (size_t i = 0; i < numGroups + 1; ++i)
+        buffers.emplace_back(new StreamBuffer(*table.layout(),
+            table.capacity()));
 
-        // When we get a false back from a filter, we're filtering out a
-        // point, so add it to the list of skips so that it doesn't get
-        // processed by subsequent filters.
-        for (Streamable *s : filters)
+    // The queue for a group holds the buffers ready for it.  The queue
+    // for the first group holds buffers that are free to be filled.
+    std::vector<BufferQueue> queues(numGroups);
+    for (auto& b : buffers)
+        queues.front().push(b.get());
+
+    std::mutex mutex;
+    std::exception_ptr error;
+    SpatialReference lastSrs;
+    // Set when a stage wants no more points.  Stages are only asked from
+    // the thread that runs them.
+    std::atomic<bool> satisfied(false);
+    for (Streamable *s : all)
+        if (s->satisfied())
+            satisfied = true;
+
+    auto stop = [&]()
+    {
+        for (BufferQueue& q : queues)
+            q.stop();
+    };
+
+    // Run a group's filters on the points in a buffer.
+    auto filter = [&](StageGroup& group, StreamBuffer& buf)
+    {
+        for (Streamable *s : group)
         {
-            auto si = srsMap.find(s);
-            if (si == srsMap.end() || si->second != srs)
+            if (s == reader)
+                continue;
+
+            bool changed;
             {
-                s->spatialReferenceChanged(srs);
-                srsMap[s] = srs;
+                std::lock_guard<std::mutex> lock(mutex);
+                auto si = srsMap.find(s);
+                changed = (si == srsMap.end() || si->second != buf.m_srs);
+                if (changed)
+                    srsMap[s] = buf.m_srs;
             }
+            if (changed)
+                s->spatialReferenceChanged(buf.m_srs);
+
             s->startLogging();
+            filterTable(*s, buf, buf.m_count);
+            const SpatialReference& tempSrs = s->getSpatialReference();
+            if (!tempSrs.empty())
+            {
+                buf.m_srs = tempSrs;
+                buf.setSpatialReference(tempSrs);
+            }
+            s->stopLogging();
+            if (s->satisfied())
+                satisfied = true;
+        }
+    };
+
+    // Fill a buffer with points from the reader.
+    auto read = [&](StreamBuffer& buf)
+    {
+        // Clear the spatial reference when processing starts.
+        buf.clearSpatialReferences();
+        PointRef point(buf, 0);
+        point_count_t pointLimit = satisfied ? 0 :
+            (std::min)(count, buf.capacity());
+
+        reader->startLogging();
+        // When we get false back from a reader, we're done, so set
+        // the point limit to the number of points processed in this loop
+        // of the table.
+        bool finished = (pointLimit == 0);
+        {
+            StageProfile::Timer timer(reader->m_profile);
+            Trace::Span span("stream", reader->getName());
             for (PointId idx = 0; idx < pointLimit; idx++)
             {
-                if (table.skip(idx))
-                    continue;
                 point.setPointId(idx);
-                if (!s->processOne(point))
-                    table.setSkip(idx);
+                finished = !reader->processOne(point);
+                if (finished)
+                    pointLimit = idx;
             }
-            const SpatialReference& tempSrs = s->getSpatialReference();
-            if (!tempSrs.empty())
+        }
+        count -= pointLimit;
+        reader->m_profile.addPoints(0, pointLimit);
+        reader->stopLogging();
+
+        buf.m_count = pointLimit;
+        buf.m_last = finished;
+        buf.m_srs = reader->getSpatialReference();
+        if (!buf.m_srs.empty())
+            buf.setSpatialReference(buf.m_srs);
+    };
+
+    auto run = [&](size_t g)
+    {
+        try
+        {
+            BufferQueue& in = queues[g];
+            BufferQueue& out = queues[(g + 1) % numGroups];
+            bool last = false;
+            while (!last)
             {
-                srs = tempSrs;
-                table.setSpatialReference(srs);
+                StreamBuffer *buf = in.pop();
+                if (!buf)
+                    return;
+                if (g == 0)
+                    read(*buf);
+                filter(groups[g], *buf);
+                last = buf->m_last;
+
+                // The last group is done with the buffer.  Clear it and
+                // hand it back to the reader.
+                if (g == numGroups - 1)
+                {
+                    if (last)
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        lastSrs = buf->m_srs;
+                    }
+                    buf->clear(buf->m_count);
+                    buf->m_count = 0;
+                }
+                // After the reader's last buffer it doesn't need any more.
+                if (g != numGroups - 1 || !last)
+                    out.push(buf);
             }
-            s->stopLogging();
         }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error)
+                error = std::current_exception();
+            stop();
+        }
+    };
 
-        table.clear(pointLimit);
+    m_log->get(LogLevel::Debug) << "Executing stream mode with " <<
+        numGroups << " threads." << std::endl;
+
+    std::vector<std::thread> workers;
+    for (size_t g = 1; g < numGroups; ++g)
+        workers.emplace_back(run, g);
+    run(0);
+    for (std::thread& t : workers)
+        t.join();
+
+    if (error)
+        std::rethrow_exception(error);
+
+    table.clearSpatialReferences();
+    if (!lastSrs.empty())
+        table.setSpatialReference(lastSrs);
+}
+
+
+// Run the paths of the pipeline at the same time.  The stages that only
+// one path uses (at least its reader) run on a thread that takes a path
+// at a time, filling the path's own buffers.  Filled buffers are run
+// through the stages that paths share on the calling thread, either in
+// the order of the paths, as when they run one after another, or in the
+// order that they're filled.  Returns false, having run nothing, if some
+// path's reader is shared by other paths.
+bool Streamable::executeConcurrent(StreamPointTable& table,
+    std::vector<StageList>& pathList, int threads)
+{
+    using StageVec = std::list<Streamable *>;
+
+    // Split each path into the stages that only it uses and the rest.
+    std::map<Streamable *, int> uses;
+    for (StageList& stages : pathList)
+        for (Streamable *s : stages)
+            uses[s]++;
+    const size_t numPaths = pathList.size();
+    std::vector<Streamable *> readers(numPaths);
+    std::vector<StageVec> own(numPaths);
+    std::vector<StageVec> shared(numPaths);
+    for (size_t p = 0; p < numPaths; ++p)
+    {
+        StageList& stages = pathList[p];
+        if (uses[stages.front()] > 1)
+            return false;
+        readers[p] = stages.front();
+        auto si = std::next(stages.begin());
+        for (; si != stages.end() && uses[*si] == 1; ++si)
+            own[p].push_back(*si);
+        shared[p].assign(si, stages.end());
+    }
+
+    // Every stage is readied before any path runs and finished after all
+    // of them have.
+    StageList all;
+    std::set<Streamable *> seen;
+    for (StageList& stages : pathList)
+        for (Streamable *s : stages)
+            if (seen.insert(s).second)
+                all.push_back(s);
+    all.ready(table);
+
+    const size_t numWorkers = (std::min)((size_t)threads - 1, numPaths);
+    m_log->get(LogLevel::Debug) << "Executing " << numPaths << " stream "
+        "paths on " << numWorkers << " threads." << std::endl;
+
+    // Each path has two buffers so that its reader can fill one while the
+    // other is processed.  They're allocated when the path starts and
+    // released once its last buffer has been processed.
+    std::vector<std::vector<std::unique_ptr<StreamBuffer>>> buffers(numPaths);
+    std::vector<BufferQueue> idle(numPaths);
+    BufferQueue filled;
+
+    std::mutex mutex;
+    std::exception_ptr error;
+    // Set when a shared stage wants no more points.
+    std::atomic<bool> satisfied(false);
+    std::atomic<size_t> nextPath(0);
+
+    auto stop = [&]()
+    {
+        filled.stop();
+        for (BufferQueue& q : idle)
+            q.stop();
+    };
+
+    auto fail = [&]()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!error)
+            error = std::current_exception();
+        stop();
+    };
+
+    auto runPath = [&](size_t p)
+    {
+        for (size_t i = 0; i < 2; ++i)
+        {
+            buffers[p].emplace_back(new StreamBuffer(*table.layout(),
+                table.capacity()));
+            idle[p].push(buffers[p].back().get());
+        }
+
+        point_count_t count = (std::numeric_limits<point_count_t>::max)();
+        if (Reader *r = dynamic_cast<Reader *>(readers[p]))
+            count = r->count();
+
+        SrsMap srsMap;
+        bool finished = false;
+        while (!finished)
+        {
+            StreamBuffer *buf = idle[p].pop();
+            if (!buf)
+                return false;
+            if (satisfied)
+                count = 0;
+            SpatialReference srs;
+            buf->m_count =
+                readChunk(*buf, readers[p], own[p], count, srs, finished);
+            filterChunk(*buf, own[p], buf->m_count, srs, srsMap);
+            buf->m_srs = srs;
+            buf->m_last = finished;
+            buf->m_path = p;
+            filled.push(buf);
+        }
+        return true;
+    };
+
+    auto work = [&]()
+    {
+        try
+        {
+            size_t p;
+            while ((p = nextPath++) < numPaths)
+                if (!runPath(p))
+                    return;
+        }
+        catch (...)
+        {
+            fail();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < numWorkers; ++i)
+        workers.emplace_back(work);
+
+    SrsMap srsMap;
+    SpatialReference lastSrs;
+    try
+    {
+        // Buffers from paths after the current one wait here when the
+        // paths are run in order.
+        std::vector<std::deque<StreamBuffer *>> waiting(numPaths);
+        size_t current = 0;
+        size_t finishedPaths = 0;
+        while (finishedPaths < numPaths)
+        {
+            StreamBuffer *buf;
+            if (m_streamOrdered && waiting[current].size())
+            {
+                buf = waiting[current].front();
+                waiting[current].pop_front();
+            }
+            else
+            {
+                buf = filled.pop();
+                if (!buf)
+                    break;
+                if (m_streamOrdered && buf->m_path != current)
+                {
+                    waiting[buf->m_path].push_back(buf);
+                    continue;
+                }
+            }
+
+            const size_t p = buf->m_path;
+            filterChunk(*buf, shared[p], buf->m_count, buf->m_srs, srsMap);
+            for (Streamable *s : shared[p])
+                if (s->satisfied())
+                    satisfied = true;
+            lastSrs = buf->m_srs;
+
+            if (buf->m_last)
+            {
+                // The path's other buffer is idle, so both can go.
+                buffers[p].clear();
+                finishedPaths++;
+                current++;
+            }
+            else
+            {
+                buf->clear(buf->m_count);
+                buf->m_count = 0;
+                idle[p].push(buf);
+            }
+        }
+    }
+    catch (...)
+    {
+        fail();
     }
+
+    for (std::thread& t : workers)
+        t.join();
+    if (error)
+        std::rethrow_exception(error);
+
+    all.done(table);
+    table.clearSpatialReferences();
+    if (!lastSrs.empty())
+        table.setSpatialReference(lastSrs);
+    return true;
 }
 
 } // namespace pdal
-
@@ -34,6 +34,9 @@
 
 #pragma once
 
+#include <memory>
+#include <vector>
+
 #include <pdal/pdal_internal.hpp>
 #include <pdal/Stage.hpp>
 
@@ -54,17 +57,50 @@ public:
       This performs the action associated with the stage by executing the
       \ref processOne function of each stage in depth first order.  Points
       are processed up to the capacity of the provided StreamPointTable.
-      Not all stages support streaming mode and an exception will be thrown
-      when attempting to \ref execute an unsupported stage.
 
-      Streaming points can reduce memory consumption, but will limit access
-      to algorithms that need to operate on full point sets.
+      Inputs that don't support streaming, or can't stream with their
+      current options (see \ref canStream), are run in standard mode on
+      the points buffered from their own inputs, and the points they
+      produce are then streamed to the rest of the pipeline.  By default
+      all the points are buffered, so memory use for that part of the
+      pipeline is the same as in standard mode.  \ref setHybridChunkSize
+      limits the number of points buffered at once for stages that treat
+      points independently or in order.
+
+      An exception is thrown only if this stage itself can't stream with
+      its current options.
 
       \param table  Streaming point table used for stage pipeline.  This must be
         the same \ref table used in the \ref prepare function.
 
     */
     virtual void execute(StreamPointTable& table);
+
+    /**
+      Execute a prepared pipeline (linked set of stages) in streaming mode,
+      overlapping the work of the stages on separate threads.
+
+      The reader, the filters and the final stage of each path through the
+      pipeline are split into as many as \ref threads groups.  Each group
+      runs on its own thread and points are passed between groups in a ring
+      of buffers that have the layout and capacity of \ref table.  Each
+      stage is only ever called from a single thread.  The points themselves
+      never pass through \ref table, so this shouldn't be used with tables
+      that act on the point data when they're reset.
+
+      When the pipeline has several readers (or other sources) whose
+      paths only meet at later stages, the paths run at the same time
+      instead.  Each path reads into buffers of its own on one of
+      \ref threads - 1 threads, and the stages the paths share process
+      the buffers on the calling thread, in the order set with
+      \ref setStreamOrdered.
+
+      \param table  Streaming point table used for stage pipeline.  This must
+        be the same \ref table used in the \ref prepare function.
+      \param threads  Maximum number of threads to use.  If one, this is
+        the same as \ref execute(StreamPointTable&).
+    */
+    virtual void execute(StreamPointTable& table, int threads);
     using Stage::execute;
 
     /**
@@ -74,6 +110,32 @@ public:
     */
     virtual bool pipelineStreamable() const;
 
+    /**
+      Set the maximum number of points buffered at once for a stage that
+      doesn't support streaming when executing in stream mode.  The stage
+      is run separately on each chunk of points, which is only correct
+      for stages that treat points independently or in order.
+
+      \param chunkSize  Maximum number of points to buffer.  If zero, all
+        the points are buffered and the stage is run once (the default).
+    */
+    void setHybridChunkSize(point_count_t chunkSize)
+        { m_hybridChunkSize = chunkSize; }
+
+    /**
+      Set whether the points of paths from different sources reach the
+      stages the paths share in path order when the paths are streamed at
+      the same time by \ref execute(StreamPointTable&, int).  In order,
+      the shared stages see the points as if the paths had run one after
+      another.  Otherwise they see each batch of points as soon as it's
+      ready.
+
+      \param ordered  Whether the points are passed on in path order
+        (the default).
+    */
+    void setStreamOrdered(bool ordered)
+        { m_streamOrdered = ordered; }
+
 protected:
     Streamable& operator=(const Streamable&) = delete;
     Streamable(const Streamable&); // not implemented
@@ -82,6 +144,11 @@ protected:
 
     void execute(StreamPointTable& table, std::list<Streamable *>& stages,
         SrsMap& srsMap);
+    point_count_t executeChunk(StreamPointTable& table, Streamable *reader,
+        std::list<Streamable *>& filters, point_count_t& count,
+        SrsMap& srsMap, bool& finished);
+    void executePipelined(StreamPointTable& table,
+        std::list<Streamable *>& stages, SrsMap& srsMap, int threads);
 
     /**
       Process a single point (streaming mode).  Implement in subclass.
@@ -92,6 +159,23 @@ protected:
         to subsequent stages).
     */
     virtual bool processOne(PointRef& /*point*/) = 0;
+
+    /**
+      Process a range of points (streaming mode).  The default calls
+      \ref processOne for each point.  Filters can override this to work
+      on the values of many points at once, avoiding a virtual call and
+      value conversion for each point.
+
+      \param table  Table holding the points.
+      \param begin  Index of the first point to process.
+      \param end  Index one past the last point to process.
+      \param keep  Whether each point of the range, starting with \ref begin,
+        is to be processed.  Points that are filtered out should be set to
+        false.  Points that are already false must stay false.  No stage
+        looks at their values again, so they may be modified.
+    */
+    virtual void processBatch(StreamPointTable& table, PointId begin,
+        PointId end, std::vector<bool>& keep);
     /**
     {
         throwStreamingError();
@@ -108,6 +192,27 @@ protected:
     virtual void spatialReferenceChanged(const SpatialReference& /*srs*/)
     {}
 
+    /**
+      Determine if the stage can process points one at a time with its
+      current options.  In stream mode, a stage that can't is run on
+      buffered points like a stage that doesn't support streaming.
+
+      \return  Whether the stage can stream.
+    */
+    virtual bool canStream() const
+        { return true; }
+
+    /**
+      Determine if the stage will filter out every point that it's given
+      from now on.  In stream mode, this is checked before each table of
+      points is read and, once a stage on the path from a reader is
+      satisfied, no more points are read for that path.
+
+      \return  Whether the stage needs no more points.
+    */
+    virtual bool satisfied() const
+        { return false; }
+
     /**
       Find the first nonstreamable stage in a pipeline.
 
@@ -115,6 +220,28 @@ protected:
         a pointer to the first found stage that's not streamable.
     */
     const Stage *findNonstreamable() const;
+
+private:
+    class StageList;
+    class HybridSource;
+    class StreamRunner;
+
+    std::vector<StageList> paths(
+        std::vector<std::unique_ptr<Streamable>>& sources,
+        point_count_t chunkSize);
+    static void filterTable(Streamable& s, StreamPointTable& table,
+        point_count_t count);
+    point_count_t readChunk(StreamPointTable& table, Streamable *reader,
+        std::list<Streamable *>& filters, point_count_t& count,
+        SpatialReference& srs, bool& finished);
+    void filterChunk(StreamPointTable& table,
+        std::list<Streamable *>& filters, point_count_t count,
+        SpatialReference& srs, SrsMap& srsMap);
+    bool executeConcurrent(StreamPointTable& table,
+        std::vector<StageList>& pathList, int threads);
+
+    point_count_t m_hybridChunkSize;
+    bool m_streamOrdered;
 };
 
 } // namespace pdal
@@ -0,0 +1,128 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <pdal/PointLayout.hpp>
+#include <pdal/PointRef.hpp>
+
+namespace pdal
+{
+
+/**
+  Accessor for a dimension whose ID and value type are known at compile
+  time.  The accessor is resolved against a layout once the layout is
+  finalized.  If the dimension is stored as type T, values are then read
+  and written directly, without the runtime type dispatch and conversion
+  done by PointRef::getFieldAs() and PointRef::setField().  Otherwise
+  values are converted as those functions do.  Setting a dimension that
+  isn't part of the layout does nothing.
+
+  \code
+    TypedDim<Dimension::Id::X, double> x;
+    x.resolve(*table.layout());
+    ...
+    x.set(point, 12.5);
+  \endcode
+*/
+template<Dimension::Id ID, typename T>
+class TypedDim
+{
+public:
+    TypedDim() : m_present(false), m_direct(false)
+    {}
+
+    /**
+      Resolve the accessor against a finalized layout.
+
+      \param layout  Layout of the points to be accessed.
+    */
+    void resolve(const PointLayout& layout)
+    {
+        m_present = layout.hasDim(ID);
+        m_direct = (layout.dimType(ID) == Dimension::getType<T>() &&
+            !layout.dimDetail(ID)->scaled());
+    }
+
+    /**
+      Determine if the dimension is part of the layout.
+
+      \return  Whether the dimension is part of the layout.
+    */
+    bool present() const
+        { return m_present; }
+
+    /**
+      Determine if values are accessed without conversion.
+
+      \return  Whether the dimension is stored as type T.
+    */
+    bool direct() const
+        { return m_direct; }
+
+    /**
+      Get the value of the dimension for a point.
+
+      \param point  Point whose value should be fetched.
+      \return  Value of the dimension.
+    */
+    T get(const PointRef& point) const
+    {
+        if (!m_direct)
+            return point.getFieldAs<T>(ID);
+        T val;
+        point.getFieldDirect(ID, &val);
+        return val;
+    }
+
+    /**
+      Set the value of the dimension for a point.
+
+      \param point  Point whose value should be set.
+      \param val  Value to set.
+    */
+    void set(PointRef& point, T val) const
+    {
+        if (m_direct)
+            point.setFieldDirect(ID, &val);
+        else if (m_present)
+            point.setField(ID, val);
+    }
+
+private:
+    bool m_present;
+    bool m_direct;
+};
+
+} // namespace pdal
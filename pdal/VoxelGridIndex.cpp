@@ -0,0 +1,280 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <thread>
+
+#include <pdal/VoxelGridIndex.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+namespace pdal
+{
+
+VoxelGridIndex::VoxelGridIndex(const PointView& buf, double cellSize) :
+    m_buf(buf), m_cellSize(cellSize)
+{
+    if (!buf.hasDim(Dimension::Id::X))
+        throw pdal_error("VoxelGridIndex: point view missing 'X' dimension.");
+    if (!buf.hasDim(Dimension::Id::Y))
+        throw pdal_error("VoxelGridIndex: point view missing 'Y' dimension.");
+    if (!buf.hasDim(Dimension::Id::Z))
+        throw pdal_error("VoxelGridIndex: point view missing 'Z' dimension.");
+    if (!(cellSize > 0))
+        throw pdal_error("VoxelGridIndex: cell size must be positive.");
+    for (int d = 0; d < 3; ++d)
+        m_min[d] = 0;
+}
+
+
+void VoxelGridIndex::build()
+{
+    static const Dimension::Id dims[] =
+        { Dimension::Id::X, Dimension::Id::Y, Dimension::Id::Z };
+
+    const point_count_t count = m_buf.size();
+    std::vector<double> coords(count * 3);
+    std::vector<double> values(count);
+
+    for (int d = 0; d < 3; ++d)
+    {
+        double minimum = (std::numeric_limits<double>::max)();
+        if (count)
+            m_buf.getFieldArray(dims[d], 0, count, values.data());
+        for (PointId i = 0; i < count; ++i)
+        {
+            coords[i * 3 + d] = values[i];
+            minimum = (std::min)(minimum, values[i]);
+        }
+        m_min[d] = count ? minimum : 0;
+    }
+
+    std::vector<Cell> cells(count);
+    parallelFor(count, [this, &cells, &coords]()
+    {
+        return [this, &cells, &coords](std::size_t i)
+            { cells[i] = cell(&coords[i * 3]); };
+    });
+
+    // Sort the points by cell.  Pieces of the list are sorted on separate
+    // threads and then merged in pairs, also on separate threads.
+    std::vector<PointId> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    auto less = [&cells](PointId a, PointId b)
+    {
+        if (cells[a] == cells[b])
+            return a < b;
+        return cells[a] < cells[b];
+    };
+
+    std::size_t pieces = (std::max)(std::thread::hardware_concurrency(), 1u);
+    std::vector<std::size_t> bounds;
+    for (std::size_t p = 0; p <= pieces; ++p)
+        bounds.push_back(count * p / pieces);
+
+    auto begin = order.begin();
+    parallelFor(pieces, [&]()
+    {
+        return [&](std::size_t p)
+            { std::sort(begin + bounds[p], begin + bounds[p + 1], less); };
+    }, 1);
+    for (std::size_t width = 1; width < pieces; width *= 2)
+    {
+        std::size_t merges = (pieces + 2 * width - 1) / (2 * width);
+        parallelFor(merges, [&]()
+        {
+            return [&](std::size_t m)
+            {
+                std::size_t lo = m * 2 * width;
+                std::size_t mid = (std::min)(lo + width, pieces);
+                std::size_t hi = (std::min)(lo + 2 * width, pieces);
+                std::inplace_merge(begin + bounds[lo], begin + bounds[mid],
+                    begin + bounds[hi], less);
+            };
+        }, 1);
+    }
+
+    // Store the points in cell order so that the points of a cell are
+    // next to each other, and note where each cell's points are.
+    m_ids.swap(order);
+    m_coords.resize(count * 3);
+    m_cells.clear();
+    for (std::size_t i = 0; i < count; ++i)
+        std::copy_n(&coords[m_ids[i] * 3], 3, &m_coords[i * 3]);
+    for (std::size_t i = 0; i < count;)
+    {
+        const Cell& c = cells[m_ids[i]];
+        std::size_t j = i + 1;
+        while (j < count && cells[m_ids[j]] == c)
+            j++;
+        m_cells[c] = CellRange(i, j);
+        i = j;
+    }
+}
+
+
+int64_t VoxelGridIndex::cellIndex(double v, int dim) const
+{
+    return (int64_t)std::floor((v - m_min[dim]) / m_cellSize);
+}
+
+
+VoxelGridIndex::Cell VoxelGridIndex::cell(const double *pt) const
+{
+    return Cell { cellIndex(pt[0], 0), cellIndex(pt[1], 1),
+        cellIndex(pt[2], 2) };
+}
+
+
+void VoxelGridIndex::search(const double *pt, double r,
+    std::vector<PointId>& ids, std::vector<double>& sqrDists,
+    std::vector<std::pair<double, PointId>>& matches) const
+{
+    // Our distance metric is square distance, so we use the square of
+    // the radius.  Points at exactly the radius aren't included, as with
+    // KD3Index.
+    const double r2 = r * r;
+
+    auto check = [&](const CellRange& range)
+    {
+        for (std::size_t k = range.first; k < range.second; ++k)
+        {
+            const double *p = &m_coords[k * 3];
+            double d0 = pt[0] - p[0];
+            double d1 = pt[1] - p[1];
+            double d2 = pt[2] - p[2];
+            double dist = d0 * d0 + d1 * d1 + d2 * d2;
+            if (dist < r2)
+                matches.push_back(std::make_pair(dist, m_ids[k]));
+        }
+    };
+
+    matches.clear();
+    Cell lo { cellIndex(pt[0] - r, 0), cellIndex(pt[1] - r, 1),
+        cellIndex(pt[2] - r, 2) };
+    Cell hi { cellIndex(pt[0] + r, 0), cellIndex(pt[1] + r, 1),
+        cellIndex(pt[2] + r, 2) };
+
+    // When the search touches more cells than there are occupied ones,
+    // go through the occupied cells instead.
+    double touched = double(hi.m_x - lo.m_x + 1) * (hi.m_y - lo.m_y + 1) *
+        (hi.m_z - lo.m_z + 1);
+    if (touched > m_cells.size())
+    {
+        for (auto& cr : m_cells)
+        {
+            const Cell& c = cr.first;
+            if (c.m_x >= lo.m_x && c.m_x <= hi.m_x &&
+                c.m_y >= lo.m_y && c.m_y <= hi.m_y &&
+                c.m_z >= lo.m_z && c.m_z <= hi.m_z)
+                check(cr.second);
+        }
+    }
+    else
+    {
+        for (int64_t x = lo.m_x; x <= hi.m_x; ++x)
+            for (int64_t y = lo.m_y; y <= hi.m_y; ++y)
+                for (int64_t z = lo.m_z; z <= hi.m_z; ++z)
+                {
+                    auto it = m_cells.find(Cell { x, y, z });
+                    if (it != m_cells.end())
+                        check(it->second);
+                }
+    }
+
+    std::sort(matches.begin(), matches.end());
+    ids.resize(matches.size());
+    sqrDists.resize(matches.size());
+    for (std::size_t i = 0; i < matches.size(); ++i)
+    {
+        sqrDists[i] = matches[i].first;
+        ids[i] = matches[i].second;
+    }
+}
+
+
+std::vector<PointId> VoxelGridIndex::radius(double x, double y, double z,
+    double r) const
+{
+    std::vector<PointId> ids;
+    std::vector<double> sqrDists;
+    std::vector<std::pair<double, PointId>> matches;
+    double pt[] = { x, y, z };
+
+    search(pt, r, ids, sqrDists, matches);
+    return ids;
+}
+
+
+std::vector<PointId> VoxelGridIndex::radius(PointId idx, double r) const
+{
+    double x = m_buf.getFieldAs<double>(Dimension::Id::X, idx);
+    double y = m_buf.getFieldAs<double>(Dimension::Id::Y, idx);
+    double z = m_buf.getFieldAs<double>(Dimension::Id::Z, idx);
+
+    return radius(x, y, z, r);
+}
+
+
+std::vector<PointId> VoxelGridIndex::radius(PointRef& point, double r) const
+{
+    double x = point.getFieldAs<double>(Dimension::Id::X);
+    double y = point.getFieldAs<double>(Dimension::Id::Y);
+    double z = point.getFieldAs<double>(Dimension::Id::Z);
+
+    return radius(x, y, z, r);
+}
+
+
+void VoxelGridIndex::radiusAll(double r, const NeighborFunc& cb) const
+{
+    // Points are taken in cell order, so that neighboring queries look at
+    // the same cells.
+    parallelFor(m_ids.size(), [this, r, &cb]()
+    {
+        std::vector<PointId> ids;
+        std::vector<double> sqrDists;
+        std::vector<std::pair<double, PointId>> matches;
+
+        return [this, r, &cb, ids, sqrDists, matches](std::size_t i) mutable
+        {
+            search(&m_coords[i * 3], r, ids, sqrDists, matches);
+            cb(m_ids[i], ids, sqrDists);
+        };
+    });
+}
+
+} // namespace pdal
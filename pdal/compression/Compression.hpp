@@ -35,6 +35,7 @@
 
 #include <pdal/pdal_internal.hpp>
 #include <functional>
+#include <vector>
 
 namespace pdal
 {
@@ -63,6 +64,26 @@ public:
 };
 
 
+/**
+  Settings for compressors that support them.  A compressor ignores the
+  settings that its codec doesn't support.
+*/
+struct CompressionOptions
+{
+    CompressionOptions() : level(0), threads(0), longDistance(false)
+    {}
+
+    /// Compression level.  Zero selects PDAL's default for the codec.
+    int level;
+    /// Number of worker threads.  Zero compresses on the calling thread.
+    int threads;
+    /// Whether to search a large window for matches far back in the input.
+    bool longDistance;
+    /// Dictionary to prime the compressor.  Data compressed with a
+    /// dictionary can only be decompressed with the same dictionary.
+    std::vector<char> dictionary;
+};
+
 class PDAL_DLL Compressor
 {
 public:
@@ -33,6 +33,9 @@
 ****************************************************************************/
 
 #include <pdal/util/OStream.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+#include <mutex>
 
 #pragma push_macro("min")
 #pragma push_macro("max")
@@ -110,6 +113,64 @@ size_t addFields(LasZipEngine& engine, const DimTypeList& dims)
     return pointSize;
 }
 
+// Output stream for the lazperf encoder that appends to a vector.
+class VectorOutStream
+{
+public:
+    VectorOutStream(std::vector<char>& buf) : m_buf(buf)
+    {}
+
+    void putBytes(const uint8_t *buf, size_t bufsize)
+        { m_buf.insert(m_buf.end(), buf, buf + bufsize); }
+    void putByte(uint8_t b)
+        { m_buf.push_back((char)b); }
+
+private:
+    std::vector<char>& m_buf;
+};
+
+
+// Input stream for the lazperf decoder that reads from a buffer.
+class BufferInStream
+{
+public:
+    BufferInStream(const char *buf, size_t bufsize) :
+        m_buf(buf), m_avail(bufsize)
+    {}
+
+    unsigned char getByte()
+    {
+        if (m_avail)
+        {
+            m_avail--;
+            return (unsigned char)*m_buf++;
+        }
+        return 0;
+    }
+
+    void getBytes(uint8_t *dst, size_t dstsize)
+    {
+        size_t count = (std::min)(dstsize, m_avail);
+        std::copy(m_buf, m_buf + count, reinterpret_cast<char *>(dst));
+        std::fill(dst + count, dst + dstsize, 0);
+        m_buf += count;
+        m_avail -= count;
+    }
+
+private:
+    const char *m_buf;
+    size_t m_avail;
+};
+
+
+size_t packedSize(const DimTypeList& dims)
+{
+    size_t size = 0;
+    for (const DimType& d : dims)
+        size += Dimension::size(d.m_type);
+    return size;
+}
+
 } // anonymous namespace
 
 
@@ -275,5 +336,138 @@ void LazPerfDecompressor::decompress(const char *buf, size_t bufsize)
     m_impl->decompress(buf, bufsize);
 }
 
+
+LazPerfBlockCompressor::LazPerfBlockCompressor(const DimTypeList& dims) :
+    m_dims(dims), m_pointSize(packedSize(dims))
+{}
+
+
+// The models of the lazperf compressor adapt to the data they've seen,
+// so each block gets a fresh encoder in order to be decodable on its own.
+size_t LazPerfBlockCompressor::compress(const char *src,
+    point_count_t numPoints, std::vector<char>& dst) const
+{
+    typedef laszip::encoders::arithmetic<VectorOutStream> Encoder;
+
+    dst.clear();
+    VectorOutStream out(dst);
+    Encoder encoder(out);
+    auto compressor(laszip::formats::make_dynamic_compressor(encoder));
+    if (addFields(compressor, m_dims) != m_pointSize)
+        throw compression_error("Unsupported dimension type for lazperf.");
+
+    for (point_count_t i = 0; i < numPoints; ++i)
+    {
+        compressor->compress(src);
+        src += m_pointSize;
+    }
+    encoder.done();
+    return dst.size();
+}
+
+
+LazPerfBlockDecompressor::LazPerfBlockDecompressor(const DimTypeList& dims) :
+    m_dims(dims), m_pointSize(packedSize(dims))
+{}
+
+
+void LazPerfBlockDecompressor::decompress(const char *src, size_t srcsize,
+    char *dst, point_count_t numPoints) const
+{
+    typedef laszip::decoders::arithmetic<BufferInStream> Decoder;
+
+    BufferInStream in(src, srcsize);
+    Decoder decoder(in);
+    auto decompressor(laszip::formats::make_dynamic_decompressor(decoder));
+    if (addFields(decompressor, m_dims) != m_pointSize)
+        throw compression_error("Unsupported dimension type for lazperf.");
+
+    for (point_count_t i = 0; i < numPoints; ++i)
+    {
+        decompressor->decompress(dst);
+        dst += m_pointSize;
+    }
+}
+
+
+std::vector<std::vector<char>> lazPerfCompressChunks(const DimTypeList& dims,
+    const char *src, point_count_t numPoints, point_count_t chunkPoints,
+    ThreadPool& pool)
+{
+    if (chunkPoints == 0)
+        throw compression_error("Invalid lazperf chunk size of 0.");
+
+    LazPerfBlockCompressor compressor(dims);
+    const size_t numChunks =
+        (size_t)((numPoints + chunkPoints - 1) / chunkPoints);
+    std::vector<std::vector<char>> chunks(numChunks);
+
+    std::vector<std::string> errors;
+    std::mutex mutex;
+    for (size_t i = 0; i < numChunks; ++i)
+    {
+        const point_count_t first = i * chunkPoints;
+        const point_count_t count = (std::min)(chunkPoints, numPoints - first);
+        const char *pos = src + first * compressor.pointSize();
+        std::vector<char>& chunk = chunks[i];
+        pool.add([&compressor, pos, count, &chunk, &errors, &mutex]()
+        {
+            try
+            {
+                compressor.compress(pos, count, chunk);
+            }
+            catch (const std::exception& err)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                errors.push_back(err.what());
+            }
+        });
+    }
+    pool.await();
+    if (errors.size())
+        throw compression_error(errors.front());
+    return chunks;
+}
+
+
+void lazPerfDecompressChunks(const DimTypeList& dims,
+    const std::vector<std::vector<char>>& chunks, point_count_t chunkPoints,
+    char *dst, point_count_t numPoints, ThreadPool& pool)
+{
+    if (chunkPoints == 0)
+        throw compression_error("Invalid lazperf chunk size of 0.");
+
+    LazPerfBlockDecompressor decompressor(dims);
+    if (chunks.size() != (numPoints + chunkPoints - 1) / chunkPoints)
+        throw compression_error("Number of lazperf chunks doesn't match "
+            "the number of points.");
+
+    std::vector<std::string> errors;
+    std::mutex mutex;
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        const point_count_t first = i * chunkPoints;
+        const point_count_t count = (std::min)(chunkPoints, numPoints - first);
+        char *pos = dst + first * decompressor.pointSize();
+        const std::vector<char>& chunk = chunks[i];
+        pool.add([&decompressor, &chunk, pos, count, &errors, &mutex]()
+        {
+            try
+            {
+                decompressor.decompress(chunk.data(), chunk.size(), pos,
+                    count);
+            }
+            catch (const std::exception& err)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                errors.push_back(err.what());
+            }
+        });
+    }
+    pool.await();
+    if (errors.size())
+        throw compression_error(errors.front());
+}
+
 } // namespace pdal
 
@@ -40,6 +40,8 @@
 namespace pdal
 {
 
+class ThreadPool;
+
 class LazPerfCompressorImpl;
 
 class LazPerfCompressor : public Compressor
@@ -74,5 +76,96 @@ private:
     std::unique_ptr<LazPerfDecompressorImpl> m_impl;
 };
 
+
+/**
+  Compresses blocks of packed points in a single call.  Each block is
+  a self-contained lazperf stream that can be read with a
+  LazPerfDecompressor or a LazPerfBlockDecompressor.  The dimension layout
+  is resolved once and reused for every block.
+*/
+class LazPerfBlockCompressor
+{
+public:
+    PDAL_DLL LazPerfBlockCompressor(const DimTypeList& dims);
+
+    /**
+      Compress packed points.
+
+      \param src  Packed points.
+      \param numPoints  Number of points at \a src.
+      \param dst  Buffer to hold the compressed data.  Existing contents
+        are replaced, but allocated storage is reused.
+      \return  Number of compressed bytes.
+    */
+    PDAL_DLL size_t compress(const char *src, point_count_t numPoints,
+        std::vector<char>& dst) const;
+    size_t pointSize() const
+        { return m_pointSize; }
+
+private:
+    DimTypeList m_dims;
+    size_t m_pointSize;
+};
+
+
+/**
+  Decompresses a lazperf stream of a known number of points into a
+  caller-provided buffer in a single call.
+*/
+class LazPerfBlockDecompressor
+{
+public:
+    PDAL_DLL LazPerfBlockDecompressor(const DimTypeList& dims);
+
+    /**
+      Decompress packed points.
+
+      \param src  Compressed data.
+      \param srcsize  Size of compressed data.
+      \param dst  Location for decompressed points.  Must be able to hold
+        \a numPoints * pointSize() bytes.
+      \param numPoints  Number of points to decompress.
+    */
+    PDAL_DLL void decompress(const char *src, size_t srcsize, char *dst,
+        point_count_t numPoints) const;
+    size_t pointSize() const
+        { return m_pointSize; }
+
+private:
+    DimTypeList m_dims;
+    size_t m_pointSize;
+};
+
+
+/**
+  Compress packed points as independent chunks of \a chunkPoints points
+  (the last chunk may be short), compressing chunks in parallel.
+
+  \param dims  Dimension layout of the packed points.
+  \param src  Packed points.
+  \param numPoints  Number of points at \a src.
+  \param chunkPoints  Number of points in each chunk.
+  \param pool  Thread pool used to compress chunks.
+  \return  Compressed chunks, in point order.
+*/
+PDAL_DLL std::vector<std::vector<char>> lazPerfCompressChunks(
+    const DimTypeList& dims, const char *src, point_count_t numPoints,
+    point_count_t chunkPoints, ThreadPool& pool);
+
+/**
+  Decompress chunks created with lazPerfCompressChunks() in parallel.
+
+  \param dims  Dimension layout of the packed points.
+  \param chunks  Compressed chunks.
+  \param chunkPoints  Number of points in each chunk but the last.
+  \param dst  Location for decompressed points.  Must be able to hold
+    \a numPoints points.
+  \param numPoints  Total number of points in the chunks.
+  \param pool  Thread pool used to decompress chunks.
+*/
+PDAL_DLL void lazPerfDecompressChunks(const DimTypeList& dims,
+    const std::vector<std::vector<char>>& chunks, point_count_t chunkPoints,
+    char *dst, point_count_t numPoints, ThreadPool& pool);
+
 } // namespace pdal
 
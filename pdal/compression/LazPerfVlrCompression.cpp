@@ -32,6 +32,11 @@
 * OF SUCH DAMAGE.
 ****************************************************************************/
 
+#include <deque>
+#include <future>
+#include <limits>
+#include <sstream>
+
 #pragma push_macro("min")
 #pragma push_macro("max")
 #ifdef min
@@ -54,6 +59,10 @@
 #pragma pop_macro("max")
 #pragma pop_macro("min")
 
+#include <pdal/util/Charbuf.hpp>
+#include <pdal/util/IStream.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
 #include "LazPerfVlrCompression.hpp"
 
 namespace pdal
@@ -78,15 +87,19 @@ class LazPerfVlrCompressorImpl
 
 public:
     LazPerfVlrCompressorImpl(std::ostream& stream, const Schema& schema,
-            uint32_t chunksize) :
+            uint32_t chunksize, int threads) :
         m_stream(stream), m_outputStream(stream), m_schema(schema),
         m_chunksize(chunksize), m_chunkPointsWritten(0), m_chunkInfoPos(0),
-        m_chunkOffset(0)
-    {}
+        m_chunkOffset(0), m_started(false), m_resumed(false),
+        m_threads(threads)
+    {
+        if (m_threads > 1)
+            m_pool.reset(new ThreadPool(m_threads, 2 * m_threads, false));
+    }
 
     ~LazPerfVlrCompressorImpl()
     {
-        if (m_encoder)
+        if (m_encoder || m_pending.size() || m_chunkBuf.size())
             std::cerr << "LazPerfVlrCompressor destroyed without a call "
                "to done()";
     }
@@ -95,15 +108,20 @@ public:
     void compress(const char *inbuf)
     {
         // First time through.
-        if (!m_encoder || !m_compressor)
+        if (!m_started)
+            start();
+
+        if (m_pool)
         {
-            // Get the position
-            m_chunkInfoPos = m_stream.tellp();
-            // Seek over the chunk info offset value
-            m_stream.seekp(sizeof(uint64_t), std::ios::cur);
-            m_chunkOffset = m_stream.tellp();
-            resetCompressor();
+            m_chunkBuf.insert(m_chunkBuf.end(), inbuf,
+                inbuf + m_schema.size_in_bytes());
+            if (++m_chunkPointsWritten == m_chunksize)
+                queueChunk();
+            return;
         }
+
+        if (!m_encoder || !m_compressor)
+            resetCompressor();
         else if (m_chunkPointsWritten == m_chunksize)
         {
             resetCompressor();
@@ -115,11 +133,28 @@ public:
 
     void done()
     {
-        // Close and clear the point encoder.
-        m_encoder->done();
-        m_encoder.reset();
+        if (!m_started)
+            start();
 
-        newChunk();
+        if (m_pool)
+        {
+            if (m_chunkBuf.size())
+                queueChunk();
+            while (m_pending.size())
+                writeChunk();
+        }
+        else
+        {
+            // Close and clear the point encoder.  Resumed data that got
+            // no new points has no chunk to end.
+            bool open = (bool)m_encoder;
+            if (m_encoder)
+                m_encoder->done();
+            m_encoder.reset();
+
+            if (open || !m_resumed)
+                newChunk();
+        }
 
         // Save our current position.  Go to the location where we need
         // to write the chunk table offset at the beginning of the point data.
@@ -151,7 +186,28 @@ public:
         encoder.done();
     }
 
+    void resume(std::streamoff pointOffset,
+        const std::vector<uint32_t>& chunkTable)
+    {
+        m_chunkInfoPos = pointOffset;
+        m_chunkOffset = m_stream.tellp();
+        m_chunkTable = chunkTable;
+        m_chunkPointsWritten = 0;
+        m_started = true;
+        m_resumed = true;
+    }
+
 private:
+    void start()
+    {
+        // Get the position
+        m_chunkInfoPos = m_stream.tellp();
+        // Seek over the chunk info offset value
+        m_stream.seekp(sizeof(uint64_t), std::ios::cur);
+        m_chunkOffset = m_stream.tellp();
+        m_started = true;
+    }
+
     void resetCompressor()
     {
         if (m_encoder)
@@ -168,6 +224,47 @@ private:
         m_chunkPointsWritten = 0;
     }
 
+    // Hand the buffered chunk to the pool.  Each chunk is compressed
+    // with its own encoder, exactly as a single thread would.
+    void queueChunk()
+    {
+        auto points = std::make_shared<std::vector<char>>();
+        points->swap(m_chunkBuf);
+        m_chunkPointsWritten = 0;
+
+        const Schema& schema(m_schema);
+        auto task = std::make_shared<std::packaged_task<std::string()>>(
+            [points, &schema]()
+            {
+                std::ostringstream out;
+                OutputStream outputStream(out);
+                Encoder encoder(outputStream);
+                Compressor::ptr compressor =
+                    laszip::factory::build_compressor(encoder, schema);
+
+                const size_t size = schema.size_in_bytes();
+                for (size_t pos = 0; pos < points->size(); pos += size)
+                    compressor->compress(points->data() + pos);
+                encoder.done();
+                return out.str();
+            });
+        m_pending.push_back(task->get_future());
+        m_pool->add([task](){ (*task)(); });
+
+        // Don't let compressed chunks pile up.
+        while (m_pending.size() > (size_t)(2 * m_threads))
+            writeChunk();
+    }
+
+    // Write the oldest compressed chunk.
+    void writeChunk()
+    {
+        std::string chunk = m_pending.front().get();
+        m_pending.pop_front();
+        m_stream.write(chunk.data(), chunk.size());
+        m_chunkTable.push_back((uint32_t)chunk.size());
+    }
+
     std::ostream& m_stream;
     OutputStream m_outputStream;
     std::unique_ptr<Encoder> m_encoder;
@@ -178,12 +275,18 @@ private:
     std::streampos m_chunkInfoPos;
     std::streampos m_chunkOffset;
     std::vector<uint32_t> m_chunkTable;
+    bool m_started;
+    bool m_resumed;
+    int m_threads;
+    std::vector<char> m_chunkBuf;
+    std::deque<std::future<std::string>> m_pending;
+    std::unique_ptr<ThreadPool> m_pool;
 };
 
 
 LazPerfVlrCompressor::LazPerfVlrCompressor(std::ostream& stream,
-        const Schema& schema, uint32_t chunksize) :
-    m_impl(new LazPerfVlrCompressorImpl(stream, schema, chunksize))
+        const Schema& schema, uint32_t chunksize, int threads) :
+    m_impl(new LazPerfVlrCompressorImpl(stream, schema, chunksize, threads))
 {}
 
 
@@ -203,6 +306,13 @@ void LazPerfVlrCompressor::done()
 }
 
 
+void LazPerfVlrCompressor::resume(std::streamoff pointOffset,
+    const std::vector<uint32_t>& chunkTable)
+{
+    m_impl->resume(pointOffset, chunkTable);
+}
+
+
 class LazPerfVlrDecompressorImpl
 {
 public:
@@ -274,5 +384,134 @@ void LazPerfVlrDecompressor::decompress(char *outbuf)
     m_impl->decompress(outbuf);
 }
 
-} // namespace pdal
 
+class LazPerfVlrChunkDecompressorImpl
+{
+public:
+    LazPerfVlrChunkDecompressorImpl(const char *vlrData) : m_chunksize(0)
+    {
+        laszip::io::laz_vlr zipvlr(vlrData);
+        // A chunk size of all ones means chunks vary in size.
+        if (zipvlr.chunk_size != (std::numeric_limits<uint32_t>::max)())
+            m_chunksize = zipvlr.chunk_size;
+        m_schema = laszip::io::laz_vlr::to_schema(zipvlr);
+    }
+
+    size_t pointSize() const
+        { return (size_t)m_schema.size_in_bytes(); }
+
+    uint32_t chunkSize() const
+        { return m_chunksize; }
+
+    void decompress(std::vector<char>& inbuf, char *outbuf,
+        uint32_t count) const
+    {
+        Charbuf buf(inbuf);
+        std::istream in(&buf);
+        InputStream inputStream(in);
+        Decoder decoder(inputStream);
+        Decompressor::ptr decompressor =
+            laszip::factory::build_decompressor(decoder, m_schema);
+
+        const size_t size = pointSize();
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            decompressor->decompress(outbuf);
+            outbuf += size;
+        }
+    }
+
+    static std::vector<uint32_t> readChunkTable(std::istream& stream,
+        std::streamoff pointOffset, std::vector<uint32_t> *counts)
+    {
+        std::vector<uint32_t> sizes;
+
+        // The point data starts with the position of the chunk table.
+        // Writers that couldn't seek back leave it as -1.
+        stream.seekg(pointOffset);
+        ILeStream in(&stream);
+        int64_t tablePos;
+        in >> tablePos;
+        if (!stream || tablePos <= pointOffset)
+            return sizes;
+
+        stream.seekg(tablePos);
+        uint32_t version;
+        uint32_t count;
+        in >> version >> count;
+        if (!stream || version != 0)
+            return sizes;
+
+        InputStream inputStream(stream);
+        Decoder decoder(inputStream);
+        laszip::decompressors::integer decompressor(32, 2);
+        decoder.readInitBytes();
+        decompressor.init();
+
+        uint32_t countPredictor = 0;
+        uint32_t predictor = 0;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (counts)
+            {
+                countPredictor = (uint32_t)decompressor.decompress(decoder,
+                    countPredictor, 0);
+                counts->push_back(countPredictor);
+            }
+            predictor = (uint32_t)decompressor.decompress(decoder,
+                predictor, 1);
+            sizes.push_back(predictor);
+        }
+        stream.clear();
+        return sizes;
+    }
+
+private:
+    typedef laszip::io::__ifstream_wrapper<std::istream> InputStream;
+    typedef laszip::decoders::arithmetic<InputStream> Decoder;
+    typedef laszip::formats::dynamic_decompressor Decompressor;
+    typedef laszip::factory::record_schema Schema;
+
+    Schema m_schema;
+    uint32_t m_chunksize;
+};
+
+
+LazPerfVlrChunkDecompressor::LazPerfVlrChunkDecompressor(
+        const char *vlrData) :
+    m_impl(new LazPerfVlrChunkDecompressorImpl(vlrData))
+{}
+
+
+LazPerfVlrChunkDecompressor::~LazPerfVlrChunkDecompressor()
+{}
+
+
+size_t LazPerfVlrChunkDecompressor::pointSize() const
+{
+    return m_impl->pointSize();
+}
+
+
+uint32_t LazPerfVlrChunkDecompressor::chunkSize() const
+{
+    return m_impl->chunkSize();
+}
+
+
+void LazPerfVlrChunkDecompressor::decompress(std::vector<char>& inbuf,
+    char *outbuf, uint32_t count) const
+{
+    m_impl->decompress(inbuf, outbuf, count);
+}
+
+
+std::vector<uint32_t> LazPerfVlrChunkDecompressor::readChunkTable(
+    std::istream& stream, std::streamoff pointOffset,
+    std::vector<uint32_t> *counts)
+{
+    return LazPerfVlrChunkDecompressorImpl::readChunkTable(stream,
+        pointOffset, counts);
+}
+
+} // namespace pdal
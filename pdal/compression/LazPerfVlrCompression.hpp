@@ -34,6 +34,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include <pdal/util/OStream.hpp>
 
 namespace laszip
@@ -58,17 +59,27 @@ namespace pdal
 // The compressor uses the schema of the point data in order to compress
 // the point stream.  The schema is also stored in a VLR that isn't
 // handled as part of the compression process itself.
+// With more than one thread, whole chunks are buffered and compressed
+// on a pool of threads.  They're written in order, so the output is
+// the same as when compressing with a single thread.
 class LazPerfVlrCompressor
 {
     typedef laszip::factory::record_schema Schema;
 
 public:
     PDAL_DLL LazPerfVlrCompressor(std::ostream& stream, const Schema& schema,
-        uint32_t chunksize);
+        uint32_t chunksize, int threads = 1);
     PDAL_DLL ~LazPerfVlrCompressor();
 
     PDAL_DLL void compress(const char *inbuf);
     PDAL_DLL void done();
+    // Continue point data that was written before instead of starting
+    // new data.  The stream must be positioned after the last chunk that's
+    // kept, 'pointOffset' is the position of the start of the point data
+    // and 'chunkTable' holds the sizes of the chunks kept.  New points
+    // start a new chunk.
+    PDAL_DLL void resume(std::streamoff pointOffset,
+        const std::vector<uint32_t>& chunkTable);
 
 private:
     std::unique_ptr<LazPerfVlrCompressorImpl> m_impl;
@@ -91,5 +102,38 @@ private:
     std::unique_ptr<LazPerfVlrDecompressorImpl> m_impl;
 };
 
+
+class LazPerfVlrChunkDecompressorImpl;
+
+// Decompresses whole chunks of points that have been read into memory.
+// Since each chunk is compressed separately, a chunk can be decompressed
+// on any thread once its location is known from the chunk table.
+class LazPerfVlrChunkDecompressor
+{
+public:
+    PDAL_DLL LazPerfVlrChunkDecompressor(const char *vlrData);
+    PDAL_DLL ~LazPerfVlrChunkDecompressor();
+
+    PDAL_DLL size_t pointSize() const;
+    // Number of points in each chunk but the last.  Zero if chunks vary
+    // in size.
+    PDAL_DLL uint32_t chunkSize() const;
+    // Decompress 'count' points from a compressed chunk.  Safe to call
+    // from several threads at once.
+    PDAL_DLL void decompress(std::vector<char>& inbuf, char *outbuf,
+        uint32_t count) const;
+
+    // Read the sizes, in bytes, of the compressed chunks from the chunk
+    // table.  Returns an empty list if the data has no chunk table.  The
+    // table of data with chunks that vary in size also holds the number of
+    // points in each chunk, which is stored in 'counts' if provided.
+    PDAL_DLL static std::vector<uint32_t> readChunkTable(
+        std::istream& stream, std::streamoff pointOffset,
+        std::vector<uint32_t> *counts = nullptr);
+
+private:
+    std::unique_ptr<LazPerfVlrChunkDecompressorImpl> m_impl;
+};
+
 } // namespace pdal
 
@@ -35,10 +35,29 @@
 #include "ZstdCompression.hpp"
 
 #include <zstd.h>
+#include <zdict.h>
+
+// Compression parameters and dictionaries are set through the advanced
+// API, which is stable as of zstd 1.4.0.
+#if ZSTD_VERSION_NUMBER >= 10400
+#define PDAL_ZSTD_ADVANCED
+#endif
 
 namespace pdal
 {
 
+namespace
+{
+
+void check(size_t ret, const std::string& what)
+{
+    if (ZSTD_isError(ret))
+        throw compression_error(what + ": " + ZSTD_getErrorName(ret));
+}
+
+} // unnamed namespace
+
+
 class ZstdCompressorImpl
 {
 public:
@@ -47,10 +66,41 @@ public:
     char m_tmpbuf[CHUNKSIZE];
     BlockCb m_cb;
 
-    ZstdCompressorImpl(BlockCb cb, int compressionLevel) : m_cb(cb)
+    ZstdCompressorImpl(BlockCb cb, const CompressionOptions& opts) : m_cb(cb)
     {
+        const int level = opts.level ? opts.level : 15;
         m_strm = ZSTD_createCStream();
-        ZSTD_initCStream(m_strm, compressionLevel);
+#ifdef PDAL_ZSTD_ADVANCED
+        try
+        {
+            check(ZSTD_CCtx_setParameter(m_strm, ZSTD_c_compressionLevel,
+                level), "Invalid zstd compression level");
+            if (opts.threads > 0)
+                check(ZSTD_CCtx_setParameter(m_strm, ZSTD_c_nbWorkers,
+                    opts.threads), "Can't use zstd worker threads");
+            if (opts.longDistance)
+                check(ZSTD_CCtx_setParameter(m_strm,
+                    ZSTD_c_enableLongDistanceMatching, 1),
+                    "Can't use zstd long distance matching");
+            if (opts.dictionary.size())
+                check(ZSTD_CCtx_loadDictionary(m_strm,
+                    opts.dictionary.data(), opts.dictionary.size()),
+                    "Invalid zstd dictionary");
+        }
+        catch (...)
+        {
+            ZSTD_freeCStream(m_strm);
+            throw;
+        }
+#else
+        if (opts.threads > 0 || opts.longDistance || opts.dictionary.size())
+        {
+            ZSTD_freeCStream(m_strm);
+            throw compression_error("Zstd 1.4.0 or later is required for "
+                "worker threads, long distance matching and dictionaries.");
+        }
+        ZSTD_initCStream(m_strm, level);
+#endif
     }
 
     ~ZstdCompressorImpl()
@@ -67,7 +117,12 @@ public:
         {
             ZSTD_outBuffer outBuf
             { reinterpret_cast<void *>(m_tmpbuf), CHUNKSIZE, 0 };
+#ifdef PDAL_ZSTD_ADVANCED
+            ret = ZSTD_compressStream2(m_strm, &outBuf, &m_inBuf,
+                ZSTD_e_continue);
+#else
             ret = ZSTD_compressStream(m_strm, &outBuf, &m_inBuf);
+#endif
             if (ZSTD_isError(ret))
                 break;
             if (outBuf.pos)
@@ -82,7 +137,12 @@ public:
         {
             ZSTD_outBuffer outBuf
                 { reinterpret_cast<void *>(m_tmpbuf), CHUNKSIZE, 0 };
+#ifdef PDAL_ZSTD_ADVANCED
+            ZSTD_inBuffer inBuf { nullptr, 0, 0 };
+            ret = ZSTD_compressStream2(m_strm, &outBuf, &inBuf, ZSTD_e_end);
+#else
             ret = ZSTD_endStream(m_strm, &outBuf);
+#endif
             if (ZSTD_isError(ret))
                 break;
             if (outBuf.pos)
@@ -92,12 +152,20 @@ public:
 };
 
 ZstdCompressor::ZstdCompressor(BlockCb cb) :
-    m_impl(new ZstdCompressorImpl(cb, 15))
+    m_impl(new ZstdCompressorImpl(cb, CompressionOptions()))
 {}
 
 
-ZstdCompressor::ZstdCompressor(BlockCb cb, int compressionLevel) :
-    m_impl(new ZstdCompressorImpl(cb, compressionLevel))
+ZstdCompressor::ZstdCompressor(BlockCb cb, int compressionLevel)
+{
+    CompressionOptions opts;
+    opts.level = compressionLevel;
+    m_impl.reset(new ZstdCompressorImpl(cb, opts));
+}
+
+
+ZstdCompressor::ZstdCompressor(BlockCb cb, const CompressionOptions& opts) :
+    m_impl(new ZstdCompressorImpl(cb, opts))
 {}
 
 
@@ -120,10 +188,30 @@ void ZstdCompressor::done()
 class ZstdDecompressorImpl
 {
 public:
-    ZstdDecompressorImpl(BlockCb cb) : m_cb(cb)
+    ZstdDecompressorImpl(BlockCb cb, const std::vector<char>& dictionary) :
+        m_cb(cb)
     {
         m_strm = ZSTD_createDStream();
+#ifdef PDAL_ZSTD_ADVANCED
+        if (dictionary.size())
+        {
+            size_t ret = ZSTD_DCtx_loadDictionary(m_strm, dictionary.data(),
+                dictionary.size());
+            if (ZSTD_isError(ret))
+            {
+                ZSTD_freeDStream(m_strm);
+                check(ret, "Invalid zstd dictionary");
+            }
+        }
+#else
+        if (dictionary.size())
+        {
+            ZSTD_freeDStream(m_strm);
+            throw compression_error("Zstd 1.4.0 or later is required "
+                "for dictionaries.");
+        }
         ZSTD_initDStream(m_strm);
+#endif
     }
 
     ~ZstdDecompressorImpl()
@@ -159,7 +247,13 @@ private:
 };
 
 ZstdDecompressor::ZstdDecompressor(BlockCb cb) :
-    m_impl(new ZstdDecompressorImpl(cb))
+    m_impl(new ZstdDecompressorImpl(cb, std::vector<char>()))
+{}
+
+
+ZstdDecompressor::ZstdDecompressor(BlockCb cb,
+        const std::vector<char>& dictionary) :
+    m_impl(new ZstdDecompressorImpl(cb, dictionary))
 {}
 
 
@@ -172,4 +266,26 @@ void ZstdDecompressor::decompress(const char *buf, size_t bufsize)
     m_impl->decompress(buf, bufsize);
 }
 
+
+std::vector<char> trainZstdDictionary(
+    const std::vector<std::vector<char>>& samples, size_t maxSize)
+{
+    std::vector<char> buf;
+    std::vector<size_t> sizes;
+    for (const std::vector<char>& sample : samples)
+    {
+        buf.insert(buf.end(), sample.begin(), sample.end());
+        sizes.push_back(sample.size());
+    }
+
+    std::vector<char> dictionary(maxSize);
+    size_t size = ZDICT_trainFromBuffer(dictionary.data(), dictionary.size(),
+        buf.data(), sizes.data(), (unsigned)sizes.size());
+    if (ZDICT_isError(size))
+        throw compression_error(std::string("Can't train zstd "
+            "dictionary: ") + ZDICT_getErrorName(size));
+    dictionary.resize(size);
+    return dictionary;
+}
+
 } // namespace pdal
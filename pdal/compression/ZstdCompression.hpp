@@ -45,6 +45,7 @@ class ZstdCompressor : public Compressor
 public:
     PDAL_DLL ZstdCompressor(BlockCb cb);
     PDAL_DLL ZstdCompressor(BlockCb cb, int compressionLevel);
+    PDAL_DLL ZstdCompressor(BlockCb cb, const CompressionOptions& opts);
     PDAL_DLL ~ZstdCompressor();
 
     PDAL_DLL void compress(const char *buf, size_t bufsize);
@@ -60,6 +61,8 @@ class ZstdDecompressor : public Decompressor
 {
 public:
     PDAL_DLL ZstdDecompressor(BlockCb cb);
+    PDAL_DLL ZstdDecompressor(BlockCb cb,
+        const std::vector<char>& dictionary);
     PDAL_DLL ~ZstdDecompressor();
 
     PDAL_DLL void decompress(const char *buf, size_t bufsize);
@@ -70,5 +73,17 @@ private:
     std::unique_ptr<ZstdDecompressorImpl> m_impl;
 };
 
+/**
+  Train a dictionary for compressing many small buffers of similar data,
+  such as the points of tiles or patches.
+
+  \param samples  Typical buffers to be compressed.
+  \param maxSize  Maximum size of the dictionary in bytes.
+  \return  Dictionary to pass in CompressionOptions and to the
+    decompressor.
+*/
+PDAL_DLL std::vector<char> trainZstdDictionary(
+    const std::vector<std::vector<char>>& samples, size_t maxSize);
+
 } // namespace pdal
 
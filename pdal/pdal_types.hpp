@@ -123,6 +123,16 @@ struct XForm
     double toScaled(double val) const
         { return (val - m_offset.m_val) / m_scale.m_val; }
 
+    double fromScaled(double val) const
+        { return val * m_scale.m_val + m_offset.m_val; }
+
+    // Determine if two transforms scale values the same way.
+    bool sameAs(const XForm& other) const
+    {
+        return m_scale.m_val == other.m_scale.m_val &&
+            m_offset.m_val == other.m_offset.m_val;
+    }
+
     bool nonstandard() const
     {
         return m_scale.m_auto || m_offset.m_auto ||
@@ -0,0 +1,350 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "MultipartOStream.hpp"
+
+#include <algorithm>
+
+#include <pdal/util/ThreadPool.hpp>
+
+namespace pdal
+{
+
+// Part 1 is held in m_first.  Later parts are filled in m_cur and handed
+// to the thread pool when full.  The put area is over one of the two
+// buffers.
+class MultipartOStream::Buf : public std::streambuf
+{
+public:
+    Buf(std::unique_ptr<MultipartTarget> target, size_t partSize,
+            size_t threads) :
+        m_target(std::move(target)), m_partSize(partSize), m_threads(threads),
+        m_first(partSize), m_firstSize(0), m_curSize(0), m_curBase(0),
+        m_curNum(1), m_inFirst(true), m_started(false), m_closed(false)
+    {
+        if (m_partSize == 0)
+            throw pdal_error("Invalid upload part size of 0.");
+        setp(m_first.data(), m_first.data() + m_partSize);
+    }
+
+    ~Buf()
+    {
+        if (m_pool)
+            m_pool->join();
+    }
+
+    void close();
+
+protected:
+    virtual int_type overflow(int_type c);
+    virtual pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+        std::ios_base::openmode which);
+    virtual pos_type seekpos(pos_type pos, std::ios_base::openmode which);
+
+private:
+    void mark();
+    uint64_t size() const;
+    bool activate(uint64_t pos);
+    void sendPart();
+    void submit(int partNum, std::vector<char>&& data);
+
+    std::unique_ptr<MultipartTarget> m_target;
+    size_t m_partSize;
+    size_t m_threads;
+    std::unique_ptr<ThreadPool> m_pool;
+    std::vector<char> m_first;
+    size_t m_firstSize;
+    std::vector<char> m_cur;
+    size_t m_curSize;
+    uint64_t m_curBase;
+    int m_curNum;  // Part number of m_cur.  1 if there is no m_cur yet.
+    bool m_inFirst;
+    bool m_started;
+    bool m_closed;
+    // Parts kept for a target that takes all of the data at once.
+    std::vector<std::vector<char>> m_held;
+    std::mutex m_mutex;
+    std::vector<std::string> m_errors;
+};
+
+
+// Note how much of the active buffer has been written.  Writes after a
+// seek backward don't shrink it.
+void MultipartOStream::Buf::mark()
+{
+    size_t pos = pptr() - pbase();
+    if (m_inFirst)
+        m_firstSize = (std::max)(m_firstSize, pos);
+    else
+        m_curSize = (std::max)(m_curSize, pos);
+}
+
+
+uint64_t MultipartOStream::Buf::size() const
+{
+    return m_curNum == 1 ? m_firstSize : m_curBase + m_curSize;
+}
+
+
+// Point the put area at 'pos'.  Only written positions in the first part
+// and the current part are available.
+bool MultipartOStream::Buf::activate(uint64_t pos)
+{
+    if (m_closed)
+        return false;
+    if (m_curNum > 1 && pos >= m_curBase && pos <= m_curBase + m_curSize)
+    {
+        m_inFirst = false;
+        setp(m_cur.data(), m_cur.data() + m_partSize);
+        pbump((int)(pos - m_curBase));
+        return true;
+    }
+    if (pos <= m_firstSize)
+    {
+        m_inFirst = true;
+        setp(m_first.data(), m_first.data() + m_partSize);
+        pbump((int)pos);
+        return true;
+    }
+    return false;
+}
+
+
+MultipartOStream::Buf::int_type MultipartOStream::Buf::overflow(int_type c)
+{
+    if (m_closed)
+        return traits_type::eof();
+
+    mark();
+    if (m_inFirst)
+    {
+        // Moving past the end of the first part.  Continue in the second
+        // part, which must not have been sent.
+        if (m_curNum == 1)
+        {
+            m_cur.resize(m_partSize);
+            m_curSize = 0;
+            m_curBase = m_partSize;
+            m_curNum = 2;
+        }
+        else if (m_curNum != 2)
+            return traits_type::eof();
+        m_inFirst = false;
+        setp(m_cur.data(), m_cur.data() + m_partSize);
+    }
+    else
+    {
+        try
+        {
+            sendPart();
+        }
+        catch (const std::exception& err)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_errors.push_back(err.what());
+            return traits_type::eof();
+        }
+    }
+
+    if (!traits_type::eq_int_type(c, traits_type::eof()))
+    {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+
+MultipartOStream::Buf::pos_type MultipartOStream::Buf::seekoff(off_type off,
+    std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+    mark();
+
+    off_type base = 0;
+    if (dir == std::ios_base::cur)
+        base = (m_inFirst ? 0 : m_curBase) + (pptr() - pbase());
+    else if (dir == std::ios_base::end)
+        base = size();
+    return seekpos(base + off, which);
+}
+
+
+MultipartOStream::Buf::pos_type MultipartOStream::Buf::seekpos(pos_type pos,
+    std::ios_base::openmode which)
+{
+    mark();
+    if (!(which & std::ios_base::out) || off_type(pos) < 0 ||
+            !activate((uint64_t)off_type(pos)))
+        return pos_type(off_type(-1));
+    return pos;
+}
+
+
+// Hand off the full current part and start the next one.
+void MultipartOStream::Buf::sendPart()
+{
+    m_cur.resize(m_curSize);
+    if (m_target->multipart())
+        submit(m_curNum, std::move(m_cur));
+    else
+        m_held.push_back(std::move(m_cur));
+
+    m_cur.resize(m_partSize);
+    m_curSize = 0;
+    m_curBase += m_partSize;
+    m_curNum++;
+    setp(m_cur.data(), m_cur.data() + m_partSize);
+}
+
+
+void MultipartOStream::Buf::submit(int partNum, std::vector<char>&& data)
+{
+    if (!m_started)
+    {
+        m_target->start();
+        m_started = true;
+        m_pool.reset(new ThreadPool(m_threads, m_threads));
+    }
+
+    // The pool's queue is bounded, so this blocks while enough parts are
+    // already waiting to be uploaded.
+    std::shared_ptr<std::vector<char>> part(
+        new std::vector<char>(std::move(data)));
+    m_pool->add([this, partNum, part]()
+    {
+        try
+        {
+            m_target->putPart(partNum, *part);
+        }
+        catch (const std::exception& err)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_errors.push_back(err.what());
+        }
+    });
+}
+
+
+void MultipartOStream::Buf::close()
+{
+    if (m_closed)
+        return;
+    mark();
+    m_closed = true;
+    setp(nullptr, nullptr);
+
+    try
+    {
+        if (m_started)
+        {
+            // Part 1 is sent last since it may have been rewritten.
+            int numParts = m_curNum - 1;
+            if (m_curSize)
+            {
+                m_cur.resize(m_curSize);
+                submit(m_curNum, std::move(m_cur));
+                numParts = m_curNum;
+            }
+            m_first.resize(m_firstSize);
+            submit(1, std::move(m_first));
+            m_pool->await();
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_errors.size())
+                throw pdal_error(m_errors.front());
+            m_target->complete(numParts);
+        }
+        else
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_errors.size())
+                    throw pdal_error(m_errors.front());
+            }
+            std::vector<char> data(std::move(m_first));
+            data.resize(m_firstSize);
+            for (const std::vector<char>& part : m_held)
+                data.insert(data.end(), part.begin(), part.end());
+            if (m_curNum > 1)
+                data.insert(data.end(), m_cur.begin(),
+                    m_cur.begin() + m_curSize);
+            m_target->put(data);
+        }
+    }
+    catch (const pdal_error&)
+    {
+        throw;
+    }
+    catch (const std::exception& err)
+    {
+        throw pdal_error(err.what());
+    }
+}
+
+
+MultipartOStream::MultipartOStream(std::unique_ptr<MultipartTarget> target,
+        size_t partSize, size_t threads) :
+    std::ostream(nullptr),
+    m_buf(new Buf(std::move(target), partSize, threads))
+{
+    rdbuf(m_buf.get());
+}
+
+
+MultipartOStream::~MultipartOStream()
+{
+    // Errors can only be reported by calling close() explicitly.
+    try
+    {
+        close();
+    }
+    catch (...)
+    {}
+}
+
+
+void MultipartOStream::close()
+{
+    try
+    {
+        m_buf->close();
+    }
+    catch (...)
+    {
+        setstate(std::ios::badbit);
+        throw;
+    }
+}
+
+} // namespace pdal
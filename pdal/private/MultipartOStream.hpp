@@ -0,0 +1,105 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <pdal/pdal_internal.hpp>
+
+namespace pdal
+{
+
+class ThreadPool;
+
+/**
+  Destination of a MultipartOStream.
+*/
+class PDAL_DLL MultipartTarget
+{
+public:
+    virtual ~MultipartTarget()
+    {}
+
+    /// Whether the destination accepts data in separate parts.
+    virtual bool multipart() const = 0;
+    /// Store all of the data at once.
+    virtual void put(const std::vector<char>& data) = 0;
+    /// Begin a multipart upload.
+    virtual void start() = 0;
+    /// Store part \a partNum (numbered from 1).  Called from several
+    /// threads at once and in no particular order.
+    virtual void putPart(int partNum, const std::vector<char>& data) = 0;
+    /// Finish a multipart upload of \a numParts parts.
+    virtual void complete(int numParts) = 0;
+};
+
+
+/**
+  Output stream that uploads its data in parts on background threads as it
+  is written.  The first part is kept until the stream is closed so that
+  a writer can seek back and rewrite a file header.  Seeking into other
+  parts fails once they've been handed off for upload.
+
+  A target that doesn't accept parts gets all of the data in one piece
+  when the stream is closed.
+*/
+class PDAL_DLL MultipartOStream : public std::ostream
+{
+public:
+    MultipartOStream(std::unique_ptr<MultipartTarget> target,
+        size_t partSize = DefaultPartSize, size_t threads = 4);
+    ~MultipartOStream();
+
+    /**
+      Upload any remaining data and finish the upload.  Does nothing if the
+      stream is already closed.
+
+      \throws pdal_error  If the data couldn't be uploaded.
+    */
+    void close();
+
+    static const size_t DefaultPartSize = 8 * 1024 * 1024;
+
+private:
+    class Buf;
+
+    std::unique_ptr<Buf> m_buf;
+};
+
+} // namespace pdal
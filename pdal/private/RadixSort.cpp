@@ -0,0 +1,164 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "RadixSort.hpp"
+
+#include <array>
+#include <cstring>
+
+#include <pdal/util/ThreadPool.hpp>
+
+namespace pdal
+{
+
+namespace
+{
+
+const std::size_t ChunkSize = 1 << 16;
+
+typedef std::array<std::size_t, 256> Histogram;
+
+} // unnamed namespace
+
+void radixSort(std::vector<uint64_t>& keys, std::vector<PointId>& ids,
+    int keyBytes)
+{
+    const std::size_t n = keys.size();
+    if (n < 2)
+        return;
+
+    const std::size_t numChunks = (n + ChunkSize - 1) / ChunkSize;
+    std::vector<Histogram> counts(numChunks);
+    std::vector<uint64_t> tmpKeys(n);
+    std::vector<PointId> tmpIds(n);
+
+    for (int shift = 0; shift < keyBytes * 8; shift += 8)
+    {
+        parallelFor(numChunks, [&]()
+        {
+            return [&](std::size_t c)
+            {
+                Histogram& h = counts[c];
+                h.fill(0);
+                std::size_t end = (std::min)((c + 1) * ChunkSize, n);
+                for (std::size_t i = c * ChunkSize; i < end; ++i)
+                    h[(keys[i] >> shift) & 0xFF]++;
+            };
+        }, 1);
+
+        // Turn the counts into the position at which each chunk writes its
+        // first key of each byte value.
+        std::size_t pos = 0;
+        bool sorted = false;
+        for (std::size_t b = 0; b < 256; ++b)
+        {
+            std::size_t start = pos;
+            for (Histogram& h : counts)
+            {
+                std::size_t count = h[b];
+                h[b] = pos;
+                pos += count;
+            }
+            if (pos - start == n)
+                sorted = true;
+        }
+        if (sorted)
+            continue;
+
+        parallelFor(numChunks, [&]()
+        {
+            return [&](std::size_t c)
+            {
+                Histogram& h = counts[c];
+                std::size_t end = (std::min)((c + 1) * ChunkSize, n);
+                for (std::size_t i = c * ChunkSize; i < end; ++i)
+                {
+                    std::size_t& dest = h[(keys[i] >> shift) & 0xFF];
+                    tmpKeys[dest] = keys[i];
+                    tmpIds[dest] = ids[i];
+                    dest++;
+                }
+            };
+        }, 1);
+        keys.swap(tmpKeys);
+        ids.swap(tmpIds);
+    }
+}
+
+SortKey::SortKey(Dimension::Id dim, Dimension::Type type, bool descending) :
+    m_dim(dim), m_type(type), m_bytes((int)Dimension::size(type)),
+    m_mask(m_bytes == 8 ? ~0ull : (1ull << (m_bytes * 8)) - 1),
+    m_descending(descending)
+{}
+
+// Signed values are offset by half their range.  The sign bit of a
+// floating-point value is set for positive values, and all the bits are
+// flipped for negative values, which sort in reverse order of magnitude.
+uint64_t SortKey::operator()(const PointRef& point) const
+{
+    uint64_t key(0);
+    const uint64_t signBit = 1ull << (m_bytes * 8 - 1);
+    switch (Dimension::base(m_type))
+    {
+    case Dimension::BaseType::Signed:
+        key = (uint64_t)point.getFieldAs<int64_t>(m_dim) ^ signBit;
+        break;
+    case Dimension::BaseType::Unsigned:
+        key = point.getFieldAs<uint64_t>(m_dim);
+        break;
+    case Dimension::BaseType::Floating:
+        if (m_bytes == 4)
+        {
+            // Add zero to make -0 the same as 0.
+            float f = point.getFieldAs<float>(m_dim) + 0.0f;
+            uint32_t bits;
+            memcpy(&bits, &f, sizeof(bits));
+            key = bits;
+        }
+        else
+        {
+            double d = point.getFieldAs<double>(m_dim) + 0.0;
+            memcpy(&key, &d, sizeof(key));
+        }
+        key = (key & signBit) ? ~key : (key | signBit);
+        break;
+    default:
+        break;
+    }
+    if (m_descending)
+        key = ~key;
+    return key & m_mask;
+}
+
+} // namespace pdal
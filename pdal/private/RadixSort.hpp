@@ -0,0 +1,89 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <pdal/Dimension.hpp>
+#include <pdal/PointRef.hpp>
+#include <pdal/pdal_types.hpp>
+
+namespace pdal
+{
+
+/**
+  Stable LSD radix sort of point IDs by unsigned keys, a byte at a time.
+  Large inputs are split into chunks that are counted and scattered on
+  several threads.  Bytes that are the same for every key are skipped.
+
+  \param keys  Key of each entry of \ref ids.  Reordered with the IDs.
+  \param ids  IDs to sort.
+  \param keyBytes  Number of low-order bytes of the keys that can be
+    non-zero.
+*/
+PDAL_DLL void radixSort(std::vector<uint64_t>& keys,
+    std::vector<PointId>& ids, int keyBytes = 8);
+
+/**
+  Maps the values of a dimension to unsigned keys with the same order,
+  for use with \ref radixSort().
+*/
+class PDAL_DLL SortKey
+{
+public:
+    /**
+      \param dim  Dimension of the values.
+      \param type  Type of the dimension.
+      \param descending  Whether larger values should have smaller keys.
+    */
+    SortKey(Dimension::Id dim, Dimension::Type type, bool descending);
+
+    /// Number of low-order bytes of the keys that can be non-zero.
+    int bytes() const
+        { return m_bytes; }
+
+    /// Key of the dimension's value for a point.
+    uint64_t operator()(const PointRef& point) const;
+
+private:
+    Dimension::Id m_dim;
+    Dimension::Type m_type;
+    int m_bytes;
+    uint64_t m_mask;
+    bool m_descending;
+};
+
+} // namespace pdal
@@ -0,0 +1,300 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "RemoteCache.hpp"
+
+#include <algorithm>
+#include <sstream>
+
+#include <pdal/pdal_features.hpp>  // PDAL_ARBITER_ENABLED
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/Utils.hpp>
+
+#ifdef PDAL_ARBITER_ENABLED
+    #include <arbiter/arbiter.hpp>
+#endif
+
+namespace pdal
+{
+
+namespace
+{
+
+std::string hashOf(const std::vector<char>& data)
+{
+#ifdef PDAL_ARBITER_ENABLED
+    return arbiter::crypto::encodeAsHex(arbiter::crypto::sha256(data));
+#else
+    return std::string();
+#endif
+}
+
+std::string hashOf(const std::string& s)
+{
+    return hashOf(std::vector<char>(s.begin(), s.end()));
+}
+
+} // unnamed namespace
+
+
+RemoteCache::RemoteCache(const std::string& dir, uintmax_t maxSize) :
+    m_dir(FileUtils::toAbsolutePath(dir)), m_maxSize(maxSize), m_hits(0),
+    m_misses(0)
+{
+    FileUtils::createDirectories(FileUtils::toAbsolutePath("objects", m_dir));
+    FileUtils::createDirectories(FileUtils::toAbsolutePath("index", m_dir));
+}
+
+
+RemoteCache *RemoteCache::instance()
+{
+    static std::unique_ptr<RemoteCache> cache;
+    static std::once_flag flag;
+
+    std::call_once(flag, []()
+    {
+        std::string dir;
+        if (Utils::getenv("PDAL_REMOTE_CACHE", dir) != 0 || dir.empty())
+            return;
+
+        uintmax_t megabytes = 10240;
+        std::string size;
+        if (Utils::getenv("PDAL_REMOTE_CACHE_SIZE", size) == 0 &&
+                !Utils::fromString(size, megabytes))
+            throw pdal_error("Invalid PDAL_REMOTE_CACHE_SIZE '" + size +
+                "'.  Must be a number of megabytes.");
+        try
+        {
+            cache.reset(new RemoteCache(dir, megabytes * 1024 * 1024));
+        }
+        catch (const std::exception& err)
+        {
+            throw pdal_error("Unable to create remote file cache in '" +
+                dir + "': " + err.what());
+        }
+    });
+    return cache.get();
+}
+
+
+std::string RemoteCache::indexFile(const std::string& path) const
+{
+    return FileUtils::toAbsolutePath("index/" + hashOf(path), m_dir);
+}
+
+
+std::string RemoteCache::objectFile(const std::string& hash) const
+{
+    return FileUtils::toAbsolutePath("objects/" + hash, m_dir);
+}
+
+
+std::string RemoteCache::fetch(const std::string& path)
+{
+#ifdef PDAL_ARBITER_ENABLED
+    // A second request for a path waits for the first to finish so that
+    // the file is only downloaded once.
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_activeCv.wait(lock, [this, &path]()
+            { return m_active.find(path) == m_active.end(); });
+        m_active.insert(path);
+    }
+
+    // Release the path however we leave.
+    struct Release
+    {
+        Release(RemoteCache& cache, const std::string& path) :
+            m_cache(cache), m_path(path)
+        {}
+        ~Release()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_cache.m_mutex);
+                m_cache.m_active.erase(m_path);
+            }
+            m_cache.m_activeCv.notify_all();
+        }
+
+        RemoteCache& m_cache;
+        const std::string& m_path;
+    } release(*this, path);
+
+    const std::string valid = validator(path);
+    const std::string index = indexFile(path);
+
+    // An index entry holds the path, its validator and the object hash,
+    // one per line.
+    if (valid.size() && FileUtils::fileExists(index))
+    {
+        std::istringstream in(FileUtils::readFileIntoString(index));
+        std::string cachedPath;
+        std::string cachedValid;
+        std::string hash;
+        std::getline(in, cachedPath);
+        std::getline(in, cachedValid);
+        std::getline(in, hash);
+
+        const std::string object = objectFile(hash);
+        if (cachedPath == path && cachedValid == valid && hash.size() &&
+            FileUtils::touchFile(object))
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_hits++;
+            return object;
+        }
+    }
+
+    std::vector<char> data = arbiter::Arbiter().getBinary(path);
+    const std::string hash = hashOf(data);
+    const std::string object = objectFile(hash);
+    if (!FileUtils::touchFile(object))
+        writeAtomic(object, data);
+    if (valid.size())
+    {
+        const std::string entry(path + "\n" + valid + "\n" + hash + "\n");
+        writeAtomic(index, std::vector<char>(entry.begin(), entry.end()));
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_misses++;
+    evict(object);
+    return object;
+#else
+    throw pdal_error("Arbiter is not enabled for this configuration!");
+#endif
+}
+
+
+// HTTP(S) servers identify a version of a file with its ETag (or at least
+// its modification time).  The other drivers sign their requests and
+// arbiter doesn't expose their response headers, so fall back to the size.
+std::string RemoteCache::validator(const std::string& path)
+{
+#ifdef PDAL_ARBITER_ENABLED
+    arbiter::Arbiter a;
+    const arbiter::Driver& driver = a.getDriver(path);
+    if (driver.type() == "http" || driver.type() == "https")
+    {
+        const arbiter::drivers::Http& http =
+            static_cast<const arbiter::drivers::Http&>(driver);
+        arbiter::http::Response res =
+            http.internalHead(arbiter::Arbiter::stripType(path));
+        if (res.ok())
+        {
+            std::string modified;
+            for (auto& h : res.headers())
+            {
+                if (Utils::iequals(h.first, "ETag"))
+                    return "etag:" + h.second;
+                if (Utils::iequals(h.first, "Last-Modified"))
+                    modified = "modified:" + h.second;
+            }
+            if (modified.size())
+                return modified;
+        }
+    }
+
+    std::unique_ptr<std::size_t> size = a.tryGetSize(path);
+    if (size)
+        return "size:" + std::to_string(*size);
+#endif
+    return std::string();
+}
+
+
+// Write to a temporary file and rename it into place so that other
+// processes sharing the cache never see a partial file.
+void RemoteCache::writeAtomic(const std::string& filename,
+    const std::vector<char>& data)
+{
+    const std::string tempFile = FileUtils::uniqueFilename(m_dir, "tmp");
+
+    std::ostream *out = FileUtils::createFile(tempFile, true);
+    if (!out)
+        throw pdal_error("Unable to create cache file '" + tempFile + "'.");
+    out->write(data.data(), data.size());
+    bool ok = out->good();
+    FileUtils::closeFile(out);
+    if (!ok)
+    {
+        FileUtils::deleteFile(tempFile);
+        throw pdal_error("Unable to write cache file '" + tempFile + "'.");
+    }
+    FileUtils::renameFile(filename, tempFile);
+}
+
+
+// Remove the least recently used objects until the cache fits in its
+// limit.  Index entries that refer to removed objects are left behind and
+// treated as misses.
+void RemoteCache::evict(const std::string& keep)
+{
+    struct Object
+    {
+        std::string filename;
+        int64_t time;
+        uintmax_t size;
+    };
+
+    const std::string keepName = FileUtils::getFilename(keep);
+    std::vector<Object> objects;
+    uintmax_t total = 0;
+    const std::string dir = FileUtils::toAbsolutePath("objects", m_dir);
+    for (const std::string& name : FileUtils::directoryList(dir))
+    {
+        if (FileUtils::isDirectory(name))
+            continue;
+        Object o { name, FileUtils::lastWriteTime(name),
+            FileUtils::fileSize(name) };
+        total += o.size;
+        if (FileUtils::getFilename(o.filename) != keepName)
+            objects.push_back(o);
+    }
+    if (total <= m_maxSize)
+        return;
+
+    std::sort(objects.begin(), objects.end(),
+        [](const Object& o1, const Object& o2)
+        { return o1.time < o2.time; });
+    for (const Object& o : objects)
+    {
+        if (total <= m_maxSize)
+            break;
+        if (FileUtils::deleteFile(o.filename))
+            total -= o.size;
+    }
+}
+
+} // namespace pdal
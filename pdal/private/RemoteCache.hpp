@@ -0,0 +1,108 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <pdal/pdal_internal.hpp>
+
+namespace pdal
+{
+
+/**
+  Local disk cache of remote files read through arbiter.
+
+  File contents are stored by their SHA-256 hash in \c objects/, so two
+  paths that hold the same data share one copy.  Each remote path has an
+  entry in \c index/ that records the object holding its data and the
+  validator (HTTP ETag, or size for drivers that don't expose one) seen
+  when it was downloaded.  A cached copy is used only while the remote
+  validator is unchanged.  The modification time of an object is its last
+  use, and the least recently used objects are removed when the cache
+  grows beyond its size limit.
+*/
+class PDAL_DLL RemoteCache
+{
+public:
+    RemoteCache(const std::string& dir, uintmax_t maxSize);
+
+    /**
+      Get the cache configured by the environment.  PDAL_REMOTE_CACHE
+      names the cache directory and PDAL_REMOTE_CACHE_SIZE its limit in
+      megabytes (default 10240).
+
+      \return  The cache, or nullptr if PDAL_REMOTE_CACHE is unset or empty.
+    */
+    static RemoteCache *instance();
+
+    /**
+      Get a local copy of a remote file, downloading it only if the cache
+      doesn't hold the current version.
+
+      \param path  Remote path.
+      \return  Path of the local copy.
+    */
+    std::string fetch(const std::string& path);
+
+    const std::string& directory() const
+        { return m_dir; }
+    size_t hits() const
+        { return m_hits; }
+    size_t misses() const
+        { return m_misses; }
+
+private:
+    std::string validator(const std::string& path);
+    std::string indexFile(const std::string& path) const;
+    std::string objectFile(const std::string& hash) const;
+    void writeAtomic(const std::string& filename,
+        const std::vector<char>& data);
+    void evict(const std::string& keep);
+
+    std::string m_dir;
+    uintmax_t m_maxSize;
+    size_t m_hits;
+    size_t m_misses;
+    std::mutex m_mutex;
+    std::set<std::string> m_active;
+    std::condition_variable m_activeCv;
+};
+
+} // namespace pdal
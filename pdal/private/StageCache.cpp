@@ -0,0 +1,237 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (hobu.inc@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include "StageCache.hpp"
+
+#include <pdal/util/FileUtils.hpp>
+
+namespace pdal
+{
+
+namespace
+{
+
+const uint32_t Magic = 0x31435350;  // "PSC1" in little-endian order.
+const uint8_t ViewTag = 1;
+const uint8_t EndTag = 0;
+const point_count_t ChunkPoints = 65536;
+
+template<typename T>
+void writeValue(std::ostream& out, T val)
+{
+    out.write(reinterpret_cast<const char *>(&val), sizeof(T));
+}
+
+void writeString(std::ostream& out, const std::string& s)
+{
+    writeValue<uint32_t>(out, (uint32_t)s.size());
+    out.write(s.data(), s.size());
+}
+
+template<typename T>
+T readValue(std::istream& in)
+{
+    T val {};
+    in.read(reinterpret_cast<char *>(&val), sizeof(T));
+    return val;
+}
+
+std::string readString(std::istream& in)
+{
+    std::string s(readValue<uint32_t>(in), '\0');
+    in.read(&s[0], s.size());
+    return s;
+}
+
+} // unnamed namespace
+
+
+namespace StageCache
+{
+
+std::string filename(const std::string& dir, const std::string& hash)
+{
+    return FileUtils::toAbsolutePath(hash + ".pdalcache", dir);
+}
+
+
+bool valid(const std::string& filename)
+{
+    std::ifstream in(filename, std::ios::binary);
+    return in && readValue<uint32_t>(in) == Magic;
+}
+
+} // namespace StageCache
+
+
+StageCacheReader::StageCacheReader(const std::string& filename) :
+    m_cacheFile(filename), m_dataPos(0)
+{}
+
+
+void StageCacheReader::addDimensions(PointLayoutPtr layout)
+{
+    std::ifstream in(m_cacheFile, std::ios::binary);
+    if (!in || readValue<uint32_t>(in) != Magic)
+        throwError("Unable to read cache file '" + m_cacheFile + "'.");
+
+    m_dims.resize(readValue<uint32_t>(in));
+    for (Dim& d : m_dims)
+    {
+        d.m_name = readString(in);
+        d.m_type = (Dimension::Type)readValue<uint32_t>(in);
+        d.m_id = layout->registerOrAssignDim(d.m_name, d.m_type);
+    }
+    if (!in)
+        throwError("Invalid header in cache file '" + m_cacheFile + "'.");
+    m_dataPos = in.tellg();
+}
+
+
+PointViewSet StageCacheReader::run(PointViewPtr view)
+{
+    PointViewSet views;
+
+    std::ifstream in(m_cacheFile, std::ios::binary);
+    in.seekg(m_dataPos);
+
+    std::vector<char> buf;
+    while (in && readValue<uint8_t>(in) == ViewTag)
+    {
+        PointViewPtr v = views.empty() ? view : view->makeNew();
+        const point_count_t count = readValue<uint64_t>(in);
+        const std::string wkt = readString(in);
+
+        for (const Dim& d : m_dims)
+        {
+            const size_t size = Dimension::size(d.m_type);
+            for (PointId idx = 0; idx < count; idx += ChunkPoints)
+            {
+                point_count_t n = (std::min)(ChunkPoints, count - idx);
+                buf.resize(n * size);
+                in.read(buf.data(), buf.size());
+                const char *pos = buf.data();
+                for (PointId i = idx; i < idx + n; ++i, pos += size)
+                    v->setField(d.m_id, d.m_type, i, pos);
+            }
+        }
+        v->setSpatialReference(SpatialReference(wkt));
+        views.insert(v);
+    }
+    if (!in)
+        throwError("Unexpected end of cache file '" + m_cacheFile + "'.");
+    return views;
+}
+
+
+StageCacheWriter::StageCacheWriter(const std::string& filename) :
+    m_cacheFile(filename)
+{}
+
+
+StageCacheWriter::~StageCacheWriter()
+{
+    // A file that was never completed is removed.
+    if (m_out.is_open())
+    {
+        m_out.close();
+        FileUtils::deleteFile(m_tempFile);
+    }
+}
+
+
+void StageCacheWriter::ready(PointTableRef table)
+{
+    const std::string dir = FileUtils::getDirectory(m_cacheFile);
+    m_tempFile = FileUtils::uniqueFilename(dir, "tmp");
+    m_out.open(m_tempFile, std::ios::binary | std::ios::trunc);
+    if (!m_out)
+        throwError("Unable to create cache file '" + m_tempFile + "'.");
+
+    PointLayoutPtr layout = table.layout();
+    m_dims = layout->dims();
+    writeValue(m_out, Magic);
+    writeValue<uint32_t>(m_out, (uint32_t)m_dims.size());
+    for (Dimension::Id id : m_dims)
+    {
+        writeString(m_out, layout->dimName(id));
+        writeValue<uint32_t>(m_out, (uint32_t)layout->dimType(id));
+    }
+}
+
+
+void StageCacheWriter::filter(PointView& view)
+{
+    PointLayoutPtr layout = view.layout();
+
+    writeValue(m_out, ViewTag);
+    writeValue<uint64_t>(m_out, view.size());
+    writeString(m_out, view.spatialReference().getWKT());
+
+    std::vector<char> buf;
+    for (Dimension::Id id : m_dims)
+    {
+        const Dimension::Type type = layout->dimType(id);
+        const size_t size = Dimension::size(type);
+        for (PointId idx = 0; idx < view.size(); idx += ChunkPoints)
+        {
+            point_count_t n = (std::min)(ChunkPoints, view.size() - idx);
+            buf.resize(n * size);
+            char *pos = buf.data();
+            for (PointId i = idx; i < idx + n; ++i, pos += size)
+                view.getField(pos, id, type, i);
+            m_out.write(buf.data(), buf.size());
+        }
+    }
+    if (!m_out)
+        throwError("Unable to write cache file '" + m_tempFile + "'.");
+}
+
+
+void StageCacheWriter::done(PointTableRef /*table*/)
+{
+    writeValue(m_out, EndTag);
+    m_out.close();
+    if (!m_out)
+    {
+        FileUtils::deleteFile(m_tempFile);
+        throwError("Unable to write cache file '" + m_tempFile + "'.");
+    }
+    FileUtils::renameFile(m_cacheFile, m_tempFile);
+    log()->get(LogLevel::Debug) << "Saved stage output to '" <<
+        m_cacheFile << "'." << std::endl;
+}
+
+} // namespace pdal
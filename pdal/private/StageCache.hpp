@@ -0,0 +1,132 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (hobu.inc@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <pdal/Filter.hpp>
+#include <pdal/Reader.hpp>
+
+namespace pdal
+{
+
+/**
+  Stages that save the output of a pipeline stage to a cache file and read
+  it back, so that a later run of the pipeline can start from the cached
+  points instead of rerunning the stages that made them.
+
+  A cache file holds the dimension names and types, followed by each point
+  view: its point count, its spatial reference and then the values of
+  each dimension for all of the view's points, one dimension after the
+  other.  Values are stored in the machine's byte order.  A file written
+  on a machine with a different byte order doesn't match the expected
+  magic number and is treated as missing.
+*/
+namespace StageCache
+{
+    /**
+      Get the name of the cache file for a stage output.
+
+      \param dir  Cache directory.
+      \param hash  Content hash of the stage.
+      \return  Name of the cache file.
+    */
+    std::string filename(const std::string& dir, const std::string& hash);
+
+    /**
+      Determine whether a complete cache file exists.
+
+      \param filename  Name of the cache file.
+      \return  Whether the file can be read.
+    */
+    bool valid(const std::string& filename);
+}
+
+/**
+  Reader that produces the point views saved in a cache file.
+*/
+class PDAL_DLL StageCacheReader : public Reader
+{
+public:
+    StageCacheReader(const std::string& filename);
+
+    std::string getName() const
+        { return "readers.stagecache"; }
+
+private:
+    struct Dim
+    {
+        std::string m_name;
+        Dimension::Type m_type;
+        Dimension::Id m_id;
+    };
+
+    virtual void addDimensions(PointLayoutPtr layout);
+    virtual PointViewSet run(PointViewPtr view);
+
+    std::string m_cacheFile;
+    std::vector<Dim> m_dims;
+    std::streampos m_dataPos;
+};
+
+/**
+  Filter that passes points through unchanged, saving each point view to
+  a cache file.  The file is written under a temporary name and renamed
+  into place once the last view has been saved.
+*/
+class PDAL_DLL StageCacheWriter : public Filter
+{
+public:
+    StageCacheWriter(const std::string& filename);
+    ~StageCacheWriter();
+
+    std::string getName() const
+        { return "filters.stagecache"; }
+
+private:
+    virtual void ready(PointTableRef table);
+    virtual void filter(PointView& view);
+    virtual void done(PointTableRef table);
+
+    std::string m_cacheFile;
+    std::string m_tempFile;
+    std::ofstream m_out;
+    Dimension::IdList m_dims;
+};
+
+} // namespace pdal
@@ -34,9 +34,14 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <exception>
 #include <memory>
+#include <mutex>
 
 #include <pdal/Stage.hpp>
+#include <pdal/util/ThreadPool.hpp>
+#include <pdal/util/Trace.hpp>
 
 namespace pdal
 {
@@ -45,20 +50,62 @@ class StageRunner
 {
 public:
     StageRunner(Stage *s, PointViewPtr view) :
-        m_stage(s), m_view(view)
+        m_stage(s), m_view(view), m_done(false)
     {}
 
-    // For now this is all synchronous
+    // Run the stage on the view in the current thread.
     void run()
-        { m_viewSet = m_stage->run(m_view); }
+    {
+        Trace::Span span("view", m_stage->getName());
+        m_viewSet = m_stage->run(m_view);
+        m_done = true;
+    }
 
+    // Run the stage on the view using a thread from the pool.  The pool
+    // must be waited on or joined before the runner is destroyed.
+    void run(ThreadPool& pool)
+    {
+        pool.add([this]()
+        {
+            // The waiting thread measures the wall time.
+            StageProfile::Timer timer(m_stage->m_profile, false);
+            Trace::Span span("view", m_stage->getName());
+            m_stage->startLogging();
+            try
+            {
+                m_viewSet = m_stage->run(m_view);
+            }
+            catch (...)
+            {
+                m_error = std::current_exception();
+            }
+            m_stage->stopLogging();
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_done = true;
+            m_cv.notify_all();
+        });
+    }
+
+    // Wait for the run to complete and return the resulting views.  Any
+    // exception thrown by the stage is rethrown here.
     PointViewSet wait()
-        { return m_viewSet; }
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this](){ return m_done; });
+        if (m_error)
+            std::rethrow_exception(m_error);
+        return m_viewSet;
+    }
 
 private:
     Stage *m_stage;
     PointViewPtr m_view;
     PointViewSet m_viewSet;
+    bool m_done;
+    std::exception_ptr m_error;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
 };
 typedef std::shared_ptr<StageRunner> StageRunnerPtr;
 
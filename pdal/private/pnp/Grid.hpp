@@ -28,6 +28,10 @@ public:
         { return m_cells[index(xpos, ypos)]; }
     T& cell(Pos pos)
         { return cell(pos.first, pos.second); }
+    const T& cell(size_t xpos, size_t ypos) const
+        { return m_cells[index(xpos, ypos)]; }
+    const T& cell(Pos pos) const
+        { return cell(pos.first, pos.second); }
 
     /**
       Convert external coordinates to a grid position.
@@ -36,7 +40,7 @@ public:
     */
 #pragma warning(push)
 #pragma warning(disable: 4244)
-    bool cellPos(double x, double y, Pos& pos)
+    bool cellPos(double x, double y, Pos& pos) const
     {
         x -= m_xOrigin;
         y -= m_yOrigin;
@@ -64,6 +68,19 @@ public:
     */
     Point origin() const
         { return { m_xOrigin, m_yOrigin }; }
+
+    /**
+      Return the number of cells in the X direction.
+    */
+    size_t width() const
+        { return m_width; }
+
+    /**
+      Return the number of cells in the Y direction.
+    */
+    size_t height() const
+        { return m_height; }
+
     /**
       Return the cell width.
     */
@@ -81,6 +98,6 @@ private:
     double m_xOrigin, m_yOrigin;
     std::vector<T> m_cells;
 
-    size_t index(size_t xpos, size_t ypos)
+    size_t index(size_t xpos, size_t ypos) const
         { return ypos * m_width + xpos; }
 };
@@ -0,0 +1,592 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <pdal/util/ThreadPool.hpp>
+
+#include "Comparison.hpp"
+#include "Grid.hpp"
+#include "VoxelRayTrace.hpp"
+
+namespace pdal
+{
+
+struct grid_error : public std::runtime_error
+{
+    grid_error(const std::string& s) : std::runtime_error(s)
+    {}
+};
+
+
+// Point-in-polygon engine.  The polygon is overlaid with a grid and the
+// status (inside or outside) of a reference point in each cell is
+// computed up front.  Cells without edges are wholly inside or outside.
+// Cells with edges are resolved by counting the edges crossed between the
+// test point and the cell's reference point.
+//
+// Any number of rings may be added.  A point is inside if it's inside an
+// odd number of rings, so the outer and inner rings of all the parts of
+// a multi-polygon can be handled by a single engine.
+//
+// The grid is built completely in the constructor, after which the
+// engine is never modified and may be used from many threads at once.
+class GridPnp
+{
+public:
+    using Point = std::pair<double, double>;
+    using Ring = std::vector<Point>;
+
+    // Initialize the point-in-poly engine by creating an overlay grid and
+    // attaching the index of each polygon edge to any cell it passes
+    // through.
+    // NOTE: This code does only minimal validation to try to make sure
+    //  that is won't hang.  Make sure your polygon is valid before
+    //  calling.  Make sure there are no self-intersections, for example.
+    GridPnp(const Ring& outer, const std::vector<Ring>& inners)
+    {
+        std::vector<Ring> rings;
+        rings.push_back(outer);
+        rings.insert(rings.end(), inners.begin(), inners.end());
+        init(rings);
+    }
+
+
+    GridPnp(const Ring& outer)
+    {
+        init(std::vector<Ring>(1, outer));
+    }
+
+
+    // Initialize with any number of rings, for example the exterior and
+    // interior rings of every polygon in a multipolygon.
+    GridPnp(const std::vector<Ring>& rings)
+    {
+        init(rings);
+    }
+
+    bool inside(const Point& p) const
+    { return inside(p.first, p.second); }
+
+    // Determine if a point is inside the polygon attached to this class.
+    bool inside(double x, double y) const
+    {
+        // Find the index of the grid cell at the position.
+        // If the position isn't in the grid, we're certainly outside.
+        XYIndex idx;
+        if (!m_grid->cellPos(x, y, idx))
+            return false;
+
+        // If there are no edges in the cell, the status of the cell is uniform,
+        // just return the state.
+        const Cell& cell = m_grid->cell(idx);
+        if (cell.m_count == 0)
+            return cell.m_inside;
+        return testCell(cell, x, y);
+    }
+
+    // Determine if each of 'count' points is inside the polygon.  Point i
+    // is at (x[i], y[i]) and its status is written to result[i].
+    void inside(const double *x, const double *y, size_t count,
+        std::vector<bool>& result) const
+    {
+        result.resize(count);
+        for (size_t i = 0; i < count; ++i)
+            result[i] = inside(x[i], y[i]);
+    }
+
+private:
+    using XYIndex = std::pair<size_t, size_t>;
+    using RingList = Ring; // Structure is the same.
+    using EdgeId = size_t;
+
+    // Grid cells with edges refer to a range of the packed edge arrays.
+    struct Cell
+    {
+        Cell() : m_first(0), m_count(0), m_inside(false)
+        {}
+
+        size_t m_first;
+        size_t m_count;
+        Point m_point;
+        bool m_inside;
+    };
+
+    class EdgeIt
+    {
+    public:
+        EdgeIt(const RingList& r) : m_points(r), m_id(0)
+        { skipInvalid(); }
+
+        void next()
+        {
+            m_id++;
+            skipInvalid();
+        }
+
+        EdgeId operator * () const
+        { return m_id; }
+
+        operator bool () const
+        { return m_id < m_points.size() - 1; }
+
+    private:
+        void skipInvalid()
+        {
+            while (m_id < m_points.size() - 1 &&
+                (std::isnan(m_points[m_id].first) ||
+                 std::isnan(m_points[m_id + 1].first) ||
+                 (m_points[m_id] == m_points[m_id + 1])))
+            {
+                m_id++;
+            }
+        }
+
+        const RingList& m_points;
+        size_t m_id;
+    };
+
+
+    const Point& point1(EdgeId id) const
+        { return m_rings[id]; }
+    const Point& point2(EdgeId id) const
+        { return m_rings[id + 1]; }
+    double xval(const Point& p) const
+        { return p.first; }
+    double yval(const Point& p) const
+        { return p.second; }
+
+    void init(const std::vector<Ring>& rings)
+    {
+        if (rings.empty())
+            throw grid_error("Invalid polygon. No rings provided.");
+        for (const Ring& r : rings)
+            validateRing(r);
+
+        calcBounds(rings);
+        fillRingList(rings);
+        setupGrid();
+    }
+
+    void validateRing(const Ring& r)
+    {
+        if (r.size() < 4)
+            throw grid_error("Invalid ring. Ring must consist of at least "
+                " four points.");
+        if (r[0] != r[r.size() - 1])
+            throw grid_error("Invalid ring. First point is not equal to "
+                "the last point.");
+    }
+
+    // Calculate the bounding box of the polygon.
+    void calcBounds(const std::vector<Ring>& rings)
+    {
+        // Inialize max/min with X/Y of first point.
+        const Point& p = rings[0][0];
+        m_xMin = xval(p);
+        m_xMax = xval(p);
+        m_yMin = yval(p);
+        m_yMax = yval(p);
+
+        // The first point is duplicated as the last, so we skip the last
+        // point when looping.
+        for (const Ring& r : rings)
+            for (size_t id = 0; id < r.size() - 1; ++id)
+            {
+                const Point& p1 = r[id];
+
+                m_xMin = (std::min)(m_xMin, xval(p1));
+                m_xMax = (std::max)(m_xMax, xval(p1));
+                m_yMin = (std::min)(m_yMin, yval(p1));
+                m_yMax = (std::max)(m_yMax, yval(p1));
+            }
+        if (m_xMin == m_xMax || m_yMin == m_yMax)
+            throw grid_error("Invalid polygon. Polygon has no area.");
+    }
+
+
+    void fillRingList(const std::vector<Ring>& rings)
+    {
+        double nan = std::numeric_limits<double>::quiet_NaN();
+
+        for (const Ring& r : rings)
+        {
+            // Nan is a separator between rings.
+            if (m_rings.size())
+                m_rings.push_back({nan, nan});
+            m_rings.insert(m_rings.end(), r.begin(), r.end());
+        }
+    }
+
+
+    void setupGrid()
+    {
+        double xAvgLen;
+        double yAvgLen;
+
+        calcAvgEdgeLen(xAvgLen, yAvgLen);
+        XYIndex gridSize = calcGridSize(xAvgLen, yAvgLen);
+        createGrid(gridSize);
+        assignEdges();
+        computeCells();
+    }
+
+
+    void calcAvgEdgeLen(double& xAvgLen, double& yAvgLen)
+    {
+        double xdist{0};
+        double ydist{0};
+        size_t numEdges{0};
+        for (EdgeIt it(m_rings); it; it.next())
+        {
+            const Point& p1 = point1(*it);
+            const Point& p2 = point2(*it);
+
+            // Sum the lengths of the X and Y components of the edges.
+            xdist += std::abs(xval(p2) - xval(p1));
+            ydist += std::abs(yval(p2) - yval(p1));
+            numEdges++;
+        }
+
+        // Find the average X and Y component length.
+        xAvgLen = xdist / numEdges;
+        yAvgLen = ydist / numEdges;
+    }
+
+    // The paper calculates an X and Y based on a) the number of edges
+    // and b) the relative length of edges in the X and Y direction.
+    // This seems fine, but it misses out on considering the common
+    // case where a polygon delineates some area of interest.  In this
+    // case there is much "empty" space in the interior of the polygon and
+    // it seems likely that most pnp tests will happen in the empty interior.
+    // So, it would seem that we'd want the grid sufficiently large to cover
+    // this case well.  That way, most pnp tests would take no work beyond
+    // an array lookup since most cells would be empty.  Lots of tradeoff,
+    // though, in preprocessing vs. actual pnp tests.  Hopefully more work
+    // can be done on this later.  My stupid way of dealing with this is
+    // to set a minimum grid size of 1000 cells.
+    XYIndex calcGridSize(double xAvgLen, double yAvgLen)
+    {
+        // I'm setting a minmum number of cells as 1000, because, why not?
+        // m_rings isn't necessarily an exact count of edges, but it's close
+        // enough for this purpose.
+        size_t m = (std::max)((size_t)1000, m_rings.size());
+
+        // See paper for this calc.
+        double scalex = ((m_xMax - m_xMin) * yAvgLen) /
+            ((m_yMax - m_yMin) * xAvgLen);
+        double scaley = 1 / scalex;
+        size_t mx = (size_t)std::sqrt(m * scalex);
+        size_t my = (size_t)std::sqrt(m * scaley);
+
+        // We always round up, because why not.
+        return XYIndex(mx + 1, my + 1);
+    }
+
+
+    // Figure out the grid origin.
+    void createGrid(XYIndex gridSize)
+    {
+        // Make the grid extend 1/2 cell beyond bounds box.
+        double boxWidth = m_xMax - m_xMin;
+        double boxHeight = m_yMax - m_yMin;
+        //
+        double cellWidth = boxWidth / (gridSize.first - 1);
+        double cellHeight = boxHeight / (gridSize.second - 1);
+        double xOrigin = m_xMin - (cellWidth / 2);
+        double yOrigin = m_yMin - (cellHeight / 2);
+
+        m_grid.reset(new Grid<Cell>(gridSize.first, gridSize.second,
+            cellWidth, cellHeight, xOrigin, yOrigin));
+    }
+
+
+    // Loop through edges.  Add the edge to each cell traversed.  The cells
+    // traversed by each edge are found in parallel.  The edges of each
+    // cell are then packed together in edge order so that the edges of
+    // a cell can be tested in one pass over contiguous memory.
+    void assignEdges()
+    {
+        std::vector<EdgeId> ids;
+        for (EdgeIt it(m_rings); it; it.next())
+            ids.push_back(*it);
+
+        std::vector<VoxelRayTrace::CellList> traversed(ids.size());
+        Point origin = m_grid->origin();
+        parallelFor(ids.size(), [&]()
+        {
+            return [&](size_t i)
+            {
+                const Point& p1 = point1(ids[i]);
+                const Point& p2 = point2(ids[i]);
+                VoxelRayTrace vrt(m_grid->cellWidth(), m_grid->cellHeight(),
+                    xval(origin), yval(origin),
+                    xval(p1), yval(p1), xval(p2), yval(p2));
+                traversed[i] = vrt.emit();
+            };
+        }, 4096);
+
+        // Count the edges in each cell and set each cell's range.
+        for (auto& cells : traversed)
+            for (auto& c : cells)
+                m_grid->cell(XYIndex(c.first, c.second)).m_count++;
+        size_t total = 0;
+        for (size_t y = 0; y < m_grid->height(); ++y)
+            for (size_t x = 0; x < m_grid->width(); ++x)
+            {
+                Cell& cell = m_grid->cell(x, y);
+                cell.m_first = total;
+                total += cell.m_count;
+                cell.m_count = 0;
+            }
+
+        m_edgeIds.resize(total);
+        m_x1.resize(total);
+        m_y1.resize(total);
+        m_x2.resize(total);
+        m_y2.resize(total);
+        for (size_t i = 0; i < ids.size(); ++i)
+        {
+            const Point& p1 = point1(ids[i]);
+            const Point& p2 = point2(ids[i]);
+            for (auto& c : traversed[i])
+            {
+                Cell& cell = m_grid->cell(XYIndex(c.first, c.second));
+                size_t pos = cell.m_first + cell.m_count++;
+                m_edgeIds[pos] = ids[i];
+                m_x1[pos] = xval(p1);
+                m_y1[pos] = yval(p1);
+                m_x2[pos] = xval(p2);
+                m_y2[pos] = yval(p2);
+            }
+        }
+    }
+
+
+    // Put a reference point in each cell and figure out if it's inside
+    // the polygon.  The status of a reference point depends only on the
+    // cell to its left, so rows are computed in parallel.  Each row has
+    // its own random generator, which makes the result independent of
+    // the number of threads.
+    void computeCells()
+    {
+        parallelFor(m_grid->height(), [this]()
+        {
+            return [this](size_t y)
+            {
+                std::mt19937 ranGen((std::mt19937::result_type)y);
+                for (size_t x = 0; x < m_grid->width(); ++x)
+                {
+                    XYIndex pos(x, y);
+                    generateRefPoint(pos, ranGen);
+                    determinePointStatus(pos);
+                }
+            };
+        }, 8);
+    }
+
+
+    // Determine if a point is collinear with an edge.
+    bool pointCollinear(double x, double y, size_t pos) const
+    {
+        double x1 = m_x1[pos];
+        double x2 = m_x2[pos];
+        double y1 = m_y1[pos];
+        double y2 = m_y2[pos];
+
+        // If p1 == p2, this will fail.
+
+        // This is the same as saying slopes are equal.
+        return Comparison::closeEnough((x - x2) * (y - y1),
+            (y - y2) * (x - x1));
+    }
+
+
+    // The paper uses point centers, but then has to deal with points that
+    // are "singular" (rest on a polygon edge).  But there's nothing special
+    // about the point center.  The center is just a point in a cell with
+    // a known status (inside or outside the polygon).  So we just pick a point
+    // that isn't collinear with any of the segments in the cell.  Eliminating
+    // collinearity eliminates special cases when counting crossings.
+    void generateRefPoint(XYIndex pos, std::mt19937& ranGen)
+    {
+        Cell& cell = m_grid->cell(pos);
+
+        // A test point is valid if it's not collinear with any segments
+        // in the cell.
+        auto validTestPoint = [this, &cell](double x, double y)
+        {
+            for (size_t i = 0; i < cell.m_count; ++i)
+                if (pointCollinear(x, y, cell.m_first + i))
+                    return false;
+            return true;
+        };
+
+        std::uniform_real_distribution<> xDist(0, m_grid->cellWidth());
+        std::uniform_real_distribution<> yDist(0, m_grid->cellHeight());
+        Grid<Cell>::Point origin = m_grid->cellOrigin(pos);
+        double x, y;
+        do
+        {
+            x = xval(origin) + xDist(ranGen);
+            y = yval(origin) + yDist(ranGen);
+        } while (!validTestPoint(x, y));
+        cell.m_point = Point(x, y);
+    }
+
+
+    // Determine the status of a cell's reference point by drawing a segment
+    // from the reference point in the cell to the left and count crossings.
+    // Knowing the number of edge crossings and the inside/outside status
+    // of the cell determines the status of this reference point.
+    // If we're determining the status of the leftmost cell, choose a point
+    // to the left of the leftmost cell, which is guaranteed to be outside
+    // the polygon.
+    void determinePointStatus(XYIndex pos)
+    {
+        Cell& cell = m_grid->cell(pos);
+        double x1 = xval(cell.m_point);
+        double y1 = yval(cell.m_point);
+
+        size_t intersectCount = 0;
+        if (pos.first == 0)
+        {
+            double x2 = x1 - m_grid->cellWidth();
+            double y2 = y1;
+
+            intersectCount = intersections(x1, y1, x2, y2, cell);
+        }
+        else
+        {
+            const Cell& prevCell =
+                m_grid->cell(XYIndex(pos.first - 1, pos.second));
+            double x2 = xval(prevCell.m_point);
+            double y2 = yval(prevCell.m_point);
+
+            // Count the edges in the current cell and the edges in the
+            // previous cell that aren't in the current cell so as not to
+            // double-count.
+            intersectCount = intersections(x1, y1, x2, y2, cell) +
+                intersections(x1, y1, x2, y2, prevCell, &cell);
+            if (prevCell.m_inside)
+                intersectCount++;
+        }
+        cell.m_inside = (intersectCount % 2 == 1);
+    }
+
+
+    // Determine the number of intersections between a segment and the
+    // edges of a cell, skipping edges that are also in 'skip'.
+    size_t intersections(double x1, double y1, double x2, double y2,
+        const Cell& cell, const Cell *skip = nullptr) const
+    {
+        auto begin = m_edgeIds.begin();
+        size_t isect = 0;
+        for (size_t i = cell.m_first; i < cell.m_first + cell.m_count; ++i)
+        {
+            // Edge IDs in a cell are sorted.
+            if (skip && std::binary_search(begin + skip->m_first,
+                    begin + skip->m_first + skip->m_count, m_edgeIds[i]))
+                continue;
+
+            bool on;
+            if (intersects(x1, y1, x2, y2, i, on))
+                isect++;
+        }
+        return isect;
+    }
+
+
+    // Determine if a point in a cell is inside the polygon or outside.
+    // We're always calling a point that lies on an edge as 'inside'
+    // the polygon.  Every edge of the cell is tested without branching
+    // or early exit so that the loop can be vectorized.
+    bool testCell(const Cell& cell, double x, double y) const
+    {
+        size_t crossings = 0;
+        bool onEdge = false;
+        size_t end = cell.m_first + cell.m_count;
+        for (size_t i = cell.m_first; i < end; ++i)
+        {
+            bool on;
+            bool hit = intersects(x, y, xval(cell.m_point), yval(cell.m_point),
+                i, on);
+            onEdge |= on;
+            crossings += (hit & !on);
+        }
+        return onEdge || (cell.m_inside != (crossings % 2 == 1));
+    }
+
+    // Determine if the segment (x1, y1) - (x2, y2) intersects the edge
+    // in the packed edge arrays at 'pos'.  'on' is set if the intersection
+    // is at the end of either segment.  Note that because of the way
+    // we've chosen reference points, the two segments should never be
+    // collinear, which eliminates some special cases.
+    //
+    // One segment endpoint lies on the other if the slope factor (t or u)
+    // is one or 0 and the other factor is between 0 and 1.
+    // This is standard math, but it's shown nicely on Stack Overflow
+    // question 563198.  The variable names map to the good response there.
+    bool intersects(double x1, double y1, double x2, double y2,
+        size_t pos, bool& on) const
+    {
+        double rx = x2 - x1;
+        double ry = y2 - y1;
+        double sx = m_x2[pos] - m_x1[pos];
+        double sy = m_y2[pos] - m_y1[pos];
+
+        // Should never be 0.
+        double rCrossS = rx * sy - ry * sx;
+        double pqx = m_x1[pos] - x1;
+        double pqy = m_y1[pos] - y1;
+
+        double t = (pqx * sy - pqy * sx) / rCrossS;
+        double u = (pqx * ry - pqy * rx) / rCrossS;
+        bool tCloseEnough = closeEnough(t, 0) | closeEnough(t, 1);
+        bool uCloseEnough = closeEnough(u, 0) | closeEnough(u, 1);
+        bool intersect = (tCloseEnough | ((t > 0) & (t < 1))) &
+            (uCloseEnough | ((u > 0) & (u < 1)));
+        on = intersect & (tCloseEnough | uCloseEnough);
+        return intersect;
+    }
+
+    // Same as Comparison::closeEnough() for doubles (within four units
+    // in the last place), but without branches.
+    static bool closeEnough(double d1, double d2)
+    {
+        uint64_t b1 = biased(d1);
+        uint64_t b2 = biased(d2);
+        bool nan = (d1 != d1) | (d2 != d2);
+        return !nan & ((b1 >= b2 ? b1 - b2 : b2 - b1) <= 4);
+    }
+
+    // Map the sign-and-magnitude bits of a double to an unsigned value
+    // that increases with the value of the double.
+    static uint64_t biased(double d)
+    {
+        const uint64_t signBit = (uint64_t)1 << 63;
+
+        uint64_t bits;
+        std::memcpy(&bits, &d, sizeof(bits));
+        return (bits & signBit) ? ~bits + 1 : (bits | signBit);
+    }
+
+    RingList m_rings;
+    std::unique_ptr<Grid<Cell>> m_grid;
+
+    // The edges of each cell, packed cell by cell.
+    std::vector<EdgeId> m_edgeIds;
+    std::vector<double> m_x1;
+    std::vector<double> m_y1;
+    std::vector<double> m_x2;
+    std::vector<double> m_y2;
+
+    double m_xMin;
+    double m_xMax;
+    double m_yMin;
+    double m_yMax;
+};
+
+} // namespace pdal
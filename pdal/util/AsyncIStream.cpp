@@ -0,0 +1,285 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (hobu.inc@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include "AsyncIStream.hpp"
+#include "Trace.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#endif
+
+namespace pdal
+{
+
+namespace
+{
+
+bool seekFile(std::FILE *file, std::streamoff pos, int whence)
+{
+#ifdef _WIN32
+    return _fseeki64(file, pos, whence) == 0;
+#else
+    return fseeko(file, (off_t)pos, whence) == 0;
+#endif
+}
+
+
+std::streamoff tellFile(std::FILE *file)
+{
+#ifdef _WIN32
+    return _ftelli64(file);
+#else
+    return ftello(file);
+#endif
+}
+
+
+// Hint to the system how a region of the file will be read.  Does nothing
+// where hints aren't supported.
+void advise(std::FILE *file, std::streamoff pos, std::streamoff len,
+    int advice)
+{
+#ifdef POSIX_FADV_NORMAL
+    ::posix_fadvise(fileno(file), (off_t)pos, (off_t)len, advice);
+#else
+    (void)file;
+    (void)pos;
+    (void)len;
+    (void)advice;
+#endif
+}
+
+} // unnamed namespace
+
+
+ReadAheadStreambuf::ReadAheadStreambuf(size_t bufsize) : m_file(nullptr),
+    m_current(0), m_base(0), m_size(0), m_fetchOffset(0), m_fetched(0),
+    m_fetching(false), m_haveFetch(false), m_error(false), m_stop(false)
+{
+    m_buffers[0].resize(bufsize);
+    m_buffers[1].resize(bufsize);
+}
+
+
+ReadAheadStreambuf::~ReadAheadStreambuf()
+{
+    close();
+}
+
+
+ReadAheadStreambuf *ReadAheadStreambuf::open(const std::string& filename)
+{
+    if (is_open())
+        return nullptr;
+
+    m_file = std::fopen(filename.c_str(), "rb");
+    if (!m_file)
+        return nullptr;
+
+    // Our windows are large, so let them be read directly.
+    std::setvbuf(m_file, nullptr, _IONBF, 0);
+    if (!seekFile(m_file, 0, SEEK_END) || (m_size = tellFile(m_file)) < 0)
+    {
+        std::fclose(m_file);
+        m_file = nullptr;
+        return nullptr;
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    advise(m_file, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    m_current = 0;
+    m_base = 0;
+    m_error = false;
+    m_stop = false;
+    m_haveFetch = false;
+    setg(nullptr, nullptr, nullptr);
+
+    // Start on the first window right away.
+    m_fetchOffset = 0;
+    m_fetching = true;
+    m_thread = std::thread(&ReadAheadStreambuf::run, this);
+    return this;
+}
+
+
+ReadAheadStreambuf *ReadAheadStreambuf::close()
+{
+    if (!is_open())
+        return nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    m_thread.join();
+    setg(nullptr, nullptr, nullptr);
+
+    bool ok = (std::fclose(m_file) == 0) && !m_error;
+    m_file = nullptr;
+    return ok ? this : nullptr;
+}
+
+
+// Read the windows asked for by the caller until told to stop.
+void ReadAheadStreambuf::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_cv.wait(lock, [this](){ return m_fetching || m_stop; });
+        if (m_stop)
+            break;
+
+        std::vector<char>& buf = m_buffers[m_current ^ 1];
+        const std::streamoff pos = m_fetchOffset;
+        lock.unlock();
+        size_t count = 0;
+        bool ok = true;
+        if (pos < m_size)
+        {
+            Trace::Span span("io", "read");
+            ok = seekFile(m_file, pos, SEEK_SET);
+            if (ok)
+            {
+                count = std::fread(buf.data(), 1, buf.size(), m_file);
+                ok = !std::ferror(m_file);
+            }
+#ifdef POSIX_FADV_WILLNEED
+            // Have the system fetch the window after this one while the
+            // caller works through the one before.
+            advise(m_file, pos + buf.size(), buf.size(),
+                POSIX_FADV_WILLNEED);
+#endif
+        }
+        lock.lock();
+        if (!ok)
+            m_error = true;
+        m_fetched = count;
+        m_haveFetch = true;
+        m_fetching = false;
+        m_cv.notify_all();
+    }
+}
+
+
+// Make the window holding a position current, reading it if it isn't the
+// one read ahead, and start reading the window after it.
+bool ReadAheadStreambuf::fill(std::streamoff pos)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [this](){ return !m_fetching; });
+    const bool hit = m_haveFetch && pos >= m_fetchOffset &&
+        (pos < m_fetchOffset + (std::streamoff)m_fetched ||
+         pos == m_fetchOffset);
+    if (!hit)
+    {
+        m_fetchOffset = pos;
+        m_fetching = true;
+        m_cv.notify_all();
+        m_cv.wait(lock, [this](){ return !m_fetching; });
+    }
+    m_haveFetch = false;
+    if (m_error)
+        return false;
+
+    m_current ^= 1;
+    m_base = m_fetchOffset;
+    const size_t count = m_fetched;
+    char *start = m_buffers[m_current].data();
+    setg(start, start + (pos - m_base), start + count);
+
+    // A short window means the end of the file was reached.
+    if (count == m_buffers[m_current].size())
+    {
+        m_fetchOffset = m_base + count;
+        m_fetching = true;
+        lock.unlock();
+        m_cv.notify_all();
+    }
+    return pos < m_base + (std::streamoff)count;
+}
+
+
+ReadAheadStreambuf::int_type ReadAheadStreambuf::underflow()
+{
+    if (!is_open())
+        return traits_type::eof();
+    if (gptr() < egptr())
+        return traits_type::to_int_type(*gptr());
+    if (!fill(m_base + (egptr() - eback())))
+        return traits_type::eof();
+    return traits_type::to_int_type(*gptr());
+}
+
+
+ReadAheadStreambuf::pos_type ReadAheadStreambuf::seekoff(off_type off,
+    std::ios::seekdir way, std::ios::openmode which)
+{
+    if (!is_open() || !(which & std::ios::in))
+        return pos_type(off_type(-1));
+
+    std::streamoff pos;
+    if (way == std::ios::beg)
+        pos = off;
+    else if (way == std::ios::end)
+        pos = m_size + off;
+    else
+    {
+        pos = m_base + (gptr() - eback()) + off;
+        // Telling the position doesn't need to wait for the reader.
+        if (off == 0)
+            return pos_type(pos);
+    }
+    if (pos < 0)
+        return pos_type(off_type(-1));
+
+    // Move within the current window if we can.
+    if (pos >= m_base && pos <= m_base + (egptr() - eback()))
+        setg(eback(), eback() + (pos - m_base), egptr());
+    else if (!fill(pos) && m_error)
+        return pos_type(off_type(-1));
+    return pos_type(pos);
+}
+
+
+ReadAheadStreambuf::pos_type ReadAheadStreambuf::seekpos(pos_type pos,
+    std::ios::openmode which)
+{
+    return seekoff(off_type(pos), std::ios::beg, which);
+}
+
+} // namespace pdal
@@ -0,0 +1,167 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (hobu.inc@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdio>
+#include <istream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "pdal_util_export.hpp"
+
+namespace pdal
+{
+
+/**
+  A file stream buffer that reads ahead of the caller on a background
+  thread.
+
+  The file is read in windows into one of two buffers.  While the caller
+  consumes one window, the background thread reads the next one into the
+  other buffer, so computation overlaps with slow storage.  The system is
+  told that the file is read sequentially and asked to fetch the window
+  after the one being read.  Seeking within the current window is free.
+  Seeking elsewhere waits for the window at the new position.
+*/
+class ReadAheadStreambuf : public std::streambuf
+{
+public:
+    /**
+      Construct a stream buffer.
+
+      \param bufsize  Size of each of the two windows.
+    */
+    PDAL_DLL ReadAheadStreambuf(size_t bufsize = DefaultBufSize);
+    PDAL_DLL ~ReadAheadStreambuf();
+
+    /**
+      Open a file for reading and start reading its first window.
+
+      \param filename  Name of the file.
+      \return  Pointer to this buffer, or nullptr on failure.
+    */
+    PDAL_DLL ReadAheadStreambuf *open(const std::string& filename);
+
+    /**
+      Stop reading and close the file.
+
+      \return  Pointer to this buffer, or nullptr on failure.
+    */
+    PDAL_DLL ReadAheadStreambuf *close();
+
+    /**
+      Determine if the file is open.
+
+      \return  Whether the file is open.
+    */
+    PDAL_DLL bool is_open() const
+        { return m_file != nullptr; }
+
+    static const size_t DefaultBufSize = 4 * 1024 * 1024;
+
+protected:
+    int_type underflow() override;
+    pos_type seekoff(off_type off, std::ios::seekdir way,
+        std::ios::openmode which) override;
+    pos_type seekpos(pos_type pos, std::ios::openmode which) override;
+
+private:
+    void run();
+    bool fill(std::streamoff pos);
+
+    std::FILE *m_file;
+    std::vector<char> m_buffers[2];
+    int m_current;
+    std::streamoff m_base;
+    std::streamoff m_size;
+    std::streamoff m_fetchOffset;
+    size_t m_fetched;
+    bool m_fetching;
+    bool m_haveFetch;
+    bool m_error;
+    bool m_stop;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::thread m_thread;
+};
+
+/**
+  An input file stream that reads ahead of the caller on a background
+  thread.
+*/
+class AsyncIStream : public std::istream
+{
+public:
+    /**
+      Open a file for reading.  Check the stream state for failure.
+
+      \param filename  Name of the file.
+      \param bufsize  Size of the windows read ahead.
+    */
+    PDAL_DLL AsyncIStream(const std::string& filename,
+            size_t bufsize = ReadAheadStreambuf::DefaultBufSize) :
+        std::istream(nullptr), m_buf(bufsize)
+    {
+        init(&m_buf);
+        if (!m_buf.open(filename))
+            setstate(std::ios::failbit);
+    }
+
+    /**
+      Determine if the file is open.
+
+      \return  Whether the file is open.
+    */
+    PDAL_DLL bool is_open() const
+        { return m_buf.is_open(); }
+
+    /**
+      Stop reading and close the file.
+    */
+    PDAL_DLL void close()
+    {
+        if (!m_buf.close())
+            setstate(std::ios::failbit);
+    }
+
+private:
+    ReadAheadStreambuf m_buf;
+};
+
+} // namespace pdal
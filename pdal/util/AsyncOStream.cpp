@@ -0,0 +1,205 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "AsyncOStream.hpp"
+#include "Trace.hpp"
+
+namespace pdal
+{
+
+AsyncStreambuf::AsyncStreambuf(size_t bufsize) : m_current(0), m_pending(0),
+    m_error(false), m_stop(false), m_base(0)
+{
+    m_buffers[0].resize(bufsize);
+    m_buffers[1].resize(bufsize);
+}
+
+
+AsyncStreambuf::~AsyncStreambuf()
+{
+    close();
+}
+
+
+AsyncStreambuf *AsyncStreambuf::open(const std::string& filename,
+    std::ios::openmode mode)
+{
+    if (is_open())
+        return nullptr;
+
+    // Our buffers are large, so let the file write them directly.
+    m_file.pubsetbuf(nullptr, 0);
+    if (!m_file.open(filename, mode | std::ios::out))
+        return nullptr;
+
+    m_current = 0;
+    m_pending = 0;
+    m_error = false;
+    m_stop = false;
+    m_base = 0;
+    std::vector<char>& buf = m_buffers[m_current];
+    setp(buf.data(), buf.data() + buf.size());
+    m_thread = std::thread(&AsyncStreambuf::run, this);
+    return this;
+}
+
+
+AsyncStreambuf *AsyncStreambuf::close()
+{
+    if (!is_open())
+        return nullptr;
+
+    bool ok = drain();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    m_thread.join();
+    setp(nullptr, nullptr);
+
+    if (!m_file.close())
+        ok = false;
+    return ok ? this : nullptr;
+}
+
+
+// Write buffers handed off by the caller until told to stop.
+void AsyncStreambuf::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_cv.wait(lock, [this](){ return m_pending || m_stop; });
+        if (!m_pending)
+            break;
+
+        const char *data = m_buffers[m_current ^ 1].data();
+        std::streamsize count = (std::streamsize)m_pending;
+        lock.unlock();
+        bool ok;
+        {
+            Trace::Span span("io", "write");
+            ok = (m_file.sputn(data, count) == count);
+        }
+        lock.lock();
+        if (!ok)
+            m_error = true;
+        m_pending = 0;
+        m_cv.notify_all();
+    }
+}
+
+
+// Give the current buffer to the writer thread and switch to the other one,
+// waiting for it to be written if necessary.
+bool AsyncStreambuf::handOff()
+{
+    size_t count = pptr() - pbase();
+    if (count == 0)
+        return !m_error;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [this](){ return !m_pending; });
+    if (m_error)
+        return false;
+    m_pending = count;
+    m_current ^= 1;
+    m_base += count;
+    lock.unlock();
+    m_cv.notify_all();
+
+    std::vector<char>& buf = m_buffers[m_current];
+    setp(buf.data(), buf.data() + buf.size());
+    return true;
+}
+
+
+// Hand off any buffered data and wait for it all to be written.
+bool AsyncStreambuf::drain()
+{
+    bool ok = handOff();
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [this](){ return !m_pending; });
+    return ok && !m_error;
+}
+
+
+AsyncStreambuf::int_type AsyncStreambuf::overflow(int_type c)
+{
+    if (!is_open() || !handOff())
+        return traits_type::eof();
+    if (!traits_type::eq_int_type(c, traits_type::eof()))
+    {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+
+int AsyncStreambuf::sync()
+{
+    if (!is_open())
+        return -1;
+    return (drain() && m_file.pubsync() == 0) ? 0 : -1;
+}
+
+
+AsyncStreambuf::pos_type AsyncStreambuf::seekoff(off_type off,
+    std::ios::seekdir way, std::ios::openmode which)
+{
+    if (!is_open() || !(which & std::ios::out))
+        return pos_type(off_type(-1));
+
+    // Telling the position doesn't need to wait for the writer.
+    if (way == std::ios::cur && off == 0)
+        return pos_type(m_base + (pptr() - pbase()));
+
+    if (!drain())
+        return pos_type(off_type(-1));
+    pos_type pos = m_file.pubseekoff(off, way, std::ios::out);
+    if (pos != pos_type(off_type(-1)))
+        m_base = pos;
+    return pos;
+}
+
+
+AsyncStreambuf::pos_type AsyncStreambuf::seekpos(pos_type pos,
+    std::ios::openmode which)
+{
+    return seekoff(off_type(pos), std::ios::beg, which);
+}
+
+} // namespace pdal
@@ -0,0 +1,162 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "pdal_util_export.hpp"
+
+namespace pdal
+{
+
+/**
+  A file stream buffer that writes to the file on a background thread.
+
+  Data is collected in one of two large buffers.  When a buffer fills, it's
+  handed to the background thread to be written while the other buffer
+  fills.  The caller only waits when both buffers are full, so computation
+  overlaps with slow storage.  Seeking waits for pending data to be written.
+*/
+class AsyncStreambuf : public std::streambuf
+{
+public:
+    /**
+      Construct a stream buffer.
+
+      \param bufsize  Size of each of the two buffers.
+    */
+    PDAL_DLL AsyncStreambuf(size_t bufsize = DefaultBufSize);
+    PDAL_DLL ~AsyncStreambuf();
+
+    /**
+      Open a file for writing.
+
+      \param filename  Name of the file.
+      \param mode  Open mode.  Output is always set.
+      \return  Pointer to this buffer, or nullptr on failure.
+    */
+    PDAL_DLL AsyncStreambuf *open(const std::string& filename,
+        std::ios::openmode mode);
+
+    /**
+      Write all pending data and close the file.
+
+      \return  Pointer to this buffer, or nullptr on failure.
+    */
+    PDAL_DLL AsyncStreambuf *close();
+
+    /**
+      Determine if the file is open.
+
+      \return  Whether the file is open.
+    */
+    PDAL_DLL bool is_open() const
+        { return m_file.is_open(); }
+
+    static const size_t DefaultBufSize = 4 * 1024 * 1024;
+
+protected:
+    int_type overflow(int_type c) override;
+    int sync() override;
+    pos_type seekoff(off_type off, std::ios::seekdir way,
+        std::ios::openmode which) override;
+    pos_type seekpos(pos_type pos, std::ios::openmode which) override;
+
+private:
+    void run();
+    bool handOff();
+    bool drain();
+
+    std::filebuf m_file;
+    std::vector<char> m_buffers[2];
+    int m_current;
+    size_t m_pending;
+    bool m_error;
+    bool m_stop;
+    std::streamoff m_base;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::thread m_thread;
+};
+
+/**
+  An output file stream that writes to the file on a background thread.
+*/
+class AsyncOStream : public std::ostream
+{
+public:
+    /**
+      Open a file for writing.  Check the stream state for failure.
+
+      \param filename  Name of the file.
+      \param mode  Open mode.
+    */
+    PDAL_DLL AsyncOStream(const std::string& filename,
+            std::ios::openmode mode = std::ios::out | std::ios::binary) :
+        std::ostream(nullptr)
+    {
+        init(&m_buf);
+        if (!m_buf.open(filename, mode))
+            setstate(std::ios::failbit);
+    }
+
+    /**
+      Determine if the file is open.
+
+      \return  Whether the file is open.
+    */
+    PDAL_DLL bool is_open() const
+        { return m_buf.is_open(); }
+
+    /**
+      Write all pending data and close the file.
+    */
+    PDAL_DLL void close()
+    {
+        if (!m_buf.close())
+            setstate(std::ios::failbit);
+    }
+
+private:
+    AsyncStreambuf m_buf;
+};
+
+} // namespace pdal
@@ -463,8 +463,8 @@ public:
     void clip(const BOX3D& other)
     {
         BOX2D::clip(other);
-        if (other.minz < minz) minz = other.minz;
-        if (other.maxz > maxz) maxz = other.maxz;
+        if (other.minz > minz) minz = other.minz;
+        if (other.maxz < maxz) maxz = other.maxz;
     }
 
     /**
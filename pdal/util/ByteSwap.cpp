@@ -0,0 +1,125 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (hobu.inc@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include "ByteSwap.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace pdal
+{
+namespace Utils
+{
+
+namespace
+{
+
+// Swap the values that don't fill a whole vector, or all of them when
+// the build has no vector instructions.
+void swapScalar(const char *src, char *dst, size_t size, size_t count)
+{
+    char tmp[16];
+    for (size_t i = 0; i < count; ++i)
+    {
+        std::memcpy(tmp, src, size);
+        std::reverse_copy(tmp, tmp + size, dst);
+        src += size;
+        dst += size;
+    }
+}
+
+} // unnamed namespace
+
+void byteSwap(const void *src, void *dst, size_t size, size_t count)
+{
+    const char *s = (const char *)src;
+    char *d = (char *)dst;
+
+    if (size <= 1 || size > 16)
+    {
+        if (size > 16)
+            for (size_t i = 0; i < count; ++i)
+                std::reverse_copy(s + i * size, s + (i + 1) * size,
+                    d + i * size);
+        else if (s != d)
+            std::memmove(d, s, count * size);
+        return;
+    }
+
+    size_t bytes = count * size;
+    size_t done = 0;
+#if defined(__SSSE3__)
+    __m128i mask;
+    if (size == 2)
+        mask = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6,
+            9, 8, 11, 10, 13, 12, 15, 14);
+    else if (size == 4)
+        mask = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4,
+            11, 10, 9, 8, 15, 14, 13, 12);
+    else if (size == 8)
+        mask = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0,
+            15, 14, 13, 12, 11, 10, 9, 8);
+    if (size == 2 || size == 4 || size == 8)
+        for (; done + 16 <= bytes; done += 16)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i *)(s + done));
+            _mm_storeu_si128((__m128i *)(d + done),
+                _mm_shuffle_epi8(v, mask));
+        }
+#elif defined(__ARM_NEON)
+    if (size == 2)
+        for (; done + 16 <= bytes; done += 16)
+            vst1q_u8((uint8_t *)(d + done),
+                vrev16q_u8(vld1q_u8((const uint8_t *)(s + done))));
+    else if (size == 4)
+        for (; done + 16 <= bytes; done += 16)
+            vst1q_u8((uint8_t *)(d + done),
+                vrev32q_u8(vld1q_u8((const uint8_t *)(s + done))));
+    else if (size == 8)
+        for (; done + 16 <= bytes; done += 16)
+            vst1q_u8((uint8_t *)(d + done),
+                vrev64q_u8(vld1q_u8((const uint8_t *)(s + done))));
+#endif
+    swapScalar(s + done, d + done, size, (bytes - done) / size);
+}
+
+} // namespace Utils
+} // namespace pdal
@@ -36,6 +36,7 @@
 
 #include <vector>
 
+#include "ByteSwap.hpp"
 #include "pdal_util_export.hpp"
 #include "portable_endian.hpp"
 
@@ -184,6 +185,25 @@ public:
     virtual Extractor& operator >> (double& v) = 0;
 
 protected:
+    /**
+      Extract an array of values, reversing the bytes of each value if
+      \ref swap is set.
+
+      \param dst  Values to extract to.
+      \param count  Number of values.
+      \param swap  Whether to reverse the bytes of each value.
+    */
+    template<typename T>
+    void getValues(T *dst, std::size_t count, bool swap)
+    {
+        if (swap)
+            Utils::byteSwap(m_gptr, dst, sizeof(T), count);
+        else
+            memcpy(dst, m_gptr, count * sizeof(T));
+        m_gptr += count * sizeof(T);
+    }
+
+
     const char *m_eback;  ///< Start of the buffer (name from std::streambuf)
     const char *m_egptr;  ///< End of the buffer.
     const char *m_gptr;   ///< Current get position.
@@ -341,6 +361,23 @@ public:
         m_gptr += sizeof(v);
         return *this;
     }
+
+    using Extractor::get;
+
+    /**
+      Extract an array of values from a buffer. Values are only
+      converted on big-endian hosts.
+
+      \param dst  Values to extract to.
+      \param count  Number of values.
+      \return  This extractor.
+    */
+    template<typename T>
+    LeExtractor& get(T *dst, std::size_t count)
+    {
+        getValues(dst, count, le16toh(1) != 1);
+        return *this;
+    }
 };
 
 
@@ -496,6 +533,23 @@ public:
         m_gptr += sizeof(v);
         return *this;
     }
+
+    using Extractor::get;
+
+    /**
+      Extract an array of values from a buffer. Values are only
+      converted on little-endian hosts.
+
+      \param dst  Values to extract to.
+      \param count  Number of values.
+      \return  This extractor.
+    */
+    template<typename T>
+    BeExtractor& get(T *dst, std::size_t count)
+    {
+        getValues(dst, count, be16toh(1) != 1);
+        return *this;
+    }
 };
 
 
@@ -695,6 +749,23 @@ public:
         return *this;
     }
 
+
+    using Extractor::get;
+
+    /**
+      Extract an array of values from a buffer.
+
+      \param dst  Values to extract to.
+      \param count  Number of values.
+      \return  This extractor.
+    */
+    template<typename T>
+    SwitchableExtractor& get(T *dst, std::size_t count)
+    {
+        getValues(dst, count, m_isLittleEndian ? le16toh(1) != 1 :
+            be16toh(1) != 1);
+        return *this;
+    }
 private:
     bool m_isLittleEndian;
 };
@@ -34,10 +34,14 @@
 
 #include <sys/stat.h>
 
+#include <ctime>
 #include <iostream>
 #include <sstream>
 #ifndef WIN32
 #include <glob.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
 #else
 #include <codecvt>
 #include <Windows.h>
@@ -45,7 +49,10 @@
 
 #include <boost/filesystem.hpp>
 
+#include <pdal/util/AsyncIStream.hpp>
+#include <pdal/util/AsyncOStream.hpp>
 #include <pdal/util/FileUtils.hpp>
+#include <pdal/util/Trace.hpp>
 #include <pdal/util/Utils.hpp>
 #include <pdal/pdal_types.hpp>
 
@@ -99,12 +106,13 @@ inline std::string const& toNative(std::string const& in) { return in; }
 namespace FileUtils
 {
 
-std::istream *openFile(std::string const& filename, bool asBinary)
+std::istream *openFile(std::string const& filename, bool asBinary,
+    size_t readAhead)
 {
     if (filename[0] == '~')
         throw pdal::pdal_error("PDAL does not support shell expansion");
 
-    std::ifstream *ifs = nullptr;
+    std::istream *ifs = nullptr;
 
     std::string name(filename);
     if (isStdin(name))
@@ -117,7 +125,10 @@ std::istream *openFile(std::string const& filename, bool asBinary)
     if (asBinary)
         mode |= std::ios::binary;
 
-    ifs = new std::ifstream(toNative(name), mode);
+    if (readAhead)
+        ifs = new AsyncIStream(toNative(name), readAhead);
+    else
+        ifs = new std::ifstream(toNative(name), mode);
     if (!ifs->good())
     {
         delete ifs;
@@ -127,7 +138,7 @@ std::istream *openFile(std::string const& filename, bool asBinary)
 }
 
 
-std::ostream *createFile(std::string const& name, bool asBinary)
+std::ostream *createFile(std::string const& name, bool asBinary, bool async)
 {
     if (isStdout(name))
         return &std::cout;
@@ -136,7 +147,25 @@ std::ostream *createFile(std::string const& name, bool asBinary)
     if (asBinary)
         mode |= std::ios::binary;
 
-    std::ostream *ofs = new std::ofstream(toNative(name), mode);
+    std::ostream *ofs;
+    if (async)
+        ofs = new AsyncOStream(name, mode);
+    else
+        ofs = new std::ofstream(toNative(name), mode);
+    if (!ofs->good())
+    {
+        delete ofs;
+        return nullptr;
+    }
+    return ofs;
+}
+
+
+std::ostream *openForUpdate(std::string const& name)
+{
+    // Opening for input as well keeps the contents of the file.
+    std::ofstream *ofs = new std::ofstream(toNative(name),
+        std::ios::in | std::ios::out | std::ios::binary);
     if (!ofs->good())
     {
         delete ofs;
@@ -204,6 +233,13 @@ void closeFile(std::ostream *out)
     {
         ofs->close();
         delete ofs;
+        return;
+    }
+    AsyncOStream *aos = dynamic_cast<AsyncOStream *>(out);
+    if (aos)
+    {
+        aos->close();
+        delete aos;
     }
 }
 
@@ -219,6 +255,13 @@ void closeFile(std::istream* in)
     {
         ifs->close();
         delete ifs;
+        return;
+    }
+    AsyncIStream *ais = dynamic_cast<AsyncIStream *>(in);
+    if (ais)
+    {
+        ais->close();
+        delete ais;
     }
 }
 
@@ -257,8 +300,27 @@ uintmax_t fileSize(const std::string& file)
 }
 
 
+void resizeFile(const std::string& file, uintmax_t size)
+{
+    pdalboost::filesystem::resize_file(toNative(file), size);
+}
+
+
+std::string uniqueFilename(const std::string& dir, const std::string& prefix)
+{
+    pdalboost::filesystem::path path = dir.empty() ?
+        pdalboost::filesystem::temp_directory_path() :
+        pdalboost::filesystem::path(toNative(dir));
+
+    path /= pdalboost::filesystem::unique_path(
+        toNative(prefix + "%%%%-%%%%-%%%%-%%%%"));
+    return path.string();
+}
+
+
 std::string readFileIntoString(const std::string& filename)
 {
+    Trace::Span span("io", "read " + getFilename(filename));
     std::string str;
 
     std::istream* stream = openFile(filename, false);
@@ -393,6 +455,31 @@ void fileTimes(const std::string& filename, struct tm *createTime,
 }
 
 
+int64_t lastWriteTime(const std::string& filename)
+{
+#ifdef WIN32
+    std::wstring const wfilename(toNative(filename));
+    struct _stat statbuf;
+    if (_wstat(wfilename.c_str(), &statbuf))
+        return -1;
+#else
+    struct stat statbuf;
+    if (stat(filename.c_str(), &statbuf))
+        return -1;
+#endif
+    return (int64_t)statbuf.st_mtime;
+}
+
+
+bool touchFile(const std::string& filename)
+{
+    pdalboost::system::error_code ec;
+    pdalboost::filesystem::last_write_time(toNative(filename),
+        std::time(nullptr), ec);
+    return !ec;
+}
+
+
 std::string extension(const std::string& filename)
 {
     auto idx = filename.find_last_of('.');
@@ -444,6 +531,99 @@ std::vector<std::string> glob(std::string path)
     return filenames;
 }
 
+
+MapContext mapFile(const std::string& filename, bool readOnly,
+    uintmax_t pos, uintmax_t size)
+{
+    MapContext ctx;
+
+    if (size == 0)
+    {
+        uintmax_t total = fileSize(filename);
+        if (pos >= total)
+        {
+            ctx.m_error = "Can't map empty region of file.";
+            return ctx;
+        }
+        size = total - pos;
+    }
+
+    // The file handles can be closed once the region is mapped.  The
+    // mapping keeps the file open until it's unmapped.
+#ifdef _WIN32
+    HANDLE fh = CreateFileW(toNative(filename).c_str(),
+        readOnly ? GENERIC_READ : (GENERIC_READ | GENERIC_WRITE),
+        FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, NULL);
+    if (fh == INVALID_HANDLE_VALUE)
+    {
+        ctx.m_error = "Can't open file.";
+        return ctx;
+    }
+    HANDLE mh = CreateFileMapping(fh, NULL,
+        readOnly ? PAGE_READONLY : PAGE_READWRITE, 0, 0, NULL);
+    CloseHandle(fh);
+    if (mh == NULL)
+    {
+        ctx.m_error = "Can't create file mapping.";
+        return ctx;
+    }
+    ctx.m_addr = MapViewOfFile(mh, readOnly ? FILE_MAP_READ : FILE_MAP_WRITE,
+        (DWORD)(pos >> 32), (DWORD)pos, (SIZE_T)size);
+    CloseHandle(mh);
+    if (ctx.m_addr == NULL)
+    {
+        ctx.m_error = "Can't map file.";
+        return ctx;
+    }
+#else
+    int fd = ::open(filename.c_str(), readOnly ? O_RDONLY : O_RDWR);
+    if (fd == -1)
+    {
+        ctx.m_error = "Can't open file.";
+        return ctx;
+    }
+    void *addr = ::mmap(0, size,
+        readOnly ? PROT_READ : (PROT_READ | PROT_WRITE),
+        MAP_SHARED, fd, (off_t)pos);
+    ::close(fd);
+    if (addr == MAP_FAILED)
+    {
+        ctx.m_error = "Can't map file.";
+        return ctx;
+    }
+    ctx.m_addr = addr;
+#endif
+    ctx.m_size = size;
+    return ctx;
+}
+
+
+void unmapFile(MapContext& ctx)
+{
+    if (!ctx.m_addr)
+        return;
+#ifdef _WIN32
+    if (!UnmapViewOfFile(ctx.m_addr))
+        ctx.m_error = "Can't unmap file.";
+#else
+    if (::munmap(ctx.m_addr, ctx.m_size) == -1)
+        ctx.m_error = "Can't unmap file.";
+#endif
+    ctx.m_addr = nullptr;
+    ctx.m_size = 0;
+}
+
+
+void adviseSequential(const MapContext& ctx)
+{
+    if (!ctx.m_addr)
+        return;
+#ifndef _WIN32
+    ::posix_madvise(ctx.m_addr, ctx.m_size, POSIX_MADV_SEQUENTIAL);
+#endif
+}
+
 } // namespace FileUtils
 
 } // namespace pdal
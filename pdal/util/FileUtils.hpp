@@ -55,20 +55,34 @@ namespace FileUtils
 
       \param filename  Filename.
       \param asBinary  Read as binary file (don't convert /r/n to /n)
+      \param readAhead  Size of the windows of the file read ahead on a
+        background thread, or 0 to read as requested.  Files read ahead
+        are always read as binary.
       \return  Pointer to opened stream.
     */
     PDAL_DLL std::istream* openFile(std::string const& filename,
-        bool asBinary=true);
+        bool asBinary=true, size_t readAhead=0);
 
     /**
       Create a file and open for writing.
 
       \param filename  Filename.
       \param asBinary  Write as binary file (don't convert /n to /r/n)
+      \param async  Write data to the file on a background thread.
       \return  Point to opened stream.
     */
     PDAL_DLL std::ostream* createFile(std::string const& filename,
-        bool asBinary=true);
+        bool asBinary=true, bool async=false);
+
+    /**
+      Open an existing file for writing without truncating it.  The
+      stream is positioned at the start of the file.
+
+      \param filename  Filename.
+      \return  Pointer to opened stream, or null if the file can't be
+        opened.
+    */
+    PDAL_DLL std::ostream* openForUpdate(std::string const& filename);
 
     /**
       Determine if a directory exists.
@@ -155,6 +169,27 @@ namespace FileUtils
     */
     PDAL_DLL uintmax_t fileSize(const std::string& filename);
 
+    /**
+      Change the size of an existing file.  Space added to the end of the
+      file reads as zeros.
+
+      \param filename  Filename.
+      \param size  New size of the file.
+    */
+    PDAL_DLL void resizeFile(const std::string& filename, uintmax_t size);
+
+    /**
+      Generate the name of a file that doesn't exist.  The file isn't
+      created.
+
+      \param dir  Directory of the file.  If empty, the system temporary
+        directory is used.
+      \param prefix  Prefix of the filename.
+      \return  Path of the file.
+    */
+    PDAL_DLL std::string uniqueFilename(const std::string& dir,
+        const std::string& prefix);
+
     /**
       Read a file into a string.
 
@@ -234,6 +269,23 @@ namespace FileUtils
     PDAL_DLL void fileTimes(const std::string& filename, struct tm *createTime,
         struct tm *modTime);
 
+    /**
+      Get the modification time of a file or directory.
+
+      \param filename  Filename.
+      \return  Modification time in seconds since the epoch, or -1 if
+        the file doesn't exist.
+    */
+    PDAL_DLL int64_t lastWriteTime(const std::string& filename);
+
+    /**
+      Set the modification time of a file to the current time.
+
+      \param filename  Filename.
+      \return  Whether the time was set.
+    */
+    PDAL_DLL bool touchFile(const std::string& filename);
+
     /**
       Return the extension of the filename, including the separator (.).
 
@@ -258,6 +310,59 @@ namespace FileUtils
       \return  List of files that correspond to provided file specification.
     */
     PDAL_DLL std::vector<std::string> glob(std::string filespec);
+
+    /**
+      Information about a region of a file mapped into memory.
+    */
+    struct MapContext
+    {
+    public:
+        MapContext() : m_addr(nullptr), m_size(0)
+        {}
+
+        void *addr() const
+            { return m_addr; }
+        std::string what() const
+            { return m_error; }
+
+        void *m_addr;
+        uintmax_t m_size;
+        std::string m_error;
+    };
+
+    /**
+      Map a region of a file into memory.  Changes made to a writable
+      mapping are written to the file.  On failure, the address of the
+      returned context is null and what() describes the error.
+
+      \param filename  Filename.
+      \param readOnly  Whether the mapping is read-only.
+      \param pos  Offset of the region in the file.  Must be a multiple of
+        the system's allocation granularity (64K is always safe).
+      \param size  Size of the region.  If 0, the region extends to the end
+        of the file.
+      \return  Context of the mapping.
+    */
+    PDAL_DLL MapContext mapFile(const std::string& filename,
+        bool readOnly = true, uintmax_t pos = 0, uintmax_t size = 0);
+
+    /**
+      Unmap a region mapped with mapFile().  On failure, what() describes
+      the error.
+
+      \param ctx  Context of the mapping.  Its address is reset.
+    */
+    PDAL_DLL void unmapFile(MapContext& ctx);
+
+    /**
+      Tell the system that a mapped region will be read from beginning to
+      end, so that it can read ahead aggressively and drop pages once
+      they've been passed.  This is only a hint and does nothing where it
+      isn't supported.
+
+      \param ctx  Context of the mapping.
+    */
+    PDAL_DLL void adviseSequential(const MapContext& ctx);
 }
 
 } // namespace pdal
@@ -63,28 +63,46 @@ Xyz rotate(const Xyz& point, const RotationMatrix& matrix)
 }
 
 
-Xyz cartesianToCurvilinear(const Xyz& point, double latitude)
-{
-    double w = std::sqrt(1 - e2 * std::sin(latitude) * std::sin(latitude));
-    double n = a / w;
-    double m = a * (1 - e2) / (w * w * w);
-    return Xyz(point.X / (n * std::cos(latitude)), point.Y / m, point.Z);
-}
-}
+} // unnamed namespace
 
 
 Xyz georeferenceWgs84(double range, double scanAngle,
                       const RotationMatrix& boresightMatrix,
                       const RotationMatrix& imuMatrix, const Xyz& gpsPoint)
 {
-    Xyz pSocs = Xyz(range * std::sin(scanAngle), 0, -range * std::cos(scanAngle));
+    Xyz point(0, 0, 0);
+    georeferenceWgs84(&range, 1, scanAngle, boresightMatrix, imuMatrix,
+        gpsPoint, &point);
+    return point;
+}
 
-    Xyz pSocsAligned = rotate(pSocs, boresightMatrix);
-    Xyz pLocalLevel = rotate(pSocsAligned, imuMatrix);
-    Xyz pCurvilinear = cartesianToCurvilinear(pLocalLevel, gpsPoint.Y);
 
-    return Xyz(gpsPoint.X + pCurvilinear.X, gpsPoint.Y + pCurvilinear.Y,
-               gpsPoint.Z + pCurvilinear.Z);
+void georeferenceWgs84(const double *ranges, size_t count, double scanAngle,
+                       const RotationMatrix& boresightMatrix,
+                       const RotationMatrix& imuMatrix, const Xyz& gpsPoint,
+                       Xyz *out)
+{
+    const double sinScan = std::sin(scanAngle);
+    const double cosScan = std::cos(scanAngle);
+
+    // Radii of curvature in the prime vertical and meridian.
+    const double latitude = gpsPoint.Y;
+    const double w =
+        std::sqrt(1 - e2 * std::sin(latitude) * std::sin(latitude));
+    const double n = a / w;
+    const double m = a * (1 - e2) / (w * w * w);
+    const double ncos = n * std::cos(latitude);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        Xyz pSocs(ranges[i] * sinScan, 0, -ranges[i] * cosScan);
+        Xyz pSocsAligned = rotate(pSocs, boresightMatrix);
+        Xyz pLocalLevel = rotate(pSocsAligned, imuMatrix);
+
+        out[i] = Xyz(gpsPoint.X + pLocalLevel.X / ncos,
+            gpsPoint.Y + pLocalLevel.Y / m, gpsPoint.Z + pLocalLevel.Z);
+    }
 }
+
 }
 }
@@ -34,6 +34,8 @@
 
 #pragma once
 
+#include <cstddef>
+
 #include "pdal_util_export.hpp"
 
 namespace pdal
@@ -87,6 +89,14 @@ PDAL_DLL Xyz georeferenceWgs84(double range, double scanAngle,
                       const RotationMatrix& boresightMatrix,
                       const RotationMatrix& imuMatrix, const Xyz& gpsPoint);
 
+// Georeference the 'count' returns of a single pulse, writing a Latitude,
+// Longitude, Height triplet for each range to 'out'.  The trigonometry
+// that depends only on the pulse is done once rather than per return.
+PDAL_DLL void georeferenceWgs84(const double *ranges, size_t count,
+                      double scanAngle, const RotationMatrix& boresightMatrix,
+                      const RotationMatrix& imuMatrix, const Xyz& gpsPoint,
+                      Xyz *out);
+
 } // namespace georeference
 } // namespace pdal
 
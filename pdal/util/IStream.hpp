@@ -44,6 +44,7 @@
 #include <vector>
 #include <cstring>
 
+#include "ByteSwap.hpp"
 #include "portable_endian.hpp"
 #include "pdal_util_export.hpp"
 
@@ -98,8 +99,7 @@ public:
     {
         if (m_stream)
              return -1;
-        m_stream = m_fstream = new std::ifstream(filename,
-            std::ios_base::in | std::ios_base::binary);
+        m_stream = m_fstream = new BufferedIfstream(filename);
         return 0;
     }
 
@@ -258,10 +258,74 @@ public:
         { m_stream->read((char *)buf, size); }
 
 protected:
+    /**
+      Read bytes from the buffer of the current stream.  This skips the
+      sentry that std::istream::read() constructs, which is a noticeable
+      cost when fields are read one at a time.  The stream state is set
+      as std::istream::read() would set it.
+
+      \param p  Location to fill.
+      \param size  Number of bytes to read.
+    */
+    void readBytes(void *p, size_t size)
+    {
+        if (m_stream->rdstate() != std::ios_base::goodbit ||
+            m_stream->rdbuf()->sgetn((char *)p, (std::streamsize)size) !=
+                (std::streamsize)size)
+            m_stream->setstate(std::ios_base::eofbit |
+                std::ios_base::failbit);
+    }
+
+    /**
+      Read a byte from the buffer of the current stream.
+
+      \return  The byte read or EOF.
+    */
+    int getByte()
+    {
+        int c = std::char_traits<char>::eof();
+        if (m_stream->rdstate() == std::ios_base::goodbit)
+            c = m_stream->rdbuf()->sbumpc();
+        if (c == std::char_traits<char>::eof())
+            m_stream->setstate(std::ios_base::eofbit |
+                std::ios_base::failbit);
+        return c;
+    }
+
+    /**
+      Reverse the bytes of each value in an array.
+
+      \param vals  Values to convert.
+      \param count  Number of values.
+    */
+    template<typename T>
+    static void swapBytes(T *vals, size_t count)
+        { Utils::byteSwap(vals, vals, sizeof(T), count); }
+
     std::istream *m_stream;
     std::ifstream *m_fstream; // Dup of above to facilitate cleanup.
 
 private:
+    // File stream that reads through a large buffer of its own, so that
+    // reads of small fields rarely reach the file descriptor.
+    class BufferedIfstream : public std::ifstream
+    {
+    public:
+        BufferedIfstream(const std::string& filename) :
+            m_buf(BufferSize)
+        {
+            rdbuf()->pubsetbuf(m_buf.data(), m_buf.size());
+            open(filename, std::ios_base::in | std::ios_base::binary);
+        }
+        ~BufferedIfstream()
+            { close(); }
+
+    private:
+        static const size_t BufferSize = 1 << 20;
+
+        std::vector<char> m_buf;
+    };
+
     std::stack<std::istream *> m_streams;
 	IStream(const IStream&);
 };
@@ -303,7 +367,7 @@ public:
     */
     PDAL_DLL ILeStream& operator >> (uint8_t& v)
     {
-        v = (uint8_t)m_stream->get();
+        v = (uint8_t)getByte();
         return *this;
     }
 
@@ -315,7 +379,7 @@ public:
     */
     PDAL_DLL ILeStream& operator >> (int8_t& v)
     {
-        v = (int8_t)m_stream->get();
+        v = (int8_t)getByte();
         return *this;
     }
 
@@ -327,7 +391,7 @@ public:
     */
     PDAL_DLL ILeStream& operator >> (uint16_t& v)
     {
-        m_stream->read((char *)&v, sizeof(v));
+        readBytes(&v, sizeof(v));
         v = le16toh(v);
         return *this;
     }
@@ -340,7 +404,7 @@ public:
     */
     PDAL_DLL ILeStream& operator >> (int16_t& v)
     {
-        m_stream->read((char *)&v, sizeof(v));
+        readBytes(&v, sizeof(v));
         v = (int16_t)le16toh((uint16_t)v);
         return *this;
     }
@@ -353,7 +417,7 @@ public:
     */
     PDAL_DLL ILeStream& operator >> (uint32_t& v)
     {
-        m_stream->read((char *)&v, sizeof(v));
+        readBytes(&v, sizeof(v));
         v = le32toh(v);
         return *this;
     }
@@ -366,7 +430,7 @@ public:
     */
     PDAL_DLL ILeStream& operator >> (int32_t& v)
     {
-        m_stream->read((char *)&v, sizeof(v));
+        readBytes(&v, sizeof(v));
         v = (int32_t)le32toh((uint32_t)v);
         return *this;
     }
@@ -379,7 +443,7 @@ public:
     */
     PDAL_DLL ILeStream& operator >> (uint64_t& v)
     {
-        m_stream->read((char *)&v, sizeof(v));
+        readBytes(&v, sizeof(v));
         v = le64toh(v);
         return *this;
     }
@@ -392,7 +456,7 @@ public:
     */
     PDAL_DLL ILeStream& operator >> (int64_t& v)
     {
-        m_stream->read((char *)&v, sizeof(v));
+        readBytes(&v, sizeof(v));
         v = (int64_t)le64toh((uint64_t)v);
         return *this;
     }
@@ -405,7 +469,7 @@ public:
     */
     PDAL_DLL ILeStream& operator >> (float& v)
     {
-        m_stream->read((char *)&v, sizeof(v));
+        readBytes(&v, sizeof(v));
         uint32_t tmp = le32toh(*(uint32_t *)(&v));
         std::memcpy(&v, &tmp, sizeof(tmp));
         return *this;
@@ -419,11 +483,27 @@ public:
     */
     PDAL_DLL ILeStream& operator >> (double& v)
     {
-        m_stream->read((char *)&v, sizeof(v));
+        readBytes(&v, sizeof(v));
         uint64_t tmp = le64toh(*(uint64_t *)(&v));
         std::memcpy(&v, &tmp, sizeof(tmp));
         return *this;
     }
+    /**
+      Extract an array of values from the stream with a single read.
+
+      \param dst  Values to populate.
+      \param count  Number of values to extract.
+      \return  This stream.
+    */
+    template<typename T>
+    ILeStream& read(T *dst, size_t count)
+    {
+        readBytes(dst, count * sizeof(T));
+        // Values are only converted on big-endian hosts.
+        if (sizeof(T) > 1 && le16toh(1) != 1)
+            swapBytes(dst, count);
+        return *this;
+    }
 };
 
 
@@ -464,7 +544,7 @@ public:
     */
     PDAL_DLL IBeStream& operator >> (uint8_t& v)
     {
-        v = (uint8_t)m_stream->get();
+        v = (uint8_t)getByte();
         return *this;
     }
 
@@ -476,7 +556,7 @@ public:
     */
     PDAL_DLL IBeStream& operator >> (int8_t& v)
     {
-        v = (int8_t)m_stream->get();
+        v = (int8_t)getByte();
         return *this;
     }
 
@@ -488,7 +568,7 @@ public:
     */
     PDAL_DLL IBeStream& operator >> (uint16_t& v)
     {
-        m_stream->read((char *)&v, sizeof(v));
+        readBytes(&v, sizeof(v));
         v = be16toh(v);
         return *this;
     }
@@ -501,7 +581,7 @@ public:
     */
     PDAL_DLL IBeStream& operator >> (int16_t& v)
     {
-        m_stream->read((char *)&v, sizeof(v));
+        readBytes(&v, sizeof(v));
         v = (int16_t)be16toh((uint16_t)v);
         return *this;
     }
@@ -514,7 +594,7 @@ public:
     */
     PDAL_DLL IBeStream& operator >> (uint32_t& v)
     {
-        m_stream->read((char *)&v, sizeof(v));
+        readBytes(&v, sizeof(v));
         v = be32toh(v);
         return *this;
     }
@@ -527,7 +607,7 @@ public:
     */
     PDAL_DLL IBeStream& operator >> (int32_t& v)
     {
-        m_stream->read((char *)&v, sizeof(v));
+        readBytes(&v, sizeof(v));
         v = (int32_t)be32toh((uint32_t)v);
         return *this;
     }
@@ -540,7 +620,7 @@ public:
     */
     PDAL_DLL IBeStream& operator >> (uint64_t& v)
     {
-        m_stream->read((char *)&v, sizeof(v));
+        readBytes(&v, sizeof(v));
         v = be64toh(v);
         return *this;
     }
@@ -553,7 +633,7 @@ public:
     */
     PDAL_DLL IBeStream& operator >> (int64_t& v)
     {
-        m_stream->read((char *)&v, sizeof(v));
+        readBytes(&v, sizeof(v));
         v = (int64_t)be64toh((uint64_t)v);
         return *this;
     }
@@ -566,7 +646,7 @@ public:
     */
     PDAL_DLL IBeStream& operator >> (float& v)
     {
-        m_stream->read((char *)&v, sizeof(v));
+        readBytes(&v, sizeof(v));
         uint32_t tmp = be32toh(*(uint32_t *)(&v));
         std::memcpy(&v, &tmp, sizeof(tmp));
         return *this;
@@ -580,11 +660,27 @@ public:
     */
     PDAL_DLL IBeStream& operator >> (double& v)
     {
-        m_stream->read((char *)&v, sizeof(v));
+        readBytes(&v, sizeof(v));
         uint64_t tmp = be64toh(*(uint64_t *)(&v));
         std::memcpy(&v, &tmp, sizeof(tmp));
         return *this;
     }
+    /**
+      Extract an array of values from the stream with a single read.
+
+      \param dst  Values to populate.
+      \param count  Number of values to extract.
+      \return  This stream.
+    */
+    template<typename T>
+    IBeStream& read(T *dst, size_t count)
+    {
+        readBytes(dst, count * sizeof(T));
+        // Values are only converted on little-endian hosts.
+        if (sizeof(T) > 1 && be16toh(1) != 1)
+            swapBytes(dst, count);
+        return *this;
+    }
 };
 
 
@@ -620,26 +716,26 @@ public:
 
     PDAL_DLL ISwitchableStream& operator>>(uint8_t& v)
     {
-        v = (uint8_t)m_stream->get();
+        v = (uint8_t)getByte();
         return *this;
     }
 
     PDAL_DLL ISwitchableStream& operator>>(int8_t& v)
     {
-        v = (int8_t)m_stream->get();
+        v = (int8_t)getByte();
         return *this;
     }
 
     PDAL_DLL ISwitchableStream& operator>>(uint16_t& v)
     {
-        m_stream->read((char*)&v, sizeof(v));
+        readBytes(&v, sizeof(v));
         v = isLittleEndian() ? le16toh(v) : be16toh(v);
         return *this;
     }
 
     PDAL_DLL ISwitchableStream& operator>>(int16_t& v)
     {
-        m_stream->read((char*)&v, sizeof(v));
+        readBytes(&v, sizeof(v));
         v = isLittleEndian() ? (int16_t)le16toh((uint16_t)v)
                              : (int16_t)be16toh((uint16_t)v);
         return *this;
@@ -647,14 +743,14 @@ public:
 
     PDAL_DLL ISwitchableStream& operator>>(uint32_t& v)
     {
-        m_stream->read((char*)&v, sizeof(v));
+        readBytes(&v, sizeof(v));
         v = isLittleEndian() ? le32toh(v) : be32toh(v);
         return *this;
     }
 
     PDAL_DLL ISwitchableStream& operator>>(int32_t& v)
     {
-        m_stream->read((char*)&v, sizeof(v));
+        readBytes(&v, sizeof(v));
         v = isLittleEndian() ? (int32_t)le32toh((uint32_t)v)
                              : (int32_t)be32toh((uint32_t)v);
         return *this;
@@ -662,14 +758,14 @@ public:
 
     PDAL_DLL ISwitchableStream& operator>>(uint64_t& v)
     {
-        m_stream->read((char*)&v, sizeof(v));
+        readBytes(&v, sizeof(v));
         v = isLittleEndian() ? le64toh(v) : be64toh(v);
         return *this;
     }
 
     PDAL_DLL ISwitchableStream& operator>>(int64_t& v)
     {
-        m_stream->read((char*)&v, sizeof(v));
+        readBytes(&v, sizeof(v));
         v = isLittleEndian() ? (int64_t)le64toh((uint64_t)v)
                              : (int64_t)be64toh((uint64_t)v);
         return *this;
@@ -677,7 +773,7 @@ public:
 
     PDAL_DLL ISwitchableStream& operator>>(float& v)
     {
-        m_stream->read((char*)&v, sizeof(v));
+        readBytes(&v, sizeof(v));
         uint32_t tmp = isLittleEndian() ? le32toh(*(uint32_t*)(&v))
                                         : be32toh(*(uint32_t*)(&v));
         std::memcpy(&v, &tmp, sizeof(tmp));
@@ -686,7 +782,7 @@ public:
 
     PDAL_DLL ISwitchableStream& operator>>(double& v)
     {
-        m_stream->read((char*)&v, sizeof(v));
+        readBytes(&v, sizeof(v));
         uint64_t tmp = isLittleEndian() ? be64toh(*(uint64_t*)(&v))
                                         : be64toh(*(uint64_t*)(&v));
         std::memcpy(&v, &tmp, sizeof(tmp));
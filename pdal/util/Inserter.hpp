@@ -33,6 +33,7 @@
 ****************************************************************************/
 #pragma once
 
+#include "ByteSwap.hpp"
 #include "portable_endian.hpp"
 #include "pdal_util_export.hpp"
 
@@ -57,6 +58,18 @@ protected:
     // Current position.
     char *m_pptr;
 
+    // Insert an array of values, reversing the bytes of each value if
+    // 'swap' is set.
+    template<typename T>
+    void putValues(const T *src, std::size_t count, bool swap)
+    {
+        if (swap)
+            Utils::byteSwap(src, m_pptr, sizeof(T), count);
+        else
+            memcpy(m_pptr, src, count * sizeof(T));
+        m_pptr += count * sizeof(T);
+    }
+
 public:
     operator bool() const
         { return good(); }
@@ -195,6 +208,17 @@ public:
         m_pptr += sizeof(uu.d);
         return *this;
     }
+
+    using Inserter::put;
+
+    // Insert an array of values.  Values are only converted on
+    // big-endian hosts.
+    template<typename T>
+    LeInserter& put(const T *src, std::size_t count)
+    {
+        putValues(src, count, htole16(1) != 1);
+        return *this;
+    }
 };
 
 
@@ -297,6 +321,17 @@ public:
         m_pptr += sizeof(uu.d);
         return *this;
     }
+
+    using Inserter::put;
+
+    // Insert an array of values.  Values are only converted on
+    // little-endian hosts.
+    template<typename T>
+    BeInserter& put(const T *src, std::size_t count)
+    {
+        putValues(src, count, htobe16(1) != 1);
+        return *this;
+    }
 };
 
 } // namespace pdal
@@ -36,10 +36,14 @@
 #include <sys/types.h>
 #include <stdint.h>
 
+#include <algorithm>
 #include <fstream>
 #include <cstring>
 #include <stack>
+#include <vector>
 
+#include "AsyncOStream.hpp"
+#include "ByteSwap.hpp"
 #include "portable_endian.hpp"
 #include "pdal_util_export.hpp"
 
@@ -59,12 +63,15 @@ public:
     PDAL_DLL ~OStream()
         { delete m_fstream; }
 
-    PDAL_DLL int open(const std::string& filename)
+    PDAL_DLL int open(const std::string& filename, bool async = false)
     {
         if (m_stream)
             return -1;
-        m_stream = m_fstream = new std::ofstream(filename,
-            std::ios_base::out | std::ios_base::binary);
+        if (async)
+            m_stream = m_fstream = new AsyncOStream(filename,
+                std::ios_base::out | std::ios_base::binary);
+        else
+            m_stream = m_fstream = new BufferedOfstream(filename);
         return 0;
     }
     PDAL_DLL void close()
@@ -113,10 +120,61 @@ public:
     }
 
 protected:
+    // Write bytes to the buffer of the current stream, skipping the sentry
+    // that std::ostream::write() constructs.  The stream state is set as
+    // std::ostream::write() would set it.
+    void putBytes(const void *p, size_t size)
+    {
+        if (!m_stream->good() ||
+            m_stream->rdbuf()->sputn((const char *)p,
+                (std::streamsize)size) != (std::streamsize)size)
+            m_stream->setstate(std::ios_base::badbit);
+    }
+
+    // Write an array of values, reversing the bytes of each value if
+    // 'swap' is set.
+    template<typename T>
+    void putValues(const T *src, size_t count, bool swap)
+    {
+        if (!swap || sizeof(T) == 1)
+        {
+            putBytes(src, count * sizeof(T));
+            return;
+        }
+        const size_t BlockCount = 512;
+        T block[BlockCount];
+        while (count)
+        {
+            const size_t n = (std::min)(count, BlockCount);
+            Utils::byteSwap(src, block, sizeof(T), n);
+            putBytes(block, n * sizeof(T));
+            src += n;
+            count -= n;
+        }
+    }
+
     std::ostream *m_stream;
     std::ostream *m_fstream; // Dup of above to facilitate cleanup.
 
 private:
+    // File stream that writes through a large buffer of its own.
+    class BufferedOfstream : public std::ofstream
+    {
+    public:
+        BufferedOfstream(const std::string& filename) : m_buf(BufferSize)
+        {
+            rdbuf()->pubsetbuf(m_buf.data(), m_buf.size());
+            open(filename, std::ios_base::out | std::ios_base::binary);
+        }
+        ~BufferedOfstream()
+            { close(); }
+
+    private:
+        static const size_t BufferSize = 1 << 20;
+
+        std::vector<char> m_buf;
+    };
+
     std::stack<std::ostream *> m_streams;
     OStream(const OStream&);
 };
@@ -135,55 +193,55 @@ public:
 
     PDAL_DLL OLeStream& operator << (uint8_t v)
     {
-        m_stream->put((char)v);
+        putBytes(&v, sizeof(v));
         return *this;
     }
 
     PDAL_DLL OLeStream& operator << (int8_t v)
     {
-        m_stream->put((char)v);
+        putBytes(&v, sizeof(v));
         return *this;
     }
 
     PDAL_DLL OLeStream& operator << (uint16_t v)
     {
         v = htole16(v);
-        m_stream->write((char *)&v, sizeof(v));
+        putBytes(&v, sizeof(v));
         return *this;
     }
 
     PDAL_DLL OLeStream& operator << (int16_t v)
     {
         v = (int16_t)htole16((uint16_t)v);
-        m_stream->write((char *)&v, sizeof(v));
+        putBytes(&v, sizeof(v));
         return *this;
     }
 
     PDAL_DLL OLeStream& operator << (uint32_t v)
     {
         v = htole32(v);
-        m_stream->write((char *)&v, sizeof(v));
+        putBytes(&v, sizeof(v));
         return *this;
     }
 
     PDAL_DLL OLeStream& operator << (int32_t v)
     {
         v = (int32_t)htole32((uint32_t)v);
-        m_stream->write((char *)&v, sizeof(v));
+        putBytes(&v, sizeof(v));
         return *this;
     }
 
     PDAL_DLL OLeStream& operator << (uint64_t v)
     {
         v = htole64(v);
-        m_stream->write((char *)&v, sizeof(v));
+        putBytes(&v, sizeof(v));
         return *this;
     }
 
     PDAL_DLL OLeStream& operator << (int64_t v)
     {
         v = (int64_t)htole64((uint64_t)v);
-        m_stream->write((char *)&v, sizeof(v));
+        putBytes(&v, sizeof(v));
         return *this;
     }
 
@@ -192,7 +250,7 @@ public:
         uint32_t tmp(0);
         std::memcpy(&tmp, &v, sizeof(v));
         tmp = htole32(tmp);
-        m_stream->write((char *)&tmp, sizeof(tmp));
+        putBytes(&tmp, sizeof(tmp));
         return *this;
     }
 
@@ -201,7 +259,21 @@ public:
         uint64_t tmp(0);
         std::memcpy(&tmp, &v, sizeof(v));
         tmp = htole64(tmp);
-        m_stream->write((char *)&tmp, sizeof(tmp));
+        putBytes(&tmp, sizeof(tmp));
+        return *this;
+    }
+    /**
+      Insert an array of values into the stream with a single write.
+
+      \param src  Values to insert.
+      \param count  Number of values to insert.
+      \return  This stream.
+    */
+    template<typename T>
+    OLeStream& write(const T *src, size_t count)
+    {
+        // Values are only converted on big-endian hosts.
+        putValues(src, count, htole16(1) != 1);
         return *this;
     }
 };
@@ -221,55 +293,55 @@ public:
 
     PDAL_DLL OBeStream& operator << (uint8_t v)
     {
-        m_stream->put((char)v);
+        putBytes(&v, sizeof(v));
         return *this;
     }
 
     PDAL_DLL OBeStream& operator << (int8_t v)
     {
-        m_stream->put((char)v);
+        putBytes(&v, sizeof(v));
         return *this;
     }
 
     PDAL_DLL OBeStream& operator << (uint16_t v)
     {
         v = htobe16(v);
-        m_stream->write((char *)&v, sizeof(v));
+        putBytes(&v, sizeof(v));
         return *this;
     }
 
     PDAL_DLL OBeStream& operator << (int16_t v)
     {
         v = (int16_t)htobe16((uint16_t)v);
-        m_stream->write((char *)&v, sizeof(v));
+        putBytes(&v, sizeof(v));
         return *this;
     }
 
     PDAL_DLL OBeStream& operator << (uint32_t v)
     {
         v = htobe32(v);
-        m_stream->write((char *)&v, sizeof(v));
+        putBytes(&v, sizeof(v));
         return *this;
     }
 
     PDAL_DLL OBeStream& operator << (int32_t v)
     {
         v = (int32_t)htobe32((uint32_t)v);
-        m_stream->write((char *)&v, sizeof(v));
+        putBytes(&v, sizeof(v));
         return *this;
     }
 
     PDAL_DLL OBeStream& operator << (uint64_t v)
     {
         v = htobe64(v);
-        m_stream->write((char *)&v, sizeof(v));
+        putBytes(&v, sizeof(v));
         return *this;
     }
 
     PDAL_DLL OBeStream& operator << (int64_t v)
     {
         v = (int64_t)htobe64((uint64_t)v);
-        m_stream->write((char *)&v, sizeof(v));
+        putBytes(&v, sizeof(v));
         return *this;
     }
 
@@ -278,7 +350,7 @@ public:
         uint32_t tmp(0);
         std::memcpy(&tmp, &v, sizeof(v));
         tmp = htobe32(tmp);
-        m_stream->write((char *)&tmp, sizeof(tmp));
+        putBytes(&tmp, sizeof(tmp));
         return *this;
     }
 
@@ -287,7 +359,21 @@ public:
         uint64_t tmp(0);
         std::memcpy(&tmp, &v, sizeof(v));
         tmp = htobe64(tmp);
-        m_stream->write((char *)&tmp, sizeof(tmp));
+        putBytes(&tmp, sizeof(tmp));
+        return *this;
+    }
+    /**
+      Insert an array of values into the stream with a single write.
+
+      \param src  Values to insert.
+      \param count  Number of values to insert.
+      \return  This stream.
+    */
+    template<typename T>
+    OBeStream& write(const T *src, size_t count)
+    {
+        // Values are only converted on little-endian hosts.
+        putValues(src, count, htobe16(1) != 1);
         return *this;
     }
 };
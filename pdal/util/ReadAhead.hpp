@@ -0,0 +1,136 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (hobu.inc@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+
+#include "ThreadPool.hpp"
+
+namespace pdal
+{
+
+/**
+  Runs a sequence of fetches on a thread pool with up to a fixed number
+  of them in flight, and returns their results in the order in which the
+  fetches were added.  Readers of slow (usually remote) sources use this
+  to overlap requests with each other and with the processing of the
+  results that have already arrived.
+
+  A ReadAhead is used from a single thread.  Its destructor waits for the
+  fetches that are running.
+*/
+template<typename T>
+class ReadAhead
+{
+public:
+    typedef std::function<T()> Fetch;
+
+    /**
+      \param pool  Pool on which fetches are run.
+      \param depth  Maximum number of fetches that are queued or running.
+    */
+    ReadAhead(ThreadPool& pool, std::size_t depth) :
+        m_pool(pool), m_depth((std::max)(depth, (std::size_t)1))
+    {}
+
+    ~ReadAhead()
+    {
+        m_waiting.clear();
+        for (std::future<T>& f : m_running)
+            f.wait();
+    }
+
+    ReadAhead(const ReadAhead&) = delete;
+    ReadAhead& operator=(const ReadAhead&) = delete;
+
+    /**
+      Add a fetch to the sequence.  It's started as soon as fewer than
+      'depth' fetches are in flight.
+
+      \param fetch  Function that fetches and returns a result.
+    */
+    void add(Fetch fetch)
+    {
+        m_waiting.push_back(std::move(fetch));
+        fill();
+    }
+
+    /**
+      \return  Whether all the results have been returned.
+    */
+    bool empty() const
+        { return m_running.empty() && m_waiting.empty(); }
+
+    /**
+      Wait for the result of the earliest fetch that hasn't been returned.
+      Must not be called when \ref empty is true.
+
+      \return  The result of the fetch.
+      \throw  The exception thrown by the fetch, if any.
+    */
+    T next()
+    {
+        std::future<T> f(std::move(m_running.front()));
+        m_running.pop_front();
+        fill();
+        return f.get();
+    }
+
+private:
+    void fill()
+    {
+        while (m_running.size() < m_depth && m_waiting.size())
+        {
+            std::shared_ptr<std::packaged_task<T()>> task(
+                new std::packaged_task<T()>(std::move(m_waiting.front())));
+            m_waiting.pop_front();
+            m_running.push_back(task->get_future());
+            m_pool.add([task](){ (*task)(); });
+        }
+    }
+
+    ThreadPool& m_pool;
+    std::size_t m_depth;
+    std::deque<Fetch> m_waiting;
+    std::deque<std::future<T>> m_running;
+};
+
+} // namespace pdal
@@ -33,36 +33,147 @@
  ****************************************************************************/
 
 #pragma once
+
+#include <algorithm>
+#include <atomic>
 #include <condition_variable>
-#include <queue>
+#include <cstddef>
+#include <exception>
 #include <functional>
-#include <vector>
+#include <iostream>
 #include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <string>
 #include <thread>
-#include <iostream>
+#include <vector>
+
+#include "pdal_util_export.hpp"
+#include "Trace.hpp"
 
 namespace pdal
 {
 
-class PDAL_DLL Pool
+namespace parallel_detail
+{
+
+// Whether the calling thread is counted in busyThreads().
+inline bool& counted()
+{
+    static thread_local bool c = false;
+    return c;
+}
+
+// Process-wide thread budget.  Zero means one thread per core.
+inline std::atomic<std::size_t>& threadLimit()
+{
+    static std::atomic<std::size_t> limit(0);
+    return limit;
+}
+
+// Number of threads running ThreadPool tasks or parallelFor() loops.
+inline std::atomic<std::size_t>& busyThreads()
+{
+    static std::atomic<std::size_t> busy(0);
+    return busy;
+}
+
+// Count the calling thread as busy for the life of the object, unless it
+// already is.
+class BusyScope
+{
+public:
+    BusyScope() : m_marked(!counted())
+    {
+        if (m_marked)
+        {
+            counted() = true;
+            ++busyThreads();
+        }
+    }
+    ~BusyScope()
+    {
+        if (m_marked)
+        {
+            counted() = false;
+            --busyThreads();
+        }
+    }
+
+private:
+    bool m_marked;
+};
+
+// Claim up to 'wanted' more busy threads without exceeding 'budget'.
+inline std::size_t claimThreads(std::size_t wanted, std::size_t budget)
+{
+    std::atomic<std::size_t>& busy = busyThreads();
+    std::size_t cur = busy;
+    while (true)
+    {
+        std::size_t n = (std::min)(wanted, cur < budget ? budget - cur : 0);
+        if (n == 0 || busy.compare_exchange_weak(cur, cur + n))
+            return n;
+    }
+}
+
+} // namespace parallel_detail
+
+// Set the number of threads that all parallel work in the process shares:
+// parallelFor() loops, ThreadPool workers and stages that ask
+// parallelThreads() how wide to go.  Zero (the default) allows one thread
+// per core and doesn't limit the size of thread pools.
+inline void setParallelThreads(std::size_t limit)
+{
+    parallel_detail::threadLimit() = limit;
+}
+
+// The limit set with setParallelThreads(), or zero.
+inline std::size_t parallelThreadLimit()
+{
+    return parallel_detail::threadLimit();
+}
+
+// Number of threads parallel work should use: one per core, capped by
+// any limit from setParallelThreads().
+inline std::size_t parallelThreads()
+{
+    std::size_t n = (std::max)(std::thread::hardware_concurrency(), 1u);
+    std::size_t limit = parallel_detail::threadLimit();
+    return limit ? (std::min)(n, limit) : n;
+}
+
+// Number of threads to give a thread pool that asks for 'numThreads':
+// at least one and no more than the limit from setParallelThreads().
+inline std::size_t poolThreads(std::size_t numThreads)
+{
+    std::size_t limit = parallel_detail::threadLimit();
+    if (limit)
+        numThreads = (std::min)(numThreads, limit);
+    return (std::max)(numThreads, (std::size_t)1);
+}
+
+class PDAL_DLL ThreadPool
 {
 public:
     // After numThreads tasks are actively running, and queueSize tasks have
     // been enqueued to wait for an available worker thread, subsequent calls
-    // to Pool::add will block until an enqueued task has been popped from the
-    // queue.
-    Pool(
+    // to ThreadPool::add will block until an enqueued task has been popped
+    // from the queue.  Pools have no more threads than the limit set with
+    // setParallelThreads(), and their workers count against it while they
+    // run tasks, so parallelFor() loops inside tasks don't oversubscribe.
+    ThreadPool(
             std::size_t numThreads,
             std::size_t queueSize = 1,
             bool verbose = true)
         : m_verbose(verbose)
-        , m_numThreads(std::max<std::size_t>(numThreads, 1))
+        , m_numThreads(poolThreads(numThreads))
         , m_queueSize(std::max<std::size_t>(queueSize, 1))
     {
         go();
     }
 
-    ~Pool() { join(); }
+    ~ThreadPool() { join(); }
 
     // Start worker threads.
     void go()
@@ -109,7 +220,7 @@ public:
     void resize(const std::size_t numThreads)
     {
         join();
-        m_numThreads = numThreads;
+        m_numThreads = poolThreads(numThreads);
         go();
     }
 
@@ -123,8 +234,8 @@ public:
         std::unique_lock<std::mutex> lock(m_mutex);
         if (!m_running)
         {
-            throw std::runtime_error(
-                    "Attempted to add a task to a stopped Pool");
+            throw std::runtime_error("Attempted to add a task to a stopped "
+                "ThreadPool");
         }
 
         m_produceCv.wait(lock, [this]()
@@ -168,7 +279,12 @@ private:
                 m_produceCv.notify_all();
 
                 std::string err;
-                try { task(); }
+                try
+                {
+                    parallel_detail::BusyScope busy;
+                    Trace::Span span("pool", "task");
+                    task();
+                }
                 catch (std::exception& e) { err = e.what(); }
                 catch (...) { err = "Unknown error"; }
 
@@ -212,8 +328,71 @@ private:
     std::condition_variable m_consumeCv;
 
     // Disable copy/assignment.
-    Pool(const Pool& other);
-    Pool& operator=(const Pool& other);
+    ThreadPool(const ThreadPool& other);
+    ThreadPool& operator=(const ThreadPool& other);
 };
 
+// Call a worker for each index in [0, count) on one thread per core.
+// Threads take chunks of indices as they finish earlier ones, so uneven
+// work balances out.  Each thread calls makeWorker() once and passes all
+// its indices to the returned function, which can keep per-thread
+// buffers.  The first exception thrown stops the work and is rethrown.
+// Extra threads are only started while the threads already busy with
+// parallel work (pool tasks and other loops, including enclosing ones)
+// leave room under parallelThreads().  A nested loop on a busy machine
+// runs on the calling thread.
+template<typename MakeWorker>
+void parallelFor(std::size_t count, MakeWorker makeWorker,
+    std::size_t chunkSize = 1024)
+{
+    std::atomic<std::size_t> next(0);
+    std::atomic<bool> failed(false);
+    std::exception_ptr error;
+
+    auto work = [&]()
+    {
+        try
+        {
+            auto worker = makeWorker();
+            while (!failed)
+            {
+                std::size_t begin = next.fetch_add(chunkSize);
+                if (begin >= count)
+                    break;
+                std::size_t end = (std::min)(begin + chunkSize, count);
+                for (std::size_t i = begin; i < end; ++i)
+                    worker(i);
+            }
+        }
+        catch (...)
+        {
+            // Only the first error is kept.
+            if (!failed.exchange(true))
+                error = std::current_exception();
+        }
+    };
+
+    parallel_detail::BusyScope busy;
+    std::size_t budget = parallelThreads();
+    std::size_t chunks = (count + chunkSize - 1) / chunkSize;
+    std::size_t wanted = (std::min)(budget, chunks);
+    std::size_t helpers = wanted > 1 ?
+        parallel_detail::claimThreads(wanted - 1, budget) : 0;
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < helpers; ++i)
+        threads.emplace_back([&work]()
+        {
+            parallel_detail::counted() = true;
+            work();
+        });
+    work();
+    for (auto& t : threads)
+        t.join();
+    parallel_detail::busyThreads() -= helpers;
+    if (error)
+        std::rethrow_exception(error);
+}
+
 } // namespace pdal
+
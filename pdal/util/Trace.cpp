@@ -0,0 +1,174 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (hobu.inc@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Utils.hpp"
+
+namespace pdal
+{
+namespace Trace
+{
+
+namespace
+{
+
+struct Event
+{
+    const char *m_category;
+    char m_name[48];
+    uint32_t m_thread;
+    int64_t m_start;
+    int64_t m_end;
+};
+
+// The ring of events.  Writers claim slots with an atomic counter, so
+// recording takes no lock.
+struct Ring
+{
+    Ring(std::size_t capacity) : m_events(capacity), m_next(0),
+        m_origin(now())
+    {}
+
+    std::vector<Event> m_events;
+    std::atomic<uint64_t> m_next;
+    int64_t m_origin;
+};
+
+std::atomic<bool> s_enabled(false);
+std::unique_ptr<Ring> s_ring;
+std::mutex s_mutex;
+
+uint32_t threadNumber()
+{
+    static std::atomic<uint32_t> s_next(1);
+    static thread_local uint32_t number = s_next++;
+    return number;
+}
+
+} // unnamed namespace
+
+void start(std::size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_enabled = false;
+    s_ring.reset(new Ring((std::max)(capacity, (std::size_t)1)));
+    s_enabled = true;
+}
+
+
+void stop()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_enabled = false;
+    s_ring.reset();
+}
+
+
+bool enabled()
+{
+    return s_enabled.load(std::memory_order_relaxed);
+}
+
+
+int64_t now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+void record(const char *category, const std::string& name,
+    int64_t startNs, int64_t endNs)
+{
+    Ring *ring = s_ring.get();
+    if (!enabled() || !ring)
+        return;
+
+    uint64_t slot = ring->m_next.fetch_add(1, std::memory_order_relaxed);
+    Event& e = ring->m_events[slot % ring->m_events.size()];
+    e.m_category = category;
+    size_t len = (std::min)(name.size(), sizeof(e.m_name) - 1);
+    std::memcpy(e.m_name, name.data(), len);
+    e.m_name[len] = 0;
+    e.m_thread = threadNumber();
+    e.m_start = startNs;
+    e.m_end = endNs;
+}
+
+
+void write(std::ostream& out)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    // Times are in microseconds.
+    std::ios::fmtflags flags(out.flags());
+    std::streamsize precision(out.precision());
+    out << std::fixed << std::setprecision(3);
+    out << "{\"traceEvents\":[";
+    if (s_ring)
+    {
+        const Ring& ring = *s_ring;
+        uint64_t end = ring.m_next;
+        uint64_t size = ring.m_events.size();
+        uint64_t begin = end > size ? end - size : 0;
+        for (uint64_t i = begin; i < end; ++i)
+        {
+            const Event& e = ring.m_events[i % size];
+            if (i != begin)
+                out << ",";
+            out << "\n{\"name\":\"" << Utils::escapeJSON(e.m_name) <<
+                "\",\"cat\":\"" << e.m_category << "\",\"ph\":\"X\"," <<
+                "\"ts\":" << (e.m_start - ring.m_origin) / 1000.0 << "," <<
+                "\"dur\":" << (e.m_end - e.m_start) / 1000.0 << "," <<
+                "\"pid\":1,\"tid\":" << e.m_thread << "}";
+        }
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    out.flags(flags);
+    out.precision(precision);
+}
+
+} // namespace Trace
+} // namespace pdal
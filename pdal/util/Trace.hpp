@@ -0,0 +1,128 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (hobu.inc@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include "pdal_util_export.hpp"
+
+namespace pdal
+{
+namespace Trace
+{
+
+/**
+  Start recording timeline events.  Events are kept in a ring buffer of
+  fixed size, so once it's full the oldest events are overwritten.
+  Recording is off until this is called and costs a single check when off.
+
+  \param capacity  Number of events kept.
+*/
+PDAL_DLL void start(std::size_t capacity = 1 << 20);
+
+/**
+  Stop recording and discard the recorded events.
+*/
+PDAL_DLL void stop();
+
+/**
+  \return  Whether events are being recorded.
+*/
+PDAL_DLL bool enabled();
+
+/**
+  Record an event that has finished.
+
+  \param category  Kind of event ("stage", "stream", "pool", "io").  Must
+    be a string literal or otherwise outlive the recording.
+  \param name  Name of the event.  Long names are truncated.
+  \param startNs  Start of the event, in nanoseconds of the steady clock.
+  \param endNs  End of the event, in nanoseconds of the steady clock.
+*/
+PDAL_DLL void record(const char *category, const std::string& name,
+    int64_t startNs, int64_t endNs);
+
+/**
+  Write the recorded events in the Chrome trace event format, which can be
+  loaded by chrome://tracing and Perfetto.  Events are written as complete
+  ("X") events with one track per thread.  Recording should be finished.
+
+  \param out  Stream to write to.
+*/
+PDAL_DLL void write(std::ostream& out);
+
+/**
+  \return  The steady clock time in nanoseconds.
+*/
+PDAL_DLL int64_t now();
+
+/**
+  Records an event for the time between its construction and destruction
+  if recording is on when it's constructed.
+*/
+class Span
+{
+public:
+    Span(const char *category, const std::string& name) :
+        m_category(enabled() ? category : nullptr)
+    {
+        if (m_category)
+        {
+            m_name = name;
+            m_start = now();
+        }
+    }
+
+    ~Span()
+    {
+        if (m_category)
+            record(m_category, m_name, m_start, now());
+    }
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+private:
+    const char *m_category;
+    std::string m_name;
+    int64_t m_start;
+};
+
+} // namespace Trace
+} // namespace pdal
@@ -0,0 +1,229 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (hobu.inc@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include <arrow/io/file.h>
+#include <arrow/ipc/reader.h>
+#include <parquet/arrow/reader.h>
+
+#include <pdal/util/FileUtils.hpp>
+
+#include "ArrowReader.hpp"
+
+namespace pdal
+{
+
+static PluginInfo const s_info
+{
+    "readers.arrow",
+    "Read points from Apache Arrow IPC (Feather) or Parquet files.",
+    "http://pdal.io/stages/readers.arrow.html"
+};
+
+CREATE_SHARED_STAGE(ArrowReader, s_info)
+std::string ArrowReader::getName() const { return s_info.name; }
+
+ArrowReader::ArrowReader() : m_format(Format::Ipc), m_numRows(0),
+    m_nextBatch(0), m_row(0)
+{}
+
+
+ArrowReader::~ArrowReader()
+{}
+
+
+void ArrowReader::addArgs(ProgramArgs& args)
+{
+    args.add("format", "File format: 'ipc', 'parquet' or 'auto'.  'auto' "
+        "reads files with the extension .parquet or .pq as Parquet and "
+        "others as Arrow IPC.", m_formatName, "auto");
+}
+
+
+void ArrowReader::initialize()
+{
+    std::string format = Utils::tolower(m_formatName);
+    if (format == "auto")
+    {
+        std::string ext = Utils::tolower(FileUtils::extension(m_filename));
+        format = (ext == ".parquet" || ext == ".pq") ? "parquet" : "ipc";
+    }
+    if (format == "ipc")
+        m_format = Format::Ipc;
+    else if (format == "parquet")
+        m_format = Format::Parquet;
+    else
+        throwError("Invalid format '" + m_formatName + "'.  Must be 'ipc', "
+            "'parquet' or 'auto'.");
+
+    open();
+    if (m_format == Format::Ipc)
+    {
+        m_schema = m_ipcReader->schema();
+        m_numRows = ArrowUtils::value(m_ipcReader->CountRows(), getName());
+    }
+    else
+    {
+        ArrowUtils::check(m_parquetReader->GetSchema(&m_schema), getName());
+        m_numRows = m_parquetReader->parquet_reader()->metadata()->num_rows();
+    }
+
+    // The file is opened again when reading starts.
+    m_ipcReader.reset();
+    m_parquetReader.reset();
+}
+
+
+void ArrowReader::open()
+{
+    if (!FileUtils::fileExists(m_filename))
+        throwError("Unable to open file '" + m_filename + "'.");
+
+    std::shared_ptr<arrow::io::ReadableFile> file = ArrowUtils::value(
+        arrow::io::ReadableFile::Open(m_filename), getName());
+    if (m_format == Format::Ipc)
+        m_ipcReader = ArrowUtils::value(
+            arrow::ipc::RecordBatchFileReader::Open(file), getName());
+    else
+        ArrowUtils::check(parquet::arrow::OpenFile(file,
+            arrow::default_memory_pool(), &m_parquetReader), getName());
+}
+
+
+void ArrowReader::addDimensions(PointLayoutPtr layout)
+{
+    for (const std::shared_ptr<arrow::Field>& field : m_schema->fields())
+    {
+        Dimension::Type type = ArrowUtils::pdalType(*field->type());
+        if (type == Dimension::Type::None)
+        {
+            log()->get(LogLevel::Warning) << getName() << ": Skipping "
+                "column '" << field->name() << "' of unsupported type '" <<
+                field->type()->ToString() << "'." << std::endl;
+            continue;
+        }
+        layout->registerOrAssignDim(field->name(), type);
+    }
+}
+
+
+void ArrowReader::ready(PointTableRef table)
+{
+    m_layout = table.layout();
+    open();
+    if (m_format == Format::Parquet)
+        ArrowUtils::check(
+            m_parquetReader->GetRecordBatchReader(&m_batchReader), getName());
+    m_nextBatch = 0;
+    m_batch.reset();
+    m_cols.clear();
+    m_row = 0;
+}
+
+
+// Make the next non-empty batch the current one.
+bool ArrowReader::nextBatch()
+{
+    m_batch.reset();
+    m_cols.clear();
+    m_row = 0;
+    while (true)
+    {
+        std::shared_ptr<arrow::RecordBatch> batch;
+        if (m_format == Format::Ipc)
+        {
+            if (m_nextBatch >= m_ipcReader->num_record_batches())
+                return false;
+            batch = ArrowUtils::value(
+                m_ipcReader->ReadRecordBatch(m_nextBatch++), getName());
+        }
+        else
+        {
+            ArrowUtils::check(m_batchReader->ReadNext(&batch), getName());
+            if (!batch)
+                return false;
+        }
+        if (batch->num_rows())
+        {
+            m_batch = batch;
+            m_cols = ArrowUtils::columns(*m_layout, *m_batch);
+            return true;
+        }
+    }
+}
+
+
+point_count_t ArrowReader::read(PointViewPtr view, point_count_t count)
+{
+    point_count_t total = 0;
+    while (total < count)
+    {
+        if (!m_batch || m_row >= m_batch->num_rows())
+            if (!nextBatch())
+                break;
+        point_count_t added =
+            ArrowUtils::append(*view, *m_batch, m_row, count - total);
+        // A batch without columns matching dimensions adds nothing.
+        if (added == 0)
+        {
+            m_row = m_batch->num_rows();
+            continue;
+        }
+        m_row += added;
+        total += added;
+    }
+    return total;
+}
+
+
+bool ArrowReader::processOne(PointRef& point)
+{
+    if (!m_batch || m_row >= m_batch->num_rows())
+        if (!nextBatch())
+            return false;
+    ArrowUtils::setPoint(point, m_cols, m_row++);
+    return true;
+}
+
+
+void ArrowReader::done(PointTableRef)
+{
+    m_batch.reset();
+    m_cols.clear();
+    m_batchReader.reset();
+    m_ipcReader.reset();
+    m_parquetReader.reset();
+}
+
+} // namespace pdal
@@ -0,0 +1,111 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (hobu.inc@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <memory>
+
+#include <pdal/Reader.hpp>
+#include <pdal/Streamable.hpp>
+
+#include "ArrowUtils.hpp"
+
+namespace arrow
+{
+namespace ipc
+{
+class RecordBatchFileReader;
+}
+}
+
+namespace parquet
+{
+namespace arrow
+{
+class FileReader;
+}
+}
+
+namespace pdal
+{
+
+class PDAL_DLL ArrowReader : public Reader, public Streamable
+{
+public:
+    ArrowReader();
+    ~ArrowReader();
+    std::string getName() const;
+
+    point_count_t numPoints() const
+        { return m_numRows; }
+
+private:
+    enum class Format
+    {
+        Ipc,
+        Parquet
+    };
+
+    virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
+    virtual void addDimensions(PointLayoutPtr layout);
+    virtual void ready(PointTableRef table);
+    virtual point_count_t read(PointViewPtr view, point_count_t count);
+    virtual bool processOne(PointRef& point);
+    virtual void done(PointTableRef table);
+
+    void open();
+    bool nextBatch();
+
+    std::string m_formatName;
+    Format m_format;
+    point_count_t m_numRows;
+    std::shared_ptr<arrow::Schema> m_schema;
+    PointLayoutPtr m_layout;
+
+    std::shared_ptr<arrow::ipc::RecordBatchFileReader> m_ipcReader;
+    std::unique_ptr<parquet::arrow::FileReader> m_parquetReader;
+    std::unique_ptr<arrow::RecordBatchReader> m_batchReader;
+    int m_nextBatch;  // Index of the next IPC batch.
+
+    std::shared_ptr<arrow::RecordBatch> m_batch;
+    std::vector<ArrowUtils::Column> m_cols;
+    int64_t m_row;  // Next row of the current batch.
+
+    ArrowReader(const ArrowReader&) = delete;
+    ArrowReader& operator=(const ArrowReader&) = delete;
+};
+
+} // namespace pdal
@@ -0,0 +1,230 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (hobu.inc@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include "ArrowUtils.hpp"
+
+#include <pdal/PointTable.hpp>
+
+namespace pdal
+{
+namespace ArrowUtils
+{
+
+std::shared_ptr<arrow::DataType> arrowType(Dimension::Type type)
+{
+    using namespace Dimension;
+
+    switch (type)
+    {
+    case Type::Signed8:
+        return arrow::int8();
+    case Type::Signed16:
+        return arrow::int16();
+    case Type::Signed32:
+        return arrow::int32();
+    case Type::Signed64:
+        return arrow::int64();
+    case Type::Unsigned8:
+        return arrow::uint8();
+    case Type::Unsigned16:
+        return arrow::uint16();
+    case Type::Unsigned32:
+        return arrow::uint32();
+    case Type::Unsigned64:
+        return arrow::uint64();
+    case Type::Float:
+        return arrow::float32();
+    case Type::Double:
+        return arrow::float64();
+    default:
+        return nullptr;
+    }
+}
+
+
+Dimension::Type pdalType(const arrow::DataType& type)
+{
+    using namespace Dimension;
+
+    switch (type.id())
+    {
+    case arrow::Type::INT8:
+        return Type::Signed8;
+    case arrow::Type::INT16:
+        return Type::Signed16;
+    case arrow::Type::INT32:
+        return Type::Signed32;
+    case arrow::Type::INT64:
+        return Type::Signed64;
+    case arrow::Type::UINT8:
+        return Type::Unsigned8;
+    case arrow::Type::UINT16:
+        return Type::Unsigned16;
+    case arrow::Type::UINT32:
+        return Type::Unsigned32;
+    case arrow::Type::UINT64:
+        return Type::Unsigned64;
+    case arrow::Type::FLOAT:
+        return Type::Float;
+    case arrow::Type::DOUBLE:
+        return Type::Double;
+    default:
+        return Type::None;
+    }
+}
+
+
+std::shared_ptr<arrow::Schema> schema(const PointLayout& layout)
+{
+    arrow::FieldVector fields;
+    for (Dimension::Id d : layout.dims())
+        fields.push_back(arrow::field(layout.dimName(d),
+            arrowType(layout.dimType(d)), false));
+    return arrow::schema(fields);
+}
+
+
+std::shared_ptr<arrow::RecordBatch> toRecordBatch(PointView& view,
+    PointId start, point_count_t count)
+{
+    count = (start < view.size()) ?
+        (std::min)(count, view.size() - start) : 0;
+    const PointLayout& layout = *view.layout();
+
+    // Columns of a column table can be wrapped if the view's points are
+    // consecutive in the table.  Scaled dimensions are stored as integers
+    // and are always converted.
+    ColumnPointTable *columns =
+        dynamic_cast<ColumnPointTable *>(&view.table());
+    const PointId first = count ? view.tableId(start) : 0;
+    for (PointId i = 1; columns && i < count; ++i)
+        if (view.tableId(start + i) != first + i)
+            columns = nullptr;
+
+    arrow::ArrayVector arrays;
+    for (Dimension::Id d : layout.dims())
+    {
+        const Dimension::Type type = layout.dimType(d);
+        const size_t size = Dimension::size(type);
+
+        std::shared_ptr<arrow::Buffer> buf;
+        if (columns && !layout.dimDetail(d)->scaled())
+            buf = std::make_shared<arrow::Buffer>(
+                (const uint8_t *)(columns->column(d) + first * size),
+                (int64_t)(count * size));
+        else
+        {
+            auto result = arrow::AllocateBuffer((int64_t)(count * size));
+            if (!result.ok())
+                throw pdal_error("Can't allocate Arrow buffer: " +
+                    result.status().ToString());
+            buf = std::move(result).ValueOrDie();
+            char *p = (char *)buf->mutable_data();
+            for (PointId i = 0; i < count; ++i)
+            {
+                view.getField(p, d, type, start + i);
+                p += size;
+            }
+        }
+        arrays.push_back(arrow::MakeArray(arrow::ArrayData::Make(
+            arrowType(type), (int64_t)count, { nullptr, buf }, 0)));
+    }
+    return arrow::RecordBatch::Make(schema(layout), (int64_t)count, arrays);
+}
+
+
+std::vector<Column> columns(const PointLayout& layout,
+    const arrow::RecordBatch& batch)
+{
+    std::vector<Column> cols;
+    for (int i = 0; i < batch.num_columns(); ++i)
+    {
+        const Dimension::Id id =
+            layout.findDim(batch.schema()->field(i)->name());
+        if (id == Dimension::Id::Unknown)
+            continue;
+
+        const std::shared_ptr<arrow::Array> array = batch.column(i);
+        const Dimension::Type type = pdalType(*array->type());
+        const std::shared_ptr<arrow::ArrayData>& data = array->data();
+        if (type == Dimension::Type::None || data->buffers.size() < 2 ||
+                !data->buffers[1])
+            continue;
+
+        Column c;
+        c.m_id = id;
+        c.m_type = type;
+        c.m_data = (const char *)data->buffers[1]->data() +
+            data->offset * Dimension::size(type);
+        c.m_array = array;
+        cols.push_back(c);
+    }
+    return cols;
+}
+
+
+void setPoint(PointRef& point, const std::vector<Column>& cols, int64_t row)
+{
+    for (const Column& c : cols)
+    {
+        if (c.m_array->null_count() && c.m_array->IsNull(row))
+            point.setField(c.m_id, 0);
+        else
+            point.setField(c.m_id, c.m_type,
+                c.m_data + row * Dimension::size(c.m_type));
+    }
+}
+
+
+point_count_t append(PointView& view, const arrow::RecordBatch& batch,
+    int64_t start, point_count_t count)
+{
+    const std::vector<Column> cols = columns(*view.layout(), batch);
+    if (cols.empty() || start >= batch.num_rows())
+        return 0;
+    count = (std::min)(count, (point_count_t)(batch.num_rows() - start));
+
+    PointId idx = view.size();
+    PointRef point(view, idx);
+    for (point_count_t i = 0; i < count; ++i)
+    {
+        point.setPointId(idx + i);
+        setPoint(point, cols, start + i);
+    }
+    return count;
+}
+
+} // namespace ArrowUtils
+} // namespace pdal
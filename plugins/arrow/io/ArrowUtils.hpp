@@ -0,0 +1,168 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (hobu.inc@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <arrow/api.h>
+
+#include <pdal/PointView.hpp>
+
+namespace pdal
+{
+
+// Conversion between point views and Arrow record batches, for applications
+// that embed PDAL in an Arrow-based stack.  Each dimension is a column
+// named for the dimension and holding values of the dimension's type.
+namespace ArrowUtils
+{
+
+/**
+  Find the Arrow type that holds values of a dimension type.
+
+  \param type  Dimension type.
+  \return  Arrow type, or nullptr if there's none.
+*/
+PDAL_DLL std::shared_ptr<arrow::DataType> arrowType(Dimension::Type type);
+
+/**
+  Find the dimension type that holds values of an Arrow type.  Only
+  integer and floating point types, other than half floats, have one.
+
+  \param type  Arrow type.
+  \return  Dimension type, or Dimension::Type::None if there's none.
+*/
+PDAL_DLL Dimension::Type pdalType(const arrow::DataType& type);
+
+/**
+  Make the schema of record batches holding the points of a layout.
+
+  \param layout  Layout of the points.
+  \return  Schema with a field for each dimension, in layout order.
+*/
+PDAL_DLL std::shared_ptr<arrow::Schema> schema(const PointLayout& layout);
+
+/**
+  Make a record batch holding points of a view.  When the view's points
+  are consecutive points of a ColumnPointTable, the columns wrap the
+  table's storage rather than copying it.  The batch is then only valid
+  until points are added to the table or the table is destroyed.
+
+  \param view  View holding the points.
+  \param start  Index in the view of the first point.
+  \param count  Number of points.  Points past the end of the view aren't
+    included.
+  \return  Record batch with the schema of the view's layout.
+*/
+PDAL_DLL std::shared_ptr<arrow::RecordBatch> toRecordBatch(PointView& view,
+    PointId start = 0,
+    point_count_t count = (std::numeric_limits<point_count_t>::max)());
+
+// Values of a column of a record batch and the dimension they're read into.
+struct Column
+{
+    Dimension::Id m_id;
+    Dimension::Type m_type;
+    const char *m_data;
+    std::shared_ptr<arrow::Array> m_array;
+};
+
+/**
+  Match the columns of a record batch to the dimensions of a layout by
+  name.  Columns without a dimension or of types without a dimension type
+  are skipped.
+
+  \param layout  Layout of the points.
+  \param batch  Record batch.
+  \return  Columns read into dimensions.
+*/
+PDAL_DLL std::vector<Column> columns(const PointLayout& layout,
+    const arrow::RecordBatch& batch);
+
+/**
+  Copy a row of a record batch to a point.  Null values are read as 0.
+
+  \param point  Point to set.
+  \param cols  Columns of the batch, as returned by columns().
+  \param row  Index of the row.
+*/
+PDAL_DLL void setPoint(PointRef& point, const std::vector<Column>& cols,
+    int64_t row);
+
+/**
+  Append the rows of a record batch to a view as points.  Columns are
+  matched to dimensions as they are by columns().
+
+  \param view  View to which points are added.
+  \param batch  Record batch.
+  \param start  Index of the first row to add.
+  \param count  Number of rows to add.  Rows past the end of the batch
+    aren't added.
+  \return  Number of points added.
+*/
+PDAL_DLL point_count_t append(PointView& view,
+    const arrow::RecordBatch& batch, int64_t start = 0,
+    point_count_t count = (std::numeric_limits<point_count_t>::max)());
+
+/**
+  Throw if an Arrow operation failed.
+
+  \param status  Status of the operation.
+  \param stage  Name of the stage, which prefixes the error message.
+*/
+inline void check(const arrow::Status& status, const std::string& stage)
+{
+    if (!status.ok())
+        throw pdal_error(stage + ": " + status.ToString());
+}
+
+/**
+  Get the value of an Arrow operation, throwing if it failed.
+
+  \param result  Result of the operation.
+  \param stage  Name of the stage, which prefixes the error message.
+  \return  Value of the result.
+*/
+template<typename T>
+T value(arrow::Result<T> result, const std::string& stage)
+{
+    check(result.status(), stage);
+    return result.MoveValueUnsafe();
+}
+
+} // namespace ArrowUtils
+} // namespace pdal
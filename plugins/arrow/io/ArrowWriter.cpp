@@ -0,0 +1,154 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (hobu.inc@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include <arrow/io/file.h>
+#include <arrow/ipc/writer.h>
+#include <parquet/arrow/writer.h>
+#include <parquet/properties.h>
+
+#include <pdal/util/FileUtils.hpp>
+
+#include "ArrowWriter.hpp"
+
+namespace pdal
+{
+
+static PluginInfo const s_info
+{
+    "writers.arrow",
+    "Write points to Apache Arrow IPC (Feather) or Parquet files.",
+    "http://pdal.io/stages/writers.arrow.html"
+};
+
+CREATE_SHARED_STAGE(ArrowWriter, s_info)
+std::string ArrowWriter::getName() const { return s_info.name; }
+
+ArrowWriter::ArrowWriter() : m_format(Format::Ipc), m_batchSize(0)
+{}
+
+
+ArrowWriter::~ArrowWriter()
+{}
+
+
+void ArrowWriter::addArgs(ProgramArgs& args)
+{
+    args.add("filename", "Output filename", m_filename).setPositional();
+    args.add("format", "File format: 'ipc', 'parquet' or 'auto'.  'auto' "
+        "writes files with the extension .parquet or .pq as Parquet and "
+        "others as Arrow IPC.", m_formatName, "auto");
+    args.add("batch_size", "Maximum number of points in a record batch "
+        "or Parquet row group", m_batchSize, point_count_t(65536));
+}
+
+
+void ArrowWriter::initialize()
+{
+    std::string format = Utils::tolower(m_formatName);
+    if (format == "auto")
+    {
+        std::string ext = Utils::tolower(FileUtils::extension(m_filename));
+        format = (ext == ".parquet" || ext == ".pq") ? "parquet" : "ipc";
+    }
+    if (format == "ipc")
+        m_format = Format::Ipc;
+    else if (format == "parquet")
+        m_format = Format::Parquet;
+    else
+        throwError("Invalid format '" + m_formatName + "'.  Must be 'ipc', "
+            "'parquet' or 'auto'.");
+
+    if (m_batchSize == 0)
+        throwError("Option 'batch_size' must be greater than 0.");
+}
+
+
+void ArrowWriter::ready(PointTableRef table)
+{
+    m_schema = ArrowUtils::schema(*table.layout());
+    m_stream = ArrowUtils::value(
+        arrow::io::FileOutputStream::Open(m_filename), getName());
+
+    if (m_format == Format::Ipc)
+    {
+        m_ipcWriter = ArrowUtils::value(
+            arrow::ipc::MakeFileWriter(m_stream, m_schema), getName());
+    }
+    else
+    {
+        std::shared_ptr<parquet::WriterProperties> props =
+            parquet::WriterProperties::Builder().
+                max_row_group_length(m_batchSize)->build();
+        m_parquetWriter = ArrowUtils::value(
+            parquet::arrow::FileWriter::Open(*m_schema,
+                arrow::default_memory_pool(), m_stream, props), getName());
+    }
+}
+
+
+void ArrowWriter::write(const PointViewPtr view)
+{
+    for (PointId idx = 0; idx < view->size(); idx += m_batchSize)
+    {
+        std::shared_ptr<arrow::RecordBatch> batch =
+            ArrowUtils::toRecordBatch(*view, idx, m_batchSize);
+
+        // Batches that wrap the point table are written before
+        // anything can be added to it.
+        if (m_format == Format::Ipc)
+            ArrowUtils::check(m_ipcWriter->WriteRecordBatch(*batch),
+                getName());
+        else
+            ArrowUtils::check(m_parquetWriter->WriteRecordBatch(*batch),
+                getName());
+    }
+}
+
+
+void ArrowWriter::done(PointTableRef)
+{
+    if (m_ipcWriter)
+        ArrowUtils::check(m_ipcWriter->Close(), getName());
+    if (m_parquetWriter)
+        ArrowUtils::check(m_parquetWriter->Close(), getName());
+    ArrowUtils::check(m_stream->Close(), getName());
+
+    m_ipcWriter.reset();
+    m_parquetWriter.reset();
+    m_stream.reset();
+    getMetadata().addList("filename", m_filename);
+}
+
+} // namespace pdal
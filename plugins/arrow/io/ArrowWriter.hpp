@@ -0,0 +1,101 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (hobu.inc@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <memory>
+
+#include <pdal/Writer.hpp>
+
+#include "ArrowUtils.hpp"
+
+namespace arrow
+{
+namespace io
+{
+class FileOutputStream;
+}
+namespace ipc
+{
+class RecordBatchWriter;
+}
+}
+
+namespace parquet
+{
+namespace arrow
+{
+class FileWriter;
+}
+}
+
+namespace pdal
+{
+
+class PDAL_DLL ArrowWriter : public Writer
+{
+public:
+    ArrowWriter();
+    ~ArrowWriter();
+    std::string getName() const;
+
+private:
+    enum class Format
+    {
+        Ipc,
+        Parquet
+    };
+
+    virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
+    virtual void ready(PointTableRef table);
+    virtual void write(const PointViewPtr view);
+    virtual void done(PointTableRef table);
+
+    std::string m_filename;
+    std::string m_formatName;
+    Format m_format;
+    point_count_t m_batchSize;
+
+    std::shared_ptr<arrow::Schema> m_schema;
+    std::shared_ptr<arrow::io::FileOutputStream> m_stream;
+    std::shared_ptr<arrow::ipc::RecordBatchWriter> m_ipcWriter;
+    std::unique_ptr<parquet::arrow::FileWriter> m_parquetWriter;
+
+    ArrowWriter(const ArrowWriter&) = delete;
+    ArrowWriter& operator=(const ArrowWriter&) = delete;
+};
+
+} // namespace pdal
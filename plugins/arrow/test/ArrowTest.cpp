@@ -0,0 +1,216 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (hobu.inc@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <pdal/PointTable.hpp>
+#include <pdal/PointView.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <io/FauxReader.hpp>
+
+#include "Support.hpp"
+
+#include "../io/ArrowReader.hpp"
+#include "../io/ArrowWriter.hpp"
+#include "../io/ArrowUtils.hpp"
+
+namespace pdal
+{
+
+namespace
+{
+
+void roundTrip(const std::string& filename, const std::string& format)
+{
+    FileUtils::deleteFile(filename);
+
+    Options readerOps;
+    readerOps.add("bounds", BOX3D(1, 2, 3, 1000, 2000, 3000));
+    readerOps.add("count", 1000);
+    readerOps.add("mode", "ramp");
+    FauxReader reader;
+    reader.setOptions(readerOps);
+
+    Options writerOps;
+    writerOps.add("filename", filename);
+    writerOps.add("format", format);
+    writerOps.add("batch_size", 300);
+    ArrowWriter writer;
+    writer.setOptions(writerOps);
+    writer.setInput(reader);
+
+    PointTable table;
+    writer.prepare(table);
+    PointViewSet s = writer.execute(table);
+    PointViewPtr in = *s.begin();
+
+    Options ops;
+    ops.add("filename", filename);
+    ops.add("format", format);
+    ArrowReader r;
+    r.setOptions(ops);
+
+    PointTable table2;
+    r.prepare(table2);
+    EXPECT_EQ(r.numPoints(), 1000U);
+    s = r.execute(table2);
+    EXPECT_EQ(s.size(), 1U);
+    PointViewPtr out = *s.begin();
+    ASSERT_EQ(out->size(), in->size());
+
+    for (const Dimension::Id dim : table.layout()->dims())
+    {
+        Dimension::Id dim2 = table2.layout()->findDim(
+            table.layout()->dimName(dim));
+        EXPECT_EQ(table.layout()->dimType(dim), table2.layout()->dimType(dim2));
+        for (PointId idx = 0; idx < in->size(); ++idx)
+            EXPECT_DOUBLE_EQ(in->getFieldAs<double>(dim, idx),
+                out->getFieldAs<double>(dim2, idx));
+    }
+}
+
+} // unnamed namespace
+
+TEST(ArrowTest, ipc)
+{
+    roundTrip(Support::temppath("arrow_test.arrow"), "auto");
+}
+
+TEST(ArrowTest, parquet)
+{
+    roundTrip(Support::temppath("arrow_test.parquet"), "auto");
+    roundTrip(Support::temppath("arrow_test.bin"), "parquet");
+}
+
+TEST(ArrowTest, badFormat)
+{
+    Options ops;
+    ops.add("filename", Support::temppath("arrow_test.arrow"));
+    ops.add("format", "csv");
+    ArrowWriter writer;
+    writer.setOptions(ops);
+
+    PointTable table;
+    EXPECT_THROW(writer.prepare(table), pdal_error);
+}
+
+// Record batches made from the consecutive points of a column table wrap
+// its columns.  Other batches hold copies.
+TEST(ArrowTest, recordBatch)
+{
+    ColumnPointTable table;
+    PointLayoutPtr layout = table.layout();
+    layout->registerDim(Dimension::Id::X);
+    layout->registerDim(Dimension::Id::Intensity);
+
+    PointView view(table);
+    for (PointId idx = 0; idx < 100; ++idx)
+    {
+        view.setField(Dimension::Id::X, idx, idx * 1.5);
+        view.setField(Dimension::Id::Intensity, idx, idx + 10);
+    }
+
+    std::shared_ptr<arrow::RecordBatch> batch =
+        ArrowUtils::toRecordBatch(view, 10, 20);
+    ASSERT_EQ(batch->num_rows(), 20);
+    ASSERT_EQ(batch->num_columns(), 2);
+    EXPECT_EQ(batch->schema()->field(0)->name(), "X");
+    EXPECT_TRUE(batch->column(0)->type()->Equals(arrow::float64()));
+    EXPECT_TRUE(batch->column(1)->type()->Equals(arrow::uint16()));
+
+    auto x = std::static_pointer_cast<arrow::DoubleArray>(batch->column(0));
+    EXPECT_EQ(reinterpret_cast<const char *>(x->raw_values()),
+        table.column(Dimension::Id::X) + 10 * sizeof(double));
+
+    // Reversed points aren't consecutive in the table.
+    PointView reversed(table);
+    for (PointId idx = 0; idx < 100; ++idx)
+        reversed.appendPoint(view, 99 - idx);
+    batch = ArrowUtils::toRecordBatch(reversed);
+    ASSERT_EQ(batch->num_rows(), 100);
+    x = std::static_pointer_cast<arrow::DoubleArray>(batch->column(0));
+    EXPECT_DOUBLE_EQ(x->Value(0), 99 * 1.5);
+
+    PointTable table2;
+    table2.layout()->registerDim(Dimension::Id::X);
+    table2.layout()->registerDim(Dimension::Id::Intensity);
+    PointView out(table2);
+    EXPECT_EQ(ArrowUtils::append(out, *batch, 90), 10U);
+    ASSERT_EQ(out.size(), 10U);
+    for (PointId idx = 0; idx < out.size(); ++idx)
+    {
+        EXPECT_DOUBLE_EQ(out.getFieldAs<double>(Dimension::Id::X, idx),
+            (9 - idx) * 1.5);
+        EXPECT_EQ(out.getFieldAs<uint16_t>(Dimension::Id::Intensity, idx),
+            19 - idx);
+    }
+}
+
+// Scaled columns are stored as integers, so they're converted rather than
+// wrapped.
+TEST(ArrowTest, recordBatchScaled)
+{
+    ColumnPointTable table;
+    PointLayoutPtr layout = table.layout();
+    XForm xform(.5, 100);
+    layout->setScaling(xform, xform, xform);
+    layout->registerDim(Dimension::Id::X);
+    layout->registerDim(Dimension::Id::Intensity);
+
+    PointView view(table);
+    for (PointId idx = 0; idx < 100; ++idx)
+    {
+        view.setField(Dimension::Id::X, idx, idx * 1.5);
+        view.setField(Dimension::Id::Intensity, idx, idx + 10);
+    }
+
+    std::shared_ptr<arrow::RecordBatch> batch =
+        ArrowUtils::toRecordBatch(view, 10, 20);
+    ASSERT_EQ(batch->num_rows(), 20);
+    EXPECT_TRUE(batch->column(0)->type()->Equals(arrow::float64()));
+    auto x = std::static_pointer_cast<arrow::DoubleArray>(batch->column(0));
+    EXPECT_NE(reinterpret_cast<const char *>(x->raw_values()),
+        table.column(Dimension::Id::X) + 10 * sizeof(int32_t));
+    for (int64_t i = 0; i < batch->num_rows(); ++i)
+        EXPECT_DOUBLE_EQ(x->Value(i), (i + 10) * 1.5);
+
+    // Unscaled columns are still wrapped.
+    auto intensity =
+        std::static_pointer_cast<arrow::UInt16Array>(batch->column(1));
+    EXPECT_EQ(reinterpret_cast<const char *>(intensity->raw_values()),
+        table.column(Dimension::Id::Intensity) + 10 * sizeof(uint16_t));
+}
+
+} // namespace pdal
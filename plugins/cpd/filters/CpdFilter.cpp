@@ -33,15 +33,179 @@
  ****************************************************************************/
 
 #include <cpd/affine.hpp>
+#include <cpd/gauss_transform.hpp>
+#ifdef PDAL_HAVE_CPD_FGT
+#include <cpd/gauss_transform_fgt.hpp>
+#endif
 #include <cpd/nonrigid.hpp>
 #include <cpd/rigid.hpp>
 #include <filters/CpdFilter.hpp>
+#include <filters/private/VoxelMap.hpp>
 #include <pdal/EigenUtils.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+#include <cmath>
+#include <mutex>
 
 namespace pdal
 {
 namespace
 {
+
+// The direct Gauss transform (the E-step of each CPD iteration), with the
+// rows of the fixed points split among threads.  This computes the same
+// sums as cpd::GaussTransformDirect.
+class ParallelGaussTransform : public cpd::GaussTransform
+{
+public:
+    cpd::Probabilities compute(const cpd::Matrix& fixed,
+        const cpd::Matrix& moving, double sigma2, double outliers) const
+    {
+        typedef cpd::Matrix::Index Index;
+
+        const double ksig = -2.0 * sigma2;
+        const Index cols = fixed.cols();
+        const Index numFixed = fixed.rows();
+        const Index numMoving = moving.rows();
+        const double outlierTmp = (outliers * numMoving *
+            std::pow(-ksig * M_PI, 0.5 * cols)) /
+            ((1 - outliers) * numFixed);
+
+        // Sums over the fixed points handled by one thread.
+        struct Partial
+        {
+            Partial(Index numMoving, Index cols) :
+                p1(cpd::Vector::Zero(numMoving)),
+                p1Max(cpd::Vector::Zero(numMoving)),
+                px(cpd::Matrix::Zero(numMoving, cols)),
+                correspondence(cpd::IndexVector::Zero(numMoving)), l(0)
+            {}
+
+            cpd::Vector p1;
+            cpd::Vector p1Max;
+            cpd::Matrix px;
+            cpd::IndexVector correspondence;
+            double l;
+        };
+
+        cpd::Vector pt1 = cpd::Vector::Zero(numFixed);
+        std::vector<std::unique_ptr<Partial>> partials;
+        std::mutex mutex;
+
+        parallelFor((size_t)numFixed, [&]()
+        {
+            Partial *part = new Partial(numMoving, cols);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                partials.emplace_back(part);
+            }
+            auto p = std::make_shared<cpd::Vector>(numMoving);
+            return [&, part, p](size_t row)
+            {
+                const Index i = (Index)row;
+                double sp = 0;
+                for (Index j = 0; j < numMoving; ++j)
+                {
+                    double razn =
+                        (fixed.row(i) - moving.row(j)).squaredNorm();
+                    (*p)(j) = std::exp(razn / ksig);
+                    sp += (*p)(j);
+                }
+                sp += outlierTmp;
+                pt1(i) = 1 - outlierTmp / sp;
+                for (Index j = 0; j < numMoving; ++j)
+                {
+                    double v = (*p)(j) / sp;
+                    part->p1(j) += v;
+                    part->px.row(j) += fixed.row(i) * v;
+                    if (v > part->p1Max(j) ||
+                        (v == part->p1Max(j) && i < part->correspondence(j)))
+                    {
+                        part->correspondence(j) = i;
+                        part->p1Max(j) = v;
+                    }
+                }
+                part->l += -std::log(sp);
+            };
+        }, 16);
+
+        cpd::Probabilities probabilities;
+        probabilities.p1 = cpd::Vector::Zero(numMoving);
+        probabilities.pt1 = pt1;
+        probabilities.px = cpd::Matrix::Zero(numMoving, cols);
+        probabilities.correspondence = cpd::IndexVector::Zero(numMoving);
+        probabilities.l = cols * numFixed * std::log(sigma2) / 2;
+
+        cpd::Vector p1Max = cpd::Vector::Zero(numMoving);
+        for (auto& part : partials)
+        {
+            probabilities.p1 += part->p1;
+            probabilities.px += part->px;
+            probabilities.l += part->l;
+            for (Index j = 0; j < numMoving; ++j)
+            {
+                Index c = part->correspondence(j);
+                double v = part->p1Max(j);
+                if (v > p1Max(j) || (v == p1Max(j) &&
+                    c < probabilities.correspondence(j)))
+                {
+                    probabilities.correspondence(j) = c;
+                    p1Max(j) = v;
+                }
+            }
+        }
+        return probabilities;
+    }
+};
+
+// Replace the points of each voxel with their centroid.
+cpd::Matrix voxelize(const PointView& view, double cell)
+{
+    BOX3D bounds;
+    view.calculateBounds(bounds);
+    const VoxelKey voxel(bounds, cell);
+    if (!voxel.fits())
+        throw pdal_error("filters.cpd: Option 'voxel' is too small for "
+            "the extent of the fixed points.");
+
+    struct Sum
+    {
+        Sum() : m_x(0), m_y(0), m_z(0), m_count(0)
+        {}
+
+        double m_x;
+        double m_y;
+        double m_z;
+        point_count_t m_count;
+    };
+
+    VoxelMap<Sum> voxels;
+    for (PointId id = 0; id < view.size(); ++id)
+    {
+        double x = view.getFieldAs<double>(Dimension::Id::X, id);
+        double y = view.getFieldAs<double>(Dimension::Id::Y, id);
+        double z = view.getFieldAs<double>(Dimension::Id::Z, id);
+        Sum& sum = voxels[voxel.key(voxel.col(x), voxel.row(y),
+            voxel.depth(z))];
+        sum.m_x += x - bounds.minx;
+        sum.m_y += y - bounds.miny;
+        sum.m_z += z - bounds.minz;
+        sum.m_count++;
+    }
+
+    // Sort by key so the order of the points doesn't depend on hashing.
+    std::vector<VoxelMap<Sum>::Entry> entries = voxels.sorted();
+    cpd::Matrix matrix(entries.size(), 3);
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        const Sum& sum = entries[i].second;
+        matrix(i, 0) = bounds.minx + sum.m_x / sum.m_count;
+        matrix(i, 1) = bounds.miny + sum.m_y / sum.m_count;
+        matrix(i, 2) = bounds.minz + sum.m_z / sum.m_count;
+    }
+    return matrix;
+}
+
 void movePoints(PointViewPtr moving, const cpd::Matrix& result)
 {
     assert(moving->size() == (point_count_t)result.rows());
@@ -80,6 +244,47 @@ void CpdFilter::addArgs(ProgramArgs& args)
 {
     args.add("method", "CPD method (rigid, nonrigid, or affine)", m_method,
              "rigid");
+    args.add("gauss_transform", "Gauss transform used for the E-step "
+        "(direct or fgt)", m_gaussTransform, "direct");
+    args.add("voxel", "Edge length of the voxels used to downsample the "
+        "fixed points (0 disables downsampling)", m_voxel, 0.0);
+}
+
+void CpdFilter::initialize()
+{
+    if (m_gaussTransform == "fgt")
+    {
+#ifndef PDAL_HAVE_CPD_FGT
+        throwError("Option 'gauss_transform' can't be 'fgt': the cpd "
+            "library was built without fgt support.");
+#endif
+    }
+    else if (m_gaussTransform != "direct")
+        throwError("Invalid value for option 'gauss_transform': '" +
+            m_gaussTransform + "'.  Must be 'direct' or 'fgt'.");
+    if (m_voxel < 0)
+        throwError("Option 'voxel' can't be negative.");
+}
+
+std::unique_ptr<cpd::GaussTransform> CpdFilter::gaussTransform() const
+{
+#ifdef PDAL_HAVE_CPD_FGT
+    if (m_gaussTransform == "fgt")
+        return std::unique_ptr<cpd::GaussTransform>(
+            new cpd::GaussTransformFgt());
+#endif
+    return std::unique_ptr<cpd::GaussTransform>(new ParallelGaussTransform());
+}
+
+cpd::Matrix CpdFilter::fixedMatrix(PointViewPtr fixed) const
+{
+    if (m_voxel == 0)
+        return eigen::pointViewToEigen(*fixed);
+
+    cpd::Matrix matrix = voxelize(*fixed, m_voxel);
+    log()->get(LogLevel::Debug) << "Downsampled " << fixed->size() <<
+        " fixed points to " << matrix.rows() << "." << std::endl;
+    return matrix;
 }
 
 std::string CpdFilter::defaultMethod()
@@ -149,9 +354,10 @@ PointViewPtr CpdFilter::change(PointViewPtr fixed, PointViewPtr moving)
 
 void CpdFilter::cpd_rigid(PointViewPtr fixed, PointViewPtr moving)
 {
-    cpd::Matrix fixedMatrix = eigen::pointViewToEigen(*fixed);
+    cpd::Rigid rigid;
+    rigid.gauss_transform(gaussTransform());
     cpd::Matrix movingMatrix = eigen::pointViewToEigen(*moving);
-    cpd::RigidResult result = cpd::rigid(fixedMatrix, movingMatrix);
+    cpd::RigidResult result = rigid.run(fixedMatrix(fixed), movingMatrix);
     movePoints(moving, result.points);
     addMetadata(this, static_cast<cpd::Result>(result));
     MetadataNode root = getMetadata();
@@ -160,9 +366,10 @@ void CpdFilter::cpd_rigid(PointViewPtr fixed, PointViewPtr moving)
 
 void CpdFilter::cpd_affine(PointViewPtr fixed, PointViewPtr moving)
 {
-    cpd::Matrix fixedMatrix = eigen::pointViewToEigen(*fixed);
+    cpd::Affine affine;
+    affine.gauss_transform(gaussTransform());
     cpd::Matrix movingMatrix = eigen::pointViewToEigen(*moving);
-    cpd::AffineResult result = cpd::affine(fixedMatrix, movingMatrix);
+    cpd::AffineResult result = affine.run(fixedMatrix(fixed), movingMatrix);
     movePoints(moving, result.points);
     MetadataNode root = getMetadata();
     root.add("transform", result.matrix());
@@ -170,9 +377,10 @@ void CpdFilter::cpd_affine(PointViewPtr fixed, PointViewPtr moving)
 
 void CpdFilter::cpd_nonrigid(PointViewPtr fixed, PointViewPtr moving)
 {
-    cpd::Matrix fixedMatrix = eigen::pointViewToEigen(*fixed);
+    cpd::Nonrigid nonrigid;
+    nonrigid.gauss_transform(gaussTransform());
     cpd::Matrix movingMatrix = eigen::pointViewToEigen(*moving);
-    cpd::NonrigidResult result = cpd::nonrigid(fixedMatrix, movingMatrix);
+    cpd::NonrigidResult result = nonrigid.run(fixedMatrix(fixed), movingMatrix);
     movePoints(moving, result.points);
 }
 }
@@ -36,6 +36,10 @@
 
 #include <pdal/Filter.hpp>
 
+#include <memory>
+
+#include <cpd/gauss_transform.hpp>
+
 namespace pdal
 {
 
@@ -44,7 +48,8 @@ class PDAL_DLL CpdFilter : public Filter
   public:
     static std::string defaultMethod();
 
-    CpdFilter() : Filter(), m_fixed(nullptr), m_method(""), m_complete(false)
+    CpdFilter() : Filter(), m_fixed(nullptr), m_method(""), m_complete(false),
+        m_voxel(0)
     {
     }
     std::string getName() const;
@@ -53,16 +58,21 @@ class PDAL_DLL CpdFilter : public Filter
 
   private:
     virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
     virtual void done(PointTableRef _);
 
     PointViewPtr change(PointViewPtr fixed, PointViewPtr moving);
     void cpd_rigid(PointViewPtr fixed, PointViewPtr moving);
     void cpd_affine(PointViewPtr fixed, PointViewPtr moving);
     void cpd_nonrigid(PointViewPtr fixed, PointViewPtr moving);
+    std::unique_ptr<cpd::GaussTransform> gaussTransform() const;
+    cpd::Matrix fixedMatrix(PointViewPtr fixed) const;
 
     PointViewPtr m_fixed;
     std::string m_method;
     bool m_complete;
+    std::string m_gaussTransform;
+    double m_voxel;
 
     CpdFilter& operator=(const CpdFilter&); // not implemented
     CpdFilter(const CpdFilter&);            // not implemented
@@ -199,4 +199,53 @@ TEST(CpdFilterTest, NonrigidNoThrow)
 {
     checkNoThrow("nonrigid");
 }
+
+TEST(CpdFilterTest, VoxelRecoverTranslation)
+{
+    auto reader1 = newReader();
+    auto reader2 = newReader();
+    TransformationFilter transformationFilter;
+    Options transformationOptions;
+    transformationOptions.add("matrix", "1 0 0 1\n0 1 0 2\n0 0 1 3\n0 0 0 1");
+    transformationFilter.setOptions(transformationOptions);
+    transformationFilter.setInput(*reader2);
+
+    // A cell smaller than the point spacing keeps every fixed point, so
+    // the translation should still be recovered.
+    auto filter = newFilter();
+    Options options;
+    options.add("voxel", 0.01);
+    filter->setOptions(options);
+    filter->setInput(*reader1);
+    filter->setInput(transformationFilter);
+
+    PointTable table;
+    filter->prepare(table);
+    PointViewSet pointViewSet = filter->execute(table);
+
+    MetadataNode root = filter->getMetadata();
+    Eigen::MatrixXd transform =
+        root.findChild("transform").value<Eigen::MatrixXd>();
+    double tolerance = 1e-4;
+    EXPECT_NEAR(-1.0, transform(0, 3), tolerance);
+    EXPECT_NEAR(-2.0, transform(1, 3), tolerance);
+    EXPECT_NEAR(-3.0, transform(2, 3), tolerance);
+    checkPointsEqualReader(pointViewSet, tolerance);
+}
+
+TEST(CpdFilterTest, InvalidGaussTransform)
+{
+    auto reader1 = newReader();
+    auto reader2 = newReader();
+    auto filter = newFilter();
+    filter->setInput(*reader1);
+    filter->setInput(*reader2);
+
+    Options options;
+    options.add("gauss_transform", "lowrank");
+    filter->setOptions(options);
+
+    PointTable table;
+    ASSERT_THROW(filter->prepare(table), pdal_error);
+}
 } // namespace pdal
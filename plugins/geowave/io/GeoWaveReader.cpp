@@ -33,7 +33,14 @@
 ****************************************************************************/
 
 #include "GeoWaveReader.hpp"
+#include <pdal/PointView.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <thread>
 
 #include <jace/Jace.h>
 using jace::java_cast;
@@ -172,6 +179,8 @@ std::string pdal::GeoWaveReader::getName() const { return s_info.name; }
         args.add("bounds", "The extent of the bounding rectangle to use "
             "to query points, expressed as a string, eg: "
             "([xmin, xmax], [ymin, ymax], [zmin, zmax])", m_bounds);
+        args.add("threads", "Number of ranges of the bounds to scan "
+            "concurrently.  The default is the number of cores.", m_threads);
     }
 
     void GeoWaveReader::initialize()
@@ -223,18 +232,21 @@ std::string pdal::GeoWaveReader::getName() const { return s_info.name; }
         else
             attribs = java_cast<FeatureDataAdapter>(accumuloAdapterStore.getAdapter(java_new<ByteArrayId>(m_featureTypeName))).getType().getAttributeDescriptors();
 
+        m_attributes.clear();
         for (int i = 0; i < attribs.size(); ++i){
             std::string name = java_cast<AttributeDescriptor>(attribs.get(i)).getLocalName();
-            if (name.compare("location") != 0 && name.compare("X") != 0 && name.compare("Y") != 0)
+            if (name.compare("location") == 0)
+                continue;
+            m_attributes.push_back(name);
+            if (name.compare("X") != 0 && name.compare("Y") != 0)
                 layout->registerDim(Dimension::id(name));
         }
     }
 
-    void GeoWaveReader::ready(PointTableRef table)
+    // Start a query of the points inside 'bounds'.  Returns false if the
+    // store can't be reached.
+    bool GeoWaveReader::query(const BOX2D& bounds, CloseableIterator& iterator)
     {
-        if (m_bounds.empty())
-            return;
-
         BasicAccumuloOperations accumuloOperations;
         try
         {
@@ -248,12 +260,12 @@ std::string pdal::GeoWaveReader::getName() const { return s_info.name; }
         catch (AccumuloException& e)
         {
             log()->get(LogLevel::Error) << "There was a problem establishing a connector. " << e;
-            return;
+            return false;
         }
         catch (AccumuloSecurityException& e)
         {
             log()->get(LogLevel::Error) << "The credentials passed are invalid. " << e;
-            return;
+            return false;
         }
 
         AccumuloDataStore accumuloDataStore = java_new<AccumuloDataStore>(
@@ -263,10 +275,10 @@ std::string pdal::GeoWaveReader::getName() const { return s_info.name; }
 
         GeometryFactory factory = java_new<GeometryFactory>();
 
-        JDouble lonMin = m_bounds.minx;
-        JDouble lonMax = m_bounds.maxx;
-        JDouble latMin = m_bounds.miny;
-        JDouble latMax = m_bounds.maxy;
+        JDouble lonMin = bounds.minx;
+        JDouble lonMax = bounds.maxx;
+        JDouble latMin = bounds.miny;
+        JDouble latMax = bounds.maxy;
 
         JArray<Coordinate> coordArray(5);
         coordArray[0] = java_new<Coordinate>(lonMin, latMin);
@@ -279,69 +291,157 @@ std::string pdal::GeoWaveReader::getName() const { return s_info.name; }
         Query query = java_new<SpatialQuery>(geom);
 
         JInt count = m_count;
-        m_iterator = accumuloDataStore.query(index, query, count);
+        iterator = accumuloDataStore.query(index, query, count);
+        return true;
     }
 
-    point_count_t GeoWaveReader::read(PointViewPtr view, point_count_t count)
+    void GeoWaveReader::ready(PointTableRef table)
+    {
+        m_ids.clear();
+        for (const std::string& name : m_attributes)
+            m_ids.push_back(Dimension::id(name));
+    }
+
+    // Scan the points of one range of the query bounds.  Points are
+    // collected into a column per attribute and appended to the view a
+    // batch at a time.  The ranges share edges, so points on the upper X
+    // edge of a range are left to the next one.
+    void GeoWaveReader::scan(const BOX2D& bounds, bool last,
+        PointViewPtr view, point_count_t limit, std::mutex& mutex)
     {
-        using namespace Dimension;
+        const point_count_t BatchSize = 4096;
+
+        CloseableIterator iterator;
+        if (!query(bounds, iterator))
+            return;
+
+        std::vector<String> names;
+        for (const std::string& name : m_attributes)
+            names.push_back(java_new<String>(name));
+        size_t xCol = std::find(m_ids.begin(), m_ids.end(),
+            Dimension::Id::X) - m_ids.begin();
+
+        std::vector<std::vector<double>> columns(m_ids.size());
+        bool full = false;
 
-        String location = java_new<String>("location");
-        point_count_t numRead = 0;
+        auto flush = [&]()
+        {
+            point_count_t num = columns.empty() ? 0 : columns[0].size();
+            if (num == 0)
+                return;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            PointId start = view->size();
+            if (start >= limit)
+            {
+                full = true;
+                return;
+            }
+            num = (std::min)(num, limit - start);
+            for (PointId i = 0; i < num; ++i)
+                view->setField(m_ids[0], start + i, columns[0][i]);
+            for (size_t d = 1; d < m_ids.size(); ++d)
+                view->setFieldArray(m_ids[d], start, num, columns[d].data());
+            if (m_cb)
+                for (PointId i = 0; i < num; ++i)
+                    m_cb(*view, start + i);
+            for (auto& c : columns)
+                c.clear();
+            full = (start + num >= limit);
+        };
+
+        auto add = [&](SimpleFeature& simpleFeature)
+        {
+            for (size_t d = 0; d < names.size(); ++d)
+                columns[d].push_back(java_cast<Double>(
+                    simpleFeature.getAttribute(names[d])).doubleValue());
+            if (!last && xCol < columns.size() &&
+                    columns[xCol].back() >= bounds.maxx)
+                for (auto& c : columns)
+                    c.pop_back();
+            if (!columns.empty() && columns[0].size() >= BatchSize)
+                flush();
+        };
 
         if (m_useFeatCollDataAdapter)
         {
-            while (m_iterator.hasNext() && count > 0)
+            while (!full && iterator.hasNext())
             {
-                SimpleFeatureCollection featureCollection = java_cast<SimpleFeatureCollection>(m_iterator.next());
+                SimpleFeatureCollection featureCollection = java_cast<SimpleFeatureCollection>(iterator.next());
                 SimpleFeatureIterator featItr = featureCollection.features();
 
-                while (featItr.hasNext() && count-- > 0)
+                while (!full && featItr.hasNext())
                 {
                     SimpleFeature simpleFeature = java_cast<SimpleFeature>(featItr.next());
-                    List attribs = simpleFeature.getType().getAttributeDescriptors();
-
-                    for (int i = 0; i < attribs.size(); ++i){
-                        String name = java_cast<AttributeDescriptor>(attribs.get(i)).getLocalName();
-
-                        if (!name.equals(location))
-                            view->setField(id(name), numRead, java_cast<Double>(simpleFeature.getAttribute(name)).doubleValue());
-                    }
-
-                    if (m_cb)
-                        m_cb(*view, numRead);
-
-                    ++numRead;
+                    add(simpleFeature);
                 }
                 featItr.close();
             }
         }
         else
         {
-            while (m_iterator.hasNext() && count-- > 0){
-                SimpleFeature simpleFeature = java_cast<SimpleFeature>(m_iterator.next());
-                List attribs = simpleFeature.getType().getAttributeDescriptors();
-
-                for (int i = 0; i < attribs.size(); ++i){
-                    String name = java_cast<AttributeDescriptor>(attribs.get(i)).getLocalName();
-
-                    if (!name.equals(location))
-                        view->setField(id(name), numRead, java_cast<Double>(simpleFeature.getAttribute(name)).doubleValue());
-                }
+            while (!full && iterator.hasNext())
+            {
+                SimpleFeature simpleFeature = java_cast<SimpleFeature>(iterator.next());
+                add(simpleFeature);
+            }
+        }
+        if (!full)
+            flush();
+        iterator.close();
+    }
 
-                if (m_cb)
-                    m_cb(*view, numRead);
+    point_count_t GeoWaveReader::read(PointViewPtr view, point_count_t count)
+    {
+        if (m_bounds.empty() || m_ids.empty())
+            return 0;
+
+        const PointId first = view->size();
+        const point_count_t limit =
+            (count > (std::numeric_limits<point_count_t>::max)() - first) ?
+            (std::numeric_limits<point_count_t>::max)() : first + count;
+
+        // The bounds are split into ranges of X, each scanned by its own
+        // query.
+        size_t threads(m_threads ? m_threads :
+            (size_t)(std::max)(std::thread::hardware_concurrency(), 1U));
+        std::vector<BOX2D> ranges;
+        const double width = (m_bounds.maxx - m_bounds.minx) / threads;
+        for (size_t i = 0; i < threads; ++i)
+        {
+            BOX2D range(m_bounds.to2d());
+            range.minx = m_bounds.minx + i * width;
+            if (i + 1 < threads)
+                range.maxx = range.minx + width;
+            ranges.push_back(range);
+        }
 
-                ++numRead;
+        std::mutex mutex;
+        if (ranges.size() > 1)
+        {
+            ThreadPool pool(ranges.size(), ranges.size(), false);
+            for (size_t i = 0; i < ranges.size(); ++i)
+            {
+                const BOX2D& range = ranges[i];
+                bool last = (i + 1 == ranges.size());
+                pool.add([this, &range, last, view, limit, &mutex]()
+                {
+                    scan(range, last, view, limit, mutex);
+                    jace::detach();
+                });
             }
+            pool.await();
+            if (pool.errors().size())
+                throwError(pool.errors().front());
         }
+        else
+            scan(ranges.front(), true, view, limit, mutex);
 
-        return numRead;
+        return view->size() - first;
     }
 
     void GeoWaveReader::done(PointTableRef table)
     {
-        m_iterator.close();
     }
 
     int GeoWaveReader::createJvm()
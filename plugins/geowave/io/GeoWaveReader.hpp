@@ -37,6 +37,8 @@
 #include <pdal/Reader.hpp>
 #include <pdal/util/Bounds.hpp>
 
+#include <mutex>
+
 #include "jace/proxy/mil/nga/giat/geowave/core/store/CloseableIterator.h"
 using jace::proxy::mil::nga::giat::geowave::core::store::CloseableIterator;
 
@@ -56,6 +58,9 @@ namespace pdal
         virtual point_count_t read(PointViewPtr view, point_count_t count);
         virtual void done(PointTableRef table);
         int createJvm();
+        bool query(const BOX2D& bounds, CloseableIterator& iterator);
+        void scan(const BOX2D& bounds, bool last, PointViewPtr view,
+            point_count_t limit, std::mutex& mutex);
 
         std::string m_zookeeperUrl;
         std::string m_instanceName;
@@ -67,8 +72,11 @@ namespace pdal
         bool m_useFeatCollDataAdapter;
         uint32_t m_pointsPerEntry;
         BOX3D m_bounds;
+        size_t m_threads;
 
-        CloseableIterator m_iterator;
+        // Feature attributes other than the location and their dimensions.
+        std::vector<std::string> m_attributes;
+        Dimension::IdList m_ids;
     };
 
 } // namespace pdal
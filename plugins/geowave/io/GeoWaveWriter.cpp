@@ -260,41 +260,68 @@ std::string pdal::GeoWaveWriter::getName() const { return s_info.name; }
         GeometryFactory geometryFactory = JTSFactoryFinder::getGeometryFactory();
         SimpleFeatureBuilder builder = java_new<SimpleFeatureBuilder>(TYPE);
 
-        DefaultFeatureCollection featureCollection = java_new<DefaultFeatureCollection>(
-            UUID::randomUUID().toString(),
-            TYPE);
-
-        for (PointId idx = 0; idx < view->size(); ++idx)
+        // Java names of the attributes are made once rather than per point.
+        Dimension::IdList dims;
+        std::vector<String> names;
+        for (auto di = m_dims.begin(); di != m_dims.end(); ++di)
+            if (view->hasDim(*di))
+            {
+                dims.push_back(*di);
+                names.push_back(java_new<String>(view->dimName(*di)));
+            }
+
+        // Points are fetched from the view a column at a time, and with a
+        // collection adapter each batch is written as its own collection.
+        const point_count_t batchSize = m_useFeatCollDataAdapter ?
+            (point_count_t)(std::max)(m_pointsPerEntry, 1U) : 4096;
+        std::vector<double> xs(batchSize);
+        std::vector<double> ys(batchSize);
+        std::vector<std::vector<double>> columns(dims.size(),
+            std::vector<double>(batchSize));
+
+        for (PointId begin = 0; begin < view->size(); begin += batchSize)
         {
-            JDouble X = view->getFieldAs<double>(Id::X, idx);
-            JDouble Y = view->getFieldAs<double>(Id::Y, idx);
+            point_count_t num = (std::min)(batchSize, view->size() - begin);
+            view->getFieldArray(Id::X, begin, num, xs.data());
+            view->getFieldArray(Id::Y, begin, num, ys.data());
+            for (size_t d = 0; d < dims.size(); ++d)
+                view->getFieldArray(dims[d], begin, num, columns[d].data());
+
+            DefaultFeatureCollection featureCollection = java_new<DefaultFeatureCollection>(
+                UUID::randomUUID().toString(),
+                TYPE);
+
+            for (PointId i = 0; i < num; ++i)
+            {
+                JDouble X = xs[i];
+                JDouble Y = ys[i];
 
-            Point point = geometryFactory.createPoint(
-                java_new<Coordinate>(
-                X,
-                Y));
+                Point point = geometryFactory.createPoint(
+                    java_new<Coordinate>(
+                    X,
+                    Y));
 
-            builder.set(location, point);
+                builder.set(location, point);
 
-            for (auto di = m_dims.begin(); di != m_dims.end(); ++di)
-                if (view->hasDim(*di))
-                    builder.set(java_new<String>(view->dimName(*di)), java_new<Double>(view->getFieldAs<double>(*di, idx)));
+                for (size_t d = 0; d < dims.size(); ++d)
+                    builder.set(names[d], java_new<Double>(columns[d][i]));
 
-            SimpleFeature feature = builder.buildFeature(UUID::randomUUID().toString());
+                SimpleFeature feature = builder.buildFeature(UUID::randomUUID().toString());
+
+                if (m_useFeatCollDataAdapter)
+                    featureCollection.add(feature);
+                else
+                    accumuloIndexWriter.write(
+                    dataAdapter,
+                    feature);
+            }
 
             if (m_useFeatCollDataAdapter)
-                featureCollection.add(feature);
-            else
                 accumuloIndexWriter.write(
                 dataAdapter,
-                feature);
+                featureCollection);
         }
 
-        if (m_useFeatCollDataAdapter)
-            accumuloIndexWriter.write(
-            dataAdapter,
-            featureCollection);
-
         accumuloIndexWriter.close();
     }
 
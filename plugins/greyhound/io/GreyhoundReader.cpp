@@ -37,6 +37,11 @@
 #include <pdal/pdal_features.hpp>
 #include <pdal/compression/LazPerfCompression.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+#include <algorithm>
+#include <mutex>
+#include <thread>
 
 namespace pdal
 {
@@ -65,6 +70,13 @@ void GreyhoundReader::addArgs(ProgramArgs& args)
     args.add("buffer", "Ratio by which to bloat the requested bounds.  The "
             "buffered portion, if writers.greyhound is later used, will not be "
             "written - this allows edge effect mitigation.", m_args.buffer);
+    args.add("split", "Number of times to split the query bounds into "
+            "quadrants.  Each split multiplies the number of concurrent "
+            "sub-queries by four.", m_split);
+    args.add("depth_split", "Issue a separate query for each depth from "
+            "depth_begin to depth_end", m_depthSplit);
+    args.add("threads", "Number of sub-queries to fetch and decompress "
+            "concurrently.  The default is the number of cores.", m_threads);
 }
 
 void GreyhoundReader::initialize(PointTableRef table)
@@ -188,15 +200,80 @@ void GreyhoundReader::prepared(PointTableRef table)
     queryNode.add("params", dense(m_params.toJson()));
 }
 
-point_count_t GreyhoundReader::read(PointViewPtr view, point_count_t count)
+// Split the query into disjoint sub-queries.  Greyhound bounds are
+// half-open, so points on the boundary of two tiles are only returned once.
+std::vector<Json::Value> GreyhoundReader::subQueries() const
+{
+    const Json::Value base(m_params.toJson());
+    std::vector<Json::Value> queries { base };
+
+    if (m_split)
+    {
+        const Json::Value& jb(base.isMember("bounds") ?
+            base["bounds"] : m_info["bounds"]);
+
+        if (jb.isNull())
+            log()->get(LogLevel::Warning) << "No bounds available to "
+                "split the query." << std::endl;
+        else
+        {
+            std::vector<greyhound::Bounds> tiles { greyhound::Bounds(jb) };
+            for (std::size_t i(0); i < m_split; ++i)
+            {
+                std::vector<greyhound::Bounds> next;
+                for (const greyhound::Bounds& b : tiles)
+                {
+                    next.push_back(b.getNw());
+                    next.push_back(b.getNe());
+                    next.push_back(b.getSw());
+                    next.push_back(b.getSe());
+                }
+                tiles.swap(next);
+            }
+
+            queries.clear();
+            for (const greyhound::Bounds& b : tiles)
+            {
+                Json::Value q(base);
+                q["bounds"] = b.toJson();
+                queries.push_back(q);
+            }
+        }
+    }
+
+    if (m_depthSplit)
+    {
+        if (!m_args.depthEnd || base.isMember("depth"))
+            log()->get(LogLevel::Warning) << "Can't split the query by "
+                "depth without 'depth_end'." << std::endl;
+        else
+        {
+            std::vector<Json::Value> next;
+            for (const Json::Value& q : queries)
+                for (std::size_t d(m_args.depthBegin); d < m_args.depthEnd; ++d)
+                {
+                    Json::Value dq(q);
+                    dq["depthBegin"] = static_cast<Json::UInt64>(d);
+                    dq["depthEnd"] = static_cast<Json::UInt64>(d + 1);
+                    next.push_back(dq);
+                }
+            queries.swap(next);
+        }
+    }
+
+    return queries;
+}
+
+// Fetch a query's points and decompress them into packed point data.
+std::vector<char> GreyhoundReader::fetch(const GreyhoundParams& params,
+    uint32_t& numPoints) const
 {
-    const std::string url(m_params.root() + "read" + m_params.qs());
+    const std::string url(params.root() + "read" + params.qs());
     log()->get(LogLevel::Debug) << "Reading: " << url << std::endl;
 
     auto response(m_arbiter->getBinary(url));
-    const std::size_t pointSize(view->layout()->pointSize());
 
-    uint32_t numPoints(0);
+    numPoints = 0;
     std::copy(
             response.data() + response.size() - sizeof(uint32_t),
             response.data() + response.size(),
@@ -209,25 +286,73 @@ point_count_t GreyhoundReader::read(PointViewPtr view, point_count_t count)
 
     response.resize(response.size() - sizeof(uint32_t));
 
-    const auto dimTypes(m_readLayout.dimTypes());
 #ifdef PDAL_HAVE_LAZPERF
-    auto cb = [this, &view, &dimTypes](char *buf, size_t bufsize)
-    {
-        view->setPackedPoint(dimTypes, view->size(), buf);
-        if (m_cb)
-            m_cb(*view, view->size() - 1);
-    };
-    LazPerfDecompressor(cb, dimTypes, numPoints).
-        decompress(response.data(), response.size());
+    LazPerfBlockDecompressor decompressor(m_readLayout.dimTypes());
+    std::vector<char> points(numPoints * decompressor.pointSize());
+    decompressor.decompress(response.data(), response.size(), points.data(),
+        numPoints);
+    return points;
 #else
-    const char* end(response.data() + response.size());
-    for (const char* pos(response.data()); pos < end; pos += pointSize)
+    return response;
+#endif
+}
+
+point_count_t GreyhoundReader::read(PointViewPtr view, point_count_t count)
+{
+    const std::vector<Json::Value> queries(subQueries());
+    const auto dimTypes(m_readLayout.dimTypes());
+    const std::size_t pointSize(m_readLayout.pointSize());
+
+    // Sub-queries are written to the view in the order in which they
+    // arrive.  Record where each one landed so that writers.greyhound can
+    // send the points back to the query from which they came.
+    Json::Value landed;
+    std::mutex mutex;
+    auto run([&](const Json::Value& q)
     {
-        view->setPackedPoint(dimTypes, view->size(), pos);
-        if (m_cb)
-            m_cb(*view, view->size() - 1);
+        const GreyhoundParams params(m_params.root(), q);
+        uint32_t numPoints(0);
+        const std::vector<char> points(fetch(params, numPoints));
+
+        std::lock_guard<std::mutex> lock(mutex);
+        Json::Value entry;
+        entry["params"] = q;
+        entry["offset"] = static_cast<Json::UInt64>(view->size());
+        entry["count"] = numPoints;
+        landed.append(entry);
+
+        const char* pos(points.data());
+        for (uint32_t i(0); i < numPoints; ++i)
+        {
+            view->setPackedPoint(dimTypes, view->size(), pos);
+            if (m_cb)
+                m_cb(*view, view->size() - 1);
+            pos += pointSize;
+        }
+    });
+
+    std::size_t threads(m_threads ? m_threads :
+        (std::size_t)(std::max)(std::thread::hardware_concurrency(), 1U));
+    threads = (std::min)(threads, queries.size());
+    if (threads > 1)
+    {
+        ThreadPool pool(threads, queries.size(), false);
+        for (const Json::Value& q : queries)
+            pool.add([&run, &q]() { run(q); });
+        pool.await();
+        if (pool.errors().size())
+            throw pdal_error(pool.errors().front());
     }
-#endif
+    else
+    {
+        for (const Json::Value& q : queries)
+            run(q);
+    }
+
+    if (queries.size() > 1)
+        view->table().privateMetadata("greyhound").add("queries",
+            dense(landed));
+
     if (!m_params.obounds().isNull())
     {
         greyhound::Bounds obounds(m_params.obounds());
@@ -249,7 +374,7 @@ point_count_t GreyhoundReader::read(PointViewPtr view, point_count_t count)
         view->setField(Dimension::Id::PointId, i, i);
     }
 
-    return numPoints;
+    return view->size();
 }
 
 } // namespace pdal
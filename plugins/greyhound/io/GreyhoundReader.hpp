@@ -62,7 +62,14 @@ private:
     virtual void prepared(PointTableRef table) override;
     virtual point_count_t read(PointViewPtr view, point_count_t count) override;
 
+    std::vector<Json::Value> subQueries() const;
+    std::vector<char> fetch(const GreyhoundParams& params,
+        uint32_t& numPoints) const;
+
     GreyhoundArgs m_args;
+    std::size_t m_split = 0;
+    bool m_depthSplit = false;
+    std::size_t m_threads = 0;
     GreyhoundParams m_params;
     std::unique_ptr<arbiter::Arbiter> m_arbiter;
 
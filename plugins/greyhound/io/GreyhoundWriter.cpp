@@ -138,39 +138,55 @@ void GreyhoundWriter::write(const PointViewPtr view)
         view->getPackedPoint(m_writeLayout.dimTypes(), i, pos);
     }
 
-#ifdef PDAL_HAVE_LAZPERF
-    m_params["compress"] = true;
+    // If the reader split its query, send each sub-query's points back to
+    // that sub-query.
+    const MetadataNode queries(
+            view->table().privateMetadata("greyhound").findChild("queries"));
+    if (queries.valid())
+    {
+        for (const Json::Value& q : parse(queries.value<std::string>()))
+        {
+            GreyhoundParams params(m_params.root(), q["params"]);
+            params["schema"] = m_params.toJson()["schema"];
+            params["name"] = m_name;
 
-    std::vector<char> comp;
-    comp.reserve(data.size() / 5);
+            put(params, data.data() + q["offset"].asUInt64() * pointSize,
+                    q["count"].asUInt64());
+        }
+    }
+    else
+        put(m_params, data.data(), view->size());
+}
 
-    auto cb([&comp](char* p, std::size_t s)
-    {
-        comp.insert(comp.end(), p, p + s);
-    });
+void GreyhoundWriter::put(GreyhoundParams params, const char* data,
+        const std::size_t numPoints) const
+{
+    std::vector<char> buffer;
 
-    LazPerfCompressor compressor(cb, m_writeLayout.dimTypes());
-    compressor.compress(data.data(), data.size());
-    compressor.done();
+#ifdef PDAL_HAVE_LAZPERF
+    params["compress"] = true;
 
-    data = std::move(comp);
+    buffer.reserve(numPoints * m_writeLayout.pointSize() / 5);
+
+    LazPerfBlockCompressor compressor(m_writeLayout.dimTypes());
+    compressor.compress(data, numPoints, buffer);
 #else
-    m_params.removeMember("compress");
+    params.removeMember("compress");
+    buffer.assign(data, data + numPoints * m_writeLayout.pointSize());
 #endif
 
     const arbiter::http::Headers h {
-        { "NumPoints", std::to_string(view->size()) }
+        { "NumPoints", std::to_string(numPoints) }
     };
 
     log()->get(LogLevel::Debug) <<
-        "Writing: " << m_params.root() << "\n" << m_params.qs() << "\n" <<
-        m_params.toJson() << "\nOBounds: " << m_params.obounds() << std::endl;
+        "Writing: " << params.root() << "\n" << params.qs() << "\n" <<
+        params.toJson() << "\nOBounds: " << params.obounds() << std::endl;
 
     arbiter::Arbiter a;
-    const std::string url(m_params.root() + "write" + m_params.qs());
+    const std::string url(params.root() + "write" + params.qs());
     log()->get(LogLevel::Debug) << "Writing: " << url << std::endl;
-    a.put(url, data, h);
+    a.put(url, buffer, h);
 }
 
 } // namespace pdal
-
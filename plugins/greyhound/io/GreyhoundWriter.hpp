@@ -54,6 +54,9 @@ private:
     virtual void prepared(PointTableRef table) override;
     virtual void write(const PointViewPtr view) override;
 
+    void put(GreyhoundParams params, const char* data,
+            std::size_t numPoints) const;
+
     std::string m_name;
     Json::Value m_writeDims;
 
@@ -255,3 +255,45 @@ TEST_F(GreyhoundReaderTest, singleOption)
 
 
 
+
+TEST_F(GreyhoundReaderTest, splitQuery)
+{
+    if (!doTests()) return;
+
+    const greyhound::Bounds bounds(center - 100, center + 100);
+
+    auto run([](const Json::Value& json)
+    {
+        pdal::GreyhoundReader reader;
+        reader.setOptions(toOptions(json));
+
+        pdal::PointTable table;
+        reader.prepare(table);
+        PointViewSet viewSet = reader.execute(table);
+        return *viewSet.begin();
+    });
+
+    Json::Value json;
+    json["bounds"] = bounds.toJson();
+    json["depth_begin"] = 7;
+    json["depth_end"] = 9;
+    PointViewPtr whole = run(json);
+
+    json["split"] = 2;
+    json["depth_split"] = true;
+    json["threads"] = 4;
+    PointViewPtr split = run(json);
+    ASSERT_EQ(whole->size(), split->size());
+
+    greyhound::Point p;
+    for (std::size_t i(0); i < split->size(); ++i)
+    {
+        p.x = split->getFieldAs<double>(Dimension::Id::X, i);
+        p.y = split->getFieldAs<double>(Dimension::Id::Y, i);
+        p.z = split->getFieldAs<double>(Dimension::Id::Z, i);
+
+        ASSERT_TRUE(bounds.contains(p));
+        ASSERT_EQ(split->getFieldAs<std::size_t>(Dimension::Id::PointId, i),
+                i);
+    }
+}
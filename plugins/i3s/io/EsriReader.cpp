@@ -37,15 +37,27 @@
 #include <Eigen/Geometry>
 #include <ogr_spatialref.h>
 
+#include <pdal/util/ThreadPool.hpp>
+
 #include "../lepcc/src/include/lepcc_types.h"
 
 #include "EsriUtil.hpp"
-#include "pool.hpp"
-#include "SlpkExtractor.hpp"
 
 
 namespace pdal
 {
+
+// The geometry and attributes of a node, fetched and decoded.
+struct EsriReader::NodeData
+{
+    std::vector<lepcc::Point3D> xyz;
+    std::vector<point_count_t> selected;
+    std::vector<lepcc::RGB_t> rgb;
+    std::vector<uint16_t> intensity;
+    std::vector<std::vector<char>> attrs; // Raw data, one per m_dimMap entry.
+    PointId startId = 0;
+};
+
 void EsriReader::addArgs(ProgramArgs& args)
 {
     args.add("bounds", "Bounds of the point cloud", m_args.bounds);
@@ -297,25 +309,64 @@ point_count_t EsriReader::read(PointViewPtr view, point_count_t count)
     log()->get(LogLevel::Debug) << "Traversing metadata" << std::endl;
     traverseTree(initJson, 0, nodes, 0, 0);
 
-    // Create view with overlapping nodes at desired depth
-    // Will create a thread pool on the createview class and iterate
-    // through the node list for the nodes to be pulled.
+    // Nodes are handled in batches.  The geometry and attributes of each
+    // node in a batch are fetched and decoded in parallel.  Once all the
+    // selected points are known, a range of the view is reserved for each
+    // node and the nodes are written into their ranges in parallel.
     log()->get(LogLevel::Debug) << "Fetching binaries" << std::endl;
-    Pool p(m_args.threads);
-    for (std::size_t i = 0; i < nodes.size(); i++)
+    ThreadPool p(m_args.threads);
+    const std::size_t batchSize(4 * p.numThreads());
+    for (std::size_t first = 0; first < nodes.size(); first += batchSize)
     {
-        log()->get(LogLevel::Debug) << "\r" << i << "/" << nodes.size();
-        std::string localUrl;
+        const std::size_t last = (std::min)(first + batchSize, nodes.size());
+        std::vector<NodeData> batch(last - first);
+
+        for (std::size_t i = first; i < last; i++)
+        {
+            log()->get(LogLevel::Debug) << "\r" << i << "/" << nodes.size();
+            const std::string localUrl =
+                m_filename + "/nodes/" + std::to_string(nodes[i]);
+            NodeData& node = batch[i - first];
+            node.attrs.resize(m_dimMap.size());
+
+            p.add([this, localUrl, &node]()
+            {
+                fetchGeometry(localUrl, node);
+            });
 
-        localUrl = m_filename + "/nodes/" + std::to_string(nodes[i]);
-        int nodeIndex(nodes[i]);
+            std::size_t attr = 0;
+            for (const auto& dimEntry : m_dimMap)
+            {
+                p.add([this, localUrl, &dimEntry, &node, attr]()
+                {
+                    fetchAttribute(localUrl, dimEntry.first, dimEntry.second,
+                        node, attr);
+                });
+                attr++;
+            }
+        }
+        p.await();
+        if (p.errors().size())
+            throwError(p.errors().front());
 
-        p.add([localUrl, nodeIndex, this, &view]()
+        PointId next = view->size();
+        for (NodeData& node : batch)
         {
-            createView(localUrl, nodeIndex, *view);
-        });
+            node.startId = next;
+            next += node.selected.size();
+        }
+        for (PointId idx = view->size(); idx < next; ++idx)
+            view->getOrAddPoint(idx);
+
+        for (const NodeData& node : batch)
+            p.add([this, &view, &node]()
+            {
+                writeNode(*view, node);
+            });
+        p.await();
+        if (p.errors().size())
+            throwError(p.errors().front());
     }
-    p.await();
     return view->size();
 }
 
@@ -436,131 +487,114 @@ BOX3D EsriReader::createCube(Json::Value base)
 }
 
 
-void EsriReader::createView(std::string localUrl, int nodeIndex, PointView& view)
+// Fetch and decode the XYZ data of a node and select the points that are
+// within the bounds.
+void EsriReader::fetchGeometry(const std::string& localUrl,
+    NodeData& node) const
 {
-    // pull the geometries to start
     const std::string geomUrl = localUrl + "/geometries/";
     auto xyzFetch = fetchBinary(geomUrl, "0", ".bin.pccxyz");
-    std::vector<lepcc::Point3D> xyz;
     try
     {
-        xyz = EsriUtil::decompressXYZ(&xyzFetch);
+        node.xyz = EsriUtil::decompressXYZ(&xyzFetch);
     }
     catch (const EsriUtil::decompression_error& e)
     {
         throwError(e.what());
     }
 
-    std::vector<point_count_t> selected;
-    uint64_t startId;
+    for (uint64_t j = 0; j < node.xyz.size(); ++j)
+        if (m_bounds.contains(node.xyz[j].x, node.xyz[j].y, node.xyz[j].z))
+            node.selected.push_back(j);
+}
 
-    {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        startId = view.size();
 
+// Fetch and decode the data of one attribute of a node.
+void EsriReader::fetchAttribute(const std::string& localUrl,
+    Dimension::Id dimId, const dimData& dim, NodeData& node,
+    std::size_t attr) const
+{
+    const std::string attrUrl = localUrl + "/attributes/";
+    const std::string key(std::to_string(dim.key));
 
-        for (uint64_t j = 0; j < xyz.size(); ++j)
+    //the extensions seen in this part correspond with slpk
+    try
+    {
+        if (dimId == Dimension::Id::Red)
         {
-            double x = xyz[j].x;
-            double y = xyz[j].y;
-            double z = xyz[j].z;
-
-            if (m_bounds.contains(x, y, z))
-            {
-                PointId id = view.size();
-                selected.push_back(j);
-                view.setField(pdal::Dimension::Id::X, id, xyz[j].x);
-                view.setField(pdal::Dimension::Id::Y, id, xyz[j].y);
-                view.setField(pdal::Dimension::Id::Z, id, xyz[j].z);
-            }
+            auto data = fetchBinary(attrUrl, key, ".bin.pccrgb");
+            node.rgb = EsriUtil::decompressRGB(&data);
         }
+        else if (dimId == Dimension::Id::Intensity)
+        {
+            auto data = fetchBinary(attrUrl, key, ".bin.pccint");
+            node.intensity = EsriUtil::decompressIntensity(&data);
+        }
+        else
+            node.attrs[attr] = fetchBinary(attrUrl, key, ".bin.gz");
     }
+    catch (const EsriUtil::decompression_error& e)
+    {
+        throwError(e.what());
+    }
+}
 
-    const std::string attrUrl = localUrl + "/attributes/";
 
-    //the extensions seen in this part correspond with slpk
+// Write the selected points of a node into the range of the view reserved
+// for it.
+void EsriReader::writeNode(PointView& view, const NodeData& node) const
+{
+    const std::vector<point_count_t>& selected = node.selected;
+    const PointId startId = node.startId;
+
+    for (std::size_t i(0); i < selected.size(); ++i)
+    {
+        const lepcc::Point3D& p = node.xyz[selected[i]];
+        view.setField(pdal::Dimension::Id::X, startId + i, p.x);
+        view.setField(pdal::Dimension::Id::Y, startId + i, p.y);
+        view.setField(pdal::Dimension::Id::Z, startId + i, p.z);
+    }
+
+    std::size_t attr = 0;
     for (const auto& dimEntry : m_dimMap)
     {
         const Dimension::Id dimId(dimEntry.first);
         const Dimension::Type dimType(dimEntry.second.dimType);
-        const uint64_t key(dimEntry.second.key);
-        const std::string name(dimEntry.second.name);
+        const std::vector<char>& data = node.attrs[attr++];
 
         if (dimId == Dimension::Id::Red)
         {
-            auto data = fetchBinary(
-                    attrUrl, std::to_string(key), ".bin.pccrgb");
-            std::vector<lepcc::RGB_t> rgbPoints;
-            try
-            {
-                rgbPoints = EsriUtil::decompressRGB(&data);
-            }
-            catch (const EsriUtil::decompression_error& e)
-            {
-                throwError(e.what());
-            }
-
-            std::size_t dimSize = Dimension::size(dimType);
-            if (rgbPoints.size() != xyz.size())
-            {
+            if (node.rgb.size() != node.xyz.size())
                 throwError(std::string("Bad data fetch. Data id: " +
                             dimEntry.second.name));
-            }
 
-            std::lock_guard<std::mutex> lock(m_mutex);
             for (std::size_t i(0); i < selected.size(); ++i)
             {
-                view.setField(pdal::Dimension::Id::Red,
-                        startId + i, rgbPoints[selected[i]].r);
-                view.setField(pdal::Dimension::Id::Green,
-                        startId + i, rgbPoints[selected[i]].g);
-                view.setField(pdal::Dimension::Id::Blue,
-                        startId + i, rgbPoints[selected[i]].b);
+                const lepcc::RGB_t& rgb = node.rgb[selected[i]];
+                view.setField(pdal::Dimension::Id::Red, startId + i, rgb.r);
+                view.setField(pdal::Dimension::Id::Green, startId + i, rgb.g);
+                view.setField(pdal::Dimension::Id::Blue, startId + i, rgb.b);
             }
         }
         else if (dimId == Dimension::Id::Intensity)
         {
-            auto data = fetchBinary(attrUrl, std::to_string(key),
-                    ".bin.pccint");
-
-            std::vector<uint16_t> intensity;
-            try
-            {
-                intensity = EsriUtil::decompressIntensity(&data);
-            }
-            catch (const EsriUtil::decompression_error& e)
-            {
-                throwError(e.what());
-            }
-
-            if (intensity.size() != xyz.size())
-            {
+            if (node.intensity.size() != node.xyz.size())
                 throwError(std::string("Bad data fetch. Data id: " +
                             dimEntry.second.name));
-            }
 
-            std::lock_guard<std::mutex> lock(m_mutex);
             for (std::size_t i(0); i < selected.size(); ++i)
-            {
                 view.setField(pdal::Dimension::Id::Intensity,
-                        startId + i, intensity[selected[i]]);
-            }
+                        startId + i, node.intensity[selected[i]]);
         }
         else if (dimId == Dimension::Id::NumberOfReturns)
         {
-
-            const std::vector<char> data = fetchBinary(
-                    attrUrl, std::to_string(key), ".bin.gz");
-
             const uint8_t* returnData =
                 reinterpret_cast<const uint8_t*> (data.data());
 
-            if (data.size() != xyz.size())
+            if (data.size() != node.xyz.size())
                 throwError(std::string("Bad data fetch. Data id: " +
                             dimEntry.second.name));
 
-
-            std::lock_guard<std::mutex> lock(m_mutex);
             for (std::size_t i(0); i < selected.size(); ++i)
             {
                 //unpack returns to return number and number of returns
@@ -573,25 +607,18 @@ void EsriReader::createView(std::string localUrl, int nodeIndex, PointView& view
                 view.setField(Dimension::Id::NumberOfReturns,
                         startId + i, numReturns);
             }
-
         }
         else
         {
-            const auto data = fetchBinary(
-                    attrUrl, std::to_string(key), ".bin.gz");
-
             std::size_t dimSize = Dimension::size(dimType);
 
-            if (data.size() != xyz.size() * dimSize)
+            if (data.size() != node.xyz.size() * dimSize)
                 throwError(std::string("Bad data fetch. Data id: " +
                             dimEntry.second.name));
 
-            std::lock_guard<std::mutex> lock(m_mutex);
             for (std::size_t i(0); i < selected.size(); ++i)
-            {
                 view.setField(dimId, dimType, startId + i,
                         data.data() + selected[i] * dimSize);
-            }
         }
     }
 }
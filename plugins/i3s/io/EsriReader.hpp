@@ -185,7 +185,12 @@ protected:
     virtual void ready(PointTableRef table) override;
     virtual point_count_t read(PointViewPtr view, point_count_t count) override;
     virtual void done(PointTableRef table) override;
-    void createView(std::string localUrl, int nodeIndex,  PointView& view);
+
+    struct NodeData;
+    void fetchGeometry(const std::string& localUrl, NodeData& node) const;
+    void fetchAttribute(const std::string& localUrl, Dimension::Id dimId,
+        const dimData& dim, NodeData& node, std::size_t attr) const;
+    void writeNode(PointView& view, const NodeData& node) const;
     BOX3D createCube(Json::Value base);
     BOX3D parseBox(Json::Value base);
     void traverseTree(Json::Value page, int index, std::vector<int>& nodes,
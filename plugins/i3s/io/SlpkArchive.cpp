@@ -32,13 +32,9 @@
 * OF SUCH DAMAGE.
 ****************************************************************************/
 
-#include <fstream>
-#include <algorithm>
+#include <cstring>
 
-#include <pdal/util/IStream.hpp>
-#include <pdal/util/FileUtils.hpp>
-
-#include "SlpkExtractor.hpp"
+#include "SlpkArchive.hpp"
 
 namespace pdal
 {
@@ -59,70 +55,70 @@ struct zheader
 #pragma pack()
 
 
-void SlpkExtractor::extract() const
+SlpkArchive::~SlpkArchive()
+{
+    if (m_ctx.addr())
+        FileUtils::unmapFile(m_ctx);
+}
+
+
+// Map the archive and index the files it contains.
+void SlpkArchive::open()
 {
-    if (!FileUtils::directoryExists(m_directory))
-        throw slpk_error("Output directory doesn't exist.");
+    m_ctx = FileUtils::mapFile(m_filename);
+    if (!m_ctx.addr())
+        throw slpk_error("Couldn't map '" + m_filename + "': " + m_ctx.what());
 
-    ILeStream in(m_filename);
+    const char *base = reinterpret_cast<const char *>(m_ctx.addr());
+    const uint64_t size = m_ctx.m_size;
+    uint64_t pos = 0;
 
     zheader h;
-    std::string name;
-    std::vector<char> extra;
     int32_t magic;
-
-    in.get(reinterpret_cast<char *>(&magic), sizeof(magic));
-    while (magic == 0x04034b50)
+    while (pos + sizeof(magic) + sizeof(h) <= size)
     {
-        in >> h.m_version;
-        in >> h.m_purpose;
-        in >> h.m_compression;
-        in >> h.m_time;
-        in >> h.m_crc;
-        in >> h.m_compressedSize;
-        in >> h.m_uncompressedSize;
-        in >> h.m_nameLen;
-        in >> h.m_extraLen;
-
-        in.get(name, h.m_nameLen);
-        if (h.m_extraLen)
-        {
-            extra.resize(h.m_extraLen);
-            in.get(extra);
-        }
+        std::memcpy(&magic, base + pos, sizeof(magic));
+        if (magic != 0x04034b50)
+            break;
+        pos += sizeof(magic);
+        std::memcpy(&h, base + pos, sizeof(h));
+        pos += sizeof(h);
+
+        if (pos + h.m_nameLen + h.m_extraLen > size)
+            throw slpk_error("Truncated header in slpk archive.");
+        std::string name(base + pos, h.m_nameLen);
+        pos += h.m_nameLen + h.m_extraLen;
 
         if (h.m_compression != 0)
             throw slpk_error("Found compressed file in slpk archive.");
         if (h.m_compressedSize != h.m_uncompressedSize)
             throw slpk_error("Compressed and uncompressed sizes don't match "
                 "in slpk archive.");
-        writeFile(name, in, h.m_compressedSize);
-        in.get(reinterpret_cast<char *>(&magic), sizeof(magic));
+        if (pos + h.m_compressedSize > size)
+            throw slpk_error("File '" + name + "' extends beyond the end "
+                "of the slpk archive.");
+
+        m_entries[name] = { pos, h.m_compressedSize };
+        pos += h.m_compressedSize;
     }
 }
 
-void SlpkExtractor::writeFile(std::string filename, ILeStream& in,
-    size_t count) const
+
+bool SlpkArchive::exists(const std::string& name) const
 {
-    std::string dir = FileUtils::getDirectory(filename);
-    dir = m_directory + "/" + dir;
-    if (dir.size())
-        FileUtils::createDirectories(dir);
-    filename = m_directory + "/" + filename;
-
-    std::ofstream out(filename, std::ios_base::out | std::ios_base::binary);
-    if (!out)
-        throw slpk_error("Couldn't open output file '" + filename + "'.");
-
-    const size_t bufsize(100000);
-    char buf[bufsize];
-    while (count)
-    {
-        size_t size = (std::min)(bufsize, count);
-        in.get(buf, size);
-        out.write(buf, size);
-        count -= size;
-    }
+    return m_entries.find(name) != m_entries.end();
+}
+
+
+std::vector<char> SlpkArchive::read(const std::string& name) const
+{
+    auto it = m_entries.find(name);
+    if (it == m_entries.end())
+        throw slpk_error("File '" + name + "' not found in slpk archive.");
+
+    const char *start =
+        reinterpret_cast<const char *>(m_ctx.addr()) + it->second.m_offset;
+    return std::vector<char>(start, start + it->second.m_size);
 }
 
 } //namespace pdal
@@ -34,7 +34,11 @@
 
 #pragma once
 
+#include <map>
 #include <string>
+#include <vector>
+
+#include <pdal/util/FileUtils.hpp>
 
 namespace pdal
 {
@@ -51,21 +55,30 @@ public:
     std::string m_error;
 };
 
-class ILeStream;
-
-class SlpkExtractor
+// An SLPK archive, mapped into memory.  The files in the archive are
+// stored uncompressed, so they can be read in place without extracting
+// the archive.  Once opened, the archive can be read from several threads.
+class SlpkArchive
 {
 public:
-    SlpkExtractor (const std::string& filename, const std::string& directory) :
-        m_filename(filename), m_directory(directory)
+    SlpkArchive(const std::string& filename) : m_filename(filename)
     {}
-    void extract() const;
-    
+    ~SlpkArchive();
+
+    void open();
+    bool exists(const std::string& name) const;
+    std::vector<char> read(const std::string& name) const;
+
 private:
-    std::string m_filename;
-    std::string m_directory;
+    struct Entry
+    {
+        uint64_t m_offset;
+        uint64_t m_size;
+    };
 
-    void writeFile(std::string filename, ILeStream& in, size_t count) const;
+    std::string m_filename;
+    FileUtils::MapContext m_ctx;
+    std::map<std::string, Entry> m_entries;
 };
 
 } // namespace pdal
@@ -35,9 +35,7 @@
 #include "SlpkReader.hpp"
 #include <pdal/util/FileUtils.hpp>
 
-#include "pool.hpp"
 #include "EsriUtil.hpp"
-#include "SlpkExtractor.hpp"
 
 namespace pdal
 {
@@ -55,23 +53,22 @@ std::string SlpkReader::getName() const { return slpkInfo.name; }
 
 void SlpkReader::initInfo()
 {
-    // create temp path
-    std::string path = arbiter::fs::getTempPath();
-
-    // use arbiter to create new directory if doesn't already exist
-    std::string fullPath(path + FileUtils::stem(
-        FileUtils::getFilename(m_filename)));
-    arbiter::fs::mkdirp(fullPath);
-
-    // un-archive the slpk archive
-    SlpkExtractor slpk(m_filename, fullPath);
-    slpk.extract();
-    m_filename = fullPath;
-    log()->get(LogLevel::Debug) << "Making directory at: " <<
-        fullPath << std::endl;
-
-    // unarchive and decompress the 3dscenelayer and create json info object
-    auto compressed = m_arbiter->get(m_filename + "/3dSceneLayer.json.gz");
+    // Map the archive rather than extracting it.  The files in it are
+    // stored uncompressed and are read in place.
+    m_archive.reset(new SlpkArchive(m_filename));
+    try
+    {
+        m_archive->open();
+    }
+    catch (const slpk_error& e)
+    {
+        throwError(e.what());
+    }
+    log()->get(LogLevel::Debug) << "Mapped archive: " <<
+        m_filename << std::endl;
+
+    // decompress the 3dscenelayer and create json info object
+    auto compressed = readEntry(m_filename + "/3dSceneLayer.json.gz");
     std::string jsonString;
 
     m_decomp.decompress(jsonString, compressed.data(), compressed.size());
@@ -81,23 +78,43 @@ void SlpkReader::initInfo()
 }
 
 
+// Read a file from the archive.  Paths are built from the archive
+// filename as if it were a directory.
+std::vector<char> SlpkReader::readEntry(const std::string& path) const
+{
+    std::string name(path);
+    if (Utils::startsWith(name, m_filename + "/"))
+        name = name.substr(m_filename.size() + 1);
+
+    try
+    {
+        return m_archive->read(name);
+    }
+    catch (const slpk_error& e)
+    {
+        throwError(e.what());
+    }
+    return std::vector<char>();
+}
+
+
 Json::Value SlpkReader::fetchJson(std::string filepath)
 {
     std::string output;
-    auto compressed = m_arbiter->get(filepath + ".json.gz");
+    auto compressed = readEntry(filepath + ".json.gz");
     m_decomp.decompress<std::string>(output, compressed.data(),
         compressed.size());
     return EsriUtil::parse(output);
 
 }
 
-// fetch data using arbiter to get a char vector
+// fetch data from the archive to get a char vector
 std::vector<char> SlpkReader::fetchBinary(std::string url, std::string attNum,
     std::string ext) const
 {
     url += attNum + ext;
 
-    auto data(m_arbiter->getBinary(url));
+    auto data(readEntry(url));
 
     if (FileUtils::extension(url) != ".gz")
         return data;
@@ -35,6 +35,7 @@
 #pragma once
 
 #include "EsriReader.hpp"
+#include "SlpkArchive.hpp"
 
 namespace pdal
 {
@@ -49,6 +50,10 @@ protected:
             std::string ext) const override;
     virtual Json::Value fetchJson(std::string) override;
 
+private:
+    std::vector<char> readEntry(const std::string& path) const;
+
+    std::unique_ptr<SlpkArchive> m_archive;
 };
 
 } // namespace pdal
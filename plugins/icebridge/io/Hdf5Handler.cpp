@@ -41,8 +41,17 @@ namespace pdal
 
 using namespace hdf5;
 
+namespace
+{
+
+// Minimum number of entries to read from each column at once.
+const hsize_t MinBlockSize = 65536;
+
+} // unnamed namespace
+
 Hdf5Handler::Hdf5Handler()
     : m_numPoints(0)
+    , m_blockSize(MinBlockSize)
     , m_columnDataMap()
 { }
 
@@ -62,6 +71,9 @@ void Hdf5Handler::initialize(
     try
     {
         // Open each HDF5 DataSet and its corresponding DataSpace.
+        m_columnDataMap.clear();
+        m_numPoints = 0;
+        hsize_t chunkSize = 0;
         for (const auto& col : columns)
         {
             const std::string dataSetName = col.name;
@@ -76,7 +88,13 @@ void Hdf5Handler::initialize(
             // Does not check whether all the columns are the same length.
             m_numPoints = (std::max)((uint64_t)getColumnNumEntries(dataSetName),
                 m_numPoints);
+            chunkSize = (std::max)(getColumnChunkSize(dataSetName), chunkSize);
         }
+
+        m_blockSize = MinBlockSize;
+        if (chunkSize)
+            m_blockSize = chunkSize *
+                ((MinBlockSize + chunkSize - 1) / chunkSize);
     }
     catch (const H5::Exception&)
     {
@@ -94,12 +112,18 @@ uint64_t Hdf5Handler::getNumPoints() const
     return m_numPoints;
 }
 
+hsize_t Hdf5Handler::getBlockSize() const
+{
+    return m_blockSize;
+}
+
 void Hdf5Handler::getColumnEntries(
         void* data,
         const std::string& dataSetName,
         const hsize_t numEntries,
         const hsize_t offset) const
 {
+    std::lock_guard<std::mutex> lock(m_mutex);
     try
     {
         const ColumnData& columnData(getColumnData(dataSetName));
@@ -135,6 +159,19 @@ Hdf5Handler::getColumnNumEntries(const std::string& dataSetName) const
     return entries;
 }
 
+hsize_t
+Hdf5Handler::getColumnChunkSize(const std::string& dataSetName) const
+{
+    hsize_t chunk = 0;
+
+    const H5::DSetCreatPropList plist(
+        getColumnData(dataSetName).dataSet.getCreatePlist());
+    if (plist.getLayout() == H5D_CHUNKED)
+        plist.getChunk(1, &chunk);
+
+    return chunk;
+}
+
 const Hdf5Handler::ColumnData&
 Hdf5Handler::getColumnData(const std::string& dataSetName) const
 {
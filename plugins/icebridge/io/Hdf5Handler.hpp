@@ -37,6 +37,7 @@
 #include "H5Cpp.h"
 
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <string>
 #include <map>
@@ -76,6 +77,12 @@ public:
 
     uint64_t getNumPoints() const;
 
+    // Number of entries to read at once, a multiple of the largest chunk
+    // size of the columns so that no chunk is decompressed twice.
+    hsize_t getBlockSize() const;
+
+    // Safe to call from several threads.  The reads themselves are
+    // serialized since HDF5 is not thread-safe in all builds.
     void getColumnEntries(
             void* data,
             const std::string& dataSetName,
@@ -106,10 +113,13 @@ private:
     };
 
     hsize_t getColumnNumEntries(const std::string& dataSetName) const;
+    hsize_t getColumnChunkSize(const std::string& dataSetName) const;
     const ColumnData& getColumnData(const std::string& dataSetName) const;
 
     std::unique_ptr<H5::H5File> m_h5File;
     uint64_t m_numPoints;
+    hsize_t m_blockSize;
+    mutable std::mutex m_mutex;
 
     std::map<std::string, ColumnData> m_columnDataMap;
 };
@@ -36,6 +36,7 @@
 #include <pdal/util/FileUtils.hpp>
 #include <pdal/PointView.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 #include <map>
 
@@ -86,6 +87,67 @@ Dimension::IdList dimensions()
         Id::PulseWidth, Id::GpsTime };
 }
 
+// All data we read for icebridge is currently 4 bytes wide.
+const size_t ValueSize = 4;
+
+struct ViewSetter
+{
+    PointView& view;
+    Dimension::Id dim;
+    PointId start;
+
+    template<typename T>
+    void operator()(PointId i, T val) const
+        { view.setField(dim, start + i, val); }
+};
+
+struct PointSetter
+{
+    PointRef& point;
+    Dimension::Id dim;
+
+    template<typename T>
+    void operator()(PointId, T val) const
+        { point.setField(dim, val); }
+};
+
+// Convert count raw values of a column and pass them to the setter.
+template<typename Setter>
+void convertColumn(const pdal::hdf5::Hdf5ColumnData& column,
+    Dimension::Id dim, const unsigned char *raw, point_count_t count,
+    Setter set)
+{
+    // This is ugly but avoids a test in a tight loop.
+    if (column.predType == H5::PredType::NATIVE_FLOAT)
+    {
+        const float *fval = (const float *)raw;
+
+        // Offset time is in ms but icebridge stores in seconds.
+        if (dim == Dimension::Id::OffsetTime)
+        {
+            for (PointId i = 0; i < count; ++i)
+                set(i, *fval++ * 1000);
+        }
+        else if (dim == Dimension::Id::X)
+        {
+            // Longitude is 0-360. Convert
+            for (PointId i = 0; i < count; ++i)
+                set(i, Utils::normalizeLongitude((double)*fval++));
+        }
+        else
+        {
+            for (PointId i = 0; i < count; ++i)
+                set(i, *fval++);
+        }
+    }
+    else if (column.predType == H5::PredType::NATIVE_INT)
+    {
+        const int32_t *ival = (const int32_t *)raw;
+        for (PointId i = 0; i < count; ++i)
+            set(i, *ival++);
+    }
+}
+
 } // unnamed namespace
 
 void IcebridgeReader::addDimensions(PointLayoutPtr layout)
@@ -105,6 +167,9 @@ void IcebridgeReader::ready(PointTableRef table)
         throwError(err.what());
     }
     m_index = 0;
+    m_buffers.clear();
+    m_bufferIndex = 0;
+    m_bufferCount = 0;
     if (!m_metadataFile.empty())
     {
         m_mdReader.readMetadataFile(m_metadataFile, &m_metadata);
@@ -114,71 +179,86 @@ void IcebridgeReader::ready(PointTableRef table)
 
 point_count_t IcebridgeReader::read(PointViewPtr view, point_count_t count)
 {
-    //All data we read for icebridge is currently 4 bytes wide, so
-    //  just allocate once and forget it.
-    //This could be a huge allocation.  Perhaps we should do something
-    //  in the icebridge handler?
-
     PointId startId = view->size();
     point_count_t remaining = m_hdf5Handler.getNumPoints() - m_index;
     count = (std::min)(count, remaining);
 
-    std::unique_ptr<unsigned char>
-        rawData(new unsigned char[count * sizeof(float)]);
-
     //Not loving the position-linked data, but fine for now.
     Dimension::IdList dims = dimensions();
-    auto di = dims.begin();
-    for (auto ci = hdf5Columns.begin(); ci != hdf5Columns.end(); ++ci, ++di)
+
+    // Each column is read and converted on its own thread, except that
+    // X, Y and Z share one since setting them touches the view's
+    // modification count.
+    std::vector<std::vector<size_t>> tasks;
+    std::vector<size_t> coords;
+    for (size_t c = 0; c < hdf5Columns.size(); ++c)
     {
-        PointId nextId = startId;
-        PointId idx = m_index;
-        const hdf5::Hdf5ColumnData& column = *ci;
+        if (dims[c] == Dimension::Id::X || dims[c] == Dimension::Id::Y ||
+                dims[c] == Dimension::Id::Z)
+            coords.push_back(c);
+        else
+            tasks.push_back({ c });
+    }
+    tasks.push_back(coords);
 
-        try
-        {
-            m_hdf5Handler.getColumnEntries(rawData.get(), column.name, count,
-                m_index);
-            void *p = (void *)rawData.get();
+    for (PointId i = 0; i < count; ++i)
+        view->setField(Dimension::Id::X, startId + i, 0.0);
 
-            // This is ugly but avoids a test in a tight loop.
-            if (column.predType == H5::PredType::NATIVE_FLOAT)
+    // Columns are read a block at a time, which bounds the buffers and
+    // keeps each read aligned with the datasets' chunks.
+    const point_count_t blockSize = m_hdf5Handler.getBlockSize();
+    try
+    {
+        parallelFor(tasks.size(), [&]()
+        {
+            std::vector<unsigned char> raw;
+            return [&, raw](size_t t) mutable
             {
-                // Offset time is in ms but icebridge stores in seconds.
-                if (*di == Dimension::Id::OffsetTime)
+                for (size_t c : tasks[t])
                 {
-                    float *fval = (float *)p;
-                    for (PointId i = 0; i < count; ++i)
+                    const hdf5::Hdf5ColumnData& column = hdf5Columns[c];
+                    for (point_count_t offset = 0; offset < count;
+                        offset += blockSize)
                     {
-                        view->setField(*di, nextId++, *fval * 1000);
-                        fval++;
+                        point_count_t num =
+                            (std::min)(blockSize, count - offset);
+                        raw.resize(num * ValueSize);
+                        m_hdf5Handler.getColumnEntries(raw.data(),
+                            column.name, num, m_index + offset);
+                        convertColumn(column, dims[c], raw.data(), num,
+                            ViewSetter { *view, dims[c], startId + offset });
                     }
                 }
-                else if (*di == Dimension::Id::X)
-                {
-                    float *fval = (float *)p;
-                    for (PointId i = 0; i < count; ++i)
-                    {
-                        double dval = (double)(*fval);
-                        // Longitude is 0-360. Convert
-                        dval = Utils::normalizeLongitude(dval);
-                        view->setField(*di, nextId++, dval);
-                        fval++;
-                    }
+            };
+        }, 1);
+    }
+    catch(const Hdf5Handler::error& err)
+    {
+        throwError(err.what());
+    }
+    m_index += count;
+    return count;
+}
 
-                }
-                else
-                {
-                    float *fval = (float *)p;
-                    for (PointId i = 0; i < count; ++i)
-                        view->setField(*di, nextId++, *fval++);
-                }
-            }
-            else if (column.predType == H5::PredType::NATIVE_INT)
+
+bool IcebridgeReader::processOne(PointRef& point)
+{
+    if (m_bufferIndex == m_bufferCount)
+    {
+        if (eof())
+            return false;
+
+        m_bufferCount = (std::min)((point_count_t)m_hdf5Handler.getBlockSize(),
+            m_hdf5Handler.getNumPoints() - m_index);
+        m_bufferIndex = 0;
+        m_buffers.resize(hdf5Columns.size());
+        try
+        {
+            for (size_t c = 0; c < hdf5Columns.size(); ++c)
             {
-                int32_t *ival = (int32_t *)p;
-                for (PointId i = 0; i < count; ++i)
-                    view->setField(*di, nextId++, *ival++);
+                m_buffers[c].resize(m_bufferCount * ValueSize);
+                m_hdf5Handler.getColumnEntries(m_buffers[c].data(),
+                    hdf5Columns[c].name, m_bufferCount, m_index);
             }
         }
         catch(const Hdf5Handler::error& err)
@@ -186,7 +266,15 @@ point_count_t IcebridgeReader::read(PointViewPtr view, point_count_t count)
             throwError(err.what());
         }
     }
-    return count;
+
+    static const Dimension::IdList dims(dimensions());
+    for (size_t c = 0; c < hdf5Columns.size(); ++c)
+        convertColumn(hdf5Columns[c], dims[c],
+            m_buffers[c].data() + m_bufferIndex * ValueSize, 1,
+            PointSetter { point, dims[c] });
+    m_bufferIndex++;
+    m_index++;
+    return true;
 }
 
 void IcebridgeReader::addArgs(ProgramArgs& args)
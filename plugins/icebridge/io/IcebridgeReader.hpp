@@ -37,6 +37,7 @@
 #include <pdal/pdal_features.hpp>
 
 #include <pdal/Reader.hpp>
+#include <pdal/Streamable.hpp>
 #include <pdal/Options.hpp>
 #include <pdal/StageFactory.hpp>
 
@@ -61,10 +62,10 @@ namespace pdal
 namespace pdal
 {
 
-class PDAL_DLL IcebridgeReader : public pdal::Reader
+class PDAL_DLL IcebridgeReader : public pdal::Reader, public pdal::Streamable
 {
 public:
-    IcebridgeReader() : pdal::Reader()
+    IcebridgeReader() : pdal::Reader(), pdal::Streamable()
         {}
     std::string getName() const;
 
@@ -72,11 +73,17 @@ private:
     Hdf5Handler m_hdf5Handler;
     point_count_t m_index;
 
+    // Column data of the current block when streaming.
+    std::vector<std::vector<unsigned char>> m_buffers;
+    point_count_t m_bufferIndex;
+    point_count_t m_bufferCount;
+
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void addArgs(ProgramArgs& args);
     virtual void initialize();
     virtual void ready(PointTableRef table);
     virtual point_count_t read(PointViewPtr view, point_count_t count);
+    virtual bool processOne(PointRef& point);
     virtual void done(PointTableRef table);
     virtual bool eof();
 
@@ -40,6 +40,8 @@
 #include <pdal/StageFactory.hpp>
 #include <pdal/util/FileUtils.hpp>
 
+#include <filters/StreamCallbackFilter.hpp>
+
 #include "Support.hpp"
 
 using namespace pdal;
@@ -138,6 +140,40 @@ TEST(IcebridgeReaderTest, testRead)
             0.0);           // relTime
 }
 
+TEST(IcebridgeReaderTest, testStream)
+{
+    StageFactory f;
+    Options options;
+    options.add("filename", getFilePath());
+
+    Stage* reader(f.createStage("readers.icebridge"));
+    reader->setOptions(options);
+    PointTable table;
+    reader->prepare(table);
+    PointViewSet viewSet = reader->execute(table);
+    PointViewPtr view = *viewSet.begin();
+
+    Stage* sreader(f.createStage("readers.icebridge"));
+    sreader->setOptions(options);
+
+    PointId idx = 0;
+    StreamCallbackFilter filter;
+    filter.setCallback([&idx, &view](PointRef& p)
+    {
+        for (Dimension::Id dim : view->dims())
+            EXPECT_DOUBLE_EQ(p.getFieldAs<double>(dim),
+                view->getFieldAs<double>(dim, idx));
+        idx++;
+        return true;
+    });
+    filter.setInput(*sreader);
+
+    FixedPointTable ft(1);
+    filter.prepare(ft);
+    filter.execute(ft);
+    EXPECT_EQ(idx, view->size());
+}
+
 TEST(IcebridgeReaderTest, testPipeline)
 {
     PipelineManager manager;
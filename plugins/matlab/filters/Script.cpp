@@ -40,6 +40,25 @@ namespace pdal
 namespace mlang
 {
 
+namespace
+{
+
+template<typename T>
+void getColumnT(const PointView& view, Dimension::Id id, PointId begin,
+    point_count_t count, void *data)
+{
+    view.getFieldArray(id, begin, count, (T *)data);
+}
+
+template<typename T>
+void setColumnT(PointView& view, Dimension::Id id, PointId begin,
+    point_count_t count, const void *data)
+{
+    view.setFieldArray(id, begin, count, (const T *)data);
+}
+
+} // unnamed namespace
+
 
 std::ostream& operator << (std::ostream& os, Script const& script)
 {
@@ -205,11 +224,7 @@ void Script::getMatlabStruct(mxArray* array, PointViewPtr view, const Dimension:
             throw pdal::pdal_error(oss.str());
         }
 
-        for (PointId i = 0; i < view->size(); ++i)
-        {
-            view->setField(d, pt, i, p);
-            p += view->dimSize(d);
-        }
+        setColumn(*view, d, pt, 0, view->size(), p);
     }
 
     // TODO: add back metadata
@@ -249,13 +264,7 @@ mxArray* Script::setMatlabStruct(PointViewPtr view, const Dimension::IdList& ind
         Dimension::Id id = dims[j];
         Dimension::Type t = view->dimType(id);
         mxArray* array = arrays[j];
-        char* pointsPtr = (char*)mxGetData(array);
-
-        for (point_count_t i = 0; i < view->size(); ++i)
-        {
-            view->getField(pointsPtr, id, t, i);
-            pointsPtr += view->dimSize(id);
-        }
+        getColumn(*view, id, t, 0, view->size(), mxGetData(array));
     }
 
     // Push the dimension names into a char**
@@ -328,6 +337,91 @@ mxArray* Script::setMatlabStruct(PointViewPtr view, const Dimension::IdList& ind
 
 }
 
+void Script::getColumn(const PointView& view, Dimension::Id id,
+    Dimension::Type type, PointId begin, point_count_t count, void *data)
+{
+    switch (type)
+    {
+    case Dimension::Type::Float:
+        getColumnT<float>(view, id, begin, count, data);
+        break;
+    case Dimension::Type::Double:
+        getColumnT<double>(view, id, begin, count, data);
+        break;
+    case Dimension::Type::Signed8:
+        getColumnT<int8_t>(view, id, begin, count, data);
+        break;
+    case Dimension::Type::Signed16:
+        getColumnT<int16_t>(view, id, begin, count, data);
+        break;
+    case Dimension::Type::Signed32:
+        getColumnT<int32_t>(view, id, begin, count, data);
+        break;
+    case Dimension::Type::Signed64:
+        getColumnT<int64_t>(view, id, begin, count, data);
+        break;
+    case Dimension::Type::Unsigned8:
+        getColumnT<uint8_t>(view, id, begin, count, data);
+        break;
+    case Dimension::Type::Unsigned16:
+        getColumnT<uint16_t>(view, id, begin, count, data);
+        break;
+    case Dimension::Type::Unsigned32:
+        getColumnT<uint32_t>(view, id, begin, count, data);
+        break;
+    case Dimension::Type::Unsigned64:
+        getColumnT<uint64_t>(view, id, begin, count, data);
+        break;
+    default:
+        throw pdal::pdal_error("Unable to copy dimension '" +
+            view.dimName(id) + "' of unsupported type to a Matlab array.");
+    }
+}
+
+
+void Script::setColumn(PointView& view, Dimension::Id id,
+    Dimension::Type type, PointId begin, point_count_t count,
+    const void *data)
+{
+    switch (type)
+    {
+    case Dimension::Type::Float:
+        setColumnT<float>(view, id, begin, count, data);
+        break;
+    case Dimension::Type::Double:
+        setColumnT<double>(view, id, begin, count, data);
+        break;
+    case Dimension::Type::Signed8:
+        setColumnT<int8_t>(view, id, begin, count, data);
+        break;
+    case Dimension::Type::Signed16:
+        setColumnT<int16_t>(view, id, begin, count, data);
+        break;
+    case Dimension::Type::Signed32:
+        setColumnT<int32_t>(view, id, begin, count, data);
+        break;
+    case Dimension::Type::Signed64:
+        setColumnT<int64_t>(view, id, begin, count, data);
+        break;
+    case Dimension::Type::Unsigned8:
+        setColumnT<uint8_t>(view, id, begin, count, data);
+        break;
+    case Dimension::Type::Unsigned16:
+        setColumnT<uint16_t>(view, id, begin, count, data);
+        break;
+    case Dimension::Type::Unsigned32:
+        setColumnT<uint32_t>(view, id, begin, count, data);
+        break;
+    case Dimension::Type::Unsigned64:
+        setColumnT<uint64_t>(view, id, begin, count, data);
+        break;
+    default:
+        throw pdal::pdal_error("Unable to copy Matlab array of unsupported "
+            "type to dimension '" + view.dimName(id) + "'.");
+    }
+}
+
+
 Dimension::Type Script::getPDALDataType(mxClassID t)
 {
     using namespace Dimension;
@@ -62,6 +62,15 @@ public:
     static std::string getLogicalMask(mxArray* array, LogPtr log);
     static std::string getSRSWKT(mxArray* array, LogPtr log);
 
+    // Copy a run of a dimension to/from a packed buffer of the given type,
+    // one column at a time, as Matlab stores its arrays.
+    static void getColumn(const PointView& view, Dimension::Id id,
+        Dimension::Type type, PointId begin, point_count_t count,
+        void *data);
+    static void setColumn(PointView& view, Dimension::Id id,
+        Dimension::Type type, PointId begin, point_count_t count,
+        const void *data);
+
     std::string m_source;
     std::string m_scriptFilename;
 
@@ -133,17 +133,47 @@ void MatlabReader::addDimensions(PointLayoutPtr layout)
 
 point_count_t MatlabReader::read(PointViewPtr view, point_count_t numPts)
 {
-    PointId idx = view->size();
-    point_count_t cnt = 0;
-    PointRef point(*view, idx);
-    while (cnt < numPts)
+    const PointId start = view->size();
+    point_count_t cnt = (std::min)((point_count_t)(m_numElements -
+        m_pointIndex), numPts);
+    if (!cnt || !m_numFields)
+        return 0;
+
+    // Matlab arrays are column-major, so copy each field into the view as
+    // a block.  The first field is appended point by point to grow the view.
+    for (int i = 0; i < m_numFields; ++i)
     {
-        point.setPointId(idx);
-        if (!processOne(point))
-            break;
-        cnt++;
-        idx++;
+        Dimension::Id d = (Dimension::Id) m_dimensionIdMap[i];
+        Dimension::Type t = (Dimension::Type) m_dimensionTypeMap[i];
+
+        mxArray* f = mxGetFieldByNumber(m_structArray, 0, i);
+        if (!f)
+        {
+            std::ostringstream oss;
+            oss << "Unable to fetch array for field " << i;
+            throwError(oss.str());
+        }
+        if ((size_t)mxGetNumberOfElements(f) < m_pointIndex + cnt)
+        {
+            std::ostringstream oss;
+            oss << "Array for field " << i << " has fewer than " <<
+                m_numElements << " elements.";
+            throwError(oss.str());
+        }
+        size_t size = mxGetElementSize(f);
+        char* p = (char*)mxGetData(f) + (m_pointIndex * size);
+        if (i == 0)
+        {
+            for (PointId idx = 0; idx < cnt; ++idx)
+            {
+                view->setField(d, t, start + idx, (void*)p);
+                p += size;
+            }
+        }
+        else
+            mlang::Script::setColumn(*view, d, t, start, cnt, p);
     }
+    m_pointIndex += cnt;
     return cnt;
 }
 
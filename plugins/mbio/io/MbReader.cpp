@@ -54,14 +54,28 @@ CREATE_SHARED_STAGE(MbReader, s_info)
 
 std::string MbReader::getName() const { return s_info.name; }
 
+namespace
+{
+
+// Number of points decoded before a batch is handed to the reader.
+const size_t BatchSize = 16384;
+
+// Number of decoded batches the read-ahead thread may hold.
+const size_t MaxBatches = 4;
+
+} // unnamed namespace
+
 MbReader::MbReader() : m_bath(nullptr), m_bathlon(nullptr),
     m_bathlat(nullptr), m_amp(nullptr), m_bathflag(nullptr), m_ss(nullptr),
-    m_sslon(nullptr), m_sslat(nullptr)
+    m_sslon(nullptr), m_sslat(nullptr), m_eof(false), m_stop(false),
+    m_pos(0)
 {}
 
 
 MbReader::~MbReader()
-{}
+{
+    stopReadAhead();
+}
 
 
 void MbReader::addArgs(ProgramArgs& args)
@@ -130,6 +144,15 @@ void MbReader::ready(PointTableRef table)
         (void **)&m_sslon, &error);
     mb_register_array(verbose, m_ctx, 3, sizeof(double),
         (void **)&m_sslat, &error);
+
+    stopReadAhead();
+    m_batches.clear();
+    m_current.reset();
+    m_pos = 0;
+    m_eof = false;
+    m_stop = false;
+    m_error.clear();
+    m_worker = std::thread(&MbReader::readAhead, this);
 }
 
 namespace
@@ -221,7 +244,9 @@ double timeconvert(int time_i[7])
 
 } // namespace
 
-bool MbReader::loadData()
+// Decode pings until the batch is full.  Returns false at the end of
+// the file.
+bool MbReader::loadData(Batch& batch)
 {
     int verbose = 0;
     int kind;
@@ -241,7 +266,7 @@ bool MbReader::loadData()
     char comment[MB_COMMENT_MAXLINE];
     int error;
 
-    while (true)
+    while (batch.size() < BatchSize)
     {
         int status = mb_read(verbose, m_ctx, &kind, &pings, pingTime,
             &pingTimeT, &lon, &lat, &speed, &heading, &distance, &altitude,
@@ -249,8 +274,6 @@ bool MbReader::loadData()
             m_amp, m_bathlon, m_bathlat, m_ss, m_sslon, m_sslat, comment,
             &error);
 
-        double gpsTime = timeconvert(pingTime);
-
         if (status == 0)
         {
             if (error > 0 && error != MB_ERROR_EOF)
@@ -260,77 +283,138 @@ bool MbReader::loadData()
 
         if (kind == 1)
         {
-            bool ok(false);
+            double gpsTime = timeconvert(pingTime);
+
             if (m_dataType == DataType::Multibeam)
-                ok = extractMultibeam(numBath, numAmp, gpsTime);
+                extractMultibeam(batch, numBath, numAmp, gpsTime);
             else
-                ok = extractSidescan(numSs, gpsTime);
-            if (ok)
-                break;
+                extractSidescan(batch, numSs, gpsTime);
         }
     }
     return true;
 }
 
 
-bool MbReader::extractMultibeam(int numBath, int numAmp, double gpsTime)
+void MbReader::extractMultibeam(Batch& batch, int numBath, int numAmp,
+    double gpsTime)
 {
     for (size_t i = 0; i < (size_t)numBath; ++i)
     {
         if (m_bathflag[i] & 1)
             continue;
-        m_bathQueue.emplace(m_bathlon[i], m_bathlat[i], -m_bath[i],
-                m_amp[i], gpsTime);
+        batch.m_x.push_back(m_bathlon[i]);
+        batch.m_y.push_back(m_bathlat[i]);
+        batch.m_z.push_back(-m_bath[i]);
+        batch.m_value.push_back(m_amp[i]);
     }
+    batch.m_time.resize(batch.m_x.size(), gpsTime);
     if (numBath != numAmp)
-        log()->get(LogLevel::Warning) << getName() << ": Number of "
-            "bathymetry values doesn't match number of amplitude "
-            "values." << std::endl;
-    return m_bathQueue.size();
+        batch.m_mismatches++;
 }
 
 
-bool MbReader::extractSidescan(int numSs, double gpsTime)
+void MbReader::extractSidescan(Batch& batch, int numSs, double gpsTime)
 {
-    for (size_t i = 0; i < (size_t)numSs; ++i)
-        m_ssQueue.emplace(m_sslon[i], m_sslat[i], m_ss[i], gpsTime);
-    return m_ssQueue.size();
+    batch.m_x.insert(batch.m_x.end(), m_sslon, m_sslon + numSs);
+    batch.m_y.insert(batch.m_y.end(), m_sslat, m_sslat + numSs);
+    batch.m_value.insert(batch.m_value.end(), m_ss, m_ss + numSs);
+    batch.m_time.resize(batch.m_x.size(), gpsTime);
 }
 
 
-bool MbReader::processOne(PointRef& point)
+// Run on m_worker.  Decode batches until the end of the file, staying at
+// most MaxBatches ahead of the reader.
+void MbReader::readAhead()
 {
-    if (m_dataType == DataType::Multibeam)
+    try
+    {
+        bool more = true;
+        while (more)
+        {
+            std::unique_ptr<Batch> batch(new Batch);
+            more = loadData(*batch);
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this]()
+                { return m_stop || m_batches.size() < MaxBatches; });
+            if (m_stop)
+                return;
+            if (batch->size())
+                m_batches.push_back(std::move(batch));
+            m_eof = !more;
+            m_cv.notify_all();
+        }
+    }
+    catch (const std::exception& err)
     {
-        if (m_bathQueue.empty())
-            if (!loadData())
-            {
-                return false;
-            }
-
-        BathData& bd = m_bathQueue.front();
-
-        point.setField(Dimension::Id::X, bd.m_bathlon);
-        point.setField(Dimension::Id::Y, bd.m_bathlat);
-        point.setField(Dimension::Id::Z, bd.m_bath);
-        point.setField(Dimension::Id::GpsTime, bd.m_time);
-        point.setField(Dimension::Id::Amplitude, bd.m_amp);
-        m_bathQueue.pop();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_error = err.what();
+        m_eof = true;
+        m_cv.notify_all();
     }
-    else // Sidescan
+}
+
+
+// Make the next decoded batch current.  Returns false once all batches
+// have been read.
+bool MbReader::nextBatch()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [this]() { return m_batches.size() || m_eof; });
+    if (m_batches.empty())
     {
-        if (m_ssQueue.empty())
-            if (!loadData())
-                return false;
+        m_current.reset();
+        if (m_error.size())
+            throw pdal_error(m_error);
+        return false;
+    }
+    m_current = std::move(m_batches.front());
+    m_batches.pop_front();
+    m_pos = 0;
+    m_cv.notify_all();
+    lock.unlock();
+
+    if (m_current->m_mismatches)
+        log()->get(LogLevel::Warning) << getName() << ": Number of "
+            "bathymetry values doesn't match number of amplitude "
+            "values in " << m_current->m_mismatches << " pings." << std::endl;
+    return true;
+}
 
-        SidescanData& ss = m_ssQueue.front();
 
-        point.setField(Dimension::Id::X, ss.m_sslon);
-        point.setField(Dimension::Id::Y, ss.m_sslat);
-        point.setField(Dimension::Id::GpsTime, ss.m_time);
-        point.setField(Dimension::Id::Intensity, ss.m_ss);
-        m_ssQueue.pop();
+void MbReader::stopReadAhead()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
     }
+    m_cv.notify_all();
+    if (m_worker.joinable())
+        m_worker.join();
+}
+
+
+Dimension::Id MbReader::valueDim() const
+{
+    return m_dataType == DataType::Multibeam ?
+        Dimension::Id::Amplitude : Dimension::Id::Intensity;
+}
+
+
+bool MbReader::processOne(PointRef& point)
+{
+    if (!m_current || m_pos >= m_current->size())
+        if (!nextBatch())
+            return false;
+
+    const Batch& b = *m_current;
+    point.setField(Dimension::Id::X, b.m_x[m_pos]);
+    point.setField(Dimension::Id::Y, b.m_y[m_pos]);
+    if (m_dataType == DataType::Multibeam)
+        point.setField(Dimension::Id::Z, b.m_z[m_pos]);
+    point.setField(Dimension::Id::GpsTime, b.m_time[m_pos]);
+    point.setField(valueDim(), b.m_value[m_pos]);
+    m_pos++;
     return true;
 }
 
@@ -354,15 +438,32 @@ point_count_t MbReader::read(PointViewPtr view, point_count_t count)
 {
     using namespace pdal::Dimension;
 
-    PointRef point = view->point(0);
-    PointId id;
-    for (id = 0; id < count; ++id)
+    point_count_t numRead = 0;
+    while (numRead < count)
     {
-        point.setPointId(id);
-        if (!processOne(point))
-            break;
+        if (!m_current || m_pos >= m_current->size())
+            if (!nextBatch())
+                break;
+
+        const Batch& b = *m_current;
+        point_count_t num = (std::min)(count - numRead,
+            (point_count_t)(b.size() - m_pos));
+        PointId start = view->size();
+
+        // Setting X adds the points.  The other dimensions are set a
+        // batch at a time.
+        for (PointId i = 0; i < num; ++i)
+            view->setField(Id::X, start + i, b.m_x[m_pos + i]);
+        view->setFieldArray(Id::Y, start, num, b.m_y.data() + m_pos);
+        if (m_dataType == DataType::Multibeam)
+            view->setFieldArray(Id::Z, start, num, b.m_z.data() + m_pos);
+        view->setFieldArray(Id::GpsTime, start, num, b.m_time.data() + m_pos);
+        view->setFieldArray(valueDim(), start, num, b.m_value.data() + m_pos);
+
+        m_pos += num;
+        numRead += num;
     }
-    return id;
+    return numRead;
 }
 
 
@@ -370,6 +471,7 @@ void MbReader::done(PointTableRef table)
 {
     int error;
 
+    stopReadAhead();
     mb_close(0, &m_ctx, &error);
     getMetadata().addList("filename", m_filename);
 }
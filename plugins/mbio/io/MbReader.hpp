@@ -34,7 +34,12 @@
 
 #pragma once
 
-#include <queue>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include <pdal/Reader.hpp>
 #include <pdal/Streamable.hpp>
@@ -52,35 +57,24 @@ extern "C"
 namespace pdal
 {
 
-struct BathData;
-
 class PDAL_DLL MbReader : public Reader, public Streamable
 {
-    struct BathData
+    // Points decoded from a run of pings, stored by dimension.
+    struct Batch
     {
-        double m_bathlon;
-        double m_bathlat;
-        double m_bath;
-        double m_amp;
-        double m_time;
-
-        BathData(double bathlon, double bathlat, double bath, double amp,
-                double time) :
-            m_bathlon(bathlon), m_bathlat(bathlat), m_bath(bath), m_amp(amp),
-            m_time(time)
+        std::vector<double> m_x;
+        std::vector<double> m_y;
+        std::vector<double> m_z;
+        std::vector<double> m_value;
+        std::vector<double> m_time;
+        // Pings whose bathymetry and amplitude counts differ.
+        size_t m_mismatches;
+
+        Batch() : m_mismatches(0)
         {}
-    };
-
-    struct SidescanData
-    {
-        double m_sslon;
-        double m_sslat;
-        double m_ss;
-        double m_time;
 
-        SidescanData(double sslon, double sslat, double ss, double time) :
-            m_sslon(sslon), m_sslat(sslat), m_ss(ss), m_time(time)
-        {}
+        size_t size() const
+            { return m_x.size(); }
     };
 
     enum class DataType
@@ -104,9 +98,13 @@ private:
     virtual void ready(PointTableRef table);
     virtual point_count_t read(PointViewPtr view, point_count_t count);
     virtual void done(PointTableRef table);
-    bool loadData();
-    bool extractMultibeam(int numBath, int numAmp, double time);
-    bool extractSidescan(int numSs, double time);
+    bool loadData(Batch& batch);
+    void extractMultibeam(Batch& batch, int numBath, int numAmp, double time);
+    void extractSidescan(Batch& batch, int numSs, double time);
+    void readAhead();
+    bool nextBatch();
+    void stopReadAhead();
+    Dimension::Id valueDim() const;
 
     friend std::istream& operator>>(std::istream& in,
         MbReader::DataType& mode);
@@ -122,8 +120,18 @@ private:
     double *m_ss;
     double *m_sslon;
     double *m_sslat;
-    std::queue<BathData> m_bathQueue;
-    std::queue<SidescanData> m_ssQueue;
+
+    // Batches are decoded by m_worker ahead of the batch being read.
+    std::thread m_worker;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<std::unique_ptr<Batch>> m_batches;
+    bool m_eof;
+    bool m_stop;
+    std::string m_error;
+    std::unique_ptr<Batch> m_current;
+    size_t m_pos;
+
     MbFormat m_format;
     double m_timegap;
     double m_speedmin;
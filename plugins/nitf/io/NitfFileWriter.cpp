@@ -302,5 +302,15 @@ void NitfFileWriter::wrapData(const std::string& filename)
     m_source.reset(new nitf::SegmentFileSource(*m_inputHandle, 0, 0));
 }
 
+
+// Drop the wrapped data, closing the input file if there is one.
+void NitfFileWriter::releaseData()
+{
+    m_source.reset();
+    if (m_inputHandle)
+        m_inputHandle->close();
+    m_inputHandle.reset();
+}
+
 } // namespace pdal
 
@@ -75,6 +75,7 @@ public:
         { m_filename = filename; }
     void wrapData(const char *buf, size_t size);
     void wrapData(const std::string& filename);
+    void releaseData();
     void addArgs(ProgramArgs& args);
     void setBounds(const BOX3D& bounds);
     void write();
@@ -61,6 +61,12 @@ typedef pdalboost::iostreams::stream<RDevice> RStream;
                 m_rdevice.reset(new RDevice(*m_baseStream, offset, len));
                 m_rstream.reset(new RStream(*m_rdevice));
                 m_istream = m_rstream.get();
+                // The LAS data can be mapped in place within the NITF.
+                if (FileUtils::fileExists(filename))
+                {
+                    m_localFilename = filename;
+                    m_localOffset = offset;
+                }
             }
         }
 
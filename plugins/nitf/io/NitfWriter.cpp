@@ -39,6 +39,7 @@
 
 #include <pdal/GDALUtils.hpp>
 #include <pdal/PointView.hpp>
+#include <pdal/util/FileUtils.hpp>
 
 #ifndef IMPORT_NITRO_API
 #define IMPORT_NITRO_API
@@ -106,13 +107,21 @@ void NitfWriter::writeView(const PointViewPtr view)
 }
 
 
+// The LAS data is streamed to a file next to the output rather than held
+// in memory.  The NITF headers, which hold the length of the data, are
+// written in front of it once the LAS header has been patched.
 void NitfWriter::readyFile(const std::string& filename,
     const SpatialReference& srs)
 {
     m_nitf.setFilename(filename);
+    m_lasFilename = FileUtils::uniqueFilename(
+        FileUtils::getDirectory(filename), "nitf");
 
+    std::ostream *out = createFile(m_lasFilename);
+    if (!out)
+        throwError("Couldn't open file '" + m_lasFilename + "' for output.");
     Utils::writeProgress(m_progressFd, "READYFILE", filename);
-    prepOutput(&m_oss, srs);
+    prepOutput(out, srs);
 }
 
 
@@ -120,24 +129,29 @@ void NitfWriter::doneFile()
 {
     finishOutput();
 
-    std::streambuf *buf = m_oss.rdbuf();
-    std::streamoff size = buf->pubseekoff(0, m_oss.end);
-    buf->pubseekoff(0, m_oss.beg);
-
-    std::vector<char> bytes(size);
-    buf->sgetn(bytes.data(), size);
-    m_oss.clear();
-    m_nitf.wrapData(bytes.data(), size);
-    m_nitf.setBounds(reprojectBoxToDD(m_srs, m_lasHeader.getBounds()));
-
+    std::ostream *out = m_ostream;
+    m_ostream = NULL;
     try
     {
+        Utils::closeFile(out);
+        m_nitf.wrapData(m_lasFilename);
+        m_nitf.setBounds(reprojectBoxToDD(m_srs, m_lasHeader.getBounds()));
         m_nitf.write();
     }
     catch (const NitfFileWriter::error& err)
     {
+        m_nitf.releaseData();
+        FileUtils::deleteFile(m_lasFilename);
         throwError(err.what());
     }
+    catch (...)
+    {
+        m_nitf.releaseData();
+        FileUtils::deleteFile(m_lasFilename);
+        throw;
+    }
+    m_nitf.releaseData();
+    FileUtils::deleteFile(m_lasFilename);
 }
 
 } // namespaces
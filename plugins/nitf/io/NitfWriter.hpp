@@ -51,7 +51,7 @@ public:
 
 private:
     NitfFileWriter m_nitf;
-    std::stringstream m_oss;
+    std::string m_lasFilename;
     BOX3D m_bounds;
 
     virtual void addArgs(ProgramArgs& args);
@@ -38,6 +38,9 @@
 #include <pdal/compression/LazPerfCompression.hpp>
 #include <pdal/util/FileUtils.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+#include <thread>
 
 #include "OciReader.hpp"
 
@@ -55,6 +58,15 @@ CREATE_SHARED_STAGE(OciReader, s_info)
 
 std::string OciReader::getName() const { return s_info.name; }
 
+OciReader::OciReader() : m_atEnd(false), m_compression(false), m_cloudId(0),
+    m_nextBlock(0)
+{}
+
+
+OciReader::~OciReader()
+{}
+
+
 void OciReader::addArgs(ProgramArgs& args)
 {
     args.add("query", "SQL query to retrieve points", m_query).setPositional();
@@ -63,6 +75,12 @@ void OciReader::addArgs(ProgramArgs& args)
     args.add("connection", "Connection string", m_connSpec);
     args.add("populate_pointsourceid", "Set point source ID",
         m_updatePointSourceId);
+    args.add("fetch_size", "Number of blocks returned by the database in "
+        "each round trip", m_fetchSize, 10U);
+    args.add("max_blocks", "Maximum number of blocks held in memory and "
+        "decoded together", m_maxBlocks, size_t(64));
+    args.add("threads", "Number of threads used to decode blocks.  "
+        "The default is the number of cores.", m_threads);
 }
 
 
@@ -83,7 +101,13 @@ void OciReader::initialize()
     if (m_query.empty())
         throwError("'query' statement is empty. No data can be read.");
 
+    if (m_fetchSize == 0)
+        throwError("Option 'fetch_size' must be greater than 0.");
+    if (m_maxBlocks == 0)
+        throwError("Option 'max_blocks' must be greater than 0.");
+
     m_stmt = Statement(m_connection->CreateStatement(m_query.c_str()));
+    m_stmt->SetPrefetch(m_fetchSize);
     m_stmt->Execute(0);
 
     validateQuery();
@@ -244,151 +268,248 @@ void OciReader::addDimensions(PointLayoutPtr layout)
 }
 
 
-point_count_t OciReader::read(PointViewPtr view, point_count_t count)
+void OciReader::ready(PointTableRef)
 {
-    if (eof())
-        return 0;
-
-    point_count_t totalNumRead = 0;
-    while (totalNumRead < count)
-    {
-        if (m_block->numRemaining() == 0)
-            if (!readOci(m_stmt, m_block))
-                return totalNumRead;
-        PointId bufBegin = view->size();
-
-        point_count_t numRead = 0;
-        if (orientation() == Orientation::DimensionMajor)
-            numRead = readDimMajor(*view, m_block, count - totalNumRead);
-        else if (orientation() == Orientation::PointMajor)
-            numRead = readPointMajor(*view, m_block, count - totalNumRead);
-        PointId bufEnd = bufBegin + numRead;
-        totalNumRead += numRead;
-    }
-    return totalNumRead;
+    m_atEnd = false;
+    m_blocks.clear();
+    m_nextBlock = 0;
+
+    size_t threads = m_threads ? m_threads :
+        (size_t)(std::max)(std::thread::hardware_concurrency(), 1U);
+    if (threads > 1)
+        m_pool.reset(new ThreadPool(threads, m_maxBlocks, false));
 }
 
 
-point_count_t OciReader::readDimMajor(PointView& view, BlockPtr block,
-    point_count_t numPts)
+void OciReader::done(PointTableRef)
 {
-    using namespace Dimension;
+    m_pool.reset();
+    m_blocks.clear();
+}
 
-    point_count_t numRemaining = block->numRemaining();
-    PointId startId = view.size();
-    point_count_t blockRemaining = numRemaining;
-    point_count_t numRead = 0;
 
-    DimTypeList dims = dbDimTypes();
-    for (auto di = dims.begin(); di != dims.end(); ++di)
+// Read up to 'max_blocks' blocks from the database.  A batch only
+// contains blocks from a single cloud so that the schema used to decode
+// them is the same.
+bool OciReader::fetchBlocks()
+{
+    m_blocks.clear();
+    m_nextBlock = 0;
+
+    while (m_blocks.size() < m_maxBlocks)
     {
-        PointId nextId = startId;
-        char *pos = seekDimMajor(*di, block);
-        blockRemaining = numRemaining;
-        numRead = 0;
-        while (numRead < numPts && blockRemaining > 0)
+        if (!m_block->fetched())
         {
-            writeField(view, pos, *di, nextId);
-            pos += Dimension::size(di->m_type);
-
-            if (di->m_id == Id::PointSourceId && m_updatePointSourceId)
-                view.setField(Id::PointSourceId, nextId, block->obj_id);
-
-            if (m_cb && di == dims.rbegin().base() - 1)
-                m_cb(view, nextId);
+            if (!m_stmt->Fetch())
+                break;
+            m_block->setFetched();
+        }
 
-            nextId++;
-            numRead++;
-            blockRemaining--;
+        int32_t cloudId = m_stmt->GetInteger(&m_block->pc->pc_id);
+        if (m_blocks.empty())
+        {
+            XMLSchema *s = findSchema(m_stmt, m_block);
+            updateSchema(*s);
+            MetadataNode comp = s->getMetadata().findChild("compression");
+            m_compression = (comp.value() == "lazperf");
+            m_cloudId = cloudId;
         }
+        else if (cloudId != m_cloudId)
+            break;
+
+        // Read the points from the blob in the row.
+        readBlob(m_stmt, m_block);
+
+        FetchedBlock b;
+        b.m_data.swap(m_block->chunk);
+        b.m_numPoints = m_block->numPoints();
+        b.m_pos = 0;
+        b.m_objId = m_block->obj_id;
+        b.m_compressed = m_compression;
+        m_blocks.push_back(std::move(b));
+        m_block->clearFetched();
     }
-    block->setNumRemaining(blockRemaining);
-    return numRead;
+    return m_blocks.size();
 }
 
 
-point_count_t OciReader::readPointMajor(PointView& view,
-    BlockPtr block, point_count_t numPts)
+// Decompress a block's points into packed, point-major data.
+void OciReader::decompress(FetchedBlock& block) const
 {
-    PointId nextId = view.size();
-    point_count_t numRead = 0;
-
-    if (m_compression)
-    {
 #ifdef PDAL_HAVE_LAZPERF
-        auto cb = [this, &view, &nextId, &numRead](char *buf, size_t bufsize)
-        {
-            writePoint(view, nextId, buf);
-            if (m_cb)
-                m_cb(view, nextId);
-            nextId++;
-            numRead++;
-        };
-        const char *src = reinterpret_cast<const char *>(block->chunk.data());
-        size_t srcsize = block->chunk.size();
-        LazPerfDecompressor(cb, dbDimTypes(), block->numRemaining()).
-            decompress(src, srcsize);
+    LazPerfBlockDecompressor decompressor(dbDimTypes());
+    std::vector<uint8_t> data(block.m_numPoints * decompressor.pointSize());
+    decompressor.decompress(reinterpret_cast<const char *>(block.m_data.data()),
+        block.m_data.size(), reinterpret_cast<char *>(data.data()),
+        block.m_numPoints);
+    block.m_data.swap(data);
+    block.m_compressed = false;
 #else
-        throwError("Can't decompress without LAZperf.");
+    throw pdal_error("Can't decompress without LAZperf.");
 #endif
-    }
-    else
-    {
-        char *pos = seekPointMajor(block);
+}
 
-        size_t cnt = block->numRemaining();
-        while (numRead < numPts && cnt--)
-        {
-            writePoint(view, nextId, pos);
 
-            if (m_cb)
-                m_cb(view, nextId);
+// Write 'count' points of a block, starting with the first unread one,
+// to the view at 'start'.  The points must already exist in the view so
+// that blocks can be decoded in parallel.
+void OciReader::decodeBlock(PointView& view, FetchedBlock& block,
+    PointId start, point_count_t count)
+{
+    using namespace Dimension;
+
+    // Compressed blocks are always point-major.
+    bool pointMajor = block.m_compressed ||
+        orientation() == Orientation::PointMajor;
+    if (block.m_compressed)
+        decompress(block);
 
+    const char *data = reinterpret_cast<const char *>(block.m_data.data());
+    DimTypeList dims = dbDimTypes();
+    if (pointMajor)
+    {
+        const char *pos = data + block.m_pos * packedPointSize();
+        for (PointId idx = start; idx < start + count; ++idx)
+        {
+            writePoint(view, idx, pos);
             pos += packedPointSize();
-            nextId++;
-            numRead++;
         }
     }
-    block->setNumRemaining(block->numRemaining() - numRead);
-    return numRead;
+    else
+    {
+        for (const DimType& d : dims)
+        {
+            const char *pos = data + dimOffset(d.m_id) * block.m_numPoints +
+                Dimension::size(d.m_type) * block.m_pos;
+            for (PointId idx = start; idx < start + count; ++idx)
+            {
+                writeField(view, pos, d, idx);
+                pos += Dimension::size(d.m_type);
+            }
+        }
+    }
+
+    if (m_updatePointSourceId)
+        for (const DimType& d : dims)
+            if (d.m_id == Id::PointSourceId)
+                for (PointId idx = start; idx < start + count; ++idx)
+                    view.setField(Id::PointSourceId, idx, block.m_objId);
+    block.m_pos += count;
 }
 
 
-char *OciReader::seekDimMajor(const DimType& d, BlockPtr block)
+point_count_t OciReader::read(PointViewPtr view, point_count_t count)
 {
-    return block->data() +
-        (dimOffset(d.m_id) * block->numPoints()) +
-        (Dimension::size(d.m_type) * block->numRead());
-}
+    if (eof())
+        return 0;
+
+    point_count_t totalNumRead = 0;
+    while (totalNumRead < count)
+    {
+        if (m_nextBlock == m_blocks.size() && !fetchBlocks())
+        {
+            m_atEnd = true;
+            break;
+        }
 
+        // Take the blocks that fit in the requested count.  If the next
+        // block doesn't fit, read part of it.
+        std::vector<FetchedBlock *> blocks;
+        point_count_t numPoints = 0;
+        for (size_t i = m_nextBlock; i < m_blocks.size(); ++i)
+        {
+            FetchedBlock& b = m_blocks[i];
+            point_count_t remaining = b.m_numPoints - b.m_pos;
+            if (numPoints + remaining > count - totalNumRead)
+                break;
+            blocks.push_back(&b);
+            numPoints += remaining;
+        }
 
-char *OciReader::seekPointMajor(BlockPtr block)
-{
-    return block->data() + (block->numRead() * packedPointSize());
+        const PointId start = view->size();
+        if (blocks.empty())
+        {
+            numPoints = count - totalNumRead;
+            for (PointId idx = start; idx < start + numPoints; ++idx)
+                view->getOrAddPoint(idx);
+            decodeBlock(*view, m_blocks[m_nextBlock], start, numPoints);
+        }
+        else
+        {
+            for (PointId idx = start; idx < start + numPoints; ++idx)
+                view->getOrAddPoint(idx);
+
+            if (m_pool && blocks.size() > 1)
+            {
+                PointId pos = start;
+                for (FetchedBlock *b : blocks)
+                {
+                    point_count_t cnt = b->m_numPoints - b->m_pos;
+                    m_pool->add([this, &view, b, pos, cnt]()
+                        { decodeBlock(*view, *b, pos, cnt); });
+                    pos += cnt;
+                }
+                m_pool->await();
+                if (m_pool->errors().size())
+                    throwError(m_pool->errors().front());
+            }
+            else
+            {
+                PointId pos = start;
+                for (FetchedBlock *b : blocks)
+                {
+                    point_count_t cnt = b->m_numPoints - b->m_pos;
+                    decodeBlock(*view, *b, pos, cnt);
+                    pos += cnt;
+                }
+            }
+            m_nextBlock += blocks.size();
+        }
+
+        if (m_cb)
+            for (PointId idx = start; idx < start + numPoints; ++idx)
+                m_cb(*view, idx);
+        totalNumRead += numPoints;
+    }
+    return totalNumRead;
 }
 
 
-// Read a block (set of points) from the database.
-bool OciReader::readOci(Statement stmt, BlockPtr block)
+bool OciReader::processOne(PointRef& point)
 {
-    if (!block->fetched())
+    using namespace Dimension;
+
+    if (eof())
+        return false;
+
+    if (m_nextBlock == m_blocks.size() && !fetchBlocks())
     {
-        if (!stmt->Fetch())
-        {
-            m_atEnd = true;
-            return false;
-        }
-        block->setFetched();
+        m_atEnd = true;
+        return false;
     }
-    // Read the points from the blob in the row.
-    readBlob(stmt, block);
-    XMLSchema *s = findSchema(stmt, block);
-    updateSchema(*s);
-    MetadataNode comp = s->getMetadata().findChild("compression");
-    m_compression = (comp.value() == "lazperf");
 
-    block->reset();
-    block->clearFetched();
+    FetchedBlock& b = m_blocks[m_nextBlock];
+    bool pointMajor = b.m_compressed ||
+        orientation() == Orientation::PointMajor;
+    if (b.m_compressed)
+        decompress(b);
+
+    const char *data = reinterpret_cast<const char *>(b.m_data.data());
+    DimTypeList dims = dbDimTypes();
+    if (pointMajor)
+        writePoint(point, data + b.m_pos * packedPointSize());
+    else
+        for (const DimType& d : dims)
+            writeField(point, data + dimOffset(d.m_id) * b.m_numPoints +
+                Dimension::size(d.m_type) * b.m_pos, d);
+
+    if (m_updatePointSourceId)
+        for (const DimType& d : dims)
+            if (d.m_id == Id::PointSourceId)
+                point.setField(Id::PointSourceId, b.m_objId);
+
+    if (++b.m_pos == b.m_numPoints)
+        m_nextBlock++;
     return true;
 }
 
@@ -34,21 +34,35 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include <pdal/DbReader.hpp>
 #include <pdal/StageFactory.hpp>
+#include <pdal/Streamable.hpp>
 
 #include "OciCommon.hpp"
 
 namespace pdal
 {
 
-class PDAL_DLL OciReader : public DbReader
+class ThreadPool;
+
+class PDAL_DLL OciReader : public DbReader, public Streamable
 {
+    // The data of a block that has been read from the database.
+    struct FetchedBlock
+    {
+        std::vector<uint8_t> m_data;
+        point_count_t m_numPoints;
+        point_count_t m_pos;  // Number of points already read.
+        int32_t m_objId;
+        bool m_compressed;
+    };
+
 public:
-    OciReader()
-    {}
+    OciReader();
+    ~OciReader();
     OciReader& operator=(const OciReader&) = delete;
     OciReader(const OciReader&) = delete;
     std::string getName() const;
@@ -57,9 +71,10 @@ private:
     virtual void addArgs(ProgramArgs& args);
     virtual void initialize();
     virtual void addDimensions(PointLayoutPtr layout);
-    virtual void ready(PointTableRef table)
-        { m_atEnd = false; }
+    virtual void ready(PointTableRef table);
     virtual point_count_t read(PointViewPtr view, point_count_t);
+    virtual bool processOne(PointRef& point);
+    virtual void done(PointTableRef table);
     virtual bool eof()
         { return m_atEnd; }
 
@@ -69,13 +84,10 @@ private:
         BlockPtr block) const;
 
     void readBlob(Statement stmt, BlockPtr block);
-    point_count_t readDimMajor(PointView& view, BlockPtr block,
-        point_count_t numPts);
-    point_count_t readPointMajor(PointView& view, BlockPtr block,
-        point_count_t numPts);
-    char *seekDimMajor(const DimType& d, BlockPtr block);
-    char *seekPointMajor(BlockPtr block);
-    bool readOci(Statement stmt, BlockPtr block);
+    bool fetchBlocks();
+    void decompress(FetchedBlock& block) const;
+    void decodeBlock(PointView& view, FetchedBlock& block, PointId start,
+        point_count_t count);
     XMLSchema *findSchema(Statement stmt, BlockPtr block);
 
     Connection m_connection;
@@ -89,6 +101,13 @@ private:
     bool m_atEnd;
     std::map<int32_t, XMLSchema> m_schemas;
     bool m_compression;
+    int32_t m_cloudId;
+    uint32_t m_fetchSize;
+    size_t m_maxBlocks;
+    size_t m_threads;
+    std::vector<FetchedBlock> m_blocks;
+    size_t m_nextBlock;
+    std::unique_ptr<ThreadPool> m_pool;
 };
 
 } // namespace pdal
@@ -702,6 +702,20 @@ bool OWStatement::Fetch(int nRows)
 }
 
 
+// Set the number of rows returned by the server in each round trip.
+// Rows beyond the first are buffered and returned by subsequent fetches.
+void OWStatement::SetPrefetch(int nRows)
+{
+    ub4 nPrefetch = (ub4) nRows;
+
+    CheckError(OCIAttrSet((dvoid*) hStmt,
+                          (ub4) OCI_HTYPE_STMT,
+                          (dvoid*) &nPrefetch,
+                          (ub4) 0,
+                          (ub4) OCI_ATTR_PREFETCH_ROWS,
+                          hError), hError);
+}
+
 bool OWStatement::GetNextField(
     int nIndex,
     char* pszName,
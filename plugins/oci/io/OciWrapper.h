@@ -405,6 +405,7 @@ public:
 
     bool                Execute( int nRows = 1 );
     bool                Fetch( int nRows = 1 );
+    void                SetPrefetch( int nRows );
     unsigned int        nFetchCount;
 
     bool                GetNextField(
@@ -39,6 +39,7 @@
 
 #include <pdal/pdal_types.hpp>
 
+#include <pdal/ArtifactManager.hpp>
 #include <pdal/PointView.hpp>
 
 #include <pcl/io/pcd_io.h>
@@ -72,15 +73,27 @@ void PCDtoPDAL(CloudT &cloud, PointViewPtr view, BOX3D const& bounds)
 
     if (pcl::traits::has_xyz<typename CloudT::PointType>::value)
     {
+        // X adds the points to the view.  Y and Z are then set a chunk at
+        // a time.
         auto getX = [&cloud, &bounds](size_t i)
             { return cloud.points[i].x + bounds.minx; };
-        auto getY = [&cloud, &bounds](size_t i)
-            { return cloud.points[i].y + bounds.miny; };
-        auto getZ = [&cloud, &bounds](size_t i)
-            { return cloud.points[i].z + bounds.minz; };
         setValues(view, Dimension::Id::X, cloud.points.size(), getX);
-        setValues(view, Dimension::Id::Y, cloud.points.size(), getY);
-        setValues(view, Dimension::Id::Z, cloud.points.size(), getZ);
+
+        const point_count_t ChunkSize = 4096;
+        std::vector<double> y(ChunkSize), z(ChunkSize);
+        for (PointId start = 0; start < cloud.points.size();
+            start += ChunkSize)
+        {
+            point_count_t n = (std::min)(ChunkSize,
+                (point_count_t)(cloud.points.size() - start));
+            for (point_count_t i = 0; i < n; ++i)
+            {
+                y[i] = cloud.points[start + i].y + bounds.miny;
+                z[i] = cloud.points[start + i].z + bounds.minz;
+            }
+            view->setFieldArray(Dimension::Id::Y, start, n, y.data());
+            view->setFieldArray(Dimension::Id::Z, start, n, z.data());
+        }
     }
 
     if (pcl::traits::has_intensity<typename CloudT::PointType>::value)
@@ -143,17 +156,25 @@ void PDALtoPCD(PointViewPtr view, CloudT &cloud, BOX3D const& bounds,
 
     if (pcl::traits::has_xyz<typename CloudT::PointType>::value)
     {
-        for (size_t i = 0; i < cloud.points.size(); ++i)
+        // Fetch the coordinates a chunk at a time and write them straight
+        // into the points of the cloud.
+        const point_count_t ChunkSize = 4096;
+        std::vector<double> x(ChunkSize), y(ChunkSize), z(ChunkSize);
+        for (PointId start = 0; start < cloud.points.size();
+            start += ChunkSize)
         {
-            double xd = view->getFieldAs<double>(Dimension::Id::X, i) - bounds.minx;
-            double yd = view->getFieldAs<double>(Dimension::Id::Y, i) - bounds.miny;
-            double zd = view->getFieldAs<double>(Dimension::Id::Z, i) - bounds.minz;
-
-            typename CloudT::PointType p = cloud.points[i];
-            p.x = (float) (xd / scale_x);
-            p.y = (float) (yd / scale_y);
-            p.z = (float) (zd / scale_z);
-            cloud.points[i] = p;
+            point_count_t n = (std::min)(ChunkSize,
+                (point_count_t)(cloud.points.size() - start));
+            view->getFieldArray(Dimension::Id::X, start, n, x.data());
+            view->getFieldArray(Dimension::Id::Y, start, n, y.data());
+            view->getFieldArray(Dimension::Id::Z, start, n, z.data());
+            for (point_count_t i = 0; i < n; ++i)
+            {
+                typename CloudT::PointType& p = cloud.points[start + i];
+                p.x = (float) ((x[i] - bounds.minx) / scale_x);
+                p.y = (float) ((y[i] - bounds.miny) / scale_y);
+                p.z = (float) ((z[i] - bounds.minz) / scale_z);
+            }
         }
     }
 
@@ -211,6 +232,93 @@ void PDALtoPCD(PointViewPtr view, CloudT &cloud)
 }
 
 
+/**
+ * \brief A cloud kept with the point table for the next PCL-based filter.
+ *
+ * A PCL-based filter stores the cloud from which it created its output
+ * view.  If the next PCL-based filter gets that view unchanged, it uses
+ * the cloud rather than converting the view again.  The cloud is shared
+ * and must not be modified.  Only changes to the positions of points are
+ * tracked, so only clouds of positions should be stored.
+ */
+template <typename CloudT>
+class CloudArtifact : public Artifact
+{
+public:
+    CloudArtifact(const PointView& view, typename CloudT::Ptr cloud,
+            const BOX3D& bounds) : m_viewId(view.id()), m_size(view.size()),
+        m_modCount(view.modCount()), m_cloud(cloud), m_bounds(bounds)
+    {}
+
+    // The cloud holds the points of the view if the view hasn't gained,
+    // lost, reordered or moved points since the cloud was stored.
+    bool matches(const PointView& view) const
+    {
+        return view.id() == m_viewId && view.size() == m_size &&
+            view.modCount() == m_modCount;
+    }
+
+    int m_viewId;
+    point_count_t m_size;
+    uint64_t m_modCount;
+    typename CloudT::Ptr m_cloud;
+    BOX3D m_bounds;
+};
+
+static const std::string CloudArtifactName("pcl.cloud");
+
+/**
+ * \brief Get a cloud of the points of a view.
+ *
+ * If the previous PCL-based filter stored the cloud of this view, the
+ * cloud is shared.  Otherwise the view is converted.
+ *
+ * \param view  View to convert.
+ * \param bounds  Set to the bounds of the view.  Coordinates in the cloud
+ *    are relative to the minimum of the bounds.
+ * \return  The cloud, which must not be modified.
+ */
+template <typename CloudT>
+typename CloudT::Ptr viewToCloud(PointViewPtr view, BOX3D& bounds)
+{
+    ArtifactManager& mgr = view->table().artifactManager();
+    auto art = mgr.get<CloudArtifact<CloudT>>(CloudArtifactName);
+    if (art && art->matches(*view))
+    {
+        bounds = art->m_bounds;
+        return art->m_cloud;
+    }
+
+    bounds.clear();
+    view->calculateBounds(bounds);
+    typename CloudT::Ptr cloud(new CloudT);
+    PDALtoPCD(view, *cloud, bounds);
+    return cloud;
+}
+
+/**
+ * \brief Convert a cloud to a view and keep the cloud for the next
+ *    PCL-based filter.
+ *
+ * \param cloud  Cloud to convert.
+ * \param view  View to which points are added.
+ * \param bounds  Bounds to whose minimum the cloud's coordinates are
+ *    relative.
+ */
+template <typename CloudT>
+void cloudToView(typename CloudT::Ptr cloud, PointViewPtr view,
+    const BOX3D& bounds)
+{
+    PCDtoPDAL(*cloud, view, bounds);
+
+    // Replace any cloud stored by an earlier filter, whatever its type.
+    ArtifactManager& mgr = view->table().artifactManager();
+    mgr.erase(CloudArtifactName);
+    mgr.put(CloudArtifactName,
+        std::make_shared<CloudArtifact<CloudT>>(*view, cloud, bounds));
+}
+
+
 inline void setLogLevel(LogLevel level)
 {
     // PCL should provide console output at similar verbosity level as PDAL
@@ -71,13 +71,11 @@ PointViewSet GridProjectionFilter::run(PointViewPtr input)
 
     log()->get(LogLevel::Debug2) << "Process GridProjectionFilter..." << std::endl;
 
-    BOX3D buffer_bounds;
-    input->calculateBounds(buffer_bounds);
-
-    // convert PointView to PointNormal
+    // convert PointView to PointNormal, or use the cloud of the previous
+    // PCL-based filter
     typedef pcl::PointCloud<pcl::PointXYZ> Cloud;
-    Cloud::Ptr cloud(new Cloud);
-    pclsupport::PDALtoPCD(input, *cloud, buffer_bounds);
+    BOX3D buffer_bounds;
+    Cloud::Ptr cloud = pclsupport::viewToCloud<Cloud>(input, buffer_bounds);
 
     pclsupport::setLogLevel(log()->getLevel());
 
@@ -125,7 +123,7 @@ PointViewSet GridProjectionFilter::run(PointViewPtr input)
         return viewSet;
     }
 
-    pclsupport::PCDtoPDAL(*cloud_f, output, buffer_bounds);
+    pclsupport::cloudToView<Cloud>(cloud_f, output, buffer_bounds);
 
     log()->get(LogLevel::Debug2) << cloud->points.size() << " before, " <<
                                  cloud_f->points.size() << " after" << std::endl;
@@ -76,13 +76,11 @@ PointViewSet PCLBlock::run(PointViewPtr input)
 
     log()->get(LogLevel::Debug2) << "Process PCLBlock..." << std::endl;
 
-    BOX3D bounds;
-    input->calculateBounds(bounds);
-
-    // convert PointView to PointNormal
+    // convert PointView to PointNormal, or use the cloud of the previous
+    // PCL-based filter
     typedef pcl::PointCloud<pcl::PointXYZ> Cloud;
-    Cloud::Ptr cloud(new Cloud);
-    pclsupport::PDALtoPCD(input, *cloud, bounds);
+    BOX3D bounds;
+    Cloud::Ptr cloud = pclsupport::viewToCloud<Cloud>(input, bounds);
 
     pclsupport::setLogLevel(log()->getLevel());
 
@@ -109,7 +107,7 @@ PointViewSet PCLBlock::run(PointViewPtr input)
         return viewSet;
     }
 
-    pclsupport::PCDtoPDAL(*cloud_f, output, bounds);
+    pclsupport::cloudToView<Cloud>(cloud_f, output, bounds);
 
     return viewSet;
 }
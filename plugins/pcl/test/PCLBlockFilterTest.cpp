@@ -126,3 +126,35 @@ TEST(PCLBlockFilterTest, PCLBlockFilterTest_filter_VoxelGrid)
     // test LeafSize
     test_filter("filters/pcl/filter_VoxelGrid.json", 81);
 }
+
+// A PCL-based filter following another uses the cloud the first one
+// stored rather than converting the view again.
+TEST(PCLBlockFilterTest, chained)
+{
+    StageFactory f;
+
+    Options options;
+    options.add("filename",
+        Support::datapath("autzen/autzen-point-format-3.las"));
+    Stage* reader(f.createStage("readers.las"));
+    reader->setOptions(options);
+
+    Options filterOptions;
+    filterOptions.add("filename",
+        Support::datapath("filters/pcl/example_PassThrough_1.json"));
+    Stage* first(f.createStage("filters.pclblock"));
+    first->setOptions(filterOptions);
+    first->setInput(*reader);
+    Stage* second(f.createStage("filters.pclblock"));
+    second->setOptions(filterOptions);
+    second->setInput(*first);
+
+    PointTable table;
+    second->prepare(table);
+    PointViewSet viewSet = second->execute(table);
+
+    EXPECT_EQ(1u, viewSet.size());
+    PointViewPtr view = *viewSet.begin();
+    EXPECT_EQ(81u, view->size());
+    EXPECT_TRUE(table.artifactManager().exists("pcl.cloud"));
+}
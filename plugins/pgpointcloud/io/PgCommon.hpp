@@ -106,6 +106,41 @@ inline void pg_commit(PGconn* session)
     pg_execute(session, sql);
 }
 
+inline void pg_copy_start(PGconn* session, std::string const& sql)
+{
+    PGresult *result = PQexec(session, sql.c_str());
+    if ( (!result) || (PQresultStatus(result) != PGRES_COPY_IN) )
+    {
+        std::string errmsg = std::string(PQerrorMessage(session));
+        PQclear(result);
+        throw pdal_error(errmsg);
+    }
+    PQclear(result);
+}
+
+inline void pg_copy_data(PGconn* session, std::string const& data)
+{
+    if (PQputCopyData(session, data.data(), (int)data.size()) != 1)
+        throw pdal_error(PQerrorMessage(session));
+}
+
+inline void pg_copy_end(PGconn* session)
+{
+    if (PQputCopyEnd(session, NULL) != 1)
+        throw pdal_error(PQerrorMessage(session));
+
+    std::string errmsg;
+    PGresult *result;
+    while ((result = PQgetResult(session)))
+    {
+        if (PQresultStatus(result) != PGRES_COMMAND_OK && errmsg.empty())
+            errmsg = PQresultErrorMessage(result);
+        PQclear(result);
+    }
+    if (errmsg.size())
+        throw pdal_error(errmsg);
+}
+
 inline std::string pg_query_once(PGconn* session, std::string const& sql)
 {
     PGresult *result = PQexec(session, sql.c_str());
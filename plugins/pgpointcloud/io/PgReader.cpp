@@ -37,8 +37,12 @@
 #include <pdal/PointView.hpp>
 #include <pdal/XMLSchema.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
+#include <pdal/util/portable_endian.hpp>
 
+#include <algorithm>
 #include <iostream>
+#include <thread>
 
 namespace pdal
 {
@@ -56,12 +60,28 @@ CREATE_SHARED_STAGE(PgReader, s_info)
 std::string PgReader::getName() const { return s_info.name; }
 
 PgReader::PgReader() : m_session(NULL), m_pcid(0), m_cached_point_count(0),
-    m_cached_max_points(0)
+    m_cached_max_points(0), m_cur_result(NULL), m_nextCursor(0)
 {}
 
 
 PgReader::~PgReader()
 {
+    // Background fetches use the sessions.
+    for (Cursor& c : m_cursors)
+    {
+        if (c.m_next.valid())
+        {
+            try
+            {
+                PQclear(c.m_next.get());
+            }
+            catch (...)
+            {}
+        }
+        if (c.m_session && c.m_session != m_session)
+            PQfinish(c.m_session);
+    }
+
     //ABELL - Do bad things happen if we don't do this?  Already in done().
     if (m_session)
         PQfinish(m_session);
@@ -75,6 +95,15 @@ void PgReader::addArgs(ProgramArgs& args)
     args.add("column", "Column name", m_column_name, "pa");
     args.add("schema", "Schema name", m_schema_name);
     args.add("where", "Where clause for selection", m_where);
+    args.add("fetch_size", "Number of patches fetched from the server at "
+        "once", m_fetchSize, 100U);
+    args.add("connections", "Number of connections used to read patches.  "
+        "The query is split by ranges of 'id_column'.", m_connections,
+        size_t(1));
+    args.add("id_column", "Integer column used to split the query across "
+        "connections", m_idColumn, "id");
+    args.add("threads", "Number of threads used to decode patches.  "
+        "The default is the number of cores.", m_threads);
 }
 
 
@@ -107,17 +136,30 @@ point_count_t PgReader::getNumPoints() const
 
 
 std::string PgReader::getDataQuery() const
+{
+    return getDataQuery("");
+}
+
+
+// Build the query for the patch data, limited by the 'range' condition
+// if it's not empty.  Patches are returned as uncompressed WKB in a bytea
+// so that a binary cursor can transfer them without hex encoding.
+std::string PgReader::getDataQuery(const std::string& range) const
 {
     std::ostringstream oss;
-    oss << "SELECT text(PC_Uncompress(" << pg_quote_identifier(m_column_name) <<
-        ")) AS pa, ";
+    oss << "SELECT decode(text(PC_Uncompress(" <<
+        pg_quote_identifier(m_column_name) << ")), 'hex') AS pa, ";
     oss << "PC_NumPoints(" << pg_quote_identifier(m_column_name) <<
         ") AS npoints FROM ";
     if (!m_schema_name.empty())
         oss << pg_quote_identifier(m_schema_name) << ".";
     oss << pg_quote_identifier(m_table_name);
-    if (!m_where.empty())
+    if (!m_where.empty() && !range.empty())
+        oss << " WHERE (" << m_where << ") AND " << range;
+    else if (!m_where.empty())
         oss << " WHERE " << m_where;
+    else if (!range.empty())
+        oss << " WHERE " << range;
 
     log()->get(LogLevel::Debug) << "Constructed data query " <<
         oss.str() << std::endl;
@@ -231,6 +273,14 @@ void PgReader::ready(PointTableRef /*table*/)
     m_cur_row = 0;
     m_cur_nrows = 0;
     m_cur_result = NULL;
+    m_patch = Patch();
+
+    if (m_fetchSize == 0)
+        throwError("Option 'fetch_size' must be greater than 0.");
+    size_t threads = m_threads ? m_threads :
+        (size_t)(std::max)(std::thread::hardware_concurrency(), 1U);
+    if (threads > 1)
+        m_pool.reset(new ThreadPool(threads, threads, false));
 
     CursorSetup();
 }
@@ -238,12 +288,14 @@ void PgReader::ready(PointTableRef /*table*/)
 
 void PgReader::done(PointTableRef /*table*/)
 {
+    if (m_cur_result)
+        PQclear(m_cur_result);
+    m_cur_result = NULL;
     CursorTeardown();
+    m_pool.reset();
     if (m_session)
         PQfinish(m_session);
     m_session = NULL;
-    if (m_cur_result)
-        PQclear(m_cur_result);
 }
 
 void PgReader::initialize()
@@ -259,24 +311,86 @@ void PgReader::initialize()
 
 void PgReader::CursorSetup()
 {
-    std::ostringstream oss;
-    oss << "DECLARE cur CURSOR FOR " << getDataQuery();
-    pg_begin(m_session);
-    pg_execute(m_session, oss.str());
+    // Split the query into ranges of the ID column, one per connection.
+    std::vector<std::string> ranges;
+    if (m_connections > 1)
+    {
+        std::string id = pg_quote_identifier(m_idColumn);
+        std::ostringstream oss;
+        oss << "SELECT Min(" << id << "), Max(" << id << ") FROM ";
+        if (!m_schema_name.empty())
+            oss << pg_quote_identifier(m_schema_name) << ".";
+        oss << pg_quote_identifier(m_table_name);
+        if (!m_where.empty())
+            oss << " WHERE " << m_where;
 
-    log()->get(LogLevel::Debug) << "SQL cursor prepared: " <<
-        oss.str() << std::endl;
+        PGresult *result = pg_query_result(m_session, oss.str());
+        if (PQntuples(result) && !PQgetisnull(result, 0, 0))
+        {
+            int64_t lo = std::stoll(PQgetvalue(result, 0, 0));
+            int64_t hi = std::stoll(PQgetvalue(result, 0, 1));
+            int64_t span = (hi - lo) / (int64_t)m_connections + 1;
+            for (int64_t start = lo; start <= hi; start += span)
+                ranges.push_back(id + " >= " + std::to_string(start) +
+                    " AND " + id + " < " + std::to_string(start + span));
+        }
+        PQclear(result);
+    }
+    if (ranges.empty())
+        ranges.push_back("");
+
+    m_cursors.resize(ranges.size());
+    m_nextCursor = 0;
+    for (size_t i = 0; i < ranges.size(); ++i)
+    {
+        Cursor& c = m_cursors[i];
+        c.m_session = i ? pg_connect(m_connection) : m_session;
+
+        std::string sql = "DECLARE cur BINARY CURSOR FOR " +
+            getDataQuery(ranges[i]);
+        pg_begin(c.m_session);
+        pg_execute(c.m_session, sql);
+        c.m_next = fetch(c.m_session);
+
+        log()->get(LogLevel::Debug) << "SQL cursor prepared: " <<
+            sql << std::endl;
+    }
 }
 
 
 void PgReader::CursorTeardown()
 {
-    pg_execute(m_session, "CLOSE cur");
-    pg_commit(m_session);
+    for (Cursor& c : m_cursors)
+    {
+        if (c.m_next.valid())
+        {
+            try
+            {
+                PQclear(c.m_next.get());
+            }
+            catch (const pdal_error&)
+            {}
+        }
+        pg_execute(c.m_session, "CLOSE cur");
+        pg_commit(c.m_session);
+        if (c.m_session != m_session)
+            PQfinish(c.m_session);
+    }
+    m_cursors.clear();
     log()->get(LogLevel::Debug) << "SQL cursor closed." << std::endl;
 }
 
 
+// Fetch the next batch of patches from a cursor in the background so
+// that it arrives while the current batch is decoded.
+std::future<PGresult *> PgReader::fetch(PGconn *session)
+{
+    std::string sql = "FETCH " + std::to_string(m_fetchSize) + " FROM cur";
+    return std::async(std::launch::async, [session, sql]()
+        { return pg_query_result(session, sql); });
+}
+
+
 point_count_t PgReader::readPgPatch(PointViewPtr view, point_count_t numPts)
 {
     point_count_t numRemaining = m_patch.remaining;
@@ -299,36 +413,126 @@ point_count_t PgReader::readPgPatch(PointViewPtr view, point_count_t numPts)
 }
 
 
+// Make the next batch of patches current.  Batches are taken from each
+// cursor in turn.
 bool PgReader::NextBuffer()
 {
-    if (m_cur_row >= m_cur_nrows || !m_cur_result)
+    if (m_cur_result)
+        PQclear(m_cur_result);
+    m_cur_result = NULL;
+
+    while (std::any_of(m_cursors.begin(), m_cursors.end(),
+        [](const Cursor& c){ return !c.m_done; }))
     {
-        static std::string fetch = "FETCH 2 FROM cur";
-        if (m_cur_result)
-            PQclear(m_cur_result);
-        m_cur_result = pg_query_result(m_session, fetch);
-        bool logOutput = (log()->getLevel() > LogLevel::Debug3);
-        if (logOutput)
-            log()->get(LogLevel::Debug3) << "SQL: " << fetch << std::endl;
-        if ((PQresultStatus(m_cur_result) != PGRES_TUPLES_OK) ||
-            (PQntuples(m_cur_result) == 0))
+        Cursor& c = m_cursors[m_nextCursor];
+        m_nextCursor = (m_nextCursor + 1) % m_cursors.size();
+        if (c.m_done)
+            continue;
+
+        PGresult *result;
+        try
+        {
+            result = c.m_next.get();
+        }
+        catch (const pdal_error& err)
         {
-            PQclear(m_cur_result);
-            m_cur_result = NULL;
-            m_atEnd = true;
-            return false;
+            throwError(err.what());
         }
+        if (PQntuples(result) == 0)
+        {
+            PQclear(result);
+            c.m_done = true;
+            continue;
+        }
+        c.m_next = fetch(c.m_session);
 
+        m_cur_result = result;
         m_cur_row = 0;
         m_cur_nrows = PQntuples(m_cur_result);
+        return true;
+    }
+    m_atEnd = true;
+    return false;
+}
+
+
+// Get the point data and number of points of a patch in the current batch.
+const char *PgReader::patchData(uint32_t row, point_count_t& numPoints) const
+{
+    uint32_t count;
+    memcpy(&count, PQgetvalue(m_cur_result, row, 1), sizeof(count));
+    numPoints = be32toh(count);
+
+    size_t size = PQgetlength(m_cur_result, row, 0);
+    if (size < Patch::trim + numPoints * packedPointSize())
+        throwError("Invalid patch data.");
+    return PQgetvalue(m_cur_result, row, 0) + Patch::trim;
+}
+
+
+// Decode the whole patches of the current batch that fit in 'count'
+// points.  The points are added to the view first so that the patches
+// can be decoded in parallel.
+point_count_t PgReader::readPatches(PointView& view, point_count_t count)
+{
+    struct Span
+    {
+        const char *m_data;
+        point_count_t m_count;
+        PointId m_start;
+    };
+
+    std::vector<Span> spans;
+    const PointId start = view.size();
+    point_count_t total = 0;
+    while (m_cur_row < m_cur_nrows)
+    {
+        point_count_t numPoints;
+        const char *data = patchData(m_cur_row, numPoints);
+        if (total + numPoints > count)
+            break;
+        spans.push_back({ data, numPoints, start + total });
+        total += numPoints;
+        m_cur_row++;
+    }
+
+    // The next patch doesn't fit, so set it aside to be read in pieces.
+    if (spans.empty())
+    {
+        point_count_t numPoints;
+        const char *data = patchData(m_cur_row, numPoints);
+        m_patch.count = numPoints;
+        m_patch.remaining = numPoints;
+        m_patch.binary.assign(data, data + numPoints * packedPointSize());
+        m_cur_row++;
+        return 0;
     }
-    m_patch.hex = PQgetvalue(m_cur_result, m_cur_row, 0);
-    m_patch.count = atoi(PQgetvalue(m_cur_result, m_cur_row, 1));
-    m_patch.remaining = m_patch.count;
-    m_patch.update_binary();
 
-    m_cur_row++;
-    return true;
+    for (PointId idx = start; idx < start + total; ++idx)
+        view.getOrAddPoint(idx);
+
+    auto decode = [this, &view](const Span& s)
+    {
+        const char *pos = s.m_data;
+        for (PointId i = 0; i < s.m_count; ++i)
+        {
+            writePoint(view, s.m_start + i, pos);
+            pos += packedPointSize();
+        }
+    };
+
+    if (m_pool && spans.size() > 1)
+    {
+        for (const Span& s : spans)
+            m_pool->add([&decode, &s](){ decode(s); });
+        m_pool->await();
+        if (m_pool->errors().size())
+            throwError(m_pool->errors().front());
+    }
+    else
+        for (const Span& s : spans)
+            decode(s);
+    return total;
 }
 
 
@@ -344,13 +548,12 @@ point_count_t PgReader::read(PointViewPtr view, point_count_t count)
     point_count_t totalNumRead = 0;
     while (totalNumRead < count)
     {
-        if (m_patch.remaining == 0)
-            if (!NextBuffer())
-                return totalNumRead;
-        PointId bufBegin = view->size();
-        point_count_t numRead = readPgPatch(view, count - totalNumRead);
-        PointId bufEnd = bufBegin + numRead;
-        totalNumRead += numRead;
+        if (m_patch.remaining)
+            totalNumRead += readPgPatch(view, count - totalNumRead);
+        else if (m_cur_row < m_cur_nrows)
+            totalNumRead += readPatches(*view, count - totalNumRead);
+        else if (!NextBuffer())
+            break;
     }
     return totalNumRead;
 }
@@ -41,11 +41,15 @@
 
 #include "PgCommon.hpp"
 
+#include <future>
+#include <memory>
 #include <vector>
 
 namespace pdal
 {
 
+class ThreadPool;
+
 class PDAL_DLL PgReader : public DbReader
 {
     class Patch
@@ -56,29 +60,22 @@ class PDAL_DLL PgReader : public DbReader
 
         point_count_t count;
         point_count_t remaining;
-        std::string hex;
-
         std::vector<uint8_t> binary;
-        static const uint32_t trim = 26;
-
-#define _base(x) ((x >= '0' && x <= '9') ? '0' : \
-             (x >= 'a' && x <= 'f') ? 'a' - 10 : \
-             (x >= 'A' && x <= 'F') ? 'A' - 10 : \
-                '\255')
-#define HEXOF(x) (x - _base(x))
-
-        inline void update_binary()
-        {
-            // http://stackoverflow.com/questions/8197838/convert-a-long-hex-string-in-to-int-array-with-sscanf
-            binary.resize((hex.size() - trim)/2);
-
-            char const* source = hex.c_str() + trim;
-            char const* p = 0;
-
-            for (p = source; p && *p; p += 2)
-                binary[(p - source) >> 1] =
-                    ((HEXOF(*p)) << 4) + HEXOF(*(p + 1));
-        }
+
+        // Size of the WKB header (endian, pcid, compression, npoints).
+        static const uint32_t trim = 13;
+    };
+
+    // A cursor over all or part of the query, along with the next batch
+    // of results being fetched in the background.
+    struct Cursor
+    {
+        Cursor() : m_session(NULL), m_done(false)
+        {}
+
+        PGconn *m_session;
+        std::future<PGresult *> m_next;
+        bool m_done;
     };
 
 public:
@@ -90,6 +87,7 @@ public:
     virtual point_count_t getNumPoints() const;
     point_count_t getMaxPoints() const;
     std::string getDataQuery() const;
+    std::string getDataQuery(const std::string& range) const;
     std::string connString() const
         { return m_connection; }
     void getSession() const;
@@ -107,6 +105,9 @@ private:
     SpatialReference fetchSpatialReference() const;
     uint32_t fetchPcid() const;
     point_count_t readPgPatch(PointViewPtr view, point_count_t numPts);
+    point_count_t readPatches(PointView& view, point_count_t count);
+    const char *patchData(uint32_t row, point_count_t& numPoints) const;
+    std::future<PGresult *> fetch(PGconn *session);
 
     // Internal functions for managing scroll cursor
     void CursorSetup();
@@ -119,6 +120,10 @@ private:
     std::string m_schema_name;
     std::string m_column_name;
     std::string m_where;
+    std::string m_idColumn;
+    uint32_t m_fetchSize;
+    size_t m_connections;
+    size_t m_threads;
     mutable uint32_t m_pcid;
     mutable point_count_t m_cached_point_count;
     mutable point_count_t m_cached_max_points;
@@ -128,6 +133,9 @@ private:
     uint32_t m_cur_nrows;
     PGresult* m_cur_result;
     Patch m_patch;
+    std::vector<Cursor> m_cursors;
+    size_t m_nextCursor;
+    std::unique_ptr<ThreadPool> m_pool;
 
     PgReader& operator=(const PgReader&); // not implemented
     PgReader(const PgReader&); // not implemented
@@ -35,9 +35,13 @@
 
 #include "PgWriter.hpp"
 
+#include <chrono>
+#include <thread>
+
 #include <pdal/PointView.hpp>
 #include <pdal/XMLSchema.hpp>
 #include <pdal/util/FileUtils.hpp>
+#include <pdal/util/ThreadPool.hpp>
 #include <pdal/util/portable_endian.hpp>
 #include <pdal/util/ProgramArgs.hpp>
 
@@ -56,8 +60,6 @@ CREATE_SHARED_STAGE(PgWriter, s_info)
 std::string PgWriter::getName() const { return s_info.name; }
 
 // TO DO:
-// - change INSERT into COPY
-//
 // - PCID / Schema consistency. If a PCID is specified,
 // must it be consistent with the buffer schema? Or should
 // the writer shove the data into the database schema as best
@@ -73,12 +75,15 @@ PgWriter::PgWriter()
     , m_srid(0)
     , m_pcid(0)
     , m_overwrite(true)
+    , m_copying(false)
     , m_schema_is_initialized(false)
 {}
 
 
 PgWriter::~PgWriter()
 {
+    // Outstanding encoding tasks reference this writer.
+    m_pool.reset();
     if (m_session)
         PQfinish(m_session);
 }
@@ -98,6 +103,8 @@ void PgWriter::addArgs(ProgramArgs& args)
     args.add("pcid", "PCID", m_pcid);
     args.add("pre_sql", "SQL to execute before query", m_pre_sql);
     args.add("post_sql", "SQL to execute after query", m_post_sql);
+    args.add("threads", "Number of threads used to encode patches.  "
+        "The default is the number of cores.", m_threads);
 }
 
 
@@ -105,6 +112,10 @@ void PgWriter::initialize()
 {
     m_patch_compression_type = getCompressionType(m_compressionSpec);
     m_session = pg_connect(m_connection);
+
+    size_t threads = m_threads ? m_threads :
+        (size_t)(std::max)(std::thread::hardware_concurrency(), 1U);
+    m_pool.reset(new ThreadPool(threads, threads, false));
 }
 
 
@@ -149,6 +160,16 @@ void PgWriter::writeInit()
         CreateTable(m_schema_name, m_table_name, m_column_name, m_pcid);
     }
 
+    // Patches are streamed to the server in a single COPY rather than
+    // sending an INSERT per patch.
+    std::string copy("COPY ");
+    if (m_schema_name.size())
+        copy += pg_quote_identifier(m_schema_name) + ".";
+    copy += pg_quote_identifier(m_table_name) + " (" +
+        pg_quote_identifier(m_column_name) + ") FROM STDIN";
+    pg_copy_start(m_session, copy);
+    m_copying = true;
+
     m_schema_is_initialized = true;
 }
 
@@ -161,6 +182,13 @@ void PgWriter::write(const PointViewPtr view)
 
 void PgWriter::done(PointTableRef /*table*/)
 {
+    if (m_copying)
+    {
+        sendPatches(0);
+        m_copying = false;
+        pg_copy_end(m_session);
+    }
+
     //CreateIndex(m_schema_name, m_table_name, m_column_name);
 
     if (m_post_sql.size())
@@ -410,49 +438,56 @@ void PgWriter::CreateIndex(std::string const& schema_name,
 
 void PgWriter::writeTile(const PointViewPtr view)
 {
-    std::vector<char> storage(packedPointSize());
-    std::string hexrep;
-    size_t maxHexrepSize = packedPointSize() * view->size() * 2;
-    hexrep.reserve(maxHexrepSize);
+    if (view->size() > (std::numeric_limits<uint32_t>::max)())
+        throwError("Too many points for tile.");
 
-    m_insert.clear();
-    m_insert.reserve(maxHexrepSize + 3000);
+    // Encode the patch in the pool.  The view is held by the task until
+    // it's done.
+    using Task = std::packaged_task<std::string()>;
+    std::shared_ptr<Task> task(new Task([this, view]()
+        { return encodePatch(*view); }));
+    m_patches.push_back(task->get_future());
+    m_pool->add([task](){ (*task)(); });
 
-    for (PointId idx = 0; idx < view->size(); ++idx)
+    sendPatches(2 * m_pool->numThreads());
+}
+
+
+// Send encoded patches to the server in order until no more than
+// 'maxPending' remain, sending any that are already finished as well.
+void PgWriter::sendPatches(size_t maxPending)
+{
+    while (m_patches.size())
     {
-        size_t size = readPoint(*view.get(), idx, storage.data());
+        std::future<std::string>& f = m_patches.front();
+        if (m_patches.size() <= maxPending &&
+            f.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            break;
 
-        /* We are always getting uncompressed bytes off the block_data */
-        /* so we always used compression type 0 (uncompressed) in writing */
-        /* our WKB */
-        static char syms[] = "0123456789ABCDEF";
-        for (size_t i = 0; i != size; i++)
+        std::string row;
+        try
+        {
+            row = f.get();
+        }
+        catch (const pdal_error& err)
         {
-            hexrep.push_back(syms[((storage[i] >> 4) & 0xf)]);
-            hexrep.push_back(syms[storage[i] & 0xf]);
+            throwError(err.what());
         }
+        m_patches.pop_front();
+        pg_copy_data(m_session, row);
     }
+}
 
-    std::string insert_into("INSERT INTO ");
-    std::string values(" (" + pg_quote_identifier(m_column_name) +
-                       ") VALUES ('");
-
-    m_insert.append(insert_into);
 
-    if (m_schema_name.size())
-    {
-        m_insert.append(pg_quote_identifier(m_schema_name));
-        m_insert.append(".");
-    }
-
-    m_insert.append(pg_quote_identifier(m_table_name));
-    m_insert.append(values);
+// Build a row of COPY text input containing the hex-encoded patch.
+std::string PgWriter::encodePatch(const PointView& view)
+{
+    std::vector<char> storage(packedPointSize());
+    std::string row;
 
     std::ostringstream options;
 
-    if (view->size() > (std::numeric_limits<uint32_t>::max)())
-        throwError("Too many points for tile.");
-    uint32_t num_points = htobe32(static_cast<uint32_t>(view->size()));
+    uint32_t num_points = htobe32(static_cast<uint32_t>(view.size()));
     int32_t pcid = htobe32(m_pcid);
     CompressionType compression_v = CompressionType::None;
     uint32_t compression = htobe32(static_cast<uint32_t>(compression_v));
@@ -470,11 +505,25 @@ void PgWriter::writeTile(const PointViewPtr view)
     // needs to be 4 bytes
     options << std::hex << std::setfill('0') << std::setw(8) << num_points;
 
-    m_insert.append(options.str());
-    m_insert.append(hexrep);
-    m_insert.append("')");
+    row.reserve(packedPointSize() * view.size() * 2 + 32);
+    row.append(options.str());
 
-    pg_execute(m_session, m_insert);
+    for (PointId idx = 0; idx < view.size(); ++idx)
+    {
+        size_t size = readPoint(view, idx, storage.data());
+
+        /* We are always getting uncompressed bytes off the block_data */
+        /* so we always used compression type 0 (uncompressed) in writing */
+        /* our WKB */
+        static char syms[] = "0123456789ABCDEF";
+        for (size_t i = 0; i != size; i++)
+        {
+            row.push_back(syms[((storage[i] >> 4) & 0xf)]);
+            row.push_back(syms[storage[i] & 0xf]);
+        }
+    }
+    row.push_back('\n');
+    return row;
 }
 
 } // namespace pdal
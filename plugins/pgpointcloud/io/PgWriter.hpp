@@ -35,6 +35,9 @@
 
 #pragma once
 
+#include <deque>
+#include <future>
+
 #include <pdal/DbWriter.hpp>
 #include <pdal/StageFactory.hpp>
 #include "PgCommon.hpp"
@@ -42,6 +45,8 @@
 namespace pdal
 {
 
+class ThreadPool;
+
 class PDAL_DLL PgWriter : public DbWriter
 {
 public:
@@ -60,6 +65,8 @@ private:
 
     void writeInit();
     void writeTile(const PointViewPtr view);
+    std::string encodePatch(const PointView& view);
+    void sendPatches(size_t maxPending);
 
     bool CheckTableExists(std::string const& name);
     bool CheckPointCloudExists();
@@ -92,7 +99,10 @@ private:
     uint32_t m_srid;
     uint32_t m_pcid;
     bool m_overwrite;
-    std::string m_insert;
+    size_t m_threads;
+    std::unique_ptr<ThreadPool> m_pool;
+    std::deque<std::future<std::string>> m_patches;
+    bool m_copying;
     Orientation m_orientation;
     std::string m_pre_sql;
     std::string m_post_sql;
@@ -257,6 +257,49 @@ TEST_F(PgpointcloudWriterTest, writeXYZ)
     EXPECT_TRUE(Utils::contains(dims, Dimension::Id::Z));
 }
 
+TEST_F(PgpointcloudWriterTest, readConnections)
+{
+    if (shouldSkipTests())
+    {
+        return;
+    }
+
+    StageFactory f;
+    Stage* reader(f.createStage("readers.las"));
+    Options options;
+    options.add("filename", Support::datapath("las/1.2-with-color.las"));
+    reader->setOptions(options);
+
+    Stage* chipper(f.createStage("filters.chipper"));
+    Options chipperOps;
+    chipperOps.add("capacity", 50);
+    chipper->setOptions(chipperOps);
+    chipper->setInput(*reader);
+
+    Stage* writer(f.createStage("writers.pgpointcloud"));
+    writer->setOptions(getDbOptions());
+    writer->setInput(*chipper);
+
+    PointTable table;
+    writer->prepare(table);
+    writer->execute(table);
+
+    // Read with small batches split across several connections.
+    Options readOps = getDbOptions();
+    readOps.add("fetch_size", 3);
+    readOps.add("connections", 4);
+    readOps.add("threads", 2);
+
+    Stage* pgReader(f.createStage("readers.pgpointcloud"));
+    pgReader->setOptions(readOps);
+
+    PointTable readTable;
+    pgReader->prepare(readTable);
+    PointViewSet viewSet = pgReader->execute(readTable);
+    EXPECT_EQ(viewSet.size(), 1U);
+    EXPECT_EQ((*viewSet.begin())->size(), 1065U);
+}
+
 TEST_F(PgpointcloudWriterTest, writetNoPointcloudExtension)
 {
     if (shouldSkipTests())
@@ -63,6 +63,12 @@ void PythonFilter::addArgs(ProgramArgs& args)
     args.add("add_dimension", "Dimensions to add", m_addDimensions);
     args.add("pdalargs", "Dictionary to add to module globals when "
         "calling function", m_pdalargs);
+    args.add("batch_size", "Maximum number of points passed to the "
+        "function at once in stream mode.  If 0, all the points of each "
+        "batch of the stream are passed", m_batchSize, (point_count_t)0);
+    args.add("threads", "Number of views the function may be run on at "
+        "once when the pipeline runs with several threads.  Each thread has "
+        "its own copy of the module", m_threads, 1);
 }
 
 
@@ -77,40 +83,86 @@ void PythonFilter::ready(PointTableRef table)
 {
     if (m_source.empty())
         m_source = FileUtils::readFileIntoString(m_scriptFile);
+    if (m_threads < 1)
+        throwError("Option 'threads' must be at least 1.");
     plang::Environment::get()->set_stdout(log()->getLogStream());
-    m_script = new plang::Script(m_source, m_module, m_function);
-
-	m_pythonMethod = new plang::Invocation(*m_script);
-    m_pythonMethod->compile();
+    {
+        plang::GilLock lock;
+        m_script = new plang::Script(m_source, m_module, m_function);
+        for (int i = 0; i < m_threads; ++i)
+        {
+            plang::Invocation *method = new plang::Invocation(*m_script);
+            m_invocations.push_back(method);
+            method->compile();
+            if (!m_pdalargs.empty())
+            {
+                std::ostringstream args;
+                args << m_pdalargs;
+                method->setKWargs(args.str());
+            }
+        }
+        m_idle = m_invocations;
+    }
     m_totalMetadata = table.metadata();
+    m_layout = table.layout();
+    m_streamed = false;
+
+    // The thread that started Python holds the interpreter lock unless
+    // it's released.  Release it until the stage is done so that the
+    // threads running views can take it.
+    m_gilRelease.reset(new plang::GilRelease);
 }
 
 
 PointViewSet PythonFilter::run(PointViewPtr view)
 {
-    log()->get(LogLevel::Debug5) << "filters.python " << *m_script <<
-        " processing " << view->size() << " points." << std::endl;
-    m_pythonMethod->resetArguments();
-    m_pythonMethod->begin(*view, m_totalMetadata);
+    plang::Invocation *method;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idleCond.wait(lock, [this](){ return m_idle.size(); });
+        method = m_idle.back();
+        m_idle.pop_back();
+    }
 
-    if (!m_pdalargs.empty())
+    PointViewSet viewSet;
+    try
     {
-        std::ostringstream args;
-        args << m_pdalargs;
-        m_pythonMethod->setKWargs(args.str());
+        viewSet = run(*method, view);
     }
-    m_pythonMethod->execute();
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_idle.push_back(method);
+        m_idleCond.notify_one();
+        throw;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_idle.push_back(method);
+    m_idleCond.notify_one();
+    return viewSet;
+}
+
+
+PointViewSet PythonFilter::run(plang::Invocation& method, PointViewPtr view)
+{
+    log()->get(LogLevel::Debug5) << "filters.python " << *m_script <<
+        " processing " << view->size() << " points." << std::endl;
+    plang::GilLock lock;
+    method.resetArguments();
+    method.begin(*view, m_totalMetadata);
+    method.execute();
 
     PointViewSet viewSet;
 
-    if (m_pythonMethod->hasOutputVariable("Mask"))
+    if (method.hasOutputVariable("Mask"))
     {
         PointViewPtr outview = view->makeNew();
 
         size_t arrSize(0);
         void *pydata =
-            m_pythonMethod->extractResult("Mask", Dimension::Type::Unsigned8, arrSize);
+            method.extractResult("Mask", Dimension::Type::Unsigned8, arrSize);
         char *ok = (char *)pydata;
+        plang::GilRelease release;
         for (PointId idx = 0; idx < arrSize; ++idx)
             if (*ok++)
                 outview->appendPoint(*view, idx);
@@ -119,17 +171,103 @@ PointViewSet PythonFilter::run(PointViewPtr view)
     }
     else
     {
-        m_pythonMethod->end(*view, getMetadata());
+        method.end(*view);
+        // Other views may be adding metadata at the same time.
+        std::lock_guard<std::mutex> metadataLock(m_mutex);
+        method.addMetadata(getMetadata());
         viewSet.insert(view);
     }
     return viewSet;
 }
 
 
+bool PythonFilter::processOne(PointRef& point)
+{
+    std::vector<PointRef> points { point };
+    std::vector<bool> keep(1, true);
+    processPoints(points, keep);
+    return keep[0];
+}
+
+
+void PythonFilter::processBatch(StreamPointTable& table, PointId begin,
+    PointId end, std::vector<bool>& keep)
+{
+    std::vector<PointId> ids;
+    for (PointId idx = begin; idx < end; ++idx)
+        if (keep[idx - begin])
+            ids.push_back(idx);
+
+    const point_count_t batchSize = m_batchSize ? m_batchSize : ids.size();
+    std::vector<PointRef> points;
+    std::vector<bool> batchKeep;
+    for (size_t start = 0; start < ids.size(); start += batchSize)
+    {
+        const size_t count = (std::min)(batchSize, ids.size() - start);
+        points.clear();
+        for (size_t i = 0; i < count; ++i)
+            points.emplace_back(table, ids[start + i]);
+        batchKeep.assign(count, true);
+
+        processPoints(points, batchKeep);
+        for (size_t i = 0; i < count; ++i)
+            if (!batchKeep[i])
+                keep[ids[start + i] - begin] = false;
+    }
+}
+
+
+void PythonFilter::processPoints(std::vector<PointRef>& points,
+    std::vector<bool>& keep)
+{
+    log()->get(LogLevel::Debug5) << "filters.python " << *m_script <<
+        " processing " << points.size() << " points." << std::endl;
+
+    // The lock is only held while the function runs on this batch.
+    plang::GilLock lock;
+    plang::Invocation *method = m_invocations.front();
+    method->resetArguments();
+    method->begin(points, *m_layout, m_srs, m_totalMetadata);
+    method->execute();
+    m_streamed = true;
+
+    if (method->hasOutputVariable("Mask"))
+    {
+        size_t arrSize(0);
+        const char *ok = (const char *)method->extractResult("Mask",
+            Dimension::Type::Unsigned8, arrSize);
+        if (arrSize != points.size())
+            throwError("Mask must have a value for each point.");
+        for (size_t i = 0; i < arrSize; ++i)
+            if (!ok[i])
+                keep[i] = false;
+    }
+    else
+        method->end(points, *m_layout);
+}
+
+
+void PythonFilter::spatialReferenceChanged(const SpatialReference& srs)
+{
+    m_srs = srs;
+}
+
+
 void PythonFilter::done(PointTableRef table)
 {
+    m_gilRelease.reset();
+    {
+        plang::GilLock lock;
+        // Metadata set by the script in stream mode is added once rather
+        // than for each batch.
+        if (m_streamed)
+            m_invocations.front()->addMetadata(getMetadata());
+        for (plang::Invocation *method : m_invocations)
+            delete method;
+        m_invocations.clear();
+        m_idle.clear();
+    }
     static_cast<plang::Environment*>(plang::Environment::get())->reset_stdout();
-    delete m_pythonMethod;
     delete m_script;
 }
 
@@ -36,37 +36,64 @@
 
 #include <pdal/pdal_internal.hpp>
 #include <pdal/Filter.hpp>
+#include <pdal/Streamable.hpp>
 
 #include "../plang/Invocation.hpp"
 
 #include <json/json.h>
 
+#include <condition_variable>
+#include <mutex>
+
 namespace pdal
 {
 
-class PDAL_DLL PythonFilter : public Filter
+class PDAL_DLL PythonFilter : public Filter, public Streamable
 {
 public:
-    PythonFilter() : Filter(), m_script(NULL)
+    PythonFilter() : Filter(), m_script(NULL), m_streamed(false)
         {}
 
     std::string getName() const;
 
 private:
     plang::Script* m_script;
-    plang::Invocation *m_pythonMethod;
+    // One invocation for each view run at once.  Each has its own copy
+    // of the module.
+    std::vector<plang::Invocation *> m_invocations;
+    std::vector<plang::Invocation *> m_idle;
+    std::mutex m_mutex;
+    std::condition_variable m_idleCond;
+    std::unique_ptr<plang::GilRelease> m_gilRelease;
+    int m_threads;
     std::string m_source;
     std::string m_scriptFile;
     std::string m_module;
     std::string m_function;
     StringList m_addDimensions;
+    point_count_t m_batchSize;
+    PointLayoutPtr m_layout;
+    SpatialReference m_srs;
+    bool m_streamed;
 
     virtual void addArgs(ProgramArgs& args);
     virtual void addDimensions(PointLayoutPtr layout);
+    virtual bool viewsRunConcurrently() const
+        { return m_threads > 1; }
     virtual void ready(PointTableRef table);
     virtual PointViewSet run(PointViewPtr view);
+    virtual bool processOne(PointRef& point);
+    virtual void processBatch(StreamPointTable& table, PointId begin,
+        PointId end, std::vector<bool>& keep);
+    virtual void spatialReferenceChanged(const SpatialReference& srs);
     virtual void done(PointTableRef table);
 
+    // Call the function on a batch of points in stream mode.
+    void processPoints(std::vector<PointRef>& points,
+        std::vector<bool>& keep);
+    // Run the function on a view in standard mode.
+    PointViewSet run(plang::Invocation& method, PointViewPtr view);
+
     PythonFilter& operator=(const PythonFilter&); // not implemented
     PythonFilter(const PythonFilter&); // not implemented
 
@@ -40,6 +40,10 @@
 #include <pdal/pdal_types.hpp>
 #include <pdal/util/ProgramArgs.hpp>
 #include <pdal/util/Algorithm.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+#include <cstring>
+#include <thread>
 
 #include "../plang/Environment.hpp"
 
@@ -239,6 +243,8 @@ void NumpyReader::addArgs(ProgramArgs& args)
     m_orderArg = &args.add("order", "Order of dimension interpretation "
         "of the array.  Either 'row'-major (C) or 'column'-major (Fortran)",
         m_order);
+    args.add("threads", "Number of threads used to copy the fields of "
+        "contiguous arrays.  The default is the number of cores.", m_threads);
 }
 
 
@@ -292,6 +298,78 @@ Dimension::Type getType(PyArray_Descr *dtype, const std::string& name)
     return pdalType;
 }
 
+
+// Copy 'count' values of a field, 'stride' bytes apart, to a dimension of
+// the view.  Values that are packed and aligned are handed to the view
+// directly.  Others are gathered into a buffer a chunk at a time.
+template<typename T>
+void copyField(PointView& view, Dimension::Id id, const char *data,
+    npy_intp stride, PointId start, point_count_t count)
+{
+    if (stride == sizeof(T) &&
+        reinterpret_cast<uintptr_t>(data) % alignof(T) == 0)
+    {
+        view.setFieldArray(id, start, count,
+            reinterpret_cast<const T *>(data));
+        return;
+    }
+
+    const point_count_t ChunkSize = 4096;
+    std::vector<T> buf((std::min)(count, ChunkSize));
+    while (count)
+    {
+        point_count_t n = (std::min)(count, ChunkSize);
+        for (point_count_t i = 0; i < n; ++i, data += stride)
+            std::memcpy(&buf[i], data, sizeof(T));
+        view.setFieldArray(id, start, n, buf.data());
+        start += n;
+        count -= n;
+    }
+}
+
+
+void copyField(PointView& view, Dimension::Id id, Dimension::Type type,
+    const char *data, npy_intp stride, PointId start, point_count_t count)
+{
+    using namespace Dimension;
+
+    switch (type)
+    {
+    case Type::Float:
+        copyField<float>(view, id, data, stride, start, count);
+        break;
+    case Type::Double:
+        copyField<double>(view, id, data, stride, start, count);
+        break;
+    case Type::Signed8:
+        copyField<int8_t>(view, id, data, stride, start, count);
+        break;
+    case Type::Signed16:
+        copyField<int16_t>(view, id, data, stride, start, count);
+        break;
+    case Type::Signed32:
+        copyField<int32_t>(view, id, data, stride, start, count);
+        break;
+    case Type::Signed64:
+        copyField<int64_t>(view, id, data, stride, start, count);
+        break;
+    case Type::Unsigned8:
+        copyField<uint8_t>(view, id, data, stride, start, count);
+        break;
+    case Type::Unsigned16:
+        copyField<uint16_t>(view, id, data, stride, start, count);
+        break;
+    case Type::Unsigned32:
+        copyField<uint32_t>(view, id, data, stride, start, count);
+        break;
+    case Type::Unsigned64:
+        copyField<uint64_t>(view, id, data, stride, start, count);
+        break;
+    case Type::None:
+        break;
+    }
+}
+
 } // unnamed namespace
 
 
@@ -489,6 +567,9 @@ bool NumpyReader::processOne(PointRef& point)
 
 point_count_t NumpyReader::read(PointViewPtr view, point_count_t numToRead)
 {
+    if (PyArray_IS_C_CONTIGUOUS(m_array) || PyArray_IS_F_CONTIGUOUS(m_array))
+        return readBulk(*view, numToRead);
+
     PointId idx = view->size();
     point_count_t numRead(0);
 
@@ -504,6 +585,118 @@ point_count_t NumpyReader::read(PointViewPtr view, point_count_t numToRead)
 }
 
 
+// Check if the records of the array are laid out exactly like the points
+// of the view's table, so that they can be copied whole.
+bool NumpyReader::recordsMatch(const PointView& view) const
+{
+    if (m_storeXYZ || dynamic_cast<ColumnPointTable *>(&view.table()))
+        return false;
+
+    PointLayoutPtr layout = view.layout();
+    if (layout->pointSize() != (size_t)PyArray_ITEMSIZE(m_array) ||
+        layout->dims().size() != m_fields.size())
+        return false;
+    for (const Field& f : m_fields)
+    {
+        const Dimension::Detail *d = layout->dimDetail(f.m_id);
+        if (d->type() != f.m_type || d->offset() != f.m_offset)
+            return false;
+    }
+    return true;
+}
+
+
+// Read the points of a contiguous array.  The points are stored in
+// iteration order, so the array can be copied a field at a time rather
+// than a point at a time, with the fields copied in parallel.
+point_count_t NumpyReader::readBulk(PointView& view, point_count_t numToRead)
+{
+    const point_count_t count = (std::min)(numToRead, m_numPoints - m_index);
+    if (count == 0)
+        return 0;
+
+    const npy_intp itemsize = PyArray_ITEMSIZE(m_array);
+    const char *data = PyArray_BYTES(m_array) + m_index * itemsize;
+    const PointId start = view.size();
+    const point_count_t position = m_index;
+    m_index += count;
+
+    if (recordsMatch(view))
+    {
+        for (PointId idx = 0; idx < count; ++idx)
+            std::memcpy(view.getOrAddPoint(start + idx),
+                data + idx * itemsize, itemsize);
+        return count;
+    }
+
+    // Add the points to the view before they're filled in parallel.
+    for (PointId idx = start; idx < start + count; ++idx)
+        view.setField(m_fields.front().m_id, idx, 0);
+
+    // X, Y and Z are copied by the same task because setting any of them
+    // updates the view's modification count.
+    std::vector<const Field *> xyzFields;
+    std::vector<std::function<void()>> tasks;
+    for (const Field& f : m_fields)
+    {
+        if (f.m_id == Dimension::Id::X || f.m_id == Dimension::Id::Y ||
+            f.m_id == Dimension::Id::Z)
+            xyzFields.push_back(&f);
+        else
+            tasks.push_back([&view, &f, data, itemsize, start, count]()
+            {
+                copyField(view, f.m_id, f.m_type, data + f.m_offset,
+                    itemsize, start, count);
+            });
+    }
+    tasks.push_back([this, &view, &xyzFields, data, itemsize, start, count,
+        position]()
+    {
+        for (const Field *f : xyzFields)
+            copyField(view, f->m_id, f->m_type, data + f->m_offset,
+                itemsize, start, count);
+        if (!m_storeXYZ)
+            return;
+
+        std::vector<uint64_t> x(count), y, z;
+        for (point_count_t i = 0; i < count; ++i)
+            x[i] = ((position + i) % m_xIter) / m_xDiv;
+        view.setFieldArray(Dimension::Id::X, start, count, x.data());
+        if (m_ndims > 1)
+        {
+            y.resize(count);
+            for (point_count_t i = 0; i < count; ++i)
+                y[i] = ((position + i) % m_yIter) / m_yDiv;
+            view.setFieldArray(Dimension::Id::Y, start, count, y.data());
+        }
+        if (m_ndims > 2)
+        {
+            z.resize(count);
+            for (point_count_t i = 0; i < count; ++i)
+                z[i] = ((position + i) % m_zIter) / m_zDiv;
+            view.setFieldArray(Dimension::Id::Z, start, count, z.data());
+        }
+    });
+
+    size_t threads = m_threads ? m_threads :
+        (size_t)(std::max)(std::thread::hardware_concurrency(), 1U);
+    threads = (std::min)(threads, tasks.size());
+    if (threads > 1)
+    {
+        ThreadPool pool(threads, tasks.size(), false);
+        for (auto& t : tasks)
+            pool.add(t);
+        pool.await();
+        if (pool.errors().size())
+            throwError(pool.errors().front());
+    }
+    else
+        for (auto& t : tasks)
+            t();
+    return count;
+}
+
+
 void NumpyReader::done(PointTableRef)
 {
     // Dereference everything we're using
@@ -78,6 +78,8 @@ private:
     void createFields(PointLayoutPtr layout);
     bool nextPoint();
     bool loadPoint(PointRef& point, point_count_t position);
+    point_count_t readBulk(PointView& view, point_count_t count);
+    bool recordsMatch(const PointView& view) const;
     void wakeUpNumpyArray();
     Dimension::Id registerDim(PointLayoutPtr layout, const std::string& name,
         Dimension::Type pdalType);
@@ -119,6 +121,7 @@ private:
     };
     std::vector<Field> m_fields;
     point_count_t m_index;
+    size_t m_threads;
 };
 
 } // namespace pdal
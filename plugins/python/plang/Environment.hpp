@@ -80,6 +80,42 @@ private:
     Redirector m_redirector;
 };
 
+// Holds the global interpreter lock while in scope, acquiring it if the
+// calling thread doesn't already hold it.  The environment must have been
+// created.
+class PDAL_DLL GilLock
+{
+public:
+    GilLock() : m_state(PyGILState_Ensure())
+        {}
+    ~GilLock()
+        { PyGILState_Release(m_state); }
+
+private:
+    GilLock(const GilLock&) = delete;
+    GilLock& operator=(const GilLock&) = delete;
+
+    PyGILState_STATE m_state;
+};
+
+// Releases the global interpreter lock while in scope if the calling
+// thread holds it, so that other threads can run Python while this one
+// works on points.  No Python objects may be touched while released.
+class PDAL_DLL GilRelease
+{
+public:
+    GilRelease() : m_state(PyGILState_Check() ? PyEval_SaveThread() : nullptr)
+        {}
+    ~GilRelease()
+        { if (m_state) PyEval_RestoreThread(m_state); }
+
+private:
+    GilRelease(const GilRelease&) = delete;
+    GilRelease& operator=(const GilRelease&) = delete;
+
+    PyThreadState *m_state;
+};
+
 } // namespace plang
 } // namespace pdal
 
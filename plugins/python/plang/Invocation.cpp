@@ -34,6 +34,8 @@
 
 #include "Invocation.hpp"
 
+#include <cstring>
+
 #define NPY_NO_DEPRECATED_API NPY_1_7_API_VERSION
 #define NO_IMPORT_ARRAY
 #define PY_ARRAY_UNIQUE_SYMBOL PDAL_ARRAY_API
@@ -107,6 +109,13 @@ void Invocation::compile()
 
     Py_INCREF(m_bytecode);
 
+    // Code executed with the name of a module that's already been imported
+    // runs in that module, so remove it to give each invocation a module
+    // of its own.
+    PyObject *modules = PyImport_GetModuleDict();
+    if (PyDict_GetItemString(modules, m_script.module()))
+        PyDict_DelItemString(modules, m_script.module());
+
     Py_XDECREF(m_module);
     m_module = PyImport_ExecCodeModule(const_cast<char*>(m_script.module()),
         m_bytecode);
@@ -142,46 +151,63 @@ void Invocation::compile()
         throw pdal::pdal_error(getTraceback());
 }
 
-void Invocation::cleanup()
+// Release the arguments of a call, which may be made many times with the
+// same compiled script.
+void Invocation::clearArguments()
 {
-    Py_XDECREF(m_varsIn);
-    Py_XDECREF(m_varsOut);
-    Py_XDECREF(m_scriptResult);
-    Py_XDECREF(m_scriptArgs); // also decrements script and vars
+    Py_CLEAR(m_varsIn);
+    Py_CLEAR(m_varsOut);
+    Py_CLEAR(m_scriptResult);
+    Py_CLEAR(m_scriptArgs); // also decrements script and vars
     for (size_t i = 0; i < m_pyInputArrays.size(); i++)
         Py_XDECREF(m_pyInputArrays[i]);
     m_pyInputArrays.clear();
-    Py_XDECREF(m_bytecode);
-    Py_XDECREF(m_module);
+    for (auto bi = m_buffers.begin(); bi != m_buffers.end(); ++bi)
+        free(*bi);
+    m_buffers.clear();
+}
+
+void Invocation::cleanup()
+{
+    clearArguments();
+    Py_CLEAR(m_bytecode);
+    Py_CLEAR(m_module);
 
     //	Py_XDECREF(m_function);
-    Py_XDECREF(m_dictionary);
+    Py_CLEAR(m_dictionary);
 
-    Py_XDECREF(m_metadata_PyObject);
-    Py_XDECREF(m_srs_PyObject);
-    Py_XDECREF(m_pdalargs_PyObject);
+    Py_CLEAR(m_metadata_PyObject);
+    Py_CLEAR(m_schema_PyObject);
+    Py_CLEAR(m_srs_PyObject);
+    Py_CLEAR(m_pdalargs_PyObject);
 }
 
 void Invocation::resetArguments()
 {
-    cleanup();
+    clearArguments();
     m_varsIn = PyDict_New();
     m_varsOut = PyDict_New();
 }
 
 void Invocation::insertArgument(std::string const& name, uint8_t* data,
-    Dimension::Type t, point_count_t count)
+    Dimension::Type t, point_count_t count, size_t stride)
 {
     npy_intp mydims = count;
     int nd = 1;
     npy_intp* dims = &mydims;
-    npy_intp stride = Dimension::size(t);
-    npy_intp* strides = &stride;
+    npy_intp byteStride = stride ? stride : Dimension::size(t);
+    npy_intp* strides = &byteStride;
 
 #ifdef NPY_ARRAY_CARRAY
     int flags = NPY_ARRAY_CARRAY;
+    // Values interleaved with those of other dimensions make a strided
+    // array, which may not be aligned.
+    if (byteStride != (npy_intp)Dimension::size(t))
+        flags = NPY_ARRAY_WRITEABLE;
 #else
     int flags = NPY_CARRAY;
+    if (byteStride != (npy_intp)Dimension::size(t))
+        flags = NPY_WRITEABLE;
 #endif
 
     const int pyDataType = plang::Environment::getPythonDataType(t);
@@ -193,7 +219,7 @@ void Invocation::insertArgument(std::string const& name, uint8_t* data,
 }
 
 void *Invocation::extractResult(std::string const& name,
-    Dimension::Type t, size_t& num_elements)
+    Dimension::Type t, size_t& num_elements, std::ptrdiff_t *stride)
 {
     PyObject* xarr = PyDict_GetItemString(m_varsOut, name.c_str());
     if (!xarr)
@@ -252,6 +278,23 @@ void *Invocation::extractResult(std::string const& name,
             "dimension data type of '" << name << "' is not pdal::Floating.";
         throw pdal::pdal_error(oss.str());
     }
+
+    // Outputs may be views of other arrays, such as slices or transposes,
+    // whose values aren't packed.  Replace those that can't be described
+    // by a single stride with a packed copy, which 'outs' keeps alive.
+    const bool packed = PyArray_IS_C_CONTIGUOUS(arr);
+    if (!packed && !(stride && nDims == 1))
+    {
+        PyObject *copy = PyArray_NewCopy(arr, NPY_CORDER);
+        if (!copy)
+            throw pdal::pdal_error(getTraceback());
+        PyDict_SetItemString(m_varsOut, name.c_str(), copy);
+        Py_DECREF(copy);
+        arr = (PyArrayObject *)copy;
+    }
+    if (stride)
+        *stride = (nDims == 1 && !packed) ? PyArray_STRIDE(arr, 0) :
+            (std::ptrdiff_t)Dimension::size(t);
     return PyArray_GetPtr(arr, &one);
 }
 
@@ -351,9 +394,17 @@ bool Invocation::execute()
     if (!PyBool_Check(m_scriptResult))
         throw pdal::pdal_error("User function return value not boolean.");
 
+    // PyDict_GetItem returns a borrowed reference.  Hold our own so that
+    // the object can be released like the one it replaces.
     PyObject* b = PyUnicode_FromString("metadata");
-    if (PyDict_Contains(m_dictionary, PyUnicode_FromString("metadata")) == 1)
-        m_metadata_PyObject = PyDict_GetItem(m_dictionary, b);
+    if (PyDict_Contains(m_dictionary, b) == 1)
+    {
+        PyObject *metadata = PyDict_GetItem(m_dictionary, b);
+        Py_XINCREF(metadata);
+        Py_XDECREF(m_metadata_PyObject);
+        m_metadata_PyObject = metadata;
+    }
+    Py_DECREF(b);
 
     return (m_scriptResult == Py_True);
 }
@@ -405,46 +456,155 @@ void Invocation::setKWargs(std::string const& s)
     m_pdalargs_PyObject = getPyJSON(s);
 }
 
+Invocation::ViewStorage Invocation::findStorage(PointView& view) const
+{
+    ViewStorage vs;
+    const point_count_t count = view.size();
+    if (!count)
+        return vs;
+
+    BasePointTable& table = view.m_pointTable;
+    if (ColumnPointTable *ct = dynamic_cast<ColumnPointTable *>(&table))
+    {
+        // Columns are ordered by point ID, so the view's points must be
+        // consecutive points of the table.
+        const PointId first = view.m_index[0];
+        for (PointId i = 1; i < count; ++i)
+            if (view.m_index[i] != first + i)
+                return vs;
+        vs.m_columns = ct;
+        vs.m_first = first;
+    }
+    // Blocks of a mapped table can be unmapped as others are accessed, so
+    // only tables that keep all their points in memory are used.
+    else if (dynamic_cast<PointTable *>(&table) ||
+        dynamic_cast<ContiguousPointTable *>(&table))
+    {
+        const size_t pointSize = view.layout()->pointSize();
+        char *base = view.getPoint(0);
+        for (PointId i = 1; i < count; ++i)
+            if (view.getPoint(i) != base + i * pointSize)
+                return vs;
+        vs.m_base = base;
+        vs.m_pointSize = pointSize;
+    }
+    return vs;
+}
+
+Invocation::Storage Invocation::dimStorage(const ViewStorage& vs,
+    const PointLayout& layout, Dimension::Id d) const
+{
+    const Dimension::Detail *dd = layout.dimDetail(d);
+
+    Storage s;
+    if (vs.m_columns)
+    {
+        s.m_data = vs.m_columns->column(d) + vs.m_first * dd->size();
+        s.m_stride = dd->size();
+    }
+    else
+    {
+        s.m_data = vs.m_base + dd->offset();
+        s.m_stride = vs.m_pointSize;
+    }
+    return s;
+}
+
 void Invocation::begin(PointView& view, MetadataNode m)
 {
     PointLayoutPtr layout(view.m_pointTable.layout());
     Dimension::IdList const& dims = layout->dims();
 
-    for (auto di = dims.begin(); di != dims.end(); ++di)
+    // The values of each dimension are found or copied without holding
+    // the interpreter lock.  Only handing them to NumPy needs it.
+    std::vector<Storage> storage;
     {
-        Dimension::Id d = *di;
-        const Dimension::Detail *dd = layout->dimDetail(d);
-        void *data = malloc(dd->size() * view.size());
+        GilRelease release;
+        const ViewStorage vs = findStorage(view);
+        for (Dimension::Id d : dims)
+        {
+            // Hand NumPy the table's own storage rather than a copy.
+            // Scaled dimensions are stored as integers and are always
+            // converted.
+            const Dimension::Detail *dd = layout->dimDetail(d);
+            if (vs.valid() && !dd->scaled())
+            {
+                storage.push_back(dimStorage(vs, *layout, d));
+                continue;
+            }
+
+            const size_t size = Dimension::size(dd->type());
+            char *data = (char *)malloc(size * view.size());
+            m_buffers.push_back(data);  // Hold pointer for deallocation
+            char *p = data;
+            for (PointId idx = 0; idx < view.size(); ++idx)
+            {
+                view.getField(p, d, dd->type(), idx);
+                p += size;
+            }
+            storage.push_back({ data, size });
+        }
+    }
+
+    for (size_t i = 0; i < dims.size(); ++i)
+        insertArgument(layout->dimName(dims[i]),
+            (uint8_t *)storage[i].m_data, layout->dimType(dims[i]),
+            view.size(), storage[i].m_stride);
+
+    setGlobals(m, *view.layout(), view.spatialReference());
+}
+
+void Invocation::begin(const std::vector<PointRef>& points,
+    const PointLayout& layout, const SpatialReference& srs, MetadataNode m)
+{
+    for (Dimension::Id d : layout.dims())
+    {
+        const Dimension::Detail *dd = layout.dimDetail(d);
+        const size_t size = Dimension::size(dd->type());
+        char *data = (char *)malloc(size * (std::max)(points.size(),
+            (size_t)1));
         m_buffers.push_back(data);  // Hold pointer for deallocation
-        char *p = (char *)data;
-        for (PointId idx = 0; idx < view.size(); ++idx)
+        char *p = data;
+        for (const PointRef& point : points)
         {
-            view.getFieldInternal(d, idx, (void *)p);
-            p += dd->size();
+            point.getField(p, d, dd->type());
+            p += size;
         }
-        std::string name = layout->dimName(*di);
-        insertArgument(name, (uint8_t *)data, dd->type(), view.size());
+        insertArgument(layout.dimName(d), (uint8_t *)data, dd->type(),
+            points.size());
     }
+    setGlobals(m, layout, srs);
+}
 
+void Invocation::setGlobals(MetadataNode m, const PointLayout& layout,
+    const SpatialReference& srs)
+{
     // Put pipeline 'metadata' variable into module scope
     Py_XDECREF(m_metadata_PyObject);
     m_metadata_PyObject = plang::fromMetadata(m);
 
     // Put 'schema' dict into module scope
-    MetadataNode s = view.layout()->toMetadata();
+    MetadataNode s = layout.toMetadata();
     std::ostringstream ostrm;
     Utils::toJSON(s, ostrm);
     Py_XDECREF(m_schema_PyObject);
     m_schema_PyObject = getPyJSON(ostrm.str());
     ostrm.str("");
 
-    MetadataNode srs = view.spatialReference().toMetadata();
-    Utils::toJSON(srs, ostrm);
+    MetadataNode srsNode = srs.toMetadata();
+    Utils::toJSON(srsNode, ostrm);
     Py_XDECREF(m_srs_PyObject);
     m_srs_PyObject = getPyJSON(ostrm.str());
 }
 
 void Invocation::end(PointView& view, MetadataNode m)
+{
+    end(view);
+    if (m_metadata_PyObject)
+        plang::addMetadata(m_metadata_PyObject, m);
+}
+
+void Invocation::end(PointView& view)
 {
     // for each entry in the script's outs dictionary,
     // look up that entry's name in the schema and then
@@ -456,6 +616,17 @@ void Invocation::end(PointView& view, MetadataNode m)
 
     PointLayoutPtr layout(view.m_pointTable.layout());
     Dimension::IdList const& dims = layout->dims();
+    const ViewStorage vs = findStorage(view);
+
+    struct Output
+    {
+        Dimension::Id m_id;
+        const char *m_data;
+        npy_intp m_stride;
+        size_t m_count;
+        std::vector<char> m_copy;
+    };
+    std::vector<Output> outputs;
 
     for (auto di = dims.begin(); di != dims.end(); ++di)
     {
@@ -468,21 +639,142 @@ void Invocation::end(PointView& view, MetadataNode m)
         assert(name == *found);
         assert(hasOutputVariable(name));
 
-        size_t size = dd->size();
+        Output out;
+        out.m_id = d;
+        std::ptrdiff_t stride;
+        out.m_data = (const char *)extractResult(name, dd->type(),
+            out.m_count, &stride);
+        out.m_stride = (npy_intp)stride;
+        outputs.push_back(std::move(out));
+    }
+
+    // The outputs are held by the 'outs' dictionary, so their values can
+    // be copied to the points without holding the interpreter lock.
+    GilRelease release;
+
+    // Outputs may be views of the table's storage, such as an input array
+    // or a slice of one.  Those that aren't the storage of their own
+    // dimension are copied before anything is written so that writing one
+    // dimension doesn't change the values of another output.
+    auto overlaps = [](const char *lo1, const char *hi1,
+        const char *lo2, const char *hi2)
+    {
+        return lo1 < hi2 && lo2 < hi1;
+    };
+    auto range = [](const char *data, npy_intp stride, size_t count,
+        size_t size, const char *& lo, const char *& hi)
+    {
+        const npy_intp span = count ? stride * (npy_intp)(count - 1) : 0;
+        lo = data + (std::min)(span, (npy_intp)0);
+        hi = data + (std::max)(span, (npy_intp)0) + size;
+    };
+
+    for (Output& out : outputs)
+    {
+        if (!vs.valid())
+            break;
+
+        const size_t size = Dimension::size(layout->dimType(out.m_id));
+        const Storage own = dimStorage(vs, *layout, out.m_id);
+        if (!layout->dimDetail(out.m_id)->scaled() &&
+            out.m_data == own.m_data &&
+            out.m_stride == (npy_intp)own.m_stride &&
+            out.m_count == view.size())
+            continue;
+
+        const char *lo, *hi;
+        range(out.m_data, out.m_stride, out.m_count, size, lo, hi);
+        bool shared = false;
+        for (Dimension::Id d : dims)
+        {
+            const Storage s = dimStorage(vs, *layout, d);
+            const char *slo, *shi;
+            range(s.m_data, s.m_stride, view.size(), layout->dimSize(d),
+                slo, shi);
+            if (overlaps(lo, hi, slo, shi))
+            {
+                shared = true;
+                break;
+            }
+        }
+        if (!shared)
+            continue;
+
+        out.m_copy.resize(out.m_count * size);
+        for (size_t i = 0; i < out.m_count; ++i)
+            std::memcpy(out.m_copy.data() + i * size,
+                out.m_data + i * out.m_stride, size);
+        out.m_data = out.m_copy.data();
+        out.m_stride = size;
+    }
+
+    for (const Output& out : outputs)
+    {
+        const Dimension::Detail *dd = layout->dimDetail(out.m_id);
+        const size_t size = Dimension::size(dd->type());
+        const char *p = out.m_data;
+
+        if (vs.valid() && !dd->scaled() && out.m_count == view.size())
+        {
+            // Write directly to the table's storage.  There's nothing to
+            // do if the script modified an input array in place.
+            Storage s = dimStorage(vs, *layout, out.m_id);
+            if (p == s.m_data && out.m_stride == (npy_intp)s.m_stride)
+                continue;
+            for (size_t i = 0; i < out.m_count; ++i)
+            {
+                std::memcpy(s.m_data, p, size);
+                s.m_data += s.m_stride;
+                p += out.m_stride;
+            }
+            continue;
+        }
+
+        for (PointId idx = 0; idx < out.m_count; ++idx)
+        {
+            view.setField(out.m_id, dd->type(), idx, (const void *)p);
+            p += out.m_stride;
+        }
+    }
+    for (auto bi = m_buffers.begin(); bi != m_buffers.end(); ++bi)
+        free(*bi);
+    m_buffers.clear();
+}
+
+void Invocation::end(std::vector<PointRef>& points, const PointLayout& layout)
+{
+    std::vector<std::string> names;
+    getOutputNames(names);
+
+    for (Dimension::Id d : layout.dims())
+    {
+        const Dimension::Detail *dd = layout.dimDetail(d);
+        std::string name = layout.dimName(d);
+        if (std::find(names.begin(), names.end(), name) == names.end())
+            continue;
+
         size_t arrSize(0);
-        void *data = extractResult(name, dd->type(), arrSize);
-        char *p = (char *)data;
-        for (PointId idx = 0; idx < arrSize; ++idx)
+        std::ptrdiff_t stride;
+        const char *p = (const char *)extractResult(name, dd->type(), arrSize,
+            &stride);
+        if (arrSize != points.size())
+            throw pdal::pdal_error("Plang output variable '" + name +
+                "' doesn't have a value for each point.");
+        for (PointRef& point : points)
         {
-            view.setField(d, dd->type(), idx, (void *)p);
-            p += size;
+            point.setField(d, dd->type(), (const void *)p);
+            p += stride;
         }
     }
     for (auto bi = m_buffers.begin(); bi != m_buffers.end(); ++bi)
         free(*bi);
     m_buffers.clear();
+}
+
+void Invocation::addMetadata(MetadataNode m)
+{
     if (m_metadata_PyObject)
-        addMetadata(m_metadata_PyObject, m);
+        plang::addMetadata(m_metadata_PyObject, m);
 }
 } // namespace plang
 } // namespace pdal
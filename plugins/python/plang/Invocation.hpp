@@ -60,14 +60,21 @@ public:
 
 
     // creates a Python variable pointing to a (one dimensional) C array
-    // adds the new variable to the arguments dictionary
+    // adds the new variable to the arguments dictionary.  The array isn't
+    // copied.  If stride is 0, the values are packed.
     void insertArgument(std::string const& name,
                         uint8_t* data,
                         Dimension::Type t,
-                        point_count_t count);
+                        point_count_t count,
+                        size_t stride = 0);
+    // Returns the address of the first value of an output array.  If
+    // stride is null, the values are packed, which may mean copying the
+    // array.  Otherwise one dimensional arrays aren't copied and stride
+    // is set to the byte distance between their values.
     void *extractResult(const std::string& name,
                         Dimension::Type dataType,
-                        size_t& arrSize);
+                        size_t& arrSize,
+                        std::ptrdiff_t *stride = nullptr);
 
     bool hasOutputVariable(const std::string& name) const;
 
@@ -83,13 +90,53 @@ public:
     // possible names from the schema)
     void getOutputNames(std::vector<std::string>& names);
 
+    // The interpreter lock must be held.  It's released while values are
+    // copied between the view and the arrays.
     void begin(PointView& view, MetadataNode m);
     void end(PointView& view, MetadataNode m);
+    // Copy the outputs to the view without adding metadata set by the
+    // script.
+    void end(PointView& view);
+
+    // Stream mode.  The arguments are copies of the values of the points,
+    // and outputs are copied back to the points by end().  Metadata set
+    // by the script is only added by addMetadata().
+    void begin(const std::vector<PointRef>& points, const PointLayout& layout,
+        const SpatialReference& srs, MetadataNode m);
+    void end(std::vector<PointRef>& points, const PointLayout& layout);
+    void addMetadata(MetadataNode m);
 
     void setKWargs(std::string const& s);
 
 private:
+    // Location of the values of a dimension for the points of a view.
+    struct Storage
+    {
+        char *m_data;
+        size_t m_stride;
+    };
+
+    // Where the points of a view are stored, if the values of each
+    // dimension are evenly spaced in the table and can be handed to NumPy
+    // without copying.
+    struct ViewStorage
+    {
+        ColumnPointTable *m_columns = nullptr;
+        PointId m_first = 0;
+        char *m_base = nullptr;
+        size_t m_pointSize = 0;
+
+        bool valid() const
+            { return m_columns || m_base; }
+    };
+
+    void clearArguments();
     void cleanup();
+    void setGlobals(MetadataNode m, const PointLayout& layout,
+        const SpatialReference& srs);
+    ViewStorage findStorage(PointView& view) const;
+    Storage dimStorage(const ViewStorage& vs, const PointLayout& layout,
+        Dimension::Id d) const;
 
     Script m_script;
 
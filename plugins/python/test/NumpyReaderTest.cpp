@@ -236,3 +236,42 @@ TEST(NumpyReaderTest, threedim_col)
     }
 }
 
+
+// Contiguous arrays are copied a field at a time.  Make sure the result is
+// the same for row and column tables and with a single thread.
+TEST(NumpyReaderTest, bulkCopy)
+{
+    auto run = [](BasePointTable& table, int threads)
+    {
+        Options ops;
+        ops.add("filename", Support::datapath("plang/1.2-with-color.npy"));
+        ops.add("threads", threads);
+
+        NumpyReader reader;
+        reader.setOptions(ops);
+        reader.prepare(table);
+        PointViewSet viewSet = reader.execute(table);
+        EXPECT_EQ(viewSet.size(), 1u);
+        return *viewSet.begin();
+    };
+
+    PointTable t1;
+    PointViewPtr v1 = run(t1, 1);
+    PointTable t2;
+    PointViewPtr v2 = run(t2, 4);
+    ColumnPointTable t3;
+    PointViewPtr v3 = run(t3, 4);
+
+    ASSERT_EQ(v1->size(), 1065u);
+    ASSERT_EQ(v2->size(), v1->size());
+    ASSERT_EQ(v3->size(), v1->size());
+    for (PointId idx = 0; idx < v1->size(); ++idx)
+        for (Dimension::Id id : t1.layout()->dims())
+        {
+            double d = v1->getFieldAs<double>(id, idx);
+            EXPECT_EQ(d, v2->getFieldAs<double>(id, idx));
+            EXPECT_EQ(d, v3->getFieldAs<double>(id, idx));
+        }
+    EXPECT_EQ(v3->getFieldAs<int16_t>(Dimension::Id::Intensity, 800), 49);
+    EXPECT_EQ(v3->getFieldAs<int32_t>(Dimension::Id::X, 400), 63679039);
+}
@@ -36,8 +36,10 @@
 
 #include <pdal/PipelineManager.hpp>
 #include <pdal/StageFactory.hpp>
+#include <io/BufferReader.hpp>
 #include <io/FauxReader.hpp>
 #include <filters/StatsFilter.hpp>
+#include <filters/StreamCallbackFilter.hpp>
 
 #include "../plang/Invocation.hpp"
 #include "../plang/Environment.hpp"
@@ -124,6 +126,254 @@ TEST_F(PythonFilterTest, PythonFilterTest_test1)
     EXPECT_DOUBLE_EQ(statsZ.maximum(), 3.14);
 }
 
+// Input arrays are views of the table's storage.  Check that changing them
+// in place and swapping dimensions work with both interleaved and columnar
+// tables.
+TEST_F(PythonFilterTest, sharedStorage)
+{
+    auto test = [](BasePointTable& table)
+    {
+        StageFactory f;
+
+        Options ops;
+        ops.add("bounds", BOX3D(0.0, 0.0, 0.0, 9.0, 18.0, 27.0));
+        ops.add("count", 10);
+        ops.add("mode", "ramp");
+
+        FauxReader reader;
+        reader.setOptions(ops);
+
+        Options opts;
+        opts.add("source", "import numpy as np\n"
+            "def myfunc(ins,outs):\n"
+            "  Z = ins['Z']\n"
+            "  Z *= 2\n"
+            "  outs['Z'] = Z\n"
+            "  outs['X'] = ins['Y']\n"
+            "  outs['Y'] = ins['X']\n"
+            "  return True\n"
+        );
+        opts.add("module", "MyModule");
+        opts.add("function", "myfunc");
+
+        Stage* filter(f.createStage("filters.python"));
+        filter->setOptions(opts);
+        filter->setInput(reader);
+
+        filter->prepare(table);
+        PointViewSet viewSet = filter->execute(table);
+        EXPECT_EQ(viewSet.size(), 1u);
+        PointViewPtr view = *viewSet.begin();
+        EXPECT_EQ(view->size(), 10u);
+
+        for (PointId i = 0; i < view->size(); ++i)
+        {
+            EXPECT_DOUBLE_EQ(view->getFieldAs<double>(Dimension::Id::X, i),
+                2.0 * i);
+            EXPECT_DOUBLE_EQ(view->getFieldAs<double>(Dimension::Id::Y, i),
+                1.0 * i);
+            EXPECT_DOUBLE_EQ(view->getFieldAs<double>(Dimension::Id::Z, i),
+                6.0 * i);
+        }
+    };
+
+    PointTable table;
+    test(table);
+
+    ColumnPointTable columnTable;
+    test(columnTable);
+}
+
+// Outputs that are reversed, sliced or strided views of other arrays must
+// be read element by element rather than as packed values.
+TEST_F(PythonFilterTest, stridedOutputs)
+{
+    auto test = [](BasePointTable& table, const std::string& source)
+    {
+        StageFactory f;
+
+        Options ops;
+        ops.add("bounds", BOX3D(0.0, 0.0, 0.0, 9.0, 18.0, 27.0));
+        ops.add("count", 10);
+        ops.add("mode", "ramp");
+
+        FauxReader reader;
+        reader.setOptions(ops);
+
+        Options opts;
+        opts.add("source", source);
+        opts.add("module", "MyModule");
+        opts.add("function", "myfunc");
+
+        Stage* filter(f.createStage("filters.python"));
+        filter->setOptions(opts);
+        filter->setInput(reader);
+
+        filter->prepare(table);
+        PointViewSet viewSet = filter->execute(table);
+        EXPECT_EQ(viewSet.size(), 1u);
+        return *viewSet.begin();
+    };
+
+    const std::string strided("import numpy as np\n"
+        "def myfunc(ins,outs):\n"
+        "  outs['X'] = ins['X'][::-1]\n"
+        "  outs['Y'] = np.arange(20.0).reshape(4, 5)[::2]\n"
+        "  outs['Z'] = np.arange(20.0)[::2]\n"
+        "  return True\n");
+
+    auto check = [](PointViewPtr view)
+    {
+        EXPECT_EQ(view->size(), 10u);
+        for (PointId i = 0; i < view->size(); ++i)
+        {
+            EXPECT_DOUBLE_EQ(view->getFieldAs<double>(Dimension::Id::X, i),
+                9.0 - i);
+            EXPECT_DOUBLE_EQ(view->getFieldAs<double>(Dimension::Id::Y, i),
+                i < 5 ? 1.0 * i : i + 5.0);
+            EXPECT_DOUBLE_EQ(view->getFieldAs<double>(Dimension::Id::Z, i),
+                2.0 * i);
+        }
+    };
+
+    PointTable table;
+    check(test(table, strided));
+
+    ColumnPointTable columnTable;
+    check(test(columnTable, strided));
+
+    PointTable maskTable;
+    PointViewPtr view = test(maskTable, "import numpy as np\n"
+        "def myfunc(ins,outs):\n"
+        "  outs['Mask'] = np.repeat(ins['X'] > 4, 2)[::2]\n"
+        "  return True\n");
+    EXPECT_EQ(view->size(), 5u);
+    for (PointId i = 0; i < view->size(); ++i)
+        EXPECT_DOUBLE_EQ(view->getFieldAs<double>(Dimension::Id::X, i),
+            5.0 + i);
+}
+
+TEST_F(PythonFilterTest, stream)
+{
+    auto test = [](const std::string& source, point_count_t batchSize,
+        std::function<bool(PointRef&)> cb, bool cullOdd = false)
+    {
+        StageFactory f;
+
+        Options ops;
+        ops.add("bounds", BOX3D(0.0, 0.0, 0.0, 9.0, 18.0, 27.0));
+        ops.add("count", 10);
+        ops.add("mode", "ramp");
+
+        FauxReader reader;
+        reader.setOptions(ops);
+
+        Options opts;
+        opts.add("source", source);
+        opts.add("module", "MyModule");
+        opts.add("function", "myfunc");
+        opts.add("batch_size", batchSize);
+
+        // Optionally skip the points with odd X before the function sees
+        // them, so that batches are made of scattered points.
+        StreamCallbackFilter cull;
+        cull.setCallback([](PointRef& p)
+            { return p.getFieldAs<int>(Dimension::Id::X) % 2 == 0; });
+        cull.setInput(reader);
+
+        Stage* filter(f.createStage("filters.python"));
+        filter->setOptions(opts);
+        if (cullOdd)
+            filter->setInput(cull);
+        else
+            filter->setInput(reader);
+
+        StreamCallbackFilter c;
+        c.setCallback(cb);
+        c.setInput(*filter);
+
+        FixedPointTable table(8);
+        c.prepare(table);
+        c.execute(table);
+    };
+
+    // State is kept between batches, which are at most the batch size and
+    // don't span batches of the stream.
+    int count = 0;
+    const std::vector<int> calls { 1, 1, 1, 2, 2, 2, 3, 3, 4, 4 };
+    test("import numpy as np\n"
+        "calls = 0\n"
+        "def myfunc(ins,outs):\n"
+        "  global calls\n"
+        "  calls += 1\n"
+        "  outs['Z'] = ins['Z'] + calls\n"
+        "  return True\n", 3,
+        [&count, &calls](PointRef& p)
+        {
+            EXPECT_DOUBLE_EQ(p.getFieldAs<double>(Dimension::Id::Z),
+                3.0 * count + calls[count]);
+            count++;
+            return true;
+        });
+    EXPECT_EQ(count, 10);
+
+    count = 0;
+    test("import numpy as np\n"
+        "def myfunc(ins,outs):\n"
+        "  outs['Mask'] = np.mod(ins['X'], 2) == 0\n"
+        "  return True\n", 0,
+        [&count](PointRef& p)
+        {
+            EXPECT_DOUBLE_EQ(p.getFieldAs<double>(Dimension::Id::X),
+                2.0 * count);
+            count++;
+            return true;
+        });
+    EXPECT_EQ(count, 5);
+
+    // Only the points left by the previous stage are passed, in batches of
+    // two within each batch of the stream.
+    count = 0;
+    const std::vector<int> culledCalls { 1, 1, 2, 2, 3 };
+    test("import numpy as np\n"
+        "calls = 0\n"
+        "def myfunc(ins,outs):\n"
+        "  global calls\n"
+        "  calls += 1\n"
+        "  outs['Z'] = ins['Z'] + calls\n"
+        "  return True\n", 2,
+        [&count, &culledCalls](PointRef& p)
+        {
+            EXPECT_DOUBLE_EQ(p.getFieldAs<double>(Dimension::Id::X),
+                2.0 * count);
+            EXPECT_DOUBLE_EQ(p.getFieldAs<double>(Dimension::Id::Z),
+                6.0 * count + culledCalls[count]);
+            count++;
+            return true;
+        }, true);
+    EXPECT_EQ(count, 5);
+
+    // Outputs that are strided views are read with their stride.  The
+    // stream's batches are points 0-7 and 8-9.
+    count = 0;
+    const std::vector<double> reversed { 7, 6, 5, 4, 3, 2, 1, 0, 9, 8 };
+    test("import numpy as np\n"
+        "def myfunc(ins,outs):\n"
+        "  outs['X'] = ins['X'][::-1]\n"
+        "  outs['Y'] = np.repeat(ins['Y'], 2)[::2]\n"
+        "  return True\n", 0,
+        [&count, &reversed](PointRef& p)
+        {
+            EXPECT_DOUBLE_EQ(p.getFieldAs<double>(Dimension::Id::X),
+                reversed[count]);
+            EXPECT_DOUBLE_EQ(p.getFieldAs<double>(Dimension::Id::Y),
+                2.0 * count);
+            count++;
+            return true;
+        });
+    EXPECT_EQ(count, 10);
+}
+
 TEST_F(PythonFilterTest, pipelineJSON)
 {
     PipelineManager manager;
@@ -1063,6 +1313,51 @@ TEST_F(PythonFilterTest, PythonFilterTest_modify)
     EXPECT_DOUBLE_EQ(statsZ.maximum(), 100);
 }
 
+// Views run at once each get a copy of the module.
+TEST_F(PythonFilterTest, threads)
+{
+    StageFactory f;
+
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::Z);
+    BufferReader reader;
+    for (int v = 0; v < 4; ++v)
+    {
+        PointViewPtr view(new PointView(table));
+        for (PointId i = 0; i < 1000; ++i)
+            view->setField(Dimension::Id::Z, i, v);
+        reader.addView(view);
+    }
+
+    Options opts;
+    opts.add("source", "import numpy as np\n"
+        "def myfunc(ins,outs):\n"
+        "  outs['Z'] = ins['Z'] + 10\n"
+        "  return True\n");
+    opts.add("module", "MyModule");
+    opts.add("function", "myfunc");
+    opts.add("threads", 2);
+
+    Stage* filter(f.createStage("filters.python"));
+    filter->setOptions(opts);
+    filter->setInput(reader);
+    filter->prepare(table);
+    PointViewSet viewSet = filter->execute(table, 4);
+    EXPECT_EQ(viewSet.size(), 4u);
+
+    std::vector<double> z;
+    for (PointViewPtr view : viewSet)
+    {
+        EXPECT_EQ(view->size(), 1000u);
+        double first = view->getFieldAs<double>(Dimension::Id::Z, 0);
+        for (PointId i = 1; i < view->size(); ++i)
+            EXPECT_EQ(view->getFieldAs<double>(Dimension::Id::Z, i), first);
+        z.push_back(first);
+    }
+    std::sort(z.begin(), z.end());
+    EXPECT_EQ(z, std::vector<double>({ 10, 11, 12, 13 }));
+}
+
 
 // most pipelines (those with a writer) will be invoked via `pdal pipeline`
 static void run_pipeline(std::string const& pipeline)
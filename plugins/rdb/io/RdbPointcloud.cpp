@@ -32,9 +32,11 @@
 * OF SUCH DAMAGE.
  ****************************************************************************/
 
+#include <algorithm>
 #include <sstream>
 #include <array>
 #include <json/json.h>
+#include <pdal/util/ThreadPool.hpp>
 #include "RdbPointcloud.hpp"
 
 namespace pdal
@@ -367,22 +369,60 @@ void RdbPointcloud::addDimensions(PointLayoutPtr layout)
 
 point_count_t RdbPointcloud::read(PointViewPtr view, const point_count_t count)
 {
-    struct PointViewAdapter
+    // Coordinates share a task since setting any of them touches the
+    // view's modification count.  The first buffer is written while the
+    // view is grown, so it isn't part of any task.
+    std::vector<std::vector<AttributeBuffer::Ptr>> tasks;
+    std::vector<AttributeBuffer::Ptr> coordinates;
+    for (size_t i = 1; i < m_select_buffer.size(); ++i)
     {
-        PointViewAdapter(PointViewPtr view): view(view) { }
-        point_count_t size() const { return view->size(); }
-        void setField(
-            const Dimension::Id   dimension,
-            const Dimension::Type type,
-            const PointId         index,
-            const void*           value
-        ) const
+        const auto& buffer = m_select_buffer[i];
+        if (buffer->id == Dimension::Id::X ||
+            buffer->id == Dimension::Id::Y ||
+            buffer->id == Dimension::Id::Z)
+            coordinates.push_back(buffer);
+        else
+            tasks.push_back({ buffer });
+    }
+    if (!coordinates.empty())
+        tasks.push_back(coordinates);
+
+    point_count_t total = 0;
+    while (total < count && !m_select_buffer.empty())
+    {
+        if ((m_select_index >= m_select_count) && !nextBlock())
+            break;
+
+        const point_count_t num = (std::min)(
+            count - total, point_count_t(m_select_count - m_select_index)
+        );
+        const PointId start = view->size();
+        const auto& first = m_select_buffer.front();
+        for (point_count_t i = 0; i < num; ++i)
         {
-            view->setField(dimension, type, index, value);
+            view->setField(
+                first->id, first->type, start + i,
+                first->at(m_select_index + i)
+            );
         }
-        PointViewPtr view;
-    };
-    return readPoints(PointViewAdapter(view), count);
+        parallelFor(tasks.size(), [&]()
+        {
+            return [&](size_t t)
+            {
+                for (const auto& buffer: tasks[t])
+                for (point_count_t i = 0; i < num; ++i)
+                {
+                    view->setField(
+                        buffer->id, buffer->type, start + i,
+                        buffer->at(m_select_index + i)
+                    );
+                }
+            };
+        }, 1);
+        m_select_index += uint32_t(num);
+        total += num;
+    }
+    return total;
 }
 
 
@@ -459,44 +499,10 @@ point_count_t RdbPointcloud::readPoints(
     {
         if (m_select_index >= m_select_count) // then read next block
         {
-            m_select_index = 0; // rewind internal buffer
-            m_select_count = m_select_query.next(m_buffer_size);
-            if (m_select_count == 0) // then we reached end-of-file
+            if (!nextBlock()) // then we reached end-of-file
             {
                 return total;
             }
-            if (m_crs_pose) // then transform points
-            {
-                const auto transform = [&](
-                    const AttributeBuffer::Ptr& x,
-                    const AttributeBuffer::Ptr& y,
-                    const AttributeBuffer::Ptr& z,
-                    const double                w
-                )
-                {
-                    auto px = static_cast<double*>(x->at(0));
-                    auto py = static_cast<double*>(y->at(0));
-                    auto pz = static_cast<double*>(z->at(0));
-                    const auto end = px + m_select_count;
-                    for (; px < end; ++px, ++py, ++pz)
-                    {
-                        const Eigen::Vector4d xyz(
-                            *m_crs_pose * Eigen::Vector4d(*px, *py, *pz, w)
-                        );
-                        *px = xyz[0];
-                        *py = xyz[1];
-                        *pz = xyz[2];
-                    }
-                };
-                if (m_buffer_px && m_buffer_py && m_buffer_pz) // coordinates
-                {
-                    transform(m_buffer_px, m_buffer_py, m_buffer_pz, 1.0);
-                }
-                if (m_buffer_nx && m_buffer_ny && m_buffer_nz) // normals
-                {
-                    transform(m_buffer_nx, m_buffer_ny, m_buffer_nz, 0.0);
-                }
-            }
         }
         while ((total < count) && (m_select_index < m_select_count))
         {
@@ -517,4 +523,50 @@ point_count_t RdbPointcloud::readPoints(
     return total;
 }
 
+
+bool RdbPointcloud::nextBlock()
+{
+    m_select_index = 0; // rewind internal buffer
+    m_select_count = m_select_query.next(m_buffer_size);
+    if (m_select_count == 0) // then we reached end-of-file
+    {
+        return false;
+    }
+    if (m_crs_pose) // then transform points
+    {
+        const auto transform = [&](
+            const AttributeBuffer::Ptr& x,
+            const AttributeBuffer::Ptr& y,
+            const AttributeBuffer::Ptr& z,
+            const double                w
+        )
+        {
+            const auto px = static_cast<double*>(x->at(0));
+            const auto py = static_cast<double*>(y->at(0));
+            const auto pz = static_cast<double*>(z->at(0));
+            parallelFor(m_select_count, [&]()
+            {
+                return [&](size_t i)
+                {
+                    const Eigen::Vector4d xyz(
+                        *m_crs_pose * Eigen::Vector4d(px[i], py[i], pz[i], w)
+                    );
+                    px[i] = xyz[0];
+                    py[i] = xyz[1];
+                    pz[i] = xyz[2];
+                };
+            });
+        };
+        if (m_buffer_px && m_buffer_py && m_buffer_pz) // coordinates
+        {
+            transform(m_buffer_px, m_buffer_py, m_buffer_pz, 1.0);
+        }
+        if (m_buffer_nx && m_buffer_ny && m_buffer_nz) // normals
+        {
+            transform(m_buffer_nx, m_buffer_ny, m_buffer_nz, 0.0);
+        }
+    }
+    return true;
+}
+
 }
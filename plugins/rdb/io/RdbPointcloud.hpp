@@ -59,6 +59,8 @@ public:
 
     void addDimensions(PointLayoutPtr layout);
 
+    //! read up to count points, filling the attributes of each block in
+    //! parallel
     point_count_t read(PointViewPtr view, const point_count_t count);
     bool read(PointRef& point);
 
@@ -137,6 +139,9 @@ private:
         const size_t m_typeSize;
     };
 
+    // read the next block of points from the database, false at the end
+    bool nextBlock();
+
     // point reader implementation
     template <typename TargetAdapter>
     point_count_t readPoints(
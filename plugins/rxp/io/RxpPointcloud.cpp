@@ -41,6 +41,10 @@
 
 #include "RxpPointcloud.hpp"
 
+#include <functional>
+
+#include <pdal/util/ThreadPool.hpp>
+
 
 namespace pdal
 {
@@ -64,8 +68,7 @@ RxpPointcloud::RxpPointcloud(
         bool syncToPps,
         bool reflectanceAsIntensity,
         float minReflectance,
-        float maxReflectance,
-        PointTableRef table)
+        float maxReflectance)
     : scanlib::pointcloud(syncToPps)
     , m_syncToPps(syncToPps)
     , m_reflectanceAsIntensity(reflectanceAsIntensity)
@@ -132,17 +135,95 @@ void RxpPointcloud::copyPoint(const Point& from, PointRef& to) const {
     to.setField(Id::IsPpsLocked, from.target.is_pps_locked);
 
     if (m_reflectanceAsIntensity) {
-        uint16_t intensity;
-        if (from.target.reflectance > m_maxReflectance) {
-            intensity = (std::numeric_limits<uint16_t>::max)();
-        } else if (from.target.reflectance < m_minReflectance) {
-            intensity = 0;
-        } else {
-            intensity = uint16_t(std::roundf(double((std::numeric_limits<uint16_t>::max)()) *
-                        (from.target.reflectance - m_minReflectance) / (m_maxReflectance - m_minReflectance)));
-        }
-        to.setField(Id::Intensity, intensity);
+        to.setField(Id::Intensity, intensity(from.target.reflectance));
+    }
+}
+
+
+uint16_t RxpPointcloud::intensity(float reflectance) const
+{
+    if (reflectance > m_maxReflectance) {
+        return (std::numeric_limits<uint16_t>::max)();
+    } else if (reflectance < m_minReflectance) {
+        return 0;
+    } else {
+        return uint16_t(std::roundf(double((std::numeric_limits<uint16_t>::max)()) *
+                    (reflectance - m_minReflectance) / (m_maxReflectance - m_minReflectance)));
+    }
+}
+
+
+point_count_t RxpPointcloud::readBatch(std::vector<Point>& points, point_count_t count)
+{
+    points.clear();
+    while (m_points.size() < count && !endOfInput())
+    {
+        m_dec.get(m_rxpbuf);
+        if (!m_dec.eoi())
+            dispatch(m_rxpbuf.begin(), m_rxpbuf.end());
     }
+    count = (std::min)(count, (point_count_t)m_points.size());
+    points.reserve(count);
+    for (point_count_t i = 0; i < count; ++i)
+    {
+        points.push_back(m_points.front());
+        m_points.pop_front();
+    }
+    return count;
+}
+
+
+void RxpPointcloud::copyPoints(const std::vector<Point>& points, PointView& view,
+        PointId start) const
+{
+    using namespace Dimension;
+
+    // X, Y and Z are written by one task since setting any of them touches
+    // the view's modification count.
+    std::vector<std::function<void(const Point&, PointId)>> fields;
+    fields.push_back([&view](const Point& p, PointId idx) {
+        view.setField(Id::X, idx, p.target.vertex[0]);
+        view.setField(Id::Y, idx, p.target.vertex[1]);
+        view.setField(Id::Z, idx, p.target.vertex[2]);
+    });
+    const Id timeId = getTimeDimensionId(m_syncToPps);
+    fields.push_back([&view, timeId](const Point& p, PointId idx) {
+        view.setField(timeId, idx, p.target.time);
+    });
+    fields.push_back([&view](const Point& p, PointId idx) {
+        view.setField(Id::Amplitude, idx, p.target.amplitude);
+    });
+    fields.push_back([&view](const Point& p, PointId idx) {
+        view.setField(Id::Reflectance, idx, p.target.reflectance);
+    });
+    fields.push_back([&view](const Point& p, PointId idx) {
+        view.setField(Id::ReturnNumber, idx, p.returnNumber);
+        view.setField(Id::NumberOfReturns, idx, p.numberOfReturns);
+    });
+    fields.push_back([&view](const Point& p, PointId idx) {
+        view.setField(Id::EchoRange, idx, p.target.echo_range);
+    });
+    fields.push_back([&view](const Point& p, PointId idx) {
+        view.setField(Id::Deviation, idx, p.target.deviation);
+    });
+    fields.push_back([&view](const Point& p, PointId idx) {
+        view.setField(Id::BackgroundRadiation, idx, p.target.background_radiation);
+        view.setField(Id::IsPpsLocked, idx, p.target.is_pps_locked);
+    });
+    if (m_reflectanceAsIntensity) {
+        fields.push_back([this, &view](const Point& p, PointId idx) {
+            view.setField(Id::Intensity, idx, intensity(p.target.reflectance));
+        });
+    }
+
+    parallelFor(fields.size(), [&]()
+    {
+        return [&](std::size_t f)
+        {
+            for (std::size_t i = 0; i < points.size(); ++i)
+                fields[f](points[i], start + i);
+        };
+    }, 1);
 }
 
 
@@ -44,6 +44,7 @@
 #include <pdal/Dimension.hpp>
 #include <pdal/PointRef.hpp>
 #include <pdal/PointTable.hpp>
+#include <pdal/PointView.hpp>
 
 #include <riegl/scanlib.hpp>
 
@@ -70,12 +71,18 @@ public:
             bool isSyncToPps,
             bool m_reflectanceAsIntensity,
             float m_minReflectance,
-            float m_maxReflectance,
-            PointTableRef table);
+            float m_maxReflectance);
     virtual ~RxpPointcloud();
 
     bool endOfInput() const;
     bool readOne(PointRef& point);
+    // Decode up to count points into points, which is cleared first.
+    // Returns the number of points decoded, zero once the input is done.
+    point_count_t readBatch(std::vector<Point>& points, point_count_t count);
+    // Write points to the view starting at index start, which must already
+    // exist.  Each dimension is filled on its own thread.
+    void copyPoints(const std::vector<Point>& points, PointView& view,
+        PointId start) const;
 
     inline bool isSyncToPps() const
     {
@@ -88,6 +95,7 @@ protected:
 private:
     bool readSavedPoint(PointRef& point);
     void copyPoint(const Point& from, PointRef& to) const;
+    uint16_t intensity(float reflectance) const;
     void savePoints();
 
     bool m_syncToPps;
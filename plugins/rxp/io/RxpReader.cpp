@@ -40,7 +40,9 @@
 
 #include "RxpReader.hpp"
 
+#include <pdal/util/FileUtils.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 namespace pdal
 {
@@ -54,6 +56,9 @@ static PluginInfo const s_info
 
 CREATE_SHARED_STAGE(RxpReader, s_info)
 
+// Number of points decoded from the SDK before they are written to the view.
+const point_count_t BATCH_SIZE = 1 << 16;
+
 std::string RxpReader::getName() const { return s_info.name; }
 
 Dimension::IdList getRxpDimensions(bool syncToPps, bool reflectanceAsIntensity)
@@ -88,42 +93,123 @@ void RxpReader::addArgs(ProgramArgs& args)
     args.add("reflectance_as_intensity", "Reflectance as intensity", m_reflectanceAsIntensity, DEFAULT_REFLECTANCE_AS_INTENSITY);
     args.add("min_reflectance", "Minimum reflectance", m_minReflectance, DEFAULT_MIN_REFLECTANCE);
     args.add("max_reflectance", "Maximum reflectance", m_maxReflectance, DEFAULT_MAX_REFLECTANCE);
+    args.add("threads", "Number of scan positions to read concurrently. "
+        "The default is the number of cores.", m_threads);
 }
 
 void RxpReader::initialize()
 {
-    m_uri = m_isRdtp ? "rdtp://" + m_filename : "file:" + m_filename;
+    // A glob can name the scan positions of a project, each of which
+    // is read as a separate stream.
+    m_positions.clear();
+    if (!m_isRdtp)
+        m_positions = FileUtils::glob(m_filename);
+    if (m_positions.empty())
+        m_positions.push_back(m_filename);
 }
 
 
 void RxpReader::addDimensions(PointLayoutPtr layout)
 {
     layout->registerDims(getRxpDimensions(m_syncToPps, m_reflectanceAsIntensity));
+    if (m_positions.size() > 1)
+        layout->registerDim(Dimension::Id::OriginId);
 }
 
 
-void RxpReader::ready(PointTableRef table)
+void RxpReader::ready(PointTableRef)
 {
-    m_pointcloud.reset(new RxpPointcloud(m_uri, m_syncToPps, m_reflectanceAsIntensity, m_minReflectance, m_maxReflectance, table));
+    m_position = 0;
+    m_pointcloud.reset(openPosition(m_position));
 }
 
 
-point_count_t RxpReader::read(PointViewPtr view, point_count_t num)
+RxpPointcloud *RxpReader::openPosition(std::size_t position) const
+{
+    const std::string& filename = m_positions[position];
+    const std::string uri = m_isRdtp ? "rdtp://" + filename : "file:" + filename;
+    return new RxpPointcloud(uri, m_syncToPps, m_reflectanceAsIntensity,
+        m_minReflectance, m_maxReflectance);
+}
+
+
+// Read the points of one scan position into the view until the view holds
+// limit points.  Points are decoded in batches outside of the lock and
+// written to the view while holding it.
+point_count_t RxpReader::readPosition(PointViewPtr view, point_count_t limit,
+    std::size_t position, std::mutex *mutex)
 {
+    std::unique_ptr<RxpPointcloud> pointcloud(openPosition(position));
+    std::vector<Point> points;
     point_count_t numRead = 0;
-    PointRef point(view->point(0));
-    while (numRead < num && !m_pointcloud->endOfInput()) {
-        point.setPointId(numRead);
-        processOne(point);
-        ++numRead;
+    while (pointcloud->readBatch(points, BATCH_SIZE))
+    {
+        std::unique_lock<std::mutex> lock;
+        if (mutex)
+            lock = std::unique_lock<std::mutex>(*mutex);
+
+        const PointId start = view->size();
+        if (start >= limit)
+            break;
+        if (points.size() > limit - start)
+            points.erase(points.begin() + (limit - start), points.end());
+
+        for (PointId idx = start; idx < start + points.size(); ++idx)
+            view->setField(Dimension::Id::X, idx, 0.0);
+        pointcloud->copyPoints(points, *view, start);
+        if (m_positions.size() > 1)
+            for (PointId idx = start; idx < start + points.size(); ++idx)
+                view->setField(Dimension::Id::OriginId, idx, position);
+        numRead += points.size();
     }
     return numRead;
 }
 
 
+point_count_t RxpReader::read(PointViewPtr view, point_count_t num)
+{
+    // The stream opened by ready() is only used when streaming.
+    m_pointcloud.reset();
+
+    const PointId first = view->size();
+    const point_count_t limit =
+        (num > (std::numeric_limits<point_count_t>::max)() - first) ?
+        (std::numeric_limits<point_count_t>::max)() : first + num;
+
+    std::size_t threads(m_threads ? m_threads :
+        (std::size_t)(std::max)(std::thread::hardware_concurrency(), 1U));
+    threads = (std::min)(threads, m_positions.size());
+    if (threads > 1)
+    {
+        std::mutex mutex;
+        ThreadPool pool(threads, m_positions.size(), false);
+        for (std::size_t position = 0; position < m_positions.size(); ++position)
+            pool.add([this, view, limit, position, &mutex]()
+                { readPosition(view, limit, position, &mutex); });
+        pool.await();
+        if (pool.errors().size())
+            throw pdal_error(pool.errors().front());
+    }
+    else
+    {
+        for (std::size_t position = 0; position < m_positions.size(); ++position)
+            readPosition(view, limit, position, nullptr);
+    }
+    return view->size() - first;
+}
+
+
 bool RxpReader::processOne(PointRef& point)
 {
-    return m_pointcloud->readOne(point);
+    while (!m_pointcloud->readOne(point))
+    {
+        if (++m_position >= m_positions.size())
+            return false;
+        m_pointcloud.reset(openPosition(m_position));
+    }
+    if (m_positions.size() > 1)
+        point.setField(Dimension::Id::OriginId, m_position);
+    return true;
 }
 
 
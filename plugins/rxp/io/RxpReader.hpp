@@ -42,6 +42,7 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 
 #include <pdal/PointView.hpp>
 #include <pdal/Reader.hpp>
@@ -73,6 +74,8 @@ public:
         , m_reflectanceAsIntensity(DEFAULT_REFLECTANCE_AS_INTENSITY)
         , m_minReflectance(DEFAULT_MIN_REFLECTANCE)
         , m_maxReflectance(DEFAULT_MAX_REFLECTANCE)
+        , m_threads(0)
+        , m_position(0)
         , m_pointcloud()
     {}
 
@@ -87,12 +90,18 @@ private:
     virtual bool processOne(PointRef& point);
     virtual void done(PointTableRef table);
 
-    std::string m_uri;
+    RxpPointcloud *openPosition(std::size_t position) const;
+    point_count_t readPosition(PointViewPtr view, point_count_t num,
+        std::size_t position, std::mutex *mutex);
+
+    std::vector<std::string> m_positions;
     bool m_syncToPps;
     bool m_isRdtp;
     bool m_reflectanceAsIntensity;
     float m_minReflectance;
     float m_maxReflectance;
+    std::size_t m_threads;
+    std::size_t m_position;
     std::unique_ptr<RxpPointcloud> m_pointcloud;
 };
 
@@ -161,3 +161,22 @@ TEST(RxpReaderTest, testReflectanceAsIntensity)
     uint16_t intensity = view->getFieldAs<uint16_t>(Dimension::Id::Intensity, 0);
     EXPECT_EQ((std::numeric_limits<uint16_t>::max)(), intensity);
 }
+
+TEST(RxpReaderTest, testGlob)
+{
+    Options options;
+    options.add("filename", testDataPath() + "130501_232206_cut.rx?");
+    options.add("threads", 4);
+    RxpReader reader;
+    reader.setOptions(options);
+    PointTable table;
+    reader.prepare(table);
+    PointViewSet viewSet = reader.execute(table);
+    PointViewPtr view = *viewSet.begin();
+
+    // A single matching position is read as if it were named directly.
+    EXPECT_EQ(view->size(), 177208u);
+    EXPECT_FALSE(table.layout()->hasDim(Dimension::Id::OriginId));
+    checkPoint(view, 0, 2.2630672454833984, -0.038407701998949051, -1.3249952793121338, 342656.34233957872,
+            2.6865001276019029, 19.8699989, 5.70246553, 4, true, 1, 1);
+}
@@ -94,6 +94,7 @@ public:
     MetadataNode m_metadata;
     bool m_isCompressed;
     std::string m_compVersion;
+    std::vector<char> m_dictionary;
     std::vector<unsigned char> buf;
     size_t idx;
 
@@ -128,6 +129,7 @@ public:
         , m_connection(connection)
         , m_session(0)
         , m_statement(0)
+        , m_insertStatement(0)
         , m_position(-1)
     {
         m_log->get(LogLevel::Debug3) << "Setting up config " << std::endl;
@@ -140,6 +142,8 @@ public:
 
     ~SQLite()
     {
+        if (m_insertStatement)
+            sqlite3_finalize(m_insertStatement);
 
         if (m_session)
         {
@@ -368,6 +372,9 @@ public:
         return (int64_t)sqlite3_last_insert_rowid(m_session);
     }
 
+    // Inserts the records using the statement.  The prepared statement
+    // is kept so that repeated inserts with the same SQL don't have to
+    // prepare it again.
     void insert(std::string const& statement, records const& rs)
     {
         checkSession();
@@ -376,19 +383,27 @@ public:
 
         records::size_type rows = rs.size();
 
-        assert(!m_statement);
-        status = sqlite3_prepare_v2(m_session,
-                                    statement.c_str(),
-                                    static_cast<int>(statement.size()),
-                                    &m_statement,
-                                    0);
-        if (status != SQLITE_OK)
+        if (!m_insertStatement || statement != m_insertSql)
         {
-            error("insert preparation failed", "insert");
+            if (m_insertStatement)
+                sqlite3_finalize(m_insertStatement);
+            m_insertStatement = NULL;
+            m_insertSql.clear();
+
+            status = sqlite3_prepare_v2(m_session,
+                                        statement.c_str(),
+                                        static_cast<int>(statement.size()),
+                                        &m_insertStatement,
+                                        0);
+            if (status != SQLITE_OK)
+            {
+                error("insert preparation failed", "insert");
+            }
+            m_insertSql = statement;
         }
 
-        m_log->get(LogLevel::Debug3) << "Inserting '" << statement << "'"<<
-            std::endl;
+        m_log->get(LogLevel::Debug3) << "Inserting " << rows <<
+            " rows with '" << statement << "'"<< std::endl;
 
         for (records::size_type r = 0; r < rows; ++r)
         {
@@ -398,18 +413,18 @@ public:
                 const column& c = rs[r][pos];
                 if (c.null)
                 {
-                    status = sqlite3_bind_null(m_statement, pos+1);
+                    status = sqlite3_bind_null(m_insertStatement, pos+1);
                 }
                 else if (c.blobLen != 0)
                 {
-                    status = sqlite3_bind_blob(m_statement, pos+1,
+                    status = sqlite3_bind_blob(m_insertStatement, pos+1,
                                                &(c.blobBuf.front()),
                                                static_cast<int>(c.blobLen),
                                                SQLITE_STATIC);
                 }
                 else
                 {
-                    status = sqlite3_bind_text(m_statement, pos+1,
+                    status = sqlite3_bind_text(m_insertStatement, pos+1,
                                                c.data.c_str(),
                                                static_cast<int>(c.data.length()),
                                                SQLITE_STATIC);
@@ -417,6 +432,7 @@ public:
 
                 if (SQLITE_OK != status)
                 {
+                    sqlite3_reset(m_insertStatement);
                     std::ostringstream oss;
                     oss << "insert bind failed (row=" << r
                         <<", position=" << pos
@@ -425,21 +441,14 @@ public:
                 }
             }
 
-            status = sqlite3_step(m_statement);
-
+            status = sqlite3_step(m_insertStatement);
             if (status != SQLITE_DONE && status != SQLITE_ROW)
             {
+                sqlite3_reset(m_insertStatement);
                 error("insert step failed", "insert");
             }
+            sqlite3_reset(m_insertStatement);
         }
-
-        status = sqlite3_finalize(m_statement);
-        if (status != SQLITE_OK)
-        {
-            error("insert finalize failed", "insert");
-        }
-
-        m_statement = NULL;
     }
 
     bool loadSpatialite(const std::string& module_name="")
@@ -551,6 +560,8 @@ private:
     std::string m_connection;
     sqlite3* m_session;
     sqlite3_stmt* m_statement;
+    sqlite3_stmt* m_insertStatement;
+    std::string m_insertSql;
     records m_data;
     records::size_type m_position;
     std::map<std::string, int32_t> m_columns;
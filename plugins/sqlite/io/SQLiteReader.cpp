@@ -38,6 +38,7 @@
 #include <pdal/pdal_features.hpp>
 #include <pdal/PDALUtils.hpp>
 #include <pdal/compression/LazPerfCompression.hpp>
+#include <pdal/compression/ZstdCompression.hpp>
 #include <pdal/util/ProgramArgs.hpp>
 
 namespace pdal
@@ -170,6 +171,9 @@ void SQLiteReader::addDimensions(PointLayoutPtr layout)
 
     XMLSchema schema(s.data);
     m_patch->m_metadata = schema.getMetadata();
+    std::vector<uint8_t> dict = Utils::base64_decode(
+        m_patch->m_metadata.findChild("dictionary").value());
+    m_patch->m_dictionary.assign(dict.begin(), dict.end());
 
     loadSchema(layout, schema);
 }
@@ -202,7 +206,8 @@ point_count_t SQLiteReader::readPatch(PointViewPtr view, point_count_t numPts)
     int32_t position = columns.find("POINTS")->second;
 
     MetadataNode comp = m_patch->m_metadata.findChild("compression");
-    m_patch->m_isCompressed = Utils::iequals(comp.value(), "lazperf");
+    const bool zstd = Utils::iequals(comp.value(), "zstd");
+    m_patch->m_isCompressed = zstd || Utils::iequals(comp.value(), "lazperf");
     m_patch->m_compVersion = m_patch->m_metadata.findChild("version").value();
 
     position = columns.find("NUM_POINTS")->second;
@@ -222,27 +227,60 @@ point_count_t SQLiteReader::readPatch(PointViewPtr view, point_count_t numPts)
 
     point_count_t numRead = 0;
     PointId nextId = view->size();
-    if (m_patch->m_isCompressed)
+    if (zstd)
     {
-        size_t bufsize = 0;
-#ifdef PDAL_HAVE_LAZPERF
-        auto cb = [this, view, &nextId, &numRead, &count]
-            (char *buf, size_t bufsize)
+#ifdef PDAL_HAVE_ZSTD
+        std::vector<char> data;
+        ZstdDecompressor decompressor([&data](char *buf, size_t bufsize)
+            { data.insert(data.end(), buf, buf + bufsize); },
+            m_patch->m_dictionary);
+        const std::vector<unsigned char>& blob = (*r)[position].blobBuf;
+        decompressor.decompress(reinterpret_cast<const char *>(blob.data()),
+            blob.size());
+        decompressor.done();
+
+        if (data.size() < count * packedPointSize())
+            throwError("Decompressed patch is too small.");
+        const char *pos = data.data();
+        while (numRead < numPts && count > 0)
         {
-            writePoint(*view.get(),  nextId, buf);
+            writePoint(*view.get(), nextId, pos);
+
+            pos += packedPointSize();
             if (m_cb)
                 m_cb(*view, nextId);
             nextId++;
             numRead++;
             count--;
-        };
-
+        }
+#else
+        throwError("Can't decompress without Zstd.");
+#endif
+    }
+    else if (m_patch->m_isCompressed)
+    {
+        size_t bufsize = 0;
+#ifdef PDAL_HAVE_LAZPERF
         const char *buf = reinterpret_cast<const char *>(
             (*r)[position].blobBuf.data());
         bufsize = (*r)[position].blobBuf.size();
         count = (std::min)(count, size_t(numPts));
-        LazPerfDecompressor(cb, dbDimTypes(), count).
-            decompress(buf, bufsize);
+
+        LazPerfBlockDecompressor decompressor(dbDimTypes());
+        std::vector<char> points(count * decompressor.pointSize());
+        decompressor.decompress(buf, bufsize, points.data(), count);
+
+        const char *pos = points.data();
+        while (count > 0)
+        {
+            writePoint(*view.get(), nextId, pos);
+            if (m_cb)
+                m_cb(*view, nextId);
+            pos += decompressor.pointSize();
+            nextId++;
+            numRead++;
+            count--;
+        }
 
         // Set the data into the patch.
 
@@ -38,11 +38,16 @@
 
 #include <pdal/PointView.hpp>
 #include <pdal/compression/LazPerfCompression.hpp>
+#include <pdal/compression/ZstdCompression.hpp>
+#include <pdal/util/Algorithm.hpp>
 #include <pdal/util/FileUtils.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
+#include <chrono>
 #include <iomanip>
 #include <sstream>
+#include <thread>
 
 #include <gdal.h>
 #include <ogr_api.h>
@@ -69,6 +74,13 @@ SQLiteWriter::SQLiteWriter() :
 {}
 
 
+SQLiteWriter::~SQLiteWriter()
+{
+    // Outstanding encoding tasks reference this writer.
+    m_pool.reset();
+}
+
+
 void SQLiteWriter::addArgs(ProgramArgs& args)
 {
     DbWriter::doAddArgs(args);
@@ -84,8 +96,11 @@ void SQLiteWriter::addArgs(ProgramArgs& args)
     args.add("srid", "SRID", m_srid, 4326U);
     args.add("pcid", "PCID", m_pcId);
     args.add("is3d", "Whether a Z dimension should be written", m_is3d);
-    args.add("compression", "Whether blocks should be compressed",
-        m_doCompression);
+    args.add("compression", "Compression of blocks: 'lazperf' (or 'true'), "
+        "'zstd' or 'none' (or 'false')", m_compression, "none");
+    args.add("zstd_dictionary", "File containing a zstd dictionary used to "
+        "compress blocks", m_zstdDictionaryFile);
+    args.add("zstd_level", "Zstd compression level", m_zstdLevel, 15);
     args.add("overwrite", "Whether existing data should be overwritten",
         m_overwrite);
     args.add("pre_sql", "SQL to be executed before running the translation, "
@@ -94,11 +109,32 @@ void SQLiteWriter::addArgs(ProgramArgs& args)
         "or the name of a file containing such SQL", m_postSql);
     args.add("clound_boundary_wkt", "Boundary of points to be written",
         m_cloudBoundary);
+    args.add("journal_mode", "SQLite journal mode (e.g. 'wal')",
+        m_journalMode);
+    args.add("synchronous", "SQLite synchronous setting: 'off', 'normal', "
+        "'full' or 'extra'", m_synchronous);
+    args.add("batch_size", "Number of blocks inserted at once", m_batchSize,
+        size_t(100));
+    args.add("threads", "Number of threads used to compress blocks.  "
+        "The default is the number of cores.", m_threads);
 }
 
 
 void SQLiteWriter::initialize()
 {
+    m_journalMode = Utils::tolower(m_journalMode);
+    m_synchronous = Utils::tolower(m_synchronous);
+    const std::vector<std::string> journalModes
+        { "delete", "truncate", "persist", "memory", "wal", "off" };
+    const std::vector<std::string> syncModes
+        { "off", "normal", "full", "extra" };
+    if (m_journalMode.size() && !Utils::contains(journalModes, m_journalMode))
+        throwError("Invalid journal_mode '" + m_journalMode + "'.");
+    if (m_synchronous.size() && !Utils::contains(syncModes, m_synchronous))
+        throwError("Invalid synchronous setting '" + m_synchronous + "'.");
+    if (m_batchSize == 0)
+        throwError("Option 'batch_size' must be greater than 0.");
+
     try
     {
         log()->get(LogLevel::Debug) << "Connection: '" << m_connection <<
@@ -117,6 +153,10 @@ void SQLiteWriter::initialize()
             m_session->initSpatialiteMetadata();
         }
 
+        if (m_journalMode.size())
+            m_session->execute("PRAGMA journal_mode=" + m_journalMode);
+        if (m_synchronous.size())
+            m_session->execute("PRAGMA synchronous=" + m_synchronous);
     }
     catch (pdal_error const& e)
     {
@@ -124,7 +164,35 @@ void SQLiteWriter::initialize()
             std::string(e.what()));
     }
 
-    m_patch = PatchPtr(new Patch());
+    size_t threads = m_threads ? m_threads :
+        (size_t)(std::max)(std::thread::hardware_concurrency(), 1U);
+    m_pool.reset(new ThreadPool(threads, threads, false));
+
+    m_compression = Utils::tolower(m_compression);
+    if (m_compression == "true")
+        m_compression = "lazperf";
+    else if (m_compression == "false" || m_compression == "none")
+        m_compression.clear();
+    if (m_compression.size() && m_compression != "lazperf" &&
+        m_compression != "zstd")
+        throwError("Invalid compression '" + m_compression + "'.  Must be "
+            "'lazperf', 'zstd' or 'none'.");
+#ifndef PDAL_HAVE_ZSTD
+    if (m_compression == "zstd")
+        throwError("Can't compress with zstd.  PDAL not built with Zstd.");
+#endif
+
+    if (m_zstdDictionaryFile.size())
+    {
+        if (m_compression != "zstd")
+            throwError("Option 'zstd_dictionary' requires zstd "
+                "compression.");
+        std::string dict = FileUtils::readFileIntoString(m_zstdDictionaryFile);
+        if (dict.empty())
+            throwError("Unable to read zstd dictionary '" +
+                m_zstdDictionaryFile + "'.");
+        m_zstdDictionary.assign(dict.begin(), dict.end());
+    }
 }
 
 
@@ -372,6 +440,11 @@ bool SQLiteWriter::IsValidGeometryWKT(std::string const& input) const
 
 void SQLiteWriter::done(PointTableRef table)
 {
+    insertTiles(0);
+    if (m_rows.size())
+        m_session->insert(m_block_insert_query.str(), m_rows);
+    m_rows.clear();
+
     if (m_doCreateIndex)
     {
         CreateIndexes(m_block_table, "extent", m_is3d);
@@ -409,12 +482,18 @@ void SQLiteWriter::CreateCloud()
         Utils::tolower(m_block_table) << "',?) ";
 
     MetadataNode m;
-    if (m_doCompression)
+    if (m_compression.size())
     {
         Metadata metadata;
         m = metadata.getNode();
-        m.add("compression", "lazperf");
+        m.add("compression", m_compression);
         m.add("version", "1.0");
+        // The dictionary is needed to read the blocks, so it's stored
+        // with the schema of the cloud.
+        if (m_zstdDictionary.size())
+            m.add("dictionary", Utils::base64_encode(
+                (const unsigned char *)m_zstdDictionary.data(),
+                m_zstdDictionary.size()));
     }
     XMLSchema schema(dbDimTypes(), m);
     std::string xml = schema.xml();
@@ -455,86 +534,113 @@ void SQLiteWriter::CreateCloud()
 
 void SQLiteWriter::writeTile(const PointViewPtr view)
 {
-    using namespace std;
+    // Compress the tile in the pool.  The view is held by the task until
+    // it's done.
+    using Task = std::packaged_task<row()>;
+    int32_t blockId = m_block_id++;
+    std::shared_ptr<Task> task(new Task([this, view, blockId]()
+        { return encodeTile(*view, blockId); }));
+    m_tiles.push_back(task->get_future());
+    m_pool->add([task](){ (*task)(); });
+
+    insertTiles(2 * m_pool->numThreads());
+}
 
-    if (m_doCompression)
-    {
-#ifdef PDAL_HAVE_LAZPERF
-        XMLDimList xmlDims = dbDimTypes();
-        DimTypeList dimTypes;
-        for (XMLDim& xmlDim : xmlDims)
-            dimTypes.push_back(xmlDim.m_dimType);
 
-        auto cb = [this](char *buf, size_t bufsize)
-        {
-            m_patch->putBytes(reinterpret_cast<unsigned char *>(buf), bufsize);
-        };
-        LazPerfCompressor compressor(cb, dimTypes);
+// Collect encoded tiles in order until no more than 'maxPending' remain,
+// taking any that are already finished as well.  Rows are inserted
+// 'batch_size' at a time.
+void SQLiteWriter::insertTiles(size_t maxPending)
+{
+    while (m_tiles.size())
+    {
+        std::future<row>& f = m_tiles.front();
+        if (m_tiles.size() <= maxPending &&
+            f.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            break;
 
         try
         {
-            std::vector<char> outbuf(packedPointSize());
-            for (PointId idx = 0; idx < view->size(); idx++)
-            {
-                size_t size = readPoint(*view.get(), idx, outbuf.data());
-                // Read the data and write to the patch.
-                compressor.compress(outbuf.data(), size);
-            }
+            m_rows.push_back(f.get());
         }
-        catch (pdal_error&)
+        catch (const pdal_error& err)
         {
-            compressor.done();
-            throw;
+            throwError(err.what());
         }
-        compressor.done();
-#else
-        throwError("Can't compress without LAZperf.");
-#endif
+        m_tiles.pop_front();
 
-        size_t viewSize = view->size() * view->pointSize();
-        double percent = (double) m_patch->byte_size()/(double) viewSize;
-        percent = percent * 100;
-        log()->get(LogLevel::Debug3) << "Compressing tile by " <<
-            std::setprecision(2) << (100 - percent) << "%" << std::endl;
+        if (m_rows.size() >= m_batchSize)
+        {
+            m_session->insert(m_block_insert_query.str(), m_rows);
+            m_rows.clear();
+        }
     }
-    else
+}
+
+
+// Build the row for a block of points.  This runs on a pool thread.
+row SQLiteWriter::encodeTile(const PointView& view, int32_t blockId)
+{
+    std::vector<char> storage(view.size() * packedPointSize());
+    char *pos = storage.data();
+    for (PointId idx = 0; idx < view.size(); idx++)
+        pos += readPoint(view, idx, pos);
+    size_t size = pos - storage.data();
+
+    std::vector<char> comp;
+    if (m_compression == "zstd")
     {
-        std::vector<char> storage(packedPointSize());
+#ifdef PDAL_HAVE_ZSTD
+        CompressionOptions opts;
+        opts.level = m_zstdLevel;
+        opts.dictionary = m_zstdDictionary;
 
-        for (PointId idx = 0; idx < view->size(); idx++)
+        auto cb = [&comp](char *buf, size_t bufsize)
         {
-            size_t size = readPoint(*view.get(), idx, storage.data());
-            m_patch->putBytes((const unsigned char *)storage.data(), size);
-        }
-        log()->get(LogLevel::Debug3) << "uncompressed size: " <<
-            m_patch->byte_size() << std::endl;
+            comp.insert(comp.end(), buf, buf + bufsize);
+        };
+        ZstdCompressor compressor(cb, opts);
+
+        // Tiles are small, so they're compressed in one piece.
+        compressor.compress(storage.data(), size);
+        compressor.done();
+#endif
     }
+    else if (m_compression == "lazperf")
+    {
+#ifdef PDAL_HAVE_LAZPERF
+        XMLDimList xmlDims = dbDimTypes();
+        DimTypeList dimTypes;
+        for (XMLDim& xmlDim : xmlDims)
+            dimTypes.push_back(xmlDim.m_dimType);
 
-    records rs;
-    row r;
+        LazPerfBlockCompressor(dimTypes).compress(storage.data(),
+            view.size(), comp);
+#else
+        throw pdal_error("Can't compress without LAZperf.");
+#endif
+    }
+    else
+    {
+        storage.resize(size);
+        comp.swap(storage);
+    }
 
     uint32_t precision(9);
     BOX3D b;
-    view->calculateBounds(b);
+    view.calculateBounds(b);
     std::string bounds = b.toWKT(precision); // polygons are only 2d, not cubes
-
     std::string box = b.toBox(precision);
-    log()->get(LogLevel::Debug3) << "extent: " << bounds << std::endl;
-    log()->get(LogLevel::Debug3) << "bbox: " << box << std::endl;
 
+    row r;
     r.push_back(column(m_obj_id));
-    r.push_back(column(m_block_id));
-    r.push_back(column(view->size()));
-    r.push_back(blob(reinterpret_cast<const char *>(m_patch->getBytes()),
-        m_patch->byte_size()));
+    r.push_back(column(blockId));
+    r.push_back(column(view.size()));
+    r.push_back(blob(comp.data(), comp.size()));
     r.push_back(column(bounds));
     r.push_back(column(m_srid));
     r.push_back(column(box));
-    rs.push_back(r);
-    m_session->insert(m_block_insert_query.str(), rs);
-    m_block_id++;
-    m_patch->clear();
-
+    return r;
 }
 
 } // namespaces
@@ -34,6 +34,9 @@
 
 #pragma once
 
+#include <deque>
+#include <future>
+
 #include <pdal/DbWriter.hpp>
 #include <pdal/StageFactory.hpp>
 #include "SQLiteCommon.hpp"
@@ -41,11 +44,13 @@
 namespace pdal
 {
 
+class ThreadPool;
 
 class PDAL_DLL SQLiteWriter : public DbWriter
 {
 public:
     SQLiteWriter();
+    ~SQLiteWriter();
     std::string getName() const;
 
 private:
@@ -60,6 +65,8 @@ private:
 
     void writeInit();
     void writeTile(const PointViewPtr view);
+    row encodeTile(const PointView& view, int32_t blockId);
+    void insertTiles(size_t maxPending);
     void CreateBlockTable();
     void CreateCloudTable();
     bool CheckTableExists(std::string const& name);
@@ -92,9 +99,18 @@ private:
     std::string m_cloudBoundary;
     long m_pcId;
     bool m_is3d;
-    bool m_doCompression;
+    std::string m_compression;
+    std::string m_zstdDictionaryFile;
+    int m_zstdLevel;
+    std::vector<char> m_zstdDictionary;
     bool m_overwrite;
-    PatchPtr m_patch;
+    std::string m_journalMode;
+    std::string m_synchronous;
+    size_t m_batchSize;
+    size_t m_threads;
+    std::unique_ptr<ThreadPool> m_pool;
+    std::deque<std::future<row>> m_tiles;
+    records m_rows;
 };
 
 } // namespaces
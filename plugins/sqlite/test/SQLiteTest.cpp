@@ -79,7 +79,7 @@ Options getReaderOptions()
     return options;
 }
 
-void testReadWrite(bool compression, bool scaling)
+void testReadWrite(const std::string& compression, bool scaling)
 {
     FileUtils::deleteFile(tempFilename);
 
@@ -139,24 +139,88 @@ void testReadWrite(bool compression, bool scaling)
 
 TEST(SQLiteTest, readWrite)
 {
-    testReadWrite(false, false);
+    testReadWrite("none", false);
 }
 
 TEST(SQLiteTest, readWriteCompress)
 {
     if (Config::hasFeature(Config::Feature::LAZPERF))
-        testReadWrite(true, false);
+        testReadWrite("lazperf", false);
 }
 
 TEST(SQLiteTest, readWriteScale)
 {
-    testReadWrite(false, true);
+    testReadWrite("none", true);
 }
 
 TEST(SQLiteTest, readWriteCompressScale)
 {
     if (Config::hasFeature(Config::Feature::LAZPERF))
-        testReadWrite(true, true);
+        testReadWrite("lazperf", true);
+}
+
+TEST(SQLiteTest, readWriteZstd)
+{
+    if (Config::hasFeature(Config::Feature::ZSTD))
+        testReadWrite("zstd", false);
+}
+
+TEST(SQLiteTest, readWriteZstdScale)
+{
+    if (Config::hasFeature(Config::Feature::ZSTD))
+        testReadWrite("zstd", true);
+}
+
+TEST(SQLiteTest, readWriteBatched)
+{
+    FileUtils::deleteFile(tempFilename);
+
+    Options writerOptions = getWriterOptions();
+    writerOptions.add("journal_mode", "wal");
+    writerOptions.add("synchronous", "off");
+    writerOptions.add("batch_size", 2);
+    writerOptions.add("threads", 3);
+
+    StageFactory f;
+    {
+    Options lasReadOpts;
+    lasReadOpts.add("filename", Support::datapath("las/1.2-with-color.las"));
+    lasReadOpts.add("count", 11);
+
+    LasReader reader;
+    reader.setOptions(lasReadOpts);
+
+    Stage* chipper(f.createStage("filters.chipper"));
+    Options chipperOpts;
+    chipperOpts.add("capacity", 3);
+    chipper->setOptions(chipperOpts);
+    chipper->setInput(reader);
+
+    Stage* sqliteWriter(f.createStage("writers.sqlite"));
+    sqliteWriter->setOptions(writerOptions);
+    sqliteWriter->setInput(*chipper);
+
+    PointTable table;
+    sqliteWriter->prepare(table);
+    sqliteWriter->execute(table);
+    }
+
+    Stage* sqliteReader(f.createStage("readers.sqlite"));
+    sqliteReader->setOptions(getReaderOptions());
+
+    PointTable table2;
+    sqliteReader->prepare(table2);
+    PointViewSet viewSet = sqliteReader->execute(table2);
+    EXPECT_EQ(viewSet.size(), 1U);
+    PointViewPtr view = *viewSet.begin();
+    EXPECT_EQ(view->size(), 11U);
+
+    // Blocks are in chipper order, so compare the sum of the values.
+    uint32_t sum = 0;
+    for (PointId idx = 0; idx < view->size(); idx++)
+        sum += view->getFieldAs<uint16_t>(Dimension::Id::Red, idx);
+    EXPECT_EQ(sum, 68U + 54 + 112 + 178 + 134 + 99 + 90 + 106 + 106 + 100 +
+        64);
 }
 
 TEST(SQLiteTest, Issue895)
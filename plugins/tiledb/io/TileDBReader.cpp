@@ -33,6 +33,10 @@
 ****************************************************************************/
 
 #include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include <pdal/util/ThreadPool.hpp>
 
 #include "TileDBReader.hpp"
 
@@ -48,6 +52,15 @@ static PluginInfo const s_info
 CREATE_SHARED_STAGE(TileDBReader, s_info)
 std::string TileDBReader::getName() const { return s_info.name; }
 
+TileDBReader::TileDBReader() : m_empty(false), m_started(false), m_cur(0)
+{}
+
+TileDBReader::~TileDBReader()
+{
+    // An outstanding query writes into our buffers.
+    waitPending();
+}
+
 Dimension::Type getPdalType(tiledb_datatype_t t)
 {
     switch (t)
@@ -94,6 +107,8 @@ void TileDBReader::addArgs(ProgramArgs& args)
     args.add("chunk_size", "TileDB read chunk size", m_chunkSize,
         point_count_t(1000000));
     args.add("stats", "Dump TileDB query stats to stdout", m_stats, false);
+    args.add("threads", "Number of threads used to convert query results "
+        "into points.  The default is the number of cores.", m_threads);
     args.add("bbox3d", "Bounding box subarray to read from TileDB in format "
         "([minx, maxx], [miny, maxy], [minz, maxz])", m_bbox);
 }
@@ -157,44 +172,44 @@ void TileDBReader::addDimensions(PointLayoutPtr layout)
 }
 
 template <typename T>
-void TileDBReader::setQueryBuffer(const DimInfo& di)
+void TileDBReader::setQueryBuffer(const DimInfo& di, Buffer& buf)
 {
-    m_query->set_buffer(di.m_name, di.m_buffer->get<T>(), di.m_buffer->count());
+    m_query->set_buffer(di.m_name, buf.get<T>(), buf.count());
 }
 
-void TileDBReader::setQueryBuffer(const DimInfo& di)
+void TileDBReader::setQueryBuffer(const DimInfo& di, Buffer& buf)
 {
     switch(di.m_tileType)
     {
     case TILEDB_INT8:
-        setQueryBuffer<int8_t>(di);
+        setQueryBuffer<int8_t>(di, buf);
         break;
     case TILEDB_UINT8:
-        setQueryBuffer<uint8_t>(di);
+        setQueryBuffer<uint8_t>(di, buf);
         break;
     case TILEDB_INT16:
-        setQueryBuffer<int16_t>(di);
+        setQueryBuffer<int16_t>(di, buf);
         break;
     case TILEDB_UINT16:
-        setQueryBuffer<uint16_t>(di);
+        setQueryBuffer<uint16_t>(di, buf);
         break;
     case TILEDB_INT32:
-        setQueryBuffer<int32_t>(di);
+        setQueryBuffer<int32_t>(di, buf);
         break;
     case TILEDB_UINT32:
-        setQueryBuffer<uint32_t>(di);
+        setQueryBuffer<uint32_t>(di, buf);
         break;
     case TILEDB_INT64:
-        setQueryBuffer<int64_t>(di);
+        setQueryBuffer<int64_t>(di, buf);
         break;
     case TILEDB_UINT64:
-        setQueryBuffer<uint64_t>(di);
+        setQueryBuffer<uint64_t>(di, buf);
         break;
     case TILEDB_FLOAT32:
-        setQueryBuffer<float>(di);
+        setQueryBuffer<float>(di, buf);
         break;
     case TILEDB_FLOAT64:
-        setQueryBuffer<double>(di);
+        setQueryBuffer<double>(di, buf);
         break;
     default:
         throwError("TileDB dimension '" + di.m_name + "' can't be mapped "
@@ -202,102 +217,130 @@ void TileDBReader::setQueryBuffer(const DimInfo& di)
     }
 }
 
-void TileDBReader::ready(PointTableRef)
+void TileDBReader::ready(PointTableRef table)
 {
     int numDims = m_array->schema().domain().dimensions().size();
 
+    // Don't fetch attributes that have been removed from the layout.
+    PointLayoutPtr layout = table.layout();
+    m_dims.erase(std::remove_if(m_dims.begin(), m_dims.end(),
+        [layout](const DimInfo& di)
+        {
+            return di.m_dimCategory == DimCategory::Attribute &&
+                !layout->hasDim(di.m_id);
+        }), m_dims.end());
+
     m_query.reset(new tiledb::Query(*m_ctx, *m_array));
 
-    // Build the buffer for the dimensions.
+    // Build two sets of buffers so that one can be filled by the query
+    // while the other is being converted.  All dimensions share the
+    // first buffer.
     auto it = std::find_if(m_dims.begin(), m_dims.end(),
         [](DimInfo& di){ return di.m_dimCategory == DimCategory::Dimension; });
+    tiledb_datatype_t coordType = it->m_tileType;
 
-    DimInfo& di = *it;
-    Buffer *dimBuf = new Buffer(di.m_tileType, m_chunkSize * numDims);
-    m_query->set_coordinates(dimBuf->get<double>(), dimBuf->count());
-    m_buffers.push_back(std::unique_ptr<Buffer>(dimBuf));
-
-    for (DimInfo& di : m_dims)
+    for (Results& results : m_results)
     {
-        // All dimensions use the same buffer.
-        if (di.m_dimCategory == DimCategory::Dimension)
-            di.m_buffer = dimBuf;
-        else
+        results = Results();
+        results.m_buffers.emplace_back(
+            new Buffer(coordType, m_chunkSize * numDims));
+        for (DimInfo& di : m_dims)
         {
-            std::unique_ptr<Buffer> dimBuf(
-                new Buffer(di.m_tileType, m_chunkSize));
-            di.m_buffer = dimBuf.get();
-            m_buffers.push_back(std::move(dimBuf));
-            setQueryBuffer(di);
+            if (di.m_dimCategory == DimCategory::Dimension)
+                di.m_bufIdx = 0;
+            else
+            {
+                di.m_bufIdx = results.m_buffers.size();
+                results.m_buffers.emplace_back(
+                    new Buffer(di.m_tileType, m_chunkSize));
+            }
         }
     }
+    m_started = false;
+    m_cur = 0;
 
 // Set the extent of the query.
-    if (!m_bbox.empty())
-    {
-        if (numDims == 2)
-            m_query->set_subarray({m_bbox.minx, m_bbox.minx,
-                m_bbox.miny, m_bbox.maxy});
-        else
-            m_query->set_subarray({m_bbox.minx, m_bbox.minx,
-                m_bbox.miny, m_bbox.maxy, m_bbox.minz, m_bbox.maxz});
-    }
-    else
+    BOX3D box(m_bbox);
+    if (box.empty())
     {
         // get extents
-        std::vector<double> subarray;
         auto domain = m_array->non_empty_domain<double>();
-        for (const auto& kv : domain)
+        box.minx = domain[0].second.first;
+        box.maxx = domain[0].second.second;
+        box.miny = domain[1].second.first;
+        box.maxy = domain[1].second.second;
+        if (numDims > 2)
         {
-            subarray.push_back(kv.second.first);
-            subarray.push_back(kv.second.second);
+            box.minz = domain[2].second.first;
+            box.maxz = domain[2].second.second;
         }
-        m_query->set_subarray(subarray);
     }
+
+    // Points outside the query bounds will be dropped downstream, so
+    // don't fetch them.
+    m_empty = false;
+    if (m_queryBounds.valid())
+    {
+        if (numDims == 2)
+        {
+            box.minz = m_queryBounds.minz;
+            box.maxz = m_queryBounds.maxz;
+        }
+        m_empty = !box.overlaps(m_queryBounds);
+        box.clip(m_queryBounds);
+    }
+
+    if (m_empty)
+        log()->get(LogLevel::Debug) << "No points in query bounds." <<
+            std::endl;
+    else if (numDims == 2)
+        m_query->set_subarray({box.minx, box.maxx, box.miny, box.maxy});
+    else
+        m_query->set_subarray({box.minx, box.maxx, box.miny, box.maxy,
+            box.minz, box.maxz});
 }
 
 namespace
 {
 
-bool setField(PointViewPtr view, TileDBReader::DimInfo di, PointId idx,
-    size_t bufOffset)
+bool setField(PointRef& point, const TileDBReader::DimInfo& di,
+    TileDBReader::Buffer& buf, size_t bufOffset)
 {
     // Span is a count of the number of elements in each set of data, so
     // offset is a count of item types.  We're doing pointer arithmetic
     // below, so the size of the type is accounted for.
     bufOffset = bufOffset * di.m_span + di.m_offset;
-    TileDBReader::Buffer& buf = *di.m_buffer;
     switch (di.m_type)
     {
     case Dimension::Type::Signed8:
-        view->setField(di.m_id, idx, *(buf.get<int8_t>() + bufOffset));
+        point.setField(di.m_id, *(buf.get<int8_t>() + bufOffset));
         break;
     case Dimension::Type::Unsigned8:
-        view->setField(di.m_id, idx, *(buf.get<uint8_t>() + bufOffset));
+        point.setField(di.m_id, *(buf.get<uint8_t>() + bufOffset));
         break;
     case Dimension::Type::Signed16:
-        view->setField(di.m_id, idx, *(buf.get<int16_t>() + bufOffset));
+        point.setField(di.m_id, *(buf.get<int16_t>() + bufOffset));
         break;
     case Dimension::Type::Unsigned16:
-        view->setField(di.m_id, idx, *(buf.get<uint16_t>() + bufOffset));
+        point.setField(di.m_id, *(buf.get<uint16_t>() + bufOffset));
         break;
     case Dimension::Type::Signed32:
-        view->setField(di.m_id, idx, *(buf.get<int32_t>() + bufOffset));
+        point.setField(di.m_id, *(buf.get<int32_t>() + bufOffset));
         break;
     case Dimension::Type::Unsigned32:
-        view->setField(di.m_id, idx, *(buf.get<uint32_t>() + bufOffset));
+        point.setField(di.m_id, *(buf.get<uint32_t>() + bufOffset));
         break;
     case Dimension::Type::Signed64:
-        view->setField(di.m_id, idx, *(buf.get<int64_t>() + bufOffset));
+        point.setField(di.m_id, *(buf.get<int64_t>() + bufOffset));
         break;
     case Dimension::Type::Unsigned64:
-        view->setField(di.m_id, idx, *(buf.get<uint64_t>() + bufOffset));
+        point.setField(di.m_id, *(buf.get<uint64_t>() + bufOffset));
         break;
     case Dimension::Type::Float:
-        view->setField(di.m_id, idx, *(buf.get<float>() + bufOffset));
+        point.setField(di.m_id, *(buf.get<float>() + bufOffset));
         break;
     case Dimension::Type::Double:
-        view->setField(di.m_id, idx, *(buf.get<double>() + bufOffset));
+        point.setField(di.m_id, *(buf.get<double>() + bufOffset));
         break;
     default:
         return false;
@@ -307,62 +350,185 @@ bool setField(PointViewPtr view, TileDBReader::DimInfo di, PointId idx,
 
 } // unnamed namespace
 
-point_count_t TileDBReader::read(PointViewPtr view, point_count_t count)
+void TileDBReader::submit(Results& results, bool async)
 {
-    PointId idx = view->size();
-    point_count_t numRead = 0;
-
-    tiledb::Query::Status status;
-    do
+    // Point the query at the buffers of this result set.
+    for (const DimInfo& di : m_dims)
+        if (di.m_dimCategory == DimCategory::Attribute)
+            setQueryBuffer(di, *results.m_buffers[di.m_bufIdx]);
+    Buffer& coords = *results.m_buffers[0];
+    m_query->set_coordinates(coords.get<double>(), coords.count());
+
+    if (m_stats)
+        tiledb::Stats::enable();
+    if (async)
     {
-        if (m_stats)
-            tiledb::Stats::enable();
+        std::shared_ptr<std::promise<void>> done(new std::promise<void>);
+        m_pending = done->get_future();
+        m_query->submit_async([done](){ done->set_value(); });
+    }
+    else
         m_query->submit();
-        if (m_stats)
-        {
-            tiledb::Stats::dump(stdout);
-            tiledb::Stats::disable();
-        }
+}
+
+void TileDBReader::waitPending()
+{
+    if (!m_pending.valid())
+        return;
+
+    // Poll the status as well as waiting for the callback in case a
+    // failed query doesn't complete normally.
+    while (m_pending.wait_for(std::chrono::milliseconds(10)) !=
+            std::future_status::ready &&
+        m_query->query_status() != tiledb::Query::Status::FAILED)
+    {}
+    m_pending = std::future<void>();
+}
+
+void TileDBReader::collect(Results& results)
+{
+    waitPending();
+    if (m_stats)
+    {
+        tiledb::Stats::dump(stdout);
+        tiledb::Stats::disable();
+    }
+
+    // The result buffer count represents the total number of items
+    // returned by the query for dimensions.  So if there are three
+    // dimensions, the number of points returned is the buffer count
+    // divided by the number of dimensions.
+    results.m_status = m_query->query_status();
+    results.m_count = m_query->result_buffer_elements()[TILEDB_COORDS].second /
+        m_array->schema().domain().dimensions().size();
+    results.m_pos = 0;
+
+    if (results.m_status == tiledb::Query::Status::FAILED)
+        throwError("Unable to read from " + m_arrayName);
+    if (results.m_status == tiledb::Query::Status::INCOMPLETE &&
+            results.m_count == 0)
+        throwError("Need to increase chunk_size for reader.");
+}
 
-        status = m_query->query_status();
+// Make the next set of results current and start fetching the set after
+// it into the other buffers.  Returns false when the query is exhausted.
+bool TileDBReader::nextResults()
+{
+    if (!m_started)
+    {
+        m_started = true;
+        m_cur = 0;
+        submit(m_results[m_cur], false);
+    }
+    else
+    {
+        if (m_results[m_cur].m_status != tiledb::Query::Status::INCOMPLETE)
+            return false;
+        m_cur = 1 - m_cur;
+    }
+    collect(m_results[m_cur]);
 
-        // The result buffer count represents the total number of items
-        // returned by the query for dimensions.  So if there are three
-        // dimensions, the number of points returned is the buffer count
-        // divided by the number of dimensions.
-        size_t result_num =
-            (int)m_query->result_buffer_elements()[TILEDB_COORDS].second /
-            m_array->schema().domain().dimensions().size();
+    if (m_results[m_cur].m_status == tiledb::Query::Status::INCOMPLETE)
+        submit(m_results[1 - m_cur], true);
+    return true;
+}
 
-        if (status == tiledb::Query::Status::INCOMPLETE && result_num == 0)
-            throwError("Need to increase chunk_size for reader.");
+void TileDBReader::convert(PointView& view, Results& results,
+    point_count_t count)
+{
+    const PointId start = view.size();
+    const size_t first = results.m_pos;
+    count = (std::min)(count, (point_count_t)(results.m_count - first));
 
-        for (size_t i = 0; i < result_num; ++i)
+    auto fill = [&view, &results, start, first, count](const DimInfo& di)
+    {
+        Buffer& buf = *results.m_buffers[di.m_bufIdx];
+        PointRef point(view, start);
+        for (PointId i = 0; i < count; ++i)
         {
-            for (DimInfo& dim : m_dims)
-                if (!setField(view, dim, idx, i))
-                    throwError("Invalid dimension type when setting data.");
+            point.setPointId(start + i);
+            if (!setField(point, di, buf, first + i))
+                throw pdal_error("Invalid dimension type when setting data.");
+        }
+    };
 
-            // progess callback
-            if (m_cb)
-                m_cb(*view, idx);
+    // Adding points to a view isn't thread-safe, so the first dimension
+    // is set serially to create the points.  The rest are independent.
+    fill(m_dims.front());
+    if (m_pool)
+    {
+        for (auto it = m_dims.begin() + 1; it != m_dims.end(); ++it)
+        {
+            const DimInfo& di = *it;
+            m_pool->add([&fill, &di](){ fill(di); });
+        }
+        m_pool->await();
+        if (m_pool->errors().size())
+            throwError(m_pool->errors().front());
+    }
+    else
+        for (auto it = m_dims.begin() + 1; it != m_dims.end(); ++it)
+            fill(*it);
+    results.m_pos += count;
+}
 
-            idx++;
-            numRead++;
+point_count_t TileDBReader::read(PointViewPtr view, point_count_t count)
+{
+    point_count_t numRead = 0;
+
+    if (m_empty)
+        return 0;
+
+    const size_t threads = (std::min)(m_dims.size() - 1, m_threads ?
+        m_threads :
+        (size_t)(std::max)(std::thread::hardware_concurrency(), 1U));
+    if (threads > 1 && !m_pool)
+        m_pool.reset(new ThreadPool(threads, m_dims.size(), false));
 
-            if (numRead == count)
+    while (numRead < count)
+    {
+        Results& results = m_results[m_cur];
+        if (results.m_pos == results.m_count)
+        {
+            if (!nextResults())
                 break;
+            continue;
         }
-    }
-    while(status == tiledb::Query::Status::INCOMPLETE);
 
-    if (status == tiledb::Query::Status::FAILED)
-        throwError("Unable to read from " + m_arrayName);
+        PointId idx = view->size();
+        convert(*view, results, count - numRead);
+        numRead += view->size() - idx;
+
+        // progess callback
+        if (m_cb)
+            for (; idx < view->size(); ++idx)
+                m_cb(*view, idx);
+    }
     return numRead;
 }
 
+bool TileDBReader::processOne(PointRef& point)
+{
+    if (m_empty)
+        return false;
+
+    while (m_results[m_cur].m_pos == m_results[m_cur].m_count)
+        if (!nextResults())
+            return false;
+
+    Results& results = m_results[m_cur];
+    for (const DimInfo& di : m_dims)
+        if (!setField(point, di, *results.m_buffers[di.m_bufIdx],
+                results.m_pos))
+            throwError("Invalid dimension type when setting data.");
+    results.m_pos++;
+    return true;
+}
+
 void TileDBReader::done(pdal::BasePointTable &table)
 {
+    waitPending();
+    m_pool.reset();
     m_array->close();
 }
 
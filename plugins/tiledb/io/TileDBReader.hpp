@@ -34,15 +34,19 @@
 
 #pragma once
 
+#include <future>
 #include <iostream>
 
 #include <pdal/Reader.hpp>
+#include <pdal/Streamable.hpp>
 #include <tiledb/tiledb>
 
 namespace pdal
 {
 
-class PDAL_DLL TileDBReader : public Reader
+class ThreadPool;
+
+class PDAL_DLL TileDBReader : public Reader, public Streamable
 {
 public:
     struct Buffer
@@ -67,9 +71,24 @@ public:
         Attribute
     };
 
+    // The results of one submission of the query.  Two of these are
+    // used so that the next chunk can be fetched while the current
+    // one is being converted.
+    struct Results
+    {
+        std::vector<std::unique_ptr<Buffer>> m_buffers;
+        size_t m_count;  // Number of points returned.
+        size_t m_pos;    // Next point to be converted.
+        tiledb::Query::Status m_status;
+
+        Results() : m_count(0), m_pos(0),
+            m_status(tiledb::Query::Status::UNINITIALIZED)
+        {}
+    };
+
     struct DimInfo
     {
-        Buffer *m_buffer;
+        size_t m_bufIdx;  // Index into Results::m_buffers.
         DimCategory m_dimCategory;
         size_t m_span;
         size_t m_offset;
@@ -79,14 +98,20 @@ public:
         std::string m_name;
     };
 
-    TileDBReader() = default;
+    TileDBReader();
+    ~TileDBReader();
     std::string getName() const;
 private:
     virtual void addArgs(ProgramArgs& args);
     virtual void initialize();
     virtual void addDimensions(PointLayoutPtr layout);
+    virtual bool dimensionsUsed(PointLayoutPtr, Dimension::IdList&) const
+        { return true; }
+    virtual void restrictBounds(const BOX3D& bounds)
+        { m_queryBounds = bounds; }
     virtual void ready(PointTableRef);
     virtual point_count_t read(PointViewPtr view, point_count_t count);
+    virtual bool processOne(PointRef& point);
     virtual void done(PointTableRef table);
 
     std::string m_arrayName;
@@ -94,8 +119,15 @@ private:
     point_count_t m_chunkSize;
     bool m_stats;
     BOX3D m_bbox;
-    std::vector<std::unique_ptr<Buffer>> m_buffers;
+    BOX3D m_queryBounds;
+    bool m_empty;
+    bool m_started;
+    size_t m_threads;
+    Results m_results[2];
+    size_t m_cur;  // Index of the results currently being converted.
+    std::future<void> m_pending;
     std::vector<DimInfo> m_dims;
+    std::unique_ptr<ThreadPool> m_pool;
 
     std::unique_ptr<tiledb::Context> m_ctx;
     std::unique_ptr<tiledb::Array> m_array;
@@ -105,8 +137,13 @@ private:
     TileDBReader& operator=(const TileDBReader&) = delete;
 
     template<typename T>
-    void setQueryBuffer(const DimInfo& di);
-    void setQueryBuffer(const DimInfo& di);
+    void setQueryBuffer(const DimInfo& di, Buffer& buf);
+    void setQueryBuffer(const DimInfo& di, Buffer& buf);
+    void submit(Results& results, bool async);
+    void waitPending();
+    void collect(Results& results);
+    bool nextResults();
+    void convert(PointView& view, Results& results, point_count_t count);
 };
 
 } // namespace pdal
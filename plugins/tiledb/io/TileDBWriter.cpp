@@ -34,9 +34,12 @@
 
 #include <string.h>
 #include <cctype>
+#include <chrono>
 #include <limits>
+#include <thread>
 
 #include <pdal/util/FileUtils.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 #include "TileDBWriter.hpp"
 
@@ -60,49 +63,91 @@ static PluginInfo const s_info
 CREATE_SHARED_STAGE(TileDBWriter, s_info)
 
 void writeAttributeValue(TileDBWriter::DimBuffer& dim,
-    PointViewPtr view, PointId idx)
+    const PointView& view, PointId idx, size_t pos)
 {
     Everything e;
 
     switch (dim.m_type)
     {
     case Dimension::Type::Double:
-        e.d = view->getFieldAs<double>(dim.m_id, idx);
+        e.d = view.getFieldAs<double>(dim.m_id, idx);
         break;
     case Dimension::Type::Float:
-        e.f = view->getFieldAs<float>(dim.m_id, idx);
+        e.f = view.getFieldAs<float>(dim.m_id, idx);
         break;
     case Dimension::Type::Signed8:
-        e.s8 = view->getFieldAs<int8_t>(dim.m_id, idx);
+        e.s8 = view.getFieldAs<int8_t>(dim.m_id, idx);
         break;
     case Dimension::Type::Signed16:
-        e.s16 = view->getFieldAs<int16_t>(dim.m_id, idx);
+        e.s16 = view.getFieldAs<int16_t>(dim.m_id, idx);
         break;
     case Dimension::Type::Signed32:
-        e.s32 = view->getFieldAs<int32_t>(dim.m_id, idx);
+        e.s32 = view.getFieldAs<int32_t>(dim.m_id, idx);
         break;
     case Dimension::Type::Signed64:
-        e.s64 = view->getFieldAs<int64_t>(dim.m_id, idx);
+        e.s64 = view.getFieldAs<int64_t>(dim.m_id, idx);
         break;
     case Dimension::Type::Unsigned8:
-        e.u8 = view->getFieldAs<uint8_t>(dim.m_id, idx);
+        e.u8 = view.getFieldAs<uint8_t>(dim.m_id, idx);
         break;
     case Dimension::Type::Unsigned16:
-        e.u16 = view->getFieldAs<uint16_t>(dim.m_id, idx);
+        e.u16 = view.getFieldAs<uint16_t>(dim.m_id, idx);
         break;
     case Dimension::Type::Unsigned32:
-        e.u32 = view->getFieldAs<uint32_t>(dim.m_id, idx);
+        e.u32 = view.getFieldAs<uint32_t>(dim.m_id, idx);
         break;
     case Dimension::Type::Unsigned64:
-        e.u64 = view->getFieldAs<uint64_t>(dim.m_id, idx);
+        e.u64 = view.getFieldAs<uint64_t>(dim.m_id, idx);
         break;
     default:
-        throw pdal_error("Unsupported attribute type for " +
-            view->dimName(dim.m_id));
+        throw pdal_error("Unsupported attribute type for " + dim.m_name);
     }
 
     size_t size = Dimension::size(dim.m_type);
-    memcpy(dim.m_buffer.data() + (idx * size), &e, size);
+    memcpy(dim.m_buffer.data() + (pos * size), &e, size);
+}
+
+
+void setQueryBuffer(tiledb::Query& query, TileDBWriter::DimBuffer& a,
+    size_t size)
+{
+    uint8_t *buf = a.m_buffer.data();
+    switch (a.m_type)
+    {
+    case Dimension::Type::Double:
+        query.set_buffer(a.m_name, reinterpret_cast<double *>(buf), size);
+        break;
+    case Dimension::Type::Float:
+        query.set_buffer(a.m_name, reinterpret_cast<float *>(buf), size);
+        break;
+    case Dimension::Type::Signed8:
+        query.set_buffer(a.m_name, reinterpret_cast<int8_t *>(buf), size);
+        break;
+    case Dimension::Type::Signed16:
+        query.set_buffer(a.m_name, reinterpret_cast<int16_t *>(buf), size);
+        break;
+    case Dimension::Type::Signed32:
+        query.set_buffer(a.m_name, reinterpret_cast<int32_t *>(buf), size);
+        break;
+    case Dimension::Type::Signed64:
+        query.set_buffer(a.m_name, reinterpret_cast<int64_t *>(buf), size);
+        break;
+    case Dimension::Type::Unsigned8:
+        query.set_buffer(a.m_name, reinterpret_cast<uint8_t *>(buf), size);
+        break;
+    case Dimension::Type::Unsigned16:
+        query.set_buffer(a.m_name, reinterpret_cast<uint16_t *>(buf), size);
+        break;
+    case Dimension::Type::Unsigned32:
+        query.set_buffer(a.m_name, reinterpret_cast<uint32_t *>(buf), size);
+        break;
+    case Dimension::Type::Unsigned64:
+        query.set_buffer(a.m_name, reinterpret_cast<uint64_t *>(buf), size);
+        break;
+    case Dimension::Type::None:
+    default:
+        throw pdal_error("Unsupported attribute type for " + a.m_name);
+    }
 }
 
 
@@ -160,6 +205,20 @@ tiledb::Filter createFilter(const tiledb::Context& ctx, const std::string& name)
 
 std::string TileDBWriter::getName() const { return s_info.name; }
 
+TileDBWriter::TileDBWriter() : m_cur(0)
+{}
+
+TileDBWriter::~TileDBWriter()
+{
+    // Outstanding queries reference the batch buffers.
+    for (Batch& b : m_batches)
+        if (b.m_pending.valid())
+            while (b.m_pending.wait_for(std::chrono::milliseconds(10)) !=
+                    std::future_status::ready &&
+                b.m_query->query_status() != tiledb::Query::Status::FAILED)
+            {}
+}
+
 void TileDBWriter::addArgs(ProgramArgs& args)
 {
     args.add("array_name", "TileDB array name", m_arrayName).setPositional();
@@ -175,6 +234,12 @@ void TileDBWriter::addArgs(ProgramArgs& args)
         m_compressor);
     args.add("compression_level", "TileDB compression level",
         m_compressionLevel, -1);
+    args.add("cache_size", "Number of points written by each TileDB write "
+        "query", m_cacheSize, point_count_t(1000000));
+    args.add("threads", "Number of threads used to fill attribute buffers.  "
+        "The default is the number of cores.", m_threads);
+    args.add("write_threads", "Number of write queries that may run at "
+        "once.  Each writes its own fragment.", m_writeThreads, size_t(1));
 }
 
 
@@ -188,6 +253,11 @@ void TileDBWriter::initialize()
     else
         m_ctx.reset(new tiledb::Context());
 
+    if (m_cacheSize == 0)
+        throwError("Option 'cache_size' must be greater than 0.");
+    if (m_writeThreads == 0)
+        throwError("Option 'write_threads' must be greater than 0.");
+
     // If the array already exists on disk, throw an error
     if (tiledb::Object::object(*m_ctx, m_arrayName).type() ==
         tiledb::Object::Type::Array)
@@ -244,108 +314,150 @@ void TileDBWriter::ready(pdal::BasePointTable &table)
 
     tiledb::Array::create(m_arrayName, *m_schema);
     m_array.reset(new tiledb::Array(*m_ctx, m_arrayName, TILEDB_WRITE));
-    m_query.reset(new tiledb::Query(*m_ctx, *m_array));
-    m_query->set_layout(TILEDB_UNORDERED);
+
+    // One batch is filled while up to m_writeThreads others are written.
+    m_batches.resize(m_writeThreads + 1);
+    for (Batch& b : m_batches)
+    {
+        b.m_coords.resize(m_cacheSize * 3);
+        b.m_attrs = m_attrs;
+        for (DimBuffer& a : b.m_attrs)
+            a.m_buffer.resize(m_cacheSize * Dimension::size(a.m_type));
+        b.m_query.reset(new tiledb::Query(*m_ctx, *m_array));
+        b.m_query->set_layout(TILEDB_UNORDERED);
+    }
+    m_cur = 0;
+
+    const size_t threads = (std::min)(m_attrs.size() + 1, m_threads ?
+        m_threads :
+        (size_t)(std::max)(std::thread::hardware_concurrency(), 1U));
+    if (threads > 1)
+        m_pool.reset(new ThreadPool(threads, m_attrs.size() + 1, false));
+
+    if (m_stats)
+        tiledb::Stats::enable();
 }
 
 
-void TileDBWriter::write(const PointViewPtr view)
+void TileDBWriter::fill(Batch& batch, const PointView& view, PointId start,
+    point_count_t count)
 {
-    std::vector<double> coords;
-
-    auto attrs = m_schema->attributes();
+    const size_t pos = batch.m_count;
+    BOX3D bounds;
 
-    // Size the buffers.
-    for (auto& a : m_attrs)
-        a.m_buffer.resize(view->size() * Dimension::size(a.m_type));
+    auto fillCoords = [&batch, &view, &bounds, start, count, pos]()
+    {
+        double *c = batch.m_coords.data() + pos * 3;
+        for (PointId idx = start; idx < start + count; ++idx)
+        {
+            double x = view.getFieldAs<double>(Dimension::Id::X, idx);
+            double y = view.getFieldAs<double>(Dimension::Id::Y, idx);
+            double z = view.getFieldAs<double>(Dimension::Id::Z, idx);
+
+            *c++ = x;
+            *c++ = y;
+            *c++ = z;
+            bounds.grow(x, y, z);
+        }
+    };
 
-    PointRef point(*view, 0);
-    for (PointId idx = 0; idx < view->size(); ++idx)
+    auto fillAttr = [&view, start, count, pos](DimBuffer& a)
     {
-        point.setPointId(idx);
-        double x = view->getFieldAs<double>(Dimension::Id::X, idx);
-        double y = view->getFieldAs<double>(Dimension::Id::Y, idx);
-        double z = view->getFieldAs<double>(Dimension::Id::Z, idx);
+        for (PointId i = 0; i < count; ++i)
+            writeAttributeValue(a, view, start + i, pos + i);
+    };
 
-        coords.push_back(x);
-        coords.push_back(y);
-        coords.push_back(z);
+    // Each buffer is independent, so they can be filled in parallel.
+    if (m_pool)
+    {
+        m_pool->add(fillCoords);
+        for (DimBuffer& a : batch.m_attrs)
+            m_pool->add([&fillAttr, &a](){ fillAttr(a); });
+        m_pool->await();
+        if (m_pool->errors().size())
+            throwError(m_pool->errors().front());
+    }
+    else
+    {
+        fillCoords();
+        for (DimBuffer& a : batch.m_attrs)
+            fillAttr(a);
+    }
+    m_bbox.grow(bounds);
+    batch.m_count += count;
+}
 
-        m_bbox.grow(x, y, z);
 
-        for (auto& a : m_attrs)
-            writeAttributeValue(a, view, idx);
+void TileDBWriter::write(const PointViewPtr view)
+{
+    PointId idx = 0;
+    while (idx < view->size())
+    {
+        Batch& batch = m_batches[m_cur];
+        point_count_t count = (std::min)(m_cacheSize - batch.m_count,
+            (point_count_t)(view->size() - idx));
+        fill(batch, *view, idx, count);
+        idx += count;
+        if (batch.m_count == m_cacheSize)
+            flush();
     }
-    m_query->set_coordinates(coords);
+}
+
 
-    // set tiledb buffers
-    size_t size = view->size();
-    for (const auto& a : m_attrs)
+// Start writing the current batch and move on to the next one, waiting
+// for its previous write to finish if necessary.
+void TileDBWriter::flush()
+{
+    Batch& batch = m_batches[m_cur];
+
+    batch.m_query->set_coordinates(batch.m_coords.data(),
+        batch.m_count * 3);
+    for (DimBuffer& a : batch.m_attrs)
+        setQueryBuffer(*batch.m_query, a, batch.m_count);
+
+    std::shared_ptr<std::promise<void>> done(new std::promise<void>);
+    batch.m_pending = done->get_future();
+    batch.m_query->submit_async([done](){ done->set_value(); });
+
+    m_cur = (m_cur + 1) % m_batches.size();
+    finish(m_batches[m_cur]);
+}
+
+
+// Wait for any write of a batch to complete and make it available for
+// filling.
+void TileDBWriter::finish(Batch& batch)
+{
+    if (batch.m_pending.valid())
     {
-        uint8_t *buf = const_cast<uint8_t *>(a.m_buffer.data());
-        switch (a.m_type)
-        {
-        case Dimension::Type::Double:
-            m_query->set_buffer(a.m_name, reinterpret_cast<double *>(buf),
-                size);
-            break;
-        case Dimension::Type::Float:
-            m_query->set_buffer(a.m_name, reinterpret_cast<float *>(buf),
-                size);
-            break;
-        case Dimension::Type::Signed8:
-            m_query->set_buffer(a.m_name, reinterpret_cast<int8_t *>(buf),
-                size);
-            break;
-        case Dimension::Type::Signed16:
-            m_query->set_buffer(a.m_name, reinterpret_cast<int16_t *>(buf),
-                size);
-            break;
-        case Dimension::Type::Signed32:
-            m_query->set_buffer(a.m_name, reinterpret_cast<int32_t *>(buf),
-                size);
-            break;
-        case Dimension::Type::Signed64:
-            m_query->set_buffer(a.m_name, reinterpret_cast<int64_t *>(buf),
-                size);
-            break;
-        case Dimension::Type::Unsigned8:
-            m_query->set_buffer(a.m_name, reinterpret_cast<uint8_t *>(buf),
-                size);
-            break;
-        case Dimension::Type::Unsigned16:
-            m_query->set_buffer(a.m_name, reinterpret_cast<uint16_t *>(buf),
-                size);
-            break;
-        case Dimension::Type::Unsigned32:
-            m_query->set_buffer(a.m_name, reinterpret_cast<uint32_t *>(buf),
-                size);
-            break;
-        case Dimension::Type::Unsigned64:
-            m_query->set_buffer(a.m_name, reinterpret_cast<uint64_t *>(buf),
-                size);
-            break;
-        case Dimension::Type::None:
-        default:
-            throw pdal_error("Unsupported attribute type for " + a.m_name);
-        }
+        // Poll the status as well as waiting for the callback in case a
+        // failed query doesn't complete normally.
+        while (batch.m_pending.wait_for(std::chrono::milliseconds(10)) !=
+                std::future_status::ready &&
+            batch.m_query->query_status() != tiledb::Query::Status::FAILED)
+        {}
+        batch.m_pending = std::future<void>();
+        if (batch.m_query->query_status() == tiledb::Query::Status::FAILED)
+            throwError("Unable to write to " + m_arrayName);
     }
+    batch.m_count = 0;
+}
 
-    if (m_stats)
-        tiledb::Stats::enable();
 
-    m_query->submit();
+void TileDBWriter::done(PointTableRef table)
+{
+    if (m_batches[m_cur].m_count)
+        flush();
+    for (Batch& b : m_batches)
+        finish(b);
+    m_pool.reset();
 
     if (m_stats)
     {
         tiledb::Stats::dump(stdout);
         tiledb::Stats::disable();
     }
-}
-
 
-void TileDBWriter::done(PointTableRef table)
-{
     tiledb::VFS vfs(*m_ctx, m_ctx->config());
 
     // write pipeline metadata sidecar inside array
@@ -383,6 +495,11 @@ void TileDBWriter::done(PointTableRef table)
 
     fbuf.close();
     m_array->close();
+
+    // Concurrent writes leave interleaved fragments.  Merge them so that
+    // reads don't pay for it.
+    if (m_writeThreads > 1)
+        tiledb::Array::consolidate(*m_ctx, m_arrayName);
 }
 
 } // namespace pdal
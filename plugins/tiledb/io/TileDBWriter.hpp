@@ -34,12 +34,16 @@
 
 #pragma once
 
+#include <future>
+
 #include <pdal/Writer.hpp>
 #include <tiledb/tiledb>
 
 namespace pdal
 {
 
+class ThreadPool;
+
 class PDAL_DLL TileDBWriter : public Writer
 {
 public:
@@ -55,7 +59,22 @@ public:
         {}
     };
 
-    TileDBWriter() = default;
+    // A set of buffers and the query that writes them.  While one batch
+    // is being filled, others may be written asynchronously.
+    struct Batch
+    {
+        std::vector<double> m_coords;
+        std::vector<DimBuffer> m_attrs;
+        point_count_t m_count;
+        std::unique_ptr<tiledb::Query> m_query;
+        std::future<void> m_pending;
+
+        Batch() : m_count(0)
+        {}
+    };
+
+    TileDBWriter();
+    ~TileDBWriter();
     std::string getName() const;
 private:
     virtual void addArgs(ProgramArgs& args);
@@ -73,6 +92,9 @@ private:
     size_t m_z_tile_size;
 
     bool m_stats;
+    point_count_t m_cacheSize;
+    size_t m_threads;
+    size_t m_writeThreads;
 
     BOX3D m_bbox;
 
@@ -83,8 +105,15 @@ private:
     std::unique_ptr<tiledb::Context> m_ctx;
     std::unique_ptr<tiledb::ArraySchema> m_schema;
     std::unique_ptr<tiledb::Array> m_array;
-    std::unique_ptr<tiledb::Query> m_query;
     std::vector<DimBuffer> m_attrs;
+    std::vector<Batch> m_batches;
+    size_t m_cur;  // Index of the batch being filled.
+    std::unique_ptr<ThreadPool> m_pool;
+
+    void fill(Batch& batch, const PointView& view, PointId start,
+        point_count_t count);
+    void flush();
+    void finish(Batch& batch);
 
     TileDBWriter(const TileDBWriter&) = delete;
     TileDBWriter& operator=(const TileDBWriter&) = delete;
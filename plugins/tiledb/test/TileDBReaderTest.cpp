@@ -37,6 +37,7 @@
 #include <pdal/PointView.hpp>
 #include <pdal/PipelineManager.hpp>
 #include <pdal/StageFactory.hpp>
+#include <filters/StreamCallbackFilter.hpp>
 
 #include "Support.hpp"
 
@@ -113,4 +114,82 @@ class TileDBReaderTest : public ::testing::Test
         ASSERT_DOUBLE_EQ(subarray[3], bbox.maxy);
         ASSERT_DOUBLE_EQ(subarray[5], bbox.maxz);
     }
+
+    TEST_F(TileDBReaderTest, chunked)
+    {
+        // Force many incomplete queries so that fetches are pipelined.
+        std::string pth(Support::datapath("tiledb/array"));
+
+        Options opts;
+        opts.add("array_name", pth);
+
+        TileDBReader reader;
+        reader.setOptions(opts);
+        PointTable table;
+        reader.prepare(table);
+        PointViewSet ts = reader.execute(table);
+        PointViewPtr v = *ts.begin();
+
+        Options chunkOpts(opts);
+        chunkOpts.add("chunk_size", 7);
+        chunkOpts.add("threads", 3);
+
+        TileDBReader reader2;
+        reader2.setOptions(chunkOpts);
+        PointTable table2;
+        reader2.prepare(table2);
+        PointViewSet ts2 = reader2.execute(table2);
+        PointViewPtr v2 = *ts2.begin();
+
+        ASSERT_EQ(v->size(), v2->size());
+        for (PointId i = 0; i < v->size(); ++i)
+        {
+            EXPECT_DOUBLE_EQ(v->getFieldAs<double>(Dimension::Id::X, i),
+                v2->getFieldAs<double>(Dimension::Id::X, i));
+            EXPECT_DOUBLE_EQ(v->getFieldAs<double>(Dimension::Id::Y, i),
+                v2->getFieldAs<double>(Dimension::Id::Y, i));
+            EXPECT_DOUBLE_EQ(v->getFieldAs<double>(Dimension::Id::Z, i),
+                v2->getFieldAs<double>(Dimension::Id::Z, i));
+        }
+    }
+
+    TEST_F(TileDBReaderTest, stream)
+    {
+        std::string pth(Support::datapath("tiledb/array"));
+
+        Options opts;
+        opts.add("array_name", pth);
+
+        TileDBReader reader;
+        reader.setOptions(opts);
+        PointTable table;
+        reader.prepare(table);
+        PointViewSet ts = reader.execute(table);
+        PointViewPtr v = *ts.begin();
+
+        Options chunkOpts(opts);
+        chunkOpts.add("chunk_size", 5);
+
+        TileDBReader reader2;
+        reader2.setOptions(chunkOpts);
+
+        PointId idx = 0;
+        auto cb = [&v, &idx](PointRef& point)
+        {
+            EXPECT_DOUBLE_EQ(v->getFieldAs<double>(Dimension::Id::X, idx),
+                point.getFieldAs<double>(Dimension::Id::X));
+            EXPECT_DOUBLE_EQ(v->getFieldAs<double>(Dimension::Id::Z, idx),
+                point.getFieldAs<double>(Dimension::Id::Z));
+            idx++;
+            return true;
+        };
+        StreamCallbackFilter f;
+        f.setCallback(cb);
+        f.setInput(reader2);
+
+        FixedPointTable t(4);
+        f.prepare(t);
+        f.execute(t);
+        EXPECT_EQ(idx, v->size());
+    }
 }
\ No newline at end of file
@@ -132,5 +132,51 @@ namespace pdal
         ASSERT_DOUBLE_EQ(subarray[3], bbox.maxy);
         ASSERT_DOUBLE_EQ(subarray[5], bbox.maxz);
     }
-}
 
+    TEST_F(TileDBWriterTest, write_batched)
+    {
+        tiledb::Context ctx;
+        tiledb::VFS vfs(ctx);
+        std::string pth = Support::temppath("tiledb_test_batched_out");
+
+        Options options;
+        options.add("array_name", pth);
+        options.add("cache_size", 7);
+        options.add("threads", 3);
+        options.add("write_threads", 3);
+
+        if (vfs.is_dir(pth))
+        {
+            vfs.remove_dir(pth);
+        }
+
+        TileDBWriter writer;
+        writer.setOptions(options);
+        writer.setInput(m_reader);
+
+        PointTable table;
+        writer.prepare(table);
+        writer.execute(table);
+
+        tiledb::Array array(ctx, pth, TILEDB_READ);
+        auto domain = array.non_empty_domain<double>();
+        std::vector<double> subarray;
+
+        for (const auto& kv: domain)
+        {
+            subarray.push_back(kv.second.first);
+            subarray.push_back(kv.second.second);
+        }
+
+        tiledb::Query q(ctx, array, TILEDB_READ);
+        q.set_subarray(subarray);
+
+        auto max_el = array.max_buffer_elements(subarray);
+        std::vector<double> coords(max_el[TILEDB_COORDS].second);
+        q.set_coordinates(coords);
+        q.submit();
+        array.close();
+
+        EXPECT_EQ(m_reader.count() * 3, coords.size());
+    }
+}
@@ -0,0 +1,369 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "Benchmark.hpp"
+
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <regex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <pdal/pdal_features.hpp>
+#include <pdal/Options.hpp>
+#include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/Utils.hpp>
+#include <io/FauxReader.hpp>
+
+namespace pdal
+{
+namespace bench
+{
+
+namespace
+{
+
+struct Benchmark
+{
+    std::string name;
+    Function func;
+};
+
+struct Result
+{
+    std::string name;
+    uint64_t iterations;
+    double seconds;
+    double itemsPerSecond;
+    double bytesPerSecond;
+    std::string error;
+    bool failed;
+};
+
+std::vector<Benchmark>& benchmarks()
+{
+    static std::vector<Benchmark> s_benchmarks;
+    return s_benchmarks;
+}
+
+// Run a benchmark with increasing iteration counts until the timed part
+// takes at least 'minTime' seconds.
+Result run(const Benchmark& b, double minTime)
+{
+    const uint64_t MaxIterations = 1000000000;
+
+    uint64_t iterations = 1;
+    while (true)
+    {
+        State state(iterations);
+        b.func(state);
+
+        Result r { b.name, state.iterations(), state.seconds(), 0, 0,
+            state.error(), false };
+        if (r.error.size())
+            return r;
+        if (r.seconds >= minTime || iterations >= MaxIterations)
+        {
+            if (r.seconds > 0)
+            {
+                r.itemsPerSecond = state.items() / r.seconds;
+                r.bytesPerSecond = state.bytes() / r.seconds;
+            }
+            return r;
+        }
+
+        // Aim past the minimum time, but don't grow too quickly when the
+        // first runs are too short to measure.
+        double mult = 10;
+        if (r.seconds > 0)
+            mult = (std::min)(10.0, (std::max)(2.0, minTime * 1.4 / r.seconds));
+        iterations = (std::min)(MaxIterations, (uint64_t)(iterations * mult));
+    }
+}
+
+std::string humanRate(double rate)
+{
+    const char *suffix[] = { "", "k", "M", "G", "T" };
+    size_t i = 0;
+    while (rate >= 1000 && i < 4)
+    {
+        rate /= 1000;
+        i++;
+    }
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2) << rate << suffix[i] << "/s";
+    return out.str();
+}
+
+void writeConsole(std::ostream& out, const Result& r)
+{
+    out << std::left << std::setw(48) << r.name << std::right;
+    if (r.error.size())
+    {
+        out << (r.failed ? "  FAILED: " : "  SKIPPED: ") << r.error <<
+            std::endl;
+        return;
+    }
+    out << std::setw(14) << std::fixed << std::setprecision(0) <<
+        (r.seconds * 1e9 / r.iterations) << " ns" <<
+        std::setw(12) << r.iterations;
+    if (r.itemsPerSecond > 0)
+        out << "  items=" << humanRate(r.itemsPerSecond);
+    if (r.bytesPerSecond > 0)
+        out << "  bytes=" << humanRate(r.bytesPerSecond);
+    out << std::endl;
+}
+
+// Results are written in the layout used by Google Benchmark so that
+// existing tools can compare runs.
+void writeJson(std::ostream& out, const std::vector<Result>& results)
+{
+    char date[64];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S",
+        std::localtime(&now));
+
+    out << "{\n";
+    out << "  \"context\": {\n";
+    out << "    \"date\": \"" << date << "\",\n";
+    out << "    \"pdal_version\": \"" << PDAL_VERSION_STRING << "\",\n";
+    out << "    \"build_type\": \"" << PDAL_BUILD_TYPE << "\",\n";
+    out << "    \"num_cpus\": " << std::thread::hardware_concurrency() <<
+        "\n";
+    out << "  },\n";
+    out << "  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const Result& r = results[i];
+        out << (i ? ",\n" : "\n") << "    {\n";
+        out << "      \"name\": \"" << Utils::escapeJSON(r.name) << "\",\n";
+        if (r.error.size())
+        {
+            out << "      \"error_occurred\": true,\n";
+            out << "      \"error_message\": \"" <<
+                Utils::escapeJSON(r.error) << "\"\n";
+        }
+        else
+        {
+            out << std::setprecision(17);
+            out << "      \"iterations\": " << r.iterations << ",\n";
+            out << "      \"real_time\": " <<
+                r.seconds * 1e9 / r.iterations << ",\n";
+            out << "      \"time_unit\": \"ns\"";
+            if (r.itemsPerSecond > 0)
+                out << ",\n      \"items_per_second\": " << r.itemsPerSecond;
+            if (r.bytesPerSecond > 0)
+                out << ",\n      \"bytes_per_second\": " << r.bytesPerSecond;
+            out << "\n";
+        }
+        out << "    }";
+    }
+    out << "\n  ]\n}\n";
+}
+
+} // unnamed namespace
+
+
+State::State(uint64_t iterations) : m_iterations(iterations),
+    m_remaining(iterations), m_started(false), m_running(false),
+    m_elapsed(0), m_items(0), m_bytes(0)
+{}
+
+
+bool State::keepRunning()
+{
+    if (!m_started)
+    {
+        m_started = true;
+        resumeTiming();
+    }
+    if (m_remaining && m_error.empty())
+    {
+        m_remaining--;
+        return true;
+    }
+    pauseTiming();
+    return false;
+}
+
+
+void State::pauseTiming()
+{
+    if (m_running)
+    {
+        m_elapsed += Clock::now() - m_start;
+        m_running = false;
+    }
+}
+
+
+void State::resumeTiming()
+{
+    if (!m_running)
+    {
+        m_start = Clock::now();
+        m_running = true;
+    }
+}
+
+
+double State::seconds() const
+{
+    return std::chrono::duration<double>(m_elapsed).count();
+}
+
+
+void registerBenchmark(const std::string& name, const Function& f)
+{
+    benchmarks().push_back({ name, f });
+}
+
+
+PointViewPtr fauxPoints(PointTableRef table, const std::string& mode,
+    point_count_t count)
+{
+    Options opts;
+    opts.add("mode", mode);
+    opts.add("count", count);
+    opts.add("bounds", BOX3D(0, 0, 0, 1000, 1000, 100));
+    opts.add("mean_x", 500);
+    opts.add("mean_y", 500);
+    opts.add("mean_z", 50);
+    opts.add("stdev_x", 100);
+    opts.add("stdev_y", 100);
+    opts.add("stdev_z", 10);
+    opts.add("number_of_returns", 3);
+
+    FauxReader reader;
+    reader.setOptions(opts);
+    reader.prepare(table);
+    PointViewSet set = reader.execute(table);
+    return *set.begin();
+}
+
+
+PointViewPtr copyView(const PointView& view, PointTableRef table)
+{
+    PointViewPtr copy(new PointView(table));
+    for (Dimension::Id dim : view.dims())
+        for (PointId idx = 0; idx < view.size(); ++idx)
+            copy->setField(dim, idx, view.getFieldAs<double>(dim, idx));
+    return copy;
+}
+
+} // namespace bench
+} // namespace pdal
+
+
+using namespace pdal;
+
+int main(int argc, char *argv[])
+{
+    std::string filter;
+    double minTime;
+    std::string format;
+    std::string outFilename;
+    bool list;
+
+    ProgramArgs args;
+    args.add("filter", "Regular expression matching the names of the "
+        "benchmarks to run", filter, ".*");
+    args.add("min_time", "Minimum time in seconds for which each "
+        "benchmark is run", minTime, 0.5);
+    args.add("format", "Output format ('console' or 'json')", format,
+        "console");
+    args.add("out", "File to which results are written in JSON format",
+        outFilename);
+    args.add("list", "List the benchmarks without running them", list);
+
+    try
+    {
+        args.parse(std::vector<std::string>(argv + 1, argv + argc));
+        if (format != "console" && format != "json")
+            throw pdal_error("Invalid format '" + format + "'.");
+    }
+    catch (const pdal_error& err)
+    {
+        std::cerr << "pdal_bench: " << err.what() << std::endl;
+        args.dump(std::cerr, 2, 80);
+        return 1;
+    }
+
+    std::regex re(filter);
+    std::vector<bench::Result> results;
+    for (const bench::Benchmark& b : bench::benchmarks())
+    {
+        if (!std::regex_search(b.name, re))
+            continue;
+        if (list)
+        {
+            std::cout << b.name << std::endl;
+            continue;
+        }
+
+        try
+        {
+            results.push_back(bench::run(b, minTime));
+        }
+        catch (const std::exception& err)
+        {
+            results.push_back({ b.name, 0, 0, 0, 0, err.what(), true });
+        }
+        if (format == "console")
+            bench::writeConsole(std::cout, results.back());
+    }
+
+    if (format == "json")
+        bench::writeJson(std::cout, results);
+    if (outFilename.size())
+    {
+        std::ofstream out(outFilename);
+        if (!out)
+        {
+            std::cerr << "pdal_bench: Unable to open '" << outFilename <<
+                "' for output." << std::endl;
+            return 1;
+        }
+        bench::writeJson(out, results);
+    }
+
+    for (const bench::Result& r : results)
+        if (r.failed)
+            return 1;
+    return 0;
+}
@@ -0,0 +1,193 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include <pdal/PointTable.hpp>
+#include <pdal/PointView.hpp>
+
+namespace pdal
+{
+namespace bench
+{
+
+/**
+  Timing state passed to a benchmark.  A benchmark does its setup, then
+  runs the code to be measured in a loop while keepRunning() returns true.
+  The runner calls the benchmark with increasing iteration counts until
+  the timed part runs long enough to be measured reliably.
+*/
+class State
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    State(uint64_t iterations);
+
+    /**
+      Start the timer on the first call and count an iteration.
+
+      \return  Whether another iteration is to be run.
+    */
+    bool keepRunning();
+
+    /**
+      Stop the timer, for per-iteration setup that shouldn't be measured.
+    */
+    void pauseTiming();
+
+    /**
+      Restart the timer after pauseTiming().
+    */
+    void resumeTiming();
+
+    /**
+      Set the number of items processed in all iterations, from which the
+      item rate is computed.
+
+      \param items  Number of items.
+    */
+    void setItemsProcessed(uint64_t items)
+        { m_items = items; }
+
+    /**
+      Set the number of bytes processed in all iterations, from which the
+      byte rate is computed.
+
+      \param bytes  Number of bytes.
+    */
+    void setBytesProcessed(uint64_t bytes)
+        { m_bytes = bytes; }
+
+    /**
+      Skip the benchmark, reporting the reason instead of a timing.
+
+      \param msg  Reason the benchmark was skipped.
+    */
+    void skip(const std::string& msg)
+        { m_error = msg; }
+
+    uint64_t iterations() const
+        { return m_iterations; }
+    double seconds() const;
+    uint64_t items() const
+        { return m_items; }
+    uint64_t bytes() const
+        { return m_bytes; }
+    const std::string& error() const
+        { return m_error; }
+
+private:
+    uint64_t m_iterations;
+    uint64_t m_remaining;
+    bool m_started;
+    bool m_running;
+    Clock::time_point m_start;
+    Clock::duration m_elapsed;
+    uint64_t m_items;
+    uint64_t m_bytes;
+    std::string m_error;
+};
+
+typedef std::function<void(State&)> Function;
+
+/**
+  Add a benchmark to the set run by pdal_bench.
+
+  \param name  Name of the benchmark.  Parameters are separated from the
+    name by '/', as in "KD3Index/build/100000".
+  \param f  Benchmark function.
+*/
+void registerBenchmark(const std::string& name, const Function& f);
+
+/**
+  Registers benchmarks when a static instance is constructed.
+*/
+struct Registrar
+{
+    Registrar(const std::function<void()>& f)
+        { f(); }
+    Registrar(const std::string& name, const Function& f)
+        { registerBenchmark(name, f); }
+};
+
+/**
+  Keep the compiler from discarding a value that is computed but not used.
+
+  \param val  Value to keep.
+*/
+template <typename T>
+inline void keep(const T& val)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(val) : "memory");
+#else
+    static volatile const void *s_sink;
+    s_sink = &val;
+#endif
+}
+
+/**
+  Create points with readers.faux.
+
+  \param table  Table to hold the points.
+  \param mode  Faux reader mode ("uniform", "normal", "ramp", ...).
+  \param count  Number of points.
+  \return  View of the points.
+*/
+PointViewPtr fauxPoints(PointTableRef table, const std::string& mode,
+    point_count_t count);
+
+/**
+  Copy the points of a view to a new view in another table.  The
+  dimensions of the view must be registered in the table's layout.
+
+  \param view  View to copy.
+  \param table  Table to hold the copy.
+  \return  Copy of the view.
+*/
+PointViewPtr copyView(const PointView& view, PointTableRef table);
+
+} // namespace bench
+} // namespace pdal
+
+#define PDAL_BENCH(name) \
+    static void name(pdal::bench::State& state); \
+    static pdal::bench::Registrar name##_registrar(#name, name); \
+    static void name(pdal::bench::State& state)
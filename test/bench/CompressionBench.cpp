@@ -0,0 +1,177 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "Benchmark.hpp"
+
+#include <memory>
+
+#include <pdal/pdal_features.hpp>
+#include <pdal/compression/Compression.hpp>
+#ifdef PDAL_HAVE_ZLIB
+#include <pdal/compression/DeflateCompression.hpp>
+#endif
+#ifdef PDAL_HAVE_ZSTD
+#include <pdal/compression/ZstdCompression.hpp>
+#endif
+#ifdef PDAL_HAVE_LZMA
+#include <pdal/compression/LzmaCompression.hpp>
+#endif
+#ifdef PDAL_HAVE_LAZPERF
+#include <pdal/compression/LazPerfCompression.hpp>
+#endif
+
+using namespace pdal;
+using namespace pdal::bench;
+
+namespace
+{
+
+const point_count_t NumPoints = 1000000;
+
+typedef std::function<std::unique_ptr<Compressor>(BlockCb)>
+    CompressorFactory;
+typedef std::function<std::unique_ptr<Decompressor>(BlockCb)>
+    DecompressorFactory;
+
+// Packed point data to be compressed.
+struct Data
+{
+    Data()
+    {
+        PointTable table;
+        PointViewPtr view = fauxPoints(table, "normal", NumPoints);
+        dims = table.layout()->dimTypes();
+        size_t pointSize = table.layout()->pointSize();
+
+        buf.resize(view->size() * pointSize);
+        for (PointId idx = 0; idx < view->size(); ++idx)
+            view->getPackedPoint(dims, idx, buf.data() + idx * pointSize);
+    }
+
+    DimTypeList dims;
+    std::vector<char> buf;
+};
+
+const Data& data()
+{
+    static Data s_data;
+    return s_data;
+}
+
+std::vector<char> compress(const CompressorFactory& factory)
+{
+    std::vector<char> out;
+    auto cb = [&out](char *buf, size_t size)
+        { out.insert(out.end(), buf, buf + size); };
+
+    std::unique_ptr<Compressor> c = factory(cb);
+    c->compress(data().buf.data(), data().buf.size());
+    c->done();
+    return out;
+}
+
+void compressBench(State& state, const CompressorFactory& factory)
+{
+    data();
+    while (state.keepRunning())
+        keep(compress(factory).size());
+    state.setItemsProcessed(state.iterations() * NumPoints);
+    state.setBytesProcessed(state.iterations() * data().buf.size());
+}
+
+void decompressBench(State& state, const CompressorFactory& cFactory,
+    const DecompressorFactory& dFactory)
+{
+    std::vector<char> compressed = compress(cFactory);
+    size_t size = 0;
+    auto cb = [&size](char *, size_t bufsize)
+        { size += bufsize; };
+
+    while (state.keepRunning())
+    {
+        std::unique_ptr<Decompressor> d = dFactory(cb);
+        d->decompress(compressed.data(), compressed.size());
+        d->done();
+    }
+    state.setItemsProcessed(state.iterations() * NumPoints);
+    state.setBytesProcessed(size);
+}
+
+void registerCodec(const std::string& name, const CompressorFactory& c,
+    const DecompressorFactory& d)
+{
+    registerBenchmark("Compression/" + name + "/compress",
+        [c](State& state){ compressBench(state, c); });
+    registerBenchmark("Compression/" + name + "/decompress",
+        [c, d](State& state){ decompressBench(state, c, d); });
+}
+
+Registrar registrar([]()
+{
+#ifdef PDAL_HAVE_ZLIB
+    registerCodec("deflate",
+        [](BlockCb cb)
+            { return std::unique_ptr<Compressor>(new DeflateCompressor(cb)); },
+        [](BlockCb cb)
+            { return std::unique_ptr<Decompressor>(
+                new DeflateDecompressor(cb)); });
+#endif
+#ifdef PDAL_HAVE_ZSTD
+    registerCodec("zstd",
+        [](BlockCb cb)
+            { return std::unique_ptr<Compressor>(new ZstdCompressor(cb)); },
+        [](BlockCb cb)
+            { return std::unique_ptr<Decompressor>(
+                new ZstdDecompressor(cb)); });
+#endif
+#ifdef PDAL_HAVE_LZMA
+    registerCodec("lzma",
+        [](BlockCb cb)
+            { return std::unique_ptr<Compressor>(new LzmaCompressor(cb)); },
+        [](BlockCb cb)
+            { return std::unique_ptr<Decompressor>(
+                new LzmaDecompressor(cb)); });
+#endif
+#ifdef PDAL_HAVE_LAZPERF
+    registerCodec("lazperf",
+        [](BlockCb cb)
+            { return std::unique_ptr<Compressor>(
+                new LazPerfCompressor(cb, data().dims)); },
+        [](BlockCb cb)
+            { return std::unique_ptr<Decompressor>(
+                new LazPerfDecompressor(cb, data().dims, NumPoints)); });
+#endif
+});
+
+} // unnamed namespace
@@ -0,0 +1,111 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "Benchmark.hpp"
+
+#include <pdal/StageFactory.hpp>
+#include <io/BufferReader.hpp>
+
+using namespace pdal;
+using namespace pdal::bench;
+
+namespace
+{
+
+// Run a filter on a fresh copy of the same points in each iteration.
+void filterBench(State& state, const std::string& name, const Options& opts,
+    point_count_t count)
+{
+    PointTable srcTable;
+    PointViewPtr src = fauxPoints(srcTable, "uniform", count);
+
+    while (state.keepRunning())
+    {
+        state.pauseTiming();
+        StageFactory factory;
+        Stage *filter = factory.createStage(name);
+        if (!filter)
+        {
+            state.skip("Stage '" + name + "' isn't available.");
+            continue;
+        }
+
+        PointTable table;
+        table.layout()->registerDims(srcTable.layout()->dims());
+        BufferReader reader;
+        filter->setOptions(opts);
+        filter->setInput(reader);
+        filter->prepare(table);
+        reader.addView(copyView(*src, table));
+        state.resumeTiming();
+
+        filter->execute(table);
+    }
+    state.setItemsProcessed(state.iterations() * count);
+}
+
+void add(const std::string& name, const Options& opts, point_count_t count)
+{
+    registerBenchmark("Filter/" + name + "/" + std::to_string(count),
+        [name, opts, count](State& state)
+            { filterBench(state, name, opts, count); });
+}
+
+Registrar registrar([]()
+{
+    Options range;
+    range.add("limits", "Z[20:80]");
+    add("filters.range", range, 1000000);
+
+    Options crop;
+    crop.add("bounds", "([100, 900], [100, 900])");
+    add("filters.crop", crop, 1000000);
+
+    Options assign;
+    assign.add("assignment", "Z[0:10]=10");
+    add("filters.assign", assign, 1000000);
+
+    Options decimation;
+    decimation.add("step", 10);
+    add("filters.decimation", decimation, 1000000);
+
+    Options sort;
+    sort.add("dimension", "X");
+    add("filters.sort", sort, 1000000);
+
+    add("filters.stats", Options(), 1000000);
+    add("filters.outlier", Options(), 100000);
+});
+
+} // unnamed namespace
@@ -0,0 +1,120 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "Benchmark.hpp"
+
+#include <pdal/KDIndex.hpp>
+
+using namespace pdal;
+using namespace pdal::bench;
+
+namespace
+{
+
+const point_count_t NumPoints = 100000;
+const point_count_t NumQueries = 10000;
+const point_count_t K = 8;
+
+} // unnamed namespace
+
+
+PDAL_BENCH(KD3Index_build)
+{
+    PointTable table;
+    PointViewPtr view = fauxPoints(table, "uniform", NumPoints);
+
+    while (state.keepRunning())
+    {
+        KD3Index index(*view);
+        index.build();
+        keep(index);
+    }
+    state.setItemsProcessed(state.iterations() * view->size());
+}
+
+
+PDAL_BENCH(KD3Index_knn)
+{
+    PointTable table;
+    PointViewPtr view = fauxPoints(table, "uniform", NumPoints);
+    KD3Index index(*view);
+    index.build();
+
+    std::vector<PointId> ids(K);
+    std::vector<double> dists(K);
+    while (state.keepRunning())
+    {
+        for (PointId idx = 0; idx < NumQueries; ++idx)
+            index.knnSearch(idx, K, &ids, &dists);
+        keep(ids[0]);
+    }
+    state.setItemsProcessed(state.iterations() * NumQueries);
+}
+
+
+PDAL_BENCH(KD3Index_radius)
+{
+    PointTable table;
+    PointViewPtr view = fauxPoints(table, "uniform", NumPoints);
+    KD3Index index(*view);
+    index.build();
+
+    while (state.keepRunning())
+    {
+        size_t count = 0;
+        for (PointId idx = 0; idx < NumQueries; ++idx)
+            count += index.radius(idx, 10).size();
+        keep(count);
+    }
+    state.setItemsProcessed(state.iterations() * NumQueries);
+}
+
+
+PDAL_BENCH(KD3Index_knnSearchAll)
+{
+    PointTable table;
+    PointViewPtr view = fauxPoints(table, "uniform", NumPoints);
+    KD3Index index(*view);
+    index.build();
+
+    while (state.keepRunning())
+    {
+        std::vector<PointId> nearest(view->size());
+        index.knnSearchAll(K, [&nearest](PointId idx,
+            const std::vector<PointId>& ids, const std::vector<double>&)
+            { nearest[idx] = ids.back(); });
+        keep(nearest[0]);
+    }
+    state.setItemsProcessed(state.iterations() * view->size());
+}
@@ -0,0 +1,133 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "Benchmark.hpp"
+
+#include <pdal/pdal_features.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <io/BufferReader.hpp>
+#include <io/LasReader.hpp>
+#include <io/LasWriter.hpp>
+
+using namespace pdal;
+using namespace pdal::bench;
+
+namespace
+{
+
+const point_count_t NumPoints = 1000000;
+
+void write(const PointViewPtr& view, PointTableRef table,
+    const std::string& filename, const std::string& compression)
+{
+    BufferReader reader;
+    reader.addView(view);
+
+    Options opts;
+    opts.add("filename", filename);
+    opts.add("dataformat_id", 1);
+    if (compression.size())
+        opts.add("compression", compression);
+
+    LasWriter writer;
+    writer.setOptions(opts);
+    writer.setInput(reader);
+    writer.prepare(table);
+    writer.execute(table);
+}
+
+void lasWrite(State& state, const std::string& compression,
+    const std::string& ext)
+{
+    PointTable table;
+    PointViewPtr view = fauxPoints(table, "uniform", NumPoints);
+    std::string filename = FileUtils::uniqueFilename("", "pdal_bench") + ext;
+
+    while (state.keepRunning())
+        write(view, table, filename, compression);
+    state.setItemsProcessed(state.iterations() * view->size());
+    state.setBytesProcessed(state.iterations() *
+        FileUtils::fileSize(filename));
+    FileUtils::deleteFile(filename);
+}
+
+void lasRead(State& state, const std::string& compression,
+    const std::string& ext)
+{
+    std::string filename = FileUtils::uniqueFilename("", "pdal_bench") + ext;
+    {
+        PointTable table;
+        write(fauxPoints(table, "uniform", NumPoints), table, filename,
+            compression);
+    }
+
+    Options opts;
+    opts.add("filename", filename);
+    point_count_t count = 0;
+    while (state.keepRunning())
+    {
+        PointTable table;
+        LasReader reader;
+        reader.setOptions(opts);
+        reader.prepare(table);
+        PointViewSet set = reader.execute(table);
+        count += (*set.begin())->size();
+    }
+    state.setItemsProcessed(count);
+    state.setBytesProcessed(state.iterations() *
+        FileUtils::fileSize(filename));
+    FileUtils::deleteFile(filename);
+}
+
+#if defined(PDAL_HAVE_LAZPERF)
+const std::string LazCompression("lazperf");
+#elif defined(PDAL_HAVE_LASZIP)
+const std::string LazCompression("laszip");
+#endif
+
+Registrar registrar([]()
+{
+    registerBenchmark("LAS/write", [](State& state)
+        { lasWrite(state, "", ".las"); });
+    registerBenchmark("LAS/read", [](State& state)
+        { lasRead(state, "", ".las"); });
+#if defined(PDAL_HAVE_LAZPERF) || defined(PDAL_HAVE_LASZIP)
+    registerBenchmark("LAZ/write", [](State& state)
+        { lasWrite(state, LazCompression, ".laz"); });
+    registerBenchmark("LAZ/read", [](State& state)
+        { lasRead(state, LazCompression, ".laz"); });
+#endif
+});
+
+} // unnamed namespace
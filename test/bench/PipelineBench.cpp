@@ -0,0 +1,103 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "Benchmark.hpp"
+
+#include <pdal/StageFactory.hpp>
+#include <io/FauxReader.hpp>
+#include <io/NullWriter.hpp>
+
+using namespace pdal;
+using namespace pdal::bench;
+
+namespace
+{
+
+// Read faux points, drop some with filters.range and discard the rest.
+void pipelineBench(State& state, const std::string& mode,
+    point_count_t count, bool stream)
+{
+    Options readerOpts;
+    readerOpts.add("mode", mode);
+    readerOpts.add("count", count);
+    readerOpts.add("bounds", BOX3D(0, 0, 0, 1000, 1000, 100));
+    readerOpts.add("mean_x", 500);
+    readerOpts.add("mean_y", 500);
+    readerOpts.add("mean_z", 50);
+    readerOpts.add("stdev_x", 100);
+    readerOpts.add("stdev_y", 100);
+    readerOpts.add("stdev_z", 10);
+
+    Options filterOpts;
+    filterOpts.add("limits", "Z[10:90]");
+
+    while (state.keepRunning())
+    {
+        StageFactory factory;
+        FauxReader reader;
+        reader.setOptions(readerOpts);
+        Stage *filter = factory.createStage("filters.range");
+        filter->setOptions(filterOpts);
+        filter->setInput(reader);
+        NullWriter writer;
+        writer.setInput(*filter);
+
+        if (stream)
+        {
+            FixedPointTable table(10000);
+            writer.prepare(table);
+            writer.execute(table);
+        }
+        else
+        {
+            PointTable table;
+            writer.prepare(table);
+            writer.execute(table);
+        }
+    }
+    state.setItemsProcessed(state.iterations() * count);
+}
+
+Registrar registrar([]()
+{
+    for (std::string mode : { "uniform", "normal", "ramp" })
+        for (point_count_t count : { 100000, 1000000 })
+            for (bool stream : { false, true })
+                registerBenchmark("Pipeline/" + mode + "/" +
+                    std::to_string(count) + (stream ? "/stream" : "/standard"),
+                    [mode, count, stream](State& state)
+                        { pipelineBench(state, mode, count, stream); });
+});
+
+} // unnamed namespace
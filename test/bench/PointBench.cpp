@@ -0,0 +1,138 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "Benchmark.hpp"
+
+using namespace pdal;
+using namespace pdal::bench;
+
+namespace
+{
+
+const point_count_t NumPoints = 1000000;
+
+} // unnamed namespace
+
+
+PDAL_BENCH(PointView_setField)
+{
+    PointTable table;
+    table.layout()->registerDims({ Dimension::Id::X, Dimension::Id::Y,
+        Dimension::Id::Z, Dimension::Id::Intensity });
+    table.finalize();
+
+    while (state.keepRunning())
+    {
+        PointView view(table);
+        for (PointId idx = 0; idx < NumPoints; ++idx)
+        {
+            view.setField(Dimension::Id::X, idx, (double)idx);
+            view.setField(Dimension::Id::Y, idx, (double)idx);
+            view.setField(Dimension::Id::Z, idx, (double)idx);
+            view.setField(Dimension::Id::Intensity, idx, (uint16_t)idx);
+        }
+        keep(view.size());
+    }
+    state.setItemsProcessed(state.iterations() * NumPoints);
+}
+
+
+PDAL_BENCH(PointView_getFieldAs)
+{
+    PointTable table;
+    PointViewPtr view = fauxPoints(table, "uniform", NumPoints);
+
+    while (state.keepRunning())
+    {
+        double sum = 0;
+        for (PointId idx = 0; idx < view->size(); ++idx)
+            sum += view->getFieldAs<double>(Dimension::Id::X, idx);
+        keep(sum);
+    }
+    state.setItemsProcessed(state.iterations() * view->size());
+}
+
+
+PDAL_BENCH(PointRef_getFieldAs)
+{
+    PointTable table;
+    PointViewPtr view = fauxPoints(table, "uniform", NumPoints);
+
+    while (state.keepRunning())
+    {
+        double sum = 0;
+        PointRef point(*view, 0);
+        for (PointId idx = 0; idx < view->size(); ++idx)
+        {
+            point.setPointId(idx);
+            sum += point.getFieldAs<double>(Dimension::Id::X);
+        }
+        keep(sum);
+    }
+    state.setItemsProcessed(state.iterations() * view->size());
+}
+
+
+PDAL_BENCH(PointView_getPackedPoint)
+{
+    PointTable table;
+    PointViewPtr view = fauxPoints(table, "uniform", NumPoints);
+    DimTypeList dims = table.layout()->dimTypes();
+    std::vector<char> buf(table.layout()->pointSize());
+
+    while (state.keepRunning())
+    {
+        for (PointId idx = 0; idx < view->size(); ++idx)
+            view->getPackedPoint(dims, idx, buf.data());
+        keep(buf[0]);
+    }
+    state.setItemsProcessed(state.iterations() * view->size());
+    state.setBytesProcessed(state.iterations() * view->size() * buf.size());
+}
+
+
+PDAL_BENCH(PointView_append)
+{
+    PointTable table;
+    PointViewPtr view = fauxPoints(table, "uniform", NumPoints);
+
+    while (state.keepRunning())
+    {
+        PointViewPtr copy = view->makeNew();
+        for (PointId idx = 0; idx < view->size(); ++idx)
+            copy->appendPoint(*view, idx);
+        keep(copy->size());
+    }
+    state.setItemsProcessed(state.iterations() * view->size());
+}
@@ -124,7 +124,10 @@ TEST(BoundsTest, test_clip)
 	EXPECT_DOUBLE_EQ(r1.miny, 40);
 	EXPECT_DOUBLE_EQ(r1.maxy, 8);
 
-//ABELL - Need BOX3D example.
+    BOX3D b1(0, 0, 0, 10, 10, 10);
+    BOX3D b2(1, 2, 3, 11, 12, 7);
+    b1.clip(b2);
+    EXPECT_TRUE(b1 == BOX3D(1, 2, 3, 10, 10, 7));
 }
 
 TEST(BoundsTest, test_intersect)
@@ -39,7 +39,11 @@
 
 #include <Eigen/Dense>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
 #include <limits>
+#include <random>
 
 using namespace pdal;
 
@@ -61,6 +65,79 @@ TEST(EigenTest, PointViewToEigen)
     EXPECT_EQ(expected, actual);
 }
 
+TEST(EigenTest, CovarianceEigen)
+{
+    using namespace Eigen;
+
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::X);
+    table.layout()->registerDim(Dimension::Id::Y);
+    table.layout()->registerDim(Dimension::Id::Z);
+    PointView view(table);
+
+    // Noisy points about a tilted plane, far from the origin.
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> dist(-5, 5);
+    std::normal_distribution<double> noise(0, .01);
+    std::vector<PointId> ids;
+    for (PointId i = 0; i < 50; ++i)
+    {
+        double x = dist(gen);
+        double y = dist(gen);
+        view.setField(Dimension::Id::X, i, 637000 + x);
+        view.setField(Dimension::Id::Y, i, 851000 + y);
+        view.setField(Dimension::Id::Z, i, 400 + .3 * x - .2 * y + noise(gen));
+        ids.push_back(i);
+    }
+
+    // Reference: iterative solver on the covariance of the demeaned points.
+    MatrixXd A = eigen::pointViewToEigen(view);
+    MatrixXd centered = A.rowwise() - A.colwise().mean();
+    Matrix3d cov = centered.transpose() * centered / (A.rows() - 1);
+    SelfAdjointEigenSolver<Matrix3d> solver(cov);
+
+    Matrix3f B = eigen::computeCovariance(view, ids);
+    for (size_t i = 0; i < 9; ++i)
+        EXPECT_NEAR(cov(i), B(i), 1e-5);
+
+    Vector3f eval;
+    Matrix3f evec;
+    ASSERT_TRUE(eigen::computeCovarianceEigen(view, ids, eval, &evec));
+    for (int i = 0; i < 3; ++i)
+    {
+        EXPECT_NEAR(solver.eigenvalues()[i], eval[i], 1e-5);
+        Vector3d v = evec.col(i).cast<double>();
+        EXPECT_NEAR(1.0, std::fabs(v.dot(solver.eigenvectors().col(i))),
+            1e-4);
+    }
+    EXPECT_EQ(2, eigen::computeRank(view, ids, 0.01));
+
+    // Coordinates held in an array give the same result.
+    std::vector<double> coords;
+    for (PointId i = 0; i < view.size(); ++i)
+        for (Dimension::Id d :
+                { Dimension::Id::X, Dimension::Id::Y, Dimension::Id::Z })
+            coords.push_back(view.getFieldAs<double>(d, i));
+    Vector3f eval2;
+    Matrix3f evec2;
+    ASSERT_TRUE(eigen::computeCovarianceEigen(coords.data(), ids, eval2,
+        &evec2));
+    EXPECT_EQ(eval, eval2);
+    EXPECT_EQ(evec, evec2);
+
+    // Collapse the points onto a line.
+    for (PointId i = 0; i < view.size(); ++i)
+        view.setField(Dimension::Id::Y, i, 851000 +
+            view.getFieldAs<double>(Dimension::Id::X, i) - 637000);
+    for (PointId i = 0; i < view.size(); ++i)
+        view.setField(Dimension::Id::Z, i, 400.0);
+    EXPECT_EQ(1, eigen::computeRank(view, ids, 0.01));
+
+    // A single point has no covariance.
+    std::vector<PointId> one { 0 };
+    EXPECT_FALSE(eigen::computeCovarianceEigen(view, one, eval));
+}
+
 TEST(EigenTest, ComputeValues)
 {
     using namespace Eigen;
@@ -251,6 +328,121 @@ TEST(EigenTest, Morphological)
     EXPECT_EQ(0, Fv2[12]);
 }
 
+namespace
+{
+
+enum class Shape
+{
+    Diamond,
+    Disk,
+    Square
+};
+
+// Reference dilation or erosion of a column-major raster that visits every
+// cell of the structuring element.
+std::vector<double> bruteMorph(const std::vector<double>& data, int rows,
+    int cols, int radius, Shape shape, bool dilate)
+{
+    std::vector<double> out(data.size());
+    for (int c = 0; c < cols; ++c)
+        for (int r = 0; r < rows; ++r)
+        {
+            double v = dilate ? std::numeric_limits<double>::lowest() :
+                (std::numeric_limits<double>::max)();
+            for (int col = (std::max)(c - radius, 0);
+                    col <= (std::min)(c + radius, cols - 1); ++col)
+                for (int row = (std::max)(r - radius, 0);
+                        row <= (std::min)(r + radius, rows - 1); ++row)
+                {
+                    int dr = row - r;
+                    int dc = col - c;
+                    if (shape == Shape::Diamond &&
+                            std::abs(dr) + std::abs(dc) > radius)
+                        continue;
+                    if (shape == Shape::Disk &&
+                            dr * dr + dc * dc > radius * radius)
+                        continue;
+                    double d = data[col * rows + row];
+                    v = dilate ? (std::max)(v, d) : (std::min)(v, d);
+                }
+            out[c * rows + r] = v;
+        }
+    return out;
+}
+
+std::vector<double> randomRaster(size_t size)
+{
+    std::mt19937 gen(size);
+    std::uniform_real_distribution<double> dist(0, 100);
+
+    std::vector<double> data(size);
+    for (double& d : data)
+        d = dist(gen);
+    return data;
+}
+
+} // unnamed namespace
+
+TEST(EigenTest, MorphologicalLarge)
+{
+    const int rows = 37;
+    const int cols = 23;
+    std::vector<double> data = randomRaster(rows * cols);
+
+    for (int i = 0; i < 12; ++i)
+    {
+        EXPECT_EQ(eigen::dilateDiamond(data, rows, cols, i),
+            bruteMorph(data, rows, cols, i, Shape::Diamond, true));
+        EXPECT_EQ(eigen::erodeDiamond(data, rows, cols, i),
+            bruteMorph(data, rows, cols, i, Shape::Diamond, false));
+        EXPECT_EQ(eigen::dilateSquare(data, rows, cols, i),
+            bruteMorph(data, rows, cols, i, Shape::Square, true));
+        EXPECT_EQ(eigen::erodeSquare(data, rows, cols, i),
+            bruteMorph(data, rows, cols, i, Shape::Square, false));
+    }
+
+    // A raster one cell wide only has neighbors along its length.
+    std::vector<double> line = randomRaster(50);
+    EXPECT_EQ(eigen::dilateDiamond(line, 1, 50, 7),
+        bruteMorph(line, 1, 50, 7, Shape::Diamond, true));
+    EXPECT_EQ(eigen::erodeDiamond(line, 50, 1, 7),
+        bruteMorph(line, 50, 1, 7, Shape::Diamond, false));
+}
+
+TEST(EigenTest, OpenClose)
+{
+    using namespace Eigen;
+
+    const int rows = 31;
+    const int cols = 26;
+    std::vector<double> data = randomRaster(rows * cols);
+    MatrixXd m = Map<MatrixXd>(data.data(), rows, cols);
+
+    for (int radius = 1; radius < 9; ++radius)
+    {
+        MatrixXd padded = eigen::padMatrix(m, radius);
+        std::vector<double> p(padded.data(), padded.data() + padded.size());
+        int prows = padded.rows();
+        int pcols = padded.cols();
+
+        std::vector<double> maxZ =
+            bruteMorph(p, prows, pcols, radius, Shape::Disk, true);
+        std::vector<double> closed =
+            bruteMorph(maxZ, prows, pcols, radius, Shape::Disk, false);
+        MatrixXd expected = Map<MatrixXd>(closed.data(), prows, pcols).
+            block(radius, radius, rows, cols);
+        EXPECT_EQ(eigen::matrixClose(m, radius), expected);
+
+        std::vector<double> minZ =
+            bruteMorph(p, prows, pcols, radius, Shape::Disk, false);
+        std::vector<double> opened =
+            bruteMorph(minZ, prows, pcols, radius, Shape::Disk, true);
+        expected = Map<MatrixXd>(opened.data(), prows, pcols).
+            block(radius, radius, rows, cols);
+        EXPECT_EQ(eigen::matrixOpen(m, radius), expected);
+    }
+}
+
 TEST(EigenTest, RoundtripString)
 {
     Eigen::MatrixXd identity = Eigen::MatrixXd::Identity(4, 4);
@@ -0,0 +1,164 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (hobu.inc@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <sstream>
+
+#include <pdal/util/ByteSwap.hpp>
+#include <pdal/util/Extractor.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/Inserter.hpp>
+#include <pdal/util/IStream.hpp>
+#include <pdal/util/OStream.hpp>
+#include "Support.hpp"
+
+using namespace pdal;
+
+// Bulk and single values written to a file read back in either form.
+TEST(EndianStreamTest, file)
+{
+    std::string filename(Support::temppath("lestream.bin"));
+    FileUtils::deleteFile(filename);
+
+    std::vector<double> d { 1.5, -2.25, 1e300 };
+    std::vector<int32_t> i { -1, 0x01020304, 7 };
+    {
+        OLeStream out(filename);
+        out.write(d.data(), d.size());
+        out << (uint8_t)200 << (int16_t)-300;
+        out.write(i.data(), i.size());
+    }
+
+    ILeStream in(filename);
+    double d0, d1, d2;
+    in >> d0 >> d1 >> d2;
+    EXPECT_EQ(d0, d[0]);
+    EXPECT_EQ(d1, d[1]);
+    EXPECT_EQ(d2, d[2]);
+
+    uint8_t u8;
+    int16_t i16;
+    in >> u8 >> i16;
+    EXPECT_EQ(u8, 200);
+    EXPECT_EQ(i16, -300);
+
+    std::vector<int32_t> i2(i.size());
+    in.read(i2.data(), i2.size());
+    EXPECT_EQ(i, i2);
+    EXPECT_TRUE((bool)in);
+
+    // Reading past the end fails the stream as std::istream does.
+    uint32_t u32;
+    in >> u32;
+    EXPECT_FALSE((bool)in);
+
+    in.close();
+    FileUtils::deleteFile(filename);
+}
+
+TEST(EndianStreamTest, bigEndian)
+{
+    std::stringstream ss;
+    OBeStream out(&ss);
+    std::vector<uint32_t> v { 0x01020304, 5 };
+    out.write(v.data(), v.size());
+    out << (uint16_t)0x0607;
+
+    std::string s = ss.str();
+    ASSERT_EQ(s.size(), 10u);
+    EXPECT_EQ(s[0], 1);
+    EXPECT_EQ(s[3], 4);
+    EXPECT_EQ(s[8], 6);
+
+    IBeStream in(&ss);
+    std::vector<uint32_t> v2(v.size());
+    uint16_t u16;
+    in.read(v2.data(), v2.size());
+    in >> u16;
+    EXPECT_EQ(v, v2);
+    EXPECT_EQ(u16, 0x0607);
+}
+
+// Counts that leave part of a vector exercise the scalar tail.
+TEST(EndianStreamTest, byteSwap)
+{
+    for (size_t size : { 1, 2, 4, 8 })
+        for (size_t count : { 0, 1, 7, 8, 9, 33 })
+        {
+            std::vector<char> src(size * count);
+            for (size_t i = 0; i < src.size(); ++i)
+                src[i] = (char)(i * 7 + 1);
+            std::vector<char> dst(src.size());
+            Utils::byteSwap(src.data(), dst.data(), size, count);
+            for (size_t i = 0; i < count; ++i)
+                for (size_t b = 0; b < size; ++b)
+                    EXPECT_EQ(dst[i * size + b],
+                        src[i * size + size - 1 - b]);
+
+            // Swapping in place gives the same result.
+            Utils::byteSwap(src.data(), src.data(), size, count);
+            EXPECT_EQ(src, dst);
+        }
+}
+
+TEST(EndianStreamTest, bulkExtract)
+{
+    std::vector<char> buf(100);
+    std::vector<double> d { 1.5, -2.25, 3 };
+    std::vector<int16_t> s { -5, 0x0102 };
+
+    BeInserter ins(buf.data(), buf.size());
+    ins.put(d.data(), d.size());
+    ins << (uint8_t)9;
+    ins.put(s.data(), s.size());
+    EXPECT_EQ(buf[24], 9);
+    EXPECT_EQ(buf[27], 1);
+
+    BeExtractor ext(buf.data(), buf.size());
+    std::vector<double> d2(d.size());
+    std::vector<int16_t> s2(s.size());
+    uint8_t u8;
+    ext.get(d2.data(), d2.size());
+    ext >> u8;
+    ext.get(s2.data(), s2.size());
+    EXPECT_EQ(d, d2);
+    EXPECT_EQ(u8, 9);
+    EXPECT_EQ(s, s2);
+
+    SwitchableExtractor sext(buf.data(), buf.size(), false);
+    sext.get(d2.data(), d2.size());
+    EXPECT_EQ(d, d2);
+}
@@ -82,6 +82,104 @@ TEST(FileUtilsTest, test_file_ops)
     EXPECT_NO_THROW(FileUtils::openFile("foo~1.glob"));
 }
 
+// Closing a synchronous file must not treat the deleted stream as an
+// asynchronous one.
+TEST(FileUtilsTest, syncClose)
+{
+    std::string tmp(Support::temppath("sync.tmp"));
+    FileUtils::deleteFile(tmp);
+
+    std::ostream* ostr = FileUtils::createFile(tmp);
+    ASSERT_TRUE(ostr);
+    *ostr << "contents";
+    FileUtils::closeFile(ostr);
+
+    EXPECT_EQ(FileUtils::readFileIntoString(tmp), "contents");
+    FileUtils::deleteFile(tmp);
+}
+
+// Seeking in an asynchronous stream has to account for data that's
+// buffered but not yet written.
+TEST(FileUtilsTest, async)
+{
+    std::string tmp(Support::temppath("async.tmp"));
+    FileUtils::deleteFile(tmp);
+
+    std::ostream* ostr = FileUtils::createFile(tmp, true, true);
+    ASSERT_TRUE(ostr);
+
+    std::string expected("HEADER");
+    *ostr << expected;
+    for (int i = 0; i < 2000000; ++i)
+    {
+        std::string s(std::to_string(i));
+        *ostr << s;
+        expected += s;
+    }
+    EXPECT_EQ((size_t)ostr->tellp(), expected.size());
+
+    ostr->seekp(0);
+    *ostr << "header";
+    expected.replace(0, 6, "header");
+    ostr->seekp(0, std::ios::end);
+    *ostr << "end";
+    expected += "end";
+    EXPECT_EQ((size_t)ostr->tellp(), expected.size());
+    FileUtils::closeFile(ostr);
+
+    EXPECT_EQ(FileUtils::readFileIntoString(tmp), expected);
+    FileUtils::deleteFile(tmp);
+
+    EXPECT_FALSE(FileUtils::createFile(
+        Support::temppath("nodir/async.tmp"), true, true));
+}
+
+// Reads and seeks in a stream that reads ahead see the file as it is,
+// whether or not they cross the windows read in the background.
+TEST(FileUtilsTest, readAhead)
+{
+    std::string tmp(Support::temppath("readahead.tmp"));
+    FileUtils::deleteFile(tmp);
+
+    std::string expected;
+    for (int i = 0; i < 100000; ++i)
+        expected += std::to_string(i);
+    std::ostream* ostr = FileUtils::createFile(tmp);
+    *ostr << expected;
+    FileUtils::closeFile(ostr);
+
+    // Small windows so that reads cross many of them.
+    std::istream* istr = FileUtils::openFile(tmp, true, 1000);
+    ASSERT_TRUE(istr);
+
+    std::string buf(2500, ' ');
+    istr->read(&buf[0], buf.size());
+    EXPECT_EQ(buf, expected.substr(0, 2500));
+    EXPECT_EQ((size_t)istr->tellg(), 2500u);
+
+    // Back into the window before, within the current one, and far ahead.
+    for (size_t pos : { (size_t)1500, (size_t)2100, (size_t)300000 })
+    {
+        istr->seekg(pos);
+        istr->read(&buf[0], 100);
+        EXPECT_EQ(buf.substr(0, 100), expected.substr(pos, 100));
+    }
+
+    istr->seekg(-10, std::ios::end);
+    istr->read(&buf[0], 100);
+    EXPECT_EQ((size_t)istr->gcount(), 10u);
+    EXPECT_TRUE(istr->eof());
+    EXPECT_EQ(buf.substr(0, 10), expected.substr(expected.size() - 10));
+
+    istr->clear();
+    istr->seekg(0);
+    std::string all((std::istreambuf_iterator<char>(*istr)),
+        std::istreambuf_iterator<char>());
+    EXPECT_EQ(all, expected);
+    FileUtils::closeFile(istr);
+    FileUtils::deleteFile(tmp);
+}
+
 TEST(FileUtilsTest, test_readFileIntoString)
 {
     const std::string filename = Support::datapath("text/text.txt");
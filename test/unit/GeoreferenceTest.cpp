@@ -37,6 +37,7 @@
 #include <pdal/util/Georeference.hpp>
 
 #include <cmath>
+#include <vector>
 
 
 namespace pdal
@@ -124,5 +125,23 @@ TEST(Georeference, WithImu)
     EXPECT_DOUBLE_EQ(2.0000004696006983, point.Y);
     EXPECT_DOUBLE_EQ(3, point.Z);
 }
+
+TEST(Georeference, Returns)
+{
+    RotationMatrix boresight(0, 1, 0, 0, 0, -1, -1, 0, 0);
+    RotationMatrix imu(1, 0, 0, 0, 0, 1, 0, -1, 0);
+    Xyz gps(-1.4, 0.6, 300);
+    double ranges[] = { 800.5, 812.25, 830 };
+
+    std::vector<Xyz> points(3, Xyz(0, 0, 0));
+    georeferenceWgs84(ranges, 3, 0.25, boresight, imu, gps, points.data());
+    for (size_t i = 0; i < 3; ++i)
+    {
+        Xyz point = georeferenceWgs84(ranges[i], 0.25, boresight, imu, gps);
+        EXPECT_EQ(point.X, points[i].X);
+        EXPECT_EQ(point.Y, points[i].Y);
+        EXPECT_EQ(point.Z, points[i].Z);
+    }
+}
 }
 }
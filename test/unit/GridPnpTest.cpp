@@ -0,0 +1,192 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <cmath>
+#include <random>
+#include <thread>
+
+#include <pdal/private/pnp/GridPnp.hpp>
+
+using namespace pdal;
+
+namespace
+{
+
+using Point = GridPnp::Point;
+using Ring = GridPnp::Ring;
+
+Ring square(double xmin, double ymin, double xmax, double ymax)
+{
+    return Ring { {xmin, ymin}, {xmax, ymin}, {xmax, ymax}, {xmin, ymax},
+        {xmin, ymin} };
+}
+
+// A star with 'count' vertices, which has lots of edges in lots of cells.
+Ring star(size_t count, double inner, double outer)
+{
+    const double pi = 3.14159265358979323846;
+
+    Ring r;
+    for (size_t i = 0; i < count; ++i)
+    {
+        double radius = (i % 2) ? inner : outer;
+        double angle = 2 * pi * i / count;
+        r.push_back({radius * std::cos(angle), radius * std::sin(angle)});
+    }
+    r.push_back(r.front());
+    return r;
+}
+
+// Plain even-odd ray casting to check the engine against.
+bool bruteInside(const std::vector<Ring>& rings, double x, double y)
+{
+    bool inside = false;
+    for (const Ring& r : rings)
+        for (size_t i = 0; i < r.size() - 1; ++i)
+        {
+            const Point& p1 = r[i];
+            const Point& p2 = r[i + 1];
+            if ((p1.second > y) != (p2.second > y) &&
+                x < (p2.first - p1.first) * (y - p1.second) /
+                    (p2.second - p1.second) + p1.first)
+                inside = !inside;
+        }
+    return inside;
+}
+
+} // unnamed namespace
+
+TEST(GridPnpTest, hole)
+{
+    GridPnp g(square(0, 0, 10, 10), { square(4, 4, 6, 6) });
+
+    EXPECT_TRUE(g.inside(1, 1));
+    EXPECT_TRUE(g.inside(9, 5));
+    EXPECT_FALSE(g.inside(5, 5));
+    EXPECT_FALSE(g.inside(-1, 5));
+    EXPECT_FALSE(g.inside(11, 5));
+    EXPECT_FALSE(g.inside(5, 100));
+
+    // Points on edges are inside.
+    EXPECT_TRUE(g.inside(0, 5));
+    EXPECT_TRUE(g.inside(4, 5));
+}
+
+TEST(GridPnpTest, multiPolygon)
+{
+    // Two polygons, the second with a hole.
+    std::vector<Ring> rings { square(0, 0, 10, 10),
+        square(100, 100, 110, 110), square(104, 104, 106, 106) };
+    GridPnp g(rings);
+
+    EXPECT_TRUE(g.inside(5, 5));
+    EXPECT_TRUE(g.inside(101, 101));
+    EXPECT_FALSE(g.inside(105, 105));
+    EXPECT_FALSE(g.inside(50, 50));
+    EXPECT_FALSE(g.inside(5, 105));
+}
+
+TEST(GridPnpTest, invalid)
+{
+    EXPECT_THROW(GridPnp(Ring { {0, 0}, {1, 0}, {0, 0} }), grid_error);
+    EXPECT_THROW(GridPnp(Ring { {0, 0}, {1, 0}, {1, 1}, {0, 1} }),
+        grid_error);
+    EXPECT_THROW(GridPnp(square(0, 0, 10, 0)), grid_error);
+    EXPECT_THROW(GridPnp(std::vector<Ring>()), grid_error);
+}
+
+TEST(GridPnpTest, batch)
+{
+    std::vector<Ring> rings { star(2000, 50, 100), square(-20, -20, 20, 20),
+        square(200, 200, 300, 250) };
+    GridPnp g(rings);
+
+    std::mt19937 gen(1357);
+    std::uniform_real_distribution<double> dist(-120, 320);
+    std::vector<double> x(20000);
+    std::vector<double> y(20000);
+    for (size_t i = 0; i < x.size(); ++i)
+    {
+        x[i] = dist(gen);
+        y[i] = dist(gen);
+    }
+
+    std::vector<bool> result;
+    g.inside(x.data(), y.data(), x.size(), result);
+    ASSERT_EQ(result.size(), x.size());
+    size_t count = 0;
+    for (size_t i = 0; i < x.size(); ++i)
+    {
+        EXPECT_EQ(result[i], g.inside(x[i], y[i]));
+        EXPECT_EQ(result[i], bruteInside(rings, x[i], y[i]));
+        if (result[i])
+            count++;
+    }
+    EXPECT_GT(count, 0u);
+    EXPECT_LT(count, x.size());
+}
+
+// A polygon with enough edges that the grid is built in parallel.  Make
+// sure it's correct and gets the same answers from several threads.
+TEST(GridPnpTest, large)
+{
+    std::vector<Ring> rings { star(200000, 90, 100) };
+    GridPnp g(rings);
+
+    std::mt19937 gen(2468);
+    std::uniform_real_distribution<double> dist(-110, 110);
+    std::vector<double> x(500);
+    std::vector<double> y(500);
+    for (size_t i = 0; i < x.size(); ++i)
+    {
+        x[i] = dist(gen);
+        y[i] = dist(gen);
+    }
+
+    std::vector<bool> expected;
+    for (size_t i = 0; i < x.size(); ++i)
+        expected.push_back(bruteInside(rings, x[i], y[i]));
+
+    std::vector<std::vector<bool>> results(4);
+    std::vector<std::thread> threads;
+    for (auto& r : results)
+        threads.emplace_back([&g, &x, &y, &r]()
+            { g.inside(x.data(), y.data(), x.size(), r); });
+    for (auto& t : threads)
+        t.join();
+    for (auto& r : results)
+        EXPECT_EQ(r, expected);
+}
@@ -33,7 +33,13 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <algorithm>
+#include <random>
+
+#include <pdal/CompactKDIndex.hpp>
 #include <pdal/KDIndex.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include "Support.hpp"
 
 using namespace pdal;
 
@@ -356,3 +362,269 @@ TEST(KDIndex, radius3D)
     EXPECT_EQ(ids[2], 2u);
 }
 
+
+// Enough points that the tree is built on several threads.  The neighbors
+// found must be the same as those found by brute force.
+TEST(KDIndex, large3D)
+{
+    PointTable table;
+    PointLayoutPtr layout = table.layout();
+    PointView view(table);
+
+    layout->registerDim(Dimension::Id::X);
+    layout->registerDim(Dimension::Id::Y);
+    layout->registerDim(Dimension::Id::Z);
+
+    const PointId count = 100000;
+    std::mt19937 gen(12345);
+    std::uniform_real_distribution<double> dist(0, 1000);
+    for (PointId i = 0; i < count; ++i)
+    {
+        view.setField(Dimension::Id::X, i, dist(gen));
+        view.setField(Dimension::Id::Y, i, dist(gen));
+        // Lots of equal Z values exercise the split of equal coordinates.
+        view.setField(Dimension::Id::Z, i, (int)(dist(gen) / 100));
+    }
+
+    KD3Index index(view);
+    index.build();
+
+    auto distance = [&view](PointId id, double x, double y, double z)
+    {
+        double dx = x - view.getFieldAs<double>(Dimension::Id::X, id);
+        double dy = y - view.getFieldAs<double>(Dimension::Id::Y, id);
+        double dz = z - view.getFieldAs<double>(Dimension::Id::Z, id);
+        return dx * dx + dy * dy + dz * dz;
+    };
+
+    for (int q = 0; q < 20; ++q)
+    {
+        double x = dist(gen);
+        double y = dist(gen);
+        double z = dist(gen) / 100;
+
+        std::vector<double> expected;
+        for (PointId i = 0; i < count; ++i)
+            expected.push_back(distance(i, x, y, z));
+        std::sort(expected.begin(), expected.end());
+
+        std::vector<PointId> ids = index.neighbors(x, y, z, 10);
+        ASSERT_EQ(ids.size(), 10u);
+        for (size_t i = 0; i < ids.size(); ++i)
+            EXPECT_DOUBLE_EQ(distance(ids[i], x, y, z), expected[i]);
+
+        std::vector<PointId> inRadius = index.radius(x, y, z, 20);
+        size_t numExpected =
+            std::lower_bound(expected.begin(), expected.end(), 20.0 * 20.0) -
+            expected.begin();
+        EXPECT_EQ(inRadius.size(), numExpected);
+    }
+}
+
+TEST(KDIndex, searchAll)
+{
+    PointTable table;
+    PointLayoutPtr layout = table.layout();
+    PointView view(table);
+
+    layout->registerDim(Dimension::Id::X);
+    layout->registerDim(Dimension::Id::Y);
+    layout->registerDim(Dimension::Id::Z);
+
+    const PointId count = 10000;
+    std::mt19937 gen(54321);
+    std::uniform_real_distribution<double> dist(0, 100);
+    for (PointId i = 0; i < count; ++i)
+    {
+        view.setField(Dimension::Id::X, i, dist(gen));
+        view.setField(Dimension::Id::Y, i, dist(gen));
+        view.setField(Dimension::Id::Z, i, dist(gen));
+    }
+
+    KD3Index index(view);
+    index.build();
+
+    // Each point's results are stored on its own, since the callbacks
+    // run concurrently.
+    std::vector<std::vector<PointId>> knn(count);
+    std::vector<std::vector<PointId>> radius(count);
+    index.knnSearchAll(8, [&knn](PointId i, const std::vector<PointId>& ids,
+        const std::vector<double>& sqrDists)
+    {
+        EXPECT_EQ(ids.size(), sqrDists.size());
+        knn[i] = ids;
+    });
+    index.radiusAll(5, [&radius](PointId i, const std::vector<PointId>& ids,
+        const std::vector<double>&)
+    {
+        radius[i] = ids;
+    });
+    for (PointId i = 0; i < count; ++i)
+    {
+        EXPECT_EQ(knn[i], index.neighbors(i, 8));
+        EXPECT_EQ(radius[i], index.radius(i, 5));
+    }
+
+    // Query points from another view.
+    std::vector<PointId> ids { 3, 1, 4, 1000 };
+    std::vector<std::vector<PointId>> others(count);
+    index.knnSearchAll(view, ids, 3, [&others](PointId i,
+        const std::vector<PointId>& ids, const std::vector<double>&)
+    {
+        others[i] = ids;
+    });
+    for (PointId i : ids)
+        EXPECT_EQ(others[i], index.neighbors(i, 3));
+
+    // Exceptions thrown by the callback get to the caller.
+    EXPECT_THROW(index.knnSearchAll(4, [](PointId i,
+        const std::vector<PointId>&, const std::vector<double>&)
+    {
+        if (i == 5000)
+            throw pdal_error("Stop");
+    }), pdal_error);
+
+    // Fewer neighbors than asked for.
+    PointView small(table);
+    small.appendPoint(view, 0);
+    small.appendPoint(view, 1);
+    KD3Index smallIndex(small);
+    smallIndex.build();
+    smallIndex.knnSearchAll(8, [](PointId,
+        const std::vector<PointId>& ids, const std::vector<double>&)
+    {
+        EXPECT_EQ(ids.size(), 2u);
+    });
+}
+
+TEST(KDIndex, saveLoad)
+{
+    PointTable table;
+    PointLayoutPtr layout = table.layout();
+    PointView view(table);
+
+    layout->registerDim(Dimension::Id::X);
+    layout->registerDim(Dimension::Id::Y);
+    layout->registerDim(Dimension::Id::Z);
+
+    const PointId count = 1000;
+    std::mt19937 gen(999);
+    std::uniform_real_distribution<double> dist(0, 100);
+    for (PointId i = 0; i < count; ++i)
+    {
+        view.setField(Dimension::Id::X, i, dist(gen));
+        view.setField(Dimension::Id::Y, i, dist(gen));
+        view.setField(Dimension::Id::Z, i, dist(gen));
+    }
+
+    std::string filename(Support::temppath("kdindex.kdi"));
+    FileUtils::deleteFile(filename);
+
+    KD3Index index(view);
+    EXPECT_FALSE(index.load(filename));
+    index.build();
+    EXPECT_TRUE(index.save(filename));
+
+    KD3Index loaded(view);
+    EXPECT_TRUE(loaded.load(filename));
+    for (PointId i = 0; i < count; i += 10)
+    {
+        EXPECT_EQ(loaded.neighbors(i, 5), index.neighbors(i, 5));
+        EXPECT_EQ(loaded.radius(i, 10), index.radius(i, 10));
+    }
+
+    // A 2D index or different points don't match the file.
+    KD2Index index2(view);
+    EXPECT_FALSE(index2.load(filename));
+    view.setField(Dimension::Id::X, 0, 1000);
+    KD3Index changed(view);
+    EXPECT_FALSE(changed.load(filename));
+
+    // The view writes the file and then reads it back.
+    FileUtils::deleteFile(filename);
+    view.build3dIndex(filename);
+    EXPECT_TRUE(FileUtils::fileExists(filename));
+    KD3Index reloaded(view);
+    EXPECT_TRUE(reloaded.load(filename));
+
+    FileUtils::deleteFile(filename);
+}
+
+TEST(KDIndex, compact)
+{
+    PointTable table;
+    PointLayoutPtr layout = table.layout();
+    PointView view(table);
+
+    layout->registerDim(Dimension::Id::X);
+    layout->registerDim(Dimension::Id::Y);
+    layout->registerDim(Dimension::Id::Z);
+
+    // Projected coordinates far from the origin.
+    const PointId count = 10000;
+    std::mt19937 gen(2468);
+    std::uniform_real_distribution<double> dist(0, 1000);
+    for (PointId i = 0; i < count; ++i)
+    {
+        view.setField(Dimension::Id::X, i, 500000 + dist(gen));
+        view.setField(Dimension::Id::Y, i, 4000000 + dist(gen));
+        view.setField(Dimension::Id::Z, i, dist(gen) / 10);
+    }
+
+    KD3Index index(view);
+    index.build();
+    CompactKD3Index compact(view);
+    compact.build();
+    EXPECT_LT(compact.memoryUsed(), count * 24);
+
+    for (PointId i = 0; i < count; i += 7)
+    {
+        EXPECT_EQ(compact.neighbors(i, 8), index.neighbors(i, 8));
+        EXPECT_EQ(compact.radius(i, 20), index.radius(i, 20));
+    }
+
+    double pt[] = { 500500.5, 4000250.25, 50 };
+    std::vector<PointId> ids;
+    std::vector<double> sqrDists;
+    compact.knnSearch(pt, 4, ids, sqrDists);
+    EXPECT_EQ(ids, index.neighbors(pt[0], pt[1], pt[2], 4));
+    for (size_t i = 0; i < ids.size(); ++i)
+    {
+        double dx = view.getFieldAs<double>(Dimension::Id::X, ids[i]) - pt[0];
+        double dy = view.getFieldAs<double>(Dimension::Id::Y, ids[i]) - pt[1];
+        double dz = view.getFieldAs<double>(Dimension::Id::Z, ids[i]) - pt[2];
+        EXPECT_NEAR(sqrDists[i], dx * dx + dy * dy + dz * dz, .01);
+    }
+
+    std::vector<std::vector<PointId>> knn(count);
+    std::vector<std::vector<PointId>> radius(count);
+    compact.knnSearchAll(5, [&knn](PointId i, const std::vector<PointId>& ids,
+        const std::vector<double>&)
+    {
+        knn[i] = ids;
+    });
+    compact.radiusAll(15, [&radius](PointId i,
+        const std::vector<PointId>& ids, const std::vector<double>&)
+    {
+        radius[i] = ids;
+    });
+    for (PointId i = 0; i < count; ++i)
+    {
+        EXPECT_EQ(knn[i], index.neighbors(i, 5));
+        EXPECT_EQ(radius[i], index.radius(i, 15));
+    }
+
+    // 2D, and an empty view.
+    KD2Index index2(view);
+    index2.build();
+    CompactKD2Index compact2(view);
+    compact2.build();
+    for (PointId i = 0; i < count; i += 101)
+        EXPECT_EQ(compact2.neighbors(i, 6), index2.neighbors(i, 6));
+
+    PointView empty(table);
+    CompactKD3Index emptyIndex(empty);
+    emptyIndex.build();
+    EXPECT_TRUE(emptyIndex.neighbors(pt, 3).empty());
+    EXPECT_TRUE(emptyIndex.radius(pt, 10).empty());
+}
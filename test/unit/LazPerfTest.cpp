@@ -42,6 +42,7 @@
 #include <pdal/Options.hpp>
 #include <pdal/PointView.hpp>
 #include <pdal/compression/LazPerfCompression.hpp>
+#include <pdal/util/ThreadPool.hpp>
 #include <io/LasReader.hpp>
 
 using namespace pdal;
@@ -193,3 +194,85 @@ TEST(Compression, types)
                        rawBuf.size());
 }
 
+
+
+TEST(Compression, block)
+{
+    Options opts;
+    opts.add("filename", Support::datapath("las/1.2-with-color.las"));
+
+    LasReader reader;
+    reader.setOptions(opts);
+
+    PointTable table;
+    reader.prepare(table);
+    PointViewSet viewSet = reader.execute(table);
+    PointViewPtr view = *viewSet.begin();
+
+    DimTypeList dimTypes = table.layout()->dimTypes();
+    std::vector<char> raw = getBytes(view);
+
+    // The block API produces the same stream as the streaming compressor.
+    std::vector<char> streamed;
+    auto cb = [&streamed](char *buf, size_t bufsize)
+    {
+        streamed.insert(streamed.end(), buf, buf + bufsize);
+    };
+    LazPerfCompressor compressor(cb, dimTypes);
+    compressor.compress(raw.data(), raw.size());
+    compressor.done();
+
+    LazPerfBlockCompressor blockCompressor(dimTypes);
+    EXPECT_EQ(blockCompressor.pointSize(), 52U);
+    std::vector<char> comp;
+    size_t size = blockCompressor.compress(raw.data(), view->size(), comp);
+    EXPECT_EQ(size, comp.size());
+    EXPECT_EQ(comp, streamed);
+
+    // Compressing again into the same buffer replaces its contents.
+    blockCompressor.compress(raw.data(), view->size(), comp);
+    EXPECT_EQ(comp, streamed);
+
+    std::vector<char> out(raw.size());
+    LazPerfBlockDecompressor(dimTypes).decompress(comp.data(), comp.size(),
+        out.data(), view->size());
+    EXPECT_EQ(out, raw);
+}
+
+
+TEST(Compression, chunks)
+{
+    Options opts;
+    opts.add("filename", Support::datapath("las/1.2-with-color.las"));
+
+    LasReader reader;
+    reader.setOptions(opts);
+
+    PointTable table;
+    reader.prepare(table);
+    PointViewSet viewSet = reader.execute(table);
+    PointViewPtr view = *viewSet.begin();
+
+    DimTypeList dimTypes = table.layout()->dimTypes();
+    std::vector<char> raw = getBytes(view);
+
+    ThreadPool pool(4, 4);
+    std::vector<std::vector<char>> chunks = lazPerfCompressChunks(dimTypes,
+        raw.data(), view->size(), 100, pool);
+    EXPECT_EQ(chunks.size(), 11U);
+
+    // Each chunk stands alone.
+    std::vector<char> last(65 * 52);
+    LazPerfBlockDecompressor(dimTypes).decompress(chunks.back().data(),
+        chunks.back().size(), last.data(), 65);
+    EXPECT_TRUE(std::equal(last.begin(), last.end(),
+        raw.begin() + 1000 * 52));
+
+    std::vector<char> out(raw.size());
+    lazPerfDecompressChunks(dimTypes, chunks, 100, out.data(), view->size(),
+        pool);
+    EXPECT_EQ(out, raw);
+
+    EXPECT_THROW(lazPerfDecompressChunks(dimTypes, chunks, 50, out.data(),
+        view->size(), pool), compression_error);
+}
@@ -32,6 +32,8 @@
 * OF SUCH DAMAGE.
 ****************************************************************************/
 
+#include <sstream>
+
 #include <pdal/pdal_test_main.hpp>
 #include <pdal/Log.hpp>
 #include <pdal/util/FileUtils.hpp>
@@ -62,6 +64,29 @@ TEST(Log, t1)
         Support::datapath("logs/t1")));
 }
 
+// Messages passed as functions are only built for enabled levels.
+TEST(Log, deferred)
+{
+    std::ostringstream oss;
+    Log l("", &oss);
+    l.setLevel(LogLevel::Info);
+
+    EXPECT_TRUE(l.enabled(LogLevel::Warning));
+    EXPECT_TRUE(l.enabled(LogLevel::Info));
+    EXPECT_FALSE(l.enabled(LogLevel::Debug));
+
+    int calls = 0;
+    l.get(LogLevel::Debug, [&calls](std::ostream& out)
+        { ++calls; out << "debug\n"; });
+    EXPECT_EQ(calls, 0);
+    EXPECT_EQ(oss.str(), "");
+
+    l.get(LogLevel::Info, [&calls](std::ostream& out)
+        { ++calls; out << "info\n"; });
+    EXPECT_EQ(calls, 1);
+    EXPECT_NE(oss.str().find("info"), std::string::npos);
+}
+
 // Make sure that devnull thing works.
 TEST(Log, t2)
 {
@@ -359,3 +359,74 @@ TEST(MetadataTest, update)
     root2.add(c);
     EXPECT_THROW(root2.addOrUpdate(c), pdal_error);
 }
+
+TEST(MetadataTest, json)
+{
+    MetadataNode root("root");
+    root.add("count", 3);
+    root.add("name", "say \"hi\"\n");
+    root.add("nan", std::numeric_limits<double>::quiet_NaN());
+    root.addWithType("json", "[1, 2]", "json", "");
+    MetadataNode l = root.addList("list");
+    l.add("x", 1);
+    root.addList("list", 2);
+    MetadataNode c = root.add("child");
+    c.add("a", true);
+
+    const std::string expected =
+R"({
+  "root":
+  {
+    "child":
+    {
+      "a": true
+    },
+    "count": 3,
+    "json": [1, 2],
+    "list":
+    [
+      {
+        "x": 1
+      },
+      2
+    ],
+    "name": "say \"hi\"",
+    "nan": "NaN"
+  }
+}
+)";
+    EXPECT_EQ(Utils::toJSON(root), expected);
+
+    std::ostringstream oss;
+    Utils::toJSON(root, oss);
+    EXPECT_EQ(oss.str(), expected);
+}
+
+// Check that nodes added to a JSON stream are written as they're added.
+TEST(MetadataTest, jsonStream)
+{
+    std::ostringstream oss;
+    {
+        Utils::MetadataJsonStream stream(oss, "stages");
+        EXPECT_EQ(oss.str(), "{\n  \"stages\":\n  [\n");
+
+        MetadataNode a("readers.faux");
+        a.add("count", 10);
+        stream.add(a);
+        EXPECT_EQ(oss.str(), "{\n  \"stages\":\n  [\n"
+            "    {\n      \"readers.faux\":\n      {\n"
+            "        \"count\": 10\n      }\n    }");
+
+        MetadataNode b("writers.null");
+        stream.add(b);
+    }
+    EXPECT_EQ(oss.str(), "{\n  \"stages\":\n  [\n"
+        "    {\n      \"readers.faux\":\n      {\n"
+        "        \"count\": 10\n      }\n    },\n"
+        "    {\n      \"writers.null\":\n      {\n      }\n    }\n"
+        "  ]\n}\n");
+
+    std::ostringstream empty;
+    Utils::MetadataJsonStream(empty, "stages").close();
+    EXPECT_EQ(empty.str(), "{\n  \"stages\":\n  [\n  ]\n}\n");
+}
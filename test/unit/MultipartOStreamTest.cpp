@@ -0,0 +1,195 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <map>
+#include <mutex>
+
+#include <pdal/private/MultipartOStream.hpp>
+
+using namespace pdal;
+
+namespace
+{
+
+struct Upload
+{
+    Upload() : started(false), numParts(0), failPart(0)
+    {}
+
+    std::string data() const
+    {
+        std::string s;
+        for (auto& p : parts)
+            s += std::string(p.second.begin(), p.second.end());
+        return s;
+    }
+
+    bool started;
+    int numParts;
+    int failPart;
+    std::map<int, std::vector<char>> parts;
+    std::vector<char> whole;
+    std::mutex mutex;
+};
+
+class TestTarget : public MultipartTarget
+{
+public:
+    TestTarget(Upload& upload, bool multipart) :
+        m_upload(upload), m_multipart(multipart)
+    {}
+
+    virtual bool multipart() const
+        { return m_multipart; }
+    virtual void put(const std::vector<char>& data)
+        { m_upload.whole = data; }
+    virtual void start()
+        { m_upload.started = true; }
+    virtual void putPart(int partNum, const std::vector<char>& data)
+    {
+        if (partNum == m_upload.failPart)
+            throw pdal_error("Part failed");
+        std::lock_guard<std::mutex> lock(m_upload.mutex);
+        m_upload.parts[partNum] = data;
+    }
+    virtual void complete(int numParts)
+        { m_upload.numParts = numParts; }
+
+private:
+    Upload& m_upload;
+    bool m_multipart;
+};
+
+std::unique_ptr<MultipartTarget> target(Upload& upload, bool multipart)
+{
+    return std::unique_ptr<MultipartTarget>(new TestTarget(upload, multipart));
+}
+
+std::string alphabet(size_t count)
+{
+    std::string s;
+    for (size_t i = 0; i < count; ++i)
+        s += (char)('a' + (i % 26));
+    return s;
+}
+
+} // unnamed namespace
+
+TEST(MultipartOStreamTest, parts)
+{
+    Upload upload;
+    MultipartOStream out(target(upload, true), 16, 2);
+
+    std::string data = alphabet(50);
+    out << data;
+    EXPECT_EQ(out.tellp(), 50);
+    EXPECT_TRUE(upload.started);
+
+    // The first part can still be rewritten.
+    out.seekp(2);
+    EXPECT_TRUE(out.good());
+    EXPECT_EQ(out.tellp(), 2);
+    out << "HDR";
+    EXPECT_EQ(out.tellp(), 5);
+    out.seekp(0, std::ios::end);
+    EXPECT_EQ(out.tellp(), 50);
+    out.close();
+    EXPECT_TRUE(out.good());
+
+    data.replace(2, 3, "HDR");
+    EXPECT_EQ(upload.numParts, 4);
+    EXPECT_EQ(upload.parts.size(), 4U);
+    EXPECT_EQ(upload.parts[1].size(), 16U);
+    EXPECT_EQ(upload.parts[4].size(), 2U);
+    EXPECT_EQ(upload.data(), data);
+    EXPECT_TRUE(upload.whole.empty());
+}
+
+TEST(MultipartOStreamTest, seekSent)
+{
+    Upload upload;
+    MultipartOStream out(target(upload, true), 16, 2);
+
+    out << alphabet(50);
+    // Part two (bytes 16-31) has been handed off.
+    out.seekp(20);
+    EXPECT_FALSE(out.good());
+}
+
+TEST(MultipartOStreamTest, small)
+{
+    // Data that doesn't fill two parts is sent in one piece.
+    Upload upload;
+    MultipartOStream out(target(upload, true), 16, 2);
+
+    std::string data = alphabet(20);
+    out << data;
+    out.seekp(0);
+    out << "X";
+    out.close();
+
+    data[0] = 'X';
+    EXPECT_FALSE(upload.started);
+    EXPECT_EQ(std::string(upload.whole.begin(), upload.whole.end()), data);
+}
+
+TEST(MultipartOStreamTest, whole)
+{
+    Upload upload;
+    MultipartOStream out(target(upload, false), 16, 2);
+
+    std::string data = alphabet(100);
+    out << data;
+    out.close();
+
+    EXPECT_FALSE(upload.started);
+    EXPECT_TRUE(upload.parts.empty());
+    EXPECT_EQ(std::string(upload.whole.begin(), upload.whole.end()), data);
+}
+
+TEST(MultipartOStreamTest, error)
+{
+    Upload upload;
+    upload.failPart = 3;
+    MultipartOStream out(target(upload, true), 16, 2);
+
+    out << alphabet(100);
+    EXPECT_THROW(out.close(), pdal_error);
+    EXPECT_EQ(upload.numParts, 0);
+
+    // Closing again does nothing.
+    EXPECT_NO_THROW(out.close());
+}
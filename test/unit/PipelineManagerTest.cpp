@@ -41,6 +41,9 @@
 #include <pdal/PipelineManager.hpp>
 #include <pdal/util/FileUtils.hpp>
 
+#include <chrono>
+#include <thread>
+
 using namespace pdal;
 
 TEST(PipelineManagerTest, basic)
@@ -227,3 +230,447 @@ TEST(PipelineManagerTest, replace)
     EXPECT_EQ(w2->getInputs().size(), 1U);
     EXPECT_EQ(w2->getInputs().front(), f2);
 }
+
+// Independent branches run concurrently should produce the same points,
+// in the same order, as running them serially.
+TEST(PipelineManagerTest, concurrentBranches)
+{
+    auto run = [](int threads)
+    {
+        PipelineManager mgr;
+
+        Stage& merge = mgr.makeFilter("filters.merge");
+        for (int i = 0; i < 4; ++i)
+        {
+            Options ro;
+            ro.add("mode", "ramp");
+            ro.add("count", 10000);
+            ro.add("bounds", BOX3D(i, 0, 0, i + 1, 1, 1));
+            Stage& r = mgr.makeReader("", "readers.faux", ro);
+
+            Options so;
+            so.add("dimension", "Y");
+            Stage& f = mgr.makeFilter("filters.sort", r, so);
+            merge.setInput(f);
+        }
+
+        EXPECT_EQ(mgr.execute(threads), 40000U);
+        const PointViewSet& s = mgr.views();
+        EXPECT_EQ(s.size(), 1U);
+
+        std::vector<double> xs;
+        PointViewPtr v = *s.begin();
+        for (PointId idx = 0; idx < v->size(); ++idx)
+            xs.push_back(v->getFieldAs<double>(Dimension::Id::X, idx));
+        return xs;
+    };
+
+    std::vector<double> serial = run(1);
+    std::vector<double> concurrent = run(4);
+    EXPECT_EQ(serial, concurrent);
+}
+
+// Views from a stage that supports running views concurrently should be
+// processed the same way as when they're run serially.
+TEST(PipelineManagerTest, concurrentViews)
+{
+    auto run = [](int threads)
+    {
+        PipelineManager mgr;
+
+        Options ro;
+        ro.add("filename", Support::datapath("las/1.2-with-color.las"));
+        Stage& r = mgr.makeReader("", "readers.las", ro);
+
+        Options co;
+        co.add("capacity", 100);
+        Stage& c = mgr.makeFilter("filters.chipper", r, co);
+
+        Options oo;
+        oo.add("method", "radius");
+        oo.add("radius", 50.0);
+        Stage& o = mgr.makeFilter("filters.outlier", c, oo);
+        mgr.makeFilter("filters.merge", o);
+
+        EXPECT_EQ(mgr.execute(threads), 1065U);
+        const PointViewSet& s = mgr.views();
+        EXPECT_EQ(s.size(), 1U);
+
+        std::vector<int> classes;
+        PointViewPtr v = *s.begin();
+        for (PointId idx = 0; idx < v->size(); ++idx)
+            classes.push_back(
+                v->getFieldAs<int>(Dimension::Id::Classification, idx));
+        return classes;
+    };
+
+    std::vector<int> serial = run(1);
+    std::vector<int> concurrent = run(4);
+    EXPECT_EQ(serial, concurrent);
+}
+
+// Dimensions that no stage uses are removed when every stage can tell
+// which dimensions it uses.
+TEST(PipelineManagerTest, pruneDimensions)
+{
+    using namespace Dimension;
+
+    auto run = [](const std::string& filter, Options fo)
+    {
+        PipelineManager mgr;
+
+        Options ro;
+        ro.add("filename", Support::datapath("las/1.2-with-color.las"));
+        Stage& r = mgr.makeReader("", "readers.las", ro);
+
+        Stage& f = mgr.makeFilter(filter, r, fo);
+        mgr.makeWriter("", "writers.null", f);
+
+        mgr.execute();
+        const PointViewSet& s = mgr.views();
+        EXPECT_EQ(s.size(), 1u);
+        EXPECT_GT((*s.begin())->size(), 0u);
+        return mgr.pointTable().layout()->dims();
+    };
+    auto has = [](const Dimension::IdList& dims, Id id)
+    {
+        return std::find(dims.begin(), dims.end(), id) != dims.end();
+    };
+
+    // filters.range uses only Classification.
+    Options ro;
+    ro.add("limits", "Classification[1:1]");
+    Dimension::IdList dims = run("filters.range", ro);
+    EXPECT_EQ(dims.size(), 4u);
+    EXPECT_TRUE(has(dims, Id::X));
+    EXPECT_TRUE(has(dims, Id::Y));
+    EXPECT_TRUE(has(dims, Id::Z));
+    EXPECT_TRUE(has(dims, Id::Classification));
+
+    // filters.stats may use any dimension, so nothing is removed.
+    dims = run("filters.stats", Options());
+    EXPECT_TRUE(has(dims, Id::Intensity));
+    EXPECT_TRUE(has(dims, Id::Red));
+}
+
+// Crop and range bounds are handed to the reader, which skips points
+// outside of them.  Stages between the reader and the filter that don't
+// pass bounds through stop the pushdown.
+TEST(PipelineManagerTest, pushdownBounds)
+{
+    auto run = [](const std::string& filter, Options fo, bool block,
+        point_count_t& read)
+    {
+        PipelineManager mgr;
+
+        Options ro;
+        ro.add("filename", Support::datapath("las/1.2-with-color.las"));
+        Stage& r = mgr.makeReader("", "readers.las", ro);
+
+        Stage *prev = &r;
+        if (block)
+        {
+            Options d;
+            d.add("step", 1);
+            prev = &mgr.makeFilter("filters.decimation", *prev, d);
+        }
+        Stage& f = mgr.makeFilter(filter, *prev, fo);
+        mgr.makeWriter("", "writers.null", f);
+
+        point_count_t cnt = mgr.execute();
+        read = r.profile().pointsOut();
+        return cnt;
+    };
+
+    point_count_t read;
+
+    Options co;
+    co.add("bounds", "([636000, 637000], [849000, 851000])");
+    point_count_t cnt = run("filters.crop", co, true, read);
+    EXPECT_EQ(read, 1065u);
+    EXPECT_GT(cnt, 0u);
+    EXPECT_LT(cnt, 1065u);
+    EXPECT_EQ(run("filters.crop", co, false, read), cnt);
+    EXPECT_EQ(read, cnt);
+
+    Options ro;
+    ro.add("limits", "X[636000:637000], Y[849000:851000]");
+    EXPECT_EQ(run("filters.range", ro, true, read), cnt);
+    EXPECT_EQ(read, 1065u);
+    EXPECT_EQ(run("filters.range", ro, false, read), cnt);
+    EXPECT_EQ(read, cnt);
+
+    // Points are only dropped in Z when Z is limited.
+    ro.add("limits", "Z[:500]");
+    point_count_t zcnt = run("filters.range", ro, false, read);
+    EXPECT_LE(zcnt, cnt);
+    EXPECT_EQ(read, zcnt);
+}
+
+TEST(PipelineManagerTest, pushdownCount)
+{
+    auto run = [](Options fo, bool block, point_count_t& read)
+    {
+        PipelineManager mgr;
+
+        Options ro;
+        ro.add("filename", Support::datapath("las/1.2-with-color.las"));
+        Stage& r = mgr.makeReader("", "readers.las", ro);
+
+        Stage *prev = &r;
+        if (block)
+        {
+            Options d;
+            d.add("step", 2);
+            prev = &mgr.makeFilter("filters.decimation", *prev, d);
+        }
+        Stage& f = mgr.makeFilter("filters.head", *prev, fo);
+        mgr.makeWriter("", "writers.null", f);
+
+        point_count_t cnt = mgr.execute();
+        read = r.profile().pointsOut();
+        return cnt;
+    };
+
+    point_count_t read;
+
+    Options ho;
+    ho.add("count", 100);
+    EXPECT_EQ(run(ho, false, read), 100u);
+    EXPECT_EQ(read, 100u);
+
+    // Decimation keeps points by position, so the reader is handed the
+    // positions of the points kept rather than a count.
+    EXPECT_EQ(run(ho, true, read), 100u);
+    EXPECT_EQ(read, 100u);
+
+    // Inverted, the points after the first 'count' are kept.
+    ho.add("invert", true);
+    EXPECT_EQ(run(ho, false, read), 965u);
+    EXPECT_EQ(read, 1065u);
+}
+
+// Decimation and head keep points by position, so the reader is handed the
+// positions to read and skips the rest.  The points kept are the same as
+// those kept when every point is read.
+TEST(PipelineManagerTest, pushdownSelection)
+{
+    auto run = [](const std::string& filename, bool pushdown,
+        point_count_t& read) -> PointViewPtr
+    {
+        PipelineManager mgr;
+
+        Options ro;
+        ro.add("filename", Support::datapath(filename));
+        Stage& r = mgr.makeReader("", "readers.las", ro);
+
+        Options d;
+        d.add("step", 10);
+        d.add("offset", 3);
+        Stage& f = mgr.makeFilter("filters.decimation", r, d);
+
+        Options ho;
+        ho.add("count", 50);
+        Stage& h = mgr.makeFilter("filters.head", f, ho);
+
+        PointViewSet s;
+        if (pushdown)
+        {
+            mgr.execute();
+            s = mgr.views();
+        }
+        else
+        {
+            PointTable t;
+            h.prepare(t);
+            s = h.execute(t);
+        }
+        read = r.profile().pointsOut();
+        return *s.begin();
+    };
+
+    for (const std::string filename : { "las/simple.las", "laz/simple.laz" })
+    {
+        point_count_t read;
+        PointViewPtr all = run(filename, false, read);
+        PointViewPtr pushed = run(filename, true, read);
+        EXPECT_EQ(read, 50u);
+        ASSERT_EQ(all->size(), 50u);
+        ASSERT_EQ(pushed->size(), 50u);
+        for (PointId i = 0; i < all->size(); ++i)
+        {
+            EXPECT_EQ(all->getFieldAs<double>(Dimension::Id::X, i),
+                pushed->getFieldAs<double>(Dimension::Id::X, i));
+            EXPECT_EQ(all->getFieldAs<double>(Dimension::Id::GpsTime, i),
+                pushed->getFieldAs<double>(Dimension::Id::GpsTime, i));
+        }
+    }
+}
+
+// Copies of a pipeline share no stages with it and can be executed on
+// other threads.
+TEST(PipelineManagerTest, clone)
+{
+    PipelineManager mgr;
+
+    Options ro;
+    ro.add("filename", Support::datapath("las/1.2-with-color.las"));
+    Stage& r = mgr.makeReader("", "readers.las", ro);
+    r.setTag("reader");
+
+    Options fo;
+    fo.add("limits", "Classification[2:2]");
+    Stage& f = mgr.makeFilter("filters.range", r, fo);
+    mgr.makeWriter("", "writers.null", f);
+
+    EXPECT_FALSE(r.threadSafe());
+    EXPECT_TRUE(f.threadSafe());
+
+    std::vector<PipelineManagerPtr> copies;
+    for (int i = 0; i < 4; ++i)
+        copies.push_back(mgr.clone());
+
+    const std::vector<Stage *> stages = copies[0]->stages();
+    ASSERT_EQ(stages.size(), 3u);
+    EXPECT_NE(stages[0], &r);
+    EXPECT_EQ(stages[0]->getName(), "readers.las");
+    EXPECT_EQ(stages[0]->tag(), "reader");
+    ASSERT_EQ(stages[1]->getInputs().size(), 1u);
+    EXPECT_EQ(stages[1]->getInputs()[0], stages[0]);
+    ASSERT_EQ(stages[2]->getInputs().size(), 1u);
+    EXPECT_EQ(stages[2]->getInputs()[0], stages[1]);
+
+    std::vector<point_count_t> counts(copies.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < copies.size(); ++i)
+        threads.emplace_back([&copies, &counts, i]()
+        {
+            copies[i]->execute();
+            counts[i] = (*copies[i]->views().begin())->size();
+        });
+    for (std::thread& t : threads)
+        t.join();
+
+    mgr.execute();
+    point_count_t expected = (*mgr.views().begin())->size();
+    EXPECT_GT(expected, 0u);
+    for (point_count_t count : counts)
+        EXPECT_EQ(count, expected);
+}
+
+TEST(PipelineManagerTest, cacheDir)
+{
+    const std::string dir = Support::temppath("stagecache");
+    FileUtils::deleteDirectory(dir);
+
+    // Run reader -> assign -> range -> null, caching the output of the
+    // assign filter.
+    auto run = [&dir](const std::string& limits, bool cache,
+        PipelineManager& mgr)
+    {
+        if (cache)
+            mgr.setCacheDir(dir);
+
+        Options ro;
+        ro.add("filename", Support::datapath("las/1.2-with-color.las"));
+        Stage& r = mgr.makeReader("", "readers.las", ro);
+
+        Options ao;
+        ao.add("assignment", "Intensity[:]=7");
+        Stage& a = mgr.makeFilter("filters.assign", r, ao);
+
+        Options fo;
+        fo.add("limits", limits);
+        Stage& f = mgr.makeFilter("filters.range", a, fo);
+        mgr.makeWriter("", "writers.null", f);
+        mgr.execute();
+        return r.profile().pointsOut();
+    };
+
+    PipelineManager first;
+    EXPECT_GT(run("Classification[2:2]", true, first), 0u);
+    EXPECT_EQ(FileUtils::directoryList(dir).size(), 1u);
+
+    // A different last filter starts from the saved points, so the reader
+    // isn't run.
+    PipelineManager second;
+    EXPECT_EQ(run("Classification[1:1]", true, second), 0u);
+    EXPECT_EQ(FileUtils::directoryList(dir).size(), 1u);
+
+    PipelineManager uncached;
+    run("Classification[1:1]", false, uncached);
+
+    PointViewPtr v1 = *second.views().begin();
+    PointViewPtr v2 = *uncached.views().begin();
+    ASSERT_EQ(second.views().size(), 1u);
+    ASSERT_EQ(v1->size(), v2->size());
+    EXPECT_GT(v1->size(), 0u);
+    EXPECT_EQ(v1->spatialReference(), v2->spatialReference());
+    for (PointId i = 0; i < v1->size(); ++i)
+    {
+        EXPECT_EQ(v1->getFieldAs<double>(Dimension::Id::X, i),
+            v2->getFieldAs<double>(Dimension::Id::X, i));
+        EXPECT_EQ(v1->getFieldAs<int>(Dimension::Id::Intensity, i), 7);
+        EXPECT_EQ(v1->getFieldAs<int>(Dimension::Id::Red, i),
+            v2->getFieldAs<int>(Dimension::Id::Red, i));
+    }
+
+    // Changing an upstream option misses the cache.
+    PipelineManager third;
+    Options ro;
+    ro.add("filename", Support::datapath("las/1.2-with-color.las"));
+    ro.add("count", 100);
+    third.setCacheDir(dir);
+    Stage& r = third.makeReader("", "readers.las", ro);
+    Stage& a = third.makeFilter("filters.assign", r);
+    third.makeFilter("filters.range", a);
+    third.execute();
+    EXPECT_EQ(r.profile().pointsOut(), 100u);
+    EXPECT_EQ(FileUtils::directoryList(dir).size(), 2u);
+
+    FileUtils::deleteDirectory(dir);
+}
+
+// Any option that names a file makes the file part of the hash, but not
+// while it may still be changing within its modification time.
+TEST(PipelineManagerTest, contentHashFiles)
+{
+    const std::string raster = Support::temppath("hashraster.tif");
+    FileUtils::deleteFile(raster);
+
+    StageFactory f;
+    Stage *s = f.createStage("filters.colorization");
+    Options o;
+    o.add("raster", raster);
+    s->setOptions(o);
+
+    auto write = [&raster](const std::string& contents)
+    {
+        std::ostream *out = FileUtils::createFile(raster);
+        *out << contents;
+        FileUtils::closeFile(out);
+    };
+
+    const std::string missing = s->contentHash("");
+    EXPECT_FALSE(missing.empty());
+
+    write("abc");
+    EXPECT_TRUE(s->contentHash("").empty());
+
+    std::this_thread::sleep_for(std::chrono::seconds(3));
+    const std::string written = s->contentHash("");
+    EXPECT_FALSE(written.empty());
+    EXPECT_NE(written, missing);
+    EXPECT_EQ(s->contentHash(""), written);
+
+    write("abcd");
+    EXPECT_TRUE(s->contentHash("").empty());
+
+    Options in;
+    in.add("filename", "STDIN");
+    Stage *r = f.createStage("readers.text");
+    r->setOptions(in);
+    EXPECT_TRUE(r->contentHash("").empty());
+
+    FileUtils::deleteFile(raster);
+}
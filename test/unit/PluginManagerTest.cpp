@@ -40,6 +40,9 @@
 #include <pdal/pdal_config.hpp>
 #include <pdal/Filter.hpp>
 #include <pdal/util/Algorithm.hpp>
+#include <pdal/util/FileUtils.hpp>
+
+#include <json/json.h>
 
 #include "Support.hpp"
 
@@ -171,5 +174,86 @@ TEST(PluginManagerTest, validnames)
 
 }
 
+TEST(PluginManagerTest, cache)
+{
+    std::string curPath;
+    std::string curCache;
+    int pathSet = Utils::getenv("PDAL_DRIVER_PATH", curPath);
+    int cacheSet = Utils::getenv("PDAL_PLUGIN_CACHE", curCache);
+
+    const std::string dir = Support::temppath("plugincache");
+    const std::string cacheFile = Support::temppath("plugincache.json");
+    FileUtils::deleteDirectory(dir);
+    FileUtils::deleteFile(cacheFile);
+    FileUtils::createDirectory(dir);
+
+    const std::string driver = FileUtils::toAbsolutePath(
+        "libpdal_plugin_filter_cachetest" + Utils::dynamicLibExtension, dir);
+    const std::string kernel = FileUtils::toAbsolutePath(
+        "libpdal_plugin_kernel_cachetest" + Utils::dynamicLibExtension, dir);
+    FileUtils::closeFile(FileUtils::createFile(driver));
+    FileUtils::closeFile(FileUtils::createFile(kernel));
+
+    Utils::setenv("PDAL_DRIVER_PATH", dir);
+    Utils::setenv("PDAL_PLUGIN_CACHE", cacheFile);
+
+    // First pass scans the directory and writes the cache.
+    {
+        PluginDirectory pd;
+        EXPECT_EQ(pd.m_drivers["filters.cachetest"], driver);
+        EXPECT_EQ(pd.m_kernels["kernels.cachetest"], kernel);
+    }
+    EXPECT_TRUE(FileUtils::fileExists(cacheFile));
+
+    // Mark the cached entry as current and point it elsewhere.  The
+    // directory shouldn't be rescanned, so the bogus path is returned.
+    Json::Value cache;
+    std::istringstream in(FileUtils::readFileIntoString(cacheFile));
+    in >> cache;
+    Json::Value& entry =
+        cache["directories"][FileUtils::toAbsolutePath(dir)];
+    ASSERT_TRUE(entry.isObject());
+    entry["mtime"] = (Json::Int64)FileUtils::lastWriteTime(dir);
+    entry["drivers"]["filters.cachetest"] = "/bogus/path";
+    {
+        std::ofstream out(cacheFile);
+        out << cache;
+    }
+    {
+        PluginDirectory pd;
+        EXPECT_EQ(pd.m_drivers["filters.cachetest"], "/bogus/path");
+    }
+
+    // A stale time forces a rescan.
+    entry["mtime"] = (Json::Int64)0;
+    {
+        std::ofstream out(cacheFile);
+        out << cache;
+    }
+    {
+        PluginDirectory pd;
+        EXPECT_EQ(pd.m_drivers["filters.cachetest"], driver);
+    }
+
+    // With the cache disabled nothing is read.
+    FileUtils::deleteFile(cacheFile);
+    Utils::setenv("PDAL_PLUGIN_CACHE", "off");
+    {
+        PluginDirectory pd;
+        EXPECT_EQ(pd.m_drivers["filters.cachetest"], driver);
+    }
+    EXPECT_FALSE(FileUtils::fileExists(cacheFile));
+
+    FileUtils::deleteDirectory(dir);
+    if (pathSet == 0)
+        Utils::setenv("PDAL_DRIVER_PATH", curPath);
+    else
+        Utils::unsetenv("PDAL_DRIVER_PATH");
+    if (cacheSet == 0)
+        Utils::setenv("PDAL_PLUGIN_CACHE", curCache);
+    else
+        Utils::unsetenv("PDAL_PLUGIN_CACHE");
+}
+
 } // namespace pdal
 
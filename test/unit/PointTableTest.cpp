@@ -32,9 +32,21 @@
 * OF SUCH DAMAGE.
 ****************************************************************************/
 
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include <pdal/pdal_test_main.hpp>
 
 #include <pdal/PointTable.hpp>
+#include <pdal/SharedMemoryLayout.h>
+#include <pdal/SharedMemoryPointTable.hpp>
+#include <pdal/util/ThreadPool.hpp>
 #include <io/LasReader.hpp>
 #include "Support.hpp"
 
@@ -255,6 +267,532 @@ TEST(PointTable, simple)
 
     ContiguousPointTable t2;
     simpleTest(t2);
+
+    ColumnPointTable t3;
+    simpleTest(t3);
+
+    MappedPointTable t4(Support::temppath());
+    simpleTest(t4);
+
+    CompressedPointTable t5;
+    simpleTest(t5);
+}
+
+
+TEST(PointTable, mapped)
+{
+    std::string filename;
+    {
+        // A tiny budget limits the table to two mapped blocks.
+        MappedPointTable table(Support::temppath(), 1);
+        PointLayoutPtr layout = table.layout();
+
+        layout->registerDim(Dimension::Id::X);
+        layout->registerDim(Dimension::Id::Classification);
+
+        const PointId count = 300000;
+        PointView v(table);
+        for (PointId id = 0; id < count; id++)
+        {
+            v.setField(Dimension::Id::X, id, id * 2.0);
+            v.setField(Dimension::Id::Classification, id, id % 32);
+        }
+        EXPECT_LE(table.mappedBlocks(), 2u);
+        filename = table.filename();
+        EXPECT_TRUE(FileUtils::fileExists(filename));
+
+        // Read back in reverse so that every block is remapped.
+        for (PointId id = count; id-- > 0;)
+        {
+            EXPECT_DOUBLE_EQ(id * 2.0,
+                v.getFieldAs<double>(Dimension::Id::X, id));
+            EXPECT_EQ(id % 32,
+                v.getFieldAs<PointId>(Dimension::Id::Classification, id));
+        }
+        EXPECT_LE(table.mappedBlocks(), 2u);
+    }
+    EXPECT_FALSE(FileUtils::fileExists(filename));
+}
+
+
+TEST(PointTable, compressed)
+{
+    // A tiny budget limits the table to two uncompressed blocks.
+    CompressedPointTable table(1);
+    PointLayoutPtr layout = table.layout();
+
+    layout->registerDim(Dimension::Id::X);
+    layout->registerDim(Dimension::Id::Classification);
+
+    const PointId count = 300000;
+    PointView v(table);
+    for (PointId id = 0; id < count; id++)
+    {
+        v.setField(Dimension::Id::X, id, id * 2.0);
+        v.setField(Dimension::Id::Classification, id, id % 32);
+    }
+    EXPECT_LE(table.hotBlocks(), 2u);
+    EXPECT_GT(table.compressedBytes(), 0u);
+
+    // Read back in reverse so that every block is decompressed.
+    for (PointId id = count; id-- > 0;)
+    {
+        EXPECT_DOUBLE_EQ(id * 2.0,
+            v.getFieldAs<double>(Dimension::Id::X, id));
+        EXPECT_EQ(id % 32,
+            v.getFieldAs<PointId>(Dimension::Id::Classification, id));
+    }
+    EXPECT_LE(table.hotBlocks(), 2u);
+
+    // Changes survive a block being compressed again.
+    v.setField(Dimension::Id::X, 0, -1.0);
+    v.setField(Dimension::Id::X, count - 1, -2.0);
+    v.setField(Dimension::Id::X, count / 2, -3.0);
+    EXPECT_DOUBLE_EQ(-1.0, v.getFieldAs<double>(Dimension::Id::X, 0));
+    EXPECT_DOUBLE_EQ(-2.0, v.getFieldAs<double>(Dimension::Id::X, count - 1));
+    EXPECT_DOUBLE_EQ(-3.0, v.getFieldAs<double>(Dimension::Id::X, count / 2));
+    EXPECT_DOUBLE_EQ(2.0, v.getFieldAs<double>(Dimension::Id::X, 1));
+}
+
+
+namespace
+{
+
+// Read and write fields from several threads.  With room for only two
+// blocks, blocks are mapped or decompressed while other threads use them.
+void checkConcurrentAccess(BasePointTable& table)
+{
+    PointLayoutPtr layout = table.layout();
+    layout->registerDim(Dimension::Id::X);
+    layout->registerDim(Dimension::Id::Classification);
+
+    const PointId count = 300000;
+    const point_count_t chunk = 4096;
+    PointView v(table);
+    for (PointId id = 0; id < count; id++)
+        v.setField(Dimension::Id::X, id, id * 2.0);
+
+    parallelFor((count + chunk - 1) / chunk, [&]()
+    {
+        std::vector<double> x(chunk);
+        std::vector<uint8_t> c(chunk);
+        return [&, x, c](size_t i) mutable
+        {
+            PointId begin = i * chunk;
+            point_count_t n = (std::min)(chunk, count - begin);
+            v.getFieldArray(Dimension::Id::X, begin, n, x.data());
+            for (point_count_t j = 0; j < n; ++j)
+                c[j] = (int)x[j] % 32;
+            v.setFieldArray(Dimension::Id::Classification, begin, n,
+                c.data());
+        };
+    }, 1);
+
+    for (PointId id = 0; id < count; id++)
+        EXPECT_EQ((id * 2) % 32,
+            v.getFieldAs<PointId>(Dimension::Id::Classification, id));
+}
+
+} // unnamed namespace
+
+TEST(PointTable, mappedConcurrent)
+{
+    MappedPointTable table(Support::temppath(), 1);
+    checkConcurrentAccess(table);
+    EXPECT_LE(table.mappedBlocks(), 2u);
+}
+
+
+TEST(PointTable, compressedConcurrent)
+{
+    CompressedPointTable table(1);
+    checkConcurrentAccess(table);
+    EXPECT_LE(table.hotBlocks(), 2u);
+}
+
+
+#ifndef _WIN32
+TEST(PointTable, sharedMemory)
+{
+    const std::string name("pdal-test-shm");
+    const PointId count = 1000;
+    {
+        SharedMemoryPointTable table(name, count);
+        PointLayoutPtr layout = table.layout();
+        layout->registerDim(Dimension::Id::X);
+        layout->registerDim(Dimension::Id::Classification);
+        table.finalize();
+
+        PointView v(table);
+        for (PointId id = 0; id < count; id++)
+        {
+            v.setField(Dimension::Id::X, id, id * 2.0);
+            v.setField(Dimension::Id::Classification, id, id % 32);
+        }
+        EXPECT_THROW(v.setField(Dimension::Id::X, count, 1.0), pdal_error);
+    }
+
+    // Read the segment the way another process would.
+    int fd = shm_open(("/" + name).c_str(), O_RDONLY, 0);
+    ASSERT_GE(fd, 0);
+    struct stat st;
+    ASSERT_EQ(fstat(fd, &st), 0);
+    void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    ASSERT_NE(addr, MAP_FAILED);
+
+    const char *base = static_cast<const char *>(addr);
+    const pdal_shm_header *header =
+        reinterpret_cast<const pdal_shm_header *>(base);
+    EXPECT_EQ(header->magic, PDAL_SHM_MAGIC);
+    EXPECT_EQ(header->state, (uint32_t)PDAL_SHM_COMPLETE);
+    EXPECT_EQ(header->point_count, count);
+    EXPECT_EQ(header->point_size, 9u);
+    ASSERT_EQ(header->dim_count, 2u);
+
+    const pdal_shm_dim *dims =
+        reinterpret_cast<const pdal_shm_dim *>(base + sizeof(*header));
+    EXPECT_STREQ(dims[0].name, "X");
+    EXPECT_EQ(dims[0].type, (uint32_t)(PDAL_SHM_FLOATING | 8));
+    EXPECT_STREQ(dims[1].name, "Classification");
+    EXPECT_EQ(dims[1].type, (uint32_t)(PDAL_SHM_UNSIGNED | 1));
+
+    const char *data = base + header->data_offset;
+    for (PointId id = 0; id < count; id++)
+    {
+        const char *p = data + id * header->point_size;
+        double x;
+        std::memcpy(&x, p + dims[0].offset, sizeof(x));
+        EXPECT_DOUBLE_EQ(x, id * 2.0);
+        EXPECT_EQ((PointId)(uint8_t)p[dims[1].offset], id % 32);
+    }
+
+    munmap(addr, st.st_size);
+    SharedMemoryPointTable::remove(name);
+    EXPECT_LT(shm_open(("/" + name).c_str(), O_RDONLY, 0), 0);
+}
+
+// The segment's layout can't describe scaled values.
+TEST(PointTable, sharedMemoryScaled)
+{
+    const std::string name("pdal-test-shm-scaled");
+    SharedMemoryPointTable table(name, 10);
+    PointLayoutPtr layout = table.layout();
+    XForm xform(.01, 0);
+    layout->setScaling(xform, xform, xform);
+    layout->registerDim(Dimension::Id::X);
+    EXPECT_THROW(table.finalize(), pdal_error);
+    EXPECT_LT(shm_open(("/" + name).c_str(), O_RDONLY, 0), 0);
+}
+#endif
+
+TEST(PointTable, column)
+{
+    ColumnPointTable table;
+    PointLayoutPtr layout = table.layout();
+
+    layout->registerDim(Dimension::Id::X);
+    layout->registerDim(Dimension::Id::Intensity);
+
+    // Enough points to force the columns to grow.
+    const PointId count = 100000;
+    PointView v(table);
+    for (PointId id = 0; id < count; id++)
+    {
+        v.setField(Dimension::Id::X, id, id * 2.0);
+        v.setField(Dimension::Id::Intensity, id, id % 1000);
+    }
+    EXPECT_EQ(count, table.numPoints());
+    EXPECT_EQ(nullptr, table.column(Dimension::Id::Y));
+
+    const double *x = reinterpret_cast<const double *>(
+        table.column(Dimension::Id::X));
+    const uint16_t *intensity = reinterpret_cast<const uint16_t *>(
+        table.column(Dimension::Id::Intensity));
+    for (PointId id = 0; id < count; id++)
+    {
+        EXPECT_DOUBLE_EQ(id * 2.0, x[id]);
+        EXPECT_EQ(id % 1000, intensity[id]);
+    }
+    EXPECT_THROW(v.getPoint(0), pdal_error);
+}
+
+
+TEST(PointTable, memoryLimit)
+{
+    auto fill = [](BasePointTable& table, PointId count)
+    {
+        table.layout()->registerDim(Dimension::Id::X);
+        PointView v(table);
+        for (PointId id = 0; id < count; id++)
+            v.setField(Dimension::Id::X, id, id * 2.0);
+    };
+
+    // A limit of one 65536-point block of doubles.
+    const uint64_t limit = 65536 * sizeof(double);
+    {
+        PointTable table;
+        table.setMemoryLimit(limit);
+        EXPECT_NO_THROW(fill(table, 65536));
+    }
+    {
+        PointTable table;
+        table.setMemoryLimit(limit);
+        EXPECT_THROW(fill(table, 65537), pdal_error);
+    }
+    {
+        ColumnPointTable table;
+        table.setMemoryLimit(limit);
+        EXPECT_THROW(fill(table, 100000), pdal_error);
+    }
+    {
+        ContiguousPointTable table;
+        table.setMemoryLimit(limit);
+        EXPECT_THROW(fill(table, 100000), pdal_error);
+    }
+    {
+        // Mapped tables keep points on disk, so they aren't limited.
+        MappedPointTable table(Support::temppath(), 1);
+        table.setMemoryLimit(limit);
+        EXPECT_NO_THROW(fill(table, 100000));
+    }
+}
+
+
+TEST(PointTable, reserve)
+{
+    auto fill = [](BasePointTable& table, point_count_t count)
+    {
+        PointView v(table);
+        v.reserve(count);
+        table.reserve(count);
+        const uint64_t reserved = table.allocatedBytes();
+        for (PointId id = 0; id < count; id++)
+            v.setField(Dimension::Id::X, id, id * 2.0);
+        for (PointId id = 0; id < count; id++)
+            EXPECT_DOUBLE_EQ(id * 2.0,
+                v.getFieldAs<double>(Dimension::Id::X, id));
+        return reserved;
+    };
+
+    // Reserved storage isn't grown while the points are added.
+    {
+        ColumnPointTable table;
+        table.layout()->registerDim(Dimension::Id::X);
+        table.finalize();
+        EXPECT_EQ(fill(table, 100000), 100000 * sizeof(double));
+        EXPECT_EQ(table.allocatedBytes(), 100000 * sizeof(double));
+    }
+    {
+        ContiguousPointTable table;
+        table.layout()->registerDim(Dimension::Id::X);
+        table.finalize();
+        EXPECT_EQ(fill(table, 100000), 100000 * sizeof(double));
+        EXPECT_EQ(table.allocatedBytes(), 100000 * sizeof(double));
+    }
+
+    // Storage beyond the memory limit isn't reserved.
+    {
+        ColumnPointTable table;
+        table.layout()->registerDim(Dimension::Id::X);
+        table.finalize();
+        table.setMemoryLimit(1000);
+        table.reserve(100000);
+        EXPECT_EQ(table.allocatedBytes(), 0u);
+    }
+}
+
+
+TEST(PointTable, blockPool)
+{
+    auto fill = [](PointTable& table)
+    {
+        table.layout()->registerDim(Dimension::Id::X);
+        PointView v(table);
+        for (PointId id = 0; id < 100000; id++)
+            v.setField(Dimension::Id::X, id, id * 2.0);
+        for (PointId id = 0; id < 100000; id++)
+            EXPECT_DOUBLE_EQ(id * 2.0,
+                v.getFieldAs<double>(Dimension::Id::X, id));
+    };
+
+    std::shared_ptr<BlockPool> pool(new BlockPool);
+    const uint64_t blockBytes = 65536 * sizeof(double);
+    {
+        PointTable table(pool);
+        fill(table);
+    }
+    // The table's two blocks are kept for reuse.
+    EXPECT_EQ(pool->idleBytes(), 2 * blockBytes);
+    {
+        PointTable table(pool);
+        fill(table);
+        EXPECT_EQ(pool->idleBytes(), 0u);
+    }
+    EXPECT_EQ(pool->idleBytes(), 2 * blockBytes);
+
+    // Blocks beyond the idle limit are freed.
+    std::shared_ptr<BlockPool> small(new BlockPool(blockBytes, true));
+    {
+        PointTable table(small);
+        fill(table);
+    }
+    EXPECT_EQ(small->idleBytes(), blockBytes);
+}
+
+
+TEST(PointTable, removeDim)
+{
+    using namespace Dimension;
+
+    PointTable table;
+    PointLayoutPtr layout(table.layout());
+
+    layout->registerDim(Id::X);
+    layout->registerDim(Id::Intensity);
+    layout->registerDim(Id::Classification);
+    layout->registerDim(Id::GpsTime);
+    EXPECT_EQ(layout->pointSize(), 19u);
+
+    layout->removeDim(Id::Intensity);
+    EXPECT_FALSE(layout->hasDim(Id::Intensity));
+    EXPECT_EQ(layout->dims().size(), 3u);
+    EXPECT_EQ(layout->pointSize(), 17u);
+
+    // Removing a dimension that isn't there does nothing.
+    layout->removeDim(Id::Intensity);
+    EXPECT_EQ(layout->pointSize(), 17u);
+
+    // The remaining dimensions still fit together.
+    EXPECT_EQ(layout->dimDetail(Id::X)->offset(), 0);
+    EXPECT_EQ(layout->dimDetail(Id::GpsTime)->offset(), 8);
+    EXPECT_EQ(layout->dimDetail(Id::Classification)->offset(), 16);
+
+    PointView view(table);
+    view.setField(Id::X, 0, 1.5);
+    view.setField(Id::GpsTime, 0, 2.5);
+    view.setField(Id::Classification, 0, 2);
+    view.setField(Id::Intensity, 0, 100);
+    EXPECT_DOUBLE_EQ(view.getFieldAs<double>(Id::X, 0), 1.5);
+    EXPECT_DOUBLE_EQ(view.getFieldAs<double>(Id::GpsTime, 0), 2.5);
+    EXPECT_EQ(view.getFieldAs<int>(Id::Classification, 0), 2);
+
+    layout->finalize();
+    EXPECT_THROW(layout->removeDim(Id::X), pdal_error);
+}
+
+TEST(PointTable, aligned)
+{
+    using namespace Dimension;
+
+    PointTable table;
+    PointLayoutPtr layout(table.layout());
+
+    layout->registerDim(Id::Classification);
+    layout->registerDim(Id::Intensity);
+    layout->registerDim(Id::Z);
+    layout->registerDim(Id::GpsTime);
+    layout->registerDim(Id::X);
+    layout->registerDim(Id::Y);
+    layout->setAligned(true);
+    EXPECT_EQ(layout->pointSize(), 35u);
+
+    // Larger dimensions come first and X, Y and Z are together.
+    EXPECT_EQ(layout->dimOffset(Id::X), 0u);
+    EXPECT_EQ(layout->dimOffset(Id::Y), 8u);
+    EXPECT_EQ(layout->dimOffset(Id::Z), 16u);
+    EXPECT_EQ(layout->dimOffset(Id::GpsTime), 24u);
+    EXPECT_EQ(layout->dimOffset(Id::Intensity), 32u);
+    EXPECT_EQ(layout->dimOffset(Id::Classification), 34u);
+
+    layout->finalize();
+    EXPECT_EQ(layout->pointSize(), 40u);
+    EXPECT_THROW(layout->setAligned(false), pdal_error);
+
+    PointView view(table);
+    for (PointId i = 0; i < 10; ++i)
+    {
+        view.setField(Id::X, i, i + .5);
+        view.setField(Id::Classification, i, i);
+    }
+    for (PointId i = 0; i < 10; ++i)
+    {
+        EXPECT_DOUBLE_EQ(view.getFieldAs<double>(Id::X, i), i + .5);
+        EXPECT_EQ(view.getFieldAs<int>(Id::Classification, i), (int)i);
+    }
+}
+
+TEST(PointTable, streamFieldArray)
+{
+    using namespace Dimension;
+
+    FixedPointTable table(10);
+    PointLayoutPtr layout(table.layout());
+    layout->registerDim(Id::X, Type::Double);
+    layout->registerDim(Id::Classification, Type::Unsigned8);
+    table.finalize();
+
+    std::vector<double> in { 0, 1.5, 2, 300, -1, 5, 6, 7, 8, 9 };
+    table.setFieldArray(Id::X, 0, 10, in.data());
+    table.setFieldArray(Id::Classification, 0, 10, in.data());
+
+    std::vector<double> out(10);
+    table.getFieldArray(Id::X, 0, 10, out.data());
+    EXPECT_EQ(out, in);
+
+    // Values that don't fit are left alone, as with PointRef::setField().
+    table.getFieldArray(Id::Classification, 0, 10, out.data());
+    std::vector<double> expected { 0, 2, 2, 0, 0, 5, 6, 7, 8, 9 };
+    EXPECT_EQ(out, expected);
+
+    PointRef point(table, 7);
+    EXPECT_EQ(point.getFieldAs<int>(Id::Classification), 7);
+
+    // Ranges that don't start at zero.
+    std::vector<double> part { 20, 21 };
+    table.setFieldArray(Id::Classification, 3, 2, part.data());
+    table.getFieldArray(Id::Classification, 2, 4, out.data());
+    EXPECT_EQ(out[0], 2);
+    EXPECT_EQ(out[1], 20);
+    EXPECT_EQ(out[2], 21);
+    EXPECT_EQ(out[3], 5);
+}
+
+TEST(PointTable, streamScaledFieldArray)
+{
+    using namespace Dimension;
+
+    FixedPointTable table(4);
+    PointLayoutPtr layout(table.layout());
+    XForm xform(.01, 1000);
+    layout->setScaling(xform, xform, xform);
+    layout->registerDim(Id::X);
+    layout->registerDim(Id::Y);
+    table.finalize();
+    EXPECT_EQ(layout->dimSize(Id::X), 4u);
+
+    // The last value is too far from the offset to be stored and is
+    // dropped.
+    std::vector<double> in { 1000, 1234.56, 999.99, 1e12 };
+    table.setFieldArray(Id::X, 0, 4, in.data());
+    table.setFieldArray(Id::Y, 0, 3, in.data());
+
+    std::vector<double> out(4);
+    table.getFieldArray(Id::X, 0, 3, out.data());
+    for (size_t i = 0; i < 3; ++i)
+        EXPECT_NEAR(out[i], in[i], 1e-9);
+    for (PointId i = 0; i < 3; ++i)
+    {
+        PointRef point(table, i);
+        EXPECT_NEAR(point.getFieldAs<double>(Id::X), in[i], 1e-9);
+        EXPECT_NEAR(point.getFieldAs<double>(Id::Y), in[i], 1e-9);
+    }
+
+    // Values set through PointRef read back through the array.
+    PointRef point(table, 3);
+    point.setField(Id::Y, 1010.5);
+    table.getFieldArray(Id::Y, 1, 3, out.data());
+    EXPECT_NEAR(out[2], 1010.5, 1e-9);
 }
 
 } // namespace
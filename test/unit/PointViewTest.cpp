@@ -34,12 +34,17 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <algorithm>
 #include <array>
+#include <limits>
 #include <random>
+#include <vector>
 
+#include <pdal/KDIndex.hpp>
 #include <pdal/PointView.hpp>
 #include <pdal/PointViewIter.hpp>
 #include <pdal/PDALUtils.hpp>
+#include <pdal/TypedDim.hpp>
 #include "Support.hpp"
 
 using namespace pdal;
@@ -287,6 +292,52 @@ TEST(PointViewTest, calcBounds)
     check_bounds(box_b2, 1.0, 3.0, 1.0, 3.0, 1.0, 3.0);
 }
 
+// Enough points to be split into blocks reduced on several threads.
+TEST(PointViewTest, calculateBoundsLarge)
+{
+    auto check = [](BasePointTable& table)
+    {
+        PointLayoutPtr layout(table.layout());
+        layout->registerDim(Dimension::Id::X);
+        layout->registerDim(Dimension::Id::Y);
+        layout->registerDim(Dimension::Id::Z, Dimension::Type::Signed32);
+
+        PointView view(table);
+        const PointId count = 100000;
+        for (PointId i = 0; i < count; ++i)
+        {
+            view.setField(Dimension::Id::X, i, (double)i);
+            view.setField(Dimension::Id::Y, i, -(double)i);
+            view.setField(Dimension::Id::Z, i, (int)(i % 1000) - 500);
+        }
+        // NaN values are skipped.
+        view.setField(Dimension::Id::X, 50000,
+            std::numeric_limits<double>::quiet_NaN());
+
+        BOX3D box;
+        view.calculateBounds(box);
+        EXPECT_DOUBLE_EQ(box.minx, 0.0);
+        EXPECT_DOUBLE_EQ(box.maxx, count - 1.0);
+        EXPECT_DOUBLE_EQ(box.miny, -(count - 1.0));
+        EXPECT_DOUBLE_EQ(box.maxy, 0.0);
+        EXPECT_DOUBLE_EQ(box.minz, -500.0);
+        EXPECT_DOUBLE_EQ(box.maxz, 499.0);
+
+        // Bounds are grown, not replaced.
+        BOX2D box2(-10, 5, 0, 7);
+        view.calculateBounds(box2);
+        EXPECT_DOUBLE_EQ(box2.minx, -10.0);
+        EXPECT_DOUBLE_EQ(box2.maxx, count - 1.0);
+        EXPECT_DOUBLE_EQ(box2.miny, -(count - 1.0));
+        EXPECT_DOUBLE_EQ(box2.maxy, 7.0);
+    };
+
+    PointTable table;
+    check(table);
+    MappedPointTable mapped(Support::temppath(), 1);
+    check(mapped);
+}
+
 TEST(PointViewTest, order)
 {
     PointTable table;
@@ -350,9 +401,354 @@ TEST(PointViewTest, getFloatNan)
     EXPECT_NO_THROW(view->getFieldAs<float>(Dimension::Id::ScanAngleRank, 0));
 }
 
+namespace
+{
+
+void testFieldArray(PointTableRef table)
+{
+    PointLayoutPtr layout(table.layout());
+    layout->registerDim(Dimension::Id::X, Dimension::Type::Double);
+    layout->registerDim(Dimension::Id::Intensity, Dimension::Type::Unsigned16);
+
+    // Enough points to span several bulk transfers and table blocks.
+    const point_count_t count = 70000;
+    PointView base(table);
+    for (PointId i = 0; i < count; ++i)
+        base.setField(Dimension::Id::X, i, (double)i);
+
+    // Reverse the order of the points so that the table IDs of the view
+    // aren't sequential.
+    PointView v(table);
+    for (PointId i = count; i-- > 0;)
+        v.appendPoint(base, i);
+
+    std::vector<double> x(count);
+    v.getFieldArray(Dimension::Id::X, 0, count, x.data());
+    for (PointId i = 0; i < count; ++i)
+        EXPECT_DOUBLE_EQ(x[i], (double)(count - 1 - i));
+
+    std::vector<int> xi(10);
+    v.getFieldArray(Dimension::Id::X, 5, 10, xi.data());
+    for (PointId i = 0; i < 10; ++i)
+        EXPECT_EQ(xi[i], (int)(count - 6 - i));
+
+    std::vector<double> in(count);
+    for (PointId i = 0; i < count; ++i)
+        in[i] = (double)(i % 60000);
+    v.setFieldArray(Dimension::Id::Intensity, 0, count, in.data());
+    for (PointId i = 0; i < count; ++i)
+        EXPECT_EQ(v.getFieldAs<uint16_t>(Dimension::Id::Intensity, i),
+            i % 60000);
+
+    std::vector<uint16_t> intensity(count);
+    v.getFieldArray(Dimension::Id::Intensity, 0, count, intensity.data());
+    for (PointId i = 0; i < count; ++i)
+        EXPECT_EQ(intensity[i], i % 60000);
+
+    // Values that don't fit the dimension's type are an error.
+    in[3] = 70000.0;
+    EXPECT_THROW(v.setFieldArray(Dimension::Id::Intensity, 0, 10, in.data()),
+        pdal_error);
+    std::vector<int8_t> small(count);
+    EXPECT_THROW(v.getFieldArray(Dimension::Id::X, 0, count, small.data()),
+        pdal_error);
+}
+
+} // unnamed namespace
+
+TEST(PointViewTest, fieldArray)
+{
+    PointTable t1;
+    testFieldArray(t1);
+
+    ColumnPointTable t2;
+    testFieldArray(t2);
+
+    ContiguousPointTable t3;
+    testFieldArray(t3);
+}
+
+TEST(PointViewTest, typedDim)
+{
+    PointTable table;
+    PointLayoutPtr layout(table.layout());
+    layout->registerDim(Dimension::Id::X, Dimension::Type::Double);
+    layout->registerDim(Dimension::Id::Intensity, Dimension::Type::Unsigned32);
+    layout->finalize();
+
+    TypedDim<Dimension::Id::X, double> x;
+    TypedDim<Dimension::Id::Intensity, uint16_t> intensity;
+    TypedDim<Dimension::Id::Red, uint16_t> red;
+    x.resolve(*layout);
+    intensity.resolve(*layout);
+    red.resolve(*layout);
+    EXPECT_TRUE(x.direct());
+    EXPECT_FALSE(intensity.direct());
+    EXPECT_FALSE(red.direct());
+
+    PointView view(table);
+    PointRef point(view, 0);
+    x.set(point, 1234.5);
+    intensity.set(point, 60000);
+    EXPECT_DOUBLE_EQ(x.get(point), 1234.5);
+    EXPECT_EQ(intensity.get(point), 60000u);
+    EXPECT_DOUBLE_EQ(view.getFieldAs<double>(Dimension::Id::X, 0), 1234.5);
+    EXPECT_EQ(view.getFieldAs<uint32_t>(Dimension::Id::Intensity, 0), 60000u);
+
+    // Dimensions that aren't in the layout read as zero.
+    EXPECT_EQ(red.get(point), 0u);
+
+    // A value that doesn't fit the requested type can't be fetched.
+    view.setField(Dimension::Id::Intensity, 0, 70000);
+    EXPECT_THROW(intensity.get(point), pdal_error);
+}
+
+TEST(PointViewTest, indexCache)
+{
+    PointTable table;
+    table.layout()->registerDims({Dimension::Id::X, Dimension::Id::Y,
+        Dimension::Id::Z, Dimension::Id::Intensity});
+
+    PointView view(table);
+    for (PointId i = 0; i < 3; ++i)
+    {
+        view.setField(Dimension::Id::X, i, i);
+        view.setField(Dimension::Id::Y, i, i);
+        view.setField(Dimension::Id::Z, i, i);
+    }
+
+    KD3Index *index = &view.build3dIndex();
+    EXPECT_EQ(index->neighbor(0, 0, 0), 0u);
+    KD2Index *index2 = &view.build2dIndex();
+    EXPECT_EQ(index2->neighbor(0, 0), 0u);
+
+    // Other dimensions don't touch the index.
+    view.setField(Dimension::Id::Intensity, 0, 10);
+    EXPECT_EQ(&view.build3dIndex(), index);
+    EXPECT_EQ(&view.build2dIndex(), index2);
+
+    // Moving a point does.
+    view.setField(Dimension::Id::X, 0, 100);
+    EXPECT_EQ(view.build3dIndex().neighbor(0, 0, 0), 1u);
+    EXPECT_EQ(view.build2dIndex().neighbor(100, 0), 0u);
+
+    // So do new points.
+    PointView other(table);
+    other.setField(Dimension::Id::X, 0, -0.5);
+    other.setField(Dimension::Id::Y, 0, -0.5);
+    other.setField(Dimension::Id::Z, 0, -0.5);
+    view.appendPoint(other, 0);
+    EXPECT_EQ(view.build3dIndex().neighbor(0, 0, 0), 3u);
+
+    // And reordering the points.
+    std::reverse(view.begin(), view.end());
+    EXPECT_EQ(view.build3dIndex().neighbor(0, 0, 0), 0u);
+}
+
+// Faces span chunks and keep their indices when the mesh switches to
+// full-width storage.
+TEST(PointViewTest, mesh)
+{
+    PointTable table;
+    PointView view(table);
+
+    TriangularMesh *mesh = view.createMesh("foo");
+    ASSERT_TRUE(mesh);
+    EXPECT_FALSE(view.createMesh("foo"));
+    EXPECT_EQ(view.mesh(), mesh);
+
+    const size_t count = TriangularMesh::ChunkFaces * 2 + 10;
+    for (PointId i = 0; i < count; ++i)
+        mesh->add(i, i + 1, i + 2);
+    EXPECT_EQ(mesh->size(), count);
+    Triangle t = (*mesh)[TriangularMesh::ChunkFaces + 5];
+    EXPECT_EQ(t.m_a, TriangularMesh::ChunkFaces + 5);
+    EXPECT_EQ(t.m_c, TriangularMesh::ChunkFaces + 7);
+
+    const PointId big = (PointId)(std::numeric_limits<uint32_t>::max)() + 1;
+    mesh->add(big, 1, 2);
+    EXPECT_EQ(mesh->size(), count + 1);
+    EXPECT_EQ((*mesh)[count].m_a, big);
+
+    size_t visited = 0;
+    mesh->visit(0, mesh->size(), [&](PointId a, PointId b, PointId c)
+    {
+        if (visited < count)
+        {
+            EXPECT_EQ(a, visited);
+            EXPECT_EQ(c, visited + 2);
+        }
+        visited++;
+    });
+    EXPECT_EQ(visited, count + 1);
+}
+
 // Per discussions with @abellgithub (https://github.com/gadomski/PDAL/commit/c1d54e56e2de841d37f2a1b1c218ed723053f6a9#commitcomment-14415138)
 // we only do bounds checking on `PointView`s when in debug mode.
+// X, Y and Z kept as scaled integers read and write as doubles.
+TEST(PointViewTest, scaled)
+{
+    using namespace Dimension;
+
+    PointTable table;
+    PointLayoutPtr layout = table.layout();
+    layout->registerDim(Id::X);
+    layout->registerDim(Id::Intensity);
+    XForm x(.01, 1000);
+    XForm yz;
+    yz.m_scale.set("auto");
+    yz.m_offset.set("auto");
+    layout->setScaling(x, yz, yz);
+    layout->proposeScaling(XForm(.5, 0), XForm(.1, 10), XForm(.1, 10));
+    layout->registerDim(Id::Y);
+    layout->registerDim(Id::Z);
+    layout->finalize();
+
+    EXPECT_EQ(layout->dimType(Id::X), Type::Double);
+    EXPECT_EQ(layout->dimSize(Id::X), 4u);
+    EXPECT_EQ(layout->pointSize(), 14u);
+    EXPECT_EQ(layout->dimDetail(Id::X)->xform().m_offset.m_val, 1000);
+    EXPECT_EQ(layout->dimDetail(Id::Y)->xform().m_scale.m_val, .1);
+    EXPECT_EQ(layout->dimDetail(Id::Y)->xform().m_offset.m_val, 10);
+
+    PointView view(table);
+    view.setField(Id::X, 0, 1234.567);
+    view.setField(Id::Y, 0, 20);
+    view.setField(Id::X, 1, 999);
+    EXPECT_DOUBLE_EQ(view.getFieldAs<double>(Id::X, 0), 1234.57);
+    EXPECT_DOUBLE_EQ(view.getFieldAs<double>(Id::Y, 0), 20);
+    EXPECT_EQ(view.getFieldAs<int>(Id::X, 1), 999);
+    EXPECT_THROW(view.setField(Id::X, 2, 1e10), pdal_error);
+
+    int32_t raw[2];
+    view.getScaledArray(Id::X, 0, 2, raw);
+    EXPECT_EQ(raw[0], 23457);
+    EXPECT_EQ(raw[1], -100);
+
+    double xs[2] { 1000.5, 1001 };
+    view.setFieldArray(Id::X, 0, 2, xs);
+    view.getFieldArray(Id::X, 0, 2, xs);
+    EXPECT_DOUBLE_EQ(xs[0], 1000.5);
+    EXPECT_DOUBLE_EQ(xs[1], 1001);
+    EXPECT_TRUE(view.compare(Id::X, 0, 1));
+
+    PointRef point(view, 1);
+    EXPECT_EQ(point.getScaledField(Id::X), 100);
+    point.setField(Id::X, 1000.25);
+    EXPECT_DOUBLE_EQ(point.getFieldAs<double>(Id::X), 1000.25);
+
+    TypedDim<Id::X, double> tx;
+    tx.resolve(*layout);
+    EXPECT_FALSE(tx.direct());
+    EXPECT_DOUBLE_EQ(tx.get(point), 1000.25);
+
+    // A scale that's 'auto' must be provided before the layout is final.
+    PointTable table2;
+    table2.layout()->setScaling(yz, yz, yz);
+    table2.layout()->registerDim(Id::X);
+    EXPECT_THROW(table2.layout()->finalize(), pdal_error);
+}
+
 #ifndef NDEBUG
+TEST(PointViewTest, append)
+{
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::X);
+
+    PointView v1(table);
+    PointView v2(table);
+    for (PointId i = 0; i < 5; ++i)
+    {
+        v1.setField(Dimension::Id::X, i, i);
+        v2.setField(Dimension::Id::X, i, i + 10);
+    }
+
+    v1.append(v2);
+    EXPECT_EQ(v1.size(), 10u);
+    for (PointId i = 0; i < 10; ++i)
+        EXPECT_EQ(v1.getFieldAs<int>(Dimension::Id::X, i),
+            i < 5 ? (int)i : (int)i + 5);
+
+    // The points are shared, not copied.
+    v2.setField(Dimension::Id::X, 0, 100);
+    EXPECT_EQ(v1.getFieldAs<int>(Dimension::Id::X, 5), 100);
+
+    v2.append(v2);
+    EXPECT_EQ(v2.size(), 10u);
+    EXPECT_EQ(v2.getFieldAs<int>(Dimension::Id::X, 5), 100);
+
+    PointTable other;
+    other.layout()->registerDim(Dimension::Id::X);
+    PointView v3(other);
+    EXPECT_THROW(v1.append(v3), pdal_error);
+}
+
+// Consecutive points are kept as runs and other points individually.
+TEST(PointViewTest, pointIndex)
+{
+    const size_t count = 1000000;
+    PointIndex index;
+    index.pushRun(0, count);
+    EXPECT_EQ(index.size(), count);
+    EXPECT_LT(index.memoryUsed(), 1024u);
+    EXPECT_EQ(index[0], 0u);
+    EXPECT_EQ(index[count - 1], count - 1);
+
+    // Changing an entry only expands the run around it.
+    index.set(500000, 7);
+    EXPECT_EQ(index[500000], 7u);
+    EXPECT_EQ(index[499999], 499999u);
+    EXPECT_EQ(index[500001], 500001u);
+    EXPECT_LT(index.memoryUsed(), 65536u * sizeof(PointId) + 1024);
+
+    index.push_back(count);
+    index.push_back(3);
+    EXPECT_EQ(index.size(), count + 2);
+    EXPECT_EQ(index[count], count);
+    EXPECT_EQ(index[count + 1], 3u);
+
+    std::vector<PointId> ids(4);
+    index.copy(count - 2, 4, ids.data());
+    EXPECT_EQ(ids, std::vector<PointId>({ count - 2, count - 1, count, 3 }));
+
+    index.resize(10);
+    index.append(index, 10);
+    EXPECT_EQ(index.size(), 20u);
+    EXPECT_EQ(index[15], 5u);
+    EXPECT_THROW(index.at(20), std::out_of_range);
+}
+
+// Filtered and reordered views must see the right points.
+TEST(PointViewTest, pointIndexView)
+{
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::X);
+
+    const PointId count = 200000;
+    PointView all(table);
+    for (PointId i = 0; i < count; ++i)
+        all.setField(Dimension::Id::X, i, i);
+
+    PointView odd(table);
+    for (PointId i = 1; i < count; i += 2)
+        odd.appendPoint(all, i);
+    ASSERT_EQ(odd.size(), count / 2);
+
+    std::vector<PointId> order(odd.size());
+    for (PointId i = 0; i < order.size(); ++i)
+        order[i] = order.size() - 1 - i;
+    odd.reorder(order);
+
+    std::vector<double> x(odd.size());
+    odd.getFieldArray(Dimension::Id::X, 0, odd.size(), x.data());
+    for (PointId i = 0; i < odd.size(); ++i)
+    {
+        EXPECT_EQ(odd.getFieldAs<PointId>(Dimension::Id::X, i),
+            count - 1 - 2 * i);
+        EXPECT_EQ(x[i], (double)(count - 1 - 2 * i));
+    }
+}
+
 TEST(PointViewDeathTest, out_of_bounds)
 {
     PointTable point_table;
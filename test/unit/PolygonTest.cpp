@@ -140,6 +140,42 @@ TEST(PolygonTest, covers)
     EXPECT_EQ(covered, true);
 }
 
+TEST(PolygonTest, coversBatch)
+{
+    pdal::Polygon p("MULTIPOLYGON (((0 0, 10 0, 10 10, 0 10, 0 0),"
+        "(4 4, 6 4, 6 6, 4 6, 4 4)),"
+        "((100 100, 110 100, 110 110, 100 110, 100 100)))");
+
+    std::vector<double> x { 1, 5, 0, 105, 50, 10, 115 };
+    std::vector<double> y { 1, 5, 5, 105, 50, 10, 105 };
+    std::vector<bool> expected { true, false, true, true, false, true, false };
+
+    std::vector<bool> covered;
+    p.covers(x.data(), y.data(), x.size(), covered);
+    EXPECT_EQ(covered, expected);
+
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::X);
+    table.layout()->registerDim(Dimension::Id::Y);
+    table.layout()->registerDim(Dimension::Id::Z);
+    PointView view(table);
+    for (PointId i = 0; i < x.size(); ++i)
+    {
+        view.setField(Dimension::Id::X, i, x[i]);
+        view.setField(Dimension::Id::Y, i, y[i]);
+        view.setField(Dimension::Id::Z, i, 0);
+        EXPECT_EQ(p.covers(view.point(i)), expected[i]);
+    }
+
+    // Changing the geometry discards the point-in-polygon engine.
+    pdal::Polygon copy(p);
+    p.update("POLYGON ((200 200, 201 200, 201 201, 200 201, 200 200))");
+    p.covers(x.data(), y.data(), x.size(), covered);
+    EXPECT_EQ(covered, std::vector<bool>(x.size(), false));
+    copy.covers(x.data(), y.data(), x.size(), covered);
+    EXPECT_EQ(covered, expected);
+}
+
 TEST(PolygonTest, valid)
 {
     pdal::Polygon p(getWKT());
@@ -186,6 +222,32 @@ TEST(PolygonTest, bounds3d)
     EXPECT_NEAR(b.maxz, 438.70996, .00001);
 }
 
+TEST(PolygonTest, predicates)
+{
+    pdal::Polygon big(BOX2D(0, 0, 10, 10));
+    pdal::Polygon small(BOX2D(2, 2, 4, 4));
+    pdal::Polygon far(BOX2D(20, 20, 30, 30));
+    pdal::Polygon edge(BOX2D(10, 0, 20, 10));
+    pdal::Polygon part(BOX2D(5, 5, 15, 15));
+
+    EXPECT_TRUE(small.within(big));
+    EXPECT_FALSE(big.within(small));
+    EXPECT_FALSE(far.within(big));
+    EXPECT_TRUE(big.contains(small));
+    EXPECT_FALSE(big.contains(far));
+    EXPECT_FALSE(big.contains(part));
+    EXPECT_TRUE(big.overlaps(part));
+    EXPECT_FALSE(big.overlaps(far));
+    EXPECT_TRUE(big.touches(edge));
+    EXPECT_FALSE(big.touches(far));
+    EXPECT_FALSE(big.crosses(far));
+
+    // Modifying a polygon must discard its cached bounds.
+    pdal::Polygon moved(small);
+    moved.update(far.wkt());
+    EXPECT_TRUE(small.within(big));
+    EXPECT_FALSE(moved.within(big));
+}
 
 TEST(PolygonTest, streams)
 {
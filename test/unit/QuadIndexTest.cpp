@@ -0,0 +1,137 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (hobu.inc@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <algorithm>
+#include <random>
+
+#include <pdal/PointView.hpp>
+#include <pdal/QuadIndex.hpp>
+#include "Support.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+void fill(PointView& view, point_count_t count)
+{
+    PointLayoutPtr layout = view.table().layout();
+    layout->registerDim(Dimension::Id::X);
+    layout->registerDim(Dimension::Id::Y);
+    layout->finalize();
+
+    std::mt19937 gen(17);
+    std::uniform_real_distribution<double> dist(0, 1000);
+    for (PointId i = 0; i < count; ++i)
+    {
+        view.setField(Dimension::Id::X, i, dist(gen));
+        view.setField(Dimension::Id::Y, i, dist(gen));
+    }
+}
+
+std::vector<PointId> bruteForce(const PointView& view, const BOX2D& box)
+{
+    std::vector<PointId> ids;
+    for (PointId i = 0; i < view.size(); ++i)
+    {
+        double x = view.getFieldAs<double>(Dimension::Id::X, i);
+        double y = view.getFieldAs<double>(Dimension::Id::Y, i);
+        if (x >= box.minx && y >= box.miny && x < box.maxx && y < box.maxy)
+            ids.push_back(i);
+    }
+    return ids;
+}
+
+} // unnamed namespace
+
+TEST(QuadIndexTest, boxes)
+{
+    PointTable table;
+    PointView view(table);
+    fill(view, 10000);
+
+    QuadIndex idx(view);
+
+    std::vector<BOX2D> boxes;
+    boxes.push_back(BOX2D(100, 100, 200, 200));
+    boxes.push_back(BOX2D(0, 0, 1000, 1000));
+    boxes.push_back(BOX2D(-50, 500, 10, 1500));
+    boxes.push_back(BOX2D(2000, 2000, 3000, 3000));
+    boxes.push_back(BOX2D(333.3, 0, 333.4, 1000));
+
+    std::vector<std::vector<PointId>> results = idx.getPoints(boxes);
+    ASSERT_EQ(results.size(), boxes.size());
+    for (size_t i = 0; i < boxes.size(); ++i)
+    {
+        std::vector<PointId> ids = results[i];
+        std::sort(ids.begin(), ids.end());
+        EXPECT_EQ(ids, bruteForce(view, boxes[i]));
+
+        const BOX2D& b = boxes[i];
+        ids = idx.getPoints(b.minx, b.miny, b.maxx, b.maxy);
+        std::sort(ids.begin(), ids.end());
+        EXPECT_EQ(ids, bruteForce(view, boxes[i]));
+    }
+}
+
+// Queries by depth use the tree of points by depth, which holds every
+// point once.
+TEST(QuadIndexTest, depth)
+{
+    PointTable table;
+    PointView view(table);
+    fill(view, 1000);
+
+    QuadIndex idx(view);
+
+    std::vector<size_t> fills = idx.getFills();
+    EXPECT_EQ(fills.size(), idx.getDepth() + 1);
+    size_t total = 0;
+    for (size_t f : fills)
+        total += f;
+    EXPECT_EQ(total, 1000u);
+    EXPECT_EQ(fills[0], 1u);
+
+    std::vector<PointId> all = idx.getPoints();
+    std::sort(all.begin(), all.end());
+    ASSERT_EQ(all.size(), 1000u);
+    for (PointId i = 0; i < all.size(); ++i)
+        EXPECT_EQ(all[i], i);
+
+    std::vector<PointId> top = idx.getPoints(0, 0, 1000, 1000, 2);
+    EXPECT_EQ(top.size(), fills[0] + fills[1]);
+}
@@ -0,0 +1,130 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <pdal/pdal_features.hpp>
+#include <pdal/private/RemoteCache.hpp>
+#include <pdal/util/FileUtils.hpp>
+
+#include "Support.hpp"
+
+using namespace pdal;
+
+#ifdef PDAL_ARBITER_ENABLED
+
+namespace
+{
+
+void writeFile(const std::string& filename, const std::string& contents)
+{
+    std::ostream *out = FileUtils::createFile(filename);
+    *out << contents;
+    FileUtils::closeFile(out);
+}
+
+} // unnamed namespace
+
+// Local files go through arbiter's file driver, which is validated
+// by size like the non-HTTP remote drivers.
+TEST(RemoteCacheTest, fetch)
+{
+    const std::string dir(Support::temppath("remote_cache"));
+    const std::string src1(Support::temppath("remote_cache1.txt"));
+    const std::string src2(Support::temppath("remote_cache2.txt"));
+    FileUtils::deleteDirectory(dir);
+    writeFile(src1, "abcdef");
+    writeFile(src2, "abcdef");
+
+    RemoteCache cache(dir, 1024 * 1024);
+    const std::string local = cache.fetch(src1);
+    EXPECT_EQ(FileUtils::readFileIntoString(local), "abcdef");
+    EXPECT_EQ(cache.misses(), 1U);
+    EXPECT_EQ(cache.hits(), 0U);
+
+    // A second read uses the cached copy.
+    EXPECT_EQ(cache.fetch(src1), local);
+    EXPECT_EQ(cache.misses(), 1U);
+    EXPECT_EQ(cache.hits(), 1U);
+
+    // A different path with the same contents shares the object.
+    EXPECT_EQ(cache.fetch(src2), local);
+    EXPECT_EQ(cache.misses(), 2U);
+    EXPECT_EQ(FileUtils::directoryList(dir + "/objects").size(), 1U);
+
+    // A changed file is downloaded again.
+    writeFile(src1, "abcdefgh");
+    const std::string changed = cache.fetch(src1);
+    EXPECT_NE(changed, local);
+    EXPECT_EQ(FileUtils::readFileIntoString(changed), "abcdefgh");
+    EXPECT_EQ(cache.misses(), 3U);
+
+    // A new cache on the same directory sees the earlier downloads.
+    RemoteCache cache2(dir, 1024 * 1024);
+    EXPECT_EQ(cache2.fetch(src1), changed);
+    EXPECT_EQ(cache2.hits(), 1U);
+
+    FileUtils::deleteDirectory(dir);
+    FileUtils::deleteFile(src1);
+    FileUtils::deleteFile(src2);
+}
+
+TEST(RemoteCacheTest, evict)
+{
+    const std::string dir(Support::temppath("remote_cache_evict"));
+    const std::string src1(Support::temppath("remote_cache_evict1.txt"));
+    const std::string src2(Support::temppath("remote_cache_evict2.txt"));
+    FileUtils::deleteDirectory(dir);
+    writeFile(src1, "12345678");
+    writeFile(src2, "abcdefgh");
+
+    // Room for one file.
+    RemoteCache cache(dir, 10);
+    const std::string local1 = cache.fetch(src1);
+    EXPECT_TRUE(FileUtils::fileExists(local1));
+    const std::string local2 = cache.fetch(src2);
+    EXPECT_TRUE(FileUtils::fileExists(local2));
+    EXPECT_FALSE(FileUtils::fileExists(local1));
+
+    // The evicted file is downloaded again.
+    EXPECT_EQ(cache.fetch(src1), local1);
+    EXPECT_EQ(cache.misses(), 3U);
+    EXPECT_EQ(FileUtils::readFileIntoString(local1), "12345678");
+
+    FileUtils::deleteDirectory(dir);
+    FileUtils::deleteFile(src1);
+    FileUtils::deleteFile(src2);
+}
+
+#endif // PDAL_ARBITER_ENABLED
@@ -39,6 +39,8 @@
 
 #include <filters/private/Segmentation.hpp>
 
+#include <algorithm>
+#include <random>
 #include <vector>
 
 using namespace pdal;
@@ -94,3 +96,62 @@ TEST(SegmentationTest, BasicClustering)
     EXPECT_EQ(1u, clusters.size());
     EXPECT_EQ(1u, clusters[0].size());
 }
+
+TEST(SegmentationTest, ClustersMatchRegionGrowing)
+{
+    using namespace Segmentation;
+
+    PointTable table;
+    table.layout()->registerDims(
+        {Dimension::Id::X, Dimension::Id::Y, Dimension::Id::Z});
+    PointViewPtr src(new PointView(table));
+
+    std::mt19937 gen(314);
+    std::uniform_real_distribution<double> dist(0, 20);
+    const PointId count = 1500;
+    for (PointId i = 0; i < count; ++i)
+    {
+        src->setField(Dimension::Id::X, i, dist(gen));
+        src->setField(Dimension::Id::Y, i, dist(gen));
+        src->setField(Dimension::Id::Z, i, dist(gen) / 10);
+    }
+
+    // Grow each cluster from its lowest unvisited point by brute force.
+    const double tolerance = 0.6;
+    auto close = [&src, tolerance](PointId a, PointId b)
+    {
+        using namespace Dimension;
+        double dx = src->getFieldAs<double>(Id::X, a) -
+            src->getFieldAs<double>(Id::X, b);
+        double dy = src->getFieldAs<double>(Id::Y, a) -
+            src->getFieldAs<double>(Id::Y, b);
+        double dz = src->getFieldAs<double>(Id::Z, a) -
+            src->getFieldAs<double>(Id::Z, b);
+        return dx * dx + dy * dy + dz * dz < tolerance * tolerance;
+    };
+
+    std::vector<bool> visited(count);
+    std::vector<std::vector<PointId>> expected;
+    for (PointId i = 0; i < count; ++i)
+    {
+        if (visited[i])
+            continue;
+        std::vector<PointId> cluster { i };
+        visited[i] = true;
+        for (size_t c = 0; c < cluster.size(); ++c)
+            for (PointId j = 0; j < count; ++j)
+                if (!visited[j] && close(cluster[c], j))
+                {
+                    cluster.push_back(j);
+                    visited[j] = true;
+                }
+        std::sort(cluster.begin(), cluster.end());
+        if (cluster.size() >= 3)
+            expected.push_back(cluster);
+    }
+
+    std::vector<std::vector<PointId>> clusters =
+        extractClusters(*src, 3, count, tolerance);
+    EXPECT_GT(clusters.size(), 10u);
+    EXPECT_EQ(expected, clusters);
+}
@@ -465,6 +465,30 @@ TEST(SpatialReferenceTest, identifyEPSG)
     EXPECT_EQ(web.identifyVerticalEPSG(), "");
 }
 
+// Repeated lookups come from the process-wide cache and must match the
+// first ones.
+TEST(SpatialReferenceTest, cache)
+{
+    SpatialReference a("EPSG:2029");
+    SpatialReference b("EPSG:2029");
+    EXPECT_EQ(a.getWKT(), b.getWKT());
+    EXPECT_EQ(a.identifyHorizontalEPSG(), "2029");
+    EXPECT_EQ(b.identifyHorizontalEPSG(), "2029");
+    EXPECT_EQ(a.getProj4(), b.getProj4());
+    EXPECT_TRUE(a.isProjected());
+    EXPECT_TRUE(b.isProjected());
+    EXPECT_FALSE(b.isGeographic());
+
+    SpatialReference c("EPSG:4326");
+    EXPECT_TRUE(c.isGeographic());
+    EXPECT_FALSE(c.isProjected());
+    EXPECT_FALSE(a == c);
+    EXPECT_TRUE(a == b);
+
+    EXPECT_THROW(SpatialReference("EPSG:nonsense"), pdal_error);
+    EXPECT_THROW(SpatialReference("EPSG:nonsense"), pdal_error);
+}
+
 // Make sure we get positive, negative and 0 back for UTM zones.
 TEST(SpatialReferenceTest, issue_1989)
 {
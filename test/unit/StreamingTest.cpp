@@ -33,11 +33,16 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
 #include <pdal/Filter.hpp>
 #include <pdal/PointTable.hpp>
 #include <io/FauxReader.hpp>
 #include <pdal/StageFactory.hpp>
 #include <filters/MergeFilter.hpp>
+#include <filters/SortFilter.hpp>
 #include <filters/StreamCallbackFilter.hpp>
 #include "Support.hpp"
 
@@ -528,3 +533,313 @@ R"(
         EXPECT_NE(output.find("DBDCA"), std::string::npos);
     }
 }
+
+// Make sure that running stages on separate threads passes points through
+// in order and honors filtered points.
+TEST(Streaming, pipelined)
+{
+    Options ro;
+    ro.add("bounds", BOX3D(0, 0, 0, 999, 999, 999));
+    ro.add("mode", "ramp");
+    ro.add("count", 1000);
+    FauxReader r;
+    r.setOptions(ro);
+
+    StreamCallbackFilter f1;
+    auto cb1 = [](PointRef& point)
+    {
+        return point.getFieldAs<int>(Dimension::Id::X) % 2 == 0;
+    };
+    f1.setCallback(cb1);
+    f1.setInput(r);
+
+    StreamCallbackFilter f2;
+    f2.setCallback([](PointRef&){ return true; });
+    f2.setInput(f1);
+
+    StreamCallbackFilter f3;
+    int cnt = 0;
+    int x = 0;
+    auto cb3 = [&cnt, &x](PointRef& point)
+    {
+        EXPECT_EQ(point.getFieldAs<int>(Dimension::Id::X), x);
+        x += 2;
+        cnt++;
+        return true;
+    };
+    f3.setCallback(cb3);
+    f3.setInput(f2);
+
+    FixedPointTable t(30);
+    f3.prepare(t);
+    f3.execute(t, 3);
+    EXPECT_EQ(cnt, 500);
+}
+
+// Check that stages that don't support streaming are run on buffered points.
+TEST(Streaming, hybrid)
+{
+    auto run = [](point_count_t chunkSize, int threads)
+    {
+        Options ro;
+        ro.add("bounds", BOX3D(0, 0, 0, 999, 999, 999));
+        ro.add("mode", "ramp");
+        ro.add("count", 1000);
+        FauxReader r;
+        r.setOptions(ro);
+
+        StreamCallbackFilter f1;
+        f1.setCallback([](PointRef& point)
+            { return point.getFieldAs<int>(Dimension::Id::X) % 2 == 0; });
+        f1.setInput(r);
+
+        Options so;
+        so.add("dimension", "X");
+        so.add("order", "DESC");
+        SortFilter sort;
+        sort.setOptions(so);
+        sort.setInput(f1);
+
+        StreamCallbackFilter f2;
+        std::vector<int> xs;
+        f2.setCallback([&xs](PointRef& point)
+        {
+            xs.push_back(point.getFieldAs<int>(Dimension::Id::X));
+            return true;
+        });
+        f2.setInput(sort);
+
+        EXPECT_FALSE(f2.pipelineStreamable());
+        FixedPointTable t(30);
+        f2.prepare(t);
+        f2.setHybridChunkSize(chunkSize);
+        f2.execute(t, threads);
+        return xs;
+    };
+
+    // Everything buffered: one sort of all the points.
+    std::vector<int> xs = run(0, 1);
+    EXPECT_EQ(xs.size(), 500u);
+    for (size_t i = 0; i < xs.size(); ++i)
+        EXPECT_EQ(xs[i], (int)(998 - 2 * i));
+    EXPECT_EQ(run(0, 3), xs);
+
+    // Each chunk of 100 points is sorted on its own.
+    xs = run(100, 1);
+    EXPECT_EQ(xs.size(), 500u);
+    for (size_t i = 0; i < xs.size(); ++i)
+    {
+        int chunk = (int)(i / 100);
+        int pos = (int)(i % 100);
+        EXPECT_EQ(xs[i], 200 * chunk + 198 - 2 * pos);
+    }
+}
+
+TEST(Streaming, profile)
+{
+    auto check = [](bool stream)
+    {
+        Options ro;
+        ro.add("bounds", BOX3D(0, 0, 0, 999, 999, 999));
+        ro.add("mode", "ramp");
+        ro.add("count", 1000);
+        FauxReader r;
+        r.setOptions(ro);
+
+        StreamCallbackFilter f;
+        f.setCallback([](PointRef& point)
+            { return point.getFieldAs<int>(Dimension::Id::X) % 4 == 0; });
+        f.setInput(r);
+
+        if (stream)
+        {
+            FixedPointTable t(100);
+            f.prepare(t);
+            f.execute(t);
+        }
+        else
+        {
+            PointTable t;
+            f.prepare(t);
+            f.execute(t);
+            EXPECT_GT(r.profile().allocatedBytes(), 0u);
+            EXPECT_EQ(r.profile().tableBytes(), t.allocatedBytes());
+        }
+
+        EXPECT_EQ(r.profile().pointsIn(), 0u);
+        EXPECT_EQ(r.profile().pointsOut(), 1000u);
+        // The callback filter only removes points in stream mode.
+        point_count_t out = stream ? 250 : 1000;
+        EXPECT_EQ(f.profile().pointsIn(), 1000u);
+        EXPECT_EQ(f.profile().pointsOut(), out);
+        EXPECT_GE(r.profile().wallTime(), 0.0);
+
+        MetadataNode m = f.profile().toMetadata();
+        EXPECT_EQ(m.name(), "profile");
+        EXPECT_EQ(m.findChild("points_out").value<point_count_t>(), out);
+
+        // Preparing again clears the profile.
+        PointTable t;
+        f.prepare(t);
+        EXPECT_EQ(f.profile().pointsIn(), 0u);
+    };
+
+    check(true);
+    check(false);
+}
+
+namespace
+{
+
+// Drops every other point a batch at a time.
+class BatchFilter : public Filter, public Streamable
+{
+public:
+    std::string getName() const
+        { return "filters.batchtest"; }
+
+    int m_batches = 0;
+
+private:
+    virtual bool processOne(PointRef& point)
+        { return point.pointId() % 2 == 0; }
+
+    virtual void processBatch(StreamPointTable& /*table*/, PointId begin,
+        PointId end, std::vector<bool>& keep)
+    {
+        m_batches++;
+        for (PointId idx = begin; idx < end; ++idx)
+            if ((idx % 2) == 1)
+                keep[idx - begin] = false;
+    }
+};
+
+}
+
+TEST(Streaming, batch)
+{
+    Options ro;
+    ro.add("bounds", BOX3D(0, 0, 0, 999, 999, 999));
+    ro.add("mode", "ramp");
+    ro.add("count", 1000);
+    FauxReader r;
+    r.setOptions(ro);
+
+    BatchFilter b;
+    b.setInput(r);
+
+    // A filter without its own batch processing sees only the points
+    // that were kept, one at a time.
+    point_count_t cnt = 0;
+    StreamCallbackFilter f;
+    f.setCallback([&cnt](PointRef& point)
+    {
+        EXPECT_EQ(point.pointId() % 2, 0u);
+        cnt++;
+        return true;
+    });
+    f.setInput(b);
+
+    FixedPointTable t(100);
+    f.prepare(t);
+    f.execute(t);
+
+    EXPECT_EQ(b.m_batches, 10);
+    EXPECT_EQ(cnt, 500u);
+    EXPECT_EQ(b.profile().pointsIn(), 1000u);
+    EXPECT_EQ(b.profile().pointsOut(), 500u);
+    EXPECT_EQ(f.profile().pointsIn(), 500u);
+}
+
+TEST(Streaming, adaptive)
+{
+    Options ro;
+    ro.add("bounds", BOX3D(0, 0, 0, 199999, 199999, 199999));
+    ro.add("mode", "ramp");
+    ro.add("count", 200000);
+    FauxReader r;
+    r.setOptions(ro);
+
+    // The points must come through in order however the batches are sized.
+    int cnt = 0;
+    StreamCallbackFilter f;
+    f.setCallback([&cnt](PointRef& point)
+    {
+        EXPECT_EQ(point.getFieldAs<int>(Dimension::Id::X), cnt);
+        cnt++;
+        return true;
+    });
+    f.setInput(r);
+
+    AdaptivePointTable t(8192);
+    f.prepare(t);
+    f.execute(t);
+
+    EXPECT_EQ(cnt, 200000);
+    EXPECT_GE(t.capacity(), 1024u);
+    EXPECT_LE(t.capacity(), 8192u);
+}
+
+// Check that the paths from several readers run at the same time and
+// that the stage they share gets the points in order when asked to.
+TEST(Streaming, concurrentPaths)
+{
+    const std::thread::id caller = std::this_thread::get_id();
+    std::atomic<int> elsewhere(0);
+
+    auto run = [&](bool ordered, bool fail)
+    {
+        std::vector<std::unique_ptr<FauxReader>> readers;
+        std::vector<std::unique_ptr<StreamCallbackFilter>> filters;
+        StreamCallbackFilter last;
+        for (int i = 0; i < 3; ++i)
+        {
+            Options ro;
+            ro.add("bounds", BOX3D(i * 1000, 0, 0, i * 1000 + 999, 999, 999));
+            ro.add("mode", "ramp");
+            ro.add("count", 1000);
+            readers.emplace_back(new FauxReader);
+            readers.back()->setOptions(ro);
+
+            // Each reader's own filter keeps points with even X.
+            filters.emplace_back(new StreamCallbackFilter);
+            filters.back()->setCallback([&, fail](PointRef& point)
+            {
+                if (std::this_thread::get_id() != caller)
+                    elsewhere++;
+                int x = point.getFieldAs<int>(Dimension::Id::X);
+                if (fail && x == 1500)
+                    throw pdal_error("Failed");
+                return x % 2 == 0;
+            });
+            filters.back()->setInput(*readers.back());
+            last.setInput(*filters.back());
+        }
+
+        std::vector<int> xs;
+        last.setCallback([&xs](PointRef& point)
+        {
+            xs.push_back(point.getFieldAs<int>(Dimension::Id::X));
+            return true;
+        });
+        last.setStreamOrdered(ordered);
+
+        FixedPointTable t(30);
+        last.prepare(t);
+        last.execute(t, 4);
+        return xs;
+    };
+
+    std::vector<int> expected;
+    for (int x = 0; x < 3000; x += 2)
+        expected.push_back(x);
+
+    EXPECT_EQ(run(true, false), expected);
+    EXPECT_EQ(elsewhere, 3000);
+    std::vector<int> xs = run(false, false);
+    std::sort(xs.begin(), xs.end());
+    EXPECT_EQ(xs, expected);
+
+    EXPECT_THROW(run(true, true), pdal_error);
+    EXPECT_THROW(run(false, true), pdal_error);
+}
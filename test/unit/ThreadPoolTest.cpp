@@ -0,0 +1,118 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (hobu.inc@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <pdal/util/ThreadPool.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace pdal;
+
+namespace
+{
+
+// Counts the threads running at once and records the most seen.
+class Gauge
+{
+public:
+    Gauge() : m_now(0), m_max(0)
+    {}
+
+    void run()
+    {
+        size_t now = ++m_now;
+        size_t max = m_max;
+        while (now > max && !m_max.compare_exchange_weak(max, now))
+            ;
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        --m_now;
+    }
+
+    size_t max() const
+        { return m_max; }
+
+private:
+    std::atomic<size_t> m_now;
+    std::atomic<size_t> m_max;
+};
+
+} // unnamed namespace
+
+// Pools get no more threads than the process-wide limit.
+TEST(ThreadPoolTest, poolLimit)
+{
+    setParallelThreads(2);
+    {
+        ThreadPool pool(8, 8, false);
+        EXPECT_EQ(pool.numThreads(), 2u);
+    }
+    setParallelThreads(0);
+    ThreadPool pool(8, 8, false);
+    EXPECT_EQ(pool.numThreads(), 8u);
+}
+
+// A parallelFor() inside pool tasks only uses threads that the pool
+// leaves free, so the two together stay within the limit.
+TEST(ThreadPoolTest, nested)
+{
+    setParallelThreads(4);
+
+    Gauge gauge;
+    {
+        ThreadPool pool(3, 3, false);
+        for (int t = 0; t < 6; ++t)
+            pool.add([&gauge]()
+            {
+                parallelFor(64, [&gauge]()
+                    { return [&gauge](size_t){ gauge.run(); }; }, 1);
+            });
+        pool.await();
+    }
+    EXPECT_LE(gauge.max(), 4u);
+    EXPECT_GE(gauge.max(), 3u);
+    EXPECT_EQ(parallel_detail::busyThreads(), 0u);
+
+    // Once the pool is gone, a loop gets all the threads.
+    Gauge all;
+    parallelFor(64, [&all]()
+        { return [&all](size_t){ all.run(); }; }, 1);
+    EXPECT_EQ(all.max(), (std::min)(parallelThreads(), (size_t)4));
+
+    setParallelThreads(0);
+}
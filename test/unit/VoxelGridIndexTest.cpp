@@ -0,0 +1,143 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <algorithm>
+#include <random>
+
+#include <pdal/KDIndex.hpp>
+#include <pdal/VoxelGridIndex.hpp>
+
+using namespace pdal;
+
+namespace
+{
+
+void makePoints(PointView& view, PointId count)
+{
+    std::mt19937 gen(2468);
+    std::uniform_real_distribution<double> dist(-50, 50);
+    for (PointId i = 0; i < count; ++i)
+    {
+        view.setField(Dimension::Id::X, i, dist(gen));
+        view.setField(Dimension::Id::Y, i, dist(gen));
+        view.setField(Dimension::Id::Z, i, dist(gen) / 10);
+    }
+}
+
+std::vector<PointId> sorted(std::vector<PointId> ids)
+{
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+} // unnamed namespace
+
+TEST(VoxelGridIndexTest, radius)
+{
+    PointTable table;
+    table.layout()->registerDims(
+        {Dimension::Id::X, Dimension::Id::Y, Dimension::Id::Z});
+    PointView view(table);
+    makePoints(view, 20000);
+
+    KD3Index kdi(view);
+    kdi.build();
+
+    // Cells the size of the radius, smaller and larger.
+    for (double cellSize : { 2.0, 0.5, 10.0 })
+    {
+        VoxelGridIndex index(view, cellSize);
+        index.build();
+
+        for (PointId i = 0; i < view.size(); i += 97)
+        {
+            std::vector<PointId> ids = index.radius(i, 2.0);
+            EXPECT_EQ(sorted(ids), sorted(kdi.radius(i, 2.0)));
+            ASSERT_FALSE(ids.empty());
+
+            // Nearest first.
+            EXPECT_EQ(ids[0], i);
+        }
+        EXPECT_EQ(sorted(index.radius(0, 0, 0, 3.0)),
+            sorted(kdi.radius(0, 0, 0, 3.0)));
+        // Outside the points.
+        EXPECT_TRUE(index.radius(1000, 1000, 1000, 3.0).empty());
+    }
+}
+
+TEST(VoxelGridIndexTest, radiusAll)
+{
+    PointTable table;
+    table.layout()->registerDims(
+        {Dimension::Id::X, Dimension::Id::Y, Dimension::Id::Z});
+    PointView view(table);
+    makePoints(view, 5000);
+
+    KD3Index& kdi = view.build3dIndex();
+    VoxelGridIndex index(view, 3.0);
+    index.build();
+
+    std::vector<std::vector<PointId>> found(view.size());
+    index.radiusAll(3.0, [&found](PointId i, const std::vector<PointId>& ids,
+        const std::vector<double>& sqrDists)
+    {
+        EXPECT_EQ(ids.size(), sqrDists.size());
+        EXPECT_TRUE(std::is_sorted(sqrDists.begin(), sqrDists.end()));
+        found[i] = ids;
+    });
+    for (PointId i = 0; i < view.size(); ++i)
+        EXPECT_EQ(sorted(found[i]), sorted(kdi.radius(i, 3.0)));
+}
+
+TEST(VoxelGridIndexTest, errors)
+{
+    PointTable table;
+    table.layout()->registerDims({Dimension::Id::X, Dimension::Id::Y});
+    PointView view(table);
+
+    EXPECT_THROW(VoxelGridIndex(view, 1.0), pdal_error);
+
+    PointTable table3;
+    table3.layout()->registerDims(
+        {Dimension::Id::X, Dimension::Id::Y, Dimension::Id::Z});
+    PointView view3(table3);
+    EXPECT_THROW(VoxelGridIndex(view3, 0), pdal_error);
+
+    // An empty view is fine.
+    VoxelGridIndex index(view3, 1.0);
+    index.build();
+    EXPECT_TRUE(index.radius(0, 0, 0, 1.0).empty());
+}
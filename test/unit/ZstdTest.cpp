@@ -35,6 +35,7 @@
 #include <pdal/pdal_test_main.hpp>
 
 #include <random>
+#include <sstream>
 
 #include <pdal/compression/ZstdCompression.hpp>
 
@@ -81,3 +82,86 @@ TEST(Compression, zstd)
     decompressor.done();
 }
 
+
+TEST(Compression, zstdOptions)
+{
+    std::default_random_engine generator;
+    std::uniform_int_distribution<int> dist(0, 1000);
+
+    std::vector<int> orig(1000357);
+    for (size_t i = 0; i < orig.size(); ++i)
+        orig[i] = dist(generator) + (int)(i / 1000);
+    const char *sp = reinterpret_cast<const char *>(orig.data());
+    const size_t s = orig.size() * sizeof(int);
+
+    CompressionOptions opts;
+    opts.level = 3;
+    opts.threads = 2;
+    opts.longDistance = true;
+
+    std::vector<char> compressed;
+    ZstdCompressor compressor([&compressed](char *buf, size_t bufsize)
+        { compressed.insert(compressed.end(), buf, buf + bufsize); }, opts);
+    compressor.compress(sp, s / 2);
+    compressor.compress(sp + s / 2, s - s / 2);
+    compressor.done();
+
+    std::vector<char> decompressed;
+    ZstdDecompressor decompressor([&decompressed](char *buf, size_t bufsize)
+        { decompressed.insert(decompressed.end(), buf, buf + bufsize); });
+    decompressor.decompress(compressed.data(), compressed.size());
+    decompressor.done();
+
+    ASSERT_EQ(decompressed.size(), s);
+    EXPECT_EQ(memcmp(decompressed.data(), sp, s), 0);
+}
+
+TEST(Compression, zstdDictionary)
+{
+    std::default_random_engine generator;
+    std::uniform_int_distribution<int> dist(0, 99);
+
+    // Small buffers of similar records, like points of EPT nodes.
+    auto makeSample = [&]()
+    {
+        std::ostringstream oss;
+        for (int i = 0; i < 20; ++i)
+            oss << "X=" << (500 + dist(generator)) << ".25 Y=" <<
+                (4000 + dist(generator)) << ".5 Z=" << dist(generator) <<
+                " Intensity=" << dist(generator) << ";";
+        std::string s = oss.str();
+        return std::vector<char>(s.begin(), s.end());
+    };
+
+    std::vector<std::vector<char>> samples;
+    for (int i = 0; i < 500; ++i)
+        samples.push_back(makeSample());
+    CompressionOptions opts;
+    opts.dictionary = trainZstdDictionary(samples, 4096);
+    EXPECT_GT(opts.dictionary.size(), 0u);
+    EXPECT_LE(opts.dictionary.size(), 4096u);
+
+    auto compress = [](const std::vector<char>& data,
+        const CompressionOptions& opts)
+    {
+        std::vector<char> compressed;
+        ZstdCompressor compressor([&compressed](char *buf, size_t bufsize)
+            { compressed.insert(compressed.end(), buf, buf + bufsize); },
+            opts);
+        compressor.compress(data.data(), data.size());
+        compressor.done();
+        return compressed;
+    };
+
+    std::vector<char> sample = makeSample();
+    std::vector<char> plain = compress(sample, CompressionOptions());
+    std::vector<char> withDict = compress(sample, opts);
+    EXPECT_LT(withDict.size(), plain.size());
+
+    std::vector<char> decompressed;
+    ZstdDecompressor decompressor([&decompressed](char *buf, size_t bufsize)
+        { decompressed.insert(decompressed.end(), buf, buf + bufsize); },
+        opts.dictionary);
+    decompressor.decompress(withDict.data(), withDict.size());
+    EXPECT_EQ(decompressed, sample);
+}
@@ -92,3 +92,25 @@ TEST(Hausdorff, distance)
 
     EXPECT_EQ(std::sqrt(6.0), Utils::computeHausdorff(src, cand));
 }
+
+TEST(Hausdorff, approximate)
+{
+    std::string A = Support::datapath("autzen/autzen-thin.las");
+    std::string B = Support::datapath("las/autzen_trim.las");
+    std::string output;
+
+    const std::string cmd = Support::binpath(Support::exename("pdal")) +
+                            " hausdorff --cell_size=10 " + A + " " + B;
+    EXPECT_EQ(Utils::run_shell_command(cmd, output), 0);
+
+    auto value = [&output](const std::string& key)
+    {
+        std::string::size_type pos = output.find("\"" + key + "\": ");
+        EXPECT_NE(pos, std::string::npos);
+        return std::stod(output.substr(pos + key.size() + 4));
+    };
+    double hausdorff = value("hausdorff");
+    double bound = value("error_bound");
+    EXPECT_DOUBLE_EQ(bound, 20 * std::sqrt(3.0));
+    EXPECT_LE(std::abs(hausdorff - 4416.968175), bound);
+}
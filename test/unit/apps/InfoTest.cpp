@@ -131,8 +131,8 @@ std::string r = R"foo(
         "minimum": 636001.76,
         "name": "X",
         "position": 0,
-        "stddev": 1946.814556,
-        "variance": 3790086.914
+        "stddev": 314.9304199,
+        "variance": 99181.16939
       },
       {
         "average": 849145.7857,
@@ -141,8 +141,8 @@ std::string r = R"foo(
         "minimum": 848935.2,
         "name": "Y",
         "position": 1,
-        "stddev": 2564.046991,
-        "variance": 6574336.973
+        "stddev": 124.3281512,
+        "variance": 15457.48917
       },
 )foo";
 
@@ -199,3 +199,22 @@ std::string r = R"foo(
 
     test("--all", r);
 }
+
+TEST(Info, sample)
+{
+    test("--stats --sample 1000", "\"total_points\": 110000");
+    test("--stats --sample 1000", "\"average_error\":");
+    test("--stats --fraction 0.1", "\"method\": \"runs\"");
+}
+
+TEST(Info, jobs)
+{
+    std::string cmd = appName() + " --summary --jobs 2 " +
+        Support::datapath("las/1.2-with-color*.las") + " 2>&1";
+
+    std::string output;
+    EXPECT_EQ(Utils::run_shell_command(cmd, output), 0);
+    EXPECT_NE(output.find("\"files\":"), std::string::npos);
+    EXPECT_NE(output.find("1.2-with-color.las\""), std::string::npos);
+    EXPECT_NE(output.find("1.2-with-color-clipped.las\""), std::string::npos);
+}
@@ -32,6 +32,8 @@
 ****************************************************************************/
 
 #include <iostream>
+#include <fstream>
+#include <limits>
 #include <string>
 
 #include <pdal/pdal_test_main.hpp>
@@ -108,3 +110,85 @@ TEST(Merge, Args)
     FileUtils::deleteFile(outfile);
 }
 
+
+
+namespace
+{
+
+point_count_t numPoints(const std::string& filename)
+{
+    std::string output;
+    Utils::run_shell_command(Support::binpath("pdal") + " info --summary " +
+        filename, output);
+    const std::string key("\"num_points\": ");
+    auto pos = output.find(key);
+    if (pos == std::string::npos)
+        return 0;
+    return std::stoull(output.substr(pos + key.size()));
+}
+
+} // unnamed namespace
+
+
+TEST(Merge, Threads)
+{
+    std::string file1(Support::datapath("las/tile/file1.las"));
+    std::string file2(Support::datapath("las/tile/file2.las"));
+    std::string file3(Support::datapath("las/tile/file3.las"));
+    std::string outfile(Support::temppath("out.las"));
+    std::string cmd = appName() + " --threads=2 " + file1 + " " + file2 +
+        " " + file3 + " " + outfile;
+
+    std::string output;
+    EXPECT_EQ(Utils::run_shell_command(cmd, output), 0);
+    EXPECT_EQ(numPoints(outfile),
+        numPoints(file1) + numPoints(file2) + numPoints(file3));
+
+    FileUtils::deleteFile(outfile);
+}
+
+
+TEST(Merge, OrderBy)
+{
+    std::string in1(Support::datapath("las/1.2-with-color.las"));
+    std::string in2(Support::datapath("las/100-points.las"));
+    std::string file1(Support::temppath("sorted1.las"));
+    std::string file2(Support::temppath("sorted2.las"));
+    std::string outfile(Support::temppath("out.txt"));
+
+    std::string output;
+    std::string sort(Support::binpath("pdal") + " translate ");
+    std::string sortArgs(" filters.sort --filters.sort.dimension=X");
+    EXPECT_EQ(Utils::run_shell_command(sort + in1 + " " + file1 + sortArgs,
+        output), 0);
+    EXPECT_EQ(Utils::run_shell_command(sort + in2 + " " + file2 + sortArgs,
+        output), 0);
+
+    std::string cmd = appName() + " --order_by=X " + file1 + " " + file2 +
+        " " + outfile;
+    EXPECT_EQ(Utils::run_shell_command(cmd, output), 0);
+
+    // Unsorted inputs are an error.
+    cmd = appName() + " --order_by=Y " + file1 + " " + file2 + " " +
+        Support::temppath("bad.txt") + " 2>&1";
+    EXPECT_NE(Utils::run_shell_command(cmd, output), 0);
+
+    std::ifstream in(outfile);
+    std::string line;
+    std::getline(in, line);
+    size_t count = 0;
+    double last = std::numeric_limits<double>::lowest();
+    while (std::getline(in, line))
+    {
+        double x = std::stod(line);
+        EXPECT_LE(last, x);
+        last = x;
+        count++;
+    }
+    EXPECT_EQ(count, numPoints(in1) + numPoints(in2));
+
+    FileUtils::deleteFile(file1);
+    FileUtils::deleteFile(file2);
+    FileUtils::deleteFile(outfile);
+    FileUtils::deleteFile(Support::temppath("bad.txt"));
+}
@@ -0,0 +1,157 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <chrono>
+#include <thread>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/Utils.hpp>
+#include "Support.hpp"
+
+using namespace pdal;
+
+#ifndef _WIN32
+
+namespace
+{
+
+std::string serveCommand(const std::string& socket)
+{
+    return Support::binpath(Support::exename("pdal")) + " serve " + socket;
+}
+
+// Connect to the server, waiting for it to start listening.
+int connectTo(const std::string& socket)
+{
+    sockaddr_un addr {};
+    addr.sun_family = AF_UNIX;
+    socket.copy(addr.sun_path, sizeof(addr.sun_path) - 1);
+    for (int i = 0; i < 200; ++i)
+    {
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (::connect(fd, (sockaddr *)&addr, sizeof(addr)) == 0)
+            return fd;
+        ::close(fd);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    return -1;
+}
+
+// Send a request, shutting down the connection's write side unless
+// 'hold' is set, and return the response.
+std::string request(const std::string& socket, const std::string& pipeline,
+    bool hold = false)
+{
+    int fd = connectTo(socket);
+    if (fd < 0)
+        return "";
+    ::send(fd, pipeline.data(), pipeline.size(), 0);
+    if (!hold)
+        ::shutdown(fd, SHUT_WR);
+
+    std::string response;
+    char buf[4096];
+    ssize_t cnt;
+    while ((cnt = ::read(fd, buf, sizeof(buf))) > 0)
+        response.append(buf, cnt);
+    ::close(fd);
+    return response;
+}
+
+} // unnamed namespace
+
+TEST(ServeTest, request)
+{
+    std::string socket = FileUtils::uniqueFilename("", "pdal-serve-");
+
+    int status = -1;
+    std::string output;
+    std::thread server([&]()
+    {
+        status = Utils::run_shell_command(serveCommand(socket) +
+            " --max-requests 1 2>&1", output);
+    });
+
+    std::string response = request(socket, "[ \"" +
+        Support::datapath("las/1.2-with-color.las") + "\" ]");
+    server.join();
+    EXPECT_EQ(status, 0) << output;
+    EXPECT_NE(response.find("\"points\": 1065"), std::string::npos) <<
+        response;
+    EXPECT_FALSE(FileUtils::fileExists(socket));
+}
+
+TEST(ServeTest, timeout)
+{
+    std::string socket = FileUtils::uniqueFilename("", "pdal-serve-");
+
+    int status = -1;
+    std::string output;
+    std::thread server([&]()
+    {
+        status = Utils::run_shell_command(serveCommand(socket) +
+            " --max-requests 1 --timeout 1 2>&1", output);
+    });
+
+    // A client that never finishes its request doesn't hold the server.
+    std::string response = request(socket, "[", true);
+    server.join();
+    EXPECT_EQ(status, 0) << output;
+    EXPECT_NE(response.find("Timed out"), std::string::npos) << response;
+}
+
+TEST(ServeTest, notSocket)
+{
+    // A file that isn't a socket isn't replaced.
+    std::string filename = FileUtils::uniqueFilename("", "pdal-serve-");
+    std::ostream *out = FileUtils::createFile(filename);
+    *out << "data";
+    FileUtils::closeFile(out);
+
+    std::string output;
+    EXPECT_NE(Utils::run_shell_command(serveCommand(filename) +
+        " --max-requests 1 2>&1", output), 0);
+    EXPECT_EQ(FileUtils::readFileIntoString(filename), "data");
+    FileUtils::deleteFile(filename);
+}
+
+#endif
@@ -0,0 +1,175 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <pdal/PointTable.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/Utils.hpp>
+#include <io/LasReader.hpp>
+#include <filters/SortFilter.hpp>
+#include <filters/StreamCallbackFilter.hpp>
+#include <kernels/private/ExternalSort.hpp>
+#include "Support.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+struct Pt
+{
+    int m_class;
+    double m_time;
+    double m_x;
+
+    bool operator==(const Pt& other) const
+    {
+        return m_class == other.m_class && m_time == other.m_time &&
+            m_x == other.m_x;
+    }
+};
+
+Pt makePt(const PointRef& p)
+{
+    return Pt { p.getFieldAs<int>(Dimension::Id::Classification),
+        p.getFieldAs<double>(Dimension::Id::GpsTime),
+        p.getFieldAs<double>(Dimension::Id::X) };
+}
+
+// Sort the file in memory with filters.sort.
+std::vector<Pt> sortInMemory(const std::string& filename,
+    const std::string& dims, const std::string& order)
+{
+    Options ro;
+    ro.add("filename", filename);
+    LasReader r;
+    r.setOptions(ro);
+
+    Options so;
+    so.add("dimension", dims);
+    so.add("order", order);
+    SortFilter f;
+    f.setOptions(so);
+    f.setInput(r);
+
+    PointTable table;
+    f.prepare(table);
+    PointViewSet s = f.execute(table);
+    PointViewPtr v = *s.begin();
+
+    std::vector<Pt> pts;
+    for (PointId i = 0; i < v->size(); ++i)
+        pts.push_back(makePt(v->point(i)));
+    return pts;
+}
+
+} // unnamed namespace
+
+TEST(SortTest, external)
+{
+    std::string filename = Support::datapath("las/autzen_trim.las");
+    std::vector<Pt> expected =
+        sortInMemory(filename, "Classification, GpsTime", "DESC");
+    ASSERT_GT(expected.size(), 0u);
+
+    Options ro;
+    ro.add("filename", filename);
+    LasReader r;
+    r.setOptions(ro);
+
+    // A tiny budget so that the points are split into many runs.
+    sort::ExternalSort sorter({ "Classification", " GpsTime" }, true,
+        100000, Support::temppath());
+    EXPECT_EQ(sorter.makeRuns(r), expected.size());
+    EXPECT_GT(sorter.numRuns(), 10u);
+
+    std::vector<Pt> pts;
+    StreamCallbackFilter f;
+    f.setInput(sorter.merged());
+    f.setCallback([&pts](PointRef& p)
+    {
+        pts.push_back(makePt(p));
+        return true;
+    });
+
+    FixedPointTable table(1000);
+    f.prepare(table);
+    f.execute(table);
+    EXPECT_TRUE(pts == expected);
+}
+
+TEST(SortTest, externalErrors)
+{
+    Options ro;
+    ro.add("filename", Support::datapath("las/autzen_trim.las"));
+    LasReader r;
+    r.setOptions(ro);
+
+    sort::ExternalSort sorter({ "Foo" }, false, 100000, "");
+    EXPECT_THROW(sorter.makeRuns(r), pdal_error);
+}
+
+TEST(SortTest, command)
+{
+    std::string in = Support::datapath("las/autzen_trim.las");
+    std::string out = Support::temppath("sorted.las");
+    FileUtils::deleteFile(out);
+
+    const std::string cmd = Support::binpath(Support::exename("pdal")) +
+        " sort " + in + " " + out + " --external --dimension=GpsTime "
+        "--memory-budget=1 --temp-dir=" + Support::temppath();
+    std::string output;
+    EXPECT_EQ(Utils::run_shell_command(cmd, output), 0);
+
+    std::vector<Pt> expected = sortInMemory(in, "GpsTime", "ASC");
+    std::vector<Pt> pts = sortInMemory(out, "GpsTime", "ASC");
+    EXPECT_TRUE(pts == expected);
+
+    Options ro;
+    ro.add("filename", out);
+    LasReader r;
+    r.setOptions(ro);
+    PointTable table;
+    r.prepare(table);
+    PointViewSet s = r.execute(table);
+    PointViewPtr v = *s.begin();
+    ASSERT_EQ(v->size(), expected.size());
+    for (PointId i = 1; i < v->size(); ++i)
+        EXPECT_LE(v->getFieldAs<double>(Dimension::Id::GpsTime, i - 1),
+            v->getFieldAs<double>(Dimension::Id::GpsTime, i));
+
+    EXPECT_NE(Utils::run_shell_command(cmd + " --order=UP", output), 0);
+    FileUtils::deleteFile(out);
+}
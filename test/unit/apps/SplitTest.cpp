@@ -0,0 +1,102 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <pdal/PointTable.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/Utils.hpp>
+#include <io/LasReader.hpp>
+#include "Support.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+PointViewPtr readLas(const std::string& filename)
+{
+    Options ro;
+    ro.add("filename", filename);
+    LasReader r;
+    r.setOptions(ro);
+    PointTable table;
+    r.prepare(table);
+    PointViewSet s = r.execute(table);
+    return *s.begin();
+}
+
+} // unnamed namespace
+
+TEST(SplitTest, streamCapacity)
+{
+    std::string in = Support::datapath("las/1.2-with-color.las");
+    std::string out = Support::temppath("split_stream.las");
+    std::vector<std::string> outs;
+    for (int i = 1; i <= 4; ++i)
+    {
+        outs.push_back(Support::temppath("split_stream_" +
+            std::to_string(i) + ".las"));
+        FileUtils::deleteFile(outs.back());
+    }
+
+    // Files end in the middle of a batch of points read into the table.
+    const std::string cmd = Support::binpath(Support::exename("pdal")) +
+        " split " + in + " " + out + " --stream --capacity=500";
+    std::string output;
+    EXPECT_EQ(Utils::run_shell_command(cmd + " 2>&1", output), 0) << output;
+
+    // The points of the input are written in order, 500 to a file.
+    PointViewPtr expected = readLas(in);
+    ASSERT_EQ(expected->size(), 1065u);
+    PointId next = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+        ASSERT_TRUE(FileUtils::fileExists(outs[i])) << outs[i];
+        PointViewPtr v = readLas(outs[i]);
+        EXPECT_EQ(v->size(), i < 2 ? 500u : 65u);
+        for (PointId idx = 0; idx < v->size(); ++idx, ++next)
+        {
+            EXPECT_NEAR(v->getFieldAs<double>(Dimension::Id::X, idx),
+                expected->getFieldAs<double>(Dimension::Id::X, next), 1e-6);
+            EXPECT_NEAR(v->getFieldAs<double>(Dimension::Id::Y, idx),
+                expected->getFieldAs<double>(Dimension::Id::Y, next), 1e-6);
+            EXPECT_EQ(v->getFieldAs<int>(Dimension::Id::Intensity, idx),
+                expected->getFieldAs<int>(Dimension::Id::Intensity, next));
+        }
+        FileUtils::deleteFile(outs[i]);
+    }
+    EXPECT_EQ(next, expected->size());
+    EXPECT_FALSE(FileUtils::fileExists(outs[3]));
+}
@@ -36,6 +36,8 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <pdal/PointView.hpp>
+#include <pdal/StageFactory.hpp>
 #include <pdal/util/FileUtils.hpp>
 
 #include "Support.hpp"
@@ -103,6 +105,52 @@ TEST(TIndex, test2)
     EXPECT_NE(pos, std::string::npos);
 }
 
+// Reading the files of a tile index concurrently should produce the same
+// points as reading them one after another.
+TEST(TIndex, threads)
+{
+    std::string inSpec(Support::datapath("tindex/*.txt"));
+    std::string outSpec(Support::temppath("tindex.out"));
+
+    std::string cmd = Support::binpath("pdal") + " tindex create " +
+        outSpec + " \"" + inSpec + "\"";
+
+    FileUtils::deleteDirectory(outSpec);
+
+    std::string output;
+    Utils::run_shell_command(cmd, output);
+
+    auto read = [&outSpec](int threads)
+    {
+        StageFactory factory;
+        Stage *reader = factory.createStage("readers.tindex");
+
+        Options opts;
+        opts.add("filename", outSpec);
+        opts.add("threads", threads);
+        reader->setOptions(opts);
+
+        PointTable table;
+        reader->prepare(table);
+        PointViewSet s = reader->execute(table);
+        EXPECT_EQ(s.size(), 1u);
+        PointViewPtr v = *s.begin();
+
+        std::vector<double> values;
+        for (PointId idx = 0; idx < v->size(); ++idx)
+        {
+            values.push_back(v->getFieldAs<double>(Dimension::Id::X, idx));
+            values.push_back(v->getFieldAs<double>(Dimension::Id::Y, idx));
+        }
+        return values;
+    };
+
+    std::vector<double> serial = read(1);
+    std::vector<double> parallel = read(3);
+    EXPECT_EQ(serial.size(), 24u);
+    EXPECT_EQ(serial, parallel);
+}
+
 // Indentical to test1, but filespec input comes from find command.
 TEST(TIndex, test3)
 {
@@ -147,3 +195,27 @@ TEST(TIndex, test3)
 #endif
 }
 
+
+// Files are indexed on several threads, and files that haven't changed
+// aren't indexed again.
+TEST(TIndex, createThreads)
+{
+    std::string inSpec(Support::datapath("tindex/*.txt"));
+    std::string outSpec(Support::temppath("tindex.out"));
+
+    std::string cmd = Support::binpath("pdal") + " --verbose=info tindex "
+        "create " + outSpec + " \"" + inSpec + "\" --threads=2 --log=stdout";
+
+    FileUtils::deleteDirectory(outSpec);
+
+    std::string output;
+    Utils::run_shell_command(cmd, output);
+    size_t count = 0;
+    for (auto pos = output.find("Indexed file"); pos != std::string::npos;
+            pos = output.find("Indexed file", pos + 1))
+        count++;
+    EXPECT_EQ(count, 3U);
+
+    Utils::run_shell_command(cmd, output);
+    EXPECT_EQ(output.find("Indexed file"), std::string::npos);
+}
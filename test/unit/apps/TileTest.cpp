@@ -118,3 +118,28 @@ TEST(Tile, test2)
     checkFile(2, 1, 3);
     checkFile(2, 2, 2);
 }
+
+
+// Writing with several threads and few open writers should give the same
+// tiles.
+TEST(Tile, threads)
+{
+    std::string inSpec(Support::datapath("text/file*.txt"));
+    std::string outSpec(Support::temppath("tile/out#.txt"));
+
+    std::string baseCmd = Support::binpath("pdal") + " tile \"" +
+        inSpec + "\" \"" + outSpec + "\" ";
+
+    FileUtils::deleteDirectory(Support::temppath("tile"));
+    FileUtils::createDirectory(Support::temppath("tile"));
+
+    std::string output;
+    std::string cmd = baseCmd + " --origin_x=0 --origin_y=0 --length=10 "
+        "--threads=4 --max_writers=2";
+    Utils::run_shell_command(cmd, output);
+
+    EXPECT_EQ(FileUtils::directoryList(Support::temppath("tile")).size(), 9U);
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            checkFile(i, j, 3);
+}
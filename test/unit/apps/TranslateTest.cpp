@@ -235,3 +235,22 @@ TEST(TranslateTest, issue_2114)
     EXPECT_FALSE(FileUtils::fileExists(Support::temppath("out4.las")));
 }
 
+
+// Check that a wildcard input is translated to one output per file.
+TEST(TranslateTest, multipleInputs)
+{
+    std::string output;
+    std::string in = Support::datapath("las/1.2-with-color*.las");
+    std::string out1 = Support::temppath("multi_1.2-with-color.las");
+    std::string out2 = Support::temppath("multi_1.2-with-color-clipped.las");
+    FileUtils::deleteFile(out1);
+    FileUtils::deleteFile(out2);
+
+    EXPECT_NE(runTranslate("\"" + in + "\" " + Support::temppath("out.las"),
+        output), 0);
+    EXPECT_EQ(runTranslate("\"" + in + "\" " +
+        Support::temppath("multi_#.las") + " --jobs 2", output), 0);
+
+    EXPECT_TRUE(FileUtils::fileExists(out1));
+    EXPECT_TRUE(FileUtils::fileExists(out2));
+}
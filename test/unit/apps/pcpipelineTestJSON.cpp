@@ -415,6 +415,114 @@ TEST(json, stagetags)
     EXPECT_NE(stat, 0);
 }
 
+TEST(json, batch)
+{
+    std::string pipeline(Support::temppath("batch.json"));
+    std::string list(Support::temppath("batch.txt"));
+    std::string out1(Support::temppath("batch_1.2-with-color.las"));
+    std::string out2(Support::temppath("batch_out.las"));
+    FileUtils::deleteFile(out1);
+    FileUtils::deleteFile(out2);
+
+    std::ostream *o = FileUtils::createFile(pipeline);
+    *o << "[ \"in.las\", { \"type\": \"writers.las\", \"filename\": \"" <<
+        Support::temppath("batch_#.las") << "\" } ]";
+    FileUtils::closeFile(o);
+
+    o = FileUtils::createFile(list);
+    *o << Support::datapath("las/1.2-with-color.las") << "\n";
+    *o << "# Comments and blank lines are skipped.\n\n";
+    *o << Support::datapath("las/simple.las") << " " << out2 << "\n";
+    FileUtils::closeFile(o);
+
+    std::string output;
+    std::string cmd(appName() + " " + pipeline + " --batch " + list +
+        " --jobs 2");
+    EXPECT_EQ(Utils::run_shell_command(cmd + " 2>&1", output), 0);
+    EXPECT_NE(output.find("Processed 2 files (0 failed): 2130 points"),
+        std::string::npos) << output;
+    EXPECT_TRUE(FileUtils::fileExists(out1));
+    EXPECT_TRUE(FileUtils::fileExists(out2));
+
+    // A file that fails is reported and doesn't stop the others.
+    o = FileUtils::createFile(list);
+    *o << Support::datapath("las/1.2-with-color.las") << "\n";
+    *o << Support::datapath("las/nonexistent.las") << "\n";
+    FileUtils::closeFile(o);
+    EXPECT_NE(Utils::run_shell_command(cmd + " 2>&1", output), 0);
+    EXPECT_NE(output.find("nonexistent.las: failed"), std::string::npos);
+    EXPECT_NE(output.find("Processed 2 files (1 failed): 1065 points"),
+        std::string::npos) << output;
+}
+
+TEST(json, batchWorkers)
+{
+    std::string pipeline(Support::temppath("batch_workers.json"));
+    std::string list(Support::temppath("batch_workers.txt"));
+    std::string workers(Support::temppath("batch_workers_hosts.txt"));
+
+    // The head filter's metadata sorts ahead of the reader's, but the
+    // points counted are the ones read.
+    std::ostream *o = FileUtils::createFile(pipeline);
+    *o << "[ \"in.las\", { \"type\": \"filters.head\", \"count\": 10 }, "
+        "{ \"type\": \"writers.null\" } ]";
+    FileUtils::closeFile(o);
+
+    o = FileUtils::createFile(list);
+    *o << Support::datapath("las/1.2-with-color.las") << "\n";
+    *o << Support::datapath("las/simple.las") << "\n";
+    FileUtils::closeFile(o);
+
+    // The worker runs the pipeline command itself.
+    o = FileUtils::createFile(workers);
+    *o << Support::binpath(Support::exename("pdal")) << "\n";
+    FileUtils::closeFile(o);
+
+    std::string output;
+    std::string cmd(appName() + " " + pipeline + " --batch " + list +
+        " --workers " + workers);
+    EXPECT_EQ(Utils::run_shell_command(cmd + " 2>&1", output), 0) << output;
+    EXPECT_NE(output.find("Processed 2 files (0 failed): 2130 points"),
+        std::string::npos) << output;
+}
+
+TEST(json, trace)
+{
+    std::string pipeline(Support::temppath("trace.json"));
+    std::string trace(Support::temppath("trace_out.json"));
+
+    std::ostream *o = FileUtils::createFile(pipeline);
+    *o << "[ \"" << Support::datapath("las/1.2-with-color.las") <<
+        "\", { \"type\": \"filters.range\", \"limits\": " <<
+        "\"Classification[2:2]\" }, { \"type\": \"writers.null\" } ]";
+    FileUtils::closeFile(o);
+
+    auto run = [&](const std::string& options)
+    {
+        FileUtils::deleteFile(trace);
+        std::string output;
+        std::string cmd(appName() + " " + pipeline + " --trace " + trace +
+            " " + options);
+        EXPECT_EQ(Utils::run_shell_command(cmd + " 2>&1", output), 0) <<
+            output;
+        return FileUtils::readFileIntoString(trace);
+    };
+
+    // Stream mode records a span for each batch of each stage.
+    std::string events = run("");
+    EXPECT_EQ(events.find("{\"traceEvents\":["), 0u);
+    EXPECT_NE(events.find("\"name\":\"readers.las\",\"cat\":\"stream\""),
+        std::string::npos) << events;
+    EXPECT_NE(events.find("\"name\":\"filters.range\",\"cat\":\"stream\""),
+        std::string::npos) << events;
+
+    // Standard mode records a span for each stage.
+    events = run("--nostream");
+    EXPECT_NE(events.find("\"name\":\"filters.range\",\"cat\":\"stage\""),
+        std::string::npos) << events;
+    EXPECT_NE(events.find("\"ph\":\"X\""), std::string::npos);
+}
+
 // Make sure that spatialreference works for random readers
 TEST(json, issue_2159)
 {
@@ -36,6 +36,7 @@
 
 #include <pdal/StageFactory.hpp>
 #include <pdal/util/FileUtils.hpp>
+#include <filters/StreamCallbackFilter.hpp>
 
 #include "Support.hpp"
 
@@ -177,3 +178,50 @@ TEST(AssignFilterTest, test_condition)
     EXPECT_EQ(v->size(), 10u);
     EXPECT_EQ(ielse, 7);
 }
+
+TEST(AssignFilterTest, stream_condition)
+{
+    StageFactory factory;
+
+    Stage& r = *factory.createStage("readers.las");
+    Stage& f = *factory.createStage("filters.assign");
+
+    // utm17.las contains 5 points with intensity of 280, 3 of 260 and 2 of 240
+    Options ro;
+    ro.add("filename", Support::datapath("las/utm17.las"));
+    r.setOptions(ro);
+
+    Options fo;
+    fo.add("condition", "Intensity[260:260]");
+    fo.add("assignment", "PointSourceId[:]=6");
+    fo.add("assignment", "Classification[:]=2");
+
+    f.setInput(r);
+    f.setOptions(fo);
+
+    int ielse = 0;
+    int i6 = 0;
+    StreamCallbackFilter c;
+    c.setCallback([&](PointRef& point)
+    {
+        int ii = point.getFieldAs<int>(Dimension::Id::PointSourceId);
+        int cls = point.getFieldAs<int>(Dimension::Id::Classification);
+        if (ii == 6)
+        {
+            EXPECT_EQ(cls, 2);
+            i6++;
+        }
+        else
+            ielse++;
+        return true;
+    });
+    c.setInput(f);
+
+    // Use a small table so that the points are processed in several batches.
+    FixedPointTable t(4);
+    c.prepare(t);
+    c.execute(t);
+
+    EXPECT_EQ(i6, 3);
+    EXPECT_EQ(ielse, 7);
+}
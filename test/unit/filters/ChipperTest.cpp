@@ -103,6 +103,74 @@ TEST(ChipperTest, test_construction)
 }
 
 
+TEST(ChipperTest, histogram)
+{
+    PointTable table;
+
+    Options ops1;
+    ops1.add("filename", Support::datapath("las/1.2-with-color.las"));
+    LasReader reader;
+    reader.setOptions(ops1);
+
+    Options options;
+    options.add("capacity", 15);
+    options.add("histogram", true);
+
+    ChipperFilter chipper;
+    chipper.setInput(reader);
+    chipper.setOptions(options);
+    chipper.prepare(table);
+    PointViewSet viewSet = chipper.execute(table);
+
+    // Every point is in exactly one chip and no chip is over capacity.
+    point_count_t total = 0;
+    for (auto& v : viewSet)
+    {
+        EXPECT_LE(v->size(), 15u);
+        EXPECT_GT(v->size(), 0u);
+        total += v->size();
+    }
+    EXPECT_EQ(total, 1065u);
+    EXPECT_GE(viewSet.size(), 71u);
+}
+
+
+// Points that share a location are too dense for the histogram and are
+// chipped by sorting.
+TEST(ChipperTest, histogram_dense)
+{
+    PointTable table;
+    table.layout()->registerDims({Dimension::Id::X, Dimension::Id::Y});
+    PointViewPtr view(new PointView(table));
+    for (PointId i = 0; i < 100; ++i)
+    {
+        double x = (i < 90) ? 5.0 : (double)i;
+        view->setField(Dimension::Id::X, i, x);
+        view->setField(Dimension::Id::Y, i, x);
+    }
+
+    Options ops;
+    ops.add("capacity", 10);
+    ops.add("histogram", true);
+
+    ChipperFilter chipper;
+    chipper.setOptions(ops);
+    chipper.prepare(table);
+    StageWrapper::ready(chipper, table);
+    PointViewSet viewSet = StageWrapper::run(chipper, view);
+    StageWrapper::done(chipper, table);
+
+    point_count_t total = 0;
+    for (auto& v : viewSet)
+    {
+        EXPECT_LE(v->size(), 10u);
+        total += v->size();
+    }
+    EXPECT_EQ(total, 100u);
+    EXPECT_EQ(viewSet.size(), 10u);
+}
+
+
 // Make sure things don't crash if the point buffer is empty.
 TEST(ChipperTest, empty_buffer)
 {
@@ -35,6 +35,7 @@
 #include <pdal/pdal_test_main.hpp>
 
 #include <io/FauxReader.hpp>
+#include <io/LasReader.hpp>
 #include <filters/ColorinterpFilter.hpp>
 #include <filters/StreamCallbackFilter.hpp>
 
@@ -296,3 +297,69 @@ TEST(ColorinterpFilterTest, mad)
     standardTest(coptions, test);
 }
 
+
+namespace
+{
+
+// Colors of the points of a LAS file, run in stream mode.
+std::vector<int> colorLas(Options& coptions, bool& streamable)
+{
+    Options ro;
+    ro.add("filename", Support::datapath("las/1.2-with-color.las"));
+    LasReader r;
+    r.setOptions(ro);
+
+    ColorinterpFilter c;
+    coptions.add("ramp", makeColor());
+    c.setOptions(coptions);
+    c.setInput(r);
+
+    std::vector<int> reds;
+    StreamCallbackFilter s;
+    s.setInput(c);
+    s.setCallback([&reds](PointRef& point)
+    {
+        reds.push_back(point.getFieldAs<int>(Dimension::Id::Red));
+        return true;
+    });
+
+    FixedPointTable t(100);
+    s.prepare(t);
+    streamable = s.pipelineStreamable();
+    s.execute(t);
+    return reds;
+}
+
+} // unnamed namespace
+
+TEST(ColorinterpFilterTest, header_range)
+{
+    Options ro;
+    ro.add("filename", Support::datapath("las/1.2-with-color.las"));
+    LasReader r;
+    r.setOptions(ro);
+    PointTable t;
+    r.prepare(t);
+    double minz = r.getMetadata().findChild("minz").value<double>();
+    double maxz = r.getMetadata().findChild("maxz").value<double>();
+
+    bool streamable;
+    Options explicitOps;
+    explicitOps.add("minimum", minz);
+    explicitOps.add("maximum", maxz);
+    std::vector<int> expected = colorLas(explicitOps, streamable);
+    EXPECT_TRUE(streamable);
+
+    Options headerOps;
+    headerOps.add("header_range", true);
+    std::vector<int> reds = colorLas(headerOps, streamable);
+    EXPECT_TRUE(streamable);
+    EXPECT_EQ(expected, reds);
+    EXPECT_EQ(reds.size(), 1065u);
+
+    // Without the header range the filter runs on buffered points.
+    Options autoOps;
+    reds = colorLas(autoOps, streamable);
+    EXPECT_FALSE(streamable);
+    EXPECT_EQ(reds.size(), 1065u);
+}
@@ -34,8 +34,13 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <random>
+
+#include <pdal/GDALUtils.hpp>
 #include <pdal/PointView.hpp>
+#include <pdal/util/FileUtils.hpp>
 #include <io/LasReader.hpp>
+#include <io/TextReader.hpp>
 #include <filters/ColorizationFilter.hpp>
 #include <filters/StreamCallbackFilter.hpp>
 
@@ -187,4 +192,176 @@ TEST(ColorizationFilterTest, test4)
     EXPECT_THROW(testFile(options, dims, 210, 205, 47175), pdal_error);
 }
 
+namespace
+{
+
+// Write a two band raster of 50x37 unit cells with its upper-left corner
+// at (0, 37), in 16x16 blocks so that the blocks on the right and bottom
+// edges are partial.  Band 1 holds row * 100 + column and band 2 holds
+// column * 3 + row.
+std::string writeBlockRaster()
+{
+    const int width = 50;
+    const int height = 37;
+    const int blockSize = 16;
+    std::string filename(Support::temppath("colorization_blocks.tif"));
+    FileUtils::deleteFile(filename);
+
+    gdal::registerDrivers();
+    gdal::Raster raster(filename, "GTiff", SpatialReference(),
+        { 0, 1, 0, height, 0, -1 });
+    gdal::GDALError err = raster.open(width, height, 2,
+        Dimension::Type::Double, -9999,
+        { "TILED=YES", "BLOCKXSIZE=16", "BLOCKYSIZE=16" });
+    EXPECT_EQ(err, gdal::GDALError::None) << raster.errorMsg();
+
+    // Blocks are written whole, so leave room past the last cell.
+    std::vector<double> band1(width * height + blockSize);
+    std::vector<double> band2(band1.size());
+    for (int row = 0; row < height; ++row)
+        for (int col = 0; col < width; ++col)
+        {
+            band1[row * width + col] = row * 100 + col;
+            band2[row * width + col] = col * 3 + row;
+        }
+    raster.writeBand(band1.data(), -9999.0, 1);
+    raster.writeBand(band2.data(), -9999.0, 2);
+    raster.close();
+    return filename;
+}
+
+// Write the center of each cell in random order, followed by random
+// points in and around the raster.
+std::string writeBlockPoints()
+{
+    std::string filename(Support::temppath("colorization_blocks.txt"));
+
+    std::vector<std::pair<double, double>> points;
+    for (int row = 0; row < 37; ++row)
+        for (int col = 0; col < 50; ++col)
+            points.emplace_back(col + .5, 37 - row - .5);
+    std::mt19937 gen(4321);
+    std::shuffle(points.begin(), points.end(), gen);
+
+    std::uniform_real_distribution<double> xdist(-2, 52);
+    std::uniform_real_distribution<double> ydist(-2, 39);
+    for (int i = 0; i < 1000; ++i)
+        points.emplace_back(xdist(gen), ydist(gen));
+
+    std::ostream *out = FileUtils::createFile(filename);
+    *out << "X,Y,Z\n";
+    for (auto& p : points)
+        *out << Utils::toString(p.first, 15) << "," <<
+            Utils::toString(p.second, 15) << ",0\n";
+    FileUtils::closeFile(out);
+    return filename;
+}
+
+} // unnamed namespace
+
+// Colorize points spread over every block of a tiled raster, including the
+// partial blocks at its edges, and check the values against those read one
+// point at a time and against the values written.
+TEST(ColorizationFilterTest, blocks)
+{
+    const std::string rasterFile = writeBlockRaster();
+    const std::string pointFile = writeBlockPoints();
 
+    gdal::Raster raster(rasterFile);
+    ASSERT_EQ(raster.open(), gdal::GDALError::None) << raster.errorMsg();
+
+    // Check a point against the per-point read.  Returns whether the point
+    // is in the raster.
+    auto check = [&raster](double x, double y, uint16_t red, uint16_t green)
+    {
+        std::vector<double> data;
+        if (raster.read(x, y, data) != gdal::GDALError::None)
+            return false;
+        EXPECT_EQ(red, (uint16_t)data[0]);
+        EXPECT_EQ(green, (uint16_t)data[1]);
+
+        // Cell centers are the first points.
+        double col = x - .5;
+        double row = 37 - y - .5;
+        if (col == std::floor(col) && row == std::floor(row))
+        {
+            EXPECT_EQ(red, (uint16_t)(row * 100 + col));
+            EXPECT_EQ(green, (uint16_t)(col * 3 + row));
+        }
+        return true;
+    };
+
+    Options readerOps;
+    readerOps.add("filename", pointFile);
+
+    Options filterOps;
+    filterOps.add("raster", rasterFile);
+    filterOps.add("dimensions", "Red:1,Green:2");
+
+    // Standard mode keeps points that aren't in the raster uncolored.
+    {
+        TextReader reader;
+        reader.setOptions(readerOps);
+
+        ColorizationFilter filter;
+        filter.setOptions(filterOps);
+        filter.setInput(reader);
+
+        PointTable table;
+        filter.prepare(table);
+        PointViewSet viewSet = filter.execute(table);
+        ASSERT_EQ(viewSet.size(), 1u);
+        PointViewPtr view = *viewSet.begin();
+        ASSERT_EQ(view->size(), 50u * 37u + 1000u);
+
+        point_count_t found = 0;
+        for (PointId i = 0; i < view->size(); ++i)
+        {
+            using namespace Dimension;
+
+            uint16_t red = view->getFieldAs<uint16_t>(Id::Red, i);
+            uint16_t green = view->getFieldAs<uint16_t>(Id::Green, i);
+            if (check(view->getFieldAs<double>(Id::X, i),
+                view->getFieldAs<double>(Id::Y, i), red, green))
+                found++;
+            else
+            {
+                EXPECT_EQ(red, 0);
+                EXPECT_EQ(green, 0);
+            }
+        }
+        EXPECT_GT(found, 50u * 37u);
+        EXPECT_LT(found, view->size());
+    }
+
+    // Stream mode drops points that aren't in the raster.
+    {
+        TextReader reader;
+        reader.setOptions(readerOps);
+
+        ColorizationFilter filter;
+        filter.setOptions(filterOps);
+        filter.setInput(reader);
+
+        point_count_t count = 0;
+        StreamCallbackFilter c;
+        c.setCallback([&check, &count](PointRef& p)
+        {
+            using namespace Dimension;
+
+            EXPECT_TRUE(check(p.getFieldAs<double>(Id::X),
+                p.getFieldAs<double>(Id::Y),
+                p.getFieldAs<uint16_t>(Id::Red),
+                p.getFieldAs<uint16_t>(Id::Green)));
+            count++;
+            return true;
+        });
+        c.setInput(filter);
+
+        FixedPointTable table(100);
+        c.prepare(table);
+        c.execute(table);
+        EXPECT_GT(count, 50u * 37u);
+        EXPECT_LT(count, 50u * 37u + 1000u);
+    }
+}
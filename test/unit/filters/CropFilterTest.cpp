@@ -34,6 +34,8 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <random>
+
 #include <pdal/util/FileUtils.hpp>
 #include <pdal/PointView.hpp>
 #include <pdal/StageFactory.hpp>
@@ -259,6 +261,126 @@ TEST(CropFilterTest, multibounds)
 }
 
 
+// Each region's view holds the points it keeps, in input order, when many
+// overlapping regions are cropped in a single pass, and stream mode keeps
+// the points kept by any region.
+TEST(CropFilterTest, manyRegions)
+{
+    using namespace Dimension;
+
+    struct Region
+    {
+        BOX2D box;
+        bool circle;
+    };
+
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> pos(-5, 95);
+    std::uniform_int_distribution<int> size(0, 20);
+
+    Options o;
+    std::vector<Region> regions;
+    std::vector<Region> boxes;
+    for (size_t i = 0; i < 80; ++i)
+    {
+        double x = pos(gen);
+        double y = pos(gen);
+        BOX2D b(x, y, x + size(gen), y + size(gen));
+        std::ostringstream oss;
+        if (i % 2)
+        {
+            oss << "([" << b.minx << ", " << b.maxx << "], [" <<
+                b.miny << ", " << b.maxy << "])";
+            o.add("bounds", oss.str());
+            boxes.push_back({b, false});
+        }
+        else if (b.maxx > b.minx && b.maxy > b.miny)
+        {
+            oss << "POLYGON ((" << b.minx << " " << b.miny << ", " <<
+                b.maxx << " " << b.miny << ", " << b.maxx << " " <<
+                b.maxy << ", " << b.minx << " " << b.maxy << ", " <<
+                b.minx << " " << b.miny << "))";
+            o.add("polygon", oss.str());
+            regions.push_back({b, false});
+        }
+    }
+    regions.insert(regions.end(), boxes.begin(), boxes.end());
+    o.add("point", "POINT (50 50)");
+    o.add("distance", 10);
+    regions.push_back({BOX2D(50, 50, 50, 50), true});
+
+    auto covers = [](const Region& r, double x, double y)
+    {
+        if (r.circle)
+            return (x - 50) * (x - 50) + (y - 50) * (y - 50) < 100;
+        return r.box.contains(x, y);
+    };
+
+    // A 100 x 100 grid of points, X varying fastest.
+    Options readerOpts;
+    readerOpts.add("mode", "grid");
+    readerOpts.add("bounds", BOX3D(0, 0, 0, 100, 100, 0));
+    const point_count_t count = 10000;
+
+    for (bool outside : { false, true })
+    {
+        FauxReader r;
+        r.setOptions(readerOpts);
+
+        Options cropOpts(o);
+        cropOpts.add("outside", outside);
+        CropFilter crop;
+        crop.setInput(r);
+        crop.setOptions(cropOpts);
+
+        PointTable table;
+        crop.prepare(table);
+        PointViewSet s = crop.execute(table);
+        ASSERT_EQ(s.size(), regions.size());
+
+        point_count_t kept = 0;
+        for (PointId idx = 0; idx < count; ++idx)
+        {
+            double x = (double)(idx % 100);
+            double y = (double)(idx / 100);
+            for (const Region& reg : regions)
+                if (covers(reg, x, y) != outside)
+                {
+                    kept++;
+                    break;
+                }
+        }
+
+        auto it = s.begin();
+        for (const Region& reg : regions)
+        {
+            PointViewPtr v = *it++;
+            PointId out = 0;
+            for (PointId idx = 0; idx < count; ++idx)
+            {
+                double x = (double)(idx % 100);
+                double y = (double)(idx / 100);
+                if (covers(reg, x, y) == outside)
+                    continue;
+                ASSERT_LT(out, v->size());
+                EXPECT_EQ(v->getFieldAs<double>(Id::X, out), x);
+                EXPECT_EQ(v->getFieldAs<double>(Id::Y, out), y);
+                out++;
+            }
+            EXPECT_EQ(out, v->size());
+        }
+
+        point_count_t streamed = 0;
+        StreamCallbackFilter f;
+        f.setCallback([&streamed](PointRef&){ streamed++; return true; });
+        f.setInput(crop);
+        FixedPointTable t(1000);
+        f.prepare(t);
+        f.execute(t);
+        EXPECT_EQ(streamed, kept);
+    }
+}
+
 TEST(CropFilterTest, stream)
 {
     using namespace Dimension;
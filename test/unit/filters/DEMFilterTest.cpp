@@ -0,0 +1,230 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <random>
+
+#include <pdal/GDALUtils.hpp>
+#include <pdal/PointView.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <filters/DEMFilter.hpp>
+#include <filters/StreamCallbackFilter.hpp>
+#include <io/TextReader.hpp>
+
+#include "Support.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+// Write a raster of 50x37 unit cells with its upper-left corner at (0, 37),
+// in 16x16 blocks so that the blocks on the right and bottom edges are
+// partial.  Each cell holds row * 100 + column.
+std::string writeDem()
+{
+    const int width = 50;
+    const int height = 37;
+    const int blockSize = 16;
+    std::string filename(Support::temppath("dem_blocks.tif"));
+    FileUtils::deleteFile(filename);
+
+    gdal::registerDrivers();
+    gdal::Raster raster(filename, "GTiff", SpatialReference(),
+        { 0, 1, 0, height, 0, -1 });
+    gdal::GDALError err = raster.open(width, height, 1,
+        Dimension::Type::Double, -9999,
+        { "TILED=YES", "BLOCKXSIZE=16", "BLOCKYSIZE=16" });
+    EXPECT_EQ(err, gdal::GDALError::None) << raster.errorMsg();
+
+    // Blocks are written whole, so leave room past the last cell.
+    std::vector<double> band(width * height + blockSize);
+    for (int row = 0; row < height; ++row)
+        for (int col = 0; col < width; ++col)
+            band[row * width + col] = row * 100 + col;
+    raster.writeBand(band.data(), -9999.0, 1);
+    raster.close();
+    return filename;
+}
+
+// Write points at the center of each cell in random order, followed by
+// random points in and around the raster.  Every third point is at the
+// height of its cell, the others are 1.5 above or below it.
+std::string writeDemPoints()
+{
+    std::string filename(Support::temppath("dem_blocks.txt"));
+
+    std::vector<std::pair<double, double>> points;
+    for (int row = 0; row < 37; ++row)
+        for (int col = 0; col < 50; ++col)
+            points.emplace_back(col + .5, 37 - row - .5);
+    std::mt19937 gen(8765);
+    std::shuffle(points.begin(), points.end(), gen);
+
+    std::uniform_real_distribution<double> xdist(-2, 52);
+    std::uniform_real_distribution<double> ydist(-2, 39);
+    for (int i = 0; i < 1000; ++i)
+        points.emplace_back(xdist(gen), ydist(gen));
+
+    std::ostream *out = FileUtils::createFile(filename);
+    *out << "X,Y,Z\n";
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+        double x = points[i].first;
+        double y = points[i].second;
+        double z = std::floor(37 - y) * 100 + std::floor(x) +
+            ((int)(i % 3) - 1) * 1.5;
+        *out << Utils::toString(x, 15) << "," << Utils::toString(y, 15) <<
+            "," << Utils::toString(z, 15) << "\n";
+    }
+    FileUtils::closeFile(out);
+    return filename;
+}
+
+} // unnamed namespace
+
+// Filter points spread over every block of a tiled raster, including the
+// partial blocks at its edges, and check that the points kept are those
+// kept when the raster is read one point at a time.
+TEST(DEMFilterTest, blocks)
+{
+    const std::string rasterFile = writeDem();
+    const std::string pointFile = writeDemPoints();
+
+    gdal::Raster raster(rasterFile);
+    ASSERT_EQ(raster.open(), gdal::GDALError::None) << raster.errorMsg();
+
+    // Whether a point should pass, reading the raster for the point alone.
+    auto passes = [&raster](double x, double y, double z)
+    {
+        std::vector<double> data;
+        if (raster.read(x, y, data) != gdal::GDALError::None)
+            return false;
+        return z >= data[0] - 1 && z <= data[0] + 1;
+    };
+
+    Options readerOps;
+    readerOps.add("filename", pointFile);
+
+    Options filterOps;
+    filterOps.add("raster", rasterFile);
+    filterOps.add("limits", "Z[1:1]");
+
+    // The points expected to pass, in order.
+    std::vector<std::array<double, 3>> expected;
+    {
+        TextReader reader;
+        reader.setOptions(readerOps);
+
+        PointTable table;
+        reader.prepare(table);
+        PointViewSet viewSet = reader.execute(table);
+        PointViewPtr view = *viewSet.begin();
+        ASSERT_EQ(view->size(), 50u * 37u + 1000u);
+        for (PointId i = 0; i < view->size(); ++i)
+        {
+            using namespace Dimension;
+
+            double x = view->getFieldAs<double>(Id::X, i);
+            double y = view->getFieldAs<double>(Id::Y, i);
+            double z = view->getFieldAs<double>(Id::Z, i);
+            if (passes(x, y, z))
+                expected.push_back({ x, y, z });
+        }
+    }
+    // Every third cell center is at the height of its cell.
+    EXPECT_GE(expected.size(), 50u * 37u / 3);
+    EXPECT_LT(expected.size(), 50u * 37u);
+
+    auto check = [&expected](PointId i, double x, double y, double z)
+    {
+        EXPECT_LT(i, expected.size());
+        if (i >= expected.size())
+            return;
+        EXPECT_DOUBLE_EQ(x, expected[i][0]);
+        EXPECT_DOUBLE_EQ(y, expected[i][1]);
+        EXPECT_DOUBLE_EQ(z, expected[i][2]);
+    };
+
+    {
+        TextReader reader;
+        reader.setOptions(readerOps);
+
+        DEMFilter filter;
+        filter.setOptions(filterOps);
+        filter.setInput(reader);
+
+        PointTable table;
+        filter.prepare(table);
+        PointViewSet viewSet = filter.execute(table);
+        ASSERT_EQ(viewSet.size(), 1u);
+        PointViewPtr view = *viewSet.begin();
+        EXPECT_EQ(view->size(), expected.size());
+        for (PointId i = 0; i < view->size(); ++i)
+        {
+            using namespace Dimension;
+
+            check(i, view->getFieldAs<double>(Id::X, i),
+                view->getFieldAs<double>(Id::Y, i),
+                view->getFieldAs<double>(Id::Z, i));
+        }
+    }
+
+    {
+        TextReader reader;
+        reader.setOptions(readerOps);
+
+        DEMFilter filter;
+        filter.setOptions(filterOps);
+        filter.setInput(reader);
+
+        PointId i = 0;
+        StreamCallbackFilter c;
+        c.setCallback([&check, &i](PointRef& p)
+        {
+            using namespace Dimension;
+
+            check(i++, p.getFieldAs<double>(Id::X),
+                p.getFieldAs<double>(Id::Y), p.getFieldAs<double>(Id::Z));
+            return true;
+        });
+        c.setInput(filter);
+
+        FixedPointTable table(100);
+        c.prepare(table);
+        c.execute(table);
+        EXPECT_EQ(i, expected.size());
+    }
+}
@@ -36,11 +36,13 @@
 #include <pdal/pdal_test_main.hpp>
 
 #include <pdal/PointView.hpp>
+#include <io/FauxReader.hpp>
 #include <io/TextReader.hpp>
 #include <filters/DelaunayFilter.hpp>
 
 #include <vector>
 #include <algorithm> // for rotate_copy
+#include <array>
 
 #include "Support.hpp"
 
@@ -123,3 +125,63 @@ TEST(DelaunayFilterTest, test1)
     }
 }
 
+// Triangulating in tiles must produce the same triangles as triangulating
+// all the points at once.
+TEST(DelaunayFilterTest, tiles)
+{
+    auto triangles = [](double tileSize)
+    {
+        Options readerOps;
+        readerOps.add("bounds", BOX3D(0, 0, 0, 100, 100, 0));
+        readerOps.add("count", 5000);
+        readerOps.add("mode", "uniform");
+
+        FauxReader reader;
+        reader.setOptions(readerOps);
+
+        Options filterOps;
+        filterOps.add("tile_size", tileSize);
+
+        DelaunayFilter filter;
+        filter.setOptions(filterOps);
+        filter.setInput(reader);
+
+        PointTable table;
+        filter.prepare(table);
+        PointViewSet viewSet = filter.execute(table);
+        PointViewPtr view = *viewSet.begin();
+        TriangularMesh *mesh = view->mesh("delaunay2d");
+
+        // Rotate each triangle to start at its smallest vertex, keeping
+        // the winding.
+        std::vector<std::array<PointId, 3>> out;
+        for (size_t i = 0; i < mesh->size(); i++)
+        {
+            const Triangle& t = (*mesh)[i];
+            std::array<PointId, 3> v { { t.m_a, t.m_b, t.m_c } };
+            std::rotate(v.begin(), std::min_element(v.begin(), v.end()),
+                v.end());
+            out.push_back(v);
+        }
+        std::sort(out.begin(), out.end());
+        return out;
+    };
+
+    auto expected = triangles(0);
+    EXPECT_GT(expected.size(), 9000u);
+    EXPECT_EQ(expected, triangles(10));
+    EXPECT_EQ(expected, triangles(33));
+    EXPECT_EQ(expected, triangles(1000));
+}
+
+TEST(DelaunayFilterTest, badTileSize)
+{
+    Options ops;
+    ops.add("tile_size", -1);
+
+    DelaunayFilter filter;
+    filter.setOptions(ops);
+
+    PointTable table;
+    EXPECT_THROW(filter.prepare(table), pdal_error);
+}
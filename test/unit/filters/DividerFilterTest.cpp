@@ -34,6 +34,7 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <pdal/StageFactory.hpp>
 #include <io/FauxReader.hpp>
 #include <filters/DividerFilter.hpp>
 
@@ -206,3 +207,95 @@ TEST(DividerFilterTest, round_robin_capacity)
     }
 }
 
+
+namespace
+{
+
+// Divide a ramp into ten views, run them through a couple of filters and
+// optionally merge them.
+PointViewSet runBranches(int threads, bool merge)
+{
+    point_count_t count = 1000;
+
+    Options readerOps;
+    readerOps.add("bounds", BOX3D(1, 1, 1,
+        (double)count, (double)count, (double)count));
+    readerOps.add("mode", "ramp");
+    readerOps.add("count", count);
+
+    FauxReader r;
+    r.setOptions(readerOps);
+
+    Options filterOps;
+    filterOps.add("count", 10);
+    filterOps.add("threads", threads);
+    DividerFilter f;
+    f.setInput(r);
+    f.setOptions(filterOps);
+
+    StageFactory factory;
+    Stage *assign = factory.createStage("filters.assign");
+    Options assignOps;
+    assignOps.add("assignment", "Classification[:]=2");
+    assign->setOptions(assignOps);
+    assign->setInput(f);
+
+    Stage *decimate = factory.createStage("filters.decimation");
+    Options decimateOps;
+    decimateOps.add("step", 3);
+    decimate->setOptions(decimateOps);
+    decimate->setInput(*assign);
+
+    Stage *last = decimate;
+    if (merge)
+    {
+        last = factory.createStage("filters.merge");
+        last->setInput(*decimate);
+    }
+
+    PointTable t;
+    last->prepare(t);
+    return last->execute(t);
+}
+
+} // unnamed namespace
+
+// Running the views of the divider on several threads gives the same views,
+// in the same order, as running them in turn.
+TEST(DividerFilterTest, branches)
+{
+    PointViewSet serial = runBranches(0, false);
+    PointViewSet parallel = runBranches(4, false);
+
+    ASSERT_EQ(serial.size(), 10u);
+    ASSERT_EQ(parallel.size(), serial.size());
+    auto si = serial.begin();
+    for (PointViewPtr v : parallel)
+    {
+        PointViewPtr sv = *si++;
+        ASSERT_EQ(v->size(), sv->size());
+        for (PointId p = 0; p < v->size(); ++p)
+        {
+            EXPECT_DOUBLE_EQ(sv->getFieldAs<double>(Dimension::Id::X, p),
+                v->getFieldAs<double>(Dimension::Id::X, p));
+            EXPECT_EQ(2, v->getFieldAs<int>(Dimension::Id::Classification, p));
+        }
+    }
+}
+
+// filters.merge joins the branches.
+TEST(DividerFilterTest, branch_merge)
+{
+    PointViewSet serial = runBranches(0, true);
+    PointViewSet parallel = runBranches(4, true);
+
+    ASSERT_EQ(serial.size(), 1u);
+    ASSERT_EQ(parallel.size(), 1u);
+    PointViewPtr sv = *serial.begin();
+    PointViewPtr v = *parallel.begin();
+    ASSERT_EQ(v->size(), sv->size());
+    EXPECT_EQ(v->size(), 340u);
+    for (PointId p = 0; p < v->size(); ++p)
+        EXPECT_DOUBLE_EQ(sv->getFieldAs<double>(Dimension::Id::X, p),
+            v->getFieldAs<double>(Dimension::Id::X, p));
+}
@@ -0,0 +1,219 @@
+/******************************************************************************
+* Copyright (c) 2026, Hobu Inc. (hobu.inc@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <pdal/PointView.hpp>
+#include <pdal/StageFactory.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <io/FauxReader.hpp>
+#include <io/LasReader.hpp>
+#include <io/LasWriter.hpp>
+#include <filters/ELMFilter.hpp>
+#include <filters/StreamCallbackFilter.hpp>
+#include "Support.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+using namespace pdal;
+
+namespace
+{
+
+// Write random points between 0 and 100 in each direction to a LAS file.
+void makeInput(const std::string& filename)
+{
+    Options fo;
+    fo.add("bounds", BOX3D(0, 0, 0, 100, 100, 100));
+    fo.add("mode", "uniform");
+    fo.add("count", 2000);
+    FauxReader r;
+    r.setOptions(fo);
+
+    Options wo;
+    wo.add("filename", filename);
+    LasWriter w;
+    w.setOptions(wo);
+    w.setInput(r);
+
+    PointTable t;
+    w.prepare(t);
+    w.execute(t);
+}
+
+// Find the noise points one cell at a time, as in the paper.
+std::vector<bool> expectedNoise(PointView& view, double cell,
+    double threshold)
+{
+    using namespace Dimension;
+
+    BOX2D bounds;
+    view.calculateBounds(bounds);
+    size_t rows =
+        static_cast<size_t>(((bounds.maxy - bounds.miny) / cell) + 1);
+
+    std::map<size_t, std::multimap<double, PointId>> cells;
+    for (PointId id = 0; id < view.size(); ++id)
+    {
+        double x = view.getFieldAs<double>(Id::X, id);
+        double y = view.getFieldAs<double>(Id::Y, id);
+        double z = view.getFieldAs<double>(Id::Z, id);
+
+        size_t c = static_cast<size_t>(std::floor(x - bounds.minx) / cell);
+        size_t r = static_cast<size_t>(std::floor(y - bounds.miny) / cell);
+        cells[c * rows + r].emplace(z, id);
+    }
+
+    std::vector<bool> noise(view.size());
+    for (auto& p : cells)
+    {
+        std::multimap<double, PointId>& ids = p.second;
+        for (auto it = ids.begin(); it != std::prev(ids.end()); ++it)
+        {
+            if (std::fabs(it->first - std::next(it)->first) < threshold)
+                break;
+            noise[it->second] = true;
+        }
+    }
+    return noise;
+}
+
+// Classify the points of a file in standard mode.
+std::vector<int> classify(const std::string& filename)
+{
+    Options ro;
+    ro.add("filename", filename);
+    LasReader r;
+    r.setOptions(ro);
+
+    Options eo;
+    eo.add("class", 18);
+    ELMFilter f;
+    f.setOptions(eo);
+    f.setInput(r);
+
+    PointTable t;
+    f.prepare(t);
+    PointViewSet s = f.execute(t);
+    PointViewPtr v = *s.begin();
+
+    std::vector<int> classes;
+    for (PointId id = 0; id < v->size(); ++id)
+        classes.push_back(
+            v->getFieldAs<int>(Dimension::Id::Classification, id));
+
+    std::vector<bool> noise = expectedNoise(*v, 10.0, 1.0);
+    for (PointId id = 0; id < v->size(); ++id)
+        EXPECT_EQ(classes[id] == 18, noise[id]);
+    return classes;
+}
+
+// Classify the points of a file in stream mode using a statistics file.
+std::vector<int> classifyStream(const std::string& filename,
+    const std::string& stats)
+{
+    Options ro;
+    ro.add("filename", filename);
+    LasReader r;
+    r.setOptions(ro);
+
+    Options eo;
+    eo.add("class", 18);
+    eo.add("stats", stats);
+    ELMFilter f;
+    f.setOptions(eo);
+    f.setInput(r);
+
+    std::vector<int> classes;
+    StreamCallbackFilter c;
+    c.setCallback([&classes](PointRef& point)
+    {
+        classes.push_back(
+            point.getFieldAs<int>(Dimension::Id::Classification));
+        return true;
+    });
+    c.setInput(f);
+
+    FixedPointTable t(100);
+    c.prepare(t);
+    c.execute(t);
+    return classes;
+}
+
+} // unnamed namespace
+
+TEST(ELMFilterTest, create)
+{
+    StageFactory f;
+    Stage* filter(f.createStage("filters.elm"));
+    EXPECT_TRUE(filter);
+}
+
+// Cells are searched in bands on several threads.  The points found are
+// those found searching one cell at a time.
+TEST(ELMFilterTest, standard)
+{
+    std::string filename(Support::temppath("elm.las"));
+    FileUtils::deleteFile(filename);
+    makeInput(filename);
+
+    std::vector<int> classes = classify(filename);
+    EXPECT_EQ(classes.size(), 2000u);
+    EXPECT_GT(std::count(classes.begin(), classes.end(), 18), 0);
+    FileUtils::deleteFile(filename);
+}
+
+// In stream mode, the first run writes the statistics of the cells and the
+// second classifies the points as they would be in standard mode.
+TEST(ELMFilterTest, stream)
+{
+    std::string filename(Support::temppath("elm.las"));
+    std::string stats(Support::temppath("elm_stats.txt"));
+    FileUtils::deleteFile(filename);
+    FileUtils::deleteFile(stats);
+    makeInput(filename);
+
+    std::vector<int> classes = classifyStream(filename, stats);
+    EXPECT_TRUE(FileUtils::fileExists(stats));
+    EXPECT_EQ(classes.size(), 2000u);
+    EXPECT_EQ(std::count(classes.begin(), classes.end(), 18), 0);
+
+    EXPECT_EQ(classifyStream(filename, stats), classify(filename));
+
+    FileUtils::deleteFile(filename);
+    FileUtils::deleteFile(stats);
+}
@@ -0,0 +1,144 @@
+/******************************************************************************
+* Copyright (c) 2018, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <pdal/PointView.hpp>
+#include <io/BufferReader.hpp>
+#include <filters/GreedyProjection.hpp>
+
+#include <array>
+#include <cmath>
+#include <random>
+
+using namespace pdal;
+
+namespace
+{
+
+using Points = std::vector<std::array<double, 3>>;
+
+// Triangulate random points on a gently curved surface.  The output
+// points are returned in 'points'.
+std::vector<std::array<PointId, 3>> triangulate(double tileSize,
+    Points& points)
+{
+    PointTable table;
+    table.layout()->registerDims({ Dimension::Id::X, Dimension::Id::Y,
+        Dimension::Id::Z });
+
+    PointViewPtr input(new PointView(table));
+    std::mt19937 gen(1234);
+    std::uniform_real_distribution<double> dist(0, 100);
+    for (PointId i = 0; i < 5000; ++i)
+    {
+        double x = dist(gen);
+        double y = dist(gen);
+        input->setField(Dimension::Id::X, i, x);
+        input->setField(Dimension::Id::Y, i, y);
+        input->setField(Dimension::Id::Z, i, 5 * std::sin(x / 20));
+    }
+
+    BufferReader reader;
+    reader.addView(input);
+
+    Options filterOps;
+    filterOps.add("multiplier", 2.5);
+    filterOps.add("radius", 5);
+    filterOps.add("tile_size", tileSize);
+
+    GreedyProjection filter;
+    filter.setOptions(filterOps);
+    filter.setInput(reader);
+
+    filter.prepare(table);
+    PointViewSet viewSet = filter.execute(table);
+    PointViewPtr view = *viewSet.begin();
+    TriangularMesh *mesh = view->mesh("filters.greedyprojection");
+
+    points.clear();
+    for (PointId i = 0; i < view->size(); ++i)
+        points.push_back({ { view->getFieldAs<double>(Dimension::Id::X, i),
+            view->getFieldAs<double>(Dimension::Id::Y, i),
+            view->getFieldAs<double>(Dimension::Id::Z, i) } });
+
+    std::vector<std::array<PointId, 3>> out;
+    for (size_t i = 0; i < mesh->size(); i++)
+    {
+        const Triangle& t = (*mesh)[i];
+        out.push_back({ { t.m_a, t.m_b, t.m_c } });
+    }
+    return out;
+}
+
+} // unnamed namespace
+
+// Growing the mesh in tiles must give the same result on every run and
+// cover about as much of the surface as a single mesh.
+TEST(GreedyProjectionTest, tiles)
+{
+    Points points;
+    auto single = triangulate(0, points);
+    auto tiled = triangulate(20, points);
+    EXPECT_EQ(tiled, triangulate(20, points));
+
+    EXPECT_GT(single.size(), 3500u);
+    EXPECT_GT(tiled.size(), single.size() * 9 / 10);
+
+    // Edges may be a bit longer than the radius, but not much.
+    for (auto& t : tiled)
+        for (int i = 0; i < 3; ++i)
+        {
+            auto& a = points[t[i]];
+            auto& b = points[t[(i + 1) % 3]];
+            double dx = a[0] - b[0];
+            double dy = a[1] - b[1];
+            double dz = a[2] - b[2];
+            EXPECT_LT(std::sqrt(dx * dx + dy * dy + dz * dz), 7.5);
+        }
+}
+
+TEST(GreedyProjectionTest, badTileSize)
+{
+    Options ops;
+    ops.add("multiplier", 2.5);
+    ops.add("radius", 5);
+    ops.add("tile_size", -1);
+
+    GreedyProjection filter;
+    filter.setOptions(ops);
+
+    PointTable table;
+    EXPECT_THROW(filter.prepare(table), pdal_error);
+}
@@ -34,6 +34,7 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <pdal/util/FileUtils.hpp>
 #include <io/LasReader.hpp>
 #include <filters/GroupByFilter.hpp>
 #include "Support.hpp"
@@ -68,3 +69,67 @@ TEST(GroupByTest, basic_test)
     EXPECT_EQ(789u, views[0]->size());
     EXPECT_EQ(276u, views[1]->size());
 }
+
+// Write the groups directly in stream mode, with one open writer so that
+// groups are split across several files.
+TEST(GroupByTest, stream_writers)
+{
+    for (auto& f : FileUtils::glob(Support::temppath("groupby_*.las")))
+        FileUtils::deleteFile(f);
+
+    Options ro;
+    ro.add("filename", Support::datapath("las/1.2-with-color.las"));
+    LasReader r;
+    r.setOptions(ro);
+
+    Options fo;
+    fo.add("dimension", "Classification");
+    fo.add("filename", Support::temppath("groupby_#.las"));
+    fo.add("max_writers", 1);
+
+    GroupByFilter s;
+    s.setOptions(fo);
+    s.setInput(r);
+
+    FixedPointTable table(100);
+    s.prepare(table);
+    EXPECT_TRUE(s.pipelineStreamable());
+    s.execute(table);
+
+    StringList files = FileUtils::glob(Support::temppath("groupby_*.las"));
+    EXPECT_GT(files.size(), 2u);
+
+    std::map<uint8_t, point_count_t> counts;
+    for (auto& f : files)
+    {
+        Options o;
+        o.add("filename", f);
+        LasReader reader;
+        reader.setOptions(o);
+        PointTable t;
+        reader.prepare(t);
+        PointViewSet viewSet = reader.execute(t);
+        PointViewPtr v = *viewSet.begin();
+        uint8_t c = v->getFieldAs<uint8_t>(Dimension::Id::Classification, 0);
+        for (PointId idx = 0; idx < v->size(); ++idx)
+            EXPECT_EQ(c, v->getFieldAs<uint8_t>(
+                Dimension::Id::Classification, idx));
+        counts[c] += v->size();
+        FileUtils::deleteFile(f);
+    }
+    EXPECT_EQ(2u, counts.size());
+    EXPECT_EQ(789u, counts.begin()->second);
+    EXPECT_EQ(276u, counts.rbegin()->second);
+}
+
+TEST(GroupByTest, bad_template)
+{
+    Options o;
+    o.add("dimension", "Classification");
+    o.add("filename", "groupby.las");
+
+    GroupByFilter s;
+    s.setOptions(o);
+    PointTable table;
+    EXPECT_THROW(s.prepare(table), pdal_error);
+}
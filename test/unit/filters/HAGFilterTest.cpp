@@ -0,0 +1,172 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <pdal/GDALUtils.hpp>
+#include <pdal/PointView.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <filters/HAGFilter.hpp>
+#include <filters/StreamCallbackFilter.hpp>
+#include <io/TextReader.hpp>
+
+#include "Support.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+// Write a 10x10 raster of unit cells with its upper-left corner at (0, 10).
+// Each cell holds 100 + column, except the cell in row 3, column 4, which
+// has no data.
+std::string writeGround()
+{
+    const int size = 10;
+    std::string filename(Support::temppath("hag_ground.tif"));
+    FileUtils::deleteFile(filename);
+
+    gdal::registerDrivers();
+    gdal::Raster raster(filename, "GTiff", SpatialReference(),
+        { 0, 1, 0, size, 0, -1 });
+    gdal::GDALError err = raster.open(size, size, 1, Dimension::Type::Double,
+        -9999);
+    EXPECT_EQ(err, gdal::GDALError::None) << raster.errorMsg();
+
+    // Blocks are written whole, so leave room past the last cell.
+    std::vector<double> band(size * size * 2);
+    for (int row = 0; row < size; ++row)
+        for (int col = 0; col < size; ++col)
+            band[row * size + col] = 100 + col;
+    band[3 * size + 4] = -9999;
+    raster.writeBand(band.data(), -9999.0, 1);
+    raster.close();
+    return filename;
+}
+
+std::string writePoints()
+{
+    std::string filename(Support::temppath("hag_points.txt"));
+    std::ostream *out = FileUtils::createFile(filename);
+    *out << "X,Y,Z\n"
+        "0.5,9.5,150\n"     // Row 0, column 0
+        "4.5,6.5,120\n"     // Row 3, column 4: no data
+        "20,5,130\n"        // Outside of the raster
+        "9.5,0.5,115\n"     // Row 9, column 9
+        "2.5,5.5,110\n";    // Row 4, column 2
+    FileUtils::closeFile(out);
+    return filename;
+}
+
+// Heights of the points above, or zero where the ground isn't known.
+const std::vector<double> heights { 50, 0, 0, 6, 8 };
+
+} // unnamed namespace
+
+// Heights are taken from the raster in standard and stream mode.  Points
+// on a no-data cell or outside of the raster are passed on without a height
+// and counted in a warning.
+TEST(HAGFilterTest, raster)
+{
+    const std::string rasterFile = writeGround();
+    const std::string pointFile = writePoints();
+
+    Options readerOps;
+    readerOps.add("filename", pointFile);
+
+    Options filterOps;
+    filterOps.add("raster", rasterFile);
+
+    const std::string warning("filters.hag: 2 points were outside of the "
+        "raster or on no-data cells.");
+
+    {
+        std::ostringstream oss;
+        LogPtr log(new Log("", &oss));
+        log->setLevel(LogLevel::Warning);
+
+        TextReader reader;
+        reader.setOptions(readerOps);
+
+        HAGFilter filter;
+        filter.setOptions(filterOps);
+        filter.setInput(reader);
+        filter.setLog(log);
+
+        PointTable table;
+        filter.prepare(table);
+        PointViewSet viewSet = filter.execute(table);
+        ASSERT_EQ(viewSet.size(), 1u);
+        PointViewPtr view = *viewSet.begin();
+        ASSERT_EQ(view->size(), heights.size());
+        for (PointId i = 0; i < view->size(); ++i)
+            EXPECT_DOUBLE_EQ(view->getFieldAs<double>(
+                Dimension::Id::HeightAboveGround, i), heights[i]);
+        EXPECT_NE(oss.str().find(warning), std::string::npos) << oss.str();
+    }
+
+    {
+        std::ostringstream oss;
+        LogPtr log(new Log("", &oss));
+        log->setLevel(LogLevel::Warning);
+
+        TextReader reader;
+        reader.setOptions(readerOps);
+
+        HAGFilter filter;
+        filter.setOptions(filterOps);
+        filter.setInput(reader);
+        filter.setLog(log);
+        EXPECT_TRUE(filter.pipelineStreamable());
+
+        size_t i = 0;
+        StreamCallbackFilter c;
+        c.setCallback([&i](PointRef& p)
+        {
+            EXPECT_LT(i, heights.size());
+            if (i < heights.size())
+                EXPECT_DOUBLE_EQ(p.getFieldAs<double>(
+                    Dimension::Id::HeightAboveGround), heights[i]);
+            i++;
+            return true;
+        });
+        c.setInput(filter);
+
+        FixedPointTable table(2);
+        c.prepare(table);
+        c.execute(table);
+        EXPECT_EQ(i, heights.size());
+        EXPECT_NE(oss.str().find(warning), std::string::npos) << oss.str();
+    }
+}
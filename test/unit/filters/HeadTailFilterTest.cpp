@@ -36,6 +36,7 @@
 
 #include <pdal/StageFactory.hpp>
 #include <io/FauxReader.hpp>
+#include <filters/StreamCallbackFilter.hpp>
 #include <filters/HeadFilter.hpp>
 #include <filters/TailFilter.hpp>
 
@@ -94,3 +95,45 @@ TEST(HeadTailFilterTest, t1)
     testFilter(false, false);
 }
 
+// In stream mode, the reader stops once the head filter has its points.
+TEST(HeadTailFilterTest, stream)
+{
+    auto run = [](int threads, point_count_t& read)
+    {
+        Options ro;
+        ro.add("bounds", BOX3D(0, 0, 0, 0, 0, 999));
+        ro.add("mode", "ramp");
+        ro.add("count", 1000);
+        FauxReader reader;
+        reader.setOptions(ro);
+
+        Options ho;
+        ho.add("count", 25);
+        HeadFilter head;
+        head.setOptions(ho);
+        head.setInput(reader);
+
+        StreamCallbackFilter f;
+        int cnt = 0;
+        f.setCallback([&cnt](PointRef& point)
+        {
+            EXPECT_EQ(point.getFieldAs<int>(Dimension::Id::Z), cnt++);
+            return true;
+        });
+        f.setInput(head);
+
+        FixedPointTable t(10);
+        f.prepare(t);
+        f.execute(t, threads);
+        read = reader.profile().pointsOut();
+        return cnt;
+    };
+
+    point_count_t read;
+    EXPECT_EQ(run(1, read), 25);
+    EXPECT_EQ(read, 30u);
+
+    // The reader may have filled every buffer before it found out.
+    EXPECT_EQ(run(3, read), 25);
+    EXPECT_LE(read, 70u);
+}
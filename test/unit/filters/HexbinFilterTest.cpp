@@ -94,3 +94,50 @@ TEST(HexbinFilterTest, HexbinFilterTest_test_1)
     out.close();
     FileUtils::deleteFile(filename);
 }
+
+// Points binned in parallel in standard mode must give the same boundary
+// as points binned one at a time in stream mode, with or without sampling.
+TEST(HexbinFilterTest, streamMatchesStandard)
+{
+    auto boundary = [](bool stream, point_count_t exactCount)
+    {
+        StageFactory f;
+
+        Options options;
+        options.add("filename", Support::datapath("las/hextest.las"));
+
+        Stage* reader(f.createStage("readers.las"));
+        reader->setOptions(options);
+
+        Options hexOptions;
+        hexOptions.add("edge_length", 0.666666666);
+        hexOptions.add("threshold", 1);
+        hexOptions.add("exact_count", exactCount);
+
+        Stage* hexbin(f.createStage("filters.hexbin"));
+        hexbin->setOptions(hexOptions);
+        hexbin->setInput(*reader);
+
+        MetadataNode m;
+        if (stream)
+        {
+            FixedPointTable table(100);
+            hexbin->prepare(table);
+            hexbin->execute(table);
+            m = table.metadata();
+        }
+        else
+        {
+            PointTable table;
+            hexbin->prepare(table);
+            hexbin->execute(table);
+            m = table.metadata();
+        }
+        return m.findChild(hexbin->getName()).findChild("boundary").value();
+    };
+
+    std::string full = boundary(false, 0);
+    EXPECT_NE(full, "MULTIPOLYGON EMPTY");
+    EXPECT_EQ(full, boundary(true, 0));
+    EXPECT_EQ(boundary(false, 200), boundary(true, 200));
+}
@@ -0,0 +1,118 @@
+/******************************************************************************
+* Copyright (c) 2018, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <pdal/PointView.hpp>
+#include <io/BufferReader.hpp>
+#include <filters/IQRFilter.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace pdal;
+
+namespace
+{
+
+// Run filters.iqr on Z values and check the kept points against fences
+// found by sorting every value.
+void checkIqr(point_count_t count, double spread)
+{
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::Z);
+
+    PointViewPtr input(new PointView(table));
+    std::mt19937 gen(4321);
+    std::normal_distribution<double> dist(100, 10);
+    std::vector<double> sorted(count);
+    for (PointId i = 0; i < count; ++i)
+    {
+        // Rounding makes many repeated values.
+        double z = std::round(dist(gen) * spread) / spread;
+        input->setField(Dimension::Id::Z, i, z);
+        sorted[i] = z;
+    }
+    std::sort(sorted.begin(), sorted.end());
+
+    double pc25 = sorted[point_count_t(count * 0.25)];
+    double pc75 = sorted[point_count_t(count * 0.75)];
+    double iqr = pc75 - pc25;
+    double low = pc25 - 1.5 * iqr;
+    double high = pc75 + 1.5 * iqr;
+
+    BufferReader reader;
+    reader.addView(input);
+
+    Options opts;
+    opts.add("dimension", "Z");
+    IQRFilter filter;
+    filter.setOptions(opts);
+    filter.setInput(reader);
+    filter.prepare(table);
+    PointViewSet viewSet = filter.execute(table);
+    ASSERT_EQ(viewSet.size(), 1u);
+    PointViewPtr output = *viewSet.begin();
+
+    point_count_t expected = 0;
+    for (PointId i = 0; i < count; ++i)
+    {
+        double z = input->getFieldAs<double>(Dimension::Id::Z, i);
+        if (z > low && z < high)
+            expected++;
+    }
+    EXPECT_EQ(output->size(), expected);
+    EXPECT_LT(output->size(), count);
+    for (PointId i = 0; i < output->size(); ++i)
+    {
+        double z = output->getFieldAs<double>(Dimension::Id::Z, i);
+        EXPECT_GT(z, low);
+        EXPECT_LT(z, high);
+    }
+}
+
+} // unnamed namespace
+
+TEST(IQRFilterTest, small)
+{
+    checkIqr(1000, 100);
+}
+
+// Enough points that the quartiles are found by counting passes rather
+// than by gathering every value.
+TEST(IQRFilterTest, large)
+{
+    checkIqr(3000000, 1000);
+}
@@ -0,0 +1,116 @@
+/******************************************************************************
+* Copyright (c) 2018, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <pdal/PointView.hpp>
+#include <io/BufferReader.hpp>
+#include <filters/MADFilter.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace pdal;
+
+namespace
+{
+
+// Run filters.mad on Z values and check the kept points against a median
+// and MAD found by sorting every value.
+void checkMad(point_count_t count, double spread)
+{
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::Z);
+
+    PointViewPtr input(new PointView(table));
+    std::mt19937 gen(8765);
+    std::normal_distribution<double> dist(-20, 5);
+    std::vector<double> sorted(count);
+    for (PointId i = 0; i < count; ++i)
+    {
+        // Rounding makes many repeated values.
+        double z = std::round(dist(gen) * spread) / spread;
+        input->setField(Dimension::Id::Z, i, z);
+        sorted[i] = z;
+    }
+    std::sort(sorted.begin(), sorted.end());
+    double median = sorted[count / 2];
+    for (double& z : sorted)
+        z = std::fabs(z - median);
+    std::sort(sorted.begin(), sorted.end());
+    double mad = sorted[count / 2] * 1.4862;
+
+    BufferReader reader;
+    reader.addView(input);
+
+    Options opts;
+    opts.add("dimension", "Z");
+    MADFilter filter;
+    filter.setOptions(opts);
+    filter.setInput(reader);
+    filter.prepare(table);
+    PointViewSet viewSet = filter.execute(table);
+    ASSERT_EQ(viewSet.size(), 1u);
+    PointViewPtr output = *viewSet.begin();
+
+    point_count_t expected = 0;
+    for (PointId i = 0; i < count; ++i)
+    {
+        double z = input->getFieldAs<double>(Dimension::Id::Z, i);
+        if (std::fabs(z - median) / mad < 2.0)
+            expected++;
+    }
+    EXPECT_EQ(output->size(), expected);
+    EXPECT_LT(output->size(), count);
+    for (PointId i = 0; i < output->size(); ++i)
+    {
+        double z = output->getFieldAs<double>(Dimension::Id::Z, i);
+        EXPECT_LT(std::fabs(z - median) / mad, 2.0);
+    }
+}
+
+} // unnamed namespace
+
+TEST(MADFilterTest, small)
+{
+    checkMad(1001, 100);
+}
+
+// Enough points that the median and MAD are found by counting passes
+// rather than by gathering every value.
+TEST(MADFilterTest, large)
+{
+    checkMad(3000000, 1000);
+}
@@ -35,6 +35,8 @@
 #include <pdal/pdal_test_main.hpp>
 
 #include <pdal/PipelineManager.hpp>
+#include <io/FauxReader.hpp>
+#include <filters/MergeFilter.hpp>
 
 #include "Support.hpp"
 
@@ -94,3 +96,33 @@ TEST(MergeTest, test6)
     PointViewPtr view = *viewSet.begin();
     EXPECT_EQ(2130u, view->size());
 }
+
+TEST(MergeTest, order)
+{
+    using namespace pdal;
+
+    PointTable table;
+    MergeFilter merge;
+    std::vector<std::unique_ptr<FauxReader>> readers;
+    for (int i = 0; i < 3; ++i)
+    {
+        Options ro;
+        ro.add("bounds", BOX3D(i * 100, 0, 0, i * 100 + 9, 9, 9));
+        ro.add("mode", "ramp");
+        ro.add("count", 10);
+        readers.emplace_back(new FauxReader);
+        readers.back()->setOptions(ro);
+        merge.setInput(*readers.back());
+    }
+
+    merge.prepare(table);
+    PointViewSet viewSet = merge.execute(table);
+
+    // The points of each input follow those of the input before it.
+    EXPECT_EQ(1u, viewSet.size());
+    PointViewPtr view = *viewSet.begin();
+    EXPECT_EQ(30u, view->size());
+    for (PointId i = 0; i < view->size(); ++i)
+        EXPECT_EQ(view->getFieldAs<int>(Dimension::Id::X, i),
+            (int)((i / 10) * 100 + i % 10));
+}
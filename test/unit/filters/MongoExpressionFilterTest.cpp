@@ -42,6 +42,7 @@
 
 #include <pdal/PointView.hpp>
 #include <pdal/StageFactory.hpp>
+#include <io/BufferReader.hpp>
 #include <filters/MongoExpressionFilter.hpp>
 
 using namespace pdal;
@@ -700,3 +701,59 @@ TEST(MongoExpressionFilterTest, logicalOperators)
     }
 }
 
+// The compiled expression used to filter whole views must agree with the
+// point-by-point evaluation.
+TEST(MongoExpressionFilterTest, compiled)
+{
+    const std::vector<std::string> expressions
+    {
+        R"({ "X": { "$gt": 2, "$lt": 5 } })",
+        R"({ "$or": [ { "X": 0 }, { "Y": { "$gte": 9 } } ] })",
+        R"({ "$nor": [ { "X": { "$in": [1, 3] } }, { "Z": "Y" } ] })",
+        R"({ "$not": { "Y": { "$nin": [2, 4, 6] } } })",
+        R"({ "$and": [ { "X": { "$ne": "Z" } }, { "$or": [
+            { "Z": { "$lte": 3 } }, { "Y": { "$in": [] } } ] } ] })",
+        R"({ "X": { "$nin": [] } })"
+    };
+
+    PointTable table;
+    table.layout()->registerDims(dims);
+    PointViewPtr view(new PointView(table));
+    for (PointId i = 0; i < 10000; ++i)
+    {
+        view->setField(D::X, i, i % 7);
+        view->setField(D::Y, i, i % 11);
+        view->setField(D::Z, i, i % 13);
+    }
+
+    for (const std::string& expression : expressions)
+    {
+        Options o;
+        o.add("expression", expression);
+
+        BufferReader r;
+        r.addView(view);
+
+        MongoExpressionFilter f;
+        f.setOptions(o);
+        f.setInput(r);
+        f.prepare(table);
+        PointViewSet s = f.execute(table);
+        EXPECT_EQ(s.size(), 1u);
+        PointViewPtr out = *s.begin();
+
+        PointId next = 0;
+        for (PointId i = 0; i < view->size(); ++i)
+        {
+            PointRef pr(view->point(i));
+            if (!f.processOne(pr))
+                continue;
+            ASSERT_LT(next, out->size()) << expression;
+            EXPECT_EQ(out->getFieldAs<int>(D::X, next), (int)(i % 7));
+            EXPECT_EQ(out->getFieldAs<int>(D::Y, next), (int)(i % 11));
+            EXPECT_EQ(out->getFieldAs<int>(D::Z, next), (int)(i % 13));
+            next++;
+        }
+        EXPECT_EQ(next, out->size()) << expression;
+    }
+}
@@ -113,3 +113,123 @@ TEST(MortonOrderTest, test_code)
     EXPECT_EQ(outView->getFieldAs<double>(Dimension::Id::X, 5), 3);
     EXPECT_EQ(outView->getFieldAs<double>(Dimension::Id::Y, 5), 2);
 }
+
+namespace
+{
+
+PointViewPtr makeGrid(PointTableRef table, int size)
+{
+    table.layout()->registerDim(Dimension::Id::X);
+    table.layout()->registerDim(Dimension::Id::Y);
+
+    PointViewPtr view(new PointView(table));
+    PointId n = 0;
+    for (int i = size - 1; i >= 0; i--)
+        for (int j = 0; j < size; j++)
+        {
+            view->setField(Dimension::Id::X, n, i);
+            view->setField(Dimension::Id::Y, n, j);
+            n++;
+        }
+    return view;
+}
+
+PointViewPtr runFilter(PointTableRef table, PointViewPtr view,
+    const Options& opts)
+{
+    BufferReader r;
+    r.addView(view);
+
+    MortonOrderFilter filter;
+    filter.setInput(r);
+    filter.setOptions(opts);
+    filter.prepare(table);
+    PointViewSet s = filter.execute(table);
+    EXPECT_EQ(s.size(), 1u);
+    return *s.begin();
+}
+
+} // unnamed namespace
+
+TEST(MortonOrderTest, morton)
+{
+    PointTable table;
+    PointViewPtr view = makeGrid(table, 4);
+    PointViewPtr outView = runFilter(table, view, Options());
+
+    // Z-order with X as the more significant coordinate.
+    int expected[][2] = { {0, 0}, {0, 1}, {1, 0}, {1, 1},
+        {0, 2}, {0, 3}, {1, 2}, {1, 3} };
+    for (PointId i = 0; i < 8; ++i)
+    {
+        EXPECT_EQ(outView->getFieldAs<int>(Dimension::Id::X, i),
+            expected[i][0]);
+        EXPECT_EQ(outView->getFieldAs<int>(Dimension::Id::Y, i),
+            expected[i][1]);
+    }
+}
+
+TEST(MortonOrderTest, hilbert)
+{
+    PointTable table;
+    PointViewPtr view = makeGrid(table, 16);
+
+    Options o;
+    o.add("curve", "hilbert");
+    PointViewPtr outView = runFilter(table, view, o);
+    ASSERT_EQ(outView->size(), 256u);
+
+    // Each point along a Hilbert curve is next to the one before it.
+    EXPECT_EQ(outView->getFieldAs<int>(Dimension::Id::X, 0), 0);
+    EXPECT_EQ(outView->getFieldAs<int>(Dimension::Id::Y, 0), 0);
+    for (PointId i = 1; i < outView->size(); ++i)
+    {
+        int dx = outView->getFieldAs<int>(Dimension::Id::X, i) -
+            outView->getFieldAs<int>(Dimension::Id::X, i - 1);
+        int dy = outView->getFieldAs<int>(Dimension::Id::Y, i) -
+            outView->getFieldAs<int>(Dimension::Id::Y, i - 1);
+        EXPECT_EQ(std::abs(dx) + std::abs(dy), 1);
+    }
+}
+
+TEST(MortonOrderTest, reorderOnly)
+{
+    PointTable table;
+    PointViewPtr view = makeGrid(table, 8);
+
+    Options o;
+    o.add("curve", "hilbert");
+    PointViewPtr copied = runFilter(table, view, o);
+
+    o.add("reorder_only", true);
+    PointViewPtr reordered = runFilter(table, view, o);
+    EXPECT_EQ(reordered.get(), view.get());
+    ASSERT_EQ(reordered->size(), copied->size());
+    for (PointId i = 0; i < copied->size(); ++i)
+    {
+        EXPECT_EQ(reordered->getFieldAs<int>(Dimension::Id::X, i),
+            copied->getFieldAs<int>(Dimension::Id::X, i));
+        EXPECT_EQ(reordered->getFieldAs<int>(Dimension::Id::Y, i),
+            copied->getFieldAs<int>(Dimension::Id::Y, i));
+    }
+}
+
+TEST(MortonOrderTest, badOptions)
+{
+    Options o;
+    o.add("curve", "peano");
+
+    MortonOrderFilter filter;
+    filter.setOptions(o);
+    PointTable table;
+    EXPECT_THROW(filter.prepare(table), pdal_error);
+
+    Options o2;
+    o2.add("curve", "hilbert");
+    o2.add("reverse", true);
+
+    MortonOrderFilter filter2;
+    filter2.setOptions(o2);
+    PointTable table2;
+    EXPECT_THROW(filter2.prepare(table2), pdal_error);
+}
@@ -220,4 +220,61 @@ TEST(NeighborClassifierFilterTest, candidate)
     }
 }
 
+namespace
+{
+
+std::vector<int> classifyCandidate(bool divide, bool morton)
+{
+    StageFactory factory;
+
+    Options ro;
+    ro.add("filename", Support::datapath("las/sample_nc.las"));
+    Stage& r = *(factory.createStage("readers.las"));
+    r.setOptions(ro);
+
+    Stage *last = &r;
+    if (divide)
+    {
+        Options dOpts;
+        dOpts.add("count", 4);
+        last = factory.createStage("filters.divider");
+        last->setOptions(dOpts);
+        last->setInput(r);
+    }
+
+    Options fo;
+    fo.add("candidate", Support::datapath("las/sample_c_thin.las"));
+    fo.add("k", 3);
+    fo.add("morton", morton);
+    Stage& f = *(factory.createStage("filters.neighborclassifier"));
+    f.setInput(*last);
+    f.setOptions(fo);
+
+    PointTable table;
+    f.prepare(table);
+    PointViewSet viewSet = f.execute(table);
+
+    std::vector<int> classes;
+    for (PointViewPtr v : viewSet)
+        for (PointId id = 0; id < v->size(); ++id)
+            classes.push_back(
+                v->getFieldAs<int>(Dimension::Id::Classification, id));
+    return classes;
+}
+
+} // unnamed namespace
+
+// The candidate index is shared by all views and the query order doesn't
+// change the result.
+TEST(NeighborClassifierFilterTest, morton)
+{
+    std::vector<int> base = classifyCandidate(false, false);
+    std::vector<int> divided = classifyCandidate(true, true);
+    std::vector<int> ordered = classifyCandidate(false, true);
+
+    EXPECT_GT(base.size(), 0u);
+    EXPECT_EQ(base, divided);
+    EXPECT_EQ(base, ordered);
+}
+
 } // namespace pdal
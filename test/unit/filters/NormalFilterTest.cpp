@@ -0,0 +1,89 @@
+/******************************************************************************
+* Copyright (c) 2015, Hobu Inc. (hobu@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <io/LasReader.hpp>
+#include <filters/NormalFilter.hpp>
+#include "Support.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+PointViewPtr normals(PointTableRef table, bool floatNormals)
+{
+    Options ro;
+    ro.add("filename", Support::datapath("las/1.2-with-color.las"));
+    LasReader r;
+    r.setOptions(ro);
+
+    Options fo;
+    fo.add("float_normals", floatNormals);
+    NormalFilter f;
+    f.setInput(r);
+    f.setOptions(fo);
+
+    f.prepare(table);
+    PointViewSet s = f.execute(table);
+    return *s.begin();
+}
+
+} // unnamed namespace
+
+TEST(NormalFilterTest, floatNormals)
+{
+    using namespace Dimension;
+
+    PointTable dTable;
+    PointViewPtr dView = normals(dTable, false);
+    PointTable fTable;
+    PointViewPtr fView = normals(fTable, true);
+
+    const Id dims[] = { Id::NormalX, Id::NormalY, Id::NormalZ,
+        Id::Curvature };
+    for (Id id : dims)
+    {
+        EXPECT_EQ(dTable.layout()->dimType(id), Type::Double);
+        EXPECT_EQ(fTable.layout()->dimType(id), Type::Float);
+    }
+
+    ASSERT_EQ(dView->size(), fView->size());
+    ASSERT_GT(dView->size(), 0u);
+    for (PointId i = 0; i < dView->size(); ++i)
+        for (Id id : dims)
+            EXPECT_NEAR(dView->getFieldAs<double>(id, i),
+                fView->getFieldAs<double>(id, i), 1e-6);
+}
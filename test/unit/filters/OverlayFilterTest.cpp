@@ -34,8 +34,12 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <random>
+
 #include <pdal/StageFactory.hpp>
 #include <pdal/util/FileUtils.hpp>
+#include <filters/StreamCallbackFilter.hpp>
+#include <filters/private/RTree.hpp>
 
 #include "Support.hpp"
 
@@ -162,3 +166,207 @@ TEST(OverlayFilterTest, stream)
 {
     testOverlay(10, true);
 }
+
+// Overlay each point in stream mode and check that it gets the same value
+// as in standard mode.
+TEST(OverlayFilterTest, streamMatchesStandard)
+{
+    Options ro;
+    ro.add("filename", Support::datapath("autzen/autzen-dd.las"));
+
+    Options fo;
+    fo.add("dimension", "Classification");
+    fo.add("column", "cls");
+    fo.add("datasource", Support::datapath("autzen/attributes.shp"));
+
+    StageFactory factory;
+
+    Stage& r1 = *(factory.createStage("readers.las"));
+    r1.setOptions(ro);
+    Stage& f1 = *(factory.createStage("filters.overlay"));
+    f1.setOptions(fo);
+    f1.setInput(r1);
+
+    PointTable table;
+    f1.prepare(table);
+    PointViewSet s = f1.execute(table);
+    ASSERT_EQ(s.size(), 1u);
+    PointViewPtr v = *s.begin();
+    ASSERT_GT(v->size(), 0u);
+
+    Stage& r2 = *(factory.createStage("readers.las"));
+    r2.setOptions(ro);
+    Stage& f2 = *(factory.createStage("filters.overlay"));
+    f2.setOptions(fo);
+    f2.setInput(r2);
+
+    PointId idx = 0;
+    point_count_t overlaid = 0;
+    StreamCallbackFilter c;
+    c.setCallback([&idx, &overlaid, v](PointRef& p)
+    {
+        using namespace Dimension;
+
+        EXPECT_LT(idx, v->size());
+        if (idx >= v->size())
+            return true;
+        EXPECT_DOUBLE_EQ(p.getFieldAs<double>(Id::X),
+            v->getFieldAs<double>(Id::X, idx));
+        EXPECT_DOUBLE_EQ(p.getFieldAs<double>(Id::Y),
+            v->getFieldAs<double>(Id::Y, idx));
+        int cls = p.getFieldAs<int>(Id::Classification);
+        EXPECT_EQ(cls, v->getFieldAs<int>(Id::Classification, idx));
+        if (cls != 0)
+            overlaid++;
+        idx++;
+        return true;
+    });
+    c.setInput(f2);
+
+    FixedPointTable t(100);
+    c.prepare(t);
+    c.execute(t);
+    EXPECT_EQ(idx, v->size());
+    // Some points must fall in the polygons for the test to mean anything.
+    EXPECT_GT(overlaid, 0u);
+}
+
+namespace
+{
+
+// IDs of the boxes containing a point, found by checking every box.
+std::vector<size_t> bruteFind(const std::vector<BOX2D>& boxes,
+    double x, double y)
+{
+    std::vector<size_t> ids;
+    for (size_t i = 0; i < boxes.size(); ++i)
+        if (!boxes[i].empty() && boxes[i].contains(x, y))
+            ids.push_back(i);
+    return ids;
+}
+
+} // unnamed namespace
+
+TEST(RTreeTest, hits)
+{
+    std::mt19937 gen(1234);
+    std::uniform_real_distribution<double> pos(0, 100);
+    std::uniform_real_distribution<double> len(0, 10);
+
+    for (size_t count : { 1, 2, 17, 1000 })
+    {
+        std::vector<BOX2D> boxes;
+        for (size_t i = 0; i < count; ++i)
+        {
+            double x = pos(gen);
+            double y = pos(gen);
+            boxes.emplace_back(x, y, x + len(gen), y + len(gen));
+        }
+
+        for (size_t nodeSize : { 2, 3, 16 })
+        {
+            RTree tree(boxes, nodeSize);
+            std::vector<size_t> ids;
+            for (size_t i = 0; i < 2000; ++i)
+            {
+                double x = pos(gen);
+                double y = pos(gen);
+                tree.find(x, y, ids);
+                EXPECT_EQ(ids, bruteFind(boxes, x, y));
+            }
+
+            // The center of each box is found.
+            for (size_t i = 0; i < boxes.size(); ++i)
+            {
+                double x = (boxes[i].minx + boxes[i].maxx) / 2;
+                double y = (boxes[i].miny + boxes[i].maxy) / 2;
+                tree.find(x, y, ids);
+                EXPECT_TRUE(std::binary_search(ids.begin(), ids.end(), i));
+                EXPECT_EQ(ids, bruteFind(boxes, x, y));
+            }
+        }
+    }
+}
+
+TEST(RTreeTest, misses)
+{
+    std::vector<size_t> ids { 7 };
+
+    // An empty tree finds nothing.
+    RTree none({});
+    none.find(0, 0, ids);
+    EXPECT_TRUE(ids.empty());
+
+    // Empty boxes are never found but keep the IDs of the others.
+    std::vector<BOX2D> boxes;
+    for (int i = 0; i < 10; ++i)
+        boxes.emplace_back(i * 10, 0, i * 10 + 5, 5);
+    boxes.insert(boxes.begin() + 3, BOX2D());
+    RTree tree(boxes, 2);
+
+    // Points in the gaps between boxes, and outside all of them.
+    for (int i = 0; i < 10; ++i)
+    {
+        tree.find(i * 10 + 7.5, 2.5, ids);
+        EXPECT_TRUE(ids.empty());
+    }
+    for (double y : { -1.0, 6.0, 1e10, -1e10 })
+    {
+        tree.find(2.5, y, ids);
+        EXPECT_TRUE(ids.empty());
+    }
+    tree.find(-0.001, 2.5, ids);
+    EXPECT_TRUE(ids.empty());
+    tree.find(95.001, 2.5, ids);
+    EXPECT_TRUE(ids.empty());
+
+    tree.find(32.5, 2.5, ids);
+    EXPECT_EQ(ids, std::vector<size_t>{ 4 });
+}
+
+TEST(RTreeTest, boundary)
+{
+    // A 4x4 grid of unit boxes that share edges and corners.
+    std::vector<BOX2D> boxes;
+    for (int j = 0; j < 4; ++j)
+        for (int i = 0; i < 4; ++i)
+            boxes.emplace_back(i, j, i + 1, j + 1);
+
+    for (size_t nodeSize : { 2, 4, 16 })
+    {
+        RTree tree(boxes, nodeSize);
+        std::vector<size_t> ids;
+
+        // Boxes contain their edges.
+        tree.find(0, 0, ids);
+        EXPECT_EQ(ids, std::vector<size_t>{ 0 });
+        tree.find(4, 4, ids);
+        EXPECT_EQ(ids, std::vector<size_t>{ 15 });
+        tree.find(0.5, 0, ids);
+        EXPECT_EQ(ids, std::vector<size_t>{ 0 });
+
+        // A shared edge is in both boxes, a shared corner in all four.
+        tree.find(1, 0.5, ids);
+        EXPECT_EQ(ids, (std::vector<size_t>{ 0, 1 }));
+        tree.find(1, 1, ids);
+        EXPECT_EQ(ids, (std::vector<size_t>{ 0, 1, 4, 5 }));
+        tree.find(2, 3, ids);
+        EXPECT_EQ(ids, (std::vector<size_t>{ 9, 10, 13, 14 }));
+
+        // Just outside the grid.
+        tree.find(4.000001, 2, ids);
+        EXPECT_TRUE(ids.empty());
+        tree.find(2, -0.000001, ids);
+        EXPECT_TRUE(ids.empty());
+
+        // Degenerate boxes are points and lines.
+        std::vector<BOX2D> thin { BOX2D(1, 1, 1, 1), BOX2D(0, 2, 5, 2) };
+        RTree thinTree(thin, nodeSize);
+        thinTree.find(1, 1, ids);
+        EXPECT_EQ(ids, std::vector<size_t>{ 0 });
+        thinTree.find(3, 2, ids);
+        EXPECT_EQ(ids, std::vector<size_t>{ 1 });
+        thinTree.find(3, 2.000001, ids);
+        EXPECT_TRUE(ids.empty());
+    }
+}
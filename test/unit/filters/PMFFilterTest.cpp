@@ -34,6 +34,10 @@
 
 #include <pdal/pdal_test_main.hpp>
 #include <filters/PMFFilter.hpp>
+#include <io/BufferReader.hpp>
+
+#include <algorithm>
+#include <cmath>
 
 using namespace pdal;
 
@@ -60,3 +64,80 @@ TEST(PMFFilterTest, validReturns)
     PointTable table;
     EXPECT_NO_THROW(filter.prepare(table));
 }
+
+namespace
+{
+
+// Classify a grid of points over a rolling surface with some raised blocks,
+// returning the classification of each point.
+std::vector<int> classifyGrid(const Options& opts)
+{
+    using namespace Dimension;
+
+    PointTable table;
+    table.layout()->registerDims({Id::X, Id::Y, Id::Z});
+
+    BufferReader reader;
+    PMFFilter filter;
+    filter.setOptions(opts);
+    filter.setInput(reader);
+    filter.prepare(table);
+
+    const int size = 150;
+    PointViewPtr view(new PointView(table));
+    for (int i = 0; i < size; ++i)
+        for (int j = 0; j < size; ++j)
+        {
+            double x = i * .9 + .3;
+            double y = j * .9 + .1;
+            double z = 10 * std::sin(x / 40) + 5 * std::cos(y / 25);
+            if ((i / 20) % 3 == 1 && (j / 15) % 3 == 1)
+                z += 8;
+            PointId id = view->size();
+            view->setField(Id::X, id, x);
+            view->setField(Id::Y, id, y);
+            view->setField(Id::Z, id, z);
+        }
+    reader.addView(view);
+
+    PointViewSet s = filter.execute(table);
+    PointViewPtr out = *s.begin();
+    std::vector<int> classes;
+    for (PointId idx = 0; idx < out->size(); ++idx)
+        classes.push_back(out->getFieldAs<int>(Id::Classification, idx));
+    return classes;
+}
+
+} // unnamed namespace
+
+// Classifying tiles with buffers should give almost the same result as
+// classifying all the points at once.
+TEST(PMFFilterTest, tiled)
+{
+    std::vector<int> full = classifyGrid(Options());
+
+    Options opts;
+    opts.add("tile", 40.0);
+    std::vector<int> tiled = classifyGrid(opts);
+
+    ASSERT_EQ(full.size(), tiled.size());
+    size_t diff = 0;
+    for (size_t i = 0; i < full.size(); ++i)
+        if (full[i] != tiled[i])
+            diff++;
+    EXPECT_LE(diff, full.size() / 1000);
+    EXPECT_GT(std::count(full.begin(), full.end(), 1), 0);
+    EXPECT_GT(std::count(full.begin(), full.end(), 2), 0);
+}
+
+TEST(PMFFilterTest, invalidTile)
+{
+    Options opts;
+    opts.add("tile", -1.0);
+
+    PMFFilter filter;
+    filter.setOptions(opts);
+
+    PointTable table;
+    EXPECT_THROW(filter.prepare(table), pdal_error);
+}
@@ -41,6 +41,7 @@
 #include <io/TextReader.hpp>
 #include <filters/RangeFilter.hpp>
 #include <filters/StreamCallbackFilter.hpp>
+#include <filters/private/DimRange.hpp>
 
 #include "Support.hpp"
 
@@ -454,3 +455,36 @@ TEST(RangeFilterTest, nan)
     EXPECT_EQ(0u, view->size());
 }
 
+// The compiled block test must agree with DimRange::valuePasses() for
+// values on and next to the bounds, infinities and NaN.
+TEST(RangeFilterTest, compiled_ranges)
+{
+    const double inf = std::numeric_limits<double>::infinity();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+
+    std::vector<double> values { nan, inf, -inf, 0, 1, 2, 5,
+        std::nextafter(1.0, 0.0), std::nextafter(1.0, 2.0),
+        std::nextafter(5.0, 0.0), std::nextafter(5.0, 6.0),
+        (std::numeric_limits<double>::max)(),
+        std::numeric_limits<double>::lowest() };
+
+    for (std::string spec : { "X[1:5]", "X(1:5)", "X[1:5)", "X(1:5]",
+        "X![1:5]", "X!(1:5)", "X[1:]", "X(:5)", "X[:]", "X![:]",
+        "X[1:1]", "X(1:1)" })
+    {
+        DimRange r;
+        r.parse(spec);
+        std::vector<char> passes(values.size());
+        r.valuesPass(values.data(), values.size(), passes.data());
+        for (size_t i = 0; i < values.size(); ++i)
+            EXPECT_EQ(r.valuePasses(values[i]), (bool)passes[i]) <<
+                spec << " " << values[i];
+    }
+
+    DimRange r1;
+    r1.parse("X[inf:inf]");
+    std::vector<char> passes(values.size());
+    r1.valuesPass(values.data(), values.size(), passes.data());
+    for (size_t i = 0; i < values.size(); ++i)
+        EXPECT_EQ(r1.valuePasses(values[i]), (bool)passes[i]) << values[i];
+}
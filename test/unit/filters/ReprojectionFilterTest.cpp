@@ -36,6 +36,7 @@
 
 #include <pdal/SpatialReference.hpp>
 #include <pdal/PointView.hpp>
+#include <io/BufferReader.hpp>
 #include <io/LasReader.hpp>
 #include <filters/ReprojectionFilter.hpp>
 #include <filters/StreamCallbackFilter.hpp>
@@ -227,3 +228,88 @@ TEST(ReprojectionFilterTest, stream_test_2)
     f.prepare(table3);
     f.execute(table3);
 }
+
+
+// A view large enough to be transformed by several threads should get the
+// same result as a stream, which is transformed a few points at a time.
+TEST(ReprojectionFilterTest, parallel)
+{
+    using namespace Dimension;
+
+    const point_count_t numPoints = 50000;
+
+    PointTable table;
+    table.layout()->registerDims({Id::X, Id::Y, Id::Z});
+    PointViewPtr view(new PointView(table));
+    for (PointId i = 0; i < numPoints; ++i)
+    {
+        view->setField(Id::X, i, 400000.0 + (i % 1000) * 10.0);
+        view->setField(Id::Y, i, 4600000.0 + (i / 1000) * 10.0);
+        view->setField(Id::Z, i, (double)(i % 100));
+    }
+
+    BufferReader reader;
+    reader.addView(view);
+
+    Options opts;
+    opts.add("in_srs", "EPSG:32615");
+    opts.add("out_srs", "EPSG:4326");
+
+    ReprojectionFilter repro;
+    repro.setInput(reader);
+    repro.setOptions(opts);
+    repro.prepare(table);
+    PointViewSet s = repro.execute(table);
+    ASSERT_EQ(s.size(), 1u);
+    PointViewPtr out = *s.begin();
+    ASSERT_EQ(out->size(), numPoints);
+
+    class StreamReader : public Reader, public Streamable
+    {
+    public:
+        std::string getName() const
+            { return "readers.stream"; }
+
+    private:
+        PointId m_next;
+
+        virtual void ready(PointTableRef)
+            { m_next = 0; }
+        virtual bool processOne(PointRef& point)
+        {
+            if (m_next == numPoints)
+                return false;
+            point.setField(Id::X, 400000.0 + (m_next % 1000) * 10.0);
+            point.setField(Id::Y, 4600000.0 + (m_next / 1000) * 10.0);
+            point.setField(Id::Z, (double)(m_next % 100));
+            m_next++;
+            return true;
+        }
+    };
+
+    StreamReader streamReader;
+    ReprojectionFilter streamRepro;
+    streamRepro.setInput(streamReader);
+    streamRepro.setOptions(opts);
+
+    PointId i = 0;
+    StreamCallbackFilter f;
+    f.setInput(streamRepro);
+    f.setCallback([&out, &i](PointRef& point)
+    {
+        EXPECT_DOUBLE_EQ(out->getFieldAs<double>(Id::X, i),
+            point.getFieldAs<double>(Id::X));
+        EXPECT_DOUBLE_EQ(out->getFieldAs<double>(Id::Y, i),
+            point.getFieldAs<double>(Id::Y));
+        EXPECT_DOUBLE_EQ(out->getFieldAs<double>(Id::Z, i),
+            point.getFieldAs<double>(Id::Z));
+        i++;
+        return true;
+    });
+
+    FixedPointTable streamTable(100);
+    streamTable.layout()->registerDims({Id::X, Id::Y, Id::Z});
+    f.prepare(streamTable);
+    f.execute(streamTable);
+    EXPECT_EQ(i, numPoints);
+}
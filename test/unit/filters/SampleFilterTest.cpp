@@ -0,0 +1,162 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <pdal/KDIndex.hpp>
+#include <pdal/StageFactory.hpp>
+#include <filters/StreamCallbackFilter.hpp>
+
+#include "Support.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+// Check that no two sampled points are within the radius and that every
+// input point is within the radius of a sampled point.
+void checkSample(PointView& in, PointView& out, double radius)
+{
+    ASSERT_GT(out.size(), 0U);
+    EXPECT_LT(out.size(), in.size());
+
+    const double r2 = radius * radius;
+    KD3Index& index = out.build3dIndex();
+    std::vector<PointId> ids(2);
+    std::vector<double> dists(2);
+    for (PointId i = 0; i < out.size(); ++i)
+    {
+        index.knnSearch(i, 2, &ids, &dists);
+        EXPECT_GE(dists[1], r2);
+    }
+
+    for (PointId i = 0; i < in.size(); ++i)
+    {
+        double x = in.getFieldAs<double>(Dimension::Id::X, i);
+        double y = in.getFieldAs<double>(Dimension::Id::Y, i);
+        double z = in.getFieldAs<double>(Dimension::Id::Z, i);
+        index.knnSearch(x, y, z, 1, &ids, &dists);
+        EXPECT_LT(dists[0], r2);
+    }
+}
+
+PointViewPtr readAll(PointTableRef table)
+{
+    StageFactory f;
+    Stage *r = f.createStage("readers.las");
+    Options ro;
+    ro.add("filename", Support::datapath("las/autzen_trim.las"));
+    r->setOptions(ro);
+    r->prepare(table);
+    PointViewSet s = r->execute(table);
+    return *s.begin();
+}
+
+} // unnamed namespace
+
+TEST(SampleFilterTest, standard)
+{
+    PointTable inTable;
+    PointViewPtr in = readAll(inTable);
+
+    StageFactory f;
+    Stage *r = f.createStage("readers.las");
+    Options ro;
+    ro.add("filename", Support::datapath("las/autzen_trim.las"));
+    r->setOptions(ro);
+
+    Stage *s = f.createStage("filters.sample");
+    Options so;
+    so.add("radius", 10);
+    s->setOptions(so);
+    s->setInput(*r);
+
+    PointTable t;
+    s->prepare(t);
+    PointViewSet set = s->execute(t);
+    ASSERT_EQ(set.size(), 1U);
+    PointViewPtr out = *set.begin();
+    checkSample(*in, *out, 10);
+}
+
+TEST(SampleFilterTest, stream)
+{
+    PointTable inTable;
+    PointViewPtr in = readAll(inTable);
+    PointViewPtr out = in->makeNew();
+
+    StageFactory f;
+    Stage *r = f.createStage("readers.las");
+    Options ro;
+    ro.add("filename", Support::datapath("las/autzen_trim.las"));
+    r->setOptions(ro);
+
+    Stage *s = f.createStage("filters.sample");
+    Options so;
+    so.add("radius", 10);
+    s->setOptions(so);
+    s->setInput(*r);
+
+    StreamCallbackFilter c;
+    c.setCallback([&out](PointRef& point)
+    {
+        PointId id = out->size();
+        out->setField(Dimension::Id::X, id,
+            point.getFieldAs<double>(Dimension::Id::X));
+        out->setField(Dimension::Id::Y, id,
+            point.getFieldAs<double>(Dimension::Id::Y));
+        out->setField(Dimension::Id::Z, id,
+            point.getFieldAs<double>(Dimension::Id::Z));
+        return true;
+    });
+    c.setInput(*s);
+
+    FixedPointTable t(1000);
+    c.prepare(t);
+    c.execute(t);
+    checkSample(*in, *out, 10);
+}
+
+TEST(SampleFilterTest, badRadius)
+{
+    StageFactory f;
+    Stage *s = f.createStage("filters.sample");
+    Options so;
+    so.add("radius", 0);
+    s->setOptions(so);
+
+    PointTable t;
+    EXPECT_THROW(s->prepare(t), pdal_error);
+}
@@ -169,3 +169,94 @@ TEST(SortFilterTest, issue1121_simpleSortOrderDesc)
     }
 }
 
+
+TEST(SortFilterTest, multipleKeys)
+{
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::PointSourceId);
+    table.layout()->registerDim(Dimension::Id::GpsTime);
+    table.layout()->registerDim(Dimension::Id::Z);
+    PointViewPtr view(new PointView(table));
+
+    std::default_random_engine generator;
+    std::uniform_int_distribution<int> ids(0, 9);
+    std::uniform_real_distribution<double> times(-1000, 1000);
+    for (PointId i = 0; i < 200000; ++i)
+    {
+        view->setField(Dimension::Id::PointSourceId, i, ids(generator));
+        view->setField(Dimension::Id::GpsTime, i, (int)times(generator));
+        view->setField(Dimension::Id::Z, i, i);
+    }
+
+    for (std::string order : { "ASC", "DESC" })
+    {
+        Options opts;
+        opts.add("dimension", "PointSourceId, GpsTime");
+        opts.add("order", order);
+
+        SortFilter filter;
+        filter.setOptions(opts);
+        filter.prepare(table);
+        FilterWrapper::ready(filter, table);
+        FilterWrapper::filter(filter, *view);
+        FilterWrapper::done(filter, table);
+
+        ASSERT_EQ(view->size(), 200000u);
+        for (PointId i = 1; i < view->size(); ++i)
+        {
+            auto key = [&view, &order](PointId idx)
+            {
+                int id = view->getFieldAs<int>(Dimension::Id::PointSourceId,
+                    idx);
+                double t = view->getFieldAs<double>(Dimension::Id::GpsTime,
+                    idx);
+                return order == "ASC" ? std::make_pair(id, t) :
+                    std::make_pair(-id, -t);
+            };
+            ASSERT_TRUE(key(i - 1) <= key(i));
+
+            // The sort is stable, so the original order of equal points is
+            // kept along with the order of the previous sort.
+            if (key(i - 1) == key(i) && order == "ASC")
+                EXPECT_LT(view->getFieldAs<double>(Dimension::Id::Z, i - 1),
+                    view->getFieldAs<double>(Dimension::Id::Z, i));
+        }
+    }
+}
+
+TEST(SortFilterTest, types)
+{
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::X);
+    table.layout()->registerDim(Dimension::Id::ScanAngleRank);
+    Dimension::Id s16 = table.layout()->registerOrAssignDim("Signed16",
+        Dimension::Type::Signed16);
+    PointViewPtr view(new PointView(table));
+
+    std::vector<double> vals { 3.5, -0.0, -2, 1e30, -1e-30, 0, -1e30, 7,
+        -3.25, 1e-30, -7 };
+    for (PointId i = 0; i < vals.size(); ++i)
+    {
+        view->setField(Dimension::Id::X, i, vals[i]);
+        view->setField(Dimension::Id::ScanAngleRank, i, vals[i]);
+        view->setField(s16, i, (int)(vals[i] * 1000) % 30000);
+    }
+
+    for (std::string dim : { "X", "ScanAngleRank", "Signed16" })
+    {
+        Options opts;
+        opts.add("dimension", dim);
+
+        SortFilter filter;
+        filter.setOptions(opts);
+        filter.prepare(table);
+        FilterWrapper::ready(filter, table);
+        FilterWrapper::filter(filter, *view);
+        FilterWrapper::done(filter, table);
+
+        Dimension::Id id = table.layout()->findDim(dim);
+        for (PointId i = 1; i < view->size(); ++i)
+            EXPECT_LE(view->getFieldAs<double>(id, i - 1),
+                view->getFieldAs<double>(id, i)) << dim;
+    }
+}
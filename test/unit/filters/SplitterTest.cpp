@@ -35,6 +35,7 @@
 #include <pdal/pdal_test_main.hpp>
 
 #include <pdal/StageFactory.hpp>
+#include <pdal/util/FileUtils.hpp>
 #include <io/LasReader.hpp>
 #include <io/FauxReader.hpp>
 #include <filters/SplitterFilter.hpp>
@@ -210,3 +211,66 @@ TEST(SplitterTest, test_buffer2)
         EXPECT_EQ(v->size(), counts[i++]);
 }
 
+// Write the tiles directly in stream mode, with few enough open writers that
+// some tiles are split across several files.
+TEST(SplitterTest, stream_writers)
+{
+    for (auto& f : FileUtils::glob(Support::temppath("splitter_*.las")))
+        FileUtils::deleteFile(f);
+
+    Options readerOptions;
+    readerOptions.add("filename", Support::datapath("las/1.2-with-color.las"));
+    LasReader reader;
+    reader.setOptions(readerOptions);
+
+    Options splitterOptions;
+    splitterOptions.add("length", 1000);
+    splitterOptions.add("origin_x", 635000);
+    splitterOptions.add("origin_y", 848000);
+    splitterOptions.add("filename", Support::temppath("splitter_#.las"));
+    splitterOptions.add("max_writers", 2);
+
+    SplitterFilter splitter;
+    splitter.setOptions(splitterOptions);
+    splitter.setInput(reader);
+
+    FixedPointTable table(100);
+    splitter.prepare(table);
+    EXPECT_TRUE(splitter.pipelineStreamable());
+    splitter.execute(table);
+
+    StringList files = FileUtils::glob(Support::temppath("splitter_*.las"));
+    EXPECT_GT(files.size(), 1u);
+    EXPECT_TRUE(FileUtils::fileExists(Support::temppath("splitter_0_0.las")));
+
+    point_count_t total = 0;
+    for (auto& f : files)
+    {
+        Options o;
+        o.add("filename", f);
+        LasReader r;
+        r.setOptions(o);
+        PointTable t;
+        r.prepare(t);
+        PointViewSet s = r.execute(t);
+        PointViewPtr v = *s.begin();
+        BOX2D b;
+        v->calculateBounds(b);
+        EXPECT_LE(b.maxx - b.minx, 1000);
+        EXPECT_LE(b.maxy - b.miny, 1000);
+        total += v->size();
+        FileUtils::deleteFile(f);
+    }
+    EXPECT_EQ(total, 1065u);
+}
+
+TEST(SplitterTest, bad_template)
+{
+    Options o;
+    o.add("filename", "splitter.las");
+
+    SplitterFilter splitter;
+    splitter.setOptions(o);
+    PointTable table;
+    EXPECT_THROW(splitter.prepare(table), pdal_error);
+}
@@ -34,9 +34,12 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <random>
+
 #include <pdal/PDALUtils.hpp>
 #include <pdal/StageFactory.hpp>
 #include <filters/StatsFilter.hpp>
+#include <io/BufferReader.hpp>
 #include <io/FauxReader.hpp>
 
 #include "Support.hpp"
@@ -85,9 +88,10 @@ TEST(Stats, simple)
     EXPECT_DOUBLE_EQ(statsY.average(), 52.0);
     EXPECT_DOUBLE_EQ(statsZ.average(), 53.0);
 
-    EXPECT_NEAR(statsX.variance(), 837.09351, .00001);
-    EXPECT_NEAR(statsY.variance(), 837.0965, .0001);
-    EXPECT_NEAR(statsZ.variance(), 837.1015, .0001);
+    // Sample variance of 1000 evenly spaced values over a range of 100.
+    EXPECT_NEAR(statsX.variance(), 835.83751, .00001);
+    EXPECT_NEAR(statsY.variance(), 835.83751, .00001);
+    EXPECT_NEAR(statsZ.variance(), 835.83751, .00001);
 
     EXPECT_DOUBLE_EQ(statsX.skewness(), 0.0);
     EXPECT_DOUBLE_EQ(statsY.skewness(), 0.0);
@@ -132,13 +136,15 @@ TEST(Stats, advanced)
     EXPECT_EQ(statsY.count(), 1000u);
     EXPECT_EQ(statsZ.count(), 1000u);
 
-    EXPECT_NEAR(statsX.skewness(), 7.6279972e+11, 10000);
-    EXPECT_NEAR(statsY.skewness(), 6.1023649e+12, 100000);
-    EXPECT_NEAR(statsZ.skewness(), 2.0595297e+13, 1000000);
+    // Evenly spaced values are symmetric, with an excess kurtosis of
+    // -6(n^2 + 1) / 5(n^2 - 1).
+    EXPECT_NEAR(statsX.skewness(), 0, 1e-12);
+    EXPECT_NEAR(statsY.skewness(), 0, 1e-12);
+    EXPECT_NEAR(statsZ.skewness(), 0, 1e-12);
 
-    EXPECT_NEAR(statsX.kurtosis(), -527558696e+4, 10000);
-    EXPECT_NEAR(statsY.kurtosis(), -422043928e+5, 100000);
-    EXPECT_NEAR(statsZ.kurtosis(), -142438122e+6, 1000000);
+    EXPECT_NEAR(statsX.kurtosis(), -1.2000024, 1e-7);
+    EXPECT_NEAR(statsY.kurtosis(), -1.2000024, 1e-7);
+    EXPECT_NEAR(statsZ.kurtosis(), -1.2000024, 1e-7);
 }
 
 
@@ -359,3 +365,229 @@ TEST(Stats, global)
 	EXPECT_DOUBLE_EQ(statsZ.maximum(), 1000.0);
 
 }
+
+namespace
+{
+
+PointViewPtr makeNormal(PointTableRef table, point_count_t count)
+{
+    table.layout()->registerDim(Dimension::Id::Z);
+    PointViewPtr view(new PointView(table));
+
+    std::mt19937 gen(1234);
+    std::normal_distribution<double> dist(100, 15);
+    for (PointId i = 0; i < count; ++i)
+        view->setField(Dimension::Id::Z, i, dist(gen));
+    return view;
+}
+
+stats::Summary globalStats(PointTableRef table, PointViewPtr view,
+    bool approximate)
+{
+    BufferReader reader;
+    reader.addView(view);
+
+    Options opts;
+    opts.add("dimensions", "Z");
+    opts.add("global", "Z");
+    opts.add("approximate", approximate);
+
+    StatsFilter filter;
+    filter.setInput(reader);
+    filter.setOptions(opts);
+    filter.prepare(table);
+    filter.execute(table);
+
+    // Global stats are computed when the filter is done.
+    return filter.getStats(Dimension::Id::Z);
+}
+
+} // unnamed namespace
+
+TEST(Stats, approximate)
+{
+    PointTable table;
+    PointViewPtr view = makeNormal(table, 200000);
+
+    stats::Summary exact = globalStats(table, view, false);
+    stats::Summary approx = globalStats(table, view, true);
+    EXPECT_NEAR(exact.median(), 100, .2);
+    EXPECT_NEAR(exact.mad(), 15 * 0.6745, .2);
+    EXPECT_NEAR(approx.median(), exact.median(), .05);
+    EXPECT_NEAR(approx.mad(), exact.mad(), .05);
+    EXPECT_EQ(approx.count(), exact.count());
+    EXPECT_DOUBLE_EQ(approx.average(), exact.average());
+}
+
+TEST(Stats, tdigest)
+{
+    stats::TDigest digest(100);
+    for (int i = 0; i < 100000; ++i)
+        digest.insert(i);
+    EXPECT_EQ(digest.count(), 100000u);
+    EXPECT_DOUBLE_EQ(digest.quantile(0), 0);
+    EXPECT_DOUBLE_EQ(digest.quantile(1), 99999);
+    for (double q : { .001, .01, .25, .5, .75, .99, .999 })
+    {
+        // Error in rank is smallest toward the ends.
+        double err = 100000 * (.001 + .02 * q * (1 - q));
+        EXPECT_NEAR(digest.quantile(q), q * 100000, err) << q;
+        EXPECT_NEAR(digest.cdf(q * 100000), q, err / 100000) << q;
+    }
+
+    // Merging digests of parts of the values gives about the same
+    // quantiles as a digest of all of them.
+    stats::TDigest even;
+    stats::TDigest odd;
+    for (int i = 0; i < 100000; ++i)
+        (i % 2 ? odd : even).insert(i);
+    even.merge(odd);
+    EXPECT_EQ(even.count(), 100000u);
+    for (double q : { .01, .5, .99 })
+        EXPECT_NEAR(even.quantile(q), q * 100000,
+            100000 * (.001 + .02 * q * (1 - q))) << q;
+}
+
+TEST(Stats, merge)
+{
+    std::mt19937 gen(42);
+    std::gamma_distribution<double> dist(2, 3);
+
+    stats::Summary all("Z", stats::Summary::Global);
+    stats::Summary part1("Z", stats::Summary::Global);
+    stats::Summary part2("Z", stats::Summary::Global);
+    for (int i = 0; i < 10001; ++i)
+    {
+        double v = dist(gen);
+        all.insert(v);
+        (i < 3000 ? part1 : part2).insert(v);
+    }
+    stats::Summary merged = part1.emptyCopy();
+    merged.merge(part1);
+    merged.merge(part2);
+
+    EXPECT_EQ(merged.count(), all.count());
+    EXPECT_DOUBLE_EQ(merged.minimum(), all.minimum());
+    EXPECT_DOUBLE_EQ(merged.maximum(), all.maximum());
+    EXPECT_NEAR(merged.average(), all.average(), 1e-12);
+    EXPECT_NEAR(merged.variance(), all.variance(), 1e-9);
+    EXPECT_NEAR(merged.skewness(), all.skewness(), 1e-9);
+    EXPECT_NEAR(merged.kurtosis(), all.kurtosis(), 1e-9);
+
+    merged.computeGlobalStats();
+    all.computeGlobalStats();
+    EXPECT_DOUBLE_EQ(merged.median(), all.median());
+    EXPECT_DOUBLE_EQ(merged.mad(), all.mad());
+}
+
+// Values of small integer dimensions are counted in an array and others
+// in a map.  Either way, the counts should come out ordered by value and
+// merge.
+TEST(Stats, enumCounts)
+{
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> dist(-200, 200);
+
+    for (Dimension::Type type : { Dimension::Type::Signed8,
+        Dimension::Type::Unsigned16, Dimension::Type::Double })
+    {
+        stats::Summary part1("C", stats::Summary::Count, false, false, 100,
+            type);
+        stats::Summary part2 = part1.emptyCopy();
+        std::map<double, point_count_t> expected;
+        for (int i = 0; i < 5000; ++i)
+        {
+            double v = dist(gen);
+            if (i % 100 == 0)
+                v += .5;
+            (i % 2 ? part1 : part2).insert(v);
+            expected[v]++;
+        }
+        stats::Summary merged = part1.emptyCopy();
+        merged.merge(part1);
+        merged.merge(part2);
+
+        const stats::Summary::EnumMap& values = merged.values();
+        ASSERT_EQ(values.size(), expected.size());
+        EXPECT_TRUE(std::equal(values.begin(), values.end(),
+            expected.begin()));
+    }
+}
+
+// Views of more than a million points are summarized in parts.
+TEST(Stats, parts)
+{
+    PointTable table;
+    PointViewPtr view = makeNormal(table, 2500000);
+
+    stats::Summary all("Z", stats::Summary::NoEnum, false);
+    for (PointId i = 0; i < view->size(); ++i)
+        all.insert(view->getFieldAs<double>(Dimension::Id::Z, i));
+
+    BufferReader reader;
+    reader.addView(view);
+    Options opts;
+    opts.add("dimensions", "Z");
+    StatsFilter filter;
+    filter.setInput(reader);
+    filter.setOptions(opts);
+    filter.prepare(table);
+    filter.execute(table);
+
+    const stats::Summary& s = filter.getStats(Dimension::Id::Z);
+    EXPECT_EQ(s.count(), all.count());
+    EXPECT_DOUBLE_EQ(s.minimum(), all.minimum());
+    EXPECT_DOUBLE_EQ(s.maximum(), all.maximum());
+    EXPECT_NEAR(s.average(), all.average(), 1e-9);
+    EXPECT_NEAR(s.stddev(), all.stddev(), 1e-9);
+}
+
+namespace
+{
+
+MetadataNode runStats(PointTableRef table, PointViewPtr view)
+{
+    BufferReader reader;
+    reader.addView(view);
+    Options opts;
+    opts.add("dimensions", "Z");
+    StatsFilter filter;
+    filter.setInput(reader);
+    filter.setOptions(opts);
+    filter.prepare(table);
+    filter.execute(table);
+    return filter.getMetadata().clone("filters.stats");
+}
+
+} // unnamed namespace
+
+// The metadata of runs on parts of the points merges into the metadata of a
+// run on all of them.
+TEST(Stats, mergeMetadata)
+{
+    PointTable table;
+    PointViewPtr view = makeNormal(table, 1000);
+    PointViewPtr part1 = view->makeNew();
+    PointViewPtr part2 = view->makeNew();
+    for (PointId i = 0; i < view->size(); ++i)
+        (i < 300 ? part1 : part2)->appendPoint(*view, i);
+
+    MetadataNode all = runStats(table, view);
+    StatsFilter filter;
+    MetadataNode merged = filter.mergeMetadata(runStats(table, part1),
+        runStats(table, part2));
+    ASSERT_TRUE(merged.valid());
+
+    MetadataNode a = all.findChild("statistic");
+    MetadataNode m = merged.findChild("statistic");
+    EXPECT_EQ(m.findChild("name").value(), "Z");
+    EXPECT_EQ(m.findChild("count").value<uint32_t>(), 1000u);
+    EXPECT_DOUBLE_EQ(m.findChild("minimum").value<double>(),
+        a.findChild("minimum").value<double>());
+    EXPECT_DOUBLE_EQ(m.findChild("maximum").value<double>(),
+        a.findChild("maximum").value<double>());
+    EXPECT_NEAR(m.findChild("average").value<double>(),
+        a.findChild("average").value<double>(), 1e-9);
+    EXPECT_NEAR(m.findChild("variance").value<double>(),
+        a.findChild("variance").value<double>(), 1e-6);
+}
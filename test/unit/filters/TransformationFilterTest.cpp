@@ -170,4 +170,48 @@ TEST_F(TransformationFilterTest, Rotation)
 }
 
 
+TEST(TransformationFilterTest, Affine)
+{
+    // Use a point count that isn't a multiple of any packed width so the
+    // remainder loop is exercised too.
+    const point_count_t count = 4103;
+
+    Options readerOpts;
+    readerOpts.add("mode", "ramp");
+    readerOpts.add("count", count);
+    readerOpts.add("bounds", BOX3D(-10, 5, 100, 30, 55, 300));
+    FauxReader reader;
+    reader.setOptions(readerOpts);
+
+    Options filterOpts;
+    filterOpts.add("matrix",
+        "0.5 -0.25 2 1\n1.5 0.75 -1 -2\n0.1 3 0.2 10\n0 0 0 1");
+    TransformationFilter filter;
+    filter.setOptions(filterOpts);
+    filter.setInput(reader);
+
+    PointTable inTable;
+    reader.prepare(inTable);
+    PointViewPtr in = *reader.execute(inTable).begin();
+
+    PointTable table;
+    filter.prepare(table);
+    PointViewPtr view = *filter.execute(table).begin();
+    ASSERT_EQ(count, view->size());
+
+    for (PointId i = 0; i < count; ++i)
+    {
+        double x = in->getFieldAs<double>(Dimension::Id::X, i);
+        double y = in->getFieldAs<double>(Dimension::Id::Y, i);
+        double z = in->getFieldAs<double>(Dimension::Id::Z, i);
+
+        EXPECT_DOUBLE_EQ(0.5 * x - 0.25 * y + 2 * z + 1,
+            view->getFieldAs<double>(Dimension::Id::X, i));
+        EXPECT_DOUBLE_EQ(1.5 * x + 0.75 * y - z - 2,
+            view->getFieldAs<double>(Dimension::Id::Y, i));
+        EXPECT_DOUBLE_EQ(0.1 * x + 3 * y + 0.2 * z + 10,
+            view->getFieldAs<double>(Dimension::Id::Z, i));
+    }
+}
+
 }
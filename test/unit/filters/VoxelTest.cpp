@@ -117,4 +117,38 @@ TEST(VoxelTest, center_value)
     }
 }
 
+TEST(VoxelTest, centroid_value)
+{
+    StageFactory fac;
+
+    Stage *reader = fac.createStage("readers.faux");
+    Options ro;
+    ro.add("bounds", "([0, 9], [0, 9], [0,0])");
+    ro.add("count", 10);
+    ro.add("mode", "ramp");
+    reader->setOptions(ro);
+
+    Stage *filter = fac.createStage("filters.voxelcentroidnearestneighbor");
+    Options fo;
+    fo.add("cell", 3);
+    filter->setOptions(fo);
+    filter->setInput(*reader);
+
+    PointTable t;
+    filter->prepare(t);
+    PointViewSet set = filter->execute(t);
+    EXPECT_EQ(set.size(), 1U);
+    PointViewPtr v = *set.begin();
+
+    // Voxels hold the points {0, 1, 2}, {3, 4, 5}, {6, 7, 8} and {9}.
+    double expected[] = { 1, 4, 7, 9 };
+    EXPECT_EQ(v->size(), 4U);
+    for (PointId i = 0; i < v->size(); ++i)
+    {
+        EXPECT_EQ(v->getFieldAs<double>(Dimension::Id::X, i), expected[i]);
+        EXPECT_EQ(v->getFieldAs<double>(Dimension::Id::Y, i), expected[i]);
+        EXPECT_EQ(v->getFieldAs<double>(Dimension::Id::Z, i), 0.0);
+    }
+}
+
 } // namespace
@@ -87,3 +87,17 @@ TEST(BpfTestZlib, roundtrip_point_compression)
     test_roundtrip(ops);
 }
 
+
+TEST(BpfTestZlib, roundtrip_threads)
+{
+    for (std::string format : { "POINT", "DIMENSION", "BYTE" })
+        for (int threads : { 1, 4 })
+        {
+            Options ops;
+
+            ops.add("format", format);
+            ops.add("compression", true);
+            ops.add("threads", threads);
+            test_roundtrip(ops);
+        }
+}
@@ -38,7 +38,9 @@
 
 #include <io/EptReader.hpp>
 #include <io/LasReader.hpp>
+#include <io/private/EptCache.hpp>
 #include <filters/CropFilter.hpp>
+#include <filters/StreamCallbackFilter.hpp>
 #include "Support.hpp"
 
 using namespace pdal;
@@ -107,6 +109,48 @@ TEST(EptReaderTest, fullRead)
     EXPECT_EQ(np, expNumPoints);
 }
 
+// In stream mode, nodes are fetched ahead of the points being passed on
+// but the points arrive in the same order as in standard mode.
+TEST(EptReaderTest, stream)
+{
+    Options options;
+    options.add("filename", "ept://" + Support::datapath("ept/ept-star"));
+    options.add("bounds", "([515380, 515400], [4918350, 4918370])");
+
+    PointTable table;
+    EptReader reader;
+    reader.setOptions(options);
+    reader.prepare(table);
+    PointViewSet s = reader.execute(table);
+    ASSERT_EQ(s.size(), 1u);
+    PointViewPtr view = *s.begin();
+    ASSERT_GT(view->size(), 0u);
+
+    EptReader streamReader;
+    streamReader.setOptions(options);
+
+    PointId idx(0);
+    StreamCallbackFilter f;
+    f.setInput(streamReader);
+    f.setCallback([&view, &idx](PointRef& point)
+    {
+        EXPECT_LT(idx, view->size());
+        EXPECT_EQ(point.getFieldAs<double>(Dimension::Id::X),
+            view->getFieldAs<double>(Dimension::Id::X, idx));
+        EXPECT_EQ(point.getFieldAs<double>(Dimension::Id::GpsTime),
+            view->getFieldAs<double>(Dimension::Id::GpsTime, idx));
+        EXPECT_EQ(point.getFieldAs<int>(Dimension::Id::OriginId),
+            view->getFieldAs<int>(Dimension::Id::OriginId, idx));
+        ++idx;
+        return true;
+    });
+
+    FixedPointTable fixed(1000);
+    f.prepare(fixed);
+    f.execute(fixed);
+    EXPECT_EQ(idx, view->size());
+}
+
 TEST(EptReaderTest, resolutionLimit)
 {
     Options options;
@@ -329,3 +373,36 @@ TEST(EptReaderTest, badOriginQuery)
     EXPECT_THROW(reader.prepare(table), pdal_error);
 }
 
+TEST(EptReaderTest, cache)
+{
+    const std::string dir(Support::temppath("eptcache"));
+    FileUtils::deleteDirectory(dir);
+
+    const std::vector<char> data(100, 'x');
+    {
+        // Room for two files.
+        EptCache cache(dir, "http://example.com/ept", 250);
+        EXPECT_TRUE(cache.find("ept-data/0-0-0-0.laz").empty());
+
+        const std::string a(cache.insert("ept-data/0-0-0-0.laz", data));
+        EXPECT_EQ(FileUtils::fileSize(a), 100u);
+        EXPECT_EQ(cache.find("ept-data/0-0-0-0.laz"), a);
+        cache.insert("ept-data/1-0-0-0.laz", data);
+
+        // The first file was used more recently, so the second is removed.
+        EXPECT_EQ(cache.find("ept-data/0-0-0-0.laz"), a);
+        cache.insert("ept-data/1-1-0-0.laz", data);
+        EXPECT_FALSE(cache.find("ept-data/0-0-0-0.laz").empty());
+        EXPECT_TRUE(cache.find("ept-data/1-0-0-0.laz").empty());
+        EXPECT_FALSE(cache.find("ept-data/1-1-0-0.laz").empty());
+    }
+
+    // The cached files are found again by a later reader of the same
+    // dataset, but not of another.
+    EptCache cache(dir, "http://example.com/ept", 250);
+    EXPECT_FALSE(cache.find("ept-data/1-1-0-0.laz").empty());
+    EptCache other(dir, "http://example.com/other", 250);
+    EXPECT_TRUE(other.find("ept-data/1-1-0-0.laz").empty());
+
+    FileUtils::deleteDirectory(dir);
+}
@@ -0,0 +1,165 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <algorithm>
+#include <sstream>
+#include <tuple>
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <json/json.h>
+
+#include <pdal/util/FileUtils.hpp>
+#include <io/EptReader.hpp>
+#include <io/EptWriter.hpp>
+#include <io/LasReader.hpp>
+#include "Support.hpp"
+
+using namespace pdal;
+
+namespace
+{
+    using Pt = std::tuple<double, double, double, uint16_t, uint16_t>;
+
+    std::vector<Pt> points(const PointViewPtr view)
+    {
+        using D = Dimension::Id;
+
+        std::vector<Pt> pts;
+        for (PointId i(0); i < view->size(); ++i)
+            pts.emplace_back(view->getFieldAs<double>(D::X, i),
+                view->getFieldAs<double>(D::Y, i),
+                view->getFieldAs<double>(D::Z, i),
+                view->getFieldAs<uint16_t>(D::Intensity, i),
+                view->getFieldAs<uint16_t>(D::Red, i));
+        std::sort(pts.begin(), pts.end());
+        return pts;
+    }
+
+    void roundTrip(const std::string& dataType)
+    {
+        const std::string dir(Support::temppath("ept-writer/"));
+        FileUtils::deleteDirectory(dir);
+
+        Options lasOptions;
+        lasOptions.add("filename", Support::datapath("las/1.2-with-color.las"));
+
+        PointTable inTable;
+        LasReader lasReader;
+        lasReader.setOptions(lasOptions);
+
+        // A small span makes for a deep tree.
+        Options writerOptions;
+        writerOptions.add("filename", dir);
+        writerOptions.add("span", 4);
+        writerOptions.add("data_type", dataType);
+
+        EptWriter writer;
+        writer.setOptions(writerOptions);
+        writer.setInput(lasReader);
+        writer.prepare(inTable);
+        PointViewSet inSet(writer.execute(inTable));
+        PointViewPtr inView(*inSet.begin());
+
+        EXPECT_TRUE(FileUtils::fileExists(dir + "ept.json"));
+        EXPECT_TRUE(FileUtils::fileExists(dir +
+            "ept-hierarchy/0-0-0-0.json"));
+        EXPECT_TRUE(FileUtils::fileExists(dir + "ept-data/0-0-0-0." +
+            (dataType == "binary" ? "bin" : "zst")));
+
+        Json::Value hier;
+        std::istringstream(FileUtils::readFileIntoString(dir +
+            "ept-hierarchy/0-0-0-0.json")) >> hier;
+        EXPECT_GT(hier.size(), 1u);
+
+        Options eptOptions;
+        eptOptions.add("filename", "ept://" + dir);
+
+        PointTable outTable;
+        EptReader eptReader;
+        eptReader.setOptions(eptOptions);
+
+        const QuickInfo qi(eptReader.preview());
+        EXPECT_EQ(qi.m_pointCount, inView->size());
+
+        BOX3D inBounds;
+        inView->calculateBounds(inBounds);
+        EXPECT_EQ(qi.m_bounds, inBounds);
+
+        eptReader.prepare(outTable);
+        PointViewSet outSet(eptReader.execute(outTable));
+        PointViewPtr outView(*outSet.begin());
+
+        ASSERT_EQ(outView->size(), inView->size());
+        EXPECT_EQ(points(outView), points(inView));
+
+        FileUtils::deleteDirectory(dir);
+    }
+}
+
+TEST(EptWriterTest, binary)
+{
+    roundTrip("binary");
+}
+
+#ifdef PDAL_HAVE_ZSTD
+TEST(EptWriterTest, zstandard)
+{
+    roundTrip("zstandard");
+}
+#endif
+
+TEST(EptWriterTest, badOptions)
+{
+    {
+        Options options;
+        options.add("filename", Support::temppath("ept-writer/"));
+        options.add("data_type", "laszip");
+
+        PointTable table;
+        EptWriter writer;
+        writer.setOptions(options);
+        EXPECT_THROW(writer.prepare(table), pdal_error);
+    }
+    {
+        Options options;
+        options.add("filename", Support::temppath("ept-writer/"));
+        options.add("span", 1);
+
+        PointTable table;
+        EptWriter writer;
+        writer.setOptions(options);
+        EXPECT_THROW(writer.prepare(table), pdal_error);
+    }
+}
@@ -96,6 +96,37 @@ TEST(GDALReaderTest, simple)
     verify(715154, 734.5, 972.5, 0, 0, 0);
 }
 
+// Bands read in parallel should produce the same points as bands read
+// one after another.
+TEST(GDALReaderTest, threads)
+{
+    auto read = [](size_t threads)
+    {
+        Options ro;
+        ro.add("filename", Support::datapath("png/autzen-height.png"));
+        ro.add("threads", threads);
+
+        GDALReader gr;
+        gr.setOptions(ro);
+
+        PointTable t;
+        gr.prepare(t);
+        PointViewSet s = gr.execute(t);
+        PointViewPtr v = *s.begin();
+
+        std::vector<double> values;
+        for (PointId idx = 0; idx < v->size(); ++idx)
+            for (Dimension::Id id : t.layout()->dims())
+                values.push_back(v->getFieldAs<double>(id, idx));
+        return values;
+    };
+
+    std::vector<double> serial = read(1);
+    std::vector<double> parallel = read(3);
+    EXPECT_EQ(serial.size(), (size_t)(735 * 973 * 5));
+    EXPECT_EQ(serial, parallel);
+}
+
 struct Point
 {
     double m_x;
@@ -641,6 +641,100 @@ TEST(GDALWriterTest, bounds)
     runGdalWriter(wo, infile, outfile, output);
 }
 
+// Tiled output, with tiles spilled to disk, matches untiled output.
+TEST(GDALWriterTest, tiled)
+{
+    std::string infile = Support::datapath("gdal/grid.txt");
+    std::string outfile = Support::temppath("tmp.tif");
+    std::string tiledfile = Support::temppath("tmp_tiled.tif");
+
+    auto write = [&infile](Options wo, bool stream)
+    {
+        Options ro;
+        ro.add("filename", infile);
+
+        TextReader r;
+        r.setOptions(ro);
+
+        GDALWriter w;
+        w.setOptions(wo);
+        w.setInput(r);
+
+        if (stream)
+        {
+            FixedPointTable t(10);
+
+            w.prepare(t);
+            w.execute(t);
+        }
+        else
+        {
+            PointTable t;
+
+            w.prepare(t);
+            w.execute(t);
+        }
+    };
+
+    gdal::registerDrivers();
+    for (int windowSize : { 0, 2 })
+        for (bool stream : { false, true })
+        {
+            Options wo;
+            wo.add("resolution", 1);
+            wo.add("radius", 1.5);
+            wo.add("output_type", "all");
+            wo.add("window_size", windowSize);
+            wo.add("bounds", "([-2, 4.7],[-2, 6.5])");
+
+            Options wo1(wo);
+            wo1.add("filename", outfile);
+            FileUtils::deleteFile(outfile);
+            write(wo1, stream);
+
+            Options wo2(wo);
+            wo2.add("filename", tiledfile);
+            wo2.add("tile_size", 2);
+            wo2.add("max_tiles", 2);
+            FileUtils::deleteFile(tiledfile);
+            write(wo2, stream);
+
+            gdal::Raster raster(outfile, "GTiff");
+            gdal::Raster tiled(tiledfile, "GTiff");
+            ASSERT_EQ(raster.open(), gdal::GDALError::None);
+            ASSERT_EQ(tiled.open(), gdal::GDALError::None);
+            ASSERT_EQ(raster.bandCount(), 6);
+            ASSERT_EQ(tiled.bandCount(), 6);
+            ASSERT_EQ(raster.width(), tiled.width());
+            ASSERT_EQ(raster.height(), tiled.height());
+            for (int band = 1; band <= 6; ++band)
+            {
+                std::vector<double> expected;
+                std::vector<double> data;
+                raster.readBand(expected, band);
+                tiled.readBand(data, band);
+                ASSERT_EQ(expected.size(), data.size());
+                for (size_t i = 0; i < data.size(); ++i)
+                {
+                    if (std::isnan(expected[i]))
+                        EXPECT_TRUE(std::isnan(data[i]));
+                    else
+                        EXPECT_DOUBLE_EQ(expected[i], data[i]) << "band " <<
+                            band << " cell " << i;
+                }
+            }
+        }
+
+    // The grid points aren't ordered by descending Y.
+    Options wo;
+    wo.add("resolution", 1);
+    wo.add("filename", tiledfile);
+    wo.add("bounds", "([-2, 4.7],[-2, 6.5])");
+    wo.add("tile_size", 2);
+    wo.add("sorted", true);
+    EXPECT_THROW(write(wo, true), pdal_error);
+}
+
 // Make sure we reset bounds when starting a new file.
 TEST(GDALWriterTest, issue_2074)
 {
@@ -741,4 +835,50 @@ TEST(GDALWriterTest, issue_2095)
     EXPECT_EQ(grid.verticalIndex(4.5), 0);
 }
 
+// Points added in parallel should produce exactly the values of points
+// added one at a time.
+TEST(GDALWriterTest, threads)
+{
+    const size_t width = 30;
+    const size_t height = 20;
+    const int types = GDALGrid::statCount | GDALGrid::statMin |
+        GDALGrid::statMax | GDALGrid::statMean | GDALGrid::statStdDev |
+        GDALGrid::statIdw;
+
+    std::vector<double> x, y, z;
+    for (size_t i = 0; i < 500; ++i)
+    {
+        x.push_back((i * 7919 % 3200) / 100.0 - 1);
+        y.push_back((i * 6271 % 2200) / 100.0 - 1);
+        z.push_back((i * 104729 % 1000) / 10.0);
+    }
+
+    for (size_t windowSize : { 0, 3 })
+    {
+        GDALGrid serial(width, height, 1, 1.6, types, windowSize);
+        for (size_t i = 0; i < x.size(); ++i)
+            serial.addPoint(x[i], y[i], z[i]);
+        serial.finalize();
+
+        GDALGrid parallel(width, height, 1, 1.6, types, windowSize);
+        parallel.setThreads(7);
+        parallel.addPoints(x, y, z);
+        parallel.finalize();
+
+        for (std::string name : { "count", "min", "max", "mean", "stdev",
+            "idw" })
+        {
+            double *expected = serial.data(name);
+            double *data = parallel.data(name);
+            for (size_t i = 0; i < width * height; ++i)
+            {
+                if (std::isnan(expected[i]))
+                    EXPECT_TRUE(std::isnan(data[i]));
+                else
+                    EXPECT_EQ(expected[i], data[i]) << name << " cell " << i;
+            }
+        }
+    }
+}
+
 } // namespace pdal
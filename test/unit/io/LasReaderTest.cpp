@@ -34,12 +34,17 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <fstream>
+#include <map>
+
 #include <pdal/pdal_features.hpp>
 #include <pdal/Filter.hpp>
 #include <pdal/PointView.hpp>
 #include <pdal/StageFactory.hpp>
 #include <pdal/Streamable.hpp>
+#include <pdal/util/OStream.hpp>
 #include <io/LasReader.hpp>
+#include <filters/StreamCallbackFilter.hpp>
 #include "Support.hpp"
 
 using namespace pdal;
@@ -252,6 +257,31 @@ TEST(LasReaderTest, test_vlr)
 }
 
 
+// With essential metadata, only forwarded values and the SRS are kept.
+TEST(LasReaderTest, essentialMetadata)
+{
+    PointTable table;
+
+    Options ops;
+    ops.add("filename", Support::datapath("las/lots_of_vlr.las"));
+    LasReader reader;
+    reader.setOptions(ops);
+    reader.setMetadataPolicy(MetadataPolicy::Essential);
+    reader.prepare(table);
+    reader.execute(table);
+
+    MetadataNode root = reader.getMetadata();
+    EXPECT_TRUE(root.findChild("minor_version").empty());
+    EXPECT_TRUE(root.findChild("count").empty());
+    EXPECT_TRUE(root.findChild("vlr_0").empty());
+    EXPECT_FALSE(root.findChild("srs").empty());
+
+    MetadataNode forward = table.privateMetadata("lasforward");
+    EXPECT_EQ(forward.findChild("minor_version").value<int>(), 1);
+    EXPECT_FALSE(forward.findChild("vlr_0").findChild("data").empty());
+}
+
+
 TEST(LasReaderTest, testInvalidFileSignature)
 {
     PointTable table;
@@ -328,6 +358,50 @@ TEST(LasReaderTest, extraBytes)
     }
 }
 
+// Extra bytes are loaded a field at a time for a batch of points in
+// standard mode and point by point in stream mode.  Both give the same
+// values.
+TEST(LasReaderTest, extraBytesStream)
+{
+    Options readOps;
+    readOps.add("filename", Support::datapath("las/extrabytes.las"));
+
+    PointTable table;
+    LasReader reader;
+    reader.setOptions(readOps);
+    reader.prepare(table);
+    PointViewSet viewSet = reader.execute(table);
+    PointViewPtr view = *viewSet.begin();
+
+    const StringList names { "Colors0", "Colors1", "Colors2", "Flags0",
+        "Flags1", "Time" };
+    std::vector<Dimension::Id> ids;
+    for (const std::string& name : names)
+        ids.push_back(table.layout()->findDim(name));
+
+    LasReader streamReader;
+    streamReader.setOptions(readOps);
+    StreamCallbackFilter f;
+    std::vector<Dimension::Id> streamIds;
+    PointId idx = 0;
+    f.setCallback([&](PointRef& point)
+    {
+        for (size_t i = 0; i < names.size(); ++i)
+            EXPECT_EQ(point.getFieldAs<double>(streamIds[i]),
+                view->getFieldAs<double>(ids[i], idx));
+        idx++;
+        return true;
+    });
+    f.setInput(streamReader);
+
+    FixedPointTable fixed(100);
+    f.prepare(fixed);
+    for (const std::string& name : names)
+        streamIds.push_back(fixed.layout()->findDim(name));
+    f.execute(fixed);
+    EXPECT_EQ(idx, view->size());
+}
+
 TEST(LasReaderTest, callback)
 {
     PointTable table;
@@ -394,6 +468,48 @@ TEST(LasReaderTest, lazperf)
        EXPECT_EQ(memcmp(buf1.get(), buf2.get(), pointSize), 0);
     }
 }
+
+// Chunks decompressed on several threads come out the same as when
+// they're decompressed one after another.
+TEST(LasReaderTest, lazperfThreads)
+{
+    auto read = [](int threads, point_count_t count)
+    {
+        Options ops;
+        ops.add("filename", Support::datapath("laz/autzen_trim.laz"));
+        ops.add("compression", "lazperf");
+        ops.add("threads", threads);
+        ops.add("count", count);
+
+        LasReader reader;
+        reader.setOptions(ops);
+
+        std::unique_ptr<PointTable> table(new PointTable);
+        reader.prepare(*table);
+        PointViewPtr view = *reader.execute(*table).begin();
+        return std::make_pair(std::move(table), view);
+    };
+
+    auto serial = read(1, 110000);
+    PointViewPtr view1 = serial.second;
+    DimTypeList dims = view1->dimTypes();
+    std::vector<char> buf1(view1->pointSize());
+    std::vector<char> buf2(view1->pointSize());
+
+    // Read everything, then stop partway through a chunk.
+    for (point_count_t count : { 110000, 75000 })
+    {
+        auto threaded = read(4, count);
+        PointViewPtr view2 = threaded.second;
+        ASSERT_EQ(view2->size(), count);
+        for (PointId i = 0; i < count; ++i)
+        {
+           view1->getPackedPoint(dims, i, buf1.data());
+           view2->getPackedPoint(dims, i, buf2.data());
+           EXPECT_EQ(memcmp(buf1.data(), buf2.data(), buf1.size()), 0);
+        }
+    }
+}
 #endif
 
 void streamTest(const std::string src, const std::string compression)
@@ -489,6 +605,25 @@ TEST(LasReaderTest, LasHeaderIncorrentPointcount)
     EXPECT_EQ(1064u, view->size());
 }
 
+// Stream mode stops at the end of the points that are really there.
+TEST(LasReaderTest, LasHeaderIncorrentPointcountStream)
+{
+    Options readOps;
+    readOps.add("filename", Support::datapath("las/1.2-with-color-clipped.las"));
+    LasReader reader;
+    reader.setOptions(readOps);
+
+    StreamCallbackFilter f;
+    point_count_t cnt = 0;
+    f.setCallback([&cnt](PointRef&){ cnt++; return true; });
+    f.setInput(reader);
+
+    FixedPointTable table(100);
+    f.prepare(table);
+    f.execute(table);
+    EXPECT_EQ(1064u, cnt);
+}
+
 TEST(LasReaderTest, EmptyGeotiffVlr)
 {
     PointTable table;
@@ -533,3 +668,140 @@ TEST(LasReaderTest, IgnoreVLRs)
     }
 
 }
+
+namespace
+{
+
+// Write a LAStools spatial index for a file with a two-level quadtree over
+// the bounds of the points.
+void writeLax(const std::string& filename, const std::string& laxFilename)
+{
+    Options ops;
+    ops.add("filename", filename);
+    LasReader reader;
+    reader.setOptions(ops);
+    PointTable table;
+    reader.prepare(table);
+    PointViewPtr view = *reader.execute(table).begin();
+
+    const BOX3D& b = reader.header().getBounds();
+    float minx = (float)b.minx;
+    float maxx = (float)b.maxx;
+    float miny = (float)b.miny;
+    float maxy = (float)b.maxy;
+
+    // Cells of the second level are numbered from 5.
+    std::map<int32_t, std::vector<std::pair<uint32_t, uint32_t>>> cells;
+    for (PointId i = 0; i < view->size(); ++i)
+    {
+        double x = view->getFieldAs<double>(Dimension::Id::X, i);
+        double y = view->getFieldAs<double>(Dimension::Id::Y, i);
+        double cellMinx = minx;
+        double cellMaxx = maxx;
+        double cellMiny = miny;
+        double cellMaxy = maxy;
+        int32_t cell = 0;
+        for (int level = 0; level < 2; ++level)
+        {
+            double midx = (cellMinx + cellMaxx) / 2;
+            double midy = (cellMiny + cellMaxy) / 2;
+            cell <<= 2;
+            if (x < midx)
+                cellMaxx = midx;
+            else
+            {
+                cellMinx = midx;
+                cell |= 1;
+            }
+            if (y < midy)
+                cellMaxy = midy;
+            else
+            {
+                cellMiny = midy;
+                cell |= 2;
+            }
+        }
+        auto& intervals = cells[cell + 5];
+        if (intervals.size() && intervals.back().second + 1 == i)
+            intervals.back().second = (uint32_t)i;
+        else
+            intervals.push_back({ (uint32_t)i, (uint32_t)i });
+    }
+
+    std::ofstream out(laxFilename, std::ios::out | std::ios::binary);
+    OLeStream lax(&out);
+    lax.put("LASX", 4);
+    lax << (uint32_t)0;
+    lax.put("LASS", 4);
+    lax << (uint32_t)0;
+    lax.put("LASQ", 4);
+    lax << (uint32_t)0 << (uint32_t)2 << (uint32_t)0 << (uint32_t)0;
+    lax << minx << maxx << miny << maxy;
+    lax.put("LASV", 4);
+    lax << (uint32_t)0 << (uint32_t)cells.size();
+    for (auto& c : cells)
+    {
+        lax << c.first << (uint32_t)c.second.size() << (uint32_t)0;
+        for (auto& i : c.second)
+            lax << i.first << i.second;
+    }
+}
+
+} // unnamed namespace
+
+// Points read using a spatial index should be the same as those read
+// without one.
+TEST(LasReaderTest, spatialIndex)
+{
+    std::vector<std::string> sources {
+        Support::datapath("las/autzen_trim.las") };
+#if defined(PDAL_HAVE_LAZPERF) || defined(PDAL_HAVE_LASZIP)
+    sources.push_back(Support::datapath("laz/autzen_trim.laz"));
+#endif
+
+    for (const std::string& src : sources)
+    {
+        std::string ext = FileUtils::extension(src);
+        std::string filename = Support::temppath("indexed" + ext);
+        std::string laxFilename = Support::temppath("indexed.lax");
+        {
+            std::ifstream in(src, std::ios::in | std::ios::binary);
+            std::ofstream out(filename, std::ios::out | std::ios::binary);
+            out << in.rdbuf();
+        }
+        FileUtils::deleteFile(laxFilename);
+
+        auto read = [&filename](const std::string& compression)
+        {
+            Options ops;
+            ops.add("filename", filename);
+            ops.add("bounds", "([636200, 636600], [849000, 849300])");
+            ops.add("compression", compression);
+
+            LasReader reader;
+            reader.setOptions(ops);
+            PointTable table;
+            reader.prepare(table);
+            PointViewPtr view = *reader.execute(table).begin();
+
+            std::vector<double> x;
+            for (PointId i = 0; i < view->size(); ++i)
+                x.push_back(view->getFieldAs<double>(Dimension::Id::X, i));
+            return x;
+        };
+
+        std::vector<double> expected = read("EITHER");
+        EXPECT_GT(expected.size(), 0u);
+        EXPECT_LT(expected.size(), 110000u);
+
+        writeLax(filename, laxFilename);
+        EXPECT_EQ(read("EITHER"), expected);
+#if defined(PDAL_HAVE_LAZPERF)
+        if (ext == ".laz")
+            EXPECT_EQ(read("LAZPERF"), expected);
+#endif
+
+        FileUtils::deleteFile(filename);
+        FileUtils::deleteFile(laxFilename);
+    }
+}
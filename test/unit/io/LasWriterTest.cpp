@@ -34,6 +34,7 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <algorithm>
 #include <stdlib.h>
 
 #include <pdal/pdal_features.hpp>
@@ -603,6 +604,76 @@ TEST(LasWriterTest, flex)
     }
 }
 
+
+// Files written concurrently from separate views are the same as files
+// written one at a time, and are numbered in view order.
+TEST(LasWriterTest, flexConcurrent)
+{
+    Options readerOps;
+    readerOps.add("filename", Support::datapath("las/simple.las"));
+
+    PointTable table;
+
+    LasReader reader;
+    reader.setOptions(readerOps);
+
+    reader.prepare(table);
+    PointViewSet views = reader.execute(table);
+    PointViewPtr v = *(views.begin());
+
+    std::vector<PointViewPtr> vs;
+    for (size_t i = 0; i < 5; ++i)
+        vs.push_back(PointViewPtr(new PointView(table)));
+
+    // Leave the third view empty.  No file is written for it.
+    for (PointId i = 0; i < v->size(); ++i)
+    {
+        size_t n = i % 4;
+        vs[n < 2 ? n : n + 1]->appendPoint(*v, i);
+    }
+
+    auto write = [&vs, &table](const std::string& filename, int threads)
+    {
+        BufferReader r;
+        for (PointViewPtr& view : vs)
+            r.addView(view);
+
+        Options writerOps;
+        writerOps.add("filename", Support::temppath(filename));
+
+        LasWriter w;
+        w.setOptions(writerOps);
+        w.setInput(r);
+
+        w.prepare(table);
+        w.execute(table, threads);
+        return w.getMetadata();
+    };
+
+    for (size_t i = 1; i <= 5; ++i)
+    {
+        FileUtils::deleteFile(Support::temppath("serial_" +
+            std::to_string(i) + ".las"));
+        FileUtils::deleteFile(Support::temppath("concurrent_" +
+            std::to_string(i) + ".las"));
+    }
+
+    write("serial_#.las", 1);
+    MetadataNode m = write("concurrent_#.las", 4);
+
+    MetadataNodeList files = m.children("filename");
+    ASSERT_EQ(files.size(), 4u);
+    for (size_t i = 1; i <= 4; ++i)
+    {
+        std::string suffix(std::to_string(i) + ".las");
+        EXPECT_EQ(files[i - 1].value(),
+            Support::temppath("concurrent_" + suffix));
+        EXPECT_EQ(Support::diff_files(Support::temppath("serial_" + suffix),
+            Support::temppath("concurrent_" + suffix)), 0u);
+    }
+    EXPECT_FALSE(FileUtils::fileExists(Support::temppath("concurrent_5.las")));
+}
+
 // Test that data from three input views gets written to a single output file.
 TEST(LasWriterTest, flex2)
 {
@@ -727,6 +798,187 @@ TEST(LasWriterTest, lazperf)
 }
 #endif
 
+#if defined(PDAL_HAVE_LAZPERF)
+// Chunks compressed on several threads should be written exactly as they
+// are when compressed serially.
+TEST(LasWriterTest, lazperfThreads)
+{
+    auto write = [](const std::string& filename, int threads)
+    {
+        Options readerOps;
+        readerOps.add("filename", Support::datapath("las/autzen_trim.las"));
+
+        LasReader reader;
+        reader.setOptions(readerOps);
+
+        FileUtils::deleteFile(filename);
+
+        Options writerOps;
+        writerOps.add("filename", filename);
+        writerOps.add("compression", "lazperf");
+        writerOps.add("threads", threads);
+
+        LasWriter writer;
+        writer.setOptions(writerOps);
+        writer.setInput(reader);
+
+        PointTable t;
+        writer.prepare(t);
+        writer.execute(t);
+    };
+
+    std::string serial(Support::temppath("serial.laz"));
+    std::string threaded(Support::temppath("threaded.laz"));
+    write(serial, 1);
+    write(threaded, 4);
+    EXPECT_TRUE(Support::compare_files(serial, threaded));
+
+    Options ops;
+    ops.add("filename", threaded);
+
+    LasReader r;
+    r.setOptions(ops);
+
+    PointTable t;
+    r.prepare(t);
+    PointViewSet set = r.execute(t);
+    EXPECT_EQ((*set.begin())->size(), (point_count_t)110000);
+
+    FileUtils::deleteFile(serial);
+    FileUtils::deleteFile(threaded);
+}
+#endif
+
+// A file written with a spatial index should give the same points for a
+// region as the original.
+TEST(LasWriterTest, spatialIndex)
+{
+    std::string src(Support::datapath("las/autzen_trim.las"));
+    std::string filename(Support::temppath("indexed.las"));
+    std::string laxFilename(Support::temppath("indexed.lax"));
+    FileUtils::deleteFile(filename);
+    FileUtils::deleteFile(laxFilename);
+
+    {
+        Options readerOps;
+        readerOps.add("filename", src);
+        LasReader reader;
+        reader.setOptions(readerOps);
+
+        Options writerOps;
+        writerOps.add("filename", filename);
+        writerOps.add("spatial_index", true);
+        LasWriter writer;
+        writer.setOptions(writerOps);
+        writer.setInput(reader);
+
+        PointTable t;
+        writer.prepare(t);
+        writer.execute(t);
+    }
+    EXPECT_TRUE(FileUtils::fileExists(laxFilename));
+
+    auto read = [](const std::string& filename)
+    {
+        Options ops;
+        ops.add("filename", filename);
+        ops.add("bounds", "([636200, 636600], [849000, 849300])");
+        LasReader reader;
+        reader.setOptions(ops);
+        PointTable table;
+        reader.prepare(table);
+        PointViewPtr view = *reader.execute(table).begin();
+
+        std::vector<std::pair<double, double>> xy;
+        for (PointId i = 0; i < view->size(); ++i)
+            xy.push_back({ view->getFieldAs<double>(Dimension::Id::X, i),
+                view->getFieldAs<double>(Dimension::Id::Y, i) });
+        std::sort(xy.begin(), xy.end());
+        return xy;
+    };
+
+    auto expected = read(src);
+    EXPECT_GT(expected.size(), 0u);
+    EXPECT_EQ(read(filename), expected);
+
+    FileUtils::deleteFile(filename);
+    FileUtils::deleteFile(laxFilename);
+}
+
+// Appending to a file should leave its points followed by the new ones,
+// with a header that covers both.  The LAZ file ends with a partial
+// chunk, which is compressed again with the appended points.
+TEST(LasWriterTest, append)
+{
+    const std::string src(Support::datapath("las/autzen_trim.las"));
+
+    auto read = [](const std::string& filename, LasHeader& header)
+    {
+        Options ops;
+        ops.add("filename", filename);
+        LasReader reader;
+        reader.setOptions(ops);
+        PointTable table;
+        reader.prepare(table);
+        PointViewPtr view = *reader.execute(table).begin();
+        header = reader.header();
+        return view;
+    };
+
+    auto test = [&src, &read](const std::string& filename,
+        const std::string& compression)
+    {
+        FileUtils::deleteFile(filename);
+        for (int i = 0; i < 2; ++i)
+        {
+            Options readerOps;
+            readerOps.add("filename", src);
+            LasReader reader;
+            reader.setOptions(readerOps);
+
+            Options writerOps;
+            writerOps.add("filename", filename);
+            writerOps.add("compression", compression);
+            writerOps.add("append", true);
+            LasWriter writer;
+            writer.setOptions(writerOps);
+            writer.setInput(reader);
+
+            PointTable t;
+            writer.prepare(t);
+            writer.execute(t);
+        }
+
+        LasHeader srcHeader;
+        LasHeader header;
+        PointViewPtr orig = read(src, srcHeader);
+        PointViewPtr v = read(filename, header);
+        const point_count_t n = orig->size();
+        ASSERT_EQ(v->size(), 2 * n);
+        EXPECT_EQ(header.pointCount(), 2 * n);
+        for (size_t r = 0; r < LasHeader::RETURN_COUNT; ++r)
+            EXPECT_EQ(header.pointCountByReturn(r),
+                2 * srcHeader.pointCountByReturn(r));
+        EXPECT_DOUBLE_EQ(header.minX(), srcHeader.minX());
+        EXPECT_DOUBLE_EQ(header.maxZ(), srcHeader.maxZ());
+
+        for (PointId i = 0; i < n; ++i)
+            for (PointId j : { i, i + n })
+            {
+                EXPECT_EQ(v->getFieldAs<double>(Dimension::Id::X, j),
+                    orig->getFieldAs<double>(Dimension::Id::X, i));
+                EXPECT_EQ(v->getFieldAs<double>(Dimension::Id::GpsTime, j),
+                    orig->getFieldAs<double>(Dimension::Id::GpsTime, i));
+            }
+        FileUtils::deleteFile(filename);
+    };
+
+    test(Support::temppath("append.las"), "none");
+#if defined(PDAL_HAVE_LAZPERF)
+    test(Support::temppath("append.laz"), "lazperf");
+#endif
+}
+
 #if defined(PDAL_HAVE_LASZIP)
 // LAZ files are normally written in chunks of 50,000, so a file of size
 // 110,000 ensures we read some whole chunks and a partial.
@@ -0,0 +1,104 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <io/FauxReader.hpp>
+#include <io/NullWriter.hpp>
+
+using namespace pdal;
+
+namespace
+{
+
+void checkMetadata(const MetadataNode& m, point_count_t count,
+    uint64_t batches)
+{
+    EXPECT_EQ(m.findChild("count").value<point_count_t>(), count);
+    EXPECT_EQ(m.findChild("batches").value<uint64_t>(), batches);
+    EXPECT_GE(m.findChild("points_per_second").value<double>(), 0.0);
+
+    MetadataNode latency = m.findChild("latency_ms");
+    double p50 = latency.findChild("p50").value<double>();
+    double p99 = latency.findChild("p99").value<double>();
+    EXPECT_LE(latency.findChild("min").value<double>(), p50);
+    EXPECT_LE(p50, p99);
+    EXPECT_LE(p99, latency.findChild("max").value<double>());
+
+    MetadataNode bytes = m.findChild("bytes_read");
+    EXPECT_EQ(bytes.findChild("X").value<uint64_t>(), count * 8);
+    EXPECT_EQ(bytes.findChild("OffsetTime").value<uint64_t>(), count * 4);
+}
+
+} // unnamed namespace
+
+TEST(NullWriterTest, standard)
+{
+    Options ro;
+    ro.add("count", 1000);
+    ro.add("mode", "ramp");
+    FauxReader r;
+    r.setOptions(ro);
+
+    Options wo;
+    wo.add("read_fields", true);
+    NullWriter w;
+    w.setOptions(wo);
+    w.setInput(r);
+
+    PointTable t;
+    w.prepare(t);
+    w.execute(t);
+    checkMetadata(w.getMetadata(), 1000, 1);
+}
+
+TEST(NullWriterTest, stream)
+{
+    Options ro;
+    ro.add("count", 1000);
+    ro.add("mode", "ramp");
+    FauxReader r;
+    r.setOptions(ro);
+
+    Options wo;
+    wo.add("read_fields", true);
+    NullWriter w;
+    w.setOptions(wo);
+    w.setInput(r);
+
+    FixedPointTable t(100);
+    w.prepare(t);
+    w.execute(t);
+    checkMetadata(w.getMetadata(), 1000, 10);
+}
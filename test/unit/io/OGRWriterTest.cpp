@@ -0,0 +1,151 @@
+/******************************************************************************
+* Copyright (c) 2019, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <set>
+
+#include <ogrsf_frmts.h>
+
+#include <pdal/GDALUtils.hpp>
+#include <pdal/StageFactory.hpp>
+#include <pdal/util/FileUtils.hpp>
+
+#include "Support.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+// Write 10 points with X from 0 to 9 in multipoints of 3, committing every
+// two features, and check that the last feature holds only the one point
+// left over.
+void testMulticount(const std::string& driver, const std::string& filename,
+    bool stream)
+{
+    StageFactory f;
+
+    Options ro;
+    ro.add("bounds", BOX3D(0, 0, 0, 9, 9, 9));
+    ro.add("count", 10);
+    ro.add("mode", "ramp");
+    Stage& r = *f.createStage("readers.faux");
+    r.setOptions(ro);
+
+    Options wo;
+    wo.add("filename", filename);
+    wo.add("ogrdriver", driver);
+    wo.add("multicount", 3);
+    wo.add("batch_size", 2);
+    Stage& w = *f.createStage("writers.ogr");
+    w.setOptions(wo);
+    w.setInput(r);
+
+    if (stream)
+    {
+        FixedPointTable t(4);
+        w.prepare(t);
+        w.execute(t);
+    }
+    else
+    {
+        PointTable t;
+        w.prepare(t);
+        w.execute(t);
+    }
+
+    GDALDataset *ds = (GDALDataset *)GDALOpenEx(filename.c_str(),
+        GDAL_OF_VECTOR, nullptr, nullptr, nullptr);
+    ASSERT_TRUE(ds) << driver;
+    OGRLayer *layer = ds->GetLayer(0);
+    ASSERT_TRUE(layer) << driver;
+
+    std::vector<int> sizes;
+    std::set<GIntBig> fids;
+    double x = 0;
+    layer->ResetReading();
+    while (OGRFeature *feature = layer->GetNextFeature())
+    {
+        EXPECT_TRUE(fids.insert(feature->GetFID()).second) <<
+            driver << ": duplicate FID " << feature->GetFID();
+
+        OGRGeometry *g = feature->GetGeometryRef();
+        EXPECT_TRUE(g);
+        if (g && wkbFlatten(g->getGeometryType()) == wkbMultiPoint)
+        {
+            OGRMultiPoint *mp = static_cast<OGRMultiPoint *>(g);
+            sizes.push_back(mp->getNumGeometries());
+            for (int i = 0; i < mp->getNumGeometries(); ++i)
+            {
+                OGRPoint *p = static_cast<OGRPoint *>(mp->getGeometryRef(i));
+                EXPECT_DOUBLE_EQ(p->getX(), x) << driver;
+                x++;
+            }
+        }
+        else
+            ADD_FAILURE() << driver << ": feature isn't a multipoint.";
+        OGRFeature::DestroyFeature(feature);
+    }
+    GDALClose(ds);
+
+    EXPECT_EQ(sizes, (std::vector<int>{ 3, 3, 3, 1 })) << driver;
+    EXPECT_EQ(fids.size(), 4u) << driver;
+}
+
+} // unnamed namespace
+
+TEST(OGRWriterTest, multicountRemainder)
+{
+    gdal::registerDrivers();
+
+    for (bool stream : { false, true })
+    {
+        const std::string shp(Support::temppath("ogr_multicount.shp"));
+        for (const char *ext : { ".shp", ".shx", ".dbf", ".prj" })
+            FileUtils::deleteFile(
+                Support::temppath(std::string("ogr_multicount") + ext));
+        testMulticount("ESRI Shapefile", shp, stream);
+
+        // GeoPackage assigns the FIDs itself, so a reused feature whose ID
+        // wasn't cleared would fail to be written.
+        if (GetGDALDriverManager()->GetDriverByName("GPKG"))
+        {
+            const std::string gpkg(Support::temppath("ogr_multicount.gpkg"));
+            FileUtils::deleteFile(gpkg);
+            testMulticount("GPKG", gpkg, stream);
+            FileUtils::deleteFile(gpkg);
+        }
+    }
+}
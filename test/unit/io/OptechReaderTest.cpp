@@ -133,6 +133,37 @@ TEST_F(OptechReaderTest, ReadingPoints)
 }
 
 
+TEST(OptechReader, threads)
+{
+    using namespace Dimension;
+
+    auto readFile = [](int threads)
+    {
+        Options options;
+        options.add("filename", getTestfilePath());
+        options.add("threads", threads);
+
+        OptechReader reader;
+        reader.setOptions(options);
+
+        PointTable table;
+        reader.prepare(table);
+        PointViewSet viewSet = reader.execute(table);
+        return *viewSet.begin();
+    };
+
+    PointViewPtr v1 = readFile(1);
+    PointViewPtr v2 = readFile(5);
+    ASSERT_EQ(v1->size(), v2->size());
+    for (PointId idx = 0; idx < v1->size(); ++idx)
+        for (Id dim : { Id::X, Id::Y, Id::Z, Id::GpsTime, Id::ReturnNumber,
+            Id::NumberOfReturns, Id::EchoRange, Id::Intensity,
+            Id::ScanAngleRank })
+            EXPECT_EQ(v1->getFieldAs<double>(dim, idx),
+                v2->getFieldAs<double>(dim, idx));
+}
+
+
 TEST_F(OptechReaderTest, Spatialreference)
 {
     SpatialReference expected("EPSG:4326");
@@ -35,7 +35,11 @@
 #include <pdal/Filter.hpp>
 #include <pdal/pdal_test_main.hpp>
 
+#include <pdal/util/FileUtils.hpp>
+#include <filters/StreamCallbackFilter.hpp>
+#include <io/BufferReader.hpp>
 #include <io/PlyReader.hpp>
+#include <io/PlyWriter.hpp>
 #include "Support.hpp"
 
 namespace pdal
@@ -199,4 +203,125 @@ TEST(PlyReader, NoVertex)
     EXPECT_THROW(reader.prepare(table), pdal_error);
 }
 
+
+TEST(PlyReader, ReadFaces)
+{
+    PlyReader reader;
+    Options options;
+    options.add("filename", Support::datapath("ply/mesh.ply"));
+    reader.setOptions(options);
+
+    PointTable table;
+    reader.prepare(table);
+    PointViewSet viewSet = reader.execute(table);
+    PointViewPtr view = *viewSet.begin();
+    EXPECT_EQ(view->size(), 4u);
+
+    TriangularMesh *mesh = view->mesh();
+    ASSERT_TRUE(mesh);
+    ASSERT_EQ(mesh->size(), 2u);
+    EXPECT_EQ((*mesh)[1].m_a, 1u);
+    EXPECT_EQ((*mesh)[1].m_b, 2u);
+    EXPECT_EQ((*mesh)[1].m_c, 3u);
+}
+
+
+// Write binary files in both byte orders and read them back.
+TEST(PlyReader, BinaryRoundTrip)
+{
+    using namespace Dimension;
+
+    const PointId count = 100000;
+    std::string outfile(Support::temppath("roundtrip.ply"));
+
+    PointTable t;
+    t.layout()->registerDims({ Id::X, Id::Y, Id::Z, Id::Intensity });
+    Id fid = t.layout()->assignDim("f", Type::Float);
+
+    PointViewPtr v(new PointView(t));
+    for (PointId i = 0; i < count; ++i)
+    {
+        v->setField(Id::X, i, i * 1.25);
+        v->setField(Id::Y, i, -(double)i);
+        v->setField(Id::Z, i, i / 7.0);
+        v->setField(Id::Intensity, i, i % 65536);
+        v->setField(fid, i, i * .5f);
+    }
+    TriangularMesh *mesh = v->createMesh("foo");
+    for (PointId i = 0; i + 2 < count; i += 3)
+        mesh->add(i, i + 1, i + 2);
+
+    for (const std::string mode : { "little endian", "big endian" })
+    {
+        FileUtils::deleteFile(outfile);
+        {
+            BufferReader r;
+            r.addView(v);
+
+            PlyWriter w;
+            Options wo;
+            wo.add("filename", outfile);
+            wo.add("storage_mode", mode);
+            wo.add("faces", true);
+            w.setInput(r);
+            w.setOptions(wo);
+
+            w.prepare(t);
+            w.execute(t);
+        }
+
+        Options ro;
+        ro.add("filename", outfile);
+
+        PlyReader reader;
+        reader.setOptions(ro);
+
+        PointTable table;
+        reader.prepare(table);
+        PointViewSet viewSet = reader.execute(table);
+        PointViewPtr view = *viewSet.begin();
+        ASSERT_EQ(view->size(), count);
+
+        Id rfid = table.layout()->findDim("f");
+        Id iid = table.layout()->findDim("intensity");
+        for (PointId i = 0; i < count; ++i)
+        {
+            checkPoint(view, i, i * 1.25, -(double)i, i / 7.0);
+            EXPECT_EQ(view->getFieldAs<int>(iid, i), (int)(i % 65536));
+            EXPECT_EQ(view->getFieldAs<float>(rfid, i), i * .5f);
+        }
+
+        TriangularMesh *rmesh = view->mesh();
+        ASSERT_TRUE(rmesh);
+        ASSERT_EQ(rmesh->size(), mesh->size());
+        for (size_t i = 0; i < mesh->size(); ++i)
+        {
+            EXPECT_EQ((*rmesh)[i].m_a, (*mesh)[i].m_a);
+            EXPECT_EQ((*rmesh)[i].m_b, (*mesh)[i].m_b);
+            EXPECT_EQ((*rmesh)[i].m_c, (*mesh)[i].m_c);
+        }
+
+        // Streaming reads the same points.
+        PlyReader sreader;
+        sreader.setOptions(ro);
+
+        PointId idx = 0;
+        StreamCallbackFilter f;
+        f.setCallback([&idx, &view](PointRef& p)
+        {
+            EXPECT_DOUBLE_EQ(p.getFieldAs<double>(Id::Z),
+                view->getFieldAs<double>(Id::Z, idx));
+            idx++;
+            return true;
+        });
+        f.setInput(sreader);
+
+        FixedPointTable ft(1000);
+        f.prepare(ft);
+        f.execute(ft);
+        EXPECT_EQ(idx, count);
+    }
+    FileUtils::deleteFile(outfile);
+}
+
 }
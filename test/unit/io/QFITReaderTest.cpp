@@ -37,6 +37,7 @@
 #include <pdal/Options.hpp>
 #include <pdal/PointView.hpp>
 #include <io/QfitReader.hpp>
+#include <filters/StreamCallbackFilter.hpp>
 #include "Support.hpp"
 
 #include <iostream>
@@ -107,3 +108,57 @@ TEST(QFITReaderTest, test_14_word)
     Check_Point(*view, 1, 244.306260, 35.623280, 1056.409000000, 903);
     Check_Point(*view, 2, 244.306204, 35.623257, 1056.483000000, 903);
 }
+
+// Records decoded on several threads or streamed should match records
+// decoded on one thread.
+TEST(QFITReaderTest, threads)
+{
+    auto read = [](size_t threads, bool stream)
+    {
+        Options options;
+        options.add("filename", Support::datapath("qfit/10-word.qi"));
+        options.add("threads", threads);
+
+        QfitReader reader;
+        reader.setOptions(options);
+
+        std::vector<double> values;
+        auto append = [&values](PointRef& point)
+        {
+            using namespace Dimension;
+            for (Id id : { Id::OffsetTime, Id::X, Id::Y, Id::Z,
+                    Id::StartPulse, Id::ReflectedPulse, Id::Azimuth,
+                    Id::Pitch, Id::Roll })
+                values.push_back(point.getFieldAs<double>(id));
+            return true;
+        };
+
+        if (stream)
+        {
+            FixedPointTable table(100);
+            StreamCallbackFilter f;
+            f.setCallback(append);
+            f.setInput(reader);
+            f.prepare(table);
+            f.execute(table);
+        }
+        else
+        {
+            PointTable table;
+            reader.prepare(table);
+            PointViewSet s = reader.execute(table);
+            PointViewPtr v = *s.begin();
+            for (PointId i = 0; i < v->size(); ++i)
+            {
+                PointRef point(*v, i);
+                append(point);
+            }
+        }
+        return values;
+    };
+
+    std::vector<double> serial = read(1, false);
+    EXPECT_FALSE(serial.empty());
+    EXPECT_EQ(serial, read(3, false));
+    EXPECT_EQ(serial, read(1, true));
+}
@@ -39,6 +39,7 @@
 #include <io/LasReader.hpp>
 #include <io/LasWriter.hpp>
 #include <io/TextReader.hpp>
+#include <filters/StreamCallbackFilter.hpp>
 #include <pdal/util/FileUtils.hpp>
 
 using namespace pdal;
@@ -288,3 +289,74 @@ TEST(TextReaderTest, insertHeader)
     EXPECT_TRUE(layout->findDim("C") != Dimension::Id::Unknown);
     EXPECT_TRUE(layout->findDim("G") != Dimension::Id::Unknown);
 }
+
+// Points parsed in parallel must match those parsed by a single thread,
+// in order, and skip the same bad lines.
+TEST(TextReaderTest, threads)
+{
+    std::string filename = Support::temppath("threads.txt");
+    {
+        std::ofstream out(filename);
+        out << "X,Y,Z,Intensity\n";
+        for (int i = 0; i < 100000; ++i)
+        {
+            if (i % 1000 == 0)
+                out << "\n1,2\n";
+            out << (i * .25) << ", " << (-i * 1.5) << "," << (i % 97) <<
+                "," << (i % 65536) << (i % 2 ? "\r\n" : "\n");
+        }
+        out << "1,2,3,4";
+    }
+
+    auto read = [&filename](int threads, bool stream)
+    {
+        TextReader reader;
+        Options options;
+        options.add("filename", filename);
+        options.add("threads", threads);
+        reader.setOptions(options);
+
+        std::vector<double> values;
+        auto append = [&values](PointRef& p)
+        {
+            for (Dimension::Id id : { Dimension::Id::X, Dimension::Id::Y,
+                    Dimension::Id::Z, Dimension::Id::Intensity })
+                values.push_back(p.getFieldAs<double>(id));
+            return true;
+        };
+
+        if (stream)
+        {
+            FixedPointTable table(1000);
+            StreamCallbackFilter f;
+            f.setCallback(append);
+            f.setInput(reader);
+            f.prepare(table);
+            f.execute(table);
+        }
+        else
+        {
+            PointTable table;
+            reader.prepare(table);
+            PointViewSet s = reader.execute(table);
+            PointViewPtr v = *s.begin();
+            for (PointId i = 0; i < v->size(); ++i)
+            {
+                PointRef p(*v, i);
+                append(p);
+            }
+        }
+        return values;
+    };
+
+    std::vector<double> values = read(1, false);
+    ASSERT_EQ(values.size(), 100001U * 4);
+    EXPECT_DOUBLE_EQ(values[4 * 999], 999 * .25);
+    EXPECT_DOUBLE_EQ(values[4 * 999 + 1], -999 * 1.5);
+    EXPECT_DOUBLE_EQ(values[4 * 100000 + 3], 4);
+    EXPECT_EQ(values, read(4, false));
+    EXPECT_EQ(values, read(4, true));
+    EXPECT_EQ(values, read(1, true));
+
+    FileUtils::deleteFile(filename);
+}
@@ -185,3 +185,51 @@ TEST(TextWriterTest, precision)
     EXPECT_NE(out.find("3,3,3,3"), std::string::npos);
 }
 
+
+// Points formatted in parallel must be written in order and match the
+// single-threaded output.
+TEST(TextWriterTest, threads)
+{
+    using namespace Dimension;
+
+    PointTable table;
+    table.layout()->registerDims( { Id::X, Id::Y, Id::Z, Id::Intensity } );
+
+    PointViewPtr view(new PointView(table));
+    for (PointId i = 0; i < 100000; ++i)
+    {
+        view->setField(Id::X, i, i * 1.0005);
+        view->setField(Id::Y, i, -(i * 0.0625));
+        view->setField(Id::Z, i, i / 3.0);
+        view->setField(Id::Intensity, i, i % 65536);
+    }
+
+    auto write = [&table, &view](int threads)
+    {
+        BufferReader r;
+        r.addView(view);
+
+        std::string outfile(Support::temppath("threads.txt"));
+
+        TextWriter w;
+        Options o;
+        o.add("order", "X,Y:1,Z:7,Intensity:0");
+        o.add("filename", outfile);
+        o.add("threads", threads);
+        w.setInput(r);
+        w.setOptions(o);
+
+        w.prepare(table);
+        w.execute(table);
+
+        std::string out = FileUtils::readFileIntoString(outfile);
+        FileUtils::deleteFile(outfile);
+        return out;
+    };
+
+    std::string out = write(1);
+    EXPECT_NE(out.find("\n12.006,-0.8,4.0000000,12\n"), std::string::npos);
+    EXPECT_NE(out.find("\n100048.999,-6249.9,33333.0000000,34463\n"),
+        std::string::npos);
+    EXPECT_EQ(out, write(4));
+}